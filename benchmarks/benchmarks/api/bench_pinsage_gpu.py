@@ -0,0 +1,32 @@
+import time
+import dgl
+import torch
+import numpy as np
+
+from .. import utils
+
+
+@utils.skip_if_cpu()
+@utils.benchmark('throughput', timeout=600)
+@utils.parametrize('avg_degree', [10, 50])
+@utils.parametrize('num_seeds', [1000, 10000])
+@utils.parametrize('num_random_walks', [10, 50])
+@utils.parametrize('num_neighbors', [3, 10])
+def track_throughput(avg_degree, num_seeds, num_random_walks, num_neighbors):
+    device = utils.get_bench_device()
+    graph = utils.get_powerlaw_graph(1000000, avg_degree, bipartite=True).to(device)
+    sampler = dgl.sampling.PinSAGESampler(
+        graph, 'item', 'user', 3, 0.5, num_random_walks, num_neighbors)
+    seeds = torch.randint(0, graph.num_nodes('item'), (num_seeds,), device=device)
+
+    # dry run
+    for i in range(3):
+        sampler(seeds)
+
+    # timing
+    num_edges = 0
+    with utils.Timer(device) as t:
+        for i in range(20):
+            num_edges += sampler(seeds).num_edges()
+
+    return num_edges / t.elapsed_secs
@@ -0,0 +1,39 @@
+import time
+import dgl
+import torch
+import numpy as np
+
+from .. import utils
+
+
+@utils.skip_if_cpu()
+@utils.benchmark('throughput', timeout=600)
+@utils.parametrize('avg_degree', [10, 50])
+@utils.parametrize('fanout', [5, 25])
+@utils.parametrize('feat_size', [16, 128])
+def track_throughput(avg_degree, fanout, feat_size):
+    """Sample on the GPU, then gather the features of the sampled nodes from
+    pinned host memory through a UnifiedTensor, i.e. over UVA.
+    """
+    device = utils.get_bench_device()
+    cpu_graph = utils.get_powerlaw_graph(1000000, avg_degree)
+    feats = torch.randn(cpu_graph.num_nodes(), feat_size)
+    feats = dgl.contrib.UnifiedTensor(feats, device=torch.device(device))
+    graph = cpu_graph.formats('csc').to(device)
+    seed_nodes = torch.randint(0, graph.num_nodes(), (1000,), device=device)
+
+    # dry run
+    for i in range(3):
+        frontier = dgl.sampling.sample_neighbors(graph, seed_nodes, fanout)
+        feats[frontier.edges()[0]]
+
+    # timing
+    num_edges = 0
+    with utils.Timer(device) as t:
+        for i in range(50):
+            frontier = dgl.sampling.sample_neighbors(graph, seed_nodes, fanout)
+            # the features of the sources of the sampled edges
+            feats[frontier.edges()[0]]
+            num_edges += frontier.num_edges()
+
+    return num_edges / t.elapsed_secs
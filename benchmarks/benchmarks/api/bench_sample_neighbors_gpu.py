@@ -0,0 +1,32 @@
+import time
+import dgl
+import torch
+import numpy as np
+
+from .. import utils
+
+
+@utils.skip_if_cpu()
+@utils.benchmark('throughput', timeout=600)
+@utils.parametrize('avg_degree', [10, 50])
+@utils.parametrize('seed_nodes_num', [1000, 20000])
+@utils.parametrize('fanout', [5, 10, 25])
+@utils.parametrize('replace', [False, True])
+def track_throughput(avg_degree, seed_nodes_num, fanout, replace):
+    device = utils.get_bench_device()
+    graph = utils.get_powerlaw_graph(1000000, avg_degree).formats('csc').to(device)
+    seed_nodes = torch.randint(0, graph.num_nodes(), (seed_nodes_num,), device=device)
+
+    # dry run
+    for i in range(3):
+        dgl.sampling.sample_neighbors(graph, seed_nodes, fanout, replace=replace)
+
+    # timing
+    num_edges = 0
+    with utils.Timer(device) as t:
+        for i in range(50):
+            frontier = dgl.sampling.sample_neighbors(
+                graph, seed_nodes, fanout, replace=replace)
+            num_edges += frontier.num_edges()
+
+    return num_edges / t.elapsed_secs
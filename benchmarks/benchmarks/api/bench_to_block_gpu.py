@@ -0,0 +1,41 @@
+import time
+import dgl
+import torch
+import numpy as np
+
+from .. import utils
+
+
+@utils.skip_if_cpu()
+@utils.benchmark('throughput', timeout=600)
+@utils.parametrize('avg_degree', [10, 50])
+@utils.parametrize('num_seed_nodes', [1024, 8192])
+@utils.parametrize('fanout', [5, 20])
+@utils.parametrize('op', ['to_block', 'compact_graphs'])
+def track_throughput(avg_degree, num_seed_nodes, fanout, op):
+    device = utils.get_bench_device()
+    graph = utils.get_powerlaw_graph(1000000, avg_degree).formats('csc').to(device)
+
+    subg_list = []
+    for i in range(10):
+        seed_nodes = torch.randint(0, graph.num_nodes(), (num_seed_nodes,), device=device)
+        subg_list.append((dgl.sampling.sample_neighbors(graph, seed_nodes, fanout), seed_nodes))
+
+    if op == 'to_block':
+        def run(subg, seed_nodes):
+            return dgl.to_block(subg, seed_nodes)
+    else:
+        def run(subg, seed_nodes):
+            return dgl.compact_graphs(subg, always_preserve=seed_nodes)
+
+    # dry run
+    run(*subg_list[0])
+
+    # timing
+    num_edges = 0
+    with utils.Timer(device) as t:
+        for i in range(10):
+            run(*subg_list[i])
+            num_edges += subg_list[i][0].num_edges()
+
+    return num_edges / t.elapsed_secs
@@ -0,0 +1,87 @@
+from datetime import timedelta
+import dgl
+import numpy as np
+import torch as th
+import torch.multiprocessing as mp
+from dgl.cuda import nccl
+from dgl.partition import NDArrayPartition
+
+from .. import utils
+
+
+def run(result_queue, proc_id, n_gpus, graph, feat_size, fanout, max_num_requests):
+    dev_id = proc_id
+    th.cuda.set_device(dev_id)
+    th.distributed.init_process_group(backend="nccl",
+                                      init_method='tcp://127.0.0.1:12345',
+                                      world_size=n_gpus,
+                                      rank=proc_id)
+    store = th.distributed.TCPStore(
+        '127.0.0.1', 12347, n_gpus, proc_id == 0, timedelta(seconds=10*60))
+    if proc_id == 0:
+        nccl_id = nccl.UniqueId()
+        store.set('nccl_root_id_bench', str(nccl_id))
+    else:
+        nccl_id = nccl.UniqueId(store.get('nccl_root_id_bench'))
+    comm = nccl.Communicator(n_gpus, proc_id, nccl_id)
+
+    # every GPU owns the features of the nodes of its remainder
+    part = NDArrayPartition(graph.num_nodes(), n_gpus, mode='remainder')
+    num_local = (graph.num_nodes() - proc_id + n_gpus - 1) // n_gpus
+    local_feats = th.randn(num_local, feat_size, device=dev_id)
+    graph = graph.to(dev_id)
+
+    # the features of the sources of the sampled edges are pulled
+    requests = []
+    for i in range(10):
+        seed_nodes = th.randint(0, graph.num_nodes(), (1000,), device=dev_id)
+        frontier = dgl.sampling.sample_neighbors(graph, seed_nodes, fanout)
+        requests.append(frontier.edges()[0][:max_num_requests])
+
+    def pull(req_idx):
+        if max_num_requests is None:
+            return comm.sparse_all_to_all_pull(req_idx, local_feats, part)
+        return comm.sparse_all_to_all_pull(
+            req_idx, local_feats, part, max_num_requests=max_num_requests)
+
+    # dry run
+    pull(requests[0])
+    th.distributed.barrier()
+
+    # timing
+    num_edges = 0
+    with utils.Timer('cuda:0') as t:
+        for i in range(10):
+            pull(requests[i])
+            num_edges += len(requests[i])
+
+    num_edges = th.tensor([num_edges / t.elapsed_secs], device=dev_id)
+    # the throughput of all the GPUs
+    th.distributed.all_reduce(num_edges)
+    if proc_id == 0:
+        result_queue.put(num_edges.item())
+
+
+@utils.benchmark('throughput', timeout=600)
+@utils.skip_if_not_4gpu()
+@utils.parametrize('avg_degree', [10, 50])
+@utils.parametrize('feat_size', [16, 128])
+@utils.parametrize('fanout', [5, 25])
+@utils.parametrize('fixed', [False, True])
+def track_throughput(avg_degree, feat_size, fanout, fixed):
+    n_gpus = 4
+    graph = utils.get_powerlaw_graph(1000000, avg_degree).formats('csc')
+    # the largest number of requests, when exchanged in fixed blocks
+    max_num_requests = 1000 * fanout if fixed else None
+
+    result_queue = mp.Queue()
+    procs = []
+    for proc_id in range(n_gpus):
+        p = mp.Process(target=utils.thread_wrapped_func(run),
+                       args=(result_queue, proc_id, n_gpus, graph, feat_size, fanout,
+                             max_num_requests))
+        p.start()
+        procs.append(p)
+    for p in procs:
+        p.join()
+    return result_queue.get(block=False)
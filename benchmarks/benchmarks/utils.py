@@ -110,6 +110,49 @@ def get_graph(name, format = None):
     return g
 
 
+def get_powerlaw_graph(num_nodes, avg_degree, alpha=2.5, bipartite=False):
+    """Create a synthetic graph whose in-degrees follow a power law.
+
+    The in-degrees are drawn from a Pareto distribution of exponent ``alpha``,
+    scaled to ``avg_degree`` on average, and the source of every edge is drawn
+    uniformly. The graph is cached under /tmp/dataset/powerlaw.
+
+    Parameters
+    ----------
+    num_nodes : int
+        The number of nodes, of every node type if bipartite.
+    avg_degree : int
+        The average in-degree.
+    alpha : float
+        The exponent of the power law. The smaller, the more skewed the degrees.
+    bipartite : bool
+        If True, return a bidirectional graph between the node types 'user' and
+        'item', with the edge types 'clicks' and 'clicked-by', as PinSAGE expects.
+    """
+    name = "powerlaw_{}_{}_{}{}".format(
+        num_nodes, avg_degree, alpha, "_bipartite" if bipartite else "")
+    bin_path = "/tmp/dataset/powerlaw/{}.bin".format(name)
+    if os.path.exists(bin_path):
+        g_list, _ = dgl.load_graphs(bin_path)
+        return g_list[0]
+    rng = np.random.default_rng(42)
+    degrees = rng.pareto(alpha - 1, num_nodes) + 1
+    degrees = np.minimum(np.round(degrees * avg_degree / degrees.mean()), num_nodes)
+    dst = np.repeat(np.arange(num_nodes), degrees.astype(np.int64))
+    src = rng.integers(0, num_nodes, len(dst))
+    src, dst = torch.from_numpy(src), torch.from_numpy(dst)
+    if bipartite:
+        g = dgl.heterograph({
+            ('user', 'clicks', 'item'): (src, dst),
+            ('item', 'clicked-by', 'user'): (dst, src)},
+            {'user': num_nodes, 'item': num_nodes})
+    else:
+        g = dgl.graph((src, dst), num_nodes=num_nodes)
+    os.makedirs(os.path.dirname(bin_path), exist_ok=True)
+    dgl.save_graphs(bin_path, [g])
+    return g
+
+
 def get_ogb_graph(name):
     os.symlink('/tmp/dataset/', os.path.join(os.getcwd(), 'dataset'))
     data = DglNodePropPredDataset(name=name)
@@ -347,16 +390,24 @@ def setup_track_flops(*args, **kwargs):
     torch.random.manual_seed(42)
 
 
+def setup_track_throughput(*args, **kwargs):
+    # fix random seed
+    np.random.seed(42)
+    torch.random.manual_seed(42)
+
+
 TRACK_UNITS = {
     'time': 's',
     'acc': '%',
     'flops': 'GFLOPS',
+    'throughput': 'edges/s',
 }
 
 TRACK_SETUP = {
     'time': setup_track_time,
     'acc': setup_track_acc,
     'flops': setup_track_flops,
+    'throughput': setup_track_throughput,
 }
 
 
@@ -489,6 +540,18 @@ def skip_if_gpu():
         return func
     return _wrapper
 
+def skip_if_cpu():
+    """skip if DGL_BENCH_DEVICE is cpu
+    """
+    device = os.environ.get('DGL_BENCH_DEVICE', 'cpu')
+
+    def _wrapper(func):
+        if device == "cpu":
+            # skip if not enabled
+            func.benchmark_name = "skip_" + func.__name__
+        return func
+    return _wrapper
+
 def _cuda_device_count(q):
     import torch
     q.put(torch.cuda.device_count())
@@ -527,6 +590,7 @@ def benchmark(track_type, timeout=60):
             - 'time' : For timing. Unit: second.
             - 'acc' : For accuracy. Unit: percentage, value between 0 and 100.
             - 'flops' : Unit: GFlops, number of floating point operations per second.
+            - 'throughput' : Unit: edges per second, e.g. sampled or gathered.
     timeout : int
         Timeout threshold in second.
 
@@ -538,7 +602,7 @@ def benchmark(track_type, timeout=60):
         def foo():
             pass
     """
-    assert track_type in ['time', 'acc', 'flops']
+    assert track_type in ['time', 'acc', 'flops', 'throughput']
 
     def _wrapper(func):
         func.unit = TRACK_UNITS[track_type]
@@ -0,0 +1,98 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file bench_common.h
+ * \brief Synthetic inputs of the C++ micro-benchmarks.
+ */
+#ifndef BENCH_COMMON_H_
+#define BENCH_COMMON_H_
+
+#include <benchmark/benchmark.h>
+#include <dgl/array.h>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace dgl {
+namespace bench {
+
+static constexpr DLContext kCPU = DLContext{kDLCPU, 0};
+
+/*!
+ * \brief A square CSR matrix whose row degrees follow a power law, like the
+ *        degrees of most real graphs.
+ *
+ * Row i has avg_degree * w_i / mean(w) nonzeros, at least one, where the
+ * weights w_i = (k_i + 1)^-alpha are shuffled over the rows. The columns are
+ * uniform, and sorted within each row.
+ */
+inline aten::CSRMatrix PowerLawCSR(int64_t num_rows, int64_t avg_degree,
+                                   double alpha = 0.8, uint64_t seed = 42) {
+  std::mt19937_64 gen(seed);
+  std::vector<double> weights(num_rows);
+  double sum = 0;
+  for (int64_t i = 0; i < num_rows; ++i) {
+    weights[i] = std::pow(i + 1, -alpha);
+    sum += weights[i];
+  }
+  std::shuffle(weights.begin(), weights.end(), gen);
+  std::vector<int64_t> indptr(num_rows + 1, 0);
+  for (int64_t i = 0; i < num_rows; ++i) {
+    const int64_t degree = std::llround(weights[i] * avg_degree * num_rows / sum);
+    indptr[i + 1] = indptr[i] + std::min(num_rows, std::max<int64_t>(degree, 1));
+  }
+  std::vector<int64_t> indices(indptr.back());
+  std::uniform_int_distribution<int64_t> dist(0, num_rows - 1);
+  for (int64_t i = 0; i < num_rows; ++i) {
+    for (int64_t j = indptr[i]; j < indptr[i + 1]; ++j)
+      indices[j] = dist(gen);
+    std::sort(indices.begin() + indptr[i], indices.begin() + indptr[i + 1]);
+  }
+  return aten::CSRMatrix(num_rows, num_rows, aten::VecToIdArray(indptr),
+                         aten::VecToIdArray(indices), aten::NullArray(), true);
+}
+
+/*! \brief PowerLawCSR, generated once per size for all the benchmarks. */
+inline const aten::CSRMatrix& CachedPowerLawCSR(int64_t num_rows, int64_t avg_degree) {
+  static std::map<std::pair<int64_t, int64_t>, aten::CSRMatrix> cache;
+  auto it = cache.find({num_rows, avg_degree});
+  if (it == cache.end())
+    it = cache.emplace(std::make_pair(num_rows, avg_degree),
+                       PowerLawCSR(num_rows, avg_degree)).first;
+  return it->second;
+}
+
+/*! \brief A float32 matrix of uniform values in [0, 1). */
+inline NDArray RandomFeatures(int64_t num_rows, int64_t dim, uint64_t seed = 42) {
+  NDArray ret = NDArray::Empty({num_rows, dim}, DLDataType{kDLFloat, 32, 1}, kCPU);
+  std::mt19937_64 gen(seed);
+  std::uniform_real_distribution<float> dist(0, 1);
+  float* data = ret.Ptr<float>();
+  for (int64_t i = 0; i < num_rows * dim; ++i)
+    data[i] = dist(gen);
+  return ret;
+}
+
+/*! \brief Distinct random rows, e.g. the seeds of a minibatch. */
+inline IdArray RandomRows(int64_t num_rows, int64_t num, uint64_t seed = 42) {
+  std::vector<int64_t> rows(num_rows);
+  for (int64_t i = 0; i < num_rows; ++i)
+    rows[i] = i;
+  std::mt19937_64 gen(seed);
+  std::shuffle(rows.begin(), rows.end(), gen);
+  rows.resize(std::min(num, num_rows));
+  return aten::VecToIdArray(rows);
+}
+
+/*! \brief Report the throughput of a benchmark in edges per second. */
+inline void SetEdgesPerSecond(benchmark::State& state, int64_t num_edges) {
+  state.counters["edges/s"] = benchmark::Counter(
+      static_cast<double>(num_edges), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+}  // namespace bench
+}  // namespace dgl
+
+#endif  // BENCH_COMMON_H_
@@ -0,0 +1,69 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file bench_graph.cc
+ * \brief Micro-benchmarks of the graph transforms of the sampling pipeline.
+ */
+#include <dgl/base_heterograph.h>
+#include <dgl/immutable_graph.h>
+#include <dgl/sampling/randomwalks.h>
+#include <tuple>
+#include <vector>
+#include "../../src/graph/transform/to_bipartite.h"
+#include "./bench_common.h"
+
+using namespace dgl;
+using namespace dgl::runtime;
+
+namespace {
+
+/*! \brief A heterograph of one node type and one edge type. */
+HeteroGraphPtr MakeHeteroGraph(const aten::COOMatrix& coo) {
+  const GraphPtr meta_graph = ImmutableGraph::CreateFromCOO(
+      1, aten::VecToIdArray(std::vector<int64_t>({0})),
+      aten::VecToIdArray(std::vector<int64_t>({0})));
+  return CreateHeteroGraph(meta_graph, {CreateFromCOO(1, coo)}, {coo.num_rows});
+}
+
+/*!
+ * \brief Compact the frontier of 10 in-neighbors of range(1) seeds, out of
+ *        range(0) nodes, into a block.
+ */
+void BM_ToBlock(benchmark::State& state) {
+  // the rows are the destination nodes
+  const aten::CSRMatrix& csc = bench::CachedPowerLawCSR(state.range(0), 16);
+  const IdArray seeds = bench::RandomRows(csc.num_rows, state.range(1));
+  const aten::COOMatrix sampled = aten::CSRRowWiseSampling(csc, seeds, 10, FloatArray(), false);
+  const HeteroGraphPtr frontier = MakeHeteroGraph(
+      aten::COOMatrix(csc.num_rows, csc.num_rows, sampled.col, sampled.row));
+  for (auto _ : state) {
+    std::vector<IdArray> lhs_nodes;
+    const auto ret = transform::ToBlock<kDLCPU, int64_t>(frontier, {seeds}, true, &lhs_nodes);
+    benchmark::DoNotOptimize(std::get<0>(ret).get());
+  }
+  bench::SetEdgesPerSecond(state, sampled.row->shape[0]);
+}
+
+/*! \brief Walk range(1) steps from range(2) seeds, out of range(0) nodes. */
+void BM_RandomWalk(benchmark::State& state) {
+  const aten::CSRMatrix& csr = bench::CachedPowerLawCSR(state.range(0), 16);
+  const HeteroGraphPtr graph = MakeHeteroGraph(aten::CSRToCOO(csr, false));
+  const int64_t length = state.range(1);
+  const IdArray seeds = bench::RandomRows(csr.num_rows, state.range(2));
+  const TypeArray metapath = aten::Full(0, length, 64, bench::kCPU);
+  const std::vector<FloatArray> prob = {
+    aten::NullArray(DLDataType{kDLFloat, 32, 1}, bench::kCPU)};
+  const std::vector<FloatArray> alias_accept = {aten::NullArray()};
+  const std::vector<IdArray> alias = {aten::NullArray()};
+  for (auto _ : state) {
+    const auto ret = sampling::RandomWalk(graph, seeds, metapath, prob, alias_accept, alias, 42);
+    benchmark::DoNotOptimize(std::get<0>(ret)->data);
+  }
+  // the edges are the steps of the walks
+  bench::SetEdgesPerSecond(state, length * seeds->shape[0]);
+}
+
+}  // namespace
+
+BENCHMARK(BM_ToBlock)->Args({1 << 20, 1024})->Args({1 << 20, 8192})->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_RandomWalk)->Args({1 << 20, 8, 1 << 14})->Args({1 << 20, 80, 1 << 14})
+  ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,89 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file bench_kernel.cc
+ * \brief Micro-benchmarks of the SpMM and SDDMM kernels per op and format.
+ */
+#include <dgl/base_heterograph.h>
+#include <dgl/kernel.h>
+#include <string>
+#include <vector>
+#include "./bench_common.h"
+
+using namespace dgl;
+using namespace dgl::runtime;
+
+namespace {
+
+/*! \brief The bipartite graph of the power-law matrix, in a single format. */
+HeteroGraphPtr MakeGraph(int64_t num_nodes, dgl_format_code_t format) {
+  // the rows are the destination nodes, whose in-degrees follow the power law
+  const aten::CSRMatrix& csc = bench::CachedPowerLawCSR(num_nodes, 16);
+  if (format == COO_CODE) {
+    const aten::COOMatrix coo = aten::CSRToCOO(csc, false);
+    return CreateFromCOO(2, aten::COOMatrix(num_nodes, num_nodes, coo.col, coo.row),
+                         COO_CODE);
+  } else if (format == CSR_CODE) {
+    return CreateFromCSR(2, aten::CSRTranspose(csc), CSR_CODE);
+  }
+  return CreateFromCSC(2, csc, CSC_CODE);
+}
+
+/*!
+ * \brief SpMM of a node feature of dimension range(1), and an edge feature of
+ *        the same dimension if the op uses it, over range(0) nodes.
+ */
+void BM_SpMM(benchmark::State& state, const std::string& op, const std::string& reduce,
+             dgl_format_code_t format) {
+  const int64_t num_nodes = state.range(0);
+  const int64_t dim = state.range(1);
+  HeteroGraphPtr graph = MakeGraph(num_nodes, format);
+  const int64_t num_edges = graph->NumEdges(0);
+  NDArray ufeat = bench::RandomFeatures(num_nodes, dim);
+  NDArray efeat = op == "copy_lhs" ? aten::NullArray() : bench::RandomFeatures(num_edges, dim);
+  NDArray out = NDArray::Empty({num_nodes, dim}, ufeat->dtype, bench::kCPU);
+  std::vector<NDArray> out_aux = {aten::NullArray(), aten::NullArray()};
+  if (reduce == "max") {
+    out_aux[0] = NDArray::Empty({num_nodes, dim}, DLDataType{kDLInt, 64, 1}, bench::kCPU);
+    if (op != "copy_lhs")
+      out_aux[1] = NDArray::Empty({num_nodes, dim}, DLDataType{kDLInt, 64, 1}, bench::kCPU);
+  }
+  for (auto _ : state) {
+    aten::SpMM(op, reduce, graph, ufeat, efeat, out, out_aux);
+    benchmark::ClobberMemory();
+  }
+  bench::SetEdgesPerSecond(state, num_edges);
+}
+
+/*! \brief SDDMM of the source and destination features of dimension range(1). */
+void BM_SDDMM(benchmark::State& state, const std::string& op, dgl_format_code_t format) {
+  const int64_t num_nodes = state.range(0);
+  const int64_t dim = state.range(1);
+  HeteroGraphPtr graph = MakeGraph(num_nodes, format);
+  const int64_t num_edges = graph->NumEdges(0);
+  NDArray lhs = bench::RandomFeatures(num_nodes, dim, 1);
+  NDArray rhs = bench::RandomFeatures(num_nodes, dim, 2);
+  NDArray out = NDArray::Empty({num_edges, op == "dot" ? 1 : dim}, lhs->dtype, bench::kCPU);
+  for (auto _ : state) {
+    aten::SDDMM(op, graph, lhs, rhs, out, 0, 2);
+    benchmark::ClobberMemory();
+  }
+  bench::SetEdgesPerSecond(state, num_edges);
+}
+
+void KernelArgs(benchmark::internal::Benchmark* b) {
+  b->Args({1 << 16, 16})->Args({1 << 16, 128})->Unit(benchmark::kMillisecond);
+}
+
+}  // namespace
+
+BENCHMARK_CAPTURE(BM_SpMM, copy_lhs_sum_csc, "copy_lhs", "sum", CSC_CODE)->Apply(KernelArgs);
+BENCHMARK_CAPTURE(BM_SpMM, copy_lhs_sum_coo, "copy_lhs", "sum", COO_CODE)->Apply(KernelArgs);
+BENCHMARK_CAPTURE(BM_SpMM, copy_lhs_max_csc, "copy_lhs", "max", CSC_CODE)->Apply(KernelArgs);
+BENCHMARK_CAPTURE(BM_SpMM, copy_lhs_max_coo, "copy_lhs", "max", COO_CODE)->Apply(KernelArgs);
+BENCHMARK_CAPTURE(BM_SpMM, mul_sum_csc, "mul", "sum", CSC_CODE)->Apply(KernelArgs);
+BENCHMARK_CAPTURE(BM_SpMM, mul_sum_coo, "mul", "sum", COO_CODE)->Apply(KernelArgs);
+
+BENCHMARK_CAPTURE(BM_SDDMM, dot_csr, "dot", CSR_CODE)->Apply(KernelArgs);
+BENCHMARK_CAPTURE(BM_SDDMM, dot_coo, "dot", COO_CODE)->Apply(KernelArgs);
+BENCHMARK_CAPTURE(BM_SDDMM, add_csr, "add", CSR_CODE)->Apply(KernelArgs);
+BENCHMARK_CAPTURE(BM_SDDMM, add_coo, "add", COO_CODE)->Apply(KernelArgs);
@@ -0,0 +1,8 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file bench_main.cc
+ * \brief The entry of the C++ micro-benchmarks.
+ */
+#include <benchmark/benchmark.h>
+
+BENCHMARK_MAIN();
@@ -0,0 +1,83 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file bench_sparse.cc
+ * \brief Micro-benchmarks of the sampling, conversion and id mapping of the
+ *        sparse matrices.
+ */
+#include <dgl/array.h>
+#include "../../src/array/cpu/array_utils.h"
+#include "../../src/array/cpu/concurrent_id_hash_map.h"
+#include "./bench_common.h"
+
+using namespace dgl;
+using namespace dgl::runtime;
+
+namespace {
+
+/*! \brief Sample range(2) neighbors of range(1) seeds out of range(0) nodes. */
+void BM_CSRRowWiseSampling(benchmark::State& state) {
+  const aten::CSRMatrix& csr = bench::CachedPowerLawCSR(state.range(0), 16);
+  const IdArray rows = bench::RandomRows(csr.num_rows, state.range(1));
+  int64_t num_sampled = 0;
+  for (auto _ : state) {
+    const aten::COOMatrix sampled = aten::CSRRowWiseSampling(
+        csr, rows, state.range(2), FloatArray(), false);
+    num_sampled = sampled.row->shape[0];
+    benchmark::DoNotOptimize(sampled.row->data);
+  }
+  bench::SetEdgesPerSecond(state, num_sampled);
+}
+
+/*! \brief Convert a COO matrix with shuffled entries to CSR. */
+void BM_COOToCSR(benchmark::State& state) {
+  const aten::CSRMatrix& csr = bench::CachedPowerLawCSR(state.range(0), 16);
+  const aten::COOMatrix sorted = aten::CSRToCOO(csr, false);
+  const int64_t num_edges = sorted.row->shape[0];
+  const IdArray perm = bench::RandomRows(num_edges, num_edges);
+  const aten::COOMatrix coo(csr.num_rows, csr.num_cols,
+                            aten::IndexSelect(sorted.row, perm),
+                            aten::IndexSelect(sorted.col, perm));
+  for (auto _ : state) {
+    const aten::CSRMatrix ret = aten::COOToCSR(coo);
+    benchmark::DoNotOptimize(ret.indices->data);
+  }
+  bench::SetEdgesPerSecond(state, num_edges);
+}
+
+void BM_CSRTranspose(benchmark::State& state) {
+  const aten::CSRMatrix& csr = bench::CachedPowerLawCSR(state.range(0), 16);
+  for (auto _ : state) {
+    const aten::CSRMatrix ret = aten::CSRTranspose(csr);
+    benchmark::DoNotOptimize(ret.indices->data);
+  }
+  bench::SetEdgesPerSecond(state, csr.indices->shape[0]);
+}
+
+/*!
+ * \brief Relabel the neighbors of range(1) seeds, out of range(0) nodes, like
+ *        the compaction of a sampled block, with the map of template type.
+ */
+template <typename Map>
+void BM_IdHashMap(benchmark::State& state) {
+  const aten::CSRMatrix& csr = bench::CachedPowerLawCSR(state.range(0), 16);
+  const IdArray rows = bench::RandomRows(csr.num_rows, state.range(1));
+  const IdArray ids = aten::CSRRowWiseSampling(csr, rows, 10, FloatArray(), false).col;
+  for (auto _ : state) {
+    Map map(rows);
+    map.Update(ids);
+    benchmark::DoNotOptimize(map.Size());
+  }
+  bench::SetEdgesPerSecond(state, ids->shape[0]);
+}
+
+}  // namespace
+
+BENCHMARK(BM_CSRRowWiseSampling)
+  ->Args({1 << 20, 1024, 10})->Args({1 << 20, 8192, 10})->Args({1 << 20, 8192, 25})
+  ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_COOToCSR)->Arg(1 << 16)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CSRTranspose)->Arg(1 << 16)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_IdHashMap, aten::IdHashMap<int64_t>)
+  ->Args({1 << 20, 1024})->Args({1 << 20, 8192})->Unit(benchmark::kMicrosecond);
+BENCHMARK_TEMPLATE(BM_IdHashMap, aten::ConcurrentIdHashMap<int64_t>)
+  ->Args({1 << 20, 1024})->Args({1 << 20, 8192})->Unit(benchmark::kMicrosecond);
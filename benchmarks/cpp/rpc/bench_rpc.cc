@@ -0,0 +1,606 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file rpc/bench_rpc.cc
+ * \brief A benchmark of the RPC layer alone: the throughput and the latency of
+ *        the pull and sample requests of clients to servers, over the socket or
+ *        the tensorpipe communicator.
+ *
+ * A pull request carries the IDs of the rows to pull, and its response the rows
+ * gathered from the feature table of the server, like FastPull. A sample request
+ * carries seed nodes, and its response fanout edges per seed. The clients keep
+ * a number of requests in flight, spread over the servers in turn.
+ *
+ * On one host, the servers and the clients run as threads of one process, once
+ * for every number of clients:
+ *
+ *   ./rpcBenchmark --backend=socket --num_servers=2 --num_clients=1,4,16
+ *
+ * Across hosts, one process per server and as many client processes as wanted,
+ * the servers waiting for all the clients:
+ *
+ *   ./rpcBenchmark --role=server --addr=10.0.0.1:50000 --num_clients=8
+ *   ./rpcBenchmark --role=client --servers=10.0.0.1:50000 --addr=10.0.0.2:51000 \
+ *       --num_clients=4 --client_offset=0
+ *   ./rpcBenchmark --role=client --servers=10.0.0.1:50000 --addr=10.0.0.3:51000 \
+ *       --num_clients=4 --client_offset=4
+ *
+ * The clients of a process receive their responses on the ports following the
+ * one of --addr. See Usage() for the other options.
+ */
+#include <dgl/runtime/ndarray.h>
+#include <dmlc/logging.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../../../src/rpc/network/socket_communicator.h"
+#include "../../../src/rpc/rpc.h"
+
+using namespace dgl;
+using namespace dgl::runtime;
+
+namespace {
+
+constexpr int64_t kQueueSize = 1LL << 30;
+constexpr DLContext kCPU = DLContext{kDLCPU, 0};
+constexpr DLDataType kInt64 = DLDataType{kDLInt, 64, 1};
+constexpr DLDataType kFloat32 = DLDataType{kDLFloat, 32, 1};
+
+struct Options {
+  /*! \brief local, server or client. */
+  std::string role = "local";
+  /*! \brief socket or tensorpipe. */
+  std::string backend = "socket";
+  /*! \brief The address of the server, or of the first client of the process. */
+  std::string addr = "127.0.0.1:50000";
+  /*! \brief The addresses of the servers of the clients. */
+  std::vector<std::string> servers;
+  /*! \brief The numbers of clients of the runs. */
+  std::vector<int64_t> num_clients = {1};
+  int64_t client_offset = 0;
+  int64_t num_servers = 1;
+  /*! \brief The number of requests of every client. */
+  int64_t num_requests = 10000;
+  /*! \brief The number of requests of every client in flight. */
+  int64_t inflight = 1;
+  /*! \brief The weights of the pull and sample requests. */
+  double pull_weight = 1;
+  double sample_weight = 0;
+  /*! \brief The rows of a pull request, or the seeds of a sample request. */
+  int64_t rows = 1000;
+  /*! \brief The row widths of the pull requests, drawn in turn. */
+  std::vector<int64_t> widths = {128};
+  int64_t fanout = 10;
+  /*! \brief The number of rows of the feature table of every server. */
+  int64_t table_rows = 100000;
+};
+
+void Usage() {
+  std::printf(
+    "Options, as --name=value:\n"
+    "  role           local (default), server or client\n"
+    "  backend        socket (default) or tensorpipe\n"
+    "  addr           ip:port of the server, or of the first client of the process\n"
+    "  servers        ip:port,... of the servers, for the clients\n"
+    "  num_clients    the numbers of clients of the runs in local mode, e.g. 1,4,16,\n"
+    "                 of all the clients for a server, of the clients of the process\n"
+    "  client_offset  the ID of the first client of the process\n"
+    "  num_servers    the number of servers in local mode\n"
+    "  num_requests   the number of requests of every client\n"
+    "  inflight       the number of requests of every client in flight\n"
+    "  mix            the weights of the requests, e.g. pull:4,sample:1\n"
+    "  rows           the rows of a pull or the seeds of a sample request\n"
+    "  widths         the row widths of the pulls, e.g. 16,128,512\n"
+    "  fanout         the edges per seed of the sample responses\n"
+    "  table_rows     the rows of the feature table of every server\n");
+}
+
+std::vector<std::string> Split(const std::string& str, char sep) {
+  std::vector<std::string> ret;
+  std::stringstream ss(str);
+  std::string item;
+  while (std::getline(ss, item, sep)) {
+    if (!item.empty())
+      ret.push_back(item);
+  }
+  return ret;
+}
+
+std::vector<int64_t> SplitInts(const std::string& str) {
+  std::vector<int64_t> ret;
+  for (const std::string& item : Split(str, ','))
+    ret.push_back(std::stoll(item));
+  return ret;
+}
+
+Options ParseOptions(int argc, char** argv) {
+  Options opt;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--help") {
+      Usage();
+      std::exit(0);
+    }
+    const size_t eq = arg.find('=');
+    if (arg.compare(0, 2, "--") != 0 || eq == std::string::npos) {
+      Usage();
+      LOG(FATAL) << "Invalid argument " << arg << ".";
+    }
+    const std::string name = arg.substr(2, eq - 2);
+    const std::string value = arg.substr(eq + 1);
+    if (name == "role") {
+      opt.role = value;
+    } else if (name == "backend") {
+      opt.backend = value;
+    } else if (name == "addr") {
+      opt.addr = value;
+    } else if (name == "servers") {
+      opt.servers = Split(value, ',');
+    } else if (name == "num_clients") {
+      opt.num_clients = SplitInts(value);
+    } else if (name == "client_offset") {
+      opt.client_offset = std::stoll(value);
+    } else if (name == "num_servers") {
+      opt.num_servers = std::stoll(value);
+    } else if (name == "num_requests") {
+      opt.num_requests = std::stoll(value);
+    } else if (name == "inflight") {
+      opt.inflight = std::stoll(value);
+    } else if (name == "mix") {
+      opt.pull_weight = opt.sample_weight = 0;
+      for (const std::string& item : Split(value, ',')) {
+        const auto kv = Split(item, ':');
+        CHECK_EQ(kv.size(), 2) << "Invalid request mix " << value << ".";
+        CHECK(kv[0] == "pull" || kv[0] == "sample") << "Unknown request " << kv[0] << ".";
+        (kv[0] == "pull" ? opt.pull_weight : opt.sample_weight) = std::stod(kv[1]);
+      }
+    } else if (name == "rows") {
+      opt.rows = std::stoll(value);
+    } else if (name == "widths") {
+      opt.widths = SplitInts(value);
+    } else if (name == "fanout") {
+      opt.fanout = std::stoll(value);
+    } else if (name == "table_rows") {
+      opt.table_rows = std::stoll(value);
+    } else {
+      Usage();
+      LOG(FATAL) << "Unknown option " << name << ".";
+    }
+  }
+  CHECK(opt.role == "local" || opt.role == "server" || opt.role == "client")
+    << "Invalid role " << opt.role << ".";
+  CHECK(opt.backend == "socket" || opt.backend == "tensorpipe")
+    << "Invalid backend " << opt.backend << ".";
+  CHECK(!opt.num_clients.empty() && !opt.widths.empty());
+  CHECK_GT(opt.pull_weight + opt.sample_weight, 0) << "The request mix is empty.";
+  CHECK_GT(opt.inflight, 0);
+  CHECK_GT(opt.table_rows, 0);
+  if (opt.role == "client")
+    CHECK(!opt.servers.empty()) << "The clients need the addresses of the servers.";
+  return opt;
+}
+
+int64_t NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*! \brief The address ip:port+offset. */
+std::string OffsetAddr(const std::string& addr, int64_t offset) {
+  const size_t colon = addr.rfind(':');
+  CHECK_NE(colon, std::string::npos) << "Invalid address " << addr << ", e.g. 127.0.0.1:50000.";
+  return addr.substr(0, colon + 1) + std::to_string(std::stoll(addr.substr(colon + 1)) + offset);
+}
+
+enum RequestType : int32_t {
+  kPull = 0,
+  kSample = 1,
+  /*! \brief The first message of a client, with the address of its responses. */
+  kHello = 2,
+  /*! \brief The last message of a client. */
+  kStop = 3,
+};
+
+const char* const kRequestNames[] = {"pull", "sample"};
+
+struct Header {
+  int32_t type;
+  int32_t client;
+  int64_t seq;
+  int64_t rows;
+  int64_t width;
+};
+
+/*! \brief A request or a response. */
+struct Packet {
+  Header header;
+  /*! \brief The address of a hello message. */
+  std::string text;
+  NDArray payload;
+};
+
+/*! \brief The two ends of the communicators of a server or a client. */
+class Endpoint {
+ public:
+  virtual ~Endpoint() {}
+  /*! \brief Wait for num_senders to connect on addr. */
+  virtual void Listen(const std::string& addr, int num_senders) = 0;
+  virtual void AddPeer(const std::string& addr, int id) = 0;
+  /*! \brief Connect to the peers. */
+  virtual void Connect() = 0;
+  virtual void Send(const Packet& packet, int peer) = 0;
+  virtual Packet Recv() = 0;
+  virtual void Finalize() = 0;
+
+ protected:
+  /*! \brief The header and the text of a packet, as bytes. */
+  static std::string Prefix(const Packet& packet) {
+    std::string ret(reinterpret_cast<const char*>(&packet.header), sizeof(Header));
+    return ret + packet.text;
+  }
+
+  static void ParsePrefix(const char* data, int64_t size, Packet* packet) {
+    CHECK_GE(size, sizeof(Header)) << "Truncated message.";
+    std::memcpy(&packet->header, data, sizeof(Header));
+    packet->text.assign(data + sizeof(Header), size - sizeof(Header));
+  }
+};
+
+/*!
+ * \brief The socket communicator, the payload following the header and the text
+ *        in the messages.
+ */
+class SocketEndpoint : public Endpoint {
+ public:
+  SocketEndpoint() : sender_(kQueueSize, 0), receiver_(kQueueSize, 0) {}
+
+  void Listen(const std::string& addr, int num_senders) override {
+    CHECK(receiver_.Wait(("socket://" + addr).c_str(), num_senders))
+      << "Cannot listen on " << addr << ".";
+  }
+
+  void AddPeer(const std::string& addr, int id) override {
+    sender_.AddReceiver(("socket://" + addr).c_str(), id);
+  }
+
+  void Connect() override {
+    CHECK(sender_.Connect()) << "Cannot connect to the peers.";
+  }
+
+  void Send(const Packet& packet, int peer) override {
+    const std::string prefix = Prefix(packet);
+    // the length of the prefix, the prefix, the dtype and the payload
+    const int64_t payload_bytes = packet.payload.defined() ? packet.payload.GetSize() : 0;
+    const int64_t size = sizeof(int64_t) + prefix.size() + sizeof(DLDataType) + payload_bytes;
+    char* data = new char[size];
+    char* pos = data;
+    const int64_t prefix_size = prefix.size();
+    std::memcpy(pos, &prefix_size, sizeof(int64_t));
+    pos += sizeof(int64_t);
+    std::memcpy(pos, prefix.data(), prefix_size);
+    pos += prefix_size;
+    const DLDataType dtype = packet.payload.defined() ? packet.payload->dtype : kInt64;
+    std::memcpy(pos, &dtype, sizeof(DLDataType));
+    pos += sizeof(DLDataType);
+    if (payload_bytes > 0)
+      std::memcpy(pos, packet.payload->data, payload_bytes);
+    network::Message msg(data, size);
+    msg.deallocator = network::DefaultMessageDeleter;
+    CHECK_EQ(sender_.Send(msg, peer), ADD_SUCCESS);
+  }
+
+  Packet Recv() override {
+    network::Message msg;
+    int send_id;
+    CHECK_EQ(receiver_.Recv(&msg, &send_id), REMOVE_SUCCESS);
+    Packet packet;
+    const char* pos = msg.data;
+    int64_t prefix_size;
+    std::memcpy(&prefix_size, pos, sizeof(int64_t));
+    pos += sizeof(int64_t);
+    ParsePrefix(pos, prefix_size, &packet);
+    pos += prefix_size;
+    DLDataType dtype;
+    std::memcpy(&dtype, pos, sizeof(DLDataType));
+    pos += sizeof(DLDataType);
+    const int64_t payload_bytes = msg.size - (pos - msg.data);
+    const int64_t elem_bytes = dtype.bits / 8;
+    packet.payload = NDArray::Empty({payload_bytes / elem_bytes}, dtype, kCPU);
+    std::memcpy(packet.payload->data, pos, payload_bytes);
+    msg.deallocator(&msg);
+    return packet;
+  }
+
+  void Finalize() override {
+    sender_.Finalize();
+    receiver_.Finalize();
+  }
+
+ private:
+  network::SocketSender sender_;
+  network::SocketReceiver receiver_;
+};
+
+/*! \brief The tensorpipe communicator, the payload being the tensor of the messages. */
+class TPEndpoint : public Endpoint {
+ public:
+  TPEndpoint() : sender_(Context()), receiver_(Context(), kQueueSize) {}
+
+  void Listen(const std::string& addr, int num_senders) override {
+    CHECK(receiver_.Wait("tcp://" + addr, num_senders)) << "Cannot listen on " << addr << ".";
+  }
+
+  void AddPeer(const std::string& addr, int id) override {
+    sender_.AddReceiver("tcp://" + addr, id);
+  }
+
+  void Connect() override {
+    CHECK(sender_.Connect()) << "Cannot connect to the peers.";
+  }
+
+  void Send(const Packet& packet, int peer) override {
+    rpc::RPCMessage msg;
+    msg.service_id = packet.header.type;
+    msg.msg_seq = packet.header.seq;
+    msg.client_id = packet.header.client;
+    msg.server_id = peer;
+    msg.data = Prefix(packet);
+    if (packet.payload.defined())
+      msg.tensors.push_back(packet.payload);
+    sender_.Send(msg, peer);
+  }
+
+  Packet Recv() override {
+    rpc::RPCMessage msg;
+    receiver_.Recv(&msg);
+    Packet packet;
+    ParsePrefix(msg.data.data(), msg.data.size(), &packet);
+    if (!msg.tensors.empty())
+      packet.payload = msg.tensors[0];
+    return packet;
+  }
+
+  void Finalize() override {
+    sender_.Finalize();
+    receiver_.Finalize();
+  }
+
+ private:
+  static std::shared_ptr<tensorpipe::Context> Context() {
+    rpc::InitGlobalTpContext();
+    return rpc::RPCContext::getInstance()->ctx;
+  }
+
+  rpc::TPSender sender_;
+  rpc::TPReceiver receiver_;
+};
+
+std::unique_ptr<Endpoint> CreateEndpoint(const Options& opt) {
+  if (opt.backend == "socket")
+    return std::unique_ptr<Endpoint>(new SocketEndpoint());
+  return std::unique_ptr<Endpoint>(new TPEndpoint());
+}
+
+/*!
+ * \brief Serve the requests of num_clients clients until they stop: gather the
+ *        rows of a table of floats of the largest width for the pulls, and make
+ *        up fanout edges per seed for the samples.
+ */
+void RunServer(const Options& opt, const std::string& addr, int num_clients) {
+  const int64_t max_width = *std::max_element(opt.widths.begin(), opt.widths.end());
+  NDArray table = NDArray::Empty({opt.table_rows, max_width}, kFloat32, kCPU);
+  float* table_data = table.Ptr<float>();
+  for (int64_t i = 0; i < opt.table_rows * max_width; ++i)
+    table_data[i] = static_cast<float>(i % 1000);
+
+  std::unique_ptr<Endpoint> endpoint = CreateEndpoint(opt);
+  endpoint->Listen(addr, num_clients);
+  // the clients say where to send their responses
+  for (int i = 0; i < num_clients; ++i) {
+    const Packet hello = endpoint->Recv();
+    CHECK_EQ(hello.header.type, kHello) << "Expected the hello message of a client.";
+    endpoint->AddPeer(hello.text, hello.header.client);
+  }
+  endpoint->Connect();
+
+  for (int num_stopped = 0; num_stopped < num_clients;) {
+    const Packet request = endpoint->Recv();
+    const Header& header = request.header;
+    if (header.type == kStop) {
+      ++num_stopped;
+      continue;
+    }
+    const int64_t* ids = request.payload.Ptr<int64_t>();
+    Packet response;
+    response.header = header;
+    if (header.type == kPull) {
+      response.payload = NDArray::Empty({header.rows, header.width}, kFloat32, kCPU);
+      float* out = response.payload.Ptr<float>();
+      for (int64_t i = 0; i < header.rows; ++i) {
+        std::memcpy(out + i * header.width, table_data + ids[i] * max_width,
+                    header.width * sizeof(float));
+      }
+    } else {
+      CHECK_EQ(header.type, kSample) << "Unknown request " << header.type << ".";
+      response.payload = NDArray::Empty({2, header.rows * opt.fanout}, kInt64, kCPU);
+      int64_t* src = response.payload.Ptr<int64_t>();
+      int64_t* dst = src + header.rows * opt.fanout;
+      for (int64_t i = 0; i < header.rows; ++i) {
+        for (int64_t j = 0; j < opt.fanout; ++j) {
+          src[i * opt.fanout + j] = (ids[i] * 31 + j * 7919) % opt.table_rows;
+          dst[i * opt.fanout + j] = ids[i];
+        }
+      }
+    }
+    endpoint->Send(response, header.client);
+  }
+  endpoint->Finalize();
+}
+
+/*! \brief The measures of a client. */
+struct ClientResult {
+  /*! \brief The latencies of the requests by type. */
+  std::vector<int64_t> latency_ns[2];
+  /*! \brief The bytes of the responses by type. */
+  int64_t bytes[2] = {0, 0};
+  int64_t start_ns = 0;
+  int64_t end_ns = 0;
+};
+
+/*! \brief Send the requests of a client to the servers in turn, and wait for their responses. */
+void RunClient(const Options& opt, int client, const std::string& addr,
+               const std::vector<std::string>& servers, ClientResult* result) {
+  std::unique_ptr<Endpoint> endpoint = CreateEndpoint(opt);
+  const int num_servers = servers.size();
+  // the servers connect back once they have the hello messages of all the clients
+  std::thread listener([&] { endpoint->Listen(addr, num_servers); });
+  for (int s = 0; s < num_servers; ++s)
+    endpoint->AddPeer(servers[s], s);
+  endpoint->Connect();
+  Packet hello;
+  hello.header = Header{kHello, client, 0, 0, 0};
+  hello.text = addr;
+  for (int s = 0; s < num_servers; ++s)
+    endpoint->Send(hello, s);
+  listener.join();
+
+  std::mt19937_64 gen(client);
+  std::uniform_int_distribution<int64_t> row_dist(0, opt.table_rows - 1);
+  std::bernoulli_distribution pull_dist(opt.pull_weight / (opt.pull_weight + opt.sample_weight));
+  std::vector<int64_t> start_ns(opt.num_requests);
+  int64_t num_sent = 0;
+  auto send_next = [&]() {
+    Packet request;
+    const int32_t type = pull_dist(gen) ? kPull : kSample;
+    const int64_t width = type == kPull ? opt.widths[num_sent % opt.widths.size()] : 0;
+    request.header = Header{type, client, num_sent, opt.rows, width};
+    request.payload = NDArray::Empty({opt.rows}, kInt64, kCPU);
+    int64_t* ids = request.payload.Ptr<int64_t>();
+    for (int64_t i = 0; i < opt.rows; ++i)
+      ids[i] = row_dist(gen);
+    start_ns[num_sent] = NowNs();
+    endpoint->Send(request, num_sent % num_servers);
+    ++num_sent;
+  };
+
+  result->start_ns = NowNs();
+  while (num_sent < std::min(opt.inflight, opt.num_requests))
+    send_next();
+  for (int64_t num_received = 0; num_received < opt.num_requests; ++num_received) {
+    const Packet response = endpoint->Recv();
+    const int type = response.header.type;
+    result->latency_ns[type].push_back(NowNs() - start_ns[response.header.seq]);
+    result->bytes[type] += response.payload.GetSize();
+    if (num_sent < opt.num_requests)
+      send_next();
+  }
+  result->end_ns = NowNs();
+
+  Packet stop;
+  stop.header = Header{kStop, client, 0, 0, 0};
+  for (int s = 0; s < num_servers; ++s)
+    endpoint->Send(stop, s);
+  endpoint->Finalize();
+}
+
+double PercentileUs(const std::vector<int64_t>& sorted, double p) {
+  if (sorted.empty())
+    return 0;
+  const size_t i = std::min(sorted.size() - 1, static_cast<size_t>(p * sorted.size()));
+  return sorted[i] / 1e3;
+}
+
+void PrintHeader() {
+  std::printf("%-10s %8s %8s %-7s %10s %12s %10s %10s %10s\n", "backend", "clients",
+              "servers", "request", "count", "requests/s", "MB/s", "p50(us)", "p99(us)");
+}
+
+/*! \brief Report the throughput and the latencies of the requests of the clients. */
+void Report(const Options& opt, int64_t num_servers, const std::vector<ClientResult>& results) {
+  int64_t start_ns = results[0].start_ns, end_ns = results[0].end_ns;
+  for (const ClientResult& result : results) {
+    start_ns = std::min(start_ns, result.start_ns);
+    end_ns = std::max(end_ns, result.end_ns);
+  }
+  const double seconds = std::max<int64_t>(end_ns - start_ns, 1) / 1e9;
+  std::vector<int64_t> all;
+  int64_t all_bytes = 0;
+  auto print = [&](const char* name, std::vector<int64_t>* latencies, int64_t bytes) {
+    std::sort(latencies->begin(), latencies->end());
+    std::printf("%-10s %8zu %8ld %-7s %10zu %12.0f %10.1f %10.1f %10.1f\n",
+                opt.backend.c_str(), results.size(), num_servers, name, latencies->size(),
+                latencies->size() / seconds, bytes / seconds / 1e6,
+                PercentileUs(*latencies, 0.5), PercentileUs(*latencies, 0.99));
+  };
+  for (int type = 0; type < 2; ++type) {
+    std::vector<int64_t> latencies;
+    int64_t bytes = 0;
+    for (const ClientResult& result : results) {
+      latencies.insert(latencies.end(), result.latency_ns[type].begin(),
+                       result.latency_ns[type].end());
+      bytes += result.bytes[type];
+    }
+    if (latencies.empty())
+      continue;
+    all.insert(all.end(), latencies.begin(), latencies.end());
+    all_bytes += bytes;
+    print(kRequestNames[type], &latencies, bytes);
+  }
+  print("all", &all, all_bytes);
+}
+
+/*! \brief Run the clients of the process, and report their measures. */
+void RunClients(const Options& opt, int64_t num_servers, const std::string& addr,
+                const std::vector<std::string>& servers, int64_t num_clients,
+                int64_t client_offset) {
+  std::vector<ClientResult> results(num_clients);
+  std::vector<std::thread> clients;
+  for (int64_t c = 0; c < num_clients; ++c) {
+    clients.emplace_back(RunClient, std::cref(opt), client_offset + c, OffsetAddr(addr, c),
+                         std::cref(servers), &results[c]);
+  }
+  for (std::thread& client : clients)
+    client.join();
+  Report(opt, num_servers, results);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const Options opt = ParseOptions(argc, argv);
+  if (opt.role == "server") {
+    RunServer(opt, opt.addr, opt.num_clients[0]);
+    return 0;
+  }
+  PrintHeader();
+  if (opt.role == "client") {
+    RunClients(opt, opt.servers.size(), opt.addr, opt.servers, opt.num_clients[0],
+               opt.client_offset);
+    return 0;
+  }
+  // the runs listen on new ports, the ones of the previous runs may be lingering
+  int64_t port_offset = 0;
+  for (const int64_t num_clients : opt.num_clients) {
+    std::vector<std::string> servers;
+    for (int64_t s = 0; s < opt.num_servers; ++s)
+      servers.push_back(OffsetAddr(opt.addr, port_offset + s));
+    std::vector<std::thread> server_threads;
+    for (const std::string& server : servers)
+      server_threads.emplace_back(RunServer, std::cref(opt), server, num_clients);
+    RunClients(opt, opt.num_servers, OffsetAddr(opt.addr, port_offset + opt.num_servers),
+               servers, num_clients, 0);
+    for (std::thread& server : server_threads)
+      server.join();
+    port_offset += opt.num_servers + num_clients;
+  }
+  return 0;
+}
@@ -37,6 +37,9 @@ set(USE_CUDA OFF)
 # Whether to build cpp unittest executables.
 set(BUILD_CPP_TEST OFF)
 
+# Whether to build the cpp micro-benchmarks, which need Google Benchmark.
+set(BUILD_CPP_BENCHMARK OFF)
+
 # Whether to enable OpenMP.
 set(USE_OPENMP ON)
 
@@ -51,3 +54,6 @@ set(USE_TVM OFF)
 
 # Whether to enable fp16 to support mixed precision training.
 set(USE_FP16 OFF)
+
+# Whether to name the time spent in DGL for Nsight Systems (NVTX) and VTune (ITT).
+set(USE_PROFILING_RANGES OFF)
@@ -247,6 +247,7 @@ macro(dgl_config_cuda out_variable)
     src/runtime/cuda/*.cu
     src/geometry/cuda/*.cu
     src/graph/transform/cuda/*.cu
+    src/graph/sampling/negative/*.cu
     src/graph/sampling/randomwalks/*.cu
   )
 
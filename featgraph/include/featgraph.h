@@ -7,6 +7,8 @@
 #define FEATGRAPH_H_
 
 #include <dlpack/dlpack.h>
+#include <cstdint>
+#include <string>
 
 namespace dgl {
 namespace featgraph {
@@ -14,6 +16,49 @@ namespace featgraph {
 /* \brief Load Featgraph module from given path. */
 void LoadFeatGraphModule(const std::string& path);
 
+/*
+ * \brief Load every kernel module (*.so) of the directory into the registry of
+ *        tuned kernels.
+ *
+ * The directory in the environment variable DGL_FEATGRAPH_KERNEL_DIR, if any, is
+ * loaded on the first lookup of a kernel.
+ */
+void LoadTunedKernelDir(const std::string& dir);
+
+/*
+ * \brief The name of the tuned kernel of an operator, e.g.
+ *        SpMM_copy_lhs_sum_float32_int32_d64_cuda, or without the feature length
+ *        (_d64) for a kernel of any length if feat_len is negative.
+ */
+std::string TunedKernelName(const std::string& kind, const std::string& op,
+                            const DLDataType& dtype, const DLDataType& idtype,
+                            int64_t feat_len, const DLContext& ctx);
+
+/*
+ * \brief Call the tuned SpMM kernel of a CSR matrix without edge ids, for the
+ *        feature length, or of any length, if there is one.
+ * \param op The operator and the reducer, e.g. copy_lhs_sum.
+ * \param ufeat The source features of shape (num_cols, feat_len).
+ * \param out The output of shape (num_rows, feat_len).
+ * \return Whether a tuned kernel was found and called.
+ */
+bool SpMMCsrTuned(const std::string& op,
+                  DLTensor* indptr, DLTensor* indices,
+                  DLTensor* ufeat, DLTensor* out,
+                  int64_t feat_len);
+
+/*
+ * \brief Call the tuned dot product SDDMM kernel of a COO matrix, for the
+ *        feature length, or of any length, if there is one.
+ * \param lhs The source features of shape (num_rows, num_heads, feat_len).
+ * \param rhs The destination features of shape (num_cols, num_heads, feat_len).
+ * \param out The output of shape (nnz, num_heads, 1).
+ * \return Whether a tuned kernel was found and called.
+ */
+bool SDDMMCooTuned(DLTensor* row, DLTensor* col,
+                   DLTensor* lhs, DLTensor* rhs,
+                   DLTensor* out, int64_t feat_len);
+
 /* \brief Call Featgraph's SDDMM kernel. */
 void SDDMMTreeReduction(DLManagedTensor* row, DLManagedTensor* col, 
                         DLManagedTensor* lhs, DLManagedTensor* rhs, 
@@ -3,7 +3,8 @@ import tvm
 from tvm import te
 
 
-def sddmm_tree_reduction_gpu(idx_type, feat_type):
+def sddmm_tree_reduction_gpu(idx_type, feat_type, feat_len=None, reduce_factor=32,
+                             edge_factor=32, name=None):
     """ SDDMM kernels on GPU optimized with Tree Reduction.
     
     Parameters
@@ -12,6 +13,14 @@ def sddmm_tree_reduction_gpu(idx_type, feat_type):
         The data type for indexing tensors.
     feat_type : str
         The data type of feature tensor.
+    feat_len : int, optional
+        The feature length the kernel is specialized for, any length if None.
+    reduce_factor : int, optional
+        The number of threads of the reduction of a dot product.
+    edge_factor : int, optional
+        The number of edges of a block of threads.
+    name : str, optional
+        The name of the kernel, SDDMMTreeReduction_<idx_type>_<feat_type> if None.
 
     Returns
     -------
@@ -23,7 +32,7 @@ def sddmm_tree_reduction_gpu(idx_type, feat_type):
     num_rows = te.var('num_rows', idx_type)
     num_cols = te.var('num_cols', idx_type)
     H = te.var('num_heads', idx_type)
-    D = te.var('feat_len', idx_type)
+    D = te.var('feat_len', idx_type) if feat_len is None else tvm.tir.IntImm(idx_type, feat_len)
     row = te.placeholder((nnz,), idx_type, 'row')
     col = te.placeholder((nnz,), idx_type, 'col')
     ufeat = te.placeholder((num_rows, H, D), feat_type, 'ufeat')
@@ -37,14 +46,15 @@ def sddmm_tree_reduction_gpu(idx_type, feat_type):
     sched = te.create_schedule(out.op)
     edge_axis, head_axis, _ = out.op.axis
     reduce_axis = out.op.reduce_axis[0]
-    _, red_inner = sched[out].split(reduce_axis, factor=32)
-    edge_outer, edge_inner = sched[out].split(edge_axis, factor=32)
+    _, red_inner = sched[out].split(reduce_axis, factor=reduce_factor)
+    edge_outer, edge_inner = sched[out].split(edge_axis, factor=edge_factor)
     sched[out].bind(red_inner, te.thread_axis('threadIdx.x'))
     sched[out].bind(edge_inner, te.thread_axis('threadIdx.y'))
     sched[out].bind(edge_outer, te.thread_axis('blockIdx.x'))
     sched[out].bind(head_axis, te.thread_axis('blockIdx.y'))
-    return tvm.lower(sched, [row, col, ufeat, vfeat, out],
-                     name='SDDMMTreeReduction_{}_{}'.format(idx_type, feat_type))
+    if name is None:
+        name = 'SDDMMTreeReduction_{}_{}'.format(idx_type, feat_type)
+    return tvm.lower(sched, [row, col, ufeat, vfeat, out], name=name)
 
 
 if __name__ == '__main__':
@@ -0,0 +1,67 @@
+""" The compute function and schedules for SpMM kernels written in TVM. """
+import tvm
+from tvm import te
+
+
+def spmm_copy_lhs_sum_gpu(idx_type, feat_type, feat_len=None, num_threads=32, name=None):
+    """ SpMM kernels on GPU summing the source features of every row of a CSR
+    matrix without edge ids, a block of threads a row.
+
+    Parameters
+    ----------
+    idx_type : str
+        The data type for indexing tensors.
+    feat_type : str
+        The data type of feature tensor.
+    feat_len : int, optional
+        The feature length the kernel is specialized for, any length if None.
+    num_threads : int, optional
+        The number of threads of a row, each summing a slice of the features.
+    name : str, optional
+        The name of the kernel, SpMM_copy_lhs_sum_<feat_type>_<idx_type>_cuda if None.
+
+    Returns
+    -------
+    IRModule
+        The result IRModule.
+    """
+    num_rows = te.var('num_rows', idx_type)
+    num_cols = te.var('num_cols', idx_type)
+    nnz = te.var('nnz', idx_type)
+    D = te.var('feat_len', idx_type) if feat_len is None else tvm.tir.IntImm(idx_type, feat_len)
+    indptr = te.placeholder((num_rows + 1,), idx_type, 'indptr')
+    indices = te.placeholder((nnz,), idx_type, 'indices')
+    ufeat = te.placeholder((num_cols, D), feat_type, 'ufeat')
+
+    def _ir(indptr, indices, ufeat, out):
+        ib = tvm.tir.ir_builder.create()
+        indptr = ib.buffer_ptr(indptr)
+        indices = ib.buffer_ptr(indices)
+        ufeat = ib.buffer_ptr(ufeat)
+        out = ib.buffer_ptr(out)
+        row = te.thread_axis('blockIdx.x')
+        tx = te.thread_axis('threadIdx.x')
+        ib.scope_attr(row, 'thread_extent', num_rows)
+        ib.scope_attr(tx, 'thread_extent', num_threads)
+        acc = ib.allocate(feat_type, (1,), name='acc', scope='local')
+        with ib.for_range(0, (D + num_threads - 1) // num_threads, name='k') as k:
+            j = k * num_threads + tx
+            with ib.if_scope(j < D):
+                acc[0] = tvm.tir.const(0, feat_type)
+                with ib.for_range(indptr[row], indptr[row + 1], name='e') as e:
+                    acc[0] += ufeat[indices[e] * D + j]
+                out[row * D + j] = acc[0]
+        return ib.get()
+
+    out = te.extern((num_rows, D), [indptr, indices, ufeat],
+                    lambda ins, outs: _ir(ins[0], ins[1], ins[2], outs[0]),
+                    dtype=feat_type, name='out')
+    sched = te.create_schedule(out.op)
+    if name is None:
+        name = 'SpMM_copy_lhs_sum_{}_{}_cuda'.format(feat_type, idx_type)
+    return tvm.lower(sched, [indptr, indices, ufeat, out], name=name)
+
+
+if __name__ == '__main__':
+    kernel0 = spmm_copy_lhs_sum_gpu('int32', 'float32')
+    print(kernel0)
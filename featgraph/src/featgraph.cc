@@ -8,11 +8,18 @@
 #include <tvm/runtime/registry.h>
 #include <dmlc/logging.h>
 #include <featgraph.h>
+#include <dirent.h>
+#include <algorithm>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace dgl {
 namespace featgraph {
 
-/* \brief Singleton that loads the featgraph module. */
+/* \brief Singleton holding the loaded featgraph modules and their kernels. */
 class FeatGraphModule {
 public:
   static FeatGraphModule* Global() {
@@ -21,19 +28,46 @@ public:
   }
 
   void Load(const std::string& path) {
-    mod = tvm::runtime::Module::LoadFromFile(path);
+    tvm::runtime::Module mod = tvm::runtime::Module::LoadFromFile(path);
+    std::lock_guard<std::mutex> lock(mutex_);
+    modules_.push_back(mod);
+    // a kernel missing before may be in the new module
+    kernels_.clear();
   }
 
   inline tvm::runtime::ModuleNode* Get() {
-    auto ret = mod.operator->();
-    if (!ret) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (modules_.empty()) {
       LOG(FATAL) << "FeatGraph module have not been loaded. "
                  << "Please set path of featgraph shared library.";
     }
-    return ret;
+    return modules_.front().operator->();
   }
+
+  /* \brief Find a kernel in the loaded modules, the last loaded first. */
+  tvm::runtime::PackedFunc Find(const std::string& name) {
+    std::call_once(env_loaded_, [] {
+      const char* dir = std::getenv("DGL_FEATGRAPH_KERNEL_DIR");
+      if (dir)
+        LoadTunedKernelDir(dir);
+    });
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = kernels_.find(name);
+    if (it != kernels_.end())
+      return it->second;
+    tvm::runtime::PackedFunc f;
+    for (auto mod = modules_.rbegin(); mod != modules_.rend() && f == nullptr; ++mod)
+      f = mod->GetFunction(name, true);
+    kernels_[name] = f;
+    return f;
+  }
+
 private:
-  tvm::runtime::Module mod;
+  std::mutex mutex_;
+  std::once_flag env_loaded_;
+  std::vector<tvm::runtime::Module> modules_;
+  /* \brief The kernels looked up, null for the missing ones. */
+  std::unordered_map<std::string, tvm::runtime::PackedFunc> kernels_;
   FeatGraphModule() {}
 };
 
@@ -42,6 +76,25 @@ void LoadFeatGraphModule(const std::string& path) {
   FeatGraphModule::Global()->Load(path);
 }
 
+void LoadTunedKernelDir(const std::string& dir) {
+  DIR* d = opendir(dir.c_str());
+  if (!d) {
+    LOG(WARNING) << "Cannot open the featgraph kernel directory " << dir;
+    return;
+  }
+  std::vector<std::string> paths;
+  while (dirent* entry = readdir(d)) {
+    const std::string name = entry->d_name;
+    if (name.size() > 3 && name.compare(name.size() - 3, 3, ".so") == 0)
+      paths.push_back(dir + "/" + name);
+  }
+  closedir(d);
+  // the later modules in name order take precedence
+  std::sort(paths.begin(), paths.end());
+  for (const std::string& path : paths)
+    FeatGraphModule::Global()->Load(path);
+}
+
 /* \brief Convert DLDataType to string. */
 inline std::string DTypeAsStr(const DLDataType& t) {
   switch(t.code) {
@@ -61,6 +114,50 @@ inline std::string GetOperatorName(
   return base_name + "_" + DTypeAsStr(dtype) + "_" + DTypeAsStr(idtype);
 }
 
+std::string TunedKernelName(const std::string& kind, const std::string& op,
+                            const DLDataType& dtype, const DLDataType& idtype,
+                            int64_t feat_len, const DLContext& ctx) {
+  std::string name = kind + "_" + op + "_" + DTypeAsStr(dtype) + "_" + DTypeAsStr(idtype);
+  if (feat_len >= 0)
+    name += "_d" + std::to_string(feat_len);
+  return name + (ctx.device_type == kDLGPU ? "_cuda" : "_cpu");
+}
+
+/* \brief Find the tuned kernel for the feature length, or else of any length. */
+tvm::runtime::PackedFunc FindTunedKernel(const std::string& kind, const std::string& op,
+                                         const DLDataType& dtype, const DLDataType& idtype,
+                                         int64_t feat_len, const DLContext& ctx) {
+  FeatGraphModule* mod = FeatGraphModule::Global();
+  tvm::runtime::PackedFunc f = mod->Find(
+      TunedKernelName(kind, op, dtype, idtype, feat_len, ctx));
+  if (f == nullptr)
+    f = mod->Find(TunedKernelName(kind, op, dtype, idtype, -1, ctx));
+  return f;
+}
+
+bool SpMMCsrTuned(const std::string& op,
+                  DLTensor* indptr, DLTensor* indices,
+                  DLTensor* ufeat, DLTensor* out,
+                  int64_t feat_len) {
+  tvm::runtime::PackedFunc f = FindTunedKernel(
+      "SpMM", op, ufeat->dtype, indptr->dtype, feat_len, ufeat->ctx);
+  if (f == nullptr)
+    return false;
+  f(indptr, indices, ufeat, out);
+  return true;
+}
+
+bool SDDMMCooTuned(DLTensor* row, DLTensor* col,
+                   DLTensor* lhs, DLTensor* rhs,
+                   DLTensor* out, int64_t feat_len) {
+  tvm::runtime::PackedFunc f = FindTunedKernel(
+      "SDDMM", "dot", lhs->dtype, row->dtype, feat_len, lhs->ctx);
+  if (f == nullptr)
+    return false;
+  f(row, col, lhs, rhs, out);
+  return true;
+}
+
 /* \brief Call FeatGraph's SDDMM kernel. */
 void SDDMMTreeReduction(DLManagedTensor* row, DLManagedTensor* col, 
                         DLManagedTensor* lhs, DLManagedTensor* rhs, 
@@ -0,0 +1,120 @@
+""" Tune featgraph kernels for the given feature lengths and export the ones
+faster than the kernels of DGL to a directory of tuned kernels.
+
+DGL loads the directory in DGL_FEATGRAPH_KERNEL_DIR, or the one given to
+dgl.sparse._CAPI_FG_LoadTunedKernelDir, and runs a tuned kernel instead of its
+own when there is one for the operator, the types and the feature length.
+"""
+import argparse
+import os
+import time
+
+import torch
+import tvm
+import dgl
+
+from sddmm import sddmm_tree_reduction_gpu
+from spmm import spmm_copy_lhs_sum_gpu
+
+
+def kernel_name(kind, op, idx_type, feat_type, feat_len):
+    """ The name of a tuned kernel, as looked up by DGL. """
+    return '{}_{}_{}_{}_d{}_cuda'.format(kind, op, feat_type, idx_type, feat_len)
+
+
+def time_tvm(mod, name, args, number):
+    """ The time of a TVM kernel in seconds. """
+    dev = tvm.cuda(0)
+    return mod.time_evaluator(name, dev, number=number)(*args).mean
+
+
+def time_dgl(fn, number):
+    """ The time of a DGL operator in seconds. """
+    fn()
+    torch.cuda.synchronize()
+    start = time.time()
+    for _ in range(number):
+        fn()
+    torch.cuda.synchronize()
+    return (time.time() - start) / number
+
+
+def tune_spmm(g, idx_type, feat_type, feat_len, number):
+    """ The fastest SpMM copy_lhs_sum kernel for the feature length, or None if
+    DGL is faster. """
+    name = kernel_name('SpMM', 'copy_lhs_sum', idx_type, feat_type, feat_len)
+    u = torch.rand((g.num_src_nodes(), feat_len), device='cuda').to(getattr(torch, feat_type))
+    indptr, indices, _ = g.adj_sparse('csc')
+    dev = tvm.cuda(0)
+    args = [tvm.nd.array(indptr.cpu().numpy().astype(idx_type), dev),
+            tvm.nd.array(indices.cpu().numpy().astype(idx_type), dev),
+            tvm.nd.array(u.cpu().numpy(), dev),
+            tvm.nd.empty((g.num_dst_nodes(), feat_len), feat_type, dev)]
+    best, best_time = None, time_dgl(lambda: dgl.ops.copy_u_sum(g, u), number)
+    for num_threads in (32, 64, 128, 256):
+        if num_threads > 2 * feat_len and num_threads > 32:
+            break
+        kernel = spmm_copy_lhs_sum_gpu(idx_type, feat_type, feat_len, num_threads, name)
+        mod = tvm.build(kernel, target='cuda', target_host='llvm')
+        t = time_tvm(mod, name, args, number)
+        if t < best_time:
+            best, best_time = kernel, t
+    return best
+
+
+def tune_sddmm(g, idx_type, feat_type, feat_len, number):
+    """ The fastest SDDMM dot kernel for the feature length, or None if DGL is
+    faster. """
+    name = kernel_name('SDDMM', 'dot', idx_type, feat_type, feat_len)
+    u = torch.rand((g.num_src_nodes(), 1, feat_len), device='cuda').to(getattr(torch, feat_type))
+    v = torch.rand((g.num_dst_nodes(), 1, feat_len), device='cuda').to(getattr(torch, feat_type))
+    row, col = g.edges()
+    dev = tvm.cuda(0)
+    args = [tvm.nd.array(row.cpu().numpy().astype(idx_type), dev),
+            tvm.nd.array(col.cpu().numpy().astype(idx_type), dev),
+            tvm.nd.array(u.cpu().numpy(), dev),
+            tvm.nd.array(v.cpu().numpy(), dev),
+            tvm.nd.empty((g.num_edges(), 1, 1), feat_type, dev)]
+    best, best_time = None, time_dgl(lambda: dgl.ops.u_dot_v(g, u, v), number)
+    for reduce_factor in (8, 16, 32):
+        for edge_factor in (8, 16, 32):
+            kernel = sddmm_tree_reduction_gpu(idx_type, feat_type, feat_len,
+                                              reduce_factor, edge_factor, name)
+            mod = tvm.build(kernel, target='cuda', target_host='llvm')
+            t = time_tvm(mod, name, args, number)
+            if t < best_time:
+                best, best_time = kernel, t
+    return best
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('--output-dir', required=True,
+                        help='The directory of tuned kernels to write to.')
+    parser.add_argument('--feat-lens', type=int, nargs='+', default=[16, 32, 64, 128, 256])
+    parser.add_argument('--idtypes', nargs='+', default=['int32', 'int64'])
+    parser.add_argument('--dtypes', nargs='+', default=['float32'])
+    parser.add_argument('--num-nodes', type=int, default=100000)
+    parser.add_argument('--num-edges', type=int, default=1000000)
+    parser.add_argument('--number', type=int, default=10,
+                        help='The number of runs every kernel is timed over.')
+    args = parser.parse_args()
+
+    kernels = []
+    for idx_type in args.idtypes:
+        g = dgl.rand_graph(args.num_nodes, args.num_edges).astype(getattr(torch, idx_type))
+        g = g.to('cuda')
+        for feat_type in args.dtypes:
+            for feat_len in args.feat_lens:
+                for tune in (tune_spmm, tune_sddmm):
+                    kernel = tune(g, idx_type, feat_type, feat_len, args.number)
+                    if kernel is not None:
+                        kernels.append(kernel)
+    if not kernels:
+        print('No featgraph kernel is faster than DGL.')
+    else:
+        os.makedirs(args.output_dir, exist_ok=True)
+        module = tvm.build(kernels, target='cuda', target_host='llvm')
+        path = os.path.join(args.output_dir, 'featgraph_tuned_{}.so'.format(int(time.time())))
+        module.export_library(path)
+        print('Exported {} tuned kernels to {}.'.format(len(kernels), path))
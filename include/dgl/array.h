@@ -14,4 +14,6 @@
 #include "./aten/spmat.h"
 #include "./aten/csr.h"
 #include "./aten/coo.h"
+#include "./aten/compressed_csr.h"
+#include "./aten/quantized.h"
 #endif  // DGL_ARRAY_H_
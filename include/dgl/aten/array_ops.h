@@ -183,6 +183,9 @@ NDArray Scatter(NDArray array, IdArray indices);
  * <code>
  *     out[index] = value
  * </code>
+ *
+ * The value and output arrays may have more than one dimension on CPU, in which
+ * case whole rows are scattered and the rows must be of the same shape.
  */
 void Scatter_(IdArray index, NDArray value, NDArray out);
 
@@ -211,6 +214,22 @@ NDArray Repeat(NDArray array, IdArray repeats);
  */
 IdArray Relabel_(const std::vector<IdArray>& arrays);
 
+/*!
+ * \brief Find the unique ids of an array in the order of their first occurrence,
+ * as Relabel_ does, together with the inverse indices and the counts, in a
+ * single pass over a hash table.
+ *
+ * Example:
+ *
+ * Given the IdArray [2, 3, 10, 0, 2, 10], the unique ids are [2, 3, 10, 0],
+ * the inverse indices, i.e. the new id of every element, are [0, 1, 2, 3, 0, 2]
+ * and the counts are [2, 1, 2, 1].
+ *
+ * \param ids The id array of non-negative ids, which is left unchanged.
+ * \return The unique ids, the inverse indices and the counts.
+ */
+std::tuple<IdArray, IdArray, IdArray> Unique(IdArray ids);
+
 /*!
  * \brief concatenate the given id arrays to one array
  *
@@ -0,0 +1,75 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file dgl/aten/compressed_csr.h
+ * \brief Read-only CSR matrix with compressed column indices
+ */
+#ifndef DGL_ATEN_COMPRESSED_CSR_H_
+#define DGL_ATEN_COMPRESSED_CSR_H_
+
+#include "./types.h"
+#include "./array_ops.h"
+#include "./csr.h"
+#include "./coo.h"
+
+namespace dgl {
+namespace aten {
+
+/*! \brief The number of non-zeros of a block of a CompressedCSRMatrix. */
+constexpr int64_t kCompressedCSRBlockSize = 64;
+
+/*!
+ * \brief Read-only CSR matrix whose column indices are delta-encoded.
+ *
+ * The column indices of every row are sorted and each one is stored as the
+ * LEB128 varint of its difference to the previous index of the row. The first
+ * index of a row and the first index of every block of kCompressedCSRBlockSize
+ * non-zeros are stored as is, and block_offsets gives the byte position of
+ * every block, so that any non-zero is decoded from at most one block.
+ *
+ * The data array is empty when the non-zeros are ordered by id, which is the
+ * case of a CSR matrix without data array, e.g. the out-edges of a graph.
+ */
+struct CompressedCSRMatrix {
+  /*! \brief the dense shape of the matrix */
+  int64_t num_rows = 0, num_cols = 0;
+  /*! \brief row pointer array, of the id type of the matrix */
+  IdArray indptr;
+  /*! \brief uint8 encoded column indices */
+  NDArray indices;
+  /*! \brief int64 byte position of every block in indices, plus the total size */
+  IdArray block_offsets;
+  /*! \brief data index array. When is null, assume it is from 0 to NNZ - 1. */
+  IdArray data;
+};
+
+/*! \brief Return true if the compressed matrix has a data array. */
+inline bool CompressedCSRHasData(const CompressedCSRMatrix& csr) {
+  return !IsNullArray(csr.data);
+}
+
+/*! \brief Return the number of non-zeros of the compressed matrix. */
+int64_t CompressedCSRNNZ(const CompressedCSRMatrix& csr);
+
+/*!
+ * \brief Compress a CSR matrix on CPU.
+ *
+ * The rows of an unsorted matrix are sorted first. The data array is dropped
+ * when it is 0 to NNZ - 1 after sorting.
+ */
+CompressedCSRMatrix CSRCompress(CSRMatrix csr);
+
+/*! \brief Decompress to a CSR matrix with sorted column indices. */
+CSRMatrix CompressedCSRDecompress(const CompressedCSRMatrix& csr);
+
+/*!
+ * \brief Randomly select a fixed number of non-zeros for each of the given rows
+ *        with equal probability, as CSRRowWiseSamplingUniform.
+ * \return A COOMatrix storing the picked row, col and data indices.
+ */
+COOMatrix CompressedCSRRowWiseSamplingUniform(
+    const CompressedCSRMatrix& csr, IdArray rows, int64_t num_samples, bool replace = true);
+
+}  // namespace aten
+}  // namespace dgl
+
+#endif  // DGL_ATEN_COMPRESSED_CSR_H_
@@ -232,6 +232,27 @@ COOMatrix COOTranspose(COOMatrix coo);
  */
 CSRMatrix COOToCSR(COOMatrix coo);
 
+/*!
+ * \brief Convert a COO matrix in host memory to a CSR matrix in host memory on
+ *        a GPU, streaming the edges through it by chunks, so that the matrix
+ *        need not fit in device memory.
+ *
+ * The edges are counted per row on the GPU chunk by chunk, and placed in a
+ * second pass, each chunk being sorted by row on the GPU. Only the row
+ * pointers of the matrix and a chunk of edges stay in device memory. The
+ * copies are faster if the arrays of the COO matrix are pinned.
+ *
+ * The result is the same as COOToCSR: the order of the edges within the rows
+ * is kept, and the CSR matrix is sorted if the COO matrix is row and column
+ * sorted.
+ *
+ * \param coo Input COO matrix in host memory.
+ * \param ctx The GPU to run the conversion on.
+ * \param chunk_size The number of edges per chunk.
+ * \return CSR matrix in host memory.
+ */
+CSRMatrix COOToCSRChunked(COOMatrix coo, DLContext ctx, int64_t chunk_size);
+
 /*!
  * \brief Slice rows of the given matrix and return.
  * \param coo COO matrix
@@ -21,6 +21,7 @@ namespace dgl {
 namespace aten {
 
 struct COOMatrix;
+class KernelPlanCache;
 
 /*!
  * \brief Plain CSR matrix
@@ -31,6 +32,10 @@ struct COOMatrix;
  * Note that we do allow duplicate non-zero entries -- multiple non-zero entries
  * that have the same row, col indices. It corresponds to multigraph in
  * graph terminology.
+ *
+ * The row pointers and the data array may be int64 with int32 column indices,
+ * for the matrices with more than 2^31 non-zeros but fewer than 2^31 rows and
+ * columns (see CSRHasWideIndptr). Only a few operators support these matrices.
  */
 
 constexpr uint64_t kDGLSerialize_AtenCsrMatrixMagic = 0xDD6cd31205dff127;
@@ -101,14 +106,15 @@ struct CSRMatrix {
   }
 
   inline void CheckValidity() const {
-    CHECK_SAME_DTYPE(indptr, indices);
+    if (!(IS_INT64(indptr) && IS_INT32(indices)))
+      CHECK_SAME_DTYPE(indptr, indices);
     CHECK_SAME_CONTEXT(indptr, indices);
     if (!aten::IsNullArray(data)) {
       CHECK_SAME_DTYPE(indptr, data);
       CHECK_SAME_CONTEXT(indptr, data);
     }
-    CHECK_NO_OVERFLOW(indptr->dtype, num_rows);
-    CHECK_NO_OVERFLOW(indptr->dtype, num_cols);
+    CHECK_NO_OVERFLOW(indices->dtype, num_rows);
+    CHECK_NO_OVERFLOW(indices->dtype, num_cols);
     CHECK_EQ(indptr->shape[0], num_rows + 1);
   }
 
@@ -133,6 +139,12 @@ bool CSRIsNonZero(CSRMatrix , int64_t row, int64_t col);
  * \note This operator allows broadcasting (i.e, either row or col can be of length 1).
  */
 runtime::NDArray CSRIsNonZero(CSRMatrix, runtime::NDArray row, runtime::NDArray col);
+/*!
+ * \brief Batched implementation of CSRIsNonZero, with the lookup index of the
+ *        matrix kept in its kernel plan cache, see CSRGetData.
+ */
+runtime::NDArray CSRIsNonZero(
+    CSRMatrix, runtime::NDArray row, runtime::NDArray col, KernelPlanCache* cache);
 
 /*! \brief Return the nnz of the given row */
 int64_t CSRGetRowNNZ(CSRMatrix , int64_t row);
@@ -149,6 +161,21 @@ inline bool CSRHasData(CSRMatrix csr) {
   return !IsNullArray(csr.data);
 }
 
+/*! \brief Whether the CSR matrix has int64 row pointers and int32 column indices. */
+inline bool CSRHasWideIndptr(const CSRMatrix& csr) {
+  return csr.indptr->dtype != csr.indices->dtype;
+}
+
+/*!
+ * \brief Convert an int64 CSR matrix to int32 column indices, keeping the int64
+ *        row pointers and data array.
+ *
+ * The matrix must have fewer than 2^31 rows and columns. Besides the operators
+ * below, the result is only supported by CSRRowWiseSampling without probability
+ * and by the CPU SpMM on Csr format with the sum reducer.
+ */
+CSRMatrix CSRNarrowIndices(CSRMatrix csr);
+
 /*! \brief Whether the column indices of each row is sorted. */
 bool CSRIsSorted(CSRMatrix csr);
 
@@ -200,6 +227,25 @@ inline runtime::NDArray CSRGetAllData(CSRMatrix mat, int64_t row, int64_t col) {
  */
 runtime::NDArray CSRGetData(CSRMatrix, runtime::NDArray rows, runtime::NDArray cols);
 
+/*!
+ * \brief Get the data for each (row, col) pair, with a lookup index of the matrix
+ *        kept in its kernel plan cache.
+ *
+ * The sorted rows of a matrix are binary searched, while the unsorted ones take a
+ * scan per query. Many queries into an unsorted GPU matrix thus build an index
+ * once instead: a hash table of the non-zeros when the rows are long on average,
+ * and a sorted copy of the matrix otherwise. The other cases are CSRGetData.
+ *
+ * \param mat Sparse matrix.
+ * \param rows Row index.
+ * \param cols Column index.
+ * \param cache The kernel plan cache of mat, where the index is kept. If null,
+ *        this is CSRGetData.
+ * \return Data array. The i^th element is the data of (rows[i], cols[i])
+ */
+runtime::NDArray CSRGetData(
+    CSRMatrix, runtime::NDArray rows, runtime::NDArray cols, KernelPlanCache* cache);
+
 /*!
  * \brief Get the data for each (row, col) pair, then index into the weights array.
  *
@@ -228,6 +274,22 @@ runtime::NDArray CSRGetData(
 /*! \brief Return a transposed CSR matrix */
 CSRMatrix CSRTranspose(CSRMatrix csr);
 
+/*!
+ * \brief Return the union of a square CSR matrix and its transpose, with sorted
+ *        rows, no duplicate entry and no data.
+ *
+ * A = [[0, 1, 1],
+ *      [0, 0, 1],
+ *      [1, 0, 0]]
+ *
+ * B = CSRMakeSymmetric(A)
+ *
+ * B = [[0, 1, 1],
+ *      [1, 0, 1],
+ *      [1, 1, 0]]
+ */
+CSRMatrix CSRMakeSymmetric(CSRMatrix csr);
+
 /*!
  * \brief Convert CSR matrix to COO matrix.
  *
@@ -293,6 +355,60 @@ CSRMatrix CSRSliceRows(CSRMatrix csr, runtime::NDArray rows);
  */
 CSRMatrix CSRSliceMatrix(CSRMatrix csr, runtime::NDArray rows, runtime::NDArray cols);
 
+/*!
+ * \brief Slice many submatrices of a CSR matrix at once, as the blocks along the
+ *        diagonal of one matrix, e.g. of a batch of node-induced subgraphs.
+ *
+ * The i-th block is M[I_i, J_i], with I_i = rows[row_offsets[i]:row_offsets[i + 1]]
+ * and J_i = cols[col_offsets[i]:col_offsets[i + 1]]. Its rows and columns are
+ * relabeled to their positions in rows and cols, so the returned matrix has
+ * len(rows) rows and len(cols) columns. The columns of a block must be unique.
+ * The entries of a row keep their order in the input matrix.
+ *
+ * On GPU, the size of the output is the only value copied to the host.
+ *
+ * \param csr The input csr matrix
+ * \param rows The row indices of all the blocks, concatenated
+ * \param row_offsets The offsets of the rows of every block, of length
+ *        number of blocks + 1
+ * \param cols The col indices of all the blocks, concatenated
+ * \param col_offsets The offsets of the cols of every block
+ * \return The matrix of the blocks, whose data are the IDs of the entries in
+ *         the input matrix.
+ */
+CSRMatrix CSRSliceMatrixBatched(CSRMatrix csr, runtime::NDArray rows,
+                                runtime::NDArray row_offsets, runtime::NDArray cols,
+                                runtime::NDArray col_offsets);
+
+/*!
+ * \brief Expand many groups of seed nodes to their k-hop neighborhoods at once,
+ *        and compute the distances of the nodes of every group to its seeds.
+ *
+ * The neighbors of a node are its columns in any of the given matrices, e.g. a
+ * CSR and its transpose for undirected neighborhoods. The nodes of the i-th
+ * group are its seeds, seeds[seed_offsets[i]:seed_offsets[i + 1]], in order,
+ * then the nodes reached at each hop, by increasing ID.
+ *
+ * The distance of a node to the j-th seed of its group is the shortest path
+ * length from the seed in the subgraph induced by the group, not going through
+ * the other seeds of the group, as for the double-radius node labeling of SEAL.
+ * It is -1 if there is no such path, or if the group has no j-th seed.
+ *
+ * \param adjs The adjacency matrices, with the same number of rows
+ * \param seeds The seeds of all the groups, concatenated. The seeds of a group
+ *        must be unique.
+ * \param seed_offsets The offsets of the seeds of every group, of length
+ *        number of groups + 1
+ * \param num_hops The number of hops
+ * \return The nodes of all the groups concatenated, their offsets, and the
+ *         matrix of distances, with one row per node and one column per seed
+ *         of the largest group.
+ */
+std::vector<runtime::NDArray> CSRKHopExpand(const std::vector<CSRMatrix>& adjs,
+                                            runtime::NDArray seeds,
+                                            runtime::NDArray seed_offsets,
+                                            int64_t num_hops);
+
 /*! \return True if the matrix has duplicate entries */
 bool CSRHasDuplicate(CSRMatrix csr);
 
@@ -346,6 +462,25 @@ CSRMatrix CSRReorder(CSRMatrix csr, runtime::NDArray new_row_ids, runtime::NDArr
  */
 CSRMatrix CSRRemove(CSRMatrix csr, IdArray entries);
 
+/*!
+ * \brief Merge two CSR matrices of the same shape row by row.
+ *
+ * Row i of the result holds the entries of row i of a followed by the ones of
+ * row i of b. If both matrices are sorted, the rows are merged by column index
+ * instead, with the entries of a first on equal columns, and the result is sorted.
+ *
+ * A missing data array stands for 0 to NNZ(a) - 1 in a and for NNZ(a) to
+ * NNZ(a) + NNZ(b) - 1 in b, so that merging the out-edges of a graph with the
+ * ones of new edges numbers the new edges after the old ones.
+ *
+ * Complexity: O(nnz(a) + nnz(b))
+ *
+ * \param a The first matrix.
+ * \param b The second matrix.
+ * \return The merged matrix, with a data array.
+ */
+CSRMatrix CSRMergeRows(CSRMatrix a, CSRMatrix b);
+
 /*!
  * \brief Randomly select a fixed number of non-zero entries along each given row independently.
  *
@@ -378,13 +513,67 @@ CSRMatrix CSRRemove(CSRMatrix csr, IdArray entries);
  * \param prob Unnormalized probability array. Should be of the same length as the data array.
  *             If an empty array is provided, assume uniform.
  * \param replace True if sample with replacement
+ * \param mask An 8-bit array of the same length as the data array, the entries whose
+ *             value is zero being left out of the sampling as if they were not in the
+ *             matrix, e.g. the edges outside of a time window. If an empty array is
+ *             provided, all the entries are sampled from. With a mask, a negative
+ *             num_samples picks all the entries left.
  * \return A COOMatrix storing the picked row, col and data indices.
+ * \note On a matrix with int64 row pointers and int32 column indices, only the
+ *       uniform sampling on CPU without mask is supported. The rows are int32 and
+ *       the result is an int64 matrix.
  */
 COOMatrix CSRRowWiseSampling(
     CSRMatrix mat,
     IdArray rows,
     int64_t num_samples,
     FloatArray prob = FloatArray(),
+    bool replace = true,
+    NDArray mask = NDArray());
+
+/*!
+ * \brief Build the alias tables of the rows of a CSR matrix for sampling with
+ *        the given probabilities, see CSRRowWiseSamplingAlias.
+ *
+ * The tables are indexed like prob, i.e. by the data indices. For every
+ * non-zero entry at position k of its row, a uniform random float below
+ * accept keeps it, otherwise the entry at position alias of the row is
+ * picked. They are only valid for the given matrix, so the ones of the
+ * in-edges and the out-edges of a graph differ, and must be rebuilt when the
+ * probabilities change.
+ *
+ * \param mat Input CSR matrix.
+ * \param prob Unnormalized probability array. Should be of the same length as the data array.
+ * \return The pair of the acceptance probabilities, of the type of prob, and the aliases.
+ */
+std::pair<FloatArray, IdArray> CSRRowWiseAliasTable(CSRMatrix mat, FloatArray prob);
+
+/*!
+ * \brief Randomly select a fixed number of non-zero entries along each given
+ *        row independently, with precomputed alias tables.
+ *
+ * The result follows the same distribution as CSRRowWiseSampling with prob,
+ * but a row costs O(num_samples) rather than O(nnz of the row) when sampling
+ * with replacement, or without it when num_samples is small compared to the
+ * number of entries of the row. Rows where many draws would be rejected fall
+ * back to the sampling of CSRRowWiseSampling.
+ *
+ * \param mat Input CSR matrix.
+ * \param rows Rows to sample from.
+ * \param num_samples Number of samples
+ * \param prob Unnormalized probability array. Should be of the same length as the data array.
+ * \param accept The acceptance probabilities returned by CSRRowWiseAliasTable for mat and prob.
+ * \param alias The aliases returned by CSRRowWiseAliasTable for mat and prob.
+ * \param replace True if sample with replacement
+ * \return A COOMatrix storing the picked row, col and data indices.
+ */
+COOMatrix CSRRowWiseSamplingAlias(
+    CSRMatrix mat,
+    IdArray rows,
+    int64_t num_samples,
+    FloatArray prob,
+    FloatArray accept,
+    IdArray alias,
     bool replace = true);
 
 /*!
@@ -482,6 +671,76 @@ COOMatrix CSRRowWiseTopk(
     FloatArray weight,
     bool ascending = false);
 
+/*!
+ * \brief Sort the non-zero entries of every row of a CSR matrix by weight, for
+ *        selecting the top K of the rows with CSRRowWiseTopkOrdered.
+ *
+ * The order is indexed like weight, i.e. by the data indices. The entry at
+ * position k of its row stores the position in the row of its k-th entry by
+ * weight, the ties being broken by position as in CSRRowWiseTopk. It is only
+ * valid for the given matrix, and must be rebuilt when the weights change.
+ *
+ * \param mat Input CSR matrix.
+ * \param weight Weight associated with each entry. Should be of the same length as the
+ *               data array.
+ * \param ascending If true, the entries are sorted by ascending weights.
+ * \return The positions of the entries of the rows by weight.
+ */
+IdArray CSRRowWiseTopkOrder(CSRMatrix mat, FloatArray weight, bool ascending = false);
+
+/*!
+ * \brief Select the K non-zero entries with the largest (or smallest) weights along each
+ *        given row, with a precomputed order.
+ *
+ * The result is the same as CSRRowWiseTopk with the weights the order was built from,
+ * but a row costs O(K) rather than O(nnz of the row).
+ *
+ * \param mat Input CSR matrix.
+ * \param rows Rows to sample from.
+ * \param k The K value.
+ * \param order The order returned by CSRRowWiseTopkOrder for mat.
+ * \return A COOMatrix storing the picked row and col indices. Its data field stores the
+ *         the index of the picked elements in the value array.
+ */
+COOMatrix CSRRowWiseTopkOrdered(
+    CSRMatrix mat,
+    IdArray rows,
+    int64_t k,
+    IdArray order);
+
+/*!
+ * \brief Randomly select a fixed number of non-zero entries along each given row
+ *        independently, among the entries with a timestamp strictly earlier than
+ *        the time bound of the row.
+ *
+ * The eligible entries are picked uniformly. A row costs O(num_samples + log(nnz of
+ * the row)), as the entries are found by binary search in the precomputed order of
+ * the row by increasing timestamp.
+ *
+ * If replace is false and a row has fewer eligible entries than num_samples, all
+ * of them are picked. A negative num_samples picks all the eligible entries.
+ *
+ * \param mat Input CSR matrix.
+ * \param rows Rows to sample from.
+ * \param num_samples Number of samples.
+ * \param timestamp Timestamp associated with each entry. Should be of the same length
+ *                  as the data array.
+ * \param order The order returned by CSRRowWiseTopkOrder for mat and timestamp, with
+ *              ascending set to true.
+ * \param bound The time bound of each row in rows, of the type of timestamp.
+ * \param replace True if sample with replacement
+ * \return A COOMatrix storing the picked row and col indices. Its data field stores the
+ *         the index of the picked elements in the value array.
+ */
+COOMatrix CSRRowWiseSamplingTemporal(
+    CSRMatrix mat,
+    IdArray rows,
+    int64_t num_samples,
+    NDArray timestamp,
+    IdArray order,
+    NDArray bound,
+    bool replace = true);
+
 
 
 /*!
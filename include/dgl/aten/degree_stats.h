@@ -0,0 +1,86 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file dgl/aten/degree_stats.h
+ * \brief Degree statistics of a sparse matrix, cached in its kernel plans.
+ */
+#ifndef DGL_ATEN_DEGREE_STATS_H_
+#define DGL_ATEN_DEGREE_STATS_H_
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "./coo.h"
+#include "./csr.h"
+#include "./kernel_plan.h"
+
+namespace dgl {
+namespace aten {
+
+/*!
+ * \brief The degrees of the rows of a sparse matrix and their distribution.
+ *
+ * The statistics only depend on the sparse structure, so they are computed on
+ * first use and kept in the kernel plan cache of the matrix, which drops them
+ * along with the matrix. Kernels read them to pick a schedule, e.g. a balanced
+ * one for skewed degrees.
+ */
+struct DegreeStats {
+  /*! \brief The degrees of the rows, of the type and on the device of the matrix. */
+  IdArray degrees;
+  /*! \brief The number of rows. */
+  int64_t num_rows = 0;
+  /*! \brief The number of non-zeros. */
+  int64_t nnz = 0;
+  /*! \brief The largest degree. */
+  int64_t max_degree = 0;
+  /*!
+   * \brief The number of rows by log2 of their degree: bin 0 counts the rows of
+   *        degree 0, and bin b > 0 the rows of degree in [2^(b-1), 2^b).
+   */
+  std::vector<int64_t> histogram;
+
+  /*! \return The bin of the histogram counting the rows of the given degree. */
+  static int Bin(int64_t degree) {
+    int bin = 0;
+    while (degree > 0) {
+      degree >>= 1;
+      ++bin;
+    }
+    return bin;
+  }
+
+  /*! \return The number of rows of degree at least 2^(bin-1), i.e. in bin or above. */
+  int64_t NumRowsFromBin(int bin) const {
+    int64_t count = 0;
+    for (size_t b = std::max(bin, 0); b < histogram.size(); ++b)
+      count += histogram[b];
+    return count;
+  }
+};
+
+/*!
+ * \brief Get the degree statistics of the rows of a Csr matrix.
+ * \param csr The Csr matrix.
+ * \param cache The kernel plan cache of csr, where the statistics are kept. If
+ *        null, they are computed on every call.
+ */
+std::shared_ptr<const DegreeStats> CSRGetDegreeStats(
+    const CSRMatrix& csr, KernelPlanCache* cache = nullptr);
+
+/*!
+ * \brief Get the degree statistics of the rows, or of the columns, of a Coo
+ *        matrix.
+ * \param coo The Coo matrix.
+ * \param transpose Whether to count the columns, i.e. the rows of the
+ *        transpose of coo.
+ * \param cache The kernel plan cache of coo, where the statistics are kept. If
+ *        null, they are computed on every call.
+ */
+std::shared_ptr<const DegreeStats> COOGetDegreeStats(
+    const COOMatrix& coo, bool transpose, KernelPlanCache* cache = nullptr);
+
+}  // namespace aten
+}  // namespace dgl
+
+#endif  // DGL_ATEN_DEGREE_STATS_H_
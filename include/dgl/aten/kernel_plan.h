@@ -0,0 +1,95 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file dgl/aten/kernel_plan.h
+ * \brief Cache of kernel execution plans attached to a sparse matrix.
+ */
+#ifndef DGL_ATEN_KERNEL_PLAN_H_
+#define DGL_ATEN_KERNEL_PLAN_H_
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace dgl {
+namespace aten {
+
+/*!
+ * \brief A cache of kernel execution plans of one sparse matrix.
+ *
+ * A plan holds whatever a kernel derives from the sparse structure alone
+ * (e.g. the tiling of the matrix and the JIT-ed code for a feature shape), so
+ * that repeated calls on the same matrix only need to dispatch. The cache is
+ * owned by the graph storing the matrix and is cleared whenever that matrix
+ * is invalidated.
+ *
+ * Plans are type-erased; the key must encode everything the plan depends on,
+ * including its type, so that a key always maps to the same plan type.
+ */
+class KernelPlanCache {
+ public:
+  /*!
+   * \brief Get the plan of the given key, building it on a cache miss.
+   * \param key The key of the plan.
+   * \param make The function building the plan, with signature
+   *        std::shared_ptr<Plan>().
+   * \return The plan.
+   */
+  template <typename Plan, typename Builder>
+  std::shared_ptr<Plan> GetOrCreate(const std::string& key, Builder make) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = plans_.find(key);
+      if (it != plans_.end())
+        return std::static_pointer_cast<Plan>(it->second);
+    }
+    // Build outside of the lock; if two threads race on the same key, the
+    // first inserted plan wins and the other one is dropped.
+    std::shared_ptr<Plan> plan = make();
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = plans_.emplace(key, plan).first;
+    return std::static_pointer_cast<Plan>(it->second);
+  }
+
+  /*!
+   * \brief Get the plan of the given key, if cached.
+   * \return The plan, or null on a cache miss.
+   */
+  template <typename Plan>
+  std::shared_ptr<Plan> Find(const std::string& key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = plans_.find(key);
+    if (it == plans_.end())
+      return nullptr;
+    return std::static_pointer_cast<Plan>(it->second);
+  }
+
+  /*! \brief Drop the plan of the given key, if cached. */
+  void Erase(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    plans_.erase(key);
+  }
+
+  /*! \brief Drop all the plans. */
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    plans_.clear();
+  }
+
+  /*! \return The number of cached plans. */
+  size_t Size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return plans_.size();
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, std::shared_ptr<void>> plans_;
+};
+
+typedef std::shared_ptr<KernelPlanCache> KernelPlanCachePtr;
+
+}  // namespace aten
+}  // namespace dgl
+
+#endif  // DGL_ATEN_KERNEL_PLAN_H_
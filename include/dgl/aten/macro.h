@@ -141,6 +141,21 @@
   }                                                           \
 } while (0)
 
+/*
+ * Dispatch according to float bits like ATEN_FLOAT_BITS_SWITCH, also accepting
+ * bfloat16 as 16 bits. The 16-bit kernels tell float16 from bfloat16 by the
+ * dtype code of their arrays.
+ */
+#define ATEN_FLOAT_BITS_SWITCH_BF16(val, bits, val_name, ...) do {             \
+  if ((val).code == kDLBfloat) {                                              \
+    CHECK_EQ((val).bits, 16) << (val_name) << " can only be bfloat16";        \
+    constexpr int bits = 16;                                                  \
+    {__VA_ARGS__}                                                             \
+  } else {                                                                    \
+    ATEN_FLOAT_BITS_SWITCH(val, bits, val_name, __VA_ARGS__);                 \
+  }                                                                           \
+} while (0)
+
 /*
  * Dispatch according to data type (int32, int64, float32 or float64):
  *
@@ -216,11 +231,20 @@
 // Macro to dispatch according to device context and index type.
 #define ATEN_CSR_SWITCH(csr, XPU, IdType, op, ...)            \
   ATEN_XPU_SWITCH((csr).indptr->ctx.device_type, XPU, op, {   \
+    CHECK_UNIFORM_CSR_WIDTH(csr, op);                         \
     ATEN_ID_TYPE_SWITCH((csr).indptr->dtype, IdType, {        \
       {__VA_ARGS__}                                           \
     });                                                       \
   });
 
+// Macro to dispatch a compressed CSR matrix according to device context and index type.
+#define ATEN_COMPRESSED_CSR_SWITCH(csr, XPU, IdType, op, ...)  \
+  ATEN_XPU_SWITCH((csr).indptr->ctx.device_type, XPU, op, {    \
+    ATEN_ID_TYPE_SWITCH((csr).indptr->dtype, IdType, {         \
+      {__VA_ARGS__}                                            \
+    });                                                        \
+  });
+
 // Macro to dispatch according to device context and index type.
 #define ATEN_COO_SWITCH(coo, XPU, IdType, op, ...)          \
   ATEN_XPU_SWITCH((coo).row->ctx.device_type, XPU, op, {    \
@@ -233,6 +257,7 @@
 #ifdef DGL_USE_CUDA
 #define ATEN_CSR_SWITCH_CUDA(csr, XPU, IdType, op, ...)            \
   ATEN_XPU_SWITCH_CUDA((csr).indptr->ctx.device_type, XPU, op, {   \
+    CHECK_UNIFORM_CSR_WIDTH(csr, op);                              \
     ATEN_ID_TYPE_SWITCH((csr).indptr->dtype, IdType, {             \
       {__VA_ARGS__}                                                \
     });                                                            \
@@ -286,6 +311,13 @@
     << (VAR1)->dtype << ")"                                                     \
     << ". But got " << (VAR2)->dtype << ".";
 
+// The CSR matrices with int64 row pointers and int32 column indices are only
+// supported by the operators which do not dispatch with ATEN_CSR_SWITCH.
+#define CHECK_UNIFORM_CSR_WIDTH(csr, op)                                             \
+  CHECK((csr).indices->dtype == (csr).indptr->dtype)                                 \
+    << (op) << " does not support CSR matrices with int64 row pointers and int32 "   \
+    << "column indices.";
+
 #define CHECK_SAME_CONTEXT(VAR1, VAR2)                                                      \
   CHECK((VAR1)->ctx == (VAR2)->ctx)                                                         \
     << "Expected " << (#VAR2) << " to have the same device context as " << (#VAR1) << "("   \
@@ -0,0 +1,78 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file dgl/aten/quantized.h
+ * \brief Feature tables stored as int8 or float16 and read as float32
+ */
+#ifndef DGL_ATEN_QUANTIZED_H_
+#define DGL_ATEN_QUANTIZED_H_
+
+#include "./types.h"
+#include "./array_ops.h"
+#include "./csr.h"
+
+namespace dgl {
+namespace aten {
+
+/*!
+ * \brief A float32 table of rows stored as int8 or float16 values.
+ *
+ * An int8 value q of the table stands for scale * (q - zero_point), with a scale
+ * and a zero point for every row if per_row, or for every column otherwise, the
+ * columns being the elements of a row. The scale and the zero point are empty for
+ * float16 values, which are read as is.
+ */
+struct QuantizedArray {
+  /*! \brief The int8 or float16 values, of the shape of the table. */
+  NDArray data;
+  /*! \brief The float32 scales and zero points, on the device of the values. */
+  NDArray scale, zero_point;
+  /*! \brief Whether the scales and zero points are of the rows or of the columns. */
+  bool per_row = true;
+};
+
+/*! \brief The number of elements of a row of the table. */
+inline int64_t QuantizedRowLength(const QuantizedArray& array) {
+  int64_t len = 1;
+  for (int i = 1; i < array.data->ndim; ++i)
+    len *= array.data->shape[i];
+  return len;
+}
+
+/*!
+ * \brief Quantize a float32 table on CPU.
+ *
+ * The int8 values map the range between the minimum and the maximum of every row
+ * or column to [-128, 127], with round to nearest.
+ *
+ * \param array The table, of at least one dimension.
+ * \param dtype int8 or float16.
+ * \param per_row Whether the int8 values are scaled by row or by column.
+ */
+QuantizedArray Quantize(NDArray array, DLDataType dtype, bool per_row = true);
+
+/*! \brief The float32 table of a quantized one on CPU. */
+NDArray Dequantize(const QuantizedArray& array);
+
+/*!
+ * \brief Gather the rows of a quantized table as float32 rows on the device of the
+ *        index.
+ *
+ * With a GPU index, the table may be on the GPU or in pinned host memory, in
+ * which case the quantized rows are read over PCIe by unified virtual addressing
+ * and only dequantized on the GPU.
+ */
+NDArray IndexSelectDequantize(const QuantizedArray& array, IdArray index);
+
+/*!
+ * \brief SpMM with the copy_lhs operator and the sum reducer on CPU, reading the
+ *        features of the source nodes from a quantized table.
+ * \param csr The CSR matrix whose rows are the destination nodes.
+ * \param ufeat The quantized features of the source nodes.
+ * \param out The float32 features of the destination nodes, overwritten.
+ */
+void SpMMCopyUSumQuantized(const CSRMatrix& csr, const QuantizedArray& ufeat, NDArray out);
+
+}  // namespace aten
+}  // namespace dgl
+
+#endif  // DGL_ATEN_QUANTIZED_H_
@@ -14,6 +14,7 @@
 #include <memory>
 
 #include "./runtime/object.h"
+#include "aten/kernel_plan.h"
 #include "aten/spmat.h"
 #include "aten/types.h"
 #include "graph_interface.h"
@@ -110,6 +111,14 @@ class BaseHeteroGraph : public runtime::Object {
    */
   virtual DLContext Context() const = 0;
 
+  /*!
+   * \brief Whether the structure of the graph is on the CPU and pinned in host
+   *        memory, so that the GPU samplers read it in place.
+   */
+  virtual bool IsPinned() const {
+    return false;
+  }
+
   /*!
    * \brief Get the number of integer bits used to store node/edge ids (32 or 64).
    */
@@ -431,6 +440,22 @@ class BaseHeteroGraph : public runtime::Object {
    */
   virtual aten::CSRMatrix GetCSCMatrix(dgl_type_t etype) const = 0;
 
+  /*!
+   * \brief Get the kernel plan cache of the adjacency matrix in the given format.
+   *
+   * Kernels store what they derive from the sparse structure (e.g. blockings and
+   * JIT-ed code) in this cache, so that repeated calls on the same graph are cheap.
+   * The cache is cleared when the adjacency matrix is invalidated.
+   *
+   * \param etype Edge type.
+   * \param fmt The sparse format, as returned by SelectFormat.
+   * \return The plan cache, or nullptr if the graph does not keep one.
+   */
+  virtual aten::KernelPlanCachePtr GetKernelPlanCache(
+      dgl_type_t etype, SparseFormat fmt) const {
+    return nullptr;
+  }
+
   /*!
    * \brief Extract the induced subgraph by the given vertices.
    *
@@ -614,7 +639,7 @@ HeteroGraphPtr CreateHeteroGraph(
 HeteroGraphPtr CreateFromCOO(
     int64_t num_vtypes, int64_t num_src, int64_t num_dst,
     IdArray row, IdArray col, bool row_sorted = false, bool col_sorted = false,
-    dgl_format_code_t formats = ALL_CODE);
+    dgl_format_code_t formats = ALL_CODE, bool trusted = false);
 
 /*!
  * \brief Create a heterograph from COO input.
@@ -625,7 +650,7 @@ HeteroGraphPtr CreateFromCOO(
  */
 HeteroGraphPtr CreateFromCOO(
     int64_t num_vtypes, const aten::COOMatrix& mat,
-    dgl_format_code_t formats = ALL_CODE);
+    dgl_format_code_t formats = ALL_CODE, bool trusted = false);
 
 /*!
  * \brief Create a heterograph from CSR input.
@@ -641,7 +666,7 @@ HeteroGraphPtr CreateFromCOO(
 HeteroGraphPtr CreateFromCSR(
     int64_t num_vtypes, int64_t num_src, int64_t num_dst,
     IdArray indptr, IdArray indices, IdArray edge_ids,
-    dgl_format_code_t formats = ALL_CODE);
+    dgl_format_code_t formats = ALL_CODE, bool sorted = false);
 
 /*!
  * \brief Create a heterograph from CSR input.
@@ -668,7 +693,7 @@ HeteroGraphPtr CreateFromCSR(
 HeteroGraphPtr CreateFromCSC(
     int64_t num_vtypes, int64_t num_src, int64_t num_dst,
     IdArray indptr, IdArray indices, IdArray edge_ids,
-    dgl_format_code_t formats = ALL_CODE);
+    dgl_format_code_t formats = ALL_CODE, bool sorted = false);
 
 /*!
  * \brief Create a heterograph from CSC input.
@@ -703,6 +728,55 @@ HeteroSubgraph InEdgeGraph(
 HeteroSubgraph OutEdgeGraph(
     const HeteroGraphPtr graph, const std::vector<IdArray>& nodes, bool relabel_nodes = false);
 
+/*!
+ * \brief Extract the subgraphs induced by many sets of nodes at once, as one
+ *        graph holding their disjoint union.
+ *
+ * The nodes of the i-th subgraph of type t are nodes[t][offsets[t][i]:offsets[t][i + 1]],
+ * relabeled to their positions in nodes[t]. On GPU, the number of edges of
+ * each relation is the only value copied to the host.
+ *
+ * \param graph Graph
+ * \param nodes Node IDs of each type of all the subgraphs, concatenated. The nodes
+ *        of a type of a subgraph must be unique.
+ * \param offsets The offsets of the nodes of every subgraph, for each type
+ * \param edge_offsets The offsets of the edges of every subgraph is stored here,
+ *        for each edge type
+ * \return The batched subgraph, whose induced vertices are the given nodes.
+ */
+HeteroSubgraph BatchedNodeSubgraph(
+    const HeteroGraphPtr graph, const std::vector<IdArray>& nodes,
+    const std::vector<IdArray>& offsets, std::vector<IdArray>* edge_offsets);
+
+/*!
+ * \brief Extract the subgraphs induced by the k-hop neighborhoods of many groups
+ *        of seeds at once, as one graph holding their disjoint union, e.g. the
+ *        enclosing subgraphs of the links of SEAL.
+ *
+ * The nodes of the i-th subgraph are its seeds, seeds[seed_offsets[i]:seed_offsets[i + 1]],
+ * in order, then the nodes reached at each hop, by increasing ID. The distance of
+ * a node to the j-th seed of its subgraph is the shortest path length from the
+ * seed in the subgraph, not going through its other seeds, or -1 if there is no
+ * such path or no j-th seed, as needed by the double-radius node labeling.
+ *
+ * \param graph Graph, with one node type and one edge type
+ * \param seeds The seeds of all the subgraphs, concatenated. The seeds of a
+ *        subgraph must be unique.
+ * \param seed_offsets The offsets of the seeds of every subgraph
+ * \param num_hops The number of hops
+ * \param direction "in", "out" or "both", the edges followed from a node
+ * \param node_offsets The offsets of the nodes of every subgraph is stored here
+ * \param edge_offsets The offsets of the edges of every subgraph is stored here
+ * \param dists The distances of the nodes to the seeds of their subgraph are
+ *        stored here, one row per node and one column per seed of the largest
+ *        group of seeds
+ * \return The batched subgraph, whose induced vertices are the nodes of the subgraphs.
+ */
+HeteroSubgraph BatchedKHopSubgraph(
+    const HeteroGraphPtr graph, IdArray seeds, IdArray seed_offsets, int64_t num_hops,
+    const std::string& direction, IdArray* node_offsets, IdArray* edge_offsets,
+    NDArray* dists);
+
 /*!
  * \brief Joint union multiple graphs into one graph.
  *
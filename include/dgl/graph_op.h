@@ -141,7 +141,8 @@ class GraphOp {
   static GraphPtr ToBidirectedImmutableGraph(GraphPtr graph);
   /*!
    * \brief Same as BidirectedMutableGraph except that the returned graph is immutable
-   * and call gk_csr_MakeSymmetric in GKlib. This is more efficient than ToBidirectedImmutableGraph.
+   * and simple, merging the rows of the in-CSR and of its transpose in parallel with
+   * aten::CSRMakeSymmetric. This is more efficient than ToBidirectedImmutableGraph.
    * It return a null pointer if the conversion fails.
    *
    * \param graph The input graph.
@@ -43,6 +43,20 @@ namespace aten {
  */
 Frontiers BFSNodesFrontiers(const CSRMatrix& csr, IdArray source);
 
+/*!
+ * \brief Traverse the graph in a breadth-first-search (BFS) order, switching
+ *        to bottom-up steps on the large frontiers with the transpose of csr.
+ *
+ * The frontiers are the same as without the transpose.
+ *
+ * \param csr The input csr matrix.
+ * \param transpose The transpose of csr with the same edge IDs, or an empty
+ *        matrix; it is only used on the CPU.
+ * \param sources Source nodes.
+ * \return A Frontiers object containing the search result
+ */
+Frontiers BFSNodesFrontiers(const CSRMatrix& csr, const CSRMatrix& transpose, IdArray source);
+
 /*!
  * \brief Traverse the graph in a breadth-first-search (BFS) order, returning
  *        the edges of the BFS tree.
@@ -53,6 +67,19 @@ Frontiers BFSNodesFrontiers(const CSRMatrix& csr, IdArray source);
  */
 Frontiers BFSEdgesFrontiers(const CSRMatrix& csr, IdArray source);
 
+/*!
+ * \brief Traverse the graph in a breadth-first-search (BFS) order, returning
+ *        the edges of the BFS tree, switching to bottom-up steps on the large
+ *        frontiers with the transpose of csr.
+ *
+ * \param csr The input csr matrix.
+ * \param transpose The transpose of csr with the same edge IDs, or an empty
+ *        matrix; it is only used on the CPU.
+ * \param sources Source nodes.
+ * \return A Frontiers object containing the search result
+ */
+Frontiers BFSEdgesFrontiers(const CSRMatrix& csr, const CSRMatrix& transpose, IdArray source);
+
 /*!
  * \brief Traverse the graph in topological order.
  *
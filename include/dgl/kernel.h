@@ -37,20 +37,94 @@ void SpMM(const std::string& op, const std::string& reduce,
           NDArray out,
           std::vector<NDArray> out_aux);
 
+/*!
+ * \brief Generalized Sparse Matrix-Matrix Multiplication on a CSR matrix whose
+ *        rows are the destination nodes.
+ *
+ * A matrix with int64 row pointers and int32 column indices is only supported
+ * on CPU with the sum reducer.
+ *
+ * \param op The binary operator, could be `add`, `sub', `mul`, 'div',
+ *        `copy_u`, `copy_e'.
+ * \param reduce The reduce operator, could be `sum`, `min`, `max'.
+ * \param csr The CSR matrix.
+ * \param ufeat The source node feature.
+ * \param efeat The edge feature.
+ * \param out The output feature on destination nodes.
+ * \param out_aux The argmin/argmax arrays of the `min` and `max` reducers.
+ */
+void SpMM(const std::string& op, const std::string& reduce,
+          const CSRMatrix& csr,
+          NDArray ufeat,
+          NDArray efeat,
+          NDArray out,
+          std::vector<NDArray> out_aux = {});
+
+/*!
+ * \brief Generalized Sparse Matrix-Matrix Multiplication on a compressed CSR
+ *        matrix whose rows are the destination nodes, on CPU.
+ * \param op The binary operator, could be `add`, `sub', `mul`, 'div',
+ *        `copy_u`, `copy_e'.
+ * \param reduce The reduce operator, only `sum`.
+ * \param csr The compressed CSR matrix.
+ * \param ufeat The source node feature.
+ * \param efeat The edge feature.
+ * \param out The output feature on destination nodes, accumulated into.
+ */
+void SpMM(const std::string& op, const std::string& reduce,
+          const CompressedCSRMatrix& csr,
+          NDArray ufeat,
+          NDArray efeat,
+          NDArray out);
+
+/*!
+ * \brief Generalized Sparse Matrix-Matrix Multiplication reading the feature of
+ *        every source node u from the row ufeat_index[u] of a larger table,
+ *        without gathering the features of the source nodes first.
+ *
+ * The columns of the CSC matrix of the graph are mapped to the rows of the
+ * table, which only takes an array of the number of edges, and the SpMM runs
+ * on the mapped matrix. The table may be in pinned host memory for a graph on
+ * GPU, in which case the kernels read it through unified virtual addressing.
+ *
+ * \param op The binary operator, could be `add`, `sub', `mul`, 'div',
+ *        `copy_u`, `copy_e'.
+ * \param reduce The reduce operator, could be `sum`, `min`, `max'.
+ * \param graph The graph we apply SpMM on.
+ * \param ufeat The feature table.
+ * \param ufeat_index The row of the table of every source node.
+ * \param efeat The edge feature.
+ * \param out The output feature on destination nodes.
+ * \param out_aux The argmin/argmax arrays of the `min` and `max` reducers, the
+ *        one of the source nodes holding rows of the table.
+ */
+void SpMMWithIndex(const std::string& op, const std::string& reduce,
+                   HeteroGraphPtr graph,
+                   NDArray ufeat,
+                   IdArray ufeat_index,
+                   NDArray efeat,
+                   NDArray out,
+                   std::vector<NDArray> out_aux);
+
 /*!
  * \brief Generalized Sampled Dense-Dense Matrix Multiplication.
  * \param op The binary operator, could be `add`, `sub', `mul`, 'div',
  *        `dot`, `copy_u`, `copy_e'.
  * \param graph The graph we apply SpMM on.
- * \param ufeat The source node feature.
- * \param vfeat The destination node feature.
+ * \param lhs The left hand side feature.
+ * \param rhs The right hand side feature.
  * \param out The output feature on edge.
+ * \param lhs_target The target of lhs, 0 for the source nodes, 1 for the
+ *        edges and 2 for the destination nodes.
+ * \param rhs_target The target of rhs, likewise.
  */
 void SDDMM(const std::string& op,
            HeteroGraphPtr graph,
-           NDArray ufeat,
-           NDArray efeat,
-           NDArray out);
+           NDArray lhs,
+           NDArray rhs,
+           NDArray out,
+           int lhs_target,
+           int rhs_target);
 
 /*!
  * \brief Sparse-sparse matrix multiplication.
@@ -64,6 +138,35 @@ std::pair<CSRMatrix, NDArray> CSRMM(
     CSRMatrix B,
     NDArray B_weights);
 
+/*!
+ * \brief Sparse-sparse matrix multiplication keeping the k largest entries of
+ *        every row of the product. Only supported on CPU.
+ */
+std::pair<CSRMatrix, NDArray> CSRMMTopK(
+    CSRMatrix A,
+    NDArray A_weights,
+    CSRMatrix B,
+    NDArray B_weights,
+    int64_t k);
+
+/*!
+ * \brief Sparse-sparse matrix multiplication computed only at the entries of a
+ *        mask, without the rest of the product.
+ *
+ * \param A The left operand.
+ * \param A_weights The edge weights of A.
+ * \param B_t The transpose of the right operand, i.e. its columns as rows.
+ * \param B_weights The edge weights of B.
+ * \param mask The entries of the product to compute.
+ * \return The entries of the product, in the order of the mask.
+ */
+NDArray CSRMaskedMM(
+    CSRMatrix A,
+    NDArray A_weights,
+    CSRMatrix B_t,
+    NDArray B_weights,
+    COOMatrix mask);
+
 /*!
  * \brief Summing up a list of sparse matrices.
  *
@@ -74,6 +177,68 @@ std::pair<CSRMatrix, NDArray> CSRSum(
     const std::vector<CSRMatrix>& A,
     const std::vector<NDArray>& A_weights);
 
+/*!
+ * \brief Sparse-sparse matrix multiplication of the adjacency matrices of two
+ *        graphs with a single edge type.
+ *
+ * The sparsity of the product (the symbolic phase) is cached on the first graph
+ * for the adjacency matrix of the second one, so that repeated products of the
+ * same graphs with different weights only compute the weights, and return the
+ * same graph.
+ *
+ * \param A The left operand.
+ * \param A_weights The edge weights of graph A.
+ * \param B The right operand.
+ * \param B_weights The edge weights of graph B.
+ * \param num_vtypes The number of vertex types of the graph to be returned.
+ * \param topk The number of largest entries to keep in every row of the product,
+ *        or -1 to keep them all. The sparsity of a pruned product depends on the
+ *        weights and is not cached.
+ * \return The graph of the product, with sorted column indices, and its edge
+ *         weights.
+ */
+std::pair<HeteroGraphPtr, NDArray> CSRMM(
+    HeteroGraphPtr A,
+    NDArray A_weights,
+    HeteroGraphPtr B,
+    NDArray B_weights,
+    int num_vtypes,
+    int64_t topk = -1);
+
+/*!
+ * \brief Summing up the adjacency matrices of a list of graphs with a single edge
+ *        type.
+ *
+ * The sparsity of the sum is cached on the first graph as for CSRMM.
+ *
+ * \param A The graphs.
+ * \param A_weights The edge weights of the graphs.
+ * \return The graph of the sum, with sorted column indices, and its edge
+ *         weights.
+ */
+std::pair<HeteroGraphPtr, NDArray> CSRSum(
+    const std::vector<HeteroGraphPtr>& A,
+    const std::vector<NDArray>& A_weights);
+
+/*!
+ * \brief Sparse-sparse matrix multiplication of the adjacency matrices of two
+ *        graphs with a single edge type, computed only at the edges of a third
+ *        graph, by intersecting the rows of A with the columns of B.
+ *
+ * \param A The left operand.
+ * \param A_weights The edge weights of graph A.
+ * \param B The right operand.
+ * \param B_weights The edge weights of graph B.
+ * \param mask The graph whose edges are the entries of the product to compute.
+ * \return The entries of the product at the edges of the mask, in their order.
+ */
+NDArray CSRMaskedMM(
+    HeteroGraphPtr A,
+    NDArray A_weights,
+    HeteroGraphPtr B,
+    NDArray B_weights,
+    HeteroGraphPtr mask);
+
 }  // namespace aten
 }  // namespace dgl
 
@@ -7,6 +7,7 @@
 #define DGL_LAZY_H_
 
 #include <memory>
+#include <mutex>
 
 namespace dgl {
 
@@ -14,7 +15,8 @@ namespace dgl {
  * \brief Lazy object that will be materialized only when being queried.
  *
  * The object should be immutable -- no mutation once materialized.
- * The object is currently not threaad safe.
+ * The object is thread safe: it is created by only one of the threads querying it
+ * at once, the others waiting for it, and it is read without locking afterwards.
  */
 template <typename T>
 class Lazy {
@@ -36,15 +38,23 @@ class Lazy {
    */
   template <typename Fn>
   const T& Get(Fn fn) {
-    if (!ptr_) {
-      ptr_.reset(new T(fn()));
+    std::shared_ptr<T> ptr = std::atomic_load(&ptr_);
+    if (!ptr) {
+      std::lock_guard<std::mutex> lock(*mutex_);
+      ptr = std::atomic_load(&ptr_);
+      if (!ptr) {
+        ptr = std::make_shared<T>(fn());
+        std::atomic_store(&ptr_, ptr);
+      }
     }
-    return *ptr_;
+    return *ptr;
   }
 
  private:
   /*!\brief the internal data pointer */
   std::shared_ptr<T> ptr_{nullptr};
+  /*!\brief the mutex guarding the creation, shared by the copies of the object */
+  std::shared_ptr<std::mutex> mutex_{std::make_shared<std::mutex>()};
 };
 
 }  // namespace dgl
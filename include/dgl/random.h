@@ -10,8 +10,11 @@
 #include <dgl/array.h>
 #include <dmlc/thread_local.h>
 #include <dmlc/logging.h>
+#include <cstdint>
+#include <limits>
 #include <random>
 #include <thread>
+#include <type_traits>
 #include <vector>
 
 namespace dgl {
@@ -34,6 +37,57 @@ inline uint32_t GetThreadId() {
 
 };  // namespace
 
+/*!
+ * \brief The xoshiro256** 64-bit pseudo-random number generator.
+ *
+ * It has better statistical quality and is several times faster than
+ * std::default_random_engine, and the state is a few words only. It satisfies
+ * UniformRandomBitGenerator, so that it works with the std distributions.
+ */
+class Xoshiro256 {
+ public:
+  typedef uint64_t result_type;
+
+  explicit Xoshiro256(uint64_t seed = 0) {
+    this->seed(seed);
+  }
+
+  /*! \brief Seed the state with the splitmix64 sequence of the seed. */
+  void seed(uint64_t seed) {
+    for (int i = 0; i < 4; ++i)
+      s_[i] = Mix(seed += 0x9e3779b97f4a7c15ULL);
+  }
+
+  /*! \brief The splitmix64 bijective mixing of a 64-bit word. */
+  static uint64_t Mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+  result_type operator()() {
+    const uint64_t result = Rotl(s_[1] * 5, 7) * 9;
+    const uint64_t t = s_[1] << 17;
+    s_[2] ^= s_[0];
+    s_[3] ^= s_[1];
+    s_[1] ^= s_[2];
+    s_[0] ^= s_[3];
+    s_[2] ^= t;
+    s_[3] = Rotl(s_[3], 45);
+    return result;
+  }
+
+ private:
+  static uint64_t Rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+  }
+
+  uint64_t s_[4];
+};
+
 /*!
  * \brief Thread-local Random Number Generator class
  */
@@ -57,11 +111,27 @@ class RandomEngine {
 
   /*!
    * \brief Set the seed of this random number generator
+   *
+   * Every thread gets its own sequence, reproducible for a given seed.
    */
   void SetSeed(uint32_t seed) {
     rng_.seed(seed + GetThreadId());
   }
 
+  /*!
+   * \brief Restart this generator at the stream of a key, so that the numbers drawn
+   *        next only depend on the key and not on the thread drawing them.
+   *
+   * The key is hashed to the seed of the state, which is only a few words, so that
+   * it is cheap to switch the stream for every task, e.g. every random walk.
+   *
+   * \param seed The global seed.
+   * \param stream The index of the stream under the global seed.
+   */
+  void SetStream(uint64_t seed, uint64_t stream) {
+    rng_.seed(Xoshiro256::Mix(Xoshiro256::Mix(seed) + stream));
+  }
+
   /*!
    * \brief Generate a uniform random integer in [0, upper)
    */
@@ -76,8 +146,22 @@ class RandomEngine {
   template<typename T>
   T RandInt(T lower, T upper) {
     CHECK_LT(lower, upper);
-    std::uniform_int_distribution<T> dist(lower, upper - 1);
-    return dist(rng_);
+    return lower + static_cast<T>(Bounded(static_cast<uint64_t>(upper) - lower));
+  }
+
+  /*!
+   * \brief Fill a buffer with uniform random integers in [lower, upper)
+   * \param num The number of integers.
+   * \param out The output buffer.
+   */
+  template<typename T>
+  void RandInt(T lower, T upper, int64_t num, T* out) {
+    if (num == 0)
+      return;
+    CHECK_LT(lower, upper);
+    const uint64_t range = static_cast<uint64_t>(upper) - lower;
+    for (int64_t i = 0; i < num; ++i)
+      out[i] = lower + static_cast<T>(Bounded(range));
   }
 
   /*!
@@ -96,8 +180,20 @@ class RandomEngine {
     // Although the result is in [lower, upper), we allow lower == upper as in
     // www.cplusplus.com/reference/random/uniform_real_distribution/uniform_real_distribution/
     CHECK_LE(lower, upper);
-    std::uniform_real_distribution<T> dist(lower, upper);
-    return dist(rng_);
+    return lower + (upper - lower) * Canonical<T>();
+  }
+
+  /*!
+   * \brief Fill a buffer with uniform random floats in [lower, upper)
+   * \param num The number of floats.
+   * \param out The output buffer.
+   */
+  template<typename T>
+  void Uniform(T lower, T upper, int64_t num, T* out) {
+    CHECK_LE(lower, upper);
+    const T scale = upper - lower;
+    for (int64_t i = 0; i < num; ++i)
+      out[i] = lower + scale * Canonical<T>();
   }
 
   /*!
@@ -230,7 +326,111 @@ class RandomEngine {
   }
 
  private:
-  std::default_random_engine rng_;
+  /*!
+   * \brief Generate a uniform random integer in [0, range), with Lemire's
+   *        multiply-and-shift method, which only divides in the rare case a
+   *        draw must be rejected to stay unbiased.
+   */
+  uint64_t Bounded(uint64_t range) {
+    if (range <= std::numeric_limits<uint32_t>::max()) {
+      // the upper bits of xoshiro256** are the best ones
+      const uint32_t r = static_cast<uint32_t>(range);
+      uint64_t m = (rng_() >> 32) * r;
+      uint32_t low = static_cast<uint32_t>(m);
+      if (low < r) {
+        const uint32_t threshold = static_cast<uint32_t>(-r) % r;
+        while (low < threshold) {
+          m = (rng_() >> 32) * r;
+          low = static_cast<uint32_t>(m);
+        }
+      }
+      return m >> 32;
+    }
+#ifdef __SIZEOF_INT128__
+    unsigned __int128 m = static_cast<unsigned __int128>(rng_()) * range;
+    uint64_t low = static_cast<uint64_t>(m);
+    if (low < range) {
+      const uint64_t threshold = (0 - range) % range;
+      while (low < threshold) {
+        m = static_cast<unsigned __int128>(rng_()) * range;
+        low = static_cast<uint64_t>(m);
+      }
+    }
+    return static_cast<uint64_t>(m >> 64);
+#else
+    std::uniform_int_distribution<uint64_t> dist(0, range - 1);
+    return dist(rng_);
+#endif  // __SIZEOF_INT128__
+  }
+
+  /*! \brief Generate a uniform random float in [0, 1) from the upper bits of a draw. */
+  template<typename T>
+  T Canonical() {
+    if (std::is_same<T, float>::value)
+      return static_cast<T>(rng_() >> 40) * T(1. / (1ULL << 24));
+    return static_cast<T>(rng_() >> 11) * T(1. / (1ULL << 53));
+  }
+
+  Xoshiro256 rng_;
+};
+
+/*!
+ * \brief The key of the streams the rows of a row-wise sampling draw from, so that
+ *        the neighbors sampled for a row only depend on the key and on the row, and
+ *        not on the number of threads or on the other rows sampled.
+ */
+struct RowStreamKey {
+  /*! \brief Whether the rows draw from their streams, or from the engine of their thread. */
+  bool enabled = false;
+  uint64_t seed = 0;
+
+  /*! \brief The key of a seed. */
+  static RowStreamKey FromSeed(uint64_t seed) {
+    RowStreamKey key;
+    key.enabled = true;
+    key.seed = Xoshiro256::Mix(seed);
+    return key;
+  }
+
+  /*! \brief The key of a sub-stream, e.g. of an edge type or of a minibatch, if enabled. */
+  RowStreamKey Derive(uint64_t stream) const {
+    RowStreamKey key = *this;
+    if (enabled)
+      key.seed = Xoshiro256::Mix(seed + stream);
+    return key;
+  }
+
+  /*! \brief Restart an engine at the stream of a row. */
+  void Seed(RandomEngine* engine, uint64_t row) const {
+    engine->SetStream(seed, row);
+  }
+};
+
+/*!
+ * \brief Set the key of the streams the rows sampled by the calling thread draw from,
+ *        until the end of the scope.
+ *
+ * The row-wise samplings read the key in the thread calling them, before their parallel
+ * loops, so a key must be set again in the tasks sampling on other threads.
+ */
+class RowStreamScope {
+ public:
+  explicit RowStreamScope(const RowStreamKey& key) : saved_(Current()) {
+    Current() = key;
+  }
+
+  ~RowStreamScope() {
+    Current() = saved_;
+  }
+
+  /*! \brief The key of the calling thread, disabled out of any scope. */
+  static RowStreamKey& Current() {
+    static thread_local RowStreamKey key;
+    return key;
+  }
+
+ private:
+  RowStreamKey saved_;
 };
 
 };  // namespace dgl
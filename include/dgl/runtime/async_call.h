@@ -0,0 +1,102 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file dgl/runtime/async_call.h
+ * \brief Calling packed functions asynchronously on a pool of worker threads.
+ *
+ * AsyncCall queues a call of a packed function, e.g. a C API of the samplers,
+ * and returns a Future right away, which is waited on for the result. A single
+ * process can thus sample the next minibatch while training on the current
+ * one, without the sampling worker processes.
+ *
+ * The arguments are retained by the call, so that the caller may drop them.
+ * The arguments that are futures are replaced by their results: the call is
+ * only queued once they are done, which chains the calls.
+ *
+ * The number of worker threads is given by DGL_ASYNC_CALL_THREADS, 1 by
+ * default, so that the calls run in the order they are queued. The calls run
+ * their parallel loops with their own OpenMP threads, so more workers also
+ * take more cores.
+ */
+#ifndef DGL_RUNTIME_ASYNC_CALL_H_
+#define DGL_RUNTIME_ASYNC_CALL_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "object.h"
+#include "packed_func.h"
+
+namespace dgl {
+namespace runtime {
+
+/*! \brief The state of a call running asynchronously. */
+class FutureObject : public Object {
+ public:
+  static constexpr const char* _type_key = "runtime.Future";
+
+  /*! \return Whether the call has finished, successfully or not. */
+  bool Done();
+
+  /*!
+   * \brief Wait for the call to finish.
+   * \return The result of the call.
+   *
+   * Fails with the error of the call, if any.
+   */
+  DGLRetValue Wait();
+
+  /*! \return The error of the finished call, empty if none. */
+  std::string Error();
+
+  /*! \brief Record the end of the call, failed if error is not empty. */
+  void Finish(DGLRetValue result, const std::string& error);
+
+  /*!
+   * \brief Call f once the call has finished, on the thread finishing it, or
+   *        right away if it has.
+   */
+  void OnDone(std::function<void()> f);
+
+  DGL_DECLARE_OBJECT_TYPE_INFO(FutureObject, Object);
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  bool done_ = false;
+  DGLRetValue result_;
+  std::string error_;
+  std::vector<std::function<void()>> callbacks_;
+};
+
+class Future : public ObjectRef {
+ public:
+  DGL_DEFINE_OBJECT_REF_METHODS(Future, ObjectRef, FutureObject);
+};
+
+/*!
+ * \brief Queue a call of a packed function to the worker threads.
+ *
+ * The arrays passed by the caller as views, i.e. that it does not own, cannot
+ * be retained and are rejected.
+ *
+ * \param f The function.
+ * \param args The arguments, the futures among them being replaced by their
+ *        results.
+ * \return The future of the result.
+ */
+Future AsyncCall(PackedFunc f, DGLArgs args);
+
+/*! \brief Wait for all the queued calls to finish. */
+void WaitAllAsyncCalls();
+
+/*! \return The number of calls not finished yet. */
+int64_t NumPendingAsyncCalls();
+
+}  // namespace runtime
+}  // namespace dgl
+
+#endif  // DGL_RUNTIME_ASYNC_CALL_H_
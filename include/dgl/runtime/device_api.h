@@ -162,6 +162,32 @@ class DeviceAPI {
    */ 
   DGL_DLL virtual void UnpinData(DGLContext ctx, void* ptr);
 
+  /*!
+   * \brief Allocate page-locked host memory, from a pool of the freed blocks.
+   *
+   * \param ctx The context of the GPU the memory is copied from and to.
+   * \param nbytes The size to be allocated.
+   * \return The host memory pointer.
+   */
+  DGL_DLL virtual void* AllocPinnedDataSpace(DGLContext ctx, size_t nbytes);
+
+  /*!
+   * \brief Free the host memory allocated by AllocPinnedDataSpace().
+   *
+   * \param ctx The context the memory was allocated for.
+   * \param ptr The host memory pointer.
+   */
+  DGL_DLL virtual void FreePinnedDataSpace(DGLContext ctx, void* ptr);
+
+  /*!
+   * \brief Check whether host memory is page-locked, i.e. allocated by
+   *        AllocPinnedDataSpace() or pinned by PinData() or another library.
+   *
+   * \param ctx The context of the device.
+   * \param ptr The host memory pointer.
+   */
+  DGL_DLL virtual bool IsPinned(DGLContext ctx, const void* ptr);
+
   /*!
    * \brief Allocate temporal workspace for backend execution.
    *
@@ -0,0 +1,80 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file dgl/runtime/huge_page.h
+ * \brief Huge page backed CPU memory.
+ *
+ * Huge pages are opt-in, by setting the environment variable
+ * DGL_CPU_HUGE_PAGES to
+ *
+ * - "thp": large CPU arrays and shared memory are advised to use transparent
+ *   huge pages (madvise MADV_HUGEPAGE), which the kernel may or may not
+ *   grant;
+ * - "2MB" or "1GB": large CPU arrays are allocated from the reserved huge
+ *   pages of that size (mmap MAP_HUGETLB), and shared memory is created as a
+ *   file in the hugetlbfs mount given by DGL_HUGETLBFS_DIR (/dev/hugepages by
+ *   default), whose page size is the one the mount was created with.
+ *
+ * Whenever huge pages are unavailable, e.g. none is reserved or the mount does
+ * not exist, the memory falls back to regular pages. Only Linux is supported.
+ *
+ * The arrays allocated by the tensor adapter, i.e. by the framework, are not
+ * affected.
+ */
+#ifndef DGL_RUNTIME_HUGE_PAGE_H_
+#define DGL_RUNTIME_HUGE_PAGE_H_
+
+#include <cstddef>
+#include <string>
+
+namespace dgl {
+namespace runtime {
+namespace huge_page {
+
+/*! \brief How the memory is backed by huge pages. */
+enum class Mode {
+  kNone = 0,
+  kTransparent,
+  k2MB,
+  k1GB,
+};
+
+/*! \brief Buffers smaller than this size always use regular pages. */
+constexpr size_t kMinBytes = 2 << 20;
+
+/*! \return The mode given by DGL_CPU_HUGE_PAGES. */
+Mode GetMode();
+
+/*! \return The mode of a value of DGL_CPU_HUGE_PAGES, kNone if invalid. */
+Mode ParseMode(const std::string& value);
+
+/*! \return The directory of the hugetlbfs mount for shared memory. */
+std::string HugetlbfsDir();
+
+/*!
+ * \brief Allocate a buffer from the reserved huge pages, in the 2MB and 1GB
+ *        modes.
+ * \param size The size of the buffer in bytes.
+ * \return The buffer, aligned to the huge page size, or nullptr if the mode
+ *         is not explicit or no huge page is available.
+ */
+void* Alloc(size_t size);
+
+/*!
+ * \brief Free a buffer allocated by Alloc.
+ * \return Whether the buffer has been allocated by Alloc.
+ */
+bool Free(void* ptr);
+
+/*!
+ * \brief Advise the kernel to back a mapped range with transparent huge
+ *        pages, in the thp mode.
+ * \param ptr The start of the range.
+ * \param size The size of the range in bytes.
+ */
+void Advise(void* ptr, size_t size);
+
+}  // namespace huge_page
+}  // namespace runtime
+}  // namespace dgl
+
+#endif  // DGL_RUNTIME_HUGE_PAGE_H_
@@ -0,0 +1,154 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file dgl/runtime/memory_tracker.h
+ * \brief Accounting of the memory held and copied by DGL.
+ *
+ * The tracker is opt-in, by setting the environment variable
+ * DGL_MEMORY_TRACKING=1 or calling MemoryTracker::Global()->SetEnabled(true).
+ * It then counts
+ *
+ * - the bytes of the arrays allocated by NDArray::Empty and
+ *   NDArray::PinnedEmpty, of the workspace pages and of the sampler arenas,
+ *   per device and per tag, until they are freed;
+ * - the bytes copied by the device APIs, per direction;
+ * - the conversions of the sparse formats done by the UnitGraphs.
+ *
+ * The memory allocated before the tracker is enabled is not counted, nor freed
+ * from the counts afterwards.
+ */
+#ifndef DGL_RUNTIME_MEMORY_TRACKER_H_
+#define DGL_RUNTIME_MEMORY_TRACKER_H_
+
+#include <dlpack/dlpack.h>
+
+#include <atomic>
+#include <cstdint>
+
+namespace dgl {
+namespace runtime {
+
+/*! \brief What the memory is allocated for. */
+enum class MemoryTag : int8_t {
+  /*! \brief Anything not tagged otherwise. */
+  kOther = 0,
+  /*! \brief The sparse formats of the graphs, e.g. created by a conversion. */
+  kGraph = 1,
+  /*! \brief The arrays allocated while sampling, results included. */
+  kSampler = 2,
+  /*! \brief The workspace pages of the device APIs. */
+  kWorkspace = 3,
+};
+
+/*!
+ * \brief Set the tag of the arrays allocated by the calling thread within the
+ *        scope, e.g.
+ *
+ * \code
+ * MemoryTagScope tag_scope(MemoryTag::kSampler);
+ * \endcode
+ */
+class MemoryTagScope {
+ public:
+  explicit MemoryTagScope(MemoryTag tag);
+  ~MemoryTagScope();
+
+  // disable copying
+  MemoryTagScope(const MemoryTagScope& other) = delete;
+  MemoryTagScope& operator=(const MemoryTagScope& other) = delete;
+
+  /*! \return The tag of the calling thread. */
+  static MemoryTag Current();
+
+ private:
+  MemoryTag prev_;
+};
+
+class MemoryTracker {
+ public:
+  static constexpr int kNumTags = 4;
+  /*! \brief The devices are the CPU, then the GPUs by id. */
+  static constexpr int kMaxGPUs = 32;
+  static constexpr int kNumDevices = kMaxGPUs + 1;
+  /*! \brief The copies are between the CPU (0) and a GPU (1). */
+  static constexpr int kNumCopyKinds = 2;
+  /*! \brief The sparse formats, indexed by SparseFormat. */
+  static constexpr int kNumFormats = 4;
+
+  /*! \brief The memory held by a device or a tag. */
+  struct Usage {
+    int64_t bytes;
+    int64_t peak_bytes;
+    int64_t num_allocs;
+  };
+
+  struct Snapshot {
+    bool enabled;
+    Usage devices[kNumDevices];
+    Usage tags[kNumTags];
+    /*! \brief Indexed by the source and destination kinds. */
+    int64_t copy_bytes[kNumCopyKinds][kNumCopyKinds];
+    int64_t num_copies[kNumCopyKinds][kNumCopyKinds];
+    /*! \brief Indexed by the source and created formats. */
+    int64_t num_conversions[kNumFormats][kNumFormats];
+  };
+
+  /*! \brief The tracker of the process. */
+  static MemoryTracker* Global();
+
+  bool Enabled() const {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  void SetEnabled(bool enabled) {
+    enabled_ = enabled;
+  }
+
+  /*!
+   * \brief Count an allocation, if enabled.
+   * \return Whether it is counted, and OnFree is to be called when it is freed.
+   */
+  bool OnAlloc(DLContext ctx, int64_t nbytes, MemoryTag tag);
+
+  /*! \brief Uncount an allocation counted by OnAlloc. */
+  void OnFree(DLContext ctx, int64_t nbytes, MemoryTag tag);
+
+  /*! \brief Count a copy, if enabled. */
+  void OnCopy(DLContext from, DLContext to, int64_t nbytes);
+
+  /*!
+   * \brief Count a conversion of sparse formats, if enabled.
+   * \param from The format converted, as a SparseFormat.
+   * \param to The format created, as a SparseFormat.
+   */
+  void OnConversion(int from, int to);
+
+  Snapshot GetSnapshot() const;
+
+  /*! \brief Reset the peaks to the current bytes and the other counters to 0. */
+  void Reset();
+
+ private:
+  struct Counter {
+    std::atomic<int64_t> bytes{0};
+    std::atomic<int64_t> peak_bytes{0};
+    std::atomic<int64_t> num_allocs{0};
+
+    void Add(int64_t nbytes);
+    void Reset();
+    Usage Get() const;
+  };
+
+  MemoryTracker();
+
+  std::atomic<bool> enabled_{false};
+  Counter devices_[kNumDevices];
+  Counter tags_[kNumTags];
+  std::atomic<int64_t> copy_bytes_[kNumCopyKinds][kNumCopyKinds];
+  std::atomic<int64_t> num_copies_[kNumCopyKinds][kNumCopyKinds];
+  std::atomic<int64_t> num_conversions_[kNumFormats][kNumFormats];
+};
+
+}  // namespace runtime
+}  // namespace dgl
+
+#endif  // DGL_RUNTIME_MEMORY_TRACKER_H_
@@ -219,6 +219,34 @@ class NDArray {
                                      DLDataType dtype,
                                      DLContext ctx,
                                      bool is_create);
+  /*!
+   * \brief Create an empty NDArray on the CPU in page-locked memory, which
+   *        the copies from and to a GPU run on asynchronously at full speed.
+   *
+   * The memory comes from a pool, since allocating it is slow.
+   * \param shape The shape of the new array.
+   * \param dtype The data type of the new array.
+   * \param ctx The context of the GPU.
+   * \return The created Array
+   */
+  DGL_DLL static NDArray PinnedEmpty(std::vector<int64_t> shape,
+                                     DLDataType dtype,
+                                     DLContext ctx);
+  /*!
+   * \brief Pin the memory of a CPU array in place, e.g. of the features in
+   *        shared memory, and map it into the address space of a GPU.
+   *
+   * Nothing is done if the memory is page-locked already. The memory is
+   * unpinned by UnpinMemory_(), or else right before the array is freed.
+   * \param ctx The context of the GPU.
+   */
+  DGL_DLL void PinMemory_(DLContext ctx);
+  /*!
+   * \brief Unpin the memory pinned by PinMemory_().
+   */
+  DGL_DLL void UnpinMemory_();
+  /*! \return Whether the data is in page-locked host memory. */
+  DGL_DLL bool IsPinned() const;
   /*!
    * \brief Get the size of the array in the number of bytes.
    */
@@ -368,6 +396,12 @@ struct NDArray::Container {
   std::vector<int64_t> stride_;
   /*! \brief The internal array object */
   std::atomic<int> ref_counter_{0};
+  /*! \brief Whether the data is pinned in place by NDArray::PinMemory_(). */
+  bool pinned_by_dgl_{false};
+  /*! \brief The GPU the data is page-locked for. */
+  DLContext pinned_ctx_{kDLGPU, 0};
+  /*! \brief The MemoryTag the data is counted for by the tracker, -1 if not. */
+  int8_t tracked_tag_{-1};
 };
 
 // implementations of inline functions
@@ -0,0 +1,79 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file dgl/runtime/numa.h
+ * \brief NUMA-aware placement of CPU threads and memory.
+ *
+ * The NUMA mode is opt-in, by setting the environment variable
+ * DGL_CPU_NUMA_ENABLED=1. In this mode
+ *
+ * - the OpenMP threads running runtime::parallel_for are pinned to the NUMA
+ *   nodes in contiguous groups, so that the contiguous chunk of every thread
+ *   is always computed on the same node;
+ * - large CPU arrays allocated by DGL are first-touched with the same
+ *   partition, so that the pages of a chunk live on the node of the thread
+ *   that writes it;
+ * - feature matrices can be interleaved across the nodes with Interleave.
+ *
+ * All the functions are no-ops on systems other than Linux or with a single
+ * NUMA node.
+ */
+#ifndef DGL_RUNTIME_NUMA_H_
+#define DGL_RUNTIME_NUMA_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace dgl {
+namespace runtime {
+namespace numa {
+
+/*! \return Whether the NUMA mode is enabled. */
+bool Enabled();
+
+/*! \return The number of NUMA nodes, 1 if unknown. */
+int NumNodes();
+
+/*!
+ * \brief Pin the calling thread to the NUMA node of its thread id.
+ *
+ * Thread tid out of num_threads goes to node tid * NumNodes() / num_threads,
+ * i.e. the threads are split into NumNodes() contiguous groups. The calling
+ * thread is only pinned again when its node changes.
+ *
+ * \param tid The id of the thread, e.g. omp_get_thread_num().
+ * \param num_threads The number of threads, e.g. omp_get_max_threads().
+ */
+void BindThread(int tid, int num_threads);
+
+/*!
+ * \brief Touch the pages of a buffer with the thread partition of
+ *        runtime::parallel_for, so that they are allocated on the NUMA node
+ *        of the thread covering them.
+ * \param ptr The buffer, whose pages must not have been touched yet.
+ * \param size The size of the buffer in bytes.
+ */
+void FirstTouch(void* ptr, size_t size);
+
+/*!
+ * \brief Interleave the pages of a buffer across all the NUMA nodes.
+ *
+ * Pages already allocated are migrated. It is useful for read-only feature
+ * matrices gathered by all the threads.
+ *
+ * \param ptr The buffer.
+ * \param size The size of the buffer in bytes.
+ */
+void Interleave(void* ptr, size_t size);
+
+/*!
+ * \brief Parse a Linux cpu list, e.g. "0-3,8,10-11".
+ * \return The cpu ids.
+ */
+std::vector<int> ParseCpuList(const std::string& cpulist);
+
+}  // namespace numa
+}  // namespace runtime
+}  // namespace dgl
+
+#endif  // DGL_RUNTIME_NUMA_H_
@@ -12,6 +12,8 @@
 #include <cstdlib>
 #include <exception>
 #include <atomic>
+#include "numa.h"
+#include "task_scheduler.h"
 
 namespace {
 int64_t divup(int64_t x, int64_t y) {
@@ -50,12 +52,32 @@ struct DefaultGrainSizeT {
 
 static DefaultGrainSizeT default_grain_size;
 
+/*!
+ * \brief Run a loop on the work-stealing scheduler, in ranges of at least
+ *        grain_size iterations, a few per thread for the idle threads to steal.
+ */
+template <typename F>
+void parallel_for_work_stealing(
+    const size_t begin,
+    const size_t end,
+    const size_t grain_size,
+    F&& f) {
+  TaskScheduler* scheduler = TaskScheduler::Global();
+  const size_t range_size = std::max<size_t>(
+      grain_size, divup(end - begin, 4 * scheduler->NumThreads()));
+  scheduler->ParallelFor(begin, end, range_size, f);
+}
+
 /*!
  * \brief OpenMP-based parallel for loop.
  *
  * It requires each thread's workload to have at least \a grain_size elements.
+ * In the NUMA mode (see dgl/runtime/numa.h), every thread is pinned to the NUMA
+ * node of its thread id.
  * The loop body will be a function that takes in a single argument \a i, which
  * stands for the index of the workload.
+ * With the work-stealing scheduler (see dgl/runtime/task_scheduler.h), the
+ * body runs on more, smaller chunks, and nested loops run in parallel too.
  */
 template <typename F>
 void parallel_for(
@@ -66,16 +88,25 @@ void parallel_for(
   if (begin >= end) {
     return;
   }
+  if (TaskScheduler::Enabled()) {
+    parallel_for_work_stealing(begin, end, grain_size, f);
+    return;
+  }
 
 #ifdef _OPENMP
   auto num_threads = compute_num_threads(begin, end, grain_size);
   // (BarclayII) the exception code is borrowed from PyTorch.
   std::atomic_flag err_flag = ATOMIC_FLAG_INIT;
   std::exception_ptr eptr;
+  // the threads are pinned by their id out of all the OpenMP threads, so that
+  // a thread stays on the same NUMA node whatever the size of the team
+  const int numa_num_threads = numa::Enabled() ? omp_get_max_threads() : 0;
 
 #pragma omp parallel num_threads(num_threads)
   {
     auto tid = omp_get_thread_num();
+    if (numa_num_threads > 0)
+      numa::BindThread(tid, numa_num_threads);
     auto chunk_size = divup((end - begin), num_threads);
     auto begin_tid = begin + tid * chunk_size;
     if (begin_tid < end) {
@@ -110,6 +141,124 @@ void parallel_for(
     F&& f) {
   parallel_for(begin, end, default_grain_size(), std::forward<F>(f));
 }
+
+/*!
+ * \brief OpenMP-based parallel for loop balanced by cost.
+ *
+ * Like parallel_for, every thread runs the loop body once on a contiguous
+ * chunk, but the chunks hold about the same cost instead of the same number of
+ * elements. Element i costs cost_prefix[i + 1] - cost_prefix[i] plus one, so
+ * that elements of no cost are still spread. It is meant for loops over the
+ * rows of a Csr matrix whose work grows with the row degree, with the indptr
+ * array of the matrix as cost_prefix.
+ *
+ * With the work-stealing scheduler, the chunks of about the same cost are
+ * more numerous than the threads.
+ *
+ * \param cost_prefix The non-decreasing prefix sum of the costs, read at
+ *        [begin, end].
+ */
+template <typename CostType, typename F>
+void parallel_for_weighted(
+    const size_t begin,
+    const size_t end,
+    const CostType* cost_prefix,
+    F&& f) {
+  if (begin >= end) {
+    return;
+  }
+
+#ifdef _OPENMP
+  const bool work_stealing = TaskScheduler::Enabled();
+  auto num_threads = work_stealing ?
+    std::min(end - begin, static_cast<size_t>(4 * TaskScheduler::Global()->NumThreads())) :
+    compute_num_threads(begin, end, default_grain_size());
+  if (num_threads == 1) {
+    f(begin, end);
+    return;
+  }
+  // the cost of [begin, i), strictly increasing in i
+  auto cost_before = [=](size_t i) -> int64_t {
+    return static_cast<int64_t>(cost_prefix[i] - cost_prefix[begin]) + (i - begin);
+  };
+  // the first element whose preceding cost reaches target
+  auto find_boundary = [=](int64_t target) -> size_t {
+    size_t lo = begin, hi = end;
+    while (lo < hi) {
+      const size_t mid = lo + (hi - lo) / 2;
+      if (cost_before(mid) < target)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    return lo;
+  };
+  const int64_t total_cost = cost_before(end);
+  if (work_stealing) {
+    TaskScheduler::Global()->ParallelFor(0, num_threads, 1, [&](size_t b, size_t e) {
+      for (size_t chunk = b; chunk < e; ++chunk) {
+        const size_t begin_chunk = find_boundary(total_cost * chunk / num_threads);
+        const size_t end_chunk = find_boundary(total_cost * (chunk + 1) / num_threads);
+        if (begin_chunk < end_chunk)
+          f(begin_chunk, end_chunk);
+      }
+    });
+    return;
+  }
+  std::atomic_flag err_flag = ATOMIC_FLAG_INIT;
+  std::exception_ptr eptr;
+  const int numa_num_threads = numa::Enabled() ? omp_get_max_threads() : 0;
+
+#pragma omp parallel num_threads(num_threads)
+  {
+    auto tid = omp_get_thread_num();
+    if (numa_num_threads > 0)
+      numa::BindThread(tid, numa_num_threads);
+    const size_t begin_tid = find_boundary(total_cost * tid / num_threads);
+    const size_t end_tid = find_boundary(total_cost * (tid + 1) / num_threads);
+    if (begin_tid < end_tid) {
+      try {
+        f(begin_tid, end_tid);
+      } catch (...) {
+        if (!err_flag.test_and_set())
+          eptr = std::current_exception();
+      }
+    }
+  }
+  if (eptr)
+    std::rethrow_exception(eptr);
+#else
+  f(begin, end);
+#endif
+}
+
+/*!
+ * \brief Run f(i) for every i in [begin, end) as separate tasks.
+ *
+ * It is meant for loops with a few iterations of very different costs, each
+ * running parallel_for itself, e.g. over the relations of a heterograph. With
+ * the work-stealing scheduler, the iterations run in parallel and the threads
+ * move between the inner loops as they finish. Otherwise they run one after
+ * the other, the inner loops using all the OpenMP threads.
+ *
+ * The iterations must not depend on running on the calling thread, e.g. on
+ * its CUDA stream.
+ */
+template <typename F>
+void parallel_for_tasks(
+    const size_t begin,
+    const size_t end,
+    F&& f) {
+  if (!TaskScheduler::Enabled()) {
+    for (size_t i = begin; i < end; ++i)
+      f(i);
+    return;
+  }
+  TaskScheduler::Global()->ParallelFor(begin, end, 1, [&f](size_t b, size_t e) {
+    for (size_t i = b; i < e; ++i)
+      f(i);
+  });
+}
 }  // namespace runtime
 }  // namespace dgl
 
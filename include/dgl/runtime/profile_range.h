@@ -0,0 +1,101 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file dgl/runtime/profile_range.h
+ * \brief Named ranges of the time spent in DGL, for Nsight Systems and VTune.
+ *
+ * The ranges are only compiled in with the build option USE_PROFILING_RANGES,
+ * and DGL_PROFILE_RANGE expands to nothing otherwise. They are NVTX ranges in
+ * the CUDA builds, and ITT tasks when the ITT API of VTune is found (see
+ * VTUNE_PROFILER_DIR in CMakeLists.txt).
+ *
+ * A range covers the rest of the enclosing scope, e.g.
+ *
+ *   DGL_PROFILE_RANGE("SpMM", op, reduce, ufeat, out);
+ *
+ * names the range by the first argument, followed by the other ones, arrays
+ * being given by their shape ("SpMM copy_lhs sum [100,16] [50,16]").
+ */
+#ifndef DGL_RUNTIME_PROFILE_RANGE_H_
+#define DGL_RUNTIME_PROFILE_RANGE_H_
+
+#ifdef DGL_USE_PROFILING_RANGES
+
+#include <sstream>
+#include <string>
+#include "ndarray.h"
+
+namespace dgl {
+namespace runtime {
+
+/*! \brief A range of the profilers, from construction to destruction. */
+class ProfileRange {
+ public:
+  explicit ProfileRange(const char* name) {
+    Begin(name);
+  }
+
+  template <typename... Args>
+  ProfileRange(const char* name, const Args&... details) {
+    std::ostringstream os;
+    os << name;
+    Append(&os, details...);
+    Begin(os.str().c_str());
+  }
+
+  ~ProfileRange() {
+    End();
+  }
+
+  // disable copying
+  ProfileRange(const ProfileRange& other) = delete;
+  ProfileRange& operator=(const ProfileRange& other) = delete;
+
+  /*! \brief Open a range not bound to a scope, e.g. of the Python frontend. */
+  static void Begin(const char* name);
+  /*! \brief Close the last range opened by Begin. */
+  static void End();
+
+ private:
+
+  static void Append(std::ostringstream* os) {}
+
+  template <typename T, typename... Args>
+  static void Append(std::ostringstream* os, const T& detail, const Args&... details) {
+    *os << ' ';
+    Write(os, detail);
+    Append(os, details...);
+  }
+
+  template <typename T>
+  static void Write(std::ostringstream* os, const T& detail) {
+    *os << detail;
+  }
+
+  static void Write(std::ostringstream* os, const NDArray& array) {
+    if (!array.defined()) {
+      *os << "none";
+      return;
+    }
+    *os << '[';
+    for (int i = 0; i < array->ndim; ++i)
+      *os << (i ? "," : "") << array->shape[i];
+    *os << ']';
+  }
+};
+
+}  // namespace runtime
+}  // namespace dgl
+
+#define DGL_PROFILE_RANGE_CONCAT_(a, b) a ## b
+#define DGL_PROFILE_RANGE_CONCAT(a, b) DGL_PROFILE_RANGE_CONCAT_(a, b)
+#define DGL_PROFILE_RANGE(...)                                          \
+  ::dgl::runtime::ProfileRange DGL_PROFILE_RANGE_CONCAT(                \
+      _dgl_profile_range_, __LINE__)(__VA_ARGS__)
+
+#else  // DGL_USE_PROFILING_RANGES
+
+#define DGL_PROFILE_RANGE(...)
+
+#endif  // DGL_USE_PROFILING_RANGES
+
+#endif  // DGL_RUNTIME_PROFILE_RANGE_H_
@@ -99,6 +99,8 @@ class Registry {
   std::string name_;
   /*! \brief internal packed function */
   PackedFunc func_;
+  /*! \brief whether func_ is ready to be called, see Get */
+  bool materialized_{false};
   friend struct Manager;
 };
 
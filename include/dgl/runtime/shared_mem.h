@@ -42,6 +42,14 @@ class SharedMemory {
    */
   std::string name;
 
+  /*
+   * \brief the file of the shared memory in hugetlbfs.
+   *
+   * It is empty unless the shared memory is backed by explicit huge pages,
+   * see dgl/runtime/huge_page.h.
+   */
+  std::string huge_page_file_;
+
  public:
   /* \brief Get the filename of shared memory file
    */
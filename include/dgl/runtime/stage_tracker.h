@@ -0,0 +1,216 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file dgl/runtime/stage_tracker.h
+ * \brief Timers and counters of the stages of the sampling pipelines.
+ *
+ * The tracker is opt-in, by setting the environment variable
+ * DGL_STAGE_TRACKING=1 or calling StageTracker::Global()->SetEnabled(true).
+ * It then counts, for every stage of SamplingStage, the calls, the seed nodes,
+ * the edges produced, the bytes gathered or copied, the wall time and the CPU
+ * time of the process during the calls.
+ *
+ * With DGL_STAGE_TRACE=1 or SetTracing(true), every call is also recorded as
+ * an event of a trace in the Chrome trace format, tagged with the minibatch
+ * set by StageBatchScope, for chrome://tracing or Perfetto.
+ *
+ * The stages may nest, e.g. ExcludeEdges within SampleNeighbors, and the
+ * stages of the GPU graphs are timed on the host, when their kernels are
+ * launched.
+ */
+#ifndef DGL_RUNTIME_STAGE_TRACKER_H_
+#define DGL_RUNTIME_STAGE_TRACKER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ndarray.h"
+
+namespace dgl {
+namespace runtime {
+
+/*! \brief The stages of a sampling pipeline. */
+enum class SamplingStage : int8_t {
+  /*! \brief The neighbor sampling of the seed nodes, excluded edges included. */
+  kSampleNeighbors = 0,
+  /*! \brief The exclusion of edges from the sampled ones. */
+  kExcludeEdges = 1,
+  /*! \brief The conversion of the sampled frontiers to blocks. */
+  kToBlock = 2,
+  /*! \brief The gathering of the features of the sampled nodes. */
+  kGather = 3,
+  /*! \brief The copies of the graphs and arrays to another device. */
+  kCopyTo = 4,
+};
+
+class StageTracker {
+ public:
+  static constexpr int kNumStages = 5;
+  /*! \brief The largest number of events of a trace, the later ones being dropped. */
+  static constexpr size_t kMaxTraceEvents = 1 << 20;
+
+  /*! \brief The counters of a stage. */
+  struct Counters {
+    int64_t num_calls;
+    int64_t num_seeds;
+    int64_t num_edges;
+    int64_t num_bytes;
+    int64_t wall_ns;
+    /*! \brief The CPU time of the process, all threads included. */
+    int64_t cpu_ns;
+    /*!
+     * \brief The wall time times the number of threads of the calls, so that
+     *        cpu_ns / thread_ns is the utilization of the threads.
+     */
+    int64_t thread_ns;
+  };
+
+  /*! \brief A call of a stage. */
+  struct Record {
+    SamplingStage stage;
+    int64_t batch;
+    int64_t start_ns;
+    int64_t wall_ns;
+    int64_t cpu_ns;
+    int num_threads;
+    int64_t num_seeds;
+    int64_t num_edges;
+    int64_t num_bytes;
+  };
+
+  /*! \brief The tracker of the process. */
+  static StageTracker* Global();
+
+  bool Enabled() const {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  void SetEnabled(bool enabled) {
+    enabled_ = enabled;
+  }
+
+  bool Tracing() const {
+    return tracing_.load(std::memory_order_relaxed);
+  }
+
+  void SetTracing(bool tracing) {
+    tracing_ = tracing;
+  }
+
+  /*! \brief Count a call, and record it in the trace if tracing. */
+  void OnCall(const Record& record);
+
+  /*! \return The counters of the stages, indexed by SamplingStage. */
+  std::vector<Counters> GetCounters() const;
+
+  /*! \return The events recorded since the last reset, in the Chrome trace format. */
+  std::string GetTrace() const;
+
+  /*! \brief Reset the counters to 0 and drop the events of the trace. */
+  void Reset();
+
+  /*! \return The time of a monotonic clock, in nanoseconds. */
+  static int64_t NowNs();
+
+  /*! \return The CPU time of the process, in nanoseconds, or 0 if unsupported. */
+  static int64_t CPUTimeNs();
+
+ private:
+  struct Counter {
+    std::atomic<int64_t> num_calls{0};
+    std::atomic<int64_t> num_seeds{0};
+    std::atomic<int64_t> num_edges{0};
+    std::atomic<int64_t> num_bytes{0};
+    std::atomic<int64_t> wall_ns{0};
+    std::atomic<int64_t> cpu_ns{0};
+    std::atomic<int64_t> thread_ns{0};
+  };
+
+  /*! \brief An event of the trace, i.e. a record with the thread that made it. */
+  struct TraceEvent {
+    Record record;
+    int thread;
+  };
+
+  StageTracker();
+
+  std::atomic<bool> enabled_{false};
+  std::atomic<bool> tracing_{false};
+  Counter stages_[kNumStages];
+  mutable std::mutex trace_mutex_;
+  std::vector<TraceEvent> trace_;
+  int64_t num_dropped_ = 0;
+};
+
+/*!
+ * \brief Time and count the rest of the enclosing scope as a call of a stage,
+ *        if the tracker is enabled or tracing, e.g.
+ *
+ * \code
+ * StageScope stage_scope(SamplingStage::kToBlock);
+ * stage_scope.AddSeeds(rhs_nodes);
+ * \endcode
+ */
+class StageScope {
+ public:
+  explicit StageScope(SamplingStage stage);
+  ~StageScope();
+
+  // disable copying
+  StageScope(const StageScope& other) = delete;
+  StageScope& operator=(const StageScope& other) = delete;
+
+  /*! \return Whether the call is counted, i.e. the counts are to be computed. */
+  bool active() const {
+    return active_;
+  }
+
+  void AddSeeds(int64_t num_seeds) {
+    record_.num_seeds += num_seeds;
+  }
+
+  /*! \brief Count the elements of the arrays as seed nodes. */
+  void AddSeeds(const std::vector<NDArray>& seeds);
+
+  void AddEdges(int64_t num_edges) {
+    record_.num_edges += num_edges;
+  }
+
+  /*! \brief Count the elements of the arrays as edges produced. */
+  void AddEdges(const std::vector<NDArray>& edges);
+
+  void AddBytes(int64_t num_bytes) {
+    record_.num_bytes += num_bytes;
+  }
+
+ private:
+  bool active_;
+  StageTracker::Record record_;
+};
+
+/*!
+ * \brief Set the minibatch of the stages called by the calling thread within
+ *        the scope, which tags their events in the trace.
+ */
+class StageBatchScope {
+ public:
+  explicit StageBatchScope(int64_t batch);
+  ~StageBatchScope();
+
+  // disable copying
+  StageBatchScope(const StageBatchScope& other) = delete;
+  StageBatchScope& operator=(const StageBatchScope& other) = delete;
+
+  /*! \return The minibatch of the calling thread, -1 if none. */
+  static int64_t Current();
+
+ private:
+  int64_t prev_;
+};
+
+}  // namespace runtime
+}  // namespace dgl
+
+#endif  // DGL_RUNTIME_STAGE_TRACKER_H_
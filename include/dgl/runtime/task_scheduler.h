@@ -0,0 +1,147 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file dgl/runtime/task_scheduler.h
+ * \brief A work-stealing scheduler of CPU tasks supporting nested parallelism.
+ *
+ * The scheduler is opt-in, by setting the environment variable
+ * DGL_PARALLEL_FOR_SCHEDULER=work_stealing. runtime::parallel_for then runs on
+ * it instead of OpenMP, and the loops of runtime::parallel_for_tasks (e.g. over
+ * the relations of a heterograph) run their iterations in parallel, with the
+ * parallel_for calls inside them sharing the same threads.
+ *
+ * The scheduler does not depend on the OpenMP thread count, which other
+ * libraries of the process (e.g. PyTorch) change too. Its threads are set by
+ *
+ * - DGL_CPU_CORES, the cpu list of the cores of the process, e.g. "0-23,48-71",
+ *   so that processes sharing a machine (e.g. the sampling workers and the
+ *   trainer) use disjoint cores: each worker thread is pinned to one of them;
+ * - DGL_NUM_THREADS, the number of threads, by default the size of
+ *   DGL_CPU_CORES if set, or else omp_get_max_threads().
+ */
+#ifndef DGL_RUNTIME_TASK_SCHEDULER_H_
+#define DGL_RUNTIME_TASK_SCHEDULER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dgl {
+namespace runtime {
+
+/*!
+ * \brief A pool of threads running ranges of loop iterations, each thread
+ *        splitting its ranges in halves and the idle threads stealing them.
+ *
+ * Every thread owns a deque of ranges: it pushes and pops at the back, so that
+ * it keeps working on the smallest and most recent ranges, while the other
+ * threads steal at the front, i.e. the largest ones. A thread waiting for its
+ * loop to finish runs the ranges of any loop meanwhile, so the loops started
+ * from inside a loop body run in parallel too, without more threads.
+ *
+ * The threads calling ParallelFor from outside the pool share one more deque.
+ */
+class TaskScheduler {
+ public:
+  /*! \brief The body of a loop, called on a range of iterations. */
+  typedef std::function<void(size_t, size_t)> RangeFn;
+
+  /*!
+   * \param num_workers The number of threads of the pool, besides the threads
+   *        calling ParallelFor.
+   * \param cores The cpus to pin the threads to, none if empty. Worker i is
+   *        pinned to cores[(i + 1) % cores.size()], the first being left to the
+   *        calling thread.
+   */
+  explicit TaskScheduler(int num_workers, std::vector<int> cores = std::vector<int>());
+  ~TaskScheduler();
+
+  // disable copying
+  TaskScheduler(const TaskScheduler& other) = delete;
+  TaskScheduler& operator=(const TaskScheduler& other) = delete;
+
+  /*!
+   * \brief The scheduler of the process, configured by DGL_NUM_THREADS and
+   *        DGL_CPU_CORES when first used in the process.
+   *
+   * The thread first calling it is pinned to all of DGL_CPU_CORES, like the
+   * threads it starts afterwards. A forked child process, whose threads are
+   * gone, creates a scheduler of its own.
+   */
+  static TaskScheduler* Global();
+
+  /*! \return Whether parallel_for runs on the global scheduler. */
+  static bool Enabled();
+
+  /*! \return The number of threads running the loops, the caller included. */
+  int NumThreads() const { return static_cast<int>(workers_.size()) + 1; }
+
+  /*!
+   * \brief Run f on disjoint ranges covering [begin, end), of at most
+   *        grain_size iterations, and return once all are done.
+   *
+   * The first exception thrown by f is rethrown, once the other ranges are
+   * done.
+   */
+  void ParallelFor(size_t begin, size_t end, size_t grain_size, const RangeFn& f);
+
+ private:
+  /*! \brief The state of a ParallelFor call. */
+  struct Loop {
+    const RangeFn* f;
+    size_t grain_size;
+    /*! \brief The number of ranges not done yet. */
+    std::atomic<int64_t> num_pending{0};
+    std::atomic_flag err_flag = ATOMIC_FLAG_INIT;
+    std::exception_ptr eptr;
+  };
+
+  struct Task {
+    Loop* loop;
+    size_t begin, end;
+  };
+
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  /*! \return The deque of the calling thread. */
+  Queue* LocalQueue();
+
+  /*! \brief Push a task to the deque of the calling thread. */
+  void Push(Queue* queue, const Task& task);
+
+  /*! \brief Pop a task of the calling thread, or else steal one. */
+  bool Pop(Queue* queue, Task* task);
+
+  /*! \brief Run a task, pushing its second half as long as it is too large. */
+  void Run(Queue* queue, Task task);
+
+  void WorkerLoop(int worker_id);
+
+  /*! \brief The cpus of the threads. */
+  std::vector<int> cores_;
+
+  /*! \brief One deque per worker, and the deque of the other threads last. */
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> workers_;
+
+  /*! \brief The number of queued tasks, for the idle workers to sleep. */
+  std::atomic<int64_t> num_queued_{0};
+  std::atomic<int> num_sleepers_{0};
+  std::mutex sleep_mutex_;
+  std::condition_variable sleep_cond_;
+  bool stop_ = false;
+};
+
+}  // namespace runtime
+}  // namespace dgl
+
+#endif  // DGL_RUNTIME_TASK_SCHEDULER_H_
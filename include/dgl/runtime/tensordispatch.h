@@ -78,6 +78,34 @@ class TensorDispatcher {
     return NDArray::FromDLPack(result);
   }
 
+  /*!
+   * \brief Whether the adapter library allocates the GPU memory of DGL, which an
+   *        adapter built without CUDA or before TAalloc does not.
+   */
+  inline bool IsWorkspaceAvailable() const {
+    return available_ && entrypoints_[Op::kAlloc] && entrypoints_[Op::kFree];
+  }
+
+  /*!
+   * \brief Allocate a piece of GPU memory from the allocator of the framework, so
+   *        that DGL and the framework share one cache of device memory.
+   *
+   * Used in the workspaces of CUDADeviceAPI, e.g. the temporary storage of CUB and
+   * the buffers of cuSPARSE.
+   *
+   * \note Only valid if IsWorkspaceAvailable().
+   */
+  inline void* AllocWorkspace(size_t nbytes, int device_id, void* stream) const {
+    auto entry = entrypoints_[Op::kAlloc];
+    return FUNCCAST(tensoradapter::TAalloc, entry)(nbytes, device_id, stream);
+  }
+
+  /*! \brief Free the GPU memory allocated by AllocWorkspace. */
+  inline void FreeWorkspace(void* ptr) const {
+    auto entry = entrypoints_[Op::kFree];
+    FUNCCAST(tensoradapter::TAfree, entry)(ptr);
+  }
+
  private:
   /*! \brief ctor */
   TensorDispatcher() = default;
@@ -91,14 +119,21 @@ class TensorDispatcher {
    */
   static constexpr const char *names_[] = {
     "TAempty",
+    "TAalloc",
+    "TAfree",
   };
 
   /*! \brief Index of each function to the symbol list */
   class Op {
    public:
     static constexpr int kEmpty = 0;
+    static constexpr int kAlloc = 1;
+    static constexpr int kFree = 2;
   };
 
+  /*! \brief Number of functions every adapter library must have */
+  static constexpr int num_required_entries_ = 1;
+
   /*! \brief Number of functions */
   static constexpr int num_entries_ = sizeof(names_) / sizeof(names_[0]);
 
@@ -0,0 +1,83 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file dgl/sampling/layer.h
+ * \brief Layer-wise importance sampling.
+ */
+#ifndef DGL_SAMPLING_LAYER_H_
+#define DGL_SAMPLING_LAYER_H_
+
+#include <dgl/base_heterograph.h>
+#include <dgl/array.h>
+#include <vector>
+
+namespace dgl {
+namespace sampling {
+
+/*! \brief The importance distribution the nodes of a layer are drawn from. */
+enum class LayerImportance {
+  /*!
+   * \brief LADIES: a candidate is drawn with a probability proportional to the
+   *        sum of the squared weights of its edges to the output nodes of the layer.
+   */
+  kLADIES = 0,
+  /*!
+   * \brief FastGCN: a candidate is drawn with a probability proportional to the
+   *        sum of the squared weights of all its out-edges, whatever the layer.
+   */
+  kFastGCN = 1,
+};
+
+/*!
+ * \brief The blocks of a layer-wise sampling, with the weights of their edges.
+ */
+struct LayerSampledBlocks {
+  /*! \brief The blocks, from the input layer to the output one. */
+  std::vector<HeteroGraphPtr> blocks;
+  /*!
+   * \brief The source node IDs of every block. The destination nodes of a block
+   *        are its first source nodes.
+   */
+  std::vector<IdArray> src_nodes;
+  /*! \brief The edge IDs of every block. */
+  std::vector<IdArray> induced_edges;
+  /*!
+   * \brief The edge weights of every block, debiased by the importance of their
+   *        source node and normalized to sum to one over the in-edges of a node.
+   */
+  std::vector<FloatArray> edge_weights;
+};
+
+/*!
+ * \brief Sample the input nodes of every layer of a GNN computing the outputs of
+ *        the given nodes, and return the blocks of the layers.
+ *
+ * Going from the last layer to the first, the candidates of a layer are the
+ * in-neighbors of its output nodes. A fixed number of them is drawn from the
+ * importance distribution and the block keeps the in-edges of the output nodes
+ * coming from the drawn nodes. The output nodes are included in the input nodes,
+ * which are the output nodes of the previous layer.
+ *
+ * Only CPU graphs with a single node and edge type are supported.
+ *
+ * \param hg The input graph.
+ * \param seeds The output node IDs of the last layer.
+ * \param num_samples The number of nodes drawn for every layer, from the first to
+ *        the last.
+ * \param weight The 1D float array of the edge weights. An empty array gives every
+ *        edge a weight of one.
+ * \param importance The importance distribution.
+ * \param replace If true, draw the nodes with replacement.
+ * \return The blocks with their source node IDs, edge IDs and edge weights.
+ */
+LayerSampledBlocks SampleLayerBlocks(
+    const HeteroGraphPtr hg,
+    IdArray seeds,
+    const std::vector<int64_t>& num_samples,
+    FloatArray weight,
+    LayerImportance importance,
+    bool replace = false);
+
+}  // namespace sampling
+}  // namespace dgl
+
+#endif  // DGL_SAMPLING_LAYER_H_
@@ -0,0 +1,49 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file dgl/sampling/negative.h
+ * \brief Negative sampling for link prediction.
+ */
+#ifndef DGL_SAMPLING_NEGATIVE_H_
+#define DGL_SAMPLING_NEGATIVE_H_
+
+#include <dgl/base_heterograph.h>
+#include <dgl/array.h>
+#include <vector>
+
+namespace dgl {
+namespace sampling {
+
+/*!
+ * \brief Make negative examples by corrupting one end of the given edges.
+ *
+ * Every edge (u, v) gives k negative edges, (u, v') when corrupting the
+ * destination and (u', v) when corrupting the source, the corrupted end being
+ * drawn from all the nodes of its type, uniformly or in proportion to the given
+ * weights, e.g. the degrees to the power 0.75.
+ *
+ * With num_trials > 0, a negative edge that exists in the graph is drawn again,
+ * up to num_trials draws in all, looking it up in the CSR matrix of its edge
+ * type, and the ones still existing after that are dropped.
+ *
+ * \param hg The input graph.
+ * \param eids The IDs of the edges to corrupt by edge type. Empty arrays are allowed.
+ * \param k The number of negative edges of every edge.
+ * \param corrupt_src If true, corrupt the sources, else the destinations.
+ * \param prob The weights of the nodes of the corrupted type by edge type. An
+ *        empty float array draws the nodes uniformly.
+ * \param num_trials The number of draws of a negative edge before it is dropped for
+ *        existing in the graph, or 0 to keep the existing ones.
+ * \return The negative edges by edge type, in the order of the given edges.
+ */
+std::vector<aten::COOMatrix> CorruptEdges(
+    const HeteroGraphPtr hg,
+    const std::vector<IdArray>& eids,
+    int64_t k,
+    bool corrupt_src,
+    const std::vector<FloatArray>& prob,
+    int64_t num_trials);
+
+}  // namespace sampling
+}  // namespace dgl
+
+#endif  // DGL_SAMPLING_NEGATIVE_H_
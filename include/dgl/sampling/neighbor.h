@@ -8,6 +8,7 @@
 
 #include <dgl/base_heterograph.h>
 #include <dgl/array.h>
+#include <utility>
 #include <vector>
 
 namespace dgl {
@@ -33,8 +34,18 @@ namespace sampling {
  * \param exclude_edges Edges IDs of each type which will be excluded during sampling.
  *        The vector length must be equal to the number of edges types. Empty array is allowed.
  * \param replace If true, sample with replacement.
+ * \param alias_accept The acceptance probabilities of the alias tables of probability
+ *        by edge type, see BuildAliasTable. Missing or empty arrays keep the sampling
+ *        without them.
+ * \param alias The aliases of the alias tables of probability by edge type.
+ * \param mask The 8-bit masks over the edge IDs of every edge type, see
+ *        aten::CSRRowWiseSampling. Only the edges of nonzero mask are sampled. Missing
+ *        or empty arrays sample all the edges. The alias tables are not used with a mask.
  * \return Sampled neighborhoods as a graph. The return graph has the same schema as the
  *         original one.
+ * \note Under a RowStreamScope of the calling thread, the neighbors sampled for a node
+ *       on CPU only depend on the key of the scope, the edge type and the node, see
+ *       RowStreamKey, whatever the number of threads.
  */
 HeteroSubgraph SampleNeighbors(
     const HeteroGraphPtr hg,
@@ -43,7 +54,79 @@ HeteroSubgraph SampleNeighbors(
     EdgeDir dir,
     const std::vector<FloatArray>& probability,
     const std::vector<IdArray>& exclude_edges,
-    bool replace = true);
+    bool replace = true,
+    const std::vector<FloatArray>& alias_accept = {},
+    const std::vector<IdArray>& alias = {},
+    const std::vector<NDArray>& mask = {});
+
+/*!
+ * \brief The message flow graphs (blocks) of a multi-layer neighbor sampling.
+ */
+struct SampledBlocks {
+  /*! \brief The blocks, from the input layer to the output one. */
+  std::vector<HeteroGraphPtr> blocks;
+  /*!
+   * \brief The source node IDs of every block by node type. The destination nodes
+   *        of a block are its first source nodes.
+   */
+  std::vector<std::vector<IdArray>> src_nodes;
+  /*! \brief The edge IDs of every block by edge type. */
+  std::vector<std::vector<IdArray>> induced_edges;
+};
+
+/*!
+ * \brief Sample the in-edges of the given nodes layer by layer and return the
+ *        blocks of a multi-layer GNN computing their outputs.
+ *
+ * It is equivalent to SampleNeighbors followed by ToBlock with the destination
+ * nodes included in the source ones, from the last layer to the first, the source
+ * nodes of a block being the seeds of the previous layer. A single ID map per node
+ * type relabels the nodes of all the layers, and no intermediate graph is created.
+ *
+ * Only CPU graphs are supported.
+ *
+ * \param hg The input graph.
+ * \param seeds The output node IDs of each type. The vector length must be equal to
+ *              the number of node types. Empty array is allowed.
+ * \param fanouts Number of sampled neighbors for each edge type, for every layer from
+ *                the first to the last.
+ * \param probability A vector of 1D float arrays, indicating the transition probability of
+ *        each edge by edge type.  An empty float array assumes uniform transition.
+ * \param replace If true, sample with replacement.
+ * \param alias_accept The acceptance probabilities of the alias tables of probability
+ *        for in-edges by edge type, see SampleNeighbors.
+ * \param alias The aliases of the alias tables of probability by edge type.
+ * \return The blocks with their source node IDs and edge IDs.
+ * \note Under a RowStreamScope, the nodes of the layers draw from the key of the
+ *       scope derived by layer, as for SampleNeighbors.
+ */
+SampledBlocks SampleNeighborBlocks(
+    const HeteroGraphPtr hg,
+    const std::vector<IdArray>& seeds,
+    const std::vector<std::vector<int64_t>>& fanouts,
+    const std::vector<FloatArray>& probability,
+    bool replace = true,
+    const std::vector<FloatArray>& alias_accept = {},
+    const std::vector<IdArray>& alias = {});
+
+/*!
+ * \brief Build the alias tables of the neighbors of every node for sampling them with
+ *        the given probabilities, on the CSR or CSC matrix of an edge type.
+ *
+ * The tables are indexed by edge IDs, so they can be stored and shared like the edge
+ * features. They are only valid for the given edge direction and probabilities.
+ *
+ * \param hg The input graph.
+ * \param etype The edge type.
+ * \param dir Edge direction.
+ * \param probability The unnormalized probabilities of the edges of etype.
+ * \return The pair of the acceptance probabilities and the aliases.
+ */
+std::pair<FloatArray, IdArray> BuildAliasTable(
+    const HeteroGraphPtr hg,
+    dgl_type_t etype,
+    EdgeDir dir,
+    const FloatArray& probability);
 
 /*!
  * Select the neighbors with k-largest weights on the connecting edges for each given node.
@@ -61,6 +144,9 @@ HeteroSubgraph SampleNeighbors(
  *               each edge.
  * \param ascending If true, elements are sorted by ascending order, equivalent to find
  *                  the K smallest values. Otherwise, find K largest values.
+ * \param order Optional orders of the neighbors by weight for every edge type, see
+ *              BuildTopkOrder, selecting the neighbors in O(k). Missing or empty arrays
+ *              select by the weights.
  * \return Sampled neighborhoods as a graph. The return graph has the same schema as the
  *         original one.
  */
@@ -70,8 +156,63 @@ HeteroSubgraph SampleNeighborsTopk(
     const std::vector<int64_t>& k,
     EdgeDir dir,
     const std::vector<FloatArray>& weight,
+    bool ascending = false,
+    const std::vector<IdArray>& order = {});
+
+/*!
+ * \brief Sort the neighbors of every node by the weights of the connecting edges, on the
+ *        CSR or CSC matrix of an edge type, for SampleNeighborsTopk.
+ *
+ * The order is indexed by edge IDs, so it can be stored and shared like the edge
+ * features. It is only valid for the given edge direction, weights and sort order.
+ *
+ * \param hg The input graph.
+ * \param etype The edge type.
+ * \param dir Edge direction.
+ * \param weight The weights of the edges of etype.
+ * \param ascending If true, the neighbors are sorted by ascending weights.
+ * \return The positions of the neighbors of the nodes by weight.
+ */
+IdArray BuildTopkOrder(
+    const HeteroGraphPtr hg,
+    dgl_type_t etype,
+    EdgeDir dir,
+    const FloatArray& weight,
     bool ascending = false);
 
+/*!
+ * \brief Sample from the neighbors of the given nodes connected by edges strictly earlier
+ *        than the time of the node, and return the sampled edges as a graph.
+ *
+ * The eligible neighbors are sampled uniformly, by binary search in the neighbors of the
+ * nodes sorted by timestamp, so a node costs O(fanout + log(number of neighbors)).
+ *
+ * \param hg The input graph.
+ * \param nodes Node IDs of each type. The vector length must be equal to the number
+ *              of node types. Empty array is allowed.
+ * \param fanouts Number of sampled neighbors for each edge type. The vector length
+ *                should be equal to the number of edge types. A fanout of -1 picks
+ *                all the eligible neighbors.
+ * \param dir Edge direction.
+ * \param timestamp A vector of 1D arrays, the timestamps of the edges by edge type.
+ * \param order The orders of the neighbors by ascending timestamp for every edge type,
+ *              from BuildTopkOrder with the same edge direction.
+ * \param bound The time of every node in \c nodes by node type, of the type of the
+ *              timestamps.
+ * \param replace If true, sample with replacement.
+ * \return Sampled neighborhoods as a graph. The return graph has the same schema as the
+ *         original one.
+ */
+HeteroSubgraph SampleNeighborsTemporal(
+    const HeteroGraphPtr hg,
+    const std::vector<IdArray>& nodes,
+    const std::vector<int64_t>& fanouts,
+    EdgeDir dir,
+    const std::vector<NDArray>& timestamp,
+    const std::vector<IdArray>& order,
+    const std::vector<NDArray>& bound,
+    bool replace = false);
+
 HeteroSubgraph SampleNeighborsBiased(
     const HeteroGraphPtr hg,
     const IdArray& nodes,
@@ -24,6 +24,13 @@ namespace sampling {
  * \param metapath A 1D array of edge types representing the metapath.
  * \param prob A vector of 1D float arrays, indicating the transition probability of
  *        each edge by edge type.  An empty float array assumes uniform transition.
+ * \param alias_accept A vector of the acceptance probabilities of the alias tables
+ *        of \c prob by edge type, from aten::CSRRowWiseAliasTable on the CSR matrices,
+ *        or null arrays.  They make a weighted step O(1) instead of O(degree).
+ * \param alias A vector of the aliases of the alias tables by edge type.
+ * \param random_seed The seed of the walks, or a negative number to draw them from
+ *        the thread-local random engine.  With a seed, the walk from the i-th seed
+ *        node only depends on \c random_seed and i, whatever the number of threads.
  * \return A pair of
  *         1. One 2D array of shape (len(seeds), len(metapath) + 1) with node IDs.  The
  *            paths that terminated early are padded with -1.
@@ -35,7 +42,10 @@ std::tuple<IdArray, IdArray, TypeArray> RandomWalk(
     const HeteroGraphPtr hg,
     const IdArray seeds,
     const TypeArray metapath,
-    const std::vector<FloatArray> &prob);
+    const std::vector<FloatArray> &prob,
+    const std::vector<FloatArray> &alias_accept,
+    const std::vector<IdArray> &alias,
+    int64_t random_seed);
 
 /*!
  * \brief Metapath-based random walk with restart probability.
@@ -45,7 +55,14 @@ std::tuple<IdArray, IdArray, TypeArray> RandomWalk(
  * \param metapath A 1D array of edge types representing the metapath.
  * \param prob A vector of 1D float arrays, indicating the transition probability of
  *        each edge by edge type.  An empty float array assumes uniform transition.
+ * \param alias_accept A vector of the acceptance probabilities of the alias tables
+ *        of \c prob by edge type, from aten::CSRRowWiseAliasTable on the CSR matrices,
+ *        or null arrays.  They make a weighted step O(1) instead of O(degree).
+ * \param alias A vector of the aliases of the alias tables by edge type.
  * \param restart_prob Restart probability
+ * \param random_seed The seed of the walks, or a negative number to draw them from
+ *        the thread-local random engine.  With a seed, the walk from the i-th seed
+ *        node only depends on \c random_seed and i, whatever the number of threads.
  * \return A pair of
  *         1. One 2D array of shape (len(seeds), len(metapath) + 1) with node IDs.  The
  *            paths that terminated early are padded with -1.
@@ -58,7 +75,10 @@ std::tuple<IdArray, IdArray, TypeArray> RandomWalkWithRestart(
     const IdArray seeds,
     const TypeArray metapath,
     const std::vector<FloatArray> &prob,
-    double restart_prob);
+    const std::vector<FloatArray> &alias_accept,
+    const std::vector<IdArray> &alias,
+    double restart_prob,
+    int64_t random_seed);
 
 /*!
  * \brief Metapath-based random walk with stepwise restart probability.  Useful
@@ -69,8 +89,15 @@ std::tuple<IdArray, IdArray, TypeArray> RandomWalkWithRestart(
  * \param metapath A 1D array of edge types representing the metapath.
  * \param prob A vector of 1D float arrays, indicating the transition probability of
  *        each edge by edge type.  An empty float array assumes uniform transition.
+ * \param alias_accept A vector of the acceptance probabilities of the alias tables
+ *        of \c prob by edge type, from aten::CSRRowWiseAliasTable on the CSR matrices,
+ *        or null arrays.  They make a weighted step O(1) instead of O(degree).
+ * \param alias A vector of the aliases of the alias tables by edge type.
  * \param restart_prob Restart probability array which has the same number of elements
  *        as \c metapath, indicating the probability to terminate after transition.
+ * \param random_seed The seed of the walks, or a negative number to draw them from
+ *        the thread-local random engine.  With a seed, the walk from the i-th seed
+ *        node only depends on \c random_seed and i, whatever the number of threads.
  * \return A pair of
  *         1. One 2D array of shape (len(seeds), len(metapath) + 1) with node IDs.  The
  *            paths that terminated early are padded with -1.
@@ -83,7 +110,67 @@ std::tuple<IdArray, IdArray, TypeArray> RandomWalkWithStepwiseRestart(
     const IdArray seeds,
     const TypeArray metapath,
     const std::vector<FloatArray> &prob,
-    FloatArray restart_prob);
+    const std::vector<FloatArray> &alias_accept,
+    const std::vector<IdArray> &alias,
+    FloatArray restart_prob,
+    int64_t random_seed);
+
+/*!
+ * \brief Metapath-based random walk going back in time: every step picks uniformly
+ *        among the outbound edges strictly earlier than the previous step, or than
+ *        the time of the seed node for the first step, and the walk terminates when
+ *        there is none.  A step costs O(log(degree)).
+ *
+ * Only CPU graphs are supported.
+ *
+ * \param hg The heterograph.
+ * \param seeds A 1D array of seed nodes, with the type the source type of the first
+ *        edge type in the metapath.
+ * \param metapath A 1D array of edge types representing the metapath.
+ * \param timestamp A vector of 1D arrays, the timestamps of the edges by edge type.
+ * \param order A vector of the orders of the outbound edges of the nodes by ascending
+ *        timestamp, from aten::CSRRowWiseTopkOrder on the CSR matrices, by edge type.
+ * \param seed_time A 1D array of the time of every seed node, of the type of the
+ *        timestamps.
+ * \param random_seed The seed of the walks, or a negative number to draw them from
+ *        the thread-local random engine.  See RandomWalk.
+ * \return A tuple of
+ *         1. One 2D array of shape (len(seeds), len(metapath) + 1) with node IDs.  The
+ *            paths that terminated early are padded with -1.
+ *         2. One 2D array of shape (len(seeds), len(metapath)) with edge IDs.  The
+ *            paths that terminated early are padded with -1.
+ *         3. One 1D array of shape (len(metapath) + 1) with node type IDs.
+ */
+std::tuple<IdArray, IdArray, TypeArray> RandomWalkTemporal(
+    const HeteroGraphPtr hg,
+    const IdArray seeds,
+    const TypeArray metapath,
+    const std::vector<NDArray> &timestamp,
+    const std::vector<IdArray> &order,
+    const NDArray seed_time,
+    int64_t random_seed);
+
+/*!
+ * \brief Pack the padded traces returned by the random walks, with their edge IDs
+ *        and node types, in a single pass.
+ *
+ * Only CPU arrays are supported.
+ *
+ * \param traces The 2D array of node IDs, padded with -1.
+ * \param eids The 2D array of edge IDs, padded with -1.
+ * \param vtypes The 1D array of node type IDs of the positions of the traces.
+ * \return A tuple of
+ *         1. The node IDs of all the traces, concatenated without the padding.
+ *         2. The edge IDs of all the traces, concatenated without the padding.  A
+ *            trace has one edge less than nodes.
+ *         3. The node type IDs of the concatenated node IDs.
+ *         4. The number of nodes of every trace.
+ *         5. The offset of every trace in the concatenated node IDs.
+ */
+std::tuple<IdArray, IdArray, TypeArray, IdArray, IdArray> PackWalks(
+    const IdArray traces,
+    const IdArray eids,
+    const TypeArray vtypes);
 
 };  // namespace sampling
 
@@ -7,6 +7,7 @@
 #define DGL_SCHEDULER_H_
 
 #include <vector>
+#include "aten/csr.h"
 #include "runtime/ndarray.h"
 
 namespace dgl {
@@ -56,6 +57,34 @@ template <class IdType>
 std::vector<IdArray> GroupEdgeByNodeDegree(const IdArray& uids,
         const IdArray& vids, const IdArray& eids);
 
+/*!
+ * \brief Generate the degree bucketing schedule of a UDF reduce from the in-edges of
+ *        the destination nodes.
+ * \tparam IdType Graph's index data type, can be int32_t or int64_t
+ * \param csc The in-edges of the destination nodes, with the edge IDs as data
+ * \return a vector of 4 IdArrays. The 4 arrays are:
+ *         degrees: the degrees of the buckets, in increasing order
+ *         nids: destination node ids, by bucket, in increasing order in a bucket
+ *         nid_section: number of nodes in each bucket (used to split nids)
+ *         eids: the in-edges of the nodes of nids in order, in increasing order
+ *               of edge id for a node, so the messages of a bucket are a
+ *               (nodes, degree) block of them
+ */
+template <class IdType>
+std::vector<IdArray> DegreeBucketingCSC(const aten::CSRMatrix& csc);
+
+/*!
+ * \brief Gather the messages of the edges given, in one buffer.
+ *
+ * With the eids of DegreeBucketingCSC, the mailbox of every bucket is a contiguous
+ * slice of the buffer, of shape (nodes, degree, feat).
+ *
+ * \param msg The messages by edge id, of any shape and data type, on CPU
+ * \param eids The edge ids
+ * \return The messages of eids, in order
+ */
+NDArray GatherMailbox(NDArray msg, IdArray eids);
+
 }  // namespace sched
 
 }  // namespace dgl
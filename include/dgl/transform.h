@@ -7,6 +7,7 @@
 #ifndef DGL_TRANSFORM_H_
 #define DGL_TRANSFORM_H_
 
+#include <string>
 #include <vector>
 #include <tuple>
 #include <utility>
@@ -115,15 +116,58 @@ ToSimpleGraph(const HeteroGraphPtr graph);
 /*!
  * \brief Remove edges from a graph.
  *
+ * The sparse formats created in the relation graphs are kept, with the edges
+ * numbered in the order of their original IDs.
+ *
  * \param graph The graph.
  * \param eids The edge IDs to remove per edge type.
  *
- * \return A pair of the graph with edges removed, as well as the edge ID mapping from
- *         the original graph to the new graph per edge type.
+ * \return A pair of the graph with edges removed, as well as the original IDs of
+ *         the edges of the new graph per edge type.
  */
 std::pair<HeteroGraphPtr, std::vector<IdArray>>
 RemoveEdges(const HeteroGraphPtr graph, const std::vector<IdArray> &eids);
 
+/*!
+ * \brief Add nodes and edges to a graph.
+ *
+ * The new edges are merged into the sparse formats created in the relation
+ * graphs, and numbered after the existing edges of their type.
+ *
+ * \param graph The graph.
+ * \param src The source nodes of the new edges per edge type.
+ * \param dst The destination nodes of the new edges per edge type.
+ * \param num_nodes_per_type The new number of nodes per node type, no less than
+ *        the current one.
+ *
+ * \return The graph with the new nodes and edges.
+ */
+HeteroGraphPtr AddEdges(
+    const HeteroGraphPtr graph, const std::vector<IdArray> &src,
+    const std::vector<IdArray> &dst, const std::vector<int64_t> &num_nodes_per_type);
+
+/*!
+ * \brief Compute an order of the nodes of a homogeneous graph improving the
+ *        locality of its traversals, taking the edges as undirected.
+ *
+ * - "rcmk": reverse Cuthill-McKee, the breadth-first order from the node of
+ *   smallest degree of every component, visiting the neighbors by increasing
+ *   degree, reversed. It reduces the bandwidth of the adjacency matrix.
+ * - "degree": the nodes by decreasing degree, so that the hubs are packed.
+ * - "rabbit": the Rabbit order, which merges the nodes by increasing degree
+ *   into the neighboring community of largest modularity gain, and lays out
+ *   every community contiguously by a depth-first order of its merges.
+ *
+ * Ties are broken by node ID, so the order does not depend on the number of
+ * threads.
+ *
+ * \param graph The graph, on CPU.
+ * \param algorithm The algorithm.
+ *
+ * \return The old ID of every new node, which the graph can be reordered with.
+ */
+IdArray NodeOrder(const HeteroGraphPtr graph, const std::string &algorithm);
+
 };  // namespace transform
 
 };  // namespace dgl
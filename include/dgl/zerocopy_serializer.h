@@ -145,6 +145,41 @@ class StreamWithBuffer : public dmlc::SeekStream {
     }
   }
 
+  /*!
+   * \brief Construct stream backed up by string, and reconstruct NDArray
+   * as views of the arrays of data_list, e.g. the arrays a communicator
+   * received the data into, on CPU or GPU.
+   * \param p_buffer buffer pointer
+   * \param size buffer size
+   * \param data_list arrays holding the data of the NDArrays
+   */
+  StreamWithBuffer(char* p_buffer, size_t size,
+                   const std::vector<runtime::NDArray>& data_list)
+      : strm_(new dmlc::MemoryFixedSizeStream(p_buffer, size)),
+        send_to_remote_(true) {
+    for (const auto& data : data_list) {
+      buffer_list_.emplace_back(data, data->data, data.GetSize());
+    }
+  }
+
+  /*!
+   * \brief Construct stream backed up by string, and reconstruct NDArray
+   * from data_ptr_list whose memory is owned by data_owner, e.g. a memory
+   * mapped file. The NDArrays keep data_owner alive instead of freeing their
+   * data pointer.
+   * \param blob The string to write/load from zerocopy write/load
+   * \param data_ptr_list pointer list for NDArrays to deconstruct from
+   * \param data_owner The owner of the memory of the pointers
+   */
+  StreamWithBuffer(std::string* blob, const std::vector<void*>& data_ptr_list,
+                   std::shared_ptr<void> data_owner)
+      : strm_(new dmlc::MemoryStringStream(blob)), send_to_remote_(true),
+        data_owner_(std::move(data_owner)) {
+    for (void* data : data_ptr_list) {
+      buffer_list_.emplace_back(data);
+    }
+  }
+
   // delegate methods to strm_
   virtual size_t Read(void* ptr, size_t size) { return strm_->Read(ptr, size); }
   virtual void Write(const void* ptr, size_t size) { strm_->Write(ptr, size); }
@@ -183,8 +218,23 @@ class StreamWithBuffer : public dmlc::SeekStream {
   std::unique_ptr<dmlc::SeekStream> strm_;
   std::deque<Buffer> buffer_list_;
   bool send_to_remote_;
+  std::shared_ptr<void> data_owner_;
 };  // namespace dgl
 
+/*!
+ * \brief Create a contiguous NDArray pointing to raw data instead of copying it.
+ * \param shape The shape of the array.
+ * \param dtype The data type of the array.
+ * \param ctx The context of the data.
+ * \param raw The data.
+ * \param owner The owner of the data, kept alive by the array, e.g. a memory
+ *        mapped file. If null, the data is freed with the array by delete[].
+ * \return The array.
+ */
+runtime::NDArray CreateNDArrayFromRawData(std::vector<int64_t> shape, DLDataType dtype,
+                                          DLContext ctx, void* raw,
+                                          std::shared_ptr<void> owner = nullptr);
+
 }  // namespace dgl
 
 #endif  // DGL_ZEROCOPY_SERIALIZER_H_
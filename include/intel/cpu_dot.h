@@ -0,0 +1,159 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file intel/cpu_dot.h
+ * \brief Intel CPU dot product kernel
+ */
+#ifndef INTEL_CPU_DOT_H_
+#define INTEL_CPU_DOT_H_
+#include <cstdint>
+#include <type_traits>
+#include "cpu_kernel.h"
+
+namespace dgl {
+
+/*!
+ * \brief Dot product kernel using Intel AVX512 or AVX2+FMA instructions.
+ *
+ * Calling convention:
+ *   DType dot = run(lhs, rhs, size)
+ * where size is passed as int64_t.
+ * \note it uses AVX512 if available, otherwise AVX2 and FMA.
+ */
+template <typename DType>
+class ElemWiseDot : public IntelKernelGenerator {
+ public:
+  static_assert(
+    std::is_base_of<std::true_type,
+                    utils::has_type<DType, supported_types>>::value,
+    "Use case fail dgl::ElemWiseDot<DType> DType is not supported !");
+  typedef DType (*FuncType)(const DType*, const DType*, int64_t);
+
+ protected:
+  const Xbyak::Reg64 &r_left_;
+  const Xbyak::Reg64 &r_right_;
+  const Xbyak::Reg64 &r_size_;
+
+  /* [functional] Does kernel is applicable on this machine ? */
+  bool applicable_;
+
+ public:
+  static constexpr int UNIT_SIZE_BYTES = sizeof(DType);
+  static constexpr int BITS_IN_BYTES = 8;
+  static constexpr int ZMM_UNIT_PER_REG = 512 / (UNIT_SIZE_BYTES * BITS_IN_BYTES);
+  static constexpr int YMM_UNIT_PER_REG = 256 / (UNIT_SIZE_BYTES * BITS_IN_BYTES);
+
+  /* Reduce the lanes of xmm0 into its lowest lane. */
+  void reduce_xmm0() {
+    alias_HADD<DType>(xmm0, xmm0, xmm0);
+    if (std::is_same<DType, float>::value)
+      alias_HADD<DType>(xmm0, xmm0, xmm0);
+  }
+
+  void generate_avx512() {
+    vpxord(zmm0, zmm0, zmm0);
+    mov(r8, r_size_);
+    and_(r8, ZMM_UNIT_PER_REG - 1);  // r8 = size % ZMM_UNIT_PER_REG
+    sub(r_size_, r8);                // size of the full chunks
+    xor_(r9, r9);                    // reset r9
+    cmp(r_size_, 0);                 // do we have any full chunks ?
+    jz("remainder");
+
+    L("for_i");
+    alias_load<DType>(zmm1, ptr[r_left_ + r9 * UNIT_SIZE_BYTES]);
+    alias_FMA<DType>(zmm0, zmm1, ptr[r_right_ + r9 * UNIT_SIZE_BYTES]);
+    add(r9, ZMM_UNIT_PER_REG);
+    cmp(r_size_, r9);  // more full chunks ?
+    jnz("for_i");
+
+    L("remainder");
+    cmp(r8, 0);  // do we have a remainder ?
+    jz("reduce");
+    /* prepare a bitmask for k1 */
+    mov(rax, 1);
+    mov(rcx, r8);
+    sal(rax, cl);
+    dec(rax);  // k1= (1 << r8 )-1
+    kmovw(k1, eax);
+    alias_load<DType>(zmm1 | k1 | Xbyak::T_z, ptr[r_left_ + r9 * UNIT_SIZE_BYTES]);
+    alias_load<DType>(zmm2 | k1 | Xbyak::T_z, ptr[r_right_ + r9 * UNIT_SIZE_BYTES]);
+    alias_FMA<DType>(zmm0, zmm1, zmm2);
+
+    L("reduce");
+    vextractf64x4(ymm1, zmm0, 1);
+    alias_ADD<DType>(ymm0, ymm0, ymm1);
+    vextractf128(xmm1, ymm0, 1);
+    alias_ADD<DType>(xmm0, xmm0, xmm1);
+    reduce_xmm0();
+    vzeroupper();
+  }
+
+  void generate_avx2() {
+    vxorps(ymm0, ymm0, ymm0);
+    vxorps(xmm2, xmm2, xmm2);
+    mov(r8, r_size_);
+    and_(r8, YMM_UNIT_PER_REG - 1);  // r8 = size % YMM_UNIT_PER_REG
+    sub(r_size_, r8);                // size of the full chunks
+    xor_(r9, r9);                    // reset r9
+    cmp(r_size_, 0);                 // do we have any full chunks ?
+    jz("remainder");
+
+    L("for_i");
+    alias_load<DType>(ymm1, ptr[r_left_ + r9 * UNIT_SIZE_BYTES]);
+    alias_FMA<DType>(ymm0, ymm1, ptr[r_right_ + r9 * UNIT_SIZE_BYTES]);
+    add(r9, YMM_UNIT_PER_REG);
+    cmp(r_size_, r9);  // more full chunks ?
+    jnz("for_i");
+
+    /* AVX2 has no masked loads for the remainder, accumulate it in xmm2 */
+    L("remainder");
+    add(r8, r9);  // r8 = size
+    cmp(r9, r8);
+    jge("reduce");
+    L("for_r");
+    alias_load_scalar<DType>(xmm1, ptr[r_left_ + r9 * UNIT_SIZE_BYTES]);
+    alias_FMA_scalar<DType>(xmm2, xmm1, ptr[r_right_ + r9 * UNIT_SIZE_BYTES]);
+    inc(r9);
+    cmp(r9, r8);
+    jl("for_r");
+
+    L("reduce");
+    vextractf128(xmm1, ymm0, 1);
+    alias_ADD<DType>(xmm0, xmm0, xmm1);
+    reduce_xmm0();
+    alias_ADD<DType>(xmm0, xmm0, xmm2);
+    vzeroupper();
+  }
+
+  ElemWiseDot()
+      : r_left_(rdi),
+        r_right_(rsi),
+        r_size_(rdx),
+        applicable_(false) {
+    static Xbyak::util::Cpu current_cpu;
+
+    if (current_cpu.has(Xbyak::util::Cpu::tAVX512F)) {
+      generate_avx512();
+      applicable_ = true;
+      log_intel("AVX512F cpu dot kernel is ready");
+    } else if (current_cpu.has(Xbyak::util::Cpu::tAVX2) &&
+               current_cpu.has(Xbyak::util::Cpu::tFMA)) {
+      generate_avx2();
+      applicable_ = true;
+      log_intel("AVX2 cpu dot kernel is ready");
+    }
+    ret();
+  }
+
+  bool applicable() const { return applicable_; }
+
+  /*! \return The kernel as a function pointer. */
+  FuncType func() const { return getCode<FuncType>(); }
+
+  DType run(const DType* lhs, const DType* rhs, int64_t size) const {
+    return func()(lhs, rhs, size);
+  }
+};
+
+}  // namespace dgl
+
+#endif  // INTEL_CPU_DOT_H_
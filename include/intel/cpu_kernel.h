@@ -0,0 +1,209 @@
+/*!
+ *  Copyright (c) 2019 by Contributors
+ * \file intel/cpu_kernel.h
+ * \brief Common infrastructure of the Intel CPU kernels
+ * \author Pawel Piotrowicz <pawel.piotrowicz@intel.com>
+ */
+#ifndef INTEL_CPU_KERNEL_H_
+#define INTEL_CPU_KERNEL_H_
+#include <cstdint>
+#include <cstdlib>
+#include <tuple>
+#include <type_traits>
+#include "dmlc/logging.h"
+#include "meta_utils.h"
+#include "xbyak/xbyak.h"
+#include "xbyak/xbyak_util.h"
+
+namespace dgl {
+
+typedef std::tuple<float, double> supported_types;
+
+#ifndef log_intel
+#define log_intel(x)                   \
+  if (IntelKernel<>::IsLogEnabled()) { \
+    LOG(INFO) << x;                    \
+  }
+#endif
+
+static inline Xbyak::Zmm make_zmm(const Xbyak::Xmm &v) {
+  return Xbyak::Zmm(v.getIdx());
+}
+template <int version = 0>
+struct IntelKernel {
+  static int64_t GetValue() {
+    int64_t v = 0;
+    const char *label = "DGL_CPU_INTEL_KERNEL_ENABLED";
+    const char *ptr = std::getenv(label);
+    if (ptr) {
+      v = atoll(ptr);
+      log_intel(label << "=>" << v);
+    }
+    return v;
+  }
+
+  static int64_t IsEnabled() {
+    static int64_t r = IntelKernel<version>::GetValue();
+    return r;
+  }
+
+  static int IsLogEnabled() {
+    static int r = (std::getenv("DGL_CPU_INTEL_KERNEL_LOG")) ? 1 : 0;
+    return r;
+  }
+};
+
+/*!
+ * \brief Xbyak code generator with the AVX2/AVX512 instruction aliases shared
+ *        by the SpMM and SDDMM kernels. Each alias picks the single or double
+ *        precision flavour of the instruction from the template type.
+ */
+class IntelKernelGenerator : public Xbyak::CodeGenerator {
+ public:
+  template <class TType, class R1, class R2,
+            utils::CheckCmp<TType, float> = true>
+  void alias_load(R1 r1, R2 r2) {
+    vmovups(r1, r2);
+  }
+  template <class TType, class R1, class R2,
+            utils::CheckCmp<TType, double> = true>
+  void alias_load(R1 r1, R2 r2) {
+    vmovupd(r1, r2);
+  }
+
+  template <class TType, class R1, class R2,
+            utils::CheckCmp<TType, float> = true>
+  void alias_save(R1 r1, R2 r2) {
+    alias_load<TType>(r1, r2);
+  }
+  template <class TType, class R1, class R2,
+            utils::CheckCmp<TType, double> = true>
+  void alias_save(R1 r1, R2 r2) {
+    alias_load<TType>(r1, r2);
+  }
+
+  template <class TType, class R1, class R2, class R3,
+            utils::CheckCmp<TType, float> = true>
+  void alias_ADD(R1 r1, R2 r2, R3 r3) {
+    vaddps(r1, r2, r3);
+  }
+  template <class TType, class R1, class R2, class R3,
+            utils::CheckCmp<TType, double> = true>
+  void alias_ADD(R1 r1, R2 r2, R3 r3) {
+    vaddpd(r1, r2, r3);
+  }
+
+  template <class TType, class R1, class R2, class R3,
+            utils::CheckCmp<TType, float> = true>
+  void alias_SUB(R1 r1, R2 r2, R3 r3) {
+    vsubps(r1, r2, r3);
+  }
+  template <class TType, class R1, class R2, class R3,
+            utils::CheckCmp<TType, double> = true>
+  void alias_SUB(R1 r1, R2 r2, R3 r3) {
+    vsubpd(r1, r2, r3);
+  }
+
+  template <class TType, class R1, class R2, class R3,
+            utils::CheckCmp<TType, float> = true>
+  void alias_DIV(R1 r1, R2 r2, R3 r3) {
+    vdivps(r1, r2, r3);
+  }
+  template <class TType, class R1, class R2, class R3,
+            utils::CheckCmp<TType, double> = true>
+  void alias_DIV(R1 r1, R2 r2, R3 r3) {
+    vdivpd(r1, r2, r3);
+  }
+
+  template <class TType, class R1, class R2, class R3,
+            utils::CheckCmp<TType, float> = true>
+  void alias_MUL(R1 r1, R2 r2, R3 r3) {
+    vmulps(r1, r2, r3);
+  }
+  template <class TType, class R1, class R2, class R3,
+            utils::CheckCmp<TType, double> = true>
+  void alias_MUL(R1 r1, R2 r2, R3 r3) {
+    vmulpd(r1, r2, r3);
+  }
+
+  template <class TType, class R1, class R2, class R3,
+            utils::CheckCmp<TType, float> = true>
+  void alias_FMA(R1 r1, R2 r2, R3 r3) {
+    vfmadd231ps(r1, r2, r3);
+  }
+  template <class TType, class R1, class R2, class R3,
+            utils::CheckCmp<TType, double> = true>
+  void alias_FMA(R1 r1, R2 r2, R3 r3) {
+    vfmadd231pd(r1, r2, r3);
+  }
+
+  template <class TType, class R1, class R2, class R3,
+            utils::CheckCmp<TType, float> = true>
+  void alias_FMA_scalar(R1 r1, R2 r2, R3 r3) {
+    vfmadd231ss(r1, r2, r3);
+  }
+  template <class TType, class R1, class R2, class R3,
+            utils::CheckCmp<TType, double> = true>
+  void alias_FMA_scalar(R1 r1, R2 r2, R3 r3) {
+    vfmadd231sd(r1, r2, r3);
+  }
+
+  template <class TType, class R1, class R2,
+            utils::CheckCmp<TType, float> = true>
+  void alias_load_scalar(R1 r1, R2 r2) {
+    vmovss(r1, r2);
+  }
+  template <class TType, class R1, class R2,
+            utils::CheckCmp<TType, double> = true>
+  void alias_load_scalar(R1 r1, R2 r2) {
+    vmovsd(r1, r2);
+  }
+
+  template <class TType, class R1, class R2, class R3,
+            utils::CheckCmp<TType, float> = true>
+  void alias_HADD(R1 r1, R2 r2, R3 r3) {
+    vhaddps(r1, r2, r3);
+  }
+  template <class TType, class R1, class R2, class R3,
+            utils::CheckCmp<TType, double> = true>
+  void alias_HADD(R1 r1, R2 r2, R3 r3) {
+    vhaddpd(r1, r2, r3);
+  }
+
+  template <class TType, class K, class R1, class R2,
+            utils::CheckCmp<TType, float> = true>
+  void alias_CMP(K k, R1 r1, R2 r2, uint8_t predicate) {
+    vcmpps(k, r1, r2, predicate);
+  }
+  template <class TType, class K, class R1, class R2,
+            utils::CheckCmp<TType, double> = true>
+  void alias_CMP(K k, R1 r1, R2 r2, uint8_t predicate) {
+    vcmppd(k, r1, r2, predicate);
+  }
+
+  template <class TType, class R1, class R2,
+            utils::CheckCmp<TType, int32_t> = true>
+  void alias_broadcast_id(R1 r1, R2 r2) {
+    vpbroadcastd(r1, r2);
+  }
+  template <class TType, class R1, class R2,
+            utils::CheckCmp<TType, int64_t> = true>
+  void alias_broadcast_id(R1 r1, R2 r2) {
+    vpbroadcastq(r1, r2);
+  }
+
+  template <class TType, class R1, class R2,
+            utils::CheckCmp<TType, int32_t> = true>
+  void alias_save_id(R1 r1, R2 r2) {
+    vmovdqu32(r1, r2);
+  }
+  template <class TType, class R1, class R2,
+            utils::CheckCmp<TType, int64_t> = true>
+  void alias_save_id(R1 r1, R2 r2) {
+    vmovdqu64(r1, r2);
+  }
+};
+
+}  // namespace dgl
+
+#endif  // INTEL_CPU_KERNEL_H_
@@ -6,58 +6,20 @@
  */
 #ifndef INTEL_CPU_SUPPORT_H_
 #define INTEL_CPU_SUPPORT_H_
+#include <cstdint>
 #include <memory>
 #include <tuple>
 #include <type_traits>
-#include "dmlc/logging.h"
-#include "meta_utils.h"
-#include "xbyak/xbyak.h"
-#include "xbyak/xbyak_util.h"
+#include "cpu_kernel.h"
 
 namespace dgl {
 
-typedef std::tuple<float, double> supported_types;
-
-#ifndef log_intel
-#define log_intel(x)                   \
-  if (IntelKernel<>::IsLogEnabled()) { \
-    LOG(INFO) << x;                    \
-  }
-#endif
-
-static inline Xbyak::Zmm make_zmm(const Xbyak::Xmm &v) {
-  return Xbyak::Zmm(v.getIdx());
-}
-template <int version = 0>
-struct IntelKernel {
-  static int64_t GetValue() {
-    int64_t v = 0;
-    const char *label = "DGL_CPU_INTEL_KERNEL_ENABLED";
-    const char *ptr = std::getenv(label);
-    if (ptr) {
-      v = atoll(ptr);
-      log_intel(label << "=>" << v);
-    }
-    return v;
-  }
-
-  static int64_t IsEnabled() {
-    static int64_t r = IntelKernel<version>::GetValue();
-    return r;
-  }
-
-  static int IsLogEnabled() {
-    static int r = (std::getenv("DGL_CPU_INTEL_KERNEL_LOG")) ? 1 : 0;
-    return r;
-  }
-};
-
 /*!
  * \brief Element-wise addition kernel using Intel AVX512 instructions.
  * \note it uses AVX512.
  */
 template <class Op>
-class ElemWiseAddUpdate : public Xbyak::CodeGenerator {
+class ElemWiseAddUpdate : public IntelKernelGenerator {
  public:
   typedef typename Op::type DType;
   static_assert(
@@ -82,72 +44,6 @@ class ElemWiseAddUpdate : public Xbyak::CodeGenerator {
   static constexpr int UNIT_PER_REG =
     REG_BIT_SIZE / (UNIT_SIZE_BYTES * BITS_IN_BYTES);
 
-  template <class TType, class R1, class R2,
-            utils::CheckCmp<TType, float> = true>
-  void alias_load(R1 r1, R2 r2) {
-    vmovups(r1, r2);
-  }
-  template <class TType, class R1, class R2,
-            utils::CheckCmp<TType, double> = true>
-  void alias_load(R1 r1, R2 r2) {
-    vmovupd(r1, r2);
-  }
-
-  template <class TType, class R1, class R2,
-            utils::CheckCmp<TType, float> = true>
-  void alias_save(R1 r1, R2 r2) {
-    alias_load<TType>(r1, r2);
-  }
-  template <class TType, class R1, class R2,
-            utils::CheckCmp<TType, double> = true>
-  void alias_save(R1 r1, R2 r2) {
-    alias_load<TType>(r1, r2);
-  }
-
-  template <class TType, class R1, class R2, class R3,
-            utils::CheckCmp<TType, float> = true>
-  void alias_ADD(R1 r1, R2 r2, R3 r3) {
-    vaddps(r1, r2, r3);
-  }
-  template <class TType, class R1, class R2, class R3,
-            utils::CheckCmp<TType, double> = true>
-  void alias_ADD(R1 r1, R2 r2, R3 r3) {
-    vaddpd(r1, r2, r3);
-  }
-
-  template <class TType, class R1, class R2, class R3,
-            utils::CheckCmp<TType, float> = true>
-  void alias_SUB(R1 r1, R2 r2, R3 r3) {
-    vsubps(r1, r2, r3);
-  }
-  template <class TType, class R1, class R2, class R3,
-            utils::CheckCmp<TType, double> = true>
-  void alias_SUB(R1 r1, R2 r2, R3 r3) {
-    vsubpd(r1, r2, r3);
-  }
-
-  template <class TType, class R1, class R2, class R3,
-            utils::CheckCmp<TType, float> = true>
-  void alias_DIV(R1 r1, R2 r2, R3 r3) {
-    vdivps(r1, r2, r3);
-  }
-  template <class TType, class R1, class R2, class R3,
-            utils::CheckCmp<TType, double> = true>
-  void alias_DIV(R1 r1, R2 r2, R3 r3) {
-    vdivpd(r1, r2, r3);
-  }
-
-  template <class TType, class R1, class R2, class R3,
-            utils::CheckCmp<TType, float> = true>
-  void alias_MUL(R1 r1, R2 r2, R3 r3) {
-    vmulps(r1, r2, r3);
-  }
-  template <class TType, class R1, class R2, class R3,
-            utils::CheckCmp<TType, double> = true>
-  void alias_MUL(R1 r1, R2 r2, R3 r3) {
-    vmulpd(r1, r2, r3);
-  }
-
   template <class Operator,
             utils::Verify<Operator, ::dgl::aten::cpu::op::CopyLhs,
                           supported_types> = true>
@@ -327,6 +223,220 @@ class ElemWiseAddUpdate : public Xbyak::CodeGenerator {
   }
 };
 
+/*!
+ * \brief Element-wise compare-and-update kernel for SpMM-Min/Max using Intel
+ *        AVX512 instructions.
+ *
+ * For every feature position k it computes val = Op(lhs[k], rhs[k]) and, where
+ * Cmp::Call(out[k], val) holds, writes val to out[k] and the source node/edge
+ * id to the Arg-Min/Max buffers. With \a with_type the source node type and
+ * the edge type are recorded as well, which is what the heterograph kernel
+ * needs.
+ *
+ * Calling convention:
+ *   run(out, lhs, rhs, size, arg_lhs, arg_rhs, lhs_id, rhs_id)
+ *   run(out, lhs, rhs, size, arg_lhs, arg_rhs, lhs_id, rhs_id,
+ *       arg_lhs_type, arg_rhs_type, lhs_type, rhs_type)          // with_type
+ * where the ids and types are passed as int64_t.
+ * \note it uses AVX512.
+ */
+template <class Op, class Cmp, typename IdType, bool with_type = false>
+class ElemWiseCmpUpdate : public IntelKernelGenerator {
+ public:
+  typedef typename Op::type DType;
+  static_assert(
+    std::is_base_of<std::true_type,
+                    utils::has_type<DType, supported_types>>::value,
+    "Use case fail dgl::ElemWiseCmpUpdate< Operator<DType> > DType is not "
+    "supported !");
+  static_assert(std::is_same<IdType, int32_t>::value ||
+                std::is_same<IdType, int64_t>::value,
+                "dgl::ElemWiseCmpUpdate only supports int32 and int64 ids");
+  static_assert(std::is_same<Cmp, ::dgl::aten::cpu::op::Max<DType>>::value ||
+                std::is_same<Cmp, ::dgl::aten::cpu::op::Min<DType>>::value,
+                "dgl::ElemWiseCmpUpdate only supports Max and Min reducers");
+
+ protected:
+  const Xbyak::Reg64 &r_out_;
+  const Xbyak::Reg64 &r_left_;
+  const Xbyak::Reg64 &r_right;
+  const Xbyak::Reg64 &r_size_;
+  const Xbyak::Reg64 &r_arg_left_;
+  const Xbyak::Reg64 &r_arg_right_;
+  const Xbyak::Reg64 &r_type_left_;
+  const Xbyak::Reg64 &r_type_right_;
+
+  /* [functional] Does kernel is applicable on this machine ? */
+  bool applicable_;
+
+ public:
+  static constexpr int UNIT_SIZE_BYTES = sizeof(DType);
+  static constexpr int ID_SIZE_BYTES = sizeof(IdType);
+  static constexpr int BITS_IN_BYTES = 8;
+  static constexpr int REG_BIT_SIZE = 512;
+  static constexpr int UNIT_PER_REG =
+    REG_BIT_SIZE / (UNIT_SIZE_BYTES * BITS_IN_BYTES);
+  static constexpr int ID_PER_REG =
+    REG_BIT_SIZE / (ID_SIZE_BYTES * BITS_IN_BYTES);
+  /* int64 ids of a float chunk span two zmm registers */
+  static constexpr bool SPLIT_ID_STORE = ID_PER_REG < UNIT_PER_REG;
+  /* _CMP_LT_OQ for Max (out < val), _CMP_GT_OQ for Min (out > val) */
+  static constexpr uint8_t CMP_PREDICATE =
+    std::is_same<Cmp, ::dgl::aten::cpu::op::Max<DType>>::value ? 0x11 : 0x1E;
+
+  /* Offsets of the stack-passed arguments at function entry */
+  static constexpr int STACK_LHS_ID = 8;
+  static constexpr int STACK_RHS_ID = 16;
+  static constexpr int STACK_ARG_LHS_TYPE = 24;
+  static constexpr int STACK_ARG_RHS_TYPE = 32;
+  static constexpr int STACK_LHS_TYPE = 40;
+  static constexpr int STACK_RHS_TYPE = 48;
+
+  void load_chunk(const Xbyak::Zmm &dst, const Xbyak::Reg64 &src,
+                  bool masked) {
+    if (masked)
+      alias_load<DType>(dst | k1, ptr[src + r10 * UNIT_SIZE_BYTES]);
+    else
+      alias_load<DType>(dst, ptr[src + r10 * UNIT_SIZE_BYTES]);
+  }
+
+  template <class Operator,
+            utils::Verify<Operator, ::dgl::aten::cpu::op::CopyLhs,
+                          supported_types> = true>
+  void compute_chunk(bool masked) {
+    load_chunk(zmm1, r_left_, masked);
+  }
+  template <class Operator,
+            utils::Verify<Operator, ::dgl::aten::cpu::op::CopyRhs,
+                          supported_types> = true>
+  void compute_chunk(bool masked) {
+    load_chunk(zmm1, r_right, masked);
+  }
+  template <class Operator, utils::Verify<Operator, ::dgl::aten::cpu::op::Add,
+                                          supported_types> = true>
+  void compute_chunk(bool masked) {
+    load_chunk(zmm1, r_left_, masked);
+    load_chunk(zmm2, r_right, masked);
+    alias_ADD<DType>(zmm1, zmm1, zmm2);
+  }
+  template <class Operator, utils::Verify<Operator, ::dgl::aten::cpu::op::Sub,
+                                          supported_types> = true>
+  void compute_chunk(bool masked) {
+    load_chunk(zmm1, r_left_, masked);
+    load_chunk(zmm2, r_right, masked);
+    alias_SUB<DType>(zmm1, zmm1, zmm2);
+  }
+  template <class Operator, utils::Verify<Operator, ::dgl::aten::cpu::op::Mul,
+                                          supported_types> = true>
+  void compute_chunk(bool masked) {
+    load_chunk(zmm1, r_left_, masked);
+    load_chunk(zmm2, r_right, masked);
+    alias_MUL<DType>(zmm1, zmm1, zmm2);
+  }
+  template <class Operator, utils::Verify<Operator, ::dgl::aten::cpu::op::Div,
+                                          supported_types> = true>
+  void compute_chunk(bool masked) {
+    load_chunk(zmm1, r_left_, masked);
+    load_chunk(zmm2, r_right, masked);
+    alias_DIV<DType>(zmm1, zmm1, zmm2);
+  }
+
+  /* Store the broadcast id register under the update mask k2 (and k3). */
+  void save_ids(const Xbyak::Reg64 &dst, const Xbyak::Zmm &ids) {
+    alias_save_id<IdType>(ptr[dst + r10 * ID_SIZE_BYTES], ids | k2);
+    if (SPLIT_ID_STORE) {
+      alias_save_id<IdType>(
+        ptr[dst + r10 * ID_SIZE_BYTES + REG_BIT_SIZE / BITS_IN_BYTES],
+        ids | k3);
+    }
+  }
+
+  void update_chunk(bool masked) {
+    load_chunk(zmm0, r_out_, masked);
+    compute_chunk<Op>(masked);
+    /* k2 = lanes where the accumulator should be replaced */
+    if (masked)
+      alias_CMP<DType>(k2 | k1, zmm0, zmm1, CMP_PREDICATE);
+    else
+      alias_CMP<DType>(k2, zmm0, zmm1, CMP_PREDICATE);
+    alias_save<DType>(ptr[r_out_ + r10 * UNIT_SIZE_BYTES], zmm1 | k2);
+    if (SPLIT_ID_STORE)
+      kshiftrw(k3, k2, ID_PER_REG);
+    if (Op::use_lhs) {
+      save_ids(r_arg_left_, zmm3);
+      if (with_type) save_ids(r_type_left_, zmm5);
+    }
+    if (Op::use_rhs) {
+      save_ids(r_arg_right_, zmm4);
+      if (with_type) save_ids(r_type_right_, zmm6);
+    }
+  }
+
+  ElemWiseCmpUpdate()
+      : r_out_(rdi),
+        r_left_(rsi),
+        r_right(rdx),
+        r_size_(rcx),
+        r_arg_left_(r8),
+        r_arg_right_(r9),
+        r_type_left_(rax),
+        r_type_right_(r11),
+        applicable_(false) {
+    static Xbyak::util::Cpu current_cpu;
+
+    if (current_cpu.has(Xbyak::util::Cpu::tAVX512F)) {
+      /* prepare REMAINDER */
+      mov(r11, r_size_);
+      and_(r11, UNIT_PER_REG - 1);  // r11 = size % UNIT_PER_REG
+      sub(r_size_, r11);            // size of the full chunks
+      mov(r10, r_size_);
+      /* prepare a bitmask for k1 */
+      mov(rax, 1);
+      mov(rcx, r11);
+      sal(rax, cl);
+      dec(rax);        // k1= (1 << r11 )-1
+      kmovw(k1, eax);  // set bitmask
+      mov(r_size_, r10);
+
+      /* broadcast the ids (and types) to be recorded */
+      alias_broadcast_id<IdType>(zmm3, ptr[rsp + STACK_LHS_ID]);
+      alias_broadcast_id<IdType>(zmm4, ptr[rsp + STACK_RHS_ID]);
+      if (with_type) {
+        mov(r_type_left_, ptr[rsp + STACK_ARG_LHS_TYPE]);
+        mov(r_type_right_, ptr[rsp + STACK_ARG_RHS_TYPE]);
+        alias_broadcast_id<IdType>(zmm5, ptr[rsp + STACK_LHS_TYPE]);
+        alias_broadcast_id<IdType>(zmm6, ptr[rsp + STACK_RHS_TYPE]);
+      }
+
+      xor_(r10, r10);   // reset r10
+      cmp(r_size_, 0);  // do we have any full chunks ?
+      jz("remainder");
+
+      L("for_i");
+      update_chunk(false);
+      add(r10, UNIT_PER_REG);  // r10+=sizeof(zmm)/sizeof(DType)
+      cmp(r_size_, r10);       // more full chunks ?
+      jnz("for_i");
+
+      L("remainder");
+      kortestw(k1, k1);  // do we have a remainder ?
+      jz("done");
+      update_chunk(true);
+      L("done");
+      applicable_ = true;
+      log_intel("AVX512F cpu cmp kernel is ready");
+    }
+    ret();
+  }
+
+  bool applicable() const { return applicable_; }
+
+  template <class... P>
+  void run(P... args) {
+    ((void (*)(P...))(this)->getCode())(args...);
+  }
+};
+
 }  // namespace dgl
 
 #endif  // INTEL_CPU_SUPPORT_H_
@@ -143,6 +143,10 @@ def _make_dgl_args(args, temp_args):
         elif isinstance(arg, ctypes.c_void_p):
             values[i].v_handle = arg
             type_codes[i] = TypeCode.HANDLE
+        elif callable(getattr(arg, "_resolve_function", None)):
+            # a global function not looked up yet
+            values[i].v_handle = arg._resolve_function().handle
+            type_codes[i] = TypeCode.FUNC_HANDLE
         elif callable(arg):
             arg = convert_to_dgl_func(arg)
             values[i].v_handle = arg.handle
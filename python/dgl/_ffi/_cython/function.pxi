@@ -145,6 +145,10 @@ cdef inline int make_arg(object arg,
     elif isinstance(arg, ctypes.c_void_p):
         value[0].v_handle = c_handle(arg)
         tcode[0] = kHandle
+    elif callable(getattr(arg, "_resolve_function", None)):
+        # a global function not looked up yet
+        value[0].v_handle = (<FunctionBase>arg._resolve_function()).chandle
+        tcode[0] = kFuncHandle
     elif callable(arg):
         arg = convert_to_dgl_func(arg)
         value[0].v_handle = (<FunctionBase>arg).chandle
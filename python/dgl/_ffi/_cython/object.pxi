@@ -83,6 +83,9 @@ cdef class ObjectBase:
         instead of creating a new Object.
         """
         cdef void* chandle
+        if not isinstance(fconstructor, FunctionBase):
+            # a global function not looked up yet
+            fconstructor = fconstructor._resolve_function()
         ConstructorCall(
             (<FunctionBase>fconstructor).chandle,
             kObjectHandle, args, &chandle)
@@ -5,6 +5,7 @@ from __future__ import absolute_import
 
 import sys
 import os
+import time
 import ctypes
 import numpy as np
 from . import libinfo
@@ -40,8 +41,28 @@ def _load_lib():
 
 # version number
 __version__ = libinfo.__version__
+# The seconds spent in each phase of the startup, see startup_phases.
+_STARTUP_PHASES = {}
+
 # library instance of nnvm
+_LOAD_BEGIN = time.perf_counter()
 _LIB, _LIB_NAME, _DIR_NAME = _load_lib()
+_STARTUP_PHASES["load_library"] = time.perf_counter() - _LOAD_BEGIN
+
+def startup_phases():
+    """Get the time spent in each phase of loading DGL.
+
+    The phases are ``load_library``, loading the library including the static
+    initialization of its C APIs, and ``init_api``, exposing the C APIs to the
+    Python modules. When DGL is built with ``USE_PROFILING_RANGES``, the
+    exposing of the C APIs of every module is a profiling range as well.
+
+    Returns
+    -------
+    dict[str, float]
+        The seconds spent in each phase so far.
+    """
+    return dict(_STARTUP_PHASES)
 
 # The FFI mode of DGL
 _FFI_MODE = os.environ.get("DGL_FFI", "auto")
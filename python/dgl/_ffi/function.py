@@ -2,9 +2,12 @@
 """Function namespace."""
 from __future__ import absolute_import
 
+import os
 import sys
+import time
 import ctypes
 from .base import _LIB, check_call, py_str, c_str, string_types, _FFI_MODE
+from .base import _STARTUP_PHASES
 
 IMPORT_EXCEPT = RuntimeError if _FFI_MODE == "cython" else ImportError
 
@@ -28,6 +31,9 @@ except IMPORT_EXCEPT:
 
 FunctionHandle = ctypes.c_void_p
 
+# Whether the C APIs of the modules are only looked up on their first call.
+_LAZY_API = os.environ.get("DGL_LAZY_API", "1") != "0"
+
 class Function(_FunctionBase):
     """The PackedFunc object.
 
@@ -181,6 +187,8 @@ def register_func(func_name, f=None, override=False):
             myf = convert_to_dgl_func(myf)
         check_call(_LIB.DGLFuncRegisterGlobal(
             c_str(func_name), myf.handle, ioverride))
+        global _GLOBAL_FUNC_NAMES
+        _GLOBAL_FUNC_NAMES = None
         return myf
     if f:
         return register(f)
@@ -215,6 +223,72 @@ def get_global_func(name, allow_missing=False):
 
 
 
+class BatchResult(object):
+    """The result of a previous call of :func:`call_batch`, as an argument of
+    a later call of the same batch.
+
+    Parameters
+    ----------
+    index : int
+        The index of the previous call in the batch.
+    """
+    __slots__ = ["index"]
+
+    def __init__(self, index):
+        self.index = index
+
+
+_CALL_BATCH = None
+
+
+def call_batch(calls):
+    """Run a sequence of C API calls with a single call to the backend.
+
+    The arguments of every call crossing the FFI take a conversion, which
+    dominates the latency of the small calls, e.g. of online inference on tiny
+    graphs. The calls of a batch cross it once, and the results of the earlier
+    calls are passed to the later ones without coming back to Python.
+
+    Parameters
+    ----------
+    calls : list of (Function, tuple)
+        The functions and their arguments, in the order of the calls. An
+        argument :class:`BatchResult` is replaced with the result of a previous
+        call.
+
+    Returns
+    -------
+    The result of the last call, None if there is none.
+
+    Examples
+    --------
+    >>> from dgl._ffi.function import BatchResult, call_batch
+    >>> call_batch([(f, (x,)), (g, (BatchResult(0), 1))])  # same as g(f(x), 1)
+    """
+    global _CALL_BATCH
+    if _CALL_BATCH is None:
+        _CALL_BATCH = get_global_func("_CallBatch")
+    flat_args = [len(calls)]
+    refs = []
+    for i, (func, args) in enumerate(calls):
+        if isinstance(func, LazyFunction):
+            func = func._resolve_function()  # pylint: disable=protected-access
+        flat_args.append(func)
+        flat_args.append(len(args))
+        for j, arg in enumerate(args):
+            if isinstance(arg, BatchResult):
+                if not 0 <= arg.index < i:
+                    raise ValueError("Call %d can only use the results of the previous "
+                                     "calls, got %d." % (i, arg.index))
+                refs.extend((i, j, arg.index))
+                flat_args.append(None)
+            else:
+                flat_args.append(arg)
+    flat_args.append(len(refs) // 3)
+    flat_args.extend(refs)
+    return _CALL_BATCH(*flat_args)
+
+
 def list_global_func_names():
     """Get list of global functions registered.
 
@@ -263,6 +337,97 @@ def _get_api(f):
     flocal.is_global = True
     return flocal
 
+
+class LazyFunction(object):
+    """A global function of a module, looked up on its first use.
+
+    Looking up a function takes a call to the backend, and the modules of DGL
+    expose hundreds of them, most of which a program never calls. The function
+    replaces itself in its module with the looked up one on its first call.
+
+    Parameters
+    ----------
+    name : str
+        The name of the global function.
+    fname : str
+        The name of the function in the module.
+    module : module
+        The module of the function.
+    """
+    def __init__(self, name, fname, module):
+        self._name = name
+        self._module = module
+        self._func = None
+        self.__name__ = fname
+        self.__doc__ = ("DGL PackedFunc %s. " % fname)
+
+    def _resolve_function(self):
+        """Look up the function, once."""
+        if self._func is None:
+            f = _get_api(get_global_func(self._name))
+            f.__name__ = self.__name__
+            f.__doc__ = self.__doc__
+            self._func = f
+            if getattr(self._module, self.__name__, None) is self:
+                setattr(self._module, self.__name__, f)
+        return self._func
+
+    def __call__(self, *args):
+        return self._resolve_function()(*args)
+
+    def __getattr__(self, name):
+        # only reached for the attributes of the looked up function
+        return getattr(self._resolve_function(), name)
+
+
+# The names of the global functions by their namespace, "" for the internal
+# ones, listed once for all the modules.
+_GLOBAL_FUNC_NAMES = None
+
+
+def _global_func_names(prefix):
+    global _GLOBAL_FUNC_NAMES
+    if _GLOBAL_FUNC_NAMES is None:
+        names = {}
+        for name in list_global_func_names():
+            if name.startswith("_") and not name.startswith('_deprecate'):
+                names.setdefault("", []).append(name)
+            else:
+                names.setdefault(name.rsplit('.', 1)[0], []).append(name)
+        _GLOBAL_FUNC_NAMES = names
+    return _GLOBAL_FUNC_NAMES.get(prefix, [])
+
+
+def _set_api(target_module, name, fname):
+    if _LAZY_API:
+        setattr(target_module, fname, LazyFunction(name, fname, target_module))
+        return
+    f = get_global_func(name)
+    ff = _get_api(f)
+    ff.__name__ = fname
+    ff.__doc__ = ("DGL PackedFunc %s. " % fname)
+    setattr(target_module, ff.__name__, ff)
+
+
+class _StartupPhase(object):
+    """Time a phase of the startup, and name it by a profiling range when
+    the library is built with USE_PROFILING_RANGES."""
+    def __init__(self, phase, detail):
+        self.phase = phase
+        self.detail = detail
+        self.begin = None
+
+    def __enter__(self):
+        if "_ProfileRangePush" in _global_func_names(""):
+            get_global_func("_ProfileRangePush")("%s %s" % (self.phase, self.detail))
+        self.begin = time.perf_counter()
+
+    def __exit__(self, *args):
+        elapsed = time.perf_counter() - self.begin
+        _STARTUP_PHASES[self.phase] = _STARTUP_PHASES.get(self.phase, 0.) + elapsed
+        if "_ProfileRangePop" in _global_func_names(""):
+            get_global_func("_ProfileRangePop")()
+
 def _init_api(namespace, target_module_name=None):
     """Initialize api for a given module name
 
@@ -283,40 +448,22 @@ def _init_api(namespace, target_module_name=None):
 def _init_api_prefix(module_name, prefix):
     module = sys.modules[module_name]
 
-    for name in list_global_func_names():
-        if name.startswith("_") and not name.startswith('_deprecate'):
-            # internal APIs are ignored
-            continue
-        name_split = name.rsplit('.', 1)
-        if name_split[0] != prefix:
-            continue
-
-        if len(name_split) == 1:
-            print('Warning: invalid API name "%s".' % name)
-            continue
-        fname = name_split[1]
-        target_module = module
-
-        f = get_global_func(name)
-        ff = _get_api(f)
-        ff.__name__ = fname
-        ff.__doc__ = ("DGL PackedFunc %s. " % fname)
-        setattr(target_module, ff.__name__, ff)
+    with _StartupPhase("init_api", module_name):
+        for name in _global_func_names(prefix):
+            name_split = name.rsplit('.', 1)
+            if len(name_split) == 1:
+                print('Warning: invalid API name "%s".' % name)
+                continue
+            _set_api(module, name, name_split[1])
 
 def _init_internal_api():
-    for name in list_global_func_names():
-        if not name.startswith("_") or name.startswith('_deprecate'):
-            # normal APIs are ignored
-            continue
-        target_module = sys.modules["dgl._api_internal"]
-        fname = name
-        if fname.find(".") != -1:
-            print('Warning: invalid API name "%s".' % fname)
-            continue
-        f = get_global_func(name)
-        ff = _get_api(f)
-        ff.__name__ = fname
-        ff.__doc__ = ("DGL PackedFunc %s. " % fname)
-        setattr(target_module, ff.__name__, ff)
+    target_module = sys.modules["dgl._api_internal"]
+    with _StartupPhase("init_api", "dgl._api_internal"):
+        for name in _global_func_names(""):
+            fname = name
+            if fname.find(".") != -1:
+                print('Warning: invalid API name "%s".' % fname)
+                continue
+            _set_api(target_module, name, fname)
 
 _set_class_function(Function)
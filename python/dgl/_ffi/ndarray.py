@@ -319,6 +319,9 @@ class NDArrayBase(_NDArrayBase):
     def pin_memory_(self, ctx):
         """Pin host memory and map into GPU address space (in-place)
 
+        Nothing is done if the memory is page-locked already. The memory is
+        unpinned by :func:`unpin_memory_`, or else when the array is freed.
+
         Parameters
         ----------
         ctx : DGLContext
@@ -16,7 +16,11 @@ class StreamContext(object):
     """ Context-manager that selects a given stream.
 
     All CUDA kernels queued within its context will be enqueued
-    on a selected stream.
+    on a selected stream. This covers the array and graph operators,
+    the cuSPARSE and cuBLAS calls and the copies between the host and the
+    device, so that e.g. the sampling of a data loader can run on its own
+    stream and overlap with the computation of the model. The stream is
+    selected for the calling thread only.
 
     """
 
@@ -47,6 +51,24 @@ class StreamContext(object):
             self.ctx.device_type, self.ctx.device_id, self.prev_cuda_stream))
 
 
+def current_stream(ctx):
+    """ Return the handle of the CUDA stream selected for the calling thread.
+
+    Parameters
+    ----------
+    ctx : DGLContext
+        The device.
+
+    Returns
+    -------
+    int
+        The handle of the stream, 0 for the default stream.
+    """
+    handle = DGLStreamHandle()
+    check_call(_LIB.DGLGetStream(ctx.device_type, ctx.device_id, ctypes.byref(handle)))
+    return handle.value or 0
+
+
 def stream(cuda_stream):
     """ Wrapper of StreamContext
 
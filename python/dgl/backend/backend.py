@@ -1712,7 +1712,7 @@ def scatter_add(x, idx, m):
     """
     pass
 
-def csrmm(A, A_weights, B, B_weights, num_vtypes):
+def csrmm(A, A_weights, B, B_weights, num_vtypes, topk=-1):
     """Compute weighted adjacency matrix multiplication.
 
     Notes
@@ -1734,6 +1734,9 @@ def csrmm(A, A_weights, B, B_weights, num_vtypes):
         The edge weights of B.  Must be a 1D vector.
     num_vtypes : int
         The number of node types of the output graph.  Must be either 1 or 2.
+    topk : int, optional
+        The number of largest entries to keep in every row of the product, or -1 to
+        keep them all.  Only supported on CPU.
 
     Returns
     -------
@@ -1770,6 +1773,38 @@ def csrsum(gidxs, weights):
     """
     pass
 
+def csrmaskedmm(A, A_weights, B, B_weights, M):
+    """Compute weighted adjacency matrix multiplication only at the non-zero
+    positions of graph :attr:`M`'s adjacency matrix.
+
+    In scipy, this is equivalent to ``(A @ B)[M != 0]``, without the rest of the
+    product.
+
+    Notes
+    -----
+    A must allow creation of CSR and B of CSC representations, and both must be simple
+    graphs (i.e. having at most one edge between two nodes).
+
+    Parameters
+    ----------
+    A : HeteroGraphIndex
+        The unit graph as left operand.
+    A_weights : Tensor
+        The edge weights of A.  Must be a 1D vector.
+    B : HeteroGraphIndex
+        The unit graph as right operand.
+    B_weights : Tensor
+        The edge weights of B.  Must be a 1D vector.
+    M : HeteroGraphIndex
+        The unit graph whose edges are the entries to compute.
+
+    Returns
+    -------
+    Tensor
+        The entries of the product at the edges of M.
+    """
+    pass
+
 def csrmask(A, A_weights, B):
     """Retrieve the values in the weighted adjacency matrix of graph :attr:`A` at the
     non-zero positions of graph :attr:`B`'s adjacency matrix.
@@ -2,13 +2,13 @@ import mxnet as mx
 import numpy as np
 from mxnet import nd
 from ...sparse import _gspmm, _gsddmm, _segment_reduce, _bwd_segment_cmp, _scatter_add
-from ...sparse import _csrmm, _csrsum, _csrmask
+from ...sparse import _csrmm, _csrsum, _csrmask, _csrmaskedmm
 from ...base import dgl_warning, is_all, ALL
 from .tensor import asnumpy, copy_to, zerocopy_from_numpy, context, to_backend_ctx
 from ...heterograph_index import create_unitgraph_from_csr
 
 __all__ = ['gspmm', 'gsddmm', 'edge_softmax', 'segment_reduce', 'scatter_add',
-           'csrmm', 'csrsum', 'csrmask']
+           'csrmm', 'csrsum', 'csrmask', 'csrmaskedmm']
 
 
 def _scatter_nd(index, src, n_rows):
@@ -385,14 +385,16 @@ def scatter_add(x, idx, m):
 
 
 class CSRMM(mx.autograd.Function):
-    def __init__(self, gidxA, gidxB, num_vtypes):
+    def __init__(self, gidxA, gidxB, num_vtypes, topk):
         super().__init__()
         self.gidxA = gidxA
         self.gidxB = gidxB
         self.num_vtypes = num_vtypes
+        self.topk = topk
 
     def forward(self, A_weights, B_weights):
-        gidxC, C_weights = _csrmm(self.gidxA, A_weights, self.gidxB, B_weights, self.num_vtypes)
+        gidxC, C_weights = _csrmm(
+            self.gidxA, A_weights, self.gidxB, B_weights, self.num_vtypes, self.topk)
         nrows, ncols, C_indptr, C_indices, C_eids = gidxC.adjacency_matrix_tensors(0, False, 'csr')
         # Note: the returned C_indptr, C_indices and C_eids tensors MUST be the same
         # as the underlying tensors of the created graph gidxC.
@@ -414,8 +416,8 @@ class CSRMM(mx.autograd.Function):
         dB_weights = _csrmask(dgidxB, dB_weights, self.gidxB)
         return dA_weights, dB_weights
 
-def csrmm(gidxA, A_weights, gidxB, B_weights, num_vtypes):
-    op = CSRMM(gidxA, gidxB, num_vtypes)
+def csrmm(gidxA, A_weights, gidxB, B_weights, num_vtypes, topk=-1):
+    op = CSRMM(gidxA, gidxB, num_vtypes, topk)
     nrows, ncols, C_indptr, C_indices, C_eids, C_weights = op(A_weights, B_weights)
     gidxC = create_unitgraph_from_csr(
         num_vtypes, nrows.asscalar(), ncols.asscalar(), C_indptr, C_indices, C_eids,
@@ -467,3 +469,27 @@ class CSRMask(mx.autograd.Function):
 def csrmask(gidxA, A_weights, gidxB):
     op = CSRMask(gidxA, gidxB)
     return op(A_weights)
+
+class CSRMaskedMM(mx.autograd.Function):
+    def __init__(self, gidxA, gidxB, gidxM):
+        super().__init__()
+        self.gidxA = gidxA
+        self.gidxB = gidxB
+        self.gidxM = gidxM
+
+    def forward(self, A_weights, B_weights):
+        self.save_for_backward(A_weights, B_weights)
+        return _csrmaskedmm(self.gidxA, A_weights, self.gidxB, B_weights, self.gidxM)
+
+    def backward(self, dM_weights):
+        A_weights, B_weights = self.saved_tensors
+        # the gradients are products masked by the operands themselves
+        dA_weights = _csrmaskedmm(
+            self.gidxM, dM_weights, self.gidxB.reverse(), B_weights, self.gidxA)
+        dB_weights = _csrmaskedmm(
+            self.gidxA.reverse(), A_weights, self.gidxM, dM_weights, self.gidxB)
+        return dA_weights, dB_weights
+
+def csrmaskedmm(gidxA, A_weights, gidxB, B_weights, gidxM):
+    op = CSRMaskedMM(gidxA, gidxB, gidxM)
+    return op(A_weights, B_weights)
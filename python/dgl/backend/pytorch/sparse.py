@@ -3,6 +3,8 @@ from distutils.version import LooseVersion
 from ...base import is_all, ALL
 from ...sparse import _gspmm, _gspmm_hetero, _gsddmm, _gsddmm_hetero, _segment_reduce, _bwd_segment_cmp
 from ...sparse import _csrmm, _csrsum, _csrmask, _scatter_add, _update_grad_minmax_hetero
+from ...sparse import _csrmaskedmm
+from ...sparse import _edge_softmax_forward, _edge_softmax_backward
 from ...heterograph_index import create_unitgraph_from_csr
 
 if LooseVersion(th.__version__) >= LooseVersion("1.6.0"):
@@ -27,7 +29,7 @@ else:
         return decorate_bwd
 
 __all__ = ['gspmm', 'gsddmm', 'gspmm_hetero', 'gsddmm_hetero', 'edge_softmax', 'edge_softmax_hetero',
-           'segment_reduce', 'scatter_add', 'csrmm', 'csrsum', 'csrmask']
+           'segment_reduce', 'scatter_add', 'csrmm', 'csrsum', 'csrmask', 'csrmaskedmm']
 
 
 def _reduce_grad(grad, shape):
@@ -447,6 +449,17 @@ class GSDDMM_hetero(th.autograd.Function):
         return (None, None, None, None, None) + dX + dY
 
 
+def _use_native_edge_softmax(gidx, score):
+    """Whether the single kernel edge softmax applies, which requires the CSC
+    format of the graph. The CPU kernel does not support float16."""
+    if gidx.number_of_etypes() != 1:
+        return False
+    fmts = gidx.formats()
+    if 'csc' not in fmts['created'] + fmts['not created']:
+        return False
+    return score.is_cuda or score.dtype != th.float16
+
+
 class EdgeSoftmax(th.autograd.Function):
     @staticmethod
     @custom_fwd(cast_inputs=th.float16)
@@ -470,10 +483,13 @@ class EdgeSoftmax(th.autograd.Function):
             gidx = gidx.edge_subgraph([eids], True).graph
         if norm_by == 'src':
             gidx = gidx.reverse()
-        score_max = _gspmm(gidx, 'copy_rhs', 'max', None, score)[0]
-        score = th.exp(_gsddmm(gidx, 'sub', score, score_max, 'e', 'v'))
-        score_sum = _gspmm(gidx, 'copy_rhs', 'sum', None, score)[0]
-        out = _gsddmm(gidx, 'div', score, score_sum, 'e', 'v')
+        if _use_native_edge_softmax(gidx, score):
+            out = _edge_softmax_forward(gidx, score)
+        else:
+            score_max = _gspmm(gidx, 'copy_rhs', 'max', None, score)[0]
+            score = th.exp(_gsddmm(gidx, 'sub', score, score_max, 'e', 'v'))
+            score_sum = _gspmm(gidx, 'copy_rhs', 'sum', None, score)[0]
+            out = _gsddmm(gidx, 'div', score, score_sum, 'e', 'v')
         ctx.backward_cache = gidx
         ctx.save_for_backward(out)
         return out
@@ -499,6 +515,11 @@ class EdgeSoftmax(th.autograd.Function):
         # See https://github.com/dmlc/dgl/pull/3386
         ctx.backward_cache = None
         out, = ctx.saved_tensors
+        # the native kernel is not differentiable, keep the composed operators
+        # for higher order gradients
+        if not th.is_grad_enabled() and _use_native_edge_softmax(gidx, out):
+            grad_score = _edge_softmax_backward(gidx, out, grad_out)
+            return None, grad_score, None, None
         sds = out * grad_out
         accum = gspmm(gidx, 'copy_rhs', 'sum', None, sds)
 
@@ -624,8 +645,8 @@ class ScatterAdd(th.autograd.Function):
 
 class CSRMM(th.autograd.Function):
     @staticmethod
-    def forward(ctx, gidxA, A_weights, gidxB, B_weights, num_vtypes):
-        gidxC, C_weights = _csrmm(gidxA, A_weights, gidxB, B_weights, num_vtypes)
+    def forward(ctx, gidxA, A_weights, gidxB, B_weights, num_vtypes, topk):
+        gidxC, C_weights = _csrmm(gidxA, A_weights, gidxB, B_weights, num_vtypes, topk)
         nrows, ncols, C_indptr, C_indices, C_eids = gidxC.adjacency_matrix_tensors(0, False, 'csr')
         # Note: the returned C_indptr, C_indices and C_eids tensors MUST be the same
         # as the underlying tensors of the created graph gidxC.
@@ -645,7 +666,7 @@ class CSRMM(th.autograd.Function):
             gidxA.reverse(), A_weights, gidxC, dC_weights, gidxB.number_of_ntypes())
         dA_weights = csrmask(dgidxA, dA_weights, gidxA)
         dB_weights = csrmask(dgidxB, dB_weights, gidxB)
-        return None, dA_weights, None, dB_weights, None
+        return None, dA_weights, None, dB_weights, None, None
 
 
 class CSRSum(th.autograd.Function):
@@ -668,6 +689,24 @@ class CSRSum(th.autograd.Function):
         return (None,) + tuple(csrmask(gidxC, dC_weights, gidx) for gidx in gidxs)
 
 
+class CSRMaskedMM(th.autograd.Function):
+    @staticmethod
+    def forward(ctx, gidxA, A_weights, gidxB, B_weights, gidxM):
+        ctx.backward_cache = gidxA, gidxB, gidxM
+        ctx.save_for_backward(A_weights, B_weights)
+        return _csrmaskedmm(gidxA, A_weights, gidxB, B_weights, gidxM)
+
+    @staticmethod
+    def backward(ctx, dM_weights):
+        gidxA, gidxB, gidxM = ctx.backward_cache
+        ctx.backward_cache = None
+        A_weights, B_weights = ctx.saved_tensors
+        # the gradients are products masked by the operands themselves
+        dA_weights = csrmaskedmm(gidxM, dM_weights, gidxB.reverse(), B_weights, gidxA)
+        dB_weights = csrmaskedmm(gidxA.reverse(), A_weights, gidxM, dM_weights, gidxB)
+        return None, dA_weights, None, dB_weights, None
+
+
 class CSRMask(th.autograd.Function):
     @staticmethod
     def forward(ctx, gidxA, A_weights, gidxB):
@@ -739,9 +778,9 @@ def segment_reduce(op, x, offsets):
 def scatter_add(x, idx, m):
     return ScatterAdd.apply(x, idx, m)
 
-def csrmm(gidxA, A_weights, gidxB, B_weights, num_vtypes):
+def csrmm(gidxA, A_weights, gidxB, B_weights, num_vtypes, topk=-1):
     nrows, ncols, C_indptr, C_indices, C_eids, C_weights = \
-        CSRMM.apply(gidxA, A_weights, gidxB, B_weights, num_vtypes)
+        CSRMM.apply(gidxA, A_weights, gidxB, B_weights, num_vtypes, topk)
     gidxC = create_unitgraph_from_csr(
         num_vtypes, nrows.item(), ncols.item(), C_indptr, C_indices, C_eids,
         ["coo", "csr", "csc"])
@@ -756,3 +795,6 @@ def csrsum(gidxs, weights):
 
 def csrmask(gidxA, A_weights, gidxB):
     return CSRMask.apply(gidxA, A_weights, gidxB)
+
+def csrmaskedmm(gidxA, A_weights, gidxB, B_weights, gidxM):
+    return CSRMaskedMM.apply(gidxA, A_weights, gidxB, B_weights, gidxM)
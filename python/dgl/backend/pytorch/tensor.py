@@ -20,6 +20,7 @@ if LooseVersion(th.__version__) < LooseVersion("1.5.0"):
 
 def data_type_dict():
     return {'float16' : th.float16,
+            'bfloat16' : th.bfloat16,
             'float32' : th.float32,
             'float64' : th.float64,
             'uint8'   : th.uint8,
@@ -3,11 +3,11 @@ import numpy as np
 from .tensor import tensor, copy_to, context, asnumpy, zerocopy_from_numpy
 from ...base import is_all, ALL
 from ...sparse import _gspmm, _gsddmm, _segment_reduce, _bwd_segment_cmp, _scatter_add
-from ...sparse import _csrmm, _csrsum, _csrmask
+from ...sparse import _csrmm, _csrsum, _csrmask, _csrmaskedmm
 from ...heterograph_index import create_unitgraph_from_csr
 
 __all__ = ['gspmm', 'gsddmm', 'edge_softmax', 'segment_reduce', 'scatter_add',
-           'csrmm', 'csrsum', 'csrmask']
+           'csrmm', 'csrsum', 'csrmask', 'csrmaskedmm']
 
 
 def _scatter_nd(index, src, n_rows):
@@ -300,8 +300,8 @@ def scatter_add(x, idx, m):
     return _lambda(x)
 
 
-def csrmm_real(gidxA, A_weights, gidxB, B_weights, num_vtypes):
-    gidxC, C_weights = _csrmm(gidxA, A_weights, gidxB, B_weights, num_vtypes)
+def csrmm_real(gidxA, A_weights, gidxB, B_weights, num_vtypes, topk):
+    gidxC, C_weights = _csrmm(gidxA, A_weights, gidxB, B_weights, num_vtypes, topk)
     nrows, ncols, C_indptr, C_indices, C_eids = gidxC.adjacency_matrix_tensors(0, False, 'csr')
 
     def grad(dnrows, dncols, dC_indptr, dC_indices, dC_eids, dC_weights):
@@ -315,10 +315,10 @@ def csrmm_real(gidxA, A_weights, gidxB, B_weights, num_vtypes):
         return dA_weights, dB_weights
     return (tf.constant(nrows), tf.constant(ncols), C_indptr, C_indices, C_eids, C_weights), grad
 
-def csrmm(gidxA, A_weights, gidxB, B_weights, num_vtypes):
+def csrmm(gidxA, A_weights, gidxB, B_weights, num_vtypes, topk=-1):
     @tf.custom_gradient
     def _lambda(A_weights, B_weights):
-        return csrmm_real(gidxA, A_weights, gidxB, B_weights, num_vtypes)
+        return csrmm_real(gidxA, A_weights, gidxB, B_weights, num_vtypes, topk)
     nrows, ncols, C_indptr, C_indices, C_eids, C_weights = _lambda(A_weights, B_weights)
     gidxC = create_unitgraph_from_csr(
         num_vtypes, nrows.numpy(), ncols.numpy(), C_indptr, C_indices, C_eids,
@@ -359,3 +359,20 @@ def csrmask(gidxA, A_weights, gidxB):
     def _lambda(A_weights):
         return csrmask_real(gidxA, A_weights, gidxB)
     return _lambda(A_weights)
+
+
+def csrmaskedmm_real(gidxA, A_weights, gidxB, B_weights, gidxM):
+    M_weights = _csrmaskedmm(gidxA, A_weights, gidxB, B_weights, gidxM)
+
+    def grad(dM_weights):
+        # the gradients are products masked by the operands themselves
+        dA_weights = _csrmaskedmm(gidxM, dM_weights, gidxB.reverse(), B_weights, gidxA)
+        dB_weights = _csrmaskedmm(gidxA.reverse(), A_weights, gidxM, dM_weights, gidxB)
+        return dA_weights, dB_weights
+    return M_weights, grad
+
+def csrmaskedmm(gidxA, A_weights, gidxB, B_weights, gidxM):
+    @tf.custom_gradient
+    def _lambda(A_weights, B_weights):
+        return csrmaskedmm_real(gidxA, A_weights, gidxB, B_weights, gidxM)
+    return _lambda(A_weights, B_weights)
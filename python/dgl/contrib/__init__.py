@@ -3,3 +3,4 @@ from . import graph_store
 from .dis_kvstore import KVClient, KVServer
 from .dis_kvstore import read_ip_config
 from .unified_tensor import UnifiedTensor
+from .quantized_tensor import QuantizedTensor, quantized_copy_u_sum
@@ -0,0 +1,139 @@
+"""Quantized Tensor."""
+from .. import backend as F
+from .._ffi.function import _init_api
+from .. import utils
+
+__all__ = ['QuantizedTensor', 'quantized_copy_u_sum']
+
+class QuantizedTensor: #QuantizedTensor
+    '''Class for storing a float32 feature tensor as int8 or float16 values,
+    read back as float32 rows.
+
+    An int8 value ``q`` stands for ``scale * (q - zero_point)``, with a scale
+    and a zero point for every row, or for every column if ``per_row`` is False,
+    mapping the range of the row or of the column to [-128, 127]. The rows are
+    dequantized where they are gathered, so a GPU only reads a quarter (int8) or
+    a half (float16) of the bytes of the float32 rows.
+
+    Parameters
+    ----------
+    input : Tensor
+        The float32 tensor to quantize, on CPU.
+    dtype : str, optional
+        ``'int8'`` or ``'float16'``. Default: ``'int8'``.
+    per_row : bool, optional
+        Whether the int8 values are scaled by row or by column. Default: True.
+    device : device, optional
+        The GPU reading the quantized values from pinned memory, by zero-copy
+        access. Default: None, i.e. the values are only read on CPU.
+
+    Examples
+    --------
+    >>> feats = dgl.contrib.QuantizedTensor(torch.rand((128, 128)), device=torch.device('cuda'))
+
+    Indexing with a GPU index gathers the int8 rows over PCIe and dequantizes
+    them on the GPU:
+
+    >>> idx = torch.tensor([0, 1, 2], device='cuda')
+    >>> output = feats[idx]
+
+    The quantized features of the source nodes can be summed on CPU without
+    dequantizing the table first:
+
+    >>> h = dgl.contrib.quantized_copy_u_sum(g, feats)
+    '''
+
+    def __init__(self, input, dtype='int8', per_row=True, device=None):
+        if F.device_type(F.context(input)) != 'cpu':
+            raise ValueError("Input tensor must be a cpu tensor")
+        if device is not None and F.device_type(device) != 'cuda':
+            raise ValueError("Target device must be a cuda device")
+        if dtype not in ('int8', 'float16'):
+            raise ValueError("The dtype must be 'int8' or 'float16'")
+
+        self._shape = tuple(F.shape(input))
+        self._per_row = per_row
+        self._device = device
+        self._data, self._scale, self._zero_point = _CAPI_DGLQuantize(
+            F.zerocopy_to_dgl_ndarray(input), dtype, per_row)
+        if device is not None:
+            ctx = utils.to_dgl_context(device)
+            for arr in self._arrays():
+                arr.pin_memory_(ctx)
+
+    def _arrays(self):
+        # the float16 tables have empty scales and zero points, not pinned
+        if self._data.dtype == 'float16':
+            return [self._data]
+        return [self._data, self._scale, self._zero_point]
+
+    def __len__(self):
+        return self._shape[0]
+
+    def __getitem__(self, key):
+        '''Gather the rows of the ids as float32 rows, on the device of the
+        key. A cuda key reads the quantized rows from pinned memory.
+
+        Parameters
+        ----------
+        key : Tensor
+            Tensor which contains the index ids, on CPU or on the GPU of the
+            tensor.
+        '''
+        if F.device_type(F.context(key)) == 'cuda' and self._device is None:
+            raise ValueError("The QuantizedTensor has no device to be read from")
+        return F.zerocopy_from_dgl_ndarray(_CAPI_DGLIndexSelectDequantize(
+            self._data, self._scale, self._zero_point, self._per_row,
+            F.zerocopy_to_dgl_ndarray(key)))
+
+    def dequantize(self):
+        '''The float32 tensor of all the rows, on CPU.'''
+        return F.zerocopy_from_dgl_ndarray(_CAPI_DGLDequantize(
+            self._data, self._scale, self._zero_point, self._per_row))
+
+    def __del__(self):
+        if hasattr(self, '_data') and self._device is not None:
+            ctx = utils.to_dgl_context(self._device)
+            for arr in self._arrays():
+                arr.unpin_memory_(ctx)
+            self._data = None
+
+    @property
+    def shape(self):
+        """Shape of this tensor"""
+        return self._shape
+
+    @property
+    def dtype(self):
+        """Type of the stored values"""
+        return self._data.dtype
+
+    @property
+    def device(self):
+        """Device of this tensor"""
+        return self._device
+
+def quantized_copy_u_sum(g, feat):
+    r'''Sum the features of the source nodes of the inbound edges of every node,
+    read from a quantized tensor, like :func:`dgl.ops.copy_u_sum` on its
+    dequantized tensor.
+
+    Parameters
+    ----------
+    g : DGLGraph
+        The graph, with a single edge type, on CPU.
+    feat : QuantizedTensor
+        The features of the source nodes.
+
+    Returns
+    -------
+    Tensor
+        The float32 features of the destination nodes, on CPU.
+    '''
+    out = F.zeros((g.num_dst_nodes(),) + feat.shape[1:], F.float32, F.cpu())
+    _CAPI_DGLSpMMCopyUSumQuantized(
+        g._graph, feat._data, feat._scale, feat._zero_point, feat._per_row,
+        F.zerocopy_to_dgl_ndarray_for_write(out))
+    return out
+
+_init_api("dgl.ndarray.quantized", __name__)
@@ -19,6 +19,18 @@ class UnifiedTensor: #UnifiedTensor
         unified tensor.
     device : device
         GPU to create the address mapping of the input CPU tensor.
+    cache_size : int, optional
+        The number of rows to cache on the GPU. The rows of the ids given to
+        :meth:`preload_cache` are cached for good. If ``dynamic_cache`` is True,
+        the remaining rows of the cache hold the rows last read from the CPU,
+        replaced in first-in first-out order. Default: 0, i.e. no cache.
+    dynamic_cache : bool, optional
+        Whether to cache the rows read from the CPU. Default: False.
+    sort_index : bool, optional
+        Whether to read the rows in the order of their ids, with a warp per
+        row, and put them back in the order of the index on the GPU. It
+        coalesces the reads of random rows of 64 to 256 elements over PCIe,
+        for the cost of a sort of the index. Default: False.
 
     Examples
     --------
@@ -63,9 +75,18 @@ class UnifiedTensor: #UnifiedTensor
     >>> sub_feat_gpu2 = feats_gpu2[feats_idx_gpu2]
 
     ``feats_gpu2`` tensors, respectively.
+
+    To read the most accessed rows from the GPU memory, e.g. of the nodes of the
+    highest in-degrees, one can cache them:
+
+    >>> feats = dgl.contrib.UnifiedTensor(feats, device=torch.device('cuda'), cache_size=32)
+    >>> feats.preload_cache(torch.topk(g.in_degrees(), 32).indices.to('cuda'))
+    >>> rows, counts = feats.gather(idx)
+
+    where ``counts`` holds the numbers of rows read from the cache and from the CPU.
     '''
 
-    def __init__(self, input, device):
+    def __init__(self, input, device, cache_size=0, dynamic_cache=False, sort_index=False):
         if F.device_type(device) != 'cuda':
             raise ValueError("Target device must be a cuda device")
         if F.device_type(F.context(input)) != 'cpu':
@@ -74,8 +95,14 @@ class UnifiedTensor: #UnifiedTensor
         self._input = input
         self._array = F.zerocopy_to_dgl_ndarray(self._input)
         self._device = device
+        self._sort_index = sort_index
 
         self._array.pin_memory_(utils.to_dgl_context(self._device))
+        self._cache = None
+        if cache_size > 0:
+            self._cache = _CAPI_DGLGPUFeatureCacheCreate(
+                self._array, utils.to_dgl_context(self._device).device_id,
+                cache_size, dynamic_cache)
 
     def __len__(self):
         return len(self._array)
@@ -95,15 +122,94 @@ class UnifiedTensor: #UnifiedTensor
         '''
         if F.device_type(F.context(key)) != 'cuda':
             return self._input[key]
+        elif self._cache is not None:
+            return self.gather(key)[0]
         else:
             return F.zerocopy_from_dgl_ndarray(
                     _CAPI_DGLIndexSelectCPUFromGPU(self._array,
-                                F.zerocopy_to_dgl_ndarray(key)))
+                                F.zerocopy_to_dgl_ndarray(key), self._sort_index))
+
+    def preload_cache(self, ids):
+        '''Cache the rows of the given ids for good, replacing the content
+        of the cache. The ids beyond the cache size are ignored.
+
+        Parameters
+        ----------
+        ids : Tensor
+            The distinct row ids, on the GPU of the tensor.
+        '''
+        if self._cache is None:
+            raise ValueError("The UnifiedTensor has no cache")
+        _CAPI_DGLGPUFeatureCachePreload(self._cache, F.zerocopy_to_dgl_ndarray(ids))
+
+    def gather(self, key):
+        '''Perform zero-copy access from GPU through the cache.
+
+        Parameters
+        ----------
+        key : Tensor
+            Tensor which contains the index ids, on the GPU of the tensor.
+
+        Returns
+        -------
+        Tensor
+            The rows, on the GPU.
+        Tensor
+            The numbers of rows read from the cache and from the CPU, on the GPU.
+        '''
+        if self._cache is None:
+            raise ValueError("The UnifiedTensor has no cache")
+        rows, counts = _CAPI_DGLGPUFeatureCacheIndexSelect(
+            self._cache, F.zerocopy_to_dgl_ndarray(key))
+        return F.zerocopy_from_dgl_ndarray(rows), F.zerocopy_from_dgl_ndarray(counts)
 
     def __setitem__(self, key, val):
-        self._input[key] = val
+        '''Perform zero-copy write from GPU if the context of
+        the key is cuda. Otherwise, just safely fallback to the
+        backend specific indexing scheme.
+
+        Parameters
+        ----------
+        key : Tensor
+            Tensor which contains the index ids
+        val : Tensor
+            The rows to write, on the device of the key. For the duplicate
+            ids, any of the rows is written.
+        '''
+        if F.device_type(F.context(key)) != 'cuda':
+            self._input[key] = val
+        else:
+            self._check_uncached()
+            _CAPI_DGLIndexScatterGPUToCPU(self._array, F.zerocopy_to_dgl_ndarray(key),
+                                          F.zerocopy_to_dgl_ndarray(F.copy_to(val, self._device)))
+
+    def index_add_(self, key, val):
+        '''Add the rows to the rows of the ids, from GPU if the context of
+        the key is cuda, e.g. to apply the gradients of a sparse embedding.
+        The rows of the duplicate ids are summed on the GPU first, so that
+        every row of the CPU tensor is only updated once.
+
+        Parameters
+        ----------
+        key : Tensor
+            Tensor which contains the index ids
+        val : Tensor
+            The float rows to add, on the device of the key.
+        '''
+        if F.device_type(F.context(key)) != 'cuda':
+            F.index_add_inplace(self._input, key, val)
+        else:
+            self._check_uncached()
+            _CAPI_DGLIndexAddGPUToCPU(self._array, F.zerocopy_to_dgl_ndarray(key),
+                                      F.zerocopy_to_dgl_ndarray(F.copy_to(val, self._device)))
+
+    def _check_uncached(self):
+        if self._cache is not None:
+            raise ValueError("The UnifiedTensor with a cache cannot be written from GPU")
 
     def __del__(self):
+        if hasattr(self, '_cache'):
+            self._cache = None
         if hasattr(self, '_array') and self._array != None:
             self._array.unpin_memory_(utils.to_dgl_context(self._device))
             self._array = None
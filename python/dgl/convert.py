@@ -17,6 +17,7 @@ __all__ = [
     'bipartite',
     'hetero_from_relations',
     'hetero_from_shared_memory',
+    'hetero_from_cuda_shared_memory',
     'heterograph',
     'create_block',
     'block_to_graph',
@@ -29,6 +30,7 @@ __all__ = [
     'from_networkx',
     'bipartite_from_networkx',
     'to_networkx',
+    'StreamingGraphBuilder',
 ]
 
 def graph(data,
@@ -39,6 +41,7 @@ def graph(data,
           device=None,
           row_sorted=False,
           col_sorted=False,
+          trusted=False,
           **deprecated_kwargs):
     """Create a graph and return.
 
@@ -88,7 +91,14 @@ def graph(data,
         Whether or not the rows of the COO are in ascending order.
     col_sorted : bool, optional
         Whether or not the columns of the COO are in ascending order within
-        each row. This only has an effect when ``row_sorted`` is True.
+        each row. This only has an effect when ``row_sorted`` is True. For CSR or
+        CSC data, whether the indices are in ascending order within each row.
+    trusted : bool, optional
+        Whether the data comes with exact metadata, e.g. edges saved by DGL, so
+        that no pass over the edges validates or infers it. The node IDs are
+        not checked against :attr:`num_nodes`, which is then required, and
+        :attr:`row_sorted` and :attr:`col_sorted` are taken as exact, i.e.
+        unsorted edges are not scanned for order.
 
     Returns
     -------
@@ -176,15 +186,18 @@ def graph(data,
                        " Please refer to their API documents for more details.".format(
                            deprecated_kwargs.keys()))
 
-    (sparse_fmt, arrays), urange, vrange = utils.graphdata2tensors(data, idtype)
+    if trusted and num_nodes is None:
+        raise DGLError('The num_nodes argument is required by trusted=True.')
+    (sparse_fmt, arrays), urange, vrange = utils.graphdata2tensors(
+        data, idtype, infer_nodes=not trusted)
     if num_nodes is not None:  # override the number of nodes
-        if num_nodes < max(urange, vrange):
+        if urange is not None and num_nodes < max(urange, vrange):
             raise DGLError('The num_nodes argument must be larger than the max ID in the data,'
                            ' but got {} and {}.'.format(num_nodes, max(urange, vrange) - 1))
         urange, vrange = num_nodes, num_nodes
 
     g = create_from_edges(sparse_fmt, arrays, '_N', '_E', '_N', urange, vrange,
-                          row_sorted=row_sorted, col_sorted=col_sorted)
+                          row_sorted=row_sorted, col_sorted=col_sorted, trusted=trusted)
 
     return g.to(device)
 
@@ -224,6 +237,27 @@ def hetero_from_shared_memory(name):
     g, ntypes, etypes = heterograph_index.create_heterograph_from_shared_memory(name)
     return DGLHeteroGraph(g, ntypes, etypes)
 
+def hetero_from_cuda_shared_memory(name):
+    """Open a heterograph on a GPU shared by another process with
+    :meth:`DGLGraph.cuda_shared_memory` under the given name.
+
+    The graph stays in the memory of the GPU of the other process, which this
+    process reads by CUDA IPC, so the structure is resident once on the GPU
+    however many processes use it. It has the same node types and edge types
+    as the original graph, but no node features or edge features.
+
+    Paramaters
+    ----------
+    name : str
+        The name of the share memory
+
+    Returns
+    -------
+    HeteroGraph (on the GPU)
+    """
+    g, ntypes, etypes = heterograph_index.create_heterograph_from_cuda_shared_memory(name)
+    return DGLHeteroGraph(g, ntypes, etypes)
+
 def heterograph(data_dict,
                 num_nodes_dict=None,
                 idtype=None,
@@ -1620,6 +1654,95 @@ def to_networkx(g, node_attrs=None, edge_attrs=None):
 
 DGLHeteroGraph.to_networkx = to_networkx
 
+class StreamingGraphBuilder(object):
+    """Build a graph from edges given by chunks, without holding all of them in
+    memory as an edge list.
+
+    The edges are buffered up to the memory budget, then spilled to temporary
+    files by ranges of source nodes. :meth:`build` then writes them into the CSR
+    of the graph, which is the only storage holding all the edges; the graph
+    can be saved with ``dgl.save_graphs(..., mmap_layout=True)`` to be mapped
+    into memory when loaded.
+
+    The edge IDs are given in the order the edges are added.
+
+    Parameters
+    ----------
+    num_nodes : int or (int, int)
+        The number of nodes, or the numbers of source and destination nodes of
+        a bipartite graph.
+    idtype : int32 or int64, optional
+        The data type of the node and edge IDs of the graph. Default: int64.
+    memory_budget : int, optional
+        The number of bytes used to buffer the edges. Default: 1GB.
+    tmp_dir : str, optional
+        The directory of the temporary files. Default: the directory of the
+        temporary files of the system.
+    num_buckets : int, optional
+        The number of ranges of source nodes spilled to separate files.
+        Default: 256.
+
+    Examples
+    --------
+    >>> builder = dgl.StreamingGraphBuilder(4)
+    >>> builder.add_edges(torch.tensor([0, 1]), torch.tensor([1, 2]))
+    >>> builder.add_edges(torch.tensor([3, 0]), torch.tensor([0, 3]))
+    >>> g = builder.build()
+    >>> g.edges(order='eid')
+    (tensor([0, 1, 3, 0]), tensor([1, 2, 0, 3]))
+    """
+    def __init__(self, num_nodes, idtype=F.int64, memory_budget=1 << 30,
+                 tmp_dir=None, num_buckets=256):
+        if isinstance(num_nodes, tuple):
+            self._num_src, self._num_dst = num_nodes
+            self._num_ntypes = 2
+        else:
+            self._num_src = self._num_dst = num_nodes
+            self._num_ntypes = 1
+        self._idtype = idtype
+        self._builder = heterograph_index._CAPI_DGLStreamingCSRBuilderCreate(
+            int(self._num_src), int(self._num_dst), 32 if idtype == F.int32 else 64,
+            int(memory_budget), tmp_dir or '', int(num_buckets))
+
+    def _to_ndarray(self, nodes):
+        if not F.is_tensor(nodes):
+            nodes = F.tensor(nodes, self._idtype)
+        return F.to_dgl_nd(F.copy_to(F.astype(nodes, self._idtype), F.cpu()))
+
+    def add_edges(self, u, v):
+        """Add the edges from the nodes ``u`` to the nodes ``v``.
+
+        Parameters
+        ----------
+        u : Tensor or iterable[int]
+            The source nodes.
+        v : Tensor or iterable[int]
+            The destination nodes.
+        """
+        heterograph_index._CAPI_DGLStreamingCSRBuilderAddEdges(
+            self._builder, self._to_ndarray(u), self._to_ndarray(v))
+
+    def build(self, sort_columns=True):
+        """Return the graph of all the edges added.
+
+        Parameters
+        ----------
+        sort_columns : bool, optional
+            Whether to sort the destination nodes of the out edges of every node
+            in the CSR of the graph. Default: True.
+
+        Returns
+        -------
+        DGLGraph
+            The graph, whose structure is stored as CSR.
+        """
+        gidx = heterograph_index._CAPI_DGLStreamingCSRBuilderFinish(
+            self._builder, self._num_ntypes, sort_columns)
+        if self._num_ntypes == 1:
+            return DGLHeteroGraph(gidx, ['_N'], ['_E'])
+        else:
+            return DGLHeteroGraph(gidx, ['_U', '_V'], ['_E'])
+
 ############################################################
 # Internal APIs
 ############################################################
@@ -1628,7 +1751,8 @@ def create_from_edges(sparse_fmt, arrays,
                       utype, etype, vtype,
                       urange, vrange,
                       row_sorted=False,
-                      col_sorted=False):
+                      col_sorted=False,
+                      trusted=False):
     """Internal function to create a graph from incident nodes with types.
 
     utype could be equal to vtype
@@ -1655,8 +1779,11 @@ def create_from_edges(sparse_fmt, arrays,
         Whether or not the rows of the COO are in ascending order.
     col_sorted : bool, optional
         Whether or not the columns of the COO are in ascending order within
-        each row. This only has an effect when ``row_sorted`` is True.
-
+        each row. This only has an effect when ``row_sorted`` is True. For CSR
+        or CSC arrays, whether the indices are in ascending order within each
+        row, which is only taken if ``trusted``.
+    trusted : bool, optional
+        Whether the sortedness flags are exact.
 
     Returns
     -------
@@ -1671,12 +1798,12 @@ def create_from_edges(sparse_fmt, arrays,
         u, v = arrays
         hgidx = heterograph_index.create_unitgraph_from_coo(
             num_ntypes, urange, vrange, u, v, ['coo', 'csr', 'csc'],
-            row_sorted, col_sorted)
+            row_sorted, col_sorted, trusted)
     else:   # 'csr' or 'csc'
         indptr, indices, eids = arrays
         hgidx = heterograph_index.create_unitgraph_from_csr(
             num_ntypes, urange, vrange, indptr, indices, eids, ['coo', 'csr', 'csc'],
-            sparse_fmt == 'csc')
+            sparse_fmt == 'csc', trusted and col_sorted)
     if utype == vtype:
         return DGLHeteroGraph(hgidx, [utype], [etype])
     else:
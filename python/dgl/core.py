@@ -2,6 +2,7 @@
 # pylint: disable=not-callable
 import numpy as np
 
+from ._ffi.function import _init_api
 from .base import DGLError, is_all, NID, EID, ALL, dgl_warning
 from . import backend as F
 from . import function as fn
@@ -90,6 +91,10 @@ def invoke_udf_reduce(graph, func, msgdata, *, orig_nid=None):
     It analyzes the graph, groups nodes by their degrees and applies the UDF on each
     group -- a strategy called *degree-bucketing*.
 
+    On CPU, the buckets and the mailboxes of all of them are built in C++, the
+    messages being gathered once into one buffer per message field, which every
+    bucket takes a slice of.
+
     Parameters
     ----------
     graph : DGLGraph
@@ -106,7 +111,6 @@ def invoke_udf_reduce(graph, func, msgdata, *, orig_nid=None):
     dict[str, Tensor]
         Results from running the UDF.
     """
-    degs = graph.in_degrees()
     nodes = graph.dstnodes()
     if orig_nid is None:
         orig_nid = nodes
@@ -115,10 +119,63 @@ def invoke_udf_reduce(graph, func, msgdata, *, orig_nid=None):
     dstdata = graph._node_frames[ntid]
     msgdata = Frame(msgdata)
 
-    # degree bucketing
-    unique_degs, bucketor = _bucketing(degs)
     bkt_rsts = []
     bkt_nodes = []
+    if F.device_type(graph.device) == 'cpu':
+        # degree bucketing and mailboxes of all the buckets in C++
+        keys = list(msgdata.keys())
+        ret = _CAPI_DGLDegreeBucketMailbox(
+            graph._graph, [F.to_dgl_nd(msgdata[k]) for k in keys])
+        unique_degs = F.asnumpy(F.from_dgl_nd(ret[0])).tolist()
+        sorted_nodes = F.from_dgl_nd(ret[1])
+        sections = F.asnumpy(F.from_dgl_nd(ret[2])).tolist()
+        mailboxes = {k : F.from_dgl_nd(mailbox) for k, mailbox in zip(keys, ret[4:])}
+        sorted_orig_nid = F.gather_row(orig_nid, sorted_nodes)
+        node_start = msg_start = 0
+        for deg, num_nodes_bkt in zip(unique_degs, sections):
+            node_bkt = F.narrow_row(sorted_nodes, node_start, node_start + num_nodes_bkt)
+            orig_nid_bkt = F.narrow_row(sorted_orig_nid, node_start, node_start + num_nodes_bkt)
+            node_start += num_nodes_bkt
+            if deg == 0:
+                # skip reduce function for zero-degree nodes
+                continue
+            bkt_nodes.append(node_bkt)
+            # the slices of the mailboxes, reshaped to (num_nodes_bkt, degree, feat_size)
+            maildata = {}
+            for k, mailbox in mailboxes.items():
+                msg = F.narrow_row(mailbox, msg_start, msg_start + num_nodes_bkt * deg)
+                if F.dtype(msg) != F.dtype(msgdata[k]):
+                    # bool messages are gathered as bytes
+                    msg = F.astype(msg, F.dtype(msgdata[k]))
+                maildata[k] = F.reshape(msg, (num_nodes_bkt, deg) + F.shape(msg)[1:])
+            msg_start += num_nodes_bkt * deg
+            nbatch = NodeBatch(graph, orig_nid_bkt, ntype, dstdata.subframe(node_bkt),
+                               msgs=maildata)
+            bkt_rsts.append(func(nbatch))
+    else:
+        _invoke_udf_reduce_buckets(graph, func, msgdata, nodes, orig_nid, bkt_rsts, bkt_nodes)
+
+    # prepare a result frame
+    retf = Frame(num_rows=len(nodes))
+    retf._initializers = dstdata._initializers
+    retf._default_initializer = dstdata._default_initializer
+
+    # merge bucket results and write to the result frame
+    if len(bkt_rsts) != 0:  # if all the nodes have zero degree, no need to merge results.
+        merged_rst = {}
+        for k in bkt_rsts[0].keys():
+            merged_rst[k] = F.cat([rst[k] for rst in bkt_rsts], dim=0)
+        merged_nodes = F.cat(bkt_nodes, dim=0)
+        retf.update_row(merged_nodes, merged_rst)
+
+    return retf
+
+def _invoke_udf_reduce_buckets(graph, func, msgdata, nodes, orig_nid, bkt_rsts, bkt_nodes):
+    """Run the UDF reduce on every degree bucket, bucketing in Python, and append
+    the results and the nodes of every bucket to ``bkt_rsts`` and ``bkt_nodes``."""
+    ntype = graph.dsttypes[0]
+    dstdata = graph._node_frames[graph.get_ntype_id_from_dst(ntype)]
+    unique_degs, bucketor = _bucketing(graph.in_degrees())
     for deg, node_bkt, orig_nid_bkt in zip(unique_degs, bucketor(nodes), bucketor(orig_nid)):
         if deg == 0:
             # skip reduce function for zero-degree nodes
@@ -142,21 +199,6 @@ def invoke_udf_reduce(graph, func, msgdata, *, orig_nid=None):
         nbatch = NodeBatch(graph, orig_nid_bkt, ntype, ndata_bkt, msgs=maildata)
         bkt_rsts.append(func(nbatch))
 
-    # prepare a result frame
-    retf = Frame(num_rows=len(nodes))
-    retf._initializers = dstdata._initializers
-    retf._default_initializer = dstdata._default_initializer
-
-    # merge bucket results and write to the result frame
-    if len(bkt_rsts) != 0:  # if all the nodes have zero degree, no need to merge results.
-        merged_rst = {}
-        for k in bkt_rsts[0].keys():
-            merged_rst[k] = F.cat([rst[k] for rst in bkt_rsts], dim=0)
-        merged_nodes = F.cat(bkt_nodes, dim=0)
-        retf.update_row(merged_nodes, merged_rst)
-
-    return retf
-
 def _bucketing(val):
     """Internal function to create groups on the values.
 
@@ -378,3 +420,5 @@ def message_passing(g, mfunc, rfunc, afunc):
         orig_nid = g.dstdata.get(NID, None)
         ndata = invoke_node_udf(g, ALL, g.dsttypes[0], afunc, ndata=ndata, orig_nid=orig_nid)
     return ndata
+
+_init_api("dgl.core")
@@ -1,2 +1,5 @@
 """ CUDA wrappers """
 from . import nccl
+from .cuda_graph import CUDAGraph
+from .id_hash_table import IdHashTable
+from .._ffi.streams import stream, current_stream
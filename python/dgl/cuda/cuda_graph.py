@@ -0,0 +1,70 @@
+"""API capturing the DGL CUDA kernels in CUDA graphs."""
+from contextlib import contextmanager
+
+from .._ffi.function import _init_api
+
+class CUDAGraph(object):
+    """ CUDA graph recording the kernels DGL launches on its current stream,
+        to replay them without the host-side dispatch.
+
+    A replay launches the kernels on the same arrays as during the capture, so
+    it is only valid for a fixed sequence of graphs (e.g. the blocks of a
+    sampled minibatch, whose structure is kept), and for input and output
+    features kept alive and updated in place.
+
+    Run the computation once before capturing it: the first run builds the
+    state cached on the graphs (kernel plans, degree statistics, sorted
+    formats), which synchronizes with the host and cannot be captured.
+
+    The capture runs on the current DGL stream, which must not be the default
+    stream for the kernels of the framework to be captured as well. For
+    PyTorch, enter both ``torch.cuda.stream(s)`` and
+    ``dgl._ffi.streams.stream(s)`` with the same side stream ``s``.
+
+    Parameters
+    ----------
+    device_id : int
+        The id of the GPU the kernels run on.
+    workspace_size : int
+        The size in bytes of the buffer the temporary workspaces of the
+        captured kernels are carved out of. The workspaces not fitting in it
+        are allocated separately. Both are kept as long as the graph.
+
+    Examples
+    --------
+    >>> g = dgl.cuda.CUDAGraph()
+    >>> y = model(blocks, x)          # warm up
+    >>> with g.capture():
+    ...     y = model(blocks, x)
+    >>> x.copy_(new_x)
+    >>> g.replay()                    # y now holds model(blocks, new_x)
+    """
+    def __init__(self, device_id=0, workspace_size=64 << 20):
+        self._handle = _CAPI_DGLCUDAGraphCreate(device_id, workspace_size)
+
+    def begin_capture(self):
+        """ Start capturing the kernels launched on the current stream.
+        """
+        _CAPI_DGLCUDAGraphBeginCapture(self._handle)
+
+    def end_capture(self):
+        """ Stop capturing and instantiate the CUDA graph.
+        """
+        _CAPI_DGLCUDAGraphEndCapture(self._handle)
+
+    @contextmanager
+    def capture(self):
+        """ Context manager capturing the kernels launched in its scope.
+        """
+        self.begin_capture()
+        try:
+            yield self
+        finally:
+            self.end_capture()
+
+    def replay(self):
+        """ Launch the captured kernels on the current stream.
+        """
+        _CAPI_DGLCUDAGraphReplay(self._handle)
+
+_init_api("dgl.cuda.cuda_graph")
@@ -0,0 +1,76 @@
+"""API of a GPU hashtable from ids to values living across minibatches."""
+from .._ffi.function import _init_api
+from .. import backend as F
+
+class IdHashTable(object):
+    """ GPU hashtable from non-negative ids to integer values, kept across calls
+        and updated by batches, e.g. to map the global node IDs of a GPU
+        feature cache to the slots of its buffer.
+
+    Every batch of insertions, lookups or removals runs as one kernel on the
+    current stream. The table grows as needed: an insertion only synchronizes
+    with the host when the table may be more than half full.
+
+    Parameters
+    ----------
+    device_id : int
+        The id of the GPU storing the table.
+    capacity : int
+        The number of keys the table can hold before growing.
+
+    Examples
+    --------
+    >>> table = dgl.cuda.IdHashTable(capacity=1000)
+    >>> table.insert(torch.tensor([5, 10, 7], device='cuda'),
+    ...              torch.tensor([0, 1, 2], device='cuda'))
+    >>> table.lookup(torch.tensor([7, 8, 5], device='cuda'))
+    tensor([ 2, -1,  0], device='cuda:0')
+    >>> table.remove(torch.tensor([5], device='cuda'))
+    >>> len(table)
+    2
+    """
+    def __init__(self, device_id=0, capacity=1024):
+        self._handle = _CAPI_DGLCUDAIdHashTableCreate(device_id, capacity)
+
+    def insert(self, keys, values):
+        """ Insert the keys with their values, replacing the values of the keys
+            already in the table.
+
+        Parameters
+        ----------
+        keys : Tensor
+            The int32 or int64 keys, on the GPU of the table.
+        values : Tensor
+            The int32 or int64 values, one for each key.
+        """
+        _CAPI_DGLCUDAIdHashTableInsert(self._handle, F.to_dgl_nd(keys), F.to_dgl_nd(values))
+
+    def lookup(self, keys):
+        """ Look up the keys.
+
+        Parameters
+        ----------
+        keys : Tensor
+            The int32 or int64 keys, on the GPU of the table.
+
+        Returns
+        -------
+        Tensor
+            The int64 values of the keys, -1 for the keys not in the table.
+        """
+        return F.from_dgl_nd(_CAPI_DGLCUDAIdHashTableLookup(self._handle, F.to_dgl_nd(keys)))
+
+    def remove(self, keys):
+        """ Remove the keys, ignoring the ones not in the table.
+
+        Parameters
+        ----------
+        keys : Tensor
+            The int32 or int64 keys, on the GPU of the table.
+        """
+        _CAPI_DGLCUDAIdHashTableRemove(self._handle, F.to_dgl_nd(keys))
+
+    def __len__(self):
+        return _CAPI_DGLCUDAIdHashTableSize(self._handle)
+
+_init_api("dgl.cuda.id_hash_table")
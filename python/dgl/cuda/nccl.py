@@ -39,7 +39,7 @@ class UniqueId(object):
 class Communicator(object):
     """ High-level wrapper for NCCL communication.
     """
-    def __init__(self, size, rank, unique_id):
+    def __init__(self, size, rank, unique_id, local_size=1):
         """ Create a new NCCL communicator.
 
             Parameters
@@ -50,6 +50,15 @@ class Communicator(object):
                 The rank of the current process in the communicator.
             unique_id : NCCLUniqueId
                 The unique id of the root process (rank=0).
+            local_size : int, optional
+                The number of processes on each machine. If greater than one,
+                and less than `size`, the sparse all-to-all operations are
+                hierarchical: the data for the processes of another machine
+                is first gathered, within the machine, by the process of the
+                same local rank, which then sends it in one message to its
+                counterpart on that machine. The processes of a machine must
+                have consecutive ranks, i.e., the rank
+                `machine * local_size + local_rank`. Default: 1.
 
             Examples
             --------
@@ -69,12 +78,22 @@ class Communicator(object):
             Then, all processes should create the communicator.
 
             >>> comm = Communicator(world_size, rank, uid)
+
+            Across machines of 8 GPUs each, with one process per GPU, the
+            communicator can be made hierarchical via:
+
+            >>> comm = Communicator(world_size, rank, uid, local_size=8)
         """
         assert rank < size, "The rank of a process must be less than the " \
             "size of the communicator."
+        assert local_size <= 1 or size % local_size == 0, "The size of the " \
+            "communicator must be a multiple of the local size."
         self._handle = _CAPI_DGLNCCLCreateComm(size, rank, unique_id.get())
+        if local_size > 1:
+            _CAPI_DGLNCCLSetLocalSize(self._handle, local_size)
         self._rank = rank
         self._size = size
+        self._local_size = max(local_size, 1)
 
     def sparse_all_to_all_push(self, idx, value, partition):
         """ Perform an all-to-all-v operation, where by all processors send out
@@ -135,7 +154,8 @@ class Communicator(object):
         return (F.zerocopy_from_dgl_ndarray(out_idx),
                 F.zerocopy_from_dgl_ndarray(out_value))
 
-    def sparse_all_to_all_pull(self, req_idx, value, partition):
+    def sparse_all_to_all_pull(self, req_idx, value, partition,
+                               max_num_requests=None, compress=False):
         """ Perform an all-to-all-v operation, where by all processors request
             the values corresponding to their set of indices.
 
@@ -149,6 +169,17 @@ class Communicator(object):
             partition : NDArrayPartition
                 The object containing information for assigning indices to
                 processors.
+            max_num_requests : int, optional
+                The maximum number of indices any processor requests, the same
+                on all processors. If given, the requests and the values are
+                exchanged in blocks of this size per pair of processors, padded
+                where fewer, so the operation never waits for the device and
+                can overlap with other work on the host. Otherwise, the
+                number of indices requested is first copied to the host to
+                exchange exactly as much as needed.
+            compress : bool, optional
+                If True, the floating point values are sent as float16 and
+                converted back. Requires `max_num_requests`. Default: False.
 
             Returns
             -------
@@ -173,16 +204,32 @@ class Communicator(object):
 
             >>> nbr_values = comm.sparse_all_to_all_pull(nbr_idxs, node_feat, part)
 
+            If no process requests more than `batch_size` neighbors, the
+            features can be requested without synchronizing the host, and sent
+            at half the size, via:
+
+            >>> nbr_values = comm.sparse_all_to_all_pull(
+            ...     nbr_idxs, node_feat, part, max_num_requests=batch_size,
+            ...     compress=True)
+
             Then two the arrays 'nbr_idxs' and 'nbr_values' forms the sparse
             set of features, where 'nbr_idxs[i]' is the global node id, and
             'nbr_values[i]' is the feature vector for that node. This
             communication pattern is useful for node features or node
             embeddings.
         """
-        out_value = _CAPI_DGLNCCLSparseAllToAllPull(
-            self.get(), F.zerocopy_to_dgl_ndarray(req_idx),
-            F.zerocopy_to_dgl_ndarray(value),
-            partition.get())
+        if max_num_requests is not None:
+            out_value = _CAPI_DGLNCCLSparseAllToAllPullFixed(
+                self.get(), F.zerocopy_to_dgl_ndarray(req_idx),
+                F.zerocopy_to_dgl_ndarray(value),
+                partition.get(), max_num_requests, compress)
+        else:
+            assert not compress, "Compressing the values requires " \
+                "max_num_requests."
+            out_value = _CAPI_DGLNCCLSparseAllToAllPull(
+                self.get(), F.zerocopy_to_dgl_ndarray(req_idx),
+                F.zerocopy_to_dgl_ndarray(value),
+                partition.get())
         return F.zerocopy_from_dgl_ndarray(out_value)
 
     def get(self):
@@ -210,4 +257,14 @@ class Communicator(object):
         """
         return self._size
 
+    def local_size(self):
+        """ Get the number of processes on each machine.
+
+            Returns
+            -------
+            int
+                The number of processes on each machine.
+        """
+        return self._local_size
+
 _init_api("dgl.cuda.nccl")
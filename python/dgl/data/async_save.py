@@ -0,0 +1,43 @@
+"""Handles of the saves written in the background."""
+from __future__ import absolute_import
+import atexit
+
+from .._ffi.object import ObjectBase, register_object
+from .._ffi.function import _init_api
+
+__all__ = ['AsyncSave']
+
+_init_api("dgl.data.async_save")
+
+
+@register_object("serialize.AsyncSave")
+class AsyncSave(ObjectBase):
+    """Handle of a save written in the background, returned by
+    :func:`~dgl.data.utils.save_tensors_async` and
+    :func:`~dgl.data.utils.save_graphs_async`.
+
+    The tensors have been copied when the handle is returned, so changing them
+    afterwards does not change the saved file.
+    """
+
+    def done(self):
+        """Return whether the write has finished, successfully or not."""
+        return bool(_CAPI_AsyncSaveDone(self))
+
+    def wait(self):
+        """Wait for the write to finish.
+
+        Raises
+        ------
+        DGLError
+            If the write failed.
+        """
+        _CAPI_AsyncSaveWait(self)
+
+
+def wait_all():
+    """Wait for all the saves written in the background to finish."""
+    _CAPI_WaitAllAsyncSaves()
+
+# the background threads do not keep the interpreter alive
+atexit.register(wait_all)
@@ -1,259 +1,674 @@
-"""For Graph Serialization"""
-from __future__ import absolute_import
-import os
-from ..base import dgl_warning, DGLError
-from ..heterograph import DGLHeteroGraph
-from .._ffi.object import ObjectBase, register_object
-from .._ffi.function import _init_api
-from .. import backend as F
-from .heterograph_serialize import save_heterographs
-
-_init_api("dgl.data.graph_serialize")
-
-__all__ = ['save_graphs', "load_graphs", "load_labels"]
-
-
-@register_object("graph_serialize.StorageMetaData")
-class StorageMetaData(ObjectBase):
-    """StorageMetaData Object
-    attributes available:
-      num_graph [int]: return numbers of graphs
-      nodes_num_list Value of NDArray: return number of nodes for each graph
-      edges_num_list Value of NDArray: return number of edges for each graph
-      labels [dict of backend tensors]: return dict of labels
-      graph_data [list of GraphData]: return list of GraphData Object
-    """
-
-
-def is_local_path(filepath):
-    return not (filepath.startswith("hdfs://") or
-                filepath.startswith("viewfs://") or
-                filepath.startswith("s3://"))
-
-
-def check_local_file_exists(filename):
-    if is_local_path(filename) and not os.path.exists(filename):
-        raise DGLError("File {} does not exist.".format(filename))
-
-@register_object("graph_serialize.GraphData")
-class GraphData(ObjectBase):
-    """GraphData Object"""
-
-    @staticmethod
-    def create(g):
-        """Create GraphData"""
-        # TODO(zihao): support serialize batched graph in the future.
-        assert g.batch_size == 1, "Batched DGLGraph is not supported for serialization"
-        ghandle = g._graph
-        if len(g.ndata) != 0:
-            node_tensors = dict()
-            for key, value in g.ndata.items():
-                node_tensors[key] = F.zerocopy_to_dgl_ndarray(value)
-        else:
-            node_tensors = None
-
-        if len(g.edata) != 0:
-            edge_tensors = dict()
-            for key, value in g.edata.items():
-                edge_tensors[key] = F.zerocopy_to_dgl_ndarray(value)
-        else:
-            edge_tensors = None
-
-        return _CAPI_MakeGraphData(ghandle, node_tensors, edge_tensors)
-
-    def get_graph(self):
-        """Get DGLHeteroGraph from GraphData"""
-        ghandle = _CAPI_GDataGraphHandle(self)
-        hgi =_CAPI_DGLAsHeteroGraph(ghandle)
-        g = DGLHeteroGraph(hgi, ['_U'], ['_E'])
-        node_tensors_items = _CAPI_GDataNodeTensors(self).items()
-        edge_tensors_items = _CAPI_GDataEdgeTensors(self).items()
-        for k, v in node_tensors_items:
-            g.ndata[k] = F.zerocopy_from_dgl_ndarray(v)
-        for k, v in edge_tensors_items:
-            g.edata[k] = F.zerocopy_from_dgl_ndarray(v)
-        return g
-
-
-def save_graphs(filename, g_list, labels=None):
-    r"""Save graphs and optionally their labels to file.
-
-    Besides saving to local files, DGL supports writing the graphs directly
-    to S3 (by providing a ``"s3://..."`` path) or to HDFS (by providing
-    ``"hdfs://..."`` a path).
-
-    The function saves both the graph structure and node/edge features to file
-    in DGL's own binary format. For graph-level features, pass them via
-    the :attr:`labels` argument.
-
-    Parameters
-    ----------
-    filename : str
-        The file name to store the graphs and labels.
-    g_list: list
-        The graphs to be saved.
-    labels: dict[str, Tensor]
-        labels should be dict of tensors, with str as keys
-
-    Examples
-    ----------
-    >>> import dgl
-    >>> import torch as th
-
-    Create :class:`DGLGraph` objects and initialize node
-    and edge features.
-
-    >>> g1 = dgl.graph(([0, 1, 2], [1, 2, 3]))
-    >>> g2 = dgl.graph(([0, 2], [2, 3]))
-    >>> g2.edata["e"] = th.ones(2, 4)
-
-    Save Graphs into file
-
-    >>> from dgl.data.utils import save_graphs
-    >>> graph_labels = {"glabel": th.tensor([0, 1])}
-    >>> save_graphs("./data.bin", [g1, g2], graph_labels)
-
-    See Also
-    --------
-    load_graphs
-    """
-    # if it is local file, do some sanity check
-    if is_local_path(filename):
-        if os.path.isdir(filename):
-            raise DGLError("Filename {} is an existing directory.".format(filename))
-        f_path = os.path.dirname(filename)
-        if f_path and not os.path.exists(f_path):
-            os.makedirs(f_path)
-
-    g_sample = g_list[0] if isinstance(g_list, list) else g_list
-    if type(g_sample) == DGLHeteroGraph:  # Doesn't support DGLHeteroGraph's derived class
-        save_heterographs(filename, g_list, labels)
-    else:
-        raise DGLError(
-            "Invalid argument g_list. Must be a DGLGraph or a list of DGLGraphs.")
-
-
-
-def load_graphs(filename, idx_list=None):
-    """Load graphs and optionally their labels from file saved by :func:`save_graphs`.
-
-    Besides loading from local files, DGL supports loading the graphs directly
-    from S3 (by providing a ``"s3://..."`` path) or from HDFS (by providing
-    ``"hdfs://..."`` a path).
-
-    Parameters
-    ----------
-    filename: str
-        The file name to load graphs from.
-    idx_list: list[int], optional
-        The indices of the graphs to be loaded if the file contains multiple graphs.
-        Default is loading all the graphs stored in the file.
-
-    Returns
-    --------
-    graph_list: list[DGLGraph]
-        The loaded graphs.
-    labels: dict[str, Tensor]
-        The graph labels stored in file. If no label is stored, the dictionary is empty.
-        Regardless of whether the ``idx_list`` argument is given or not,
-        the returned dictionary always contains the labels of all the graphs.
-
-    Examples
-    ----------
-    Following the example in :func:`save_graphs`.
-
-    >>> from dgl.data.utils import load_graphs
-    >>> glist, label_dict = load_graphs("./data.bin") # glist will be [g1, g2]
-    >>> glist, label_dict = load_graphs("./data.bin", [0]) # glist will be [g1]
-
-    See Also
-    --------
-    save_graphs
-    """
-    # if it is local file, do some sanity check
-    check_local_file_exists(filename)
-    version = _CAPI_GetFileVersion(filename)
-    if version == 1:
-        dgl_warning(
-            "You are loading a graph file saved by old version of dgl.  \
-            Please consider saving it again with the current format.")
-        return load_graph_v1(filename, idx_list)
-    elif version == 2:
-        return load_graph_v2(filename, idx_list)
-    else:
-        raise DGLError("Invalid DGL Version Number.")
-
-
-def load_graph_v2(filename, idx_list=None):
-    """Internal functions for loading DGLHeteroGraphs."""
-    if idx_list is None:
-        idx_list = []
-    assert isinstance(idx_list, list)
-    heterograph_list = _CAPI_LoadGraphFiles_V2(filename, idx_list)
-    label_dict = load_labels_v2(filename)
-    return [gdata.get_graph() for gdata in heterograph_list], label_dict
-
-
-def load_graph_v1(filename, idx_list=None):
-    """"Internal functions for loading DGLGraphs (V0)."""
-    if idx_list is None:
-        idx_list = []
-    assert isinstance(idx_list, list)
-    metadata = _CAPI_LoadGraphFiles_V1(filename, idx_list, False)
-    label_dict = {}
-    for k, v in metadata.labels.items():
-        label_dict[k] = F.zerocopy_from_dgl_ndarray(v)
-
-    return [gdata.get_graph() for gdata in metadata.graph_data], label_dict
-
-def load_labels(filename):
-    """
-    Load label dict from file
-
-    Parameters
-    ----------
-    filename: str
-        filename to load DGLGraphs
-
-    Returns
-    ----------
-    labels: dict
-        dict of labels stored in file (empty dict returned if no
-        label stored)
-
-    Examples
-    ----------
-    Following the example in save_graphs.
-
-    >>> from dgl.data.utils import load_labels
-    >>> label_dict = load_graphs("./data.bin")
-
-    """
-    # if it is local file, do some sanity check
-    check_local_file_exists(filename)
-
-    version = _CAPI_GetFileVersion(filename)
-    if version == 1:
-        return load_labels_v1(filename)
-    elif version == 2:
-        return load_labels_v2(filename)
-    else:
-        raise Exception("Invalid DGL Version Number")
-
-
-def load_labels_v2(filename):
-    """Internal functions for loading labels from V2 format"""
-    label_dict = {}
-    nd_dict = _CAPI_LoadLabels_V2(filename)
-    for k, v in nd_dict.items():
-        label_dict[k] = F.zerocopy_from_dgl_ndarray(v)
-    return label_dict
-
-
-def load_labels_v1(filename):
-    """Internal functions for loading labels from V1 format"""
-    metadata = _CAPI_LoadGraphFiles_V1(filename, [], True)
-    label_dict = {}
-    for k, v in metadata.labels.items():
-        label_dict[k] = F.zerocopy_from_dgl_ndarray(v)
-    return label_dict
+"""For Graph Serialization"""
+from __future__ import absolute_import
+import os
+import numpy as np
+from ..base import dgl_warning, DGLError
+from ..heterograph import DGLHeteroGraph
+from .. import heterograph_index
+from .. import ndarray as nd
+from .._ffi.object import ObjectBase, register_object
+from .._ffi.function import _init_api
+from .. import backend as F
+from .heterograph_serialize import save_heterographs, tensor_dict_to_ndarray_dict
+
+_init_api("dgl.data.graph_serialize")
+
+__all__ = ['save_graphs', "save_graphs_async", "load_graphs", "load_labels",
+           "load_graph_feature", "save_graph_delta", "load_graph_snapshot",
+           "load_csr_graph_mmap"]
+
+
+@register_object("graph_serialize.StorageMetaData")
+class StorageMetaData(ObjectBase):
+    """StorageMetaData Object
+    attributes available:
+      num_graph [int]: return numbers of graphs
+      nodes_num_list Value of NDArray: return number of nodes for each graph
+      edges_num_list Value of NDArray: return number of edges for each graph
+      labels [dict of backend tensors]: return dict of labels
+      graph_data [list of GraphData]: return list of GraphData Object
+    """
+
+
+def is_local_path(filepath):
+    return not (filepath.startswith("hdfs://") or
+                filepath.startswith("viewfs://") or
+                filepath.startswith("s3://"))
+
+
+def check_local_file_exists(filename):
+    if is_local_path(filename) and not os.path.exists(filename):
+        raise DGLError("File {} does not exist.".format(filename))
+
+@register_object("graph_serialize.GraphData")
+class GraphData(ObjectBase):
+    """GraphData Object"""
+
+    @staticmethod
+    def create(g):
+        """Create GraphData"""
+        # TODO(zihao): support serialize batched graph in the future.
+        assert g.batch_size == 1, "Batched DGLGraph is not supported for serialization"
+        ghandle = g._graph
+        if len(g.ndata) != 0:
+            node_tensors = dict()
+            for key, value in g.ndata.items():
+                node_tensors[key] = F.zerocopy_to_dgl_ndarray(value)
+        else:
+            node_tensors = None
+
+        if len(g.edata) != 0:
+            edge_tensors = dict()
+            for key, value in g.edata.items():
+                edge_tensors[key] = F.zerocopy_to_dgl_ndarray(value)
+        else:
+            edge_tensors = None
+
+        return _CAPI_MakeGraphData(ghandle, node_tensors, edge_tensors)
+
+    def get_graph(self):
+        """Get DGLHeteroGraph from GraphData"""
+        ghandle = _CAPI_GDataGraphHandle(self)
+        hgi =_CAPI_DGLAsHeteroGraph(ghandle)
+        g = DGLHeteroGraph(hgi, ['_U'], ['_E'])
+        node_tensors_items = _CAPI_GDataNodeTensors(self).items()
+        edge_tensors_items = _CAPI_GDataEdgeTensors(self).items()
+        for k, v in node_tensors_items:
+            g.ndata[k] = F.zerocopy_from_dgl_ndarray(v)
+        for k, v in edge_tensors_items:
+            g.edata[k] = F.zerocopy_from_dgl_ndarray(v)
+        return g
+
+
+def save_graphs(filename, g_list, labels=None, mmap_layout=False, columnar=False):
+    r"""Save graphs and optionally their labels to file.
+
+    Besides saving to local files, DGL supports writing the graphs directly
+    to S3 (by providing a ``"s3://..."`` path) or to HDFS (by providing
+    ``"hdfs://..."`` a path).
+
+    The function saves both the graph structure and node/edge features to file
+    in DGL's own binary format. For graph-level features, pass them via
+    the :attr:`labels` argument.
+
+    Parameters
+    ----------
+    filename : str
+        The file name to store the graphs and labels.
+    g_list: list
+        The graphs to be saved.
+    labels: dict[str, Tensor]
+        labels should be dict of tensors, with str as keys
+    mmap_layout: bool, optional
+        If True, store the arrays of the graphs aligned to pages, so that
+        :func:`load_graphs` maps the file into memory instead of reading it.
+        The loaded graph structures and features then point into the mapping,
+        which makes loading large graphs near-instant and shares their memory
+        between the processes loading the same file. Writing to the loaded
+        tensors only changes the copy of the process. Only local files are
+        supported, on Linux and MacOS. Default: False.
+    columnar: bool, optional
+        If True, store every node or edge feature and every label as a single
+        column holding the rows of all the graphs, apart from the graph
+        structures. :func:`load_labels` and :func:`load_graph_feature` then
+        read only the columns they return, each with one sequential read.
+        A feature must have the same data type and row shape in all the
+        graphs. Cannot be combined with :attr:`mmap_layout`. Default: False.
+
+    Examples
+    ----------
+    >>> import dgl
+    >>> import torch as th
+
+    Create :class:`DGLGraph` objects and initialize node
+    and edge features.
+
+    >>> g1 = dgl.graph(([0, 1, 2], [1, 2, 3]))
+    >>> g2 = dgl.graph(([0, 2], [2, 3]))
+    >>> g2.edata["e"] = th.ones(2, 4)
+
+    Save Graphs into file
+
+    >>> from dgl.data.utils import save_graphs
+    >>> graph_labels = {"glabel": th.tensor([0, 1])}
+    >>> save_graphs("./data.bin", [g1, g2], graph_labels)
+
+    See Also
+    --------
+    load_graphs
+    """
+    if mmap_layout and columnar:
+        raise DGLError("The mmap layout and the columnar layout cannot be combined.")
+    _check_save_path(filename, mmap_layout)
+    _check_graph_list(g_list)
+    save_heterographs(filename, g_list, labels, mmap_layout, columnar=columnar)
+
+
+def save_graphs_async(filename, g_list, labels=None, mmap_layout=False):
+    r"""Save graphs and optionally their labels to file in the background.
+
+    The node and edge features and the labels are copied into staging buffers
+    before returning, and the graph structures, which never change, are
+    shared. The graphs and their features may thus be changed right away,
+    e.g. by the next training step, while a background thread writes the file
+    as :func:`save_graphs` does.
+
+    The number of background threads is given by the environment variable
+    ``DGL_ASYNC_SAVE_THREADS``, 1 by default, so that the files are written in
+    the order they are saved. The pending saves are waited for at exit.
+
+    Parameters
+    ----------
+    filename : str
+        The file name to store the graphs and labels.
+    g_list: list
+        The graphs to be saved.
+    labels: dict[str, Tensor]
+        labels should be dict of tensors, with str as keys
+    mmap_layout: bool, optional
+        Whether to store the graphs in the memory mapped layout, see
+        :func:`save_graphs`. Default: False.
+
+    Returns
+    -------
+    AsyncSave
+        The handle of the save, whose ``wait()`` blocks until the file is
+        written and raises the error of the write if any.
+
+    Examples
+    ----------
+    >>> handle = dgl.data.utils.save_graphs_async("./ckpt.bin", [g])
+    >>> g.ndata['h'] += 1   # does not change the saved graph
+    >>> handle.wait()
+
+    See Also
+    --------
+    save_graphs
+    """
+    _check_save_path(filename, mmap_layout)
+    _check_graph_list(g_list)
+    return save_heterographs(filename, g_list, labels, mmap_layout, async_save=True)
+
+
+def _check_save_path(filename, mmap_layout):
+    """Check the file name to save graphs to, and create its directory if needed."""
+    if mmap_layout and not is_local_path(filename):
+        raise DGLError("The mmap layout only supports local files, got {}.".format(filename))
+    # if it is local file, do some sanity check
+    if is_local_path(filename):
+        if os.path.isdir(filename):
+            raise DGLError("Filename {} is an existing directory.".format(filename))
+        f_path = os.path.dirname(filename)
+        if f_path and not os.path.exists(f_path):
+            os.makedirs(f_path)
+
+
+def _check_graph_list(g_list):
+    """Check the graphs to save."""
+    g_sample = g_list[0] if isinstance(g_list, list) else g_list
+    if type(g_sample) != DGLHeteroGraph:  # Doesn't support DGLHeteroGraph's derived class
+        raise DGLError(
+            "Invalid argument g_list. Must be a DGLGraph or a list of DGLGraphs.")
+
+
+
+def load_graphs(filename, idx_list=None):
+    """Load graphs and optionally their labels from file saved by :func:`save_graphs`.
+
+    Besides loading from local files, DGL supports loading the graphs directly
+    from S3 (by providing a ``"s3://..."`` path) or from HDFS (by providing
+    ``"hdfs://..."`` a path).
+
+    Parameters
+    ----------
+    filename: str
+        The file name to load graphs from.
+    idx_list: list[int], optional
+        The indices of the graphs to be loaded if the file contains multiple graphs.
+        Default is loading all the graphs stored in the file.
+
+    Returns
+    --------
+    graph_list: list[DGLGraph]
+        The loaded graphs.
+    labels: dict[str, Tensor]
+        The graph labels stored in file. If no label is stored, the dictionary is empty.
+        Regardless of whether the ``idx_list`` argument is given or not,
+        the returned dictionary always contains the labels of all the graphs.
+
+    Examples
+    ----------
+    Following the example in :func:`save_graphs`.
+
+    >>> from dgl.data.utils import load_graphs
+    >>> glist, label_dict = load_graphs("./data.bin") # glist will be [g1, g2]
+    >>> glist, label_dict = load_graphs("./data.bin", [0]) # glist will be [g1]
+
+    See Also
+    --------
+    save_graphs
+    """
+    # if it is local file, do some sanity check
+    check_local_file_exists(filename)
+    version = _CAPI_GetFileVersion(filename)
+    if version == 1:
+        dgl_warning(
+            "You are loading a graph file saved by old version of dgl.  \
+            Please consider saving it again with the current format.")
+        return load_graph_v1(filename, idx_list)
+    elif version == 2:
+        return load_graph_v2(filename, idx_list)
+    elif version == 3:
+        return load_graph_v3(filename, idx_list)
+    elif version == 4:
+        raise DGLError("{} is a graph delta, load it with load_graph_snapshot.".format(filename))
+    elif version == 5:
+        return load_graph_v5(filename, idx_list)
+    else:
+        raise DGLError("Invalid DGL Version Number.")
+
+
+def load_graph_v2(filename, idx_list=None):
+    """Internal functions for loading DGLHeteroGraphs."""
+    if idx_list is None:
+        idx_list = []
+    assert isinstance(idx_list, list)
+    heterograph_list = _CAPI_LoadGraphFiles_V2(filename, idx_list)
+    label_dict = load_labels_v2(filename)
+    return [gdata.get_graph() for gdata in heterograph_list], label_dict
+
+
+def load_graph_v3(filename, idx_list=None):
+    """Internal functions for loading DGLHeteroGraphs from memory mapped files."""
+    if idx_list is None:
+        idx_list = []
+    assert isinstance(idx_list, list)
+    heterograph_list = _CAPI_LoadGraphFiles_V3(filename, idx_list)
+    label_dict = load_labels_v3(filename)
+    return [gdata.get_graph() for gdata in heterograph_list], label_dict
+
+
+def load_graph_v5(filename, idx_list=None):
+    """Internal functions for loading DGLHeteroGraphs stored by columns."""
+    if idx_list is None:
+        idx_list = []
+    assert isinstance(idx_list, list)
+    heterograph_list = _CAPI_LoadGraphFiles_V5(filename, idx_list)
+    label_dict = load_labels_v5(filename)
+    return [gdata.get_graph() for gdata in heterograph_list], label_dict
+
+
+def load_graph_v1(filename, idx_list=None):
+    """"Internal functions for loading DGLGraphs (V0)."""
+    if idx_list is None:
+        idx_list = []
+    assert isinstance(idx_list, list)
+    metadata = _CAPI_LoadGraphFiles_V1(filename, idx_list, False)
+    label_dict = {}
+    for k, v in metadata.labels.items():
+        label_dict[k] = F.zerocopy_from_dgl_ndarray(v)
+
+    return [gdata.get_graph() for gdata in metadata.graph_data], label_dict
+
+def load_labels(filename):
+    """
+    Load label dict from file
+
+    Parameters
+    ----------
+    filename: str
+        filename to load DGLGraphs
+
+    Returns
+    ----------
+    labels: dict
+        dict of labels stored in file (empty dict returned if no
+        label stored)
+
+    Examples
+    ----------
+    Following the example in save_graphs.
+
+    >>> from dgl.data.utils import load_labels
+    >>> label_dict = load_graphs("./data.bin")
+
+    """
+    # if it is local file, do some sanity check
+    check_local_file_exists(filename)
+
+    version = _CAPI_GetFileVersion(filename)
+    if version == 1:
+        return load_labels_v1(filename)
+    elif version == 2:
+        return load_labels_v2(filename)
+    elif version == 3:
+        return load_labels_v3(filename)
+    elif version == 5:
+        return load_labels_v5(filename)
+    else:
+        raise Exception("Invalid DGL Version Number")
+
+
+def load_graph_feature(filename, name, ntype=None, etype=None):
+    """Load one node or edge feature of all the graphs of a file saved by
+    :func:`save_graphs` with ``columnar=True``.
+
+    The feature is read with a single sequential read, without loading the
+    graphs.
+
+    Parameters
+    ----------
+    filename : str
+        The file name to load the feature from.
+    name : str
+        The name of the feature.
+    ntype : str, optional
+        The node type of a node feature. Can be omitted if only one node type
+        has a feature of that name.
+    etype : str or (str, str, str), optional
+        The edge type of an edge feature. If given, an edge feature is
+        loaded, otherwise a node feature.
+
+    Returns
+    -------
+    list[Tensor or None]
+        The feature of every graph, or None for the graphs without it. The
+        tensors are slices of a single tensor.
+
+    Examples
+    --------
+    >>> dgl.save_graphs("./data.bin", [g1, g2], columnar=True)
+    >>> feats = dgl.data.utils.load_graph_feature("./data.bin", "h")
+    """
+    check_local_file_exists(filename)
+    if _CAPI_GetFileVersion(filename) != 5:
+        raise DGLError("{} is not saved with columnar=True.".format(filename))
+    if etype is not None:
+        is_edge = True
+        etype = [etype] if isinstance(etype, str) else list(etype)
+    else:
+        is_edge = False
+        etype = [] if ntype is None else [ntype]
+    rows, offsets, present = _CAPI_LoadFeatureColumn_V5(filename, is_edge, etype, name)
+    rows = F.zerocopy_from_dgl_ndarray(rows)
+    offsets = F.asnumpy(F.zerocopy_from_dgl_ndarray(offsets)).tolist()
+    present = F.asnumpy(F.zerocopy_from_dgl_ndarray(present)).tolist()
+    return [F.narrow_row(rows, offsets[i], offsets[i + 1]) if present[i] else None
+            for i in range(len(present))]
+
+
+def load_labels_v2(filename):
+    """Internal functions for loading labels from V2 format"""
+    label_dict = {}
+    nd_dict = _CAPI_LoadLabels_V2(filename)
+    for k, v in nd_dict.items():
+        label_dict[k] = F.zerocopy_from_dgl_ndarray(v)
+    return label_dict
+
+
+def load_labels_v3(filename):
+    """Internal functions for loading labels from V3 format"""
+    label_dict = {}
+    nd_dict = _CAPI_LoadLabels_V3(filename)
+    for k, v in nd_dict.items():
+        label_dict[k] = F.zerocopy_from_dgl_ndarray(v)
+    return label_dict
+
+
+def load_labels_v5(filename):
+    """Internal functions for loading labels from V5 format"""
+    label_dict = {}
+    nd_dict = _CAPI_LoadLabels_V5(filename)
+    for k, v in nd_dict.items():
+        label_dict[k] = F.zerocopy_from_dgl_ndarray(v)
+    return label_dict
+
+
+def _to_type_dict(value, types, name):
+    if isinstance(value, dict):
+        return value
+    if len(types) != 1:
+        raise DGLError("{} must be a dict for graphs with multiple types.".format(name))
+    return {types[0]: value}
+
+
+def save_graph_delta(filename, g, base_num_nodes, base_num_edges,
+                     dirty_nodes=None, dirty_edges=None):
+    r"""Save the changes of a growing graph since a snapshot.
+
+    The graph must only have grown since the snapshot: the nodes and edges of
+    the snapshot keep their IDs, and the new ones come after them. The delta
+    stores the new nodes and edges with their features, and the features of
+    the existing nodes and edges given by :attr:`dirty_nodes` and
+    :attr:`dirty_edges`, whose rows replace the ones of the snapshot.
+
+    A snapshot saved by :func:`save_graphs` followed by the deltas saved since
+    is loaded by :func:`load_graph_snapshot`. Every delta records the numbers
+    of nodes and edges it starts from, which must be the ones of the snapshot
+    with the previous deltas applied.
+
+    Parameters
+    ----------
+    filename : str
+        The file name to store the delta.
+    g : DGLGraph
+        The graph.
+    base_num_nodes : int or dict[str, int]
+        The number of nodes of every node type in the snapshot.
+    base_num_edges : int or dict[etype, int]
+        The number of edges of every edge type in the snapshot.
+    dirty_nodes : Tensor or dict[str, Tensor], optional
+        The IDs of the changed nodes of the snapshot of every node type, whose
+        feature rows are saved. Default: no node changed.
+    dirty_edges : Tensor or dict[etype, Tensor], optional
+        The IDs of the changed edges of the snapshot of every edge type, whose
+        feature rows are saved. Default: no edge changed.
+
+    Examples
+    --------
+    >>> g = dgl.graph(([0, 1], [1, 2]))
+    >>> g.ndata['h'] = torch.zeros(3, 4)
+    >>> dgl.save_graphs('./base.bin', [g])
+    >>> g.add_edges([2, 3], [3, 0])
+    >>> g.ndata['h'][0] = 1
+    >>> dgl.data.utils.save_graph_delta('./delta1.bin', g, 3, 2, dirty_nodes=torch.tensor([0]))
+    >>> g2 = dgl.data.utils.load_graph_snapshot('./base.bin', ['./delta1.bin'])
+
+    See Also
+    --------
+    load_graph_snapshot
+    """
+    base_num_nodes = _to_type_dict(base_num_nodes, g.ntypes, 'base_num_nodes')
+    base_num_edges = {g.to_canonical_etype(k): v for k, v in
+                      _to_type_dict(base_num_edges, g.canonical_etypes, 'base_num_edges').items()}
+    dirty_nodes = _to_type_dict(
+        {} if dirty_nodes is None else dirty_nodes, g.ntypes, 'dirty_nodes')
+    dirty_edges = {g.to_canonical_etype(k): v for k, v in
+                   _to_type_dict({} if dirty_edges is None else dirty_edges,
+                                 g.canonical_etypes, 'dirty_edges').items()}
+
+    def _slice_rows(data, start, stop):
+        return tensor_dict_to_ndarray_dict(
+            {k: F.narrow_row(v, start, stop) for k, v in data.items()})
+
+    def _gather_rows(data, ids):
+        return tensor_dict_to_ndarray_dict({k: F.gather_row(v, ids) for k, v in data.items()})
+
+    def _to_ids(ids):
+        if ids is None:
+            ids = []
+        ids = ids if F.is_tensor(ids) else F.tensor(ids, F.int64)
+        return F.copy_to(F.astype(ids, F.int64), F.cpu())
+
+    base_nodes, new_nodes, ndata, node_ids, node_patches = [], [], [], [], []
+    for ntype in g.ntypes:
+        num_nodes = g.num_nodes(ntype)
+        base = base_num_nodes.get(ntype, num_nodes)
+        if base > num_nodes:
+            raise DGLError("The snapshot has more nodes of type {} than the graph.".format(ntype))
+        data = g.nodes[ntype].data
+        ids = _to_ids(dirty_nodes.get(ntype))
+        base_nodes.append(base)
+        new_nodes.append(num_nodes - base)
+        ndata.append(_slice_rows(data, base, num_nodes))
+        node_ids.append(F.to_dgl_nd(ids))
+        node_patches.append(_gather_rows(data, F.copy_to(ids, g.device)))
+
+    base_edges, src, dst, edata, edge_ids, edge_patches = [], [], [], [], [], []
+    for etype in g.canonical_etypes:
+        num_edges = g.num_edges(etype)
+        base = base_num_edges.get(etype, num_edges)
+        if base > num_edges:
+            raise DGLError("The snapshot has more edges of type {} than the graph.".format(etype))
+        u, v = g.edges(order='eid', etype=etype)
+        data = g.edges[etype].data
+        ids = _to_ids(dirty_edges.get(etype))
+        base_edges.append(base)
+        src.append(F.to_dgl_nd(F.narrow_row(u, base, num_edges)))
+        dst.append(F.to_dgl_nd(F.narrow_row(v, base, num_edges)))
+        edata.append(_slice_rows(data, base, num_edges))
+        edge_ids.append(F.to_dgl_nd(ids))
+        edge_patches.append(_gather_rows(data, F.copy_to(ids, g.device)))
+
+    if is_local_path(filename):
+        if os.path.isdir(filename):
+            raise DGLError("Filename {} is an existing directory.".format(filename))
+        f_path = os.path.dirname(filename)
+        if f_path and not os.path.exists(f_path):
+            os.makedirs(f_path)
+    _CAPI_SaveHeteroGraphDelta(filename, g.ntypes, g.etypes, base_nodes, base_edges, new_nodes,
+                               src, dst, ndata, edata, node_ids, edge_ids, node_patches,
+                               edge_patches)
+
+
+def load_graph_snapshot(filename, delta_filenames, idx=0):
+    """Load a graph saved by :func:`save_graphs` with the deltas saved since by
+    :func:`save_graph_delta` applied in order.
+
+    The relation graphs without new edges and the features without new rows
+    are the ones loaded from the snapshot, with the changed rows replaced in
+    place. With a snapshot saved with ``mmap_layout=True``, they thus still
+    point into the mapping of the file, and only the patched pages are copied.
+
+    Parameters
+    ----------
+    filename : str
+        The file name of the snapshot.
+    delta_filenames : list[str]
+        The file names of the deltas, in the order they have been saved.
+    idx : int, optional
+        The index of the graph in the snapshot. Default: 0.
+
+    Returns
+    -------
+    DGLGraph
+        The graph.
+
+    See Also
+    --------
+    save_graph_delta
+    """
+    check_local_file_exists(filename)
+    for delta_filename in delta_filenames:
+        check_local_file_exists(delta_filename)
+    version = _CAPI_GetFileVersion(filename)
+    if version == 2:
+        gdata = _CAPI_LoadGraphFiles_V2(filename, [idx])[0]
+    elif version == 3:
+        gdata = _CAPI_LoadGraphFiles_V3(filename, [idx])[0]
+    elif version == 5:
+        gdata = _CAPI_LoadGraphFiles_V5(filename, [idx])[0]
+    else:
+        raise DGLError("{} is not a snapshot of heterographs saved by save_graphs.".format(
+            filename))
+    return _CAPI_ApplyHeteroGraphDeltas(gdata, list(delta_filenames)).get_graph()
+
+
+def _map_npy_file(filename):
+    """Map the 1D array of a ``.npy`` file into memory as a DGL NDArray."""
+    check_local_file_exists(filename)
+    with open(filename, 'rb') as f:
+        version = np.lib.format.read_magic(f)
+        if version == (1, 0):
+            shape, fortran_order, dtype = np.lib.format.read_array_header_1_0(f)
+        else:
+            shape, fortran_order, dtype = np.lib.format.read_array_header_2_0(f)
+        offset = f.tell()
+    if len(shape) != 1:
+        raise DGLError("Expect a 1D array in {}, but got shape {}.".format(filename, shape))
+    if dtype not in (np.dtype('<i4'), np.dtype('<i8')):
+        raise DGLError("Expect little-endian int32 or int64 in {}, but got {}.".format(
+            filename, dtype))
+    del fortran_order   # same layout for 1D arrays
+    return _CAPI_MapArrayFromFile(filename, offset, dtype.name, *shape)
+
+
+def load_csr_graph_mmap(indptr_file, indices_file, eids_file=None, transpose=False,
+                        formats=None):
+    """Create a graph whose CSR adjacency matrix is mapped from the arrays of
+    existing ``.npy`` files instead of being read, e.g. saved by ``numpy.save``.
+
+    The files are mapped copy-on-write, so the graph is ready in about the time
+    of mapping them, the pages are read from the disk when first accessed and
+    shared with the other processes mapping the same files through the page
+    cache. The files are never written to. This is meant for, e.g., serving
+    processes opening a read-only graph from a local disk. Only local files
+    are supported, on Linux and MacOS.
+
+    Parameters
+    ----------
+    indptr_file : str
+        The file of the row pointers, of length ``num_nodes + 1``.
+    indices_file : str
+        The file of the column indices.
+    eids_file : str, optional
+        The file of the edge IDs of the non-zero entries. If not given, the
+        edge IDs are the positions of the entries.
+    transpose : bool, optional
+        If True, the arrays are those of the CSC matrix, i.e. of the inbound
+        edges of every node. Default: False.
+    formats : str or list[str], optional
+        The sparse formats allowed for the graph, see :func:`dgl.DGLGraph.formats`.
+        The other formats are built in memory when needed. Default: all.
+
+    Returns
+    -------
+    DGLGraph
+        The homogeneous graph, with the data type of the arrays as its ID type.
+
+    Examples
+    --------
+    >>> import numpy as np
+    >>> np.save('indptr.npy', np.array([0, 2, 3, 3], dtype=np.int64))
+    >>> np.save('indices.npy', np.array([1, 2, 0], dtype=np.int64))
+    >>> g = dgl.data.utils.load_csr_graph_mmap('indptr.npy', 'indices.npy')
+    >>> g.edges()
+    (tensor([0, 0, 1]), tensor([1, 2, 0]))
+    """
+    indptr = _map_npy_file(indptr_file)
+    indices = _map_npy_file(indices_file)
+    if indptr.dtype != indices.dtype:
+        raise DGLError("The row pointers and the column indices must have the same data type.")
+    if eids_file is not None:
+        eids = _map_npy_file(eids_file)
+        if eids.dtype != indptr.dtype:
+            raise DGLError("The edge IDs and the row pointers must have the same data type.")
+    else:
+        eids = nd.array(np.array([], dtype=indptr.dtype))
+    if formats is None:
+        formats = ['coo', 'csr', 'csc']
+    elif isinstance(formats, str):
+        formats = [formats]
+    num_nodes = indptr.shape[0] - 1
+    gidx = heterograph_index._CAPI_DGLHeteroCreateUnitGraphFromCSR(
+        1, num_nodes, num_nodes, indptr, indices, eids, formats, transpose, False)
+    return DGLHeteroGraph(gidx, ['_N'], ['_E'])
+
+
+def load_labels_v1(filename):
+    """Internal functions for loading labels from V1 format"""
+    metadata = _CAPI_LoadGraphFiles_V1(filename, [], True)
+    label_dict = {}
+    for k, v in metadata.labels.items():
+        label_dict[k] = F.zerocopy_from_dgl_ndarray(v)
+    return label_dict
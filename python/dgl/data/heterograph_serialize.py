@@ -6,6 +6,7 @@ from .._ffi.object import ObjectBase, register_object
 from .._ffi.function import _init_api
 from .. import backend as F
 from ..container import convert_to_strmap
+from .async_save import AsyncSave  # pylint: disable=unused-import
 
 _init_api("dgl.data.heterograph_serialize")
 
@@ -18,15 +19,27 @@ def tensor_dict_to_ndarray_dict(tensor_dict):
     return convert_to_strmap(ndarray_dict)
 
 
-def save_heterographs(filename, g_list, labels):
-    """Save heterographs into file"""
+def save_heterographs(filename, g_list, labels, mmap_layout=False, async_save=False,
+                      columnar=False):
+    """Save heterographs into file, in the memory mapped layout if mmap_layout is True,
+    or with the features stored by columns if columnar is True.
+    If async_save is True, return the handle of a save written in the background."""
     if labels is None:
         labels = {}
     if isinstance(g_list, DGLHeteroGraph):
         g_list = [g_list]
     assert all([type(g) == DGLHeteroGraph for g in g_list]), "Invalid DGLHeteroGraph in g_list argument"
     gdata_list = [HeteroGraphData.create(g) for g in g_list]
-    _CAPI_SaveHeteroGraphData(filename, gdata_list, tensor_dict_to_ndarray_dict(labels))
+    if async_save:
+        return _CAPI_SaveHeteroGraphDataAsync(
+            filename, gdata_list, tensor_dict_to_ndarray_dict(labels), mmap_layout)
+    if columnar:
+        _CAPI_SaveHeteroGraphData_V5(filename, gdata_list, tensor_dict_to_ndarray_dict(labels))
+    elif mmap_layout:
+        _CAPI_SaveHeteroGraphData_V3(filename, gdata_list, tensor_dict_to_ndarray_dict(labels))
+    else:
+        _CAPI_SaveHeteroGraphData(filename, gdata_list, tensor_dict_to_ndarray_dict(labels))
+    return None
 
 @register_object("heterograph_serialize.HeteroGraphData")
 class HeteroGraphData(ObjectBase):
@@ -3,12 +3,29 @@ from __future__ import absolute_import
 from ..ndarray import NDArray
 from .._ffi.function import _init_api
 from .. import backend as F
+from .async_save import AsyncSave  # pylint: disable=unused-import
 
-__all__ = ['save_tensors', "load_tensors"]
+__all__ = ['save_tensors', "save_tensors_async", "load_tensors"]
 
 _init_api("dgl.data.tensor_serialize")
 
 
+def _to_ndarray_dict(tensor_dict):
+    """Convert the values of a dict of tensors to dgl NDArrays."""
+    nd_dict = {}
+    for key, value in tensor_dict.items():
+        if not isinstance(key, str):
+            raise Exception("Dict key has to be str")
+        if F.is_tensor(value):
+            nd_dict[key] = F.zerocopy_to_dgl_ndarray(value)
+        elif isinstance(value, NDArray):
+            nd_dict[key] = value
+        else:
+            raise Exception(
+                "Dict value has to be backend tensor or dgl ndarray")
+    return nd_dict
+
+
 def save_tensors(filename, tensor_dict):
     """
     Save dict of tensors to file
@@ -25,22 +42,36 @@ def save_tensors(filename, tensor_dict):
     status : bool
         Return whether save operation succeeds
     """
-    nd_dict = {}
+    nd_dict = _to_ndarray_dict(tensor_dict)
     is_empty_dict = len(tensor_dict) == 0
-    for key, value in tensor_dict.items():
-        if not isinstance(key, str):
-            raise Exception("Dict key has to be str")
-        if F.is_tensor(value):
-            nd_dict[key] = F.zerocopy_to_dgl_ndarray(value)
-        elif isinstance(value, NDArray):
-            nd_dict[key] = value
-        else:
-            raise Exception(
-                "Dict value has to be backend tensor or dgl ndarray")
-    
     return _CAPI_SaveNDArrayDict(filename, nd_dict, is_empty_dict)
 
 
+def save_tensors_async(filename, tensor_dict):
+    """
+    Save dict of tensors to file in the background
+
+    The tensors are copied into staging buffers before returning, so they may
+    be changed right away, e.g. by the next training step. The file is then
+    written by a background thread, in the format of :func:`save_tensors`.
+
+    Parameters
+    ----------
+    filename : str
+        File name to store dict of tensors.
+    tensor_dict: dict of dgl NDArray or backend tensor
+        Python dict using string as key and tensor as value
+
+    Returns
+    ----------
+    AsyncSave
+        The handle of the save, whose ``wait()`` blocks until the file is
+        written and raises the error of the write if any
+    """
+    nd_dict = _to_ndarray_dict(tensor_dict)
+    return _CAPI_SaveNDArrayDictAsync(filename, nd_dict, len(tensor_dict) == 0)
+
+
 def load_tensors(filename, return_dgl_ndarray=False):
     """
     load dict of tensors from file
@@ -13,14 +13,19 @@ import numpy as np
 import pickle
 import errno
 
-from .graph_serialize import save_graphs, load_graphs, load_labels
-from .tensor_serialize import save_tensors, load_tensors
+from .graph_serialize import save_graphs, save_graphs_async, load_graphs, load_labels
+from .graph_serialize import load_graph_feature
+from .graph_serialize import save_graph_delta, load_graph_snapshot, load_csr_graph_mmap
+from .tensor_serialize import save_tensors, save_tensors_async, load_tensors
 
 from .. import backend as F
 
 __all__ = ['loadtxt','download', 'check_sha1', 'extract_archive',
            'get_download_dir', 'Subset', 'split_dataset',
-           'save_graphs', "load_graphs", "load_labels", "save_tensors", "load_tensors"]
+           'save_graphs', "save_graphs_async", "load_graphs", "load_labels",
+           "load_graph_feature", "save_graph_delta", "load_graph_snapshot",
+           "load_csr_graph_mmap", "save_tensors",
+           "save_tensors_async", "load_tensors"]
 
 def loadtxt(path, delimiter, dtype=None):
     try:
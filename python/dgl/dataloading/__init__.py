@@ -17,10 +17,13 @@ Read the user guide :ref:`guide-minibatch`.
 from .neighbor import *
 from .dataloader import *
 from .cluster_gcn import *
+from .graph_saint import *
 from .shadow import *
 
 from . import negative_sampler
-from .async_transferer import AsyncTransferer
+from .async_transferer import AsyncTransferer, PrefetchQueue
+from .minibatch_pipeline import MinibatchPipeline
+from .layerwise_inference import LayerwiseInference
 
 from .. import backend as F
 
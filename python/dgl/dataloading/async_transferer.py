@@ -101,4 +101,100 @@ class AsyncTransferer(object):
         return Transfer(transfer_id, self._handle)
 
 
+class PrefetchQueue(object):
+    """ Class for copying the next minibatches to the GPU ahead of time.
+
+    Every item of the queue is a list of tensors, e.g. the arrays of the blocks,
+    the features and the labels of a minibatch, copied as one transfer. The
+    queue has ``num_slots`` slots, each with its own GPU buffers, which are
+    reused once the tensors returned from them are no longer referenced. The
+    transfers go round-robin over ``num_streams`` copy streams.
+
+    To keep the next two minibatches on the GPU while training on the current
+    one:
+
+    >>> queue = dgl.dataloading.PrefetchQueue(torch.device(0), num_slots=3)
+    >>> minibatches = ([feats[ids], labels[ids]] for ids in batches)
+    >>> for feats, labels in queue.prefetch(iter(minibatches)):
+    ...     train(feats, labels)
+
+    The copies of the tensors not in pinned memory are staged through pinned
+    buffers of the queue.
+    """
+    def __init__(self, device, num_slots=2, num_streams=1):
+        """ Create a new PrefetchQueue object.
+
+        Parameters
+        ----------
+        device : Device or context object.
+            The context to copy to. Must be a GPU context for the copies to be
+            asynchronous.
+        num_slots : int, optional
+            The maximum number of transfers in the queue.
+        num_streams : int, optional
+            The number of copy streams.
+        """
+        if isinstance(device, ndarray.DGLContext):
+            ctx = device
+        else:
+            ctx = utils.to_dgl_context(device)
+        self._num_slots = num_slots
+        self._handle = _CAPI_DGLPrefetchQueueCreate(ctx, num_slots, num_streams)
+
+    def put(self, tensors):
+        """ Start copying a list of tensors. The queue must not be full.
+
+        Parameters
+        ----------
+        tensors : list[Tensor]
+            The tensors to transfer. The ones already on the device are passed
+            through.
+        """
+        arrays = [F.zerocopy_to_dgl_ndarray(tensor) for tensor in tensors]
+        _CAPI_DGLPrefetchQueueEnqueue(self._handle, arrays)
+
+    def get(self):
+        """ Wait for the oldest transfer to finish, and return its tensors.
+
+        Returns
+        -------
+        list[Tensor]
+            The tensors on the device.
+        """
+        arrays = _CAPI_DGLPrefetchQueueDequeue(self._handle)
+        return [F.zerocopy_from_dgl_ndarray(array) for array in arrays]
+
+    def prefetch(self, iterator):
+        """ Iterate over the lists of tensors of an iterator on the device,
+        keeping ``num_slots - 1`` transfers in the queue. The last slot is left
+        to the tensors in use, which are only released once the next ones are
+        returned, so that the buffers of every slot are reused.
+
+        Parameters
+        ----------
+        iterator : iterator[list[Tensor]]
+            The lists of tensors to transfer.
+
+        Returns
+        -------
+        iterator[list[Tensor]]
+            The lists of tensors on the device, in order.
+        """
+        it = iter(iterator)
+        done = False
+        depth = max(self._num_slots - 1, 1)
+        while True:
+            while not done and len(self) < depth:
+                try:
+                    self.put(next(it))
+                except StopIteration:
+                    done = True
+            if len(self) == 0:
+                return
+            yield self.get()
+
+    def __len__(self):
+        return _CAPI_DGLPrefetchQueueSize(self._handle)
+
+
 _init_api("dgl.dataloading.async_transferer")
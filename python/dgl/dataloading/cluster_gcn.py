@@ -3,7 +3,9 @@ import os
 import pickle
 import numpy as np
 
+from .._ffi.function import _init_api
 from ..transform import metis_partition_assignment
+from ..subgraph import _create_hetero_subgraph
 from .. import backend as F
 from .dataloader import SubgraphIterator
 
@@ -13,6 +15,10 @@ class ClusterGCNSubgraphIterator(SubgraphIterator):
     This sampler first partitions the graph with METIS partitioning, then it caches the nodes of
     each partition to a file within the given cache directory.
 
+    The subgraphs are extracted in C++ from a copy of the graph whose nodes are renumbered
+    by partition, so that the subgraph of any union of partitions, see :meth:`subgraph`, is
+    sliced from contiguous rows without relabeling the nodes.
+
     This is used in conjunction with :class:`dgl.dataloading.pytorch.GraphDataLoader`.
 
     Notes
@@ -44,6 +50,7 @@ class ClusterGCNSubgraphIterator(SubgraphIterator):
         if os.name == 'nt':
             raise NotImplementedError("METIS partitioning is not supported on Windows yet.")
         super().__init__(g)
+        self._sampler = None
 
         # First see if the cache is already there.  If so, directly read from cache.
         if not refresh and self._load_parts(cache_directory):
@@ -75,9 +82,44 @@ class ClusterGCNSubgraphIterator(SubgraphIterator):
         with open(self._cache_file_path(cache_directory), 'wb') as file_:
             pickle.dump((self.part_indptr, self.part_indices), file_)
 
+    def __getstate__(self):
+        # the C++ sampler is created again in the worker processes
+        state = self.__dict__.copy()
+        state['_sampler'] = None
+        return state
+
+    def _get_sampler(self):
+        if self._sampler is None:
+            self._sampler = _CAPI_DGLClusterGCNSamplerCreate(
+                self.g._graph,
+                F.to_dgl_nd(F.tensor(self.part_indptr, dtype=F.int64)),
+                F.to_dgl_nd(F.tensor(self.part_indices, dtype=self.g.idtype)))
+        return self._sampler
+
+    def subgraph(self, parts):
+        """Return the subgraph induced by the nodes of the given partitions, with
+        the edges between them, as in Cluster-GCN.
+
+        Parameters
+        ----------
+        parts : list[int] or tensor
+            The partition IDs.
+
+        Returns
+        -------
+        DGLGraph
+            The subgraph, whose nodes are the ones of the partitions by increasing
+            partition ID. The original node and edge IDs are stored as the
+            ``dgl.NID`` and ``dgl.EID`` features.
+        """
+        parts = F.tensor(parts, dtype=F.int64)
+        sgi = _CAPI_DGLClusterGCNSamplerSample(self._get_sampler(), F.to_dgl_nd(parts))
+        return _create_hetero_subgraph(self.g, sgi, sgi.induced_nodes, sgi.induced_edges)
+
     def __len__(self):
         return self.part_indptr.shape[0] - 1
 
     def __getitem__(self, i):
-        nodes = self.part_indices[self.part_indptr[i]:self.part_indptr[i+1]]
-        return self.g.subgraph(nodes)
+        return self.subgraph([i])
+
+_init_api("dgl.dataloading.cluster_gcn", __name__)
@@ -3,7 +3,6 @@
 from collections.abc import Mapping, Sequence
 from abc import ABC, abstractproperty, abstractmethod
 import re
-import numpy as np
 from .. import transform
 from ..base import NID, EID
 from .. import backend as F
@@ -14,64 +13,22 @@ from ..heterograph import DGLHeteroGraph as DGLGraph
 from ..distributed.dist_graph import DistGraph
 from ..utils import to_device
 
-def _tensor_or_dict_to_numpy(ids):
-    if isinstance(ids, Mapping):
-        return {k: F.zerocopy_to_numpy(v) for k, v in ids.items()}
-    else:
-        return F.zerocopy_to_numpy(ids)
-
-def _locate_eids_to_exclude(frontier_parent_eids, exclude_eids):
-    """Find the edges whose IDs in parent graph appeared in exclude_eids.
-
-    Note that both arguments are numpy arrays or numpy dicts.
-    """
-    if isinstance(frontier_parent_eids, Mapping):
-        result = {
-            k: np.isin(frontier_parent_eids[k], exclude_eids[k]).nonzero()[0]
-            for k in frontier_parent_eids.keys() if k in exclude_eids.keys()}
-        return {k: F.zerocopy_from_numpy(v) for k, v in result.items()}
-    else:
-        result = np.isin(frontier_parent_eids, exclude_eids).nonzero()[0]
-        return F.zerocopy_from_numpy(result)
-
 class _EidExcluder():
     def __init__(self, exclude_eids):
-        device = None
         if isinstance(exclude_eids, Mapping):
-            for _, v in exclude_eids.items():
-                if device is None:
-                    device = F.context(v)
-                    break
-        else:
-            device = F.context(exclude_eids)
-        self._exclude_eids = None
-        self._filter = None
-
-        if device == F.cpu():
-            # TODO(nv-dlasalle): Once Filter is implemented for the CPU, we
-            # should just use that irregardless of the device.
-            self._exclude_eids = (
-                _tensor_or_dict_to_numpy(exclude_eids) if exclude_eids is not None else None)
+            self._filter = {k: utils.Filter(v) for k, v in exclude_eids.items()}
         else:
-            if isinstance(exclude_eids, Mapping):
-                self._filter = {k: utils.Filter(v) for k, v in exclude_eids.items()}
-            else:
-                self._filter = utils.Filter(exclude_eids)
+            self._filter = utils.Filter(exclude_eids)
 
     def _find_indices(self, parent_eids):
         """ Find the set of edge indices to remove.
         """
-        if self._exclude_eids is not None:
-            parent_eids_np = _tensor_or_dict_to_numpy(parent_eids)
-            return _locate_eids_to_exclude(parent_eids_np, self._exclude_eids)
+        if isinstance(parent_eids, Mapping):
+            located_eids = {k: self._filter[k].find_included_indices(parent_eids[k])
+                            for k, v in parent_eids.items() if k in self._filter}
         else:
-            assert self._filter is not None
-            if isinstance(parent_eids, Mapping):
-                located_eids = {k: self._filter[k].find_included_indices(parent_eids[k])
-                                for k, v in parent_eids.items() if k in self._filter}
-            else:
-                located_eids = self._filter.find_included_indices(parent_eids)
-            return located_eids
+            located_eids = self._filter.find_included_indices(parent_eids)
+        return located_eids
 
     def __call__(self, frontier):
         parent_eids = frontier.edata[EID]
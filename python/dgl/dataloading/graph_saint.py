@@ -0,0 +1,113 @@
+"""GraphSAINT subgraph samplers."""
+
+from .._ffi.function import _init_api
+from ..base import DGLError
+from ..batch import unbatch
+from ..subgraph import _create_hetero_subgraph
+from .. import backend as F
+
+__all__ = ['SAINTSampler']
+
+class SAINTSampler(object):
+    """Sampler of the subgraphs of GraphSAINT, from
+    `GraphSAINT: Graph Sampling Based Inductive Learning Method
+    <https://arxiv.org/abs/1907.04931>`__.
+
+    The subgraphs are sampled in C++, in parallel, each of them being induced by
+    the nodes
+
+    * of ``budget`` draws of nodes with probabilities proportional to their
+      in-degrees, with ``mode='node'``,
+    * of the endpoints of ``budget`` draws of edges :math:`(u, v)` with
+      probabilities proportional to :math:`1/d_{in}(u) + 1/d_{in}(v)`, with
+      ``mode='edge'``,
+    * of ``budget`` random walks of ``walk_length`` steps along the out-edges from
+      uniformly drawn roots, with ``mode='walk'``.
+
+    The number of subgraphs every node and edge appears in can be counted while
+    sampling, e.g. in a pre-sampling phase, for the normalization coefficients
+    returned by :meth:`normalization`.
+
+    Parameters
+    ----------
+    g : DGLGraph
+        The graph, homogeneous and on CPU.
+    mode : str
+        ``'node'``, ``'edge'`` or ``'walk'``.
+    budget : int
+        The number of nodes, of edges or of roots drawn for a subgraph.
+    walk_length : int, optional
+        The number of steps of a walk, with ``mode='walk'``.
+
+    Examples
+    --------
+    >>> sampler = dgl.dataloading.SAINTSampler(g, 'node', 6000)
+    >>> presampled = sampler.sample(1000, count=True, split=True)
+    >>> loss_norm, aggr_norm = sampler.normalization()
+    >>> g.ndata['l_n'], g.edata['w'] = loss_norm, aggr_norm
+    >>> for subg in sampler.sample(50, split=True):
+    ...     train_on(subg)
+    """
+    def __init__(self, g, mode, budget, walk_length=None):
+        if mode == 'walk' and walk_length is None:
+            raise DGLError('walk_length must be given with mode="walk".')
+        self.g = g
+        self._handle = _CAPI_DGLSAINTSamplerCreate(
+            g._graph, mode, budget, 0 if walk_length is None else walk_length)
+
+    def sample(self, num_subgraphs=1, random_seed=None, count=False, split=False):
+        """Sample subgraphs.
+
+        Parameters
+        ----------
+        num_subgraphs : int, optional
+            The number of subgraphs.
+        random_seed : int, optional
+            If given, the ``i``-th subgraph is sampled from this seed and ``i``, so
+            that the subgraphs do not depend on the number of threads.
+        count : bool, optional
+            If True, the nodes and the edges of the subgraphs are counted for
+            :meth:`normalization`.
+        split : bool, optional
+            If True, return the list of the subgraphs instead of their batch.
+
+        Returns
+        -------
+        DGLGraph or list[DGLGraph]
+            The batch of the subgraphs, with their numbers of nodes and of edges
+            set, see :func:`dgl.batch`, or the subgraphs if ``split`` is True. The
+            features of the graph are copied, and the original node and edge IDs
+            are stored as the ``dgl.NID`` and ``dgl.EID`` features.
+        """
+        sgi, batch_num_nodes, batch_num_edges = _CAPI_DGLSAINTSamplerSample(
+            self._handle, num_subgraphs, -1 if random_seed is None else random_seed, count)
+        batched = _create_hetero_subgraph(self.g, sgi, sgi.induced_nodes, sgi.induced_edges)
+        batched.set_batch_num_nodes(F.from_dgl_nd(batch_num_nodes))
+        batched.set_batch_num_edges(F.from_dgl_nd(batch_num_edges))
+        return unbatch(batched) if split else batched
+
+    def normalization(self):
+        """Return the normalization coefficients of GraphSAINT from the subgraphs
+        counted.
+
+        The loss of the node :math:`v` is scaled by :math:`N / (C_v |V|)` and the
+        edge :math:`(u, v)` is aggregated with the weight :math:`C_v / C_{(u, v)}`,
+        where :math:`N` is the number of subgraphs counted and :math:`C` the number
+        of them a node or an edge appeared in, at least 1.
+
+        Returns
+        -------
+        tensor
+            The float32 coefficients of the losses of the nodes.
+        tensor
+            The float32 coefficients of the aggregations along the edges.
+        """
+        loss_norm, aggr_norm = _CAPI_DGLSAINTSamplerNormalization(self._handle)
+        return F.from_dgl_nd(loss_norm), F.from_dgl_nd(aggr_norm)
+
+    @property
+    def num_counted(self):
+        """The number of subgraphs counted."""
+        return _CAPI_DGLSAINTSamplerNumCounted(self._handle)
+
+_init_api("dgl.dataloading.graph_saint", __name__)
@@ -0,0 +1,93 @@
+"""Layer-wise inference over all the nodes of a graph, by chunks of nodes."""
+
+from .._ffi.function import _init_api
+from .. import backend as F
+from .. import ndarray as nd
+from .. import utils
+
+__all__ = ['LayerwiseInference']
+
+_OPS = {'copy_u' : 'copy_lhs', 'u_mul_e' : 'mul'}
+
+class LayerwiseInference(object):
+    """Driver of one layer of the inference over all the nodes of a graph, iterating
+    over chunks of consecutive destination nodes.
+
+    For every chunk, a C++ thread slices the inbound edges of its nodes, gathers the
+    features of their source nodes, moves them to the device and aggregates them
+    there, so the next chunks are prepared while the current one is computed on.
+    The features may be in host memory, including a file mapped into memory, e.g.
+    by :func:`numpy.load` with ``mmap_mode``, in pinned memory, read by the GPU
+    directly, or on the device. The outputs of the layer are stored with
+    :meth:`store` into a preallocated table, e.g. a file mapped into memory too, so
+    neither the inputs nor the outputs of a layer have to fit in memory.
+
+    Iterating yields the destination nodes of a chunk, from ``start`` to ``end``
+    excluded, the aggregation of the features of their source nodes and their own
+    features, both on the device:
+
+    >>> out = torch.from_numpy(np.lib.format.open_memmap(
+    ...     'h1.npy', mode='w+', dtype='float32', shape=(g.num_nodes(), 256)))
+    >>> engine = dgl.dataloading.LayerwiseInference(
+    ...     g, feat, 100000, device='cuda', reduce='mean', out=out)
+    >>> for start, end, h_neigh, h_self in engine:
+    ...     engine.store(start, sage_layer(h_self, h_neigh))
+
+    Parameters
+    ----------
+    g : DGLGraph
+        The graph, homogeneous and on CPU.
+    feat : tensor
+        The features of all the nodes, on CPU or on the device.
+    chunk_size : int
+        The number of destination nodes of a chunk.
+    device : device, optional
+        The device the chunks are aggregated on. Default: the device of ``feat``.
+    op : str, optional
+        ``'copy_u'``, or ``'u_mul_e'`` with the features ``efeat`` of the edges.
+    reduce : str, optional
+        ``'sum'``, or ``'mean'`` with ``'copy_u'``.
+    efeat : tensor, optional
+        The features of all the edges for ``'u_mul_e'``, on CPU or on the device.
+    out : tensor, optional
+        The table of the outputs of the layer of all the nodes, on CPU, written to
+        by :meth:`store`.
+    num_buffers : int, optional
+        The maximum number of chunks prepared ahead.
+    """
+    def __init__(self, g, feat, chunk_size, device=None, op='copy_u', reduce='sum',
+                 efeat=None, out=None, num_buffers=2):
+        self._g = g
+        self._device = F.context(feat) if device is None else device
+        # keep the tables alive with the driver
+        self._feat, self._efeat, self._out = feat, efeat, out
+        if efeat is not None and F.ndim(efeat) == 1:
+            efeat = F.unsqueeze(efeat, 1)
+        self._handle = _CAPI_DGLLayerwiseInferenceCreate(
+            g._graph, F.to_dgl_nd(feat),
+            nd.NULL[g._idtype_str] if efeat is None else F.to_dgl_nd(efeat),
+            _OPS.get(op, op), reduce, chunk_size, utils.to_dgl_context(self._device),
+            nd.NULL[g._idtype_str] if out is None else F.to_dgl_nd(out), num_buffers)
+
+    def __len__(self):
+        return _CAPI_DGLLayerwiseInferenceNumChunks(self._handle)
+
+    def __iter__(self):
+        for _ in range(len(self)):
+            start, end, aggregated, dst_feat = _CAPI_DGLLayerwiseInferenceNext(self._handle)
+            yield start, end, F.from_dgl_nd(aggregated), F.from_dgl_nd(dst_feat)
+
+    def store(self, start, value):
+        """Store the outputs of the layer of the nodes from ``start`` on into the
+        output table.
+
+        Parameters
+        ----------
+        start : int
+            The first node.
+        value : tensor
+            The outputs of the nodes, on any device.
+        """
+        _CAPI_DGLLayerwiseInferenceStore(self._handle, start, F.to_dgl_nd(value))
+
+_init_api("dgl.dataloading.layerwise_inference", __name__)
@@ -0,0 +1,133 @@
+"""Pipeline sampling the blocks and gathering the input features of minibatches
+in the background."""
+
+from .._ffi.function import _init_api
+from .. import backend as F
+from ..base import DGLError
+from .. import ndarray as nd
+from .. import utils
+from ..sampling.neighbor import _prepare_fanout_array, _make_blocks
+
+__all__ = ['MinibatchPipeline']
+
+class MinibatchPipeline(object):
+    """Pipeline running the neighbor sampling of every layer, the construction
+    of the blocks and the gathering of the input features of a minibatch back to
+    back in C++, on a thread of its own.
+
+    When the graph is on a GPU, the thread issues its kernels on a stream of
+    its own, so the host synchronizations of the sampling do not stall the
+    training. The features in pinned memory, e.g. pinned with
+    :meth:`dgl.ndarray.NDArray.pin_memory_`, are gathered by the GPU directly.
+
+    With ``num_buffers=2``, the minibatch ``i + 1`` is sampled while the
+    minibatch ``i`` is trained on. With ``num_workers`` greater than 1, up to
+    ``num_workers`` of the minibatches submitted are sampled at the same time by
+    persistent threads. Unlike the worker processes of a PyTorch DataLoader,
+    they need neither to attach the graph nor to pickle the blocks back:
+
+    >>> pipeline = dgl.dataloading.MinibatchPipeline(
+    ...     g, [10, 25], features=feats, num_buffers=2)
+    >>> pipeline.submit(seeds[0])
+    >>> for i in range(len(seeds)):
+    ...     if i + 1 < len(seeds):
+    ...         pipeline.submit(seeds[i + 1])
+    ...     blocks, input_features = pipeline.fetch()
+    ...     train(blocks, input_features)
+
+    Parameters
+    ----------
+    g : DGLGraph
+        The graph, on CPU or GPU.
+    fanouts : list[int or dict[etype, int]]
+        The number of inbound edges sampled for every node on each layer, from
+        the first layer to the last, see :func:`dgl.sampling.sample_neighbors`.
+    features : tensor or dict[ntype, tensor], optional
+        The features of the input nodes to gather. They must be on the device of
+        the graph, or in pinned memory.
+    replace : bool, optional
+        If True, sample with replacement.
+    num_buffers : int, optional
+        The maximum number of minibatches submitted and not fetched.
+    num_workers : int, optional
+        The number of minibatches sampled at the same time, at most
+        ``num_buffers``. On GPU, every worker issues its kernels on a stream of
+        its own.
+    random_seed : int, optional
+        If given, the ``i``-th minibatch submitted is sampled from this seed and
+        ``i``, so that the sampled blocks on CPU do not depend on the number of
+        threads or of workers, see the :attr:`random_seed` argument of
+        :func:`dgl.sampling.sample_neighbors`.
+    copy_edata : bool, optional
+        If True, the edge features of the graph are copied to the blocks.
+    """
+    def __init__(self, g, fanouts, features=None, replace=False, num_buffers=2,
+                 copy_edata=False, num_workers=1, random_seed=None):
+        self._single_features = features is not None and not isinstance(features, dict)
+        if features is None:
+            features = {}
+        elif self._single_features:
+            if len(g.ntypes) > 1:
+                raise DGLError("Must specify node type when the graph is not homogeneous.")
+            features = {g.ntypes[0] : features}
+        self._g = g
+        self._copy_edata = copy_edata
+        self._ntypes_with_features = set(features.keys())
+        # keep the features alive with the pipeline
+        self._features = features
+        feature_arrays = [F.to_dgl_nd(features[ntype]) if ntype in features
+                          else nd.array([], ctx=nd.cpu()) for ntype in g.ntypes]
+        fanout_arrays = [_prepare_fanout_array(g, fanout) for fanout in fanouts]
+        self._handle = _CAPI_DGLMinibatchPipelineCreate(
+            g._graph, fanout_arrays, replace, feature_arrays, num_buffers, num_workers,
+            -1 if random_seed is None else random_seed)
+
+    def submit(self, seed_nodes):
+        """Start the work of a minibatch, waiting while the pipeline is full.
+
+        Parameters
+        ----------
+        seed_nodes : tensor or dict[ntype, tensor]
+            The output nodes of the last layer, on the device of the graph.
+        """
+        g = self._g
+        if not isinstance(seed_nodes, dict):
+            if len(g.ntypes) > 1:
+                raise DGLError("Must specify node type when the graph is not homogeneous.")
+            seed_nodes = {g.ntypes[0] : seed_nodes}
+        seed_nodes = utils.prepare_tensor_dict(g, seed_nodes, 'nodes')
+        seeds_all_types = []
+        for ntype in g.ntypes:
+            if ntype in seed_nodes:
+                seeds_all_types.append(F.to_dgl_nd(seed_nodes[ntype]))
+            else:
+                seeds_all_types.append(F.to_dgl_nd(F.copy_to(
+                    F.tensor([], dtype=g.idtype), g.device)))
+        _CAPI_DGLMinibatchPipelineSubmit(self._handle, seeds_all_types)
+
+    def fetch(self):
+        """Wait for the oldest minibatch submitted. The minibatches are
+        fetched in the order they were submitted in, whatever the number of
+        workers.
+
+        Returns
+        -------
+        list[DGLBlock]
+            The blocks, from the first layer to the last. The original node and
+            edge IDs are stored as the ``dgl.NID`` and ``dgl.EID`` features.
+        tensor or dict[ntype, tensor]
+            The features of the input nodes of the first block, in the form the
+            features were given, empty if none.
+        """
+        block_idxs, src_nodes_nd, induced_edges_nd, features_nd = \
+            _CAPI_DGLMinibatchPipelineFetch(self._handle)
+        blocks = _make_blocks(self._g, block_idxs, src_nodes_nd, induced_edges_nd,
+                              False, self._copy_edata)
+        features = {ntype : F.from_dgl_nd(feat)
+                    for ntype, feat in zip(self._g.ntypes, features_nd)
+                    if ntype in self._ntypes_with_features}
+        if self._single_features:
+            features = features[self._g.ntypes[0]]
+        return blocks, features
+
+_init_api("dgl.dataloading.minibatch_pipeline", __name__)
@@ -1,6 +1,7 @@
 """Negative samplers"""
 from collections.abc import Mapping
 from .. import backend as F
+from ..sampling.negative import corrupt_edges
 
 class _BaseNegativeSampler(object):
     def _generate(self, g, eids, canonical_etype):
@@ -65,3 +66,78 @@ class Uniform(_BaseNegativeSampler):
         src = F.repeat(src, self.k, 0)
         dst = F.randint(shape, dtype, ctx, 0, g.number_of_nodes(vtype))
         return src, dst
+
+class Corrupt(_BaseNegativeSampler):
+    """Negative sampler that corrupts the heads or the tails of the edges with
+    nodes drawn uniformly or by degree, in C++ and for all the edge types at once,
+    optionally never returning an existing edge.
+
+    For each edge ``(u, v)`` of type ``(srctype, etype, dsttype)``, DGL generates
+    :attr:`k` pairs of negative edges ``(u, v')`` when corrupting the tails, with
+    ``v'`` of type ``dsttype``, or ``(u', v)`` when corrupting the heads, with
+    ``u'`` of type ``srctype``. See :func:`dgl.sampling.corrupt_edges`.
+
+    Parameters
+    ----------
+    k : int
+        The number of negative examples per edge.
+    corrupt : str, optional
+        ``'tail'`` or ``'head'``, the end of the edges to corrupt.
+    weighted : bool, optional
+        If True, the nodes are drawn in proportion to their degree to the power 0.75
+        for the edge type, as in word2vec: the in-degree when corrupting the tails,
+        and the out-degree when corrupting the heads.
+    exclude_existing : bool, optional
+        If True, the negative edges that exist in the graph are drawn again up to
+        :attr:`num_trials` times, and dropped if they still exist, so there may be
+        fewer than :attr:`k` negative examples for some edges.
+    num_trials : int, optional
+        The number of draws of a negative edge with :attr:`exclude_existing`.
+
+    Examples
+    --------
+    >>> g = dgl.graph(([0, 1, 2], [1, 2, 3]))
+    >>> neg_sampler = dgl.dataloading.negative_sampler.Corrupt(2, exclude_existing=True)
+    >>> neg_sampler(g, torch.tensor([0, 1]))
+    (tensor([0, 0, 1, 1]), tensor([3, 0, 1, 0]))
+    """
+    def __init__(self, k, corrupt='tail', weighted=False, exclude_existing=False,
+                 num_trials=10):
+        self.k = k
+        self.corrupt = corrupt
+        self.weighted = weighted
+        self.exclude_existing = exclude_existing
+        self.num_trials = num_trials
+
+    def _weights(self, g, canonical_etype):
+        if self.corrupt == 'tail':
+            degrees = g.in_degrees(etype=canonical_etype)
+        else:
+            degrees = g.out_degrees(etype=canonical_etype)
+        return F.astype(degrees, F.float32) ** 0.75
+
+    def __call__(self, g, eids):
+        """Returns negative examples.
+
+        Parameters
+        ----------
+        g : DGLGraph
+            The graph.
+        eids : Tensor or dict[etype, Tensor]
+            The sampled edges in the minibatch.
+
+        Returns
+        -------
+        tuple[Tensor, Tensor] or dict[etype, tuple[Tensor, Tensor]]
+            The returned source-destination pairs as negative examples.
+        """
+        prob = None
+        if isinstance(eids, Mapping):
+            eids = {g.to_canonical_etype(k): v for k, v in eids.items()}
+            if self.weighted:
+                prob = {etype: self._weights(g, etype) for etype in eids}
+        elif self.weighted:
+            prob = self._weights(g, g.canonical_etypes[0])
+        return corrupt_edges(g, eids, self.k, corrupt=self.corrupt, prob=prob,
+                             exclude_existing=self.exclude_existing,
+                             num_trials=self.num_trials)
@@ -3,7 +3,7 @@ from .dataloader import BlockSampler
 from .. import sampling, distributed
 from .. import ndarray as nd
 from .. import backend as F
-from ..base import ETYPE
+from ..base import ETYPE, NID
 
 class NeighborSamplingMixin(object):
     """Mixin object containing common optimizing routines that caches fanout and probability
@@ -128,6 +128,17 @@ class MultiLayerNeighborSampler(NeighborSamplingMixin, BlockSampler):
     def exclude_edges_in_frontier(cls, g):
         return not isinstance(g, distributed.DistGraph) and g.device == F.cpu()
 
+    def sample(self, g, seed_nodes, exclude_eids=None):
+        # Sample and relabel all the layers in a single call when nothing has to
+        # run between sampling a frontier and converting it to a block.
+        if exclude_eids is None and self.output_device is None and \
+                not isinstance(g, distributed.DistGraph) and g.device == F.cpu() and \
+                type(self).sample_frontier is MultiLayerNeighborSampler.sample_frontier:
+            blocks = sampling.sample_neighbor_blocks(
+                g, seed_nodes, self.fanouts, prob=self.prob, replace=self.replace)
+            return blocks[0].srcdata[NID], blocks[-1].dstdata[NID], blocks
+        return super().sample(g, seed_nodes, exclude_eids)
+
     def sample_frontier(self, block_id, g, seed_nodes, exclude_eids=None):
         fanout = self.fanouts[block_id]
         if isinstance(g, distributed.DistGraph):
@@ -22,9 +22,9 @@ import os
 import time
 import json
 import torch as th
-from dgl import DGLGraph
+from dgl.convert import graph as dgl_graph
 from dgl.sparse import libra_vertex_cut
-from dgl.sparse import libra2dgl_build_dict
+from dgl.sparse import libra2dgl_build_partitions
 from dgl.sparse import libra2dgl_set_lr
 from dgl.sparse import libra2dgl_build_adjlist
 from dgl.data.utils import save_graphs, save_tensors
@@ -84,40 +84,30 @@ def libra_partition(num_community, G, resultdir):
 
     print("Max partition size: ", int(community_weights.max()))
     print(" ** Converting libra partitions to dgl graphs **")
-    fsize = int(community_weights.max()) + 1024   ## max edges in partition
-    # print("fsize: ", fsize, flush=True)
 
     node_map = th.zeros(num_community, dtype=th.int64)
-    indices = th.zeros(num_nodes, dtype=th.int64)
     lrtensor = th.zeros(num_nodes, dtype=th.int64)
     gdt_key = th.zeros(num_nodes, dtype=th.int64)
     gdt_value = th.zeros([num_nodes, num_community], dtype=th.int64)
-    offset = th.zeros(1, dtype=th.int64)
-    ldt_ar = []
 
-    gg_ar = [DGLGraph() for i in range(num_community)]
+    ## building node, parition dictionary, and the local edges of the partitions
+    ## Assign local node ids and mapping to global node ids
+    ldt_ar, src_ar, dst_ar = libra2dgl_build_partitions(u_t, v_t, out, num_community,
+                                                        gdt_key, gdt_value, node_map,
+                                                        num_nodes)
+
+    gg_ar = []
     part_nodes = []
 
     print(">>> ", "num_nodes   ", " ", "num_edges")
     ## Iterator over number of partitions
     for i in range(num_community):
-        g = gg_ar[i]
-
-        a_t = th.zeros(fsize, dtype=th.int64)
-        b_t = th.zeros(fsize, dtype=th.int64)
-        ldt_key = th.zeros(fsize, dtype=th.int64)
-        ldt_ar.append(ldt_key)
-
-        ## building node, parition dictionary
-        ## Assign local node ids and mapping to global node ids
-        ret = libra2dgl_build_dict(a_t, b_t, indices, ldt_key, gdt_key, gdt_value,
-                                   node_map, offset, num_community, i, fsize, resultdir)
-
-        num_nodes_partition = int(ret[0])
-        num_edges_partition = int(ret[1])
+        num_nodes_partition = ldt_ar[i].shape[0]
+        num_edges_partition = src_ar[i].shape[0]
         part_nodes.append(num_nodes_partition)
         print(">>> ", num_nodes_partition, " ", num_edges_partition)
-        g.add_edges(a_t[0:num_edges_partition], b_t[0:num_edges_partition])
+        gg_ar.append(dgl_graph((src_ar[i], dst_ar[i]), num_nodes=num_nodes_partition))
+    del src_ar, dst_ar
 
     ########################################################
     ## fixing lr - 1-level tree for the split-nodes
@@ -1,12 +1,14 @@
 """A set of graph services of getting subgraphs from DistGraph"""
 from collections import namedtuple
+import os
 import numpy as np
 
 from .rpc import Request, Response, send_requests_to_machine, recv_responses
 from ..sampling import sample_neighbors as local_sample_neighbors
 from ..sampling import sample_etype_neighbors as local_sample_etype_neighbors
 from ..subgraph import in_subgraph as local_in_subgraph
-from .rpc import register_service
+from .rpc import register_service, register_native_sampling
+from .graph_partition_book import RangePartitionBook
 from ..convert import graph, heterograph
 from ..base import NID, EID
 from ..utils import toindex
@@ -139,6 +141,36 @@ def _in_subgraph(local_g, partition_book, seed_nodes):
     return global_src, global_dst, global_eids
 
 
+def _serve_native_sampling(req, local_g, partition_book):
+    """Serve the next sampling requests like ``req`` in C++, by batches of the
+    requests received within ``DGL_DIST_SAMPLING_WINDOW_US`` microseconds, if
+    they are uniform, of a non-negative fanout, and the global IDs of the
+    partition are a range, i.e. with a RangePartitionBook.
+    """
+    if os.environ.get('DGL_DIST_NATIVE_SAMPLING', '1') == '0' or \
+            req.prob is not None or req.fan_out < 0 or \
+            not isinstance(partition_book, RangePartitionBook) or \
+            len(local_g.etypes) != 1 or \
+            F.dtype(local_g.ndata[NID]) != F.int64 or F.dtype(local_g.edata[EID]) != F.int64:
+        return
+    key = (req.fan_out, req.edge_dir, req.replace)
+    if key in _NATIVE_SAMPLINGS:
+        return
+    _NATIVE_SAMPLINGS.add(key)
+    # the local IDs of a range partition are the global IDs minus the first one
+    node_offset = -int(F.as_scalar(
+        partition_book.nid2localnid(F.tensor([0], F.int64), partition_book.partid)))
+    empty = F.tensor([], F.int64)
+    register_native_sampling(
+        SAMPLING_SERVICE_ID,
+        SamplingRequest(empty, req.fan_out, req.edge_dir, None, req.replace),
+        SubgraphResponse(empty, empty, empty), local_g,
+        local_g.ndata[NID], local_g.edata[EID], node_offset,
+        int(os.environ.get('DGL_DIST_SAMPLING_WINDOW_US', '200')))
+
+# the samplings served in C++, by fanout, direction and replacement
+_NATIVE_SAMPLINGS = set()
+
 class SamplingRequest(Request):
     """Sampling Request"""
 
@@ -158,6 +190,7 @@ class SamplingRequest(Request):
     def process_request(self, server_state):
         local_g = server_state.graph
         partition_book = server_state.partition_book
+        _serve_native_sampling(self, local_g, partition_book)
         global_src, global_dst, global_eids = _sample_neighbors(local_g, partition_book,
                                                                 self.seed_nodes,
                                                                 self.fan_out, self.edge_dir,
@@ -776,9 +809,16 @@ def out_degrees(g, u):
         return _out_degrees(local_g, partition_book, u)
     return _distributed_get_node_property(g, u, issue_remote_req, local_access)
 
-register_service(SAMPLING_SERVICE_ID, SamplingRequest, SubgraphResponse)
+# the sampling requests are on the critical path of every mini-batch, so they
+# are served before the feature pulls queued with them
+SAMPLING_PRIORITY = 1
+
+register_service(SAMPLING_SERVICE_ID, SamplingRequest, SubgraphResponse,
+                 priority=SAMPLING_PRIORITY)
 register_service(EDGES_SERVICE_ID, EdgesRequest, FindEdgeResponse)
-register_service(INSUBGRAPH_SERVICE_ID, InSubgraphRequest, SubgraphResponse)
+register_service(INSUBGRAPH_SERVICE_ID, InSubgraphRequest, SubgraphResponse,
+                 priority=SAMPLING_PRIORITY)
 register_service(OUTDEGREE_SERVICE_ID, OutDegreeRequest, OutDegreeResponse)
 register_service(INDEGREE_SERVICE_ID, InDegreeRequest, InDegreeResponse)
-register_service(ETYPE_SAMPLING_SERVICE_ID, SamplingRequestEtype, SubgraphResponse)
+register_service(ETYPE_SAMPLING_SERVICE_ID, SamplingRequestEtype, SubgraphResponse,
+                 priority=SAMPLING_PRIORITY)
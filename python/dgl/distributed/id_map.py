@@ -114,6 +114,8 @@ class IdMap:
         self.range_start = utils.toindex(np.ascontiguousarray(ranges[:, 0]))
         self.range_end = utils.toindex(np.ascontiguousarray(ranges[:, 1]) - 1)
         self.typed_map = utils.toindex(np.concatenate(typed_map))
+        # the ranges copied to every GPU the IDs have been mapped on
+        self._device_ranges = {}
 
     def __call__(self, ids):
         '''Convert the homogeneous IDs to (type_id, type_wise_id).
@@ -135,6 +137,10 @@ class IdMap:
         if len(ids) == 0:
             return ids, ids
 
+        ctx = F.context(ids)
+        if F.device_type(ctx) != 'cpu':
+            return self._map_on_device(ids, ctx)
+
         ids = utils.toindex(ids)
         ret = _CAPI_DGLHeteroMapIds(ids.todgltensor(),
                                     self.range_start.todgltensor(),
@@ -144,4 +150,16 @@ class IdMap:
         ret = utils.toindex(ret).tousertensor()
         return ret[:len(ids)], ret[len(ids):]
 
+    def _map_on_device(self, ids, ctx):
+        '''Convert the homogeneous IDs to (type_id, type_wise_id) on the device of the IDs.'''
+        if ctx not in self._device_ranges:
+            self._device_ranges[ctx] = [
+                F.to_dgl_nd(F.copy_to(arr.tousertensor(), ctx))
+                for arr in (self.range_start, self.range_end, self.typed_map)]
+        range_start, range_end, typed_map = self._device_ranges[ctx]
+        ret = F.from_dgl_nd(_CAPI_DGLHeteroMapIds(F.to_dgl_nd(F.astype(ids, F.int64)),
+                                                  range_start, range_end, typed_map,
+                                                  self.num_parts, self.num_types))
+        return ret[:len(ids)], ret[len(ids):]
+
 _init_api("dgl.distributed.id_map")
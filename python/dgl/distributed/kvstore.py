@@ -4,7 +4,7 @@ import os
 import numpy as np
 
 from . import rpc
-from .graph_partition_book import NodePartitionPolicy, EdgePartitionPolicy
+from .graph_partition_book import NodePartitionPolicy, EdgePartitionPolicy, RangePartitionBook
 from .standalone_kvstore import KVClient as SA_KVClient
 
 from .. import backend as F
@@ -61,6 +61,7 @@ class PullRequest(rpc.Request):
             raise RuntimeError("KVServer cannot find partition policy with name: %s" % self.name)
         if self.name not in kv_store.data_store:
             raise RuntimeError("KVServer Cannot find data tensor with name: %s" % self.name)
+        kv_store.flush_gradients(self.name)
         local_id = kv_store.part_policy[self.name].to_local(self.id_tensor)
         data = kv_store.pull_handlers[self.name](kv_store.data_store, self.name, local_id)
         res = PullResponse(kv_store.server_id, data)
@@ -99,10 +100,52 @@ class PushRequest(rpc.Request):
             raise RuntimeError("KVServer cannot find partition policy with name: %s" % self.name)
         if self.name not in kv_store.data_store:
             raise RuntimeError("KVServer Cannot find data tensor with name: %s" % self.name)
+        kv_store.flush_gradients(self.name)
         local_id = kv_store.part_policy[self.name].to_local(self.id_tensor)
         kv_store.push_handlers[self.name](kv_store.data_store, self.name,
                                           local_id, self.data_tensor)
 
+KVSTORE_PUSH_GRAD = 901242
+
+class PushGradRequest(rpc.Request):
+    """Send ID tensor and gradient tensor to server, to be summed with the
+    gradients of the same rows pushed by other clients before the push handler
+    of the data is applied.
+
+    This request has no response.
+
+    Parameters
+    ----------
+    name : str
+        data name
+    id_tensor : tensor
+        a vector storing the unique data ID
+    grad_tensor : tensor
+        a float32 or float16 tensor with the same row size of data ID
+    """
+    def __init__(self, name, id_tensor, grad_tensor):
+        self.name = name
+        self.id_tensor = id_tensor
+        self.grad_tensor = grad_tensor
+
+    def __getstate__(self):
+        return self.name, self.id_tensor, self.grad_tensor
+
+    def __setstate__(self, state):
+        self.name, self.id_tensor, self.grad_tensor = state
+
+    def process_request(self, server_state):
+        kv_store = server_state.kv_store
+        if self.name not in kv_store.part_policy:
+            raise RuntimeError("KVServer cannot find partition policy with name: %s" % self.name)
+        if self.name not in kv_store.data_store:
+            raise RuntimeError("KVServer Cannot find data tensor with name: %s" % self.name)
+        local_id = kv_store.part_policy[self.name].to_local(self.id_tensor)
+        grad = self.grad_tensor
+        if F.dtype(grad) == F.float16:
+            grad = F.astype(grad, F.float32)
+        kv_store.buffer_gradients(self.name, local_id, grad)
+
 INIT_DATA = 901233
 INIT_MSG = 'Init'
 
@@ -268,6 +311,7 @@ class RegisterPullHandlerRequest(rpc.Request):
     def process_request(self, server_state):
         kv_store = server_state.kv_store
         kv_store.pull_handlers[self.name] = self.pull_func
+        kv_store.update_native_pull(self.name)
         res = RegisterPullHandlerResponse(REGISTER_PULL_MSG)
         return res
 
@@ -477,6 +521,7 @@ class SendMetaToBackupRequest(rpc.Request):
             kv_store.part_policy[self.name] = kv_store.find_policy(self.policy_str)
             kv_store.pull_handlers[self.name] = self.pull_handler
             kv_store.push_handlers[self.name] = self.push_handler
+            kv_store.update_native_pull(self.name)
         else:
             assert tuple(F.shape(kv_store.data_store[self.name])) == tuple(self.shape)
             assert F.reverse_data_type_dict[F.dtype(kv_store.data_store[self.name])] == self.dtype
@@ -526,6 +571,7 @@ class DeleteDataRequest(rpc.Request):
             del kv_store.part_policy[self.name]
             del kv_store.push_handlers[self.name]
             del kv_store.pull_handlers[self.name]
+            kv_store.update_native_pull(self.name)
         res = DeleteDataResponse(DELETE_MSG)
         return res
 
@@ -567,6 +613,28 @@ class CountLocalNonzeroRequest(rpc.Request):
 
 ############################ KVServer ###############################
 
+def coalesce_rows(id_tensor, data_tensor):
+    """Sum the rows of the same ID.
+
+    Parameters
+    ----------
+    id_tensor : tensor
+        a vector storing the ID list.
+    data_tensor : tensor
+        a tensor with the same row size of id
+
+    Returns
+    -------
+    tensor
+        the unique IDs.
+    tensor
+        the sum of the rows of every unique ID.
+    """
+    uniq_id, inverse = F.unique(id_tensor, return_inverse=True)
+    if F.shape(uniq_id)[0] == F.shape(id_tensor)[0]:
+        return id_tensor, data_tensor
+    return uniq_id, F.scatter_add(data_tensor, inverse, F.shape(uniq_id)[0])
+
 def default_push_handler(target, name, id_tensor, data_tensor):
     """Default handler for PUSH message.
 
@@ -642,6 +710,9 @@ class KVServer(object):
         rpc.register_service(KVSTORE_PUSH,
                              PushRequest,
                              None)
+        rpc.register_service(KVSTORE_PUSH_GRAD,
+                             PushGradRequest,
+                             None)
         rpc.register_service(INIT_DATA,
                              InitDataRequest,
                              InitDataResponse)
@@ -673,6 +744,9 @@ class KVServer(object):
         self._data_store = {}
         # Store the partition information with specified data name
         self._policy_set = set()
+        # The gradients pushed and not applied yet, by data name
+        self._pending_grads = {}
+        self._max_pending_grads = int(os.environ.get('DGL_KVSTORE_MAX_PENDING_GRADS', '64'))
         self._part_policy = {}
         # Basic information
         self._server_id = server_id
@@ -695,6 +769,49 @@ class KVServer(object):
         """Get server ID"""
         return self._server_id
 
+    def buffer_gradients(self, name, local_id, grad_tensor):
+        """Hold back the gradients of the local rows of a tensor, to be summed
+        with the gradients of the same rows pushed with them before the push
+        handler is applied by :func:`flush_gradients`.
+
+        Parameters
+        ----------
+        name : str
+            data name
+        local_id : tensor
+            a vector storing the local ID list.
+        grad_tensor : tensor
+            a tensor with the same row size of id
+        """
+        ids, grads = self._pending_grads.setdefault(name, ([], []))
+        ids.append(local_id)
+        grads.append(grad_tensor)
+        if len(ids) >= self._max_pending_grads:
+            self.flush_gradients(name)
+
+    def flush_gradients(self, name=None):
+        """Apply the push handler to the sum of the gradients held back of
+        every row.
+
+        The server loop flushes all the gradients once no request is queued,
+        so that the pushes of the trainers received together are applied at
+        once. The other requests on a tensor flush its gradients first.
+
+        Parameters
+        ----------
+        name : str, optional
+            data name. If None, the gradients of all the data are applied.
+        """
+        if not self._pending_grads:
+            return
+        names = list(self._pending_grads) if name is None else [name]
+        for data_name in names:
+            if data_name not in self._pending_grads:
+                continue
+            ids, grads = self._pending_grads.pop(data_name)
+            local_id, grad = coalesce_rows(F.cat(ids, 0), F.cat(grads, 0))
+            self._push_handlers[data_name](self._data_store, data_name, local_id, grad)
+
     @property
     def barrier_count(self):
         """Get barrier count"""
@@ -783,6 +900,33 @@ class KVServer(object):
                         data_tensor.shape[0])
         self._pull_handlers[name] = default_pull_handler
         self._push_handlers[name] = default_push_handler
+        self.update_native_pull(name)
+
+    def update_native_pull(self, name):
+        """Serve the pulls of a tensor in C++ if they use the default pull handler,
+        otherwise in Python.
+
+        The pulls are served in C++, without entering the Python interpreter,
+        if the tensor exists and the global IDs of the partition are a range,
+        i.e., with a RangePartitionBook. To be called whenever the tensor, its
+        partition policy or its pull handler changes.
+
+        Parameters
+        ----------
+        name : str
+            data name
+        """
+        if os.environ.get('DGL_KVSTORE_NATIVE_PULL', '1') == '0' or \
+                name not in self._data_store or \
+                self._pull_handlers.get(name) is not default_pull_handler or \
+                not isinstance(self._part_policy[name].partition_book, RangePartitionBook):
+            rpc.unregister_native_pull(name)
+            return
+        # the local IDs of a range partition are the global IDs minus the first one
+        policy = self._part_policy[name]
+        offset = -int(F.as_scalar(policy.to_local(F.tensor([0], F.int64))))
+        rpc.register_native_pull(KVSTORE_PULL, name, self._server_id,
+                                 self._data_store[name], offset)
 
     def find_policy(self, policy_str):
         """Find a partition policy from existing policy set
@@ -817,6 +961,19 @@ class KVServer(object):
 
 ############################ KVClient ###############################
 
+class _FinishedPull(object):
+    """A pull handle whose data has already been pulled."""
+    def __init__(self, data):
+        self._data = data
+
+    def done(self):
+        """Return True."""
+        return True
+
+    def wait(self):
+        """Return the pulled data."""
+        return self._data
+
 class KVClient(object):
     """KVClient is used to push/pull data to/from KVServer. If the
     target kvclient and kvserver are in the same machine, they can
@@ -848,6 +1005,9 @@ class KVClient(object):
         rpc.register_service(KVSTORE_PUSH,
                              PushRequest,
                              None)
+        rpc.register_service(KVSTORE_PUSH_GRAD,
+                             PushGradRequest,
+                             None)
         rpc.register_service(INIT_DATA,
                              InitDataRequest,
                              InitDataResponse)
@@ -899,6 +1059,10 @@ class KVClient(object):
         # push and pull handler
         self._pull_handlers = {}
         self._push_handlers = {}
+        # The data names whose remote rows are cached by fast-pull
+        self._cached_names = set()
+        # The gradients dropped by top-k pushes, to be pushed with the next ones
+        self._grad_residuals = {}
         # register role on server-0
         self._role = role
 
@@ -1000,6 +1164,7 @@ class KVClient(object):
             response = rpc.recv_response()
             assert response.msg == REGISTER_PULL_MSG
         self._pull_handlers[name] = func
+        self.disable_cache(name)
         self.barrier()
 
     def init_data(self, name, shape, dtype, part_policy, init_func, is_gdata=True):
@@ -1114,6 +1279,7 @@ class KVClient(object):
         del self._part_policy[name]
         del self._pull_handlers[name]
         del self._push_handlers[name]
+        self.disable_cache(name)
         self.barrier()
 
     def map_shared_data(self, partition_book):
@@ -1239,6 +1405,8 @@ class KVClient(object):
         assert F.ndim(id_tensor) == 1, 'ID must be a vector.'
         assert F.shape(id_tensor)[0] == F.shape(data_tensor)[0], \
         'The data must has the same row size with ID.'
+        if name in self._cached_names:
+            rpc.invalidate_feature_cache(name, id_tensor)
         # partition data
         machine_id = self._part_policy[name].to_partid(id_tensor)
         # sort index by machine id
@@ -1268,6 +1436,73 @@ class KVClient(object):
         if local_id is not None: # local push
             self._push_handlers[name](self._data_store, name, local_id, local_data)
 
+    def push_gradients(self, name, id_tensor, grad_tensor, compression=None, topk_ratio=0.1):
+        """Push the gradients of the rows of a tensor to KVServer.
+
+        The gradients of the duplicate IDs are summed before they are sent. A
+        server sums the gradients of the same rows pushed by all the clients
+        before it applies the push handler of the tensor, e.g. the update of a
+        sparse optimizer, once to every row. The gradients of the rows of the
+        local partition are sent to the local servers too, so that they are
+        summed with the others.
+
+        Note that, the push_gradients() is an non-blocking operation that will
+        return immediately.
+
+        Parameters
+        ----------
+        name : str
+            data name
+        id_tensor : tensor
+            a vector storing the global data ID
+        grad_tensor : tensor
+            a float32 tensor with the same row size of data ID
+        compression : str, optional
+            ``'fp16'`` sends the gradients as float16. ``'topk'`` only sends the
+            ``topk_ratio`` rows of the largest L2 norms, the other rows being
+            added to the next push of the tensor. Default: None.
+        topk_ratio : float, optional
+            The ratio of the rows sent by ``'topk'``. Default: 0.1.
+        """
+        assert len(name) > 0, 'name cannot be empty.'
+        assert compression in (None, 'fp16', 'topk'), \
+            'compression (%s) can only be None, \'fp16\' or \'topk\'.' % compression
+        id_tensor = utils.toindex(id_tensor)
+        id_tensor = id_tensor.tousertensor()
+        assert F.ndim(id_tensor) == 1, 'ID must be a vector.'
+        assert F.shape(id_tensor)[0] == F.shape(grad_tensor)[0], \
+        'The data must has the same row size with ID.'
+        grad_tensor = F.copy_to(grad_tensor, F.cpu())
+        if compression == 'topk' and name in self._grad_residuals:
+            res_id, res_grad = self._grad_residuals.pop(name)
+            id_tensor = F.cat([id_tensor, res_id], 0)
+            grad_tensor = F.cat([grad_tensor, res_grad], 0)
+        id_tensor, grad_tensor = coalesce_rows(id_tensor, grad_tensor)
+        if compression == 'topk':
+            num_rows = F.shape(id_tensor)[0]
+            k = min(num_rows, max(1, int(np.ceil(num_rows * topk_ratio))))
+            if k < num_rows:
+                norm = F.sum(F.reshape(grad_tensor * grad_tensor, (num_rows, -1)), 1)
+                keep = np.zeros((num_rows,), dtype=np.bool_)
+                keep[F.asnumpy(F.argtopk(norm, k, 0))] = True
+                drop = F.tensor(np.nonzero(~keep)[0])
+                self._grad_residuals[name] = (F.gather_row(id_tensor, drop),
+                                              F.gather_row(grad_tensor, drop))
+                keep = F.tensor(np.nonzero(keep)[0])
+                id_tensor = F.gather_row(id_tensor, keep)
+                grad_tensor = F.gather_row(grad_tensor, keep)
+        elif compression == 'fp16':
+            grad_tensor = F.astype(grad_tensor, F.float16)
+        if name in self._cached_names:
+            rpc.invalidate_feature_cache(name, id_tensor)
+        # partition data
+        machine_id = F.asnumpy(self._part_policy[name].to_partid(id_tensor))
+        for machine_idx in np.unique(machine_id):
+            index = F.tensor(np.nonzero(machine_id == machine_idx)[0])
+            request = PushGradRequest(name, F.gather_row(id_tensor, index),
+                                      F.gather_row(grad_tensor, index))
+            rpc.send_request_to_machine(int(machine_idx), request)
+
     def pull(self, name, id_tensor):
         """Pull message from KVServer.
 
@@ -1338,6 +1573,110 @@ class KVClient(object):
             data_tensor = F.cat(seq=[response.data_tensor for response in response_list], dim=0)
             return data_tensor[back_sorted_id] # return data with original index order
 
+    def pull_async(self, name, id_tensor):
+        """Start to pull message from KVServer, without waiting for it.
+
+        With the default pull handler, the requests are sent before returning
+        and the data arrives in the background, so the pull of the next
+        minibatch can be issued before the current one is used. Otherwise,
+        the data is pulled by :func:`pull` right away.
+
+        Parameters
+        ----------
+        name : str
+            data name
+        id_tensor : tensor
+            a vector storing the ID list
+
+        Returns
+        -------
+        handle
+            an object whose ``wait()`` returns the data tensor of :func:`pull`.
+        """
+        assert len(name) > 0, 'name cannot be empty.'
+        if self._pull_handlers[name] is not default_pull_handler:
+            return _FinishedPull(self.pull(name, id_tensor))
+        id_tensor = utils.toindex(id_tensor)
+        id_tensor = id_tensor.tousertensor()
+        assert F.ndim(id_tensor) == 1, 'ID must be a vector.'
+        part_id = self._part_policy[name].to_partid(id_tensor)
+        return rpc.fast_pull_async(name, id_tensor, part_id, KVSTORE_PULL,
+                                   self._machine_count,
+                                   self._group_count,
+                                   self._machine_id,
+                                   self._client_id,
+                                   self._data_store[name],
+                                   self._part_policy[name])
+
+    def enable_cache(self, name, budget, admit_threshold=2, hot_ids=None):
+        """Cache the rows pulled from remote machines.
+
+        The cache holds at most ``budget`` bytes of rows in CPU memory and is
+        looked up by :func:`pull` before sending the requests. A pulled row is
+        cached once its ID has missed ``admit_threshold`` times recently,
+        evicting a row not used lately if the cache is full. The rows of
+        ``hot_ids``, e.g. the nodes of highest degree, are pulled and cached
+        right away, and never evicted.
+
+        The rows pushed by this client are dropped from the cache, but the
+        rows pushed by other clients are not, so the cache suits the data
+        that is read-only during training, e.g. the input features.
+
+        Parameters
+        ----------
+        name : str
+            data name
+        budget : int
+            size of all the cached rows in bytes
+        admit_threshold : int
+            number of misses of an ID before its row is cached, or 0 to only
+            cache the rows of ``hot_ids``
+        hot_ids : tensor, optional
+            the IDs whose rows are always cached
+        """
+        assert name in self._data_name_list, 'data name: %s not exists.' % name
+        assert self._pull_handlers[name] is default_pull_handler, \
+        'Only the data pulled by the default pull handler can be cached.'
+        rpc.enable_feature_cache(name, self._data_store[name], budget, admit_threshold)
+        self._cached_names.add(name)
+        if hot_ids is not None:
+            hot_ids = utils.toindex(hot_ids).tousertensor()
+            part_id = self._part_policy[name].to_partid(hot_ids)
+            # the local rows are never cached
+            hot_ids = F.boolean_mask(hot_ids, part_id != self._machine_id)
+            if F.shape(hot_ids)[0] > 0:
+                rpc.pin_feature_cache(name, hot_ids, self.pull(name, hot_ids))
+
+    def disable_cache(self, name):
+        """Drop the cache of the rows of a data name, if any.
+
+        Parameters
+        ----------
+        name : str
+            data name
+        """
+        if name in self._cached_names:
+            rpc.disable_feature_cache(name)
+            self._cached_names.remove(name)
+
+    def cache_stats(self, name):
+        """Get the counters of the cache of a data name.
+
+        Parameters
+        ----------
+        name : str
+            data name
+
+        Returns
+        -------
+        dict
+            the number of ``hits`` and ``misses`` of the remote IDs pulled
+            since the cache is enabled, their ``hit_rate``, and the
+            ``num_rows`` and ``capacity`` of the cache.
+        """
+        assert name in self._cached_names, 'data name: %s is not cached.' % name
+        return rpc.feature_cache_stats(name)
+
     def _take_id(self, elem):
         """Used by sort response list
         """
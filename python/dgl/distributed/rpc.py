@@ -2,6 +2,7 @@
 server and clients."""
 import os
 import abc
+import json
 import pickle
 import random
 import numpy as np
@@ -16,12 +17,15 @@ __all__ = ['set_rank', 'get_rank', 'Request', 'Response', 'register_service', \
 'receiver_wait', 'add_receiver_addr', 'sender_connect', 'read_ip_config', \
 'get_num_machines', 'set_num_machines', 'get_machine_id', 'set_machine_id', \
 'send_request', 'recv_request', 'send_response', 'recv_response', 'remote_call', \
-'send_request_to_machine', 'remote_call_to_machine', 'fast_pull', \
-'get_num_client', 'set_num_client', 'client_barrier', 'copy_data_to_shared_memory']
+'send_request_to_machine', 'remote_call_to_machine', 'fast_pull', 'fast_pull_async', \
+'get_num_client', 'set_num_client', 'client_barrier', 'copy_data_to_shared_memory', \
+'get_rpc_stats', 'reset_rpc_stats', 'start_rpc_stats_dump', 'stop_rpc_stats_dump', \
+'set_service_priority']
 
 REQUEST_CLASS_TO_SERVICE_ID = {}
 RESPONSE_CLASS_TO_SERVICE_ID = {}
 SERVICE_ID_TO_PROPERTY = {}
+SERVICE_ID_TO_PRIORITY = {}
 
 DEFUALT_PORT = 30050
 
@@ -127,6 +131,8 @@ def create_receiver(max_queue_size, net_type):
     """
     max_thread_count = int(os.getenv('DGL_SOCKET_MAX_THREAD_COUNT', '0'))
     _CAPI_DGLRPCCreateReceiver(int(max_queue_size), net_type, max_thread_count)
+    for service_id, priority in SERVICE_ID_TO_PRIORITY.items():
+        _CAPI_DGLRPCSetServicePriority(int(service_id), int(priority))
 
 def finalize_sender():
     """Finalize rpc sender of this process.
@@ -259,6 +265,12 @@ def get_num_client():
     """
     return _CAPI_DGLRPCGetNumClient()
 
+def get_num_queued():
+    """Get the number of the received messages not taken by recv_request()
+    or recv_response() yet.
+    """
+    return _CAPI_DGLRPCGetNumQueued()
+
 def set_num_server_per_machine(num_server):
     """Set the total number of server per machine
     """
@@ -299,7 +311,7 @@ def set_msg_seq(msg_seq):
     """
     _CAPI_DGLRPCSetMsgSeq(int(msg_seq))
 
-def register_service(service_id, req_cls, res_cls=None):
+def register_service(service_id, req_cls, res_cls=None, priority=None):
     """Register a service to RPC.
 
     Parameter
@@ -310,11 +322,35 @@ def register_service(service_id, req_cls, res_cls=None):
         Request class.
     res_cls : class, optional
         Response class. If none, the service has no response.
+    priority : int, optional
+        The priority of the messages of the service, see
+        :func:`set_service_priority`. If none, the priority is left unchanged.
     """
     REQUEST_CLASS_TO_SERVICE_ID[req_cls] = service_id
     if res_cls is not None:
         RESPONSE_CLASS_TO_SERVICE_ID[res_cls] = service_id
     SERVICE_ID_TO_PROPERTY[service_id] = (req_cls, res_cls)
+    if priority is not None:
+        set_service_priority(service_id, priority)
+
+def set_service_priority(service_id, priority):
+    """Set the priority of the messages of a service.
+
+    The received messages are taken by priority, highest first, and in the order
+    of arrival within a priority, so that e.g. the sampling requests wait less
+    behind large pulls. A message is taken anyway once 16 messages of higher
+    priorities in a row have been taken before it. All the services have the
+    priority 0 by default.
+
+    Parameter
+    ---------
+    service_id : int
+        Service ID.
+    priority : int
+        The priority.
+    """
+    SERVICE_ID_TO_PRIORITY[service_id] = priority
+    _CAPI_DGLRPCSetServicePriority(int(service_id), int(priority))
 
 def get_service_property(service_id):
     """Get service property.
@@ -940,6 +976,30 @@ def finalize_server():
     finalize_receiver()
     print("Server (%d) shutdown." % get_rank())
 
+def _fast_pull_args(name, id_tensor, part_id, service_id,
+                    machine_count, group_count, machine_id,
+                    client_id, local_data, policy):
+    """Arguments of the fast-pull C APIs."""
+    msg_seq = incr_msg_seq()
+    pickle_data = _pull_request_payload(name)
+    global_id = _CAPI_DGLRPCGetGlobalIDFromLocalPartition(F.zerocopy_to_dgl_ndarray(id_tensor),
+                                                          F.zerocopy_to_dgl_ndarray(part_id),
+                                                          machine_id)
+    global_id = F.zerocopy_from_dgl_ndarray(global_id)
+    g2l_id = policy.to_local(global_id)
+    return (name,
+            int(machine_id),
+            int(machine_count),
+            int(group_count),
+            int(client_id),
+            int(service_id),
+            int(msg_seq),
+            pickle_data,
+            F.zerocopy_to_dgl_ndarray(id_tensor),
+            F.zerocopy_to_dgl_ndarray(part_id),
+            F.zerocopy_to_dgl_ndarray(g2l_id),
+            F.zerocopy_to_dgl_ndarray(local_data))
+
 def fast_pull(name, id_tensor, part_id, service_id,
               machine_count, group_count, machine_id,
               client_id, local_data, policy):
@@ -968,27 +1028,245 @@ def fast_pull(name, id_tensor, part_id, service_id,
     policy : PartitionPolicy
         store the partition information
     """
-    msg_seq = incr_msg_seq()
-    pickle_data = bytearray(pickle.dumps(([0], [name])))
-    global_id = _CAPI_DGLRPCGetGlobalIDFromLocalPartition(F.zerocopy_to_dgl_ndarray(id_tensor),
-                                                          F.zerocopy_to_dgl_ndarray(part_id),
-                                                          machine_id)
-    global_id = F.zerocopy_from_dgl_ndarray(global_id)
-    g2l_id = policy.to_local(global_id)
-    res_tensor = _CAPI_DGLRPCFastPull(name,
-                                      int(machine_id),
-                                      int(machine_count),
-                                      int(group_count),
-                                      int(client_id),
-                                      int(service_id),
-                                      int(msg_seq),
-                                      pickle_data,
-                                      F.zerocopy_to_dgl_ndarray(id_tensor),
-                                      F.zerocopy_to_dgl_ndarray(part_id),
-                                      F.zerocopy_to_dgl_ndarray(g2l_id),
-                                      F.zerocopy_to_dgl_ndarray(local_data))
+    res_tensor = _CAPI_DGLRPCFastPull(*_fast_pull_args(name, id_tensor, part_id, service_id,
+                                                       machine_count, group_count, machine_id,
+                                                       client_id, local_data, policy))
     return F.zerocopy_from_dgl_ndarray(res_tensor)
 
+@register_object('rpc.FastPull')
+class FastPull(ObjectBase):
+    """Handle of a fast pull in flight, returned by :func:`fast_pull_async`.
+
+    The local rows are copied in the background, and the rows of each remote
+    machine are copied as soon as its response is received, by :func:`wait`
+    or by any other receive of this client.
+    """
+
+    def done(self):
+        """Return whether all the remote responses have been received."""
+        return bool(_CAPI_DGLRPCFastPullDone(self))
+
+    def wait(self):
+        """Wait for the pull to finish.
+
+        Returns
+        -------
+        tensor
+            The pulled data, in the order of the requested IDs.
+        """
+        return F.zerocopy_from_dgl_ndarray(_CAPI_DGLRPCFastPullWait(self))
+
+def fast_pull_async(name, id_tensor, part_id, service_id,
+                    machine_count, group_count, machine_id,
+                    client_id, local_data, policy):
+    """Non-blocking version of :func:`fast_pull`.
+
+    The pull requests are sent before returning, so that several pulls, e.g.
+    of the next minibatch, can be in flight at the same time.
+
+    Parameters
+    ----------
+    The same as :func:`fast_pull`.
+
+    Returns
+    -------
+    FastPull
+        The handle of the pull.
+    """
+    return _CAPI_DGLRPCFastPullAsync(*_fast_pull_args(name, id_tensor, part_id, service_id,
+                                                      machine_count, group_count, machine_id,
+                                                      client_id, local_data, policy))
+
+def enable_feature_cache(name, local_data, budget, admit_threshold):
+    """Cache the remote rows of a tensor pulled by :func:`fast_pull`.
+
+    Parameters
+    ----------
+    name : str
+        data name
+    local_data : tensor
+        local data tensor, whose rows have the size of the cached ones
+    budget : int
+        size of all the cached rows in bytes
+    admit_threshold : int
+        number of misses of an ID before its row is cached, or 0 to only
+        cache the rows given to :func:`pin_feature_cache`
+    """
+    _CAPI_DGLRPCEnableFeatureCache(name, F.zerocopy_to_dgl_ndarray(local_data),
+                                   int(budget), int(admit_threshold))
+
+def disable_feature_cache(name):
+    """Drop the cache of a tensor, if any."""
+    _CAPI_DGLRPCDisableFeatureCache(name)
+
+def pin_feature_cache(name, id_tensor, data):
+    """Cache rows of a tensor that are never evicted.
+
+    Returns
+    -------
+    int
+        The number of cached rows, less than the number of IDs once the cache
+        is full.
+    """
+    return _CAPI_DGLRPCFeatureCachePin(name,
+                                       F.zerocopy_to_dgl_ndarray(id_tensor),
+                                       F.zerocopy_to_dgl_ndarray(data))
+
+def invalidate_feature_cache(name, id_tensor):
+    """Drop the cached rows of some IDs of a tensor."""
+    _CAPI_DGLRPCFeatureCacheInvalidate(name, F.zerocopy_to_dgl_ndarray(id_tensor))
+
+def feature_cache_stats(name):
+    """Get the counters of the cache of a tensor.
+
+    Returns
+    -------
+    dict
+        The number of ``hits`` and ``misses`` of the remote IDs, their
+        ``hit_rate``, and the ``num_rows`` and ``capacity`` of the cache.
+    """
+    stats = _CAPI_DGLRPCFeatureCacheStats(name).asnumpy()
+    hits, misses, num_rows, capacity = [int(x) for x in stats]
+    return {'hits': hits,
+            'misses': misses,
+            'hit_rate': hits / (hits + misses) if hits + misses > 0 else 0.,
+            'num_rows': num_rows,
+            'capacity': capacity}
+
+def register_native_pull(service_id, name, server_id, data, offset):
+    """Serve the pull requests of a tensor in C++, without entering Python.
+
+    Parameters
+    ----------
+    service_id : int
+        service_id of pull request
+    name : str
+        data name
+    server_id : int
+        ID of current server, sent in the responses
+    data : tensor
+        local data tensor, in CPU memory
+    offset : int
+        the global ID of the first row of the local data
+    """
+    _CAPI_DGLRPCRegisterNativePull(int(service_id),
+                                   _pull_request_payload(name),
+                                   bytearray(pickle.dumps(([0], [server_id]))),
+                                   F.zerocopy_to_dgl_ndarray(data),
+                                   int(offset))
+
+def unregister_native_pull(name):
+    """Serve the pull requests of a tensor in Python again.
+
+    Parameters
+    ----------
+    name : str
+        data name
+    """
+    _CAPI_DGLRPCUnregisterNativePull(_pull_request_payload(name))
+
+def register_native_sampling(service_id, request, response, g, nid, eid, node_offset,
+                             window_us):
+    """Serve the neighbor sampling requests of the same fanout, direction and
+    replacement as a request in C++, in batches.
+
+    The requests received within ``window_us`` microseconds of each other are
+    sampled at once over the seed nodes of all of them, and the sampled edges
+    are split back into a response per request.
+
+    Parameters
+    ----------
+    service_id : int
+        service_id of sampling request
+    request : Request
+        A sampling request of the fanout, direction and replacement served, with
+        the seed nodes as its only tensor.
+    response : Response
+        A response of the sampled source nodes, destination nodes and edges, as
+        its only tensors.
+    g : DGLGraph
+        The graph of the local partition, homogeneous and on CPU.
+    nid : tensor
+        The global IDs of the local nodes, in int64.
+    eid : tensor
+        The global IDs of the local edges, in int64.
+    node_offset : int
+        The global ID of the first node of the partition.
+    window_us : int
+        The time the server waits for more requests after the first one of a batch.
+    """
+    fan_out, edge_dir, replace = request.fan_out, request.edge_dir, request.replace
+    _CAPI_DGLRPCRegisterNativeSampling(int(service_id),
+                                       serialize_to_payload(request)[0],
+                                       serialize_to_payload(response)[0],
+                                       g._graph,
+                                       F.zerocopy_to_dgl_ndarray(nid),
+                                       F.zerocopy_to_dgl_ndarray(eid),
+                                       int(node_offset), int(fan_out), edge_dir == 'in',
+                                       bool(replace), int(window_us))
+
+def unregister_native_sampling(request):
+    """Serve the neighbor sampling requests like a request in Python again.
+
+    Parameters
+    ----------
+    request : Request
+        A sampling request of the fanout, direction and replacement served.
+    """
+    _CAPI_DGLRPCUnregisterNativeSampling(serialize_to_payload(request)[0])
+
+def _pull_request_payload(name):
+    """The payload of the pull requests of a tensor, the same for fast and regular pulls."""
+    return bytearray(pickle.dumps(([0], [name])))
+
+def get_rpc_stats():
+    """Get the counters and latencies of the RPC messages of this process.
+
+    Returns
+    -------
+    dict
+        The ``rank`` and wall-clock ``time`` of the snapshot, and:
+
+        * ``services``: by service ID, the number and bytes of the messages
+          sent and received, the ``request_latency_us`` from sending a request
+          to receiving its response, and the ``serve_latency_us`` from
+          receiving a request to sending its response;
+        * ``peers``: by the ID of the other process, the number and bytes of
+          the messages sent to and received from it;
+        * ``recv_blocked_us``: the time spent waiting in each receive;
+        * ``recv_queue_depth``: the ``last`` and ``max`` number of received
+          messages waiting to be taken.
+
+        Latencies are histograms in microseconds, with their ``count``,
+        ``sum``, ``max``, approximate ``p50``, ``p90`` and ``p99``, and the
+        ``buckets`` of power-of-two bounds: bucket ``b > 0`` counts the
+        latencies in ``[2^(b-1), 2^b)``.
+    """
+    return json.loads(_CAPI_DGLRPCGetStats())
+
+def reset_rpc_stats():
+    """Drop the RPC stats collected so far."""
+    _CAPI_DGLRPCResetStats()
+
+def start_rpc_stats_dump(path, interval=10.):
+    """Append the RPC stats to a file periodically, in a background thread.
+
+    Each line of the file is the JSON of a :func:`get_rpc_stats` snapshot.
+    Every process should dump to its own file.
+
+    Parameters
+    ----------
+    path : str
+        path of the file
+    interval : float
+        seconds between the snapshots
+    """
+    _CAPI_DGLRPCStartStatsDump(path, float(interval))
+
+def stop_rpc_stats_dump():
+    """Stop dumping the RPC stats, after a last snapshot."""
+    _CAPI_DGLRPCStopStatsDump()
+
 def register_sig_handler():
     """Register for handling signal event.
     """
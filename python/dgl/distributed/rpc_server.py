@@ -99,3 +99,7 @@ def start_server(server_id, ip_config, num_servers, num_clients, server_state, \
                 break # break the loop and exit server
             else:
                 rpc.send_response(client_id, res)
+        # the gradients pushed together are summed until the server is idle
+        kv_store = getattr(server_state, 'kv_store', None)
+        if kv_store is not None and rpc.get_num_queued() == 0:
+            kv_store.flush_gradients()
@@ -78,6 +78,13 @@ class KVClient(object):
         else:
             F.scatter_row_inplace(self._data[name], id_tensor, data_tensor)
 
+    def push_gradients(self, name, id_tensor, grad_tensor, compression=None, topk_ratio=0.1):
+        '''push the sum of the gradients of every row to kvstore'''
+        # pylint: disable=unused-argument
+        uniq_id, inverse = F.unique(id_tensor, return_inverse=True)
+        grad_tensor = F.scatter_add(grad_tensor, inverse, F.shape(uniq_id)[0])
+        self.push(name, uniq_id, grad_tensor)
+
     def pull(self, name, id_tensor):
         '''pull data from kvstore'''
         if name in self._pull_handlers:
@@ -307,7 +307,6 @@ class DGLHeteroGraph(object):
         assert num > 0, 'Number of new nodes should be larger than one.'
         ntid = self.get_ntype_id(ntype)
         # update graph idx
-        metagraph = self._graph.metagraph
         num_nodes_per_type = []
         for c_ntype in self.ntypes:
             if self.get_ntype_id(c_ntype) == ntid:
@@ -315,27 +314,13 @@ class DGLHeteroGraph(object):
             else:
                 num_nodes_per_type.append(self.number_of_nodes(c_ntype))
 
-        relation_graphs = []
-        for c_etype in self.canonical_etypes:
-            # src or dst == ntype, update the relation graph
-            if self.get_ntype_id(c_etype[0]) == ntid or self.get_ntype_id(c_etype[2]) == ntid:
-                u, v = self.edges(form='uv', order='eid', etype=c_etype)
-                hgidx = heterograph_index.create_unitgraph_from_coo(
-                    1 if c_etype[0] == c_etype[2] else 2,
-                    self.number_of_nodes(c_etype[0]) + \
-                        (num if self.get_ntype_id(c_etype[0]) == ntid else 0),
-                    self.number_of_nodes(c_etype[2]) + \
-                        (num if self.get_ntype_id(c_etype[2]) == ntid else 0),
-                    u,
-                    v,
-                    ['coo', 'csr', 'csc'])
-                relation_graphs.append(hgidx)
-            else:
-                # do nothing
-                relation_graphs.append(self._graph.get_relation_graph(self.get_etype_id(c_etype)))
-        hgidx = heterograph_index.create_heterograph_from_relations(
-            metagraph, relation_graphs, utils.toindex(num_nodes_per_type, "int64"))
-        self._graph = hgidx
+        # The relation graphs of the node type are padded with the new nodes in all
+        # their formats, so that they need not be created again.
+        empty = F.to_dgl_nd(F.copy_to(F.tensor([], self.idtype), self.device))
+        num_etypes = len(self.canonical_etypes)
+        self._graph = _CAPI_DGLAddEdges(
+            self._graph, [empty] * num_etypes, [empty] * num_etypes,
+            utils.toindex(num_nodes_per_type, "int64").todgltensor())
 
         # update data frames
         if data is None:
@@ -498,36 +483,22 @@ class DGLHeteroGraph(object):
             if v_max > num_of_v:
                 self.add_nodes(v_max - num_of_v, ntype=v_type)
 
-        # metagraph is not changed
-        metagraph = self._graph.metagraph
         num_nodes_per_type = []
         for ntype in self.ntypes:
             num_nodes_per_type.append(self.number_of_nodes(ntype))
-        # update graph idx
-        relation_graphs = []
-        for c_etype in self.canonical_etypes:
-            # the target edge type
-            if c_etype == (u_type, e_type, v_type):
-                old_u, old_v = self.edges(form='uv', order='eid', etype=c_etype)
-                hgidx = heterograph_index.create_unitgraph_from_coo(
-                    1 if u_type == v_type else 2,
-                    self.number_of_nodes(u_type),
-                    self.number_of_nodes(v_type),
-                    F.cat([old_u, u], dim=0),
-                    F.cat([old_v, v], dim=0),
-                    ['coo', 'csr', 'csc'])
-                relation_graphs.append(hgidx)
-            else:
-                # do nothing
-                # Note: node range change has been handled in add_nodes()
-                relation_graphs.append(self._graph.get_relation_graph(self.get_etype_id(c_etype)))
-
-        hgidx = heterograph_index.create_heterograph_from_relations(
-            metagraph, relation_graphs, utils.toindex(num_nodes_per_type, "int64"))
-        self._graph = hgidx
+        # The new edges are merged into all the formats of the relation graph, so
+        # that they need not be created again.
+        # Note: node range change has been handled in add_nodes()
+        etid = self.get_etype_id((u_type, e_type, v_type))
+        empty = F.to_dgl_nd(F.copy_to(F.tensor([], self.idtype), self.device))
+        src = [F.to_dgl_nd(u) if i == etid else empty
+               for i in range(len(self.canonical_etypes))]
+        dst = [F.to_dgl_nd(v) if i == etid else empty
+               for i in range(len(self.canonical_etypes))]
+        self._graph = _CAPI_DGLAddEdges(
+            self._graph, src, dst, utils.toindex(num_nodes_per_type, "int64").todgltensor())
 
         # handle data
-        etid = self.get_etype_id(etype)
         if data is None:
             self._edge_frames[etid].add_rows(len(u))
         else:
@@ -624,16 +595,17 @@ class DGLHeteroGraph(object):
             'The input eid {} is out of the range [0:{})'.format(
                 F.as_scalar(F.max(eids, dim=0)), self.number_of_edges(etype))
 
-        # edge_subgraph
-        edges = {}
+        # The edges are removed from all the formats of the relation graph, so that
+        # they need not be created again.
         u_type, e_type, v_type = self.to_canonical_etype(etype)
-        for c_etype in self.canonical_etypes:
-            # the target edge type
-            if c_etype == (u_type, e_type, v_type):
-                origin_eids = self.edges(form='eid', order='eid', etype=c_etype)
-                edges[c_etype] = utils.compensate(eids, origin_eids)
-            else:
-                edges[c_etype] = self.edges(form='eid', order='eid', etype=c_etype)
+        etid = self.get_etype_id((u_type, e_type, v_type))
+        empty = F.copy_to(F.tensor([], self.idtype), self.device)
+        remove_eids = [F.to_dgl_nd(eids if i == etid else empty)
+                       for i in range(len(self.canonical_etypes))]
+        new_graph, induced_eids = _CAPI_DGLRemoveEdges(self._graph, remove_eids)
+        edges = [F.from_dgl_nd(induced) if i == etid else
+                 self.edges(form='eid', order='eid', etype=c_etype)
+                 for i, c_etype in enumerate(self.canonical_etypes)]
 
         # If the graph is batched, update batch_num_edges
         batched = self._batch_num_edges is not None
@@ -648,10 +620,8 @@ class DGLHeteroGraph(object):
             self._batch_num_edges[c_etype] = c_etype_batch_num_edges - \
                                              F.astype(batch_num_removed_edges, F.int64)
 
-        sub_g = self.edge_subgraph(edges, relabel_nodes=False, store_ids=store_ids)
-        self._graph = sub_g._graph
-        self._node_frames = sub_g._node_frames
-        self._edge_frames = sub_g._edge_frames
+        self._edge_frames = utils.extract_edge_subframes(self, edges, store_ids)
+        self._graph = new_graph
 
     def remove_nodes(self, nids, ntype=None, store_ids=False):
         r"""Remove multiple nodes with the specified node type
@@ -5458,6 +5428,71 @@ class DGLHeteroGraph(object):
         """
         return self.to(F.cpu())
 
+    def pin_memory_(self, device=None, cache_indptr=False):
+        """Pin the graph structure in place in host memory, so that the GPU samples
+        it without copying it to the GPU, e.g. when it does not fit there.
+
+        :func:`dgl.sampling.sample_neighbors` then samples the pinned graph with
+        the GPU of the seed nodes, which reads the neighbors over PCIe. Only the
+        created formats are pinned, so create the formats to sample from first,
+        e.g. with :func:`create_formats_`. The node and edge features are not
+        pinned.
+
+        Parameters
+        ----------
+        device : Framework-specific device context object, optional
+            The GPU that samples the graph, where the row pointers are cached.
+            Default: the first GPU.
+        cache_indptr : bool, optional
+            Whether to also copy the row pointers of the CSR and CSC formats to the
+            GPU, where the sampler reads them, so that only the neighbors are read
+            over PCIe. They take ``8 * (number of nodes)`` bytes per format for
+            int64 graphs. Default: False.
+
+        Returns
+        -------
+        DGLGraph
+            The graph itself.
+
+        Examples
+        --------
+
+        >>> g = dgl.graph((torch.tensor([0, 1, 2]), torch.tensor([1, 2, 0])))
+        >>> g.create_formats_()
+        >>> g.pin_memory_(cache_indptr=True)
+        >>> g.is_pinned()
+        True
+        >>> sg = dgl.sampling.sample_neighbors(g, torch.tensor([0, 1]).cuda(), 1)
+        >>> sg.device
+        device(type='cuda', index=0)
+        """
+        if self.device != F.cpu():
+            raise DGLError('Only the graphs on the CPU can be pinned.')
+        device_id = 0 if device is None else utils.to_dgl_context(device).device_id
+        self._graph.pin_memory_(device_id, cache_indptr)
+        return self
+
+    def unpin_memory_(self):
+        """Unpin the graph structure pinned by :func:`pin_memory_`.
+
+        Returns
+        -------
+        DGLGraph
+            The graph itself.
+        """
+        self._graph.unpin_memory_()
+        return self
+
+    def is_pinned(self):
+        """Return whether the graph structure is pinned in host memory, i.e. all
+        its created formats.
+
+        Returns
+        -------
+        bool
+        """
+        return self._graph.is_pinned()
+
     def clone(self):
         """Return a heterograph object that is a clone of current graph.
 
@@ -5756,6 +5791,52 @@ class DGLHeteroGraph(object):
         """
         return self._graph.create_formats_()
 
+    def set_format_memory_budget_(self, budget):
+        r"""Limit the memory taken by the sparse matrices of the graph.
+
+        The sparse matrices are still created when necessary. Whenever creating
+        one makes the sparse matrices of an edge type take more than ``budget``
+        bytes, the least recently used other ones are dropped until they fit or
+        only the new one is left. A dropped matrix is created again from the
+        remaining ones when it is needed.
+
+        The budget applies to every edge type separately and is not kept by the
+        graphs derived from this one.
+
+        Parameters
+        ----------
+        budget : int
+            The memory budget in bytes of the sparse matrices of every edge type.
+            A negative value, the default, means no limit.
+
+        Examples
+        --------
+
+        >>> g = dgl.graph(([0, 0, 1], [2, 3, 2]))
+        >>> g.set_format_memory_budget_(0)
+        >>> g.create_formats_()
+        >>> g.formats()
+        {'created': ['csc'], 'not created': ['coo', 'csr']}
+        >>> g.in_degrees()
+        tensor([0, 0, 2, 1])
+        >>> g.formats()
+        {'created': ['csc'], 'not created': ['coo', 'csr']}
+        """
+        self._graph.set_format_memory_budget_(budget)
+
+    def format_memory_usage(self):
+        r"""Return the total size in bytes of the created sparse matrices of the
+        graph.
+
+        Examples
+        --------
+
+        >>> g = dgl.graph(([0, 0, 1], [2, 3, 2]))
+        >>> g.format_memory_usage()
+        48
+        """
+        return self._graph.format_memory_usage()
+
     def astype(self, idtype):
         """Cast this graph to use another ID type.
 
@@ -5810,6 +5891,70 @@ class DGLHeteroGraph(object):
         gidx = self._graph.shared_memory(name, self.ntypes, self.etypes, formats)
         return DGLHeteroGraph(gidx, self.ntypes, self.etypes)
 
+    def cuda_shared_memory(self, name, formats=('coo', 'csr', 'csc')):
+        """Return a copy of this graph on a GPU, shared by CUDA IPC with the other
+        processes using the GPU, without node data or edge data.
+
+        The other processes open it with :func:`dgl.hetero_from_cuda_shared_memory`
+        instead of copying the graph to the GPU each, e.g. a sampler process and
+        the trainer processes of the GPU. The returned graph must stay alive as
+        long as the graphs opened by the other processes are used.
+
+        Parameters
+        ----------
+        name : str
+            The name of the shared memory publishing the graph.
+        formats : str or a list of str (optional)
+            Desired formats to be materialized.
+
+        Returns
+        -------
+        HeteroGraph
+            The graph in the shared buffer on the GPU
+
+        Examples
+        --------
+
+        >>> g_shared = g.to('cuda').cuda_shared_memory('g')
+        >>> # in another process using the same GPU
+        >>> g = dgl.hetero_from_cuda_shared_memory('g')
+        """
+        assert len(name) > 0, "The name of shared memory cannot be empty"
+        assert len(formats) > 0
+        if isinstance(formats, str):
+            formats = [formats]
+        for fmt in formats:
+            assert fmt in ("coo", "csr", "csc"), '{} is not coo, csr or csc'.format(fmt)
+        if F.device_type(self.device) != 'cuda':
+            raise DGLError('The graph must be on a GPU to be shared by CUDA IPC.')
+        gidx = self._graph.cuda_shared_memory(name, self.ntypes, self.etypes, formats)
+        return DGLHeteroGraph(gidx, self.ntypes, self.etypes)
+
+    def publish_formats_(self):
+        """Share the sparse formats of a graph in shared memory with all the
+        processes attached to it.
+
+        The formats created by this process, e.g. lazily by an operator, that
+        the shared memory lacks are copied into it, and the formats published
+        by the other processes replace the ones this process lacks. The update
+        is in place.
+
+        The graph must be returned by :func:`shared_memory` or
+        :func:`dgl.hetero_from_shared_memory`.
+
+        Examples
+        --------
+
+        >>> g = dgl.graph(([0, 0, 1], [2, 3, 2])).shared_memory('g', formats='coo')
+        >>> g.create_formats_()  # CSR and CSC are created in this process only
+        >>> dgl.hetero_from_shared_memory('g').formats()
+        {'created': ['coo'], 'not created': ['csr', 'csc']}
+        >>> g.publish_formats_()
+        >>> dgl.hetero_from_shared_memory('g').formats()
+        {'created': ['coo', 'csr', 'csc'], 'not created': []}
+        """
+        self._graph = self._graph.sync_shared_memory_formats()
+
 
     def long(self):
         """Cast the graph to one with idtype int64
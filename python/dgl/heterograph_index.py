@@ -234,6 +234,32 @@ class HeteroGraphIndex(ObjectBase):
         """
         return _CAPI_DGLHeteroCopyTo(self, ctx.device_type, ctx.device_id)
 
+    def pin_memory_(self, device_id, cache_indptr=False):
+        """Pin the structure of this graph in place for the given GPU.
+
+        Parameters
+        ----------
+        device_id : int
+            The ID of the GPU.
+        cache_indptr : bool
+            Whether to also copy the row pointers of the CSR and CSC formats to
+            the GPU.
+        """
+        _CAPI_DGLHeteroPinMemory_(self, int(device_id), cache_indptr)
+
+    def unpin_memory_(self):
+        """Unpin the structure of this graph pinned by :func:`pin_memory_`."""
+        _CAPI_DGLHeteroUnpinMemory_(self)
+
+    def is_pinned(self):
+        """Whether the structure of this graph is pinned in host memory.
+
+        Returns
+        -------
+        bool
+        """
+        return bool(_CAPI_DGLHeteroIsPinned(self))
+
     def shared_memory(self, name, ntypes=None, etypes=None, formats=('coo', 'csr', 'csc')):
         """Return a copy of this graph in shared memory
 
@@ -261,6 +287,46 @@ class HeteroGraphIndex(ObjectBase):
         etypes = [] if etypes is None else etypes
         return _CAPI_DGLHeteroCopyToSharedMem(self, name, ntypes, etypes, formats)
 
+    def sync_shared_memory_formats(self):
+        """Publish the formats created in this graph to its shared memory, and
+        return a copy of this graph using all the formats published there.
+
+        Returns
+        -------
+        HeteroGraphIndex
+            The graph index in shared memory
+        """
+        return _CAPI_DGLHeteroSyncSharedMemFormats(self)
+
+    def cuda_shared_memory(self, name, ntypes=None, etypes=None,
+                           formats=('coo', 'csr', 'csc')):
+        """Return a copy of this graph index in a buffer on its GPU, shared by CUDA IPC
+        with the other processes using the GPU.
+
+        Parameters
+        ----------
+        name : str
+            The name of the shared memory publishing the IPC handle of the buffer.
+        ntypes : list of str
+            Name of node types
+        etypes : list of str
+            Name of edge types
+        format : list of str
+            Desired formats to be materialized.
+
+        Returns
+        -------
+        HeteroGraphIndex
+            The graph index in the shared buffer
+        """
+        assert len(name) > 0, "The name of shared memory cannot be empty"
+        assert len(formats) > 0
+        for fmt in formats:
+            assert fmt in ("coo", "csr", "csc")
+        ntypes = [] if ntypes is None else ntypes
+        etypes = [] if etypes is None else etypes
+        return _CAPI_DGLHeteroCopyToCUDAIpc(self, name, ntypes, etypes, formats)
+
     def is_multigraph(self):
         """Return whether the graph is a multigraph
         The time cost will be O(E)
@@ -974,6 +1040,15 @@ class HeteroGraphIndex(ObjectBase):
         """Create all sparse matrices allowed for the graph."""
         return _CAPI_DGLHeteroCreateFormat(self)
 
+    def set_format_memory_budget_(self, budget):
+        """Set the memory budget in bytes of the sparse matrices of every relation
+        graph, negative for no limit."""
+        _CAPI_DGLHeteroSetFormatMemoryBudget(self, int(budget))
+
+    def format_memory_usage(self):
+        """Return the total size in bytes of the created sparse matrices."""
+        return _CAPI_DGLHeteroGetFormatMemoryUsage(self)
+
     def reverse(self):
         """Reverse the heterogeneous graph adjacency
 
@@ -1071,7 +1146,7 @@ def create_metagraph_index(ntypes, canonical_etypes):
     return metagraph, ntypes, etypes, relations
 
 def create_unitgraph_from_coo(num_ntypes, num_src, num_dst, row, col,
-                              formats, row_sorted=False, col_sorted=False):
+                              formats, row_sorted=False, col_sorted=False, trusted=False):
     """Create a unitgraph graph index from COO format
 
     Parameters
@@ -1093,6 +1168,9 @@ def create_unitgraph_from_coo(num_ntypes, num_src, num_dst, row, col,
     col_sorted : bool, optional
         Whether or not the columns of the COO are in ascending order within
         each row. This only has an effect when ``row_sorted`` is True.
+    trusted : bool, optional
+        Whether ``row_sorted`` and ``col_sorted`` are exact, so that an unsorted
+        COO is not scanned for sorted rows when converted to CSR.
 
     Returns
     -------
@@ -1103,10 +1181,10 @@ def create_unitgraph_from_coo(num_ntypes, num_src, num_dst, row, col,
     return _CAPI_DGLHeteroCreateUnitGraphFromCOO(
         int(num_ntypes), int(num_src), int(num_dst),
         F.to_dgl_nd(row), F.to_dgl_nd(col),
-        formats, row_sorted, col_sorted)
+        formats, row_sorted, col_sorted, trusted)
 
 def create_unitgraph_from_csr(num_ntypes, num_src, num_dst, indptr, indices, edge_ids,
-                              formats, transpose=False):
+                              formats, transpose=False, sorted=False):
     """Create a unitgraph graph index from CSR format
 
     Parameters
@@ -1127,17 +1205,20 @@ def create_unitgraph_from_csr(num_ntypes, num_src, num_dst, indptr, indices, edg
         Restrict the storage formats allowed for the unit graph.
     transpose : bool, optional
         If True, treats the input matrix as CSC.
+    sorted : bool, optional
+        Whether the indices are in ascending order within every row.
 
     Returns
     -------
     HeteroGraphIndex
     """
+    # pylint: disable=redefined-builtin
     if isinstance(formats, str):
         formats = [formats]
     return _CAPI_DGLHeteroCreateUnitGraphFromCSR(
         int(num_ntypes), int(num_src), int(num_dst),
         F.to_dgl_nd(indptr), F.to_dgl_nd(indices), F.to_dgl_nd(edge_ids),
-        formats, transpose)
+        formats, transpose, sorted)
 
 def create_heterograph_from_relations(metagraph, rel_graphs, num_nodes_per_type):
     """Create a heterograph from metagraph and graphs of every relation.
@@ -1180,6 +1261,25 @@ def create_heterograph_from_shared_memory(name):
     g, ntypes, etypes = _CAPI_DGLHeteroCreateFromSharedMem(name)
     return g, list(ntypes), list(etypes)
 
+def create_heterograph_from_cuda_shared_memory(name):
+    """Open a heterograph shared by CUDA IPC by another process with the given name.
+
+    Paramaters
+    ----------
+    name : str
+        The name of the share memory
+
+    Returns
+    -------
+    HeteroGraphIndex (on the GPU of the other process)
+    ntypes : list of str
+        Names of node types
+    etypes : list of str
+        Names of edge types
+    """
+    g, ntypes, etypes = _CAPI_DGLHeteroCreateFromCUDAIpc(name)
+    return g, list(ntypes), list(etypes)
+
 def joint_union(metagraph, gidx_list):
     """Return a joint union of the input heterographs.
 
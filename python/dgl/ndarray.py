@@ -139,6 +139,45 @@ def exist_shared_mem_array(name):
     """
     return _CAPI_DGLExistSharedMemArray(name)
 
+def empty_pinned(shape, dtype, ctx):
+    """Create an empty CPU array in page-locked memory, which the copies from
+    and to the GPU run on asynchronously.
+
+    The memory comes from a pool keeping the freed blocks up to
+    ``DGL_CUDA_PINNED_CACHE_BYTES`` bytes, 1 GB by default.
+
+    Parameters
+    ----------
+    shape : tuple of int
+        The shape of the array.
+    dtype : str
+        The data type of the array.
+    ctx : DGLContext
+        The GPU to pin the memory for.
+
+    Returns
+    -------
+    NDArray
+        The array on the CPU.
+    """
+    return _CAPI_DGLArrayEmptyPinned(ctx, dtype, *shape)
+
+def is_pinned(arr):
+    """Check whether the data of a CPU array is in page-locked memory, e.g.
+    allocated by :func:`empty_pinned` or pinned by ``NDArray.pin_memory_``.
+
+    Parameters
+    ----------
+    arr : NDArray
+        The array.
+
+    Returns
+    -------
+    bool
+        Whether the data is page-locked.
+    """
+    return bool(_CAPI_DGLArrayIsPinned(arr))
+
 class SparseFormat:
     """Format code"""
     ANY = 0
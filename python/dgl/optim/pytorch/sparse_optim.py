@@ -7,6 +7,16 @@ from ...utils import get_shared_mem_array, create_shared_mem_array
 from ...nn.pytorch import NodeEmbedding
 from ...cuda import nccl
 from ...partition import NDArrayPartition
+from ...sparse import _sparse_adagrad_update, _sparse_adam_update
+
+def _can_update_in_place(grad, tensors):
+    ''' Whether the C++ kernels can update the tensors from the gradients in place,
+    i.e. the tensors are contiguous, of the type of the gradients, and on their device
+    or in pinned memory for gradients on GPU.
+    '''
+    return all(t.is_contiguous() and t.dtype == grad.dtype and
+               (t.device == grad.device or (grad.is_cuda and t.is_pinned()))
+               for t in tensors)
 
 class SparseGradOptimizer(abc.ABC):
     r''' The abstract sparse optimizer.
@@ -471,6 +481,13 @@ class SparseAdagrad(SparseGradOptimizer):
         eps = self._eps
         clr = self._lr
 
+        if _can_update_in_place(grad, (emb.weight, emb.optm_state)):
+            # the gradients of the duplicate indices are averaged in C++
+            with th.no_grad():
+                _sparse_adagrad_update(emb.weight, emb.optm_state, idx.to(grad.device),
+                                       grad.contiguous(), clr, eps)
+            return
+
         # the update is non-linear so indices must be unique
         grad_indices, inverse, cnt = th.unique(idx, return_inverse=True, return_counts=True)
         grad_values = th.zeros((grad_indices.shape[0], grad.shape[1]), device=grad.device)
@@ -619,6 +636,12 @@ class SparseAdam(SparseGradOptimizer):
 
             clr = self._lr
             state_step, state_mem, state_power = emb.optm_state
+            if _can_update_in_place(grad, (emb.weight, state_step, state_mem, state_power)):
+                # the gradients of the duplicate indices are averaged in C++
+                _sparse_adam_update(emb.weight, state_step, state_mem, state_power,
+                                    idx.to(grad.device), grad.contiguous(),
+                                    clr, beta1, beta2, eps)
+                return
             exec_dev = grad.device
             state_dev = state_step.device
 
@@ -11,7 +11,8 @@ from .base import EID, NID, NTYPE, ETYPE
 from .subgraph import edge_subgraph
 
 __all__ = ["metis_partition", "metis_partition_assignment",
-           "partition_graph_with_halo"]
+           "partition_graph_with_halo", "streaming_partition_assignment",
+           "StreamingPartitioner"]
 
 
 def reorder_nodes(g, new_node_ids):
@@ -231,48 +232,9 @@ def partition_graph_with_halo(g, node_part, extra_cached_hops, reshuffle=False):
         return subg_dict, None, None
 
 
-def metis_partition_assignment(g, k, balance_ntypes=None, balance_edges=False, mode="k-way"):
-    ''' This assigns nodes to different partitions with Metis partitioning algorithm.
-
-    When performing Metis partitioning, we can put some constraint on the partitioning.
-    Current, it supports two constrants to balance the partitioning. By default, Metis
-    always tries to balance the number of nodes in each partition.
-
-    * `balance_ntypes` balances the number of nodes of different types in each partition.
-    * `balance_edges` balances the number of edges in each partition.
-
-    To balance the node types, a user needs to pass a vector of N elements to indicate
-    the type of each node. N is the number of nodes in the input graph.
-
-    After the partition assignment, we construct partitions.
-
-    Parameters
-    ----------
-    g : DGLGraph
-        The graph to be partitioned
-    k : int
-        The number of partitions.
-    balance_ntypes : tensor
-        Node type of each node
-    balance_edges : bool
-        Indicate whether to balance the edges.
-    mode : str, "k-way" or "recursive"
-        Whether use multilevel recursive bisection or multilevel k-way paritioning.
-
-    Returns
-    -------
-    a 1-D tensor
-        A vector with each element that indicates the partition ID of a vertex.
-    '''
-    assert mode in ("k-way", "recursive"), "'mode' can only be 'k-way' or 'recursive'"
-    assert g.idtype == F.int64, "IdType of graph is required to be int64 for now."
-    # METIS works only on symmetric graphs.
-    # The METIS runs on the symmetric graph to generate the node assignment to partitions.
-    start = time.time()
-    sym_gidx = _CAPI_DGLMakeSymmetric_Hetero(g._graph)
-    sym_g = DGLHeteroGraph(gidx=sym_gidx)
-    print('Convert a graph into a bidirected graph: {:.3f} seconds'.format(
-        time.time() - start))
+def _get_vertex_weights(g, balance_ntypes, balance_edges):
+    """Return the vertex weights balancing the node types and edges, as a vector
+    of N * w elements following Metis, each node having w weights."""
     vwgt = []
     # To balance the node types in each partition, we can take advantage of the vertex weights
     # in Metis. When vertex weights are provided, Metis will tries to generate partitions with
@@ -315,6 +277,52 @@ def metis_partition_assignment(g, k, balance_ntypes=None, balance_edges=False, m
     else:
         vwgt = F.zeros((0,), F.int64, F.cpu())
         vwgt = F.to_dgl_nd(vwgt)
+    return vwgt
+
+
+def metis_partition_assignment(g, k, balance_ntypes=None, balance_edges=False, mode="k-way"):
+    ''' This assigns nodes to different partitions with Metis partitioning algorithm.
+
+    When performing Metis partitioning, we can put some constraint on the partitioning.
+    Current, it supports two constrants to balance the partitioning. By default, Metis
+    always tries to balance the number of nodes in each partition.
+
+    * `balance_ntypes` balances the number of nodes of different types in each partition.
+    * `balance_edges` balances the number of edges in each partition.
+
+    To balance the node types, a user needs to pass a vector of N elements to indicate
+    the type of each node. N is the number of nodes in the input graph.
+
+    After the partition assignment, we construct partitions.
+
+    Parameters
+    ----------
+    g : DGLGraph
+        The graph to be partitioned
+    k : int
+        The number of partitions.
+    balance_ntypes : tensor
+        Node type of each node
+    balance_edges : bool
+        Indicate whether to balance the edges.
+    mode : str, "k-way" or "recursive"
+        Whether use multilevel recursive bisection or multilevel k-way paritioning.
+
+    Returns
+    -------
+    a 1-D tensor
+        A vector with each element that indicates the partition ID of a vertex.
+    '''
+    assert mode in ("k-way", "recursive"), "'mode' can only be 'k-way' or 'recursive'"
+    assert g.idtype == F.int64, "IdType of graph is required to be int64 for now."
+    # METIS works only on symmetric graphs.
+    # The METIS runs on the symmetric graph to generate the node assignment to partitions.
+    start = time.time()
+    sym_gidx = _CAPI_DGLMakeSymmetric_Hetero(g._graph)
+    sym_g = DGLHeteroGraph(gidx=sym_gidx)
+    print('Convert a graph into a bidirected graph: {:.3f} seconds'.format(
+        time.time() - start))
+    vwgt = _get_vertex_weights(g, balance_ntypes, balance_edges)
 
     start = time.time()
     node_part = _CAPI_DGLMetisPartition_Hetero(sym_g._graph, k, vwgt, mode)
@@ -326,6 +334,127 @@ def metis_partition_assignment(g, k, balance_ntypes=None, balance_edges=False, m
         return node_part.tousertensor()
 
 
+class StreamingPartitioner(object):
+    ''' Assign the nodes of a graph to partitions from its edges given by chunks,
+    without holding all of them in memory, with the LDG or Fennel streaming
+    heuristics.
+
+    The edges are taken as undirected. The nodes of a chunk not assigned yet are
+    assigned, in increasing order, to the partition holding most of their
+    neighbors assigned so far, with a penalty on the load of the partition, and
+    no partition is loaded more than ``imbalance`` times the average. The memory
+    used is bounded by the number of nodes and the size of a chunk; the neighbors
+    are counted with multiple threads, with the same result for any number.
+
+    Parameters
+    ----------
+    num_nodes : int
+        The number of nodes.
+    k : int
+        The number of partitions.
+    algorithm : str, "ldg" or "fennel", optional
+        The heuristic. Default: "fennel".
+    vwgt : Tensor, optional
+        The weights of the nodes to balance, ``num_nodes * w`` of them in int64,
+        with the ``w`` weights of every node next to each other, like the vertex
+        weights of Metis. Default: every node weighs 1.
+    imbalance : float, optional
+        The largest load of a partition over the average load. Default: 1.05.
+    batch_size : int, optional
+        The number of nodes whose neighbors are counted in parallel before they
+        are assigned. Default: 4096.
+
+    Examples
+    --------
+    >>> partitioner = dgl.partition.StreamingPartitioner(4, 2)
+    >>> partitioner.add_edges(torch.tensor([0, 1]), torch.tensor([1, 2]))
+    >>> partitioner.add_edges(torch.tensor([2]), torch.tensor([3]))
+    >>> node_part = partitioner.finish()
+    '''
+    def __init__(self, num_nodes, k, algorithm="fennel", vwgt=None, imbalance=1.05,
+                 batch_size=4096):
+        assert algorithm in ("ldg", "fennel"), "'algorithm' can only be 'ldg' or 'fennel'"
+        if vwgt is None:
+            vwgt = F.zeros((0,), F.int64, F.cpu())
+        if F.is_tensor(vwgt):
+            vwgt = F.to_dgl_nd(F.reshape(vwgt, (-1,)))
+        self._partitioner = _CAPI_DGLStreamingPartitionerCreate(
+            int(num_nodes), int(k), algorithm, vwgt, float(imbalance), int(batch_size))
+
+    def add_edges(self, u, v):
+        """Assign the nodes of the edges from the nodes ``u`` to the nodes ``v``
+        not assigned yet.
+
+        Parameters
+        ----------
+        u : Tensor
+            The source nodes.
+        v : Tensor
+            The destination nodes.
+        """
+        _CAPI_DGLStreamingPartitionerAddEdges(
+            self._partitioner, F.to_dgl_nd(F.copy_to(u, F.cpu())),
+            F.to_dgl_nd(F.copy_to(v, F.cpu())))
+
+    def finish(self):
+        """Assign the nodes without edges, and return the partition of every node.
+
+        Returns
+        -------
+        a 1-D tensor
+            A vector with each element that indicates the partition ID of a vertex.
+        """
+        return F.from_dgl_nd(_CAPI_DGLStreamingPartitionerFinish(self._partitioner))
+
+
+def streaming_partition_assignment(g, k, algorithm="fennel", balance_ntypes=None,
+                                   balance_edges=False, imbalance=1.05,
+                                   chunk_size=1 << 24):
+    ''' This assigns nodes to different partitions with the LDG or Fennel streaming
+    heuristics, going through the edges by chunks.
+
+    Unlike :func:`metis_partition_assignment`, this does not build the symmetric
+    graph, and uses memory bounded by the number of nodes and the size of a
+    chunk apart from the graph, at the cost of more edge cuts. It takes the same
+    balancing constraints; see :class:`StreamingPartitioner` for graphs too large
+    to be loaded at once.
+
+    Parameters
+    ----------
+    g : DGLGraph
+        The graph to be partitioned
+    k : int
+        The number of partitions.
+    algorithm : str, "ldg" or "fennel", optional
+        The heuristic. Default: "fennel".
+    balance_ntypes : tensor
+        Node type of each node
+    balance_edges : bool
+        Indicate whether to balance the edges.
+    imbalance : float, optional
+        The largest load of a partition over the average load. Default: 1.05.
+    chunk_size : int, optional
+        The number of edges per chunk.
+
+    Returns
+    -------
+    a 1-D tensor
+        A vector with each element that indicates the partition ID of a vertex.
+    '''
+    vwgt = _get_vertex_weights(g, balance_ntypes, balance_edges)
+    start = time.time()
+    partitioner = StreamingPartitioner(g.number_of_nodes(), k, algorithm, vwgt, imbalance)
+    num_edges = g.number_of_edges()
+    for chunk_start in range(0, num_edges, chunk_size):
+        eids = F.arange(chunk_start, min(chunk_start + chunk_size, num_edges),
+                        g.idtype, g.device)
+        u, v = g.find_edges(eids)
+        partitioner.add_edges(u, v)
+    node_part = partitioner.finish()
+    print('Streaming partitioning: {:.3f} seconds'.format(time.time() - start))
+    return node_part
+
+
 def metis_partition(g, k, extra_cached_hops=0, reshuffle=False,
                     balance_ntypes=None, balance_edges=False, mode="k-way"):
     ''' This is to partition a graph with Metis partitioning.
@@ -398,11 +527,12 @@ class NDArrayPartition(object):
         The number of parts to divide the array into.
     mode : String
         The type of partition. Currently, the only valid values are
-        'remainder' and 'range'.
+        'remainder', 'range' and 'lookup'.
         'remainder' assigns rows based on remainder when dividing the row id by the
         number of parts (e.g., i % num_parts).
         'range' assigns rows based on which part of the range 'part_ranges'
         they fall into.
+        'lookup' assigns rows based on the part id of each row in 'part_map'.
     part_ranges : Tensor or dgl.NDArray, Optional
         Should only be specified when the mode is 'range'. Should be of the
         length `num_parts + 1`, and be the exclusive prefix-sum of the number
@@ -412,6 +542,11 @@ class NDArrayPartition(object):
         or equal to 'a' and less than 'b' are in partition 1, and all rows
         with index greater or equal to 'b' are in partition 2. Should have
         the same context as the partitioned NDArray (i.e., be on the same GPU).
+    part_map : Tensor or dgl.NDArray, Optional
+        Should only be specified when the mode is 'lookup'. Should be of the
+        length `array_size`, and hold the part id of each row. The rows of a
+        part are numbered within it in increasing order. Should have the same
+        context as the partitioned NDArray (i.e., be on the same GPU).
 
     Examples
     --------
@@ -433,9 +568,20 @@ class NDArrayPartition(object):
     >>>     part_range.append(part_range[-1] + part['num_nodes'])
     >>> part = NDArrayPartition(g.num_nodes(), num_parts, mode='range',
     ...                         part_ranges=part_range)
+
+    A lookup based partition of a homogenous graph `g`'s nodes, from an
+    arbitrary assignment of the nodes to parts, e.g. the one returned by
+    :func:`dgl.metis_partition_assignment`, without renumbering the nodes.
+
+    >>> node_part = dgl.metis_partition_assignment(g, num_parts)
+    >>> part = NDArrayPartition(g.num_nodes(), num_parts, mode='lookup',
+    ...                         part_map=node_part.to('cuda:0'))
     """
-    def __init__(self, array_size, num_parts, mode='remainder', part_ranges=None):
+    def __init__(self, array_size, num_parts, mode='remainder', part_ranges=None,
+                 part_map=None):
         assert num_parts > 0, 'Invalid "num_parts", must be > 0.'
+        assert mode == 'lookup' or part_map is None, 'Only when using ' \
+            'lookup-based partitioning, "part_map" should be specified.'
         if mode == 'remainder':
             assert part_ranges is None, 'When using remainder-based ' \
                 'partitioning, "part_ranges" should not be specified.'
@@ -455,6 +601,19 @@ class NDArrayPartition(object):
                 array_size,
                 num_parts,
                 part_ranges)
+        elif mode == 'lookup':
+            assert part_ranges is None, 'When using lookup-based ' \
+                'partitioning, "part_ranges" should not be specified.'
+            assert part_map is not None, 'When using lookup-based ' \
+                'partitioning, "part_map" must not be None.'
+            if F.is_tensor(part_map):
+                part_map = F.zerocopy_to_dgl_ndarray(part_map)
+            assert isinstance(part_map, NDArray), '"part_map" must ' \
+                'be Tensor or dgl.NDArray.'
+            self._partition = _CAPI_DGLNDArrayPartitionCreateLookupBased(
+                array_size,
+                num_parts,
+                part_map)
         else:
             assert False, 'Unknown partition mode "{}"'.format(mode)
         self._array_size = array_size
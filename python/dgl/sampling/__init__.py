@@ -8,4 +8,6 @@ gives a holistic explanation on how different components work together.
 from .randomwalks import *
 from .pinsage import *
 from .neighbor import *
+from .layer import *
 from .node2vec_randomwalk import *
+from .negative import *
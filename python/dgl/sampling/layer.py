@@ -0,0 +1,113 @@
+"""Layer-wise importance sampling APIs"""
+
+from .._ffi.function import _init_api
+from .. import backend as F
+from ..base import DGLError, EID, NID
+from ..heterograph import DGLBlock
+from .. import ndarray as nd
+from .. import utils
+
+__all__ = ['sample_layer_blocks']
+
+def sample_layer_blocks(g, seed_nodes, num_samples, weight=None, importance='ladies',
+                        replace=False, out_weight='w', copy_ndata=True, copy_edata=True):
+    """Sample a fixed number of input nodes for every layer of a GNN computing the
+    outputs of the given nodes, and return the blocks of the layers.
+
+    This implements the layer-wise samplers of
+    `FastGCN <https://arxiv.org/abs/1801.10247>`__ and
+    `LADIES <https://arxiv.org/abs/1911.07323>`__. Going from the last layer to the
+    first, the candidates of a layer are the in-neighbors of its output nodes,
+    :attr:`num_samples` of them are drawn from the importance distribution, and the
+    block keeps the in-edges of the output nodes coming from the drawn nodes. The
+    output nodes of a block are also among its input nodes.
+
+    Parameters
+    ----------
+    g : DGLGraph
+        The graph. Must be on CPU, with a single node type and edge type.
+    seed_nodes : tensor
+        The output nodes of the last layer.
+    num_samples : list[int]
+        The number of nodes drawn for every layer, from the first layer to the last.
+    weight : str, optional
+        Feature name of the edge weights, e.g. the normalized adjacency matrix. The
+        feature must have only one element for each edge. Every edge has a weight of
+        one if not given.
+    importance : str, optional
+        The importance distribution of the candidates. Can be either
+
+        * ``ladies``, where a candidate is drawn with a probability proportional to the
+          sum of the squared weights of its edges to the output nodes of the layer, or
+        * ``fastgcn``, where a candidate is drawn with a probability proportional to the
+          sum of the squared weights of all its out-edges.
+    replace : bool, optional
+        If True, draw the nodes with replacement.
+    out_weight : str, optional
+        The name of the edge feature of the blocks storing the edge weights divided by
+        the importance of their source node, and normalized to sum to one over the
+        in-edges of every output node.
+    copy_ndata : bool, optional
+        If True, the node features of the graph are copied to the blocks.
+    copy_edata : bool, optional
+        If True, the edge features of the graph are copied to the blocks.
+
+    Returns
+    -------
+    list[DGLBlock]
+        The blocks, from the first layer to the last. The original node and edge IDs
+        are stored as the ``dgl.NID`` and ``dgl.EID`` features.
+
+    Examples
+    --------
+    >>> g = dgl.graph(([1, 2, 3, 4, 2, 3], [0, 0, 0, 0, 1, 1]))
+    >>> blocks = dgl.sampling.sample_layer_blocks(g, torch.tensor([0, 1]), [2, 2])
+    >>> blocks[1].dstdata[dgl.NID]
+    tensor([0, 1])
+    >>> blocks[1].srcdata[dgl.NID]
+    tensor([0, 1, 2, 3])
+    >>> blocks[1].edata['w']
+    tensor([0.5000, 0.5000, 0.5000, 0.5000])
+    """
+    if g.device != F.cpu():
+        raise DGLError('sample_layer_blocks only supports CPU graphs.')
+    if len(g.ntypes) > 1 or len(g.etypes) > 1:
+        raise DGLError('sample_layer_blocks only supports graphs with a single '
+                       'node type and edge type.')
+    if importance not in ('ladies', 'fastgcn'):
+        raise DGLError('Invalid importance. Must be "ladies" or "fastgcn".')
+    seed_nodes = utils.prepare_tensor(g, seed_nodes, 'seed_nodes')
+    num_samples_array = F.to_dgl_nd(F.tensor(num_samples, dtype=F.int64))
+    if weight is None:
+        weight_array = nd.array([], ctx=nd.cpu())
+    else:
+        weight_array = F.to_dgl_nd(g.edata[weight])
+
+    block_idxs, src_nodes_nd, induced_edges_nd, edge_weights_nd = _CAPI_DGLSampleLayerBlocks(
+        g._graph, F.to_dgl_nd(seed_nodes), num_samples_array, weight_array, importance,
+        replace)
+
+    blocks = []
+    for block_idx, src_nodes, induced_edges, edge_weights in zip(
+            block_idxs, src_nodes_nd, induced_edges_nd, edge_weights_nd):
+        block = DGLBlock(block_idx, (g.ntypes, g.ntypes), g.etypes)
+        src_node_ids = F.from_dgl_nd(src_nodes)
+        dst_node_ids = src_node_ids[:block.number_of_dst_nodes()]
+        edge_ids = F.from_dgl_nd(induced_edges)
+        if copy_ndata:
+            node_frames = utils.extract_node_subframes_for_block(
+                g, [src_node_ids], [dst_node_ids])
+            utils.set_new_frames(block, node_frames=node_frames)
+        else:
+            block.srcdata[NID] = src_node_ids
+            block.dstdata[NID] = dst_node_ids
+        if copy_edata:
+            edge_frames = utils.extract_edge_subframes(g, [edge_ids])
+            utils.set_new_frames(block, edge_frames=edge_frames)
+        else:
+            block.edata[EID] = edge_ids
+        block.edata[out_weight] = F.from_dgl_nd(edge_weights)
+        blocks.append(block)
+    return blocks
+
+_init_api('dgl.sampling.layer', __name__)
@@ -0,0 +1,99 @@
+"""Negative sampling APIs"""
+
+from .._ffi.function import _init_api
+from .. import backend as F
+from ..base import DGLError
+from .. import ndarray as nd
+from .. import utils
+
+__all__ = ['corrupt_edges']
+
+def corrupt_edges(g, eids, k, *, corrupt='tail', prob=None, exclude_existing=False,
+                  num_trials=10):
+    """Make negative examples for link prediction by corrupting one end of the
+    given edges, for every edge type at once.
+
+    Every edge ``(u, v)`` gives :attr:`k` negative edges of the same type, ``(u, v')``
+    when corrupting the tails and ``(u', v)`` when corrupting the heads, the
+    corrupted end being drawn from all the nodes of its type, uniformly or in
+    proportion to :attr:`prob`.
+
+    The sampling runs in C++ on the device of the graph, in parallel on CPU.
+
+    Parameters
+    ----------
+    g : DGLGraph
+        The graph.
+    eids : Tensor or dict[etype, Tensor]
+        The IDs of the edges to corrupt.
+    k : int
+        The number of negative edges of every edge.
+    corrupt : str, optional
+        ``'tail'`` to corrupt the destination nodes, or ``'head'`` to corrupt the
+        source nodes.
+    prob : Tensor or dict[etype, Tensor], optional
+        The unnormalized probabilities of the nodes of the corrupted type of every
+        edge type, on the device of the graph, e.g. the degrees to the power 0.75.
+        The nodes are drawn uniformly if not given.
+    exclude_existing : bool, optional
+        If True, a negative edge existing in the graph is drawn again, up to
+        :attr:`num_trials` draws, looking it up in the CSR (or CSC when corrupting
+        the heads) matrix of its edge type, and dropped if it still exists after
+        that.
+    num_trials : int, optional
+        The number of draws of a negative edge with :attr:`exclude_existing`.
+
+    Returns
+    -------
+    tuple[Tensor, Tensor] or dict[etype, tuple[Tensor, Tensor]]
+        The source and destination nodes of the negative edges, in the order of the
+        given edges, in the form of :attr:`eids`.
+
+    Examples
+    --------
+    >>> g = dgl.graph(([0, 1, 2], [1, 2, 3]))
+    >>> dgl.sampling.corrupt_edges(g, torch.tensor([0, 1]), 2)
+    (tensor([0, 0, 1, 1]), tensor([3, 0, 1, 0]))
+
+    Corrupt the heads by degree and never return an existing edge.
+
+    >>> prob = g.out_degrees().float() ** 0.75
+    >>> dgl.sampling.corrupt_edges(
+    ...     g, torch.tensor([0, 1]), 2, corrupt='head', prob=prob, exclude_existing=True)
+    (tensor([2, 1, 0, 0]), tensor([1, 1, 2, 2]))
+    """
+    if corrupt not in ('head', 'tail'):
+        raise DGLError('Invalid corrupt {}, must be "head" or "tail".'.format(corrupt))
+    is_mapping = isinstance(eids, dict)
+    if not is_mapping:
+        if len(g.canonical_etypes) > 1:
+            raise DGLError('Must specify edge type when the graph is not homogeneous.')
+        eids = {g.canonical_etypes[0]: eids}
+        prob = {g.canonical_etypes[0]: prob} if prob is not None else None
+    eids = {g.to_canonical_etype(etype): v for etype, v in eids.items()}
+    eids = utils.prepare_tensor_dict(g, eids, 'eids')
+    if prob is not None:
+        prob = {g.to_canonical_etype(etype): v for etype, v in prob.items()}
+
+    eid_arrays = []
+    prob_arrays = []
+    for etype in g.canonical_etypes:
+        if etype in eids:
+            eid_arrays.append(F.to_dgl_nd(eids[etype]))
+        else:
+            eid_arrays.append(nd.array([], ctx=nd.cpu()))
+        if prob is not None and etype in prob:
+            prob_arrays.append(F.to_dgl_nd(prob[etype]))
+        else:
+            prob_arrays.append(nd.array([], ctx=nd.cpu()))
+    negs = _CAPI_DGLCorruptEdges(
+        g._graph, eid_arrays, k, corrupt == 'head', prob_arrays,
+        num_trials if exclude_existing else 0)
+
+    ret = {}
+    for i, etype in enumerate(g.canonical_etypes):
+        if etype in eids:
+            ret[etype] = (F.from_dgl_nd(negs[2 * i]), F.from_dgl_nd(negs[2 * i + 1]))
+    return ret if is_mapping else ret[g.canonical_etypes[0]]
+
+_init_api('dgl.sampling.negative', __name__)
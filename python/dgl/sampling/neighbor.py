@@ -2,15 +2,19 @@
 
 from .._ffi.function import _init_api
 from .. import backend as F
-from ..base import DGLError, EID
-from ..heterograph import DGLHeteroGraph
+from ..base import DGLError, EID, NID
+from ..heterograph import DGLHeteroGraph, DGLBlock
 from .. import ndarray as nd
 from .. import utils
 
 __all__ = [
+    'build_alias_tables',
+    'build_topk_order',
+    'sample_neighbor_blocks',
     'sample_etype_neighbors',
     'sample_neighbors',
     'sample_neighbors_biased',
+    'sample_neighbors_temporal',
     'select_topk']
 
 def sample_etype_neighbors(g, nodes, etype_field, fanout, edge_dir='in', prob=None,
@@ -82,7 +86,7 @@ def sample_etype_neighbors(g, nodes, etype_field, fanout, edge_dir='in', prob=No
     -------
     DGLGraph
         A sampled subgraph containing only the sampled neighboring edges, with the
-        same device as the input graph.
+        same device as the input graph, or as the nodes for a pinned graph.
 
     Notes
     -----
@@ -90,6 +94,10 @@ def sample_etype_neighbors(g, nodes, etype_field, fanout, edge_dir='in', prob=No
     the node or edge features of the original graph and the new graph.
     As a result, users should avoid performing in-place operations
     on the node features of the new graph to avoid feature corruption.
+
+    The features of a pinned graph sampled on GPU are not copied, since they are
+    on CPU. Gather them by ``dgl.EID`` instead, e.g. from a
+    :class:`dgl.contrib.UnifiedTensor`.
     """
     if g.device != F.cpu():
         raise DGLError("The graph should be in cpu.")
@@ -129,8 +137,9 @@ def sample_etype_neighbors(g, nodes, etype_field, fanout, edge_dir='in', prob=No
     # (TODO) (BarclayII) DGL distributed fails with bus error, freezes, or other
     # incomprehensible errors with lazy feature copy.
     # So in distributed training context, we fall back to old behavior where we
-    # only set the edge IDs.
-    if not _dist_training:
+    # only set the edge IDs. The same for a pinned graph sampled on GPU, whose
+    # features are on CPU.
+    if not _dist_training and ret.device == g.device:
         if copy_ndata:
             node_frames = utils.extract_node_subframes(g, None)
             utils.set_new_frames(ret, node_frames=node_frames)
@@ -145,7 +154,8 @@ def sample_etype_neighbors(g, nodes, etype_field, fanout, edge_dir='in', prob=No
     return ret
 
 def sample_neighbors(g, nodes, fanout, edge_dir='in', prob=None, replace=False,
-                     copy_ndata=True, copy_edata=True, _dist_training=False, exclude_edges=None):
+                     copy_ndata=True, copy_edata=True, _dist_training=False, exclude_edges=None,
+                     random_seed=None, mask=None):
     """Sample neighboring edges of the given nodes and return the induced subgraph.
 
     For each node, a number of inbound (or outbound when ``edge_dir == 'out'``) edges
@@ -158,10 +168,14 @@ def sample_neighbors(g, nodes, fanout, edge_dir='in', prob=None, replace=False,
     Parameters
     ----------
     g : DGLGraph
-        The graph.  Can be either on CPU or GPU.
+        The graph.  Can be either on CPU or GPU, or pinned by
+        :func:`DGLGraph.pin_memory_`.
     nodes : tensor or dict
         Node IDs to sample neighbors from.
 
+        If the graph is pinned and the nodes are on GPU, the GPU samples the graph
+        in host memory, uniformly, without masks or excluded edges.
+
         This argument can take a single ID tensor or a dictionary of node types and ID tensors.
         If a single tensor is given, the graph must only have one type of nodes.
     fanout : int or dict[etype, int]
@@ -186,7 +200,9 @@ def sample_neighbors(g, nodes, fanout, edge_dir='in', prob=None, replace=False,
         inbound/outbound edges for every node must be positive (though they don't have
         to sum up to one).  Otherwise, the result will be undefined.
 
-        If :attr:`prob` is not None, GPU sampling is not supported.
+        If the alias tables of :attr:`prob` for :attr:`edge_dir` were stored by
+        :func:`build_alias_tables`, sampling a node costs O(fanout) instead of
+        O(number of neighbors).
     exclude_edges: tensor or dict
         Edge IDs to exclude during sampling neighbors for the seed nodes.
 
@@ -210,6 +226,26 @@ def sample_neighbors(g, nodes, fanout, edge_dir='in', prob=None, replace=False,
         Internal argument.  Do not use.
 
         (Default: False)
+    random_seed : int, optional
+        If given, the edges of every node are sampled from this seed, so that the edges
+        sampled for a node of an edge type only depend on :attr:`random_seed`, the edge
+        type and the node ID on CPU, whatever the number of threads and the other nodes
+        sampled.  The nodes are sampled in parallel as without a seed.  Deriving the seed
+        from a global seed and the index of the minibatch makes the training reproducible.
+
+        On GPU, the same seed and nodes give the same edges, which differ from the CPU ones.
+
+        If omitted, the sampling draws from the random number generator of DGL, which can
+        be seeded with :func:`dgl.seed`, but the result then depends on the number of
+        threads on CPU.
+    mask : str, optional
+        Feature name of a boolean or 8-bit integer mask of the edges.  The feature must
+        have only one element for each edge.
+
+        Only the edges whose mask is nonzero are sampled, as if the others were not in
+        the graph, e.g. the edges of an edge type or predicate selected for the
+        minibatch.  The mask is applied by the samplers, without building a subgraph
+        first.  The edge types without the feature are sampled from all their edges.
 
     Returns
     -------
@@ -293,32 +329,8 @@ def sample_neighbors(g, nodes, fanout, edge_dir='in', prob=None, replace=False,
         else:
             nodes_all_types.append(nd.array([], ctx=nd.cpu()))
 
-    if isinstance(fanout, nd.NDArray):
-        fanout_array = fanout
-    else:
-        if not isinstance(fanout, dict):
-            fanout_array = [int(fanout)] * len(g.etypes)
-        else:
-            if len(fanout) != len(g.etypes):
-                raise DGLError('Fan-out must be specified for each edge type '
-                               'if a dict is provided.')
-            fanout_array = [None] * len(g.etypes)
-            for etype, value in fanout.items():
-                fanout_array[g.get_etype_id(etype)] = value
-        fanout_array = F.to_dgl_nd(F.tensor(fanout_array, dtype=F.int64))
-
-    if isinstance(prob, list) and len(prob) > 0 and \
-            isinstance(prob[0], nd.NDArray):
-        prob_arrays = prob
-    elif prob is None:
-        prob_arrays = [nd.array([], ctx=nd.cpu())] * len(g.etypes)
-    else:
-        prob_arrays = []
-        for etype in g.canonical_etypes:
-            if prob in g.edges[etype].data:
-                prob_arrays.append(F.to_dgl_nd(g.edges[etype].data[prob]))
-            else:
-                prob_arrays.append(nd.array([], ctx=nd.cpu()))
+    fanout_array = _prepare_fanout_array(g, fanout)
+    prob_arrays, alias_accept_arrays, alias_arrays = _prepare_prob_arrays(g, prob, edge_dir)
 
     excluded_edges_all_t = []
     if exclude_edges is not None:
@@ -333,8 +345,13 @@ def sample_neighbors(g, nodes, fanout, edge_dir='in', prob=None, replace=False,
             else:
                 excluded_edges_all_t.append(nd.array([], ctx=nd.cpu()))
 
+    mask_arrays = _prepare_mask_arrays(g, mask)
+
     subgidx = _CAPI_DGLSampleNeighbors(g._graph, nodes_all_types, fanout_array,
-                                       edge_dir, prob_arrays, excluded_edges_all_t, replace)
+                                       edge_dir, prob_arrays, excluded_edges_all_t, replace,
+                                       alias_accept_arrays, alias_arrays,
+                                       -1 if random_seed is None else random_seed,
+                                       mask_arrays)
     induced_edges = subgidx.induced_edges
     ret = DGLHeteroGraph(subgidx.graph, g.ntypes, g.etypes)
 
@@ -357,6 +374,407 @@ def sample_neighbors(g, nodes, fanout, edge_dir='in', prob=None, replace=False,
 
     return ret
 
+def _prepare_fanout_array(g, fanout):
+    """Return the fanout of every edge type as an int64 NDArray."""
+    if isinstance(fanout, nd.NDArray):
+        return fanout
+    if not isinstance(fanout, dict):
+        fanout_array = [int(fanout)] * len(g.etypes)
+    else:
+        if len(fanout) != len(g.etypes):
+            raise DGLError('Fan-out must be specified for each edge type '
+                           'if a dict is provided.')
+        fanout_array = [None] * len(g.etypes)
+        for etype, value in fanout.items():
+            fanout_array[g.get_etype_id(etype)] = value
+    return F.to_dgl_nd(F.tensor(fanout_array, dtype=F.int64))
+
+def _prepare_prob_arrays(g, prob, edge_dir):
+    """Return the probability arrays of every edge type, with the alias tables
+    stored by :func:`build_alias_tables` if any."""
+    alias_accept_arrays = []
+    alias_arrays = []
+    if isinstance(prob, list) and len(prob) > 0 and \
+            isinstance(prob[0], nd.NDArray):
+        prob_arrays = prob
+    elif prob is None:
+        prob_arrays = [nd.array([], ctx=nd.cpu())] * len(g.etypes)
+    else:
+        prob_arrays = []
+        accept_name, alias_name = _alias_table_names(prob, edge_dir)
+        for etype in g.canonical_etypes:
+            edata = g.edges[etype].data
+            if prob in edata:
+                prob_arrays.append(F.to_dgl_nd(edata[prob]))
+            else:
+                prob_arrays.append(nd.array([], ctx=nd.cpu()))
+            # the alias tables are only used on CPU
+            if prob in edata and accept_name in edata and alias_name in edata and \
+                    g.device == F.cpu():
+                alias_accept_arrays.append(F.to_dgl_nd(edata[accept_name]))
+                alias_arrays.append(F.to_dgl_nd(edata[alias_name]))
+            else:
+                alias_accept_arrays.append(nd.array([], ctx=nd.cpu()))
+                alias_arrays.append(nd.array([], ctx=nd.cpu()))
+    return prob_arrays, alias_accept_arrays, alias_arrays
+
+def _prepare_mask_arrays(g, mask):
+    """Return the 8-bit mask arrays of every edge type, empty for the edge types
+    without the mask feature."""
+    mask_arrays = []
+    for etype in g.canonical_etypes:
+        edata = g.edges[etype].data
+        if mask is not None and mask in edata:
+            mask_arrays.append(F.to_dgl_nd(F.astype(edata[mask], F.uint8)))
+        else:
+            mask_arrays.append(nd.array([], ctx=nd.cpu()))
+    return mask_arrays
+
+def sample_neighbor_blocks(g, seed_nodes, fanouts, prob=None, replace=False,
+                           copy_ndata=True, copy_edata=True, random_seed=None):
+    """Sample the inbound neighbors of the given nodes layer by layer and return
+    the blocks of a multi-layer GNN computing their outputs, in a single call.
+
+    It is equivalent to calling :func:`sample_neighbors` and :func:`dgl.to_block`
+    for every layer, from the last to the first, the input nodes of a block being
+    the seed nodes of the previous one, but all the layers are sampled and relabeled
+    in C++ without creating the intermediate frontier graphs.
+
+    Parameters
+    ----------
+    g : DGLGraph
+        The graph. Must be on CPU.
+    seed_nodes : tensor or dict[ntype, tensor]
+        The output nodes of the last layer.
+
+        If a single tensor is given, the graph must only have one type of nodes.
+    fanouts : list[int or dict[etype, int]]
+        The number of inbound edges sampled for every node on each layer, from the
+        first layer to the last, see the :attr:`fanout` argument of
+        :func:`sample_neighbors`.
+    prob : str, optional
+        Feature name used as the (unnormalized) probabilities associated with each
+        neighboring edge of a node, see :func:`sample_neighbors`. The alias tables
+        stored by :func:`build_alias_tables` for inbound edges are used if any.
+    replace : bool, optional
+        If True, sample with replacement.
+    copy_ndata : bool, optional
+        If True, the node features of the graph are copied to the blocks.
+    copy_edata : bool, optional
+        If True, the edge features of the graph are copied to the blocks.
+    random_seed : int, optional
+        If given, every layer is sampled from this seed and the layer, so that the
+        blocks do not depend on the number of threads, see :func:`sample_neighbors`.
+
+    Returns
+    -------
+    list[DGLBlock]
+        The blocks, from the first layer to the last. The original node and edge IDs
+        are stored as the ``dgl.NID`` and ``dgl.EID`` features.
+
+    Examples
+    --------
+    >>> g = dgl.graph(([0, 0, 1, 1, 2, 2], [1, 2, 0, 1, 2, 0]))
+    >>> blocks = dgl.sampling.sample_neighbor_blocks(g, torch.tensor([0]), [2, 2])
+    >>> blocks[1].dstdata[dgl.NID]
+    tensor([0])
+    >>> blocks[1].srcdata[dgl.NID]
+    tensor([0, 1, 2])
+    >>> blocks[0].dstdata[dgl.NID]
+    tensor([0, 1, 2])
+    """
+    if g.device != F.cpu():
+        raise DGLError('sample_neighbor_blocks only supports CPU graphs.')
+    if not isinstance(seed_nodes, dict):
+        if len(g.ntypes) > 1:
+            raise DGLError("Must specify node type when the graph is not homogeneous.")
+        seed_nodes = {g.ntypes[0] : seed_nodes}
+
+    seed_nodes = utils.prepare_tensor_dict(g, seed_nodes, 'nodes')
+    seeds_all_types = []
+    for ntype in g.ntypes:
+        if ntype in seed_nodes:
+            seeds_all_types.append(F.to_dgl_nd(seed_nodes[ntype]))
+        else:
+            seeds_all_types.append(F.to_dgl_nd(F.tensor([], dtype=g.idtype)))
+    fanout_arrays = [_prepare_fanout_array(g, fanout) for fanout in fanouts]
+    prob_arrays, alias_accept_arrays, alias_arrays = _prepare_prob_arrays(g, prob, 'in')
+    block_idxs, src_nodes_nd, induced_edges_nd = _CAPI_DGLSampleNeighborBlocks(
+        g._graph, seeds_all_types, fanout_arrays, prob_arrays, replace,
+        alias_accept_arrays, alias_arrays, -1 if random_seed is None else random_seed)
+    return _make_blocks(g, block_idxs, src_nodes_nd, induced_edges_nd, copy_ndata, copy_edata)
+
+def _make_blocks(g, block_idxs, src_nodes_nd, induced_edges_nd, copy_ndata, copy_edata):
+    """Wrap the blocks sampled in C++ from the graph, with their node and edge IDs."""
+    blocks = []
+    for block_idx, src_nodes, induced_edges in zip(block_idxs, src_nodes_nd, induced_edges_nd):
+        block = DGLBlock(block_idx, (g.ntypes, g.ntypes), g.etypes)
+        src_node_ids = [F.from_dgl_nd(src) for src in src_nodes]
+        dst_node_ids = [src[:block.number_of_dst_nodes(ntype)]
+                        for src, ntype in zip(src_node_ids, g.ntypes)]
+        edge_ids = [F.from_dgl_nd(eid) for eid in induced_edges]
+        if copy_ndata:
+            node_frames = utils.extract_node_subframes_for_block(g, src_node_ids, dst_node_ids)
+            utils.set_new_frames(block, node_frames=node_frames)
+        else:
+            for src, dst, ntype in zip(src_node_ids, dst_node_ids, g.ntypes):
+                block.srcnodes[ntype].data[NID] = src
+                block.dstnodes[ntype].data[NID] = dst
+        if copy_edata:
+            edge_frames = utils.extract_edge_subframes(g, edge_ids)
+            utils.set_new_frames(block, edge_frames=edge_frames)
+        else:
+            for eid, etype in zip(edge_ids, block.canonical_etypes):
+                block.edges[etype].data[EID] = eid
+        blocks.append(block)
+    return blocks
+
+def _alias_table_names(prob, edge_dir):
+    """Return the names of the edge features storing the alias tables of a
+    probability feature."""
+    return '{}_alias_accept_{}'.format(prob, edge_dir), '{}_alias_{}'.format(prob, edge_dir)
+
+def build_alias_tables(g, prob, edge_dir='in'):
+    """Precompute the alias tables used by :func:`sample_neighbors` to sample the
+    neighbors of the nodes with probabilities.
+
+    The tables of every edge type having the feature :attr:`prob` are stored as the
+    edge features ``'<prob>_alias_accept_<edge_dir>'`` and ``'<prob>_alias_<edge_dir>'``,
+    so they are shared the same way as the other edge features, e.g. through
+    shared memory. :func:`sample_neighbors` then picks them up when called with
+    the same :attr:`prob` and :attr:`edge_dir`, and samples a node in O(fanout)
+    instead of O(number of neighbors). The tables of the outbound edges also serve
+    :func:`random_walk` with the same :attr:`prob`, which then takes a step in
+    constant time.
+
+    The tables must be rebuilt whenever :attr:`prob` changes, or the sampling will
+    follow the old probabilities.
+
+    Parameters
+    ----------
+    g : DGLGraph
+        The graph. Can be either on CPU or GPU. The tables built on GPU are only
+        used by :func:`random_walk`.
+    prob : str
+        Feature name of the (unnormalized) probabilities associated with each edge,
+        see :func:`sample_neighbors`.
+    edge_dir : str, optional
+        Whether the tables are for sampling the inbound (``in``) or the outbound
+        (``out``) edges.
+
+    Examples
+    --------
+    >>> g = dgl.graph(([0, 0, 1, 1, 2, 2], [1, 2, 0, 1, 2, 0]))
+    >>> g.edata['prob'] = torch.FloatTensor([0., 1., 0., 1., 0., 1.])
+    >>> dgl.sampling.build_alias_tables(g, 'prob')
+    >>> sg = dgl.sampling.sample_neighbors(g, [0, 1], 1, prob='prob')
+    >>> sg.edges(order='eid')
+    (tensor([2, 1]), tensor([0, 1]))
+    """
+    if edge_dir not in ('in', 'out'):
+        raise DGLError('Invalid edge direction. Must be "in" or "out".')
+    accept_name, alias_name = _alias_table_names(prob, edge_dir)
+    for etype in g.canonical_etypes:
+        edata = g.edges[etype].data
+        if prob not in edata:
+            continue
+        ret = _CAPI_DGLBuildAliasTable(
+            g._graph, g.get_etype_id(etype), edge_dir, F.to_dgl_nd(edata[prob]))
+        edata[accept_name] = F.from_dgl_nd(ret(0))
+        edata[alias_name] = F.from_dgl_nd(ret(1))
+
+def _topk_order_name(weight, edge_dir, ascending):
+    """Return the name of the edge feature storing the order of the neighbors by a
+    weight feature."""
+    return '{}_topk_order_{}_{}'.format(weight, edge_dir, 'asc' if ascending else 'desc')
+
+def build_topk_order(g, weight, edge_dir='in', ascending=False):
+    """Precompute the order of the neighbors of every node by weight used by
+    :func:`select_topk`.
+
+    The order of every edge type having the feature :attr:`weight` is stored as the
+    edge feature ``'<weight>_topk_order_<edge_dir>_<asc|desc>'``, so it is shared the
+    same way as the other edge features. :func:`select_topk` then picks it up when
+    called with the same :attr:`weight`, :attr:`edge_dir` and :attr:`ascending`, and
+    selects the edges of a node in O(k) instead of O(number of neighbors).
+
+    The order must be rebuilt whenever :attr:`weight` changes, or the selection will
+    follow the old weights.
+
+    Parameters
+    ----------
+    g : DGLGraph
+        The graph. Must be on CPU.
+    weight : str
+        Feature name of the weights associated with each edge, see :func:`select_topk`.
+    edge_dir : str, optional
+        Whether the order is for selecting the inbound (``in``) or the outbound
+        (``out``) edges.
+    ascending : bool, optional
+        Whether the order is for selecting the edges with the k-smallest weights
+        instead of the k-largest ones.
+
+    Examples
+    --------
+    >>> g = dgl.graph(([0, 0, 1, 1, 2, 2], [1, 2, 0, 1, 2, 0]))
+    >>> g.edata['weight'] = torch.FloatTensor([0, 1, 0, 1, 0, 1])
+    >>> dgl.sampling.build_topk_order(g, 'weight')
+    >>> sg = dgl.sampling.select_topk(g, 1, 'weight')
+    >>> sg.edges(order='eid')
+    (tensor([2, 1, 0]), tensor([0, 1, 2]))
+    """
+    if edge_dir not in ('in', 'out'):
+        raise DGLError('Invalid edge direction. Must be "in" or "out".')
+    if g.device != F.cpu():
+        raise DGLError('The top-k order can only be built on CPU.')
+    order_name = _topk_order_name(weight, edge_dir, ascending)
+    for etype in g.canonical_etypes:
+        edata = g.edges[etype].data
+        if weight not in edata:
+            continue
+        order = _CAPI_DGLBuildTopkOrder(
+            g._graph, g.get_etype_id(etype), edge_dir, F.to_dgl_nd(edata[weight]),
+            bool(ascending))
+        edata[order_name] = F.from_dgl_nd(order)
+
+def _prepare_timestamp_orders(g, timestamp, edge_dir):
+    """Return the timestamp arrays of every edge type, with the orders of the
+    neighbors by ascending timestamp stored by :func:`build_topk_order`, or
+    built on the fly."""
+    timestamp_arrays = []
+    order_arrays = []
+    order_name = _topk_order_name(timestamp, edge_dir, True)
+    for etype in g.canonical_etypes:
+        edata = g.edges[etype].data
+        if timestamp not in edata:
+            raise DGLError('Edge timestamps "{}" do not exist for relation graph "{}".'.format(
+                timestamp, etype))
+        timestamp_arrays.append(F.to_dgl_nd(edata[timestamp]))
+        if order_name in edata:
+            order_arrays.append(F.to_dgl_nd(edata[order_name]))
+        else:
+            order_arrays.append(_CAPI_DGLBuildTopkOrder(
+                g._graph, g.get_etype_id(etype), edge_dir, timestamp_arrays[-1], True))
+    return timestamp_arrays, order_arrays
+
+def sample_neighbors_temporal(g, nodes, fanout, timestamp, seed_time, edge_dir='in',
+                              replace=False, copy_ndata=True, copy_edata=True):
+    """Sample neighboring edges of the given nodes among the edges strictly earlier than
+    the time of the nodes, and return the induced subgraph.
+
+    For each node, a number of inbound (or outbound when ``edge_dir == 'out'``) edges
+    whose timestamp is strictly smaller than the time of the node are chosen uniformly,
+    as needed by the models of dynamic graphs where a node at a given time must not see
+    the future. The graph returned contains all the nodes of the original graph, but only
+    the sampled edges.
+
+    The eligible edges of a node are found by binary search in its edges sorted by
+    timestamp, so the sampling takes O(fanout + log(number of neighbors)) per node. The
+    order is the one of :func:`build_topk_order` with ``ascending=True``: build it once
+    with ``dgl.sampling.build_topk_order(g, timestamp, edge_dir, ascending=True)``,
+    otherwise it is rebuilt on every call in time linear in the number of edges.
+
+    Parameters
+    ----------
+    g : DGLGraph
+        The graph. Must be on CPU.
+    nodes : tensor or dict
+        Node IDs to sample neighbors from.
+
+        This argument can take a single ID tensor or a dictionary of node types and ID tensors.
+        If a single tensor is given, the graph must only have one type of nodes.
+    fanout : int or dict[etype, int]
+        The number of edges to be sampled for each node on each edge type.
+
+        This argument can take a single int or a dictionary of edge types and ints.
+        If a single int is given, DGL will sample this number of edges for each node for
+        every edge type.
+
+        If -1 is given for a single edge type, all the eligible edges with the same edge
+        type will be selected.
+    timestamp : str
+        Feature name of the timestamps associated with each edge. Every edge type must
+        have it, with one element for each edge.
+    seed_time : tensor or dict
+        The time of every node of :attr:`nodes`, in the same form and of the same data
+        type as the timestamps. A node only samples the edges with a timestamp strictly
+        smaller than its time.
+    edge_dir : str, optional
+        Determines whether to sample inbound or outbound edges.
+
+        Can take either ``in`` for inbound edges or ``out`` for outbound edges.
+    replace : bool, optional
+        If True, sample with replacement.
+    copy_ndata: bool, optional
+        If True, the node features of the new graph are copied from
+        the original graph.  If False, the new graph will not have any
+        node features.
+
+        (Default: True)
+    copy_edata: bool, optional
+        If True, the edge features of the new graph are copied from
+        the original graph.  If False, the new graph will not have any
+        edge features.
+
+        (Default: True)
+
+    Returns
+    -------
+    DGLGraph
+        A sampled subgraph containing only the sampled neighboring edges.
+
+    Examples
+    --------
+    >>> g = dgl.graph(([0, 1, 2, 3, 4], [5, 5, 5, 5, 5]))
+    >>> g.edata['t'] = torch.tensor([1, 2, 3, 4, 5])
+    >>> dgl.sampling.build_topk_order(g, 't', ascending=True)
+    >>> sg = dgl.sampling.sample_neighbors_temporal(
+    ...     g, torch.tensor([5]), -1, 't', torch.tensor([4]))
+    >>> sg.edges(order='eid')
+    (tensor([0, 1, 2]), tensor([5, 5, 5]))
+    """
+    if g.device != F.cpu():
+        raise DGLError('sample_neighbors_temporal only supports CPU graphs.')
+    if edge_dir not in ('in', 'out'):
+        raise DGLError('Invalid edge direction. Must be "in" or "out".')
+    if not isinstance(nodes, dict):
+        if len(g.ntypes) > 1:
+            raise DGLError("Must specify node type when the graph is not homogeneous.")
+        nodes = {g.ntypes[0] : nodes}
+        seed_time = {g.ntypes[0] : seed_time}
+
+    nodes = utils.prepare_tensor_dict(g, nodes, 'nodes')
+    timestamp_arrays, order_arrays = _prepare_timestamp_orders(g, timestamp, edge_dir)
+    nodes_all_types = []
+    seed_time_all_types = []
+    for ntype in g.ntypes:
+        if ntype in nodes:
+            if ntype not in seed_time or \
+                    F.shape(seed_time[ntype])[0] != F.shape(nodes[ntype])[0]:
+                raise DGLError('Every node must have a time.')
+            nodes_all_types.append(F.to_dgl_nd(nodes[ntype]))
+            seed_time_all_types.append(F.to_dgl_nd(seed_time[ntype]))
+        else:
+            nodes_all_types.append(nd.array([], ctx=nd.cpu()))
+            seed_time_all_types.append(nd.array([], ctx=nd.cpu()))
+
+    fanout_array = _prepare_fanout_array(g, fanout)
+    subgidx = _CAPI_DGLSampleNeighborsTemporal(
+        g._graph, nodes_all_types, fanout_array, edge_dir, timestamp_arrays, order_arrays,
+        seed_time_all_types, replace)
+    induced_edges = subgidx.induced_edges
+    ret = DGLHeteroGraph(subgidx.graph, g.ntypes, g.etypes)
+
+    # handle features
+    if copy_ndata:
+        node_frames = utils.extract_node_subframes(g, None)
+        utils.set_new_frames(ret, node_frames=node_frames)
+
+    if copy_edata:
+        edge_frames = utils.extract_edge_subframes(g, induced_edges)
+        utils.set_new_frames(ret, edge_frames=edge_frames)
+    return ret
+
 def sample_neighbors_biased(g, nodes, fanout, bias, edge_dir='in',
                             tag_offset_name='_TAG_OFFSET', replace=False,
                             copy_ndata=True, copy_edata=True):
@@ -542,7 +960,7 @@ def select_topk(g, k, weight, nodes=None, edge_dir='in', ascending=False,
     Parameters
     ----------
     g : DGLGraph
-        The graph.  Must be on CPU.
+        The graph.  Can be either on CPU or GPU.
     k : int or dict[etype, int]
         The number of edges to be selected for each node on each edge type.
 
@@ -569,6 +987,10 @@ def select_topk(g, k, weight, nodes=None, edge_dir='in', ascending=False,
     ascending : bool, optional
         If True, DGL will return edges with k-smallest weights instead of
         k-largest weights.
+
+        If the order of :attr:`weight` for :attr:`edge_dir` and :attr:`ascending`
+        was stored by :func:`build_topk_order`, selecting the edges of a node costs
+        O(k) instead of O(number of neighbors).
     copy_ndata: bool, optional
         If True, the node features of the new graph are copied from
         the original graph. If False, the new graph will not have any
@@ -585,7 +1007,8 @@ def select_topk(g, k, weight, nodes=None, edge_dir='in', ascending=False,
     Returns
     -------
     DGLGraph
-        A sampled subgraph containing only the sampled neighboring edges.  It is on CPU.
+        A sampled subgraph containing only the sampled neighboring edges.  It is on the
+        same device as the input graph.
 
     Notes
     -----
@@ -605,14 +1028,14 @@ def select_topk(g, k, weight, nodes=None, edge_dir='in', ascending=False,
     # Rectify nodes to a dictionary
     if nodes is None:
         nodes = {
-            ntype: F.astype(F.arange(0, g.number_of_nodes(ntype)), g.idtype)
+            ntype: F.copy_to(F.astype(F.arange(0, g.number_of_nodes(ntype)), g.idtype),
+                             g.device)
             for ntype in g.ntypes
         }
     elif not isinstance(nodes, dict):
         if len(g.ntypes) > 1:
             raise DGLError("Must specify node type when the graph is not homogeneous.")
         nodes = {g.ntypes[0] : nodes}
-    assert g.device == F.cpu(), "Graph must be on CPU."
 
     # Parse nodes into a list of NDArrays.
     nodes = utils.prepare_tensor_dict(g, nodes, 'nodes')
@@ -635,15 +1058,23 @@ def select_topk(g, k, weight, nodes=None, edge_dir='in', ascending=False,
     k_array = F.to_dgl_nd(F.tensor(k_array, dtype=F.int64))
 
     weight_arrays = []
+    order_arrays = []
+    order_name = _topk_order_name(weight, edge_dir, ascending)
     for etype in g.canonical_etypes:
-        if weight in g.edges[etype].data:
-            weight_arrays.append(F.to_dgl_nd(g.edges[etype].data[weight]))
+        edata = g.edges[etype].data
+        if weight in edata:
+            weight_arrays.append(F.to_dgl_nd(edata[weight]))
         else:
             raise DGLError('Edge weights "{}" do not exist for relation graph "{}".'.format(
                 weight, etype))
+        if order_name in edata and g.device == F.cpu():
+            order_arrays.append(F.to_dgl_nd(edata[order_name]))
+        else:
+            order_arrays.append(nd.array([], ctx=nd.cpu()))
 
     subgidx = _CAPI_DGLSampleNeighborsTopk(
-        g._graph, nodes_all_types, k_array, edge_dir, weight_arrays, bool(ascending))
+        g._graph, nodes_all_types, k_array, edge_dir, weight_arrays, bool(ascending),
+        order_arrays)
     induced_edges = subgidx.induced_edges
     ret = DGLHeteroGraph(subgidx.graph, g.ntypes, g.etypes)
 
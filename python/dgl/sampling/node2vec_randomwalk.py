@@ -2,14 +2,16 @@
 
 from .._ffi.function import _init_api
 from .. import backend as F
+from ..base import DGLError
 from .. import ndarray as nd
 from .. import utils
 # pylint: disable=invalid-name
 
-__all__ = ['node2vec_random_walk']
+__all__ = ['node2vec_random_walk', 'node2vec_neighbor_filter']
 
 
-def node2vec_random_walk(g, nodes, p, q, walk_length, prob=None, return_eids=False):
+def node2vec_random_walk(g, nodes, p, q, walk_length, prob=None, return_eids=False,
+                         neighbor_filter=None, random_seed=None):
     """
     Generate random walk traces from an array of starting nodes based on the node2vec model.
     Paper: `node2vec: Scalable Feature Learning for Networks
@@ -24,14 +26,14 @@ def node2vec_random_walk(g, nodes, p, q, walk_length, prob=None, return_eids=Fal
     Parameters
     ----------
     g : DGLGraph
-        The graph.  Must be on CPU.
+        The graph.  Can be either on CPU or GPU.
 
         Note that node2vec only support homogeneous graph.
     nodes : Tensor
         Node ID tensor from which the random walk traces starts.
 
-        The tensor must be on CPU, and must have the same dtype as the ID type
-        of the graph.
+        The tensor must be on the same device as the graph, and must have the same
+        dtype as the ID type of the graph.
     p: float
         Likelihood of immediately revisiting a node in the walk.
     q: float
@@ -51,6 +53,19 @@ def node2vec_random_walk(g, nodes, p, q, walk_length, prob=None, return_eids=Fal
         If True, additionally return the edge IDs traversed.
 
         Default: False.
+    neighbor_filter : Tensor, optional
+        The neighbor filter of the graph returned by :func:`node2vec_neighbor_filter`.
+        It speeds up the walks on CPU when :attr:`p` or :attr:`q` reject many
+        candidates, and is ignored on GPU.  Build it once and reuse it for all
+        the walks on the same graph.
+    random_seed : int, optional
+        If given, the walks are generated from this seed, so that the walk from the
+        i-th starting node only depends on :attr:`random_seed` and i, whatever the
+        number of threads.  The walks run in parallel as without a seed.
+
+        If omitted, the walks draw from the random number generator of DGL, which
+        can be seeded with :func:`dgl.seed`, but the result then depends on the
+        number of threads on CPU.
 
     Returns
     -------
@@ -79,8 +94,6 @@ def node2vec_random_walk(g, nodes, p, q, walk_length, prob=None, return_eids=Fal
              [3, 0, 1, 3],
              [0, 1, 3, 0]]))
     """
-    assert g.device == F.cpu(), "Graph must be on CPU."
-
     gidx = g._graph
     nodes = F.to_dgl_nd(utils.prepare_tensor(g, nodes, 'nodes'))
 
@@ -89,7 +102,17 @@ def node2vec_random_walk(g, nodes, p, q, walk_length, prob=None, return_eids=Fal
     else:
         prob_nd = F.to_dgl_nd(g.edata[prob])
 
-    traces, eids = _CAPI_DGLSamplingNode2vec(gidx, nodes, p, q, walk_length, prob_nd)
+    if neighbor_filter is None or g.device != F.cpu():
+        filter_nd = nd.array([], ctx=nodes.ctx)
+    else:
+        filter_nd = F.to_dgl_nd(neighbor_filter)
+
+    if random_seed is not None and random_seed < 0:
+        raise DGLError('random_seed must be non-negative.')
+
+    traces, eids = _CAPI_DGLSamplingNode2vec(
+        gidx, nodes, p, q, walk_length, prob_nd, filter_nd,
+        -1 if random_seed is None else random_seed)
 
     traces = F.from_dgl_nd(traces)
     eids = F.from_dgl_nd(eids)
@@ -97,4 +120,33 @@ def node2vec_random_walk(g, nodes, p, q, walk_length, prob=None, return_eids=Fal
     return (traces, eids) if return_eids else traces
 
 
+def node2vec_neighbor_filter(g):
+    """Build the neighbor filter of a graph for :func:`node2vec_random_walk`.
+
+    Every step of a node2vec random walk checks whether the candidates are neighbors
+    of the previous node.  The filter is a Bloom filter of the successors of every
+    node that rules out most of the other nodes at once, which matters for the nodes
+    of high degree.
+
+    Parameters
+    ----------
+    g : DGLGraph
+        The graph.  Must be on CPU and homogeneous.
+
+    Returns
+    -------
+    Tensor
+        The filter, an int64 tensor with one element per edge.
+
+    Examples
+    --------
+    >>> g1 = dgl.graph(([0, 1, 1, 2, 3], [1, 2, 3, 0, 0]))
+    >>> nf = dgl.sampling.node2vec_neighbor_filter(g1)
+    >>> traces = dgl.sampling.node2vec_random_walk(
+    ...     g1, [0, 1, 2, 0], 1, 0.5, walk_length=4, neighbor_filter=nf)
+    """
+    assert g.device == F.cpu(), "Graph must be on CPU."
+    return F.from_dgl_nd(_CAPI_DGLSamplingNode2vecNeighborFilter(g._graph))
+
+
 _init_api('dgl.sampling.randomwalks', __name__)
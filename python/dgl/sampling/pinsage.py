@@ -8,7 +8,7 @@ from .. import convert
 from .randomwalks import random_walk
 from .. import utils
 
-def _select_pinsage_neighbors(src, dst, num_samples_per_node, k):
+def _select_pinsage_neighbors(src, dst, num_samples_per_node, k, hashmap_size=0):
     """Determine the neighbors for PinSAGE algorithm from the given random walk traces.
 
     This is fusing ``to_simple()``, ``select_topk()``, and counting the number of occurrences
@@ -16,7 +16,8 @@ def _select_pinsage_neighbors(src, dst, num_samples_per_node, k):
     """
     src = F.to_dgl_nd(src)
     dst = F.to_dgl_nd(dst)
-    src, dst, counts = _CAPI_DGLSamplingSelectPinSageNeighbors(src, dst, num_samples_per_node, k)
+    src, dst, counts = _CAPI_DGLSamplingSelectPinSageNeighbors(
+        src, dst, num_samples_per_node, k, hashmap_size)
     src = F.from_dgl_nd(src)
     dst = F.from_dgl_nd(dst)
     counts = F.from_dgl_nd(counts)
@@ -64,15 +65,23 @@ class RandomWalkNeighborSampler(object):
     weight_column : str, default "weights"
         The name of the edge feature to be stored on the returned graph with the number of
         visits.
+    max_visited_nodes : int, optional
+        The maximum number of distinct nodes counted for a given node on GPU, which sizes
+        the hash tables counting the visits.  The distinct nodes visited past this number
+        are ignored.
+
+        If not given, every visit of every random walk can be counted.
 
     Examples
     --------
     See examples in :any:`PinSAGESampler`.
     """
     def __init__(self, G, num_traversals, termination_prob,
-                 num_random_walks, num_neighbors, metapath=None, weight_column='weights'):
+                 num_random_walks, num_neighbors, metapath=None, weight_column='weights',
+                 max_visited_nodes=None):
         self.G = G
         self.weight_column = weight_column
+        self.max_visited_nodes = max_visited_nodes
         self.num_random_walks = num_random_walks
         self.num_neighbors = num_neighbors
         self.num_traversals = num_traversals
@@ -121,7 +130,8 @@ class RandomWalkNeighborSampler(object):
         dst = F.repeat(paths[:, 0], self.num_traversals, 0)
 
         src, dst, counts = _select_pinsage_neighbors(
-            src, dst, (self.num_random_walks * self.num_traversals), self.num_neighbors)
+            src, dst, (self.num_random_walks * self.num_traversals), self.num_neighbors,
+            self.max_visited_nodes or 0)
         neighbor_graph = convert.heterograph(
             {(self.ntype, '_E', self.ntype): (src, dst)},
             {self.ntype: self.G.number_of_nodes(self.ntype)}
@@ -175,6 +185,8 @@ class PinSAGESampler(RandomWalkNeighborSampler):
     weight_column : str, default "weights"
         The name of the edge feature to be stored on the returned graph with the number of
         visits.
+    max_visited_nodes : int, optional
+        The same as in :class:`RandomWalkNeighborSampler`.
 
     Examples
     --------
@@ -212,12 +224,14 @@ class PinSAGESampler(RandomWalkNeighborSampler):
         Ying et al., 2018, https://arxiv.org/abs/1806.01973
     """
     def __init__(self, G, ntype, other_type, num_traversals, termination_prob,
-                 num_random_walks, num_neighbors, weight_column='weights'):
+                 num_random_walks, num_neighbors, weight_column='weights',
+                 max_visited_nodes=None):
         metagraph = G.metagraph()
         fw_etype = list(metagraph[ntype][other_type])[0]
         bw_etype = list(metagraph[other_type][ntype])[0]
         super().__init__(G, num_traversals,
                          termination_prob, num_random_walks, num_neighbors,
-                         metapath=[fw_etype, bw_etype], weight_column=weight_column)
+                         metapath=[fw_etype, bw_etype], weight_column=weight_column,
+                         max_visited_nodes=max_visited_nodes)
 
 _init_api('dgl.sampling.pinsage', __name__)
@@ -6,13 +6,16 @@ from .. import backend as F
 from ..base import DGLError
 from .. import ndarray as nd
 from .. import utils
+from .neighbor import _alias_table_names, _prepare_timestamp_orders
 
 __all__ = [
     'random_walk',
+    'random_walk_batches',
+    'temporal_random_walk',
     'pack_traces']
 
 def random_walk(g, nodes, *, metapath=None, length=None, prob=None, restart_prob=None,
-                return_eids=False):
+                return_eids=False, random_seed=None):
     """Generate random walk traces from an array of starting nodes based on the given metapath.
 
     Each starting node will have one trace generated, which
@@ -61,6 +64,10 @@ def random_walk(g, nodes, *, metapath=None, length=None, prob=None, restart_prob
         to sum up to one).  The result will be undefined otherwise.
 
         If omitted, DGL assumes that the neighbors are picked uniformly.
+
+        If the alias tables of the feature were stored by
+        ``dgl.sampling.build_alias_tables(g, prob, edge_dir='out')``, every step
+        takes constant time instead of time linear in the degree of the current node.
     restart_prob : float or Tensor, optional
         Probability to terminate the current trace before each transition.
 
@@ -70,6 +77,14 @@ def random_walk(g, nodes, *, metapath=None, length=None, prob=None, restart_prob
         If True, additionally return the edge IDs traversed.
 
         Default: False.
+    random_seed : int, optional
+        If given, the walks are generated from this seed, so that the walk from the
+        i-th starting node only depends on :attr:`random_seed` and i, whatever the
+        number of threads.  The walks run in parallel as without a seed.
+
+        If omitted, the walks draw from the random number generator of DGL, which
+        can be seeded with :func:`dgl.seed`, but the result then depends on the
+        number of threads on CPU.
 
     Returns
     -------
@@ -156,6 +171,154 @@ def random_walk(g, nodes, *, metapath=None, length=None, prob=None, restart_prob
              [ 2,  0,  1,  1,  3,  2,  2],
              [ 0,  1,  1,  3,  0,  0,  0]]), tensor([0, 0, 1, 0, 0, 1, 0]))
     """
+    nodes, metapath, p_nd, alias_accept_nd, alias_nd = _prepare_random_walk(
+        g, nodes, metapath, length, prob)
+    traces, eids, types = _run_random_walk(
+        g._graph, F.to_dgl_nd(nodes), metapath, p_nd, alias_accept_nd, alias_nd,
+        restart_prob, random_seed)
+
+    traces = F.from_dgl_nd(traces)
+    types = F.from_dgl_nd(types)
+    eids = F.from_dgl_nd(eids)
+    return (traces, eids, types) if return_eids else (traces, types)
+
+def temporal_random_walk(g, nodes, seed_time, timestamp, *, metapath=None, length=None,
+                         return_eids=False, random_seed=None):
+    """Generate random walk traces going back in time from an array of starting nodes
+    based on the given metapath.
+
+    Every step picks uniformly one of the outbound edges of the current node whose
+    timestamp is strictly smaller than the one of the previous step, or than the time
+    of the starting node for the first step, so that a trace only goes through the
+    past of its starting node.  A trace terminates early when there is no such edge.
+
+    The eligible edges are found by binary search in the edges of the node sorted by
+    timestamp, so a step takes O(log(number of neighbors)).  The order is the one of
+    :func:`~dgl.sampling.build_topk_order` with ``edge_dir='out'`` and
+    ``ascending=True``: build it once, otherwise it is rebuilt on every call in time
+    linear in the number of edges.
+
+    Parameters
+    ----------
+    g : DGLGraph
+        The graph.  Must be on CPU.
+    nodes : Tensor
+        Node ID tensor from which the random walk traces starts.
+    seed_time : Tensor
+        The time of every starting node, of the same data type as the timestamps.
+    timestamp : str
+        The name of the edge feature tensor on the graph storing the timestamp of each
+        edge.  Every edge type must have it, with one element for each edge.
+    metapath, length, return_eids, random_seed
+        The same as in :func:`random_walk`.
+
+    Returns
+    -------
+    traces : Tensor
+        A 2-dimensional node ID tensor with shape ``(num_seeds, len(metapath) + 1)`` or
+        ``(num_seeds, length + 1)`` if :attr:`metapath` is None.
+    eids : Tensor, optional
+        A 2-dimensional edge ID tensor with shape ``(num_seeds, len(metapath))`` or
+        ``(num_seeds, length)`` if :attr:`metapath` is None.  Only returned if
+        :attr:`return_eids` is True.
+    types : Tensor
+        A 1-dimensional node type ID tensor with shape ``(len(metapath) + 1)`` or
+        ``(length + 1)``.
+
+    Examples
+    --------
+    >>> g = dgl.graph(([0, 1, 2, 1], [1, 2, 0, 0]))
+    >>> g.edata['t'] = torch.tensor([3, 2, 1, 5])
+    >>> dgl.sampling.build_topk_order(g, 't', edge_dir='out', ascending=True)
+    >>> dgl.sampling.temporal_random_walk(g, [0], torch.tensor([4]), 't', length=4)
+    (tensor([[ 0,  1,  2,  0, -1]]), tensor([0, 0, 0, 0, 0]))
+    """
+    if g.device != F.cpu():
+        raise DGLError('temporal_random_walk only supports CPU graphs.')
+    nodes, metapath, _, _, _ = _prepare_random_walk(g, nodes, metapath, length, None)
+    timestamp_nd, order_nd = _prepare_timestamp_orders(g, timestamp, 'out')
+    if random_seed is None:
+        random_seed = -1
+    elif random_seed < 0:
+        raise DGLError('random_seed must be non-negative.')
+    traces, eids, types = _CAPI_DGLSamplingRandomWalkTemporal(
+        g._graph, F.to_dgl_nd(nodes), metapath, timestamp_nd, order_nd,
+        F.to_dgl_nd(seed_time), random_seed)
+
+    traces = F.from_dgl_nd(traces)
+    types = F.from_dgl_nd(types)
+    eids = F.from_dgl_nd(eids)
+    return (traces, eids, types) if return_eids else (traces, types)
+
+def random_walk_batches(g, nodes, batch_size, *, metapath=None, length=None, prob=None,
+                        restart_prob=None, pack=False):
+    """Generate the random walk traces of :func:`random_walk` batch by batch of
+    starting nodes.
+
+    Only the traces of one batch are in memory at a time, which keeps the memory
+    bounded by :attr:`batch_size` for any number of starting nodes.  With
+    :attr:`pack`, every batch is returned packed as by :func:`pack_traces`, without
+    the padded traces.
+
+    Parameters
+    ----------
+    g : DGLGraph
+        The graph.  Can be either on CPU or GPU.
+    nodes : Tensor
+        Node ID tensor from which the random walk traces starts.
+    batch_size : int
+        The number of starting nodes of every batch.
+    metapath, length, prob, restart_prob
+        The same as in :func:`random_walk`.
+    pack : bool, optional
+        If True, pack the traces of every batch with their edge IDs and node types
+        in a single pass.  Only supported on CPU.
+
+    Yields
+    ------
+    traces, eids, types : (Tensor, Tensor, Tensor)
+        The node IDs, edge IDs and node type IDs of the traces of the batch, as
+        returned by :func:`random_walk` with :attr:`return_eids`, if :attr:`pack` is
+        False.
+    concat_vids, concat_eids, concat_types, lengths, offsets : (Tensor, ...)
+        If :attr:`pack` is True, the node IDs and edge IDs of all the traces of the
+        batch concatenated without the padding, the node type IDs of the node IDs,
+        and the length and offset of every trace in the node IDs.  A trace has one
+        edge less than nodes, so the edges of the i-th trace start at
+        ``offsets[i] - i``.
+
+    Examples
+    --------
+    >>> g1 = dgl.graph(([0, 1, 1, 2, 3], [1, 2, 3, 0, 0]))
+    >>> for vids, eids, types, lengths, offsets in dgl.sampling.random_walk_batches(
+    ...         g1, torch.arange(4), 2, length=3, restart_prob=0.5, pack=True):
+    ...     print(vids.split(lengths.tolist()))
+    (tensor([0, 1]), tensor([1, 3, 0, 1]))
+    (tensor([2]), tensor([3, 0, 1]))
+    """
+    if pack and g.device != F.cpu():
+        raise DGLError('Packing the traces only supports CPU.')
+    nodes, metapath, p_nd, alias_accept_nd, alias_nd = _prepare_random_walk(
+        g, nodes, metapath, length, prob)
+    if F.is_tensor(restart_prob):
+        restart_prob = F.to_dgl_nd(restart_prob)
+
+    num_nodes = F.shape(nodes)[0]
+    for start in range(0, num_nodes, batch_size):
+        batch = F.slice_axis(nodes, 0, start, min(start + batch_size, num_nodes))
+        traces, eids, types = _run_random_walk(
+            g._graph, F.to_dgl_nd(batch), metapath, p_nd, alias_accept_nd, alias_nd,
+            restart_prob)
+        if pack:
+            yield tuple(F.from_dgl_nd(arr) for arr in _CAPI_DGLSamplingPackWalks(
+                traces, eids, types))
+        else:
+            yield F.from_dgl_nd(traces), F.from_dgl_nd(eids), F.from_dgl_nd(types)
+
+def _prepare_random_walk(g, nodes, metapath, length, prob):
+    """Check the starting nodes and convert the metapath and the probabilities of
+    the random walks, with the alias tables stored by :func:`build_alias_tables`
+    if any."""
     n_etypes = len(g.canonical_etypes)
     n_ntypes = len(g.ntypes)
 
@@ -168,41 +331,48 @@ def random_walk(g, nodes, *, metapath=None, length=None, prob=None, restart_prob
     else:
         metapath = [g.get_etype_id(etype) for etype in metapath]
 
-    gidx = g._graph
-    nodes = F.to_dgl_nd(utils.prepare_tensor(g, nodes, 'nodes'))
+    nodes = utils.prepare_tensor(g, nodes, 'nodes')
     metapath = F.to_dgl_nd(utils.prepare_tensor(g, metapath, 'metapath'))
 
     # Load the probability tensor from the edge frames
-    if prob is None:
-        p_nd = [nd.array([], ctx=nodes.ctx) for _ in g.canonical_etypes]
-    else:
-        p_nd = []
-        for etype in g.canonical_etypes:
-            if prob in g.edges[etype].data:
-                prob_nd = F.to_dgl_nd(g.edges[etype].data[prob])
-                if prob_nd.ctx != nodes.ctx:
-                    raise ValueError(
-                        'context of seed node array and edges[%s].data[%s] are different' %
-                        (etype, prob))
-            else:
-                prob_nd = nd.array([], ctx=nodes.ctx)
-            p_nd.append(prob_nd)
-
-    # Actual random walk
+    ctx = F.to_dgl_nd(nodes).ctx
+    p_nd = [nd.array([], ctx=ctx) for _ in g.canonical_etypes]
+    alias_accept_nd = [nd.array([], ctx=ctx) for _ in g.canonical_etypes]
+    alias_nd = [nd.array([], ctx=ctx) for _ in g.canonical_etypes]
+    if prob is not None:
+        accept_name, alias_name = _alias_table_names(prob, 'out')
+        for etype_id, etype in enumerate(g.canonical_etypes):
+            edata = g.edges[etype].data
+            if prob not in edata:
+                continue
+            p_nd[etype_id] = F.to_dgl_nd(edata[prob])
+            if p_nd[etype_id].ctx != ctx:
+                raise ValueError(
+                    'context of seed node array and edges[%s].data[%s] are different' %
+                    (etype, prob))
+            # the walks follow the outbound edges
+            if accept_name in edata and alias_name in edata:
+                alias_accept_nd[etype_id] = F.to_dgl_nd(edata[accept_name])
+                alias_nd[etype_id] = F.to_dgl_nd(edata[alias_name])
+    return nodes, metapath, p_nd, alias_accept_nd, alias_nd
+
+def _run_random_walk(gidx, nodes, metapath, p_nd, alias_accept_nd, alias_nd, restart_prob,
+                     random_seed=None):
+    """Run the random walk variant of the restart probability on DGL arrays."""
+    if random_seed is None:
+        random_seed = -1
+    elif random_seed < 0:
+        raise DGLError('random_seed must be non-negative.')
     if restart_prob is None:
-        traces, eids, types = _CAPI_DGLSamplingRandomWalk(gidx, nodes, metapath, p_nd)
-    elif F.is_tensor(restart_prob):
+        return _CAPI_DGLSamplingRandomWalk(
+            gidx, nodes, metapath, p_nd, alias_accept_nd, alias_nd, random_seed)
+    if F.is_tensor(restart_prob):
         restart_prob = F.to_dgl_nd(restart_prob)
-        traces, eids, types = _CAPI_DGLSamplingRandomWalkWithStepwiseRestart(
-            gidx, nodes, metapath, p_nd, restart_prob)
-    else:
-        traces, eids, types = _CAPI_DGLSamplingRandomWalkWithRestart(
-            gidx, nodes, metapath, p_nd, restart_prob)
-
-    traces = F.from_dgl_nd(traces)
-    types = F.from_dgl_nd(types)
-    eids = F.from_dgl_nd(eids)
-    return (traces, eids, types) if return_eids else (traces, types)
+    if isinstance(restart_prob, nd.NDArray):
+        return _CAPI_DGLSamplingRandomWalkWithStepwiseRestart(
+            gidx, nodes, metapath, p_nd, alias_accept_nd, alias_nd, restart_prob, random_seed)
+    return _CAPI_DGLSamplingRandomWalkWithRestart(
+        gidx, nodes, metapath, p_nd, alias_accept_nd, alias_nd, restart_prob, random_seed)
 
 def pack_traces(traces, types):
     """Pack the padded traces returned by ``random_walk()`` into a concatenated array.
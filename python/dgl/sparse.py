@@ -84,7 +84,7 @@ target_mapping = {
 }
 
 
-def _gspmm(gidx, op, reduce_op, u, e):
+def _gspmm(gidx, op, reduce_op, u, e, u_index=None):
     r""" Generalized Sparse Matrix Multiplication interface. It takes the result of
     :attr:`op` on source node feature and edge feature, leads to a message on edge.
     Then aggregates the message by :attr:`reduce_op` on destination nodes.
@@ -112,6 +112,11 @@ def _gspmm(gidx, op, reduce_op, u, e):
         The feature on source nodes, could be None if op is ``copy_rhs``.
     e : tensor or None
         The feature on edges, could be None if op is ``copy_lhs``.
+    u_index : tensor, optional
+        If given, :attr:`u` is a table of features and the feature of the source
+        node ``i`` is ``u[u_index[i]]``, read by the kernels without gathering the
+        features of the source nodes. The table may be in pinned host memory for
+        a graph on GPU. ``arg_u`` then holds rows of the table.
 
     Returns
     -------
@@ -129,6 +134,8 @@ def _gspmm(gidx, op, reduce_op, u, e):
         raise DGLError("We only support gspmm on graph with one edge type")
     use_u = op != 'copy_rhs'
     use_e = op != 'copy_lhs'
+    if u_index is not None and not use_u:
+        raise DGLError("u_index requires the source node features.")
     if use_u and use_e:
         if F.dtype(u) != F.dtype(e):
             raise DGLError("The node features' data type {} doesn't match edge"
@@ -145,7 +152,10 @@ def _gspmm(gidx, op, reduce_op, u, e):
             e = F.unsqueeze(e, -1)
             expand_e = True
 
-    ctx = F.context(u) if use_u else F.context(e)
+    if u_index is not None:
+        ctx = F.context(u_index)
+    else:
+        ctx = F.context(u) if use_u else F.context(e)
     dtype = F.dtype(u) if use_u else F.dtype(e)
     u_shp = F.shape(u) if use_u else (0,)
     e_shp = F.shape(e) if use_e else (0,)
@@ -163,7 +173,15 @@ def _gspmm(gidx, op, reduce_op, u, e):
             arg_e = F.zeros(v_shp, idtype, ctx)
     arg_u_nd = to_dgl_nd_for_write(arg_u)
     arg_e_nd = to_dgl_nd_for_write(arg_e)
-    if gidx.number_of_edges(0) > 0:
+    if gidx.number_of_edges(0) > 0 and u_index is not None:
+        _CAPI_DGLKernelSpMMWithIndex(gidx, op, reduce_op,
+                                     to_dgl_nd(u),
+                                     to_dgl_nd(u_index),
+                                     to_dgl_nd(e if use_e else None),
+                                     to_dgl_nd_for_write(v),
+                                     arg_u_nd,
+                                     arg_e_nd)
+    elif gidx.number_of_edges(0) > 0:
         _CAPI_DGLKernelSpMM(gidx, op, reduce_op,
                             to_dgl_nd(u if use_u else None),
                             to_dgl_nd(e if use_e else None),
@@ -467,6 +485,151 @@ def _gsddmm_hetero(gidx, op, lhs_len, lhs_target='u', rhs_target='v', lhs_and_rh
     return out
 
 
+def _fused_attention(gidx, op, lhs, rhs, feat, negative_slope=0.2):
+    r""" Fused attention operator. It computes an attention score on every edge
+    from the source and destination node operands, normalizes the scores with a
+    softmax over the incoming edges of every destination node, and aggregates the
+    source node feature with the normalized scores.
+
+    .. math::
+        s_{uv} = \mathrm{LeakyReLU}(\phi(l_u, r_v))
+
+        x_v = \sum_{(u, v)\in \mathcal{G}} \mathrm{softmax}_v(s)_{uv} f_u
+
+    where :math:`\phi` is the score operator :attr:`op`. This is equivalent to
+    ``_gsddmm``, followed by an edge softmax and ``_gspmm``, but is computed in a
+    single pass without materializing any edge tensor. Only CPU is supported.
+
+    Parameters
+    ----------
+    gidx : HeteroGraphIndex
+        The input graph index.
+    op : str
+        The score operator, could be ``add`` (e.g. GAT, where the operands are
+        of shape :math:`(N, H)` or :math:`(N, H, 1)`) or ``dot`` (e.g. dot-product
+        attention, where the operands are of shape :math:`(N, H, D)`).
+    lhs : tensor
+        The score operand on source nodes.
+    rhs : tensor
+        The score operand on destination nodes.
+    feat : tensor
+        The feature on source nodes to aggregate, of shape :math:`(N, H, F)`.
+    negative_slope : float
+        The negative slope of the LeakyReLU applied on the scores. Use 1 to
+        leave the scores unchanged.
+
+    Returns
+    -------
+    tuple
+        The returned tuple is composed of two elements:
+        - The aggregated feature on destination nodes, of shape :math:`(N, H, F)`.
+        - The log-sum-exp of the scores of every destination node and head, of
+          shape :math:`(N, H)`, useful to recompute the softmax for gradients.
+
+    Notes
+    -----
+    This function does not handle gradients.
+    """
+    if gidx.number_of_etypes() != 1:
+        raise DGLError("We only support fused attention on graph with one edge type")
+    if op not in ['add', 'dot']:
+        raise DGLError("Unsupported attention score operator: {}".format(op))
+    if F.dtype(lhs) != F.dtype(rhs) or F.dtype(lhs) != F.dtype(feat):
+        raise DGLError("The operands data type don't match: {}, {} and {}, please convert"
+                       " them to the same type.".format(F.dtype(lhs), F.dtype(rhs),
+                                                       F.dtype(feat)))
+    if F.ndim(lhs) == 2:
+        lhs = F.unsqueeze(lhs, -1)
+    if F.ndim(rhs) == 2:
+        rhs = F.unsqueeze(rhs, -1)
+    ctx = F.context(feat)
+    dtype = F.dtype(feat)
+    _, dsttype = gidx.metagraph.find_edge(0)
+    num_dst = gidx.number_of_nodes(dsttype)
+    out = F.zeros((num_dst,) + F.shape(feat)[1:], dtype, ctx)
+    lse = F.full_1d(num_dst * F.shape(feat)[1], -float('inf'), dtype, ctx)
+    lse = F.reshape(lse, (num_dst, F.shape(feat)[1]))
+    if gidx.number_of_edges(0) > 0:
+        _CAPI_DGLKernelFusedAttention(gidx, op,
+                                      to_dgl_nd(lhs),
+                                      to_dgl_nd(rhs),
+                                      to_dgl_nd(feat),
+                                      float(negative_slope),
+                                      to_dgl_nd_for_write(out),
+                                      to_dgl_nd_for_write(lse))
+    return out, lse
+
+
+def _edge_softmax_forward(gidx, score):
+    r""" Edge softmax forward operator. It normalizes the scores of the incoming
+    edges of every destination node with a softmax.
+
+    .. math::
+        y_{uv} = \frac{\exp(s_{uv})}{\sum_{(w, v)\in \mathcal{G}} \exp(s_{wv})}
+
+    This is equivalent to the sequence ``_gspmm`` max, ``_gsddmm`` sub, exp,
+    ``_gspmm`` sum and ``_gsddmm`` div, but is computed by a single kernel on the
+    in-edge CSR of the graph. To normalize by source nodes, pass the reversed graph.
+
+    Parameters
+    ----------
+    gidx : HeteroGraphIndex
+        The input graph index, which must allow the CSC format.
+    score : tensor
+        The edge scores of shape :math:`(E, *)`.
+
+    Returns
+    -------
+    tensor
+        The normalized scores, of the same shape as :attr:`score`.
+
+    Notes
+    -----
+    This function does not handle gradients.
+    """
+    if gidx.number_of_etypes() != 1:
+        raise DGLError("We only support edge softmax on graph with one edge type")
+    out = F.zeros(F.shape(score), F.dtype(score), F.context(score))
+    if gidx.number_of_edges(0) > 0:
+        _CAPI_DGLKernelEdgeSoftmaxForward(gidx,
+                                          to_dgl_nd(score),
+                                          to_dgl_nd_for_write(out))
+    return out
+
+
+def _edge_softmax_backward(gidx, out, grad_out):
+    r""" Edge softmax backward operator. It computes the gradient of the scores
+    of ``_edge_softmax_forward`` from its output and the gradient of its output.
+
+    .. math::
+        \frac{\partial L}{\partial s_{uv}} = y_{uv} \left(\frac{\partial L}{\partial y_{uv}} -
+        \sum_{(w, v)\in \mathcal{G}} y_{wv} \frac{\partial L}{\partial y_{wv}}\right)
+
+    Parameters
+    ----------
+    gidx : HeteroGraphIndex
+        The input graph index, which must allow the CSC format.
+    out : tensor
+        The output of ``_edge_softmax_forward``.
+    grad_out : tensor
+        The gradient of the output.
+
+    Returns
+    -------
+    tensor
+        The gradient of the scores, of the same shape as :attr:`out`.
+    """
+    if gidx.number_of_etypes() != 1:
+        raise DGLError("We only support edge softmax on graph with one edge type")
+    grad_score = F.zeros(F.shape(out), F.dtype(out), F.context(out))
+    if gidx.number_of_edges(0) > 0:
+        _CAPI_DGLKernelEdgeSoftmaxBackward(gidx,
+                                           to_dgl_nd(out),
+                                           to_dgl_nd(grad_out),
+                                           to_dgl_nd_for_write(grad_score))
+    return grad_score
+
+
 def _segment_reduce(op, feat, offsets):
     r"""Segment reduction operator.
 
@@ -547,6 +710,71 @@ def _scatter_add(x, idx, m):
     return out
 
 
+def _sparse_adagrad_update(weight, state, idx, grad, lr, eps):
+    r""" Apply the sparse Adagrad update to the rows of an embedding in place.
+
+    The gradients of the duplicate rows are averaged.
+
+    Parameters
+    ----------
+    weight : Tensor
+        The embedding, on the device of :attr:`grad`, or in pinned memory for
+        :attr:`grad` on GPU.
+    state : Tensor
+        The sums of the squared gradients, of the shape of :attr:`weight`, on
+        the device of :attr:`weight`.
+    idx : Tensor
+        The non-negative rows of the gradients, on the device of :attr:`grad`.
+    grad : Tensor
+        The gradients.
+    lr : float
+        The learning rate.
+    eps : float
+        The term added to the denominator.
+    """
+    _CAPI_DGLKernelSparseAdagradUpdate(to_dgl_nd_for_write(weight),
+                                       to_dgl_nd_for_write(state),
+                                       to_dgl_nd(idx),
+                                       to_dgl_nd(grad),
+                                       lr, eps)
+
+
+def _sparse_adam_update(weight, step, mem, power, idx, grad, lr, beta1, beta2, eps):
+    r""" Apply the sparse Adam update to the rows of an embedding in place.
+
+    The gradients of the duplicate rows are averaged.
+
+    Parameters
+    ----------
+    weight : Tensor
+        The embedding, on the device of :attr:`grad`, or in pinned memory for
+        :attr:`grad` on GPU.
+    step : Tensor
+        The number of updates of every row, on the device of :attr:`weight`.
+    mem : Tensor
+        The first moments, of the shape of :attr:`weight`, on its device.
+    power : Tensor
+        The second moments, of the shape of :attr:`weight`, on its device.
+    idx : Tensor
+        The non-negative rows of the gradients, on the device of :attr:`grad`.
+    grad : Tensor
+        The gradients.
+    lr : float
+        The learning rate.
+    beta1, beta2 : float
+        The decay rates of the moments.
+    eps : float
+        The term added to the denominator.
+    """
+    _CAPI_DGLKernelSparseAdamUpdate(to_dgl_nd_for_write(weight),
+                                    to_dgl_nd_for_write(step),
+                                    to_dgl_nd_for_write(mem),
+                                    to_dgl_nd_for_write(power),
+                                    to_dgl_nd(idx),
+                                    to_dgl_nd(grad),
+                                    lr, beta1, beta2, eps)
+
+
 def _update_grad_minmax_hetero(gidx, op, list_x, list_idx, list_idx_etype, list_dX):
     r""" Update gradients for reduce operator max and min (on first dimension) implementation.
 
@@ -620,7 +848,7 @@ def _bwd_segment_cmp(feat, arg, m):
                                  to_dgl_nd_for_write(out))
     return out
 
-def _csrmm(A, A_weights, B, B_weights, num_vtypes):
+def _csrmm(A, A_weights, B, B_weights, num_vtypes, topk=-1):
     """Return a graph whose adjacency matrix is the sparse matrix multiplication
     of those of two given graphs.
 
@@ -639,6 +867,9 @@ def _csrmm(A, A_weights, B, B_weights, num_vtypes):
         The edge weights of graph B as 1D tensor.
     num_vtypes : int
         The number of node types for the returned graph (must be either 1 or 2).
+    topk : int, optional
+        The number of largest entries to keep in every row of the product, on CPU
+        only, or -1 to keep them all.
 
     Returns
     -------
@@ -648,9 +879,38 @@ def _csrmm(A, A_weights, B, B_weights, num_vtypes):
         The edge weights of the output graph.
     """
     C, C_weights = _CAPI_DGLCSRMM(
-        A, F.to_dgl_nd(A_weights), B, F.to_dgl_nd(B_weights), num_vtypes)
+        A, F.to_dgl_nd(A_weights), B, F.to_dgl_nd(B_weights), num_vtypes, topk)
     return C, F.from_dgl_nd(C_weights)
 
+def _csrmaskedmm(A, A_weights, B, B_weights, M):
+    """Return the entries of the sparse matrix multiplication of the adjacency
+    matrices of two given graphs at the edges of a third one, without computing
+    the rest of the product.
+
+    Note that the edge weights of both graphs must be scalar, i.e. :attr:`A_weights`
+    and :attr:`B_weights` must be 1D vectors.
+
+    Parameters
+    ----------
+    A : HeteroGraphIndex
+        The input graph index as left operand.
+    A_weights : Tensor
+        The edge weights of graph A as 1D tensor.
+    B : HeteroGraphIndex
+        The input graph index as right operand.
+    B_weights : Tensor
+        The edge weights of graph B as 1D tensor.
+    M : HeteroGraphIndex
+        The graph index whose edges are the entries to compute.
+
+    Returns
+    -------
+    M_weights : Tensor
+        The entries of the product at the edges of M.
+    """
+    return F.from_dgl_nd(_CAPI_DGLCSRMaskedMM(
+        A, F.to_dgl_nd(A_weights), B, F.to_dgl_nd(B_weights), M))
+
 def _csrsum(As, A_weights):
     """Return a graph whose adjacency matrix is the sparse matrix summation
     of the given list of graphs.
@@ -750,6 +1010,27 @@ def libra2dgl_build_dict(a, b, indices, ldt_key, gdt_key, gdt_value, node_map,
     return ret
 
 
+def libra2dgl_build_partitions(u, v, out, nc, gdt_key, gdt_value, node_map, Nn):
+    """
+    This function invokes C/C++ code for pre-processing Libra output.
+    After graph partitioning using Libra, it builds the dictionaries of
+    :func:`libra2dgl_build_dict` for all the partitions at once from the assignment
+    of the edges in memory, and returns, for each partition, the global node IDs of
+    its local nodes and the local src and dst node IDs of its edges.
+    Parameter details are present in dgl/src/array/libra_partition.cc
+    """
+    ret = _CAPI_DGLLibra2dglBuildPartitions(to_dgl_nd(u),
+                                            to_dgl_nd(v),
+                                            to_dgl_nd(out),
+                                            nc,
+                                            to_dgl_nd_for_write(gdt_key),
+                                            to_dgl_nd_for_write(gdt_value),
+                                            to_dgl_nd_for_write(node_map),
+                                            Nn)
+    ret = [F.from_dgl_nd(array) for array in ret]
+    return ret[0::3], ret[1::3], ret[2::3]
+
+
 def libra2dgl_build_adjlist(feat, gfeat, adj, inner_node, ldt, gdt_key,
                             gdt_value, node_map, lr, lrtensor, num_nodes,
                             nc, c, feat_size, labels, trainm, testm, valm,
@@ -5,6 +5,8 @@ For stochastic subgraph extraction, please see functions under :mod:`dgl.samplin
 """
 from collections.abc import Mapping
 
+import numpy as np
+
 from ._ffi.function import _init_api
 from .base import DGLError, dgl_warning
 from . import backend as F
@@ -15,7 +17,8 @@ from .heterograph import DGLHeteroGraph
 from . import utils
 
 __all__ = ['node_subgraph', 'edge_subgraph', 'node_type_subgraph', 'edge_type_subgraph',
-           'in_subgraph', 'out_subgraph', 'khop_in_subgraph', 'khop_out_subgraph']
+           'in_subgraph', 'out_subgraph', 'khop_in_subgraph', 'khop_out_subgraph',
+           'batch_node_subgraphs', 'batch_khop_subgraphs']
 
 def node_subgraph(graph, nodes, *, relabel_nodes=True, store_ids=True):
     """Return a subgraph induced on the given nodes.
@@ -154,6 +157,181 @@ def node_subgraph(graph, nodes, *, relabel_nodes=True, store_ids=True):
 
 DGLHeteroGraph.subgraph = utils.alias_func(node_subgraph)
 
+def batch_node_subgraphs(graph, nodes_list, *, store_ids=True):
+    """Return the batch of the subgraphs induced on many sets of nodes, extracted
+    at once.
+
+    The result is the same as ``dgl.batch([dgl.node_subgraph(graph, nodes)
+    for nodes in nodes_list])``, but all the subgraphs are extracted in a single
+    call, in parallel on CPU, and on GPU with the number of edges of each edge
+    type as the only value copied to the host. This is meant for models working
+    on many small subgraphs at once, e.g. SEAL or ShaDow-GNN.
+
+    Parameters
+    ----------
+    graph : DGLGraph
+        The graph to extract subgraphs from.
+    nodes_list : list[nodes or dict[str, nodes]]
+        The nodes of every subgraph, as in :func:`dgl.node_subgraph`, except that
+        they must be IDs, not masks. The nodes of a type of a subgraph must be
+        unique.
+    store_ids : bool, optional
+        If True, the IDs of the extracted nodes and edges in the original graph
+        are stored as the ``dgl.NID`` and ``dgl.EID`` features of the result.
+
+    Returns
+    -------
+    DGLGraph
+        The batched subgraphs, on the device of the graph. The nodes of each
+        subgraph are in the given order, and the features are copied from the
+        original graph.
+
+    Examples
+    --------
+    >>> g = dgl.graph(([0, 1, 2, 3, 4], [1, 2, 3, 4, 0]))
+    >>> bg = dgl.batch_node_subgraphs(g, [torch.tensor([0, 1]), torch.tensor([4, 0, 3])])
+    >>> bg.batch_num_nodes()
+    tensor([2, 3])
+    >>> bg.edges()
+    (tensor([0, 2, 4]), tensor([1, 3, 2]))
+    >>> bg.edata[dgl.EID]
+    tensor([0, 4, 3])
+
+    See Also
+    --------
+    node_subgraph
+    """
+    if graph.is_block:
+        raise DGLError('Extracting subgraph from a block graph is not allowed.')
+    nodes_per_type = {ntype: [] for ntype in graph.ntypes}
+    for nodes in nodes_list:
+        if not isinstance(nodes, Mapping):
+            assert len(graph.ntypes) == 1, \
+                'need a dict of node type and IDs for graph with multiple node types'
+            nodes = {graph.ntypes[0]: nodes}
+        for ntype in graph.ntypes:
+            nids = nodes.get(ntype, F.copy_to(F.tensor([], graph.idtype), graph.device))
+            nodes_per_type[ntype].append(
+                utils.prepare_tensor(graph, nids, 'nodes["{}"]'.format(ntype)))
+
+    induced_nodes = []
+    offsets = []
+    batch_num_nodes = {}
+    for ntype in graph.ntypes:
+        counts = [F.shape(nids)[0] for nids in nodes_per_type[ntype]]
+        induced_nodes.append(F.cat(nodes_per_type[ntype], 0) if len(counts) > 0
+                             else F.copy_to(F.tensor([], graph.idtype), graph.device))
+        offsets.append(F.copy_to(F.tensor([0] + list(np.cumsum(counts)), graph.idtype),
+                                 graph.device))
+        batch_num_nodes[ntype] = F.copy_to(F.tensor(counts, F.int64), graph.device)
+    sgi, edge_offsets = _CAPI_DGLBatchedNodeSubgraph(
+        graph._graph, [F.to_dgl_nd(nids) for nids in induced_nodes],
+        [F.to_dgl_nd(offset) for offset in offsets])
+    subg = _create_hetero_subgraph(
+        graph, sgi, induced_nodes, sgi.induced_edges, store_ids=store_ids)
+    batch_num_edges = {}
+    for etype, offset in zip(graph.canonical_etypes, edge_offsets):
+        offset = F.astype(F.from_dgl_nd(offset), F.int64)
+        num_subgraphs = F.shape(offset)[0] - 1
+        batch_num_edges[etype] = F.narrow_row(offset, 1, num_subgraphs + 1) - \
+            F.narrow_row(offset, 0, num_subgraphs)
+    subg.set_batch_num_nodes(batch_num_nodes)
+    subg.set_batch_num_edges(batch_num_edges)
+    return subg
+
+def batch_khop_subgraphs(graph, seeds_list, k, *, direction='both', store_ids=True):
+    """Return the batch of the subgraphs induced on the k-hop neighborhoods of
+    many sets of seed nodes, extracted at once, with the distances of their nodes
+    to the seeds.
+
+    This is meant for models working on enclosing subgraphs, e.g. SEAL, whose
+    seeds are the two ends of a link. The neighborhoods are expanded and the
+    subgraphs extracted in C++, in parallel over the sets of seeds on CPU, and
+    on GPU with the sizes of the frontiers as the only values copied to the host.
+
+    The nodes of each subgraph are its seeds in the given order, then the nodes
+    reached at each hop, by increasing ID. The distance of a node to a seed is
+    the shortest path length from the seed in the subgraph, not going through
+    the other seeds of the subgraph, as needed by the double-radius node
+    labeling (DRNL) of SEAL.
+
+    Parameters
+    ----------
+    graph : DGLGraph
+        The graph, with a single node type and a single edge type.
+    seeds_list : list[Tensor]
+        The seeds of every subgraph. The seeds of a subgraph must be unique.
+    k : int
+        The number of hops.
+    direction : str, optional
+        The edges followed to expand the neighborhoods: ``'in'`` for the
+        predecessors of the nodes, ``'out'`` for their successors, or ``'both'``.
+    store_ids : bool, optional
+        If True, the IDs of the extracted nodes and edges in the original graph
+        are stored as the ``dgl.NID`` and ``dgl.EID`` features of the result.
+
+    Returns
+    -------
+    DGLGraph
+        The batched subgraphs, on the device of the graph.
+    Tensor
+        The distances of the nodes of the batched subgraphs to the seeds of their
+        subgraph, of shape ``(N, S)``, with ``S`` the largest number of seeds of
+        a subgraph. The distance is -1 if there is no such path, or if the
+        subgraph has fewer seeds.
+
+    Examples
+    --------
+    >>> g = dgl.graph(([0, 1, 2, 3], [1, 2, 3, 4]))
+    >>> bg, dists = dgl.batch_khop_subgraphs(
+    ...     g, [torch.tensor([0, 1]), torch.tensor([3])], 1)
+    >>> bg.ndata[dgl.NID]
+    tensor([0, 1, 2, 3, 2, 4])
+    >>> bg.batch_num_nodes()
+    tensor([3, 3])
+    >>> bg.edges()
+    (tensor([0, 1, 3, 4]), tensor([1, 2, 5, 3]))
+    >>> dists
+    tensor([[ 0, -1],
+            [-1,  0],
+            [-1,  1],
+            [ 0, -1],
+            [ 1, -1],
+            [ 1, -1]])
+
+    See Also
+    --------
+    khop_in_subgraph
+    khop_out_subgraph
+    batch_node_subgraphs
+    """
+    if graph.is_block:
+        raise DGLError('Extracting subgraph from a block graph is not allowed.')
+    if len(graph.ntypes) != 1 or len(graph.etypes) != 1:
+        raise DGLError('The k-hop subgraphs are only supported on homogeneous graphs.')
+    if direction not in ('in', 'out', 'both'):
+        raise DGLError('Invalid direction {}, must be one of "in", "out" or "both".'.format(
+            direction))
+    seeds_list = [utils.prepare_tensor(graph, seeds, 'seeds') for seeds in seeds_list]
+    counts = [F.shape(seeds)[0] for seeds in seeds_list]
+    seeds = F.cat(seeds_list, 0) if len(counts) > 0 \
+        else F.copy_to(F.tensor([], graph.idtype), graph.device)
+    seed_offsets = F.copy_to(F.tensor([0] + list(np.cumsum(counts)), graph.idtype),
+                             graph.device)
+    sgi, node_offsets, edge_offsets, dists = _CAPI_DGLBatchedKHopSubgraph(
+        graph._graph, F.to_dgl_nd(seeds), F.to_dgl_nd(seed_offsets), k, direction)
+    subg = _create_hetero_subgraph(
+        graph, sgi, sgi.induced_nodes, sgi.induced_edges, store_ids=store_ids)
+    num_subgraphs = len(counts)
+    batch_num = []
+    for offset in (node_offsets, edge_offsets):
+        offset = F.astype(F.from_dgl_nd(offset), F.int64)
+        batch_num.append(F.narrow_row(offset, 1, num_subgraphs + 1) -
+                         F.narrow_row(offset, 0, num_subgraphs))
+    subg.set_batch_num_nodes(batch_num[0])
+    subg.set_batch_num_edges(batch_num[1])
+    return subg, F.from_dgl_nd(dists)
+
 def edge_subgraph(graph, edges, *, relabel_nodes=True, store_ids=True, **deprecated_kwargs):
     """Return a subgraph induced on the given edges.
 
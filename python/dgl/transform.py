@@ -27,12 +27,12 @@ from . import convert
 from .heterograph import DGLHeteroGraph, DGLBlock
 from .heterograph_index import create_metagraph_index, create_heterograph_from_relations
 from .frame import Frame
-from . import ndarray as nd
 from . import backend as F
 from . import utils, batch
 from .partition import metis_partition_assignment
 from .partition import partition_graph_with_halo
 from .partition import metis_partition
+from .partition import streaming_partition_assignment
 from . import subgraph
 
 # TO BE DEPRECATED
@@ -66,8 +66,10 @@ __all__ = [
     'metis_partition_assignment',
     'partition_graph_with_halo',
     'metis_partition',
+    'streaming_partition_assignment',
     'as_heterograph',
     'adj_product_graph',
+    'masked_adj_product',
     'adj_sum_graph',
     'reorder_graph'
     ]
@@ -422,7 +424,7 @@ def _segmented_knn_graph_blas(x, k, segs, dist='euclidean'):
     return convert.graph((F.reshape(src, (-1,)), F.reshape(dst, (-1,))))
 
 def _nndescent_knn_graph(x, k, segs, num_iters=None, max_candidates=None,
-                         delta=0.001, sample_rate=0.5, dist='euclidean'):
+                         delta=0.001, sample_rate=0.5, dist='euclidean', device=None):
     r"""Construct multiple graphs from multiple sets of points according to
     **approximate** k-nearest-neighbor using NN-descent algorithm from paper
     `Efficient k-nearest neighbor graph construction for generic similarity
@@ -463,6 +465,10 @@ def _nndescent_knn_graph(x, k, segs, num_iters=None, max_candidates=None,
         * 'euclidean': Use Euclidean distance (L2 norm) :math:`\sqrt{\sum_{i} (x_{i} - y_{i})^{2}}`.
         * 'cosine': Use cosine distance.
         (default: 'euclidean')
+    device : Device context, optional
+        The GPU to run on when :attr:`x` is on CPU. The points are then pinned and
+        read from host memory.
+        (default: None, i.e. the device of :attr:`x`)
 
     Returns
     -------
@@ -470,9 +476,13 @@ def _nndescent_knn_graph(x, k, segs, num_iters=None, max_candidates=None,
         The graph. The node IDs are in the same order as :attr:`x`.
     """
     num_points, _ = F.shape(x)
+    if device is None:
+        device = F.context(x)
+    if F.device_type(F.context(x)) != 'cpu' and F.context(x) != device:
+        raise DGLError("'x' must be on CPU or on the device to run on.")
     if isinstance(segs, (tuple, list)):
         segs = F.tensor(segs)
-    segs = F.copy_to(segs, F.context(x))
+    segs = F.copy_to(segs, device)
 
     if max_candidates is None:
         max_candidates = min(60, k)
@@ -497,13 +507,22 @@ def _nndescent_knn_graph(x, k, segs, num_iters=None, max_candidates=None,
     offset[1:] = F.cumsum(segs, dim=0)
     out = F.zeros((2, num_points * k), F.dtype(segs), F.context(segs))
 
-    # points, offsets, out, k, num_iters, max_candidates, delta
-    _CAPI_DGLNNDescent(F.to_dgl_nd(x), F.to_dgl_nd(offset),
-                       F.zerocopy_to_dgl_ndarray_for_write(out),
-                       k, num_iters, max_candidates, delta)
+    x_nd = F.to_dgl_nd(x)
+    pinned = F.context(x) != device
+    if pinned:
+        x_nd.pin_memory_(utils.to_dgl_context(device))
+    try:
+        # points, offsets, out, k, num_iters, max_candidates, delta
+        _CAPI_DGLNNDescent(x_nd, F.to_dgl_nd(offset),
+                           F.zerocopy_to_dgl_ndarray_for_write(out),
+                           k, num_iters, max_candidates, delta)
+    finally:
+        if pinned:
+            x_nd.unpin_memory_(utils.to_dgl_context(device))
     return out
 
-def knn(k, x, x_segs, y=None, y_segs=None, algorithm='bruteforce', dist='euclidean'):
+def knn(k, x, x_segs, y=None, y_segs=None, algorithm='bruteforce', dist='euclidean',
+        device=None):
     r"""For each element in each segment in :attr:`y`, find :attr:`k` nearest
     points in the same segment in :attr:`x`. If :attr:`y` is None, perform a self-query
     over :attr:`x`.
@@ -562,6 +581,12 @@ def knn(k, x, x_segs, y=None, y_segs=None, algorithm='bruteforce', dist='euclide
         * 'euclidean': Use Euclidean distance (L2 norm) :math:`\sqrt{\sum_{i} (x_{i} - y_{i})^{2}}`.
         * 'cosine': Use cosine distance.
         (default: 'euclidean')
+    device : Device context, optional
+        The GPU on which 'nn-descent' runs for points on CPU. The points stay in
+        host memory, pinned during the call, so that their number is not bounded
+        by the memory of the GPU. The result is on this device. Only supported
+        by 'nn-descent'.
+        (default: None, i.e. the device of :attr:`x`)
 
     Returns
     -------
@@ -574,7 +599,9 @@ def knn(k, x, x_segs, y=None, y_segs=None, algorithm='bruteforce', dist='euclide
     if algorithm == "nn-descent":
         if y is not None or y_segs is not None:
             raise DGLError("Currently 'nn-descent' only supports self-query cases.")
-        return _nndescent_knn_graph(x, k, x_segs, dist=dist)
+        return _nndescent_knn_graph(x, k, x_segs, dist=dist, device=device)
+    if device is not None:
+        raise DGLError("Only 'nn-descent' supports running on another device than 'x'.")
 
     # self query
     if y is None:
@@ -894,7 +921,6 @@ def line_graph(g, backtracking=True, shared=False):
     * If :attr:`shared` is True, the node features of the resulting graph share the same
       storage with the edge features of the input graph. Hence, users should try to
       avoid in-place operations which will be visible to both graphs.
-    * The function supports input graph on GPU but copies it to CPU during computation.
     * This function discards the batch information. Please use
       :func:`dgl.DGLGraph.set_batch_num_nodes`
       and :func:`dgl.DGLGraph.set_batch_num_edges` on the transformed graph
@@ -927,9 +953,7 @@ def line_graph(g, backtracking=True, shared=False):
     assert g.is_homogeneous, \
         'only homogeneous graph is supported'
 
-    dev = g.device
-    lg = DGLHeteroGraph(_CAPI_DGLHeteroLineGraph(g._graph.copy_to(nd.cpu()), backtracking))
-    lg = lg.to(dev)
+    lg = DGLHeteroGraph(_CAPI_DGLHeteroLineGraph(g._graph, backtracking))
     if shared:
         new_frames = utils.extract_edge_subframes(g, None)
         utils.set_new_frames(lg, node_frames=new_frames)
@@ -2513,7 +2537,7 @@ def _unitgraph_less_than_int32(g):
     num_nodes = max(g.num_nodes(g.ntypes[0]), g.num_nodes(g.ntypes[-1]))
     return max(num_nodes, num_edges) <= (1 << 31) - 1
 
-def adj_product_graph(A, B, weight_name, etype='_E'):
+def adj_product_graph(A, B, weight_name, etype='_E', topk=None):
     r"""Create a weighted graph whose adjacency matrix is the product of
     the adjacency matrices of the given two graphs.
 
@@ -2558,6 +2582,12 @@ def adj_product_graph(A, B, weight_name, etype='_E'):
         The corresponding edge feature must be scalar.
     etype : str, optional
         The edge type of the returned graph.
+    topk : int, optional
+        If given, only keep the :attr:`topk` edges of largest weight out of every
+        source node, the ones of smallest destination node first among equal
+        weights, to bound the size of the product of dense graphs.  The rows
+        are pruned while they are computed, so that the full product is never
+        stored.  Only supported on CPU.
 
     Returns
     -------
@@ -2628,6 +2658,12 @@ def adj_product_graph(A, B, weight_name, etype='_E'):
     >>> C = dgl.adj_product_graph(A, B, 'w')
     >>> C.ntypes
     ['A', 'C']
+
+    Keep the single heaviest edge out of every source node.
+
+    >>> C = dgl.adj_product_graph(A, B, 'w', topk=1)
+    >>> C.out_degrees()
+    tensor([1, 1, 1])
     """
     srctype, _, _ = A.canonical_etypes[0]
     _, _, dsttype = B.canonical_etypes[0]
@@ -2639,8 +2675,11 @@ def adj_product_graph(A, B, weight_name, etype='_E'):
             raise ValueError(
                 'For GPU graphs the number of nodes and edges must be less than 2 ** 31 - 1.')
 
+    if topk is not None and topk < 0:
+        raise DGLError('Invalid topk {}, must be non-negative.'.format(topk))
     C_gidx, C_weights = F.csrmm(
-        A._graph, A.edata[weight_name], B._graph, B.edata[weight_name], num_vtypes)
+        A._graph, A.edata[weight_name], B._graph, B.edata[weight_name], num_vtypes,
+        -1 if topk is None else topk)
     num_nodes_dict = {srctype: A.num_nodes(srctype), dsttype: B.num_nodes(dsttype)}
     C_metagraph, ntypes, etypes, _ = \
         create_metagraph_index(ntypes, [(srctype, etype, dsttype)])
@@ -2652,6 +2691,65 @@ def adj_product_graph(A, B, weight_name, etype='_E'):
     C.edata[weight_name] = C_weights
     return C
 
+def masked_adj_product(A, B, mask, weight_name):
+    r"""Compute the entries of the product of the adjacency matrices of the
+    given two graphs at the edges of a third graph only.
+
+    Namely, given two weighted graphs :attr:`A` and :attr:`B` as in
+    :func:`adj_product_graph`, this function returns the entries of
+    :math:`\mathrm{adj}(A) \times \mathrm{adj}(B)` at the edges of :attr:`mask`,
+    without computing the rest of the product. Every entry is the dot product of
+    a row of :math:`\mathrm{adj}(A)` and a column of :math:`\mathrm{adj}(B)`,
+    computed by intersecting their sorted nonzeros, so that the cost grows with
+    the degrees of the nodes of the mask rather than with the size of the
+    product, e.g. to count the common neighbors of the candidate edges of a
+    graph whose square is too large to store.
+
+    The two graphs must be simple graphs, and all the three graphs must have only
+    one edge type. The source nodes of :attr:`mask` are those of :attr:`A` and
+    its destination nodes are those of :attr:`B`.
+
+    Notes
+    -----
+    This function works on both CPU and GPU.
+
+    The returned weights are differentiable w.r.t. the input edge weights.
+
+    If the graph format is restricted, :attr:`A` must have CSR and :attr:`B`
+    must have CSC available.
+
+    Parameters
+    ----------
+    A : DGLGraph
+        The graph as left operand.
+    B : DGLGraph
+        The graph as right operand.
+    mask : DGLGraph
+        The graph whose edges are the entries to compute.
+    weight_name : str
+        The feature name of edge weight of both :attr:`A` and :attr:`B`.
+
+        The corresponding edge feature must be scalar.
+
+    Returns
+    -------
+    Tensor
+        The entries of the product at the edges of :attr:`mask`, in the order of
+        its edge IDs.
+
+    Examples
+    --------
+    Count the common neighbors of the pairs of nodes of a graph.
+
+    >>> g = dgl.graph(([0, 0, 1, 2], [1, 2, 2, 0]))
+    >>> g.edata['w'] = torch.ones(4)
+    >>> pairs = dgl.graph(([0, 1, 2], [2, 1, 1]), num_nodes=3)
+    >>> dgl.masked_adj_product(g, g, pairs, 'w')
+    tensor([1., 0., 1.])
+    """
+    return F.csrmaskedmm(
+        A._graph, A.edata[weight_name], B._graph, B.edata[weight_name], mask._graph)
+
 def adj_sum_graph(graphs, weight_name):
     r"""Create a weighted graph whose adjacency matrix is the sum of the
     adjacency matrices of the given graphs, whose rows represent source nodes
@@ -2977,13 +3075,22 @@ def reorder_graph(g, node_permute_algo='rcmk', edge_permute_algo='src',
     g : DGLGraph
         The homogeneous graph.
     node_permute_algo: str, optional
-        The permutation algorithm to re-order nodes. Options are ``rcmk`` or
-        ``metis`` or ``custom``. ``rcmk`` is the default value.
+        The permutation algorithm to re-order nodes. Options are ``rcmk``, ``degree``,
+        ``rabbit``, ``metis`` or ``custom``. ``rcmk`` is the default value.
+
+        The ``rcmk``, ``degree`` and ``rabbit`` orders are computed in parallel in C++,
+        taking the edges as undirected, and break the ties by node ID.
 
         * ``rcmk``: Use the `Reverse Cuthill–McKee <https://docs.scipy.org/doc/scipy/reference/
           generated/scipy.sparse.csgraph.reverse_cuthill_mckee.html#
-          scipy-sparse-csgraph-reverse-cuthill-mckee>`__ from ``scipy`` to generate nodes
-          permutation.
+          scipy-sparse-csgraph-reverse-cuthill-mckee>`__ order, starting every component
+          from its node of smallest degree, which reduces the bandwidth of the adjacency
+          matrix.
+        * ``degree``: Sort the nodes by decreasing degree, so that the features of the
+          high-degree nodes are packed together.
+        * ``rabbit``: Use the `Rabbit order <https://ieeexplore.ieee.org/document/7516041>`__,
+          which merges the nodes into communities greedily by modularity, and places the
+          nodes of every community together.
         * ``metis``: Use the :func:`~dgl.metis_partition_assignment` function
           to partition the input graph, which gives a cluster assignment of each node.
           DGL then sorts the assignment array so the new node order will put nodes of
@@ -3003,7 +3110,7 @@ def reorder_graph(g, node_permute_algo='rcmk', edge_permute_algo='src',
     permute_config: dict, optional
         Additional key-value config data for the specified permutation algorithm.
 
-        * For ``rcmk``, this argument is not required.
+        * For ``rcmk``, ``degree`` and ``rabbit``, this argument is not required.
         * For ``metis``, users should specify the number of partitions ``k`` (e.g.,
           ``permute_config={'k':10}`` to partition the graph to 10 clusters).
         * For ``custom``, users should provide a node permutation array ``nodes_perm``.
@@ -3105,7 +3212,7 @@ def reorder_graph(g, node_permute_algo='rcmk', edge_permute_algo='src',
     # sanity checks
     if not g.is_homogeneous:
         raise DGLError("Homograph is supported only.")
-    expected_node_algo = ['rcmk', 'metis', 'custom']
+    expected_node_algo = ['rcmk', 'degree', 'rabbit', 'metis', 'custom']
     if node_permute_algo not in expected_node_algo:
         raise DGLError("Unexpected node_permute_algo is specified: {}. Expected algos: {}".format(
             node_permute_algo, expected_node_algo))
@@ -3115,8 +3222,8 @@ def reorder_graph(g, node_permute_algo='rcmk', edge_permute_algo='src',
             edge_permute_algo, expected_edge_algo))
 
     # generate nodes permutation
-    if node_permute_algo == 'rcmk':
-        nodes_perm = rcmk_perm(g)
+    if node_permute_algo in ('rcmk', 'degree', 'rabbit'):
+        nodes_perm = native_perm(g, node_permute_algo)
     elif node_permute_algo == 'metis':
         if permute_config is None or 'k' not in permute_config:
             raise DGLError(
@@ -3174,8 +3281,9 @@ def metis_perm(g, k):
     return np.argsort(pids).copy()
 
 
-def rcmk_perm(g):
-    r"""Return nodes permutation according to ``'rcmk'`` algorithm.
+def native_perm(g, algo):
+    r"""Return nodes permutation according to the ``'rcmk'``, ``'degree'`` or
+    ``'rabbit'`` algorithm, computed in C++.
 
     For internal use.
 
@@ -3183,18 +3291,16 @@ def rcmk_perm(g):
     ----------
     g : DGLGraph
         The homogeneous graph.
+    algo : str
+        The algorithm.
 
     Returns
     -------
-    iterable[int]
-        The nodes permutation.
+    Tensor
+        The nodes permutation, on the device of the graph.
     """
-    fmat = 'csr'
-    allowed_fmats = sum(g.formats().values(), [])
-    if fmat not in allowed_fmats:
-        g = g.formats(allowed_fmats + [fmat])
-    csr_adj = g.adj(scipy_fmt=fmat)
-    perm = sparse.csgraph.reverse_cuthill_mckee(csr_adj)
-    return perm.copy()
+    cpu_g = g if g.device == F.cpu() else g.to(F.cpu())
+    perm = F.from_dgl_nd(_CAPI_DGLNodeOrder(cpu_g._graph, algo))
+    return F.copy_to(perm, g.device)
 
 _init_api("dgl.transform")
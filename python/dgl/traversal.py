@@ -10,6 +10,15 @@ __all__ = ['bfs_nodes_generator', 'bfs_edges_generator',
            'topological_nodes_generator',
            'dfs_edges_generator', 'dfs_labeled_edges_generator',]
 
+def _prepare_bfs_inputs(graph, source):
+    """Return the graph index and the source nodes to traverse, on the GPU of
+    the graph or on the CPU."""
+    source = utils.toindex(source, dtype=graph._idtype_str).tousertensor()
+    if F.device_type(graph.device) == 'cuda':
+        return graph._graph, F.to_dgl_nd(F.copy_to(source, graph.device))
+    # the graph is traversed on the CPU, with its in-edges if it has them
+    return graph._graph.copy_to(utils.to_dgl_context(F.cpu())), F.to_dgl_nd(source)
+
 def bfs_nodes_generator(graph, source, reverse=False):
     """Node frontiers generator using breadth-first search.
 
@@ -44,11 +53,9 @@ def bfs_nodes_generator(graph, source, reverse=False):
         'DGLGraph is deprecated, Please use DGLHeteroGraph'
     assert len(graph.canonical_etypes) == 1, \
         'bfs_nodes_generator only support homogeneous graph'
-    # Workaround before support for GPU graph
-    gidx = graph._graph.copy_to(utils.to_dgl_context(F.cpu()))
-    source = utils.toindex(source, dtype=graph._idtype_str)
-    ret = _CAPI_DGLBFSNodes_v2(gidx, source.todgltensor(), reverse)
-    all_nodes = utils.toindex(ret(0), dtype=graph._idtype_str).tousertensor()
+    gidx, source = _prepare_bfs_inputs(graph, source)
+    ret = _CAPI_DGLBFSNodes_v2(gidx, source, reverse)
+    all_nodes = F.from_dgl_nd(ret(0))
     # TODO(minjie): how to support directly creating python list
     sections = utils.toindex(ret(1)).tonumpy().tolist()
     node_frontiers = F.split(all_nodes, sections, dim=0)
@@ -89,11 +96,9 @@ def bfs_edges_generator(graph, source, reverse=False):
         'DGLGraph is deprecated, Please use DGLHeteroGraph'
     assert len(graph.canonical_etypes) == 1, \
         'bfs_edges_generator only support homogeneous graph'
-    # Workaround before support for GPU graph
-    gidx = graph._graph.copy_to(utils.to_dgl_context(F.cpu()))
-    source = utils.toindex(source, dtype=graph._idtype_str)
-    ret = _CAPI_DGLBFSEdges_v2(gidx, source.todgltensor(), reverse)
-    all_edges = utils.toindex(ret(0), dtype=graph._idtype_str).tousertensor()
+    gidx, source = _prepare_bfs_inputs(graph, source)
+    ret = _CAPI_DGLBFSEdges_v2(gidx, source, reverse)
+    all_edges = F.from_dgl_nd(ret(0))
     # TODO(minjie): how to support directly creating python list
     sections = utils.toindex(ret(1)).tonumpy().tolist()
     edge_frontiers = F.split(all_edges, sections, dim=0)
@@ -131,10 +136,12 @@ def topological_nodes_generator(graph, reverse=False):
         'DGLGraph is deprecated, Please use DGLHeteroGraph'
     assert len(graph.canonical_etypes) == 1, \
         'topological_nodes_generator only support homogeneous graph'
-    # Workaround before support for GPU graph
-    gidx = graph._graph.copy_to(utils.to_dgl_context(F.cpu()))
+    if F.device_type(graph.device) == 'cuda':
+        gidx = graph._graph
+    else:
+        gidx = graph._graph.copy_to(utils.to_dgl_context(F.cpu()))
     ret = _CAPI_DGLTopologicalNodes_v2(gidx, reverse)
-    all_nodes = utils.toindex(ret(0), dtype=graph._idtype_str).tousertensor()
+    all_nodes = F.from_dgl_nd(ret(0))
     # TODO(minjie): how to support directly creating python list
     sections = utils.toindex(ret(1)).tonumpy().tolist()
     return F.split(all_nodes, sections, dim=0)
@@ -4,3 +4,4 @@ from .data import *
 from .checks import *
 from .shared_mem import *
 from .filter import *
+from .async_call import *
@@ -0,0 +1,113 @@
+"""Calling the C APIs asynchronously on the worker threads of the runtime."""
+from __future__ import absolute_import
+import atexit
+import time
+
+from .. import backend as F
+from .._ffi.object import ObjectBase, register_object
+from .._ffi.function import _init_api, _FunctionBase
+
+__all__ = ['async_call', 'Future']
+
+_init_api("dgl.utils.async_call")
+
+# The Cython FFI holds the GIL in the C APIs, which the Python functions called
+# by the workers need, so the futures are polled instead of waited for.
+_FFI_HOLDS_GIL = not _FunctionBase.__module__.startswith('dgl._ffi._ctypes')
+_POLL_INTERVAL = 1e-4
+
+
+def async_call(func, *args):
+    """Call a function on the worker threads of the runtime, and return a
+    :class:`Future` of its result right away.
+
+    The function is typically a C API, e.g. of a sampler, which then runs without
+    the GIL while the caller goes on, e.g. to train on the previous minibatch. A
+    Python function may also be given, which holds the GIL except in the C APIs
+    it calls, and which must return a value a C API could, e.g. a DGL NDArray or
+    a graph index rather than a DGLGraph.
+
+    The arguments are kept alive by the call. The framework tensors among them
+    are passed as DGL NDArrays, and the futures are replaced by their results,
+    the call starting once they are done: see :meth:`Future.then`.
+
+    The number of worker threads is given by the environment variable
+    ``DGL_ASYNC_CALL_THREADS``, 1 by default, so that the calls run in the order
+    they are made. The pending calls are waited for at exit.
+
+    Parameters
+    ----------
+    func : Function or callable
+        The function to call.
+    args
+        The arguments of the function.
+
+    Returns
+    -------
+    Future
+        The future of the result, as returned by the C API.
+
+    Examples
+    --------
+    Sample the next minibatch while training on the current one, with the
+    arguments of the C API as prepared by :func:`dgl.sampling.sample_neighbors`:
+
+    >>> from dgl.sampling.neighbor import _CAPI_DGLSampleNeighbors
+    >>> future = dgl.utils.async_call(_CAPI_DGLSampleNeighbors, g._graph, *capi_args)
+    >>> train(block)
+    >>> subgidx = future.wait()
+    >>> frontier = DGLHeteroGraph(subgidx.graph, g.ntypes, g.etypes)
+    """
+    args = [F.zerocopy_to_dgl_ndarray(arg) if F.is_tensor(arg) else arg for arg in args]
+    return _CAPI_DGLAsyncCall(func, *args)
+
+
+@register_object("runtime.Future")
+class Future(ObjectBase):
+    """Future of the result of a call made by :func:`async_call`."""
+
+    def done(self):
+        """Return whether the call has finished, successfully or not."""
+        return bool(_CAPI_DGLFutureDone(self))
+
+    def wait(self):
+        """Wait for the call to finish and return its result.
+
+        Raises
+        ------
+        DGLError
+            If the call failed, or one of the futures it was passed.
+        """
+        if _FFI_HOLDS_GIL:
+            while not self.done():
+                time.sleep(_POLL_INTERVAL)
+        return _CAPI_DGLFutureWait(self)
+
+    def then(self, func, *args):
+        """Call a function on the result of this call once it is done, without
+        waiting for it.
+
+        Parameters
+        ----------
+        func : Function or callable
+            The function to call, with the result as first argument.
+        args
+            The other arguments of the function.
+
+        Returns
+        -------
+        Future
+            The future of the result of the function.
+        """
+        return async_call(func, self, *args)
+
+
+def wait_all():
+    """Wait for all the calls made by :func:`async_call` to finish."""
+    if _FFI_HOLDS_GIL:
+        while _CAPI_DGLNumPendingAsyncCalls() > 0:
+            time.sleep(_POLL_INTERVAL)
+    _CAPI_DGLWaitAllAsyncCalls()
+
+# the worker threads do not keep the interpreter alive
+atexit.register(wait_all)
@@ -11,7 +11,8 @@ def prepare_tensor(g, data, name):
     """Convert the data to ID tensor and check its ID type and context.
 
     If the data is already in tensor type, raise error if its ID type
-    and context does not match the graph's.
+    and context does not match the graph's. The tensors of a graph pinned by
+    :func:`DGLGraph.pin_memory_` may also be on the GPU.
     Otherwise, convert it to tensor type of the graph's ID type and
     ctx and return.
 
@@ -30,7 +31,8 @@ def prepare_tensor(g, data, name):
         Data in tensor object.
     """
     if F.is_tensor(data):
-        if F.dtype(data) != g.idtype or F.context(data) != g.device:
+        if F.dtype(data) != g.idtype or \
+                (F.context(data) != g.device and not g.is_pinned()):
             raise DGLError('Expect argument "{}" to have data type {} and device '
                            'context {}. But got {} and {}.'.format(
                                name, g.idtype, g.device, F.dtype(data), F.context(data)))
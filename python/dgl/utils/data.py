@@ -108,7 +108,7 @@ def networkx2tensor(nx_graph, idtype, edge_id_attr_name=None):
 
 SparseAdjTuple = namedtuple('SparseAdjTuple', ['format', 'arrays'])
 
-def graphdata2tensors(data, idtype=None, bipartite=False, **kwargs):
+def graphdata2tensors(data, idtype=None, bipartite=False, infer_nodes=True, **kwargs):
     """Function to convert various types of data to edge tensors and infer
     the number of nodes.
 
@@ -129,6 +129,9 @@ def graphdata2tensors(data, idtype=None, bipartite=False, **kwargs):
     bipartite : bool, optional
         Whether infer number of nodes of a bipartite graph --
         num_src and num_dst can be different.
+    infer_nodes : bool, optional
+        Whether to infer the number of nodes of the edge tensors, which scans
+        them. If False, the numbers of nodes are None for the edge tensors.
     kwargs
 
         - edge_id_attr_name : The name (str) of the edge attribute that stores the edge
@@ -174,7 +177,10 @@ def graphdata2tensors(data, idtype=None, bipartite=False, **kwargs):
     if isinstance(data, SparseAdjTuple):
         if idtype is not None:
             data = SparseAdjTuple(data.format, tuple(F.astype(a, idtype) for a in data.arrays))
-        num_src, num_dst = infer_num_nodes(data, bipartite=bipartite)
+        if infer_nodes:
+            num_src, num_dst = infer_num_nodes(data, bipartite=bipartite)
+        else:
+            num_src = num_dst = None
     elif isinstance(data, list):
         src, dst = elist2tensor(data, idtype)
         data = SparseAdjTuple('coo', (src, dst))
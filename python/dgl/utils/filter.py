@@ -21,8 +21,7 @@ class Filter(object):
     tensor([0,2], device='cuda')
     """
     def __init__(self, ids):
-        """Create a new filter from a given set of IDs. This currently is only
-        implemented for the GPU.
+        """Create a new filter from a given set of IDs.
 
         Parameters
         ----------
@@ -759,6 +759,37 @@ def relabel(x):
                                F.copy_to(F.arange(0, len(unique_x), dtype), ctx))
     return unique_x, old_to_new
 
+def unique_with_counts(ids):
+    """Find the unique IDs of a tensor in the order of their first occurrence,
+    together with the inverse indices and the number of occurrences of every
+    unique ID, in a single pass over a hash table on the device of the tensor.
+
+    The unique IDs are in the same order as the ones of the relabeling of
+    :func:`dgl.to_block` and :func:`dgl.compact_graphs`, unlike ``F.unique``
+    which sorts them.
+
+    Examples
+    --------
+    >>> unique_with_counts(torch.tensor([2, 3, 10, 0, 2, 10]))
+    (tensor([ 2,  3, 10,  0]), tensor([0, 1, 2, 3, 0, 2]), tensor([2, 1, 2, 1]))
+
+    Parameters
+    ----------
+    ids : Tensor
+        The 1D ID tensor.
+
+    Returns
+    -------
+    unique : Tensor
+        The unique IDs.
+    inverse : Tensor
+        The index of every ID in :attr:`unique`, i.e. ``unique[inverse] == ids``.
+    counts : Tensor
+        The number of occurrences of every unique ID.
+    """
+    ret = _CAPI_DGLArrayUnique(F.to_dgl_nd(ids))
+    return F.from_dgl_nd(ret(0)), F.from_dgl_nd(ret(1)), F.from_dgl_nd(ret(2))
+
 def extract_node_subframes(graph, nodes, store_ids=True):
     """Extract node features of the given nodes from :attr:`graph`
     and return them in frames.
@@ -902,6 +933,222 @@ def set_num_threads(num_threads):
     """
     _CAPI_DGLSetOMPThreads(num_threads)
 
+def numa_interleave(tensor):
+    """Interleave the memory of a CPU tensor across the NUMA nodes.
+
+    It is useful for large feature tensors read by all the threads, e.g. the
+    node features of SpMM, together with the NUMA mode of the CPU kernels
+    enabled by the environment variable ``DGL_CPU_NUMA_ENABLED=1``. It does
+    nothing on machines with a single NUMA node.
+
+    Parameters
+    ----------
+    tensor : Tensor
+        The contiguous CPU tensor.
+
+    Returns
+    -------
+    Tensor
+        The same tensor.
+    """
+    _CAPI_DGLNumaInterleave(F.zerocopy_to_dgl_ndarray(tensor))
+    return tensor
+
+def cpu_allocator_stats():
+    """Get the counters of the caching allocator of the CPU arrays.
+
+    The caching allocator is opt-in, by setting the environment variable
+    ``DGL_CPU_ALLOC_CACHE_BYTES`` to the size of the freed arrays kept at most
+    for reuse. It only serves the arrays allocated by DGL, not those of the
+    framework when the tensor adapter is loaded.
+
+    Returns
+    -------
+    dict
+        Whether the allocator is ``enabled``, the number of ``allocs`` and of
+        the ``hits`` among them served from the cache, the ``bytes_in_use``
+        and ``peak_bytes_in_use`` by the arrays, the ``bytes_cached`` by the
+        freed arrays, and the number of freed arrays ``released`` to the
+        system.
+    """
+    stats = [int(x) for x in _CAPI_DGLCPUAllocatorStats().asnumpy()]
+    keys = ['enabled', 'allocs', 'hits', 'bytes_in_use', 'peak_bytes_in_use',
+            'bytes_cached', 'released']
+    ret = dict(zip(keys, stats))
+    ret['enabled'] = bool(ret['enabled'])
+    return ret
+
+def set_cpu_allocator_cache(cap_bytes):
+    """Change the size of the freed CPU arrays kept by the caching allocator,
+    releasing those beyond it. It does nothing if the allocator is disabled.
+
+    Parameters
+    ----------
+    cap_bytes : int
+        The size kept at most.
+    """
+    _CAPI_DGLCPUAllocatorSetCap(int(cap_bytes))
+
+def empty_cpu_allocator_cache():
+    """Release the freed CPU arrays kept by the caching allocator.
+
+    The small arrays kept by the other threads are not released.
+    """
+    _CAPI_DGLCPUAllocatorEmptyCache()
+
+def enable_memory_tracking(enabled=True):
+    """Enable or disable the accounting of the memory held and copied by DGL.
+
+    It is also enabled by setting the environment variable
+    ``DGL_MEMORY_TRACKING=1``. The memory allocated while it is disabled is not
+    counted.
+
+    Parameters
+    ----------
+    enabled : bool
+        Whether to count the allocations and the copies.
+    """
+    _CAPI_DGLMemoryTrackerSetEnabled(bool(enabled))
+
+def memory_stats():
+    """Get the counters of the memory held and copied by DGL, see
+    :func:`enable_memory_tracking`.
+
+    The arrays allocated by DGL are counted, including those allocated by the
+    framework on behalf of DGL when the tensor adapter is loaded, but not the
+    tensors of the framework passed to DGL.
+
+    Returns
+    -------
+    dict
+        Whether the tracker is ``enabled``, and
+
+        * ``devices`` and ``tags``: the ``bytes`` held, the ``peak_bytes`` and
+          the number of ``allocs``, by device (e.g. ``'cpu'``, ``'gpu:0'``)
+          and by what they are allocated for, i.e. the ``'graph'`` formats,
+          the ``'sampler'`` arrays, the ``'workspace'`` of the devices or
+          ``'other'``;
+        * ``copies``: the ``bytes`` copied and the number of ``copies`` by
+          direction, e.g. ``'cpu->gpu'``;
+        * ``conversions``: the number of conversions of the sparse formats of
+          the graphs, e.g. ``'coo->csr'``.
+    """
+    stats = [int(x) for x in _CAPI_DGLMemoryTrackerStats().asnumpy()]
+    max_gpus, formats = 32, [None, 'coo', 'csr', 'csc']
+    kinds, tags = ['cpu', 'gpu'], ['other', 'graph', 'sampler', 'workspace']
+    def _usages(pos, num):
+        return [dict(zip(['bytes', 'peak_bytes', 'allocs'], stats[pos + 3 * i:pos + 3 * i + 3]))
+                for i in range(num)]
+    pos = 1
+    devices = _usages(pos, max_gpus + 1)
+    pos += 3 * (max_gpus + 1)
+    ret = {'enabled': bool(stats[0]), 'devices': {'cpu': devices[0]}}
+    for i, usage in enumerate(devices[1:]):
+        if usage['peak_bytes'] > 0 or usage['allocs'] > 0:
+            ret['devices']['gpu:{}'.format(i)] = usage
+    ret['tags'] = dict(zip(tags, _usages(pos, len(tags))))
+    pos += 3 * len(tags)
+    num_kinds = len(kinds) ** 2
+    ret['copies'] = {}
+    for i in range(num_kinds):
+        ret['copies']['{}->{}'.format(kinds[i // 2], kinds[i % 2])] = {
+            'bytes': stats[pos + i], 'copies': stats[pos + num_kinds + i]}
+    pos += 2 * num_kinds
+    ret['conversions'] = {}
+    for i, src in enumerate(formats):
+        for j, dst in enumerate(formats):
+            if src is not None and dst is not None and src != dst:
+                ret['conversions']['{}->{}'.format(src, dst)] = stats[pos + 4 * i + j]
+    return ret
+
+def reset_memory_stats():
+    """Reset the peaks of :func:`memory_stats` to the bytes held, and its other
+    counters to zero."""
+    _CAPI_DGLMemoryTrackerReset()
+
+_SAMPLING_STAGES = ['sample_neighbors', 'exclude_edges', 'to_block', 'gather', 'copy_to']
+_STAGE_COUNTERS = ['calls', 'seeds', 'edges', 'bytes', 'wall_ns', 'cpu_ns', 'thread_ns']
+
+def enable_stage_tracking(enabled=True, trace=False):
+    """Enable or disable the timers and counters of the stages of the sampling
+    pipelines, i.e. the neighbor sampling, the exclusion of edges, the
+    conversion to blocks, the gathering of the features and the copies to
+    another device.
+
+    They are also enabled by setting the environment variables
+    ``DGL_STAGE_TRACKING=1`` and ``DGL_STAGE_TRACE=1``.
+
+    Parameters
+    ----------
+    enabled : bool
+        Whether to count the calls of the stages, see :func:`stage_stats`.
+    trace : bool
+        Whether to record every call in a trace, see :func:`stage_trace`.
+    """
+    _CAPI_DGLStageTrackerSetEnabled(bool(enabled), bool(trace))
+
+def stage_stats():
+    """Get the counters of the stages of the sampling pipelines, see
+    :func:`enable_stage_tracking`.
+
+    The stages may nest, e.g. ``exclude_edges`` within ``sample_neighbors``,
+    and the stages on GPU are timed on the host.
+
+    Returns
+    -------
+    dict
+        Whether the tracker is ``enabled`` and ``tracing``, and ``stages``, the
+        counters of ``'sample_neighbors'``, ``'exclude_edges'``, ``'to_block'``,
+        ``'gather'`` and ``'copy_to'``: the numbers of ``calls``, of ``seeds`` and
+        of ``edges`` produced, the ``bytes`` gathered or copied, the ``wall_ns``
+        and the ``cpu_ns`` of the process during the calls, and their
+        ``utilization`` of the threads, i.e. ``cpu_ns`` over ``wall_ns`` times
+        the number of threads.
+    """
+    stats = [int(x) for x in _CAPI_DGLStageTrackerStats().asnumpy()]
+    ret = {'enabled': bool(stats[0]), 'tracing': bool(stats[1]), 'stages': {}}
+    num = len(_STAGE_COUNTERS)
+    for i, stage in enumerate(_SAMPLING_STAGES):
+        counters = dict(zip(_STAGE_COUNTERS, stats[2 + num * i:2 + num * (i + 1)]))
+        thread_ns = counters.pop('thread_ns')
+        counters['utilization'] = counters['cpu_ns'] / thread_ns if thread_ns > 0 else 0.
+        ret['stages'][stage] = counters
+    return ret
+
+def stage_trace(path=None):
+    """Get the calls of the stages recorded since :func:`enable_stage_tracking`
+    with ``trace=True``, or the last :func:`reset_stage_stats`, in the Chrome
+    trace format.
+
+    The events are tagged with the index of their minibatch in the pipelines
+    of DGL, or the one set by :func:`set_stage_batch`.
+
+    Parameters
+    ----------
+    path : str, optional
+        The file to write the trace to, e.g. to load in ``chrome://tracing`` or
+        Perfetto.
+
+    Returns
+    -------
+    str
+        The trace, in JSON.
+    """
+    trace = _CAPI_DGLStageTrackerTrace()
+    if path is not None:
+        with open(path, 'w') as f:
+            f.write(trace)
+    return trace
+
+def set_stage_batch(batch):
+    """Set the minibatch of the stages called by the calling thread in the trace
+    of :func:`stage_trace`, -1 for none."""
+    _CAPI_DGLStageTrackerSetBatch(int(batch))
+
+def reset_stage_stats():
+    """Reset the counters of :func:`stage_stats` to zero and drop the trace."""
+    _CAPI_DGLStageTrackerReset()
+
 def alias_func(func):
     """Return an alias function with proper docstring."""
     @wraps(func)
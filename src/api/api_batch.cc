@@ -0,0 +1,77 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file api/api_batch.cc
+ * \brief Running a sequence of C API calls with a single call from the frontend.
+ */
+#include <dgl/runtime/packed_func.h>
+#include <dgl/runtime/registry.h>
+
+#include <utility>
+#include <vector>
+
+namespace dgl {
+namespace runtime {
+
+/*!
+ * \brief Run a sequence of PackedFunc calls, and return the result of the last.
+ *
+ * Every argument crossing the FFI costs a conversion in the frontend, which
+ * dominates the latency of the small calls. The calls of a batch cross it once,
+ * and the results of the earlier calls are passed to the later ones directly.
+ *
+ * The arguments are
+ *
+ * - the number of calls, then for each call the function, its number of
+ *   arguments and the arguments;
+ * - the number of references, then for each of them the index of a call, the
+ *   position of its argument that is replaced with the result of a previous
+ *   call, and the index of that previous call.
+ */
+DGL_REGISTER_GLOBAL("_CallBatch")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    const int num_calls = args[0];
+    CHECK_GE(num_calls, 0) << "Invalid number of calls " << num_calls << ".";
+    // the position of the function of every call
+    std::vector<int> offsets(num_calls);
+    int pos = 1;
+    for (int i = 0; i < num_calls; ++i) {
+      offsets[i] = pos;
+      const int num_args = args[pos + 1];
+      CHECK_GE(num_args, 0) << "Invalid number of arguments of call " << i << ".";
+      pos += 2 + num_args;
+    }
+    const int num_refs = args[pos++];
+    CHECK_EQ(args.size(), pos + 3 * num_refs) << "Invalid arguments of the batch.";
+    // the argument positions and previous calls of the references of every call
+    std::vector<std::vector<std::pair<int, int>>> refs(num_calls);
+    for (int r = 0; r < num_refs; ++r, pos += 3) {
+      const int call = args[pos];
+      const int arg = args[pos + 1];
+      const int source = args[pos + 2];
+      CHECK(call >= 0 && call < num_calls && source >= 0 && source < call)
+        << "Call " << call << " can only use the results of the previous calls.";
+      CHECK(arg >= 0 && arg < static_cast<int>(args[offsets[call] + 1]))
+        << "Call " << call << " has no argument " << arg << ".";
+      refs[call].emplace_back(arg, source);
+    }
+
+    std::vector<DGLRetValue> results(num_calls);
+    std::vector<DGLValue> values;
+    std::vector<int> type_codes;
+    for (int i = 0; i < num_calls; ++i) {
+      const PackedFunc f = args[offsets[i]];
+      const int num_args = args[offsets[i] + 1];
+      const int first = offsets[i] + 2;
+      values.assign(args.values + first, args.values + first + num_args);
+      type_codes.assign(args.type_codes + first, args.type_codes + first + num_args);
+      DGLArgsSetter setter(values.data(), type_codes.data());
+      for (const auto& ref : refs[i])
+        setter(ref.first, results[ref.second]);
+      f.CallPacked(DGLArgs(values.data(), type_codes.data(), num_args), &results[i]);
+    }
+    if (num_calls > 0)
+      *rv = std::move(results.back());
+  });
+
+}  // namespace runtime
+}  // namespace dgl
@@ -9,10 +9,12 @@
 #include <dgl/runtime/container.h>
 #include <dgl/runtime/shared_mem.h>
 #include <dgl/runtime/device_api.h>
+#include <dgl/runtime/profile_range.h>
 #include <sstream>
 #include "../c_api_common.h"
 #include "./array_op.h"
 #include "./arith.h"
+#include "./uvm_array_op.h"
 
 using namespace dgl::runtime;
 
@@ -101,11 +103,11 @@ IdArray HStack(IdArray lhs, IdArray rhs) {
     device->CopyDataFromTo(lhs.Ptr<IdType>(), 0,
                            ret.Ptr<IdType>(), 0,
                            len * sizeof(IdType),
-                           ctx, ctx, lhs->dtype, nullptr);
+                           ctx, ctx, lhs->dtype, device->GetStream());
     device->CopyDataFromTo(rhs.Ptr<IdType>(), 0,
                            ret.Ptr<IdType>(), len * sizeof(IdType),
                            len * sizeof(IdType),
-                           ctx, ctx, lhs->dtype, nullptr);
+                           ctx, ctx, lhs->dtype, device->GetStream());
   });
   return ret;
 }
@@ -115,6 +117,7 @@ NDArray IndexSelect(NDArray array, IdArray index) {
   CHECK_SAME_CONTEXT(array, index);
   CHECK_GE(array->ndim, 1) << "Only support array with at least 1 dimension";
   CHECK_EQ(index->ndim, 1) << "Index array must be an 1D array.";
+  DGL_PROFILE_RANGE("IndexSelect", array, index);
   ATEN_XPU_SWITCH_CUDA(array->ctx.device_type, XPU, "IndexSelect", {
     ATEN_DTYPE_SWITCH(array->dtype, DType, "values", {
       ATEN_ID_TYPE_SWITCH(index->dtype, IdType, {
@@ -158,7 +161,7 @@ NDArray IndexSelect(NDArray array, int64_t start, int64_t end) {
   ATEN_DTYPE_SWITCH(array->dtype, DType, "values", {
     device->CopyDataFromTo(array->data, start * sizeof(DType),
                            ret->data, 0, len * sizeof(DType),
-                           array->ctx, ret->ctx, array->dtype, nullptr);
+                           array->ctx, ret->ctx, array->dtype, device->GetStream());
   });
   return ret;
 }
@@ -180,6 +183,13 @@ void Scatter_(IdArray index, NDArray value, NDArray out) {
   CHECK_SAME_CONTEXT(index, value);
   CHECK_SAME_CONTEXT(index, out);
   CHECK_EQ(value->shape[0], index->shape[0]);
+  CHECK_EQ(value->ndim, out->ndim) << "The value and output arrays must have the same"
+    << " number of dimensions.";
+  for (int d = 1; d < value->ndim; ++d)
+    CHECK_EQ(value->shape[d], out->shape[d]) << "The rows of the value and output arrays"
+      << " must have the same shape.";
+  CHECK(value->ndim == 1 || value->ctx.device_type == kDLCPU)
+    << "Scatter_ of multi-dimensional arrays is only supported on CPU.";
   if (index->shape[0] == 0)
     return;
   ATEN_XPU_SWITCH_CUDA(value->ctx.device_type, XPU, "Scatter_", {
@@ -213,6 +223,17 @@ IdArray Relabel_(const std::vector<IdArray>& arrays) {
   return ret;
 }
 
+std::tuple<IdArray, IdArray, IdArray> Unique(IdArray ids) {
+  CHECK_EQ(ids->ndim, 1) << "The id array must be 1D.";
+  std::tuple<IdArray, IdArray, IdArray> ret;
+  ATEN_XPU_SWITCH_CUDA(ids->ctx.device_type, XPU, "Unique", {
+    ATEN_ID_TYPE_SWITCH(ids->dtype, IdType, {
+      ret = impl::Unique<XPU, IdType>(ids);
+    });
+  });
+  return ret;
+}
+
 NDArray Concat(const std::vector<IdArray>& arrays) {
   IdArray ret;
 
@@ -351,6 +372,22 @@ NDArray CSRIsNonZero(CSRMatrix csr, NDArray row, NDArray col) {
   return ret;
 }
 
+namespace {
+
+/*! \brief Whether the lookups into csr may build an index of it, see CSRGetData. */
+bool CSRMayIndexLookups(const CSRMatrix& csr, KernelPlanCache* cache) {
+  return cache != nullptr && !csr.sorted && csr.indptr->ctx.device_type == kDLGPU &&
+    !CSRHasWideIndptr(csr);
+}
+
+}  // namespace
+
+NDArray CSRIsNonZero(CSRMatrix csr, NDArray row, NDArray col, KernelPlanCache* cache) {
+  if (!CSRMayIndexLookups(csr, cache))
+    return CSRIsNonZero(csr, row, col);
+  return CSRGetData(csr, row, col, cache) != -1;
+}
+
 bool CSRHasDuplicate(CSRMatrix csr) {
   bool ret = false;
   ATEN_CSR_SWITCH_CUDA(csr, XPU, IdType, "CSRHasDuplicate", {
@@ -397,7 +434,7 @@ NDArray CSRGetRowData(CSRMatrix csr, int64_t row) {
 }
 
 bool CSRIsSorted(CSRMatrix csr) {
-  if (csr.indices->shape[0] <= 1)
+  if (csr.sorted || csr.indices->shape[0] <= 1)
     return true;
   bool ret = false;
   ATEN_CSR_SWITCH_CUDA(csr, XPU, IdType, "CSRIsSorted", {
@@ -418,6 +455,22 @@ NDArray CSRGetData(CSRMatrix csr, NDArray rows, NDArray cols) {
   return ret;
 }
 
+NDArray CSRGetData(CSRMatrix csr, NDArray rows, NDArray cols, KernelPlanCache* cache) {
+  if (!CSRMayIndexLookups(csr, cache))
+    return CSRGetData(csr, rows, cols);
+  NDArray ret;
+  CHECK_SAME_DTYPE(csr.indices, rows);
+  CHECK_SAME_DTYPE(csr.indices, cols);
+  CHECK_SAME_CONTEXT(csr.indices, rows);
+  CHECK_SAME_CONTEXT(csr.indices, cols);
+#ifdef DGL_USE_CUDA
+  ATEN_ID_TYPE_SWITCH(csr.indptr->dtype, IdType, {
+    ret = impl::CSRGetDataIndexed<kDLGPU, IdType>(csr, rows, cols, cache);
+  });
+#endif  // DGL_USE_CUDA
+  return ret;
+}
+
 template <typename DType>
 NDArray CSRGetData(CSRMatrix csr, NDArray rows, NDArray cols, NDArray weights, DType filler) {
   NDArray ret;
@@ -460,7 +513,16 @@ CSRMatrix CSRTranspose(CSRMatrix csr) {
   return ret;
 }
 
+CSRMatrix CSRMakeSymmetric(CSRMatrix csr) {
+  CSRMatrix ret;
+  ATEN_CSR_SWITCH(csr, XPU, IdType, "CSRMakeSymmetric", {
+    ret = impl::CSRMakeSymmetric<XPU, IdType>(csr);
+  });
+  return ret;
+}
+
 COOMatrix CSRToCOO(CSRMatrix csr, bool data_as_order) {
+  DGL_PROFILE_RANGE("CSRToCOO", csr.num_rows, csr.num_cols, csr.indices);
   COOMatrix ret;
   if (data_as_order) {
     ATEN_XPU_SWITCH_CUDA(csr.indptr->ctx.device_type, XPU, "CSRToCOODataAsOrder", {
@@ -492,6 +554,7 @@ CSRMatrix CSRSliceRows(CSRMatrix csr, int64_t start, int64_t end) {
 CSRMatrix CSRSliceRows(CSRMatrix csr, NDArray rows) {
   CHECK_SAME_DTYPE(csr.indices, rows);
   CHECK_SAME_CONTEXT(csr.indices, rows);
+  DGL_PROFILE_RANGE("CSRSliceRows", csr.num_rows, csr.num_cols, csr.indices, rows);
   CSRMatrix ret;
   ATEN_CSR_SWITCH_CUDA(csr, XPU, IdType, "CSRSliceRows", {
     ret = impl::CSRSliceRows<XPU, IdType>(csr, rows);
@@ -511,9 +574,52 @@ CSRMatrix CSRSliceMatrix(CSRMatrix csr, NDArray rows, NDArray cols) {
   return ret;
 }
 
+CSRMatrix CSRSliceMatrixBatched(CSRMatrix csr, NDArray rows, NDArray row_offsets,
+                                NDArray cols, NDArray col_offsets) {
+  CHECK_SAME_DTYPE(csr.indices, rows);
+  CHECK_SAME_DTYPE(csr.indices, row_offsets);
+  CHECK_SAME_DTYPE(csr.indices, cols);
+  CHECK_SAME_DTYPE(csr.indices, col_offsets);
+  CHECK_SAME_CONTEXT(csr.indices, rows);
+  CHECK_SAME_CONTEXT(csr.indices, row_offsets);
+  CHECK_SAME_CONTEXT(csr.indices, cols);
+  CHECK_SAME_CONTEXT(csr.indices, col_offsets);
+  CHECK_GE(row_offsets->shape[0], 1) << "The offsets must start with 0.";
+  CHECK_EQ(row_offsets->shape[0], col_offsets->shape[0])
+    << "The rows and the cols must have the same number of blocks.";
+  CSRMatrix ret;
+  ATEN_CSR_SWITCH_CUDA(csr, XPU, IdType, "CSRSliceMatrixBatched", {
+    ret = impl::CSRSliceMatrixBatched<XPU, IdType>(csr, rows, row_offsets, cols, col_offsets);
+  });
+  return ret;
+}
+
+std::vector<NDArray> CSRKHopExpand(const std::vector<CSRMatrix>& adjs, NDArray seeds,
+                                   NDArray seed_offsets, int64_t num_hops) {
+  CHECK(!adjs.empty()) << "There must be at least one adjacency matrix.";
+  for (const CSRMatrix& adj : adjs) {
+    CHECK_SAME_DTYPE(adjs[0].indices, adj.indices);
+    CHECK_SAME_CONTEXT(adjs[0].indices, adj.indices);
+    CHECK_EQ(adj.num_rows, adjs[0].num_rows) << "The matrices must have the same shape.";
+    CHECK_EQ(adj.num_cols, adjs[0].num_rows) << "The matrices must be square.";
+  }
+  CHECK_SAME_DTYPE(adjs[0].indices, seeds);
+  CHECK_SAME_DTYPE(adjs[0].indices, seed_offsets);
+  CHECK_SAME_CONTEXT(adjs[0].indices, seeds);
+  CHECK_SAME_CONTEXT(adjs[0].indices, seed_offsets);
+  CHECK_GE(seed_offsets->shape[0], 1) << "The offsets must start with 0.";
+  CHECK_GE(num_hops, 0) << "The number of hops must be non-negative.";
+  std::vector<NDArray> ret;
+  ATEN_CSR_SWITCH_CUDA(adjs[0], XPU, IdType, "CSRKHopExpand", {
+    ret = impl::CSRKHopExpand<XPU, IdType>(adjs, seeds, seed_offsets, num_hops);
+  });
+  return ret;
+}
+
 void CSRSort_(CSRMatrix* csr) {
   if (csr->sorted)
     return;
+  DGL_PROFILE_RANGE("CSRSort_", csr->num_rows, csr->num_cols, csr->indices);
   ATEN_CSR_SWITCH_CUDA(*csr, XPU, IdType, "CSRSort_", {
     impl::CSRSort_<XPU, IdType>(csr);
   });
@@ -550,15 +656,59 @@ CSRMatrix CSRRemove(CSRMatrix csr, IdArray entries) {
   return ret;
 }
 
+CSRMatrix CSRMergeRows(CSRMatrix a, CSRMatrix b) {
+  CHECK_EQ(a.num_rows, b.num_rows) << "CSRMergeRows: the numbers of rows differ.";
+  CHECK_EQ(a.num_cols, b.num_cols) << "CSRMergeRows: the numbers of columns differ.";
+  CHECK_SAME_DTYPE(a.indptr, b.indptr);
+  CHECK_SAME_CONTEXT(a.indptr, b.indptr);
+  CSRMatrix ret;
+  ATEN_CSR_SWITCH(a, XPU, IdType, "CSRMergeRows", {
+    ret = impl::CSRMergeRows<XPU, IdType>(a, b);
+  });
+  return ret;
+}
+
 COOMatrix CSRRowWiseSampling(
-    CSRMatrix mat, IdArray rows, int64_t num_samples, FloatArray prob, bool replace) {
+    CSRMatrix mat, IdArray rows, int64_t num_samples, FloatArray prob, bool replace,
+    NDArray mask) {
   COOMatrix ret;
-  if (IsNullArray(prob)) {
+  if (rows->ctx.device_type == kDLGPU && mat.indices->ctx.device_type == kDLCPU) {
+    // a matrix pinned in host memory is sampled by the GPU of the rows
+    CHECK(IsNullArray(prob) && IsNullArray(mask)) << "CSRRowWiseSampling only supports "
+      << "uniform sampling without masks on pinned CSR matrices.";
+    return CSRRowWiseSamplingUniformPinned(mat, rows, num_samples, replace);
+  }
+  if (!IsNullArray(mask)) {
+    CHECK(!CSRHasWideIndptr(mat)) << "CSRRowWiseSampling does not support masks "
+      << "on CSR matrices with int64 row pointers and int32 column indices.";
+    CHECK_EQ(mask->dtype.bits, 8) << "The mask must be an array of 8-bit integers.";
+    CHECK_EQ(mask->ndim, 1) << "The mask must be a 1D array.";
+    CHECK_SAME_CONTEXT(mat.indices, mask);
+    ATEN_CSR_SWITCH_CUDA(mat, XPU, IdType, "CSRRowWiseSampling", {
+      if (IsNullArray(prob)) {
+        ret = impl::CSRRowWiseSamplingMasked<XPU, IdType, float>(
+            mat, rows, num_samples, mask, prob, replace);
+      } else {
+        ATEN_FLOAT_TYPE_SWITCH(prob->dtype, FloatType, "probability", {
+          ret = impl::CSRRowWiseSamplingMasked<XPU, IdType, FloatType>(
+              mat, rows, num_samples, mask, prob, replace);
+        });
+      }
+    });
+  } else if (CSRHasWideIndptr(mat)) {
+    CHECK(IsNullArray(prob)) << "CSRRowWiseSampling only supports uniform sampling "
+      << "on CSR matrices with int64 row pointers and int32 column indices.";
+    CHECK_SAME_DTYPE(mat.indices, rows);
+    ATEN_XPU_SWITCH(mat.indptr->ctx.device_type, XPU, "CSRRowWiseSampling", {
+      ret = impl::CSRRowWiseSamplingUniformWideIndptr<XPU, int32_t>(
+          mat, rows, num_samples, replace);
+    });
+  } else if (IsNullArray(prob)) {
     ATEN_CSR_SWITCH_CUDA(mat, XPU, IdType, "CSRRowWiseSampling", {
       ret = impl::CSRRowWiseSamplingUniform<XPU, IdType>(mat, rows, num_samples, replace);
     });
   } else {
-    ATEN_CSR_SWITCH(mat, XPU, IdType, "CSRRowWiseSampling", {
+    ATEN_CSR_SWITCH_CUDA(mat, XPU, IdType, "CSRRowWiseSampling", {
       ATEN_FLOAT_TYPE_SWITCH(prob->dtype, FloatType, "probability", {
         ret = impl::CSRRowWiseSampling<XPU, IdType, FloatType>(
             mat, rows, num_samples, prob, replace);
@@ -568,6 +718,35 @@ COOMatrix CSRRowWiseSampling(
   return ret;
 }
 
+std::pair<FloatArray, IdArray> CSRRowWiseAliasTable(CSRMatrix mat, FloatArray prob) {
+  std::pair<FloatArray, IdArray> ret;
+  ATEN_CSR_SWITCH_CUDA(mat, XPU, IdType, "CSRRowWiseAliasTable", {
+    ATEN_FLOAT_TYPE_SWITCH(prob->dtype, FloatType, "probability", {
+      ret = impl::CSRRowWiseAliasTable<XPU, IdType, FloatType>(mat, prob);
+    });
+  });
+  return ret;
+}
+
+COOMatrix CSRRowWiseSamplingAlias(
+    CSRMatrix mat, IdArray rows, int64_t num_samples, FloatArray prob,
+    FloatArray accept, IdArray alias, bool replace) {
+  CHECK_SAME_DTYPE(prob, accept);
+  CHECK_SAME_DTYPE(mat.indices, alias);
+  CHECK_EQ(accept->shape[0], prob->shape[0])
+    << "The alias tables must be built from the same probabilities.";
+  CHECK_EQ(alias->shape[0], prob->shape[0])
+    << "The alias tables must be built from the same probabilities.";
+  COOMatrix ret;
+  ATEN_CSR_SWITCH(mat, XPU, IdType, "CSRRowWiseSamplingAlias", {
+    ATEN_FLOAT_TYPE_SWITCH(prob->dtype, FloatType, "probability", {
+      ret = impl::CSRRowWiseSamplingAlias<XPU, IdType, FloatType>(
+          mat, rows, num_samples, prob, accept, alias, replace);
+    });
+  });
+  return ret;
+}
+
 COOMatrix CSRRowWisePerEtypeSampling(
     CSRMatrix mat, IdArray rows, IdArray etypes,
     const std::vector<int64_t>& num_samples, FloatArray prob, bool replace,
@@ -591,7 +770,7 @@ COOMatrix CSRRowWisePerEtypeSampling(
 COOMatrix CSRRowWiseTopk(
     CSRMatrix mat, IdArray rows, int64_t k, NDArray weight, bool ascending) {
   COOMatrix ret;
-  ATEN_CSR_SWITCH(mat, XPU, IdType, "CSRRowWiseTopk", {
+  ATEN_CSR_SWITCH_CUDA(mat, XPU, IdType, "CSRRowWiseTopk", {
     ATEN_DTYPE_SWITCH(weight->dtype, DType, "weight", {
       ret = impl::CSRRowWiseTopk<XPU, IdType, DType>(
           mat, rows, k, weight, ascending);
@@ -600,6 +779,44 @@ COOMatrix CSRRowWiseTopk(
   return ret;
 }
 
+IdArray CSRRowWiseTopkOrder(CSRMatrix mat, NDArray weight, bool ascending) {
+  IdArray ret;
+  ATEN_CSR_SWITCH(mat, XPU, IdType, "CSRRowWiseTopkOrder", {
+    ATEN_DTYPE_SWITCH(weight->dtype, DType, "weight", {
+      ret = impl::CSRRowWiseTopkOrder<XPU, IdType, DType>(mat, weight, ascending);
+    });
+  });
+  return ret;
+}
+
+COOMatrix CSRRowWiseTopkOrdered(CSRMatrix mat, IdArray rows, int64_t k, IdArray order) {
+  CHECK_SAME_DTYPE(mat.indices, order);
+  COOMatrix ret;
+  ATEN_CSR_SWITCH(mat, XPU, IdType, "CSRRowWiseTopkOrdered", {
+    ret = impl::CSRRowWiseTopkOrdered<XPU, IdType>(mat, rows, k, order);
+  });
+  return ret;
+}
+
+COOMatrix CSRRowWiseSamplingTemporal(
+    CSRMatrix mat, IdArray rows, int64_t num_samples, NDArray timestamp, IdArray order,
+    NDArray bound, bool replace) {
+  CHECK_SAME_DTYPE(mat.indices, order);
+  CHECK_SAME_DTYPE(timestamp, bound);
+  CHECK_EQ(order->shape[0], timestamp->shape[0])
+    << "The order must be built from the same timestamps.";
+  CHECK_EQ(bound->shape[0], rows->shape[0])
+    << "There must be one time bound for each row.";
+  COOMatrix ret;
+  ATEN_CSR_SWITCH(mat, XPU, IdType, "CSRRowWiseSamplingTemporal", {
+    ATEN_DTYPE_SWITCH(timestamp->dtype, DType, "timestamp", {
+      ret = impl::CSRRowWiseSamplingTemporal<XPU, IdType, DType>(
+          mat, rows, num_samples, timestamp, order, bound, replace);
+    });
+  });
+  return ret;
+}
+
 COOMatrix CSRRowWiseSamplingBiased(
     CSRMatrix mat,
     IdArray rows,
@@ -649,6 +866,48 @@ CSRToSimple(const CSRMatrix& csr) {
   return ret;
 }
 
+CSRMatrix CSRNarrowIndices(CSRMatrix csr) {
+  CHECK(IS_INT64(csr.indptr) && IS_INT64(csr.indices))
+    << "CSRNarrowIndices expects an int64 CSR matrix.";
+  return CSRMatrix(csr.num_rows, csr.num_cols, csr.indptr, AsNumBits(csr.indices, 32),
+                   csr.data, csr.sorted);
+}
+
+int64_t CompressedCSRNNZ(const CompressedCSRMatrix& csr) {
+  int64_t ret = 0;
+  ATEN_COMPRESSED_CSR_SWITCH(csr, XPU, IdType, "CompressedCSRNNZ", {
+    ret = csr.indptr.Ptr<IdType>()[csr.num_rows];
+  });
+  return ret;
+}
+
+CompressedCSRMatrix CSRCompress(CSRMatrix csr) {
+  CompressedCSRMatrix ret;
+  ATEN_CSR_SWITCH(csr, XPU, IdType, "CSRCompress", {
+    ret = impl::CSRCompress<XPU, IdType>(csr);
+  });
+  return ret;
+}
+
+CSRMatrix CompressedCSRDecompress(const CompressedCSRMatrix& csr) {
+  CSRMatrix ret;
+  ATEN_COMPRESSED_CSR_SWITCH(csr, XPU, IdType, "CompressedCSRDecompress", {
+    ret = impl::CompressedCSRDecompress<XPU, IdType>(csr);
+  });
+  return ret;
+}
+
+COOMatrix CompressedCSRRowWiseSamplingUniform(
+    const CompressedCSRMatrix& csr, IdArray rows, int64_t num_samples, bool replace) {
+  COOMatrix ret;
+  CHECK_SAME_DTYPE(csr.indptr, rows);
+  ATEN_COMPRESSED_CSR_SWITCH(csr, XPU, IdType, "CompressedCSRRowWiseSamplingUniform", {
+    ret = impl::CompressedCSRRowWiseSamplingUniform<XPU, IdType>(
+        csr, rows, num_samples, replace);
+  });
+  return ret;
+}
+
 ///////////////////////// COO routines //////////////////////////
 
 bool COOIsNonZero(COOMatrix coo, int64_t row, int64_t col) {
@@ -721,6 +980,7 @@ COOMatrix COOTranspose(COOMatrix coo) {
 }
 
 CSRMatrix COOToCSR(COOMatrix coo) {
+  DGL_PROFILE_RANGE("COOToCSR", coo.num_rows, coo.num_cols, coo.row);
   CSRMatrix ret;
   ATEN_XPU_SWITCH_CUDA(coo.row->ctx.device_type, XPU, "COOToCSR", {
     ATEN_ID_TYPE_SWITCH(coo.row->dtype, IdType, {
@@ -730,6 +990,22 @@ CSRMatrix COOToCSR(COOMatrix coo) {
   return ret;
 }
 
+CSRMatrix COOToCSRChunked(COOMatrix coo, DLContext ctx, int64_t chunk_size) {
+  CHECK_EQ(coo.row->ctx.device_type, kDLCPU) << "The COO matrix must be in host memory.";
+  CHECK_EQ(ctx.device_type, kDLGPU) << "The conversion must run on a GPU.";
+  CHECK_GT(chunk_size, 0) << "The chunk size must be positive.";
+  DGL_PROFILE_RANGE("COOToCSRChunked", coo.num_rows, coo.num_cols, coo.row);
+  CSRMatrix ret;
+#ifdef DGL_USE_CUDA
+  ATEN_ID_TYPE_SWITCH(coo.row->dtype, IdType, {
+    ret = impl::COOToCSRChunked<kDLGPU, IdType>(coo, ctx, chunk_size);
+  });
+#else
+  LOG(FATAL) << "COOToCSRChunked requires DGL to be built with CUDA.";
+#endif  // DGL_USE_CUDA
+  return ret;
+}
+
 COOMatrix COOSliceRows(COOMatrix coo, int64_t start, int64_t end) {
   COOMatrix ret;
   ATEN_COO_SWITCH(coo, XPU, IdType, "COOSliceRows", {
@@ -765,7 +1041,7 @@ void COOSort_(COOMatrix* mat, bool sort_column) {
 }
 
 std::pair<bool, bool> COOIsSorted(COOMatrix coo) {
-  if (coo.row->shape[0] <= 1)
+  if ((coo.row_sorted && coo.col_sorted) || coo.row->shape[0] <= 1)
     return {true, true};
   std::pair<bool, bool> ret;
   ATEN_COO_SWITCH_CUDA(coo, XPU, IdType, "COOIsSorted", {
@@ -847,7 +1123,7 @@ std::pair<COOMatrix, IdArray> COOCoalesce(COOMatrix coo) {
 
 COOMatrix COOLineGraph(const COOMatrix &coo, bool backtracking) {
   COOMatrix ret;
-  ATEN_COO_SWITCH(coo, XPU, IdType, "COOLineGraph", {
+  ATEN_COO_SWITCH_CUDA(coo, XPU, IdType, "COOLineGraph", {
     ret = impl::COOLineGraph<XPU, IdType>(coo, backtracking);
   });
   return ret;
@@ -962,6 +1238,10 @@ COOToSimple(const COOMatrix& coo) {
 
 ///////////////////////// Graph Traverse routines //////////////////////////
 Frontiers BFSNodesFrontiers(const CSRMatrix& csr, IdArray source) {
+  return BFSNodesFrontiers(csr, CSRMatrix(), source);
+}
+
+Frontiers BFSNodesFrontiers(const CSRMatrix& csr, const CSRMatrix& transpose, IdArray source) {
   Frontiers ret;
   CHECK_EQ(csr.indptr->ctx.device_type, source->ctx.device_type) <<
     "Graph and source should in the same device context";
@@ -969,15 +1249,19 @@ Frontiers BFSNodesFrontiers(const CSRMatrix& csr, IdArray source) {
     "Graph and source should in the same dtype";
   CHECK_EQ(csr.num_rows, csr.num_cols) <<
     "Graph traversal can only work on square-shaped CSR.";
-  ATEN_XPU_SWITCH(source->ctx.device_type, XPU, "BFSNodesFrontiers", {
+  ATEN_XPU_SWITCH_CUDA(source->ctx.device_type, XPU, "BFSNodesFrontiers", {
     ATEN_ID_TYPE_SWITCH(source->dtype, IdType, {
-      ret = impl::BFSNodesFrontiers<XPU, IdType>(csr, source);
+      ret = impl::BFSNodesFrontiers<XPU, IdType>(csr, transpose, source);
     });
   });
   return ret;
 }
 
 Frontiers BFSEdgesFrontiers(const CSRMatrix& csr, IdArray source) {
+  return BFSEdgesFrontiers(csr, CSRMatrix(), source);
+}
+
+Frontiers BFSEdgesFrontiers(const CSRMatrix& csr, const CSRMatrix& transpose, IdArray source) {
   Frontiers ret;
   CHECK_EQ(csr.indptr->ctx.device_type, source->ctx.device_type) <<
     "Graph and source should in the same device context";
@@ -985,9 +1269,9 @@ Frontiers BFSEdgesFrontiers(const CSRMatrix& csr, IdArray source) {
     "Graph and source should in the same dtype";
   CHECK_EQ(csr.num_rows, csr.num_cols) <<
     "Graph traversal can only work on square-shaped CSR.";
-  ATEN_XPU_SWITCH(source->ctx.device_type, XPU, "BFSEdgesFrontiers", {
+  ATEN_XPU_SWITCH_CUDA(source->ctx.device_type, XPU, "BFSEdgesFrontiers", {
     ATEN_ID_TYPE_SWITCH(source->dtype, IdType, {
-      ret = impl::BFSEdgesFrontiers<XPU, IdType>(csr, source);
+      ret = impl::BFSEdgesFrontiers<XPU, IdType>(csr, transpose, source);
     });
   });
   return ret;
@@ -997,7 +1281,7 @@ Frontiers TopologicalNodesFrontiers(const CSRMatrix& csr) {
   Frontiers ret;
   CHECK_EQ(csr.num_rows, csr.num_cols) <<
     "Graph traversal can only work on square-shaped CSR.";
-  ATEN_XPU_SWITCH(csr.indptr->ctx.device_type, XPU, "TopologicalNodesFrontiers", {
+  ATEN_XPU_SWITCH_CUDA(csr.indptr->ctx.device_type, XPU, "TopologicalNodesFrontiers", {
     ATEN_ID_TYPE_SWITCH(csr.indices->dtype, IdType, {
       ret = impl::TopologicalNodesFrontiers<XPU, IdType>(csr);
     });
@@ -1106,6 +1390,30 @@ DGL_REGISTER_GLOBAL("ndarray._CAPI_DGLExistSharedMemArray")
 #endif  // _WIN32
   });
 
+DGL_REGISTER_GLOBAL("ndarray._CAPI_DGLArrayEmptyPinned")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    DLContext ctx = args[0];
+    DLDataType dtype = args[1];
+    std::vector<int64_t> shape;
+    for (int i = 2; i < args.size(); ++i)
+      shape.push_back(args[i]);
+    *rv = NDArray::PinnedEmpty(shape, dtype, ctx);
+  });
+
+DGL_REGISTER_GLOBAL("ndarray._CAPI_DGLArrayIsPinned")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    NDArray array = args[0];
+    *rv = array.IsPinned();
+  });
+
+DGL_REGISTER_GLOBAL("utils.internal._CAPI_DGLArrayUnique")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    IdArray ids = args[0];
+    IdArray values, inverse, counts;
+    std::tie(values, inverse, counts) = Unique(ids);
+    *rv = ConvertNDArrayVectorToPackedFunc({values, inverse, counts});
+  });
+
 DGL_REGISTER_GLOBAL("ndarray._CAPI_DGLArrayCastToSigned")
 .set_body([] (DGLArgs args, DGLRetValue* rv) {
     NDArray array = args[0];
@@ -43,6 +43,10 @@ NDArray IndexSelect(NDArray array, IdArray index);
 template <DLDeviceType XPU, typename DType>
 DType IndexSelect(NDArray array, int64_t index);
 
+// The values of the table are int8 if bits is 8, float16 if 16.
+template <DLDeviceType XPU, int bits, typename IdType>
+NDArray IndexSelectDequantize(const QuantizedArray& array, IdArray index);
+
 template <DLDeviceType XPU, typename DType>
 IdArray NonZero(BoolArray bool_arr);
 
@@ -61,6 +65,9 @@ NDArray Repeat(NDArray array, IdArray repeats);
 template <DLDeviceType XPU, typename IdType>
 IdArray Relabel_(const std::vector<IdArray>& arrays);
 
+template <DLDeviceType XPU, typename IdType>
+std::tuple<IdArray, IdArray, IdArray> Unique(IdArray ids);
+
 template <DLDeviceType XPU, typename IdType>
 NDArray Concat(const std::vector<IdArray>& arrays);
 
@@ -119,6 +126,9 @@ NDArray CSRGetData(CSRMatrix csr, NDArray rows, NDArray cols) {
   return CSRGetData<XPU, IdType, IdType>(csr, rows, cols, true, NullArray(rows->dtype), -1);
 }
 
+template <DLDeviceType XPU, typename IdType>
+NDArray CSRGetDataIndexed(CSRMatrix csr, NDArray rows, NDArray cols, KernelPlanCache* cache);
+
 template <DLDeviceType XPU, typename IdType>
 std::vector<runtime::NDArray> CSRGetDataAndIndices(
     CSRMatrix csr, runtime::NDArray rows, runtime::NDArray cols);
@@ -126,6 +136,9 @@ std::vector<runtime::NDArray> CSRGetDataAndIndices(
 template <DLDeviceType XPU, typename IdType>
 CSRMatrix CSRTranspose(CSRMatrix csr);
 
+template <DLDeviceType XPU, typename IdType>
+CSRMatrix CSRMakeSymmetric(CSRMatrix csr);
+
 // Convert CSR to COO
 template <DLDeviceType XPU, typename IdType>
 COOMatrix CSRToCOO(CSRMatrix csr);
@@ -143,6 +156,16 @@ CSRMatrix CSRSliceRows(CSRMatrix csr, runtime::NDArray rows);
 template <DLDeviceType XPU, typename IdType>
 CSRMatrix CSRSliceMatrix(CSRMatrix csr, runtime::NDArray rows, runtime::NDArray cols);
 
+template <DLDeviceType XPU, typename IdType>
+CSRMatrix CSRSliceMatrixBatched(CSRMatrix csr, runtime::NDArray rows,
+                                runtime::NDArray row_offsets, runtime::NDArray cols,
+                                runtime::NDArray col_offsets);
+
+template <DLDeviceType XPU, typename IdType>
+std::vector<runtime::NDArray> CSRKHopExpand(
+    const std::vector<CSRMatrix>& adjs, runtime::NDArray seeds,
+    runtime::NDArray seed_offsets, int64_t num_hops);
+
 template <DLDeviceType XPU, typename IdType>
 void CSRSort_(CSRMatrix* csr);
 
@@ -159,11 +182,31 @@ COOMatrix COOReorder(COOMatrix coo, runtime::NDArray new_row_ids, runtime::NDArr
 template <DLDeviceType XPU, typename IdType>
 CSRMatrix CSRRemove(CSRMatrix csr, IdArray entries);
 
+template <DLDeviceType XPU, typename IdType>
+CSRMatrix CSRMergeRows(CSRMatrix a, CSRMatrix b);
+
 // FloatType is the type of probability data.
 template <DLDeviceType XPU, typename IdType, typename FloatType>
 COOMatrix CSRRowWiseSampling(
     CSRMatrix mat, IdArray rows, int64_t num_samples, FloatArray prob, bool replace);
 
+// FloatType is the type of probability data, and prob may be empty for uniform
+// sampling.
+template <DLDeviceType XPU, typename IdType, typename FloatType>
+COOMatrix CSRRowWiseSamplingMasked(
+    CSRMatrix mat, IdArray rows, int64_t num_samples, NDArray mask, FloatArray prob,
+    bool replace);
+
+// FloatType is the type of probability data.
+template <DLDeviceType XPU, typename IdType, typename FloatType>
+std::pair<FloatArray, IdArray> CSRRowWiseAliasTable(CSRMatrix mat, FloatArray prob);
+
+// FloatType is the type of probability data.
+template <DLDeviceType XPU, typename IdType, typename FloatType>
+COOMatrix CSRRowWiseSamplingAlias(
+    CSRMatrix mat, IdArray rows, int64_t num_samples, FloatArray prob,
+    FloatArray accept, IdArray alias, bool replace);
+
 // FloatType is the type of probability data.
 template <DLDeviceType XPU, typename IdType, typename FloatType>
 COOMatrix CSRRowWisePerEtypeSampling(
@@ -175,6 +218,11 @@ template <DLDeviceType XPU, typename IdType>
 COOMatrix CSRRowWiseSamplingUniform(
     CSRMatrix mat, IdArray rows, int64_t num_samples, bool replace);
 
+// IdType is the type of the column indices, the row pointers being int64.
+template <DLDeviceType XPU, typename IdType>
+COOMatrix CSRRowWiseSamplingUniformWideIndptr(
+    CSRMatrix mat, IdArray rows, int64_t num_samples, bool replace);
+
 template <DLDeviceType XPU, typename IdType>
 COOMatrix CSRRowWisePerEtypeSamplingUniform(
     CSRMatrix mat, IdArray rows, IdArray etypes, const std::vector<int64_t>& num_samples,
@@ -185,6 +233,19 @@ template <DLDeviceType XPU, typename IdType, typename DType>
 COOMatrix CSRRowWiseTopk(
     CSRMatrix mat, IdArray rows, int64_t k, NDArray weight, bool ascending);
 
+// DType is the type of weight data.
+template <DLDeviceType XPU, typename IdType, typename DType>
+IdArray CSRRowWiseTopkOrder(CSRMatrix mat, NDArray weight, bool ascending);
+
+template <DLDeviceType XPU, typename IdType>
+COOMatrix CSRRowWiseTopkOrdered(CSRMatrix mat, IdArray rows, int64_t k, IdArray order);
+
+// DType is the type of timestamp data.
+template <DLDeviceType XPU, typename IdType, typename DType>
+COOMatrix CSRRowWiseSamplingTemporal(
+    CSRMatrix mat, IdArray rows, int64_t num_samples, NDArray timestamp, IdArray order,
+    NDArray bound, bool replace);
+
 template <DLDeviceType XPU, typename IdType, typename FloatType>
 COOMatrix CSRRowWiseSamplingBiased(
     CSRMatrix mat,
@@ -202,6 +263,39 @@ CSRMatrix UnionCsr(const std::vector<CSRMatrix>& csrs);
 template <DLDeviceType XPU, typename IdType>
 std::tuple<CSRMatrix, IdArray, IdArray> CSRToSimple(CSRMatrix csr);
 
+// Disjoint union and partition of COOMatrixes and CSRMatrixes
+template <DLDeviceType XPU, typename IdType>
+COOMatrix DisjointUnionCoo(const std::vector<COOMatrix>& coos);
+
+template <DLDeviceType XPU, typename IdType>
+std::vector<COOMatrix> DisjointPartitionCooBySizes(
+    const COOMatrix &coo,
+    const uint64_t batch_size,
+    const std::vector<uint64_t> &edge_cumsum,
+    const std::vector<uint64_t> &src_vertex_cumsum,
+    const std::vector<uint64_t> &dst_vertex_cumsum);
+
+template <DLDeviceType XPU, typename IdType>
+CSRMatrix DisjointUnionCsr(const std::vector<CSRMatrix>& csrs);
+
+template <DLDeviceType XPU, typename IdType>
+std::vector<CSRMatrix> DisjointPartitionCsrBySizes(
+    const CSRMatrix &csr,
+    const uint64_t batch_size,
+    const std::vector<uint64_t> &edge_cumsum,
+    const std::vector<uint64_t> &src_vertex_cumsum,
+    const std::vector<uint64_t> &dst_vertex_cumsum);
+
+template <DLDeviceType XPU, typename IdType>
+CompressedCSRMatrix CSRCompress(CSRMatrix csr);
+
+template <DLDeviceType XPU, typename IdType>
+CSRMatrix CompressedCSRDecompress(const CompressedCSRMatrix& csr);
+
+template <DLDeviceType XPU, typename IdType>
+COOMatrix CompressedCSRRowWiseSamplingUniform(
+    const CompressedCSRMatrix& csr, IdArray rows, int64_t num_samples, bool replace);
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 
 template <DLDeviceType XPU, typename IdType>
@@ -236,6 +330,9 @@ COOMatrix COOTranspose(COOMatrix coo);
 template <DLDeviceType XPU, typename IdType>
 CSRMatrix COOToCSR(COOMatrix coo);
 
+template <DLDeviceType XPU, typename IdType>
+CSRMatrix COOToCSRChunked(COOMatrix coo, DLContext ctx, int64_t chunk_size);
+
 template <DLDeviceType XPU, typename IdType>
 COOMatrix COOSliceRows(COOMatrix coo, int64_t start, int64_t end);
 
@@ -285,10 +382,10 @@ COOMatrix COORowWiseTopk(
 ///////////////////////// Graph Traverse routines //////////////////////////
 
 template <DLDeviceType XPU, typename IdType>
-Frontiers BFSNodesFrontiers(const CSRMatrix& csr, IdArray source);
+Frontiers BFSNodesFrontiers(const CSRMatrix& csr, const CSRMatrix& transpose, IdArray source);
 
 template <DLDeviceType XPU, typename IdType>
-Frontiers BFSEdgesFrontiers(const CSRMatrix& csr, IdArray source);
+Frontiers BFSEdgesFrontiers(const CSRMatrix& csr, const CSRMatrix& transpose, IdArray source);
 
 template <DLDeviceType XPU, typename IdType>
 Frontiers TopologicalNodesFrontiers(const CSRMatrix& csr);
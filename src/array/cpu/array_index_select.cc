@@ -4,6 +4,9 @@
  * \brief Array index select CPU implementation
  */
 #include <dgl/array.h>
+#include <dgl/runtime/parallel_for.h>
+#include <vector>
+#include "./array_row_copy.h"
 
 namespace dgl {
 using runtime::NDArray;
@@ -12,18 +15,34 @@ namespace impl {
 
 template<DLDeviceType XPU, typename DType, typename IdType>
 NDArray IndexSelect(NDArray array, IdArray index) {
-  CHECK_EQ(array->shape[0], array.NumElements()) << "Only support tensor"
-    << " whose first dimension equals number of elements, e.g. (5,), (5, 1)";
-
   const DType* array_data = static_cast<DType*>(array->data);
   const IdType* idx_data = static_cast<IdType*>(index->data);
   const int64_t arr_len = array->shape[0];
   const int64_t len = index->shape[0];
-  NDArray ret = NDArray::Empty({len}, array->dtype, array->ctx);
+  int64_t num_feat = 1;
+  std::vector<int64_t> shape{len};
+  for (int d = 1; d < array->ndim; ++d) {
+    num_feat *= array->shape[d];
+    shape.emplace_back(array->shape[d]);
+  }
+  NDArray ret = NDArray::Empty(shape, array->dtype, array->ctx);
   DType* ret_data = static_cast<DType*>(ret->data);
-  for (int64_t i = 0; i < len; ++i) {
-    CHECK_LT(idx_data[i], arr_len) << "Index out of range.";
-    ret_data[i] = array_data[idx_data[i]];
+
+  if (num_feat == 1) {
+    runtime::parallel_for(0, len, [=](size_t b, size_t e) {
+      for (auto i = b; i < e; ++i) {
+        if (i + kRowPrefetchDistance < e)
+          PrefetchRow(reinterpret_cast<const char*>(
+                array_data + idx_data[i + kRowPrefetchDistance]));
+        CHECK(idx_data[i] >= 0 && idx_data[i] < arr_len) << "Index out of range.";
+        ret_data[i] = array_data[idx_data[i]];
+      }
+    });
+  } else {
+    CopyRows<IdType>(
+        static_cast<const char*>(array->data), idx_data, arr_len,
+        static_cast<char*>(ret->data), nullptr, len,
+        len, num_feat * sizeof(DType));
   }
   return ret;
 }
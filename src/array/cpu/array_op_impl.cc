@@ -8,6 +8,7 @@
 #include <dgl/runtime/parallel_for.h>
 #include <numeric>
 #include "../arith.h"
+#include "./concurrent_id_hash_map.h"
 
 namespace dgl {
 using runtime::NDArray;
@@ -204,29 +205,48 @@ template IdArray Range<kDLCPU, int64_t>(int64_t, int64_t, DLContext);
 template <DLDeviceType XPU, typename IdType>
 IdArray Relabel_(const std::vector<IdArray>& arrays) {
   // build map & relabel
-  IdType newid = 0;
-  std::unordered_map<IdType, IdType> oldv2newv;
+  ConcurrentIdHashMap<IdType> oldv2newv;
+  for (IdArray arr : arrays)
+    oldv2newv.Update(arr);
   for (IdArray arr : arrays) {
-    for (int64_t i = 0; i < arr->shape[0]; ++i) {
-      const IdType id = static_cast<IdType*>(arr->data)[i];
-      if (!oldv2newv.count(id)) {
-        oldv2newv[id] = newid++;
-      }
-      static_cast<IdType*>(arr->data)[i] = oldv2newv[id];
-    }
+    IdType* arr_data = static_cast<IdType*>(arr->data);
+    parallel_for(0, arr->shape[0], [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i)
+        arr_data[i] = oldv2newv.Map(arr_data[i], -1);
+    });
   }
   // map array
-  IdArray maparr = NewIdArray(newid, DLContext{kDLCPU, 0}, sizeof(IdType) * 8);
-  IdType* maparr_data = static_cast<IdType*>(maparr->data);
-  for (const auto& kv : oldv2newv) {
-    maparr_data[kv.second] = kv.first;
-  }
-  return maparr;
+  return oldv2newv.Values();
 }
 
 template IdArray Relabel_<kDLCPU, int32_t>(const std::vector<IdArray>& arrays);
 template IdArray Relabel_<kDLCPU, int64_t>(const std::vector<IdArray>& arrays);
 
+///////////////////////////// Unique /////////////////////////////
+
+template <DLDeviceType XPU, typename IdType>
+std::tuple<IdArray, IdArray, IdArray> Unique(IdArray ids) {
+  ConcurrentIdHashMap<IdType> oldv2newv(ids);
+  IdArray values = oldv2newv.Values();
+  IdArray inverse = oldv2newv.Map(ids, -1);
+  IdArray counts = aten::Full(0, values->shape[0], sizeof(IdType) * 8, ids->ctx);
+  const IdType* inverse_data = inverse.Ptr<IdType>();
+  IdType* counts_data = counts.Ptr<IdType>();
+  parallel_for(0, inverse->shape[0], [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      IdType* count = counts_data + inverse_data[i];
+      IdType curr = *count;
+      IdType prev;
+      while ((prev = CompareAndSwap(count, curr, curr + 1)) != curr)
+        curr = prev;
+    }
+  });
+  return std::make_tuple(values, inverse, counts);
+}
+
+template std::tuple<IdArray, IdArray, IdArray> Unique<kDLCPU, int32_t>(IdArray ids);
+template std::tuple<IdArray, IdArray, IdArray> Unique<kDLCPU, int64_t>(IdArray ids);
+
 }  // namespace impl
 }  // namespace aten
 }  // namespace dgl
@@ -0,0 +1,101 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file array/cpu/array_row_copy.h
+ * \brief Parallel copy of the rows of arrays by index on CPU.
+ */
+#ifndef DGL_ARRAY_CPU_ARRAY_ROW_COPY_H_
+#define DGL_ARRAY_CPU_ARRAY_ROW_COPY_H_
+
+#include <dgl/runtime/parallel_for.h>
+#include <dmlc/logging.h>
+#include <cstdint>
+#include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif  // __SSE2__
+
+namespace dgl {
+namespace aten {
+namespace impl {
+
+/*! \brief The number of rows ahead whose source is prefetched. */
+constexpr int64_t kRowPrefetchDistance = 8;
+
+/*!
+ * \brief The number of bytes of output from which the rows are written with
+ *        non-temporal stores, since such an output would only evict the source
+ *        rows from the cache.
+ */
+constexpr int64_t kNonTemporalCopyBytes = 1 << 25;
+
+/*! \brief Prefetch the start of a row to read. */
+inline void PrefetchRow(const char* row) {
+#if defined(__GNUC__)
+  __builtin_prefetch(row, 0, 0);
+#endif  // __GNUC__
+}
+
+/*!
+ * \brief Copy a row, with non-temporal stores if non_temporal, in which case
+ *        the destination must be aligned to 16 bytes.
+ */
+inline void CopyRow(char* dst, const char* src, int64_t row_bytes, bool non_temporal) {
+#if defined(__SSE2__)
+  if (non_temporal) {
+    int64_t i = 0;
+    for (; i + 16 <= row_bytes; i += 16) {
+      _mm_stream_si128(reinterpret_cast<__m128i*>(dst + i),
+                       _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+    }
+    std::memcpy(dst + i, src + i, row_bytes - i);
+    return;
+  }
+#endif  // __SSE2__
+  std::memcpy(dst, src, row_bytes);
+}
+
+/*!
+ * \brief Copy the row src_index[i] of src to the row dst_index[i] of dst for
+ *        every i in [0, len), in parallel, prefetching the upcoming source rows.
+ *        A null index stands for the identity.
+ *
+ * The rows are written with non-temporal stores if the output is large and
+ * every row starts on 16 bytes.
+ *
+ * \param num_src_rows The number of rows of src, to check the source indices.
+ * \param num_dst_rows The number of rows of dst, to check the destination indices.
+ */
+template <typename IdType>
+void CopyRows(
+    const char* src, const IdType* src_index, int64_t num_src_rows,
+    char* dst, const IdType* dst_index, int64_t num_dst_rows,
+    int64_t len, int64_t row_bytes) {
+#if defined(__SSE2__)
+  const bool non_temporal = len * row_bytes >= kNonTemporalCopyBytes &&
+    row_bytes % 16 == 0 && reinterpret_cast<uintptr_t>(dst) % 16 == 0;
+#else
+  const bool non_temporal = false;
+#endif  // __SSE2__
+  runtime::parallel_for(0, len, [&](size_t b, size_t e) {
+    for (auto i = b; i < e; ++i) {
+      if (src_index && i + kRowPrefetchDistance < e)
+        PrefetchRow(src + src_index[i + kRowPrefetchDistance] * row_bytes);
+      const int64_t src_row = src_index ? src_index[i] : i;
+      const int64_t dst_row = dst_index ? dst_index[i] : i;
+      CHECK(src_row >= 0 && src_row < num_src_rows) << "Index out of range.";
+      CHECK(dst_row >= 0 && dst_row < num_dst_rows) << "Index out of range.";
+      CopyRow(dst + dst_row * row_bytes, src + src_row * row_bytes, row_bytes, non_temporal);
+    }
+#if defined(__SSE2__)
+    // make the non-temporal stores visible to the other threads
+    if (non_temporal)
+      _mm_sfence();
+#endif  // __SSE2__
+  });
+}
+
+}  // namespace impl
+}  // namespace aten
+}  // namespace dgl
+
+#endif  // DGL_ARRAY_CPU_ARRAY_ROW_COPY_H_
@@ -5,6 +5,7 @@
  */
 #include <dgl/array.h>
 #include <dgl/runtime/parallel_for.h>
+#include "./array_row_copy.h"
 
 namespace dgl {
 using runtime::NDArray;
@@ -40,11 +41,21 @@ void Scatter_(IdArray index, NDArray value, NDArray out) {
   const IdType* idx = index.Ptr<IdType>();
   const DType* val = value.Ptr<DType>();
   DType* outd = out.Ptr<DType>();
-  runtime::parallel_for(0, len, [&](size_t b, size_t e) {
-    for (auto i = b; i < e; ++i) {
-      outd[idx[i]] = val[i];
-    }
-  });
+  int64_t num_feat = 1;
+  for (int d = 1; d < value->ndim; ++d)
+    num_feat *= value->shape[d];
+  if (num_feat == 1) {
+    runtime::parallel_for(0, len, [&](size_t b, size_t e) {
+      for (auto i = b; i < e; ++i) {
+        outd[idx[i]] = val[i];
+      }
+    });
+  } else {
+    CopyRows<IdType>(
+        reinterpret_cast<const char*>(val), nullptr, len,
+        reinterpret_cast<char*>(outd), idx, out->shape[0],
+        len, num_feat * sizeof(DType));
+  }
 }
 
 template void Scatter_<kDLCPU, int32_t, int32_t>(IdArray, NDArray, NDArray);
@@ -4,11 +4,14 @@
  * \brief Array sort CPU implementation
  */
 #include <dgl/array.h>
+#include <dgl/runtime/parallel_for.h>
 #ifdef PARALLEL_ALGORITHMS
 #include <parallel/algorithm>
 #endif
 #include <algorithm>
 #include <iterator>
+#include <type_traits>
+#include "./radix_sort.h"
 
 namespace {
 
@@ -167,6 +170,24 @@ std::pair<IdArray, IdArray> Sort(IdArray array, int /* num_bits */) {
   IdArray idx = aten::Range(0, nitem, 64, array->ctx);
   IdType* val_data = val.Ptr<IdType>();
   int64_t* idx_data = idx.Ptr<int64_t>();
+  if (nitem >= kRadixSortMinSize) {
+    // radix sort of the offsets to the minimum, which are unsigned
+    typedef typename std::make_unsigned<IdType>::type KeyType;
+    const auto minmax = std::minmax_element(val_data, val_data + nitem);
+    const IdType min_val = *minmax.first;
+    const KeyType range = static_cast<KeyType>(*minmax.second) - static_cast<KeyType>(min_val);
+    KeyType* keys = reinterpret_cast<KeyType*>(val_data);
+    runtime::parallel_for(0, nitem, kRadixSortMinSize, [&](int64_t b, int64_t e) {
+      for (int64_t i = b; i < e; ++i)
+        keys[i] -= static_cast<KeyType>(min_val);
+    });
+    RadixSortPairs(keys, idx_data, nitem, RadixSortNumBits(range));
+    runtime::parallel_for(0, nitem, kRadixSortMinSize, [&](int64_t b, int64_t e) {
+      for (int64_t i = b; i < e; ++i)
+        keys[i] += static_cast<KeyType>(min_val);
+    });
+    return std::make_pair(val, idx);
+  }
   typedef std::pair<IdType, int64_t> Pair;
 #ifdef PARALLEL_ALGORITHMS
   __gnu_parallel::sort(
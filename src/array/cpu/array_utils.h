@@ -8,6 +8,7 @@
 
 #include <dgl/aten/types.h>
 #include <parallel_hashmap/phmap.h>
+#include <memory>
 #include <vector>
 #include <unordered_map>
 #include <utility>
@@ -22,19 +23,24 @@ namespace aten {
  * Useful for relabeling integers and finding unique integers.
  *
  * Usually faster than std::unordered_map in existence checking.
+ *
+ * The filter and the hashmap memory is taken from Allocator, e.g. the arena of
+ * the calling thread for the temporary maps of the samplers. The filter grows
+ * with the number of ids given so far, so that a small map does not clear a
+ * large bitmap.
  */
-template <typename IdType>
+template <typename IdType, typename Allocator = std::allocator<IdType>>
 class IdHashMap {
  public:
   // default ctor
-  IdHashMap(): filter_(kFilterSize, false) {}
+  IdHashMap(): filter_(kMinFilterSize, false), filter_mask_(kMinFilterSize - 1) {}
 
   // Construct the hashmap using the given id array.
   // The id array could contain duplicates.
   // If the id array has no duplicates, the array will be relabeled to consecutive
   // integers starting from 0.
-  explicit IdHashMap(IdArray ids): filter_(kFilterSize, false) {
-    oldv2newv_.reserve(ids->shape[0]);
+  explicit IdHashMap(IdArray ids): IdHashMap() {
+    Reserve(ids->shape[0]);
     Update(ids);
   }
 
@@ -43,6 +49,7 @@ class IdHashMap {
 
   void Reserve(const int64_t size) {
     oldv2newv_.reserve(size);
+    ReserveFilter(size);
   }
 
   // Update the hashmap with given id array.
@@ -50,24 +57,25 @@ class IdHashMap {
   void Update(IdArray ids) {
     const IdType* ids_data = static_cast<IdType*>(ids->data);
     const int64_t len = ids->shape[0];
+    ReserveFilter(oldv2newv_.size() + len);
     for (int64_t i = 0; i < len; ++i) {
       const IdType id = ids_data[i];
       // phmap::flat_hash_map::insert assures that an insertion will not happen if the
       // key already exists.
       oldv2newv_.insert({id, oldv2newv_.size()});
-      filter_[id & kFilterMask] = true;
+      filter_[id & filter_mask_] = true;
     }
   }
 
   // Return true if the given id is contained in this hashmap.
   bool Contains(IdType id) const {
-    return filter_[id & kFilterMask] && oldv2newv_.count(id);
+    return filter_[id & filter_mask_] && oldv2newv_.count(id);
   }
 
   // Return the new id of the given id. If the given id is not contained
   // in the hash map, returns the default_val instead.
   IdType Map(IdType id, IdType default_val) const {
-    if (filter_[id & kFilterMask]) {
+    if (filter_[id & filter_mask_]) {
       auto it = oldv2newv_.find(id);
       return (it == oldv2newv_.end()) ? default_val : it->second;
     } else {
@@ -100,13 +108,33 @@ class IdHashMap {
   }
 
  private:
-  static constexpr int32_t kFilterMask = 0xFFFFFF;
-  static constexpr int32_t kFilterSize = kFilterMask + 1;
+  static constexpr int64_t kMinFilterSize = 1 << 10;
+  static constexpr int64_t kMaxFilterSize = 1 << 24;
+  // The number of bits of the filter for each id
+  static constexpr int64_t kFilterBitsPerId = 8;
+
+  // Enlarge the filter, up to kMaxFilterSize, for the given number of ids.
+  void ReserveFilter(int64_t size) {
+    int64_t filter_size = filter_mask_ + 1;
+    if (filter_size >= kMaxFilterSize || filter_size >= size * kFilterBitsPerId)
+      return;
+    while (filter_size < kMaxFilterSize && filter_size < size * kFilterBitsPerId)
+      filter_size *= 2;
+    filter_.assign(filter_size, false);
+    filter_mask_ = filter_size - 1;
+    for (const auto &pair : oldv2newv_)
+      filter_[pair.first & filter_mask_] = true;
+  }
+
   // This bitmap is used as a bloom filter to remove some lookups.
   // Hashtable is very slow. Using bloom filter can significantly speed up lookups.
-  std::vector<bool> filter_;
+  std::vector<bool, typename std::allocator_traits<Allocator>::template rebind_alloc<bool>>
+    filter_;
+  IdType filter_mask_;
   // The hashmap from old vid to new vid
-  phmap::flat_hash_map<IdType, IdType> oldv2newv_;
+  phmap::flat_hash_map<IdType, IdType, phmap::Hash<IdType>, phmap::EqualTo<IdType>,
+    typename std::allocator_traits<Allocator>::template rebind_alloc<
+      std::pair<const IdType, IdType>>> oldv2newv_;
 };
 
 /*
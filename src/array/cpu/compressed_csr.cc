@@ -0,0 +1,230 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file array/cpu/compressed_csr.cc
+ * \brief CompressedCSRMatrix CPU implementation
+ */
+#include <dgl/array.h>
+#include <dgl/random.h>
+#include <dgl/runtime/parallel_for.h>
+#include <algorithm>
+#include <numeric>
+#include <vector>
+#include "./compressed_csr.h"
+
+namespace dgl {
+namespace aten {
+namespace impl {
+
+using runtime::parallel_for;
+using runtime::parallel_for_weighted;
+
+namespace {
+
+/*!
+ * \brief Walk over the non-zeros of a block with their rows.
+ * \param fn The function called on the position and the row of every non-zero.
+ */
+template <typename IdType, typename F>
+inline void ForEachInBlock(const IdType* indptr, int64_t num_rows, int64_t nnz,
+                           int64_t block, F fn) {
+  const int64_t begin = block * kCompressedCSRBlockSize;
+  const int64_t end = std::min(nnz, begin + kCompressedCSRBlockSize);
+  // the last row starting at or before the block, i.e. the row of its first non-zero
+  int64_t row = std::upper_bound(indptr, indptr + num_rows + 1, begin) - indptr - 1;
+  for (int64_t pos = begin; pos < end; ++pos) {
+    while (indptr[row + 1] <= pos)
+      ++row;
+    fn(pos, row);
+  }
+}
+
+}  // namespace
+
+template <DLDeviceType XPU, typename IdType>
+CompressedCSRMatrix CSRCompress(CSRMatrix csr) {
+  if (!csr.sorted)
+    csr = CSRSort(csr);
+  const int64_t N = csr.num_rows;
+  const int64_t nnz = csr.indices->shape[0];
+  const int64_t num_blocks = (nnz + kCompressedCSRBlockSize - 1) / kCompressedCSRBlockSize;
+  const IdType* indptr = csr.indptr.Ptr<IdType>();
+  const IdType* indices = csr.indices.Ptr<IdType>();
+
+  // the stored value of a non-zero, which is its column index at the start of a
+  // row or a block
+  auto delta = [&](int64_t pos, int64_t row) -> uint64_t {
+    if (pos == indptr[row] || pos % kCompressedCSRBlockSize == 0)
+      return indices[pos];
+    return indices[pos] - indices[pos - 1];
+  };
+
+  IdArray block_offsets = NewIdArray(num_blocks + 1, csr.indptr->ctx, 64);
+  int64_t* block_offsets_data = block_offsets.Ptr<int64_t>();
+  block_offsets_data[0] = 0;
+  parallel_for(0, num_blocks, [&](int64_t b, int64_t e) {
+    for (int64_t block = b; block < e; ++block) {
+      int64_t size = 0;
+      ForEachInBlock(indptr, N, nnz, block, [&](int64_t pos, int64_t row) {
+        size += cpu::VarintSize(delta(pos, row));
+      });
+      block_offsets_data[block + 1] = size;
+    }
+  });
+  std::partial_sum(block_offsets_data, block_offsets_data + num_blocks + 1,
+                   block_offsets_data);
+
+  NDArray bytes = NDArray::Empty(
+      {block_offsets_data[num_blocks]}, DLDataType{kDLUInt, 8, 1}, csr.indptr->ctx);
+  uint8_t* bytes_data = bytes.Ptr<uint8_t>();
+  parallel_for(0, num_blocks, [&](int64_t b, int64_t e) {
+    for (int64_t block = b; block < e; ++block) {
+      uint8_t* out = bytes_data + block_offsets_data[block];
+      ForEachInBlock(indptr, N, nnz, block, [&](int64_t pos, int64_t row) {
+        out = cpu::EncodeVarint(delta(pos, row), out);
+      });
+    }
+  });
+
+  IdArray data = NullArray(csr.indptr->dtype, csr.indptr->ctx);
+  if (CSRHasData(csr)) {
+    const IdType* data_data = csr.data.Ptr<IdType>();
+    for (int64_t i = 0; i < nnz; ++i) {
+      if (data_data[i] != i) {
+        data = csr.data;
+        break;
+      }
+    }
+  }
+
+  CompressedCSRMatrix ret;
+  ret.num_rows = N;
+  ret.num_cols = csr.num_cols;
+  ret.indptr = csr.indptr;
+  ret.indices = bytes;
+  ret.block_offsets = block_offsets;
+  ret.data = data;
+  return ret;
+}
+
+template CompressedCSRMatrix CSRCompress<kDLCPU, int32_t>(CSRMatrix csr);
+template CompressedCSRMatrix CSRCompress<kDLCPU, int64_t>(CSRMatrix csr);
+
+template <DLDeviceType XPU, typename IdType>
+CSRMatrix CompressedCSRDecompress(const CompressedCSRMatrix& csr) {
+  const int64_t N = csr.num_rows;
+  const IdType* indptr = csr.indptr.Ptr<IdType>();
+  const int64_t nnz = indptr[N];
+  const int64_t num_blocks = csr.block_offsets->shape[0] - 1;
+  const uint8_t* bytes = csr.indices.Ptr<uint8_t>();
+  const int64_t* block_offsets = csr.block_offsets.Ptr<int64_t>();
+
+  IdArray indices = NewIdArray(nnz, csr.indptr->ctx, csr.indptr->dtype.bits);
+  IdType* indices_data = indices.Ptr<IdType>();
+  parallel_for(0, num_blocks, [&](int64_t b, int64_t e) {
+    for (int64_t block = b; block < e; ++block) {
+      const uint8_t* in = bytes + block_offsets[block];
+      ForEachInBlock(indptr, N, nnz, block, [&](int64_t pos, int64_t row) {
+        uint64_t value;
+        in = cpu::DecodeVarint(in, &value);
+        indices_data[pos] = static_cast<IdType>(
+            (pos == indptr[row] || pos % kCompressedCSRBlockSize == 0) ?
+            value : indices_data[pos - 1] + value);
+      });
+    }
+  });
+  return CSRMatrix(N, csr.num_cols, csr.indptr, indices, csr.data, true);
+}
+
+template CSRMatrix CompressedCSRDecompress<kDLCPU, int32_t>(const CompressedCSRMatrix& csr);
+template CSRMatrix CompressedCSRDecompress<kDLCPU, int64_t>(const CompressedCSRMatrix& csr);
+
+template <DLDeviceType XPU, typename IdType>
+COOMatrix CompressedCSRRowWiseSamplingUniform(
+    const CompressedCSRMatrix& csr, IdArray rows, int64_t num_samples, bool replace) {
+  const IdType* indptr = csr.indptr.Ptr<IdType>();
+  const uint8_t* bytes = csr.indices.Ptr<uint8_t>();
+  const int64_t* block_offsets = csr.block_offsets.Ptr<int64_t>();
+  const IdType* data = CompressedCSRHasData(csr) ? csr.data.Ptr<IdType>() : nullptr;
+  const IdType* rows_data = rows.Ptr<IdType>();
+  const int64_t num_rows = rows->shape[0];
+  const auto& ctx = csr.indptr->ctx;
+  const RowStreamKey row_streams = RowStreamScope::Current();
+
+  // the offsets of the rows in the result and the prefix sum of their degrees, as
+  // CSRRowWisePick
+  std::vector<int64_t> pick_prefix(num_rows + 1, 0);
+  std::vector<int64_t> deg_prefix(num_rows + 1, 0);
+  parallel_for(0, num_rows, [&](size_t b, size_t e) {
+    for (size_t i = b; i < e; ++i) {
+      const IdType rid = rows_data[i];
+      const int64_t len = indptr[rid + 1] - indptr[rid];
+      if (replace)
+        pick_prefix[i + 1] = len == 0 ? 0 : num_samples;
+      else
+        pick_prefix[i + 1] = std::min(num_samples, len);
+      deg_prefix[i + 1] = len;
+    }
+  });
+  std::partial_sum(pick_prefix.begin(), pick_prefix.end(), pick_prefix.begin());
+  std::partial_sum(deg_prefix.begin(), deg_prefix.end(), deg_prefix.begin());
+
+  const int64_t new_len = pick_prefix[num_rows];
+  IdArray picked_row = NewIdArray(new_len, ctx, sizeof(IdType) * 8);
+  IdArray picked_col = NewIdArray(new_len, ctx, sizeof(IdType) * 8);
+  IdArray picked_idx = NewIdArray(new_len, ctx, sizeof(IdType) * 8);
+  IdType* picked_rdata = picked_row.Ptr<IdType>();
+  IdType* picked_cdata = picked_col.Ptr<IdType>();
+  IdType* picked_idata = picked_idx.Ptr<IdType>();
+
+  parallel_for_weighted(0, num_rows, deg_prefix.data(), [&](size_t b, size_t e) {
+    RandomEngine* engine = RandomEngine::ThreadLocal();
+    const RandomEngine saved_engine = *engine;
+    for (size_t i = b; i < e; ++i) {
+      const IdType rid = rows_data[i];
+      const IdType off = indptr[rid];
+      const IdType len = indptr[rid + 1] - off;
+      const int64_t row_offset = pick_prefix[i];
+      const int64_t num_picked = pick_prefix[i + 1] - row_offset;
+      if (num_picked == 0)
+        continue;
+
+      if (len <= num_samples && !replace) {
+        // take all the non-zeros, decoding the row once
+        cpu::DecodeCompressedRow<IdType>(
+            bytes, block_offsets, off, off, off + len, picked_cdata + row_offset);
+        for (int64_t j = 0; j < len; ++j)
+          picked_idata[row_offset + j] = off + j;
+      } else {
+        // decode the picked non-zeros from their blocks
+        if (row_streams.enabled)
+          row_streams.Seed(engine, rid);
+        engine->UniformChoice<IdType>(
+            num_samples, len, picked_idata + row_offset, replace);
+        for (int64_t j = 0; j < num_samples; ++j) {
+          const IdType pos = off + picked_idata[row_offset + j];
+          cpu::DecodeCompressedRow<IdType>(
+              bytes, block_offsets, off, pos, pos + 1, picked_cdata + row_offset + j);
+          picked_idata[row_offset + j] = pos;
+        }
+      }
+      for (int64_t j = 0; j < num_picked; ++j) {
+        picked_rdata[row_offset + j] = rid;
+        if (data)
+          picked_idata[row_offset + j] = data[picked_idata[row_offset + j]];
+      }
+    }
+    if (row_streams.enabled)
+      *engine = saved_engine;
+  });
+
+  return COOMatrix(csr.num_rows, csr.num_cols, picked_row, picked_col, picked_idx);
+}
+
+template COOMatrix CompressedCSRRowWiseSamplingUniform<kDLCPU, int32_t>(
+    const CompressedCSRMatrix&, IdArray, int64_t, bool);
+template COOMatrix CompressedCSRRowWiseSamplingUniform<kDLCPU, int64_t>(
+    const CompressedCSRMatrix&, IdArray, int64_t, bool);
+
+}  // namespace impl
+}  // namespace aten
+}  // namespace dgl
@@ -0,0 +1,88 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file array/cpu/compressed_csr.h
+ * \brief Encoding and decoding of the column indices of CompressedCSRMatrix
+ */
+#ifndef DGL_ARRAY_CPU_COMPRESSED_CSR_H_
+#define DGL_ARRAY_CPU_COMPRESSED_CSR_H_
+
+#include <dgl/aten/compressed_csr.h>
+#include <algorithm>
+#include <cstdint>
+
+namespace dgl {
+namespace aten {
+namespace cpu {
+
+/*! \brief Return the number of bytes of the varint of a value. */
+inline int64_t VarintSize(uint64_t value) {
+  int64_t size = 1;
+  for (; value >= 0x80; value >>= 7)
+    ++size;
+  return size;
+}
+
+/*! \brief Write the varint of a value, returning the end of its bytes. */
+inline uint8_t* EncodeVarint(uint64_t value, uint8_t* out) {
+  for (; value >= 0x80; value >>= 7)
+    *(out++) = static_cast<uint8_t>(value) | 0x80;
+  *(out++) = static_cast<uint8_t>(value);
+  return out;
+}
+
+/*! \brief Read a varint, returning the end of its bytes. */
+inline const uint8_t* DecodeVarint(const uint8_t* in, uint64_t* value) {
+  uint64_t v = 0;
+  int shift = 0;
+  for (; *in & 0x80; ++in, shift += 7)
+    v |= static_cast<uint64_t>(*in & 0x7F) << shift;
+  *value = v | (static_cast<uint64_t>(*in) << shift);
+  return in + 1;
+}
+
+/*! \brief Skip the given number of varints, returning the end of their bytes. */
+inline const uint8_t* SkipVarints(const uint8_t* in, int64_t num) {
+  for (; num > 0; ++in) {
+    if (!(*in & 0x80))
+      --num;
+  }
+  return in;
+}
+
+/*!
+ * \brief Decode the column indices of the non-zeros [begin, end) of a row.
+ *
+ * The cost is the number of non-zeros from the start of the row, or from the
+ * start of the block of begin if it is after, to end. A row is thus best read by
+ * ranges not crossing the blocks.
+ *
+ * \param bytes The encoded column indices.
+ * \param block_offsets The byte positions of the blocks.
+ * \param row_start The position of the first non-zero of the row.
+ * \param begin The position of the first non-zero to decode, in the row.
+ * \param end The position after the last non-zero to decode, in the row.
+ * \param out The column indices of the non-zeros.
+ */
+template <typename IdType>
+inline void DecodeCompressedRow(
+    const uint8_t* bytes, const int64_t* block_offsets,
+    int64_t row_start, int64_t begin, int64_t end, IdType* out) {
+  const int64_t block_start = begin / kCompressedCSRBlockSize * kCompressedCSRBlockSize;
+  int64_t pos = std::max(row_start, block_start);
+  const uint8_t* in = SkipVarints(
+      bytes + block_offsets[begin / kCompressedCSRBlockSize], pos - block_start);
+  uint64_t col = 0;
+  for (; pos < end; ++pos) {
+    uint64_t value;
+    in = DecodeVarint(in, &value);
+    col = (pos == row_start || pos % kCompressedCSRBlockSize == 0) ? value : col + value;
+    if (pos >= begin)
+      out[pos - begin] = static_cast<IdType>(col);
+  }
+}
+
+}  // namespace cpu
+}  // namespace aten
+}  // namespace dgl
+
+#endif  // DGL_ARRAY_CPU_COMPRESSED_CSR_H_
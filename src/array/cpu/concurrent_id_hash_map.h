@@ -0,0 +1,270 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file array/cpu/concurrent_id_hash_map.h
+ * \brief A hashmap relabeling ids that is built and queried by all the threads.
+ */
+#ifndef DGL_ARRAY_CPU_CONCURRENT_ID_HASH_MAP_H_
+#define DGL_ARRAY_CPU_CONCURRENT_ID_HASH_MAP_H_
+
+#include <dgl/aten/types.h>
+#include <dgl/runtime/parallel_for.h>
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <vector>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif  // _MSC_VER
+#include "../../c_api_common.h"
+
+namespace dgl {
+namespace aten {
+
+namespace impl {
+
+/*!
+ * \brief Atomically replace *ptr by desired if it equals expected.
+ * \return The value of *ptr before the operation.
+ */
+inline int32_t CompareAndSwap(int32_t *ptr, int32_t expected, int32_t desired) {
+#ifdef _MSC_VER
+  return _InterlockedCompareExchange(reinterpret_cast<volatile long *>(ptr), desired, expected);
+#else
+  return __sync_val_compare_and_swap(ptr, expected, desired);
+#endif  // _MSC_VER
+}
+
+inline int64_t CompareAndSwap(int64_t *ptr, int64_t expected, int64_t desired) {
+#ifdef _MSC_VER
+  return _InterlockedCompareExchange64(
+      reinterpret_cast<volatile __int64 *>(ptr), desired, expected);
+#else
+  return __sync_val_compare_and_swap(ptr, expected, desired);
+#endif  // _MSC_VER
+}
+
+}  // namespace impl
+
+/*!
+ * \brief A hashmap that maps each ids in the given arrays to new ids starting from
+ *        zero, in the order of their first occurrence, like IdHashMap.
+ *
+ * The ids of an array are inserted by all the threads into an open addressing
+ * table, with linear probing on a compare-and-swap of the keys. Every occurrence
+ * also keeps the smallest position of its id by an atomic minimum, so that the
+ * first occurrences are known once all the ids are in, and a prefix sum over them
+ * gives the new ids. The relabeling is thus the same as the one of IdHashMap
+ * whatever the number of threads, as in the OrderedHashTable of the GPU.
+ *
+ * The ids must be non-negative. The table is kept at most half full and only
+ * grows between two updates. The memory is taken from Allocator, e.g. the arena
+ * of the calling thread for the temporary maps of the transforms.
+ */
+template <typename IdType, typename Allocator = std::allocator<IdType>>
+class ConcurrentIdHashMap {
+ public:
+  ConcurrentIdHashMap() = default;
+
+  // Construct the hashmap using the given id array.
+  // The id array could contain duplicates.
+  explicit ConcurrentIdHashMap(IdArray ids) {
+    Update(ids);
+  }
+
+  ConcurrentIdHashMap(const ConcurrentIdHashMap &other) = default;
+
+  // Make room for the given number of ids without growing the table.
+  void Reserve(const int64_t size) {
+    Grow(size);
+  }
+
+  // Update the hashmap with given id array.
+  // The id array could contain duplicates.
+  void Update(IdArray ids) {
+    const IdType* ids_data = static_cast<IdType*>(ids->data);
+    const int64_t len = ids->shape[0];
+    if (len == 0)
+      return;
+    CHECK_LT(size_ + len, std::numeric_limits<IdType>::max())
+      << "Too many ids for the id type of the hashmap.";
+    Grow(size_ + len);
+
+    // The ids already in the table map to new ids below size_, the others keep
+    // size_ plus the position of their first occurrence.
+    std::vector<int64_t, SlotAllocator> slots(len);
+    runtime::parallel_for(0, len, kGrainSize, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i)
+        slots[i] = Insert(ids_data[i], size_ + i);
+    });
+
+    // Count the first occurrences of the new ids by chunk, forgetting the slots
+    // of the other elements.
+    const int64_t num_chunks = (len + kGrainSize - 1) / kGrainSize;
+    std::vector<int64_t, SlotAllocator> chunk_offsets(num_chunks + 1, 0);
+    runtime::parallel_for(0, num_chunks, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; ++c) {
+        int64_t count = 0;
+        for (int64_t i = c * kGrainSize; i < std::min(len, (c + 1) * kGrainSize); ++i) {
+          if (values_[slots[i]] == static_cast<IdType>(size_ + i))
+            ++count;
+          else
+            slots[i] = -1;
+        }
+        chunk_offsets[c + 1] = count;
+      }
+    });
+    for (int64_t c = 0; c < num_chunks; ++c)
+      chunk_offsets[c + 1] += chunk_offsets[c];
+
+    runtime::parallel_for(0, num_chunks, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; ++c) {
+        int64_t newid = size_ + chunk_offsets[c];
+        for (int64_t i = c * kGrainSize; i < std::min(len, (c + 1) * kGrainSize); ++i) {
+          if (slots[i] >= 0)
+            values_[slots[i]] = newid++;
+        }
+      }
+    });
+    size_ += chunk_offsets[num_chunks];
+  }
+
+  // Return true if the given id is contained in this hashmap.
+  bool Contains(IdType id) const {
+    return Find(id) >= 0;
+  }
+
+  // Return the new id of the given id. If the given id is not contained
+  // in the hash map, returns the default_val instead.
+  IdType Map(IdType id, IdType default_val) const {
+    const int64_t slot = Find(id);
+    return (slot < 0) ? default_val : values_[slot];
+  }
+
+  // Return the new id of each id in the given array.
+  IdArray Map(IdArray ids, IdType default_val) const {
+    const IdType* ids_data = static_cast<IdType*>(ids->data);
+    const int64_t len = ids->shape[0];
+    IdArray values = NewIdArray(len, ids->ctx, ids->dtype.bits);
+    IdType* values_data = static_cast<IdType*>(values->data);
+    runtime::parallel_for(0, len, kGrainSize, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i)
+        values_data[i] = Map(ids_data[i], default_val);
+    });
+    return values;
+  }
+
+  // Return all the old ids collected so far, ordered by new id.
+  IdArray Values() const {
+    IdArray values = NewIdArray(size_, DLContext{kDLCPU, 0}, sizeof(IdType) * 8);
+    IdType* values_data = static_cast<IdType*>(values->data);
+    const int64_t capacity = keys_.size();
+    runtime::parallel_for(0, capacity, kGrainSize, [&](int64_t begin, int64_t end) {
+      for (int64_t slot = begin; slot < end; ++slot) {
+        if (keys_[slot] != kEmptyKey)
+          values_data[values_[slot]] = keys_[slot];
+      }
+    });
+    return values;
+  }
+
+  inline size_t Size() const {
+    return size_;
+  }
+
+ private:
+  typedef typename std::allocator_traits<Allocator>::template rebind_alloc<int64_t>
+    SlotAllocator;
+
+  static constexpr IdType kEmptyKey = -1;
+  static constexpr IdType kEmptyValue = std::numeric_limits<IdType>::max();
+  static constexpr int64_t kMinCapacity = 64;
+  // the number of elements below which a loop runs on a single thread
+  static constexpr int64_t kGrainSize = 4096;
+
+  inline int64_t Hash(IdType id) const {
+    // Fibonacci hashing, so that consecutive ids are spread over the table
+    return static_cast<int64_t>(
+        (static_cast<uint64_t>(id) * 0x9E3779B97F4A7C15ull) >> hash_shift_);
+  }
+
+  /*!
+   * \brief Insert the id if it is not in the table yet and lower its value to the
+   *        given one, from any thread.
+   * \return The slot of the id.
+   */
+  int64_t Insert(IdType id, IdType value) {
+    const int64_t mask = keys_.size() - 1;
+    int64_t slot = Hash(id);
+    while (true) {
+      // a stale read only costs a compare-and-swap
+      IdType key = keys_[slot];
+      if (key == kEmptyKey)
+        key = impl::CompareAndSwap(&keys_[slot], kEmptyKey, id);
+      if (key == kEmptyKey || key == id)
+        break;
+      slot = (slot + 1) & mask;
+    }
+    IdType curr = values_[slot];
+    while (value < curr) {
+      const IdType prev = impl::CompareAndSwap(&values_[slot], curr, value);
+      if (prev == curr)
+        break;
+      curr = prev;
+    }
+    return slot;
+  }
+
+  // Return the slot of the id, or -1 if it is not in the table.
+  int64_t Find(IdType id) const {
+    if (id < 0 || keys_.empty())
+      return -1;
+    const int64_t mask = keys_.size() - 1;
+    for (int64_t slot = Hash(id); keys_[slot] != kEmptyKey; slot = (slot + 1) & mask) {
+      if (keys_[slot] == id)
+        return slot;
+    }
+    return -1;
+  }
+
+  // Rehash the table if it cannot hold the given number of ids.
+  void Grow(int64_t size) {
+    int64_t capacity = kMinCapacity;
+    int log_capacity = 6;
+    while (capacity < 2 * size) {
+      capacity *= 2;
+      ++log_capacity;
+    }
+    if (capacity <= static_cast<int64_t>(keys_.size()))
+      return;
+
+    std::vector<IdType, Allocator> old_keys(capacity, kEmptyKey);
+    std::vector<IdType, Allocator> old_values(capacity, kEmptyValue);
+    old_keys.swap(keys_);
+    old_values.swap(values_);
+    hash_shift_ = 64 - log_capacity;
+    const int64_t old_capacity = old_keys.size();
+    runtime::parallel_for(0, old_capacity, kGrainSize, [&](int64_t begin, int64_t end) {
+      for (int64_t slot = begin; slot < end; ++slot) {
+        if (old_keys[slot] != kEmptyKey)
+          Insert(old_keys[slot], old_values[slot]);
+      }
+    });
+  }
+
+  // The ids in the table, or kEmptyKey for the free slots
+  std::vector<IdType, Allocator> keys_;
+  // The new ids of the keys
+  std::vector<IdType, Allocator> values_;
+  int hash_shift_ = 64;
+  int64_t size_ = 0;
+};
+
+template <typename IdType, typename Allocator>
+constexpr IdType ConcurrentIdHashMap<IdType, Allocator>::kEmptyKey;
+template <typename IdType, typename Allocator>
+constexpr IdType ConcurrentIdHashMap<IdType, Allocator>::kEmptyValue;
+
+}  // namespace aten
+}  // namespace dgl
+
+#endif  // DGL_ARRAY_CPU_CONCURRENT_ID_HASH_MAP_H_
@@ -5,47 +5,96 @@
  */
 
 #include <dgl/array.h>
+#include <dgl/runtime/parallel_for.h>
 #include <numeric>
 #include <algorithm>
 #include <vector>
 #include <iterator>
 
 namespace dgl {
+using runtime::parallel_for;
 namespace aten {
 namespace impl {
 
+namespace {
+
+/*!
+ * \brief Call fn(j) on the edges j following the edge i in the line graph, i.e.
+ *        leaving the destination of i, in the order of the input, except i
+ *        itself and, without backtracking, the edges going back to the source of i.
+ */
+template <typename IdType, typename Fn>
+inline void ForEachSuccessor(
+    int64_t i, const IdType *coo_row, const IdType *coo_col, const IdType *out_indptr,
+    const IdType *out_edges, int64_t num_nodes, bool backtracking, Fn fn) {
+  const IdType u = coo_row[i];
+  const IdType v = coo_col[i];
+  if (v >= num_nodes)
+    return;
+  for (IdType k = out_indptr[v]; k < out_indptr[v + 1]; ++k) {
+    const IdType j = out_edges[k];
+    if (j != i && (backtracking || coo_col[j] != u))
+      fn(j);
+  }
+}
+
+}  // namespace
+
+/*
+ * The edges are first grouped by source. The successors of every edge are then
+ * counted in parallel, so that the line graph is allocated at its exact size,
+ * and written in a second pass.
+ */
 template <DLDeviceType XPU, typename IdType>
 COOMatrix COOLineGraph(const COOMatrix &coo, bool backtracking) {
   const int64_t nnz = coo.row->shape[0];
-  IdType* coo_row = coo.row.Ptr<IdType>();
-  IdType* coo_col = coo.col.Ptr<IdType>();
-  IdArray data = COOHasData(coo) ? coo.data : Range(0,
-                                                    nnz,
-                                                    coo.row->dtype.bits,
-                                                    coo.row->ctx);
-  IdType* data_data = data.Ptr<IdType>();
-  std::vector<IdType> new_row;
-  std::vector<IdType> new_col;
-
-  for (int64_t i = 0; i < nnz; ++i) {
-    IdType u = coo_row[i];
-    IdType v = coo_col[i];
-    for (int64_t j = 0; j < nnz; ++j) {
-      // no self-loop
-      if (i == j)
-        continue;
-
-      // succ_u == v
-      // if not backtracking succ_u != u
-      if (v == coo_row[j] && (backtracking || u != coo_col[j])) {
-        new_row.push_back(data_data[i]);
-        new_col.push_back(data_data[j]);
-      }
-    }
+  const int64_t num_nodes = coo.num_rows;
+  const IdType* coo_row = coo.row.Ptr<IdType>();
+  const IdType* coo_col = coo.col.Ptr<IdType>();
+  const IdType* data_data = COOHasData(coo) ? coo.data.Ptr<IdType>() : nullptr;
+
+  // the edges leaving every node, in the order of the input
+  std::vector<IdType> out_indptr(num_nodes + 1, 0);
+  std::vector<IdType> out_edges(nnz);
+  for (int64_t i = 0; i < nnz; ++i)
+    ++out_indptr[coo_row[i] + 1];
+  std::partial_sum(out_indptr.begin(), out_indptr.end(), out_indptr.begin());
+  {
+    std::vector<IdType> out_pos(out_indptr.begin(), out_indptr.end() - 1);
+    for (int64_t i = 0; i < nnz; ++i)
+      out_edges[out_pos[coo_row[i]]++] = i;
   }
 
-  COOMatrix res = COOMatrix(nnz, nnz, NDArray::FromVector(new_row), NDArray::FromVector(new_col),
-    NullArray(), false, false);
+  std::vector<int64_t> offsets(nnz + 1, 0);
+  parallel_for(0, nnz, [&](int64_t b, int64_t e) {
+    for (int64_t i = b; i < e; ++i) {
+      int64_t count = 0;
+      ForEachSuccessor(i, coo_row, coo_col, out_indptr.data(), out_edges.data(), num_nodes,
+                       backtracking, [&count] (IdType) { ++count; });
+      offsets[i + 1] = count;
+    }
+  });
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+  const int64_t num_new_edges = offsets[nnz];
+  IdArray new_row = NewIdArray(num_new_edges, coo.row->ctx, coo.row->dtype.bits);
+  IdArray new_col = NewIdArray(num_new_edges, coo.row->ctx, coo.row->dtype.bits);
+  IdType* new_row_data = new_row.Ptr<IdType>();
+  IdType* new_col_data = new_col.Ptr<IdType>();
+  parallel_for(0, nnz, [&](int64_t b, int64_t e) {
+    for (int64_t i = b; i < e; ++i) {
+      const IdType eid = data_data ? data_data[i] : i;
+      int64_t pos = offsets[i];
+      ForEachSuccessor(i, coo_row, coo_col, out_indptr.data(), out_edges.data(), num_nodes,
+                       backtracking, [&] (IdType j) {
+        new_row_data[pos] = eid;
+        new_col_data[pos] = data_data ? data_data[j] : j;
+        ++pos;
+      });
+    }
+  });
+
+  COOMatrix res = COOMatrix(nnz, nnz, new_row, new_col, NullArray(), false, false);
   return res;
 }
 
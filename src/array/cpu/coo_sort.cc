@@ -4,6 +4,7 @@
  * \brief COO sorting
  */
 #include <dgl/array.h>
+#include <dgl/runtime/parallel_for.h>
 #ifdef PARALLEL_ALGORITHMS
 #include <parallel/algorithm>
 #endif
@@ -12,6 +13,8 @@
 #include <vector>
 #include <iterator>
 #include <tuple>
+#include <type_traits>
+#include "./radix_sort.h"
 
 namespace {
 
@@ -167,6 +170,58 @@ namespace impl {
 
 ///////////////////////////// COOSort_ /////////////////////////////
 
+namespace {
+
+/*!
+ * \brief Sort the entries of a COO matrix by row, then by column if sort_column,
+ *        with radix sorts of the entry positions.
+ *
+ * The positions are sorted by column first, then by row, each sort being stable.
+ */
+template <typename IdType>
+void COORadixSort_(COOMatrix* coo, bool sort_column) {
+  typedef typename std::make_unsigned<IdType>::type KeyType;
+  const int64_t nnz = coo->row->shape[0];
+  IdType* coo_row = coo->row.Ptr<IdType>();
+  IdType* coo_col = coo->col.Ptr<IdType>();
+  IdType* coo_data = coo->data.Ptr<IdType>();
+
+  std::vector<KeyType> keys(nnz);
+  std::vector<IdType> perm(nnz);
+  std::vector<IdType> buffer(nnz);
+  runtime::parallel_for(0, nnz, kRadixSortMinSize, [&](int64_t b, int64_t e) {
+    for (int64_t i = b; i < e; ++i) {
+      keys[i] = sort_column ? coo_col[i] : coo_row[i];
+      perm[i] = i;
+    }
+  });
+  if (sort_column) {
+    RadixSortPairs(keys.data(), perm.data(), nnz, RadixSortNumBits(coo->num_cols - 1));
+    runtime::parallel_for(0, nnz, kRadixSortMinSize, [&](int64_t b, int64_t e) {
+      for (int64_t i = b; i < e; ++i)
+        keys[i] = coo_row[perm[i]];
+    });
+  }
+  RadixSortPairs(keys.data(), perm.data(), nnz, RadixSortNumBits(coo->num_rows - 1));
+
+  // the rows are the sorted keys, the columns and data are gathered
+  auto gather = [&](IdType* arr) {
+    runtime::parallel_for(0, nnz, kRadixSortMinSize, [&](int64_t b, int64_t e) {
+      for (int64_t i = b; i < e; ++i)
+        buffer[i] = arr[perm[i]];
+    });
+    std::swap_ranges(buffer.begin(), buffer.end(), arr);
+  };
+  gather(coo_col);
+  gather(coo_data);
+  runtime::parallel_for(0, nnz, kRadixSortMinSize, [&](int64_t b, int64_t e) {
+    for (int64_t i = b; i < e; ++i)
+      coo_row[i] = keys[i];
+  });
+}
+
+}  // namespace
+
 template <DLDeviceType XPU, typename IdType>
 void COOSort_(COOMatrix* coo, bool sort_column) {
   const int64_t nnz = coo->row->shape[0];
@@ -179,7 +234,9 @@ void COOSort_(COOMatrix* coo, bool sort_column) {
   typedef std::tuple<IdType, IdType, IdType> Tuple;
 
   // Arg sort
-  if (sort_column) {
+  if (nnz >= kRadixSortMinSize) {
+    COORadixSort_<IdType>(coo, sort_column);
+  } else if (sort_column) {
 #ifdef PARALLEL_ALGORITHMS
     __gnu_parallel::sort(
 #else
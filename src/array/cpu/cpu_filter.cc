@@ -0,0 +1,134 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file array/cpu/cpu_filter.cc
+ * \brief Object for selecting items in a set, or selecting items not in a set.
+ */
+
+#include <dgl/runtime/parallel_for.h>
+#include <parallel_hashmap/phmap.h>
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+#include "../filter.h"
+#include "../../runtime/arena.h"
+
+namespace dgl {
+namespace array {
+
+namespace {
+
+/*!
+ * \brief The set is stored as a bitmap over [min, max] when that range has at
+ *        most this many times as many items as the set, i.e. when the bitmap
+ *        takes at most 8 bytes per item. A hash set is used otherwise.
+ */
+constexpr int64_t kBitmapBitsPerItem = 64;
+
+/*! \brief The number of items a thread filters at a time. */
+constexpr int64_t kFilterChunkSize = 1 << 14;
+
+template<typename IdType>
+class CpuFilterSet : public Filter {
+ public:
+  explicit CpuFilterSet(IdArray array) {
+    const IdType* data = array.Ptr<IdType>();
+    const int64_t size = array->shape[0];
+    if (size == 0)
+      return;
+    const auto minmax = std::minmax_element(data, data + size);
+    min_ = *minmax.first;
+    range_ = static_cast<int64_t>(*minmax.second) - min_ + 1;
+    use_bitmap_ = range_ <= kBitmapBitsPerItem * size;
+    if (use_bitmap_) {
+      bitmap_.resize((range_ + 63) / 64, 0);
+      for (int64_t i = 0; i < size; ++i) {
+        const uint64_t off = static_cast<int64_t>(data[i]) - min_;
+        bitmap_[off >> 6] |= uint64_t(1) << (off & 63);
+      }
+    } else {
+      set_.reserve(size);
+      set_.insert(data, data + size);
+    }
+  }
+
+  IdArray find_included_indices(IdArray test) override {
+    return PerformFilter<true>(test);
+  }
+
+  IdArray find_excluded_indices(IdArray test) override {
+    return PerformFilter<false>(test);
+  }
+
+ private:
+  bool Contains(IdType item) const {
+    if (use_bitmap_) {
+      // items below min_ wrap around to offsets larger than range_
+      const uint64_t off = static_cast<int64_t>(item) - min_;
+      return off < static_cast<uint64_t>(range_) && ((bitmap_[off >> 6] >> (off & 63)) & 1);
+    }
+    return !set_.empty() && set_.count(item);
+  }
+
+  template<bool include>
+  IdArray PerformFilter(IdArray test) const {
+    const int64_t size = test->shape[0];
+    if (size == 0) {
+      return test;
+    }
+    const IdType* test_data = test.Ptr<IdType>();
+
+    // The items are split in chunks: the chunks count their selected items in
+    // parallel, then write their indices at the prefix sum of the counts.
+    const int64_t num_chunks = (size + kFilterChunkSize - 1) / kFilterChunkSize;
+    runtime::ArenaScope arena_scope;
+    uint8_t* mark = arena_scope.arena()->Alloc<uint8_t>(size);
+    int64_t* chunk_prefix = arena_scope.arena()->Alloc<int64_t>(num_chunks + 1);
+    chunk_prefix[0] = 0;
+    runtime::parallel_for(0, num_chunks, [&](size_t b, size_t e) {
+      for (size_t c = b; c < e; ++c) {
+        const int64_t end = std::min<int64_t>(size, (c + 1) * kFilterChunkSize);
+        int64_t count = 0;
+        for (int64_t i = c * kFilterChunkSize; i < end; ++i) {
+          mark[i] = Contains(test_data[i]) == include;
+          count += mark[i];
+        }
+        chunk_prefix[c + 1] = count;
+      }
+    });
+    std::partial_sum(chunk_prefix, chunk_prefix + num_chunks + 1, chunk_prefix);
+
+    IdArray result = aten::NewIdArray(chunk_prefix[num_chunks], test->ctx, sizeof(IdType) * 8);
+    IdType* result_data = result.Ptr<IdType>();
+    runtime::parallel_for(0, num_chunks, [&](size_t b, size_t e) {
+      for (size_t c = b; c < e; ++c) {
+        const int64_t end = std::min<int64_t>(size, (c + 1) * kFilterChunkSize);
+        IdType* out = result_data + chunk_prefix[c];
+        for (int64_t i = c * kFilterChunkSize; i < end; ++i) {
+          if (mark[i])
+            *(out++) = i;
+        }
+      }
+    });
+    return result;
+  }
+
+  bool use_bitmap_{false};
+  int64_t min_{0}, range_{0};
+  std::vector<uint64_t> bitmap_;
+  phmap::flat_hash_set<IdType> set_;
+};
+
+}  // namespace
+
+template<DLDeviceType XPU, typename IdType>
+FilterRef CreateSetFilter(IdArray set) {
+  return FilterRef(std::make_shared<CpuFilterSet<IdType>>(set));
+}
+
+template FilterRef CreateSetFilter<kDLCPU, int32_t>(IdArray set);
+template FilterRef CreateSetFilter<kDLCPU, int64_t>(IdArray set);
+
+}  // namespace array
+}  // namespace dgl
@@ -0,0 +1,191 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file array/cpu/csr_accumulator.h
+ * \brief Row accumulators of the sparse-sparse products and sums on CPU.
+ */
+#ifndef DGL_ARRAY_CPU_CSR_ACCUMULATOR_H_
+#define DGL_ARRAY_CPU_CSR_ACCUMULATOR_H_
+
+#include <dgl/runtime/parallel_for.h>
+#include <algorithm>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace dgl {
+namespace aten {
+namespace cpu {
+
+/*!
+ * \brief A row is accumulated in the dense array when its number of products
+ *        times this ratio reaches the number of columns, so that the array is
+ *        only used by the rows that fill a part of it.
+ */
+constexpr int64_t kDenseAccumulatorRatio = 16;
+
+/*! \brief The number of rows of the chunks of the parallel prefix sum. */
+constexpr int64_t kScanChunkSize = 1 << 14;
+
+/*!
+ * \brief Accumulator of the products of a row of a sparse-sparse product, meant
+ *        to be owned by a thread and reused over its rows (Gustavson's algorithm).
+ *
+ * A row with many products relative to the number of columns is accumulated in
+ * a dense array of the width of the result, allocated on first use, whose
+ * entries are marked with the row that wrote them last so that it is never
+ * cleared. The other rows sort their products by column and merge them. Either
+ * way the row is returned with sorted columns.
+ */
+template <typename IdType, typename DType>
+class RowAccumulator {
+ public:
+  explicit RowAccumulator(int64_t num_cols) : num_cols_(num_cols) {}
+
+  /*! \brief Start a row of about the given number of products. */
+  void Begin(int64_t num_products) {
+    dense_ = num_products * kDenseAccumulatorRatio >= num_cols_;
+    if (dense_ && mark_.empty()) {
+      mark_.assign(num_cols_, -1);
+      values_.resize(num_cols_);
+    }
+    ++row_;
+    cols_.clear();
+    vals_.clear();
+    products_.clear();
+  }
+
+  /*! \brief Add the value to the column of the row. */
+  void Add(IdType col, DType val) {
+    if (!dense_) {
+      products_.emplace_back(col, val);
+    } else if (mark_[col] != row_) {
+      mark_[col] = row_;
+      values_[col] = val;
+      cols_.push_back(col);
+    } else {
+      values_[col] += val;
+    }
+  }
+
+  /*! \brief Add the column of the row, to count the columns without the values. */
+  void AddColumn(IdType col) {
+    if (!dense_) {
+      cols_.push_back(col);
+    } else if (mark_[col] != row_) {
+      mark_[col] = row_;
+      cols_.push_back(col);
+    }
+  }
+
+  /*! \brief The number of columns of the row added with AddColumn. */
+  int64_t CountColumns() {
+    if (dense_)
+      return cols_.size();
+    std::sort(cols_.begin(), cols_.end());
+    return std::unique(cols_.begin(), cols_.end()) - cols_.begin();
+  }
+
+  /*!
+   * \brief Finish the row added with Add, making its sorted columns and their
+   *        summed values available in cols() and vals().
+   */
+  void Finish() {
+    if (dense_) {
+      std::sort(cols_.begin(), cols_.end());
+      vals_.reserve(cols_.size());
+      for (const IdType col : cols_)
+        vals_.push_back(values_[col]);
+      return;
+    }
+    std::sort(products_.begin(), products_.end(),
+              [] (const std::pair<IdType, DType>& a, const std::pair<IdType, DType>& b) {
+                return a.first < b.first;
+              });
+    for (const auto& product : products_) {
+      if (!cols_.empty() && cols_.back() == product.first) {
+        vals_.back() += product.second;
+      } else {
+        cols_.push_back(product.first);
+        vals_.push_back(product.second);
+      }
+    }
+  }
+
+  /*!
+   * \brief Keep the k columns of the finished row with the largest values, the
+   *        smallest columns first among equal values, still sorted by column.
+   */
+  void KeepTopK(int64_t k) {
+    if (static_cast<int64_t>(cols_.size()) <= k)
+      return;
+    std::vector<int64_t> order(cols_.size());
+    std::iota(order.begin(), order.end(), 0);
+    // the columns are sorted, so that the position breaks the ties
+    std::nth_element(order.begin(), order.begin() + k, order.end(),
+                     [this] (int64_t a, int64_t b) {
+                       return vals_[a] > vals_[b] || (vals_[a] == vals_[b] && a < b);
+                     });
+    order.resize(k);
+    std::sort(order.begin(), order.end());
+    for (int64_t i = 0; i < k; ++i) {
+      cols_[i] = cols_[order[i]];
+      vals_[i] = vals_[order[i]];
+    }
+    cols_.resize(k);
+    vals_.resize(k);
+  }
+
+  const std::vector<IdType>& cols() const { return cols_; }
+  const std::vector<DType>& vals() const { return vals_; }
+
+ private:
+  const int64_t num_cols_;
+  bool dense_ = false;
+  // the row of the current products, to mark the entries of the dense array
+  int64_t row_ = -1;
+  std::vector<int64_t> mark_;
+  std::vector<DType> values_;
+  std::vector<std::pair<IdType, DType>> products_;
+  std::vector<IdType> cols_;
+  std::vector<DType> vals_;
+};
+
+/*!
+ * \brief Turn the counts at [0, n) into their exclusive prefix sum, followed by
+ *        the total at n, in parallel over chunks of rows.
+ * \return The total.
+ */
+template <typename T>
+int64_t PrefixSumInPlace(T* data, int64_t n) {
+  const int64_t num_chunks = (n + kScanChunkSize - 1) / kScanChunkSize;
+  std::vector<int64_t> chunk_prefix(num_chunks + 1, 0);
+  runtime::parallel_for(0, num_chunks, [&](size_t b, size_t e) {
+    for (size_t c = b; c < e; ++c) {
+      const int64_t end = std::min<int64_t>(n, (c + 1) * kScanChunkSize);
+      int64_t sum = 0;
+      for (int64_t i = c * kScanChunkSize; i < end; ++i)
+        sum += data[i];
+      chunk_prefix[c + 1] = sum;
+    }
+  });
+  std::partial_sum(chunk_prefix.begin(), chunk_prefix.end(), chunk_prefix.begin());
+  runtime::parallel_for(0, num_chunks, [&](size_t b, size_t e) {
+    for (size_t c = b; c < e; ++c) {
+      const int64_t end = std::min<int64_t>(n, (c + 1) * kScanChunkSize);
+      int64_t sum = chunk_prefix[c];
+      for (int64_t i = c * kScanChunkSize; i < end; ++i) {
+        const int64_t len = data[i];
+        data[i] = sum;
+        sum += len;
+      }
+    }
+  });
+  data[n] = chunk_prefix[num_chunks];
+  return chunk_prefix[num_chunks];
+}
+
+}  // namespace cpu
+}  // namespace aten
+}  // namespace dgl
+
+#endif  // DGL_ARRAY_CPU_CSR_ACCUMULATOR_H_
@@ -5,10 +5,14 @@
  */
 #include <dgl/array.h>
 #include <dgl/runtime/parallel_for.h>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #include <unordered_set>
 #include <numeric>
 #include "array_utils.h"
+#include "./radix_sort.h"
 
 namespace dgl {
 
@@ -38,6 +42,102 @@ void CollectDataFromSorted(const IdType *indices_data, const IdType *data,
   }
 }
 
+/*! \brief The number of queries from which CSRGetData sorts them by row. */
+constexpr int64_t kCSRGetDataBatchMinQueries = 1 << 14;
+/*! \brief The number of queries of an unsorted row from which the row is sorted. */
+constexpr int64_t kCSRGetDataSortRowMinQueries = 8;
+
+/*!
+ * \brief Look up the non-zeros of a batch of (row, col) pairs.
+ *
+ * The pairs are sorted by row then column with radix sorts, and each row is
+ * merge-joined with its sorted queries: every query searches from the match of
+ * the previous one. The rows of an unsorted matrix with many queries are sorted
+ * first, stably so that the first match in the row is still returned.
+ *
+ * \param write The function called on the position of every matched query and
+ *        the position of its non-zero.
+ */
+template <typename IdType, typename F>
+void CSRGetDataBatched(
+    const CSRMatrix& csr, const IdType* row_data, const IdType* col_data,
+    int64_t row_stride, int64_t col_stride, int64_t num_queries, F write) {
+  typedef typename std::make_unsigned<IdType>::type KeyType;
+  typedef std::pair<IdType, IdType> ColumnPair;
+  const IdType* indptr_data = static_cast<IdType*>(csr.indptr->data);
+  const IdType* indices_data = static_cast<IdType*>(csr.indices->data);
+
+  std::vector<KeyType> keys(num_queries);
+  std::vector<int64_t> order(num_queries);
+  parallel_for(0, num_queries, [&](size_t b, size_t e) {
+    for (auto p = b; p < e; ++p) {
+      const IdType row_id = row_data[p * row_stride], col_id = col_data[p * col_stride];
+      CHECK(row_id >= 0 && row_id < csr.num_rows) << "Invalid row index: " << row_id;
+      CHECK(col_id >= 0 && col_id < csr.num_cols) << "Invalid col index: " << col_id;
+      keys[p] = col_id;
+      order[p] = p;
+    }
+  });
+  RadixSortPairs(keys.data(), order.data(), num_queries, RadixSortNumBits(csr.num_cols - 1));
+  parallel_for(0, num_queries, [&](size_t b, size_t e) {
+    for (auto p = b; p < e; ++p)
+      keys[p] = row_data[order[p] * row_stride];
+  });
+  RadixSortPairs(keys.data(), order.data(), num_queries, RadixSortNumBits(csr.num_rows - 1));
+
+  // every chunk handles the rows whose first query it holds
+  parallel_for(0, num_queries, [&](size_t b, size_t e) {
+    std::vector<ColumnPair> sorted_row;
+    int64_t start = b;
+    while (start > 0 && start < static_cast<int64_t>(e) && keys[start] == keys[start - 1])
+      ++start;
+    while (start < static_cast<int64_t>(e)) {
+      int64_t end = start + 1;
+      while (end < num_queries && keys[end] == keys[start])
+        ++end;
+      const IdType row_id = keys[start];
+      const IdType row_start = indptr_data[row_id], row_end = indptr_data[row_id + 1];
+      if (csr.sorted) {
+        const IdType* it = indices_data + row_start;
+        const IdType* end_ptr = indices_data + row_end;
+        for (int64_t q = start; q < end; ++q) {
+          const IdType col_id = col_data[order[q] * col_stride];
+          it = std::lower_bound(it, end_ptr, col_id);
+          if (it != end_ptr && *it == col_id)
+            write(order[q], it - indices_data);
+        }
+      } else if (end - start >= kCSRGetDataSortRowMinQueries) {
+        sorted_row.resize(row_end - row_start);
+        for (IdType idx = row_start; idx < row_end; ++idx)
+          sorted_row[idx - row_start] = {indices_data[idx], idx};
+        std::stable_sort(sorted_row.begin(), sorted_row.end(),
+                         [](const ColumnPair& a, const ColumnPair& b) {
+                           return a.first < b.first;
+                         });
+        auto it = sorted_row.begin();
+        for (int64_t q = start; q < end; ++q) {
+          const IdType col_id = col_data[order[q] * col_stride];
+          it = std::lower_bound(it, sorted_row.end(), col_id,
+                                [](const ColumnPair& a, IdType col) { return a.first < col; });
+          if (it != sorted_row.end() && it->first == col_id)
+            write(order[q], it->second);
+        }
+      } else {
+        for (int64_t q = start; q < end; ++q) {
+          const IdType col_id = col_data[order[q] * col_stride];
+          for (IdType idx = row_start; idx < row_end; ++idx) {
+            if (indices_data[idx] == col_id) {
+              write(order[q], idx);
+              break;
+            }
+          }
+        }
+      }
+      start = end;
+    }
+  });
+}
+
 template <DLDeviceType XPU, typename IdType, typename DType>
 NDArray CSRGetData(
     CSRMatrix csr, NDArray rows, NDArray cols, bool return_eids, NDArray weights, DType filler) {
@@ -69,7 +169,14 @@ NDArray CSRGetData(
   //   consider sorting it especially when the number of (row, col) pairs is large.
   //   Need more benchmarks to justify the choice.
 
-  if (csr.sorted) {
+  if (retlen >= kCSRGetDataBatchMinQueries) {
+    CSRGetDataBatched<IdType>(
+        csr, row_data, col_data, row_stride, col_stride, retlen,
+        [&](int64_t p, IdType idx) {
+          const IdType eid = data ? data[idx] : idx;
+          ret_data[p] = return_eids ? eid : weight_data[eid];
+        });
+  } else if (csr.sorted) {
     // use binary search on each row
     parallel_for(0, retlen, [&](size_t b, size_t e) {
       for (auto p = b; p < e; ++p) {
@@ -0,0 +1,135 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file array/cpu/csr_khop.cc
+ * \brief CPU implementation of the k-hop expansion of groups of seeds
+ */
+#include <dgl/array.h>
+#include <dgl/runtime/parallel_for.h>
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+namespace dgl {
+namespace aten {
+namespace impl {
+
+using runtime::parallel_for;
+
+template <DLDeviceType XPU, typename IdType>
+std::vector<NDArray> CSRKHopExpand(
+    const std::vector<CSRMatrix>& adjs, NDArray seeds, NDArray seed_offsets,
+    int64_t num_hops) {
+  const auto& ctx = seeds->ctx;
+  const uint8_t nbits = seeds->dtype.bits;
+  const int64_t num_nodes = adjs[0].num_rows;
+  const int64_t num_groups = seed_offsets->shape[0] - 1;
+  const IdType* seeds_data = seeds.Ptr<IdType>();
+  const IdType* seed_offsets_data = seed_offsets.Ptr<IdType>();
+  CHECK(seed_offsets_data[0] == 0 && seed_offsets_data[num_groups] == seeds->shape[0])
+    << "The seed offsets must span the seeds.";
+  int64_t max_seeds = 0;
+  for (int64_t g = 0; g < num_groups; ++g) {
+    CHECK_LE(seed_offsets_data[g], seed_offsets_data[g + 1]) << "Invalid seed offsets.";
+    max_seeds = std::max<int64_t>(max_seeds, seed_offsets_data[g + 1] - seed_offsets_data[g]);
+  }
+
+  // the nodes of every group, and their distances from each seed of the group
+  std::vector<std::vector<IdType>> group_nodes(num_groups);
+  std::vector<std::vector<IdType>> group_dists(num_groups);
+  parallel_for(0, num_groups, 1, [&](size_t b, size_t e) {
+    for (size_t g = b; g < e; ++g) {
+      const IdType* group_seeds = seeds_data + seed_offsets_data[g];
+      const int64_t num_seeds = seed_offsets_data[g + 1] - seed_offsets_data[g];
+      std::vector<IdType>& nodes = group_nodes[g];
+      // the position of every node of the group
+      std::unordered_map<IdType, IdType> pos;
+      for (int64_t j = 0; j < num_seeds; ++j) {
+        CHECK(group_seeds[j] >= 0 && group_seeds[j] < num_nodes)
+          << "Invalid node ID " << group_seeds[j] << ".";
+        CHECK(pos.emplace(group_seeds[j], j).second)
+          << "The seeds of a group must be unique.";
+        nodes.push_back(group_seeds[j]);
+      }
+      size_t begin = 0;
+      for (int64_t hop = 0; hop < num_hops && begin < nodes.size(); ++hop) {
+        const size_t end = nodes.size();
+        for (size_t i = begin; i < end; ++i) {
+          for (const CSRMatrix& adj : adjs) {
+            const IdType* indptr = adj.indptr.Ptr<IdType>();
+            const IdType* indices = adj.indices.Ptr<IdType>();
+            for (IdType k = indptr[nodes[i]]; k < indptr[nodes[i] + 1]; ++k) {
+              if (pos.emplace(indices[k], nodes.size()).second)
+                nodes.push_back(indices[k]);
+            }
+          }
+        }
+        // the nodes of a hop by ID
+        std::sort(nodes.begin() + end, nodes.end());
+        for (size_t i = end; i < nodes.size(); ++i)
+          pos[nodes[i]] = i;
+        begin = end;
+      }
+
+      // BFS from every seed in the subgraph, not going through the other seeds
+      const int64_t num_group_nodes = nodes.size();
+      std::vector<IdType>& dists = group_dists[g];
+      dists.assign(num_group_nodes * max_seeds, -1);
+      std::vector<IdType> queue;
+      for (int64_t j = 0; j < num_seeds; ++j) {
+        queue.assign(1, j);
+        dists[j * max_seeds + j] = 0;
+        for (size_t q = 0; q < queue.size(); ++q) {
+          const IdType u = queue[q];
+          const IdType d = dists[u * max_seeds + j];
+          // the paths stop at the other seeds
+          if (u < num_seeds && u != j)
+            continue;
+          for (const CSRMatrix& adj : adjs) {
+            const IdType* indptr = adj.indptr.Ptr<IdType>();
+            const IdType* indices = adj.indices.Ptr<IdType>();
+            for (IdType k = indptr[nodes[u]]; k < indptr[nodes[u] + 1]; ++k) {
+              auto it = pos.find(indices[k]);
+              if (it == pos.end() || it->second < num_seeds)
+                continue;
+              IdType* dist = &dists[it->second * max_seeds + j];
+              if (*dist == -1) {
+                *dist = d + 1;
+                queue.push_back(it->second);
+              }
+            }
+          }
+        }
+      }
+    }
+  });
+
+  IdArray node_offsets = NewIdArray(num_groups + 1, ctx, nbits);
+  IdType* node_offsets_data = node_offsets.Ptr<IdType>();
+  node_offsets_data[0] = 0;
+  for (int64_t g = 0; g < num_groups; ++g)
+    node_offsets_data[g + 1] = node_offsets_data[g] + group_nodes[g].size();
+  const int64_t total = node_offsets_data[num_groups];
+  IdArray ret_nodes = NewIdArray(total, ctx, nbits);
+  NDArray ret_dists = NDArray::Empty({total, max_seeds}, seeds->dtype, ctx);
+  IdType* ret_nodes_data = ret_nodes.Ptr<IdType>();
+  IdType* ret_dists_data = ret_dists.Ptr<IdType>();
+  parallel_for(0, num_groups, [&](size_t b, size_t e) {
+    for (size_t g = b; g < e; ++g) {
+      std::copy(group_nodes[g].begin(), group_nodes[g].end(),
+                ret_nodes_data + node_offsets_data[g]);
+      std::copy(group_dists[g].begin(), group_dists[g].end(),
+                ret_dists_data + node_offsets_data[g] * max_seeds);
+    }
+  });
+  return {ret_nodes, node_offsets, ret_dists};
+}
+
+template std::vector<NDArray> CSRKHopExpand<kDLCPU, int32_t>(
+    const std::vector<CSRMatrix>&, NDArray, NDArray, int64_t);
+template std::vector<NDArray> CSRKHopExpand<kDLCPU, int64_t>(
+    const std::vector<CSRMatrix>&, NDArray, NDArray, int64_t);
+
+}  // namespace impl
+}  // namespace aten
+}  // namespace dgl
@@ -0,0 +1,96 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file array/cpu/csr_make_symmetric.cc
+ * \brief Symmetrize a CSR matrix
+ */
+#include <dgl/array.h>
+#include <dgl/runtime/parallel_for.h>
+#include <vector>
+#include "./csr_accumulator.h"
+#include "../array_op.h"
+
+namespace dgl {
+using runtime::parallel_for_weighted;
+namespace aten {
+namespace impl {
+
+namespace {
+
+/*!
+ * \brief Merge two sorted rows, dropping the duplicate columns, into out if
+ *        not null.
+ * \return The number of unique columns.
+ */
+template <typename IdType>
+int64_t MergeUniqueRows(const IdType* a, int64_t a_len, const IdType* b, int64_t b_len,
+                        IdType* out) {
+  int64_t i = 0, j = 0, n = 0;
+  while (i < a_len || j < b_len) {
+    IdType col;
+    if (j == b_len || (i < a_len && a[i] <= b[j]))
+      col = a[i];
+    else
+      col = b[j];
+    while (i < a_len && a[i] == col)
+      ++i;
+    while (j < b_len && b[j] == col)
+      ++j;
+    if (out)
+      out[n] = col;
+    ++n;
+  }
+  return n;
+}
+
+}  // namespace
+
+/*
+ * Every row of the result is the merge of the sorted rows of A and of its
+ * transpose, whose rows are sorted as the transpose keeps the entries of a
+ * column ordered by row. The rows are merged twice in parallel, balanced by
+ * their number of entries, first to count the unique columns and then to
+ * write them into the preallocated result, so no COO is built or sorted.
+ */
+template <DLDeviceType XPU, typename IdType>
+CSRMatrix CSRMakeSymmetric(CSRMatrix csr) {
+  CHECK_EQ(csr.num_rows, csr.num_cols) << "Only a square matrix can be symmetrized.";
+  const int64_t N = csr.num_rows;
+  if (!csr.sorted)
+    csr = CSRSort(csr);
+  const CSRMatrix csr_t = CSRTranspose<XPU, IdType>(csr);
+  const IdType* Ap = csr.indptr.Ptr<IdType>();
+  const IdType* Aj = csr.indices.Ptr<IdType>();
+  const IdType* Tp = csr_t.indptr.Ptr<IdType>();
+  const IdType* Tj = csr_t.indices.Ptr<IdType>();
+
+  std::vector<int64_t> cost(N + 1);
+  for (int64_t i = 0; i <= N; ++i)
+    cost[i] = Ap[i] + Tp[i];
+
+  IdArray ret_indptr = NDArray::Empty({N + 1}, csr.indptr->dtype, csr.indptr->ctx);
+  IdType* Bp = ret_indptr.Ptr<IdType>();
+  parallel_for_weighted(0, N, cost.data(), [&](size_t b, size_t e) {
+    for (auto i = b; i < e; ++i) {
+      Bp[i] = MergeUniqueRows<IdType>(
+          Aj + Ap[i], Ap[i + 1] - Ap[i], Tj + Tp[i], Tp[i + 1] - Tp[i], nullptr);
+    }
+  });
+  const int64_t nnz = cpu::PrefixSumInPlace(Bp, N);
+
+  IdArray ret_indices = NDArray::Empty({nnz}, csr.indices->dtype, csr.indices->ctx);
+  IdType* Bj = ret_indices.Ptr<IdType>();
+  parallel_for_weighted(0, N, cost.data(), [&](size_t b, size_t e) {
+    for (auto i = b; i < e; ++i) {
+      MergeUniqueRows<IdType>(
+          Aj + Ap[i], Ap[i + 1] - Ap[i], Tj + Tp[i], Tp[i + 1] - Tp[i], Bj + Bp[i]);
+    }
+  });
+  return CSRMatrix(N, N, ret_indptr, ret_indices, NullArray(csr.indptr->dtype), true);
+}
+
+template CSRMatrix CSRMakeSymmetric<kDLCPU, int32_t>(CSRMatrix);
+template CSRMatrix CSRMakeSymmetric<kDLCPU, int64_t>(CSRMatrix);
+
+}  // namespace impl
+}  // namespace aten
+}  // namespace dgl
@@ -0,0 +1,112 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file array/cpu/csr_masked_mm.cc
+ * \brief CSR Matrix Multiplication at the entries of a mask
+ */
+
+#include <dgl/array.h>
+#include <dgl/runtime/parallel_for.h>
+#include <algorithm>
+
+namespace dgl {
+
+using dgl::runtime::NDArray;
+using dgl::runtime::parallel_for;
+
+namespace aten {
+
+namespace {
+
+/*!
+ * \brief A row is searched into the other one instead of merged with it when
+ *        it is this many times shorter.
+ */
+constexpr int64_t kSearchRatio = 16;
+
+/*!
+ * \brief The dot product of two sparse rows with sorted columns, merging them,
+ *        or searching the shorter one into the longer one if they are of very
+ *        different lengths.
+ */
+template <typename IdType, typename DType>
+DType SparseRowDot(
+    const IdType* a_cols, const IdType* a_eids, const DType* a_data, IdType a_begin, IdType a_end,
+    const IdType* b_cols, const IdType* b_eids, const DType* b_data, IdType b_begin, IdType b_end) {
+  if ((a_end - a_begin) * kSearchRatio < b_end - b_begin) {
+    DType sum = 0;
+    const IdType* b_it = b_cols + b_begin;
+    for (IdType u = a_begin; u < a_end; ++u) {
+      b_it = std::lower_bound(b_it, b_cols + b_end, a_cols[u]);
+      if (b_it == b_cols + b_end)
+        break;
+      if (*b_it == a_cols[u]) {
+        const IdType v = b_it - b_cols;
+        sum += a_data[a_eids ? a_eids[u] : u] * b_data[b_eids ? b_eids[v] : v];
+      }
+    }
+    return sum;
+  }
+  if ((b_end - b_begin) * kSearchRatio < a_end - a_begin)
+    return SparseRowDot(b_cols, b_eids, b_data, b_begin, b_end,
+                        a_cols, a_eids, a_data, a_begin, a_end);
+  DType sum = 0;
+  IdType u = a_begin, v = b_begin;
+  while (u < a_end && v < b_end) {
+    if (a_cols[u] < b_cols[v]) {
+      ++u;
+    } else if (b_cols[v] < a_cols[u]) {
+      ++v;
+    } else {
+      sum += a_data[a_eids ? a_eids[u] : u] * b_data[b_eids ? b_eids[v] : v];
+      ++u;
+      ++v;
+    }
+  }
+  return sum;
+}
+
+};  // namespace
+
+template <int XPU, typename IdType, typename DType>
+NDArray CSRMaskedMM(
+    const CSRMatrix& A,
+    NDArray A_weights,
+    const CSRMatrix& B_t,
+    NDArray B_weights,
+    const COOMatrix& mask) {
+  const IdType* A_indptr = A.indptr.Ptr<IdType>();
+  const IdType* A_indices = A.indices.Ptr<IdType>();
+  const IdType* A_eids = CSRHasData(A) ? A.data.Ptr<IdType>() : nullptr;
+  const IdType* B_indptr = B_t.indptr.Ptr<IdType>();
+  const IdType* B_indices = B_t.indices.Ptr<IdType>();
+  const IdType* B_eids = CSRHasData(B_t) ? B_t.data.Ptr<IdType>() : nullptr;
+  const DType* A_data = A_weights.Ptr<DType>();
+  const DType* B_data = B_weights.Ptr<DType>();
+  const IdType* mask_rows = mask.row.Ptr<IdType>();
+  const IdType* mask_cols = mask.col.Ptr<IdType>();
+  const int64_t nnz = mask.row->shape[0];
+  NDArray C_weights = NDArray::Empty({nnz}, A_weights->dtype, A_weights->ctx);
+  DType* C_data = C_weights.Ptr<DType>();
+
+  parallel_for(0, nnz, [=](size_t b, size_t e) {
+    for (auto i = b; i < e; ++i) {
+      const IdType row = mask_rows[i], col = mask_cols[i];
+      C_data[i] = SparseRowDot<IdType, DType>(
+          A_indices, A_eids, A_data, A_indptr[row], A_indptr[row + 1],
+          B_indices, B_eids, B_data, B_indptr[col], B_indptr[col + 1]);
+    }
+  });
+  return C_weights;
+}
+
+template NDArray CSRMaskedMM<kDLCPU, int32_t, float>(
+    const CSRMatrix&, NDArray, const CSRMatrix&, NDArray, const COOMatrix&);
+template NDArray CSRMaskedMM<kDLCPU, int64_t, float>(
+    const CSRMatrix&, NDArray, const CSRMatrix&, NDArray, const COOMatrix&);
+template NDArray CSRMaskedMM<kDLCPU, int32_t, double>(
+    const CSRMatrix&, NDArray, const CSRMatrix&, NDArray, const COOMatrix&);
+template NDArray CSRMaskedMM<kDLCPU, int64_t, double>(
+    const CSRMatrix&, NDArray, const CSRMatrix&, NDArray, const COOMatrix&);
+
+};  // namespace aten
+};  // namespace dgl
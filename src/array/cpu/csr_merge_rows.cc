@@ -0,0 +1,74 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file array/cpu/csr_merge_rows.cc
+ * \brief CSR row-wise merge CPU implementation
+ */
+#include <dgl/array.h>
+#include <dgl/runtime/parallel_for.h>
+
+namespace dgl {
+namespace aten {
+namespace impl {
+
+using runtime::parallel_for;
+using runtime::parallel_for_weighted;
+
+template <DLDeviceType XPU, typename IdType>
+CSRMatrix CSRMergeRows(CSRMatrix a, CSRMatrix b) {
+  const int64_t N = a.num_rows;
+  const bool sorted = a.sorted && b.sorted;
+  const IdType* a_indptr = a.indptr.Ptr<IdType>();
+  const IdType* a_indices = a.indices.Ptr<IdType>();
+  const IdType* a_data = CSRHasData(a) ? a.data.Ptr<IdType>() : nullptr;
+  const IdType* b_indptr = b.indptr.Ptr<IdType>();
+  const IdType* b_indices = b.indices.Ptr<IdType>();
+  const IdType* b_data = CSRHasData(b) ? b.data.Ptr<IdType>() : nullptr;
+  const int64_t a_nnz = a_indptr[N];
+  const int64_t nnz = a_nnz + b_indptr[N];
+
+  IdArray ret_indptr = NewIdArray(N + 1, a.indptr->ctx, a.indptr->dtype.bits);
+  IdArray ret_indices = NewIdArray(nnz, a.indptr->ctx, a.indptr->dtype.bits);
+  IdArray ret_data = NewIdArray(nnz, a.indptr->ctx, a.indptr->dtype.bits);
+  IdType* ret_indptr_data = ret_indptr.Ptr<IdType>();
+  IdType* ret_indices_data = ret_indices.Ptr<IdType>();
+  IdType* ret_data_data = ret_data.Ptr<IdType>();
+
+  ret_indptr_data[0] = 0;
+  parallel_for(0, N, [&](int64_t s, int64_t e) {
+    for (int64_t i = s; i < e; ++i)
+      ret_indptr_data[i + 1] = a_indptr[i + 1] + b_indptr[i + 1];
+  });
+
+  // without data array, the entries of b are numbered after the ones of a
+  auto a_id = [&](IdType pos) -> IdType { return a_data ? a_data[pos] : pos; };
+  auto b_id = [&](IdType pos) -> IdType { return b_data ? b_data[pos] : a_nnz + pos; };
+
+  parallel_for_weighted(0, N, ret_indptr_data, [&](int64_t s, int64_t e) {
+    for (int64_t i = s; i < e; ++i) {
+      IdType pa = a_indptr[i], pb = b_indptr[i];
+      const IdType ea = a_indptr[i + 1], eb = b_indptr[i + 1];
+      IdType out = ret_indptr_data[i];
+      // the entries of a come first on equal columns, as the concatenation
+      while (pa < ea || pb < eb) {
+        const bool take_a = (pb == eb) ||
+          (pa < ea && (!sorted || a_indices[pa] <= b_indices[pb]));
+        if (take_a) {
+          ret_indices_data[out] = a_indices[pa];
+          ret_data_data[out++] = a_id(pa++);
+        } else {
+          ret_indices_data[out] = b_indices[pb];
+          ret_data_data[out++] = b_id(pb++);
+        }
+      }
+    }
+  });
+
+  return CSRMatrix(N, a.num_cols, ret_indptr, ret_indices, ret_data, sorted);
+}
+
+template CSRMatrix CSRMergeRows<kDLCPU, int32_t>(CSRMatrix, CSRMatrix);
+template CSRMatrix CSRMergeRows<kDLCPU, int64_t>(CSRMatrix, CSRMatrix);
+
+}  // namespace impl
+}  // namespace aten
+}  // namespace dgl
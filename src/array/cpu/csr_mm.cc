@@ -6,54 +6,70 @@
 
 #include <dgl/array.h>
 #include <dgl/runtime/parallel_for.h>
-#include <parallel_hashmap/phmap.h>
+#include <algorithm>
 #include <vector>
 #include "array_utils.h"
+#include "csr_accumulator.h"
 
 namespace dgl {
 
 using dgl::runtime::NDArray;
 using dgl::runtime::parallel_for;
+using dgl::runtime::parallel_for_weighted;
 
 namespace aten {
 
 namespace {
 
-// TODO(BarclayII): avoid using map for sorted CSRs
+/*!
+ * \brief The exclusive prefix sum of the number of products of every row of
+ *        A x B, followed by the total, to estimate and balance their cost.
+ */
+template <typename IdType>
+std::vector<int64_t> CountProductsPerRow(
+    const IdType* A_indptr,
+    const IdType* A_indices,
+    const IdType* B_indptr,
+    int64_t M) {
+  std::vector<int64_t> products(M + 1);
+  parallel_for(0, M, [&](size_t b, size_t e) {
+    for (auto i = b; i < e; ++i) {
+      int64_t count = 0;
+      for (IdType u = A_indptr[i]; u < A_indptr[i + 1]; ++u)
+        count += B_indptr[A_indices[u] + 1] - B_indptr[A_indices[u]];
+      products[i] = count;
+    }
+  });
+  cpu::PrefixSumInPlace(products.data(), M);
+  return products;
+}
+
 template <typename IdType>
 void CountNNZPerRow(
     const IdType* A_indptr,
     const IdType* A_indices,
     const IdType* B_indptr,
     const IdType* B_indices,
+    const std::vector<int64_t>& products,
     IdType* C_indptr_data,
-    int64_t M) {
-  parallel_for(0, M, [=](size_t b, size_t e) {
+    int64_t M,
+    int64_t P,
+    int64_t topk) {
+  parallel_for_weighted(0, M, products.data(), [&](size_t b, size_t e) {
+    cpu::RowAccumulator<IdType, int8_t> acc(P);
     for (auto i = b; i < e; ++i) {
-      phmap::flat_hash_set<IdType> set;
+      acc.Begin(products[i + 1] - products[i]);
       for (IdType u = A_indptr[i]; u < A_indptr[i + 1]; ++u) {
         IdType w = A_indices[u];
         for (IdType v = B_indptr[w]; v < B_indptr[w + 1]; ++v)
-          set.insert(B_indices[v]);
+          acc.AddColumn(B_indices[v]);
       }
-      C_indptr_data[i] = set.size();
+      const int64_t nnz = acc.CountColumns();
+      C_indptr_data[i] = topk >= 0 ? std::min(nnz, topk) : nnz;
     }
   });
 }
 
-template <typename IdType>
-int64_t ComputeIndptrInPlace(IdType* C_indptr_data, int64_t M) {
-  int64_t nnz = 0;
-  IdType len = 0;
-  for (IdType i = 0; i < M; ++i) {
-    len = C_indptr_data[i];
-    C_indptr_data[i] = nnz;
-    nnz += len;
-  }
-  C_indptr_data[M] = nnz;
-  return nnz;
-}
-
 template <typename IdType, typename DType>
 void ComputeIndicesAndData(
     const IdType* A_indptr,
@@ -64,41 +80,43 @@ void ComputeIndicesAndData(
     const IdType* B_indices,
     const IdType* B_eids,
     const DType* B_data,
+    const std::vector<int64_t>& products,
     const IdType* C_indptr_data,
     IdType* C_indices_data,
     DType* C_weights_data,
-    int64_t M) {
-  parallel_for(0, M, [=](size_t b, size_t e) {
+    int64_t M,
+    int64_t P,
+    int64_t topk) {
+  parallel_for_weighted(0, M, products.data(), [&](size_t b, size_t e) {
+    cpu::RowAccumulator<IdType, DType> acc(P);
     for (auto i = b; i < e; ++i) {
-      phmap::flat_hash_map<IdType, DType> map;
+      acc.Begin(products[i + 1] - products[i]);
       for (IdType u = A_indptr[i]; u < A_indptr[i + 1]; ++u) {
         IdType w = A_indices[u];
         DType vA = A_data[A_eids ? A_eids[u] : u];
-        for (IdType v = B_indptr[w]; v < B_indptr[w + 1]; ++v) {
-          IdType t = B_indices[v];
-          DType vB = B_data[B_eids ? B_eids[v] : v];
-          map[t] += vA * vB;
-        }
-      }
-
-      IdType v = C_indptr_data[i];
-      for (auto it : map) {
-        C_indices_data[v] = it.first;
-        C_weights_data[v] = it.second;
-        ++v;
+        for (IdType v = B_indptr[w]; v < B_indptr[w + 1]; ++v)
+          acc.Add(B_indices[v], vA * B_data[B_eids ? B_eids[v] : v]);
       }
+      acc.Finish();
+      if (topk >= 0)
+        acc.KeepTopK(topk);
+      std::copy(acc.cols().begin(), acc.cols().end(), C_indices_data + C_indptr_data[i]);
+      std::copy(acc.vals().begin(), acc.vals().end(), C_weights_data + C_indptr_data[i]);
     }
   });
 }
 
-};  // namespace
-
-template <int XPU, typename IdType, typename DType>
-std::pair<CSRMatrix, NDArray> CSRMM(
+/*!
+ * \brief Gustavson's row-wise product, keeping the topk largest entries of every
+ *        row if topk is not negative.
+ */
+template <typename IdType, typename DType>
+std::pair<CSRMatrix, NDArray> CSRMMImpl(
     const CSRMatrix& A,
     NDArray A_weights,
     const CSRMatrix& B,
-    NDArray B_weights) {
+    NDArray B_weights,
+    int64_t topk) {
   CHECK_EQ(A.num_cols, B.num_rows) << "A's number of columns must equal to B's number of rows";
   const bool A_has_eid = !IsNullArray(A.data);
   const bool B_has_eid = !IsNullArray(B.data);
@@ -116,8 +134,11 @@ std::pair<CSRMatrix, NDArray> CSRMM(
   IdArray C_indptr = IdArray::Empty({M + 1}, A.indptr->dtype, A.indptr->ctx);
   IdType* C_indptr_data = C_indptr.Ptr<IdType>();
 
-  CountNNZPerRow<IdType>(A_indptr, A_indices, B_indptr, B_indices, C_indptr_data, M);
-  int64_t nnz = ComputeIndptrInPlace<IdType>(C_indptr_data, M);
+  const std::vector<int64_t> products = CountProductsPerRow<IdType>(
+      A_indptr, A_indices, B_indptr, M);
+  CountNNZPerRow<IdType>(
+      A_indptr, A_indices, B_indptr, B_indices, products, C_indptr_data, M, P, topk);
+  int64_t nnz = cpu::PrefixSumInPlace<IdType>(C_indptr_data, M);
   // Allocate indices and weights array
   IdArray C_indices = IdArray::Empty({nnz}, A.indices->dtype, A.indices->ctx);
   NDArray C_weights = NDArray::Empty({nnz}, A_weights->dtype, A_weights->ctx);
@@ -127,13 +148,73 @@ std::pair<CSRMatrix, NDArray> CSRMM(
   ComputeIndicesAndData<IdType, DType>(
       A_indptr, A_indices, A_eids, A_data,
       B_indptr, B_indices, B_eids, B_data,
-      C_indptr_data, C_indices_data, C_weights_data, M);
+      products, C_indptr_data, C_indices_data, C_weights_data, M, P, topk);
 
   return {
-      CSRMatrix(M, P, C_indptr, C_indices, NullArray(C_indptr->dtype, C_indptr->ctx)),
+      CSRMatrix(M, P, C_indptr, C_indices, NullArray(C_indptr->dtype, C_indptr->ctx), true),
       C_weights};
 }
 
+};  // namespace
+
+template <int XPU, typename IdType, typename DType>
+std::pair<CSRMatrix, NDArray> CSRMM(
+    const CSRMatrix& A,
+    NDArray A_weights,
+    const CSRMatrix& B,
+    NDArray B_weights) {
+  return CSRMMImpl<IdType, DType>(A, A_weights, B, B_weights, -1);
+}
+
+template <int XPU, typename IdType, typename DType>
+std::pair<CSRMatrix, NDArray> CSRMMTopK(
+    const CSRMatrix& A,
+    NDArray A_weights,
+    const CSRMatrix& B,
+    NDArray B_weights,
+    int64_t k) {
+  CHECK_GE(k, 0) << "The number of entries to keep in every row must be non-negative.";
+  return CSRMMImpl<IdType, DType>(A, A_weights, B, B_weights, k);
+}
+
+template <int XPU, typename IdType, typename DType>
+NDArray CSRMMNumeric(
+    const CSRMatrix& A,
+    NDArray A_weights,
+    const CSRMatrix& B,
+    NDArray B_weights,
+    const CSRMatrix& C) {
+  const IdType* A_indptr = A.indptr.Ptr<IdType>();
+  const IdType* A_indices = A.indices.Ptr<IdType>();
+  const IdType* A_eids = CSRHasData(A) ? A.data.Ptr<IdType>() : nullptr;
+  const IdType* B_indptr = B.indptr.Ptr<IdType>();
+  const IdType* B_indices = B.indices.Ptr<IdType>();
+  const IdType* B_eids = CSRHasData(B) ? B.data.Ptr<IdType>() : nullptr;
+  const DType* A_data = A_weights.Ptr<DType>();
+  const DType* B_data = B_weights.Ptr<DType>();
+  const IdType* C_indptr = C.indptr.Ptr<IdType>();
+  const IdType* C_indices = C.indices.Ptr<IdType>();
+  NDArray C_weights = NDArray::Empty({C.indices->shape[0]}, A_weights->dtype, A_weights->ctx);
+  DType* C_data = C_weights.Ptr<DType>();
+
+  parallel_for(0, A.num_rows, [=](size_t b, size_t e) {
+    for (auto i = b; i < e; ++i) {
+      const IdType* row_begin = C_indices + C_indptr[i];
+      const IdType* row_end = C_indices + C_indptr[i + 1];
+      std::fill(C_data + C_indptr[i], C_data + C_indptr[i + 1], 0);
+      for (IdType u = A_indptr[i]; u < A_indptr[i + 1]; ++u) {
+        IdType w = A_indices[u];
+        DType vA = A_data[A_eids ? A_eids[u] : u];
+        for (IdType v = B_indptr[w]; v < B_indptr[w + 1]; ++v) {
+          const IdType pos = std::lower_bound(row_begin, row_end, B_indices[v]) - C_indices;
+          C_data[pos] += vA * B_data[B_eids ? B_eids[v] : v];
+        }
+      }
+    }
+  });
+  return C_weights;
+}
+
 template std::pair<CSRMatrix, NDArray> CSRMM<kDLCPU, int32_t, float>(
     const CSRMatrix&, NDArray, const CSRMatrix&, NDArray);
 template std::pair<CSRMatrix, NDArray> CSRMM<kDLCPU, int64_t, float>(
@@ -143,5 +224,23 @@ template std::pair<CSRMatrix, NDArray> CSRMM<kDLCPU, int32_t, double>(
 template std::pair<CSRMatrix, NDArray> CSRMM<kDLCPU, int64_t, double>(
     const CSRMatrix&, NDArray, const CSRMatrix&, NDArray);
 
+template std::pair<CSRMatrix, NDArray> CSRMMTopK<kDLCPU, int32_t, float>(
+    const CSRMatrix&, NDArray, const CSRMatrix&, NDArray, int64_t);
+template std::pair<CSRMatrix, NDArray> CSRMMTopK<kDLCPU, int64_t, float>(
+    const CSRMatrix&, NDArray, const CSRMatrix&, NDArray, int64_t);
+template std::pair<CSRMatrix, NDArray> CSRMMTopK<kDLCPU, int32_t, double>(
+    const CSRMatrix&, NDArray, const CSRMatrix&, NDArray, int64_t);
+template std::pair<CSRMatrix, NDArray> CSRMMTopK<kDLCPU, int64_t, double>(
+    const CSRMatrix&, NDArray, const CSRMatrix&, NDArray, int64_t);
+
+template NDArray CSRMMNumeric<kDLCPU, int32_t, float>(
+    const CSRMatrix&, NDArray, const CSRMatrix&, NDArray, const CSRMatrix&);
+template NDArray CSRMMNumeric<kDLCPU, int64_t, float>(
+    const CSRMatrix&, NDArray, const CSRMatrix&, NDArray, const CSRMatrix&);
+template NDArray CSRMMNumeric<kDLCPU, int32_t, double>(
+    const CSRMatrix&, NDArray, const CSRMatrix&, NDArray, const CSRMatrix&);
+template NDArray CSRMMNumeric<kDLCPU, int64_t, double>(
+    const CSRMatrix&, NDArray, const CSRMatrix&, NDArray, const CSRMatrix&);
+
 };  // namespace aten
 };  // namespace dgl
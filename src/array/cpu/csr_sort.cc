@@ -7,7 +7,9 @@
 #include <dgl/runtime/parallel_for.h>
 #include <numeric>
 #include <algorithm>
+#include <type_traits>
 #include <vector>
+#include "./radix_sort.h"
 
 namespace dgl {
 namespace aten {
@@ -41,6 +43,7 @@ template bool CSRIsSorted<kDLCPU, int32_t>(CSRMatrix csr);
 template <DLDeviceType XPU, typename IdType>
 void CSRSort_(CSRMatrix* csr) {
   typedef std::pair<IdType, IdType> ShufflePair;
+  typedef typename std::make_unsigned<IdType>::type KeyType;
   const int64_t num_rows = csr->num_rows;
   const int64_t nnz = csr->indices->shape[0];
   const IdType* indptr_data = static_cast<IdType*>(csr->indptr->data);
@@ -53,6 +56,8 @@ void CSRSort_(CSRMatrix* csr) {
   runtime::parallel_for(0, num_rows, [=](size_t b, size_t e) {
     for (auto row = b; row < e; ++row) {
       const int64_t num_cols = indptr_data[row + 1] - indptr_data[row];
+      if (num_cols >= kRadixSortMinSize)
+        continue;
       std::vector<ShufflePair> reorder_vec(num_cols);
       IdType *col = indices_data + indptr_data[row];
       IdType *eid = eid_data + indptr_data[row];
@@ -72,6 +77,16 @@ void CSRSort_(CSRMatrix* csr) {
     }
   });
 
+  // the long rows are sorted one at a time, each with all the threads
+  const int col_bits = RadixSortNumBits(csr->num_cols - 1);
+  for (int64_t row = 0; row < num_rows; ++row) {
+    const int64_t num_cols = indptr_data[row + 1] - indptr_data[row];
+    if (num_cols < kRadixSortMinSize)
+      continue;
+    KeyType* col = reinterpret_cast<KeyType*>(indices_data + indptr_data[row]);
+    RadixSortPairs(col, eid_data + indptr_data[row], num_cols, col_bits);
+  }
+
   csr->sorted = true;
 }
 
@@ -6,9 +6,10 @@
 
 #include <dgl/array.h>
 #include <dgl/runtime/parallel_for.h>
-#include <parallel_hashmap/phmap.h>
+#include <algorithm>
 #include <vector>
 #include "array_utils.h"
+#include "csr_accumulator.h"
 
 namespace dgl {
 
@@ -18,67 +19,75 @@ namespace aten {
 
 namespace {
 
-// TODO(BarclayII): avoid using map for sorted CSRs
+/*!
+ * \brief The exclusive prefix sum of the number of entries of every row of the
+ *        matrices, followed by the total, to estimate and balance their cost.
+ */
+template <typename IdType>
+std::vector<int64_t> CountEntriesPerRow(
+    const std::vector<const IdType*>& A_indptr,
+    int64_t M) {
+  int64_t n = A_indptr.size();
+  std::vector<int64_t> entries(M + 1);
+  runtime::parallel_for(0, M, [&](size_t b, size_t e) {
+    for (size_t i = b; i < e; ++i) {
+      int64_t count = 0;
+      for (int64_t k = 0; k < n; ++k)
+        count += A_indptr[k][i + 1] - A_indptr[k][i];
+      entries[i] = count;
+    }
+  });
+  cpu::PrefixSumInPlace(entries.data(), M);
+  return entries;
+}
+
 template <typename IdType>
 void CountNNZPerRow(
     const std::vector<const IdType*>& A_indptr,
     const std::vector<const IdType*>& A_indices,
+    const std::vector<int64_t>& entries,
     IdType* C_indptr_data,
-    int64_t M) {
+    int64_t M,
+    int64_t N) {
   int64_t n = A_indptr.size();
 
-  runtime::parallel_for(0, M, [=](size_t b, size_t e) {
+  runtime::parallel_for_weighted(0, M, entries.data(), [&](size_t b, size_t e) {
+    cpu::RowAccumulator<IdType, int8_t> acc(N);
     for (size_t i = b; i < e; ++i) {
-      phmap::flat_hash_set<IdType> set;
+      acc.Begin(entries[i + 1] - entries[i]);
       for (int64_t k = 0; k < n; ++k) {
         for (IdType u = A_indptr[k][i]; u < A_indptr[k][i + 1]; ++u)
-          set.insert(A_indices[k][u]);
+          acc.AddColumn(A_indices[k][u]);
       }
-      C_indptr_data[i] = set.size();
+      C_indptr_data[i] = acc.CountColumns();
     }
   });
 }
 
-template <typename IdType>
-int64_t ComputeIndptrInPlace(IdType* C_indptr_data, int64_t M) {
-  int64_t nnz = 0;
-  IdType len = 0;
-  for (IdType i = 0; i < M; ++i) {
-    len = C_indptr_data[i];
-    C_indptr_data[i] = nnz;
-    nnz += len;
-  }
-  C_indptr_data[M] = nnz;
-  return nnz;
-}
-
 template <typename IdType, typename DType>
 void ComputeIndicesAndData(
     const std::vector<const IdType*>& A_indptr,
     const std::vector<const IdType*>& A_indices,
     const std::vector<const IdType*>& A_eids,
     const std::vector<const DType*>& A_data,
+    const std::vector<int64_t>& entries,
     const IdType* C_indptr_data,
     IdType* C_indices_data,
     DType* C_weights_data,
-    int64_t M) {
+    int64_t M,
+    int64_t N) {
   int64_t n = A_indptr.size();
-  runtime::parallel_for(0, M, [=](size_t b, size_t e) {
+  runtime::parallel_for_weighted(0, M, entries.data(), [&](size_t b, size_t e) {
+    cpu::RowAccumulator<IdType, DType> acc(N);
     for (auto i = b; i < e; ++i) {
-      phmap::flat_hash_map<IdType, DType> map;
+      acc.Begin(entries[i + 1] - entries[i]);
       for (int64_t k = 0; k < n; ++k) {
-        for (IdType u = A_indptr[k][i]; u < A_indptr[k][i + 1]; ++u) {
-          IdType kA = A_indices[k][u];
-          DType vA = A_data[k][A_eids[k] ? A_eids[k][u] : u];
-          map[kA] += vA;
-        }
-      }
-      IdType j = C_indptr_data[i];
-      for (auto it : map) {
-        C_indices_data[j] = it.first;
-        C_weights_data[j] = it.second;
-        ++j;
+        for (IdType u = A_indptr[k][i]; u < A_indptr[k][i + 1]; ++u)
+          acc.Add(A_indices[k][u], A_data[k][A_eids[k] ? A_eids[k][u] : u]);
       }
+      acc.Finish();
+      std::copy(acc.cols().begin(), acc.cols().end(), C_indices_data + C_indptr_data[i]);
+      std::copy(acc.vals().begin(), acc.vals().end(), C_weights_data + C_indptr_data[i]);
     }
   });
 }
@@ -114,8 +123,9 @@ std::pair<CSRMatrix, NDArray> CSRSum(
   IdArray C_indptr = IdArray::Empty({M + 1}, A[0].indptr->dtype, A[0].indptr->ctx);
   IdType* C_indptr_data = C_indptr.Ptr<IdType>();
 
-  CountNNZPerRow<IdType>(A_indptr, A_indices, C_indptr_data, M);
-  IdType nnz = ComputeIndptrInPlace<IdType>(C_indptr_data, M);
+  const std::vector<int64_t> entries = CountEntriesPerRow<IdType>(A_indptr, M);
+  CountNNZPerRow<IdType>(A_indptr, A_indices, entries, C_indptr_data, M, N);
+  int64_t nnz = cpu::PrefixSumInPlace<IdType>(C_indptr_data, M);
   // Allocate indices and weights array
   IdArray C_indices = IdArray::Empty({nnz}, A[0].indices->dtype, A[0].indices->ctx);
   NDArray C_weights = NDArray::Empty({nnz}, A_weights[0]->dtype, A_weights[0]->ctx);
@@ -123,13 +133,51 @@ std::pair<CSRMatrix, NDArray> CSRSum(
   DType* C_weights_data = C_weights.Ptr<DType>();
   ComputeIndicesAndData<IdType, DType>(
       A_indptr, A_indices, A_eids, A_data,
-      C_indptr_data, C_indices_data, C_weights_data, M);
+      entries, C_indptr_data, C_indices_data, C_weights_data, M, N);
 
   return {
-      CSRMatrix(M, N, C_indptr, C_indices, NullArray(C_indptr->dtype, C_indptr->ctx)),
+      CSRMatrix(M, N, C_indptr, C_indices, NullArray(C_indptr->dtype, C_indptr->ctx), true),
       C_weights};
 }
 
+template <int XPU, typename IdType, typename DType>
+NDArray CSRSumNumeric(
+    const std::vector<CSRMatrix>& A,
+    const std::vector<NDArray>& A_weights,
+    const CSRMatrix& C) {
+  const int64_t n = A.size();
+  std::vector<const IdType*> A_indptr(n);
+  std::vector<const IdType*> A_indices(n);
+  std::vector<const IdType*> A_eids(n);
+  std::vector<const DType*> A_data(n);
+  for (int64_t k = 0; k < n; ++k) {
+    A_indptr[k] = A[k].indptr.Ptr<IdType>();
+    A_indices[k] = A[k].indices.Ptr<IdType>();
+    A_eids[k] = CSRHasData(A[k]) ? A[k].data.Ptr<IdType>() : nullptr;
+    A_data[k] = A_weights[k].Ptr<DType>();
+  }
+  const IdType* C_indptr = C.indptr.Ptr<IdType>();
+  const IdType* C_indices = C.indices.Ptr<IdType>();
+  NDArray C_weights = NDArray::Empty(
+      {C.indices->shape[0]}, A_weights[0]->dtype, A_weights[0]->ctx);
+  DType* C_data = C_weights.Ptr<DType>();
+
+  runtime::parallel_for(0, C.num_rows, [&](size_t b, size_t e) {
+    for (size_t i = b; i < e; ++i) {
+      const IdType* row_begin = C_indices + C_indptr[i];
+      const IdType* row_end = C_indices + C_indptr[i + 1];
+      std::fill(C_data + C_indptr[i], C_data + C_indptr[i + 1], 0);
+      for (int64_t k = 0; k < n; ++k) {
+        for (IdType u = A_indptr[k][i]; u < A_indptr[k][i + 1]; ++u) {
+          const IdType pos = std::lower_bound(row_begin, row_end, A_indices[k][u]) - C_indices;
+          C_data[pos] += A_data[k][A_eids[k] ? A_eids[k][u] : u];
+        }
+      }
+    }
+  });
+  return C_weights;
+}
+
 template std::pair<CSRMatrix, NDArray> CSRSum<kDLCPU, int32_t, float>(
     const std::vector<CSRMatrix>&, const std::vector<NDArray>&);
 template std::pair<CSRMatrix, NDArray> CSRSum<kDLCPU, int64_t, float>(
@@ -139,5 +187,14 @@ template std::pair<CSRMatrix, NDArray> CSRSum<kDLCPU, int32_t, double>(
 template std::pair<CSRMatrix, NDArray> CSRSum<kDLCPU, int64_t, double>(
     const std::vector<CSRMatrix>&, const std::vector<NDArray>&);
 
+template NDArray CSRSumNumeric<kDLCPU, int32_t, float>(
+    const std::vector<CSRMatrix>&, const std::vector<NDArray>&, const CSRMatrix&);
+template NDArray CSRSumNumeric<kDLCPU, int64_t, float>(
+    const std::vector<CSRMatrix>&, const std::vector<NDArray>&, const CSRMatrix&);
+template NDArray CSRSumNumeric<kDLCPU, int32_t, double>(
+    const std::vector<CSRMatrix>&, const std::vector<NDArray>&, const CSRMatrix&);
+template NDArray CSRSumNumeric<kDLCPU, int64_t, double>(
+    const std::vector<CSRMatrix>&, const std::vector<NDArray>&, const CSRMatrix&);
+
 };  // namespace aten
 };  // namespace dgl
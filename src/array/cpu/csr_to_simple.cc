@@ -4,66 +4,118 @@
  * \brief CSR sorting
  */
 #include <dgl/array.h>
+#include <dgl/runtime/parallel_for.h>
 #include <numeric>
 #include <algorithm>
 #include <vector>
 
 namespace dgl {
+using runtime::parallel_for_weighted;
 namespace aten {
 namespace impl {
 
+namespace {
+
+// The rows up to this degree are sorted by insertion.
+constexpr int64_t kSmallRowDegree = 16;
+
+}  // namespace
+
+/*
+ * The rows are deduplicated independently, balanced over the threads by
+ * degree. A row is sorted in a permutation of its entries, unless the matrix is
+ * sorted, so that no sorted copy of the matrix is made: the unique columns and
+ * their counts are written at the offset of the row in the input, and then
+ * packed once the new offsets are known.
+ */
 template <DLDeviceType XPU, typename IdType>
 std::tuple<CSRMatrix, IdArray, IdArray> CSRToSimple(CSRMatrix csr) {
-  if (!csr.sorted)
-    csr = CSRSort(csr);
-
+  const int64_t num_rows = csr.num_rows;
+  const int64_t nnz = csr.indices->shape[0];
+  const auto &ctx = csr.indptr->ctx;
+  const uint8_t nbits = sizeof(IdType) * 8;
   const IdType *indptr_data = static_cast<IdType*>(csr.indptr->data);
   const IdType *indices_data = static_cast<IdType*>(csr.indices->data);
+  const IdType *eid_data = CSRHasData(csr) ? static_cast<IdType*>(csr.data->data) : nullptr;
 
-  std::vector<IdType> indptr;
-  std::vector<IdType> indices;
-  std::vector<IdType> count;
-  indptr.resize(csr.indptr->shape[0]);
-  indptr[0] = 0;
+  IdArray ret_indptr = NewIdArray(num_rows + 1, ctx, nbits);
+  IdArray row_indices = NewIdArray(nnz, ctx, nbits);
+  IdArray row_count = NewIdArray(nnz, ctx, nbits);
+  // the rank of every edge among the unique columns of its row, then its new id
+  IdArray eids_remapped = NewIdArray(nnz, ctx, nbits);
+  IdType *ret_indptr_data = static_cast<IdType*>(ret_indptr->data);
+  IdType *row_indices_data = static_cast<IdType*>(row_indices->data);
+  IdType *row_count_data = static_cast<IdType*>(row_count->data);
+  IdType *eids_remapped_data = static_cast<IdType*>(eids_remapped->data);
 
-  for (int64_t i = 1; i < csr.indptr->shape[0]; ++i) {
-    if (indptr_data[i-1] == indptr_data[i]) {
-      indptr[i] = indptr[i-1];
-      continue;
-    }
+  parallel_for_weighted(0, num_rows, indptr_data, [&](size_t b, size_t e) {
+    std::vector<IdType> order;
+    for (size_t row = b; row < e; ++row) {
+      const IdType off = indptr_data[row];
+      const int64_t deg = indptr_data[row + 1] - off;
+      const IdType *cols = indices_data + off;
+      order.resize(deg);
+      std::iota(order.begin(), order.end(), 0);
+      if (!csr.sorted) {
+        auto less = [cols] (IdType x, IdType y) { return cols[x] < cols[y]; };
+        if (deg <= kSmallRowDegree) {
+          for (int64_t i = 1; i < deg; ++i) {
+            const IdType x = order[i];
+            int64_t j = i;
+            for (; j > 0 && less(x, order[j - 1]); --j)
+              order[j] = order[j - 1];
+            order[j] = x;
+          }
+        } else {
+          std::sort(order.begin(), order.end(), less);
+        }
+      }
 
-    int64_t cnt = 1;
-    int64_t dup_cnt = 1;
-    indices.push_back(indices_data[indptr_data[i-1]]);
-    for (int64_t j = indptr_data[i-1]+1; j < indptr_data[i]; ++j) {
-      if (indices_data[j-1] == indices_data[j]) {
-        ++dup_cnt;
-        continue;
+      IdType num_unique = 0;
+      for (int64_t i = 0; i < deg; ++i) {
+        const IdType pos = off + order[i];
+        if (i == 0 || indices_data[pos] != row_indices_data[off + num_unique - 1]) {
+          row_indices_data[off + num_unique] = indices_data[pos];
+          row_count_data[off + num_unique] = 0;
+          ++num_unique;
+        }
+        ++row_count_data[off + num_unique - 1];
+        eids_remapped_data[eid_data ? eid_data[pos] : pos] = num_unique - 1;
       }
-      count.push_back(dup_cnt);
-      dup_cnt = 1;
-      indices.push_back(indices_data[j]);
-      ++cnt;
+      ret_indptr_data[row + 1] = num_unique;
     }
-    count.push_back(dup_cnt);
-    indptr[i] = indptr[i-1] + cnt;
-  }
+  });
+
+  ret_indptr_data[0] = 0;
+  std::partial_sum(ret_indptr_data, ret_indptr_data + num_rows + 1, ret_indptr_data);
+  const int64_t num_unique = ret_indptr_data[num_rows];
+  IdArray ret_indices = NewIdArray(num_unique, ctx, nbits);
+  IdArray edge_count = NewIdArray(num_unique, ctx, nbits);
+  IdType *ret_indices_data = static_cast<IdType*>(ret_indices->data);
+  IdType *edge_count_data = static_cast<IdType*>(edge_count->data);
+
+  parallel_for_weighted(0, num_rows, indptr_data, [&](size_t b, size_t e) {
+    for (size_t row = b; row < e; ++row) {
+      const IdType off = indptr_data[row];
+      const IdType new_off = ret_indptr_data[row];
+      const IdType row_num_unique = ret_indptr_data[row + 1] - new_off;
+      std::copy(row_indices_data + off, row_indices_data + off + row_num_unique,
+                ret_indices_data + new_off);
+      std::copy(row_count_data + off, row_count_data + off + row_num_unique,
+                edge_count_data + new_off);
+      for (IdType pos = off; pos < indptr_data[row + 1]; ++pos)
+        eids_remapped_data[eid_data ? eid_data[pos] : pos] += new_off;
+    }
+  });
 
   CSRMatrix res_csr = CSRMatrix(
     csr.num_rows,
     csr.num_cols,
-    IdArray::FromVector(indptr),
-    IdArray::FromVector(indices),
+    ret_indptr,
+    ret_indices,
     NullArray(),
     true);
 
-  const IdArray &edge_count = IdArray::FromVector(count);
-  const IdArray new_eids = Range(
-      0, res_csr.indices->shape[0], sizeof(IdType) * 8, csr.indptr->ctx);
-  const IdArray eids_remapped = CSRHasData(csr) ?
-    Scatter(Repeat(new_eids, edge_count), csr.data) :
-    Repeat(new_eids, edge_count);
-
   return std::make_tuple(res_csr, edge_count, eids_remapped);
 }
 
@@ -0,0 +1,57 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file array/cpu/edge_softmax.cc
+ * \brief Edge softmax C APIs and definitions.
+ */
+#include "./edge_softmax.h"
+#include <dgl/array.h>
+#include "./spmm_binary_ops.h"
+
+namespace dgl {
+namespace aten {
+
+/*! \brief Edge softmax forward on Csr format. */
+template <int XPU, typename IdType, int bits>
+void EdgeSoftmaxForwardCsr(const CSRMatrix& csc, NDArray score, NDArray out) {
+  SWITCH_BITS(bits, DType, {
+    cpu::EdgeSoftmaxForwardCsr<IdType, DType>(csc, score, out);
+  });
+}
+
+/*! \brief Edge softmax backward on Csr format. */
+template <int XPU, typename IdType, int bits>
+void EdgeSoftmaxBackwardCsr(const CSRMatrix& csc, NDArray out,
+                            NDArray grad_out, NDArray grad_score) {
+  SWITCH_BITS(bits, DType, {
+    cpu::EdgeSoftmaxBackwardCsr<IdType, DType>(csc, out, grad_out, grad_score);
+  });
+}
+
+template void EdgeSoftmaxForwardCsr<kDLCPU, int32_t, 16>(
+    const CSRMatrix& csc, NDArray score, NDArray out);
+template void EdgeSoftmaxForwardCsr<kDLCPU, int64_t, 16>(
+    const CSRMatrix& csc, NDArray score, NDArray out);
+template void EdgeSoftmaxForwardCsr<kDLCPU, int32_t, 32>(
+    const CSRMatrix& csc, NDArray score, NDArray out);
+template void EdgeSoftmaxForwardCsr<kDLCPU, int64_t, 32>(
+    const CSRMatrix& csc, NDArray score, NDArray out);
+template void EdgeSoftmaxForwardCsr<kDLCPU, int32_t, 64>(
+    const CSRMatrix& csc, NDArray score, NDArray out);
+template void EdgeSoftmaxForwardCsr<kDLCPU, int64_t, 64>(
+    const CSRMatrix& csc, NDArray score, NDArray out);
+
+template void EdgeSoftmaxBackwardCsr<kDLCPU, int32_t, 16>(
+    const CSRMatrix& csc, NDArray out, NDArray grad_out, NDArray grad_score);
+template void EdgeSoftmaxBackwardCsr<kDLCPU, int64_t, 16>(
+    const CSRMatrix& csc, NDArray out, NDArray grad_out, NDArray grad_score);
+template void EdgeSoftmaxBackwardCsr<kDLCPU, int32_t, 32>(
+    const CSRMatrix& csc, NDArray out, NDArray grad_out, NDArray grad_score);
+template void EdgeSoftmaxBackwardCsr<kDLCPU, int64_t, 32>(
+    const CSRMatrix& csc, NDArray out, NDArray grad_out, NDArray grad_score);
+template void EdgeSoftmaxBackwardCsr<kDLCPU, int32_t, 64>(
+    const CSRMatrix& csc, NDArray out, NDArray grad_out, NDArray grad_score);
+template void EdgeSoftmaxBackwardCsr<kDLCPU, int64_t, 64>(
+    const CSRMatrix& csc, NDArray out, NDArray grad_out, NDArray grad_score);
+
+}  // namespace aten
+}  // namespace dgl
@@ -0,0 +1,119 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file array/cpu/edge_softmax.h
+ * \brief Edge softmax CPU kernel function header.
+ */
+#ifndef DGL_ARRAY_CPU_EDGE_SOFTMAX_H_
+#define DGL_ARRAY_CPU_EDGE_SOFTMAX_H_
+
+#include <dgl/array.h>
+#include <dgl/runtime/parallel_for.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace dgl {
+namespace aten {
+namespace cpu {
+
+/*!
+ * \brief CPU kernel of the edge softmax forward on Csr format.
+ *
+ * For every row v and head h it computes
+ *
+ *   out[e, h] = exp(score[e, h]) / sum_{e' in row v} exp(score[e', h])
+ *
+ * with the online softmax formulation: the running maximum and normalizer of
+ * every head are kept in a single pass over the edges of the row, and a second
+ * pass writes the normalized scores.
+ *
+ * \param csc The Csr matrix whose rows are the nodes to normalize by.
+ * \param score The edge scores of shape (E, H), indexed by edge id.
+ * \param out The softmax of the scores, of the same shape as score.
+ * \note it uses node parallel strategy, different threads are responsible
+ *       for the computation of different nodes.
+ */
+template <typename IdType, typename DType>
+void EdgeSoftmaxForwardCsr(const CSRMatrix& csc, NDArray score, NDArray out) {
+  const bool has_idx = !IsNullArray(csc.data);
+  const IdType* indptr = csc.indptr.Ptr<IdType>();
+  const IdType* edges = has_idx ? csc.data.Ptr<IdType>() : nullptr;
+  const DType* S = score.Ptr<DType>();
+  DType* O = out.Ptr<DType>();
+  const int64_t num_heads = score->shape[0] ? score.NumElements() / score->shape[0] : 0;
+  runtime::parallel_for_weighted(0, csc.num_rows, indptr, [&](size_t b, size_t e) {
+    std::vector<DType> max_score(num_heads), sum_exp(num_heads);
+    for (auto rid = b; rid < e; ++rid) {
+      const IdType row_start = indptr[rid], row_end = indptr[rid + 1];
+      std::fill(max_score.begin(), max_score.end(), -std::numeric_limits<DType>::infinity());
+      std::fill(sum_exp.begin(), sum_exp.end(), 0);
+      for (IdType j = row_start; j < row_end; ++j) {
+        const DType* s = S + (has_idx ? edges[j] : j) * num_heads;
+        for (int64_t h = 0; h < num_heads; ++h) {
+          if (s[h] > max_score[h]) {
+            sum_exp[h] *= std::exp(max_score[h] - s[h]);
+            max_score[h] = s[h];
+          }
+          sum_exp[h] += std::exp(s[h] - max_score[h]);
+        }
+      }
+      for (int64_t h = 0; h < num_heads; ++h)
+        sum_exp[h] = 1. / sum_exp[h];
+      for (IdType j = row_start; j < row_end; ++j) {
+        const IdType eid = has_idx ? edges[j] : j;
+        const DType* s = S + eid * num_heads;
+        DType* o = O + eid * num_heads;
+        for (int64_t h = 0; h < num_heads; ++h)
+          o[h] = std::exp(s[h] - max_score[h]) * sum_exp[h];
+      }
+    }
+  });
+}
+
+/*!
+ * \brief CPU kernel of the edge softmax backward on Csr format.
+ *
+ * For every row v and head h it computes
+ *
+ *   grad_score[e, h] = out[e, h] * (grad_out[e, h] - sum_{e' in row v} out[e', h] * grad_out[e', h])
+ *
+ * \param csc The Csr matrix whose rows are the nodes to normalize by.
+ * \param out The output of the forward pass, of shape (E, H).
+ * \param grad_out The gradient of out.
+ * \param grad_score The gradient of the scores.
+ */
+template <typename IdType, typename DType>
+void EdgeSoftmaxBackwardCsr(const CSRMatrix& csc, NDArray out,
+                            NDArray grad_out, NDArray grad_score) {
+  const bool has_idx = !IsNullArray(csc.data);
+  const IdType* indptr = csc.indptr.Ptr<IdType>();
+  const IdType* edges = has_idx ? csc.data.Ptr<IdType>() : nullptr;
+  const DType* O = out.Ptr<DType>();
+  const DType* G = grad_out.Ptr<DType>();
+  DType* R = grad_score.Ptr<DType>();
+  const int64_t num_heads = out->shape[0] ? out.NumElements() / out->shape[0] : 0;
+  runtime::parallel_for_weighted(0, csc.num_rows, indptr, [&](size_t b, size_t e) {
+    std::vector<DType> accum(num_heads);
+    for (auto rid = b; rid < e; ++rid) {
+      const IdType row_start = indptr[rid], row_end = indptr[rid + 1];
+      std::fill(accum.begin(), accum.end(), 0);
+      for (IdType j = row_start; j < row_end; ++j) {
+        const int64_t off = (has_idx ? edges[j] : j) * num_heads;
+        for (int64_t h = 0; h < num_heads; ++h)
+          accum[h] += O[off + h] * G[off + h];
+      }
+      for (IdType j = row_start; j < row_end; ++j) {
+        const int64_t off = (has_idx ? edges[j] : j) * num_heads;
+        for (int64_t h = 0; h < num_heads; ++h)
+          R[off + h] = O[off + h] * (G[off + h] - accum[h]);
+      }
+    }
+  });
+}
+
+}  // namespace cpu
+}  // namespace aten
+}  // namespace dgl
+
+#endif  // DGL_ARRAY_CPU_EDGE_SOFTMAX_H_
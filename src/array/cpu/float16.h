@@ -0,0 +1,121 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file array/cpu/float16.h
+ * \brief 16-bit floating point storage types for CPU kernels.
+ */
+#ifndef DGL_ARRAY_CPU_FLOAT16_H_
+#define DGL_ARRAY_CPU_FLOAT16_H_
+
+#include <dgl/runtime/ndarray.h>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace dgl {
+namespace aten {
+namespace cpu {
+
+namespace detail {
+inline uint32_t FloatToBits(float f) {
+  uint32_t u;
+  std::memcpy(&u, &f, sizeof(u));
+  return u;
+}
+
+inline float BitsToFloat(uint32_t u) {
+  float f;
+  std::memcpy(&f, &u, sizeof(f));
+  return f;
+}
+}  // namespace detail
+
+/*!
+ * \brief IEEE 754 half precision number.
+ *
+ * It is only a storage type: kernels convert it to float, compute and
+ * accumulate in float, and round the result back.
+ */
+struct Float16 {
+  uint16_t bits;
+
+  Float16() = default;
+
+  /*! \brief Round a float to the nearest half, ties to even. */
+  explicit Float16(float f) {
+    // Scale the magnitudes so that the float addition below performs the
+    // rounding of the mantissa, including for subnormal halves.
+    const float scale_to_inf = detail::BitsToFloat(0x77800000);   // 2^112
+    const float scale_to_zero = detail::BitsToFloat(0x08800000);  // 2^-110
+    float base = (std::abs(f) * scale_to_inf) * scale_to_zero;
+    const uint32_t w = detail::FloatToBits(f);
+    const uint32_t shl1_w = w + w;
+    const uint32_t sign = w & 0x80000000u;
+    uint32_t bias = shl1_w & 0xFF000000u;
+    if (bias < 0x71000000u)
+      bias = 0x71000000u;
+    base = detail::BitsToFloat((bias >> 1) + 0x07800000u) + base;
+    const uint32_t base_bits = detail::FloatToBits(base);
+    const uint32_t exp_bits = (base_bits >> 13) & 0x00007C00u;
+    const uint32_t mantissa_bits = base_bits & 0x00000FFFu;
+    const uint32_t nonsign = exp_bits + mantissa_bits;
+    bits = static_cast<uint16_t>((sign >> 16) | (shl1_w > 0xFF000000u ? 0x7E00u : nonsign));
+  }
+
+  operator float() const {
+    const uint32_t w = static_cast<uint32_t>(bits) << 16;
+    const uint32_t sign = w & 0x80000000u;
+    const uint32_t two_w = w + w;
+    const float exp_scale = detail::BitsToFloat(0x07800000u);  // 2^-112
+    const float normalized = detail::BitsToFloat((two_w >> 4) + (0xE0u << 23)) * exp_scale;
+    const float denormalized = detail::BitsToFloat((two_w >> 17) | (126u << 23)) - 0.5f;
+    return detail::BitsToFloat(sign | detail::FloatToBits(
+        two_w < (1u << 27) ? denormalized : normalized));
+  }
+};
+
+/*!
+ * \brief Brain floating point number, i.e. the upper half of a float.
+ *
+ * It is only a storage type, see Float16.
+ */
+struct BFloat16 {
+  uint16_t bits;
+
+  BFloat16() = default;
+
+  /*! \brief Round a float to the nearest bfloat16, ties to even. */
+  explicit BFloat16(float f) {
+    const uint32_t u = detail::FloatToBits(f);
+    if ((u & 0x7FFFFFFFu) > 0x7F800000u) {
+      bits = static_cast<uint16_t>((u >> 16) | 0x0040u);  // quiet NaN
+    } else {
+      bits = static_cast<uint16_t>((u + 0x7FFFu + ((u >> 16) & 1)) >> 16);
+    }
+  }
+
+  operator float() const {
+    return detail::BitsToFloat(static_cast<uint32_t>(bits) << 16);
+  }
+};
+
+/*!
+ * \brief Dispatch 16-bit float arrays on CPU according to their dtype code.
+ *
+ * DType is BFloat16 for bfloat16 arrays and Float16 otherwise.
+ */
+#define SWITCH_FLOAT16_TYPE(dtype, DType, ...)                   \
+  do {                                                           \
+    if ((dtype).code == kDLBfloat) {                             \
+      typedef ::dgl::aten::cpu::BFloat16 DType;                  \
+      { __VA_ARGS__ }                                            \
+    } else {                                                     \
+      typedef ::dgl::aten::cpu::Float16 DType;                   \
+      { __VA_ARGS__ }                                            \
+    }                                                            \
+  } while (0)
+
+}  // namespace cpu
+}  // namespace aten
+}  // namespace dgl
+
+#endif  // DGL_ARRAY_CPU_FLOAT16_H_
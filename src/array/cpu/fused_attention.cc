@@ -0,0 +1,70 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file array/cpu/fused_attention.cc
+ * \brief Fused attention C APIs and definitions.
+ */
+#include "./fused_attention.h"
+#include <dgl/array.h>
+#include "./spmm_binary_ops.h"
+
+namespace dgl {
+namespace aten {
+
+#define SWITCH_SCORE_OP(op, ScoreOp, ...)                             \
+  do {                                                                \
+    if ((op) == "dot") {                                              \
+      typedef cpu::op::AttnDot<DType> ScoreOp;                        \
+      { __VA_ARGS__ }                                                 \
+    } else if ((op) == "add") {                                       \
+      typedef cpu::op::AttnAdd<DType> ScoreOp;                        \
+      { __VA_ARGS__ }                                                 \
+    } else {                                                          \
+      LOG(FATAL) << "Unsupported attention score operator: " << (op); \
+    }                                                                 \
+  } while (0)
+
+/*! \brief Fused attention on Csr format. */
+template <int XPU, typename IdType, int bits>
+void FusedAttentionCsr(const std::string& op,
+                       const CSRMatrix& csc,
+                       NDArray lhs,
+                       NDArray rhs,
+                       NDArray feat,
+                       double negative_slope,
+                       NDArray out,
+                       NDArray out_lse) {
+  SWITCH_BITS(bits, DType, {
+    SWITCH_SCORE_OP(op, ScoreOp, {
+      cpu::FusedAttentionCsr<IdType, DType, ScoreOp>(
+          csc, lhs, rhs, feat, static_cast<DType>(negative_slope), out, out_lse);
+    });
+  });
+}
+
+template void FusedAttentionCsr<kDLCPU, int32_t, 16>(
+    const std::string& op, const CSRMatrix& csc,
+    NDArray lhs, NDArray rhs, NDArray feat, double negative_slope,
+    NDArray out, NDArray out_lse);
+template void FusedAttentionCsr<kDLCPU, int64_t, 16>(
+    const std::string& op, const CSRMatrix& csc,
+    NDArray lhs, NDArray rhs, NDArray feat, double negative_slope,
+    NDArray out, NDArray out_lse);
+template void FusedAttentionCsr<kDLCPU, int32_t, 32>(
+    const std::string& op, const CSRMatrix& csc,
+    NDArray lhs, NDArray rhs, NDArray feat, double negative_slope,
+    NDArray out, NDArray out_lse);
+template void FusedAttentionCsr<kDLCPU, int64_t, 32>(
+    const std::string& op, const CSRMatrix& csc,
+    NDArray lhs, NDArray rhs, NDArray feat, double negative_slope,
+    NDArray out, NDArray out_lse);
+template void FusedAttentionCsr<kDLCPU, int32_t, 64>(
+    const std::string& op, const CSRMatrix& csc,
+    NDArray lhs, NDArray rhs, NDArray feat, double negative_slope,
+    NDArray out, NDArray out_lse);
+template void FusedAttentionCsr<kDLCPU, int64_t, 64>(
+    const std::string& op, const CSRMatrix& csc,
+    NDArray lhs, NDArray rhs, NDArray feat, double negative_slope,
+    NDArray out, NDArray out_lse);
+
+}  // namespace aten
+}  // namespace dgl
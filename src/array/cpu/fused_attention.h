@@ -0,0 +1,139 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file array/cpu/fused_attention.h
+ * \brief Fused attention (SDDMM + edge softmax + SpMM) CPU kernel function header.
+ */
+#ifndef DGL_ARRAY_CPU_FUSED_ATTENTION_H_
+#define DGL_ARRAY_CPU_FUSED_ATTENTION_H_
+
+#include <dgl/array.h>
+#include <dgl/runtime/parallel_for.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace dgl {
+namespace aten {
+namespace cpu {
+namespace op {
+
+/*! \brief Attention score of u_dot_v, e.g. for dot-product attention. */
+template <typename DType>
+struct AttnDot {
+  inline static DType Call(const DType* lhs, const DType* rhs, int64_t len) {
+    DType rst = 0;
+    for (int64_t i = 0; i < len; ++i)
+      rst += lhs[i] * rhs[i];
+    return rst;
+  }
+};
+
+/*! \brief Attention score of u_add_v, e.g. for GAT. */
+template <typename DType>
+struct AttnAdd {
+  inline static DType Call(const DType* lhs, const DType* rhs, int64_t len) {
+    return lhs[0] + rhs[0];
+  }
+};
+
+}  // namespace op
+
+/*!
+ * \brief CPU kernel of fused attention on Csr format.
+ *
+ * For every destination node v and head h it computes
+ *
+ *   s_e = leaky_relu(score(lhs[u, h], rhs[v, h]))  for every in-edge e = (u, v)
+ *   out[v, h] = sum_e softmax(s)_e * feat[u, h]
+ *
+ * in a single pass over the edges of v, using the online softmax formulation:
+ * the running maximum and normalizer of every head are kept while aggregating,
+ * and the partial sum is rescaled whenever the maximum grows. No edge tensor
+ * is materialized.
+ *
+ * \param csc The Csr matrix whose rows are the destination nodes.
+ * \param lhs The source node operand of shape (N_src, H, D).
+ * \param rhs The destination node operand of shape (N_dst, H, D).
+ * \param feat The source node feature to aggregate, of shape (N_src, H, F).
+ * \param negative_slope The negative slope of the leaky relu applied to the
+ *        scores; 1 leaves the scores unchanged.
+ * \param out The result feature on destination nodes, of shape (N_dst, H, F).
+ * \param out_lse The log-sum-exp of the scores of every destination node and
+ *        head, of shape (N_dst, H), which is enough to recompute the softmax in
+ *        the backward pass. It is -inf for nodes without in-edges. Can be a
+ *        null array if not needed.
+ * \note it uses node parallel strategy, different threads are responsible
+ *       for the computation of different nodes.
+ */
+template <typename IdType, typename DType, typename ScoreOp>
+void FusedAttentionCsr(const CSRMatrix& csc, NDArray lhs, NDArray rhs,
+                       NDArray feat, DType negative_slope,
+                       NDArray out, NDArray out_lse) {
+  const IdType* indptr = csc.indptr.Ptr<IdType>();
+  const IdType* indices = csc.indices.Ptr<IdType>();
+  const DType* X = lhs.Ptr<DType>();
+  const DType* Y = rhs.Ptr<DType>();
+  const DType* V = feat.Ptr<DType>();
+  DType* O = out.Ptr<DType>();
+  DType* L = IsNullArray(out_lse) ? nullptr : out_lse.Ptr<DType>();
+  const int64_t num_heads = feat->shape[1], feat_len = feat->shape[2],
+                score_len = lhs->shape[2];
+  CHECK_NOTNULL(indptr);
+  CHECK_NOTNULL(O);
+  runtime::parallel_for_weighted(0, csc.num_rows, indptr, [&](size_t b, size_t e) {
+    // running maximum and normalizer of the scores of every head
+    std::vector<DType> max_score(num_heads), sum_exp(num_heads);
+    for (auto rid = b; rid < e; ++rid) {
+      const IdType row_start = indptr[rid], row_end = indptr[rid + 1];
+      DType* out_off = O + rid * num_heads * feat_len;
+      std::fill(out_off, out_off + num_heads * feat_len, 0);
+      std::fill(max_score.begin(), max_score.end(), -std::numeric_limits<DType>::infinity());
+      std::fill(sum_exp.begin(), sum_exp.end(), 0);
+      const DType* rhs_off = Y + rid * num_heads * score_len;
+      for (IdType j = row_start; j < row_end; ++j) {
+        const IdType cid = indices[j];
+        const DType* lhs_off = X + cid * num_heads * score_len;
+        const DType* feat_off = V + cid * num_heads * feat_len;
+        for (int64_t h = 0; h < num_heads; ++h) {
+          DType score = ScoreOp::Call(
+              lhs_off + h * score_len, rhs_off + h * score_len, score_len);
+          if (score < 0)
+            score *= negative_slope;
+          DType* acc = out_off + h * feat_len;
+          if (score > max_score[h]) {
+            // rescale the partial sums to the new maximum
+            const DType scale = std::exp(max_score[h] - score);
+            sum_exp[h] *= scale;
+            for (int64_t k = 0; k < feat_len; ++k)
+              acc[k] *= scale;
+            max_score[h] = score;
+          }
+          const DType w = std::exp(score - max_score[h]);
+          sum_exp[h] += w;
+          const DType* val = feat_off + h * feat_len;
+          for (int64_t k = 0; k < feat_len; ++k)
+            acc[k] += w * val[k];
+        }
+      }
+      for (int64_t h = 0; h < num_heads; ++h) {
+        if (sum_exp[h] > 0) {
+          DType* acc = out_off + h * feat_len;
+          const DType inv = 1. / sum_exp[h];
+          for (int64_t k = 0; k < feat_len; ++k)
+            acc[k] *= inv;
+        }
+        if (L)
+          L[rid * num_heads + h] = (sum_exp[h] > 0)
+            ? max_score[h] + std::log(sum_exp[h])
+            : -std::numeric_limits<DType>::infinity();
+      }
+    }
+  });
+}
+
+}  // namespace cpu
+}  // namespace aten
+}  // namespace dgl
+
+#endif  // DGL_ARRAY_CPU_FUSED_ATTENTION_H_
@@ -0,0 +1,210 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file array/cpu/quantized.cc
+ * \brief Quantized feature tables on CPU
+ */
+#include <dgl/array.h>
+#include <dgl/runtime/parallel_for.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "./float16.h"
+#include "../array_op.h"
+
+namespace dgl {
+using runtime::NDArray;
+using runtime::parallel_for;
+using runtime::parallel_for_weighted;
+namespace aten {
+
+namespace {
+
+/*! \brief The value of the float32 x in the int8 grid of a scale and a zero point. */
+inline int8_t QuantizeValue(float x, float scale, float zero_point) {
+  const float q = std::nearbyint(x / scale + zero_point);
+  return static_cast<int8_t>(std::min(127.f, std::max(-128.f, q)));
+}
+
+/*! \brief The float32 value of the row r and column c of a table. */
+template <int bits>
+struct Dequantizer;
+
+template <>
+struct Dequantizer<8> {
+  const int8_t* data;
+  const float* scale;
+  const float* zero_point;
+  bool per_row;
+
+  float operator()(int64_t r, int64_t c, int64_t row_len) const {
+    const int64_t k = per_row ? r : c;
+    return scale[k] * (data[r * row_len + c] - zero_point[k]);
+  }
+};
+
+template <>
+struct Dequantizer<16> {
+  const cpu::Float16* data;
+
+  float operator()(int64_t r, int64_t c, int64_t row_len) const {
+    return data[r * row_len + c];
+  }
+};
+
+template <int bits>
+Dequantizer<bits> MakeDequantizer(const QuantizedArray& array);
+
+template <>
+Dequantizer<8> MakeDequantizer<8>(const QuantizedArray& array) {
+  return {array.data.Ptr<int8_t>(), array.scale.Ptr<float>(),
+          array.zero_point.Ptr<float>(), array.per_row};
+}
+
+template <>
+Dequantizer<16> MakeDequantizer<16>(const QuantizedArray& array) {
+  return {array.data.Ptr<cpu::Float16>()};
+}
+
+template <typename Deq, typename IdType>
+void SpMMCopyUSumQuantizedImpl(const CSRMatrix& csr, const Deq& deq, int64_t row_len,
+                               float* out) {
+  const IdType* indptr = csr.indptr.Ptr<IdType>();
+  const IdType* indices = csr.indices.Ptr<IdType>();
+  parallel_for_weighted(0, csr.num_rows, indptr, [&](size_t b, size_t e) {
+    std::vector<float> accum(row_len);
+    for (auto i = b; i < e; ++i) {
+      std::fill(accum.begin(), accum.end(), 0.f);
+      for (IdType j = indptr[i]; j < indptr[i + 1]; ++j) {
+        const int64_t u = indices[j];
+        for (int64_t c = 0; c < row_len; ++c)
+          accum[c] += deq(u, c, row_len);
+      }
+      std::copy(accum.begin(), accum.end(), out + i * row_len);
+    }
+  });
+}
+
+}  // namespace
+
+QuantizedArray Quantize(NDArray array, DLDataType dtype, bool per_row) {
+  CHECK_EQ(array->ctx.device_type, kDLCPU) << "Only a table on CPU can be quantized.";
+  CHECK(array->dtype == DLDataType({kDLFloat, 32, 1})) << "The table must be float32.";
+  CHECK_GE(array->ndim, 1) << "The table must have at least one dimension.";
+  CHECK(array.IsContiguous()) << "The table must be contiguous.";
+  const int64_t num_rows = array->shape[0];
+  QuantizedArray ret;
+  ret.data = NDArray::Empty(
+      std::vector<int64_t>(array->shape, array->shape + array->ndim), dtype, array->ctx);
+  ret.per_row = per_row;
+  const int64_t row_len = QuantizedRowLength(ret);
+  const float* x = array.Ptr<float>();
+  if (dtype == DLDataType({kDLFloat, 16, 1})) {
+    cpu::Float16* h = ret.data.Ptr<cpu::Float16>();
+    parallel_for(0, num_rows * row_len, [&](size_t b, size_t e) {
+      for (auto i = b; i < e; ++i)
+        h[i] = cpu::Float16(x[i]);
+    });
+    return ret;
+  }
+  CHECK(dtype == DLDataType({kDLInt, 8, 1})) << "A table can only be quantized to int8 "
+                                             << "or float16.";
+
+  // the range of every row or column is mapped to [-128, 127]
+  const int64_t num_groups = per_row ? num_rows : row_len;
+  std::vector<float> lo(num_groups, std::numeric_limits<float>::infinity());
+  std::vector<float> hi(num_groups, -std::numeric_limits<float>::infinity());
+  if (per_row) {
+    parallel_for(0, num_rows, [&](size_t b, size_t e) {
+      for (auto r = b; r < e; ++r) {
+        for (int64_t c = 0; c < row_len; ++c) {
+          lo[r] = std::min(lo[r], x[r * row_len + c]);
+          hi[r] = std::max(hi[r], x[r * row_len + c]);
+        }
+      }
+    });
+  } else {
+    parallel_for(0, row_len, [&](size_t b, size_t e) {
+      for (int64_t r = 0; r < num_rows; ++r) {
+        for (auto c = b; c < e; ++c) {
+          lo[c] = std::min(lo[c], x[r * row_len + c]);
+          hi[c] = std::max(hi[c], x[r * row_len + c]);
+        }
+      }
+    });
+  }
+  ret.scale = NDArray::Empty({num_groups}, array->dtype, array->ctx);
+  ret.zero_point = NDArray::Empty({num_groups}, array->dtype, array->ctx);
+  float* scale = ret.scale.Ptr<float>();
+  float* zero_point = ret.zero_point.Ptr<float>();
+  for (int64_t k = 0; k < num_groups; ++k) {
+    // a constant group, or an empty one, is scaled by 1
+    scale[k] = hi[k] > lo[k] ? (hi[k] - lo[k]) / 255.f : 1.f;
+    zero_point[k] = hi[k] >= lo[k] ? -128.f - lo[k] / scale[k] : 0.f;
+  }
+  int8_t* q = ret.data.Ptr<int8_t>();
+  parallel_for(0, num_rows, [&](size_t b, size_t e) {
+    for (auto r = b; r < e; ++r) {
+      for (int64_t c = 0; c < row_len; ++c) {
+        const int64_t k = per_row ? r : c;
+        q[r * row_len + c] = QuantizeValue(x[r * row_len + c], scale[k], zero_point[k]);
+      }
+    }
+  });
+  return ret;
+}
+
+void SpMMCopyUSumQuantized(const CSRMatrix& csr, const QuantizedArray& ufeat, NDArray out) {
+  CHECK_EQ(csr.indptr->ctx.device_type, kDLCPU) << "Only SpMM on CPU reads quantized tables.";
+  CHECK_EQ(ufeat.data->ctx.device_type, kDLCPU) << "The table must be on CPU.";
+  CHECK(out->dtype == DLDataType({kDLFloat, 32, 1})) << "The output must be float32.";
+  CHECK(out.IsContiguous()) << "The output must be contiguous.";
+  const int64_t row_len = QuantizedRowLength(ufeat);
+  CHECK_EQ(out->shape[0], csr.num_rows) << "The output must have a row for every row.";
+  CHECK_EQ(out.NumElements(), csr.num_rows * row_len)
+    << "The output rows must have the length of the table rows.";
+  CHECK_GE(ufeat.data->shape[0], csr.num_cols) << "The table must have a row for every column.";
+  ATEN_ID_TYPE_SWITCH(csr.indptr->dtype, IdType, {
+    if (ufeat.data->dtype.bits == 8) {
+      SpMMCopyUSumQuantizedImpl<Dequantizer<8>, IdType>(
+          csr, MakeDequantizer<8>(ufeat), row_len, out.Ptr<float>());
+    } else {
+      SpMMCopyUSumQuantizedImpl<Dequantizer<16>, IdType>(
+          csr, MakeDequantizer<16>(ufeat), row_len, out.Ptr<float>());
+    }
+  });
+}
+
+namespace impl {
+
+template <DLDeviceType XPU, int bits, typename IdType>
+NDArray IndexSelectDequantize(const QuantizedArray& array, IdArray index) {
+  const int64_t num_rows = array.data->shape[0];
+  const int64_t row_len = QuantizedRowLength(array);
+  const int64_t len = index->shape[0];
+  std::vector<int64_t> shape(array.data->shape, array.data->shape + array.data->ndim);
+  shape[0] = len;
+  NDArray ret = NDArray::Empty(shape, DLDataType{kDLFloat, 32, 1}, index->ctx);
+  const IdType* idx = index.Ptr<IdType>();
+  float* out = ret.Ptr<float>();
+  const Dequantizer<bits> deq = MakeDequantizer<bits>(array);
+  parallel_for(0, len, [&](size_t b, size_t e) {
+    for (auto i = b; i < e; ++i) {
+      const int64_t r = idx[i];
+      CHECK(r >= 0 && r < num_rows) << "Index out of range.";
+      for (int64_t c = 0; c < row_len; ++c)
+        out[i * row_len + c] = deq(r, c, row_len);
+    }
+  });
+  return ret;
+}
+
+template NDArray IndexSelectDequantize<kDLCPU, 8, int32_t>(const QuantizedArray&, IdArray);
+template NDArray IndexSelectDequantize<kDLCPU, 8, int64_t>(const QuantizedArray&, IdArray);
+template NDArray IndexSelectDequantize<kDLCPU, 16, int32_t>(const QuantizedArray&, IdArray);
+template NDArray IndexSelectDequantize<kDLCPU, 16, int64_t>(const QuantizedArray&, IdArray);
+
+}  // namespace impl
+
+}  // namespace aten
+}  // namespace dgl
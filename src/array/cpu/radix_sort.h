@@ -0,0 +1,112 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file array/cpu/radix_sort.h
+ * \brief Parallel LSD radix sort of key-value pairs on CPU
+ */
+#ifndef DGL_ARRAY_CPU_RADIX_SORT_H_
+#define DGL_ARRAY_CPU_RADIX_SORT_H_
+
+#include <dgl/runtime/parallel_for.h>
+#include <dmlc/omp.h>
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace dgl {
+namespace aten {
+namespace impl {
+
+/*! \brief The number of elements below which the sorts use std::sort instead. */
+constexpr int64_t kRadixSortMinSize = 1 << 16;
+
+/*! \brief Return the number of bits needed to represent the given value. */
+inline int RadixSortNumBits(uint64_t value) {
+  int bits = 0;
+  for (; value > 0; value >>= 1)
+    ++bits;
+  return bits;
+}
+
+/*!
+ * \brief Stable sort of the pairs of keys and values by key, in place.
+ *
+ * The keys are sorted by digits of 8 bits, from the lowest one. Each pass splits
+ * the pairs into one chunk per thread, counts the digits of every chunk, and
+ * scatters the chunks to the positions given by the prefix sums of the counts
+ * ordered by digit then chunk, which keeps the sort stable. The passes in which
+ * all the keys have the same digit are skipped.
+ *
+ * \param keys The unsigned keys, all less than 2^num_bits.
+ * \param values The values, moved along with their keys.
+ * \param num_items The number of pairs.
+ * \param num_bits The number of low bits of the keys to sort by.
+ */
+template <typename KeyType, typename ValueType>
+void RadixSortPairs(KeyType* keys, ValueType* values, int64_t num_items, int num_bits) {
+  constexpr int kDigitBits = 8;
+  constexpr int64_t kNumDigits = 1 << kDigitBits;
+  if (num_items <= 1 || num_bits <= 0)
+    return;
+  const int64_t num_chunks = std::max<int64_t>(
+      1, std::min<int64_t>(omp_get_max_threads(), num_items / kNumDigits));
+  std::vector<KeyType> keys_buffer(num_items);
+  std::vector<ValueType> values_buffer(num_items);
+  std::vector<int64_t> offsets(num_chunks * kNumDigits);
+  KeyType* src_keys = keys;
+  ValueType* src_values = values;
+  KeyType* dst_keys = keys_buffer.data();
+  ValueType* dst_values = values_buffer.data();
+
+  for (int shift = 0; shift < num_bits; shift += kDigitBits) {
+    auto digit = [shift](KeyType key) {
+      return static_cast<int64_t>((static_cast<uint64_t>(key) >> shift) & (kNumDigits - 1));
+    };
+    runtime::parallel_for(0, num_chunks, 1, [&](int64_t b, int64_t e) {
+      for (int64_t c = b; c < e; ++c) {
+        int64_t* counts = offsets.data() + c * kNumDigits;
+        std::fill(counts, counts + kNumDigits, 0);
+        for (int64_t i = num_items * c / num_chunks; i < num_items * (c + 1) / num_chunks; ++i)
+          ++counts[digit(src_keys[i])];
+      }
+    });
+    int64_t offset = 0;
+    bool single_digit = false;
+    for (int64_t d = 0; d < kNumDigits; ++d) {
+      const int64_t digit_start = offset;
+      for (int64_t c = 0; c < num_chunks; ++c) {
+        const int64_t count = offsets[c * kNumDigits + d];
+        offsets[c * kNumDigits + d] = offset;
+        offset += count;
+      }
+      single_digit = single_digit || (offset - digit_start == num_items);
+    }
+    if (single_digit)
+      continue;
+    runtime::parallel_for(0, num_chunks, 1, [&](int64_t b, int64_t e) {
+      for (int64_t c = b; c < e; ++c) {
+        int64_t* chunk_offsets = offsets.data() + c * kNumDigits;
+        for (int64_t i = num_items * c / num_chunks; i < num_items * (c + 1) / num_chunks; ++i) {
+          const int64_t pos = chunk_offsets[digit(src_keys[i])]++;
+          dst_keys[pos] = src_keys[i];
+          dst_values[pos] = src_values[i];
+        }
+      }
+    });
+    std::swap(src_keys, dst_keys);
+    std::swap(src_values, dst_values);
+  }
+
+  if (src_keys != keys) {
+    runtime::parallel_for(0, num_items, kNumDigits, [&](int64_t b, int64_t e) {
+      std::copy(src_keys + b, src_keys + e, keys + b);
+      std::copy(src_values + b, src_values + e, values + b);
+    });
+  }
+}
+
+}  // namespace impl
+}  // namespace aten
+}  // namespace dgl
+
+#endif  // DGL_ARRAY_CPU_RADIX_SORT_H_
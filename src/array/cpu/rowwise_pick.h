@@ -8,12 +8,15 @@
 
 #include <dgl/array.h>
 #include <dmlc/omp.h>
+#include <dgl/random.h>
 #include <dgl/runtime/parallel_for.h>
 #include <functional>
 #include <algorithm>
 #include <string>
 #include <vector>
 #include <memory>
+#include <numeric>
+#include "../../runtime/arena.h"
 
 namespace dgl {
 namespace aten {
@@ -37,6 +40,9 @@ namespace impl {
 // \param col Pointer of the column indices.
 // \param data Pointer of the data indices.
 // \param out_idx Picked indices in [off, off + len).
+//
+// The pickers below take the function as a template parameter, so that a
+// lambda is inlined in the loop over the rows. PickFn remains accepted.
 template <typename IdxType>
 using PickFn = std::function<void(
     IdxType rowid, IdxType off, IdxType len,
@@ -62,6 +68,8 @@ using PickFn = std::function<void(
 // \param et_idx A map from local idx to column id.
 // \param data Pointer of the data indices.
 // \param out_idx Picked indices in [et_offset, et_offset + et_len).
+//
+// As for PickFn, the pickers take the function as a template parameter.
 template <typename IdxType>
 using RangePickFn = std::function<void(
     IdxType off, IdxType et_offset, IdxType cur_et, IdxType et_len,
@@ -70,10 +78,15 @@ using RangePickFn = std::function<void(
 
 // Template for picking non-zero values row-wise. The implementation utilizes
 // OpenMP parallelization on rows because each row performs computation independently.
-template <typename IdxType>
+//
+// Under a RowStreamScope of the calling thread, every row is picked from its own
+// stream, keyed on stream_rows[i], or on the row ID if stream_rows is null.
+template <typename IdxType, typename PickFnType = PickFn<IdxType>>
 COOMatrix CSRRowWisePick(CSRMatrix mat, IdArray rows,
-                         int64_t num_picks, bool replace, PickFn<IdxType> pick_fn) {
+                         int64_t num_picks, bool replace, const PickFnType& pick_fn,
+                         const IdxType* stream_rows = nullptr) {
   using namespace aten;
+  const RowStreamKey row_streams = RowStreamScope::Current();
   const IdxType* indptr = static_cast<IdxType*>(mat.indptr->data);
   const IdxType* indices = static_cast<IdxType*>(mat.indices->data);
   const IdxType* data = CSRHasData(mat)? static_cast<IdxType*>(mat.data->data) : nullptr;
@@ -81,79 +94,52 @@ COOMatrix CSRRowWisePick(CSRMatrix mat, IdArray rows,
   const int64_t num_rows = rows->shape[0];
   const auto& ctx = mat.indptr->ctx;
 
-  // To leverage OMP parallelization, we create two arrays to store
-  // picked src and dst indices. Each array is of length num_rows * num_picks.
-  // For rows whose nnz < num_picks, the indices are padded with -1.
-  //
-  // We check whether all the given rows
-  // have at least num_picks number of nnz when replace is false.
-  //
-  // If the check holds, remove -1 elements by remove_if operation, which simply
-  // moves valid elements to the head of arrays and create a view of the original
-  // array. The implementation consumes a little extra memory than the actual requirement.
+  // Prefix sums over the given rows of the number of picked elements, i.e. the
+  // offsets of the rows in the result, and of the degrees, i.e. the cost of the
+  // rows which balances the threads on power-law graphs. The picked rows are
+  // then written in place into arrays of the exact result size, instead of
+  // num_rows * num_picks arrays compacted afterwards.
   //
-  // Otherwise, directly use the row and col arrays to construct the result COO matrix.
-  //
-  // [02/29/2020 update]: OMP is disabled for now since batch-wise parallelism is more
-  //   significant. (minjie)
-  IdArray picked_row = NDArray::Empty({num_rows * num_picks},
+  // The prefix sums are drawn from the arena of the calling thread, which keeps
+  // the memory around for the next sampling calls.
+  runtime::ArenaScope arena_scope;
+  int64_t* pick_prefix = arena_scope.arena()->Alloc<int64_t>(num_rows + 1);
+  int64_t* deg_prefix = arena_scope.arena()->Alloc<int64_t>(num_rows + 1);
+  pick_prefix[0] = 0;
+  deg_prefix[0] = 0;
+  runtime::parallel_for(0, num_rows, [&](size_t b, size_t e) {
+    for (size_t i = b; i < e; ++i) {
+      const IdxType rid = rows_data[i];
+      const IdxType len = indptr[rid + 1] - indptr[rid];
+      if (replace) {
+        pick_prefix[i + 1] = len == 0 ? 0 : num_picks;
+      } else {
+        pick_prefix[i + 1] = std::min(static_cast<IdxType>(num_picks), len);
+      }
+      deg_prefix[i + 1] = len;
+    }
+  });
+  std::partial_sum(pick_prefix, pick_prefix + num_rows + 1, pick_prefix);
+  std::partial_sum(deg_prefix, deg_prefix + num_rows + 1, deg_prefix);
+
+  const int64_t new_len = pick_prefix[num_rows];
+  IdArray picked_row = NDArray::Empty({new_len},
                                       DLDataType{kDLInt, 8*sizeof(IdxType), 1},
                                       ctx);
-  IdArray picked_col = NDArray::Empty({num_rows * num_picks},
+  IdArray picked_col = NDArray::Empty({new_len},
                                       DLDataType{kDLInt, 8*sizeof(IdxType), 1},
                                       ctx);
-  IdArray picked_idx = NDArray::Empty({num_rows * num_picks},
+  IdArray picked_idx = NDArray::Empty({new_len},
                                       DLDataType{kDLInt, 8*sizeof(IdxType), 1},
                                       ctx);
   IdxType* picked_rdata = static_cast<IdxType*>(picked_row->data);
   IdxType* picked_cdata = static_cast<IdxType*>(picked_col->data);
   IdxType* picked_idata = static_cast<IdxType*>(picked_idx->data);
 
-  const int num_threads = omp_get_max_threads();
-  std::vector<int64_t> global_prefix(num_threads+1, 0);
-
-#pragma omp parallel num_threads(num_threads)
-  {
-    const int thread_id = omp_get_thread_num();
-
-    const int64_t start_i = thread_id * (num_rows/num_threads) +
-        std::min(static_cast<int64_t>(thread_id), num_rows % num_threads);
-    const int64_t end_i = (thread_id + 1) * (num_rows/num_threads) +
-        std::min(static_cast<int64_t>(thread_id + 1), num_rows % num_threads);
-    assert(thread_id + 1 < num_threads || end_i == num_rows);
-
-    const int64_t num_local = end_i - start_i;
-
-    // make sure we don't have to pay initialization cost
-    std::unique_ptr<int64_t[]> local_prefix(new int64_t[num_local + 1]);
-    local_prefix[0] = 0;
-    for (int64_t i = start_i; i < end_i; ++i) {
-      // build prefix-sum
-      const int64_t local_i = i-start_i;
-      const IdxType rid = rows_data[i];
-      IdxType len;
-      if (replace) {
-        len = indptr[rid+1] == indptr[rid] ? 0 : num_picks;
-      } else {
-        len = std::min(
-          static_cast<IdxType>(num_picks), indptr[rid + 1] - indptr[rid]);
-      }
-      local_prefix[local_i + 1] = local_prefix[local_i] + len;
-    }
-    global_prefix[thread_id + 1] = local_prefix[num_local];
-
-    #pragma omp barrier
-    #pragma omp master
-    {
-      for (int t = 0; t < num_threads; ++t) {
-        global_prefix[t+1] += global_prefix[t];
-      }
-    }
-
-    #pragma omp barrier
-    const IdxType thread_offset = global_prefix[thread_id];
-
-    for (int64_t i = start_i; i < end_i; ++i) {
+  runtime::parallel_for_weighted(0, num_rows, deg_prefix, [&](size_t b, size_t e) {
+    RandomEngine* engine = RandomEngine::ThreadLocal();
+    const RandomEngine saved_engine = *engine;
+    for (size_t i = b; i < e; ++i) {
       const IdxType rid = rows_data[i];
 
       const IdxType off = indptr[rid];
@@ -161,8 +147,7 @@ COOMatrix CSRRowWisePick(CSRMatrix mat, IdArray rows,
       if (len == 0)
         continue;
 
-      const int64_t local_i = i - start_i;
-      const int64_t row_offset = thread_offset + local_prefix[local_i];
+      const int64_t row_offset = pick_prefix[i];
 
       if (len <= num_picks && !replace) {
         // nnz <= num_picks and w/o replacement, take all nnz
@@ -172,6 +157,8 @@ COOMatrix CSRRowWisePick(CSRMatrix mat, IdArray rows,
           picked_idata[row_offset + j] = data? data[off + j] : off + j;
         }
       } else {
+        if (row_streams.enabled)
+          row_streams.Seed(engine, stream_rows ? stream_rows[i] : rid);
         pick_fn(rid, off, len,
                 indices, data,
                 picked_idata + row_offset);
@@ -183,24 +170,27 @@ COOMatrix CSRRowWisePick(CSRMatrix mat, IdArray rows,
         }
       }
     }
-  }
-
-  const int64_t new_len = global_prefix.back();
-  picked_row = picked_row.CreateView({new_len}, picked_row->dtype);
-  picked_col = picked_col.CreateView({new_len}, picked_col->dtype);
-  picked_idx = picked_idx.CreateView({new_len}, picked_idx->dtype);
+    if (row_streams.enabled)
+      *engine = saved_engine;
+  });
 
+  // the picks come grouped by row in the order of the given rows
+  const bool row_sorted = std::is_sorted(rows_data, rows_data + num_rows);
   return COOMatrix(mat.num_rows, mat.num_cols,
-                   picked_row, picked_col, picked_idx);
+                   picked_row, picked_col, picked_idx, row_sorted);
 }
 
 // Template for picking non-zero values row-wise. The implementation utilizes
 // OpenMP parallelization on rows because each row performs computation independently.
-template <typename IdxType>
+//
+// The rows are keyed on their streams as in CSRRowWisePick.
+template <typename IdxType, typename RangePickFnType = RangePickFn<IdxType>>
 COOMatrix CSRRowWisePerEtypePick(CSRMatrix mat, IdArray rows, IdArray etypes,
                                  const std::vector<int64_t>& num_picks, bool replace,
-                                 bool etype_sorted, RangePickFn<IdxType> pick_fn) {
+                                 bool etype_sorted, const RangePickFnType& pick_fn,
+                                 const IdxType* stream_rows = nullptr) {
   using namespace aten;
+  const RowStreamKey row_streams = RowStreamScope::Current();
   const IdxType* indptr = mat.indptr.Ptr<IdxType>();
   const IdxType* indices = mat.indices.Ptr<IdxType>();
   const IdxType* data = CSRHasData(mat)? mat.data.Ptr<IdxType>() : nullptr;
@@ -226,12 +216,24 @@ COOMatrix CSRRowWisePerEtypePick(CSRMatrix mat, IdArray rows, IdArray etypes,
     }
   }
 
-  runtime::parallel_for(0, num_rows, [&](size_t b, size_t e) {
+  // balance the threads by the degrees of the rows
+  runtime::ArenaScope arena_scope;
+  runtime::ArenaVector<int64_t> deg_prefix(num_rows + 1, 0);
+  for (int64_t i = 0; i < num_rows; ++i) {
+    const IdxType rid = rows_data[i];
+    CHECK_LT(rid, mat.num_rows);
+    deg_prefix[i + 1] = deg_prefix[i] + indptr[rid + 1] - indptr[rid];
+  }
+
+  runtime::parallel_for_weighted(0, num_rows, deg_prefix.data(), [&](size_t b, size_t e) {
+    RandomEngine* engine = RandomEngine::ThreadLocal();
+    const RandomEngine saved_engine = *engine;
     for (int64_t i = b; i < e; ++i) {
       const IdxType rid = rows_data[i];
-      CHECK_LT(rid, mat.num_rows);
       const IdxType off = indptr[rid];
       const IdxType len = indptr[rid + 1] - off;
+      if (row_streams.enabled)
+        row_streams.Seed(engine, stream_rows ? stream_rows[i] : rid);
 
       // do something here
       if (len == 0) {
@@ -256,12 +258,17 @@ COOMatrix CSRRowWisePerEtypePick(CSRMatrix mat, IdArray rows, IdArray etypes,
         picked_cols[i] = cols;
         picked_idxs[i] = idx;
       } else {
-        // need to do per edge type sample
-        std::vector<IdxType> rows;
-        std::vector<IdxType> cols;
-        std::vector<IdxType> idx;
-
-        std::vector<IdxType> et(len);
+        // need to do per edge type sample, the temporaries of the row are drawn
+        // from the arena of the worker thread
+        runtime::ArenaScope row_scope;
+        runtime::ArenaVector<IdxType> rows;
+        runtime::ArenaVector<IdxType> cols;
+        runtime::ArenaVector<IdxType> idx;
+        rows.reserve(len);
+        cols.reserve(len);
+        idx.reserve(len);
+
+        runtime::ArenaVector<IdxType> et(len);
         std::vector<IdxType> et_idx(len);
         std::iota(et_idx.begin(), et_idx.end(), 0);
         for (int64_t j = 0; j < len; ++j) {
@@ -292,8 +299,7 @@ COOMatrix CSRRowWisePerEtypePick(CSRMatrix mat, IdArray rows, IdArray etypes,
                   idx.push_back(off+et_idx[et_offset+k]);
               }
             } else {
-              IdArray picked_idx = Full(-1, num_picks[cur_et], sizeof(IdxType) * 8, ctx);
-              IdxType* picked_idata = static_cast<IdxType*>(picked_idx->data);
+              IdxType* picked_idata = row_scope.arena()->Alloc<IdxType>(num_picks[cur_et]);
 
               // need call random pick
               pick_fn(off, et_offset, cur_et,
@@ -321,14 +327,19 @@ COOMatrix CSRRowWisePerEtypePick(CSRMatrix mat, IdArray rows, IdArray etypes,
           }
         }
 
-        picked_rows[i] = VecToIdArray(rows, sizeof(IdxType) * 8, ctx);
-        picked_cols[i] = VecToIdArray(cols, sizeof(IdxType) * 8, ctx);
-        picked_idxs[i] = VecToIdArray(idx, sizeof(IdxType) * 8, ctx);
+        picked_rows[i] = NewIdArray(rows.size(), ctx, sizeof(IdxType) * 8);
+        picked_cols[i] = NewIdArray(cols.size(), ctx, sizeof(IdxType) * 8);
+        picked_idxs[i] = NewIdArray(idx.size(), ctx, sizeof(IdxType) * 8);
+        std::copy(rows.begin(), rows.end(), picked_rows[i].Ptr<IdxType>());
+        std::copy(cols.begin(), cols.end(), picked_cols[i].Ptr<IdxType>());
+        std::copy(idx.begin(), idx.end(), picked_idxs[i].Ptr<IdxType>());
       }  // end processing one row
 
       CHECK_EQ(picked_rows[i]->shape[0], picked_cols[i]->shape[0]);
       CHECK_EQ(picked_rows[i]->shape[0], picked_idxs[i]->shape[0]);
     }  // end processing all rows
+    if (row_streams.enabled)
+      *engine = saved_engine;
   });
 
   IdArray picked_row = Concat(picked_rows);
@@ -341,13 +352,16 @@ COOMatrix CSRRowWisePerEtypePick(CSRMatrix mat, IdArray rows, IdArray etypes,
 // Template for picking non-zero values row-wise. The implementation first slices
 // out the corresponding rows and then converts it to CSR format. It then performs
 // row-wise pick on the CSR matrix and rectifies the returned results.
-template <typename IdxType>
+//
+// The streams of the rows are keyed on their IDs in the COO matrix.
+template <typename IdxType, typename PickFnType = PickFn<IdxType>>
 COOMatrix COORowWisePick(COOMatrix mat, IdArray rows,
-                         int64_t num_picks, bool replace, PickFn<IdxType> pick_fn) {
+                         int64_t num_picks, bool replace, const PickFnType& pick_fn) {
   using namespace aten;
   const auto& csr = COOToCSR(COOSliceRows(mat, rows));
   const IdArray new_rows = Range(0, rows->shape[0], rows->dtype.bits, rows->ctx);
-  const auto& picked = CSRRowWisePick<IdxType>(csr, new_rows, num_picks, replace, pick_fn);
+  const auto& picked = CSRRowWisePick<IdxType>(
+      csr, new_rows, num_picks, replace, pick_fn, rows.Ptr<IdxType>());
   return COOMatrix(mat.num_rows, mat.num_cols,
                    IndexSelect(rows, picked.row),  // map the row index to the correct one
                    picked.col,
@@ -357,15 +371,15 @@ COOMatrix COORowWisePick(COOMatrix mat, IdArray rows,
 // Template for picking non-zero values row-wise. The implementation first slices
 // out the corresponding rows and then converts it to CSR format. It then performs
 // row-wise pick on the CSR matrix and rectifies the returned results.
-template <typename IdxType>
+template <typename IdxType, typename RangePickFnType = RangePickFn<IdxType>>
 COOMatrix COORowWisePerEtypePick(COOMatrix mat, IdArray rows, IdArray etypes,
                                  const std::vector<int64_t>& num_picks, bool replace,
-                                 bool etype_sorted, RangePickFn<IdxType> pick_fn) {
+                                 bool etype_sorted, const RangePickFnType& pick_fn) {
   using namespace aten;
   const auto& csr = COOToCSR(COOSliceRows(mat, rows));
   const IdArray new_rows = Range(0, rows->shape[0], rows->dtype.bits, rows->ctx);
   const auto& picked = CSRRowWisePerEtypePick<IdxType>(
-    csr, new_rows, etypes, num_picks, replace, etype_sorted, pick_fn);
+    csr, new_rows, etypes, num_picks, replace, etype_sorted, pick_fn, rows.Ptr<IdxType>());
   return COOMatrix(mat.num_rows, mat.num_cols,
                    IndexSelect(rows, picked.row),  // map the row index to the correct one
                    picked.col,
@@ -4,13 +4,23 @@
  * \brief rowwise sampling
  */
 #include <dgl/random.h>
+#include <algorithm>
 #include <numeric>
+#include <utility>
+#include <vector>
 #include "./rowwise_pick.h"
 
 namespace dgl {
 namespace aten {
 namespace impl {
 namespace {
+
+// Largest number of samples drawn without replacement with the alias tables,
+// whose duplicates are searched linearly.
+constexpr int64_t kAliasMaxRejectionSamples = 64;
+// Number of rejected draws per sample after which the alias pick falls back
+// to the tree sampler.
+constexpr int64_t kAliasMaxDrawsPerSample = 8;
 // Equivalent to numpy expression: array[idx[off:off + len]]
 template <typename IdxType, typename FloatType>
 inline FloatArray DoubleSlice(FloatArray array, const IdxType* idx_data,
@@ -28,89 +38,174 @@ inline FloatArray DoubleSlice(FloatArray array, const IdxType* idx_data,
 }
 
 template <typename IdxType, typename FloatType>
-inline PickFn<IdxType> GetSamplingPickFn(
+struct SamplingPickFn {
+  int64_t num_samples;
+  FloatArray prob;
+  bool replace;
+
+  void operator()(IdxType rowid, IdxType off, IdxType len,
+                  const IdxType* col, const IdxType* data,
+                  IdxType* out_idx) const {
+    FloatArray prob_selected = DoubleSlice<IdxType, FloatType>(prob, data, off, len);
+    RandomEngine::ThreadLocal()->Choice<IdxType, FloatType>(
+        num_samples, prob_selected, out_idx, replace);
+    for (int64_t j = 0; j < num_samples; ++j) {
+      out_idx[j] += off;
+    }
+  }
+};
+
+template <typename IdxType, typename FloatType>
+inline SamplingPickFn<IdxType, FloatType> GetSamplingPickFn(
     int64_t num_samples, FloatArray prob, bool replace) {
-  PickFn<IdxType> pick_fn = [prob, num_samples, replace]
-    (IdxType rowid, IdxType off, IdxType len,
-     const IdxType* col, const IdxType* data,
-     IdxType* out_idx) {
-      FloatArray prob_selected = DoubleSlice<IdxType, FloatType>(prob, data, off, len);
-      RandomEngine::ThreadLocal()->Choice<IdxType, FloatType>(
-          num_samples, prob_selected, out_idx, replace);
-      for (int64_t j = 0; j < num_samples; ++j) {
-        out_idx[j] += off;
-      }
-    };
-  return pick_fn;
+  return {num_samples, prob, replace};
 }
 
 template <typename IdxType, typename FloatType>
-inline RangePickFn<IdxType> GetSamplingRangePickFn(
+struct SamplingRangePickFn {
+  std::vector<int64_t> num_samples;
+  FloatArray prob;
+  bool replace;
+
+  void operator()(IdxType off, IdxType et_offset, IdxType cur_et, IdxType et_len,
+                  const std::vector<IdxType> &et_idx,
+                  const IdxType* data, IdxType* out_idx) const {
+    const FloatType* p_data = static_cast<FloatType*>(prob->data);
+    FloatArray probs = FloatArray::Empty({et_len}, prob->dtype, prob->ctx);
+    FloatType* probs_data = static_cast<FloatType*>(probs->data);
+    for (int64_t j = 0; j < et_len; ++j) {
+      if (data)
+        probs_data[j] = p_data[data[off+et_idx[et_offset+j]]];
+      else
+        probs_data[j] = p_data[off+et_idx[et_offset+j]];
+    }
+
+    RandomEngine::ThreadLocal()->Choice<IdxType, FloatType>(
+        num_samples[cur_et], probs, out_idx, replace);
+  }
+};
+
+template <typename IdxType, typename FloatType>
+inline SamplingRangePickFn<IdxType, FloatType> GetSamplingRangePickFn(
     const std::vector<int64_t>& num_samples, FloatArray prob, bool replace) {
-  RangePickFn<IdxType> pick_fn = [prob, num_samples, replace]
-    (IdxType off, IdxType et_offset, IdxType cur_et, IdxType et_len,
-    const std::vector<IdxType> &et_idx,
-    const IdxType* data, IdxType* out_idx) {
-      const FloatType* p_data = static_cast<FloatType*>(prob->data);
-      FloatArray probs = FloatArray::Empty({et_len}, prob->dtype, prob->ctx);
-      FloatType* probs_data = static_cast<FloatType*>(probs->data);
-      for (int64_t j = 0; j < et_len; ++j) {
-        if (data)
-          probs_data[j] = p_data[data[off+et_idx[et_offset+j]]];
-        else
-          probs_data[j] = p_data[off+et_idx[et_offset+j]];
-      }
+  return {num_samples, prob, replace};
+}
 
-      RandomEngine::ThreadLocal()->Choice<IdxType, FloatType>(
-          num_samples[cur_et], probs, out_idx, replace);
+template <typename IdxType, typename FloatType>
+struct SamplingAliasPickFn {
+  int64_t num_samples;
+  FloatArray prob;
+  bool replace;
+  const FloatType* accept_data;
+  const IdxType* alias_data;
+
+  void operator()(IdxType rowid, IdxType off, IdxType len,
+                  const IdxType* col, const IdxType* data,
+                  IdxType* out_idx) const {
+    RandomEngine* re = RandomEngine::ThreadLocal();
+    const FloatType* accept = accept_data;
+    const IdxType* alias = alias_data;
+    auto draw = [re, off, len, data, accept, alias]() {
+      const IdxType k = re->RandInt<IdxType>(len);
+      const IdxType eid = data ? data[off + k] : off + k;
+      return off + (re->Uniform<FloatType>() < accept[eid] ? k : alias[eid]);
     };
-  return pick_fn;
+    if (replace) {
+      for (int64_t j = 0; j < num_samples; ++j)
+        out_idx[j] = draw();
+      return;
+    }
+    // Redrawing the duplicates follows the distribution of the draws
+    // without replacement, as long as few of them are rejected.
+    int64_t picked = 0;
+    if (num_samples < kAliasMaxRejectionSamples && 2 * num_samples <= len) {
+      for (int64_t draws = 0;
+           picked < num_samples && draws < kAliasMaxDrawsPerSample * num_samples; ++draws) {
+        const IdxType idx = draw();
+        if (std::find(out_idx, out_idx + picked, idx) == out_idx + picked)
+          out_idx[picked++] = idx;
+      }
+    }
+    if (picked < num_samples) {
+      FloatArray prob_selected = DoubleSlice<IdxType, FloatType>(prob, data, off, len);
+      re->Choice<IdxType, FloatType>(num_samples, prob_selected, out_idx, false);
+      for (int64_t j = 0; j < num_samples; ++j) {
+        out_idx[j] += off;
+      }
+    }
+  }
+};
+
+template <typename IdxType, typename FloatType>
+inline SamplingAliasPickFn<IdxType, FloatType> GetSamplingAliasPickFn(
+    int64_t num_samples, FloatArray prob, FloatArray accept, IdArray alias, bool replace) {
+  return {num_samples, prob, replace, accept.Ptr<FloatType>(), alias.Ptr<IdxType>()};
 }
 
 template <typename IdxType>
-inline PickFn<IdxType> GetSamplingUniformPickFn(
+struct SamplingUniformPickFn {
+  int64_t num_samples;
+  bool replace;
+
+  void operator()(IdxType rowid, IdxType off, IdxType len,
+                  const IdxType* col, const IdxType* data,
+                  IdxType* out_idx) const {
+    RandomEngine::ThreadLocal()->UniformChoice<IdxType>(
+        num_samples, len, out_idx, replace);
+    for (int64_t j = 0; j < num_samples; ++j) {
+      out_idx[j] += off;
+    }
+  }
+};
+
+template <typename IdxType>
+inline SamplingUniformPickFn<IdxType> GetSamplingUniformPickFn(
     int64_t num_samples, bool replace) {
-  PickFn<IdxType> pick_fn = [num_samples, replace]
-    (IdxType rowid, IdxType off, IdxType len,
-     const IdxType* col, const IdxType* data,
-     IdxType* out_idx) {
-      RandomEngine::ThreadLocal()->UniformChoice<IdxType>(
-          num_samples, len, out_idx, replace);
-      for (int64_t j = 0; j < num_samples; ++j) {
-        out_idx[j] += off;
-      }
-    };
-  return pick_fn;
+  return {num_samples, replace};
 }
 
 template <typename IdxType>
-inline RangePickFn<IdxType> GetSamplingUniformRangePickFn(
+struct SamplingUniformRangePickFn {
+  std::vector<int64_t> num_samples;
+  bool replace;
+
+  void operator()(IdxType off, IdxType et_offset, IdxType cur_et, IdxType et_len,
+                  const std::vector<IdxType> &et_idx,
+                  const IdxType* data, IdxType* out_idx) const {
+    RandomEngine::ThreadLocal()->UniformChoice<IdxType>(
+        num_samples[cur_et], et_len, out_idx, replace);
+  }
+};
+
+template <typename IdxType>
+inline SamplingUniformRangePickFn<IdxType> GetSamplingUniformRangePickFn(
     const std::vector<int64_t>& num_samples, bool replace) {
-  RangePickFn<IdxType> pick_fn = [num_samples, replace]
-    (IdxType off, IdxType et_offset, IdxType cur_et, IdxType et_len,
-    const std::vector<IdxType> &et_idx,
-    const IdxType* data, IdxType* out_idx) {
-      RandomEngine::ThreadLocal()->UniformChoice<IdxType>(
-          num_samples[cur_et], et_len, out_idx, replace);
-    };
-  return pick_fn;
+  return {num_samples, replace};
 }
 
 template <typename IdxType, typename FloatType>
-inline PickFn<IdxType> GetSamplingBiasedPickFn(
-    int64_t num_samples, IdArray split, FloatArray bias, bool replace) {
-  PickFn<IdxType> pick_fn = [num_samples, split, bias, replace]
-    (IdxType rowid, IdxType off, IdxType len,
-     const IdxType* col, const IdxType* data,
-     IdxType* out_idx) {
+struct SamplingBiasedPickFn {
+  int64_t num_samples;
+  IdArray split;
+  FloatArray bias;
+  bool replace;
+
+  void operator()(IdxType rowid, IdxType off, IdxType len,
+                  const IdxType* col, const IdxType* data,
+                  IdxType* out_idx) const {
     const IdxType *tag_offset = static_cast<IdxType *>(split->data) + rowid * split->shape[1];
     RandomEngine::ThreadLocal()->BiasedChoice<IdxType, FloatType>(
             num_samples, tag_offset, bias, out_idx, replace);
     for (int64_t j = 0; j < num_samples; ++j) {
       out_idx[j] += off;
     }
-  };
-  return pick_fn;
+  }
+};
+
+template <typename IdxType, typename FloatType>
+inline SamplingBiasedPickFn<IdxType, FloatType> GetSamplingBiasedPickFn(
+    int64_t num_samples, IdArray split, FloatArray bias, bool replace) {
+  return {num_samples, split, bias, replace};
 }
 
 }  // namespace
@@ -122,7 +217,7 @@ COOMatrix CSRRowWiseSampling(CSRMatrix mat, IdArray rows, int64_t num_samples,
                              FloatArray prob, bool replace) {
   CHECK(prob.defined());
   auto pick_fn = GetSamplingPickFn<IdxType, FloatType>(num_samples, prob, replace);
-  return CSRRowWisePick(mat, rows, num_samples, replace, pick_fn);
+  return CSRRowWisePick<IdxType>(mat, rows, num_samples, replace, pick_fn);
 }
 
 template COOMatrix CSRRowWiseSampling<kDLCPU, int32_t, float>(
@@ -134,13 +229,101 @@ template COOMatrix CSRRowWiseSampling<kDLCPU, int32_t, double>(
 template COOMatrix CSRRowWiseSampling<kDLCPU, int64_t, double>(
     CSRMatrix, IdArray, int64_t, FloatArray, bool);
 
+template <DLDeviceType XPU, typename IdxType, typename FloatType>
+std::pair<FloatArray, IdArray> CSRRowWiseAliasTable(CSRMatrix mat, FloatArray prob) {
+  CHECK(prob.defined());
+  const int64_t num_entries = prob->shape[0];
+  const IdxType* indptr = mat.indptr.Ptr<IdxType>();
+  const IdxType* data = CSRHasData(mat) ? mat.data.Ptr<IdxType>() : nullptr;
+  const FloatType* prob_data = prob.Ptr<FloatType>();
+  FloatArray accept = FloatArray::Empty({num_entries}, prob->dtype, prob->ctx);
+  IdArray alias = NewIdArray(num_entries, prob->ctx, sizeof(IdxType) * 8);
+  FloatType* accept_data = accept.Ptr<FloatType>();
+  IdxType* alias_data = alias.Ptr<IdxType>();
+
+  // Vose's alias method on every row
+  runtime::parallel_for(0, mat.num_rows, [&](size_t b, size_t e) {
+    std::vector<double> scaled;
+    std::vector<IdxType> small, large;
+    for (size_t i = b; i < e; ++i) {
+      const IdxType off = indptr[i];
+      const IdxType len = indptr[i + 1] - off;
+      auto eid = [data, off](IdxType k) { return data ? data[off + k] : off + k; };
+      double total = 0.;
+      for (IdxType k = 0; k < len; ++k)
+        total += prob_data[eid(k)];
+      scaled.resize(len);
+      small.clear();
+      large.clear();
+      for (IdxType k = 0; k < len; ++k) {
+        // a row without weight is sampled uniformly
+        scaled[k] = total > 0. ? prob_data[eid(k)] * len / total : 1.;
+        if (scaled[k] < 1.)
+          small.push_back(k);
+        else
+          large.push_back(k);
+      }
+      while (!small.empty() && !large.empty()) {
+        const IdxType s = small.back(), l = large.back();
+        small.pop_back();
+        accept_data[eid(s)] = scaled[s];
+        alias_data[eid(s)] = l;
+        scaled[l] -= 1. - scaled[s];
+        if (scaled[l] < 1.) {
+          large.pop_back();
+          small.push_back(l);
+        }
+      }
+      // the remaining entries are at one up to the rounding errors
+      for (IdxType k : small) {
+        accept_data[eid(k)] = 1.;
+        alias_data[eid(k)] = k;
+      }
+      for (IdxType k : large) {
+        accept_data[eid(k)] = 1.;
+        alias_data[eid(k)] = k;
+      }
+    }
+  });
+  return {accept, alias};
+}
+
+template std::pair<FloatArray, IdArray> CSRRowWiseAliasTable<kDLCPU, int32_t, float>(
+    CSRMatrix, FloatArray);
+template std::pair<FloatArray, IdArray> CSRRowWiseAliasTable<kDLCPU, int64_t, float>(
+    CSRMatrix, FloatArray);
+template std::pair<FloatArray, IdArray> CSRRowWiseAliasTable<kDLCPU, int32_t, double>(
+    CSRMatrix, FloatArray);
+template std::pair<FloatArray, IdArray> CSRRowWiseAliasTable<kDLCPU, int64_t, double>(
+    CSRMatrix, FloatArray);
+
+template <DLDeviceType XPU, typename IdxType, typename FloatType>
+COOMatrix CSRRowWiseSamplingAlias(CSRMatrix mat, IdArray rows, int64_t num_samples,
+                                  FloatArray prob, FloatArray accept, IdArray alias,
+                                  bool replace) {
+  CHECK(prob.defined());
+  auto pick_fn = GetSamplingAliasPickFn<IdxType, FloatType>(
+      num_samples, prob, accept, alias, replace);
+  return CSRRowWisePick<IdxType>(mat, rows, num_samples, replace, pick_fn);
+}
+
+template COOMatrix CSRRowWiseSamplingAlias<kDLCPU, int32_t, float>(
+    CSRMatrix, IdArray, int64_t, FloatArray, FloatArray, IdArray, bool);
+template COOMatrix CSRRowWiseSamplingAlias<kDLCPU, int64_t, float>(
+    CSRMatrix, IdArray, int64_t, FloatArray, FloatArray, IdArray, bool);
+template COOMatrix CSRRowWiseSamplingAlias<kDLCPU, int32_t, double>(
+    CSRMatrix, IdArray, int64_t, FloatArray, FloatArray, IdArray, bool);
+template COOMatrix CSRRowWiseSamplingAlias<kDLCPU, int64_t, double>(
+    CSRMatrix, IdArray, int64_t, FloatArray, FloatArray, IdArray, bool);
+
 template <DLDeviceType XPU, typename IdxType, typename FloatType>
 COOMatrix CSRRowWisePerEtypeSampling(CSRMatrix mat, IdArray rows, IdArray etypes,
                                      const std::vector<int64_t>& num_samples,
                                      FloatArray prob, bool replace, bool etype_sorted) {
   CHECK(prob.defined());
   auto pick_fn = GetSamplingRangePickFn<IdxType, FloatType>(num_samples, prob, replace);
-  return CSRRowWisePerEtypePick(mat, rows, etypes, num_samples, replace, etype_sorted, pick_fn);
+  return CSRRowWisePerEtypePick<IdxType>(
+      mat, rows, etypes, num_samples, replace, etype_sorted, pick_fn);
 }
 
 template COOMatrix CSRRowWisePerEtypeSampling<kDLCPU, int32_t, float>(
@@ -156,7 +339,7 @@ template <DLDeviceType XPU, typename IdxType>
 COOMatrix CSRRowWiseSamplingUniform(CSRMatrix mat, IdArray rows,
                                     int64_t num_samples, bool replace) {
   auto pick_fn = GetSamplingUniformPickFn<IdxType>(num_samples, replace);
-  return CSRRowWisePick(mat, rows, num_samples, replace, pick_fn);
+  return CSRRowWisePick<IdxType>(mat, rows, num_samples, replace, pick_fn);
 }
 
 template COOMatrix CSRRowWiseSamplingUniform<kDLCPU, int32_t>(
@@ -164,12 +347,88 @@ template COOMatrix CSRRowWiseSamplingUniform<kDLCPU, int32_t>(
 template COOMatrix CSRRowWiseSamplingUniform<kDLCPU, int64_t>(
     CSRMatrix, IdArray, int64_t, bool);
 
+template <DLDeviceType XPU, typename IdxType>
+COOMatrix CSRRowWiseSamplingUniformWideIndptr(CSRMatrix mat, IdArray rows,
+                                              int64_t num_samples, bool replace) {
+  // The positions of the non-zeros, and thus the picked data, are int64 like the
+  // row pointers, so the result is an int64 matrix.
+  const int64_t* indptr = mat.indptr.Ptr<int64_t>();
+  const IdxType* indices = mat.indices.Ptr<IdxType>();
+  const int64_t* data = CSRHasData(mat) ? mat.data.Ptr<int64_t>() : nullptr;
+  const IdxType* rows_data = rows.Ptr<IdxType>();
+  const int64_t num_rows = rows->shape[0];
+  const auto& ctx = mat.indptr->ctx;
+  const RowStreamKey row_streams = RowStreamScope::Current();
+
+  std::vector<int64_t> pick_prefix(num_rows + 1, 0);
+  std::vector<int64_t> deg_prefix(num_rows + 1, 0);
+  runtime::parallel_for(0, num_rows, [&](size_t b, size_t e) {
+    for (size_t i = b; i < e; ++i) {
+      const int64_t len = indptr[rows_data[i] + 1] - indptr[rows_data[i]];
+      if (replace)
+        pick_prefix[i + 1] = len == 0 ? 0 : num_samples;
+      else
+        pick_prefix[i + 1] = std::min(num_samples, len);
+      deg_prefix[i + 1] = len;
+    }
+  });
+  std::partial_sum(pick_prefix.begin(), pick_prefix.end(), pick_prefix.begin());
+  std::partial_sum(deg_prefix.begin(), deg_prefix.end(), deg_prefix.begin());
+
+  const int64_t new_len = pick_prefix[num_rows];
+  IdArray picked_row = NewIdArray(new_len, ctx, 64);
+  IdArray picked_col = NewIdArray(new_len, ctx, 64);
+  IdArray picked_idx = NewIdArray(new_len, ctx, 64);
+  int64_t* picked_rdata = picked_row.Ptr<int64_t>();
+  int64_t* picked_cdata = picked_col.Ptr<int64_t>();
+  int64_t* picked_idata = picked_idx.Ptr<int64_t>();
+
+  runtime::parallel_for_weighted(0, num_rows, deg_prefix.data(), [&](size_t b, size_t e) {
+    RandomEngine* engine = RandomEngine::ThreadLocal();
+    const RandomEngine saved_engine = *engine;
+    for (size_t i = b; i < e; ++i) {
+      const int64_t rid = rows_data[i];
+      const int64_t off = indptr[rid];
+      const int64_t len = indptr[rid + 1] - off;
+      const int64_t row_offset = pick_prefix[i];
+      const int64_t num_picked = pick_prefix[i + 1] - row_offset;
+      if (num_picked == 0)
+        continue;
+      if (len <= num_samples && !replace) {
+        // nnz <= num_picks and w/o replacement, take all nnz
+        std::iota(picked_idata + row_offset, picked_idata + row_offset + len, off);
+      } else {
+        if (row_streams.enabled)
+          row_streams.Seed(engine, rid);
+        engine->UniformChoice<int64_t>(
+            num_samples, len, picked_idata + row_offset, replace);
+        for (int64_t j = 0; j < num_samples; ++j)
+          picked_idata[row_offset + j] += off;
+      }
+      for (int64_t j = row_offset; j < row_offset + num_picked; ++j) {
+        const int64_t picked = picked_idata[j];
+        picked_rdata[j] = rid;
+        picked_cdata[j] = indices[picked];
+        picked_idata[j] = data ? data[picked] : picked;
+      }
+    }
+    if (row_streams.enabled)
+      *engine = saved_engine;
+  });
+
+  return COOMatrix(mat.num_rows, mat.num_cols, picked_row, picked_col, picked_idx);
+}
+
+template COOMatrix CSRRowWiseSamplingUniformWideIndptr<kDLCPU, int32_t>(
+    CSRMatrix, IdArray, int64_t, bool);
+
 template <DLDeviceType XPU, typename IdxType>
 COOMatrix CSRRowWisePerEtypeSamplingUniform(CSRMatrix mat, IdArray rows, IdArray etypes,
                                             const std::vector<int64_t>& num_samples,
                                             bool replace, bool etype_sorted) {
   auto pick_fn = GetSamplingUniformRangePickFn<IdxType>(num_samples, replace);
-  return CSRRowWisePerEtypePick(mat, rows, etypes, num_samples, replace, etype_sorted, pick_fn);
+  return CSRRowWisePerEtypePick<IdxType>(
+      mat, rows, etypes, num_samples, replace, etype_sorted, pick_fn);
 }
 
 template COOMatrix CSRRowWisePerEtypeSamplingUniform<kDLCPU, int32_t>(
@@ -177,6 +436,219 @@ template COOMatrix CSRRowWisePerEtypeSamplingUniform<kDLCPU, int32_t>(
 template COOMatrix CSRRowWisePerEtypeSamplingUniform<kDLCPU, int64_t>(
     CSRMatrix, IdArray, IdArray, const std::vector<int64_t>&, bool, bool);
 
+template <DLDeviceType XPU, typename IdxType, typename DType>
+COOMatrix CSRRowWiseSamplingTemporal(
+    CSRMatrix mat, IdArray rows, int64_t num_samples, NDArray timestamp, IdArray order,
+    NDArray bound, bool replace) {
+  const IdxType* indptr = mat.indptr.Ptr<IdxType>();
+  const IdxType* indices = mat.indices.Ptr<IdxType>();
+  const IdxType* data = CSRHasData(mat) ? mat.data.Ptr<IdxType>() : nullptr;
+  const IdxType* rows_data = rows.Ptr<IdxType>();
+  const IdxType* order_data = order.Ptr<IdxType>();
+  const DType* ts_data = timestamp.Ptr<DType>();
+  const DType* bound_data = bound.Ptr<DType>();
+  const int64_t num_rows = rows->shape[0];
+  const auto& ctx = mat.indptr->ctx;
+  const RowStreamKey row_streams = RowStreamScope::Current();
+
+  // The entries of a row by increasing timestamp are at off + order[eid(off + j)],
+  // so the ones earlier than the bound of the row are a prefix of them whose
+  // length is found by binary search, and the samples are drawn by rank in it.
+  auto eid = [data](IdxType pos) { return data ? data[pos] : pos; };
+  auto by_rank = [eid, order_data](IdxType off, IdxType j) {
+    return off + order_data[eid(off + j)];
+  };
+  runtime::ArenaScope arena_scope;
+  IdxType* num_eligible = arena_scope.arena()->Alloc<IdxType>(num_rows);
+  int64_t* pick_prefix = arena_scope.arena()->Alloc<int64_t>(num_rows + 1);
+  pick_prefix[0] = 0;
+  runtime::parallel_for(0, num_rows, [&](size_t b, size_t e) {
+    for (size_t i = b; i < e; ++i) {
+      const IdxType off = indptr[rows_data[i]];
+      IdxType lo = 0, hi = indptr[rows_data[i] + 1] - off;
+      while (lo < hi) {
+        const IdxType mid = lo + (hi - lo) / 2;
+        if (ts_data[eid(by_rank(off, mid))] < bound_data[i])
+          lo = mid + 1;
+        else
+          hi = mid;
+      }
+      num_eligible[i] = lo;
+      if (num_samples < 0)
+        pick_prefix[i + 1] = lo;
+      else if (replace)
+        pick_prefix[i + 1] = lo == 0 ? 0 : num_samples;
+      else
+        pick_prefix[i + 1] = std::min(static_cast<int64_t>(lo), num_samples);
+    }
+  });
+  std::partial_sum(pick_prefix, pick_prefix + num_rows + 1, pick_prefix);
+
+  const int64_t new_len = pick_prefix[num_rows];
+  IdArray picked_row = NewIdArray(new_len, ctx, sizeof(IdxType) * 8);
+  IdArray picked_col = NewIdArray(new_len, ctx, sizeof(IdxType) * 8);
+  IdArray picked_idx = NewIdArray(new_len, ctx, sizeof(IdxType) * 8);
+  IdxType* picked_rdata = picked_row.Ptr<IdxType>();
+  IdxType* picked_cdata = picked_col.Ptr<IdxType>();
+  IdxType* picked_idata = picked_idx.Ptr<IdxType>();
+
+  runtime::parallel_for_weighted(0, num_rows, pick_prefix, [&](size_t b, size_t e) {
+    RandomEngine* re = RandomEngine::ThreadLocal();
+    const RandomEngine saved_engine = *re;
+    for (size_t i = b; i < e; ++i) {
+      const IdxType rid = rows_data[i];
+      const IdxType off = indptr[rid];
+      const IdxType len = num_eligible[i];
+      const int64_t row_offset = pick_prefix[i];
+      const int64_t num_picks = pick_prefix[i + 1] - row_offset;
+      IdxType* out_idx = picked_idata + row_offset;
+      if (num_picks == 0)
+        continue;
+      if (row_streams.enabled)
+        row_streams.Seed(re, rid);
+      if (num_picks == len && !replace) {
+        std::iota(out_idx, out_idx + len, 0);
+      } else if (replace) {
+        for (int64_t j = 0; j < num_picks; ++j)
+          out_idx[j] = re->RandInt<IdxType>(len);
+      } else {
+        re->UniformChoice<IdxType>(num_picks, len, out_idx, false);
+      }
+      for (int64_t j = 0; j < num_picks; ++j) {
+        const IdxType picked = by_rank(off, out_idx[j]);
+        picked_rdata[row_offset + j] = rid;
+        picked_cdata[row_offset + j] = indices[picked];
+        picked_idata[row_offset + j] = eid(picked);
+      }
+    }
+    if (row_streams.enabled)
+      *re = saved_engine;
+  });
+
+  return COOMatrix(mat.num_rows, mat.num_cols, picked_row, picked_col, picked_idx);
+}
+
+template COOMatrix CSRRowWiseSamplingTemporal<kDLCPU, int32_t, int32_t>(
+    CSRMatrix, IdArray, int64_t, NDArray, IdArray, NDArray, bool);
+template COOMatrix CSRRowWiseSamplingTemporal<kDLCPU, int64_t, int32_t>(
+    CSRMatrix, IdArray, int64_t, NDArray, IdArray, NDArray, bool);
+template COOMatrix CSRRowWiseSamplingTemporal<kDLCPU, int32_t, int64_t>(
+    CSRMatrix, IdArray, int64_t, NDArray, IdArray, NDArray, bool);
+template COOMatrix CSRRowWiseSamplingTemporal<kDLCPU, int64_t, int64_t>(
+    CSRMatrix, IdArray, int64_t, NDArray, IdArray, NDArray, bool);
+template COOMatrix CSRRowWiseSamplingTemporal<kDLCPU, int32_t, float>(
+    CSRMatrix, IdArray, int64_t, NDArray, IdArray, NDArray, bool);
+template COOMatrix CSRRowWiseSamplingTemporal<kDLCPU, int64_t, float>(
+    CSRMatrix, IdArray, int64_t, NDArray, IdArray, NDArray, bool);
+template COOMatrix CSRRowWiseSamplingTemporal<kDLCPU, int32_t, double>(
+    CSRMatrix, IdArray, int64_t, NDArray, IdArray, NDArray, bool);
+template COOMatrix CSRRowWiseSamplingTemporal<kDLCPU, int64_t, double>(
+    CSRMatrix, IdArray, int64_t, NDArray, IdArray, NDArray, bool);
+
+template <DLDeviceType XPU, typename IdxType, typename FloatType>
+COOMatrix CSRRowWiseSamplingMasked(
+    CSRMatrix mat, IdArray rows, int64_t num_samples, NDArray mask, FloatArray prob,
+    bool replace) {
+  const IdxType* indptr = mat.indptr.Ptr<IdxType>();
+  const IdxType* indices = mat.indices.Ptr<IdxType>();
+  const IdxType* data = CSRHasData(mat) ? mat.data.Ptr<IdxType>() : nullptr;
+  const IdxType* rows_data = rows.Ptr<IdxType>();
+  const int8_t* mask_data = static_cast<const int8_t*>(mask->data);
+  const FloatType* prob_data = IsNullArray(prob) ? nullptr : prob.Ptr<FloatType>();
+  const int64_t num_rows = rows->shape[0];
+  const auto& ctx = mat.indptr->ctx;
+  const RowStreamKey row_streams = RowStreamScope::Current();
+
+  // The entries left by the mask are counted in a first pass over the rows,
+  // which sizes the result, and gathered again in the second one to sample
+  // from them as from a row of their own.
+  auto eid = [data](IdxType pos) { return data ? data[pos] : pos; };
+  runtime::ArenaScope arena_scope;
+  IdxType* num_eligible = arena_scope.arena()->Alloc<IdxType>(num_rows);
+  int64_t* pick_prefix = arena_scope.arena()->Alloc<int64_t>(num_rows + 1);
+  int64_t* deg_prefix = arena_scope.arena()->Alloc<int64_t>(num_rows + 1);
+  pick_prefix[0] = 0;
+  deg_prefix[0] = 0;
+  runtime::parallel_for(0, num_rows, [&](size_t b, size_t e) {
+    for (size_t i = b; i < e; ++i) {
+      const IdxType rid = rows_data[i];
+      IdxType len = 0;
+      for (IdxType pos = indptr[rid]; pos < indptr[rid + 1]; ++pos)
+        len += mask_data[eid(pos)] != 0;
+      num_eligible[i] = len;
+      if (num_samples < 0)
+        pick_prefix[i + 1] = len;
+      else if (replace)
+        pick_prefix[i + 1] = len == 0 ? 0 : num_samples;
+      else
+        pick_prefix[i + 1] = std::min(static_cast<int64_t>(len), num_samples);
+      deg_prefix[i + 1] = indptr[rid + 1] - indptr[rid];
+    }
+  });
+  std::partial_sum(pick_prefix, pick_prefix + num_rows + 1, pick_prefix);
+  std::partial_sum(deg_prefix, deg_prefix + num_rows + 1, deg_prefix);
+
+  const int64_t new_len = pick_prefix[num_rows];
+  IdArray picked_row = NewIdArray(new_len, ctx, sizeof(IdxType) * 8);
+  IdArray picked_col = NewIdArray(new_len, ctx, sizeof(IdxType) * 8);
+  IdArray picked_idx = NewIdArray(new_len, ctx, sizeof(IdxType) * 8);
+  IdxType* picked_rdata = picked_row.Ptr<IdxType>();
+  IdxType* picked_cdata = picked_col.Ptr<IdxType>();
+  IdxType* picked_idata = picked_idx.Ptr<IdxType>();
+
+  runtime::parallel_for_weighted(0, num_rows, deg_prefix, [&](size_t b, size_t e) {
+    RandomEngine* re = RandomEngine::ThreadLocal();
+    const RandomEngine saved_engine = *re;
+    std::vector<IdxType> eligible;
+    for (size_t i = b; i < e; ++i) {
+      const IdxType rid = rows_data[i];
+      const IdxType len = num_eligible[i];
+      const int64_t row_offset = pick_prefix[i];
+      const int64_t num_picks = pick_prefix[i + 1] - row_offset;
+      IdxType* out_idx = picked_idata + row_offset;
+      if (num_picks == 0)
+        continue;
+      eligible.clear();
+      for (IdxType pos = indptr[rid]; pos < indptr[rid + 1]; ++pos) {
+        if (mask_data[eid(pos)] != 0)
+          eligible.push_back(pos);
+      }
+      if (row_streams.enabled)
+        row_streams.Seed(re, rid);
+      if (num_samples < 0 || (num_picks == len && !replace)) {
+        std::iota(out_idx, out_idx + len, 0);
+      } else if (prob_data) {
+        FloatArray prob_selected = FloatArray::Empty({len}, prob->dtype, ctx);
+        FloatType* prob_selected_data = prob_selected.Ptr<FloatType>();
+        for (IdxType j = 0; j < len; ++j)
+          prob_selected_data[j] = prob_data[eid(eligible[j])];
+        re->Choice<IdxType, FloatType>(num_picks, prob_selected, out_idx, replace);
+      } else {
+        re->UniformChoice<IdxType>(num_picks, len, out_idx, replace);
+      }
+      for (int64_t j = 0; j < num_picks; ++j) {
+        const IdxType picked = eligible[out_idx[j]];
+        picked_rdata[row_offset + j] = rid;
+        picked_cdata[row_offset + j] = indices[picked];
+        picked_idata[row_offset + j] = eid(picked);
+      }
+    }
+    if (row_streams.enabled)
+      *re = saved_engine;
+  });
+
+  return COOMatrix(mat.num_rows, mat.num_cols, picked_row, picked_col, picked_idx);
+}
+
+template COOMatrix CSRRowWiseSamplingMasked<kDLCPU, int32_t, float>(
+    CSRMatrix, IdArray, int64_t, NDArray, FloatArray, bool);
+template COOMatrix CSRRowWiseSamplingMasked<kDLCPU, int64_t, float>(
+    CSRMatrix, IdArray, int64_t, NDArray, FloatArray, bool);
+template COOMatrix CSRRowWiseSamplingMasked<kDLCPU, int32_t, double>(
+    CSRMatrix, IdArray, int64_t, NDArray, FloatArray, bool);
+template COOMatrix CSRRowWiseSamplingMasked<kDLCPU, int64_t, double>(
+    CSRMatrix, IdArray, int64_t, NDArray, FloatArray, bool);
+
 template <DLDeviceType XPU, typename IdxType, typename FloatType>
 COOMatrix CSRRowWiseSamplingBiased(
     CSRMatrix mat,
@@ -188,7 +660,7 @@ COOMatrix CSRRowWiseSamplingBiased(
 ) {
   auto pick_fn = GetSamplingBiasedPickFn<IdxType, FloatType>(
       num_samples, tag_offset, bias, replace);
-  return CSRRowWisePick(mat, rows, num_samples, replace, pick_fn);
+  return CSRRowWisePick<IdxType>(mat, rows, num_samples, replace, pick_fn);
 }
 
 template COOMatrix CSRRowWiseSamplingBiased<kDLCPU, int32_t, float>(
@@ -211,7 +683,7 @@ COOMatrix COORowWiseSampling(COOMatrix mat, IdArray rows, int64_t num_samples,
                              FloatArray prob, bool replace) {
   CHECK(prob.defined());
   auto pick_fn = GetSamplingPickFn<IdxType, FloatType>(num_samples, prob, replace);
-  return COORowWisePick(mat, rows, num_samples, replace, pick_fn);
+  return COORowWisePick<IdxType>(mat, rows, num_samples, replace, pick_fn);
 }
 
 template COOMatrix COORowWiseSampling<kDLCPU, int32_t, float>(
@@ -229,7 +701,8 @@ COOMatrix COORowWisePerEtypeSampling(COOMatrix mat, IdArray rows, IdArray etypes
                                      FloatArray prob, bool replace, bool etype_sorted) {
   CHECK(prob.defined());
   auto pick_fn = GetSamplingRangePickFn<IdxType, FloatType>(num_samples, prob, replace);
-  return COORowWisePerEtypePick(mat, rows, etypes, num_samples, replace, etype_sorted, pick_fn);
+  return COORowWisePerEtypePick<IdxType>(
+      mat, rows, etypes, num_samples, replace, etype_sorted, pick_fn);
 }
 
 template COOMatrix COORowWisePerEtypeSampling<kDLCPU, int32_t, float>(
@@ -245,7 +718,7 @@ template <DLDeviceType XPU, typename IdxType>
 COOMatrix COORowWiseSamplingUniform(COOMatrix mat, IdArray rows,
                                     int64_t num_samples, bool replace) {
   auto pick_fn = GetSamplingUniformPickFn<IdxType>(num_samples, replace);
-  return COORowWisePick(mat, rows, num_samples, replace, pick_fn);
+  return COORowWisePick<IdxType>(mat, rows, num_samples, replace, pick_fn);
 }
 
 template COOMatrix COORowWiseSamplingUniform<kDLCPU, int32_t>(
@@ -258,7 +731,8 @@ COOMatrix COORowWisePerEtypeSamplingUniform(COOMatrix mat, IdArray rows, IdArray
                                     const std::vector<int64_t>& num_samples,
                                     bool replace, bool etype_sorted) {
   auto pick_fn = GetSamplingUniformRangePickFn<IdxType>(num_samples, replace);
-  return COORowWisePerEtypePick(mat, rows, etypes, num_samples, replace, etype_sorted, pick_fn);
+  return COORowWisePerEtypePick<IdxType>(
+      mat, rows, etypes, num_samples, replace, etype_sorted, pick_fn);
 }
 
 template COOMatrix COORowWisePerEtypeSamplingUniform<kDLCPU, int32_t>(
@@ -3,54 +3,116 @@
  * \file array/cpu/rowwise_topk.cc
  * \brief rowwise topk
  */
+#include <dgl/runtime/parallel_for.h>
 #include <numeric>
 #include <algorithm>
 #include "./rowwise_pick.h"
+#include "../../runtime/arena.h"
 
 namespace dgl {
 namespace aten {
 namespace impl {
 namespace {
 
+/*!
+ * \brief Up to this many entries are selected with a heap of size k scanning
+ *        the row; larger selections partition a copy of the row instead.
+ */
+constexpr int64_t kTopkHeapMaxK = 32;
+
+/*!
+ * \brief The comparator ordering the positions of the entries by weight, the
+ *        ties being broken by position so that the selection is deterministic.
+ */
 template <typename IdxType, typename DType>
-inline PickFn<IdxType> GetTopkPickFn(int64_t k, NDArray weight, bool ascending) {
-  const DType* wdata = static_cast<DType*>(weight->data);
-  PickFn<IdxType> pick_fn = [k, ascending, wdata]
-    (IdxType rowid, IdxType off, IdxType len,
-     const IdxType* col, const IdxType* data,
-     IdxType* out_idx) {
-      std::function<bool(IdxType, IdxType)> compare_fn;
-      if (ascending) {
-        if (data) {
-          compare_fn = [wdata, data] (IdxType i, IdxType j) {
-              return wdata[data[i]] < wdata[data[j]];
-            };
-        } else {
-          compare_fn = [wdata] (IdxType i, IdxType j) {
-              return wdata[i] < wdata[j];
-            };
-        }
-      } else {
-        if (data) {
-          compare_fn = [wdata, data] (IdxType i, IdxType j) {
-              return wdata[data[i]] > wdata[data[j]];
-            };
-        } else {
-          compare_fn = [wdata] (IdxType i, IdxType j) {
-              return wdata[i] > wdata[j];
-            };
-        }
-      }
+struct TopkCompareFn {
+  const DType* wdata;
+  const IdxType* data;
+  bool ascending;
+
+  bool operator()(IdxType i, IdxType j) const {
+    const DType wi = wdata[data ? data[i] : i];
+    const DType wj = wdata[data ? data[j] : j];
+    if (wi != wj)
+      return ascending ? wi < wj : wi > wj;
+    return i < j;
+  }
+};
 
-      std::vector<IdxType> idx(len);
-      std::iota(idx.begin(), idx.end(), off);
-      std::sort(idx.begin(), idx.end(), compare_fn);
-      for (int64_t j = 0; j < k; ++j) {
-        out_idx[j] = idx[j];
+template <typename IdxType, typename DType>
+inline TopkCompareFn<IdxType, DType> GetTopkCompareFn(
+    const DType* wdata, const IdxType* data, bool ascending) {
+  return {wdata, data, ascending};
+}
+
+/*!
+ * \brief Write the positions of the k first entries of [off, off + len) in the
+ *        order of less to out, from the first one. Runs in O(len log k) for small
+ *        k and O(len + k log k) otherwise, rather than sorting the whole row.
+ */
+template <typename IdxType, typename CompareFn>
+inline void SelectTopk(int64_t k, IdxType off, IdxType len, const CompareFn& less,
+                       IdxType* out_idx) {
+  if (k <= kTopkHeapMaxK) {
+    // out_idx is a heap of the best entries so far, topped by the worst one
+    std::iota(out_idx, out_idx + k, off);
+    std::make_heap(out_idx, out_idx + k, less);
+    for (IdxType i = off + k; i < off + len; ++i) {
+      if (less(i, out_idx[0])) {
+        std::pop_heap(out_idx, out_idx + k, less);
+        out_idx[k - 1] = i;
+        std::push_heap(out_idx, out_idx + k, less);
       }
-    };
+    }
+    std::sort_heap(out_idx, out_idx + k, less);
+  } else {
+    runtime::ArenaScope arena_scope;
+    IdxType* idx = arena_scope.arena()->Alloc<IdxType>(len);
+    std::iota(idx, idx + len, off);
+    std::nth_element(idx, idx + k, idx + len, less);
+    std::sort(idx, idx + k, less);
+    std::copy(idx, idx + k, out_idx);
+  }
+}
+
+template <typename IdxType, typename DType>
+struct TopkPickFn {
+  int64_t k;
+  bool ascending;
+  const DType* wdata;
 
-  return pick_fn;
+  void operator()(IdxType rowid, IdxType off, IdxType len,
+                  const IdxType* col, const IdxType* data,
+                  IdxType* out_idx) const {
+    // the picker takes all the entries of the rows having at most k of them
+    SelectTopk<IdxType>(k, off, len, GetTopkCompareFn<IdxType, DType>(wdata, data, ascending),
+                        out_idx);
+  }
+};
+
+template <typename IdxType, typename DType>
+inline TopkPickFn<IdxType, DType> GetTopkPickFn(int64_t k, NDArray weight, bool ascending) {
+  return {k, ascending, static_cast<DType*>(weight->data)};
+}
+
+template <typename IdxType>
+struct TopkOrderPickFn {
+  int64_t k;
+  const IdxType* order_data;
+
+  void operator()(IdxType rowid, IdxType off, IdxType len,
+                  const IdxType* col, const IdxType* data,
+                  IdxType* out_idx) const {
+    for (int64_t j = 0; j < k; ++j) {
+      const IdxType pos = off + j;
+      out_idx[j] = off + order_data[data ? data[pos] : pos];
+    }
+  }
+};
+
+template <typename IdxType>
+inline TopkOrderPickFn<IdxType> GetTopkOrderPickFn(int64_t k, IdArray order) {
+  return {k, order.Ptr<IdxType>()};
 }
 
 }  // namespace
@@ -59,7 +121,7 @@ template <DLDeviceType XPU, typename IdxType, typename DType>
 COOMatrix CSRRowWiseTopk(
     CSRMatrix mat, IdArray rows, int64_t k, NDArray weight, bool ascending) {
   auto pick_fn = GetTopkPickFn<IdxType, DType>(k, weight, ascending);
-  return CSRRowWisePick(mat, rows, k, false, pick_fn);
+  return CSRRowWisePick<IdxType>(mat, rows, k, false, pick_fn);
 }
 
 template COOMatrix CSRRowWiseTopk<kDLCPU, int32_t, int32_t>(
@@ -79,11 +141,54 @@ template COOMatrix CSRRowWiseTopk<kDLCPU, int32_t, double>(
 template COOMatrix CSRRowWiseTopk<kDLCPU, int64_t, double>(
     CSRMatrix, IdArray, int64_t, NDArray, bool);
 
+template <DLDeviceType XPU, typename IdxType, typename DType>
+IdArray CSRRowWiseTopkOrder(CSRMatrix mat, NDArray weight, bool ascending) {
+  const int64_t num_entries = weight->shape[0];
+  const IdxType* indptr = mat.indptr.Ptr<IdxType>();
+  const IdxType* data = CSRHasData(mat) ? mat.data.Ptr<IdxType>() : nullptr;
+  const DType* wdata = static_cast<DType*>(weight->data);
+  IdArray order = NewIdArray(num_entries, weight->ctx, sizeof(IdxType) * 8);
+  IdxType* order_data = order.Ptr<IdxType>();
+  const auto less = GetTopkCompareFn<IdxType, DType>(wdata, data, ascending);
+
+  runtime::parallel_for(0, mat.num_rows, [&](size_t b, size_t e) {
+    for (size_t i = b; i < e; ++i) {
+      const IdxType off = indptr[i];
+      const IdxType len = indptr[i + 1] - off;
+      runtime::ArenaScope arena_scope;
+      IdxType* idx = arena_scope.arena()->Alloc<IdxType>(len);
+      std::iota(idx, idx + len, off);
+      std::sort(idx, idx + len, less);
+      for (IdxType j = 0; j < len; ++j)
+        order_data[data ? data[off + j] : off + j] = idx[j] - off;
+    }
+  });
+  return order;
+}
+
+template IdArray CSRRowWiseTopkOrder<kDLCPU, int32_t, int32_t>(CSRMatrix, NDArray, bool);
+template IdArray CSRRowWiseTopkOrder<kDLCPU, int64_t, int32_t>(CSRMatrix, NDArray, bool);
+template IdArray CSRRowWiseTopkOrder<kDLCPU, int32_t, int64_t>(CSRMatrix, NDArray, bool);
+template IdArray CSRRowWiseTopkOrder<kDLCPU, int64_t, int64_t>(CSRMatrix, NDArray, bool);
+template IdArray CSRRowWiseTopkOrder<kDLCPU, int32_t, float>(CSRMatrix, NDArray, bool);
+template IdArray CSRRowWiseTopkOrder<kDLCPU, int64_t, float>(CSRMatrix, NDArray, bool);
+template IdArray CSRRowWiseTopkOrder<kDLCPU, int32_t, double>(CSRMatrix, NDArray, bool);
+template IdArray CSRRowWiseTopkOrder<kDLCPU, int64_t, double>(CSRMatrix, NDArray, bool);
+
+template <DLDeviceType XPU, typename IdxType>
+COOMatrix CSRRowWiseTopkOrdered(CSRMatrix mat, IdArray rows, int64_t k, IdArray order) {
+  auto pick_fn = GetTopkOrderPickFn<IdxType>(k, order);
+  return CSRRowWisePick<IdxType>(mat, rows, k, false, pick_fn);
+}
+
+template COOMatrix CSRRowWiseTopkOrdered<kDLCPU, int32_t>(CSRMatrix, IdArray, int64_t, IdArray);
+template COOMatrix CSRRowWiseTopkOrdered<kDLCPU, int64_t>(CSRMatrix, IdArray, int64_t, IdArray);
+
 template <DLDeviceType XPU, typename IdxType, typename DType>
 COOMatrix COORowWiseTopk(
     COOMatrix mat, IdArray rows, int64_t k, NDArray weight, bool ascending) {
   auto pick_fn = GetTopkPickFn<IdxType, DType>(k, weight, ascending);
-  return COORowWisePick(mat, rows, k, false, pick_fn);
+  return COORowWisePick<IdxType>(mat, rows, k, false, pick_fn);
 }
 
 template COOMatrix COORowWiseTopk<kDLCPU, int32_t, int32_t>(
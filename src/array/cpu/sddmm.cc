@@ -43,7 +43,7 @@ namespace aten {
 
 #define SWITCH_BITS(bits, DType, ...)                           \
   do {                                                          \
-    if ((bits) == 16 || (bits) == 32) {                         \
+    if ((bits) == 32) {                                         \
       typedef float DType;                                      \
       { __VA_ARGS__ }                                           \
     } else if ((bits) == 64) {                                  \
@@ -54,6 +54,57 @@ namespace aten {
     }                                                           \
   } while (0)
 
+namespace {
+
+/*!
+ * \brief Generalized SDDMM on Csr format with float16 or bfloat16 features.
+ * \note The operators compute and accumulate in float.
+ */
+template <typename IdType>
+void SDDMMCsrFloat16(const std::string& op,
+                     const BcastOff& bcast,
+                     const CSRMatrix& csr,
+                     NDArray lhs,
+                     NDArray rhs,
+                     NDArray out,
+                     int lhs_target,
+                     int rhs_target) {
+  typedef float DType;
+  SWITCH_FLOAT16_TYPE(out->dtype, Float16Type, {
+    SWITCH_OP(op, Op, {
+      SWITCH_TARGET(lhs_target, rhs_target, LhsTarget, RhsTarget, {
+        cpu::SDDMMCsrFloat16<IdType, Float16Type, Op, LhsTarget, RhsTarget>(
+            bcast, csr, lhs, rhs, out);
+      });
+    });
+  });
+}
+
+/*!
+ * \brief Generalized SDDMM on Coo format with float16 or bfloat16 features.
+ * \note The operators compute and accumulate in float.
+ */
+template <typename IdType>
+void SDDMMCooFloat16(const std::string& op,
+                     const BcastOff& bcast,
+                     const COOMatrix& coo,
+                     NDArray lhs,
+                     NDArray rhs,
+                     NDArray out,
+                     int lhs_target,
+                     int rhs_target) {
+  typedef float DType;
+  SWITCH_FLOAT16_TYPE(out->dtype, Float16Type, {
+    SWITCH_OP(op, Op, {
+      SWITCH_TARGET(lhs_target, rhs_target, LhsTarget, RhsTarget, {
+        cpu::SDDMMCooFloat16<IdType, Float16Type, Op, LhsTarget, RhsTarget>(
+            bcast, coo, lhs, rhs, out);
+      });
+    });
+  });
+}
+
+}  // namespace
 
 /*! \brief Generalized SDDMM on Csr format. */
 template <int XPU, typename IdType, int bits>
@@ -65,6 +116,10 @@ void SDDMMCsr(const std::string& op,
               NDArray out,
               int lhs_target,
               int rhs_target) {
+  if (bits == 16) {
+    SDDMMCsrFloat16<IdType>(op, bcast, csr, lhs, rhs, out, lhs_target, rhs_target);
+    return;
+  }
   SWITCH_BITS(bits, DType, {
     SWITCH_OP(op, Op, {
       SWITCH_TARGET(lhs_target, rhs_target, LhsTarget, RhsTarget, {
@@ -86,6 +141,14 @@ void SDDMMCsrHetero(const std::string& op,
               int rhs_target,
               const std::vector<dgl_type_t>& lhs_nid,
               const std::vector<dgl_type_t>& rhs_nid) {
+  if (bits == 16) {
+    for (dgl_type_t etype = 0; etype < lhs_nid.size(); ++etype) {
+      SDDMMCsrFloat16<IdType>(op, bcast, vec_csr[etype], vec_lhs[lhs_nid[etype]],
+                             vec_rhs[rhs_nid[etype]], vec_out[etype],
+                             lhs_target, rhs_target);
+    }
+    return;
+  }
   SWITCH_BITS(bits, DType, {
     SWITCH_OP(op, Op, {
       SWITCH_TARGET(lhs_target, rhs_target, LhsTarget, RhsTarget, {
@@ -180,6 +243,10 @@ void SDDMMCoo(const std::string& op,
               NDArray out,
               int lhs_target,
               int rhs_target) {
+  if (bits == 16) {
+    SDDMMCooFloat16<IdType>(op, bcast, coo, lhs, rhs, out, lhs_target, rhs_target);
+    return;
+  }
   SWITCH_BITS(bits, DType, {
     SWITCH_OP(op, Op, {
       SWITCH_TARGET(lhs_target, rhs_target, LhsTarget, RhsTarget, {
@@ -201,6 +268,14 @@ void SDDMMCooHetero(const std::string& op,
               int rhs_target,
               const std::vector<dgl_type_t>& lhs_nid,
               const std::vector<dgl_type_t>& rhs_nid) {
+  if (bits == 16) {
+    for (dgl_type_t etype = 0; etype < lhs_nid.size(); ++etype) {
+      SDDMMCooFloat16<IdType>(op, bcast, vec_coo[etype], vec_lhs[lhs_nid[etype]],
+                             vec_rhs[rhs_nid[etype]], vec_out[etype],
+                             lhs_target, rhs_target);
+    }
+    return;
+  }
   SWITCH_BITS(bits, DType, {
     SWITCH_OP(op, Op, {
       SWITCH_TARGET(lhs_target, rhs_target, LhsTarget, RhsTarget, {
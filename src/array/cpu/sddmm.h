@@ -9,12 +9,136 @@
 #include <dgl/array.h>
 #include <dgl/bcast.h>
 #include <dgl/runtime/parallel_for.h>
+#include <algorithm>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
 #include "../selector.h"
+#include "./float16.h"
+#if !defined(_WIN32)
+#ifdef USE_AVX
+#include "intel/cpu_dot.h"
+#endif  // USE_AVX
+#endif  // _WIN32
 
 namespace dgl {
 namespace aten {
 namespace cpu {
 
+namespace op {
+template <typename DType> struct Dot;
+}  // namespace op
+
+/*! \brief Columns of a tile hold at most this many bytes of the column operand. */
+#define SDDMM_TILE_BYTES (256 * 1024)
+/*! \brief The tiled kernel buckets at most this many edges at a time. */
+#define SDDMM_TILE_MAX_EDGES 65536
+
+template <typename DType>
+using DotFunc = DType (*)(const DType*, const DType*, int64_t);
+
+/*!
+ * \brief Get the SIMD dot product kernel for Op.
+ * \param reduce_size The length of the dot products.
+ * \return The kernel, or nullptr if Op is not a dot product, the kernel is not
+ *         available on this machine, or the vectors are too short for it to pay off.
+ */
+template <typename DType, typename Op>
+DotFunc<DType> SDDMMDotKernel(int64_t reduce_size) {
+#if !defined(_WIN32)
+#ifdef USE_AVX
+  if (std::is_same<Op, op::Dot<DType>>::value && reduce_size > 16) {
+    typedef dgl::ElemWiseDot<DType> DotKernel;
+    /* Prepare an assembler kernel */
+    static std::unique_ptr<DotKernel> asm_kernel_ptr(
+        (dgl::IntelKernel<>::IsEnabled()) ? new DotKernel() : nullptr);
+    if (asm_kernel_ptr && asm_kernel_ptr->applicable())
+      return asm_kernel_ptr->func();
+  }
+#endif  // USE_AVX
+#endif  // _WIN32
+  return nullptr;
+}
+
+/*!
+ * \brief Compute the result of g-SDDMM on one edge.
+ * \param dot The SIMD dot product kernel, nullptr to use Op::Call.
+ */
+template <typename IdType, typename DType, typename Op,
+          int LhsTarget, int RhsTarget>
+inline void SDDMMEdge(const BcastOff& bcast, IdType rid, IdType eid, IdType cid,
+                      const DType* X, const DType* Y, DType* O, DotFunc<DType> dot) {
+  const int64_t dim = bcast.out_len,
+                lhs_dim = bcast.lhs_len,
+                rhs_dim = bcast.rhs_len,
+                reduce_size = bcast.reduce_size;
+  DType* out_off = O + eid * dim;
+  for (int64_t k = 0; k < dim; ++k) {
+    const int64_t lhs_add = bcast.use_bcast ? bcast.lhs_offset[k] : k;
+    const int64_t rhs_add = bcast.use_bcast ? bcast.rhs_offset[k] : k;
+    const DType* lhs_off = Op::use_lhs
+      ? X + Selector<LhsTarget>::Call(rid, eid, cid) * lhs_dim + lhs_add * reduce_size
+      : nullptr;
+    const DType* rhs_off = Op::use_rhs
+      ? Y + Selector<RhsTarget>::Call(rid, eid, cid) * rhs_dim + rhs_add * reduce_size
+      : nullptr;
+    out_off[k] = dot ? dot(lhs_off, rhs_off, reduce_size)
+                     : Op::Call(lhs_off, rhs_off, reduce_size);
+  }
+}
+
+/*!
+ * \brief CPU kernel of g-SDDMM on Csr format, tiled along the columns.
+ *
+ * The edges of a group of rows are bucketed by column tile and processed tile
+ * by tile, so that the rows of the operand indexed by column (usually the
+ * destination node feature) stay in cache across all the edges incident to
+ * them, instead of being fetched at random for every edge.
+ *
+ * \param tile_size The number of columns of a tile.
+ */
+template <typename IdType, typename DType, typename Op,
+          int LhsTarget, int RhsTarget>
+void SDDMMCsrTiled(const BcastOff& bcast,
+                   const CSRMatrix& csr,
+                   const DType* X, const DType* Y, DType* O,
+                   int64_t tile_size, DotFunc<DType> dot) {
+  const bool has_idx = !IsNullArray(csr.data);
+  const IdType* indptr = csr.indptr.Ptr<IdType>();
+  const IdType* indices = csr.indices.Ptr<IdType>();
+  const IdType* edges = csr.data.Ptr<IdType>();
+  const int64_t num_tiles = (csr.num_cols + tile_size - 1) / tile_size;
+  runtime::parallel_for_weighted(0, csr.num_rows, indptr, [=](IdType b, IdType e) {
+    std::vector<int64_t> tile_offset(num_tiles + 1);
+    std::vector<std::pair<IdType, IdType>> bucket;  // (row, position) of the edges
+    for (IdType r0 = b; r0 < e; ) {
+      // rows [r0, r1) hold at most SDDMM_TILE_MAX_EDGES edges, or a single row
+      IdType r1 = r0 + 1;
+      while (r1 < e && indptr[r1 + 1] - indptr[r0] <= SDDMM_TILE_MAX_EDGES)
+        ++r1;
+      const IdType nnz = indptr[r1] - indptr[r0];
+      std::fill(tile_offset.begin(), tile_offset.end(), 0);
+      for (IdType j = indptr[r0]; j < indptr[r1]; ++j)
+        ++tile_offset[indices[j] / tile_size + 1];
+      for (int64_t t = 0; t < num_tiles; ++t)
+        tile_offset[t + 1] += tile_offset[t];
+      bucket.resize(nnz);
+      for (IdType rid = r0; rid < r1; ++rid)
+        for (IdType j = indptr[rid]; j < indptr[rid + 1]; ++j)
+          bucket[tile_offset[indices[j] / tile_size]++] = {rid, j};
+      // tile_offset[t] is now the end of tile t, i.e. the start of tile t + 1
+      for (const auto& edge : bucket) {
+        const IdType rid = edge.first, j = edge.second;
+        const IdType eid = has_idx ? edges[j] : j;
+        SDDMMEdge<IdType, DType, Op, LhsTarget, RhsTarget>(
+            bcast, rid, eid, indices[j], X, Y, O, dot);
+      }
+      r0 = r1;
+    }
+  });
+}
+
 /*!
  * \brief CPU kernel of g-SDDMM on Csr format.
  * \param bcast Broadcast information.
@@ -23,7 +147,9 @@ namespace cpu {
  * \param rhs The right hand size operand feature.
  * \param out The result feature on edges.
  * \note it uses node parallel strategy, different threads are responsible
- *       for the computation of different nodes.
+ *       for the computation of different nodes. When the operand indexed by
+ *       column does not fit in cache, the columns are tiled (see SDDMMCsrTiled).
+ *       Dot products use a SIMD kernel when available.
  */
 template <typename IdType, typename DType, typename Op,
           int LhsTarget = 0, int RhsTarget = 2>
@@ -36,29 +162,30 @@ void SDDMMCsr(const BcastOff& bcast,
   const IdType* edges = csr.data.Ptr<IdType>();
   const DType* X = lhs.Ptr<DType>();
   const DType* Y = rhs.Ptr<DType>();
-  const int64_t dim = bcast.out_len,
-                lhs_dim = bcast.lhs_len,
-                rhs_dim = bcast.rhs_len,
-                reduce_size = bcast.reduce_size;
   DType* O = out.Ptr<DType>();
-  runtime::parallel_for(0, csr.num_rows, [=](IdType b, IdType e) {
+  const DotFunc<DType> dot = SDDMMDotKernel<DType, Op>(bcast.reduce_size);
+
+  // bytes of the operand rows gathered by column
+  int64_t col_row_bytes = 0;
+  if (Op::use_lhs && LhsTarget == 2)
+    col_row_bytes += bcast.lhs_len * sizeof(DType);
+  if (Op::use_rhs && RhsTarget == 2)
+    col_row_bytes += bcast.rhs_len * sizeof(DType);
+  if (col_row_bytes > 0 && csr.num_cols * col_row_bytes > SDDMM_TILE_BYTES) {
+    const int64_t tile_size = std::max<int64_t>(1, SDDMM_TILE_BYTES / col_row_bytes);
+    SDDMMCsrTiled<IdType, DType, Op, LhsTarget, RhsTarget>(
+        bcast, csr, X, Y, O, tile_size, dot);
+    return;
+  }
+
+  runtime::parallel_for_weighted(0, csr.num_rows, indptr, [=](IdType b, IdType e) {
     for (auto rid = b; rid < e; ++rid) {
       const IdType row_start = indptr[rid], row_end = indptr[rid + 1];
       for (IdType j = row_start; j < row_end; ++j) {
         const IdType cid = indices[j];
         const IdType eid = has_idx? edges[j] : j;
-        DType* out_off = O + eid * dim;
-        for (int64_t k = 0; k < dim; ++k) {
-          const int64_t lhs_add = bcast.use_bcast ? bcast.lhs_offset[k] : k;
-          const int64_t rhs_add = bcast.use_bcast ? bcast.rhs_offset[k] : k;
-          const DType* lhs_off = Op::use_lhs
-            ? X + Selector<LhsTarget>::Call(rid, eid, cid) * lhs_dim + lhs_add * reduce_size
-            : nullptr;
-          const DType* rhs_off = Op::use_rhs
-            ? Y + Selector<RhsTarget>::Call(rid, eid, cid) * rhs_dim + rhs_add * reduce_size
-            : nullptr;
-          out_off[k] = Op::Call(lhs_off, rhs_off, reduce_size);
-        }
+        SDDMMEdge<IdType, DType, Op, LhsTarget, RhsTarget>(
+            bcast, rid, eid, cid, X, Y, O, dot);
       }
     }
   });
@@ -72,7 +199,8 @@ void SDDMMCsr(const BcastOff& bcast,
  * \param rhs The right hand size operand feature.
  * \param out The result feature on edges.
  * \note it uses edge parallel strategy, different threads are responsible
- *       for the computation of different edges.
+ *       for the computation of different edges. Dot products use a SIMD
+ *       kernel when available.
  */
 template <typename IdType, typename DType, typename Op,
           int LhsTarget = 0, int RhsTarget = 2>
@@ -85,29 +213,111 @@ void SDDMMCoo(const BcastOff& bcast,
   const IdType* edges = coo.data.Ptr<IdType>();
   const DType* X = lhs.Ptr<DType>();
   const DType* Y = rhs.Ptr<DType>();
-  const int64_t dim = bcast.out_len,
-                lhs_dim = bcast.lhs_len,
-                rhs_dim = bcast.rhs_len,
-                reduce_size = bcast.reduce_size;
   DType* O = out.Ptr<DType>();
+  const DotFunc<DType> dot = SDDMMDotKernel<DType, Op>(bcast.reduce_size);
 #pragma omp parallel for
   for (int64_t i = 0; i < coo.row->shape[0]; ++i) {
     const IdType rid = row[i];
     const IdType cid = col[i];
     const IdType eid = has_idx? edges[i] : i;
-    DType* out_off = O + eid * dim;
-    for (int64_t k = 0; k < dim; ++k) {
-      const int64_t lhs_add = bcast.use_bcast ? bcast.lhs_offset[k] : k;
-      const int64_t rhs_add = bcast.use_bcast ? bcast.rhs_offset[k] : k;
-      const DType* lhs_off = Op::use_lhs ?
-        X + Selector<LhsTarget>::Call(rid, eid, cid) * lhs_dim + lhs_add * reduce_size : nullptr;
-      const DType* rhs_off = Op::use_rhs ?
-        Y + Selector<RhsTarget>::Call(rid, eid, cid) * rhs_dim + rhs_add * reduce_size : nullptr;
-      out_off[k] = Op::Call(lhs_off, rhs_off, bcast.reduce_size);
+    SDDMMEdge<IdType, DType, Op, LhsTarget, RhsTarget>(
+        bcast, rid, eid, cid, X, Y, O, dot);
+  }
+}
+
+/*!
+ * \brief Compute the result of g-SDDMM on one edge with 16-bit features.
+ * \param lhs_buf The buffer of reduce_size floats holding the converted lhs.
+ * \param rhs_buf The buffer of reduce_size floats holding the converted rhs.
+ * \note DType is Float16 or BFloat16 while Op computes in float.
+ */
+template <typename IdType, typename DType, typename Op,
+          int LhsTarget, int RhsTarget>
+inline void SDDMMEdgeFloat16(const BcastOff& bcast, IdType rid, IdType eid, IdType cid,
+                             const DType* X, const DType* Y, DType* O,
+                             float* lhs_buf, float* rhs_buf) {
+  const int64_t dim = bcast.out_len,
+                lhs_dim = bcast.lhs_len,
+                rhs_dim = bcast.rhs_len,
+                reduce_size = bcast.reduce_size;
+  DType* out_off = O + eid * dim;
+  for (int64_t k = 0; k < dim; ++k) {
+    const int64_t lhs_add = bcast.use_bcast ? bcast.lhs_offset[k] : k;
+    const int64_t rhs_add = bcast.use_bcast ? bcast.rhs_offset[k] : k;
+    if (Op::use_lhs) {
+      const DType* lhs_off =
+        X + Selector<LhsTarget>::Call(rid, eid, cid) * lhs_dim + lhs_add * reduce_size;
+      for (int64_t i = 0; i < reduce_size; ++i)
+        lhs_buf[i] = lhs_off[i];
+    }
+    if (Op::use_rhs) {
+      const DType* rhs_off =
+        Y + Selector<RhsTarget>::Call(rid, eid, cid) * rhs_dim + rhs_add * reduce_size;
+      for (int64_t i = 0; i < reduce_size; ++i)
+        rhs_buf[i] = rhs_off[i];
     }
+    out_off[k] = DType(Op::Call(lhs_buf, rhs_buf, reduce_size));
   }
 }
 
+/*!
+ * \brief CPU kernel of g-SDDMM on Csr format with 16-bit features.
+ * \note DType is Float16 or BFloat16 while Op computes in float: the operands
+ *       are converted to float, dot products are accumulated in float, and
+ *       only the result of every edge is rounded back to DType.
+ */
+template <typename IdType, typename DType, typename Op,
+          int LhsTarget = 0, int RhsTarget = 2>
+void SDDMMCsrFloat16(const BcastOff& bcast,
+                     const CSRMatrix& csr,
+                     NDArray lhs, NDArray rhs, NDArray out) {
+  const bool has_idx = !IsNullArray(csr.data);
+  const IdType* indptr = csr.indptr.Ptr<IdType>();
+  const IdType* indices = csr.indices.Ptr<IdType>();
+  const IdType* edges = csr.data.Ptr<IdType>();
+  const DType* X = lhs.Ptr<DType>();
+  const DType* Y = rhs.Ptr<DType>();
+  DType* O = out.Ptr<DType>();
+  runtime::parallel_for_weighted(0, csr.num_rows, indptr, [=](IdType b, IdType e) {
+    std::vector<float> lhs_buf(bcast.reduce_size), rhs_buf(bcast.reduce_size);
+    for (auto rid = b; rid < e; ++rid) {
+      const IdType row_start = indptr[rid], row_end = indptr[rid + 1];
+      for (IdType j = row_start; j < row_end; ++j) {
+        const IdType cid = indices[j];
+        const IdType eid = has_idx? edges[j] : j;
+        SDDMMEdgeFloat16<IdType, DType, Op, LhsTarget, RhsTarget>(
+            bcast, rid, eid, cid, X, Y, O, lhs_buf.data(), rhs_buf.data());
+      }
+    }
+  });
+}
+
+/*!
+ * \brief CPU kernel of g-SDDMM on Coo format with 16-bit features.
+ * \note See SDDMMCsrFloat16.
+ */
+template <typename IdType, typename DType, typename Op,
+          int LhsTarget = 0, int RhsTarget = 2>
+void SDDMMCooFloat16(const BcastOff& bcast,
+                     const COOMatrix& coo,
+                     NDArray lhs, NDArray rhs, NDArray out) {
+  const bool has_idx = !IsNullArray(coo.data);
+  const IdType* row = coo.row.Ptr<IdType>();
+  const IdType* col = coo.col.Ptr<IdType>();
+  const IdType* edges = coo.data.Ptr<IdType>();
+  const DType* X = lhs.Ptr<DType>();
+  const DType* Y = rhs.Ptr<DType>();
+  DType* O = out.Ptr<DType>();
+  runtime::parallel_for(0, coo.row->shape[0], [=](int64_t b, int64_t e) {
+    std::vector<float> lhs_buf(bcast.reduce_size), rhs_buf(bcast.reduce_size);
+    for (int64_t i = b; i < e; ++i) {
+      const IdType eid = has_idx? edges[i] : i;
+      SDDMMEdgeFloat16<IdType, DType, Op, LhsTarget, RhsTarget>(
+          bcast, row[i], eid, col[i], X, Y, O, lhs_buf.data(), rhs_buf.data());
+    }
+  });
+}
+
 namespace op {
 
 //////////////////////////////// binary operators on CPU ////////////////////////////////
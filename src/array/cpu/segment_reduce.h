@@ -1,6 +1,6 @@
 /*!
  *  Copyright (c) 2020 by Contributors
- * \file array/cpu/spmm.h
+ * \file array/cpu/segment_reduce.h
  * \brief Segment reduce kernel function header.
  */
 #ifndef DGL_ARRAY_CPU_SEGMENT_REDUCE_H_
@@ -9,6 +9,8 @@
 #include <dgl/array.h>
 #include <dgl/runtime/parallel_for.h>
 #include <dgl/base_heterograph.h>
+#include <algorithm>
+#include <numeric>
 #include <vector>
 #include <string>
 
@@ -16,6 +18,17 @@ namespace dgl {
 namespace aten {
 namespace cpu {
 
+/*!
+ * \brief Add a row of feat to a row of out.
+ * \note The loop is kept free of dependencies so that it is vectorized.
+ */
+template <typename DType>
+inline void AddRow(DType* out_row, const DType* feat_row, int64_t dim) {
+#pragma omp simd
+  for (int64_t k = 0; k < dim; ++k)
+    out_row[k] += feat_row[k];
+}
+
 /*!
  * \brief CPU kernel of segment sum.
  * \param feat The input tensor.
@@ -24,20 +37,19 @@ namespace cpu {
  */
 template <typename IdType, typename DType>
 void SegmentSum(NDArray feat, NDArray offsets, NDArray out) {
-  int n = out->shape[0];
-  int dim = 1;
+  const int64_t n = out->shape[0];
+  int64_t dim = 1;
   for (int i = 1; i < out->ndim; ++i)
     dim *= out->shape[i];
   const DType* feat_data = feat.Ptr<DType>();
   const IdType* offsets_data = offsets.Ptr<IdType>();
   DType *out_data = out.Ptr<DType>();
-  runtime::parallel_for(0, n, [=](int b, int e) {
+  // the cost of a segment is its length
+  runtime::parallel_for_weighted(0, n, offsets_data, [=](size_t b, size_t e) {
     for (auto i = b; i < e; ++i) {
-      for (IdType j = offsets_data[i]; j < offsets_data[i + 1]; ++j) {
-        for (int k = 0; k < dim; ++k) {
-          out_data[i * dim + k] += feat_data[j * dim + k];
-        }
-      }
+      DType* out_row = out_data + i * dim;
+      for (IdType j = offsets_data[i]; j < offsets_data[i + 1]; ++j)
+        AddRow(out_row, feat_data + j * dim, dim);
     }
   });
 }
@@ -53,25 +65,28 @@ void SegmentSum(NDArray feat, NDArray offsets, NDArray out) {
 template <typename IdType, typename DType, typename Cmp>
 void SegmentCmp(NDArray feat, NDArray offsets,
                 NDArray out, NDArray arg) {
-  int n = out->shape[0];
-  int dim = 1;
+  const int64_t n = out->shape[0];
+  int64_t dim = 1;
   for (int i = 1; i < out->ndim; ++i)
     dim *= out->shape[i];
   const DType* feat_data = feat.Ptr<DType>();
   const IdType* offsets_data = offsets.Ptr<IdType>();
   DType *out_data = out.Ptr<DType>();
   IdType *arg_data = arg.Ptr<IdType>();
-  std::fill(out_data, out_data + out.NumElements(), Cmp::zero);
-  std::fill(arg_data, arg_data + arg.NumElements(), -1);
-  runtime::parallel_for(0, n, [=](int b, int e) {
+  runtime::parallel_for_weighted(0, n, offsets_data, [=](size_t b, size_t e) {
     for (auto i = b; i < e; ++i) {
+      DType* out_row = out_data + i * dim;
+      IdType* arg_row = arg_data + i * dim;
+      std::fill(out_row, out_row + dim, Cmp::zero);
+      std::fill(arg_row, arg_row + dim, -1);
       for (IdType j = offsets_data[i]; j < offsets_data[i + 1]; ++j) {
-        for (int k = 0; k < dim; ++k) {
-          const DType val = feat_data[j * dim + k];
-          if (Cmp::Call(out_data[i * dim + k], val)) {
-            out_data[i * dim + k] = val;
-            arg_data[i * dim + k] = j;
-          }
+        const DType* feat_row = feat_data + j * dim;
+        // select instead of branching so that the loop is vectorized
+#pragma omp simd
+        for (int64_t k = 0; k < dim; ++k) {
+          const bool take = Cmp::Call(out_row[k], feat_row[k]);
+          out_row[k] = take ? feat_row[k] : out_row[k];
+          arg_row[k] = take ? j : arg_row[k];
         }
       }
     }
@@ -81,27 +96,45 @@ void SegmentCmp(NDArray feat, NDArray offsets,
 /*!
  * \brief CPU kernel of Scatter Add (on first dimension) operator.
  * \note math equation: out[idx[i], *] += feat[i, *]
+ *
+ * The rows of feat are first grouped by their output row with a counting
+ * sort, so that every output row is summed by a single thread without atomics,
+ * in the order of the input rows.
+ *
  * \param feat The input tensor.
  * \param idx The indices tensor.
  * \param out The output tensor.
  */
 template <typename IdType, typename DType>
 void ScatterAdd(NDArray feat, NDArray idx, NDArray out) {
-  int n = feat->shape[0];
-  int dim = 1;
+  const int64_t n = feat->shape[0];
+  const int64_t m = out->shape[0];
+  int64_t dim = 1;
   for (int i = 1; i < out->ndim; ++i)
     dim *= out->shape[i];
   const DType* feat_data = feat.Ptr<DType>();
   const IdType* idx_data = idx.Ptr<IdType>();
   DType* out_data = out.Ptr<DType>();
-#pragma omp parallel for
-  for (int i = 0; i < n; ++i) {
-    const int write_row = idx_data[i];
-    for (int k = 0; k < dim; ++k) {
-#pragma omp atomic
-      out_data[write_row * dim + k] += feat_data[i * dim + k];
-    }
+
+  std::vector<int64_t> offsets(m + 1, 0);
+  for (int64_t i = 0; i < n; ++i) {
+    CHECK(idx_data[i] >= 0 && idx_data[i] < m)
+      << "Index " << idx_data[i] << " out of range of " << m << " rows.";
+    ++offsets[idx_data[i] + 1];
   }
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+  std::vector<int64_t> perm(n);
+  std::vector<int64_t> pos(offsets.begin(), offsets.end() - 1);
+  for (int64_t i = 0; i < n; ++i)
+    perm[pos[idx_data[i]]++] = i;
+
+  runtime::parallel_for_weighted(0, m, offsets.data(), [&](size_t b, size_t e) {
+    for (auto r = b; r < e; ++r) {
+      DType* out_row = out_data + r * dim;
+      for (int64_t j = offsets[r]; j < offsets[r + 1]; ++j)
+        AddRow(out_row, feat_data + perm[j] * dim, dim);
+    }
+  });
 }
 
 /*!
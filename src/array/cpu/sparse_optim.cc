@@ -0,0 +1,111 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file array/cpu/sparse_optim.cc
+ * \brief Sparse optimizer updates of embedding rows on CPU.
+ */
+#include <dgl/array.h>
+#include <dgl/runtime/parallel_for.h>
+#include <algorithm>
+#include <cmath>
+#include "../kernel_decl.h"
+
+namespace dgl {
+namespace aten {
+
+template <int XPU, typename IdType, typename DType>
+void SparseAdagradUpdate(
+    NDArray weight, NDArray state, IdArray idx, NDArray grad, IdArray counts,
+    double lr, double eps) {
+  const int64_t n = idx->shape[0];
+  const int64_t num_rows = weight->shape[0];
+  const int64_t dim = weight.NumElements() / std::max<int64_t>(num_rows, 1);
+  const IdType* idx_data = idx.Ptr<IdType>();
+  const IdType* cnt_data = IsNullArray(counts) ? nullptr : counts.Ptr<IdType>();
+  const DType* grad_data = grad.Ptr<DType>();
+  DType* weight_data = weight.Ptr<DType>();
+  DType* state_data = state.Ptr<DType>();
+  const DType clr = lr, ceps = eps;
+
+  runtime::parallel_for(0, n, [=](size_t b, size_t e) {
+    for (auto i = b; i < e; ++i) {
+      const IdType row = idx_data[i];
+      CHECK(row >= 0 && row < num_rows) << "Index " << row << " out of range of "
+        << num_rows << " rows.";
+      const DType scale = cnt_data ? DType(1) / cnt_data[i] : DType(1);
+      const DType* g = grad_data + i * dim;
+      DType* w = weight_data + row * dim;
+      DType* s = state_data + row * dim;
+#pragma omp simd
+      for (int64_t j = 0; j < dim; ++j) {
+        const DType gj = g[j] * scale;
+        s[j] += gj * gj;
+        w[j] -= clr * gj / std::sqrt(s[j] + ceps);
+      }
+    }
+  });
+}
+
+template <int XPU, typename IdType, typename DType>
+void SparseAdamUpdate(
+    NDArray weight, NDArray step, NDArray mem, NDArray power, IdArray idx,
+    NDArray grad, IdArray counts, double lr, double beta1, double beta2, double eps) {
+  const int64_t n = idx->shape[0];
+  const int64_t num_rows = weight->shape[0];
+  const int64_t dim = weight.NumElements() / std::max<int64_t>(num_rows, 1);
+  const IdType* idx_data = idx.Ptr<IdType>();
+  const IdType* cnt_data = IsNullArray(counts) ? nullptr : counts.Ptr<IdType>();
+  const DType* grad_data = grad.Ptr<DType>();
+  DType* weight_data = weight.Ptr<DType>();
+  DType* step_data = step.Ptr<DType>();
+  DType* mem_data = mem.Ptr<DType>();
+  DType* power_data = power.Ptr<DType>();
+  const DType clr = lr, b1 = beta1, b2 = beta2, ceps = eps;
+
+  runtime::parallel_for(0, n, [=](size_t b, size_t e) {
+    for (auto i = b; i < e; ++i) {
+      const IdType row = idx_data[i];
+      CHECK(row >= 0 && row < num_rows) << "Index " << row << " out of range of "
+        << num_rows << " rows.";
+      const DType scale = cnt_data ? DType(1) / cnt_data[i] : DType(1);
+      const DType t = ++step_data[row];
+      // the bias corrections of the step of the row
+      const DType mem_corr = 1 - std::pow(b1, t);
+      const DType power_corr = 1 - std::pow(b2, t);
+      const DType* g = grad_data + i * dim;
+      DType* w = weight_data + row * dim;
+      DType* m = mem_data + row * dim;
+      DType* p = power_data + row * dim;
+#pragma omp simd
+      for (int64_t j = 0; j < dim; ++j) {
+        const DType gj = g[j] * scale;
+        m[j] = b1 * m[j] + (1 - b1) * gj;
+        p[j] = b2 * p[j] + (1 - b2) * gj * gj;
+        w[j] -= clr * (m[j] / mem_corr) / (std::sqrt(p[j] / power_corr) + ceps);
+      }
+    }
+  });
+}
+
+template void SparseAdagradUpdate<kDLCPU, int32_t, float>(
+    NDArray, NDArray, IdArray, NDArray, IdArray, double, double);
+template void SparseAdagradUpdate<kDLCPU, int64_t, float>(
+    NDArray, NDArray, IdArray, NDArray, IdArray, double, double);
+template void SparseAdagradUpdate<kDLCPU, int32_t, double>(
+    NDArray, NDArray, IdArray, NDArray, IdArray, double, double);
+template void SparseAdagradUpdate<kDLCPU, int64_t, double>(
+    NDArray, NDArray, IdArray, NDArray, IdArray, double, double);
+template void SparseAdamUpdate<kDLCPU, int32_t, float>(
+    NDArray, NDArray, NDArray, NDArray, IdArray, NDArray, IdArray,
+    double, double, double, double);
+template void SparseAdamUpdate<kDLCPU, int64_t, float>(
+    NDArray, NDArray, NDArray, NDArray, IdArray, NDArray, IdArray,
+    double, double, double, double);
+template void SparseAdamUpdate<kDLCPU, int32_t, double>(
+    NDArray, NDArray, NDArray, NDArray, IdArray, NDArray, IdArray,
+    double, double, double, double);
+template void SparseAdamUpdate<kDLCPU, int64_t, double>(
+    NDArray, NDArray, NDArray, NDArray, IdArray, NDArray, IdArray,
+    double, double, double, double);
+
+}  // namespace aten
+}  // namespace dgl
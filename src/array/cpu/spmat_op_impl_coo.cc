@@ -5,6 +5,7 @@
  */
 #include <dmlc/omp.h>
 #include <dgl/runtime/parallel_for.h>
+#include <algorithm>
 #include <vector>
 #include <unordered_set>
 #include <unordered_map>
@@ -16,6 +17,7 @@ namespace dgl {
 
 using runtime::NDArray;
 using runtime::parallel_for;
+using runtime::parallel_for_weighted;
 
 namespace aten {
 namespace impl {
@@ -157,6 +159,9 @@ COOGetRowDataAndIndices<kDLCPU, int64_t>(COOMatrix, int64_t);
 
 ///////////////////////////// COOGetData /////////////////////////////
 
+/*! \brief The number of queries from which COOGetData looks up an unsorted matrix in its CSR. */
+constexpr int64_t kCOOGetDataCSRMinQueries = 8;
+
 template <DLDeviceType XPU, typename IdType>
 IdArray COOGetData(COOMatrix coo, IdArray rows, IdArray cols) {
   const int64_t rowlen = rows->shape[0];
@@ -174,13 +179,16 @@ IdArray COOGetData(COOMatrix coo, IdArray rows, IdArray cols) {
   const int64_t nnz = coo.row->shape[0];
 
   const int64_t retlen = std::max(rowlen, collen);
+  if (!coo.row_sorted && retlen >= kCOOGetDataCSRMinQueries) {
+    // Every query scans all the non-zeros of an unsorted matrix. Its CSR is built
+    // in linear time instead, keeps the order of the non-zeros within the rows so
+    // that the first match is still returned, and is searched by batch.
+    return aten::CSRGetData(aten::COOToCSR(coo), rows, cols);
+  }
+
   IdArray ret = Full(-1, retlen, rows->dtype.bits, rows->ctx);
   IdType* ret_data = ret.Ptr<IdType>();
 
-  // TODO(minjie): We might need to consider sorting the COO beforehand especially
-  //   when the number of (row, col) pairs is large. Need more benchmarks to justify
-  //   the choice.
-
   if (coo.row_sorted) {
     parallel_for(0, retlen, [&](size_t b, size_t e) {
       for (auto p = b; p < e; ++p) {
@@ -602,6 +610,103 @@ template <class IdType> CSRMatrix UnSortedDenseCOOToCSR(const COOMatrix &coo) {
                    ret_data, coo.col_sorted);
 }
 
+/*! \brief The minimum number of rows of a block of UnSortedPartitionedCOOToCSR. */
+constexpr int64_t kCOOToCSRBlockRows = 1 << 14;
+/*! \brief The maximum number of blocks of UnSortedPartitionedCOOToCSR. */
+constexpr int64_t kCOOToCSRMaxBlocks = 1 << 12;
+/*! \brief The number of non-zeros from which UnSortedPartitionedCOOToCSR is used. */
+constexpr int64_t kCOOToCSRPartitionedMinNNZ = 1 << 22;
+
+template <class IdType> CSRMatrix UnSortedPartitionedCOOToCSR(const COOMatrix &coo) {
+  const int64_t N = coo.num_rows;
+  const int64_t NNZ = coo.row->shape[0];
+  const IdType *const row_data = static_cast<IdType *>(coo.row->data);
+  const IdType *const col_data = static_cast<IdType *>(coo.col->data);
+  const IdType *const data =
+      COOHasData(coo) ? static_cast<IdType *>(coo.data->data) : nullptr;
+
+  NDArray ret_indptr = NDArray::Empty({N + 1}, coo.row->dtype, coo.row->ctx);
+  NDArray ret_indices = NDArray::Empty({NNZ}, coo.row->dtype, coo.row->ctx);
+  NDArray ret_data = NDArray::Empty({NNZ}, coo.row->dtype, coo.row->ctx);
+  IdType *const Bp = static_cast<IdType *>(ret_indptr->data);
+  Bp[0] = 0;
+  IdType *const Bi = static_cast<IdType *>(ret_indices->data);
+  IdType *const Bx = static_cast<IdType *>(ret_data->data);
+
+  // The rows are split into blocks whose part of Bp stays in cache, and the
+  // non-zeros into one chunk per thread.
+  const int64_t block_rows = std::max(
+      kCOOToCSRBlockRows, (N + kCOOToCSRMaxBlocks - 1) / kCOOToCSRMaxBlocks);
+  const int64_t num_blocks = (N + block_rows - 1) / block_rows;
+  const int64_t num_chunks = omp_get_max_threads();
+
+  // Partition the non-zeros by block with a stable counting sort, placing their
+  // columns and data at their blocks in Bi and Bx. Every chunk histogram is
+  // allocated by the thread filling it, so that it is local to its NUMA node.
+  std::vector<std::vector<int64_t>> block_offsets(num_chunks);
+  parallel_for(0, num_chunks, 1, [&](int64_t b, int64_t e) {
+    for (int64_t c = b; c < e; ++c) {
+      block_offsets[c].assign(num_blocks, 0);
+      for (int64_t i = NNZ * c / num_chunks; i < NNZ * (c + 1) / num_chunks; ++i)
+        ++block_offsets[c][row_data[i] / block_rows];
+    }
+  });
+  std::vector<int64_t> block_start(num_blocks + 1, 0);
+  for (int64_t block = 0; block < num_blocks; ++block) {
+    int64_t offset = block_start[block];
+    for (int64_t c = 0; c < num_chunks; ++c) {
+      const int64_t count = block_offsets[c][block];
+      block_offsets[c][block] = offset;
+      offset += count;
+    }
+    block_start[block + 1] = offset;
+  }
+  CHECK_EQ(block_start[num_blocks], NNZ);
+
+  std::vector<IdType> rows(NNZ);
+  parallel_for(0, num_chunks, 1, [&](int64_t b, int64_t e) {
+    for (int64_t c = b; c < e; ++c) {
+      std::vector<int64_t>& offsets = block_offsets[c];
+      for (int64_t i = NNZ * c / num_chunks; i < NNZ * (c + 1) / num_chunks; ++i) {
+        const int64_t pos = offsets[row_data[i] / block_rows]++;
+        rows[pos] = row_data[i];
+        Bi[pos] = col_data[i];
+        Bx[pos] = data ? data[i] : i;
+      }
+    }
+  });
+
+  // Build the CSR of every block within its part of Bp, Bi and Bx.
+  parallel_for_weighted(0, num_blocks, block_start.data(), [&](int64_t b, int64_t e) {
+    std::vector<IdType> cols, eids;
+    for (int64_t block = b; block < e; ++block) {
+      const int64_t row_start = block * block_rows;
+      const int64_t row_end = std::min(N, row_start + block_rows);
+      const int64_t start = block_start[block], end = block_start[block + 1];
+      std::fill(Bp + row_start + 1, Bp + row_end + 1, 0);
+      for (int64_t i = start; i < end; ++i)
+        ++Bp[rows[i] + 1];
+      IdType sum = start;
+      for (int64_t r = row_start; r < row_end; ++r) {
+        const IdType count = Bp[r + 1];
+        Bp[r + 1] = sum;
+        sum += count;
+      }
+      cols.assign(Bi + start, Bi + end);
+      eids.assign(Bx + start, Bx + end);
+      for (int64_t i = start; i < end; ++i) {
+        const int64_t dest = Bp[rows[i] + 1]++;
+        Bi[dest] = cols[i - start];
+        Bx[dest] = eids[i - start];
+      }
+    }
+  });
+  CHECK_EQ(Bp[N], NNZ);
+
+  return CSRMatrix(coo.num_rows, coo.num_cols, ret_indptr, ret_indices,
+                   ret_data, coo.col_sorted);
+}
+
 }  // namespace
 
 /*
@@ -615,6 +720,10 @@ P^2).
   3. If row is NOT sorted in COO and graph is dense (medium/high average
 degree), UnSortedDenseCOOToCSR<> is applied. Time: O(NNZ/P + N/P), space O(NNZ +
 N*P).
+  4. If row is NOT sorted in COO and the graph is large, whatever its density,
+UnSortedPartitionedCOOToCSR<> is applied. It partitions the non-zeros by blocks
+of rows, then builds the CSR of every block with accesses to Bp staying in
+cache. Time: O(NNZ/P + N/P + P*B), space O(NNZ + P*B) with B <= 4096 blocks.
 */
 template <DLDeviceType XPU, typename IdType>
 CSRMatrix COOToCSR(COOMatrix coo) {
@@ -622,6 +731,8 @@ CSRMatrix COOToCSR(COOMatrix coo) {
     const int64_t num_threads = omp_get_num_threads();
     const int64_t num_nodes = coo.num_rows;
     const int64_t num_edges = coo.row->shape[0];
+    if (num_edges >= kCOOToCSRPartitionedMinNNZ && num_nodes > kCOOToCSRBlockRows)
+      return UnSortedPartitionedCOOToCSR<IdType>(coo);
     // Besides graph density, num_threads is also taken into account. Below
     // criteria is set-up according to the time/space complexity difference
     // between these 2 algorithms.
@@ -5,9 +5,12 @@
  */
 #include <dgl/array.h>
 #include <dgl/runtime/parallel_for.h>
+#include <dmlc/omp.h>
+#include <algorithm>
 #include <vector>
 #include <unordered_set>
 #include <numeric>
+#include <utility>
 #include "array_utils.h"
 
 namespace dgl {
@@ -229,6 +232,21 @@ template std::vector<NDArray> CSRGetDataAndIndices<kDLCPU, int64_t>(
 
 // for a matrix of shape (N, M) and NNZ
 // complexity: time O(NNZ + max(N, M)), space O(1)
+namespace {
+
+// The number of non-zeros below which the CSR is transposed on a single thread
+constexpr int64_t kParallelTransposeMinNNZ = 1 << 16;
+
+}  // namespace
+
+/*
+ * The rows are split into chunks of about the same number of non-zeros, one per
+ * thread. Every chunk counts its non-zeros by column, so that it knows where its
+ * entries go in each column, and scatters them. The entries of a column stay
+ * ordered by row as with a serial transpose. The counts take one column array per
+ * chunk, so the number of chunks is bounded to keep them below half the size of
+ * the indices.
+ */
 template <DLDeviceType XPU, typename IdType>
 CSRMatrix CSRTranspose(CSRMatrix csr) {
   const int64_t N = csr.num_rows;
@@ -244,11 +262,37 @@ CSRMatrix CSRTranspose(CSRMatrix csr) {
   IdType* Bi = static_cast<IdType*>(ret_indices->data);
   IdType* Bx = static_cast<IdType*>(ret_data->data);
 
-  std::fill(Bp, Bp + M, 0);
-
-  for (int64_t j = 0; j < nnz; ++j) {
-    Bp[Aj[j]]++;
+  int64_t num_chunks = 1;
+  if (nnz >= kParallelTransposeMinNNZ) {
+    num_chunks = std::min<int64_t>(omp_get_max_threads(), nnz / (2 * (M + 1)));
+    num_chunks = std::max<int64_t>(num_chunks, 1);
   }
+  std::vector<int64_t> chunk_rows(num_chunks + 1);
+  for (int64_t t = 0; t <= num_chunks; ++t) {
+    chunk_rows[t] = std::lower_bound(Ap, Ap + N, nnz * t / num_chunks) - Ap;
+  }
+  chunk_rows[num_chunks] = N;
+
+  // the number of entries of every column in the chunk, then their first position
+  std::vector<IdType> offsets(num_chunks * M, 0);
+  parallel_for(0, num_chunks, 1, [&](int64_t b, int64_t e) {
+    for (int64_t t = b; t < e; ++t) {
+      IdType* chunk_offsets = offsets.data() + t * M;
+      for (IdType j = Ap[chunk_rows[t]]; j < Ap[chunk_rows[t + 1]]; ++j)
+        chunk_offsets[Aj[j]]++;
+    }
+  });
+  parallel_for(0, M, [&](int64_t b, int64_t e) {
+    for (int64_t c = b; c < e; ++c) {
+      IdType count = 0;
+      for (int64_t t = 0; t < num_chunks; ++t) {
+        const IdType temp = offsets[t * M + c];
+        offsets[t * M + c] = count;
+        count += temp;
+      }
+      Bp[c] = count;
+    }
+  });
 
   // cumsum
   for (int64_t i = 0, cumsum = 0; i < M; ++i) {
@@ -258,21 +302,19 @@ CSRMatrix CSRTranspose(CSRMatrix csr) {
   }
   Bp[M] = nnz;
 
-  for (int64_t i = 0; i < N; ++i) {
-    for (IdType j = Ap[i]; j < Ap[i+1]; ++j) {
-      const IdType dst = Aj[j];
-      Bi[Bp[dst]] = i;
-      Bx[Bp[dst]] = Ax? Ax[j] : j;
-      Bp[dst]++;
+  parallel_for(0, num_chunks, 1, [&](int64_t b, int64_t e) {
+    for (int64_t t = b; t < e; ++t) {
+      IdType* chunk_offsets = offsets.data() + t * M;
+      for (int64_t i = chunk_rows[t]; i < chunk_rows[t + 1]; ++i) {
+        for (IdType j = Ap[i]; j < Ap[i + 1]; ++j) {
+          const IdType dst = Aj[j];
+          const IdType pos = Bp[dst] + chunk_offsets[dst]++;
+          Bi[pos] = i;
+          Bx[pos] = Ax? Ax[j] : j;
+        }
+      }
     }
-  }
-
-  // correct the indptr
-  for (int64_t i = 0, last = 0; i <= M; ++i) {
-    IdType temp = Bp[i];
-    Bp[i] = last;
-    last = temp;
-  }
+  });
 
   return CSRMatrix{csr.num_cols, csr.num_rows, ret_indptr, ret_indices, ret_data};
 }
@@ -310,6 +352,16 @@ COOMatrix CSRToCOODataAsOrder(CSRMatrix csr) {
   const IdType* indices_data = static_cast<IdType*>(csr.indices->data);
   // data array should have the same type as the indices arrays
   const IdType* data = CSRHasData(csr) ? static_cast<IdType*>(csr.data->data) : nullptr;
+  bool data_is_order = true;
+  for (int64_t i = 0; data && data_is_order && i < nnz; ++i)
+    data_is_order = (data[i] == i);
+  if (data_is_order) {
+    // the entries are already in the order of their ids, so that the COO shares
+    // the column indices of the CSR
+    COOMatrix ret = CSRToCOO<XPU, IdType>(csr);
+    ret.data = NullArray(csr.indptr->dtype, csr.indptr->ctx);
+    return ret;
+  }
   NDArray ret_row = NDArray::Empty({nnz}, csr.indices->dtype, csr.indices->ctx);
   NDArray ret_col = NDArray::Empty({nnz}, csr.indices->dtype, csr.indices->ctx);
   IdType* ret_row_data = static_cast<IdType*>(ret_row->data);
@@ -502,6 +554,88 @@ template CSRMatrix CSRSliceMatrix<kDLCPU, int32_t>(
 template CSRMatrix CSRSliceMatrix<kDLCPU, int64_t>(
     CSRMatrix csr, runtime::NDArray rows, runtime::NDArray cols);
 
+///////////////////////////// CSRSliceMatrixBatched /////////////////////////////
+
+template <DLDeviceType XPU, typename IdType>
+CSRMatrix CSRSliceMatrixBatched(CSRMatrix csr, NDArray rows, NDArray row_offsets,
+                                NDArray cols, NDArray col_offsets) {
+  const int64_t num_blocks = row_offsets->shape[0] - 1;
+  const int64_t new_nrows = rows->shape[0];
+  const int64_t new_ncols = cols->shape[0];
+  const IdType* indptr_data = csr.indptr.Ptr<IdType>();
+  const IdType* indices_data = csr.indices.Ptr<IdType>();
+  const IdType* data = CSRHasData(csr) ? csr.data.Ptr<IdType>() : nullptr;
+  const IdType* rows_data = rows.Ptr<IdType>();
+  const IdType* row_offsets_data = row_offsets.Ptr<IdType>();
+  const IdType* cols_data = cols.Ptr<IdType>();
+  const IdType* col_offsets_data = col_offsets.Ptr<IdType>();
+  CHECK(row_offsets_data[0] == 0 && row_offsets_data[num_blocks] == new_nrows)
+    << "The row offsets must span the rows.";
+  CHECK(col_offsets_data[0] == 0 && col_offsets_data[num_blocks] == new_ncols)
+    << "The col offsets must span the cols.";
+
+  // the cols of every block sorted, with their positions
+  std::vector<std::pair<IdType, IdType>> sorted_cols(new_ncols);
+  // the position of the col c in the block i, or -1
+  auto find_col = [&](int64_t i, IdType c) {
+    auto begin = sorted_cols.begin() + col_offsets_data[i];
+    auto end = sorted_cols.begin() + col_offsets_data[i + 1];
+    auto it = std::lower_bound(begin, end, std::make_pair(c, static_cast<IdType>(-1)));
+    return (it != end && it->first == c) ? it->second : static_cast<IdType>(-1);
+  };
+
+  IdArray ret_indptr = NewIdArray(new_nrows + 1, csr.indptr->ctx, csr.indptr->dtype.bits);
+  IdType* ret_indptr_data = ret_indptr.Ptr<IdType>();
+  ret_indptr_data[0] = 0;
+  parallel_for(0, num_blocks, [&](size_t b, size_t e) {
+    for (size_t i = b; i < e; ++i) {
+      CHECK_LE(col_offsets_data[i], col_offsets_data[i + 1]) << "Invalid col offsets.";
+      CHECK_LE(row_offsets_data[i], row_offsets_data[i + 1]) << "Invalid row offsets.";
+      for (IdType j = col_offsets_data[i]; j < col_offsets_data[i + 1]; ++j)
+        sorted_cols[j] = std::make_pair(cols_data[j], j);
+      std::sort(sorted_cols.begin() + col_offsets_data[i],
+                sorted_cols.begin() + col_offsets_data[i + 1]);
+      for (IdType r = row_offsets_data[i]; r < row_offsets_data[i + 1]; ++r) {
+        const IdType row = rows_data[r];
+        CHECK(row >= 0 && row < csr.num_rows) << "Invalid row index: " << row;
+        IdType count = 0;
+        for (IdType k = indptr_data[row]; k < indptr_data[row + 1]; ++k)
+          count += (find_col(i, indices_data[k]) != -1);
+        ret_indptr_data[r + 1] = count;
+      }
+    }
+  });
+  std::partial_sum(ret_indptr_data, ret_indptr_data + new_nrows + 1, ret_indptr_data);
+
+  const int64_t nnz = ret_indptr_data[new_nrows];
+  IdArray ret_indices = NewIdArray(nnz, csr.indices->ctx, csr.indices->dtype.bits);
+  IdArray ret_data = NewIdArray(nnz, csr.indptr->ctx, csr.indptr->dtype.bits);
+  IdType* ret_indices_data = ret_indices.Ptr<IdType>();
+  IdType* ret_data_data = ret_data.Ptr<IdType>();
+  parallel_for(0, num_blocks, [&](size_t b, size_t e) {
+    for (size_t i = b; i < e; ++i) {
+      for (IdType r = row_offsets_data[i]; r < row_offsets_data[i + 1]; ++r) {
+        const IdType row = rows_data[r];
+        IdType pos = ret_indptr_data[r];
+        for (IdType k = indptr_data[row]; k < indptr_data[row + 1]; ++k) {
+          const IdType c = find_col(i, indices_data[k]);
+          if (c != -1) {
+            ret_indices_data[pos] = c;
+            ret_data_data[pos] = data ? data[k] : k;
+            ++pos;
+          }
+        }
+      }
+    }
+  });
+  return CSRMatrix(new_nrows, new_ncols, ret_indptr, ret_indices, ret_data);
+}
+
+template CSRMatrix CSRSliceMatrixBatched<kDLCPU, int32_t>(
+    CSRMatrix, NDArray, NDArray, NDArray, NDArray);
+template CSRMatrix CSRSliceMatrixBatched<kDLCPU, int64_t>(
+    CSRMatrix, NDArray, NDArray, NDArray, NDArray);
+
 ///////////////////////////// CSRReorder /////////////////////////////
 
 template <DLDeviceType XPU, typename IdType>
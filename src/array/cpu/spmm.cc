@@ -9,6 +9,40 @@
 namespace dgl {
 namespace aten {
 
+namespace {
+
+/*!
+ * \brief Generalized SpMM on Csr format with float16 or bfloat16 features.
+ * \note The operators compute and accumulate in float.
+ */
+template <typename IdType>
+void SpMMCsrFloat16(const std::string& op, const std::string& reduce,
+                    const BcastOff& bcast,
+                    const CSRMatrix& csr,
+                    NDArray ufeat,
+                    NDArray efeat,
+                    NDArray out,
+                    std::vector<NDArray> out_aux) {
+  typedef float DType;
+  SWITCH_FLOAT16_TYPE(out->dtype, Float16Type, {
+    SWITCH_OP(op, Op, {
+      if (reduce == "sum") {
+        cpu::SpMMSumCsrFloat16<IdType, Float16Type, Op>(bcast, csr, ufeat, efeat, out);
+      } else if (reduce == "max") {
+        cpu::SpMMCmpCsrFloat16<IdType, Float16Type, Op, cpu::op::Max<DType>>(
+            bcast, csr, ufeat, efeat, out, out_aux[0], out_aux[1]);
+      } else if (reduce == "min") {
+        cpu::SpMMCmpCsrFloat16<IdType, Float16Type, Op, cpu::op::Min<DType>>(
+            bcast, csr, ufeat, efeat, out, out_aux[0], out_aux[1]);
+      } else {
+        LOG(FATAL) << "Unsupported SpMM reducer: " << reduce;
+      }
+    });
+  });
+}
+
+}  // namespace
+
 /*! \brief Generalized SpMM on Csr format. */
 template <int XPU, typename IdType, int bits>
 void SpMMCsr(const std::string& op, const std::string& reduce,
@@ -17,12 +51,15 @@ void SpMMCsr(const std::string& op, const std::string& reduce,
              NDArray ufeat,
              NDArray efeat,
              NDArray out,
-             std::vector<NDArray> out_aux) {
+             std::vector<NDArray> out_aux,
+             KernelPlanCache* plan_cache) {
   const int64_t dim = bcast.out_len;
-  if (reduce == "sum") {
+  if (bits == 16) {
+    SpMMCsrFloat16<IdType>(op, reduce, bcast, csr, ufeat, efeat, out, out_aux);
+  } else if (reduce == "sum") {
     SWITCH_BITS(bits, DType, {
       SWITCH_OP(op, Op, {
-        cpu::SpMMSumCsr<IdType, DType, Op>(bcast, csr, ufeat, efeat, out);
+        cpu::SpMMSumCsr<IdType, DType, Op>(bcast, csr, ufeat, efeat, out, plan_cache);
       });
     });
   } else if (reduce == "max" || reduce == "min") {
@@ -34,11 +71,11 @@ void SpMMCsr(const std::string& op, const std::string& reduce,
         if (reduce == "max") {
           std::fill(out_off, out_off + csr.num_rows * dim, cpu::op::Max<DType>::zero);
           cpu::SpMMCmpCsr<IdType, DType, Op, cpu::op::Max<DType>>(
-              bcast, csr, ufeat, efeat, out, out_aux[0], out_aux[1]);
+              bcast, csr, ufeat, efeat, out, out_aux[0], out_aux[1], plan_cache);
         } else {
           std::fill(out_off, out_off + csr.num_rows * dim, cpu::op::Min<DType>::zero);
           cpu::SpMMCmpCsr<IdType, DType, Op, cpu::op::Min<DType>>(
-              bcast, csr, ufeat, efeat, out, out_aux[0], out_aux[1]);
+              bcast, csr, ufeat, efeat, out, out_aux[0], out_aux[1], plan_cache);
         }
       });
     });
@@ -57,8 +94,10 @@ void SpMMCsrHetero(const std::string& op, const std::string& reduce,
              std::vector<NDArray>* vec_out,
              std::vector<std::vector<NDArray>>* out_aux,
              const std::vector<dgl_type_t>& ufeat_node_tids,
-             const std::vector<dgl_type_t>& out_node_tids) {
+             const std::vector<dgl_type_t>& out_node_tids,
+             std::vector<KernelPlanCache*> plan_caches) {
   const int64_t dim = bcast.out_len;
+  plan_caches.resize(vec_csr.size(), nullptr);
   if (reduce == "sum") {
     SWITCH_BITS(bits, DType, {
       SWITCH_OP(op, Op, {
@@ -70,7 +109,7 @@ void SpMMCsrHetero(const std::string& op, const std::string& reduce,
           NDArray ufeat = (vec_ufeat.size() == 0) ? NullArray() : vec_ufeat[src_id];
           NDArray efeat = (vec_efeat.size() == 0) ? NullArray() : vec_efeat[etype];
           NDArray out = (*vec_out)[dst_id];
-          cpu::SpMMSumCsr<IdType, DType, Op>(bcast, csr, ufeat, efeat, out);
+          cpu::SpMMSumCsr<IdType, DType, Op>(bcast, csr, ufeat, efeat, out, plan_caches[etype]);
         }
       });
     });
@@ -127,27 +166,33 @@ void SpMMCsrHetero(const std::string& op, const std::string& reduce,
 template void SpMMCsr<kDLCPU, int32_t, 16>(
     const std::string& op, const std::string& reduce,
     const BcastOff& bcast, const CSRMatrix& csr,
-    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux);
+    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux,
+    KernelPlanCache* plan_cache);
 template void SpMMCsr<kDLCPU, int64_t, 16>(
     const std::string& op, const std::string& reduce,
     const BcastOff& bcast, const CSRMatrix& csr,
-    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux);
+    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux,
+    KernelPlanCache* plan_cache);
 template void SpMMCsr<kDLCPU, int32_t, 32>(
     const std::string& op, const std::string& reduce,
     const BcastOff& bcast, const CSRMatrix& csr,
-    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux);
+    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux,
+    KernelPlanCache* plan_cache);
 template void SpMMCsr<kDLCPU, int64_t, 32>(
     const std::string& op, const std::string& reduce,
     const BcastOff& bcast, const CSRMatrix& csr,
-    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux);
+    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux,
+    KernelPlanCache* plan_cache);
 template void SpMMCsr<kDLCPU, int32_t, 64>(
     const std::string& op, const std::string& reduce,
     const BcastOff& bcast, const CSRMatrix& csr,
-    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux);
+    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux,
+    KernelPlanCache* plan_cache);
 template void SpMMCsr<kDLCPU, int64_t, 64>(
     const std::string& op, const std::string& reduce,
     const BcastOff& bcast, const CSRMatrix& csr,
-    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux);
+    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux,
+    KernelPlanCache* plan_cache);
 
 template void SpMMCsrHetero<kDLCPU, int32_t, 16>(
     const std::string& op, const std::string& reduce,
@@ -155,42 +200,48 @@ template void SpMMCsrHetero<kDLCPU, int32_t, 16>(
     const std::vector<NDArray>& ufeat, const std::vector<NDArray>& efeat,
     std::vector<NDArray>* out, std::vector<std::vector<NDArray>>* out_aux,
     const std::vector<dgl_type_t>& ufeat_node_tids,
-    const std::vector<dgl_type_t>& out_node_tids);
+    const std::vector<dgl_type_t>& out_node_tids,
+    std::vector<KernelPlanCache*> plan_caches);
 template void SpMMCsrHetero<kDLCPU, int64_t, 16>(
     const std::string& op, const std::string& reduce,
     const BcastOff& bcast, const std::vector<CSRMatrix>& csr,
     const std::vector<NDArray>& ufeat, const std::vector<NDArray>& efeat,
     std::vector<NDArray>* out, std::vector<std::vector<NDArray>>* out_aux,
     const std::vector<dgl_type_t>& ufeat_node_tids,
-    const std::vector<dgl_type_t>& out_node_tids);
+    const std::vector<dgl_type_t>& out_node_tids,
+    std::vector<KernelPlanCache*> plan_caches);
 template void SpMMCsrHetero<kDLCPU, int32_t, 32>(
     const std::string& op, const std::string& reduce,
     const BcastOff& bcast, const std::vector<CSRMatrix>& csr,
     const std::vector<NDArray>& ufeat, const std::vector<NDArray>& efeat,
     std::vector<NDArray>* out, std::vector<std::vector<NDArray>>* out_aux,
     const std::vector<dgl_type_t>& ufeat_node_tids,
-    const std::vector<dgl_type_t>& out_node_tids);
+    const std::vector<dgl_type_t>& out_node_tids,
+    std::vector<KernelPlanCache*> plan_caches);
 template void SpMMCsrHetero<kDLCPU, int64_t, 32>(
     const std::string& op, const std::string& reduce,
     const BcastOff& bcast, const std::vector<CSRMatrix>& csr,
     const std::vector<NDArray>& ufeat, const std::vector<NDArray>& efeat,
     std::vector<NDArray>* out, std::vector<std::vector<NDArray>>* out_aux,
     const std::vector<dgl_type_t>& ufeat_node_tids,
-    const std::vector<dgl_type_t>& out_node_tids);
+    const std::vector<dgl_type_t>& out_node_tids,
+    std::vector<KernelPlanCache*> plan_caches);
 template void SpMMCsrHetero<kDLCPU, int32_t, 64>(
     const std::string& op, const std::string& reduce,
     const BcastOff& bcast, const std::vector<CSRMatrix>& csr,
     const std::vector<NDArray>& ufeat, const std::vector<NDArray>& efeat,
     std::vector<NDArray>* out, std::vector<std::vector<NDArray>>* out_aux,
     const std::vector<dgl_type_t>& ufeat_node_tids,
-    const std::vector<dgl_type_t>& out_node_tids);
+    const std::vector<dgl_type_t>& out_node_tids,
+    std::vector<KernelPlanCache*> plan_caches);
 template void SpMMCsrHetero<kDLCPU, int64_t, 64>(
     const std::string& op, const std::string& reduce,
     const BcastOff& bcast, const std::vector<CSRMatrix>& csr,
     const std::vector<NDArray>& ufeat, const std::vector<NDArray>& efeat,
     std::vector<NDArray>* out, std::vector<std::vector<NDArray>>* out_aux,
     const std::vector<dgl_type_t>& ufeat_node_tids,
-    const std::vector<dgl_type_t>& out_node_tids);
+    const std::vector<dgl_type_t>& out_node_tids,
+    std::vector<KernelPlanCache*> plan_caches);
 
 /*! \brief Generalized SpMM on Coo format. */
 template <int XPU, typename IdType, int bits>
@@ -200,11 +251,12 @@ void SpMMCoo(const std::string& op, const std::string& reduce,
              NDArray ufeat,
              NDArray efeat,
              NDArray out,
-             std::vector<NDArray> out_aux) {
+             std::vector<NDArray> out_aux,
+             KernelPlanCache* plan_cache) {
   if (reduce == "sum") {
     SWITCH_BITS(bits, DType, {
       SWITCH_OP(op, Op, {
-        cpu::SpMMSumCoo<IdType, DType, Op>(bcast, coo, ufeat, efeat, out);
+        cpu::SpMMSumCoo<IdType, DType, Op>(bcast, coo, ufeat, efeat, out, plan_cache);
       });
     });
   } else if (reduce == "max" || reduce == "min") {
@@ -226,28 +278,110 @@ void SpMMCoo(const std::string& op, const std::string& reduce,
 template void SpMMCoo<kDLCPU, int32_t, 16>(
     const std::string& op, const std::string& reduce,
     const BcastOff& bcast, const COOMatrix& coo,
-    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux);
+    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux,
+    KernelPlanCache* plan_cache);
 template void SpMMCoo<kDLCPU, int64_t, 16>(
     const std::string& op, const std::string& reduce,
     const BcastOff& bcast, const COOMatrix& coo,
-    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux);
+    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux,
+    KernelPlanCache* plan_cache);
 template void SpMMCoo<kDLCPU, int32_t, 32>(
     const std::string& op, const std::string& reduce,
     const BcastOff& bcast, const COOMatrix& coo,
-    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux);
+    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux,
+    KernelPlanCache* plan_cache);
 template void SpMMCoo<kDLCPU, int64_t, 32>(
     const std::string& op, const std::string& reduce,
     const BcastOff& bcast, const COOMatrix& coo,
-    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux);
+    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux,
+    KernelPlanCache* plan_cache);
 template void SpMMCoo<kDLCPU, int32_t, 64>(
     const std::string& op, const std::string& reduce,
     const BcastOff& bcast, const COOMatrix& coo,
-    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux);
+    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux,
+    KernelPlanCache* plan_cache);
 template void SpMMCoo<kDLCPU, int64_t, 64>(
     const std::string& op, const std::string& reduce,
     const BcastOff& bcast, const COOMatrix& coo,
-    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux);
+    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux,
+    KernelPlanCache* plan_cache);
 
+/*! \brief Generalized SpMM on Csr format with int64 row pointers. */
+template <int XPU, typename IdType, int bits>
+void SpMMCsrWideIndptr(const std::string& op, const std::string& reduce,
+                       const BcastOff& bcast,
+                       const CSRMatrix& csr,
+                       NDArray ufeat,
+                       NDArray efeat,
+                       NDArray out) {
+  if (reduce == "sum") {
+    SWITCH_BITS(bits, DType, {
+      SWITCH_OP(op, Op, {
+        cpu::SpMMSumCsrNaive<IdType, DType, Op, int64_t>(
+            bcast, csr, ufeat.Ptr<DType>(), efeat.Ptr<DType>(), out.Ptr<DType>());
+      });
+    });
+  } else {
+    LOG(FATAL) << "Unsupported SpMM reducer on Csr with int64 row pointers: " << reduce;
+  }
+}
+
+template void SpMMCsrWideIndptr<kDLCPU, int32_t, 16>(
+    const std::string& op, const std::string& reduce,
+    const BcastOff& bcast, const CSRMatrix& csr,
+    NDArray ufeat, NDArray efeat, NDArray out);
+template void SpMMCsrWideIndptr<kDLCPU, int32_t, 32>(
+    const std::string& op, const std::string& reduce,
+    const BcastOff& bcast, const CSRMatrix& csr,
+    NDArray ufeat, NDArray efeat, NDArray out);
+template void SpMMCsrWideIndptr<kDLCPU, int32_t, 64>(
+    const std::string& op, const std::string& reduce,
+    const BcastOff& bcast, const CSRMatrix& csr,
+    NDArray ufeat, NDArray efeat, NDArray out);
+
+/*! \brief Generalized SpMM on compressed Csr format. */
+template <int XPU, typename IdType, int bits>
+void SpMMCompressedCsr(const std::string& op, const std::string& reduce,
+                       const BcastOff& bcast,
+                       const CompressedCSRMatrix& csr,
+                       NDArray ufeat,
+                       NDArray efeat,
+                       NDArray out) {
+  if (reduce == "sum") {
+    SWITCH_BITS(bits, DType, {
+      SWITCH_OP(op, Op, {
+        cpu::SpMMSumCompressedCsr<IdType, DType, Op>(bcast, csr, ufeat, efeat, out);
+      });
+    });
+  } else {
+    LOG(FATAL) << "Unsupported SpMM reducer on compressed Csr: " << reduce;
+  }
+}
+
+template void SpMMCompressedCsr<kDLCPU, int32_t, 16>(
+    const std::string& op, const std::string& reduce,
+    const BcastOff& bcast, const CompressedCSRMatrix& csr,
+    NDArray ufeat, NDArray efeat, NDArray out);
+template void SpMMCompressedCsr<kDLCPU, int64_t, 16>(
+    const std::string& op, const std::string& reduce,
+    const BcastOff& bcast, const CompressedCSRMatrix& csr,
+    NDArray ufeat, NDArray efeat, NDArray out);
+template void SpMMCompressedCsr<kDLCPU, int32_t, 32>(
+    const std::string& op, const std::string& reduce,
+    const BcastOff& bcast, const CompressedCSRMatrix& csr,
+    NDArray ufeat, NDArray efeat, NDArray out);
+template void SpMMCompressedCsr<kDLCPU, int64_t, 32>(
+    const std::string& op, const std::string& reduce,
+    const BcastOff& bcast, const CompressedCSRMatrix& csr,
+    NDArray ufeat, NDArray efeat, NDArray out);
+template void SpMMCompressedCsr<kDLCPU, int32_t, 64>(
+    const std::string& op, const std::string& reduce,
+    const BcastOff& bcast, const CompressedCSRMatrix& csr,
+    NDArray ufeat, NDArray efeat, NDArray out);
+template void SpMMCompressedCsr<kDLCPU, int64_t, 64>(
+    const std::string& op, const std::string& reduce,
+    const BcastOff& bcast, const CompressedCSRMatrix& csr,
+    NDArray ufeat, NDArray efeat, NDArray out);
 
 }  // namespace aten
 }  // namespace dgl
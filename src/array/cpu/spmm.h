@@ -7,11 +7,17 @@
 #define DGL_ARRAY_CPU_SPMM_H_
 
 #include <dgl/array.h>
+#include <dgl/aten/kernel_plan.h>
 #include <dgl/bcast.h>
 #include <dgl/runtime/parallel_for.h>
 #include <algorithm>
 #include <limits>
 #include <memory>
+#include <string>
+#include <typeinfo>
+#include <vector>
+#include "compressed_csr.h"
+#include "float16.h"
 #include "spmm_binary_ops.h"
 #if !defined(_WIN32)
 #ifdef USE_AVX
@@ -48,7 +54,7 @@ void SpMMSumCsrXbyak(dgl::ElemWiseAddUpdate<Op>* cpu_spec, const BcastOff& bcast
   const IdType* edges = csr.data.Ptr<IdType>();
   int64_t dim = bcast.out_len, lhs_dim = bcast.lhs_len, rhs_dim = bcast.rhs_len;
 
-  runtime::parallel_for(0, csr.num_rows, [&](size_t b, size_t e) {
+  runtime::parallel_for_weighted(0, csr.num_rows, indptr, [&](size_t b, size_t e) {
     for (auto rid = b; rid < e; ++rid) {
       const IdType row_start = indptr[rid], row_end = indptr[rid + 1];
       DType* out_off = O + rid * dim;
@@ -60,6 +66,66 @@ void SpMMSumCsrXbyak(dgl::ElemWiseAddUpdate<Op>* cpu_spec, const BcastOff& bcast
     }
   });
 }
+
+/*!
+ * \brief CPU kernel of SpMM-Min/Max on Csr format using Xbyak.
+ * \param cpu_spec JIT'ed kernel
+ * \param bcast Broadcast information.
+ * \param csr The Csr matrix.
+ * \param X The feature on source nodes.
+ * \param W The feature on edges.
+ * \param O The result feature on destination nodes.
+ * \param argX Arg-Min/Max on source nodes.
+ * \param argW Arg-Min/Max on edges.
+ * \param argX_ntype Node type of the Arg-Min/Max on source nodes. Only used
+ *        by heterograph kernels.
+ * \param argW_etype Edge type of the Arg-Min/Max on edges. Only used by
+ *        heterograph kernels.
+ * \param ntype Node type of the source nodes.
+ * \param etype Edge type.
+ * \note it uses node parallel strategy, different threads are responsible
+ *       for the computation of different nodes. For each edge, it uses the
+ *       JIT'ed kernel, which updates the result and the Arg-Min/Max buffers
+ *       under a vector mask.
+ */
+template <typename IdType, typename DType, typename Op, typename Cmp,
+          bool with_type>
+void SpMMCmpCsrXbyak(dgl::ElemWiseCmpUpdate<Op, Cmp, IdType, with_type>* cpu_spec,
+                     const BcastOff& bcast, const CSRMatrix& csr,
+                     const DType* X, const DType* W, DType* O,
+                     IdType* argX, IdType* argW,
+                     IdType* argX_ntype = nullptr, IdType* argW_etype = nullptr,
+                     int64_t ntype = 0, int64_t etype = 0) {
+  const bool has_idx = !IsNullArray(csr.data);
+  const IdType* indptr = csr.indptr.Ptr<IdType>();
+  const IdType* indices = csr.indices.Ptr<IdType>();
+  const IdType* edges = csr.data.Ptr<IdType>();
+  int64_t dim = bcast.out_len, lhs_dim = bcast.lhs_len, rhs_dim = bcast.rhs_len;
+
+  runtime::parallel_for_weighted(0, csr.num_rows, indptr, [&](size_t b, size_t e) {
+    for (auto rid = b; rid < e; ++rid) {
+      const IdType row_start = indptr[rid], row_end = indptr[rid + 1];
+      DType* out_off = O + rid * dim;
+      IdType* argx_off = Op::use_lhs ? argX + rid * dim : nullptr;
+      IdType* argw_off = Op::use_rhs ? argW + rid * dim : nullptr;
+      for (IdType j = row_start; j < row_end; ++j) {
+        const int64_t cid = indices[j];
+        const int64_t eid = has_idx ? edges[j] : j;
+        const DType* lhs_off = Op::use_lhs ? X + cid * lhs_dim : nullptr;
+        const DType* rhs_off = Op::use_rhs ? W + eid * rhs_dim : nullptr;
+        if (with_type) {
+          IdType* argx_ntype = Op::use_lhs ? argX_ntype + rid * dim : nullptr;
+          IdType* argw_etype = Op::use_rhs ? argW_etype + rid * dim : nullptr;
+          cpu_spec->run(out_off, lhs_off, rhs_off, dim, argx_off, argw_off,
+                        cid, eid, argx_ntype, argw_etype, ntype, etype);
+        } else {
+          cpu_spec->run(out_off, lhs_off, rhs_off, dim, argx_off, argw_off,
+                        cid, eid);
+        }
+      }
+    }
+  });
+}
 #endif  // USE_AVX
 #endif  // _WIN32
 
@@ -72,23 +138,25 @@ void SpMMSumCsrXbyak(dgl::ElemWiseAddUpdate<Op>* cpu_spec, const BcastOff& bcast
  * \param W The feature on edges.
  * \param O The result feature on destination nodes.
  * \note it uses node parallel strategy, different threads are responsible
- *       for the computation of different nodes.
+ *       for the computation of different nodes. IndptrType is the type of the
+ *       row pointers and of the data, int64 for the Csr matrices with int32
+ *       column indices and int64 row pointers.
  */
-template <typename IdType, typename DType, typename Op>
+template <typename IdType, typename DType, typename Op, typename IndptrType = IdType>
 void SpMMSumCsrNaive(const BcastOff& bcast, const CSRMatrix& csr, const DType* X,
                      const DType* W, DType* O) {
   const bool has_idx = !IsNullArray(csr.data);
-  const IdType* indptr = csr.indptr.Ptr<IdType>();
+  const IndptrType* indptr = csr.indptr.Ptr<IndptrType>();
   const IdType* indices = csr.indices.Ptr<IdType>();
-  const IdType* edges = csr.data.Ptr<IdType>();
+  const IndptrType* edges = csr.data.Ptr<IndptrType>();
   int64_t dim = bcast.out_len, lhs_dim = bcast.lhs_len, rhs_dim = bcast.rhs_len;
-  runtime::parallel_for(0, csr.num_rows, [&](size_t b, size_t e) {
+  runtime::parallel_for_weighted(0, csr.num_rows, indptr, [&](size_t b, size_t e) {
     for (auto rid = b; rid < e; ++rid) {
-      const IdType row_start = indptr[rid], row_end = indptr[rid + 1];
+      const IndptrType row_start = indptr[rid], row_end = indptr[rid + 1];
       DType* out_off = O + rid * dim;
-      for (IdType j = row_start; j < row_end; ++j) {
+      for (IndptrType j = row_start; j < row_end; ++j) {
         const IdType cid = indices[j];
-        const IdType eid = has_idx ? edges[j] : j;
+        const IndptrType eid = has_idx ? edges[j] : j;
         for (int64_t k = 0; k < dim; ++k) {
           const int64_t lhs_add = bcast.use_bcast ? bcast.lhs_offset[k] : k;
           const int64_t rhs_add = bcast.use_bcast ? bcast.rhs_offset[k] : k;
@@ -115,7 +183,7 @@ void SpMMSumCsrNaive(const BcastOff& bcast, const CSRMatrix& csr, const DType* X
  */
 template <typename IdType, typename DType, typename Op>
 void SpMMSumCsr(const BcastOff& bcast, const CSRMatrix& csr, NDArray ufeat,
-                NDArray efeat, NDArray out) {
+                NDArray efeat, NDArray out, KernelPlanCache* plan_cache = nullptr) {
   const bool has_idx = !IsNullArray(csr.data);
   const IdType* indptr = csr.indptr.Ptr<IdType>();
   const IdType* indices = csr.indices.Ptr<IdType>();
@@ -141,7 +209,7 @@ void SpMMSumCsr(const BcastOff& bcast, const CSRMatrix& csr, NDArray ufeat,
   const bool no_libxsmm =
        bcast.use_bcast || std::is_same<DType, double>::value;
   if (!no_libxsmm) {
-    SpMMSumCsrLibxsmm<IdType, DType, Op>(bcast, csr, ufeat, efeat, out);
+    SpMMSumCsrLibxsmm<IdType, DType, Op>(bcast, csr, ufeat, efeat, out, plan_cache);
   } else {
 #endif  // USE_LIBXSMM
     typedef dgl::ElemWiseAddUpdate<Op> ElemWiseUpd;
@@ -168,6 +236,110 @@ void SpMMSumCsr(const BcastOff& bcast, const CSRMatrix& csr, NDArray ufeat,
 #endif  // _WIN32
 }
 
+/*!
+ * \brief CPU kernel of SpMM on compressed Csr format.
+ * \param bcast Broadcast information.
+ * \param csr The compressed Csr matrix.
+ * \param ufeat The feature on source nodes.
+ * \param efeat The feature on edges.
+ * \param out The result feature on destination nodes.
+ * \note The column indices of a row are decoded block by block into a buffer,
+ *       as in SpMMSumCsrNaive otherwise.
+ */
+template <typename IdType, typename DType, typename Op>
+void SpMMSumCompressedCsr(const BcastOff& bcast, const CompressedCSRMatrix& csr,
+                          NDArray ufeat, NDArray efeat, NDArray out) {
+  const bool has_idx = CompressedCSRHasData(csr);
+  const IdType* indptr = csr.indptr.Ptr<IdType>();
+  const uint8_t* bytes = csr.indices.Ptr<uint8_t>();
+  const int64_t* block_offsets = csr.block_offsets.Ptr<int64_t>();
+  const IdType* edges = csr.data.Ptr<IdType>();
+  const DType* X = ufeat.Ptr<DType>();
+  const DType* W = efeat.Ptr<DType>();
+  int64_t dim = bcast.out_len, lhs_dim = bcast.lhs_len, rhs_dim = bcast.rhs_len;
+  DType* O = out.Ptr<DType>();
+  CHECK_NOTNULL(indptr);
+  CHECK_NOTNULL(O);
+  runtime::parallel_for_weighted(0, csr.num_rows, indptr, [&](size_t b, size_t e) {
+    IdType cids[kCompressedCSRBlockSize];
+    for (auto rid = b; rid < e; ++rid) {
+      const IdType row_start = indptr[rid], row_end = indptr[rid + 1];
+      DType* out_off = O + rid * dim;
+      for (int64_t begin = row_start; begin < row_end; ) {
+        const int64_t end = std::min<int64_t>(
+            row_end, (begin / kCompressedCSRBlockSize + 1) * kCompressedCSRBlockSize);
+        DecodeCompressedRow<IdType>(bytes, block_offsets, row_start, begin, end, cids);
+        for (int64_t j = begin; j < end; ++j) {
+          const IdType cid = cids[j - begin];
+          const IdType eid = has_idx ? edges[j] : j;
+          for (int64_t k = 0; k < dim; ++k) {
+            const int64_t lhs_add = bcast.use_bcast ? bcast.lhs_offset[k] : k;
+            const int64_t rhs_add = bcast.use_bcast ? bcast.rhs_offset[k] : k;
+            const DType* lhs_off =
+              Op::use_lhs ? X + cid * lhs_dim + lhs_add : nullptr;
+            const DType* rhs_off =
+              Op::use_rhs ? W + eid * rhs_dim + rhs_add : nullptr;
+            out_off[k] += Op::Call(lhs_off, rhs_off);
+          }
+        }
+        begin = end;
+      }
+    }
+  });
+}
+
+/*!
+ * \brief Partition of the edges of a Coo matrix by destination node range.
+ *
+ * The destination nodes (columns) are split into contiguous ranges holding
+ * about the same number of edges, one range per part. perm lists the edges
+ * ordered by part, and keeps the original edge order within a part.
+ */
+template <typename IdType>
+struct SpMMCooPartition {
+  /*! \brief The edges of part p are perm[offsets[p]:offsets[p + 1]]. */
+  std::vector<int64_t> offsets;
+  /*! \brief The positions of the edges in the Coo matrix, ordered by part. */
+  std::vector<IdType> perm;
+};
+
+/*!
+ * \brief Partition the edges of a Coo matrix by destination node range with
+ *        a single counting sort pass.
+ * \param coo The Coo matrix.
+ * \param num_parts The number of parts.
+ */
+template <typename IdType>
+std::shared_ptr<SpMMCooPartition<IdType>> SpMMBuildCooPartition(
+    const COOMatrix& coo, int64_t num_parts) {
+  const IdType* col = coo.col.Ptr<IdType>();
+  const int64_t nnz = coo.row->shape[0];
+  auto partition = std::make_shared<SpMMCooPartition<IdType>>();
+  // in-degrees, then reused as the part of every column
+  std::vector<int64_t> part_of(coo.num_cols, 0);
+  for (int64_t i = 0; i < nnz; ++i)
+    ++part_of[col[i]];
+  const int64_t edges_per_part = (nnz + num_parts - 1) / num_parts;
+  int64_t acc = 0, part = 0;
+  for (int64_t c = 0; c < coo.num_cols; ++c) {
+    acc += part_of[c];
+    part_of[c] = part;
+    if (part + 1 < num_parts && acc >= (part + 1) * edges_per_part)
+      ++part;
+  }
+  std::vector<int64_t>& offsets = partition->offsets;
+  offsets.assign(num_parts + 1, 0);
+  for (int64_t i = 0; i < nnz; ++i)
+    ++offsets[part_of[col[i]] + 1];
+  for (int64_t p = 0; p < num_parts; ++p)
+    offsets[p + 1] += offsets[p];
+  std::vector<int64_t> cursor(offsets.begin(), offsets.end() - 1);
+  partition->perm.resize(nnz);
+  for (int64_t i = 0; i < nnz; ++i)
+    partition->perm[cursor[part_of[col[i]]]++] = i;
+  return partition;
+}
+
 /*!
  * \brief CPU kernel of SpMM on Coo format.
  * \param bcast Broadcast information.
@@ -175,13 +347,17 @@ void SpMMSumCsr(const BcastOff& bcast, const CSRMatrix& csr, NDArray ufeat,
  * \param ufeat The feature on source nodes.
  * \param efeat The feature on edges.
  * \param out The result feature on destination nodes.
- * \note it uses node parallel strategy, different threads are responsible
- *       for the computation of different nodes. To avoid possible data hazard,
- *       we use atomic operators in the reduction phase.
+ * \param plan_cache The kernel plan cache of coo, where the partition of the
+ *        edges is kept. It may be null, in which case the partition is
+ *        rebuilt on every call.
+ * \note it uses node parallel strategy, the edges are partitioned by
+ *       destination node range (see SpMMBuildCooPartition) and every thread
+ *       reduces the edges of one part, so that no two threads write to the
+ *       same output row and no atomic operation is needed.
  */
 template <typename IdType, typename DType, typename Op>
 void SpMMSumCoo(const BcastOff& bcast, const COOMatrix& coo, NDArray ufeat,
-                NDArray efeat, NDArray out) {
+                NDArray efeat, NDArray out, KernelPlanCache* plan_cache = nullptr) {
   const bool has_idx = !IsNullArray(coo.data);
   const IdType* row = coo.row.Ptr<IdType>();
   const IdType* col = coo.col.Ptr<IdType>();
@@ -193,27 +369,46 @@ void SpMMSumCoo(const BcastOff& bcast, const COOMatrix& coo, NDArray ufeat,
   const int64_t nnz = coo.row->shape[0];
   // fill zero elements
   memset(O, 0, out.GetSize());
+  if (nnz == 0)
+    return;
+
+  const int64_t num_parts = omp_get_max_threads();
+  std::shared_ptr<SpMMCooPartition<IdType>> partition;
+  if (num_parts > 1) {
+    if (plan_cache) {
+      partition = plan_cache->GetOrCreate<SpMMCooPartition<IdType>>(
+          std::string(typeid(SpMMCooPartition<IdType>).name()) + "_" +
+              std::to_string(num_parts),
+          [&]() { return SpMMBuildCooPartition<IdType>(coo, num_parts); });
+    } else {
+      partition = SpMMBuildCooPartition<IdType>(coo, num_parts);
+    }
+  }
+  const IdType* perm = partition ? partition->perm.data() : nullptr;
+  const int64_t* offsets = partition ? partition->offsets.data() : nullptr;
   // spmm
-#pragma omp parallel for
-  for (IdType i = 0; i < nnz; ++i) {
-    const IdType rid = row[i];
-    const IdType cid = col[i];
-    const IdType eid = has_idx ? edges[i] : i;
-    DType* out_off = O + cid * dim;
-    for (int64_t k = 0; k < dim; ++k) {
-      const int64_t lhs_add = bcast.use_bcast ? bcast.lhs_offset[k] : k;
-      const int64_t rhs_add = bcast.use_bcast ? bcast.rhs_offset[k] : k;
-      const DType* lhs_off =
-        Op::use_lhs ? X + rid * lhs_dim + lhs_add : nullptr;
-      const DType* rhs_off =
-        Op::use_rhs ? W + eid * rhs_dim + rhs_add : nullptr;
-      const DType val = Op::Call(lhs_off, rhs_off);
-      if (val != 0) {
-#pragma omp atomic
-        out_off[k] += val;
+  runtime::parallel_for(0, num_parts, 1, [=](size_t b, size_t e) {
+    for (auto p = b; p < e; ++p) {
+      const int64_t start = offsets ? offsets[p] : 0,
+                    end = offsets ? offsets[p + 1] : nnz;
+      for (int64_t j = start; j < end; ++j) {
+        const IdType i = perm ? perm[j] : j;
+        const IdType rid = row[i];
+        const IdType cid = col[i];
+        const IdType eid = has_idx ? edges[i] : i;
+        DType* out_off = O + cid * dim;
+        for (int64_t k = 0; k < dim; ++k) {
+          const int64_t lhs_add = bcast.use_bcast ? bcast.lhs_offset[k] : k;
+          const int64_t rhs_add = bcast.use_bcast ? bcast.rhs_offset[k] : k;
+          const DType* lhs_off =
+            Op::use_lhs ? X + rid * lhs_dim + lhs_add : nullptr;
+          const DType* rhs_off =
+            Op::use_rhs ? W + eid * rhs_dim + rhs_add : nullptr;
+          out_off[k] += Op::Call(lhs_off, rhs_off);
+        }
       }
     }
-  }
+  });
 }
 
 /*!
@@ -235,7 +430,8 @@ void SpMMSumCoo(const BcastOff& bcast, const COOMatrix& coo, NDArray ufeat,
  */
 template <typename IdType, typename DType, typename Op, typename Cmp>
 void SpMMCmpCsr(const BcastOff& bcast, const CSRMatrix& csr, NDArray ufeat,
-                NDArray efeat, NDArray out, NDArray argu, NDArray arge) {
+                NDArray efeat, NDArray out, NDArray argu, NDArray arge,
+                KernelPlanCache* plan_cache = nullptr) {
   const bool has_idx = !IsNullArray(csr.data);
   const IdType* indptr = static_cast<IdType*>(csr.indptr->data);
   const IdType* indices = static_cast<IdType*>(csr.indices->data);
@@ -268,13 +464,26 @@ void SpMMCmpCsr(const BcastOff& bcast, const CSRMatrix& csr, NDArray ufeat,
   const bool no_libxsmm =
        bcast.use_bcast || std::is_same<DType, double>::value;
   if (!no_libxsmm) {
-    SpMMCmpCsrLibxsmm<IdType, DType, Op, Cmp>(bcast, csr, ufeat, efeat, out, argu, arge);
+    SpMMCmpCsrLibxsmm<IdType, DType, Op, Cmp>(
+        bcast, csr, ufeat, efeat, out, argu, arge, plan_cache);
   } else {
 #endif  // USE_LIBXSMM
+    typedef dgl::ElemWiseCmpUpdate<Op, Cmp, IdType> ElemWiseUpd;
+    /* Prepare an assembler kernel */
+    static std::unique_ptr<ElemWiseUpd> asm_kernel_ptr(
+        (dgl::IntelKernel<>::IsEnabled()) ? new ElemWiseUpd() : nullptr);
+    /* Distribute the kernel among OMP threads */
+    ElemWiseUpd* cpu_spec = (asm_kernel_ptr && asm_kernel_ptr->applicable())
+      ? asm_kernel_ptr.get()
+      : nullptr;
+    if (cpu_spec && dim > 16 && !bcast.use_bcast) {
+      SpMMCmpCsrXbyak<IdType, DType, Op, Cmp, false>(
+          cpu_spec, bcast, csr, X, W, O, argX, argW);
+    } else {
 #endif  // USE_AVX
 #endif  // _WIN32
 
-    runtime::parallel_for(0, csr.num_rows, [&](size_t b, size_t e) {
+    runtime::parallel_for_weighted(0, csr.num_rows, indptr, [&](size_t b, size_t e) {
       for (auto rid = b; rid < e; ++rid) {
         const IdType row_start = indptr[rid], row_end = indptr[rid + 1];
         DType* out_off = O + rid * dim;
@@ -302,6 +511,7 @@ void SpMMCmpCsr(const BcastOff& bcast, const CSRMatrix& csr, NDArray ufeat,
     });
 #if !defined(_WIN32)
 #ifdef USE_AVX
+    }
 #ifdef USE_LIBXSMM
   }
 #endif  // USE_LIBXSMM
@@ -366,7 +576,25 @@ void SpMMCmpCsrHetero(const BcastOff& bcast, const CSRMatrix& csr, NDArray ufeat
     CHECK_NOTNULL(argW);
   }
   // TODO(Israt): Use LIBXSMM. Homogeneous graph uses LIBXMM when enabled.
-  runtime::parallel_for(0, csr.num_rows, [&](size_t b, size_t e) {
+#if !defined(_WIN32)
+#ifdef USE_AVX
+  typedef dgl::ElemWiseCmpUpdate<Op, Cmp, IdType, true> ElemWiseUpd;
+  /* Prepare an assembler kernel */
+  static std::unique_ptr<ElemWiseUpd> asm_kernel_ptr(
+      (dgl::IntelKernel<>::IsEnabled()) ? new ElemWiseUpd() : nullptr);
+  /* Distribute the kernel among OMP threads */
+  ElemWiseUpd* cpu_spec = (asm_kernel_ptr && asm_kernel_ptr->applicable())
+    ? asm_kernel_ptr.get()
+    : nullptr;
+  if (cpu_spec && dim > 16 && !bcast.use_bcast) {
+    SpMMCmpCsrXbyak<IdType, DType, Op, Cmp, true>(
+        cpu_spec, bcast, csr, X, W, O, argX, argW, argX_ntype, argW_etype,
+        ntype, etype);
+    return;
+  }
+#endif  // USE_AVX
+#endif  // _WIN32
+  runtime::parallel_for_weighted(0, csr.num_rows, indptr, [&](size_t b, size_t e) {
     for (auto rid = b; rid < e; ++rid) {
       const IdType row_start = indptr[rid], row_end = indptr[rid + 1];
       DType* out_off = O + rid * dim;
@@ -466,6 +694,111 @@ void SpMMCmpCoo(const BcastOff& bcast, const COOMatrix& coo, NDArray ufeat,
   }
 }
 
+/*!
+ * \brief CPU kernel of SpMM-Sum on Csr format with 16-bit features.
+ * \param bcast Broadcast information.
+ * \param csr The Csr matrix.
+ * \param ufeat The feature on source nodes.
+ * \param efeat The feature on edges.
+ * \param out The result feature on destination nodes.
+ * \note DType is Float16 or BFloat16 while Op computes in float: the operands
+ *       are converted to float, the reduction is accumulated in float, and
+ *       only the result of every node is rounded back to DType.
+ */
+template <typename IdType, typename DType, typename Op>
+void SpMMSumCsrFloat16(const BcastOff& bcast, const CSRMatrix& csr, NDArray ufeat,
+                       NDArray efeat, NDArray out) {
+  const bool has_idx = !IsNullArray(csr.data);
+  const IdType* indptr = csr.indptr.Ptr<IdType>();
+  const IdType* indices = csr.indices.Ptr<IdType>();
+  const IdType* edges = csr.data.Ptr<IdType>();
+  const DType* X = ufeat.Ptr<DType>();
+  const DType* W = efeat.Ptr<DType>();
+  int64_t dim = bcast.out_len, lhs_dim = bcast.lhs_len, rhs_dim = bcast.rhs_len;
+  DType* O = out.Ptr<DType>();
+  CHECK_NOTNULL(indptr);
+  CHECK_NOTNULL(O);
+  runtime::parallel_for_weighted(0, csr.num_rows, indptr, [&](size_t b, size_t e) {
+    std::vector<float> accum(dim);
+    for (auto rid = b; rid < e; ++rid) {
+      const IdType row_start = indptr[rid], row_end = indptr[rid + 1];
+      std::fill(accum.begin(), accum.end(), 0.f);
+      for (IdType j = row_start; j < row_end; ++j) {
+        const IdType cid = indices[j];
+        const IdType eid = has_idx ? edges[j] : j;
+        for (int64_t k = 0; k < dim; ++k) {
+          const int64_t lhs_add = bcast.use_bcast ? bcast.lhs_offset[k] : k;
+          const int64_t rhs_add = bcast.use_bcast ? bcast.rhs_offset[k] : k;
+          const float lhs_val = Op::use_lhs ? float(X[cid * lhs_dim + lhs_add]) : 0.f;
+          const float rhs_val = Op::use_rhs ? float(W[eid * rhs_dim + rhs_add]) : 0.f;
+          accum[k] += Op::Call(&lhs_val, &rhs_val);
+        }
+      }
+      DType* out_off = O + rid * dim;
+      for (int64_t k = 0; k < dim; ++k)
+        out_off[k] = DType(accum[k]);
+    }
+  });
+}
+
+/*!
+ * \brief CPU kernel of SpMM-Min/Max on Csr format with 16-bit features.
+ * \param bcast Broadcast information.
+ * \param csr The Csr matrix.
+ * \param ufeat The feature on source nodes.
+ * \param efeat The feature on edges.
+ * \param out The result feature on destination nodes.
+ * \param argu Arg-Min/Max on source nodes.
+ * \param arge Arg-Min/Max on edges.
+ * \note DType is Float16 or BFloat16 while Op and Cmp compute in float, see
+ *       SpMMSumCsrFloat16. The result will contain infinity for zero-degree
+ *       nodes.
+ */
+template <typename IdType, typename DType, typename Op, typename Cmp>
+void SpMMCmpCsrFloat16(const BcastOff& bcast, const CSRMatrix& csr, NDArray ufeat,
+                       NDArray efeat, NDArray out, NDArray argu, NDArray arge) {
+  const bool has_idx = !IsNullArray(csr.data);
+  const IdType* indptr = csr.indptr.Ptr<IdType>();
+  const IdType* indices = csr.indices.Ptr<IdType>();
+  const IdType* edges = csr.data.Ptr<IdType>();
+  const DType* X = ufeat.Ptr<DType>();
+  const DType* W = efeat.Ptr<DType>();
+  int64_t dim = bcast.out_len, lhs_dim = bcast.lhs_len, rhs_dim = bcast.rhs_len;
+  DType* O = out.Ptr<DType>();
+  IdType* argX = Op::use_lhs ? argu.Ptr<IdType>() : nullptr;
+  IdType* argW = Op::use_rhs ? arge.Ptr<IdType>() : nullptr;
+  CHECK_NOTNULL(indptr);
+  CHECK_NOTNULL(O);
+  runtime::parallel_for_weighted(0, csr.num_rows, indptr, [&](size_t b, size_t e) {
+    std::vector<float> accum(dim);
+    for (auto rid = b; rid < e; ++rid) {
+      const IdType row_start = indptr[rid], row_end = indptr[rid + 1];
+      IdType* argx_off = argX + rid * dim;
+      IdType* argw_off = argW + rid * dim;
+      std::fill(accum.begin(), accum.end(), Cmp::zero);
+      for (IdType j = row_start; j < row_end; ++j) {
+        const IdType cid = indices[j];
+        const IdType eid = has_idx ? edges[j] : j;
+        for (int64_t k = 0; k < dim; ++k) {
+          const int64_t lhs_add = bcast.use_bcast ? bcast.lhs_offset[k] : k;
+          const int64_t rhs_add = bcast.use_bcast ? bcast.rhs_offset[k] : k;
+          const float lhs_val = Op::use_lhs ? float(X[cid * lhs_dim + lhs_add]) : 0.f;
+          const float rhs_val = Op::use_rhs ? float(W[eid * rhs_dim + rhs_add]) : 0.f;
+          const float val = Op::Call(&lhs_val, &rhs_val);
+          if (Cmp::Call(accum[k], val)) {
+            accum[k] = val;
+            if (Op::use_lhs) argx_off[k] = cid;
+            if (Op::use_rhs) argw_off[k] = eid;
+          }
+        }
+      }
+      DType* out_off = O + rid * dim;
+      for (int64_t k = 0; k < dim; ++k)
+        out_off[k] = DType(accum[k]);
+    }
+  });
+}
+
 }  // namespace cpu
 }  // namespace aten
 }  // namespace dgl
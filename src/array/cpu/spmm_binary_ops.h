@@ -149,7 +149,7 @@ constexpr DType Min<DType>::zero;
 #define SWITCH_BITS(bits, DType, ...)                           \
   do {                                                          \
     if ((bits) == 16) {                                         \
-      LOG(FATAL) << "FP16 not supported on CPU";                \
+      LOG(FATAL) << "FP16 not supported by this CPU kernel";    \
     } else if ((bits) == 32) {                                  \
       typedef float DType;                                      \
       { __VA_ARGS__ }                                           \
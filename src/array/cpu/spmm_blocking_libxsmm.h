@@ -11,9 +11,19 @@
 #define DGL_ARRAY_CPU_SPMM_BLOCKING_LIBXSMM_H_
 
 #include <dgl/array.h>
+#include <dgl/aten/kernel_plan.h>
 #include <dgl/bcast.h>
 #include <dmlc/logging.h>
 #include <algorithm>
+#include <cstdlib>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <typeinfo>
+#include <vector>
 
 #if !defined(_WIN32)
 #ifdef USE_AVX
@@ -27,6 +37,11 @@
 
 #define NUM_BLOCKS_PER_THREAD 20
 #define BLOCKING_HEURISTIC_PARAM 500
+// Features wider than this many bytes per row are processed in tiles of this
+// width so that a column block and its neighbor features stay in the LLC.
+#define FEATURE_BLOCK_BYTES 1024
+// Number of graph blockings kept alive for reuse across SpMM calls.
+#define BLOCKING_CACHE_CAPACITY 8
 
 namespace dgl {
 namespace aten {
@@ -47,6 +62,38 @@ int32_t GetLLCSize() {
   return cache_size;
 }
 
+/*!
+ * \brief Whether to reorder the rows by decreasing degree before blocking.
+ * \note Controlled by the environment variable DGL_CPU_SPMM_REORDER_ROWS.
+ */
+inline bool SpMMReorderRowsEnabled() {
+  static const bool enabled = [] {
+    const char *ptr = std::getenv("DGL_CPU_SPMM_REORDER_ROWS");
+    return ptr && atoi(ptr) != 0;
+  }();
+  return enabled;
+}
+
+/*!
+ * \brief Compute a row order with the rows sorted by decreasing degree.
+ *        Heavy rows land in the first blocks, which are handed out first by
+ *        the dynamic scheduler, and rows of similar degree share a block.
+ * \param csr The Csr matrix.
+ * \return The row order, row_order[i] is the i-th row to be processed.
+ */
+template <typename IdType>
+inline std::vector<IdType> SpMMDegreeRowOrder(const CSRMatrix& csr) {
+  const IdType M = csr.num_rows;
+  const IdType* indptr = csr.indptr.Ptr<IdType>();
+  std::vector<IdType> row_order(M);
+  std::iota(row_order.begin(), row_order.end(), 0);
+  std::stable_sort(row_order.begin(), row_order.end(),
+                   [indptr] (IdType a, IdType b) {
+                     return indptr[a + 1] - indptr[a] > indptr[b + 1] - indptr[b];
+                   });
+  return row_order;
+}
+
 /*!
  * \brief Tile the CSR matrix to roughly make sure that the column tiles and
  *        corresponding neighbor features fit into LLC and the row tiles
@@ -59,6 +106,11 @@ int32_t GetLLCSize() {
  * \param K_block_size block size along the columns of adjacency matrix.
  * \param use_lhs Whether to use lhs.
  * \param use_rhs Whether to use rhs.
+ * \param row_order The order in which the rows are assigned to the row tiles,
+ *        nullptr for the natural order.
+ * \note If there is more than one column tile or the rows are reordered, the
+ *       indptr/indices/data of the tiles are copied into new buffers owned by
+ *       the first tile, otherwise the tiles point into the original csr.
  */
 template <typename IdType>
 inline void SpMMCreateBlocks(
@@ -68,7 +120,8 @@ inline void SpMMCreateBlocks(
     IdType num_K_blocks,
     IdType M_block_size,
     IdType K_block_size,
-    bool use_lhs, bool use_rhs) {
+    bool use_lhs, bool use_rhs,
+    const IdType *row_order = nullptr) {
 
   const IdType M = csr.num_rows;
   const IdType K = csr.num_cols;
@@ -81,7 +134,22 @@ inline void SpMMCreateBlocks(
   if (use_rhs)
     CHECK_NOTNULL(edges);
 
-  if (num_K_blocks > 1) {
+  if (num_K_blocks > 1 || row_order) {
+    // Offset of the nonzeros of every row tile in the block buffers.
+    std::vector<IdType> m_block_offset(num_M_blocks + 1, 0);
+#pragma omp parallel for
+    for (IdType m = 0; m < num_M_blocks; m++) {
+      const IdType M_start = m * M_block_size;
+      const IdType M_end = std::min((m + 1) * M_block_size, M);
+      IdType nnz = 0;
+      for (IdType i = M_start; i < M_end; i++) {
+        const IdType row = row_order ? row_order[i] : i;
+        nnz += indptr[row + 1] - indptr[row];
+      }
+      m_block_offset[m + 1] = nnz;
+    }
+    std::partial_sum(m_block_offset.begin(), m_block_offset.end(), m_block_offset.begin());
+
     IdType *indptr_block_buf = reinterpret_cast<IdType *>(aligned_alloc(64,
                                                              (M_block_size + 1) * num_M_blocks *
                                                              num_K_blocks * sizeof(IdType)));
@@ -99,18 +167,19 @@ inline void SpMMCreateBlocks(
       for (IdType m = 0; m < num_M_blocks; m++) {
         const IdType M_start = m * M_block_size;
         const IdType M_end = std::min((m + 1) * M_block_size, M);
-        const IdType nnz = indptr[M_end] - indptr[M_start];
+        const IdType nnz = m_block_offset[m + 1] - m_block_offset[m];
 
         IdType cur_indices_id = 0;
         IdType *my_indices_block_buf, *my_edges_block_buf;
         if (use_lhs)
-          my_indices_block_buf = indices_block_buf + indptr[M_start];
+          my_indices_block_buf = indices_block_buf + m_block_offset[m];
         if (use_rhs)
-          my_edges_block_buf = edges_block_buf + indptr[M_start];
+          my_edges_block_buf = edges_block_buf + m_block_offset[m];
 
         for (IdType i = M_start; i < M_end; i++) {
-          my_cur_col_id[(i - M_start) * 2] = indptr[i];
-          my_cur_col_id[(i - M_start) * 2 + 1] = indptr[i + 1];
+          const IdType row = row_order ? row_order[i] : i;
+          my_cur_col_id[(i - M_start) * 2] = indptr[row];
+          my_cur_col_id[(i - M_start) * 2 + 1] = indptr[row + 1];
         }
         for (IdType k = 0; k < num_K_blocks; k++) {
           const IdType K_start = k * K_block_size;
@@ -159,6 +228,10 @@ inline void SpMMCreateBlocks(
       }
       free(my_cur_col_id);
     }
+    // Keep the buffers reachable from the first tile even if it is empty.
+    block_csr_array[0].indptr = indptr_block_buf;
+    block_csr_array[0].indices = indices_block_buf;
+    block_csr_array[0].data = edges_block_buf;
   } else {
 #pragma omp for
     for (IdType m = 0; m < num_M_blocks; m++) {
@@ -180,7 +253,8 @@ inline void SpMMCreateBlocks(
 /*!
  * \brief Create libxsmm kernel.
  * \param has_idx For the edge features, are there indices available.
- * \param N Feature size.
+ * \param N Feature size handled by the kernel (the width of a feature tile).
+ * \param ld Leading dimension of the feature matrices.
  * \param redop_flag Flag specifying the reduction operation.
  * \param is_cmp Is the reduction operation a compare operation.
  * \note libxsmm_dispatch_meltw_opreduce_vecs_idx creates a JIT'ed kernel.
@@ -201,9 +275,10 @@ template <typename IdType, typename DType, typename Op>
 inline libxsmm_meltwfunction_opreduce_vecs_idx SpMMCreateLibxsmmKernel(
     bool has_idx,
     IdType N,
+    IdType ld,
     libxsmm_meltw_opreduce_vecs_flags redop_flag,
     bool is_cmp) {
-  int _ld = N;
+  int _ld = ld;
   libxsmm_meltw_opreduce_vecs_flags opredop_flags;
   // First, set the Op in the opredop_flags
   if (std::is_same<Op, op::Add<DType>>::value) {
@@ -280,18 +355,21 @@ inline libxsmm_meltwfunction_opreduce_vecs_idx SpMMCreateLibxsmmKernel(
  * \param num_M_blocks Number of blocks to create along the rows of adjacency matrix.
  * \param num_K_blocks Number of blocks to create along the columns of adjacency matrix.
  * \param M_block_size block size along the rows of adjacency matrix.
- * \param kernel The libxsmm kernel.
+ * \param row_order The rows of the row tiles, nullptr for the natural order.
+ * \param N_start Offset of the feature tile.
+ * \param kernel The libxsmm kernel for the feature tile.
  */
 template <typename IdType, typename DType>
 inline void SpMMBlockwiseOpSum(
     CSRMatrixInternal<IdType, IdType> *block_csr_array,
     const DType *B, const DType *E, DType *C, bool has_idx, IdType N,
     IdType num_M_blocks, IdType num_K_blocks, IdType M_block_size,
+    const IdType *row_order, IdType N_start,
     libxsmm_meltwfunction_opreduce_vecs_idx kernel) {
 
-  DType (*in_matrix1)[N] = (DType (*)[N])B;
-  DType (*in_matrix2)[N] = (DType (*)[N])E;
-  DType (*output)[N] = (DType (*)[N])C;
+  DType (*in_matrix1)[N] = (DType (*)[N])(B + N_start);
+  DType (*in_matrix2)[N] = (DType (*)[N])(E + N_start);
+  DType (*output)[N] = (DType (*)[N])(C + N_start);
 #pragma omp parallel
   {
     for (IdType k = 0; k < num_K_blocks; k++) {
@@ -303,7 +381,7 @@ inline void SpMMBlockwiseOpSum(
         for (IdType i = 0; i < cur_csr.num_rows; i++) {
           const IdType row_start = cur_csr.indptr[i];
           const IdType row_end   = cur_csr.indptr[i + 1];
-          const IdType dst = i + M_start;
+          const IdType dst = row_order ? row_order[i + M_start] : i + M_start;
 
           libxsmm_meltw_opreduce_vecs_idx_param params;
           params.n = row_end - row_start;
@@ -337,7 +415,9 @@ inline void SpMMBlockwiseOpSum(
  * \param num_M_blocks Number of blocks to create along the rows of adjacency matrix.
  * \param num_K_blocks Number of blocks to create along the columns of adjacency matrix.
  * \param M_block_size block size along the rows of adjacency matrix.
- * \param kernel The libxsmm kernel.
+ * \param row_order The rows of the row tiles, nullptr for the natural order.
+ * \param N_start Offset of the feature tile.
+ * \param kernel The libxsmm kernel for the feature tile.
  */
 template <typename IdType, typename DType, typename Op, typename Cmp>
 inline void SpMMBlockwiseOpCmp(
@@ -345,13 +425,14 @@ inline void SpMMBlockwiseOpCmp(
     const DType *B, const DType *E, DType *C, IdType *argB, IdType *argE,
     bool has_idx, IdType N,
     IdType num_M_blocks, IdType num_K_blocks, IdType M_block_size,
+    const IdType *row_order, IdType N_start,
     libxsmm_meltwfunction_opreduce_vecs_idx kernel) {
 
-  DType (*in_matrix1)[N] = (DType (*)[N])B;
-  DType (*in_matrix2)[N] = (DType (*)[N])E;
-  DType (*output)[N] = (DType (*)[N])C;
-  IdType (*out_matrix1)[N] = (IdType (*)[N])argB;
-  IdType (*out_matrix2)[N] = (IdType (*)[N])argE;
+  DType (*in_matrix1)[N] = (DType (*)[N])(B + N_start);
+  DType (*in_matrix2)[N] = (DType (*)[N])(E + N_start);
+  DType (*output)[N] = (DType (*)[N])(C + N_start);
+  IdType (*out_matrix1)[N] = (IdType (*)[N])(argB + N_start);
+  IdType (*out_matrix2)[N] = (IdType (*)[N])(argE + N_start);
 
 #pragma omp parallel
   {
@@ -364,7 +445,7 @@ inline void SpMMBlockwiseOpCmp(
         for (IdType i = 0; i < cur_csr.num_rows; i++) {
           const IdType row_start = cur_csr.indptr[i];
           const IdType row_end   = cur_csr.indptr[i + 1];
-          const IdType dst = i + M_start;
+          const IdType dst = row_order ? row_order[i + M_start] : i + M_start;
 
           libxsmm_meltw_opreduce_vecs_idx_param params;
           params.n = row_end - row_start;
@@ -394,23 +475,172 @@ inline void SpMMBlockwiseOpCmp(
  * \param num_K_blocks Number of blocks to create along the columns of adjacency matrix.
  * \param use_lhs Whether to use lhs.
  * \param use_rhs Whether to use rhs.
+ * \param reordered Whether the rows were reordered when creating the blocks.
  */
 template <typename IdType>
 inline void SpMMFreeBlocks(
     CSRMatrixInternal<IdType, IdType> *block_csr_array,
     IdType num_M_blocks, IdType num_K_blocks,
-    bool use_lhs, bool use_rhs) {
+    bool use_lhs, bool use_rhs, bool reordered = false) {
 
-  if (num_K_blocks > 1) {
+  if (num_K_blocks > 1 || reordered) {
     free(block_csr_array[0].indptr);
-    if (use_lhs)
-      free(block_csr_array[0].indices);
-    if (use_rhs)
-      free(block_csr_array[0].data);
+    free(block_csr_array[0].indices);
+    free(block_csr_array[0].data);
   }
   free(block_csr_array);
 }
 
+/*!
+ * \brief The blocking of a CSR matrix for the libxsmm SpMM kernels.
+ *
+ * Building the blocks is a sizeable part of an SpMM call, so the blocking is
+ * cached and reused as long as the same CSR arrays are passed in with the same
+ * blocking parameters. The cache entry holds references to the CSR arrays, so
+ * their memory cannot be recycled for another graph while the entry is alive.
+ */
+template <typename IdType>
+struct SpMMBlocking {
+  /*! \brief The source CSR arrays. */
+  NDArray indptr, indices, data;
+  IdType num_M_blocks, num_K_blocks;
+  IdType M_block_size, K_block_size;
+  bool use_lhs, use_rhs;
+  /*! \brief The rows of the row tiles; empty for the natural order. */
+  std::vector<IdType> row_order;
+  CSRMatrixInternal<IdType, IdType> *block_csr_array = nullptr;
+
+  ~SpMMBlocking() {
+    if (block_csr_array)
+      SpMMFreeBlocks(block_csr_array, num_M_blocks, num_K_blocks, use_lhs, use_rhs,
+                     !row_order.empty());
+  }
+
+  const IdType *RowOrder() const {
+    return row_order.empty() ? nullptr : row_order.data();
+  }
+
+  bool Match(const CSRMatrix& csr, IdType M_bs, IdType K_bs,
+             bool lhs, bool rhs, bool reorder) const {
+    return indptr.same_as(csr.indptr) && indices.same_as(csr.indices) &&
+      data.same_as(csr.data) &&
+      M_block_size == M_bs && K_block_size == K_bs &&
+      use_lhs == lhs && use_rhs == rhs && row_order.empty() != reorder;
+  }
+};
+
+/*!
+ * \brief Build the blocking of a CSR matrix.
+ * \param csr The Csr matrix.
+ * \param M_block_size block size along the rows of adjacency matrix.
+ * \param K_block_size block size along the columns of adjacency matrix.
+ * \param use_lhs Whether to use lhs.
+ * \param use_rhs Whether to use rhs.
+ * \param reorder Whether to reorder the rows by degree.
+ */
+template <typename IdType>
+std::shared_ptr<SpMMBlocking<IdType>> SpMMBuildBlocking(
+    const CSRMatrix& csr, IdType M_block_size, IdType K_block_size,
+    bool use_lhs, bool use_rhs, bool reorder) {
+  auto blocking = std::make_shared<SpMMBlocking<IdType>>();
+  blocking->indptr = csr.indptr;
+  blocking->indices = csr.indices;
+  blocking->data = csr.data;
+  blocking->M_block_size = M_block_size;
+  blocking->K_block_size = K_block_size;
+  blocking->use_lhs = use_lhs;
+  blocking->use_rhs = use_rhs;
+  const IdType M = csr.num_rows, K = csr.num_cols;
+  blocking->num_M_blocks = (M + M_block_size - 1) / M_block_size;
+  blocking->num_K_blocks = (K + K_block_size - 1) / K_block_size;
+  if (reorder)
+    blocking->row_order = SpMMDegreeRowOrder<IdType>(csr);
+  blocking->block_csr_array =
+    (CSRMatrixInternal<IdType, IdType> *)aligned_alloc(64,
+      sizeof(CSRMatrixInternal<IdType, IdType>) *
+      blocking->num_M_blocks * blocking->num_K_blocks);
+  SpMMCreateBlocks(csr, blocking->block_csr_array, blocking->num_M_blocks,
+                   blocking->num_K_blocks, M_block_size, K_block_size,
+                   use_lhs, use_rhs, blocking->RowOrder());
+  return blocking;
+}
+
+/*!
+ * \brief Get the blocking of a CSR matrix, building it on a cache miss.
+ * \param csr The Csr matrix.
+ * \param M_block_size block size along the rows of adjacency matrix.
+ * \param K_block_size block size along the columns of adjacency matrix.
+ * \param use_lhs Whether to use lhs.
+ * \param use_rhs Whether to use rhs.
+ * \param reorder Whether to reorder the rows by degree.
+ * \note The cache keeps the BLOCKING_CACHE_CAPACITY most recently used
+ *       blockings. It is only used for matrices without a plan cache.
+ */
+template <typename IdType>
+std::shared_ptr<SpMMBlocking<IdType>> SpMMGetBlocking(
+    const CSRMatrix& csr, IdType M_block_size, IdType K_block_size,
+    bool use_lhs, bool use_rhs, bool reorder) {
+  static std::mutex mtx;
+  static std::list<std::shared_ptr<SpMMBlocking<IdType>>> cache;
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    for (auto it = cache.begin(); it != cache.end(); ++it) {
+      if ((*it)->Match(csr, M_block_size, K_block_size, use_lhs, use_rhs, reorder)) {
+        cache.splice(cache.begin(), cache, it);
+        return cache.front();
+      }
+    }
+  }
+
+  auto blocking = SpMMBuildBlocking<IdType>(
+      csr, M_block_size, K_block_size, use_lhs, use_rhs, reorder);
+
+  std::lock_guard<std::mutex> lock(mtx);
+  cache.push_front(blocking);
+  if (cache.size() > BLOCKING_CACHE_CAPACITY)
+    cache.pop_back();
+  return blocking;
+}
+
+/*!
+ * \brief Create the libxsmm kernels of all feature tiles.
+ * \param has_idx For the edge features, are there indices available.
+ * \param N Feature size.
+ * \param N_block_size Feature tile size.
+ */
+template <typename IdType, typename DType, typename Op, typename Redop>
+std::vector<libxsmm_meltwfunction_opreduce_vecs_idx> SpMMCreateTileKernels(
+    bool has_idx, IdType N, IdType N_block_size) {
+  std::vector<libxsmm_meltwfunction_opreduce_vecs_idx> kernels;
+  for (IdType N_start = 0; N_start < N; N_start += N_block_size) {
+    const IdType cur_N_block_size = std::min(N_block_size, N - N_start);
+    libxsmm_meltwfunction_opreduce_vecs_idx kernel = nullptr;
+    if (std::is_same<Redop, op::Max<DType>>::value) {
+      kernel = SpMMCreateLibxsmmKernel<IdType, DType, Op>(
+          has_idx, cur_N_block_size, N, LIBXSMM_MELTW_FLAG_OPREDUCE_VECS_REDOP_MAX, true);
+    } else if (std::is_same<Redop, op::Min<DType>>::value) {
+      kernel = SpMMCreateLibxsmmKernel<IdType, DType, Op>(
+          has_idx, cur_N_block_size, N, LIBXSMM_MELTW_FLAG_OPREDUCE_VECS_REDOP_MIN, true);
+    } else if (std::is_same<Redop, op::Add<DType>>::value) {
+      kernel = SpMMCreateLibxsmmKernel<IdType, DType, Op>(
+          has_idx, cur_N_block_size, N, LIBXSMM_MELTW_FLAG_OPREDUCE_VECS_REDOP_SUM, false);
+    }
+    kernels.push_back(kernel);
+  }
+  return kernels;
+}
+
+/*!
+ * \brief The execution plan of the libxsmm SpMM kernels on one CSR matrix:
+ *        the blocking of the matrix and the kernels of all feature tiles.
+ *        It is stored in the kernel plan cache of the matrix.
+ */
+template <typename IdType, typename DType, typename Op, typename Redop>
+struct SpMMLibxsmmPlan {
+  std::shared_ptr<SpMMBlocking<IdType>> blocking;
+  std::vector<libxsmm_meltwfunction_opreduce_vecs_idx> kernels;
+};
+
 /*!
  * \brief Optimized CPU kernel of SpMM-Sum/Max/Min on Csr format.
  * \param bcast Broadcast information.
@@ -420,7 +650,11 @@ inline void SpMMFreeBlocks(
  * \param out The result feature on destination nodes.
  * \param argu Arg-Min/Max on source nodes.
  * \param arge Arg-Min/Max on edges.
- * \note it uses libxsmm, blocking and dynamic thread scheduling.
+ * \param plan_cache The kernel plan cache of csr, may be null.
+ * \note it uses libxsmm, blocking and dynamic thread scheduling. Features wider
+ *       than FEATURE_BLOCK_BYTES are processed tile by tile. The blocking and
+ *       the kernels are kept in plan_cache if given, otherwise the blocking is
+ *       reused through SpMMGetBlocking.
  */
 template <typename IdType, typename DType, typename Op, typename Redop>
 void SpMMRedopCsrOpt(
@@ -428,7 +662,8 @@ void SpMMRedopCsrOpt(
     const CSRMatrix& csr,
     NDArray ufeat, NDArray efeat,
     NDArray out,
-    NDArray argu, NDArray arge) {
+    NDArray argu, NDArray arge,
+    KernelPlanCache* plan_cache = nullptr) {
 
   int32_t llc_size = GetLLCSize();
 
@@ -460,19 +695,18 @@ void SpMMRedopCsrOpt(
   const double avg_degree = total_nnz * 1.0 / M;
   const double nnz_prob = avg_degree / K;
 
-  IdType K_block_size = std::min((int64_t)K, (int64_t)(llc_size / (N * sizeof(DType) *
+  // Tile the feature dimension so that a column block is sized for the
+  // feature tile instead of the full feature width.
+  const IdType max_N_block_size = std::max<IdType>(1, FEATURE_BLOCK_BYTES / sizeof(DType));
+  const IdType N_block_size = std::min(N, max_N_block_size);
+  const IdType num_N_blocks = (N + N_block_size - 1) / N_block_size;
+
+  IdType K_block_size = std::min((int64_t)K, (int64_t)(llc_size / (N_block_size * sizeof(DType) *
                                                        nnz_prob * BLOCKING_HEURISTIC_PARAM)));
   IdType M_block_size = M / (nthreads * NUM_BLOCKS_PER_THREAD);
   if (M_block_size == 0) M_block_size = 1;
   if (K_block_size == 0) K_block_size = 1;
 
-  IdType num_M_blocks = (M + M_block_size - 1) / M_block_size;
-  IdType num_K_blocks = (K + K_block_size - 1) / K_block_size;
-
-  CSRMatrixInternal<IdType, IdType> *block_csr_array =
-    (CSRMatrixInternal<IdType, IdType> *)aligned_alloc(64,
-      sizeof(CSRMatrixInternal<IdType, IdType>) * num_M_blocks * num_K_blocks);
-
 #ifdef DEBUG
   endTick = __rdtsc();
   if (std::is_same<Redop, op::Max<DType>>::value) {
@@ -489,60 +723,60 @@ void SpMMRedopCsrOpt(
   LOG(INFO) << "has_idx = " << has_idx;
   LOG(INFO) << "nnz_prob = " << nnz_prob;
   LOG(INFO) << "K_block_size = " << K_block_size << ", M_block_size = " << M_block_size;
-  LOG(INFO) << "num_K_blocks = " << num_K_blocks << ", num_M_blocks = " << num_M_blocks;
+  LOG(INFO) << "N_block_size = " << N_block_size << ", num_N_blocks = " << num_N_blocks;
   LOG(INFO) << "stage0 ticks = " << (endTick - startTick);
   startTick = __rdtsc();
 #endif  // DEBUG
 
-  SpMMCreateBlocks(csr, block_csr_array, num_M_blocks, num_K_blocks, M_block_size, K_block_size,
-                   Op::use_lhs, Op::use_rhs);
+  const bool reorder = SpMMReorderRowsEnabled();
+  std::shared_ptr<SpMMBlocking<IdType>> blocking;
+  std::vector<libxsmm_meltwfunction_opreduce_vecs_idx> kernels;
+  if (plan_cache) {
+    typedef SpMMLibxsmmPlan<IdType, DType, Op, Redop> Plan;
+    std::ostringstream key;
+    key << typeid(Plan).name() << '_' << has_idx << '_' << N << '_'
+        << M_block_size << '_' << K_block_size << '_' << reorder;
+    std::shared_ptr<Plan> plan = plan_cache->GetOrCreate<Plan>(key.str(), [&]() {
+      auto p = std::make_shared<Plan>();
+      p->blocking = SpMMBuildBlocking<IdType>(
+          csr, M_block_size, K_block_size, Op::use_lhs, Op::use_rhs, reorder);
+      p->kernels = SpMMCreateTileKernels<IdType, DType, Op, Redop>(has_idx, N, N_block_size);
+      return p;
+    });
+    blocking = plan->blocking;
+    kernels = plan->kernels;
+  } else {
+    blocking = SpMMGetBlocking<IdType>(
+        csr, M_block_size, K_block_size, Op::use_lhs, Op::use_rhs, reorder);
+    kernels = SpMMCreateTileKernels<IdType, DType, Op, Redop>(has_idx, N, N_block_size);
+  }
+  const IdType num_M_blocks = blocking->num_M_blocks;
+  const IdType num_K_blocks = blocking->num_K_blocks;
 
 #ifdef DEBUG
   endTick = __rdtsc();
+  LOG(INFO) << "num_K_blocks = " << num_K_blocks << ", num_M_blocks = " << num_M_blocks;
   LOG(INFO) << "stage1 ticks = " << (endTick - startTick);
   startTick = __rdtsc();
 #endif  // DEBUG
 
-  libxsmm_meltwfunction_opreduce_vecs_idx kernel = nullptr;
-  if (std::is_same<Redop, op::Max<DType>>::value) {
-    kernel = SpMMCreateLibxsmmKernel<IdType, DType, Op>(has_idx, N,
-                                                        LIBXSMM_MELTW_FLAG_OPREDUCE_VECS_REDOP_MAX,
-                                                        true);
-  } else if (std::is_same<Redop, op::Min<DType>>::value) {
-    kernel = SpMMCreateLibxsmmKernel<IdType, DType, Op>(has_idx, N,
-                                                        LIBXSMM_MELTW_FLAG_OPREDUCE_VECS_REDOP_MIN,
-                                                        true);
-  } else if (std::is_same<Redop, op::Add<DType>>::value) {
-    kernel = SpMMCreateLibxsmmKernel<IdType, DType, Op>(has_idx, N,
-                                                        LIBXSMM_MELTW_FLAG_OPREDUCE_VECS_REDOP_SUM,
-                                                        false);
+  for (IdType n = 0; n < num_N_blocks; n++) {
+    const IdType N_start = n * N_block_size;
+    libxsmm_meltwfunction_opreduce_vecs_idx kernel = kernels[n];
+    if (std::is_same<Redop, op::Max<DType>>::value || std::is_same<Redop, op::Min<DType>>::value) {
+      SpMMBlockwiseOpCmp<IdType, DType, Op, Redop>(
+          blocking->block_csr_array, B, E, C, argB, argE, has_idx, N,
+          num_M_blocks, num_K_blocks, M_block_size, blocking->RowOrder(), N_start, kernel);
+    } else {
+      SpMMBlockwiseOpSum(
+          blocking->block_csr_array, B, E, C, has_idx, N,
+          num_M_blocks, num_K_blocks, M_block_size, blocking->RowOrder(), N_start, kernel);
+    }
   }
 
 #ifdef DEBUG
   endTick = __rdtsc();
   LOG(INFO) << "stage2 ticks = " << (endTick - startTick);
-  startTick = __rdtsc();
-#endif  // DEBUG
-
-  if (std::is_same<Redop, op::Max<DType>>::value || std::is_same<Redop, op::Min<DType>>::value) {
-    SpMMBlockwiseOpCmp<IdType, DType, Op, Redop>(block_csr_array, B, E, C, argB, argE, has_idx, N,
-                                                 num_M_blocks, num_K_blocks, M_block_size, kernel);
-  } else {
-    SpMMBlockwiseOpSum(block_csr_array, B, E, C, has_idx, N, num_M_blocks, num_K_blocks,
-                       M_block_size, kernel);
-  }
-
-#ifdef DEBUG
-  endTick = __rdtsc();
-  LOG(INFO) << "stage3 ticks = " << (endTick - startTick);
-  startTick = __rdtsc();
-#endif  // DEBUG
-
-  SpMMFreeBlocks(block_csr_array, num_M_blocks, num_K_blocks, Op::use_lhs, Op::use_rhs);
-
-#ifdef DEBUG
-  endTick = __rdtsc();
-  LOG(INFO) << "stage4 ticks = " << (endTick - startTick);
 #endif  // DEBUG
 }
 
@@ -553,13 +787,16 @@ void SpMMRedopCsrOpt(
  * \param ufeat The feature on source nodes.
  * \param efeat The feature on edges.
  * \param out The result feature on destination nodes.
+ * \param plan_cache The kernel plan cache of csr, may be null.
  * \note it uses libxsmm, blocking and dynamic thread scheduling.
  */
 template <typename IdType, typename DType, typename Op>
 void SpMMSumCsrLibxsmm(const BcastOff& bcast, const CSRMatrix& csr,
-                   NDArray ufeat, NDArray efeat, NDArray out) {
+                   NDArray ufeat, NDArray efeat, NDArray out,
+                   KernelPlanCache* plan_cache = nullptr) {
   NDArray dummy;
-  SpMMRedopCsrOpt<IdType, DType, Op, op::Add<DType>>(bcast, csr, ufeat, efeat, out, dummy, dummy);
+  SpMMRedopCsrOpt<IdType, DType, Op, op::Add<DType>>(
+      bcast, csr, ufeat, efeat, out, dummy, dummy, plan_cache);
 }
 
 /*!
@@ -571,12 +808,14 @@ void SpMMSumCsrLibxsmm(const BcastOff& bcast, const CSRMatrix& csr,
  * \param out The result feature on destination nodes.
  * \param argu Arg-Min/Max on source nodes.
  * \param arge Arg-Min/Max on edges.
+ * \param plan_cache The kernel plan cache of csr, may be null.
  * \note it uses libxsmm, blocking and dynamic thread scheduling.
  */
 template <typename IdType, typename DType, typename Op, typename Cmp>
 void SpMMCmpCsrLibxsmm(const BcastOff& bcast, const CSRMatrix& csr, NDArray ufeat,
-                   NDArray efeat, NDArray out, NDArray argu, NDArray arge) {
-  SpMMRedopCsrOpt<IdType, DType, Op, Cmp>(bcast, csr, ufeat, efeat, out, argu, arge);
+                   NDArray efeat, NDArray out, NDArray argu, NDArray arge,
+                   KernelPlanCache* plan_cache = nullptr) {
+  SpMMRedopCsrOpt<IdType, DType, Op, Cmp>(bcast, csr, ufeat, efeat, out, argu, arge, plan_cache);
 }
 
 }  // namespace cpu
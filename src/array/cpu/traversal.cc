@@ -5,43 +5,19 @@
  */
 
 #include <dgl/graph_traversal.h>
+#include <dgl/runtime/parallel_for.h>
 #include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
 #include <queue>
+#include <tuple>
 #include "./traversal.h"
 
 namespace dgl {
 namespace aten {
 namespace impl {
 namespace {
-// A utility view class to wrap a vector into a queue.
-template<typename DType>
-struct VectorQueueWrapper {
-  std::vector<DType>* vec;
-  size_t head = 0;
-
-  explicit VectorQueueWrapper(std::vector<DType>* vec): vec(vec) {}
-
-  void push(const DType& elem) {
-    vec->push_back(elem);
-  }
-
-  DType top() const {
-    return vec->operator[](head);
-  }
-
-  void pop() {
-    ++head;
-  }
-
-  bool empty() const {
-    return head == vec->size();
-  }
-
-  size_t size() const {
-    return vec->size() - head;
-  }
-};
-
 // Internal function to merge multiple traversal traces into one ndarray.
 // It is similar to zip the vectors together.
 template<typename DType>
@@ -94,21 +70,200 @@ IdArray ComputeMergedSections(
   return ret;
 }
 
-}  // namespace
+// Split a frontier in chunks of about the same number of nodes and edges, given
+// the number of edges of the frontier nodes before each of them.
+std::vector<int64_t> ChunkBounds(const std::vector<int64_t>& prefix, int64_t num_chunks) {
+  const int64_t size = prefix.size() - 1;
+  std::vector<int64_t> bounds(num_chunks + 1, size);
+  for (int64_t k = 0; k < num_chunks; ++k) {
+    const int64_t target = (prefix[size] + size) * k / num_chunks;
+    int64_t lo = 0, hi = size;
+    while (lo < hi) {
+      const int64_t mid = (lo + hi) / 2;
+      if (prefix[mid] + mid < target)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    bounds[k] = lo;
+  }
+  return bounds;
+}
 
-template <DLDeviceType XPU, typename IdType>
-Frontiers BFSNodesFrontiers(const CSRMatrix& csr, IdArray source) {
+// The parameters of Beamer et al. for switching the direction of the BFS: go
+// bottom-up once the frontier has more than 1 / alpha of the edges of the
+// unvisited nodes, and back top-down once it has less than 1 / beta of the nodes.
+constexpr int64_t kBFSAlpha = 14;
+constexpr int64_t kBFSBeta = 24;
+
+// Parallel direction-optimizing BFS returning the frontiers of BFSTraverseNodes,
+// or the edges of BFSTraverseEdges, in the same order.
+//
+// The serial BFS discovers a node from the first edge to it when expanding the
+// frontier in order, so the nodes of the next frontier are ordered by the rank
+// of that edge in the expansion, i.e. the number of edges of the frontier
+// nodes before it. The top-down steps take the lowest rank of every new node
+// with an atomic minimum, then emit the nodes from their winning edge, by
+// chunks of the frontier. The bottom-up steps scan the in-edges of the
+// unvisited nodes in the transpose for the parents in the frontier, taking
+// every parent for its lowest rank, then sort the nodes by rank.
+template <typename IdType>
+Frontiers ParallelBFS(const CSRMatrix& csr, const CSRMatrix& transpose, IdArray source,
+                      bool return_edges) {
+  const int64_t num_nodes = csr.num_rows;
+  const int64_t num_edges = csr.indices->shape[0];
+  const IdType* indptr = csr.indptr.Ptr<IdType>();
+  const IdType* indices = csr.indices.Ptr<IdType>();
+  const IdType* eids = CSRHasData(csr) ? csr.data.Ptr<IdType>() : nullptr;
+  const bool bottom_up_enabled = transpose.indptr.defined() && transpose.num_rows == num_nodes;
+  const IdType* t_indptr = bottom_up_enabled ? transpose.indptr.Ptr<IdType>() : nullptr;
+  const IdType* t_indices = bottom_up_enabled ? transpose.indices.Ptr<IdType>() : nullptr;
+  const IdType* t_eids = bottom_up_enabled && CSRHasData(transpose) ?
+    transpose.data.Ptr<IdType>() : nullptr;
+  const int64_t num_chunks = std::max(1, omp_get_max_threads());
+  const int64_t kNone = std::numeric_limits<int64_t>::max();
+
+  std::unique_ptr<std::atomic<int64_t>[]> rank(new std::atomic<int64_t>[num_nodes]);
+  runtime::parallel_for(0, num_nodes, [&](size_t b, size_t e) {
+    for (size_t i = b; i < e; ++i)
+      rank[i].store(kNone, std::memory_order_relaxed);
+  });
+  std::vector<uint8_t> visited(num_nodes, 0);
+  // the position in the frontier of the frontier nodes and the position in csr
+  // of the edges by ID, for the bottom-up steps
+  std::vector<int64_t> frontier_pos, edge_pos;
+
+  const int64_t len = source->shape[0];
+  const IdType* src_data = source.Ptr<IdType>();
+  std::vector<IdType> frontier(src_data, src_data + len);
+  // the edges of the unvisited nodes in the transpose
+  int64_t unvisited_edges = num_edges;
+  for (const IdType u : frontier) {
+    CHECK(u >= 0 && u < num_nodes) << "Invalid source node " << u;
+    if (!visited[u] && bottom_up_enabled)
+      unvisited_edges -= t_indptr[u + 1] - t_indptr[u];
+    visited[u] = 1;
+  }
   std::vector<IdType> ids;
   std::vector<int64_t> sections;
-  VectorQueueWrapper<IdType> queue(&ids);
-  auto visit = [&] (const int64_t v) { };
-  auto make_frontier = [&] () {
-      if (!queue.empty()) {
-        // do not push zero-length frontier
-        sections.push_back(queue.size());
+  if (!return_edges) {
+    ids = frontier;
+    if (len > 0)
+      sections.push_back(len);
+  }
+
+  std::vector<int64_t> prefix;
+  std::vector<std::vector<std::tuple<int64_t, IdType, IdType>>> found(num_chunks);
+  bool bottom_up = false;
+  while (!frontier.empty()) {
+    const int64_t size = frontier.size();
+    prefix.resize(size + 1);
+    prefix[0] = 0;
+    for (int64_t i = 0; i < size; ++i)
+      prefix[i + 1] = prefix[i] + indptr[frontier[i] + 1] - indptr[frontier[i]];
+    if (bottom_up_enabled) {
+      if (!bottom_up && prefix[size] > unvisited_edges / kBFSAlpha)
+        bottom_up = true;
+      else if (bottom_up && size < num_nodes / kBFSBeta)
+        bottom_up = false;
+    }
+
+    if (!bottom_up) {
+      const std::vector<int64_t> bounds = ChunkBounds(prefix, num_chunks);
+      // the same function emits the winning edges of the chunk once the ranks are taken
+      auto expand = [&](int64_t k, bool emit) {
+        for (int64_t i = bounds[k]; i < bounds[k + 1]; ++i) {
+          const IdType u = frontier[i];
+          for (IdType idx = indptr[u]; idx < indptr[u + 1]; ++idx) {
+            const IdType v = indices[idx];
+            if (visited[v])
+              continue;
+            const int64_t r = prefix[i] + idx - indptr[u];
+            if (emit) {
+              if (rank[v].load(std::memory_order_relaxed) == r)
+                found[k].emplace_back(r, v, eids ? eids[idx] : idx);
+              continue;
+            }
+            int64_t cur = rank[v].load(std::memory_order_relaxed);
+            while (r < cur && !rank[v].compare_exchange_weak(cur, r, std::memory_order_relaxed)) {}
+          }
+        }
+      };
+      runtime::parallel_for(0, num_chunks, 1, [&](size_t b, size_t e) {
+        for (size_t k = b; k < e; ++k)
+          expand(k, false);
+      });
+      runtime::parallel_for(0, num_chunks, 1, [&](size_t b, size_t e) {
+        for (size_t k = b; k < e; ++k)
+          expand(k, true);
+      });
+    } else {
+      if (frontier_pos.empty())
+        frontier_pos.assign(num_nodes, -1);
+      if (eids && edge_pos.empty()) {
+        edge_pos.resize(num_edges);
+        runtime::parallel_for(0, num_edges, [&](size_t b, size_t e) {
+          for (size_t j = b; j < e; ++j)
+            edge_pos[eids[j]] = j;
+        });
       }
-    };
-  BFSTraverseNodes<IdType>(csr, source, &queue, visit, make_frontier);
+      // the first position of a node, for the sources given several times
+      for (int64_t i = size - 1; i >= 0; --i)
+        frontier_pos[frontier[i]] = i;
+      runtime::parallel_for(0, num_chunks, 1, [&](size_t b, size_t e) {
+        for (size_t k = b; k < e; ++k) {
+          const int64_t end = num_nodes * (k + 1) / num_chunks;
+          for (int64_t v = num_nodes * k / num_chunks; v < end; ++v) {
+            if (visited[v])
+              continue;
+            int64_t best = kNone;
+            IdType best_eid = 0;
+            for (IdType j = t_indptr[v]; j < t_indptr[v + 1]; ++j) {
+              const IdType p = t_indices[j];
+              const int64_t pos = frontier_pos[p];
+              if (pos < 0)
+                continue;
+              const IdType eid = t_eids ? t_eids[j] : j;
+              const int64_t r = prefix[pos] + (eids ? edge_pos[eid] : eid) - indptr[p];
+              if (r < best) {
+                best = r;
+                best_eid = eid;
+              }
+            }
+            if (best != kNone)
+              found[k].emplace_back(best, v, best_eid);
+          }
+        }
+      });
+      for (const IdType u : frontier)
+        frontier_pos[u] = -1;
+    }
+
+    int64_t next_size = 0;
+    for (const auto& chunk : found)
+      next_size += chunk.size();
+    std::vector<std::tuple<int64_t, IdType, IdType>> next;
+    next.reserve(next_size);
+    for (auto& chunk : found) {
+      next.insert(next.end(), chunk.begin(), chunk.end());
+      chunk.clear();
+    }
+    // the top-down chunks are in order already
+    if (bottom_up)
+      std::sort(next.begin(), next.end());
+
+    frontier.resize(next_size);
+    for (int64_t i = 0; i < next_size; ++i) {
+      const IdType v = std::get<1>(next[i]);
+      frontier[i] = v;
+      visited[v] = 1;
+      if (bottom_up_enabled)
+        unvisited_edges -= t_indptr[v + 1] - t_indptr[v];
+      ids.push_back(return_edges ? std::get<2>(next[i]) : v);
+    }
+    if (next_size > 0)
+      sections.push_back(next_size);
+  }
 
   Frontiers front;
   front.ids = VecToIdArray(ids, sizeof(IdType) * 8);
@@ -116,55 +271,131 @@ Frontiers BFSNodesFrontiers(const CSRMatrix& csr, IdArray source) {
   return front;
 }
 
-template Frontiers BFSNodesFrontiers<kDLCPU, int32_t>(const CSRMatrix&, IdArray);
-template Frontiers BFSNodesFrontiers<kDLCPU, int64_t>(const CSRMatrix&, IdArray);
+// Parallel Kahn's algorithm returning the frontiers of TopologicalNodes in the
+// same order.
+//
+// The serial traversal appends a node to the next frontier on the last edge to
+// it when expanding the frontier in order, so the nodes of the next frontier
+// are ordered by the highest rank of the edges from the frontier to them. Every
+// step takes the in-degrees down with atomic counters, then the highest rank of
+// every node reaching a zero in-degree with an atomic maximum, then emits the
+// nodes from their last edge, by chunks of the frontier of about the same number
+// of edges. The ranks are only taken on the step of a node, so they are never
+// reset.
+template <typename IdType>
+Frontiers ParallelTopologicalNodes(const CSRMatrix& csr) {
+  const int64_t num_nodes = csr.num_rows;
+  const int64_t num_edges = csr.indices->shape[0];
+  const IdType* indptr = csr.indptr.Ptr<IdType>();
+  const IdType* indices = csr.indices.Ptr<IdType>();
+  const int64_t num_chunks = std::max(1, omp_get_max_threads());
 
-template <DLDeviceType XPU, typename IdType>
-Frontiers BFSEdgesFrontiers(const CSRMatrix& csr, IdArray source) {
+  std::unique_ptr<std::atomic<int64_t>[]> degree(new std::atomic<int64_t>[num_nodes]);
+  std::unique_ptr<std::atomic<int64_t>[]> rank(new std::atomic<int64_t>[num_nodes]);
+  runtime::parallel_for(0, num_nodes, [&](size_t b, size_t e) {
+    for (size_t i = b; i < e; ++i) {
+      degree[i].store(0, std::memory_order_relaxed);
+      rank[i].store(-1, std::memory_order_relaxed);
+    }
+  });
+  runtime::parallel_for(0, num_edges, [&](size_t b, size_t e) {
+    for (size_t j = b; j < e; ++j)
+      degree[indices[j]].fetch_add(1, std::memory_order_relaxed);
+  });
+
+  // the nodes without in-edges in increasing order, compacted by chunks
+  std::vector<std::vector<IdType>> found(num_chunks);
+  runtime::parallel_for(0, num_chunks, 1, [&](size_t b, size_t e) {
+    for (size_t k = b; k < e; ++k) {
+      const int64_t end = num_nodes * (k + 1) / num_chunks;
+      for (int64_t v = num_nodes * k / num_chunks; v < end; ++v) {
+        if (degree[v].load(std::memory_order_relaxed) == 0)
+          found[k].push_back(v);
+      }
+    }
+  });
   std::vector<IdType> ids;
   std::vector<int64_t> sections;
-  // NOTE: std::queue has no top() method.
-  std::vector<IdType> nodes;
-  VectorQueueWrapper<IdType> queue(&nodes);
-  auto visit = [&] (const IdType e) { ids.push_back(e); };
-  bool first_frontier = true;
-  auto make_frontier = [&] {
-      if (first_frontier) {
-        first_frontier = false;   // do not push the first section when doing edges
-      } else if (!queue.empty()) {
-        // do not push zero-length frontier
-        sections.push_back(queue.size());
+  std::vector<int64_t> prefix;
+  for (;;) {
+    const int64_t begin = ids.size();
+    for (auto& chunk : found) {
+      ids.insert(ids.end(), chunk.begin(), chunk.end());
+      chunk.clear();
+    }
+    if (static_cast<int64_t>(ids.size()) == begin)
+      break;
+    sections.push_back(ids.size() - begin);
+
+    const IdType* frontier = ids.data() + begin;
+    const int64_t size = ids.size() - begin;
+    prefix.resize(size + 1);
+    prefix[0] = 0;
+    for (int64_t i = 0; i < size; ++i)
+      prefix[i + 1] = prefix[i] + indptr[frontier[i] + 1] - indptr[frontier[i]];
+    const std::vector<int64_t> bounds = ChunkBounds(prefix, num_chunks);
+    // the steps of every edge of the chunk, in the order of the expansion
+    auto expand = [&](int64_t k, int step) {
+      for (int64_t i = bounds[k]; i < bounds[k + 1]; ++i) {
+        const IdType u = frontier[i];
+        for (IdType idx = indptr[u]; idx < indptr[u + 1]; ++idx) {
+          const IdType v = indices[idx];
+          const int64_t r = prefix[i] + idx - indptr[u];
+          if (step == 0) {
+            degree[v].fetch_sub(1, std::memory_order_relaxed);
+          } else if (degree[v].load(std::memory_order_relaxed) != 0) {
+            continue;
+          } else if (step == 1) {
+            int64_t cur = rank[v].load(std::memory_order_relaxed);
+            while (r > cur && !rank[v].compare_exchange_weak(cur, r, std::memory_order_relaxed)) {}
+          } else if (rank[v].load(std::memory_order_relaxed) == r) {
+            found[k].push_back(v);
+          }
+        }
       }
     };
-  BFSTraverseEdges<IdType>(csr, source, &queue, visit, make_frontier);
+    for (int step = 0; step < 3; ++step) {
+      runtime::parallel_for(0, num_chunks, 1, [&](size_t b, size_t e) {
+        for (size_t k = b; k < e; ++k)
+          expand(k, step);
+      });
+    }
+  }
 
+  if (static_cast<int64_t>(ids.size()) != num_nodes) {
+    LOG(FATAL) << "Error in topological traversal: loop detected in the given graph.";
+  }
   Frontiers front;
   front.ids = VecToIdArray(ids, sizeof(IdType) * 8);
   front.sections = VecToIdArray(sections, sizeof(int64_t) * 8);
   return front;
 }
 
-template Frontiers BFSEdgesFrontiers<kDLCPU, int32_t>(const CSRMatrix&, IdArray);
-template Frontiers BFSEdgesFrontiers<kDLCPU, int64_t>(const CSRMatrix&, IdArray);
+}  // namespace
 
 template <DLDeviceType XPU, typename IdType>
-Frontiers TopologicalNodesFrontiers(const CSRMatrix& csr) {
-  std::vector<IdType> ids;
-  std::vector<int64_t> sections;
-  VectorQueueWrapper<IdType> queue(&ids);
-  auto visit = [&] (const uint64_t v) { };
-  auto make_frontier = [&] () {
-      if (!queue.empty()) {
-        // do not push zero-length frontier
-        sections.push_back(queue.size());
-      }
-    };
-  TopologicalNodes<IdType>(csr, &queue, visit, make_frontier);
+Frontiers BFSNodesFrontiers(const CSRMatrix& csr, const CSRMatrix& transpose, IdArray source) {
+  return ParallelBFS<IdType>(csr, transpose, source, false);
+}
 
-  Frontiers front;
-  front.ids = VecToIdArray(ids, sizeof(IdType) * 8);
-  front.sections = VecToIdArray(sections, sizeof(int64_t) * 8);
-  return front;
+template Frontiers BFSNodesFrontiers<kDLCPU, int32_t>(const CSRMatrix&, const CSRMatrix&,
+                                                      IdArray);
+template Frontiers BFSNodesFrontiers<kDLCPU, int64_t>(const CSRMatrix&, const CSRMatrix&,
+                                                      IdArray);
+
+template <DLDeviceType XPU, typename IdType>
+Frontiers BFSEdgesFrontiers(const CSRMatrix& csr, const CSRMatrix& transpose, IdArray source) {
+  return ParallelBFS<IdType>(csr, transpose, source, true);
+}
+
+template Frontiers BFSEdgesFrontiers<kDLCPU, int32_t>(const CSRMatrix&, const CSRMatrix&,
+                                                      IdArray);
+template Frontiers BFSEdgesFrontiers<kDLCPU, int64_t>(const CSRMatrix&, const CSRMatrix&,
+                                                      IdArray);
+
+template <DLDeviceType XPU, typename IdType>
+Frontiers TopologicalNodesFrontiers(const CSRMatrix& csr) {
+  return ParallelTopologicalNodes<IdType>(csr);
 }
 
 template Frontiers TopologicalNodesFrontiers<kDLCPU, int32_t>(const CSRMatrix&);
@@ -176,10 +407,13 @@ Frontiers DGLDFSEdges(const CSRMatrix& csr, IdArray source) {
   const IdType* src_data = static_cast<IdType*>(source->data);
   std::vector<std::vector<IdType>> edges(len);
 
-  for (int64_t i = 0; i < len; ++i) {
-    auto visit = [&] (IdType e, int tag) { edges[i].push_back(e); };
-    DFSLabeledEdges<IdType>(csr, src_data[i], false, false, visit);
-  }
+  // the traversals from every source are independent
+  runtime::parallel_for(0, len, 1, [&](size_t b, size_t end) {
+    for (size_t i = b; i < end; ++i) {
+      auto visit = [&] (IdType e, int tag) { edges[i].push_back(e); };
+      DFSLabeledEdges<IdType>(csr, src_data[i], false, false, visit);
+    }
+  });
 
   Frontiers front;
   front.ids = MergeMultipleTraversals(edges);
@@ -205,16 +439,19 @@ Frontiers DGLDFSLabeledEdges(const CSRMatrix& csr,
     tags.resize(len);
   }
 
-  for (int64_t i = 0; i < len; ++i) {
-    auto visit = [&] (IdType e, int64_t tag) {
-      edges[i].push_back(e);
-      if (return_labels) {
-        tags[i].push_back(tag);
-      }
-    };
-    DFSLabeledEdges<IdType>(csr, src_data[i],
-        has_reverse_edge, has_nontree_edge, visit);
-  }
+  // the traversals from every source are independent
+  runtime::parallel_for(0, len, 1, [&](size_t b, size_t end) {
+    for (size_t i = b; i < end; ++i) {
+      auto visit = [&] (IdType e, int64_t tag) {
+        edges[i].push_back(e);
+        if (return_labels) {
+          tags[i].push_back(tag);
+        }
+      };
+      DFSLabeledEdges<IdType>(csr, src_data[i],
+          has_reverse_edge, has_nontree_edge, visit);
+    }
+  });
 
   Frontiers front;
   front.ids = MergeMultipleTraversals(edges);
@@ -0,0 +1,244 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file array/cpu/union_partition.cc
+ * \brief Disjoint union and partition of COO and CSR matrices on CPU
+ */
+#include <dgl/array.h>
+#include <dgl/runtime/parallel_for.h>
+#include <vector>
+
+namespace dgl {
+namespace aten {
+namespace impl {
+
+using runtime::parallel_for_weighted;
+
+namespace {
+
+/*!
+ * \brief Shift the values [begin, end) of an array by offset into out.
+ *
+ * A null input stands for 0 to end - begin - 1, i.e. the missing data array of
+ * a matrix.
+ */
+template <typename IdType>
+inline void CopyShifted(const IdType* in, int64_t begin, int64_t end, int64_t offset,
+                        IdType* out) {
+  if (in) {
+    for (int64_t i = begin; i < end; ++i)
+      out[i - begin] = in[i] + offset;
+  } else {
+    for (int64_t i = begin; i < end; ++i)
+      out[i - begin] = i - begin + offset;
+  }
+}
+
+}  // namespace
+
+///////////////////////// COO Based Operations/////////////////////////
+
+template <DLDeviceType XPU, typename IdType>
+COOMatrix DisjointUnionCoo(const std::vector<COOMatrix>& coos) {
+  const int64_t num_coos = coos.size();
+  const auto& ctx = coos[0].row->ctx;
+  const uint8_t nbits = coos[0].row->dtype.bits;
+  // the offsets of the rows, columns and entries of every matrix in the result
+  std::vector<int64_t> row_offsets(num_coos + 1, 0);
+  std::vector<int64_t> col_offsets(num_coos + 1, 0);
+  std::vector<int64_t> nnz_offsets(num_coos + 1, 0);
+  bool has_data = false, row_sorted = true, col_sorted = true;
+  for (int64_t i = 0; i < num_coos; ++i) {
+    row_offsets[i + 1] = row_offsets[i] + coos[i].num_rows;
+    col_offsets[i + 1] = col_offsets[i] + coos[i].num_cols;
+    nnz_offsets[i + 1] = nnz_offsets[i] + coos[i].row->shape[0];
+    has_data |= COOHasData(coos[i]);
+    row_sorted &= coos[i].row_sorted;
+    col_sorted &= coos[i].col_sorted;
+  }
+
+  const int64_t nnz = nnz_offsets[num_coos];
+  IdArray ret_row = NewIdArray(nnz, ctx, nbits);
+  IdArray ret_col = NewIdArray(nnz, ctx, nbits);
+  IdArray ret_data = has_data ? NewIdArray(nnz, ctx, nbits) : NullArray();
+  IdType* ret_row_data = ret_row.Ptr<IdType>();
+  IdType* ret_col_data = ret_col.Ptr<IdType>();
+  IdType* ret_data_data = has_data ? ret_data.Ptr<IdType>() : nullptr;
+
+  parallel_for_weighted(0, num_coos, nnz_offsets.data(), [&](int64_t b, int64_t e) {
+    for (int64_t i = b; i < e; ++i) {
+      const COOMatrix& coo = coos[i];
+      const int64_t len = nnz_offsets[i + 1] - nnz_offsets[i];
+      const int64_t pos = nnz_offsets[i];
+      CopyShifted(coo.row.Ptr<IdType>(), 0, len, row_offsets[i], ret_row_data + pos);
+      CopyShifted(coo.col.Ptr<IdType>(), 0, len, col_offsets[i], ret_col_data + pos);
+      if (has_data) {
+        CopyShifted(COOHasData(coo) ? coo.data.Ptr<IdType>() : nullptr, 0, len, pos,
+                    ret_data_data + pos);
+      }
+    }
+  });
+
+  return COOMatrix(
+      row_offsets[num_coos], col_offsets[num_coos], ret_row, ret_col, ret_data,
+      row_sorted, col_sorted);
+}
+
+template COOMatrix DisjointUnionCoo<kDLCPU, int32_t>(const std::vector<COOMatrix>&);
+template COOMatrix DisjointUnionCoo<kDLCPU, int64_t>(const std::vector<COOMatrix>&);
+
+template <DLDeviceType XPU, typename IdType>
+std::vector<COOMatrix> DisjointPartitionCooBySizes(
+    const COOMatrix &coo,
+    const uint64_t batch_size,
+    const std::vector<uint64_t> &edge_cumsum,
+    const std::vector<uint64_t> &src_vertex_cumsum,
+    const std::vector<uint64_t> &dst_vertex_cumsum) {
+  const auto& ctx = coo.row->ctx;
+  const uint8_t nbits = coo.row->dtype.bits;
+  const bool has_data = COOHasData(coo);
+  const IdType* row_data = coo.row.Ptr<IdType>();
+  const IdType* col_data = coo.col.Ptr<IdType>();
+  const IdType* data_data = has_data ? coo.data.Ptr<IdType>() : nullptr;
+
+  // the outputs are allocated up front and filled in parallel
+  std::vector<COOMatrix> ret(batch_size);
+  for (size_t g = 0; g < batch_size; ++g) {
+    const int64_t len = edge_cumsum[g + 1] - edge_cumsum[g];
+    ret[g] = COOMatrix(
+        src_vertex_cumsum[g + 1] - src_vertex_cumsum[g],
+        dst_vertex_cumsum[g + 1] - dst_vertex_cumsum[g],
+        NewIdArray(len, ctx, nbits), NewIdArray(len, ctx, nbits),
+        has_data ? NewIdArray(len, ctx, nbits) : NullArray(),
+        coo.row_sorted, coo.col_sorted);
+  }
+
+  parallel_for_weighted(0, batch_size, edge_cumsum.data(), [&](int64_t b, int64_t e) {
+    for (int64_t g = b; g < e; ++g) {
+      const int64_t begin = edge_cumsum[g], end = edge_cumsum[g + 1];
+      CopyShifted(row_data, begin, end, -static_cast<int64_t>(src_vertex_cumsum[g]),
+                  ret[g].row.Ptr<IdType>());
+      CopyShifted(col_data, begin, end, -static_cast<int64_t>(dst_vertex_cumsum[g]),
+                  ret[g].col.Ptr<IdType>());
+      if (has_data)
+        CopyShifted(data_data, begin, end, -begin, ret[g].data.Ptr<IdType>());
+    }
+  });
+
+  return ret;
+}
+
+template std::vector<COOMatrix> DisjointPartitionCooBySizes<kDLCPU, int32_t>(
+    const COOMatrix&, const uint64_t, const std::vector<uint64_t>&,
+    const std::vector<uint64_t>&, const std::vector<uint64_t>&);
+template std::vector<COOMatrix> DisjointPartitionCooBySizes<kDLCPU, int64_t>(
+    const COOMatrix&, const uint64_t, const std::vector<uint64_t>&,
+    const std::vector<uint64_t>&, const std::vector<uint64_t>&);
+
+///////////////////////// CSR Based Operations/////////////////////////
+
+template <DLDeviceType XPU, typename IdType>
+CSRMatrix DisjointUnionCsr(const std::vector<CSRMatrix>& csrs) {
+  const int64_t num_csrs = csrs.size();
+  const auto& ctx = csrs[0].indptr->ctx;
+  const uint8_t nbits = csrs[0].indptr->dtype.bits;
+  // the offsets of the rows, columns and entries of every matrix in the result,
+  // and the prefix sum of the copy costs
+  std::vector<int64_t> row_offsets(num_csrs + 1, 0);
+  std::vector<int64_t> col_offsets(num_csrs + 1, 0);
+  std::vector<int64_t> nnz_offsets(num_csrs + 1, 0);
+  std::vector<int64_t> cost_prefix(num_csrs + 1, 0);
+  bool has_data = false, sorted = true;
+  for (int64_t i = 0; i < num_csrs; ++i) {
+    row_offsets[i + 1] = row_offsets[i] + csrs[i].num_rows;
+    col_offsets[i + 1] = col_offsets[i] + csrs[i].num_cols;
+    nnz_offsets[i + 1] = nnz_offsets[i] + csrs[i].indices->shape[0];
+    cost_prefix[i + 1] = row_offsets[i + 1] + nnz_offsets[i + 1];
+    has_data |= CSRHasData(csrs[i]);
+    sorted &= csrs[i].sorted;
+  }
+
+  const int64_t num_rows = row_offsets[num_csrs];
+  const int64_t nnz = nnz_offsets[num_csrs];
+  IdArray ret_indptr = NewIdArray(num_rows + 1, ctx, nbits);
+  IdArray ret_indices = NewIdArray(nnz, ctx, nbits);
+  IdArray ret_data = has_data ? NewIdArray(nnz, ctx, nbits) : NullArray();
+  IdType* ret_indptr_data = ret_indptr.Ptr<IdType>();
+  IdType* ret_indices_data = ret_indices.Ptr<IdType>();
+  IdType* ret_data_data = has_data ? ret_data.Ptr<IdType>() : nullptr;
+  ret_indptr_data[0] = 0;
+
+  parallel_for_weighted(0, num_csrs, cost_prefix.data(), [&](int64_t b, int64_t e) {
+    for (int64_t i = b; i < e; ++i) {
+      const CSRMatrix& csr = csrs[i];
+      const int64_t len = nnz_offsets[i + 1] - nnz_offsets[i];
+      const int64_t pos = nnz_offsets[i];
+      CopyShifted(csr.indptr.Ptr<IdType>(), 1, csr.num_rows + 1, pos,
+                  ret_indptr_data + row_offsets[i] + 1);
+      CopyShifted(csr.indices.Ptr<IdType>(), 0, len, col_offsets[i], ret_indices_data + pos);
+      if (has_data) {
+        CopyShifted(CSRHasData(csr) ? csr.data.Ptr<IdType>() : nullptr, 0, len, pos,
+                    ret_data_data + pos);
+      }
+    }
+  });
+
+  return CSRMatrix(
+      num_rows, col_offsets[num_csrs], ret_indptr, ret_indices, ret_data, sorted);
+}
+
+template CSRMatrix DisjointUnionCsr<kDLCPU, int32_t>(const std::vector<CSRMatrix>&);
+template CSRMatrix DisjointUnionCsr<kDLCPU, int64_t>(const std::vector<CSRMatrix>&);
+
+template <DLDeviceType XPU, typename IdType>
+std::vector<CSRMatrix> DisjointPartitionCsrBySizes(
+    const CSRMatrix &csr,
+    const uint64_t batch_size,
+    const std::vector<uint64_t> &edge_cumsum,
+    const std::vector<uint64_t> &src_vertex_cumsum,
+    const std::vector<uint64_t> &dst_vertex_cumsum) {
+  const auto& ctx = csr.indptr->ctx;
+  const uint8_t nbits = csr.indptr->dtype.bits;
+  const bool has_data = CSRHasData(csr);
+  const IdType* indptr_data = csr.indptr.Ptr<IdType>();
+  const IdType* indices_data = csr.indices.Ptr<IdType>();
+  const IdType* data_data = has_data ? csr.data.Ptr<IdType>() : nullptr;
+
+  // the outputs are allocated up front and filled in parallel
+  std::vector<CSRMatrix> ret(batch_size);
+  std::vector<uint64_t> cost_prefix(batch_size + 1, 0);
+  for (size_t g = 0; g < batch_size; ++g) {
+    const int64_t num_src = src_vertex_cumsum[g + 1] - src_vertex_cumsum[g];
+    const int64_t len = edge_cumsum[g + 1] - edge_cumsum[g];
+    ret[g] = CSRMatrix(
+        num_src, dst_vertex_cumsum[g + 1] - dst_vertex_cumsum[g],
+        NewIdArray(num_src + 1, ctx, nbits), NewIdArray(len, ctx, nbits),
+        has_data ? NewIdArray(len, ctx, nbits) : NullArray(),
+        csr.sorted);
+    cost_prefix[g + 1] = src_vertex_cumsum[g + 1] + edge_cumsum[g + 1];
+  }
+
+  parallel_for_weighted(0, batch_size, cost_prefix.data(), [&](int64_t b, int64_t e) {
+    for (int64_t g = b; g < e; ++g) {
+      const int64_t begin = edge_cumsum[g], end = edge_cumsum[g + 1];
+      CopyShifted(indptr_data, src_vertex_cumsum[g], src_vertex_cumsum[g + 1] + 1, -begin,
+                  ret[g].indptr.Ptr<IdType>());
+      CopyShifted(indices_data, begin, end, -static_cast<int64_t>(dst_vertex_cumsum[g]),
+                  ret[g].indices.Ptr<IdType>());
+      if (has_data)
+        CopyShifted(data_data, begin, end, -begin, ret[g].data.Ptr<IdType>());
+    }
+  });
+
+  return ret;
+}
+
+template std::vector<CSRMatrix> DisjointPartitionCsrBySizes<kDLCPU, int32_t>(
+    const CSRMatrix&, const uint64_t, const std::vector<uint64_t>&,
+    const std::vector<uint64_t>&, const std::vector<uint64_t>&);
+template std::vector<CSRMatrix> DisjointPartitionCsrBySizes<kDLCPU, int64_t>(
+    const CSRMatrix&, const uint64_t, const std::vector<uint64_t>&,
+    const std::vector<uint64_t>&, const std::vector<uint64_t>&);
+
+}  // namespace impl
+}  // namespace aten
+}  // namespace dgl
@@ -62,11 +62,13 @@ template NDArray IndexSelect<kDLGPU, double, int64_t>(NDArray, IdArray);
 template <DLDeviceType XPU, typename DType>
 DType IndexSelect(NDArray array, int64_t index) {
   auto device = runtime::DeviceAPI::Get(array->ctx);
+  DGLStreamHandle stream = device->GetStream();
   DType ret = 0;
   device->CopyDataFromTo(
       static_cast<DType*>(array->data) + index, 0, &ret, 0,
       sizeof(DType), array->ctx, DLContext{kDLCPU, 0},
-      array->dtype, nullptr);
+      array->dtype, stream);
+  device->StreamSync(array->ctx, stream);
   return ret;
 }
 
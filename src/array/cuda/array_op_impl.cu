@@ -6,6 +6,7 @@
 #include <dgl/array.h>
 #include "../../runtime/cuda/cuda_common.h"
 #include "../../runtime/cuda/cuda_hashtable.cuh"
+#include "./atomic.cuh"
 #include "./utils.h"
 #include "../arith.h"
 
@@ -338,6 +339,86 @@ IdArray Relabel_(const std::vector<IdArray>& arrays) {
 template IdArray Relabel_<kDLGPU, int32_t>(const std::vector<IdArray>& arrays);
 template IdArray Relabel_<kDLGPU, int64_t>(const std::vector<IdArray>& arrays);
 
+///////////////////////////// Unique //////////////////////////////
+
+template <typename IdType>
+__global__ void _UniqueInverseKernel(
+    const IdType* ids, int64_t length, DeviceOrderedHashTable<IdType> table,
+    IdType* inverse, IdType* counts) {
+
+  int64_t tx = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+  const int64_t stride_x = static_cast<int64_t>(gridDim.x) * blockDim.x;
+
+  while (tx < length) {
+    const IdType local = table.Search(ids[tx])->local;
+    inverse[tx] = local;
+    cuda::AtomicAdd(counts + local, static_cast<IdType>(1));
+    tx += stride_x;
+  }
+}
+
+template <DLDeviceType XPU, typename IdType>
+std::tuple<IdArray, IdArray, IdArray> Unique(IdArray ids) {
+  const auto& ctx = ids->ctx;
+  const int64_t length = ids->shape[0];
+  if (length == 0) {
+    return std::make_tuple(ids, NewIdArray(0, ctx, sizeof(IdType)*8),
+                           NewIdArray(0, ctx, sizeof(IdType)*8));
+  }
+
+  auto device = runtime::DeviceAPI::Get(ctx);
+  auto* thr_entry = runtime::CUDAThreadEntry::ThreadLocal();
+
+  // build the table and get the unique ids in the order of first occurrence
+  OrderedHashTable<IdType> node_map(length, ctx, thr_entry->stream);
+  int64_t num_unique = 0;
+  int64_t * num_unique_device = static_cast<int64_t*>(
+      device->AllocWorkspace(ctx, sizeof(int64_t)));
+  IdArray values = NewIdArray(length, ctx, sizeof(IdType)*8);
+
+  CUDA_CALL(cudaMemsetAsync(
+    num_unique_device,
+    0,
+    sizeof(*num_unique_device),
+    thr_entry->stream));
+
+  node_map.FillWithDuplicates(
+    ids.Ptr<IdType>(),
+    length,
+    values.Ptr<IdType>(),
+    num_unique_device,
+    thr_entry->stream);
+
+  device->CopyDataFromTo(
+    num_unique_device, 0,
+    &num_unique, 0,
+    sizeof(num_unique),
+    ctx,
+    DGLContext{kDLCPU, 0},
+    DGLType{kDLInt, 64, 1},
+    thr_entry->stream);
+  device->StreamSync(ctx, thr_entry->stream);
+  device->FreeWorkspace(ctx, num_unique_device);
+
+  // resize the unique ids
+  values->shape[0] = num_unique;
+
+  // the inverse indices and the counts in the same pass
+  IdArray inverse = NewIdArray(length, ctx, sizeof(IdType)*8);
+  IdArray counts = aten::Full(0, num_unique, sizeof(IdType)*8, ctx);
+  const int nt = 128;
+  const int nb = (length + nt - 1) / nt;
+  CUDA_KERNEL_CALL((_UniqueInverseKernel<IdType>),
+    nb, nt, 0, thr_entry->stream,
+    ids.Ptr<IdType>(), length, node_map.DeviceHandle(),
+    inverse.Ptr<IdType>(), counts.Ptr<IdType>());
+
+  return std::make_tuple(values, inverse, counts);
+}
+
+template std::tuple<IdArray, IdArray, IdArray> Unique<kDLGPU, int32_t>(IdArray ids);
+template std::tuple<IdArray, IdArray, IdArray> Unique<kDLGPU, int64_t>(IdArray ids);
+
 ///////////////////////////// AsNumBits /////////////////////////////
 
 template <typename InType, typename OutType>
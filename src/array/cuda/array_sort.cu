@@ -17,6 +17,7 @@ template <DLDeviceType XPU, typename IdType>
 std::pair<IdArray, IdArray> Sort(IdArray array, int num_bits) {
   const auto& ctx = array->ctx;
   auto device = runtime::DeviceAPI::Get(ctx);
+  cudaStream_t stream = runtime::CUDAThreadEntry::ThreadLocal()->stream;
   const int64_t nitems = array->shape[0];
   IdArray orig_idx = Range(0, nitems, 64, ctx);
   IdArray sorted_array = NewIdArray(nitems, ctx, array->dtype.bits);
@@ -33,13 +34,13 @@ std::pair<IdArray, IdArray> Sort(IdArray array, int num_bits) {
 
   // Allocate workspace
   size_t workspace_size = 0;
-  cub::DeviceRadixSort::SortPairs(nullptr, workspace_size,
-      keys_in, keys_out, values_in, values_out, nitems, 0, num_bits);
+  CUDA_CALL(cub::DeviceRadixSort::SortPairs(nullptr, workspace_size,
+      keys_in, keys_out, values_in, values_out, nitems, 0, num_bits, stream));
   void* workspace = device->AllocWorkspace(ctx, workspace_size);
 
   // Compute
-  cub::DeviceRadixSort::SortPairs(workspace, workspace_size,
-      keys_in, keys_out, values_in, values_out, nitems, 0, num_bits);
+  CUDA_CALL(cub::DeviceRadixSort::SortPairs(workspace, workspace_size,
+      keys_in, keys_out, values_in, values_out, nitems, 0, num_bits, stream));
 
   device->FreeWorkspace(ctx, workspace);
 
@@ -189,6 +189,38 @@ inline __device__ int32_t AtomicCAS(
                    static_cast<Type>(val));
 }
 
+/**
+* \brief Performs an atomic addition on 64 bit integers with the native
+* instruction, instead of the compare-and-swap loop of the generic version.
+*/
+inline __device__ int64_t AtomicAdd(
+    int64_t * const address,
+    const int64_t val) {
+  // match the type of "::atomicAdd", so ignore lint warning
+  using Type = unsigned long long int; // NOLINT
+
+  static_assert(sizeof(Type) == sizeof(*address), "Type width must match");
+
+  return atomicAdd(reinterpret_cast<Type*>(address),
+                   static_cast<Type>(val));
+}
+
+/**
+* \brief Performs an atomic addition on 32 bit integers with the native
+* instruction, instead of the compare-and-swap loop of the generic version.
+*/
+inline __device__ int32_t AtomicAdd(
+    int32_t * const address,
+    const int32_t val) {
+  // match the type of "::atomicAdd", so ignore lint warning
+  using Type = int; // NOLINT
+
+  static_assert(sizeof(Type) == sizeof(*address), "Type width must match");
+
+  return atomicAdd(reinterpret_cast<Type*>(address),
+                   static_cast<Type>(val));
+}
+
 inline __device__ int64_t AtomicMax(
     int64_t * const address,
     const int64_t val) {
@@ -213,6 +245,21 @@ inline __device__ int32_t AtomicMax(
                    static_cast<Type>(val));
 }
 
+/**
+* \brief Performs an atomic minimum on non-negative 64 bit integers.
+*/
+inline __device__ int64_t AtomicMin(
+    int64_t * const address,
+    const int64_t val) {
+  // match the type of "::atomicCAS", so ignore lint warning
+  using Type = unsigned long long int; // NOLINT
+
+  static_assert(sizeof(Type) == sizeof(*address), "Type width must match");
+
+  return atomicMin(reinterpret_cast<Type*>(address),
+                   static_cast<Type>(val));
+}
+
 
 template <>
 __device__ __forceinline__ float AtomicAdd<float>(float* addr, float val) {
@@ -4,7 +4,11 @@
  * \brief COO2CSR
  */
 #include <dgl/array.h>
+#include <dgl/runtime/parallel_for.h>
+#include <algorithm>
+#include <vector>
 #include "../../runtime/cuda/cuda_common.h"
+#include "./atomic.cuh"
 #include "./utils.h"
 
 namespace dgl {
@@ -59,41 +63,68 @@ CSRMatrix COOToCSR<kDLGPU, int32_t>(COOMatrix coo) {
                    indptr, coo.col, coo.data, col_sorted);
 }
 
+/*! \brief The number of threads per block of the conversion kernels. */
+constexpr int kConvertNumThreads = 256;
+
 /*!
- * \brief Search for the insertion positions for needle in the hay.
- *
- * The hay is a list of sorted elements and the result is the insertion position
- * of each needle so that the insertion still gives sorted order.
+ * \brief Fill the row pointers of the sorted rows of the edges.
  *
- * It essentially perform binary search to find upper bound for each needle
- * elements.
+ * The edge i starts the rows (row[i - 1], row[i]], and the edge nnz, past the
+ * last one, starts the rows after row[nnz - 1], so that every entry of indptr
+ * is written by a thread, without atomics and in O(nnz + num_rows).
  *
  * For example:
- * hay = [0, 0, 1, 2, 2]
- * needle = [0, 1, 2, 3]
+ * row = [0, 0, 2, 2], num_rows = 4
  * then,
- * out = [2, 3, 5, 5]
+ * indptr = [0, 2, 2, 4, 4]
  */
 template <typename IdType>
-__global__ void _SortedSearchKernelUpperBound(
-    const IdType* hay, int64_t hay_size,
-    const IdType* needles, int64_t num_needles,
-    IdType* pos) {
-  int tx = blockIdx.x * blockDim.x + threadIdx.x;
-  const int stride_x = gridDim.x * blockDim.x;
-  while (tx < num_needles) {
-    const IdType ele = needles[tx];
-    // binary search
-    IdType lo = 0, hi = hay_size;
-    while (lo < hi) {
-      IdType mid = (lo + hi) >> 1;
-      if (hay[mid] <= ele) {
-        lo = mid + 1;
-      } else {
-        hi = mid;
-      }
-    }
-    pos[tx] = lo;
+__global__ void _SortedRowsToIndptrKernel(
+    const IdType* row, int64_t nnz, int64_t num_rows, IdType* indptr) {
+  int64_t tx = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+  const int64_t stride_x = static_cast<int64_t>(gridDim.x) * blockDim.x;
+  while (tx <= nnz) {
+    const int64_t begin = (tx == 0) ? 0 : row[tx - 1] + 1;
+    const int64_t end = (tx == nnz) ? num_rows : row[tx];
+    for (int64_t r = begin; r <= end; ++r)
+      indptr[r] = tx;
+    tx += stride_x;
+  }
+}
+
+/*!
+ * \brief Count the edges of every row.
+ */
+template <typename IdType>
+__global__ void _RowHistogramKernel(
+    const IdType* row, int64_t nnz, IdType* counts) {
+  int64_t tx = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+  const int64_t stride_x = static_cast<int64_t>(gridDim.x) * blockDim.x;
+  while (tx < nnz) {
+    cuda::AtomicAdd(counts + row[tx], static_cast<IdType>(1));
+    tx += stride_x;
+  }
+}
+
+/*!
+ * \brief Compute the positions in the CSR of the edges of a chunk, from the
+ *        rows of the chunk sorted with a stable sort and the permutation of the
+ *        sort. The edge at j in the sorted order goes after the edges of its
+ *        row placed by the previous chunks, counted by cursor, and after the
+ *        edges of its row before it in the chunk, so that the order of the
+ *        edges within a row is kept.
+ */
+template <typename IdType>
+__global__ void _ChunkPositionsKernel(
+    const IdType* sorted_rows, const int64_t* perm, int64_t len,
+    const IdType* cursor, int64_t* pos) {
+  int64_t tx = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+  const int64_t stride_x = static_cast<int64_t>(gridDim.x) * blockDim.x;
+  while (tx < len) {
+    const IdType r = sorted_rows[tx];
+    const IdType first = cuda::_LowerBound(sorted_rows, static_cast<IdType>(0),
+                                           static_cast<IdType>(tx), r);
+    pos[perm[tx]] = cursor[r] + (tx - first);
     tx += stride_x;
   }
 }
@@ -118,15 +149,13 @@ CSRMatrix COOToCSR<kDLGPU, int64_t>(COOMatrix coo) {
   if (!COOHasData(coo))
     coo.data = aten::Range(0, nnz, coo.row->dtype.bits, coo.row->ctx);
 
-  IdArray rowids = Range(0, coo.num_rows, nbits, ctx);
-  const int nt = cuda::FindNumThreads(coo.num_rows);
-  const int nb = (coo.num_rows + nt - 1) / nt;
-  IdArray indptr = Full(0, coo.num_rows + 1, nbits, ctx);
-  CUDA_KERNEL_CALL(_SortedSearchKernelUpperBound,
+  IdArray indptr = NewIdArray(coo.num_rows + 1, ctx, nbits);
+  const int nt = kConvertNumThreads;
+  const int nb = (nnz + nt) / nt;
+  CUDA_KERNEL_CALL(_SortedRowsToIndptrKernel,
       nb, nt, 0, thr_entry->stream,
-      coo.row.Ptr<int64_t>(), nnz,
-      rowids.Ptr<int64_t>(), coo.num_rows,
-      indptr.Ptr<int64_t>() + 1);
+      coo.row.Ptr<int64_t>(), nnz, coo.num_rows,
+      indptr.Ptr<int64_t>());
 
   return CSRMatrix(coo.num_rows, coo.num_cols,
                    indptr, coo.col, coo.data, col_sorted);
@@ -135,6 +164,79 @@ CSRMatrix COOToCSR<kDLGPU, int64_t>(COOMatrix coo) {
 template CSRMatrix COOToCSR<kDLGPU, int32_t>(COOMatrix coo);
 template CSRMatrix COOToCSR<kDLGPU, int64_t>(COOMatrix coo);
 
+template <DLDeviceType XPU, typename IdType>
+CSRMatrix COOToCSRChunked(COOMatrix coo, DLContext ctx, int64_t chunk_size) {
+  auto device = runtime::DeviceAPI::Get(ctx);
+  cudaStream_t stream = runtime::CUDAThreadEntry::ThreadLocal()->stream;
+  const auto& cpu_ctx = coo.row->ctx;
+  const auto dtype = coo.row->dtype;
+  const int64_t nnz = coo.row->shape[0];
+  const int64_t num_rows = coo.num_rows;
+  chunk_size = std::max<int64_t>(1, std::min(chunk_size, nnz));
+  const int row_bits = cuda::NumberOfBits(num_rows);
+  const IdType* row_data = coo.row.Ptr<IdType>();
+  const IdType* col_data = coo.col.Ptr<IdType>();
+  const IdType* eid_data = COOHasData(coo) ? coo.data.Ptr<IdType>() : nullptr;
+
+  IdArray chunk_rows = NewIdArray(chunk_size, ctx, dtype.bits);
+  auto copy_chunk_rows = [&] (int64_t start, int64_t len) {
+    device->CopyDataFromTo(row_data, start * sizeof(IdType),
+                           chunk_rows->data, 0, len * sizeof(IdType),
+                           cpu_ctx, ctx, dtype, stream);
+  };
+  const int nt = kConvertNumThreads;
+
+  // Count the edges of every row, chunk by chunk.
+  IdArray counts = Full(0, num_rows, dtype.bits, ctx);
+  for (int64_t start = 0; start < nnz; start += chunk_size) {
+    const int64_t len = std::min(chunk_size, nnz - start);
+    copy_chunk_rows(start, len);
+    CUDA_KERNEL_CALL(_RowHistogramKernel, (len + nt - 1) / nt, nt, 0, stream,
+        chunk_rows.Ptr<IdType>(), len, counts.Ptr<IdType>());
+  }
+  // The row pointers, kept on the device as the position of the next edge of
+  // every row.
+  IdArray cursor = aten::CumSum(counts, true);
+  IdArray indptr = NewIdArray(num_rows + 1, cpu_ctx, dtype.bits);
+  device->CopyDataFromTo(cursor->data, 0, indptr->data, 0, (num_rows + 1) * sizeof(IdType),
+                         ctx, cpu_ctx, dtype, stream);
+
+  // Place the edges, chunk by chunk, keeping their order within the rows.
+  IdArray indices = NewIdArray(nnz, cpu_ctx, dtype.bits);
+  IdArray data = NewIdArray(nnz, cpu_ctx, dtype.bits);
+  IdType* indices_data = indices.Ptr<IdType>();
+  IdType* data_data = data.Ptr<IdType>();
+  IdArray chunk_pos = NewIdArray(chunk_size, ctx, 64);
+  std::vector<int64_t> pos(chunk_size);
+  for (int64_t start = 0; start < nnz; start += chunk_size) {
+    const int64_t len = std::min(chunk_size, nnz - start);
+    const int nb = (len + nt - 1) / nt;
+    copy_chunk_rows(start, len);
+    auto sorted = aten::Sort(chunk_rows.CreateView({len}, dtype), row_bits);
+    CUDA_KERNEL_CALL(_ChunkPositionsKernel, nb, nt, 0, stream,
+        sorted.first.Ptr<IdType>(), sorted.second.Ptr<int64_t>(), len,
+        cursor.Ptr<IdType>(), chunk_pos.Ptr<int64_t>());
+    CUDA_KERNEL_CALL(_RowHistogramKernel, nb, nt, 0, stream,
+        chunk_rows.Ptr<IdType>(), len, cursor.Ptr<IdType>());
+    device->CopyDataFromTo(chunk_pos->data, 0, pos.data(), 0, len * sizeof(int64_t),
+                           ctx, cpu_ctx, chunk_pos->dtype, stream);
+    device->StreamSync(ctx, stream);
+    runtime::parallel_for(0, len, [&](size_t b, size_t e) {
+      for (auto i = b; i < e; ++i) {
+        indices_data[pos[i]] = col_data[start + i];
+        data_data[pos[i]] = eid_data ? eid_data[start + i] : start + i;
+      }
+    });
+  }
+  device->StreamSync(ctx, stream);
+
+  return CSRMatrix(num_rows, coo.num_cols, indptr, indices, data,
+                   coo.row_sorted && coo.col_sorted);
+}
+
+template CSRMatrix COOToCSRChunked<kDLGPU, int32_t>(COOMatrix, DLContext, int64_t);
+template CSRMatrix COOToCSRChunked<kDLGPU, int64_t>(COOMatrix, DLContext, int64_t);
+
 }  // namespace impl
 }  // namespace aten
 }  // namespace dgl
@@ -0,0 +1,156 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file array/cuda/coo_linegraph.cu
+ * \brief COO LineGraph on GPU
+ */
+#include <dgl/array.h>
+#include <dgl/runtime/device_api.h>
+
+#include "./dgl_cub.cuh"
+#include "../../runtime/cuda/cuda_common.h"
+
+namespace dgl {
+using runtime::NDArray;
+namespace aten {
+namespace impl {
+
+namespace {
+
+constexpr int BLOCK_SIZE = 256;
+
+/*!
+ * \brief Whether the edge j, leaving the destination of the edge i, follows it in
+ *        the line graph.
+ */
+template <typename IdType>
+__device__ __forceinline__ bool _IsSuccessor(
+    const int64_t i, const IdType j, const IdType u, const IdType * const coo_col,
+    const bool backtracking) {
+  return j != i && (backtracking || coo_col[j] != u);
+}
+
+/*!
+ * \brief Count the successors of every edge, with a zero after the last edge
+ *        so that an exclusive sum gives the offsets and the total.
+ */
+template <typename IdType>
+__global__ void _CountSuccessorsKernel(
+    const IdType * const coo_row, const IdType * const coo_col,
+    const IdType * const out_indptr, const IdType * const out_edges,
+    const int64_t nnz, const int64_t num_nodes, const bool backtracking,
+    int64_t * const counts) {
+  int64_t tx = blockIdx.x * blockDim.x + threadIdx.x;
+  const int64_t stride_x = gridDim.x * blockDim.x;
+  while (tx <= nnz) {
+    int64_t count = 0;
+    if (tx < nnz && coo_col[tx] < num_nodes) {
+      const IdType u = coo_row[tx];
+      const IdType v = coo_col[tx];
+      for (IdType k = out_indptr[v]; k < out_indptr[v + 1]; ++k) {
+        if (_IsSuccessor(tx, out_edges[k], u, coo_col, backtracking))
+          ++count;
+      }
+    }
+    counts[tx] = count;
+    tx += stride_x;
+  }
+}
+
+template <typename IdType>
+__global__ void _FillSuccessorsKernel(
+    const IdType * const coo_row, const IdType * const coo_col,
+    const IdType * const data, const IdType * const out_indptr,
+    const IdType * const out_edges, const int64_t nnz, const int64_t num_nodes,
+    const bool backtracking, const int64_t * const offsets,
+    IdType * const new_row, IdType * const new_col) {
+  int64_t tx = blockIdx.x * blockDim.x + threadIdx.x;
+  const int64_t stride_x = gridDim.x * blockDim.x;
+  while (tx < nnz) {
+    if (coo_col[tx] < num_nodes) {
+      const IdType u = coo_row[tx];
+      const IdType v = coo_col[tx];
+      const IdType eid = data ? data[tx] : tx;
+      int64_t pos = offsets[tx];
+      for (IdType k = out_indptr[v]; k < out_indptr[v + 1]; ++k) {
+        const IdType j = out_edges[k];
+        if (_IsSuccessor(tx, j, u, coo_col, backtracking)) {
+          new_row[pos] = eid;
+          new_col[pos] = data ? data[j] : j;
+          ++pos;
+        }
+      }
+    }
+    tx += stride_x;
+  }
+}
+
+}  // namespace
+
+/*
+ * As on CPU, the successors of every edge are counted, one edge per thread,
+ * the line graph is allocated at its exact size from the sum of the counts,
+ * and the successors are written by a second kernel. The edges are grouped by
+ * source with a stable sort, so that the edges of the line graph come in the
+ * same order as on CPU.
+ */
+template <DLDeviceType XPU, typename IdType>
+COOMatrix COOLineGraph(const COOMatrix &coo, bool backtracking) {
+  const auto& ctx = coo.row->ctx;
+  auto device = runtime::DeviceAPI::Get(ctx);
+  cudaStream_t stream = runtime::CUDAThreadEntry::ThreadLocal()->stream;
+  const int64_t nnz = coo.row->shape[0];
+  const int64_t num_nodes = coo.num_rows;
+
+  // the positions of the edges leaving every node, in the order of the input
+  const CSRMatrix out_csr = COOToCSR(COOMatrix(
+      coo.num_rows, coo.num_cols, coo.row, coo.col, NullArray(), coo.row_sorted, false));
+  const IdType * const out_indptr = out_csr.indptr.Ptr<IdType>();
+  const IdType * const out_edges = out_csr.data.Ptr<IdType>();
+  const IdType * const coo_row = coo.row.Ptr<IdType>();
+  const IdType * const coo_col = coo.col.Ptr<IdType>();
+  const IdType * const data = COOHasData(coo) ? coo.data.Ptr<IdType>() : nullptr;
+
+  int64_t * counts = static_cast<int64_t*>(
+      device->AllocWorkspace(ctx, (nnz + 1) * sizeof(int64_t)));
+  int64_t * offsets = static_cast<int64_t*>(
+      device->AllocWorkspace(ctx, (nnz + 1) * sizeof(int64_t)));
+  const int nb = (nnz + BLOCK_SIZE) / BLOCK_SIZE;
+  CUDA_KERNEL_CALL(_CountSuccessorsKernel<IdType>, nb, BLOCK_SIZE, 0, stream,
+      coo_row, coo_col, out_indptr, out_edges, nnz, num_nodes, backtracking, counts);
+
+  size_t prefix_temp_size = 0;
+  CUDA_CALL(cub::DeviceScan::ExclusiveSum(nullptr, prefix_temp_size,
+      counts, offsets, nnz + 1, stream));
+  void * prefix_temp = device->AllocWorkspace(ctx, prefix_temp_size);
+  CUDA_CALL(cub::DeviceScan::ExclusiveSum(prefix_temp, prefix_temp_size,
+      counts, offsets, nnz + 1, stream));
+  device->FreeWorkspace(ctx, prefix_temp);
+  device->FreeWorkspace(ctx, counts);
+
+  int64_t num_new_edges;
+  device->CopyDataFromTo(offsets, nnz * sizeof(num_new_edges), &num_new_edges, 0,
+      sizeof(num_new_edges),
+      ctx,
+      DGLContext{kDLCPU, 0},
+      DGLType{kDLInt, 64, 1},
+      stream);
+  device->StreamSync(ctx, stream);
+
+  IdArray new_row = NewIdArray(num_new_edges, ctx, coo.row->dtype.bits);
+  IdArray new_col = NewIdArray(num_new_edges, ctx, coo.row->dtype.bits);
+  if (num_new_edges > 0) {
+    CUDA_KERNEL_CALL(_FillSuccessorsKernel<IdType>, nb, BLOCK_SIZE, 0, stream,
+        coo_row, coo_col, data, out_indptr, out_edges, nnz, num_nodes, backtracking,
+        offsets, new_row.Ptr<IdType>(), new_col.Ptr<IdType>());
+  }
+  device->FreeWorkspace(ctx, offsets);
+
+  return COOMatrix(nnz, nnz, new_row, new_col, NullArray(), false, false);
+}
+
+template COOMatrix COOLineGraph<kDLGPU, int32_t>(const COOMatrix &coo, bool backtracking);
+template COOMatrix COOLineGraph<kDLGPU, int64_t>(const COOMatrix &coo, bool backtracking);
+
+}  // namespace impl
+}  // namespace aten
+}  // namespace dgl
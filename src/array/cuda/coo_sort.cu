@@ -60,38 +60,33 @@ __global__ void _COODecodeEdgesKernel(
   if (tx < nnz) {
     const IdType k = key[tx];
     row[tx] = k >> col_bits;
-    col[tx] = k & ((1 << col_bits) - 1);
+    col[tx] = k & ((static_cast<IdType>(1) << col_bits) - 1);
   }
 }
 
-
-
-template<typename T>
-int _NumberOfBits(const T& range) {
-  if (range <= 1) {
-    // ranges of 0 or 1 require no bits to store
-    return 0;
-  }
-
-  int bits = 1;
-  while (bits < sizeof(T)*8 && (1 << bits) < range) {
-    ++bits;
-  }
-
-  CHECK_EQ((range-1) >> bits, 0);
-  CHECK_NE((range-1) >> (bits-1), 0);
-
-  return bits;
-}
-
 template <DLDeviceType XPU, typename IdType>
 void COOSort_(COOMatrix* coo, bool sort_column) {
   auto* thr_entry = runtime::CUDAThreadEntry::ThreadLocal();
-  const int row_bits = _NumberOfBits(coo->num_rows);
+  const int row_bits = cuda::NumberOfBits(coo->num_rows);
 
   const int64_t nnz = coo->row->shape[0];
-  if (sort_column) {
-    const int col_bits = _NumberOfBits(coo->num_cols);
+  const int col_bits = sort_column ? cuda::NumberOfBits(coo->num_cols) : 0;
+  // the encoded edges must leave the sign bit of IdType clear
+  if (sort_column && row_bits + col_bits > static_cast<int>(sizeof(IdType)*8) - 1) {
+    // The edges do not fit in a key, so they are sorted by column and then
+    // by row, each over its own bits, the radix sort being stable.
+    auto by_col = Sort(coo->col, col_bits);
+    auto by_row = Sort(IndexSelect(coo->row, by_col.second), row_bits);
+    IdArray perm = IndexSelect(by_col.second, by_row.second);
+
+    coo->row = by_row.first;
+    coo->col = IndexSelect(coo->col, perm);
+    if (aten::COOHasData(*coo))
+      coo->data = IndexSelect(coo->data, perm);
+    else
+      coo->data = AsNumBits(perm, coo->row->dtype.bits);
+    coo->row_sorted = coo->col_sorted = true;
+  } else if (sort_column) {
     const int num_bits = row_bits + col_bits;
 
     const int nt = 256;
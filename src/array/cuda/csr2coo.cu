@@ -6,6 +6,7 @@
 #include <dgl/array.h>
 #include "../../runtime/cuda/cuda_common.h"
 #include "./utils.h"
+#include "./dgl_cub.cuh"
 
 namespace dgl {
 
@@ -48,37 +49,24 @@ COOMatrix CSRToCOO<kDLGPU, int32_t>(CSRMatrix csr) {
 }
 
 /*!
- * \brief Repeat elements
- * \param val Value to repeat
- * \param repeats Number of repeats for each value
- * \param pos The position of the output buffer to write the value.
- * \param out Output buffer.
- * \param length Number of values
+ * \brief Write every non-empty row at the position of its first entry.
+ *
+ * The rows are increasing, so that the inclusive max scan of the result, zero
+ * elsewhere, gives the row of every entry.
  *
  * For example:
- * val = [3, 0, 1]
- * repeats = [1, 0, 2]
- * pos = [0, 1, 1]  # write to output buffer position 0, 1, 1
+ * indptr = [0, 2, 2, 3]
  * then,
- * out = [3, 1, 1]
+ * out = [0, 0, 2]
  */
-template <typename DType, typename IdType>
-__global__ void _RepeatKernel(
-    const DType* val, const IdType* pos,
-    DType* out, int64_t n_row, int64_t length) {
-  int tx = blockIdx.x * blockDim.x + threadIdx.x;
-  const int stride_x = gridDim.x * blockDim.x;
-  while (tx < length) {
-    IdType l = 0, r = n_row, m = 0;
-    while (l < r) {
-      m = l + (r-l)/2;
-      if (tx >= pos[m]) {
-        l = m+1;
-      } else {
-        r = m;
-      }
-    }
-    out[tx] = val[l-1];
+template <typename IdType>
+__global__ void _RowStartsKernel(
+    const IdType* indptr, int64_t num_rows, IdType* out) {
+  int64_t tx = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+  const int64_t stride_x = static_cast<int64_t>(gridDim.x) * blockDim.x;
+  while (tx < num_rows) {
+    if (indptr[tx] < indptr[tx + 1])
+      out[indptr[tx]] = tx;
     tx += stride_x;
   }
 }
@@ -89,16 +77,28 @@ COOMatrix CSRToCOO<kDLGPU, int64_t>(CSRMatrix csr) {
   const int64_t nnz = csr.indices->shape[0];
   const auto nbits = csr.indptr->dtype.bits;
   auto* thr_entry = runtime::CUDAThreadEntry::ThreadLocal();
-  IdArray rowids = Range(0, csr.num_rows, nbits, ctx);
+  auto device = runtime::DeviceAPI::Get(ctx);
   IdArray ret_row = NewIdArray(nnz, ctx, nbits);
+  if (nnz == 0)
+    return COOMatrix(csr.num_rows, csr.num_cols, ret_row, csr.indices, csr.data,
+                     true, csr.sorted);
 
+  // The rows are found with a scan in O(nnz + num_rows), instead of searching
+  // every entry in indptr.
+  IdArray starts = Full(0, nnz, nbits, ctx);
   const int nt = 256;
-  const int nb = (nnz + nt - 1) / nt;
-  CUDA_KERNEL_CALL(_RepeatKernel,
+  const int nb = (csr.num_rows + nt - 1) / nt;
+  CUDA_KERNEL_CALL(_RowStartsKernel,
       nb, nt, 0, thr_entry->stream,
-      rowids.Ptr<int64_t>(),
-      csr.indptr.Ptr<int64_t>(), ret_row.Ptr<int64_t>(),
-      csr.num_rows, nnz);
+      csr.indptr.Ptr<int64_t>(), csr.num_rows, starts.Ptr<int64_t>());
+
+  size_t workspace_size = 0;
+  CUDA_CALL(cub::DeviceScan::InclusiveScan(nullptr, workspace_size,
+      starts.Ptr<int64_t>(), ret_row.Ptr<int64_t>(), cub::Max(), nnz, thr_entry->stream));
+  void* workspace = device->AllocWorkspace(ctx, workspace_size);
+  CUDA_CALL(cub::DeviceScan::InclusiveScan(workspace, workspace_size,
+      starts.Ptr<int64_t>(), ret_row.Ptr<int64_t>(), cub::Max(), nnz, thr_entry->stream));
+  device->FreeWorkspace(ctx, workspace);
 
   return COOMatrix(csr.num_rows, csr.num_cols,
                    ret_row, csr.indices, csr.data,
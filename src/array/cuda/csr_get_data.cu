@@ -4,10 +4,16 @@
  * \brief Retrieve entries of a CSR matrix
  */
 #include <dgl/array.h>
+#include <dgl/aten/kernel_plan.h>
+#include <limits>
+#include <memory>
+#include <tuple>
 #include <vector>
 #include <unordered_set>
 #include <numeric>
 #include "../../runtime/cuda/cuda_common.h"
+#include "../array_op.h"
+#include "./atomic.cuh"
 #include "./utils.h"
 
 namespace dgl {
@@ -17,6 +23,52 @@ using runtime::NDArray;
 namespace aten {
 namespace impl {
 
+/*! \brief The number of queries from which CSRGetData sorts them by row. */
+constexpr int64_t kCSRGetDataSortMinQueries = 1 << 14;
+/*! \brief The number of queries from which the lookups build an index of an unsorted matrix. */
+constexpr int64_t kCSRGetDataIndexMinQueries = 1 << 14;
+/*! \brief The average row length from which the index is a hash table, not a sorted copy. */
+constexpr int64_t kCSRGetDataHashMinAvgDegree = 32;
+/*! \brief The key of the empty slots of the hash table. */
+constexpr int64_t kCSRHashEmptyKey = -1;
+
+/*!
+ * \brief Binary search of the queries in the sorted rows of a CSR matrix.
+ *
+ * When order is given, the rows are the sorted rows of the queries and the
+ * thread tx searches the query order[tx], so that the threads of a warp search
+ * the same or close rows. The results are written at the positions of the queries.
+ */
+template <typename IdType, typename DType>
+__global__ void _SegmentedBinarySearchKernel(
+    const IdType* indptr, const IdType* indices, const IdType* data,
+    const IdType* row, const IdType* col, const int64_t* order,
+    int64_t row_stride, int64_t col_stride,
+    int64_t length, const DType* weights, DType filler, DType* out) {
+  int tx = blockIdx.x * blockDim.x + threadIdx.x;
+  const int stride_x = gridDim.x * blockDim.x;
+  while (tx < length) {
+    const int64_t pos = order ? order[tx] : tx;
+    const IdType r = order ? row[tx] : row[tx * row_stride], c = col[pos * col_stride];
+    IdType lo = indptr[r], hi = indptr[r + 1];
+    const IdType end = hi;
+    while (lo < hi) {
+      const IdType mid = lo + (hi - lo) / 2;
+      if (indices[mid] < c)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+    if (lo < end && indices[lo] == c) {
+      const IdType v = data ? data[lo] : lo;
+      out[pos] = weights ? weights[v] : v;
+    } else {
+      out[pos] = filler;
+    }
+    tx += stride_x;
+  }
+}
+
 template <DLDeviceType XPU, typename IdType, typename DType>
 NDArray CSRGetData(
     CSRMatrix csr, NDArray rows, NDArray cols, bool return_eids, NDArray weights, DType filler) {
@@ -41,17 +93,178 @@ NDArray CSRGetData(
     BUG_IF_FAIL(DLDataTypeTraits<DType>::dtype == rows->dtype) <<
       "DType does not match row's dtype.";
 
-  // TODO(minjie): use binary search for sorted csr
-  CUDA_KERNEL_CALL(cuda::_LinearSearchKernel,
+  if (csr.sorted) {
+    // Sort many queries by row, returning the results in their original order.
+    IdArray sorted_rows = rows, order;
+    if (row_stride == 1 && rstlen >= kCSRGetDataSortMinQueries) {
+      int num_bits = 0;
+      for (int64_t range = csr.num_rows; range > 0; range >>= 1)
+        ++num_bits;
+      std::tie(sorted_rows, order) = aten::Sort(rows, num_bits);
+    }
+    CUDA_KERNEL_CALL((_SegmentedBinarySearchKernel<IdType, DType>),
+        nb, nt, 0, thr_entry->stream,
+        csr.indptr.Ptr<IdType>(), csr.indices.Ptr<IdType>(),
+        CSRHasData(csr)? csr.data.Ptr<IdType>() : nullptr,
+        sorted_rows.Ptr<IdType>(), cols.Ptr<IdType>(),
+        order.defined() ? order.Ptr<int64_t>() : nullptr,
+        row_stride, col_stride, rstlen,
+        return_eids ? nullptr : weights.Ptr<DType>(), filler, rst.Ptr<DType>());
+  } else {
+    CUDA_KERNEL_CALL(cuda::_LinearSearchKernel,
+        nb, nt, 0, thr_entry->stream,
+        csr.indptr.Ptr<IdType>(), csr.indices.Ptr<IdType>(),
+        CSRHasData(csr)? csr.data.Ptr<IdType>() : nullptr,
+        rows.Ptr<IdType>(), cols.Ptr<IdType>(),
+        row_stride, col_stride, rstlen,
+        return_eids ? nullptr : weights.Ptr<DType>(), filler, rst.Ptr<DType>());
+  }
+  return rst;
+}
+
+/*!
+ * \brief An open addressing hash table of the non-zeros of a Csr matrix.
+ *
+ * The key of the non-zero (r, c) is r * num_cols + c, and its value the first
+ * position of the non-zero in the matrix, as found by a scan of the row.
+ */
+struct CSRHashIndex {
+  /*! \brief The keys of the slots, kCSRHashEmptyKey for the empty ones. */
+  IdArray keys;
+  /*! \brief The positions of the non-zeros of the slots. */
+  IdArray positions;
+  /*! \brief The number of slots minus one, the number of slots being a power of 2. */
+  int64_t mask;
+};
+
+__device__ __forceinline__ int64_t _CSRHashSlot(int64_t key, int64_t mask) {
+  uint64_t h = static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ull;
+  return static_cast<int64_t>(h ^ (h >> 32)) & mask;
+}
+
+/*! \brief Insert the non-zeros of a Csr matrix in its hash table, one per thread. */
+template <typename IdType>
+__global__ void _CSRHashInsertKernel(
+    const IdType* indptr, const IdType* indices, int64_t num_rows, int64_t num_cols,
+    int64_t nnz, int64_t mask, int64_t* keys, int64_t* positions) {
+  int64_t tx = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+  const int64_t stride_x = static_cast<int64_t>(gridDim.x) * blockDim.x;
+  while (tx < nnz) {
+    // the row of the non-zero is the last one starting at or before it
+    const IdType r = cuda::_LowerBound(
+        indptr, static_cast<IdType>(1), static_cast<IdType>(num_rows + 1),
+        static_cast<IdType>(tx + 1)) - 1;
+    const int64_t key = static_cast<int64_t>(r) * num_cols + indices[tx];
+    int64_t slot = _CSRHashSlot(key, mask);
+    while (true) {
+      const int64_t prev = cuda::AtomicCAS(keys + slot, kCSRHashEmptyKey, key);
+      if (prev == kCSRHashEmptyKey || prev == key) {
+        // the duplicates of a non-zero keep the first of them
+        cuda::AtomicMin(positions + slot, tx);
+        break;
+      }
+      slot = (slot + 1) & mask;
+    }
+    tx += stride_x;
+  }
+}
+
+/*! \brief Look the (row, col) pairs up in the hash table of a Csr matrix. */
+template <typename IdType>
+__global__ void _CSRHashLookupKernel(
+    const int64_t* keys, const int64_t* positions, int64_t mask, const IdType* data,
+    const IdType* row, const IdType* col, int64_t row_stride, int64_t col_stride,
+    int64_t num_cols, int64_t length, IdType* out) {
+  int64_t tx = static_cast<int64_t>(blockIdx.x) * blockDim.x + threadIdx.x;
+  const int64_t stride_x = static_cast<int64_t>(gridDim.x) * blockDim.x;
+  while (tx < length) {
+    const int64_t key = static_cast<int64_t>(row[tx * row_stride]) * num_cols +
+      col[tx * col_stride];
+    int64_t slot = _CSRHashSlot(key, mask);
+    IdType v = -1;
+    for (int64_t k = keys[slot]; k != kCSRHashEmptyKey; k = keys[slot]) {
+      if (k == key) {
+        const int64_t pos = positions[slot];
+        v = data ? data[pos] : static_cast<IdType>(pos);
+        break;
+      }
+      slot = (slot + 1) & mask;
+    }
+    out[tx] = v;
+    tx += stride_x;
+  }
+}
+
+template <typename IdType>
+std::shared_ptr<CSRHashIndex> BuildCSRHashIndex(const CSRMatrix& csr) {
+  const int64_t nnz = csr.indices->shape[0];
+  const auto& ctx = csr.indptr->ctx;
+  // at most two thirds of the slots are taken
+  int64_t num_slots = 1;
+  while (2 * num_slots < 3 * nnz)
+    num_slots <<= 1;
+  auto index = std::make_shared<CSRHashIndex>();
+  index->keys = aten::Full<int64_t>(kCSRHashEmptyKey, num_slots, ctx);
+  index->positions = aten::Full<int64_t>(
+      std::numeric_limits<int64_t>::max(), num_slots, ctx);
+  index->mask = num_slots - 1;
+  if (nnz == 0)
+    return index;
+  auto* thr_entry = runtime::CUDAThreadEntry::ThreadLocal();
+  const int nt = cuda::FindNumThreads(nnz);
+  const int nb = cuda::FindNumBlocks<'x'>((nnz + nt - 1) / nt);
+  CUDA_KERNEL_CALL((_CSRHashInsertKernel<IdType>),
+      nb, nt, 0, thr_entry->stream,
+      csr.indptr.Ptr<IdType>(), csr.indices.Ptr<IdType>(), csr.num_rows, csr.num_cols,
+      nnz, index->mask, index->keys.Ptr<int64_t>(), index->positions.Ptr<int64_t>());
+  return index;
+}
+
+template <DLDeviceType XPU, typename IdType>
+NDArray CSRGetDataIndexed(CSRMatrix csr, NDArray rows, NDArray cols, KernelPlanCache* cache) {
+  const int64_t rowlen = rows->shape[0];
+  const int64_t collen = cols->shape[0];
+  CHECK((rowlen == collen) || (rowlen == 1) || (collen == 1))
+    << "Invalid row and col id array.";
+  const int64_t rstlen = std::max(rowlen, collen);
+  if (csr.sorted || rstlen < kCSRGetDataIndexMinQueries)
+    return CSRGetData<XPU, IdType>(csr, rows, cols);
+
+  const int64_t nnz = csr.indices->shape[0];
+  // the keys of the hash table are row * num_cols + col
+  const bool keys_fit = csr.num_cols == 0 ||
+    csr.num_rows <= std::numeric_limits<int64_t>::max() / csr.num_cols;
+  if (!keys_fit || nnz < kCSRGetDataHashMinAvgDegree * csr.num_rows) {
+    // the short rows are binary searched in a sorted copy, sorted once
+    const auto sorted = cache->GetOrCreate<CSRMatrix>("csr_get_data_sorted", [&csr] {
+        return std::make_shared<CSRMatrix>(aten::CSRSort(csr));
+      });
+    return CSRGetData<XPU, IdType>(*sorted, rows, cols);
+  }
+
+  const auto index = cache->GetOrCreate<CSRHashIndex>("csr_get_data_hash", [&csr] {
+      return BuildCSRHashIndex<IdType>(csr);
+    });
+  const int64_t row_stride = (rowlen == 1 && collen != 1) ? 0 : 1;
+  const int64_t col_stride = (collen == 1 && rowlen != 1) ? 0 : 1;
+  IdArray rst = NDArray::Empty({rstlen}, rows->dtype, rows->ctx);
+  auto* thr_entry = runtime::CUDAThreadEntry::ThreadLocal();
+  const int nt = cuda::FindNumThreads(rstlen);
+  const int nb = cuda::FindNumBlocks<'x'>((rstlen + nt - 1) / nt);
+  CUDA_KERNEL_CALL((_CSRHashLookupKernel<IdType>),
       nb, nt, 0, thr_entry->stream,
-      csr.indptr.Ptr<IdType>(), csr.indices.Ptr<IdType>(),
-      CSRHasData(csr)? csr.data.Ptr<IdType>() : nullptr,
-      rows.Ptr<IdType>(), cols.Ptr<IdType>(),
-      row_stride, col_stride, rstlen,
-      return_eids ? nullptr : weights.Ptr<DType>(), filler, rst.Ptr<DType>());
+      index->keys.Ptr<int64_t>(), index->positions.Ptr<int64_t>(), index->mask,
+      CSRHasData(csr) ? csr.data.Ptr<IdType>() : nullptr,
+      rows.Ptr<IdType>(), cols.Ptr<IdType>(), row_stride, col_stride,
+      csr.num_cols, rstlen, rst.Ptr<IdType>());
   return rst;
 }
 
+template NDArray CSRGetDataIndexed<kDLGPU, int32_t>(
+    CSRMatrix csr, NDArray rows, NDArray cols, KernelPlanCache* cache);
+template NDArray CSRGetDataIndexed<kDLGPU, int64_t>(
+    CSRMatrix csr, NDArray rows, NDArray cols, KernelPlanCache* cache);
+
 template NDArray CSRGetData<kDLGPU, int32_t, float>(
     CSRMatrix csr, NDArray rows, NDArray cols, bool return_eids, NDArray weights, float filler);
 template NDArray CSRGetData<kDLGPU, int64_t, float>(
@@ -0,0 +1,408 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file array/cuda/csr_khop.cu
+ * \brief GPU implementation of the k-hop expansion of groups of seeds
+ */
+#include <dgl/array.h>
+#include <dgl/runtime/device_api.h>
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
+#include "../../runtime/cuda/cuda_common.h"
+#include "../../runtime/workspace.h"
+#include "./dgl_cub.cuh"
+#include "./utils.h"
+
+namespace dgl {
+
+using runtime::NDArray;
+using runtime::Workspace;
+
+namespace aten {
+namespace impl {
+
+namespace {
+
+/*!
+ * \brief The adjacency matrices giving the neighbors of a node, at most two of
+ *        them, e.g. a CSR and its transpose.
+ */
+template <typename IdType>
+struct Adjacency {
+  const IdType* indptr[2];
+  const IdType* indices[2];
+  int num;
+};
+
+/*! \brief Whether the sorted keys contain the key. */
+__device__ __forceinline__ bool _Contains(const int64_t* keys, int64_t len, int64_t key) {
+  int64_t begin = 0, end = len;
+  while (begin < end) {
+    const int64_t mid = begin + ((end - begin) >> 1);
+    if (keys[mid] < key)
+      begin = mid + 1;
+    else
+      end = mid;
+  }
+  return begin < len && keys[begin] == key;
+}
+
+/*!
+ * \brief Compute the key, group * num_nodes + seed, and the group of every seed.
+ */
+template <typename IdType>
+__global__ void _SeedKeysKernel(
+    const IdType* seeds, int64_t num_seeds, const IdType* seed_offsets, int64_t num_groups,
+    int64_t num_nodes, int64_t* keys, int64_t* groups) {
+  int64_t tx = blockIdx.x * blockDim.x + threadIdx.x;
+  const int64_t stride_x = gridDim.x * blockDim.x;
+  while (tx < num_seeds) {
+    // the last group whose offset is not after the seed
+    int64_t begin = 0, end = num_groups;
+    while (begin < end) {
+      const int64_t mid = begin + ((end - begin) >> 1);
+      if (seed_offsets[mid + 1] <= tx)
+        begin = mid + 1;
+      else
+        end = mid;
+    }
+    keys[tx] = begin * num_nodes + seeds[tx];
+    groups[tx] = begin;
+    tx += stride_x;
+  }
+}
+
+/*! \brief Count the neighbors of the node of every key. */
+template <typename IdType>
+__global__ void _DegreeKernel(
+    const int64_t* keys, int64_t size, int64_t num_nodes, Adjacency<IdType> adj,
+    int64_t* degree) {
+  int64_t tx = blockIdx.x * blockDim.x + threadIdx.x;
+  const int64_t stride_x = gridDim.x * blockDim.x;
+  while (tx < size) {
+    const int64_t node = keys[tx] % num_nodes;
+    int64_t deg = 0;
+    for (int a = 0; a < adj.num; ++a)
+      deg += adj.indptr[a][node + 1] - adj.indptr[a][node];
+    degree[tx] = deg;
+    tx += stride_x;
+  }
+}
+
+/*!
+ * \brief Write the keys of the neighbors of the node of every key, with the owner
+ *        of the key, flagging the ones not visited by the owner yet.
+ *
+ * The neighbor v of an owner o of group g is flagged if o * num_nodes + v is not
+ * in visited, g * num_nodes + v is in allowed and not in excluded, if given.
+ * The group of an owner is given by groups, or is the owner itself.
+ */
+template <typename IdType>
+__global__ void _ExpandKernel(
+    const int64_t* keys, int64_t size, int64_t num_nodes, Adjacency<IdType> adj,
+    const int64_t* prefix, const int64_t* visited, int64_t num_visited,
+    const int64_t* groups, const int64_t* allowed, int64_t num_allowed,
+    const int64_t* excluded, int64_t num_excluded,
+    int64_t* cand, int8_t* flags) {
+  int64_t tx = blockIdx.x * blockDim.x + threadIdx.x;
+  const int64_t stride_x = gridDim.x * blockDim.x;
+  while (tx < size) {
+    const int64_t owner = keys[tx] / num_nodes;
+    const int64_t node = keys[tx] % num_nodes;
+    const int64_t group = groups ? groups[owner] : owner;
+    int64_t pos = prefix[tx];
+    for (int a = 0; a < adj.num; ++a) {
+      for (IdType k = adj.indptr[a][node]; k < adj.indptr[a][node + 1]; ++k, ++pos) {
+        const int64_t v = adj.indices[a][k];
+        const int64_t group_key = group * num_nodes + v;
+        cand[pos] = owner * num_nodes + v;
+        flags[pos] = !_Contains(visited, num_visited, cand[pos])
+          && (!allowed || _Contains(allowed, num_allowed, group_key))
+          && (!excluded || !_Contains(excluded, num_excluded, group_key));
+      }
+    }
+    tx += stride_x;
+  }
+}
+
+/*! \brief Tag every key of a hop with group * (num_hops + 1) + hop. */
+__global__ void _HopTagKernel(
+    const int64_t* keys, int64_t size, int64_t num_nodes, int64_t hop, int64_t num_tags,
+    int64_t* tags) {
+  int64_t tx = blockIdx.x * blockDim.x + threadIdx.x;
+  const int64_t stride_x = gridDim.x * blockDim.x;
+  while (tx < size) {
+    tags[tx] = keys[tx] / num_nodes * num_tags + hop;
+    tx += stride_x;
+  }
+}
+
+/*! \brief Extract the node of every key, and the first position of every group. */
+template <typename IdType>
+__global__ void _NodesKernel(
+    const int64_t* keys, const int64_t* tags, int64_t size, int64_t num_nodes,
+    int64_t num_tags, int64_t num_groups, IdType* nodes, IdType* node_offsets) {
+  int64_t tx = blockIdx.x * blockDim.x + threadIdx.x;
+  const int64_t stride_x = gridDim.x * blockDim.x;
+  while (tx < size) {
+    nodes[tx] = keys[tx] % num_nodes;
+    // the groups starting here, those between the group of the previous key
+    // and the group of this one
+    const int64_t first = tx == 0 ? 0 : tags[tx - 1] / num_tags + 1;
+    for (int64_t g = first; g <= tags[tx] / num_tags; ++g)
+      node_offsets[g] = tx;
+    if (tx == size - 1) {
+      for (int64_t g = tags[tx] / num_tags + 1; g <= num_groups; ++g)
+        node_offsets[g] = size;
+    }
+    tx += stride_x;
+  }
+}
+
+/*!
+ * \brief Write the distance of the node of every key from its owner seed, at the
+ *        row of the node in the group of the seed.
+ */
+template <typename IdType>
+__global__ void _DistanceKernel(
+    const int64_t* keys, int64_t size, int64_t num_nodes, IdType dist,
+    const int64_t* seed_groups, const IdType* seed_offsets,
+    const int64_t* sorted_members, const int64_t* member_pos, int64_t num_members,
+    int64_t max_seeds, IdType* dists) {
+  int64_t tx = blockIdx.x * blockDim.x + threadIdx.x;
+  const int64_t stride_x = gridDim.x * blockDim.x;
+  while (tx < size) {
+    const int64_t seed = keys[tx] / num_nodes;
+    const int64_t group = seed_groups[seed];
+    const int64_t key = group * num_nodes + keys[tx] % num_nodes;
+    int64_t begin = 0, end = num_members;
+    while (begin < end) {
+      const int64_t mid = begin + ((end - begin) >> 1);
+      if (sorted_members[mid] < key)
+        begin = mid + 1;
+      else
+        end = mid;
+    }
+    dists[member_pos[begin] * max_seeds + seed - seed_offsets[group]] = dist;
+    tx += stride_x;
+  }
+}
+
+/*! \brief Sort the keys and remove the duplicates. */
+IdArray SortUnique(IdArray keys) {
+  const auto& ctx = keys->ctx;
+  auto device = runtime::DeviceAPI::Get(ctx);
+  cudaStream_t stream = runtime::CUDAThreadEntry::ThreadLocal()->stream;
+  const int64_t size = keys->shape[0];
+  if (size == 0)
+    return keys;
+  Workspace<int64_t> sorted(device, ctx, size);
+  size_t sort_workspace_size = 0;
+  CUDA_CALL(cub::DeviceRadixSort::SortKeys(nullptr, sort_workspace_size,
+      keys.Ptr<int64_t>(), sorted.get(), size, 0, sizeof(int64_t) * 8, stream));
+  Workspace<void> sort_workspace(device, ctx, sort_workspace_size);
+  CUDA_CALL(cub::DeviceRadixSort::SortKeys(sort_workspace.get(), sort_workspace_size,
+      keys.Ptr<int64_t>(), sorted.get(), size, 0, sizeof(int64_t) * 8, stream));
+
+  IdArray unique = NewIdArray(size, ctx, 64);
+  Workspace<int64_t> d_num_unique(device, ctx, 1);
+  size_t unique_workspace_size = 0;
+  CUDA_CALL(cub::DeviceSelect::Unique(nullptr, unique_workspace_size,
+      sorted.get(), unique.Ptr<int64_t>(), d_num_unique.get(), size, stream));
+  Workspace<void> unique_workspace(device, ctx, unique_workspace_size);
+  CUDA_CALL(cub::DeviceSelect::Unique(unique_workspace.get(), unique_workspace_size,
+      sorted.get(), unique.Ptr<int64_t>(), d_num_unique.get(), size, stream));
+  int64_t num_unique;
+  device->CopyDataFromTo(d_num_unique.get(), 0, &num_unique, 0, sizeof(int64_t),
+                         ctx, DGLContext{kDLCPU, 0}, DLDataType{kDLInt, 64, 1}, stream);
+  device->StreamSync(ctx, stream);
+  return unique.CreateView({num_unique}, unique->dtype);
+}
+
+/*!
+ * \brief Expand the frontiers of many searches by one hop, the key of a node
+ *        reached by a search being owner * num_nodes + node.
+ * \return The sorted keys of the nodes reached by the searches for the first time.
+ */
+template <typename IdType>
+IdArray ExpandFrontiers(
+    IdArray frontier, IdArray visited, const Adjacency<IdType>& adj, int64_t num_nodes,
+    IdArray groups, IdArray allowed, IdArray excluded) {
+  const auto& ctx = frontier->ctx;
+  auto device = runtime::DeviceAPI::Get(ctx);
+  cudaStream_t stream = runtime::CUDAThreadEntry::ThreadLocal()->stream;
+  const int64_t size = frontier->shape[0];
+  if (size == 0)
+    return frontier;
+  const int nt = cuda::FindNumThreads(size);
+  const int nb = (size + nt - 1) / nt;
+
+  Workspace<int64_t> prefix(device, ctx, size + 1);
+  CUDA_CALL(cudaMemsetAsync(prefix.get() + size, 0, sizeof(int64_t), stream));
+  CUDA_KERNEL_CALL(_DegreeKernel, nb, nt, 0, stream,
+      frontier.Ptr<int64_t>(), size, num_nodes, adj, prefix.get());
+  size_t prefix_workspace_size = 0;
+  CUDA_CALL(cub::DeviceScan::ExclusiveSum(nullptr, prefix_workspace_size,
+      prefix.get(), prefix.get(), size + 1, stream));
+  Workspace<void> prefix_workspace(device, ctx, prefix_workspace_size);
+  CUDA_CALL(cub::DeviceScan::ExclusiveSum(prefix_workspace.get(), prefix_workspace_size,
+      prefix.get(), prefix.get(), size + 1, stream));
+  int64_t num_cand;
+  device->CopyDataFromTo(prefix.get(), size * sizeof(int64_t), &num_cand, 0,
+                         sizeof(int64_t), ctx, DGLContext{kDLCPU, 0},
+                         DLDataType{kDLInt, 64, 1}, stream);
+  device->StreamSync(ctx, stream);
+  if (num_cand == 0)
+    return NewIdArray(0, ctx, 64);
+
+  Workspace<int64_t> cand(device, ctx, num_cand);
+  Workspace<int8_t> flags(device, ctx, num_cand);
+  const bool has_groups = !IsNullArray(groups);
+  const bool has_allowed = !IsNullArray(allowed);
+  const bool has_excluded = !IsNullArray(excluded);
+  CUDA_KERNEL_CALL(_ExpandKernel, nb, nt, 0, stream,
+      frontier.Ptr<int64_t>(), size, num_nodes, adj, prefix.get(),
+      visited.Ptr<int64_t>(), visited->shape[0],
+      has_groups ? groups.Ptr<int64_t>() : nullptr,
+      has_allowed ? allowed.Ptr<int64_t>() : nullptr,
+      has_allowed ? allowed->shape[0] : 0,
+      has_excluded ? excluded.Ptr<int64_t>() : nullptr,
+      has_excluded ? excluded->shape[0] : 0,
+      cand.get(), flags.get());
+
+  IdArray selected = NewIdArray(num_cand, ctx, 64);
+  Workspace<int64_t> d_num_selected(device, ctx, 1);
+  size_t select_workspace_size = 0;
+  CUDA_CALL(cub::DeviceSelect::Flagged(nullptr, select_workspace_size,
+      cand.get(), flags.get(), selected.Ptr<int64_t>(), d_num_selected.get(), num_cand,
+      stream));
+  Workspace<void> select_workspace(device, ctx, select_workspace_size);
+  CUDA_CALL(cub::DeviceSelect::Flagged(select_workspace.get(), select_workspace_size,
+      cand.get(), flags.get(), selected.Ptr<int64_t>(), d_num_selected.get(), num_cand,
+      stream));
+  int64_t num_selected;
+  device->CopyDataFromTo(d_num_selected.get(), 0, &num_selected, 0, sizeof(int64_t),
+                         ctx, DGLContext{kDLCPU, 0}, DLDataType{kDLInt, 64, 1}, stream);
+  device->StreamSync(ctx, stream);
+  return SortUnique(selected.CreateView({num_selected}, selected->dtype));
+}
+
+}  // namespace
+
+template <DLDeviceType XPU, typename IdType>
+std::vector<NDArray> CSRKHopExpand(
+    const std::vector<CSRMatrix>& adjs, NDArray seeds, NDArray seed_offsets,
+    int64_t num_hops) {
+  const auto& ctx = seeds->ctx;
+  auto device = runtime::DeviceAPI::Get(ctx);
+  cudaStream_t stream = runtime::CUDAThreadEntry::ThreadLocal()->stream;
+  const uint8_t nbits = seeds->dtype.bits;
+  const int64_t num_nodes = adjs[0].num_rows;
+  const int64_t num_seeds = seeds->shape[0];
+  const int64_t num_groups = seed_offsets->shape[0] - 1;
+  CHECK_LE(adjs.size(), 2) << "At most two adjacency matrices are supported on GPU.";
+  Adjacency<IdType> adj;
+  adj.num = adjs.size();
+  for (int a = 0; a < adj.num; ++a) {
+    adj.indptr[a] = adjs[a].indptr.Ptr<IdType>();
+    adj.indices[a] = adjs[a].indices.Ptr<IdType>();
+  }
+
+  const std::vector<IdType> offsets = seed_offsets.ToVector<IdType>();
+  CHECK(offsets[0] == 0 && offsets[num_groups] == num_seeds)
+    << "The seed offsets must span the seeds.";
+  int64_t max_seeds = 0;
+  for (int64_t g = 0; g < num_groups; ++g) {
+    CHECK_LE(offsets[g], offsets[g + 1]) << "Invalid seed offsets.";
+    max_seeds = std::max<int64_t>(max_seeds, offsets[g + 1] - offsets[g]);
+  }
+  IdArray seed_keys = NewIdArray(num_seeds, ctx, 64);
+  IdArray seed_groups = NewIdArray(num_seeds, ctx, 64);
+  if (num_seeds > 0) {
+    const int nt = cuda::FindNumThreads(num_seeds);
+    const int nb = (num_seeds + nt - 1) / nt;
+    CUDA_KERNEL_CALL(_SeedKeysKernel, nb, nt, 0, stream,
+        seeds.Ptr<IdType>(), num_seeds, seed_offsets.Ptr<IdType>(), num_groups,
+        num_nodes, seed_keys.Ptr<int64_t>(), seed_groups.Ptr<int64_t>());
+  }
+  const IdArray sorted_seed_keys = SortUnique(seed_keys);
+  CHECK_EQ(sorted_seed_keys->shape[0], num_seeds) << "The seeds of a group must be unique.";
+
+  // the nodes reached at every hop, the seeds first
+  std::vector<IdArray> hops = {seed_keys};
+  IdArray visited = sorted_seed_keys;
+  IdArray frontier = sorted_seed_keys;
+  for (int64_t hop = 0; hop < num_hops && frontier->shape[0] > 0; ++hop) {
+    frontier = ExpandFrontiers<IdType>(frontier, visited, adj, num_nodes,
+                                       NullArray(), NullArray(), NullArray());
+    if (frontier->shape[0] == 0)
+      break;
+    hops.push_back(frontier);
+    visited = Sort(Concat({visited, frontier})).first;
+  }
+
+  // order the nodes by group, then by hop, keeping the order of each hop
+  const int64_t num_tags = num_hops + 1;
+  std::vector<IdArray> tags(hops.size());
+  for (size_t hop = 0; hop < hops.size(); ++hop) {
+    const int64_t size = hops[hop]->shape[0];
+    tags[hop] = NewIdArray(size, ctx, 64);
+    if (size == 0)
+      continue;
+    const int nt = cuda::FindNumThreads(size);
+    const int nb = (size + nt - 1) / nt;
+    CUDA_KERNEL_CALL(_HopTagKernel, nb, nt, 0, stream,
+        hops[hop].Ptr<int64_t>(), size, num_nodes, static_cast<int64_t>(hop), num_tags,
+        tags[hop].Ptr<int64_t>());
+  }
+  IdArray sorted_tags, perm;
+  std::tie(sorted_tags, perm) = Sort(Concat(tags));
+  const IdArray member_keys = IndexSelect(Concat(hops), perm);
+  const int64_t total = member_keys->shape[0];
+  IdArray ret_nodes = NewIdArray(total, ctx, nbits);
+  IdArray node_offsets = Full(0, num_groups + 1, nbits, ctx);
+  if (total > 0) {
+    const int nt = cuda::FindNumThreads(total);
+    const int nb = (total + nt - 1) / nt;
+    CUDA_KERNEL_CALL(_NodesKernel, nb, nt, 0, stream,
+        member_keys.Ptr<int64_t>(), sorted_tags.Ptr<int64_t>(), total, num_nodes,
+        num_tags, num_groups, ret_nodes.Ptr<IdType>(), node_offsets.Ptr<IdType>());
+  }
+
+  // the distances from every seed, by a search whose owner is the seed
+  NDArray ret_dists = NDArray::Empty({total, max_seeds}, seeds->dtype, ctx);
+  if (total * max_seeds == 0)
+    return {ret_nodes, node_offsets, ret_dists};
+  CUDA_CALL(cudaMemsetAsync(ret_dists->data, 0xFF, total * max_seeds * sizeof(IdType), stream));
+  IdArray sorted_members, member_pos;
+  std::tie(sorted_members, member_pos) = Sort(member_keys);
+  // the keys of the searches are sorted by seed
+  visited = Add(Mul(Range(0, num_seeds, 64, ctx), num_nodes), AsNumBits(seeds, 64));
+  frontier = visited;
+  for (IdType dist = 0; frontier->shape[0] > 0; ++dist) {
+    const int64_t size = frontier->shape[0];
+    const int nt = cuda::FindNumThreads(size);
+    const int nb = (size + nt - 1) / nt;
+    CUDA_KERNEL_CALL(_DistanceKernel, nb, nt, 0, stream,
+        frontier.Ptr<int64_t>(), size, num_nodes, dist,
+        seed_groups.Ptr<int64_t>(), seed_offsets.Ptr<IdType>(),
+        sorted_members.Ptr<int64_t>(), member_pos.Ptr<int64_t>(), total,
+        max_seeds, ret_dists.Ptr<IdType>());
+    // the paths stay in the group, and stop at the other seeds
+    frontier = ExpandFrontiers<IdType>(frontier, visited, adj, num_nodes,
+                                       seed_groups, sorted_members, sorted_seed_keys);
+    if (frontier->shape[0] > 0)
+      visited = Sort(Concat({visited, frontier})).first;
+  }
+  return {ret_nodes, node_offsets, ret_dists};
+}
+
+template std::vector<NDArray> CSRKHopExpand<kDLGPU, int32_t>(
+    const std::vector<CSRMatrix>&, NDArray, NDArray, int64_t);
+template std::vector<NDArray> CSRKHopExpand<kDLGPU, int64_t>(
+    const std::vector<CSRMatrix>&, NDArray, NDArray, int64_t);
+
+}  // namespace impl
+}  // namespace aten
+}  // namespace dgl
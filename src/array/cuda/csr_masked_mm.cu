@@ -0,0 +1,123 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file array/cuda/csr_masked_mm.cu
+ * \brief CSR Matrix Multiplication at the entries of a mask on GPU
+ */
+#include <dgl/array.h>
+#include "./utils.h"
+#include "../../runtime/cuda/cuda_common.h"
+
+namespace dgl {
+
+using namespace dgl::runtime;
+
+namespace aten {
+
+namespace {
+
+/*!
+ * \brief A row is searched into the other one instead of merged with it when
+ *        it is this many times shorter.
+ */
+constexpr int64_t kSearchRatio = 16;
+
+/*!
+ * \brief The dot product of a sparse row with sorted columns and a longer one,
+ *        searching the entries of the first one into the second one.
+ */
+template <typename IdType, typename DType>
+__device__ __forceinline__ DType _SearchDot(
+    const IdType* a_cols, const IdType* a_eids, const DType* a_data, IdType a_begin, IdType a_end,
+    const IdType* b_cols, const IdType* b_eids, const DType* b_data, IdType b_begin, IdType b_end) {
+  DType sum = 0;
+  for (IdType u = a_begin; u < a_end && b_begin < b_end; ++u) {
+    b_begin = dgl::cuda::_LowerBound(b_cols, b_begin, b_end, a_cols[u]);
+    if (b_begin < b_end && b_cols[b_begin] == a_cols[u])
+      sum += a_data[a_eids ? a_eids[u] : u] * b_data[b_eids ? b_eids[b_begin] : b_begin];
+  }
+  return sum;
+}
+
+/*!
+ * \brief CUDA kernel computing every entry of the mask as the dot product of a
+ *        row of A and a column of B, i.e. a row of B_t, by merging them, or by
+ *        searching the shorter one into the longer one if they are of very
+ *        different lengths.
+ * \note It uses edge parallel strategy, every thread is responsible for an
+ *       entry of the mask.
+ */
+template <typename IdType, typename DType>
+__global__ void _CSRMaskedMMKernel(
+    const IdType* __restrict__ A_indptr,
+    const IdType* __restrict__ A_indices,
+    const IdType* __restrict__ A_eids,
+    const DType* __restrict__ A_data,
+    const IdType* __restrict__ B_indptr,
+    const IdType* __restrict__ B_indices,
+    const IdType* __restrict__ B_eids,
+    const DType* __restrict__ B_data,
+    const IdType* __restrict__ mask_rows,
+    const IdType* __restrict__ mask_cols,
+    DType* __restrict__ C_data,
+    int64_t nnz) {
+  int64_t tx = blockIdx.x * blockDim.x + threadIdx.x;
+  const int64_t stride_x = gridDim.x * blockDim.x;
+  while (tx < nnz) {
+    const IdType row = mask_rows[tx], col = mask_cols[tx];
+    IdType u = A_indptr[row], v = B_indptr[col];
+    const IdType a_end = A_indptr[row + 1], b_end = B_indptr[col + 1];
+    DType sum = 0;
+    if ((a_end - u) * kSearchRatio < b_end - v) {
+      sum = _SearchDot(A_indices, A_eids, A_data, u, a_end,
+                       B_indices, B_eids, B_data, v, b_end);
+    } else if ((b_end - v) * kSearchRatio < a_end - u) {
+      sum = _SearchDot(B_indices, B_eids, B_data, v, b_end,
+                       A_indices, A_eids, A_data, u, a_end);
+    } else {
+      while (u < a_end && v < b_end) {
+        const IdType a_col = A_indices[u], b_col = B_indices[v];
+        if (a_col == b_col)
+          sum += A_data[A_eids ? A_eids[u] : u] * B_data[B_eids ? B_eids[v] : v];
+        u += (a_col <= b_col);
+        v += (b_col <= a_col);
+      }
+    }
+    C_data[tx] = sum;
+    tx += stride_x;
+  }
+}
+
+};  // namespace
+
+template <int XPU, typename IdType, typename DType>
+NDArray CSRMaskedMM(
+    const CSRMatrix& A,
+    NDArray A_weights,
+    const CSRMatrix& B_t,
+    NDArray B_weights,
+    const COOMatrix& mask) {
+  const int64_t nnz = mask.row->shape[0];
+  NDArray C_weights = NDArray::Empty({nnz}, A_weights->dtype, A_weights->ctx);
+  auto* thr_entry = runtime::CUDAThreadEntry::ThreadLocal();
+  const int nt = dgl::cuda::FindNumThreads(nnz);
+  const int nb = (nnz + nt - 1) / nt;
+  CUDA_KERNEL_CALL((_CSRMaskedMMKernel<IdType, DType>), nb, nt, 0, thr_entry->stream,
+      A.indptr.Ptr<IdType>(), A.indices.Ptr<IdType>(),
+      CSRHasData(A) ? A.data.Ptr<IdType>() : nullptr, A_weights.Ptr<DType>(),
+      B_t.indptr.Ptr<IdType>(), B_t.indices.Ptr<IdType>(),
+      CSRHasData(B_t) ? B_t.data.Ptr<IdType>() : nullptr, B_weights.Ptr<DType>(),
+      mask.row.Ptr<IdType>(), mask.col.Ptr<IdType>(), C_weights.Ptr<DType>(), nnz);
+  return C_weights;
+}
+
+template NDArray CSRMaskedMM<kDLGPU, int32_t, float>(
+    const CSRMatrix&, NDArray, const CSRMatrix&, NDArray, const COOMatrix&);
+template NDArray CSRMaskedMM<kDLGPU, int64_t, float>(
+    const CSRMatrix&, NDArray, const CSRMatrix&, NDArray, const COOMatrix&);
+template NDArray CSRMaskedMM<kDLGPU, int32_t, double>(
+    const CSRMatrix&, NDArray, const CSRMatrix&, NDArray, const COOMatrix&);
+template NDArray CSRMaskedMM<kDLGPU, int64_t, double>(
+    const CSRMatrix&, NDArray, const CSRMatrix&, NDArray, const COOMatrix&);
+
+};  // namespace aten
+};  // namespace dgl
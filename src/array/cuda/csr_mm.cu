@@ -5,8 +5,11 @@
  */
 #include <dgl/array.h>
 #include <dgl/runtime/device_api.h>
+#include <algorithm>
+#include <vector>
 #include "./functor.cuh"
 #include "./cusparse_dispatcher.cuh"
+#include "./utils.h"
 #include "../../runtime/cuda/cuda_common.h"
 
 namespace dgl {
@@ -208,6 +211,147 @@ std::pair<CSRMatrix, NDArray> CusparseSpgemm(
 #endif  // __CUDACC_VER_MAJOR__ == 11
 }  // namespace cusparse
 
+namespace {
+
+/*! \brief The number of warps, i.e. rows, per thread block of the numeric phase. */
+constexpr int kNumericWarps = 8;
+
+/*!
+ * \brief An estimate of the device memory cuSPARSE needs per intermediate
+ *        product of SpGEMM, used to bound the size of a chunk of rows.
+ */
+template <typename DType>
+size_t SpgemmBytesPerProduct() {
+  return 2 * (sizeof(int32_t) + sizeof(DType));
+}
+
+/*! \brief The number of intermediate products of every row of A x B. */
+template <typename IdType>
+__global__ void _RowProductsKernel(
+    const IdType* __restrict__ A_indptr,
+    const IdType* __restrict__ A_indices,
+    const IdType* __restrict__ B_indptr,
+    int64_t num_rows,
+    int64_t* __restrict__ row_products) {
+  int64_t tx = blockIdx.x * blockDim.x + threadIdx.x;
+  const int64_t stride_x = gridDim.x * blockDim.x;
+  while (tx < num_rows) {
+    int64_t products = 0;
+    for (IdType u = A_indptr[tx]; u < A_indptr[tx + 1]; ++u) {
+      const IdType w = A_indices[u];
+      products += B_indptr[w + 1] - B_indptr[w];
+    }
+    row_products[tx] = products;
+    tx += stride_x;
+  }
+}
+
+/*!
+ * \brief CUDA kernel of the numeric phase of SpGEMM.
+ * \note it uses node parallel strategy, every warp is responsible for a row of
+ *       C. The lanes share the entries of a row of B, whose columns are
+ *       distinct, so they update different entries of C and no atomic is
+ *       needed; the warp synchronizes before moving to the next row of B.
+ */
+template <typename IdType, typename DType>
+__global__ void _CSRMMNumericKernel(
+    const IdType* __restrict__ A_indptr,
+    const IdType* __restrict__ A_indices,
+    const IdType* __restrict__ A_eids,
+    const DType* __restrict__ A_data,
+    const IdType* __restrict__ B_indptr,
+    const IdType* __restrict__ B_indices,
+    const IdType* __restrict__ B_eids,
+    const DType* __restrict__ B_data,
+    const IdType* __restrict__ C_indptr,
+    const IdType* __restrict__ C_indices,
+    DType* __restrict__ C_data,
+    int64_t num_rows) {
+  const int lane = threadIdx.x;
+  int64_t row = blockIdx.x * blockDim.y + threadIdx.y;
+  const int64_t stride = blockDim.y * gridDim.x;
+  while (row < num_rows) {
+    const IdType c_start = C_indptr[row], c_end = C_indptr[row + 1];
+    for (IdType j = c_start + lane; j < c_end; j += 32)
+      C_data[j] = 0;
+    __syncwarp();
+    for (IdType u = A_indptr[row]; u < A_indptr[row + 1]; ++u) {
+      const IdType w = A_indices[u];
+      const DType vA = A_data[A_eids ? A_eids[u] : u];
+      for (IdType v = B_indptr[w] + lane; v < B_indptr[w + 1]; v += 32) {
+        const IdType pos = dgl::cuda::_LowerBound(C_indices, c_start, c_end, B_indices[v]);
+        C_data[pos] += vA * B_data[B_eids ? B_eids[v] : v];
+      }
+      __syncwarp();
+    }
+    row += stride;
+  }
+}
+
+/*!
+ * \brief SpGEMM of 32-bit matrices whose weights are ordered as the entries,
+ *        split in chunks of rows of A whose intermediate products fit in the
+ *        free device memory.
+ */
+template <typename DType>
+std::pair<CSRMatrix, NDArray> _ChunkedSpgemm(
+    const CSRMatrix& A,
+    NDArray A_weights,
+    const CSRMatrix& B,
+    NDArray B_weights) {
+  const auto& ctx = A.indptr->ctx;
+  auto* thr_entry = runtime::CUDAThreadEntry::ThreadLocal();
+  const int64_t m = A.num_rows;
+  if (m == 0)
+    return cusparse::CusparseSpgemm<DType, int32_t>(A, A_weights, B, B_weights);
+  IdArray row_products = NewIdArray(m, ctx, 64);
+  const int nt = dgl::cuda::FindNumThreads(m);
+  const int nb = (m + nt - 1) / nt;
+  CUDA_KERNEL_CALL(_RowProductsKernel<int32_t>, nb, nt, 0, thr_entry->stream,
+      A.indptr.Ptr<int32_t>(), A.indices.Ptr<int32_t>(), B.indptr.Ptr<int32_t>(),
+      m, row_products.Ptr<int64_t>());
+  IdArray prefix = CumSum(row_products, true);
+  size_t free_mem = 0, total_mem = 0;
+  CUDA_CALL(cudaMemGetInfo(&free_mem, &total_mem));
+  // leave half of the free memory to the outputs and the other allocations
+  const int64_t budget = std::max<int64_t>(
+      free_mem / 2 / SpgemmBytesPerProduct<DType>(), 1);
+  if (IndexSelect<int64_t>(prefix, m) <= budget)
+    return cusparse::CusparseSpgemm<DType, int32_t>(A, A_weights, B, B_weights);
+
+  const std::vector<int64_t> products = prefix.ToVector<int64_t>();
+  const std::vector<int32_t> indptr = A.indptr.ToVector<int32_t>();
+  std::vector<IdArray> C_indptrs, C_indices;
+  std::vector<NDArray> C_weights;
+  int64_t start = 0, nnz = 0;
+  while (start < m) {
+    // the largest chunk within the budget, with at least one row
+    int64_t end = std::upper_bound(
+        products.begin() + start + 1, products.end(), products[start] + budget) -
+      products.begin() - 1;
+    end = std::max(end, start + 1);
+    const CSRMatrix A_chunk(
+        end - start, A.num_cols,
+        Sub(IndexSelect(A.indptr, start, end + 1), indptr[start]),
+        IndexSelect(A.indices, indptr[start], indptr[end]),
+        NullArray(A.indptr->dtype, ctx));
+    auto C_chunk = cusparse::CusparseSpgemm<DType, int32_t>(
+        A_chunk, IndexSelect(A_weights, indptr[start], indptr[end]), B, B_weights);
+    C_indptrs.push_back(start == 0 ? C_chunk.first.indptr :
+        Add(IndexSelect(C_chunk.first.indptr, 1, end - start + 1), nnz));
+    C_indices.push_back(C_chunk.first.indices);
+    C_weights.push_back(C_chunk.second);
+    nnz += C_chunk.first.indices->shape[0];
+    start = end;
+  }
+  return {
+      CSRMatrix(m, B.num_cols, Concat(C_indptrs), Concat(C_indices),
+                NullArray(A.indptr->dtype, ctx)),
+      Concat(C_weights)};
+}
+
+}  // namespace
+
 template <int XPU, typename IdType, typename DType>
 std::pair<CSRMatrix, NDArray> CSRMM(
     const CSRMatrix& A,
@@ -237,7 +381,7 @@ std::pair<CSRMatrix, NDArray> CSRMM(
   if (CSRHasData(B))
     newB_weights = IndexSelect(B_weights, B.data);
 
-  auto result = cusparse::CusparseSpgemm<DType, int32_t>(
+  auto result = _ChunkedSpgemm<DType>(
       cast ? newA : A, CSRHasData(A) ? newA_weights : A_weights,
       cast ? newB : B, CSRHasData(B) ? newB_weights : B_weights);
 
@@ -253,6 +397,30 @@ std::pair<CSRMatrix, NDArray> CSRMM(
   }
 }
 
+template <int XPU, typename IdType, typename DType>
+NDArray CSRMMNumeric(
+    const CSRMatrix& A,
+    NDArray A_weights,
+    const CSRMatrix& B,
+    NDArray B_weights,
+    const CSRMatrix& C) {
+  const auto& ctx = A.indptr->ctx;
+  NDArray C_weights = NDArray::Empty({C.indices->shape[0]}, A_weights->dtype, ctx);
+  if (C.num_rows == 0)
+    return C_weights;
+  auto* thr_entry = runtime::CUDAThreadEntry::ThreadLocal();
+  const dim3 nthrs(32, kNumericWarps);
+  const int nbx = dgl::cuda::FindNumBlocks<'x'>((C.num_rows + kNumericWarps - 1) / kNumericWarps);
+  CUDA_KERNEL_CALL((_CSRMMNumericKernel<IdType, DType>), nbx, nthrs, 0, thr_entry->stream,
+      A.indptr.Ptr<IdType>(), A.indices.Ptr<IdType>(),
+      CSRHasData(A) ? A.data.Ptr<IdType>() : nullptr, A_weights.Ptr<DType>(),
+      B.indptr.Ptr<IdType>(), B.indices.Ptr<IdType>(),
+      CSRHasData(B) ? B.data.Ptr<IdType>() : nullptr, B_weights.Ptr<DType>(),
+      C.indptr.Ptr<IdType>(), C.indices.Ptr<IdType>(), C_weights.Ptr<DType>(),
+      C.num_rows);
+  return C_weights;
+}
+
 template std::pair<CSRMatrix, NDArray> CSRMM<kDLGPU, int32_t, float>(
     const CSRMatrix&, NDArray, const CSRMatrix&, NDArray);
 template std::pair<CSRMatrix, NDArray> CSRMM<kDLGPU, int64_t, float>(
@@ -262,5 +430,14 @@ template std::pair<CSRMatrix, NDArray> CSRMM<kDLGPU, int32_t, double>(
 template std::pair<CSRMatrix, NDArray> CSRMM<kDLGPU, int64_t, double>(
     const CSRMatrix&, NDArray, const CSRMatrix&, NDArray);
 
+template NDArray CSRMMNumeric<kDLGPU, int32_t, float>(
+    const CSRMatrix&, NDArray, const CSRMatrix&, NDArray, const CSRMatrix&);
+template NDArray CSRMMNumeric<kDLGPU, int64_t, float>(
+    const CSRMatrix&, NDArray, const CSRMatrix&, NDArray, const CSRMatrix&);
+template NDArray CSRMMNumeric<kDLGPU, int32_t, double>(
+    const CSRMatrix&, NDArray, const CSRMatrix&, NDArray, const CSRMatrix&);
+template NDArray CSRMMNumeric<kDLGPU, int64_t, double>(
+    const CSRMatrix&, NDArray, const CSRMatrix&, NDArray, const CSRMatrix&);
+
 }  // namespace aten
 }  // namespace dgl
@@ -56,58 +56,12 @@ bool CSRIsSorted(CSRMatrix csr) {
 template bool CSRIsSorted<kDLGPU, int32_t>(CSRMatrix csr);
 template bool CSRIsSorted<kDLGPU, int64_t>(CSRMatrix csr);
 
+/*!
+ * \brief Sort the columns of every row with a segmented radix sort over the
+ *        rows, going only over the bits needed to store the columns.
+ */
 template <DLDeviceType XPU, typename IdType>
 void CSRSort_(CSRMatrix* csr) {
-  LOG(FATAL) << "Unreachable codes";
-}
-
-template <>
-void CSRSort_<kDLGPU, int32_t>(CSRMatrix* csr) {
-  auto* thr_entry = runtime::CUDAThreadEntry::ThreadLocal();
-  auto device = runtime::DeviceAPI::Get(csr->indptr->ctx);
-  // allocate cusparse handle if needed
-  if (!thr_entry->cusparse_handle) {
-    CUSPARSE_CALL(cusparseCreate(&(thr_entry->cusparse_handle)));
-  }
-  CUSPARSE_CALL(cusparseSetStream(thr_entry->cusparse_handle, thr_entry->stream));
-
-  NDArray indptr = csr->indptr;
-  NDArray indices = csr->indices;
-  const auto& ctx = indptr->ctx;
-  const int64_t nnz = indices->shape[0];
-  if (!aten::CSRHasData(*csr))
-    csr->data = aten::Range(0, nnz, indices->dtype.bits, ctx);
-  NDArray data = csr->data;
-
-  size_t workspace_size = 0;
-  CUSPARSE_CALL(cusparseXcsrsort_bufferSizeExt(
-      thr_entry->cusparse_handle,
-      csr->num_rows, csr->num_cols, nnz,
-      indptr.Ptr<int32_t>(), indices.Ptr<int32_t>(),
-      &workspace_size));
-  void* workspace = device->AllocWorkspace(ctx, workspace_size);
-
-  cusparseMatDescr_t descr;
-  CUSPARSE_CALL(cusparseCreateMatDescr(&descr));
-  CUSPARSE_CALL(cusparseSetMatType(descr, CUSPARSE_MATRIX_TYPE_GENERAL));
-  CUSPARSE_CALL(cusparseSetMatIndexBase(descr, CUSPARSE_INDEX_BASE_ZERO));
-  CUSPARSE_CALL(cusparseXcsrsort(
-      thr_entry->cusparse_handle,
-      csr->num_rows, csr->num_cols, nnz,
-      descr,
-      indptr.Ptr<int32_t>(), indices.Ptr<int32_t>(),
-      data.Ptr<int32_t>(),
-      workspace));
-
-  csr->sorted = true;
-
-  // free resources
-  CUSPARSE_CALL(cusparseDestroyMatDescr(descr));
-  device->FreeWorkspace(ctx, workspace);
-}
-
-template <>
-void CSRSort_<kDLGPU, int64_t>(CSRMatrix* csr) {
   auto* thr_entry = runtime::CUDAThreadEntry::ThreadLocal();
   auto device = runtime::DeviceAPI::Get(csr->indptr->ctx);
 
@@ -116,27 +70,34 @@ void CSRSort_<kDLGPU, int64_t>(CSRMatrix* csr) {
   const auto nbits = csr->indptr->dtype.bits;
   if (!aten::CSRHasData(*csr))
     csr->data = aten::Range(0, nnz, nbits, ctx);
+  // all the columns are 0 if there are no bits to sort
+  const int num_bits = cuda::NumberOfBits(csr->num_cols);
+  if (nnz == 0 || num_bits == 0) {
+    csr->sorted = true;
+    return;
+  }
 
-  IdArray new_indices = csr->indices.Clone();
-  IdArray new_data = csr->data.Clone();
+  IdArray new_indices = aten::NewIdArray(nnz, ctx, nbits);
+  IdArray new_data = aten::NewIdArray(nnz, ctx, nbits);
 
-  const int64_t* offsets = csr->indptr.Ptr<int64_t>();
-  const int64_t* key_in = csr->indices.Ptr<int64_t>();
-  int64_t* key_out = new_indices.Ptr<int64_t>();
-  const int64_t* value_in = csr->data.Ptr<int64_t>();
-  int64_t* value_out = new_data.Ptr<int64_t>();
+  const IdType* offsets = csr->indptr.Ptr<IdType>();
+  const IdType* key_in = csr->indices.Ptr<IdType>();
+  IdType* key_out = new_indices.Ptr<IdType>();
+  const IdType* value_in = csr->data.Ptr<IdType>();
+  IdType* value_out = new_data.Ptr<IdType>();
 
-  // Allocate workspace
+  // Allocate workspace, from the workspace pool of the device so that it is
+  // reused over the calls
   size_t workspace_size = 0;
-  cub::DeviceSegmentedRadixSort::SortPairs(nullptr, workspace_size,
+  CUDA_CALL(cub::DeviceSegmentedRadixSort::SortPairs(nullptr, workspace_size,
       key_in, key_out, value_in, value_out,
-      nnz, csr->num_rows, offsets, offsets + 1);
+      nnz, csr->num_rows, offsets, offsets + 1, 0, num_bits, thr_entry->stream));
   void* workspace = device->AllocWorkspace(ctx, workspace_size);
 
   // Compute
-  cub::DeviceSegmentedRadixSort::SortPairs(workspace, workspace_size,
+  CUDA_CALL(cub::DeviceSegmentedRadixSort::SortPairs(workspace, workspace_size,
       key_in, key_out, value_in, value_out,
-      nnz, csr->num_rows, offsets, offsets + 1);
+      nnz, csr->num_rows, offsets, offsets + 1, 0, num_bits, thr_entry->stream));
 
   csr->sorted = true;
   csr->indices = new_indices;
@@ -7,6 +7,7 @@
 #include <dgl/runtime/device_api.h>
 #include "./functor.cuh"
 #include "./cusparse_dispatcher.cuh"
+#include "./utils.h"
 #include "../../runtime/cuda/cuda_common.h"
 
 namespace dgl {
@@ -104,6 +105,42 @@ std::pair<CSRMatrix, NDArray> CusparseCsrgeam2(
 }
 }  // namespace cusparse
 
+namespace {
+
+/*! \brief The number of warps, i.e. rows, per thread block of the numeric phase. */
+constexpr int kNumericWarps = 8;
+
+/*!
+ * \brief CUDA kernel adding the weights of a matrix to those of the sum C.
+ * \note it uses node parallel strategy, every warp is responsible for a row.
+ *       The columns of a row are distinct, so the lanes update different
+ *       entries of C and no atomic is needed.
+ */
+template <typename IdType, typename DType>
+__global__ void _CSRSumNumericKernel(
+    const IdType* __restrict__ A_indptr,
+    const IdType* __restrict__ A_indices,
+    const IdType* __restrict__ A_eids,
+    const DType* __restrict__ A_data,
+    const IdType* __restrict__ C_indptr,
+    const IdType* __restrict__ C_indices,
+    DType* __restrict__ C_data,
+    int64_t num_rows) {
+  const int lane = threadIdx.x;
+  int64_t row = blockIdx.x * blockDim.y + threadIdx.y;
+  const int64_t stride = blockDim.y * gridDim.x;
+  while (row < num_rows) {
+    const IdType c_start = C_indptr[row], c_end = C_indptr[row + 1];
+    for (IdType u = A_indptr[row] + lane; u < A_indptr[row + 1]; u += 32) {
+      const IdType pos = dgl::cuda::_LowerBound(C_indices, c_start, c_end, A_indices[u]);
+      C_data[pos] += A_data[A_eids ? A_eids[u] : u];
+    }
+    row += stride;
+  }
+}
+
+}  // namespace
+
 template <int XPU, typename IdType, typename DType>
 std::pair<CSRMatrix, NDArray> CSRSum(
     const std::vector<CSRMatrix>& As,
@@ -166,6 +203,32 @@ std::pair<CSRMatrix, NDArray> CSRSum(
   }
 }
 
+template <int XPU, typename IdType, typename DType>
+NDArray CSRSumNumeric(
+    const std::vector<CSRMatrix>& As,
+    const std::vector<NDArray>& A_weights,
+    const CSRMatrix& C) {
+  const auto& ctx = C.indptr->ctx;
+  NDArray C_weights = NDArray::Empty({C.indices->shape[0]}, A_weights[0]->dtype, ctx);
+  if (C.indices->shape[0] == 0)
+    return C_weights;
+  auto* thr_entry = runtime::CUDAThreadEntry::ThreadLocal();
+  CUDA_CALL(cudaMemsetAsync(C_weights->data, 0,
+      C.indices->shape[0] * sizeof(DType), thr_entry->stream));
+  const dim3 nthrs(32, kNumericWarps);
+  const int nbx = dgl::cuda::FindNumBlocks<'x'>(
+      (C.num_rows + kNumericWarps - 1) / kNumericWarps);
+  // the matrices are added one after another, by kernels ordered on the stream
+  for (size_t i = 0; i < As.size(); ++i) {
+    CUDA_KERNEL_CALL((_CSRSumNumericKernel<IdType, DType>), nbx, nthrs, 0, thr_entry->stream,
+        As[i].indptr.Ptr<IdType>(), As[i].indices.Ptr<IdType>(),
+        CSRHasData(As[i]) ? As[i].data.Ptr<IdType>() : nullptr, A_weights[i].Ptr<DType>(),
+        C.indptr.Ptr<IdType>(), C.indices.Ptr<IdType>(), C_weights.Ptr<DType>(),
+        C.num_rows);
+  }
+  return C_weights;
+}
+
 template std::pair<CSRMatrix, NDArray> CSRSum<kDLGPU, int32_t, float>(
     const std::vector<CSRMatrix>&, const std::vector<NDArray>&);
 template std::pair<CSRMatrix, NDArray> CSRSum<kDLGPU, int64_t, float>(
@@ -175,5 +238,14 @@ template std::pair<CSRMatrix, NDArray> CSRSum<kDLGPU, int32_t, double>(
 template std::pair<CSRMatrix, NDArray> CSRSum<kDLGPU, int64_t, double>(
     const std::vector<CSRMatrix>&, const std::vector<NDArray>&);
 
+template NDArray CSRSumNumeric<kDLGPU, int32_t, float>(
+    const std::vector<CSRMatrix>&, const std::vector<NDArray>&, const CSRMatrix&);
+template NDArray CSRSumNumeric<kDLGPU, int64_t, float>(
+    const std::vector<CSRMatrix>&, const std::vector<NDArray>&, const CSRMatrix&);
+template NDArray CSRSumNumeric<kDLGPU, int32_t, double>(
+    const std::vector<CSRMatrix>&, const std::vector<NDArray>&, const CSRMatrix&);
+template NDArray CSRSumNumeric<kDLGPU, int64_t, double>(
+    const std::vector<CSRMatrix>&, const std::vector<NDArray>&, const CSRMatrix&);
+
 }  // namespace aten
 }  // namespace dgl
@@ -0,0 +1,215 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file array/cuda/edge_softmax.cu
+ * \brief Edge softmax C APIs and definitions.
+ */
+#include <dgl/array.h>
+#include <limits>
+#include "./utils.h"
+#include "./fp16.cuh"
+#include "../../runtime/cuda/cuda_common.h"
+
+namespace dgl {
+
+using namespace cuda;
+
+namespace aten {
+namespace cuda {
+
+namespace {
+
+constexpr unsigned int kFullMask = 0xffffffff;
+/*! \brief The number of warps, i.e. rows, per thread block. */
+constexpr int kEdgeSoftmaxWarps = 8;
+
+/*! \brief The type the softmax is accumulated in, float for half. */
+template <typename DType>
+struct SoftmaxAccType {
+  typedef float Type;
+};
+
+template <>
+struct SoftmaxAccType<double> {
+  typedef double Type;
+};
+
+}  // namespace
+
+/*!
+ * \brief CUDA kernel of the edge softmax forward on Csr format.
+ * \note it uses node parallel strategy, every warp is responsible for a row.
+ *       The lanes keep a running maximum and normalizer over their share of
+ *       the edges of the row (online softmax), the partial states are merged
+ *       with warp shuffles, then the lanes write the normalized scores. The
+ *       heads of a row are processed one after another.
+ */
+template <typename Idx, typename DType, bool UseIdx>
+__global__ void EdgeSoftmaxForwardKernel(
+  const DType* __restrict__ score,
+  DType* __restrict__ out,
+  const Idx* __restrict__ indptr,
+  const Idx* __restrict__ edge_map,
+  int64_t num_rows, int64_t num_heads) {
+  typedef typename SoftmaxAccType<DType>::Type AccType;
+  const AccType neg_inf = -std::numeric_limits<AccType>::infinity();
+  const int lane = threadIdx.x;
+  Idx row = blockIdx.x * blockDim.y + threadIdx.y;
+  const Idx stride = blockDim.y * gridDim.x;
+  while (row < num_rows) {
+    const Idx row_start = _ldg(indptr + row), row_end = _ldg(indptr + row + 1);
+    for (int64_t h = 0; h < num_heads; ++h) {
+      AccType max_score = neg_inf, sum_exp = 0;
+      for (Idx j = row_start + lane; j < row_end; j += 32) {
+        const Idx eid = UseIdx ? _ldg(edge_map + j) : j;
+        const AccType s = static_cast<AccType>(score[eid * num_heads + h]);
+        if (s > max_score) {
+          sum_exp = sum_exp * exp(max_score - s) + 1;
+          max_score = s;
+        } else {
+          sum_exp += exp(s - max_score);
+        }
+      }
+#pragma unroll
+      for (int offset = 16; offset > 0; offset /= 2) {
+        const AccType other_max = __shfl_xor_sync(kFullMask, max_score, offset);
+        const AccType other_sum = __shfl_xor_sync(kFullMask, sum_exp, offset);
+        const AccType new_max = max(max_score, other_max);
+        sum_exp = (max_score == neg_inf ? 0 : sum_exp * exp(max_score - new_max)) +
+          (other_max == neg_inf ? 0 : other_sum * exp(other_max - new_max));
+        max_score = new_max;
+      }
+      const AccType inv_sum = 1. / sum_exp;
+      for (Idx j = row_start + lane; j < row_end; j += 32) {
+        const Idx eid = UseIdx ? _ldg(edge_map + j) : j;
+        const AccType s = static_cast<AccType>(score[eid * num_heads + h]);
+        out[eid * num_heads + h] = static_cast<DType>(exp(s - max_score) * inv_sum);
+      }
+    }
+    row += stride;
+  }
+}
+
+/*!
+ * \brief CUDA kernel of the edge softmax backward on Csr format.
+ * \note it uses the same strategy as EdgeSoftmaxForwardKernel, the sum of
+ *       out * grad_out over the row is reduced with warp shuffles.
+ */
+template <typename Idx, typename DType, bool UseIdx>
+__global__ void EdgeSoftmaxBackwardKernel(
+  const DType* __restrict__ out,
+  const DType* __restrict__ grad_out,
+  DType* __restrict__ grad_score,
+  const Idx* __restrict__ indptr,
+  const Idx* __restrict__ edge_map,
+  int64_t num_rows, int64_t num_heads) {
+  typedef typename SoftmaxAccType<DType>::Type AccType;
+  const int lane = threadIdx.x;
+  Idx row = blockIdx.x * blockDim.y + threadIdx.y;
+  const Idx stride = blockDim.y * gridDim.x;
+  while (row < num_rows) {
+    const Idx row_start = _ldg(indptr + row), row_end = _ldg(indptr + row + 1);
+    for (int64_t h = 0; h < num_heads; ++h) {
+      AccType accum = 0;
+      for (Idx j = row_start + lane; j < row_end; j += 32) {
+        const int64_t off = (UseIdx ? _ldg(edge_map + j) : j) * num_heads + h;
+        accum += static_cast<AccType>(out[off]) * static_cast<AccType>(grad_out[off]);
+      }
+#pragma unroll
+      for (int offset = 16; offset > 0; offset /= 2)
+        accum += __shfl_xor_sync(kFullMask, accum, offset);
+      for (Idx j = row_start + lane; j < row_end; j += 32) {
+        const int64_t off = (UseIdx ? _ldg(edge_map + j) : j) * num_heads + h;
+        const AccType o = static_cast<AccType>(out[off]);
+        grad_score[off] = static_cast<DType>(
+            o * (static_cast<AccType>(grad_out[off]) - accum));
+      }
+    }
+    row += stride;
+  }
+}
+
+}  // namespace cuda
+
+/*! \brief Edge softmax forward on Csr format. */
+template <int XPU, typename IdType, int bits>
+void EdgeSoftmaxForwardCsr(const CSRMatrix& csc, NDArray score, NDArray out) {
+  if (csc.num_rows == 0 || score->shape[0] == 0)
+    return;
+  const int64_t num_heads = score.NumElements() / score->shape[0];
+  const IdType* indptr = csc.indptr.Ptr<IdType>();
+  const IdType* edge_map = csc.data.Ptr<IdType>();
+  auto* thr_entry = runtime::CUDAThreadEntry::ThreadLocal();
+  const dim3 nthrs(32, cuda::kEdgeSoftmaxWarps);
+  const int nbx = FindNumBlocks<'x'>(
+      (csc.num_rows + cuda::kEdgeSoftmaxWarps - 1) / cuda::kEdgeSoftmaxWarps);
+  SWITCH_BITS(bits, DType, {
+    if (!IsNullArray(csc.data)) {
+      CUDA_KERNEL_CALL((cuda::EdgeSoftmaxForwardKernel<IdType, DType, true>),
+          nbx, nthrs, 0, thr_entry->stream,
+          score.Ptr<DType>(), out.Ptr<DType>(), indptr, edge_map,
+          csc.num_rows, num_heads);
+    } else {
+      CUDA_KERNEL_CALL((cuda::EdgeSoftmaxForwardKernel<IdType, DType, false>),
+          nbx, nthrs, 0, thr_entry->stream,
+          score.Ptr<DType>(), out.Ptr<DType>(), indptr, edge_map,
+          csc.num_rows, num_heads);
+    }
+  });
+}
+
+/*! \brief Edge softmax backward on Csr format. */
+template <int XPU, typename IdType, int bits>
+void EdgeSoftmaxBackwardCsr(const CSRMatrix& csc, NDArray out,
+                            NDArray grad_out, NDArray grad_score) {
+  if (csc.num_rows == 0 || out->shape[0] == 0)
+    return;
+  const int64_t num_heads = out.NumElements() / out->shape[0];
+  const IdType* indptr = csc.indptr.Ptr<IdType>();
+  const IdType* edge_map = csc.data.Ptr<IdType>();
+  auto* thr_entry = runtime::CUDAThreadEntry::ThreadLocal();
+  const dim3 nthrs(32, cuda::kEdgeSoftmaxWarps);
+  const int nbx = FindNumBlocks<'x'>(
+      (csc.num_rows + cuda::kEdgeSoftmaxWarps - 1) / cuda::kEdgeSoftmaxWarps);
+  SWITCH_BITS(bits, DType, {
+    if (!IsNullArray(csc.data)) {
+      CUDA_KERNEL_CALL((cuda::EdgeSoftmaxBackwardKernel<IdType, DType, true>),
+          nbx, nthrs, 0, thr_entry->stream,
+          out.Ptr<DType>(), grad_out.Ptr<DType>(), grad_score.Ptr<DType>(),
+          indptr, edge_map, csc.num_rows, num_heads);
+    } else {
+      CUDA_KERNEL_CALL((cuda::EdgeSoftmaxBackwardKernel<IdType, DType, false>),
+          nbx, nthrs, 0, thr_entry->stream,
+          out.Ptr<DType>(), grad_out.Ptr<DType>(), grad_score.Ptr<DType>(),
+          indptr, edge_map, csc.num_rows, num_heads);
+    }
+  });
+}
+
+template void EdgeSoftmaxForwardCsr<kDLGPU, int32_t, 16>(
+    const CSRMatrix& csc, NDArray score, NDArray out);
+template void EdgeSoftmaxForwardCsr<kDLGPU, int64_t, 16>(
+    const CSRMatrix& csc, NDArray score, NDArray out);
+template void EdgeSoftmaxForwardCsr<kDLGPU, int32_t, 32>(
+    const CSRMatrix& csc, NDArray score, NDArray out);
+template void EdgeSoftmaxForwardCsr<kDLGPU, int64_t, 32>(
+    const CSRMatrix& csc, NDArray score, NDArray out);
+template void EdgeSoftmaxForwardCsr<kDLGPU, int32_t, 64>(
+    const CSRMatrix& csc, NDArray score, NDArray out);
+template void EdgeSoftmaxForwardCsr<kDLGPU, int64_t, 64>(
+    const CSRMatrix& csc, NDArray score, NDArray out);
+
+template void EdgeSoftmaxBackwardCsr<kDLGPU, int32_t, 16>(
+    const CSRMatrix& csc, NDArray out, NDArray grad_out, NDArray grad_score);
+template void EdgeSoftmaxBackwardCsr<kDLGPU, int64_t, 16>(
+    const CSRMatrix& csc, NDArray out, NDArray grad_out, NDArray grad_score);
+template void EdgeSoftmaxBackwardCsr<kDLGPU, int32_t, 32>(
+    const CSRMatrix& csc, NDArray out, NDArray grad_out, NDArray grad_score);
+template void EdgeSoftmaxBackwardCsr<kDLGPU, int64_t, 32>(
+    const CSRMatrix& csc, NDArray out, NDArray grad_out, NDArray grad_score);
+template void EdgeSoftmaxBackwardCsr<kDLGPU, int32_t, 64>(
+    const CSRMatrix& csc, NDArray out, NDArray grad_out, NDArray grad_score);
+template void EdgeSoftmaxBackwardCsr<kDLGPU, int64_t, 64>(
+    const CSRMatrix& csc, NDArray out, NDArray grad_out, NDArray grad_score);
+
+}  // namespace aten
+}  // namespace dgl
@@ -6,6 +6,7 @@
 #ifndef DGL_ARRAY_CUDA_GE_SPMM_CUH_
 #define DGL_ARRAY_CUDA_GE_SPMM_CUH_
 
+#include <dgl/bcast.h>
 #include "macro.cuh"
 #include "atomic.cuh"
 #include "../../runtime/cuda/cuda_common.h"
@@ -18,132 +19,172 @@ using namespace cuda;
 namespace aten {
 namespace cuda {
 
-/*! 
+/*! \brief Number of warps, i.e. rows, of a GE-SpMM thread block. */
+constexpr int kGESpMMWarps = 8;
+
+/*!
  * \brief CUDA kernel of GE-SpMM on Csr.
  * \note GE-SpMM: https://arxiv.org/pdf/2007.03179.pdf
- *       The grid dimension x and y are reordered for better performance.
+ *       Every warp computes one row over 32 * CoarsenFactor features, the
+ *       grid dimension x being over rows and y over features. The column
+ *       indices and edge ids of the row are loaded 32 at a time into shared
+ *       memory by the lanes of the warp (coalesced row caching), then read
+ *       by all the lanes for their CoarsenFactor features each.
+ *
+ *       It supports any reducer and binary operator without broadcasting,
+ *       and accumulates to out as SpMMCsrKernel does.
  */
 template <typename Idx, typename DType,
-          typename BinaryOp>
+          typename BinaryOp, typename ReduceOp,
+          int CoarsenFactor, bool UseIdx = false>
 __global__ void GESpMMKernel(
     const DType* __restrict__ ufeat,
     const DType* __restrict__ efeat,
     DType* __restrict__ out,
+    Idx* __restrict__ arg_u,
+    Idx* __restrict__ arg_e,
     const Idx* __restrict__ indptr,
     const Idx* __restrict__ indices,
-    const int64_t num_rows, const int64_t num_cols,
-    const int64_t feat_len) {
-  const Idx rid = blockIdx.x * blockDim.y + threadIdx.y;  // over vertices dimension
-  const Idx fid = (blockIdx.y * 64) + threadIdx.x;        // over feature dimension
-
-  if (rid < num_rows && fid < feat_len) {
-    const Idx low = __ldg(indptr + rid), high = __ldg(indptr + rid + 1);
-    DType accum_0 = 0.,
-          accum_1 = 0.;
-
-    if (blockIdx.y != gridDim.y - 1) {  // fid + 32 < feat_len
-      for (Idx left = low; left < high; left += 32) {
-        if (left + 32 <= high) {
+    const Idx* __restrict__ edge_map,
+    const int64_t num_rows,
+    const int64_t ufeat_len, const int64_t efeat_len, const int64_t out_len) {
+  __shared__ Idx sh_cid[kGESpMMWarps][32];
+  __shared__ Idx sh_eid[kGESpMMWarps][32];
+  const int lane = threadIdx.x, warp = threadIdx.y;
+  const int64_t rid = static_cast<int64_t>(blockIdx.x) * blockDim.y + warp;
+  // the whole warp leaves, so the warp-level synchronizations below are safe
+  if (rid >= num_rows)
+    return;
+  const int64_t fid = static_cast<int64_t>(blockIdx.y) * (32 * CoarsenFactor) + lane;
+
+  DType accum[CoarsenFactor];
+  Idx argu[CoarsenFactor], arge[CoarsenFactor];
 #pragma unroll
-          for (Idx i = 0; i < 32; ++i) {
-            const Idx eid = left + i; 
-            const Idx cid = __ldg(indices + eid);
-            const Idx offset = feat_len * cid + fid;
-            if (BinaryOp::use_rhs) {
-              accum_0 += BinaryOp::Call(ufeat + offset, efeat + eid);
-              accum_1 += BinaryOp::Call(ufeat + offset + 32, efeat + eid);
-            } else {
-              accum_0 += ufeat[offset];
-              accum_1 += ufeat[offset + 32];
-            }
-          }
-        } else {
-          for (Idx i = 0; left + i < high; ++i) {
-            const Idx eid = left + i; 
-            const Idx cid = __ldg(indices + eid);
-            const Idx offset = feat_len * cid + fid;
-            if (BinaryOp::use_rhs) {
-              accum_0 += BinaryOp::Call(ufeat + offset, efeat + eid);
-              accum_1 += BinaryOp::Call(ufeat + offset + 32, efeat + eid);
-            } else {
-              accum_0 += ufeat[offset];
-              accum_1 += ufeat[offset + 32];
-            }
-          }
-        }
+  for (int j = 0; j < CoarsenFactor; ++j) {
+    accum[j] = ReduceOp::zero();
+    argu[j] = 0;
+    arge[j] = 0;
+  }
 
-        out[feat_len * rid + fid] = accum_0;
-        out[feat_len * rid + fid + 32] = accum_1;
-      }
-    } else {
-      const Idx fid_0 = fid < feat_len ? fid : 0,
-                fid_1 = fid + 32 < feat_len ? fid + 32 : 0;
-      for (int left = low; left < high; left += 32) {
-        if (left + 32 <= high) {
+  const Idx low = __ldg(indptr + rid), high = __ldg(indptr + rid + 1);
+  for (Idx left = low; left < high; left += 32) {
+    const int num = min(static_cast<Idx>(32), high - left);
+    if (lane < num) {
+      sh_cid[warp][lane] = __ldg(indices + left + lane);
+      sh_eid[warp][lane] = UseIdx ? __ldg(edge_map + left + lane) : left + lane;
+    }
+    __syncwarp();
+    for (int i = 0; i < num; ++i) {
+      const Idx cid = sh_cid[warp][i];
+      const Idx eid = sh_eid[warp][i];
+      const DType* uoff = BinaryOp::use_lhs ? (ufeat + cid * ufeat_len): nullptr;
+      const DType* eoff = BinaryOp::use_rhs ? (efeat + eid * efeat_len): nullptr;
 #pragma unroll
-          for (int i = 0; i < 32; ++i) {
-            const Idx eid = left + i; 
-            const Idx cid = __ldg(indices + eid); 
-            const Idx offset = feat_len * cid;
-            if (BinaryOp::use_rhs) {
-              accum_0 += BinaryOp::Call(ufeat + offset + fid_0, efeat + eid);
-              accum_1 += BinaryOp::Call(ufeat + offset + fid_1, efeat + eid);
-            } else {
-              accum_0 += ufeat[offset + fid_0];
-              accum_1 += ufeat[offset + fid_1];
-            }
-          }
-        } else {
-          for (int i = 0; i + left < high; ++i) {
-            const Idx eid = left + i; 
-            const Idx cid = __ldg(indices + eid); 
-            const Idx offset = feat_len * cid;
-            if (BinaryOp::use_rhs) {
-              accum_0 += BinaryOp::Call(ufeat + offset + fid_0, efeat + eid);
-              accum_1 += BinaryOp::Call(ufeat + offset + fid_1, efeat + eid);
-            } else {
-              accum_0 += ufeat[offset + fid_0];
-              accum_1 += ufeat[offset + fid_1];
-            }
-          }
+      for (int j = 0; j < CoarsenFactor; ++j) {
+        const int64_t f = fid + j * 32;
+        if (f < out_len) {
+          DType val = BinaryOp::Call(uoff + f, eoff + f);
+          ReduceOp::Call(&accum[j], &argu[j], &arge[j], val, cid, eid);
         }
-
-        out[feat_len * rid + fid] = accum_0;
-        if (fid + 32 < feat_len)
-          out[feat_len * rid + fid + 32] = accum_1;
       }
     }
+    // the cache is overwritten by the next tile
+    __syncwarp();
+  }
+
+#pragma unroll
+  for (int j = 0; j < CoarsenFactor; ++j) {
+    const int64_t f = fid + j * 32;
+    if (f < out_len) {
+      out[rid * out_len + f] += accum[j];
+      if (ReduceOp::require_arg && BinaryOp::use_lhs)
+        arg_u[rid * out_len + f] = argu[j];
+      if (ReduceOp::require_arg && BinaryOp::use_rhs)
+        arg_e[rid * out_len + f] = arge[j];
+    }
   }
 }
 
+/*!
+ * \brief Whether GE-SpMM applies: there is no broadcasting, and the feature
+ *        is wide enough to fill a warp.
+ */
+inline bool GESpMMApplicable(const BcastOff& bcast) {
+  return !bcast.use_bcast && bcast.out_len >= 32;
+}
+
+/*! \brief Launch GESpMMKernel with the given coarsening factor. */
 template <typename Idx, typename DType,
-          typename BinaryOp>
-void GESpMMCsr(
+          typename BinaryOp, typename ReduceOp, int CoarsenFactor>
+void _GESpMMCsr(
+    const BcastOff& bcast,
     const CSRMatrix& csr,
     NDArray ufeat, NDArray efeat,
-    NDArray out, int64_t feat_len) {
+    NDArray out, NDArray argu, NDArray arge) {
   const Idx *indptr = csr.indptr.Ptr<Idx>();
   const Idx *indices = csr.indices.Ptr<Idx>();
+  const Idx *edge_map = csr.data.Ptr<Idx>();
   const DType *ufeat_data = ufeat.Ptr<DType>();
   const DType *efeat_data = efeat.Ptr<DType>();
   DType *out_data = out.Ptr<DType>();
+  Idx* argu_data = argu.Ptr<Idx>();
+  Idx* arge_data = arge.Ptr<Idx>();
 
   auto* thr_entry = runtime::CUDAThreadEntry::ThreadLocal();
-  
+
+  const int64_t feat_len = bcast.out_len;
   const int ntx = 32;
-  const int nty = 32;
-  const int nby = (feat_len + (ntx * 2) - 1) / (ntx * 2);
+  const int nty = kGESpMMWarps;
   const int nbx = (csr.num_rows + nty - 1) / nty;
+  const int nby = FindNumBlocks<'y'>((feat_len + ntx * CoarsenFactor - 1) / (ntx * CoarsenFactor));
+  CHECK_LE(feat_len, static_cast<int64_t>(nby) * ntx * CoarsenFactor)
+    << "Feature too wide for GE-SpMM.";
   const dim3 nblks(nbx, nby);
   const dim3 nthrs(ntx, nty);
-  const int sh_mem_size = 0;
-
-  CUDA_KERNEL_CALL((GESpMMKernel<Idx, DType, BinaryOp>),
-      nblks, nthrs, sh_mem_size, thr_entry->stream,
-      ufeat_data, efeat_data, out_data,
-      indptr, indices,
-      csr.num_rows, csr.num_cols,
-      feat_len);
+
+  if (IsNullArray(csr.data)) {
+    CUDA_KERNEL_CALL((GESpMMKernel<Idx, DType, BinaryOp, ReduceOp, CoarsenFactor, false>),
+        nblks, nthrs, 0, thr_entry->stream,
+        ufeat_data, efeat_data, out_data, argu_data, arge_data,
+        indptr, indices, edge_map,
+        csr.num_rows,
+        bcast.lhs_len, bcast.rhs_len, feat_len);
+  } else {
+    CUDA_KERNEL_CALL((GESpMMKernel<Idx, DType, BinaryOp, ReduceOp, CoarsenFactor, true>),
+        nblks, nthrs, 0, thr_entry->stream,
+        ufeat_data, efeat_data, out_data, argu_data, arge_data,
+        indptr, indices, edge_map,
+        csr.num_rows,
+        bcast.lhs_len, bcast.rhs_len, feat_len);
+  }
+}
+
+/*!
+ * \brief CUDA implementation of GE-SpMM on Csr format.
+ *
+ * The number of features per lane is chosen at compile time from the feature
+ * width: 1, 2, 4 and 8 for up to 32, 64, 128 and more features. The
+ * arguments are the same as SpMMCsr; see GESpMMApplicable for the supported
+ * shapes.
+ */
+template <typename Idx, typename DType,
+          typename BinaryOp, typename ReduceOp>
+void GESpMMCsr(
+    const BcastOff& bcast,
+    const CSRMatrix& csr,
+    NDArray ufeat, NDArray efeat,
+    NDArray out, NDArray argu, NDArray arge) {
+  CHECK(GESpMMApplicable(bcast));
+  const int64_t feat_len = bcast.out_len;
+  if (feat_len <= 32) {
+    _GESpMMCsr<Idx, DType, BinaryOp, ReduceOp, 1>(bcast, csr, ufeat, efeat, out, argu, arge);
+  } else if (feat_len <= 64) {
+    _GESpMMCsr<Idx, DType, BinaryOp, ReduceOp, 2>(bcast, csr, ufeat, efeat, out, argu, arge);
+  } else if (feat_len <= 128) {
+    _GESpMMCsr<Idx, DType, BinaryOp, ReduceOp, 4>(bcast, csr, ufeat, efeat, out, argu, arge);
+  } else {
+    _GESpMMCsr<Idx, DType, BinaryOp, ReduceOp, 8>(bcast, csr, ufeat, efeat, out, argu, arge);
+  }
 }
 
 }  // namespace cuda
@@ -10,8 +10,8 @@
 
 
 /* Macro used for switching between broadcasting and non-broadcasting kernels.
- * It also copies the auxiliary information for calculating broadcasting offsets
- * to GPU.
+ * It also gets the auxiliary information for calculating broadcasting offsets
+ * on GPU, which is cached on the device (see cuda::BcastOffsetOnDevice).
  */
 #define BCAST_IDX_CTX_SWITCH(BCAST, EDGE_MAP, CTX, LHS_OFF, RHS_OFF, ...) do { \
   const BcastOff &info = (BCAST);                                              \
@@ -26,16 +26,8 @@
     }                                                                          \
   } else {                                                                     \
     constexpr bool UseBcast = true;                                            \
-    const DLContext ctx = (CTX);                                               \
-    const auto device = runtime::DeviceAPI::Get(ctx);                          \
-    (LHS_OFF) = static_cast<int64_t*>(                                         \
-      device->AllocWorkspace(ctx, sizeof(int64_t) * info.lhs_offset.size()));  \
-    CUDA_CALL(cudaMemcpy((LHS_OFF), &info.lhs_offset[0],                       \
-      sizeof(int64_t) * info.lhs_offset.size(), cudaMemcpyHostToDevice));      \
-    (RHS_OFF) = static_cast<int64_t*>(                                         \
-      device->AllocWorkspace(ctx, sizeof(int64_t) * info.rhs_offset.size()));  \
-    CUDA_CALL(cudaMemcpy((RHS_OFF), &info.rhs_offset[0],                       \
-      sizeof(int64_t) * info.rhs_offset.size(), cudaMemcpyHostToDevice));      \
+    (LHS_OFF) = ::dgl::cuda::BcastOffsetOnDevice((CTX), info.lhs_offset);      \
+    (RHS_OFF) = ::dgl::cuda::BcastOffsetOnDevice((CTX), info.rhs_offset);      \
     if ((EDGE_MAP)) {                                                          \
       constexpr bool UseIdx = true;                                            \
       { __VA_ARGS__ }                                                          \
@@ -43,8 +35,6 @@
       constexpr bool UseIdx = false;                                           \
       { __VA_ARGS__ }                                                          \
     }                                                                          \
-    device->FreeWorkspace(ctx, (LHS_OFF));                                     \
-    device->FreeWorkspace(ctx, (RHS_OFF));                                     \
   }                                                                            \
 } while (0)                                                 
 
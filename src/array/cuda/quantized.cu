@@ -0,0 +1,111 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file array/cuda/quantized.cu
+ * \brief Quantized feature tables on GPU
+ */
+#include <dgl/array.h>
+#include <cuda_fp16.h>
+#include "../../runtime/cuda/cuda_common.h"
+#include "../array_op.h"
+#include "./utils.h"
+
+namespace dgl {
+using runtime::NDArray;
+namespace aten {
+namespace impl {
+
+namespace {
+
+/*! \brief The float32 value of the row r and column c of a table. */
+template <int bits>
+struct Dequantizer;
+
+template <>
+struct Dequantizer<8> {
+  const int8_t* data;
+  const float* scale;
+  const float* zero_point;
+  bool per_row;
+
+  __device__ __forceinline__ float operator()(int64_t r, int64_t c, int64_t row_len) const {
+    const int64_t k = per_row ? r : c;
+    return scale[k] * (data[r * row_len + c] - zero_point[k]);
+  }
+};
+
+template <>
+struct Dequantizer<16> {
+  const uint16_t* data;
+
+  __device__ __forceinline__ float operator()(int64_t r, int64_t c, int64_t row_len) const {
+    return __half2float(__ushort_as_half(data[r * row_len + c]));
+  }
+};
+
+template <int bits>
+Dequantizer<bits> MakeDequantizer(const QuantizedArray& array);
+
+template <>
+Dequantizer<8> MakeDequantizer<8>(const QuantizedArray& array) {
+  return {array.data.Ptr<int8_t>(), array.scale.Ptr<float>(),
+          array.zero_point.Ptr<float>(), array.per_row};
+}
+
+template <>
+Dequantizer<16> MakeDequantizer<16>(const QuantizedArray& array) {
+  return {array.data.Ptr<uint16_t>()};
+}
+
+/*
+ * The rows y of the block are read by the threads x, so that a row is read
+ * with as few requests as possible when it lies in pinned memory.
+ */
+template <int bits, typename IdType>
+__global__ void IndexSelectDequantizeKernel(
+    const Dequantizer<bits> deq, const int64_t row_len, const IdType* const index,
+    const int64_t length, const int64_t arr_len, float* const out) {
+  int64_t out_row = blockIdx.x * blockDim.y + threadIdx.y;
+  const int64_t stride = blockDim.y * gridDim.x;
+  while (out_row < length) {
+    const int64_t in_row = index[out_row];
+    assert(in_row >= 0 && in_row < arr_len);
+    for (int64_t col = threadIdx.x; col < row_len; col += blockDim.x)
+      out[out_row * row_len + col] = deq(in_row, col, row_len);
+    out_row += stride;
+  }
+}
+
+}  // namespace
+
+template <DLDeviceType XPU, int bits, typename IdType>
+NDArray IndexSelectDequantize(const QuantizedArray& array, IdArray index) {
+  auto* thr_entry = runtime::CUDAThreadEntry::ThreadLocal();
+  const int64_t arr_len = array.data->shape[0];
+  const int64_t row_len = QuantizedRowLength(array);
+  const int64_t len = index->shape[0];
+  std::vector<int64_t> shape(array.data->shape, array.data->shape + array.data->ndim);
+  shape[0] = len;
+  NDArray ret = NDArray::Empty(shape, DLDataType{kDLFloat, 32, 1}, index->ctx);
+  if (len == 0 || row_len == 0)
+    return ret;
+
+  dim3 block(256, 1);
+  while (static_cast<int64_t>(block.x) >= 2 * row_len) {
+    block.x /= 2;
+    block.y *= 2;
+  }
+  const dim3 grid((len + block.y - 1) / block.y);
+  CUDA_KERNEL_CALL((IndexSelectDequantizeKernel<bits, IdType>), grid, block, 0,
+      thr_entry->stream, MakeDequantizer<bits>(array), row_len, index.Ptr<IdType>(),
+      len, arr_len, ret.Ptr<float>());
+  return ret;
+}
+
+template NDArray IndexSelectDequantize<kDLGPU, 8, int32_t>(const QuantizedArray&, IdArray);
+template NDArray IndexSelectDequantize<kDLGPU, 8, int64_t>(const QuantizedArray&, IdArray);
+template NDArray IndexSelectDequantize<kDLGPU, 16, int32_t>(const QuantizedArray&, IdArray);
+template NDArray IndexSelectDequantize<kDLGPU, 16, int64_t>(const QuantizedArray&, IdArray);
+
+}  // namespace impl
+}  // namespace aten
+}  // namespace dgl
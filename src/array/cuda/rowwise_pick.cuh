@@ -0,0 +1,314 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file array/cuda/rowwise_pick.cuh
+ * \brief Template implementation for rowwise pick operators on GPU.
+ */
+#ifndef DGL_ARRAY_CUDA_ROWWISE_PICK_CUH_
+#define DGL_ARRAY_CUDA_ROWWISE_PICK_CUH_
+
+#include <dgl/array.h>
+#include <dgl/random.h>
+#include <dgl/runtime/device_api.h>
+#include <curand_kernel.h>
+#include <utility>
+
+#include "./dgl_cub.cuh"
+#include "../../runtime/cuda/cuda_common.h"
+
+namespace dgl {
+namespace aten {
+namespace impl {
+namespace rowwise {
+
+constexpr int kWarpSize = 32;
+/*! \brief The number of rows, one per warp, a thread block runs in parallel. */
+constexpr int kBlockWarps = 128 / kWarpSize;
+/*! \brief The number of rows covered by a thread block. */
+constexpr int kTileSize = kBlockWarps * 16;
+
+/**
+* @brief Compute the number of picked entries of every row, and the number of
+* entries of the temporaries used to pick them.
+*
+* Without replacement, the rows having at most `num_picks` entries are copied
+* and need no temporaries, the other ones need one per entry. With replacement,
+* the non-empty rows pick `num_picks` entries and need one temporary per entry.
+*
+* @tparam IdType The type of node and edge indexes.
+* @param num_picks The number of non-zero entries to pick per row.
+* @param replace Whether the entries are picked with replacement.
+* @param num_rows The number of rows to pick.
+* @param in_rows The set of rows to pick.
+* @param in_ptr The index where each row's edges start.
+* @param out_deg The number of picked entries of each row (output).
+* @param temp_deg The number of temporaries of each row (output).
+*/
+template<typename IdType>
+__global__ void _CSRRowWisePickSizeKernel(
+    const int64_t num_picks,
+    const bool replace,
+    const int64_t num_rows,
+    const IdType * const in_rows,
+    const IdType * const in_ptr,
+    IdType * const out_deg,
+    IdType * const temp_deg) {
+  const int64_t tIdx = threadIdx.x + static_cast<int64_t>(blockIdx.x)*blockDim.x;
+
+  if (tIdx < num_rows) {
+    const IdType in_row = in_rows[tIdx];
+    const IdType deg = in_ptr[in_row+1]-in_ptr[in_row];
+    if (replace) {
+      out_deg[tIdx] = deg == 0 ? 0 : static_cast<IdType>(num_picks);
+      temp_deg[tIdx] = deg;
+    } else {
+      out_deg[tIdx] = min(static_cast<IdType>(num_picks), deg);
+      temp_deg[tIdx] = deg > num_picks ? deg : 0;
+    }
+
+    if (tIdx == num_rows-1) {
+      // make the prefixsum work
+      out_deg[num_rows] = 0;
+      temp_deg[num_rows] = 0;
+    }
+  }
+}
+
+/**
+* @brief Fill the sort keys of the entries of the rows having temporaries, and
+* their position in the row as the values.
+*
+* @tparam IdType The ID type used for matrices.
+* @tparam KeyFn The functor computing the key of an entry from its data index
+* and a random state, only initialized when `KeyFn::kRandom` is true.
+*/
+template<typename IdType, typename KeyType, typename KeyFn>
+__global__ void _CSRRowWiseSortKeyKernel(
+    const uint64_t rand_seed,
+    const int64_t num_rows,
+    const IdType * const in_rows,
+    const IdType * const in_ptr,
+    const IdType * const data,
+    const IdType * const temp_ptr,
+    const KeyFn key_fn,
+    KeyType * const keys,
+    IdType * const values) {
+  // we assign one warp per row
+  assert(blockDim.x == kWarpSize);
+
+  int64_t out_row = blockIdx.x*kTileSize+threadIdx.y;
+  const int64_t last_row = min(static_cast<int64_t>(blockIdx.x+1)*kTileSize, num_rows);
+
+  curandState rng;
+  if (KeyFn::kRandom)
+    curand_init(rand_seed*gridDim.x+blockIdx.x, threadIdx.y*kWarpSize+threadIdx.x, 0, &rng);
+
+  while (out_row < last_row) {
+    const int64_t in_row_start = in_ptr[in_rows[out_row]];
+    const int64_t temp_start = temp_ptr[out_row];
+    const int64_t len = temp_ptr[out_row+1] - temp_start;
+    for (int64_t idx = threadIdx.x; idx < len; idx += kWarpSize) {
+      const IdType in_idx = in_row_start+idx;
+      keys[temp_start+idx] = key_fn(data ? data[in_idx] : in_idx, &rng);
+      values[temp_start+idx] = idx;
+    }
+    out_row += kBlockWarps;
+  }
+}
+
+/**
+* @brief Write the picked entries of every row: all the entries of the rows
+* without temporaries, the first `num_picks` of the sorted positions otherwise.
+*/
+template<typename IdType>
+__global__ void _CSRRowWiseSortedPickKernel(
+    const int64_t num_picks,
+    const int64_t num_rows,
+    const IdType * const in_rows,
+    const IdType * const in_ptr,
+    const IdType * const in_index,
+    const IdType * const data,
+    const IdType * const temp_ptr,
+    const IdType * const sorted_values,
+    const IdType * const out_ptr,
+    IdType * const out_rows,
+    IdType * const out_cols,
+    IdType * const out_idxs) {
+  // we assign one warp per row
+  assert(blockDim.x == kWarpSize);
+
+  int64_t out_row = blockIdx.x*kTileSize+threadIdx.y;
+  const int64_t last_row = min(static_cast<int64_t>(blockIdx.x+1)*kTileSize, num_rows);
+
+  while (out_row < last_row) {
+    const int64_t row = in_rows[out_row];
+    const int64_t in_row_start = in_ptr[row];
+    const int64_t out_row_start = out_ptr[out_row];
+    const int64_t out_len = out_ptr[out_row+1] - out_row_start;
+    const int64_t temp_start = temp_ptr[out_row];
+    const bool copy_row = temp_ptr[out_row+1] == temp_start;
+    for (int64_t idx = threadIdx.x; idx < out_len; idx += kWarpSize) {
+      const IdType in_idx = in_row_start + (copy_row ? idx : sorted_values[temp_start+idx]);
+      out_rows[out_row_start+idx] = row;
+      out_cols[out_row_start+idx] = in_index[in_idx];
+      out_idxs[out_row_start+idx] = data ? data[in_idx] : in_idx;
+    }
+    out_row += kBlockWarps;
+  }
+}
+
+/**
+* @brief Compute the offsets of the picked entries and of the temporaries of
+* every row, see _CSRRowWisePickSizeKernel.
+*
+* @return The total numbers of picked entries and of temporaries. The offset
+* arrays are allocated in the workspace of the device and must be freed by the
+* caller.
+*/
+template<typename IdType>
+std::pair<int64_t, int64_t> CSRRowWisePickOffsets(
+    CSRMatrix mat, IdArray rows, int64_t num_picks, bool replace,
+    IdType ** out_ptr, IdType ** temp_ptr) {
+  const auto& ctx = mat.indptr->ctx;
+  auto device = runtime::DeviceAPI::Get(ctx);
+  cudaStream_t stream = runtime::CUDAThreadEntry::ThreadLocal()->stream;
+  const int64_t num_rows = rows->shape[0];
+
+  IdType * out_deg = static_cast<IdType*>(
+      device->AllocWorkspace(ctx, (num_rows+1)*sizeof(IdType)));
+  IdType * temp_deg = static_cast<IdType*>(
+      device->AllocWorkspace(ctx, (num_rows+1)*sizeof(IdType)));
+  {
+    const dim3 block(512);
+    const dim3 grid((num_rows+block.x-1)/block.x);
+    CUDA_KERNEL_CALL(_CSRRowWisePickSizeKernel<IdType>, grid, block, 0, stream,
+        num_picks, replace, num_rows, rows.Ptr<IdType>(), mat.indptr.Ptr<IdType>(),
+        out_deg, temp_deg);
+  }
+
+  *out_ptr = static_cast<IdType*>(
+      device->AllocWorkspace(ctx, (num_rows+1)*sizeof(IdType)));
+  *temp_ptr = static_cast<IdType*>(
+      device->AllocWorkspace(ctx, (num_rows+1)*sizeof(IdType)));
+  size_t prefix_temp_size = 0;
+  CUDA_CALL(cub::DeviceScan::ExclusiveSum(nullptr, prefix_temp_size,
+      out_deg, *out_ptr, num_rows+1, stream));
+  void * prefix_temp = device->AllocWorkspace(ctx, prefix_temp_size);
+  CUDA_CALL(cub::DeviceScan::ExclusiveSum(prefix_temp, prefix_temp_size,
+      out_deg, *out_ptr, num_rows+1, stream));
+  CUDA_CALL(cub::DeviceScan::ExclusiveSum(prefix_temp, prefix_temp_size,
+      temp_deg, *temp_ptr, num_rows+1, stream));
+  device->FreeWorkspace(ctx, prefix_temp);
+  device->FreeWorkspace(ctx, temp_deg);
+  device->FreeWorkspace(ctx, out_deg);
+
+  // the sizes of the outputs and temporaries are needed to allocate them
+  IdType new_len, temp_len;
+  device->CopyDataFromTo(*out_ptr, num_rows*sizeof(new_len), &new_len, 0,
+      sizeof(new_len), ctx, DGLContext{kDLCPU, 0}, mat.indptr->dtype, stream);
+  device->CopyDataFromTo(*temp_ptr, num_rows*sizeof(temp_len), &temp_len, 0,
+      sizeof(temp_len), ctx, DGLContext{kDLCPU, 0}, mat.indptr->dtype, stream);
+  device->StreamSync(ctx, stream);
+  return {new_len, temp_len};
+}
+
+/**
+* @brief Pick the entries of every row having the first `num_picks` keys in
+* ascending (or descending) order, without replacement.
+*
+* The rows having at most `num_picks` entries are copied. The keys of the other
+* rows are sorted within every row by a segmented radix sort, which is stable so
+* the ties are broken by the position of the entries.
+*
+* @tparam KeyFn The functor computing the key of an entry, see
+* _CSRRowWiseSortKeyKernel.
+*/
+template<typename IdType, typename KeyType, typename KeyFn>
+COOMatrix CSRRowWiseSortPick(
+    CSRMatrix mat, IdArray rows, int64_t num_picks, bool descending, const KeyFn& key_fn) {
+  const auto& ctx = mat.indptr->ctx;
+  auto device = runtime::DeviceAPI::Get(ctx);
+  cudaStream_t stream = runtime::CUDAThreadEntry::ThreadLocal()->stream;
+
+  const int64_t num_rows = rows->shape[0];
+  const IdType * const slice_rows = rows.Ptr<IdType>();
+  const IdType * const in_ptr = mat.indptr.Ptr<IdType>();
+  const IdType * const in_cols = mat.indices.Ptr<IdType>();
+  const IdType * const data = CSRHasData(mat) ? mat.data.Ptr<IdType>() : nullptr;
+
+  if (num_rows == 0) {
+    return COOMatrix(mat.num_rows, mat.num_cols,
+        NewIdArray(0, ctx, sizeof(IdType) * 8), NewIdArray(0, ctx, sizeof(IdType) * 8),
+        NewIdArray(0, ctx, sizeof(IdType) * 8));
+  }
+
+  IdType * out_ptr, * temp_ptr;
+  const auto lens = CSRRowWisePickOffsets<IdType>(
+      mat, rows, num_picks, false, &out_ptr, &temp_ptr);
+  const int64_t new_len = lens.first, temp_len = lens.second;
+
+  IdArray picked_row = NewIdArray(new_len, ctx, sizeof(IdType) * 8);
+  IdArray picked_col = NewIdArray(new_len, ctx, sizeof(IdType) * 8);
+  IdArray picked_idx = NewIdArray(new_len, ctx, sizeof(IdType) * 8);
+
+  const dim3 block(kWarpSize, kBlockWarps);
+  const dim3 grid((num_rows+kTileSize-1)/kTileSize);
+
+  IdType * sorted_values = nullptr;
+  if (temp_len > 0) {
+    KeyType * keys = static_cast<KeyType*>(
+        device->AllocWorkspace(ctx, temp_len*sizeof(KeyType)));
+    KeyType * sorted_keys = static_cast<KeyType*>(
+        device->AllocWorkspace(ctx, temp_len*sizeof(KeyType)));
+    IdType * values = static_cast<IdType*>(
+        device->AllocWorkspace(ctx, temp_len*sizeof(IdType)));
+    sorted_values = static_cast<IdType*>(
+        device->AllocWorkspace(ctx, temp_len*sizeof(IdType)));
+
+    const uint64_t random_seed = RandomEngine::ThreadLocal()->RandInt(1000000000);
+    CUDA_KERNEL_CALL((_CSRRowWiseSortKeyKernel<IdType, KeyType, KeyFn>), grid, block, 0, stream,
+        random_seed, num_rows, slice_rows, in_ptr, data, temp_ptr, key_fn, keys, values);
+
+    size_t sort_temp_size = 0;
+    if (descending) {
+      CUDA_CALL(cub::DeviceSegmentedRadixSort::SortPairsDescending(nullptr, sort_temp_size,
+          keys, sorted_keys, values, sorted_values, temp_len, num_rows,
+          temp_ptr, temp_ptr + 1, 0, sizeof(KeyType) * 8, stream));
+    } else {
+      CUDA_CALL(cub::DeviceSegmentedRadixSort::SortPairs(nullptr, sort_temp_size,
+          keys, sorted_keys, values, sorted_values, temp_len, num_rows,
+          temp_ptr, temp_ptr + 1, 0, sizeof(KeyType) * 8, stream));
+    }
+    void * sort_temp = device->AllocWorkspace(ctx, sort_temp_size);
+    if (descending) {
+      CUDA_CALL(cub::DeviceSegmentedRadixSort::SortPairsDescending(sort_temp, sort_temp_size,
+          keys, sorted_keys, values, sorted_values, temp_len, num_rows,
+          temp_ptr, temp_ptr + 1, 0, sizeof(KeyType) * 8, stream));
+    } else {
+      CUDA_CALL(cub::DeviceSegmentedRadixSort::SortPairs(sort_temp, sort_temp_size,
+          keys, sorted_keys, values, sorted_values, temp_len, num_rows,
+          temp_ptr, temp_ptr + 1, 0, sizeof(KeyType) * 8, stream));
+    }
+    device->FreeWorkspace(ctx, sort_temp);
+    device->FreeWorkspace(ctx, values);
+    device->FreeWorkspace(ctx, sorted_keys);
+    device->FreeWorkspace(ctx, keys);
+  }
+
+  CUDA_KERNEL_CALL(_CSRRowWiseSortedPickKernel<IdType>, grid, block, 0, stream,
+      num_picks, num_rows, slice_rows, in_ptr, in_cols, data, temp_ptr, sorted_values,
+      out_ptr, picked_row.Ptr<IdType>(), picked_col.Ptr<IdType>(), picked_idx.Ptr<IdType>());
+
+  if (sorted_values)
+    device->FreeWorkspace(ctx, sorted_values);
+  device->FreeWorkspace(ctx, temp_ptr);
+  device->FreeWorkspace(ctx, out_ptr);
+
+  return COOMatrix(mat.num_rows, mat.num_cols, picked_row, picked_col, picked_idx);
+}
+
+}  // namespace rowwise
+}  // namespace impl
+}  // namespace aten
+}  // namespace dgl
+
+#endif  // DGL_ARRAY_CUDA_ROWWISE_PICK_CUH_
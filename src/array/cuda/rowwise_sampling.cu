@@ -7,9 +7,12 @@
 #include <dgl/random.h>
 #include <dgl/runtime/device_api.h>
 #include <curand_kernel.h>
+#include <algorithm>
+#include <limits>
 #include <numeric>
 
 #include "./dgl_cub.cuh"
+#include "../array_op.h"
 #include "../../array/cuda/atomic.cuh"
 #include "../../runtime/cuda/cuda_common.h"
 
@@ -23,74 +26,63 @@ namespace {
 
 constexpr int WARP_SIZE = 32;
 
+/*!
+ * \brief Rows with at least this many times as many entries as picked ones
+ *        are sampled without replacement by a whole thread block with
+ *        _CSRRowWiseSampleHubKernel, instead of a warp scanning the row.
+ */
+constexpr int64_t kHubDegreeFactor = 8;
+/*! \brief The largest number of picks the hub kernel supports. */
+constexpr int64_t kHubMaxPicks = 1024;
+/*! \brief The number of threads of the hub kernel blocks. */
+constexpr int kHubBlockSize = 128;
+/*! \brief The largest number of blocks the hub kernel is launched with. */
+constexpr int kHubMaxBlocks = 1024;
+/*! \brief The number of rows each thread block of the mask kernels handles. */
+constexpr int kMaskBlockWarps = 4;
+
 /**
-* @brief Compute the size of each row in the sampled CSR, without replacement.
+* @brief Compute the size of each row in the sampled CSR, fused in the prefix
+* sum of the sizes computing the offsets of the rows.
 *
 * @tparam IdType The type of node and edge indexes.
-* @param num_picks The number of non-zero entries to pick per row.
-* @param num_rows The number of rows to pick.
-* @param in_rows The set of rows to pick.
-* @param in_ptr The index where each row's edges start.
-* @param out_deg The size of each row in the sampled matrix, as indexed by
-* `in_rows` (output).
 */
 template<typename IdType>
-__global__ void _CSRRowWiseSampleDegreeKernel(
-    const int64_t num_picks,
-    const int64_t num_rows,
-    const IdType * const in_rows,
-    const IdType * const in_ptr,
-    IdType * const out_deg) {
-  const int tIdx = threadIdx.x + blockIdx.x*blockDim.x;
-
-  if (tIdx < num_rows) {
-    const int in_row = in_rows[tIdx];
-    const int out_row = tIdx;
-    out_deg[out_row] = min(static_cast<IdType>(num_picks), in_ptr[in_row+1]-in_ptr[in_row]);
-
-    if (out_row == num_rows-1) {
-      // make the prefixsum work
-      out_deg[num_rows] = 0;
-    }
+struct PickedDegree {
+  int64_t num_picks;
+  int64_t num_rows;
+  bool replace;
+  const IdType * in_rows;
+  const IdType * in_ptr;
+
+  __host__ __device__ IdType operator()(const int64_t out_row) const {
+    // the extra row makes the prefix sum end with the total
+    if (out_row >= num_rows)
+      return 0;
+    const IdType in_row = in_rows[out_row];
+    const IdType deg = in_ptr[in_row+1]-in_ptr[in_row];
+    if (replace)
+      return deg == 0 ? 0 : static_cast<IdType>(num_picks);
+    return deg < num_picks ? deg : static_cast<IdType>(num_picks);
   }
-}
+};
 
 /**
-* @brief Compute the size of each row in the sampled CSR, with replacement.
+* @brief Select the rows sampled by _CSRRowWiseSampleHubKernel.
 *
 * @tparam IdType The type of node and edge indexes.
-* @param num_picks The number of non-zero entries to pick per row.
-* @param num_rows The number of rows to pick.
-* @param in_rows The set of rows to pick.
-* @param in_ptr The index where each row's edges start.
-* @param out_deg The size of each row in the sampled matrix, as indexed by
-* `in_rows` (output).
 */
 template<typename IdType>
-__global__ void _CSRRowWiseSampleDegreeReplaceKernel(
-    const int64_t num_picks,
-    const int64_t num_rows,
-    const IdType * const in_rows,
-    const IdType * const in_ptr,
-    IdType * const out_deg) {
-  const int tIdx = threadIdx.x + blockIdx.x*blockDim.x;
-
-  if (tIdx < num_rows) {
-    const int64_t in_row = in_rows[tIdx];
-    const int64_t out_row = tIdx;
-
-    if (in_ptr[in_row+1]-in_ptr[in_row] == 0) {
-      out_deg[out_row] = 0;
-    } else {
-      out_deg[out_row] = static_cast<IdType>(num_picks);
-    }
-
-    if (out_row == num_rows-1) {
-      // make the prefixsum work
-      out_deg[num_rows] = 0;
-    }
+struct IsHubRow {
+  int64_t hub_degree;
+  const IdType * in_rows;
+  const IdType * in_ptr;
+
+  __device__ bool operator()(const IdType out_row) const {
+    const IdType in_row = in_rows[out_row];
+    return in_ptr[in_row+1]-in_ptr[in_row] >= hub_degree;
   }
-}
+};
 
 /**
 * @brief Perform row-wise sampling on a CSR matrix, and generate a COO matrix,
@@ -102,6 +94,8 @@ __global__ void _CSRRowWiseSampleDegreeReplaceKernel(
 * @param rand_seed The random seed to use.
 * @param num_picks The number of non-zeros to pick per row.
 * @param num_rows The number of rows to pick.
+* @param hub_degree The degree from which the rows are left to
+* _CSRRowWiseSampleHubKernel.
 * @param in_rows The set of rows to pick.
 * @param in_ptr The indptr array of the input CSR.
 * @param in_index The indices array of the input CSR.
@@ -116,6 +110,7 @@ __global__ void _CSRRowWiseSampleKernel(
     const uint64_t rand_seed,
     const int64_t num_picks,
     const int64_t num_rows,
+    const int64_t hub_degree,
     const IdType * const in_rows,
     const IdType * const in_ptr,
     const IdType * const in_index,
@@ -142,7 +137,9 @@ __global__ void _CSRRowWiseSampleKernel(
 
     const int64_t out_row_start = out_ptr[out_row];
 
-    if (deg <= num_picks) {
+    if (deg >= hub_degree) {
+      // sampled by _CSRRowWiseSampleHubKernel
+    } else if (deg <= num_picks) {
       // just copy row
       for (int idx = threadIdx.x; idx < deg; idx += WARP_SIZE) {
         const IdType in_idx = in_row_start+idx;
@@ -182,6 +179,102 @@ __global__ void _CSRRowWiseSampleKernel(
   }
 }
 
+/**
+* @brief Perform row-wise sampling on the rows with many more entries than
+* picked ones, and generate a COO matrix, without replacement.
+*
+* Every thread block samples a row at a time. Its threads draw entries
+* uniformly at random and insert them into a hash set in shared memory, the
+* first `num_picks` distinct ones being kept, which is a uniform sample of the
+* row. Since the row has at least kHubDegreeFactor times as many entries as
+* picked ones, few draws are duplicates and the cost does not depend on the
+* degree.
+*
+* @tparam IdType The ID type used for matrices.
+* @tparam BLOCK_SIZE The number of threads of a block.
+* @param rand_seed The random seed to use.
+* @param num_picks The number of non-zeros to pick per row.
+* @param table_size The size of the hash set, a power of two larger than twice
+* the number of entries inserted into it, i.e. `num_picks+BLOCK_SIZE`.
+* @param num_hubs The number of rows to sample, on the device.
+* @param hub_rows The indexes in `in_rows` of the rows to sample.
+* @param in_rows The set of rows to pick.
+* @param in_ptr The indptr array of the input CSR.
+* @param in_index The indices array of the input CSR.
+* @param data The data array of the input CSR.
+* @param out_ptr The offset to write each row to in the output COO.
+* @param out_rows The rows of the output COO (output).
+* @param out_cols The columns of the output COO (output).
+* @param out_idxs The data array of the output COO (output).
+*/
+template<typename IdType, int BLOCK_SIZE>
+__global__ void _CSRRowWiseSampleHubKernel(
+    const uint64_t rand_seed,
+    const int64_t num_picks,
+    const int64_t table_size,
+    const int64_t * const num_hubs,
+    const IdType * const hub_rows,
+    const IdType * const in_rows,
+    const IdType * const in_ptr,
+    const IdType * const in_index,
+    const IdType * const data,
+    const IdType * const out_ptr,
+    IdType * const out_rows,
+    IdType * const out_cols,
+    IdType * const out_idxs) {
+  assert(blockDim.x == BLOCK_SIZE);
+  extern __shared__ __align__(8) unsigned char hub_shared[];
+  IdType * const table = reinterpret_cast<IdType*>(hub_shared);
+  __shared__ int num_picked;
+
+  curandState rng;
+  curand_init(rand_seed*gridDim.x+blockIdx.x, threadIdx.x, 0, &rng);
+
+  for (int64_t hub = blockIdx.x; hub < *num_hubs; hub += gridDim.x) {
+    const int64_t out_row = hub_rows[hub];
+    const int64_t row = in_rows[out_row];
+    const int64_t in_row_start = in_ptr[row];
+    const int64_t deg = in_ptr[row+1] - in_row_start;
+    const int64_t out_row_start = out_ptr[out_row];
+
+    for (int64_t idx = threadIdx.x; idx < table_size; idx += BLOCK_SIZE) {
+      table[idx] = -1;
+    }
+    if (threadIdx.x == 0) {
+      num_picked = 0;
+    }
+    __syncthreads();
+
+    while (true) {
+      // every thread must read the count before any of them updates it
+      const bool done = num_picked >= num_picks;
+      __syncthreads();
+      if (done)
+        break;
+      const IdType edge = curand(&rng) % deg;
+      int64_t slot = edge & (table_size-1);
+      while (true) {
+        const IdType prev = AtomicCAS(table+slot, static_cast<IdType>(-1), edge);
+        if (prev == -1) {
+          // first draw of the entry
+          const int pos = atomicAdd(&num_picked, 1);
+          if (pos < num_picks) {
+            const IdType in_idx = in_row_start+edge;
+            out_rows[out_row_start+pos] = row;
+            out_cols[out_row_start+pos] = in_index[in_idx];
+            out_idxs[out_row_start+pos] = data ? data[in_idx] : in_idx;
+          }
+          break;
+        } else if (prev == edge) {
+          break;
+        }
+        slot = (slot+1) & (table_size-1);
+      }
+      __syncthreads();
+    }
+  }
+}
+
 /**
 * @brief Perform row-wise sampling on a CSR matrix, and generate a COO matrix,
 * with replacement.
@@ -245,6 +338,92 @@ __global__ void _CSRRowWiseSampleReplaceKernel(
   }
 }
 
+/*!
+* @brief Count the entries of each row left by a mask, with a warp per row.
+*
+* @tparam IdType The type of node and edge indexes.
+* @param num_rows The number of rows to count.
+* @param in_rows The set of rows to count.
+* @param in_ptr The indptr array of the input CSR.
+* @param data The data array of the input CSR.
+* @param mask The mask over the data indices of the entries.
+* @param out_deg The number of entries left of each row (output).
+*/
+template<typename IdType>
+__global__ void _CSRRowWiseMaskedDegreeKernel(
+    const int64_t num_rows,
+    const IdType * const in_rows,
+    const IdType * const in_ptr,
+    const IdType * const data,
+    const uint8_t * const mask,
+    IdType * const out_deg) {
+  assert(blockDim.x == WARP_SIZE);
+  const int64_t out_row = static_cast<int64_t>(blockIdx.x)*blockDim.y+threadIdx.y;
+  if (out_row >= num_rows)
+    return;
+  const int64_t row = in_rows[out_row];
+  const int64_t in_row_start = in_ptr[row];
+  const int64_t in_row_end = in_ptr[row+1];
+  IdType count = 0;
+  for (int64_t idx = in_row_start+threadIdx.x; idx < in_row_end; idx += WARP_SIZE)
+    count += mask[data ? data[idx] : idx] != 0;
+  for (int offset = WARP_SIZE/2; offset > 0; offset /= 2)
+    count += __shfl_down_sync(0xffffffff, count, offset);
+  if (threadIdx.x == 0)
+    out_deg[out_row] = count;
+}
+
+/*!
+* @brief Gather the entries of each row left by a mask, in their order, with
+* a warp per row.
+*
+* @tparam IdType The type of node and edge indexes.
+* @param num_rows The number of rows to gather.
+* @param in_rows The set of rows to gather.
+* @param in_ptr The indptr array of the input CSR.
+* @param in_index The indices array of the input CSR.
+* @param data The data array of the input CSR.
+* @param mask The mask over the data indices of the entries.
+* @param out_ptr The indptr array of the gathered CSR.
+* @param out_index The indices array of the gathered CSR (output).
+* @param out_data The data array of the gathered CSR (output).
+*/
+template<typename IdType>
+__global__ void _CSRRowWiseMaskedGatherKernel(
+    const int64_t num_rows,
+    const IdType * const in_rows,
+    const IdType * const in_ptr,
+    const IdType * const in_index,
+    const IdType * const data,
+    const uint8_t * const mask,
+    const IdType * const out_ptr,
+    IdType * const out_index,
+    IdType * const out_data) {
+  assert(blockDim.x == WARP_SIZE);
+  const int64_t out_row = static_cast<int64_t>(blockIdx.x)*blockDim.y+threadIdx.y;
+  if (out_row >= num_rows)
+    return;
+  const int64_t row = in_rows[out_row];
+  const int64_t in_row_start = in_ptr[row];
+  const int64_t deg = in_ptr[row+1] - in_row_start;
+  const unsigned lower_lanes = (1u << threadIdx.x) - 1;
+  int64_t out_idx = out_ptr[out_row];
+  // all the lanes go over the chunks of the row for the ballots
+  for (int64_t chunk = 0; chunk < deg; chunk += WARP_SIZE) {
+    const int64_t idx = in_row_start+chunk+threadIdx.x;
+    const bool valid = chunk+threadIdx.x < deg;
+    const IdType eid = valid ? (data ? data[idx] : idx) : 0;
+    const bool keep = valid && mask[eid] != 0;
+    const unsigned ballot = __ballot_sync(0xffffffff, keep);
+    if (keep) {
+      const int64_t pos = out_idx+__popc(ballot & lower_lanes);
+      out_index[pos] = in_index[idx];
+      out_data[pos] = eid;
+    }
+    out_idx += __popc(ballot);
+  }
+}
+
 }  // namespace
 
 /////////////////////////////// CSR ///////////////////////////////
@@ -254,7 +433,8 @@ COOMatrix CSRRowWiseSamplingUniform(CSRMatrix mat,
                                     IdArray rows,
                                     const int64_t num_picks,
                                     const bool replace) {
-  const auto& ctx = mat.indptr->ctx;
+  // the matrix may be pinned in host memory, see CSRRowWiseSamplingUniformPinned
+  const auto& ctx = rows->ctx;
   auto device = runtime::DeviceAPI::Get(ctx);
 
   // TODO(dlasalle): Once the device api supports getting the stream from the
@@ -276,54 +456,55 @@ COOMatrix CSRRowWiseSamplingUniform(CSRMatrix mat,
   const IdType* const data = CSRHasData(mat) ?
       static_cast<IdType*>(mat.data->data) : nullptr;
 
-  // compute degree
-  IdType * out_deg = static_cast<IdType*>(
-      device->AllocWorkspace(ctx, (num_rows+1)*sizeof(IdType)));
-  if (replace) {
-    const dim3 block(512);
-    const dim3 grid((num_rows+block.x-1)/block.x);
-    _CSRRowWiseSampleDegreeReplaceKernel<<<grid, block, 0, stream>>>(
-        num_picks, num_rows, slice_rows, in_ptr, out_deg);
-  } else {
-    const dim3 block(512);
-    const dim3 grid((num_rows+block.x-1)/block.x);
-    _CSRRowWiseSampleDegreeKernel<<<grid, block, 0, stream>>>(
-        num_picks, num_rows, slice_rows, in_ptr, out_deg);
-  }
-
-  // fill out_ptr
+  // fill out_ptr, computing the degrees on the fly
   IdType * out_ptr = static_cast<IdType*>(
       device->AllocWorkspace(ctx, (num_rows+1)*sizeof(IdType)));
-  size_t prefix_temp_size = 0;
-  CUDA_CALL(cub::DeviceScan::ExclusiveSum(nullptr, prefix_temp_size,
-      out_deg,
-      out_ptr,
-      num_rows+1,
-      stream));
-  void * prefix_temp = device->AllocWorkspace(ctx, prefix_temp_size);
-  CUDA_CALL(cub::DeviceScan::ExclusiveSum(prefix_temp, prefix_temp_size,
-      out_deg,
-      out_ptr,
-      num_rows+1,
-      stream));
-  device->FreeWorkspace(ctx, prefix_temp);
-  device->FreeWorkspace(ctx, out_deg);
-
-  cudaEvent_t copyEvent;
-  CUDA_CALL(cudaEventCreate(&copyEvent));
+  {
+    const PickedDegree<IdType> picked_degree{num_picks, num_rows, replace, slice_rows, in_ptr};
+    cub::TransformInputIterator<IdType, PickedDegree<IdType>, cub::CountingInputIterator<int64_t>>
+      out_deg(cub::CountingInputIterator<int64_t>(0), picked_degree);
+    size_t prefix_temp_size = 0;
+    CUDA_CALL(cub::DeviceScan::ExclusiveSum(nullptr, prefix_temp_size,
+        out_deg,
+        out_ptr,
+        num_rows+1,
+        stream));
+    void * prefix_temp = device->AllocWorkspace(ctx, prefix_temp_size);
+    CUDA_CALL(cub::DeviceScan::ExclusiveSum(prefix_temp, prefix_temp_size,
+        out_deg,
+        out_ptr,
+        num_rows+1,
+        stream));
+    device->FreeWorkspace(ctx, prefix_temp);
+  }
 
-  // TODO(dlasalle): use pinned memory to overlap with the actual sampling, and wait on
-  // a cudaevent
-  IdType new_len;
-  device->CopyDataFromTo(out_ptr, num_rows*sizeof(new_len), &new_len, 0,
-        sizeof(new_len),
-        ctx,
-        DGLContext{kDLCPU, 0},
-        mat.indptr->dtype,
-        stream);
-  CUDA_CALL(cudaEventRecord(copyEvent, stream));
+  // Without replacement, the rows with many more entries than picks are left
+  // to the hub kernel. They are selected on the device, so that the kernels are
+  // all queued before the host waits for the size of the output.
+  const bool use_hubs = !replace && num_rows > 0 && num_picks > 0 &&
+    num_picks <= kHubMaxPicks;
+  const int64_t hub_degree = use_hubs ?
+    kHubDegreeFactor * num_picks : std::numeric_limits<int64_t>::max();
+  IdType * hub_rows = nullptr;
+  int64_t * num_hubs = nullptr;
+  if (use_hubs) {
+    hub_rows = static_cast<IdType*>(device->AllocWorkspace(ctx, num_rows*sizeof(IdType)));
+    num_hubs = static_cast<int64_t*>(device->AllocWorkspace(ctx, sizeof(int64_t)));
+    const IsHubRow<IdType> is_hub{hub_degree, slice_rows, in_ptr};
+    cub::CountingInputIterator<IdType> counter(0);
+    size_t select_temp_size = 0;
+    CUDA_CALL(cub::DeviceSelect::If(nullptr, select_temp_size,
+        counter, hub_rows, num_hubs, num_rows, is_hub, stream));
+    void * select_temp = device->AllocWorkspace(ctx, select_temp_size);
+    CUDA_CALL(cub::DeviceSelect::If(select_temp, select_temp_size,
+        counter, hub_rows, num_hubs, num_rows, is_hub, stream));
+    device->FreeWorkspace(ctx, select_temp);
+  }
 
-  const uint64_t random_seed = RandomEngine::ThreadLocal()->RandInt(1000000000);
+  // under a RowStreamScope, the same rows give the same samples, see RowStreamKey
+  const RowStreamKey row_streams = RowStreamScope::Current();
+  const uint64_t random_seed = row_streams.enabled ?
+    row_streams.seed % 1000000000 : RandomEngine::ThreadLocal()->RandInt(1000000000);
 
   // select edges
   if (replace) {
@@ -354,6 +535,7 @@ COOMatrix CSRRowWiseSamplingUniform(CSRMatrix mat,
         random_seed,
         num_picks,
         num_rows,
+        hub_degree,
         slice_rows,
         in_ptr,
         in_cols,
@@ -363,11 +545,42 @@ COOMatrix CSRRowWiseSamplingUniform(CSRMatrix mat,
         out_cols,
         out_idxs);
   }
-  device->FreeWorkspace(ctx, out_ptr);
+  if (use_hubs) {
+    // room for the num_picks+kHubBlockSize entries inserted at most
+    int64_t table_size = 1;
+    while (table_size < 2 * (num_picks + kHubBlockSize))
+      table_size <<= 1;
+    const dim3 block(kHubBlockSize);
+    const dim3 grid(std::min<int64_t>(num_rows, kHubMaxBlocks));
+    _CSRRowWiseSampleHubKernel<IdType, kHubBlockSize>
+      <<<grid, block, table_size*sizeof(IdType), stream>>>(
+        random_seed,
+        num_picks,
+        table_size,
+        num_hubs,
+        hub_rows,
+        slice_rows,
+        in_ptr,
+        in_cols,
+        data,
+        out_ptr,
+        out_rows,
+        out_cols,
+        out_idxs);
+    device->FreeWorkspace(ctx, num_hubs);
+    device->FreeWorkspace(ctx, hub_rows);
+  }
 
-  // wait for copying `new_len` to finish
-  CUDA_CALL(cudaEventSynchronize(copyEvent));
-  CUDA_CALL(cudaEventDestroy(copyEvent));
+  // the copy waits for the sampling kernels queued before it
+  IdType new_len;
+  device->CopyDataFromTo(out_ptr, num_rows*sizeof(new_len), &new_len, 0,
+        sizeof(new_len),
+        ctx,
+        DGLContext{kDLCPU, 0},
+        mat.indptr->dtype,
+        stream);
+  device->StreamSync(ctx, stream);
+  device->FreeWorkspace(ctx, out_ptr);
 
   picked_row = picked_row.CreateView({new_len}, picked_row->dtype);
   picked_col = picked_col.CreateView({new_len}, picked_col->dtype);
@@ -382,6 +595,93 @@ template COOMatrix CSRRowWiseSamplingUniform<kDLGPU, int32_t>(
 template COOMatrix CSRRowWiseSamplingUniform<kDLGPU, int64_t>(
     CSRMatrix, IdArray, int64_t, bool);
 
+template <DLDeviceType XPU, typename IdType, typename FloatType>
+COOMatrix CSRRowWiseSamplingMasked(CSRMatrix mat,
+                                   IdArray rows,
+                                   const int64_t num_picks,
+                                   NDArray mask,
+                                   FloatArray prob,
+                                   const bool replace) {
+  const auto& ctx = mat.indptr->ctx;
+  auto device = runtime::DeviceAPI::Get(ctx);
+  cudaStream_t stream = runtime::CUDAThreadEntry::ThreadLocal()->stream;
+
+  const int64_t num_rows = rows->shape[0];
+  const IdType * const slice_rows = static_cast<const IdType*>(rows->data);
+  const IdType * const in_ptr = static_cast<const IdType*>(mat.indptr->data);
+  const IdType * const in_cols = static_cast<const IdType*>(mat.indices->data);
+  const IdType * const data = CSRHasData(mat) ?
+      static_cast<IdType*>(mat.data->data) : nullptr;
+  const uint8_t * const in_mask = static_cast<const uint8_t*>(mask->data);
+
+  // The entries of the rows left by the mask are gathered into a matrix with
+  // a row per requested row, keeping their data indices, which is sampled
+  // the same way as a matrix without mask.
+  IdArray sub_indptr = NewIdArray(num_rows+1, ctx, sizeof(IdType) * 8);
+  IdType * const sub_ptr = static_cast<IdType*>(sub_indptr->data);
+  const dim3 block(WARP_SIZE, kMaskBlockWarps);
+  const dim3 grid((num_rows+kMaskBlockWarps-1)/kMaskBlockWarps);
+  IdType * const sub_deg = static_cast<IdType*>(
+      device->AllocWorkspace(ctx, (num_rows+1)*sizeof(IdType)));
+  CUDA_CALL(cudaMemsetAsync(sub_deg+num_rows, 0, sizeof(IdType), stream));
+  if (num_rows > 0) {
+    CUDA_KERNEL_CALL(_CSRRowWiseMaskedDegreeKernel<IdType>, grid, block, 0, stream,
+        num_rows, slice_rows, in_ptr, data, in_mask, sub_deg);
+  }
+  size_t prefix_temp_size = 0;
+  CUDA_CALL(cub::DeviceScan::ExclusiveSum(nullptr, prefix_temp_size,
+      sub_deg, sub_ptr, num_rows+1, stream));
+  void * prefix_temp = device->AllocWorkspace(ctx, prefix_temp_size);
+  CUDA_CALL(cub::DeviceScan::ExclusiveSum(prefix_temp, prefix_temp_size,
+      sub_deg, sub_ptr, num_rows+1, stream));
+  device->FreeWorkspace(ctx, prefix_temp);
+  device->FreeWorkspace(ctx, sub_deg);
+
+  IdType sub_nnz;
+  device->CopyDataFromTo(sub_ptr, num_rows*sizeof(sub_nnz), &sub_nnz, 0,
+        sizeof(sub_nnz),
+        ctx,
+        DGLContext{kDLCPU, 0},
+        mat.indptr->dtype,
+        stream);
+  device->StreamSync(ctx, stream);
+
+  IdArray sub_indices = NewIdArray(sub_nnz, ctx, sizeof(IdType) * 8);
+  IdArray sub_data = NewIdArray(sub_nnz, ctx, sizeof(IdType) * 8);
+  if (num_rows > 0 && sub_nnz > 0) {
+    CUDA_KERNEL_CALL(_CSRRowWiseMaskedGatherKernel<IdType>, grid, block, 0, stream,
+        num_rows, slice_rows, in_ptr, in_cols, data, in_mask, sub_ptr,
+        static_cast<IdType*>(sub_indices->data),
+        static_cast<IdType*>(sub_data->data));
+  }
+  const CSRMatrix sub(num_rows, mat.num_cols, sub_indptr, sub_indices, sub_data,
+      mat.sorted);
+
+  // the rows of the sampled entries are the rows of sub, i.e. positions in rows
+  COOMatrix picked;
+  if (num_picks < 0) {
+    picked = aten::CSRToCOO(sub, false);
+  } else {
+    const IdArray sub_rows = aten::Range(0, num_rows, sizeof(IdType) * 8, ctx);
+    if (IsNullArray(prob))
+      picked = CSRRowWiseSamplingUniform<XPU, IdType>(sub, sub_rows, num_picks, replace);
+    else
+      picked = CSRRowWiseSampling<XPU, IdType, FloatType>(sub, sub_rows, num_picks, prob,
+                                                          replace);
+  }
+  return COOMatrix(mat.num_rows, mat.num_cols, aten::IndexSelect(rows, picked.row),
+      picked.col, picked.data);
+}
+
+template COOMatrix CSRRowWiseSamplingMasked<kDLGPU, int32_t, float>(
+    CSRMatrix, IdArray, int64_t, NDArray, FloatArray, bool);
+template COOMatrix CSRRowWiseSamplingMasked<kDLGPU, int64_t, float>(
+    CSRMatrix, IdArray, int64_t, NDArray, FloatArray, bool);
+template COOMatrix CSRRowWiseSamplingMasked<kDLGPU, int32_t, double>(
+    CSRMatrix, IdArray, int64_t, NDArray, FloatArray, bool);
+template COOMatrix CSRRowWiseSamplingMasked<kDLGPU, int64_t, double>(
+    CSRMatrix, IdArray, int64_t, NDArray, FloatArray, bool);
+
 }  // namespace impl
 }  // namespace aten
 }  // namespace dgl
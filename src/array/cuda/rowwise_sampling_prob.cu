@@ -0,0 +1,334 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file array/cuda/rowwise_sampling_prob.cu
+ * \brief rowwise sampling with probabilities
+ */
+
+#include <dgl/random.h>
+#include <dgl/runtime/device_api.h>
+#include <curand_kernel.h>
+#include <algorithm>
+
+#include "./dgl_cub.cuh"
+#include "./rowwise_pick.cuh"
+#include "./utils.h"
+#include "../../runtime/cuda/cuda_common.h"
+
+namespace dgl {
+namespace aten {
+namespace impl {
+
+namespace {
+
+using rowwise::kWarpSize;
+using rowwise::kBlockWarps;
+using rowwise::kTileSize;
+
+/**
+* @brief The A-Res key of an entry of weight w, log(u) / w for a uniform random
+* u in (0, 1]: the entries with the largest keys of a row are a sample without
+* replacement of the row with the weights as probabilities. The entries without
+* weight get the lowest key, so they are only picked after all the other ones.
+*/
+template<typename IdType, typename FloatType>
+struct AResKey {
+  static constexpr bool kRandom = true;
+  const FloatType * prob;
+
+  __device__ FloatType operator()(const IdType eid, curandState * const rng) const {
+    const FloatType w = prob[eid];
+    return w > 0 ? static_cast<FloatType>(log(curand_uniform_double(rng)) / w) :
+      static_cast<FloatType>(-INFINITY);
+  }
+};
+
+/**
+* @brief Perform row-wise sampling with probabilities on a CSR matrix, and
+* generate a COO matrix, with replacement.
+*
+* Every warp computes the cumulative probabilities of its row in `cdf`, then
+* draws the samples by binary search in them.
+*
+* @tparam IdType The ID type used for matrices.
+* @tparam FloatType The type of the probabilities.
+* @param rand_seed The random seed to use.
+* @param num_picks The number of non-zeros to pick per row.
+* @param num_rows The number of rows to pick.
+* @param in_rows The set of rows to pick.
+* @param in_ptr The indptr array of the input CSR.
+* @param in_index The indices array of the input CSR.
+* @param data The data array of the input CSR.
+* @param prob The probabilities, indexed like the data array.
+* @param out_ptr The offset to write each row to in the output COO.
+* @param cdf_ptr The offset of the cumulative probabilities of each row.
+* @param cdf The cumulative probabilities (temporary).
+* @param out_rows The rows of the output COO (output).
+* @param out_cols The columns of the output COO (output).
+* @param out_idxs The data array of the output COO (output).
+*/
+template<typename IdType, typename FloatType>
+__global__ void _CSRRowWiseSampleProbReplaceKernel(
+    const uint64_t rand_seed,
+    const int64_t num_picks,
+    const int64_t num_rows,
+    const IdType * const in_rows,
+    const IdType * const in_ptr,
+    const IdType * const in_index,
+    const IdType * const data,
+    const FloatType * const prob,
+    const IdType * const out_ptr,
+    const IdType * const cdf_ptr,
+    FloatType * const cdf,
+    IdType * const out_rows,
+    IdType * const out_cols,
+    IdType * const out_idxs) {
+  // we assign one warp per row
+  assert(blockDim.x == kWarpSize);
+  typedef cub::WarpScan<FloatType> WarpScan;
+  __shared__ typename WarpScan::TempStorage scan_storage[kBlockWarps];
+
+  int64_t out_row = blockIdx.x*kTileSize+threadIdx.y;
+  const int64_t last_row = min(static_cast<int64_t>(blockIdx.x+1)*kTileSize, num_rows);
+
+  curandState rng;
+  curand_init(rand_seed*gridDim.x+blockIdx.x, threadIdx.y*kWarpSize+threadIdx.x, 0, &rng);
+
+  while (out_row < last_row) {
+    const int64_t row = in_rows[out_row];
+    const int64_t in_row_start = in_ptr[row];
+    const int64_t deg = in_ptr[row+1] - in_row_start;
+    const int64_t out_row_start = out_ptr[out_row];
+    FloatType * const row_cdf = cdf + cdf_ptr[out_row];
+
+    if (deg > 0) {
+      FloatType total = 0;
+      for (int64_t base = 0; base < deg; base += kWarpSize) {
+        const int64_t idx = base+threadIdx.x;
+        const IdType in_idx = in_row_start+idx;
+        const FloatType w = idx < deg ? prob[data ? data[in_idx] : in_idx] : 0;
+        FloatType partial, chunk_total;
+        WarpScan(scan_storage[threadIdx.y]).InclusiveSum(w, partial, chunk_total);
+        if (idx < deg)
+          row_cdf[idx] = total+partial;
+        total += chunk_total;
+        __syncwarp();
+      }
+
+      for (int64_t idx = threadIdx.x; idx < num_picks; idx += kWarpSize) {
+        // draw in [0, total) and find the first entry whose cumulative
+        // probability is above it, which skips the entries without weight
+        const FloatType r = static_cast<FloatType>(1. - curand_uniform_double(&rng)) * total;
+        int64_t lo = 0, hi = deg-1;
+        while (lo < hi) {
+          const int64_t mid = (lo+hi)/2;
+          if (row_cdf[mid] > r)
+            hi = mid;
+          else
+            lo = mid+1;
+        }
+        const IdType in_idx = in_row_start+lo;
+        out_rows[out_row_start+idx] = row;
+        out_cols[out_row_start+idx] = in_index[in_idx];
+        out_idxs[out_row_start+idx] = data ? data[in_idx] : in_idx;
+      }
+    }
+    out_row += kBlockWarps;
+  }
+}
+
+/**
+* @brief Build the alias tables of the rows of a CSR matrix by Vose's alias
+* method, one thread per row.
+*
+* Unlike on CPU, the rows have no stacks of their own: the scaled probabilities
+* are kept in `accept` while the entries are paired, the unpaired ones having a
+* negative alias, and the small and large entries are found by two cursors
+* moving forward through the row, so every row takes a time linear in its
+* length.
+*
+* @tparam IdType The ID type used for matrices.
+* @tparam FloatType The type of the probabilities.
+* @param num_rows The number of rows of the matrix.
+* @param in_ptr The indptr array of the input CSR.
+* @param data The data array of the input CSR.
+* @param prob The probabilities, indexed like the data array.
+* @param accept The acceptance probabilities, indexed like the data array (output).
+* @param alias The aliases, indexed like the data array (output).
+*/
+template<typename IdType, typename FloatType>
+__global__ void _CSRRowWiseAliasTableKernel(
+    const int64_t num_rows,
+    const IdType * const in_ptr,
+    const IdType * const data,
+    const FloatType * const prob,
+    FloatType * const accept,
+    IdType * const alias) {
+  int64_t row = blockIdx.x * blockDim.x + threadIdx.x;
+  const int64_t stride = gridDim.x * blockDim.x;
+  while (row < num_rows) {
+    const int64_t off = in_ptr[row];
+    const int64_t len = in_ptr[row + 1] - off;
+    auto eid = [data, off] (int64_t k) { return data ? data[off + k] : off + k; };
+    double total = 0.;
+    for (int64_t k = 0; k < len; ++k)
+      total += prob[eid(k)];
+    for (int64_t k = 0; k < len; ++k) {
+      // a row without weight is sampled uniformly
+      accept[eid(k)] = total > 0. ? static_cast<FloatType>(prob[eid(k)] * len / total) : 1;
+      alias[eid(k)] = -1;
+    }
+
+    // `small` is the entry being paired, `next_small` the first unpaired
+    // small entry after it, and `large` the first large entry not yet known
+    // to be small
+    int64_t next_small = 0, large = 0;
+    while (next_small < len && accept[eid(next_small)] >= 1)
+      ++next_small;
+    while (large < len && accept[eid(large)] < 1)
+      ++large;
+    int64_t small = next_small;
+    if (next_small < len)
+      ++next_small;
+    while (next_small < len && accept[eid(next_small)] >= 1)
+      ++next_small;
+    while (small < len && large < len) {
+      alias[eid(small)] = large;
+      accept[eid(large)] -= 1 - accept[eid(small)];
+      if (accept[eid(large)] < 1) {
+        // the large entry became small: pair it next
+        small = large;
+        ++large;
+        while (large < len && accept[eid(large)] < 1)
+          ++large;
+      } else {
+        small = next_small;
+        if (next_small < len)
+          ++next_small;
+        while (next_small < len &&
+               (accept[eid(next_small)] >= 1 || alias[eid(next_small)] >= 0))
+          ++next_small;
+      }
+    }
+    // the remaining entries are at one up to the rounding errors
+    for (int64_t k = 0; k < len; ++k) {
+      if (alias[eid(k)] < 0) {
+        accept[eid(k)] = 1;
+        alias[eid(k)] = k;
+      }
+    }
+    row += stride;
+  }
+}
+
+}  // namespace
+
+/////////////////////////////// CSR ///////////////////////////////
+
+template <DLDeviceType XPU, typename IdType, typename FloatType>
+COOMatrix CSRRowWiseSampling(CSRMatrix mat,
+                             IdArray rows,
+                             const int64_t num_picks,
+                             FloatArray prob,
+                             const bool replace) {
+  const FloatType * const prob_data = prob.Ptr<FloatType>();
+  if (!replace) {
+    return rowwise::CSRRowWiseSortPick<IdType, FloatType>(
+        mat, rows, num_picks, true, AResKey<IdType, FloatType>{prob_data});
+  }
+
+  const auto& ctx = mat.indptr->ctx;
+  auto device = runtime::DeviceAPI::Get(ctx);
+  cudaStream_t stream = runtime::CUDAThreadEntry::ThreadLocal()->stream;
+
+  const int64_t num_rows = rows->shape[0];
+  if (num_rows == 0) {
+    return COOMatrix(mat.num_rows, mat.num_cols,
+        NewIdArray(0, ctx, sizeof(IdType) * 8), NewIdArray(0, ctx, sizeof(IdType) * 8),
+        NewIdArray(0, ctx, sizeof(IdType) * 8));
+  }
+
+  IdType * out_ptr, * cdf_ptr;
+  const auto lens = rowwise::CSRRowWisePickOffsets<IdType>(
+      mat, rows, num_picks, true, &out_ptr, &cdf_ptr);
+  const int64_t new_len = lens.first, cdf_len = lens.second;
+
+  IdArray picked_row = NewIdArray(new_len, ctx, sizeof(IdType) * 8);
+  IdArray picked_col = NewIdArray(new_len, ctx, sizeof(IdType) * 8);
+  IdArray picked_idx = NewIdArray(new_len, ctx, sizeof(IdType) * 8);
+  FloatType * cdf = static_cast<FloatType*>(
+      device->AllocWorkspace(ctx, std::max<int64_t>(cdf_len, 1)*sizeof(FloatType)));
+
+  // under a RowStreamScope, the same rows give the same samples, see RowStreamKey
+  const RowStreamKey row_streams = RowStreamScope::Current();
+  const uint64_t random_seed = row_streams.enabled ?
+    row_streams.seed % 1000000000 : RandomEngine::ThreadLocal()->RandInt(1000000000);
+  const dim3 block(kWarpSize, kBlockWarps);
+  const dim3 grid((num_rows+kTileSize-1)/kTileSize);
+  CUDA_KERNEL_CALL((_CSRRowWiseSampleProbReplaceKernel<IdType, FloatType>),
+      grid, block, 0, stream,
+      random_seed,
+      num_picks,
+      num_rows,
+      rows.Ptr<IdType>(),
+      mat.indptr.Ptr<IdType>(),
+      mat.indices.Ptr<IdType>(),
+      CSRHasData(mat) ? mat.data.Ptr<IdType>() : nullptr,
+      prob_data,
+      out_ptr,
+      cdf_ptr,
+      cdf,
+      picked_row.Ptr<IdType>(),
+      picked_col.Ptr<IdType>(),
+      picked_idx.Ptr<IdType>());
+
+  device->FreeWorkspace(ctx, cdf);
+  device->FreeWorkspace(ctx, cdf_ptr);
+  device->FreeWorkspace(ctx, out_ptr);
+
+  return COOMatrix(mat.num_rows, mat.num_cols, picked_row, picked_col, picked_idx);
+}
+
+template COOMatrix CSRRowWiseSampling<kDLGPU, int32_t, float>(
+    CSRMatrix, IdArray, int64_t, FloatArray, bool);
+template COOMatrix CSRRowWiseSampling<kDLGPU, int64_t, float>(
+    CSRMatrix, IdArray, int64_t, FloatArray, bool);
+template COOMatrix CSRRowWiseSampling<kDLGPU, int32_t, double>(
+    CSRMatrix, IdArray, int64_t, FloatArray, bool);
+template COOMatrix CSRRowWiseSampling<kDLGPU, int64_t, double>(
+    CSRMatrix, IdArray, int64_t, FloatArray, bool);
+
+template <DLDeviceType XPU, typename IdType, typename FloatType>
+std::pair<FloatArray, IdArray> CSRRowWiseAliasTable(CSRMatrix mat, FloatArray prob) {
+  CHECK(prob.defined());
+  const int64_t num_entries = prob->shape[0];
+  FloatArray accept = FloatArray::Empty({num_entries}, prob->dtype, prob->ctx);
+  IdArray alias = NewIdArray(num_entries, prob->ctx, sizeof(IdType) * 8);
+  if (mat.num_rows == 0)
+    return {accept, alias};
+
+  cudaStream_t stream = runtime::CUDAThreadEntry::ThreadLocal()->stream;
+  const int nt = cuda::FindNumThreads(mat.num_rows);
+  const int nb = (mat.num_rows + nt - 1) / nt;
+  CUDA_KERNEL_CALL((_CSRRowWiseAliasTableKernel<IdType, FloatType>),
+      nb, nt, 0, stream,
+      mat.num_rows,
+      mat.indptr.Ptr<IdType>(),
+      CSRHasData(mat) ? mat.data.Ptr<IdType>() : nullptr,
+      prob.Ptr<FloatType>(),
+      accept.Ptr<FloatType>(),
+      alias.Ptr<IdType>());
+  return {accept, alias};
+}
+
+template std::pair<FloatArray, IdArray> CSRRowWiseAliasTable<kDLGPU, int32_t, float>(
+    CSRMatrix, FloatArray);
+template std::pair<FloatArray, IdArray> CSRRowWiseAliasTable<kDLGPU, int64_t, float>(
+    CSRMatrix, FloatArray);
+template std::pair<FloatArray, IdArray> CSRRowWiseAliasTable<kDLGPU, int32_t, double>(
+    CSRMatrix, FloatArray);
+template std::pair<FloatArray, IdArray> CSRRowWiseAliasTable<kDLGPU, int64_t, double>(
+    CSRMatrix, FloatArray);
+
+}  // namespace impl
+}  // namespace aten
+}  // namespace dgl
@@ -0,0 +1,60 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file array/cuda/rowwise_topk.cu
+ * \brief rowwise topk
+ */
+
+#include <curand_kernel.h>
+
+#include "./rowwise_pick.cuh"
+
+namespace dgl {
+namespace aten {
+namespace impl {
+
+namespace {
+
+/**
+* @brief The topk sort key of an entry, i.e. its weight.
+*/
+template<typename IdType, typename DType>
+struct TopkKey {
+  static constexpr bool kRandom = false;
+  const DType * weight;
+
+  __device__ DType operator()(const IdType eid, curandState * const) const {
+    return weight[eid];
+  }
+};
+
+}  // namespace
+
+/////////////////////////////// CSR ///////////////////////////////
+
+template <DLDeviceType XPU, typename IdType, typename DType>
+COOMatrix CSRRowWiseTopk(
+    CSRMatrix mat, IdArray rows, int64_t k, NDArray weight, bool ascending) {
+  return rowwise::CSRRowWiseSortPick<IdType, DType>(
+      mat, rows, k, !ascending, TopkKey<IdType, DType>{weight.Ptr<DType>()});
+}
+
+template COOMatrix CSRRowWiseTopk<kDLGPU, int32_t, int32_t>(
+    CSRMatrix, IdArray, int64_t, NDArray, bool);
+template COOMatrix CSRRowWiseTopk<kDLGPU, int64_t, int32_t>(
+    CSRMatrix, IdArray, int64_t, NDArray, bool);
+template COOMatrix CSRRowWiseTopk<kDLGPU, int32_t, int64_t>(
+    CSRMatrix, IdArray, int64_t, NDArray, bool);
+template COOMatrix CSRRowWiseTopk<kDLGPU, int64_t, int64_t>(
+    CSRMatrix, IdArray, int64_t, NDArray, bool);
+template COOMatrix CSRRowWiseTopk<kDLGPU, int32_t, float>(
+    CSRMatrix, IdArray, int64_t, NDArray, bool);
+template COOMatrix CSRRowWiseTopk<kDLGPU, int64_t, float>(
+    CSRMatrix, IdArray, int64_t, NDArray, bool);
+template COOMatrix CSRRowWiseTopk<kDLGPU, int32_t, double>(
+    CSRMatrix, IdArray, int64_t, NDArray, bool);
+template COOMatrix CSRRowWiseTopk<kDLGPU, int64_t, double>(
+    CSRMatrix, IdArray, int64_t, NDArray, bool);
+
+}  // namespace impl
+}  // namespace aten
+}  // namespace dgl
@@ -109,15 +109,29 @@ void SDDMMCsrHetero(const std::string& op,
   SWITCH_BITS(bits, DType, {
     SWITCH_OP(op, Op, {
       SWITCH_TARGET(lhs_target, rhs_target, LhsTarget, RhsTarget, {
-        /* Call SDDMM CUDA kernel for each relation type sequentially */
+        // the relations of few edges are computed in a single launch, the
+        // others by one kernel each
+        std::vector<cuda::SDDMMHeteroRelation<IdType, DType>> batched;
+        std::vector<int64_t> batched_edges;
         for (dgl_type_t etype = 0; etype < lhs_eid.size(); ++etype) {
           CSRMatrix csr = vec_csr[etype];
           NDArray lhs = vec_lhs[lhs_eid[etype]];
           NDArray rhs = vec_rhs[rhs_eid[etype]];
           NDArray out = vec_out[etype];
-          cuda::SDDMMCsr<IdType, DType, Op, LhsTarget, RhsTarget>(
-            bcast, csr, lhs, rhs, out);
+          const int64_t nnz = csr.indices->shape[0];
+          if (lhs_eid.size() > 1 && nnz <= cuda::kSDDMMBatchedMaxEdges) {
+            batched.push_back({csr.indptr.Ptr<IdType>(), csr.indices.Ptr<IdType>(),
+                IsNullArray(csr.data) ? nullptr : csr.data.Ptr<IdType>(),
+                lhs.Ptr<DType>(), rhs.Ptr<DType>(), out.Ptr<DType>(), csr.num_rows, 0});
+            batched_edges.push_back(nnz);
+          } else {
+            cuda::SDDMMCsr<IdType, DType, Op, LhsTarget, RhsTarget>(
+              bcast, csr, lhs, rhs, out);
+          }
         }
+        if (!batched.empty())
+          cuda::SDDMMHeteroBatched<IdType, DType, Op, LhsTarget, RhsTarget, true>(
+            bcast, batched, batched_edges, vec_csr[0].indptr->ctx);
       });
     });
   });
@@ -165,15 +179,28 @@ void SDDMMCooHetero(const std::string& op,
   SWITCH_BITS(bits, DType, {
     SWITCH_OP(op, Op, {
       SWITCH_TARGET(lhs_target, rhs_target, LhsTarget, RhsTarget, {
-        /* Call SDDMM CUDA kernel for each relation type sequentially */
+        // as for Csr, the relations of few edges are computed in a single launch
+        std::vector<cuda::SDDMMHeteroRelation<IdType, DType>> batched;
+        std::vector<int64_t> batched_edges;
         for (dgl_type_t etype = 0; etype < lhs_eid.size(); ++etype) {
           COOMatrix coo = vec_coo[etype];
           NDArray lhs = vec_lhs[lhs_eid[etype]];
           NDArray rhs = vec_rhs[rhs_eid[etype]];
           NDArray out = vec_out[etype];
-          cuda::SDDMMCoo<IdType, DType, Op, LhsTarget, RhsTarget>(
-            bcast, coo, lhs, rhs, out);
+          const int64_t nnz = coo.row->shape[0];
+          if (lhs_eid.size() > 1 && nnz <= cuda::kSDDMMBatchedMaxEdges) {
+            batched.push_back({coo.row.Ptr<IdType>(), coo.col.Ptr<IdType>(),
+                IsNullArray(coo.data) ? nullptr : coo.data.Ptr<IdType>(),
+                lhs.Ptr<DType>(), rhs.Ptr<DType>(), out.Ptr<DType>(), coo.num_rows, 0});
+            batched_edges.push_back(nnz);
+          } else {
+            cuda::SDDMMCoo<IdType, DType, Op, LhsTarget, RhsTarget>(
+              bcast, coo, lhs, rhs, out);
+          }
         }
+        if (!batched.empty())
+          cuda::SDDMMHeteroBatched<IdType, DType, Op, LhsTarget, RhsTarget, false>(
+            bcast, batched, batched_edges, vec_coo[0].row->ctx);
       });
     });
   });
@@ -7,13 +7,16 @@
 #define DGL_ARRAY_CUDA_SDDMM_CUH_
 
 #include <dgl/bcast.h>
+#include <vector>
 #include "macro.cuh"
 #include "atomic.cuh"
 #include "functor.cuh"
 #include "fp16.cuh"
+#include "vectorized.cuh"
 #include "./utils.h"
 #include "../selector.h"
 #include "../../runtime/cuda/cuda_common.h"
+#include "../../runtime/cuda/cuda_graph.h"
 
 namespace dgl {
 
@@ -192,6 +195,210 @@ __global__ void SDDMMCsrKernel(
   }
 }
 
+/*!
+ * \brief A relation computed by SDDMMHeteroBatchedKernel.
+ * \note If IsCsr, row is the indptr of the Csr matrix.
+ */
+template <typename Idx, typename DType>
+struct SDDMMHeteroRelation {
+  const Idx* row;
+  const Idx* col;
+  const Idx* edge_map;
+  const DType* lhs;
+  const DType* rhs;
+  DType* out;
+  int64_t num_rows;
+  /*! \brief The position of the first edge of the relation among all edges. */
+  int64_t edge_begin;
+};
+
+/*!
+ * \brief CUDA kernel of g-SDDMM on Coo or Csr format on heterogeneous graph,
+ *        computing all the relations in a single launch.
+ * \note it uses the edge parallel strategy of SDDMMCooKernel over the edges of
+ *       all the relations, the relation of an edge being found by binary
+ *       search on the offsets of the relations. Every relation writes to its
+ *       own output.
+ *       If IsCsr, the source node of an edge is found by binary search on the
+ *       indptr of its relation, as in SDDMMCsrKernel.
+ */
+template <typename Idx, typename DType, typename BinaryOp,
+          bool UseBcast = false, int LhsTarget = 0, int RhsTarget = 2,
+          bool IsCsr = false>
+__global__ void SDDMMHeteroBatchedKernel(
+  const SDDMMHeteroRelation<Idx, DType>* __restrict__ relations,
+  int64_t num_relations, int64_t total_edges, int64_t reduce_size,
+  const int64_t* __restrict__ lhs_off,
+  const int64_t* __restrict__ rhs_off,
+  int64_t lhs_len, int64_t rhs_len, int64_t out_len) {
+  int64_t ty = blockIdx.y * blockDim.y + threadIdx.y;
+  const int64_t stride_y = blockDim.y * gridDim.y;
+  while (ty < total_edges) {
+    // the last relation starting at or before ty
+    int64_t lo = 0, hi = num_relations;
+    while (hi - lo > 1) {
+      const int64_t mid = lo + (hi - lo) / 2;
+      if (relations[mid].edge_begin <= ty)
+        lo = mid;
+      else
+        hi = mid;
+    }
+    const SDDMMHeteroRelation<Idx, DType> rel = relations[lo];
+    const Idx pos = ty - rel.edge_begin;
+    const Idx src = IsCsr ?
+      BinarySearchSrc<Idx>(rel.row, rel.num_rows + 1, pos) : _ldg(rel.row + pos);
+    const Idx dst = _ldg(rel.col + pos);
+    const Idx eid = rel.edge_map ? _ldg(rel.edge_map + pos) : pos;
+    const DType* lhsoff = BinaryOp::use_lhs ?
+      (rel.lhs + Selector<LhsTarget>::Call(src, eid, dst) * lhs_len): nullptr;
+    const DType* rhsoff = BinaryOp::use_rhs ?
+      (rel.rhs + Selector<RhsTarget>::Call(src, eid, dst) * rhs_len): nullptr;
+    DType* outoff = rel.out + eid * out_len;
+    int64_t tx = blockIdx.x * blockDim.x + threadIdx.x;
+    const int64_t stride_x = blockDim.x * gridDim.x;
+    while (tx < out_len) {
+      const Idx lhs_add = UseBcast ? lhs_off[tx] : tx;
+      const Idx rhs_add = UseBcast ? rhs_off[tx] : tx;
+      DType val = BinaryOp::Call(
+          lhsoff + lhs_add * reduce_size,
+          rhsoff + rhs_add * reduce_size,
+          reduce_size);
+      outoff[tx] = val;
+      tx += stride_x;
+    }
+    ty += stride_y;
+  }
+}
+
+/*!
+ * \brief CUDA kernel of g-SDDMM with vectorized feature access, on Coo or Csr
+ *        format.
+ * \note it uses the same edge parallel strategy as SDDMMCooKernel, but every
+ *       thread computes VecType<DType>::kWidth consecutive positions in feature
+ *       dimension. It requires no broadcasting, no reduction on the last
+ *       dimension, and feature rows aligned to the vector size.
+ *       If IsCsr, row is the indptr of the Csr matrix.
+ */
+template <typename Idx, typename DType, typename BinaryOp,
+          bool UseIdx = false, int LhsTarget = 0, int RhsTarget = 2,
+          bool IsCsr = false>
+__global__ void SDDMMVecKernel(
+  const DType* __restrict__ lhs,
+  const DType* __restrict__ rhs,
+  DType* __restrict__ out,
+  const Idx* __restrict__ row,
+  const Idx* __restrict__ col,
+  const Idx* __restrict__ edge_map,
+  int64_t N, int64_t M, int64_t E,
+  int64_t lhs_len, int64_t rhs_len, int64_t out_len) {
+  constexpr int kWidth = VecType<DType>::kWidth;
+  Idx ty = blockIdx.y * blockDim.y + threadIdx.y;
+  const Idx stride_y = blockDim.y * gridDim.y;
+  while (ty < E) {
+    const Idx src = IsCsr ? BinarySearchSrc<Idx>(row, N + 1, ty) : _ldg(row + ty);
+    const Idx dst = _ldg(col + ty);
+    const Idx eid = UseIdx ? _ldg(edge_map + ty) : ty;
+    const DType* lhsoff = BinaryOp::use_lhs ?
+      (lhs + Selector<LhsTarget>::Call(src, eid, dst) * lhs_len): nullptr;
+    const DType* rhsoff = BinaryOp::use_rhs ?
+      (rhs + Selector<RhsTarget>::Call(src, eid, dst) * rhs_len): nullptr;
+    DType* outoff = out + eid * out_len;
+    int64_t tx = (blockIdx.x * blockDim.x + threadIdx.x) * kWidth;
+    const int64_t stride_x = blockDim.x * gridDim.x * kWidth;
+    while (tx < out_len) {
+      VecPack<DType> lhs_vec, rhs_vec, out_vec;
+      if (BinaryOp::use_lhs)
+        lhs_vec = VecLoad(lhsoff + tx);
+      if (BinaryOp::use_rhs)
+        rhs_vec = VecLoad(rhsoff + tx);
+#pragma unroll
+      for (int k = 0; k < kWidth; ++k)
+        out_vec.val[k] = BinaryOp::Call(lhs_vec.val + k, rhs_vec.val + k);
+      VecStore(outoff + tx, out_vec);
+      tx += stride_x;
+    }
+    ty += stride_y;
+  }
+}
+
+/*!
+ * \brief CUDA kernel of SDDMM-dot with vectorized feature access and warp
+ *        reduction, on Coo or Csr format.
+ * \note it uses the same strategy as SDDMMCooTreeReduceKernel: a warp computes
+ *       a dot product, every lane loading VecType<DType>::kWidth consecutive
+ *       values of both operands at a time. It requires the reduce size to be a
+ *       multiple of the vector width and aligned operands.
+ *       If IsCsr, row is the indptr of the Csr matrix.
+ */
+template <typename Idx, typename DType,
+          bool UseBcast = false, bool UseIdx = false,
+          int LhsTarget = 0, int RhsTarget = 2, bool IsCsr = false>
+__global__ void SDDMMDotVecKernel(
+  const DType* __restrict__ lhs,
+  const DType* __restrict__ rhs,
+  DType* __restrict__ out,
+  const Idx* __restrict__ row,
+  const Idx* __restrict__ col,
+  const Idx* __restrict__ edge_map,
+  int64_t N, int64_t M, int64_t E, int64_t reduce_size,
+  const int64_t* __restrict__ lhs_off,
+  const int64_t* __restrict__ rhs_off,
+  int64_t lhs_len, int64_t rhs_len, int64_t out_len) {
+  constexpr int kWidth = VecType<DType>::kWidth;
+  Idx ty = blockIdx.x * blockDim.y + threadIdx.y;
+  if (ty < E) {
+    const Idx src = IsCsr ? BinarySearchSrc<Idx>(row, N + 1, ty) : _ldg(row + ty);
+    const Idx dst = _ldg(col + ty);
+    const Idx eid = UseIdx ? _ldg(edge_map + ty) : ty;
+    const DType* lhsoff = lhs + Selector<LhsTarget>::Call(src, eid, dst) * lhs_len;
+    const DType* rhsoff = rhs + Selector<RhsTarget>::Call(src, eid, dst) * rhs_len;
+    DType* outoff = out + eid * out_len;
+    int tx = threadIdx.x;  // tx < 32
+    for (int i = blockIdx.y; i < out_len; i += gridDim.y) {  // over output feature dimension
+      const Idx lhs_add = UseBcast ? __ldg(lhs_off + i) : i;
+      const Idx rhs_add = UseBcast ? __ldg(rhs_off + i) : i;
+      const DType* lhsrow = lhsoff + lhs_add * reduce_size;
+      const DType* rhsrow = rhsoff + rhs_add * reduce_size;
+      DType val = reduce::Sum<Idx, DType>::zero();
+      for (int64_t j = tx * kWidth; j < reduce_size; j += 32 * kWidth) {
+        const VecPack<DType> lhs_vec = VecLoad(lhsrow + j);
+        const VecPack<DType> rhs_vec = VecLoad(rhsrow + j);
+#pragma unroll
+        for (int k = 0; k < kWidth; ++k)
+          val += lhs_vec.val[k] * rhs_vec.val[k];
+      }
+#pragma unroll
+      for (int offset = 16; offset > 0; offset /= 2)
+        val += __shfl_down_sync(full_mask, val, offset);
+      if (tx == 0)
+        outoff[i] = val;
+    }
+  }
+}
+
+/*!
+ * \brief Whether SDDMMVecKernel applies to the operator and the features.
+ */
+template <typename DType, typename Op>
+bool SDDMMVecApplicable(
+    const BcastOff& bcast, const DType* lhs, const DType* rhs, const DType* out) {
+  return !bcast.use_bcast && !Op::reduce_last_dim &&
+    VecAligned(Op::use_lhs ? lhs : nullptr, bcast.lhs_len) &&
+    VecAligned(Op::use_rhs ? rhs : nullptr, bcast.rhs_len) &&
+    VecAligned(out, bcast.out_len);
+}
+
+/*!
+ * \brief Whether SDDMMDotVecKernel applies to the operator and the features.
+ * \note the warp reduction only pays off for long enough reductions.
+ */
+template <typename DType, typename Op>
+bool SDDMMDotVecApplicable(
+    const BcastOff& bcast, const DType* lhs, const DType* rhs) {
+  return std::is_same<Op, binary::Dot<DType> >::value && bcast.reduce_size >= 32 &&
+    VecAligned(lhs, bcast.reduce_size) && VecAligned(rhs, bcast.reduce_size);
+}
+
 /*!
  * \brief CUDA implementation of g-SDDMM on Coo format.
  * \param bcast Broadcast information.
@@ -225,7 +432,23 @@ void SDDMMCoo(
   const int64_t nnz = coo.row->shape[0];
   const bool use_idx = !IsNullArray(coo.data);
 
-  if (std::is_same<Op, binary::Dot<DType> >::value && reduce_dim >= 32) {
+  if (SDDMMDotVecApplicable<DType, Op>(bcast, lhs_data, rhs_data)) {
+    const int ntx = 32;  // on feature dimension
+    const int nty = 8;   // on out dimension
+    const int nbx = (nnz + nty - 1) / nty;
+    const int nby = FindNumBlocks<'y'>(len);
+    const dim3 nblks(nbx, nby);
+    const dim3 nthrs(ntx, nty);
+    BCAST_IDX_CTX_SWITCH(bcast, use_idx, out->ctx, lhs_off, rhs_off, {
+      CUDA_KERNEL_CALL((SDDMMDotVecKernel<Idx, DType, UseBcast, UseIdx, LhsTarget, RhsTarget>),
+          nblks, nthrs, 0, thr_entry->stream,
+          lhs_data, rhs_data, out_data,
+          row, col, edge_map,
+          coo.num_rows, coo.num_cols, nnz, reduce_dim,
+          lhs_off, rhs_off,
+          lhs_len, rhs_len, len);
+    });
+  } else if (std::is_same<Op, binary::Dot<DType> >::value && reduce_dim >= 32) {
     const int ntx = 32;  // on feature dimension
     const int nty = 8;   // on out dimension
     const int nbx = (nnz + nty - 1) / nty;
@@ -241,6 +464,22 @@ void SDDMMCoo(
           lhs_off, rhs_off,
           lhs_len, rhs_len, len);
     });
+  } else if (SDDMMVecApplicable<DType, Op>(bcast, lhs_data, rhs_data, out_data)) {
+    const int64_t num_vec = len / VecType<DType>::kWidth;
+    const int ntx = FindNumThreads(num_vec);
+    const int nty = CUDA_MAX_NUM_THREADS / ntx;
+    const int nbx = (num_vec + ntx - 1) / ntx;
+    const int nby = FindNumBlocks<'y'>((nnz + nty - 1) / nty);
+    const dim3 nblks(nbx, nby);
+    const dim3 nthrs(ntx, nty);
+    BCAST_IDX_CTX_SWITCH(bcast, use_idx, out->ctx, lhs_off, rhs_off, {
+      CUDA_KERNEL_CALL((SDDMMVecKernel<Idx, DType, Op, UseIdx, LhsTarget, RhsTarget>),
+          nblks, nthrs, 0, thr_entry->stream,
+          lhs_data, rhs_data, out_data,
+          row, col, edge_map,
+          coo.num_rows, coo.num_cols, nnz,
+          lhs_len, rhs_len, len);
+    });
   } else {
     const int ntx = FindNumThreads(len);
     const int nty = CUDA_MAX_NUM_THREADS / ntx;
@@ -291,26 +530,125 @@ void SDDMMCsr(
           rhs_len = bcast.rhs_len;
   int64_t reduce_dim = bcast.reduce_size;
 
+  const bool use_idx = !IsNullArray(csr.data);
+
+  if (SDDMMDotVecApplicable<DType, Op>(bcast, lhs_data, rhs_data)) {
+    const int ntx = 32;  // on feature dimension
+    const int nty = 8;   // on out dimension
+    const int nbx = (E + nty - 1) / nty;
+    const int nby = FindNumBlocks<'y'>(len);
+    const dim3 nblks(nbx, nby);
+    const dim3 nthrs(ntx, nty);
+    BCAST_IDX_CTX_SWITCH(bcast, use_idx, out->ctx, lhs_off, rhs_off, {
+      CUDA_KERNEL_CALL(
+          (SDDMMDotVecKernel<Idx, DType, UseBcast, UseIdx, LhsTarget, RhsTarget, true>),
+          nblks, nthrs, 0, thr_entry->stream,
+          lhs_data, rhs_data, out_data,
+          indptr, indices, edge_map,
+          N, M, E, reduce_dim,
+          lhs_off, rhs_off,
+          lhs_len, rhs_len, len);
+    });
+  } else if (SDDMMVecApplicable<DType, Op>(bcast, lhs_data, rhs_data, out_data)) {
+    const int64_t num_vec = len / VecType<DType>::kWidth;
+    const int ntx = FindNumThreads(num_vec);
+    const int nty = CUDA_MAX_NUM_THREADS / ntx;
+    const int nbx = (num_vec + ntx - 1) / ntx;
+    const int nby = FindNumBlocks<'y'>((E + nty - 1) / nty);
+    const dim3 nblks(nbx, nby);
+    const dim3 nthrs(ntx, nty);
+    BCAST_IDX_CTX_SWITCH(bcast, use_idx, out->ctx, lhs_off, rhs_off, {
+      CUDA_KERNEL_CALL((SDDMMVecKernel<Idx, DType, Op, UseIdx, LhsTarget, RhsTarget, true>),
+          nblks, nthrs, 0, thr_entry->stream,
+          lhs_data, rhs_data, out_data,
+          indptr, indices, edge_map,
+          N, M, E,
+          lhs_len, rhs_len, len);
+    });
+  } else {
+    const int ntx = FindNumThreads(len);
+    const int nty = CUDA_MAX_NUM_THREADS / ntx;
+    const int nbx = (len + ntx - 1) / ntx;
+    const int nby = FindNumBlocks<'y'>((E + nty - 1) / nty);
+    const dim3 nblks(nbx, nby);
+    const dim3 nthrs(ntx, nty);
+    BCAST_IDX_CTX_SWITCH(bcast, use_idx, out->ctx, lhs_off, rhs_off, {
+      CUDA_KERNEL_CALL((SDDMMCsrKernel<Idx, DType, Op, UseBcast, UseIdx, LhsTarget, RhsTarget>),
+          nblks, nthrs, 0, thr_entry->stream,
+          lhs_data, rhs_data, out_data,
+          indptr, indices, edge_map,
+          N, M, E, reduce_dim,
+          lhs_off, rhs_off,
+          lhs_len, rhs_len, len);
+    });
+  }
+}
+
+/*! \brief Maximum number of edges of a relation computed by the batched SDDMM. */
+constexpr int64_t kSDDMMBatchedMaxEdges = 1 << 16;
+
+/*!
+ * \brief CUDA implementation of g-SDDMM on Coo or Csr format on heterogeneous
+ *        graph, computing the given relations in a single launch.
+ * \param bcast Broadcast information, shared by all the relations.
+ * \param relations The relations, with edge_begin unset.
+ * \param ctx The device of the relations.
+ * \note Heterogeneous attention computes many relations of few edges each,
+ *       whose separate launches cost more than the kernels. The relations are
+ *       given by pointers, so their outputs may as well be slices of one edge
+ *       tensor.
+ */
+template <typename Idx, typename DType, typename Op,
+          int LhsTarget = 0, int RhsTarget = 2, bool IsCsr = false>
+void SDDMMHeteroBatched(
+    const BcastOff& bcast,
+    std::vector<SDDMMHeteroRelation<Idx, DType>> relations,
+    const std::vector<int64_t>& num_edges,
+    const DLContext& ctx) {
+  typedef SDDMMHeteroRelation<Idx, DType> Relation;
+  // the offset table of the relations, leaving out those of no edges
+  std::vector<Relation> nonempty;
+  int64_t total_edges = 0;
+  for (size_t i = 0; i < relations.size(); ++i) {
+    if (num_edges[i] == 0)
+      continue;
+    relations[i].edge_begin = total_edges;
+    total_edges += num_edges[i];
+    nonempty.push_back(relations[i]);
+  }
+  if (total_edges == 0)
+    return;
+
+  const auto device = runtime::DeviceAPI::Get(ctx);
+  auto* thr_entry = runtime::CUDAThreadEntry::ThreadLocal();
+  Relation* relations_dev = static_cast<Relation*>(
+      device->AllocWorkspace(ctx, nonempty.size() * sizeof(Relation)));
+  runtime::CopyHostToDeviceAsync(nonempty.data(), relations_dev,
+      nonempty.size() * sizeof(Relation), thr_entry->stream);
+
+  int64_t *lhs_off = nullptr, *rhs_off = nullptr;
+  int64_t len = bcast.out_len,
+          lhs_len = bcast.lhs_len,
+          rhs_len = bcast.rhs_len;
   const int ntx = FindNumThreads(len);
   const int nty = CUDA_MAX_NUM_THREADS / ntx;
   const int nbx = (len + ntx - 1) / ntx;
-  const int nby = FindNumBlocks<'y'>((E + nty - 1) / nty);
+  const int nby = FindNumBlocks<'y'>((total_edges + nty - 1) / nty);
   const dim3 nblks(nbx, nby);
   const dim3 nthrs(ntx, nty);
-  const bool use_idx = !IsNullArray(csr.data);
-
-  BCAST_IDX_CTX_SWITCH(bcast, use_idx, out->ctx, lhs_off, rhs_off, {
-    CUDA_KERNEL_CALL((SDDMMCsrKernel<Idx, DType, Op, UseBcast, UseIdx, LhsTarget, RhsTarget>),
+  // the edge maps are checked per relation in the kernel
+  BCAST_IDX_CTX_SWITCH(bcast, false, ctx, lhs_off, rhs_off, {
+    CUDA_KERNEL_CALL(
+        (SDDMMHeteroBatchedKernel<Idx, DType, Op, UseBcast, LhsTarget, RhsTarget, IsCsr>),
         nblks, nthrs, 0, thr_entry->stream,
-        lhs_data, rhs_data, out_data,
-        indptr, indices, edge_map,
-        N, M, E, reduce_dim,
+        relations_dev, static_cast<int64_t>(nonempty.size()), total_edges,
+        bcast.reduce_size,
         lhs_off, rhs_off,
         lhs_len, rhs_len, len);
   });
+  device->FreeWorkspace(ctx, relations_dev);
 }
 
-
 }  // namespace cuda
 }  // namespace aten
 }  // namespace dgl
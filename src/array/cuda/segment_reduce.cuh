@@ -6,9 +6,12 @@
 #ifndef DGL_ARRAY_SEGMENT_REDUCE_CUH_
 #define DGL_ARRAY_SEGMENT_REDUCE_CUH_
 
+#include <dgl/array.h>
+#include <algorithm>
 #include "../../runtime/cuda/cuda_common.h"
 #include "./utils.h"
 #include "./atomic.cuh"
+#include "./dgl_cub.cuh"
 
 namespace dgl {
 
@@ -17,10 +20,31 @@ using namespace cuda;
 namespace aten {
 namespace cuda {
 
+/*! \brief Minimum average segment length for which a warp reduces a segment. */
+constexpr int64_t kSegmentWarpMinLength = 16;
+/*! \brief Minimum average segment length for which a block reduces a segment. */
+constexpr int64_t kSegmentBlockMinLength = 2048;
+/*! \brief Number of threads of a block of the segment kernels. */
+constexpr int kSegmentNumThreads = 256;
+
+/*!
+ * \brief The launch configuration of the kernels computing every position of
+ *        n rows of dim features, by thread. The threads of a block span
+ *        several rows on the y-axis when the rows are narrow.
+ */
+inline void RowwiseLaunchConfig(int64_t n, int64_t dim, dim3* nblks, dim3* nthrs) {
+  const int ntx = FindNumThreads(dim, kSegmentNumThreads);
+  const int nty = kSegmentNumThreads / ntx;
+  *nthrs = dim3(ntx, nty);
+  *nblks = dim3(FindNumBlocks<'x'>((n + nty - 1) / nty),
+                FindNumBlocks<'y'>((dim + ntx - 1) / ntx));
+}
+
 /*!
  * \brief CUDA kernel of segment reduce.
- * \note each blockthread is responsible for aggregation on a row
- *       in the result tensor.
+ * \note each thread is responsible for aggregation on a position of a row
+ *       in the result tensor, the rows of a block on the y-axis so that a
+ *       block spans many tiny segments of narrow features.
  */
 template <typename IdType, typename DType,
           typename ReduceOp>
@@ -28,8 +52,9 @@ __global__ void SegmentReduceKernel(
     const DType* feat, const IdType* offsets,
     DType* out, IdType* arg,
     int64_t n, int64_t dim){
-  for (int row = blockIdx.x; row < n; row += gridDim.x) {
-    int col = blockIdx.y * blockDim.x + threadIdx.x;
+  for (int64_t row = blockIdx.x * blockDim.y + threadIdx.y; row < n;
+       row += gridDim.x * blockDim.y) {
+    int64_t col = blockIdx.y * blockDim.x + threadIdx.x;
     while (col < dim) {
       DType local_accum = ReduceOp::zero();
       IdType local_arg = -1;
@@ -44,6 +69,112 @@ __global__ void SegmentReduceKernel(
   }
 }
 
+/*!
+ * \brief Merge the partial reduction of a part of a segment into another one.
+ * \note on ties of min/max, the smaller index is kept, as in the serial order
+ *       of SegmentReduceKernel.
+ */
+template <typename IdType, typename DType, typename ReduceOp>
+__device__ __forceinline__ void MergeSegmentPartial(
+    DType* accum, IdType* arg, DType val, IdType val_arg) {
+  if (ReduceOp::require_arg && val == *accum) {
+    if (val_arg >= 0 && (*arg < 0 || val_arg < *arg))
+      *arg = val_arg;
+  } else {
+    ReduceOp::Call(accum, arg, val, val_arg);
+  }
+}
+
+/*!
+ * \brief CUDA kernel of segment reduce with a warp per segment.
+ * \note the 32 threads of a warp (on x-axis) stride over the rows of a segment
+ *       and their partial results are reduced by warp shuffles, for every
+ *       position in the feature dimension in turn. The warps of a block (on
+ *       y-axis) are responsible for different segments. It suits segments of
+ *       tens to thousands of rows with narrow features.
+ */
+template <typename IdType, typename DType, typename ReduceOp>
+__global__ void SegmentReduceWarpKernel(
+    const DType* feat, const IdType* offsets,
+    DType* out, IdType* arg,
+    int64_t n, int64_t dim) {
+  const int lane = threadIdx.x;
+  // the loops are uniform over a warp, as the shuffles require
+  for (int64_t row = blockIdx.x * blockDim.y + threadIdx.y; row < n;
+       row += gridDim.x * blockDim.y) {
+    const IdType start = offsets[row], end = offsets[row + 1];
+    for (int64_t col = 0; col < dim; ++col) {
+      DType local_accum = ReduceOp::zero();
+      IdType local_arg = -1;
+      for (IdType i = start + lane; i < end; i += 32)
+        ReduceOp::Call(&local_accum, &local_arg, feat[i * dim + col], i);
+#pragma unroll
+      for (int offset = 16; offset > 0; offset /= 2) {
+        const DType other = __shfl_down_sync(0xffffffff, local_accum, offset);
+        const IdType other_arg = __shfl_down_sync(0xffffffff, local_arg, offset);
+        MergeSegmentPartial<IdType, DType, ReduceOp>(
+            &local_accum, &local_arg, other, other_arg);
+      }
+      if (lane == 0) {
+        out[row * dim + col] = local_accum;
+        if (ReduceOp::require_arg)
+          arg[row * dim + col] = local_arg;
+      }
+    }
+  }
+}
+
+/*!
+ * \brief CUDA kernel of segment reduce with a block per segment.
+ * \note the threads of a block on the x-axis are responsible for different
+ *       positions in feature dimension, and those on the y-axis (a power of
+ *       two) stride over the rows of the segment; their partial results are
+ *       reduced in shared memory. Blocks on the y-axis are responsible for
+ *       different positions in feature dimension. It suits a few huge
+ *       segments, which leave the other kernels with too few threads.
+ */
+template <typename IdType, typename DType, typename ReduceOp>
+__global__ void SegmentReduceBlockKernel(
+    const DType* feat, const IdType* offsets,
+    DType* out, IdType* arg,
+    int64_t n, int64_t dim) {
+  extern __shared__ char smem[];
+  IdType* args = reinterpret_cast<IdType*>(smem);
+  DType* accums = reinterpret_cast<DType*>(args + blockDim.x * blockDim.y);
+  const int tid = threadIdx.y * blockDim.x + threadIdx.x;
+  // the loops are uniform over a block, as the barriers require
+  for (int64_t row = blockIdx.x; row < n; row += gridDim.x) {
+    const IdType start = offsets[row], end = offsets[row + 1];
+    for (int64_t col_begin = blockIdx.y * blockDim.x; col_begin < dim;
+         col_begin += gridDim.y * blockDim.x) {
+      const int64_t col = col_begin + threadIdx.x;
+      DType local_accum = ReduceOp::zero();
+      IdType local_arg = -1;
+      if (col < dim) {
+        for (IdType i = start + threadIdx.y; i < end; i += blockDim.y)
+          ReduceOp::Call(&local_accum, &local_arg, feat[i * dim + col], i);
+      }
+      accums[tid] = local_accum;
+      args[tid] = local_arg;
+      __syncthreads();
+      for (int s = blockDim.y / 2; s > 0; s >>= 1) {
+        if (threadIdx.y < s) {
+          MergeSegmentPartial<IdType, DType, ReduceOp>(
+              accums + tid, args + tid,
+              accums[tid + s * blockDim.x], args[tid + s * blockDim.x]);
+        }
+        __syncthreads();
+      }
+      if (threadIdx.y == 0 && col < dim) {
+        out[row * dim + col] = accums[tid];
+        if (ReduceOp::require_arg)
+          arg[row * dim + col] = args[tid];
+      }
+      __syncthreads();
+    }
+  }
+}
+
 /*!
  * \brief CUDA kernel of scatter add.
  * \note each blockthread is responsible for adding a row in feature tensor
@@ -53,9 +184,10 @@ template <typename IdType, typename DType>
 __global__ void ScatterAddKernel(
     const DType *feat, const IdType *idx, DType *out,
     int64_t n, int64_t dim) {
-  for (int row = blockIdx.x; row < n; row += gridDim.x) {
-    const int write_row = idx[row];
-    int col = blockIdx.y * blockDim.x + threadIdx.x;
+  for (int64_t row = blockIdx.x * blockDim.y + threadIdx.y; row < n;
+       row += gridDim.x * blockDim.y) {
+    const int64_t write_row = idx[row];
+    int64_t col = blockIdx.y * blockDim.x + threadIdx.x;
     while (col < dim) {
       cuda::AtomicAdd(out + write_row * dim + col, feat[row * dim + col]);
       col += gridDim.y * blockDim.x;
@@ -63,6 +195,52 @@ __global__ void ScatterAddKernel(
   }
 }
 
+/*!
+ * \brief CUDA kernel of scatter add on rows sorted by target index.
+ * \note each blockthread is responsible for a row in the output tensor, which
+ *       sums the rows perm[offsets[row]:offsets[row + 1]] of the feature tensor
+ *       in order, without atomics.
+ */
+template <typename IdType, typename DType>
+__global__ void SortedScatterAddKernel(
+    const DType *feat, const IdType *perm, const IdType *offsets, DType *out,
+    int64_t m, int64_t dim) {
+  for (int row = blockIdx.x; row < m; row += gridDim.x) {
+    int col = blockIdx.y * blockDim.x + threadIdx.x;
+    while (col < dim) {
+      DType local_accum = 0.;
+      for (IdType i = offsets[row]; i < offsets[row + 1]; ++i)
+        local_accum += feat[perm[i] * dim + col];
+      out[row * dim + col] += local_accum;
+      col += gridDim.y * blockDim.x;
+    }
+  }
+}
+
+/*!
+ * \brief CUDA kernel computing the start of every segment of a sorted array,
+ *        i.e. offsets[i] is the first position whose value is not less than i.
+ */
+template <typename IdType>
+__global__ void _SortedSegmentOffsetsKernel(
+    const IdType *sorted, int64_t n, int64_t num_segments, IdType *offsets) {
+  int64_t tx = blockIdx.x * blockDim.x + threadIdx.x;
+  const int64_t stride_x = gridDim.x * blockDim.x;
+  while (tx <= num_segments) {
+    int64_t lo = 0, hi = n;
+    while (lo < hi) {
+      const int64_t mid = (lo + hi) >> 1;
+      if (sorted[mid] < tx) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    offsets[tx] = lo;
+    tx += stride_x;
+  }
+}
+
 /*!
  * \brief CUDA kernel to update gradients for reduce op max/min
  * \note each WARP (group of 32 threads) is responsible for adding a row in
@@ -100,10 +278,11 @@ template <typename IdType, typename DType>
 __global__ void BackwardSegmentCmpKernel(
     const DType *feat, const IdType *arg, DType *out,
     int64_t n, int64_t dim) {
-  for (int row = blockIdx.x; row < n; row += gridDim.x) {
-    int col = blockIdx.y * blockDim.x + threadIdx.x;
+  for (int64_t row = blockIdx.x * blockDim.y + threadIdx.y; row < n;
+       row += gridDim.x * blockDim.y) {
+    int64_t col = blockIdx.y * blockDim.x + threadIdx.x;
     while (col < dim) {
-      int write_row = arg[row * dim + col];
+      const int64_t write_row = arg[row * dim + col];
       if (write_row >= 0) {
         out[write_row * dim + col] = feat[row * dim + col];
       }
@@ -135,18 +314,99 @@ void SegmentReduce(
   int64_t dim = 1;
   for (int i = 1; i < out->ndim; ++i)
     dim *= out->shape[i];
+  if (n == 0 || dim == 0)
+    return;
+
+  // the kernel is chosen by the average segment length, which is known
+  // without reading the offsets back from the device
+  const int64_t avg_length = feat->shape[0] / n;
+  if (avg_length >= kSegmentBlockMinLength) {
+    const int ntx = std::min(32, FindNumThreads(dim));
+    const int nty = kSegmentNumThreads / ntx;
+    const dim3 nblks(FindNumBlocks<'x'>(n), FindNumBlocks<'y'>((dim + ntx - 1) / ntx));
+    const dim3 nthrs(ntx, nty);
+    const size_t smem_size = ntx * nty * (sizeof(IdType) + sizeof(DType));
+    CUDA_KERNEL_CALL((SegmentReduceBlockKernel<IdType, DType, ReduceOp>),
+        nblks, nthrs, smem_size, thr_entry->stream,
+        feat_data, offsets_data, out_data, arg_data,
+        n, dim);
+  } else if (avg_length >= kSegmentWarpMinLength && dim < 32) {
+    const int nty = kSegmentNumThreads / 32;
+    const dim3 nblks(FindNumBlocks<'x'>((n + nty - 1) / nty));
+    const dim3 nthrs(32, nty);
+    CUDA_KERNEL_CALL((SegmentReduceWarpKernel<IdType, DType, ReduceOp>),
+        nblks, nthrs, 0, thr_entry->stream,
+        feat_data, offsets_data, out_data, arg_data,
+        n, dim);
+  } else {
+    dim3 nblks, nthrs;
+    RowwiseLaunchConfig(n, dim, &nblks, &nthrs);
+    CUDA_KERNEL_CALL((SegmentReduceKernel<IdType, DType, ReduceOp>),
+        nblks, nthrs, 0, thr_entry->stream,
+        feat_data, offsets_data, out_data, arg_data,
+        n, dim);
+  }
+}
+
+/*!
+ * \brief Deterministic CUDA implementation of Scatter Add (on first dimension).
+ * \note the rows are sorted by target index, then every output row is reduced
+ *       by SortedScatterAddKernel in the same order on every run.
+ * \param feat The input tensor.
+ * \param idx The indices tensor.
+ * \param out The output tensor.
+ */
+template <typename IdType, typename DType>
+void SortedScatterAdd(
+    NDArray feat,
+    NDArray idx,
+    NDArray out) {
+  const DType* feat_data = feat.Ptr<DType>();
+  const IdType* idx_data = idx.Ptr<IdType>();
+  DType *out_data = out.Ptr<DType>();
+
+  auto *thr_entry = runtime::CUDAThreadEntry::ThreadLocal();
+  const DLContext ctx = feat->ctx;
+  auto device = runtime::DeviceAPI::Get(ctx);
+  const int64_t n = feat->shape[0], m = out->shape[0];
+  int64_t dim = 1;
+  for (int i = 1; i < out->ndim; ++i)
+    dim *= out->shape[i];
+  if (n == 0 || m == 0 || dim == 0)
+    return;
+
+  IdArray rows = aten::Range(0, n, sizeof(IdType) * 8, ctx);
+  IdType* sorted_idx = static_cast<IdType*>(device->AllocWorkspace(ctx, n * sizeof(IdType)));
+  IdType* perm = static_cast<IdType*>(device->AllocWorkspace(ctx, n * sizeof(IdType)));
+  IdType* offsets = static_cast<IdType*>(device->AllocWorkspace(ctx, (m + 1) * sizeof(IdType)));
+  size_t workspace_size = 0;
+  CUDA_CALL(cub::DeviceRadixSort::SortPairs(nullptr, workspace_size,
+      idx_data, sorted_idx, rows.Ptr<IdType>(), perm, n,
+      0, sizeof(IdType) * 8, thr_entry->stream));
+  void* workspace = device->AllocWorkspace(ctx, workspace_size);
+  CUDA_CALL(cub::DeviceRadixSort::SortPairs(workspace, workspace_size,
+      idx_data, sorted_idx, rows.Ptr<IdType>(), perm, n,
+      0, sizeof(IdType) * 8, thr_entry->stream));
+  device->FreeWorkspace(ctx, workspace);
+
+  const int nt = FindNumThreads(m + 1);
+  const int nb = FindNumBlocks<'x'>((m + nt) / nt);
+  CUDA_KERNEL_CALL((_SortedSegmentOffsetsKernel<IdType>),
+      nb, nt, 0, thr_entry->stream,
+      sorted_idx, n, m, offsets);
 
-  const int nbx = FindNumBlocks<'x'>(n);
+  const int nbx = FindNumBlocks<'x'>(m);
   const int ntx = FindNumThreads(dim);
   const int nby = FindNumBlocks<'y'>((dim + ntx - 1) / ntx);
-  const int nty = 1;
   const dim3 nblks(nbx, nby);
-  const dim3 nthrs(ntx, nty);
-  // TODO(zihao): try cub's DeviceSegmentedReduce and compare the performance.
-  CUDA_KERNEL_CALL((SegmentReduceKernel<IdType, DType, ReduceOp>),
+  const dim3 nthrs(ntx, 1);
+  CUDA_KERNEL_CALL((SortedScatterAddKernel<IdType, DType>),
       nblks, nthrs, 0, thr_entry->stream,
-      feat_data, offsets_data, out_data, arg_data,
-      n, dim);
+      feat_data, perm, offsets, out_data,
+      m, dim);
+  device->FreeWorkspace(ctx, offsets);
+  device->FreeWorkspace(ctx, perm);
+  device->FreeWorkspace(ctx, sorted_idx);
 }
 
 /*!
@@ -171,12 +431,13 @@ void ScatterAdd(
   for (int i = 1; i < out->ndim; ++i)
     dim *= out->shape[i];
 
-  const int nbx = FindNumBlocks<'x'>(n);
-  const int ntx = FindNumThreads(dim);
-  const int nby = FindNumBlocks<'y'>((dim + ntx - 1) / ntx);
-  const int nty = 1;
-  const dim3 nblks(nbx, nby);
-  const dim3 nthrs(ntx, nty);
+  if (DeterministicEnabled()) {
+    SortedScatterAdd<IdType, DType>(feat, idx, out);
+    return;
+  }
+
+  dim3 nblks, nthrs;
+  RowwiseLaunchConfig(n, dim, &nblks, &nthrs);
   CUDA_KERNEL_CALL((ScatterAddKernel<IdType, DType>),
                    nblks, nthrs, 0, thr_entry->stream,
                    feat_data, idx_data, out_data,
@@ -257,12 +518,8 @@ void BackwardSegmentCmp(
   for (int i = 1; i < out->ndim; ++i)
     dim *= out->shape[i];
 
-  const int nbx = FindNumBlocks<'x'>(n);
-  const int ntx = FindNumThreads(dim);
-  const int nby = FindNumBlocks<'y'>((dim + ntx - 1) / ntx);
-  const int nty = 1;
-  const dim3 nblks(nbx, nby);
-  const dim3 nthrs(ntx, nty);
+  dim3 nblks, nthrs;
+  RowwiseLaunchConfig(n, dim, &nblks, &nthrs);
   CUDA_KERNEL_CALL((BackwardSegmentCmpKernel<IdType, DType>),
                    nblks, nthrs, 0, thr_entry->stream,
                    feat_data, arg_data, out_data,
@@ -0,0 +1,164 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file array/cuda/sparse_optim.cu
+ * \brief Sparse optimizer updates of embedding rows on GPU.
+ */
+#include <dgl/array.h>
+#include "../../runtime/cuda/cuda_common.h"
+#include "../kernel_decl.h"
+#include "./utils.h"
+
+namespace dgl {
+namespace aten {
+
+namespace {
+
+/*! \brief The block of threads updating block.y rows, block.x threads a row. */
+dim3 RowBlock(int64_t dim) {
+  dim3 block(256, 1);
+  while (static_cast<int64_t>(block.x) >= 2 * dim) {
+    block.x /= 2;
+    block.y *= 2;
+  }
+  return block;
+}
+
+/*!
+ * \brief CUDA kernel of the sparse Adagrad update of the rows idx, whose
+ *        gradients are summed over counts[i] occurrences if counts is not null.
+ * \note The weight and the state can be in pinned host memory.
+ */
+template <typename IdType, typename DType>
+__global__ void _SparseAdagradKernel(
+    DType* __restrict__ weight, DType* __restrict__ state,
+    const IdType* __restrict__ idx, const DType* __restrict__ grad,
+    const IdType* __restrict__ counts, int64_t n, int64_t num_rows, int64_t dim,
+    DType lr, DType eps) {
+  int64_t i = blockIdx.x * blockDim.y + threadIdx.y;
+  const int64_t stride = gridDim.x * blockDim.y;
+  while (i < n) {
+    const int64_t row = idx[i];
+    assert(row >= 0 && row < num_rows);
+    const DType scale = counts ? DType(1) / counts[i] : DType(1);
+    for (int64_t j = threadIdx.x; j < dim; j += blockDim.x) {
+      const DType g = grad[i * dim + j] * scale;
+      const DType s = state[row * dim + j] + g * g;
+      state[row * dim + j] = s;
+      weight[row * dim + j] -= lr * g / sqrt(s + eps);
+    }
+    i += stride;
+  }
+}
+
+/*! \brief CUDA kernel increasing the step of the rows idx. */
+template <typename IdType, typename DType>
+__global__ void _IncrementStepKernel(
+    DType* __restrict__ step, const IdType* __restrict__ idx, int64_t n) {
+  int64_t tx = blockIdx.x * blockDim.x + threadIdx.x;
+  const int64_t stride_x = gridDim.x * blockDim.x;
+  while (tx < n) {
+    step[idx[tx]] += 1;
+    tx += stride_x;
+  }
+}
+
+/*!
+ * \brief CUDA kernel of the sparse Adam update of the rows idx, whose steps
+ *        are already increased, and whose gradients are summed over counts[i]
+ *        occurrences if counts is not null.
+ * \note The weight and the states can be in pinned host memory.
+ */
+template <typename IdType, typename DType>
+__global__ void _SparseAdamKernel(
+    DType* __restrict__ weight, const DType* __restrict__ step,
+    DType* __restrict__ mem, DType* __restrict__ power,
+    const IdType* __restrict__ idx, const DType* __restrict__ grad,
+    const IdType* __restrict__ counts, int64_t n, int64_t num_rows, int64_t dim,
+    DType lr, DType beta1, DType beta2, DType eps) {
+  int64_t i = blockIdx.x * blockDim.y + threadIdx.y;
+  const int64_t stride = gridDim.x * blockDim.y;
+  while (i < n) {
+    const int64_t row = idx[i];
+    assert(row >= 0 && row < num_rows);
+    const DType scale = counts ? DType(1) / counts[i] : DType(1);
+    const DType mem_corr = 1 - pow(beta1, step[row]);
+    const DType power_corr = 1 - pow(beta2, step[row]);
+    for (int64_t j = threadIdx.x; j < dim; j += blockDim.x) {
+      const DType g = grad[i * dim + j] * scale;
+      const DType m = beta1 * mem[row * dim + j] + (1 - beta1) * g;
+      const DType p = beta2 * power[row * dim + j] + (1 - beta2) * g * g;
+      mem[row * dim + j] = m;
+      power[row * dim + j] = p;
+      weight[row * dim + j] -= lr * (m / mem_corr) / (sqrt(p / power_corr) + eps);
+    }
+    i += stride;
+  }
+}
+
+};  // namespace
+
+template <int XPU, typename IdType, typename DType>
+void SparseAdagradUpdate(
+    NDArray weight, NDArray state, IdArray idx, NDArray grad, IdArray counts,
+    double lr, double eps) {
+  const int64_t n = idx->shape[0];
+  if (n == 0)
+    return;
+  const int64_t num_rows = weight->shape[0];
+  const int64_t dim = weight.NumElements() / num_rows;
+  auto* thr_entry = runtime::CUDAThreadEntry::ThreadLocal();
+  const dim3 block = RowBlock(dim);
+  const dim3 grid((n + block.y - 1) / block.y);
+  CUDA_KERNEL_CALL((_SparseAdagradKernel<IdType, DType>), grid, block, 0, thr_entry->stream,
+      weight.Ptr<DType>(), state.Ptr<DType>(), idx.Ptr<IdType>(), grad.Ptr<DType>(),
+      IsNullArray(counts) ? nullptr : counts.Ptr<IdType>(), n, num_rows, dim,
+      static_cast<DType>(lr), static_cast<DType>(eps));
+}
+
+template <int XPU, typename IdType, typename DType>
+void SparseAdamUpdate(
+    NDArray weight, NDArray step, NDArray mem, NDArray power, IdArray idx,
+    NDArray grad, IdArray counts, double lr, double beta1, double beta2, double eps) {
+  const int64_t n = idx->shape[0];
+  if (n == 0)
+    return;
+  const int64_t num_rows = weight->shape[0];
+  const int64_t dim = weight.NumElements() / num_rows;
+  auto* thr_entry = runtime::CUDAThreadEntry::ThreadLocal();
+  const int nt = cuda::FindNumThreads(n);
+  const int nb = (n + nt - 1) / nt;
+  CUDA_KERNEL_CALL((_IncrementStepKernel<IdType, DType>), nb, nt, 0, thr_entry->stream,
+      step.Ptr<DType>(), idx.Ptr<IdType>(), n);
+  const dim3 block = RowBlock(dim);
+  const dim3 grid((n + block.y - 1) / block.y);
+  CUDA_KERNEL_CALL((_SparseAdamKernel<IdType, DType>), grid, block, 0, thr_entry->stream,
+      weight.Ptr<DType>(), step.Ptr<DType>(), mem.Ptr<DType>(), power.Ptr<DType>(),
+      idx.Ptr<IdType>(), grad.Ptr<DType>(),
+      IsNullArray(counts) ? nullptr : counts.Ptr<IdType>(), n, num_rows, dim,
+      static_cast<DType>(lr), static_cast<DType>(beta1), static_cast<DType>(beta2),
+      static_cast<DType>(eps));
+}
+
+template void SparseAdagradUpdate<kDLGPU, int32_t, float>(
+    NDArray, NDArray, IdArray, NDArray, IdArray, double, double);
+template void SparseAdagradUpdate<kDLGPU, int64_t, float>(
+    NDArray, NDArray, IdArray, NDArray, IdArray, double, double);
+template void SparseAdagradUpdate<kDLGPU, int32_t, double>(
+    NDArray, NDArray, IdArray, NDArray, IdArray, double, double);
+template void SparseAdagradUpdate<kDLGPU, int64_t, double>(
+    NDArray, NDArray, IdArray, NDArray, IdArray, double, double);
+template void SparseAdamUpdate<kDLGPU, int32_t, float>(
+    NDArray, NDArray, NDArray, NDArray, IdArray, NDArray, IdArray,
+    double, double, double, double);
+template void SparseAdamUpdate<kDLGPU, int64_t, float>(
+    NDArray, NDArray, NDArray, NDArray, IdArray, NDArray, IdArray,
+    double, double, double, double);
+template void SparseAdamUpdate<kDLGPU, int32_t, double>(
+    NDArray, NDArray, NDArray, NDArray, IdArray, NDArray, IdArray,
+    double, double, double, double);
+template void SparseAdamUpdate<kDLGPU, int64_t, double>(
+    NDArray, NDArray, NDArray, NDArray, IdArray, NDArray, IdArray,
+    double, double, double, double);
+
+}  // namespace aten
+}  // namespace dgl
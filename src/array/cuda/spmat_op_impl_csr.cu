@@ -8,7 +8,9 @@
 #include <unordered_set>
 #include <numeric>
 #include "../../runtime/cuda/cuda_common.h"
+#include "../array_op.h"
 #include "./utils.h"
+#include "./dgl_cub.cuh"
 
 namespace dgl {
 
@@ -21,21 +23,13 @@ namespace impl {
 
 template <DLDeviceType XPU, typename IdType>
 bool CSRIsNonZero(CSRMatrix csr, int64_t row, int64_t col) {
-  auto* thr_entry = runtime::CUDAThreadEntry::ThreadLocal();
   const auto& ctx = csr.indptr->ctx;
   IdArray rows = aten::VecToIdArray<int64_t>({row}, sizeof(IdType) * 8, ctx);
   IdArray cols = aten::VecToIdArray<int64_t>({col}, sizeof(IdType) * 8, ctx);
   rows = rows.CopyTo(ctx);
   cols = cols.CopyTo(ctx);
-  IdArray out = aten::NewIdArray(1, ctx, sizeof(IdType) * 8);
-  const IdType* data = nullptr;
-  // TODO(minjie): use binary search for sorted csr
-  CUDA_KERNEL_CALL(cuda::_LinearSearchKernel,
-      1, 1, 0, thr_entry->stream,
-      csr.indptr.Ptr<IdType>(), csr.indices.Ptr<IdType>(), data,
-      rows.Ptr<IdType>(), cols.Ptr<IdType>(),
-      1, 1, 1,
-      static_cast<IdType*>(nullptr), static_cast<IdType>(-1), out.Ptr<IdType>());
+  // binary searched in the sorted rows
+  IdArray out = CSRGetData<XPU, IdType>(csr, rows, cols);
   out = out.CopyTo(DLContext{kDLCPU, 0});
   return *out.Ptr<IdType>() != -1;
 }
@@ -45,26 +39,8 @@ template bool CSRIsNonZero<kDLGPU, int64_t>(CSRMatrix, int64_t, int64_t);
 
 template <DLDeviceType XPU, typename IdType>
 NDArray CSRIsNonZero(CSRMatrix csr, NDArray row, NDArray col) {
-  const auto rowlen = row->shape[0];
-  const auto collen = col->shape[0];
-  const auto rstlen = std::max(rowlen, collen);
-  NDArray rst = NDArray::Empty({rstlen}, row->dtype, row->ctx);
-  if (rstlen == 0)
-    return rst;
-  const int64_t row_stride = (rowlen == 1 && collen != 1) ? 0 : 1;
-  const int64_t col_stride = (collen == 1 && rowlen != 1) ? 0 : 1;
-  auto* thr_entry = runtime::CUDAThreadEntry::ThreadLocal();
-  const int nt = cuda::FindNumThreads(rstlen);
-  const int nb = (rstlen + nt - 1) / nt;
-  const IdType* data = nullptr;
-  // TODO(minjie): use binary search for sorted csr
-  CUDA_KERNEL_CALL(cuda::_LinearSearchKernel,
-      nb, nt, 0, thr_entry->stream,
-      csr.indptr.Ptr<IdType>(), csr.indices.Ptr<IdType>(), data,
-      row.Ptr<IdType>(), col.Ptr<IdType>(),
-      row_stride, col_stride, rstlen,
-      static_cast<IdType*>(nullptr), static_cast<IdType>(-1), rst.Ptr<IdType>());
-  return rst != -1;
+  // binary searched in the sorted rows
+  return CSRGetData<XPU, IdType>(csr, row, col) != -1;
 }
 
 template NDArray CSRIsNonZero<kDLGPU, int32_t>(CSRMatrix, NDArray, NDArray);
@@ -499,6 +475,140 @@ template CSRMatrix CSRSliceMatrix<kDLGPU, int32_t>(
 template CSRMatrix CSRSliceMatrix<kDLGPU, int64_t>(
     CSRMatrix csr, runtime::NDArray rows, runtime::NDArray cols);
 
+///////////////////////////// CSRSliceMatrixBatched /////////////////////////////
+
+/*! \brief Find the block of the row r, i.e. the last one whose offset is at most r. */
+template <typename IdType>
+__device__ __forceinline__ int64_t _FindBlock(
+    const IdType* offsets, int64_t num_blocks, IdType r) {
+  int64_t lo = 0, hi = num_blocks - 1;
+  while (lo < hi) {
+    const int64_t mid = (lo + hi + 1) >> 1;
+    if (offsets[mid] <= r)
+      lo = mid;
+    else
+      hi = mid - 1;
+  }
+  return lo;
+}
+
+/*! \brief Find the position of the col c in the sorted cols of a block, or -1. */
+template <typename IdType>
+__device__ __forceinline__ IdType _FindCol(
+    const IdType* sorted_cols, const IdType* sorted_pos, IdType begin, IdType end, IdType c) {
+  const IdType last = end;
+  while (begin < end) {
+    const IdType mid = begin + ((end - begin) >> 1);
+    if (sorted_cols[mid] < c)
+      begin = mid + 1;
+    else
+      end = mid;
+  }
+  return (begin < last && sorted_cols[begin] == c) ? sorted_pos[begin] : -1;
+}
+
+/*!
+ * \brief Count the entries of every row of the blocks whose column is in the
+ *        cols of its block, or write them if out_indptr is given.
+ */
+template <typename IdType>
+__global__ void _BlockSliceKernel(
+    const IdType* indptr, const IdType* indices, const IdType* data,
+    const IdType* rows, int64_t num_rows,
+    const IdType* row_offsets, const IdType* col_offsets, int64_t num_blocks,
+    const IdType* sorted_cols, const IdType* sorted_pos,
+    IdType* count, const IdType* out_indptr, IdType* out_indices, IdType* out_data) {
+  int64_t tx = blockIdx.x * blockDim.x + threadIdx.x;
+  const int64_t stride_x = gridDim.x * blockDim.x;
+  while (tx < num_rows) {
+    const int64_t i = _FindBlock(row_offsets, num_blocks, static_cast<IdType>(tx));
+    const IdType row = rows[tx];
+    IdType pos = out_indptr ? out_indptr[tx] : 0;
+    for (IdType k = indptr[row]; k < indptr[row + 1]; ++k) {
+      const IdType c = _FindCol(sorted_cols, sorted_pos,
+                                col_offsets[i], col_offsets[i + 1], indices[k]);
+      if (c == -1)
+        continue;
+      if (out_indptr) {
+        out_indices[pos] = c;
+        out_data[pos] = data ? data[k] : k;
+      }
+      ++pos;
+    }
+    if (!out_indptr)
+      count[tx] = pos;
+    tx += stride_x;
+  }
+}
+
+template <DLDeviceType XPU, typename IdType>
+CSRMatrix CSRSliceMatrixBatched(CSRMatrix csr, NDArray rows, NDArray row_offsets,
+                                NDArray cols, NDArray col_offsets) {
+  auto* thr_entry = runtime::CUDAThreadEntry::ThreadLocal();
+  auto device = runtime::DeviceAPI::Get(rows->ctx);
+  const auto& ctx = rows->ctx;
+  const auto& dtype = rows->dtype;
+  const auto nbits = dtype.bits;
+  const int64_t num_blocks = row_offsets->shape[0] - 1;
+  const int64_t new_nrows = rows->shape[0];
+  const int64_t new_ncols = cols->shape[0];
+
+  if (new_nrows == 0 || new_ncols == 0)
+    return CSRMatrix(new_nrows, new_ncols,
+                     Full(0, new_nrows + 1, nbits, ctx),
+                     NullArray(dtype, ctx), NullArray(dtype, ctx));
+
+  // sort the cols of every block, with their positions
+  IdArray sorted_cols = NewIdArray(new_ncols, ctx, nbits);
+  IdArray pos = Range(0, new_ncols, nbits, ctx);
+  IdArray sorted_pos = NewIdArray(new_ncols, ctx, nbits);
+  const IdType* offsets = col_offsets.Ptr<IdType>();
+  size_t workspace_size = 0;
+  CUDA_CALL(cub::DeviceSegmentedRadixSort::SortPairs(nullptr, workspace_size,
+      cols.Ptr<IdType>(), sorted_cols.Ptr<IdType>(), pos.Ptr<IdType>(), sorted_pos.Ptr<IdType>(),
+      new_ncols, num_blocks, offsets, offsets + 1, 0, sizeof(IdType) * 8, thr_entry->stream));
+  void* workspace = device->AllocWorkspace(ctx, workspace_size);
+  CUDA_CALL(cub::DeviceSegmentedRadixSort::SortPairs(workspace, workspace_size,
+      cols.Ptr<IdType>(), sorted_cols.Ptr<IdType>(), pos.Ptr<IdType>(), sorted_pos.Ptr<IdType>(),
+      new_ncols, num_blocks, offsets, offsets + 1, 0, sizeof(IdType) * 8, thr_entry->stream));
+  device->FreeWorkspace(ctx, workspace);
+
+  const IdType* data = CSRHasData(csr) ? csr.data.Ptr<IdType>() : nullptr;
+  const int nt = cuda::FindNumThreads(new_nrows);
+  const int nb = (new_nrows + nt - 1) / nt;
+  IdArray count = NewIdArray(new_nrows, ctx, nbits);
+  CUDA_KERNEL_CALL(_BlockSliceKernel,
+      nb, nt, 0, thr_entry->stream,
+      csr.indptr.Ptr<IdType>(), csr.indices.Ptr<IdType>(), data,
+      rows.Ptr<IdType>(), new_nrows,
+      row_offsets.Ptr<IdType>(), offsets, num_blocks,
+      sorted_cols.Ptr<IdType>(), sorted_pos.Ptr<IdType>(),
+      count.Ptr<IdType>(), static_cast<IdType*>(nullptr),
+      static_cast<IdType*>(nullptr), static_cast<IdType*>(nullptr));
+  IdArray ret_indptr = CumSum(count, true);
+
+  // the only synchronization with the host
+  const int64_t nnz = IndexSelect<IdType>(ret_indptr, new_nrows);
+  IdArray ret_indices = NewIdArray(nnz, ctx, nbits);
+  IdArray ret_data = NewIdArray(nnz, ctx, nbits);
+  if (nnz > 0) {
+    CUDA_KERNEL_CALL(_BlockSliceKernel,
+        nb, nt, 0, thr_entry->stream,
+        csr.indptr.Ptr<IdType>(), csr.indices.Ptr<IdType>(), data,
+        rows.Ptr<IdType>(), new_nrows,
+        row_offsets.Ptr<IdType>(), offsets, num_blocks,
+        sorted_cols.Ptr<IdType>(), sorted_pos.Ptr<IdType>(),
+        static_cast<IdType*>(nullptr), ret_indptr.Ptr<IdType>(),
+        ret_indices.Ptr<IdType>(), ret_data.Ptr<IdType>());
+  }
+  return CSRMatrix(new_nrows, new_ncols, ret_indptr, ret_indices, ret_data);
+}
+
+template CSRMatrix CSRSliceMatrixBatched<kDLGPU, int32_t>(
+    CSRMatrix, NDArray, NDArray, NDArray, NDArray);
+template CSRMatrix CSRSliceMatrixBatched<kDLGPU, int64_t>(
+    CSRMatrix, NDArray, NDArray, NDArray, NDArray);
+
 }  // namespace impl
 }  // namespace aten
 }  // namespace dgl
@@ -4,10 +4,21 @@
  * \brief SPMM C APIs and definitions.
  */
 #include <dgl/array.h>
+#include <dgl/aten/degree_stats.h>
+#include <dgl/aten/kernel_plan.h>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
 #include "./spmm.cuh"
 #include "./ge_spmm.cuh"
+#include "./spmm_blocked_ell.cuh"
 #include "./functor.cuh"
+#include "./dgl_cub.cuh"
 #include "../../runtime/cuda/cuda_common.h"
+#include "../../runtime/cuda/cuda_graph.h"
 
 namespace dgl {
 
@@ -129,21 +140,126 @@ __global__ void _IndexSelectKernel(const DType* array, const IdType* index,
  *    not be applied to float16 dtype.
  */
 template<typename DType, typename IdType>
-NDArray _IndexSelect(NDArray array, NDArray index) {
+DType* _IndexSelect(NDArray array, NDArray index) {
   auto* thr_entry = runtime::CUDAThreadEntry::ThreadLocal();
   const DType* array_data = static_cast<DType*>(array->data);
   const IdType* idx_data = static_cast<IdType*>(index->data);
-  const int64_t arr_len = array->shape[0];
   const int64_t len = index->shape[0];
-  NDArray ret = NDArray::Empty({len}, array->dtype, array->ctx);
+  // a workspace rather than an array, to be owned by the CUDA graph capturing
+  // the kernel if any; the caller frees it
+  auto device = runtime::DeviceAPI::Get(array->ctx);
+  DType* ret_data = static_cast<DType*>(
+      device->AllocWorkspace(array->ctx, len * sizeof(DType)));
   if (len == 0)
-    return ret;
-  DType* ret_data = static_cast<DType*>(ret->data);
+    return ret_data;
   const int nt = FindNumThreads(len);
   const int nb = (len + nt - 1) / nt;
   CUDA_KERNEL_CALL(_IndexSelectKernel, nb, nt, 0, thr_entry->stream,
       array_data, idx_data, len, ret_data);
-  return ret;
+  return ret_data;
+}
+
+/*! \brief Minimum largest degree for which the load-balanced SpMM is used. */
+constexpr int64_t kSpMMBalancedMinMaxDegree = 4096;
+/*! \brief Minimum ratio of the largest degree to the average one. */
+constexpr int64_t kSpMMBalancedMinSkew = 32;
+/*! \brief Minimum number of non-zeros computed by one thread. */
+constexpr int64_t kSpMMBalancedMinChunkSize = 32;
+
+template <typename IdType>
+__global__ void _CsrDegreeKernel(
+    const IdType* __restrict__ indptr,
+    int64_t num_rows,
+    IdType* __restrict__ degrees) {
+  int64_t tx = blockIdx.x * blockDim.x + threadIdx.x;
+  const int64_t stride_x = gridDim.x * blockDim.x;
+  while (tx < num_rows) {
+    degrees[tx] = indptr[tx + 1] - indptr[tx];
+    tx += stride_x;
+  }
+}
+
+/*!
+ * \brief Compute the largest degree of a Csr matrix on GPU, when there is no
+ *        plan cache to keep the degree statistics in.
+ */
+template <typename IdType>
+int64_t _ComputeMaxDegree(const CSRMatrix& csr) {
+  auto* thr_entry = runtime::CUDAThreadEntry::ThreadLocal();
+  const auto& ctx = csr.indptr->ctx;
+  auto device = runtime::DeviceAPI::Get(ctx);
+  const int64_t num_rows = csr.num_rows;
+  IdType* degrees = static_cast<IdType*>(
+      device->AllocWorkspace(ctx, num_rows * sizeof(IdType)));
+  IdType* max_degree = static_cast<IdType*>(device->AllocWorkspace(ctx, sizeof(IdType)));
+  const int nt = FindNumThreads(num_rows);
+  const int nb = (num_rows + nt - 1) / nt;
+  CUDA_KERNEL_CALL(_CsrDegreeKernel, nb, nt, 0, thr_entry->stream,
+      csr.indptr.Ptr<IdType>(), num_rows, degrees);
+  size_t workspace_size = 0;
+  CUDA_CALL(cub::DeviceReduce::Max(nullptr, workspace_size,
+      degrees, max_degree, num_rows, thr_entry->stream));
+  void* workspace = device->AllocWorkspace(ctx, workspace_size);
+  CUDA_CALL(cub::DeviceReduce::Max(workspace, workspace_size,
+      degrees, max_degree, num_rows, thr_entry->stream));
+  IdType cpu_max_degree = 0;
+  runtime::CheckNotCapturing(thr_entry->stream, "Computing the degree statistics of SpMM");
+  device->CopyDataFromTo(max_degree, 0, &cpu_max_degree, 0,
+      sizeof(cpu_max_degree),
+      ctx,
+      DGLContext{kDLCPU, 0},
+      csr.indptr->dtype,
+      thr_entry->stream);
+  device->StreamSync(ctx, thr_entry->stream);
+  device->FreeWorkspace(ctx, workspace);
+  device->FreeWorkspace(ctx, max_degree);
+  device->FreeWorkspace(ctx, degrees);
+  return cpu_max_degree;
+}
+
+/*!
+ * \brief Choose the number of non-zeros per thread of the load-balanced SpMM
+ *        on Csr format.
+ * \return The chunk size, or 0 if the degrees are even enough for the
+ *         row-parallel kernel.
+ */
+template <typename IdType>
+int64_t _BalancedChunkSize(const CSRMatrix& csr, KernelPlanCache* plan_cache) {
+  const int64_t nnz = csr.indices->shape[0];
+  // the cut rows of the load-balanced SpMM are reduced with atomics
+  if (csr.num_rows == 0 || nnz < kSpMMBalancedMinMaxDegree || dgl::cuda::DeterministicEnabled())
+    return 0;
+  // the degree statistics are shared with the other kernels on the matrix
+  const int64_t max_degree = plan_cache ?
+    CSRGetDegreeStats(csr, plan_cache)->max_degree : _ComputeMaxDegree<IdType>(csr);
+  const int64_t avg_degree = (nnz + csr.num_rows - 1) / csr.num_rows;
+  if (max_degree < kSpMMBalancedMinMaxDegree ||
+      max_degree < kSpMMBalancedMinSkew * avg_degree)
+    return 0;
+  return std::max(avg_degree, kSpMMBalancedMinChunkSize);
+}
+
+/*!
+ * \brief Call the load-balanced SpMM on Csr format if chunk_size is positive,
+ *        GE-SpMM if it applies, and the row-parallel one otherwise.
+ */
+template <typename IdType, typename DType, typename Op,
+          template <typename, typename, bool> class Reduce>
+void _SpMMCsr(const BcastOff& bcast, const CSRMatrix& csr,
+              NDArray ufeat, NDArray efeat,
+              NDArray out, NDArray argu, NDArray arge,
+              int64_t chunk_size) {
+  if (chunk_size > 0) {
+    cuda::SpMMCsrBalanced<IdType, DType, Op,
+                          Reduce<IdType, DType, false>, Reduce<IdType, DType, true> >(
+        bcast, csr, ufeat, efeat, out, argu, arge, chunk_size);
+  } else if (cuda::GESpMMApplicable(bcast)) {
+    cuda::GESpMMCsr<IdType, DType, Op, Reduce<IdType, DType, false> >(
+        bcast, csr, ufeat, efeat, out, argu, arge);
+  } else {
+    cuda::SpMMCsr<IdType, DType, Op, Reduce<IdType, DType, false> >(
+        bcast, csr, ufeat, efeat, out, argu, arge);
+  }
 }
 
 }  // namespace
@@ -184,6 +300,144 @@ cusparseStatus_t Xcsrmm2<double>(cusparseHandle_t handle, cusparseOperation_t tr
 }
 #endif
 
+#if CUDART_VERSION >= 11000
+/*!
+ * \brief Persistent state of cusparseSpMM for one Csr matrix and feature width.
+ *
+ * The descriptors and the external buffer only depend on the sparse structure
+ * and the shapes, so they are created on the first call, cached in the plan
+ * cache of the matrix, and reused; the dense matrices and the edge values are
+ * reset on every call.
+ */
+template <typename DType, typename IdType>
+class CusparseSpMMPlan {
+ public:
+  /*! \brief The compute type; half features are accumulated in float. */
+  typedef typename std::conditional<
+    std::is_same<DType, half>::value, float, DType>::type AccType;
+
+  CusparseSpMMPlan(const DLContext& ctx, const CSRMatrix& csr, int64_t x_length)
+    : ctx_(ctx), m_(csr.num_rows), k_(csr.num_cols),
+      nnz_(csr.indices->shape[0]), n_(x_length) {}
+
+  ~CusparseSpMMPlan() {
+    auto device = runtime::DeviceAPI::Get(ctx_);
+    if (matA_) {
+      CUSPARSE_CALL(cusparseDestroySpMat(matA_));
+      CUSPARSE_CALL(cusparseDestroyDnMat(matB_));
+      CUSPARSE_CALL(cusparseDestroyDnMat(matC_));
+    }
+    if (workspace_)
+      device->FreeDataSpace(ctx_, workspace_);
+    if (ones_)
+      device->FreeDataSpace(ctx_, ones_);
+  }
+
+  /*!
+   * \brief Compute C = A x B + beta * C.
+   * \param A_data The edge values, or nullptr for all ones.
+   */
+  void Run(cusparseHandle_t handle, const CSRMatrix& csr,
+           const DType* B_data, const DType* A_data, DType* C_data,
+           AccType beta) {
+    // descriptors cannot be updated and used concurrently
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto device = runtime::DeviceAPI::Get(ctx_);
+    constexpr auto dtype = cuda_dtype<DType>::value;
+    constexpr auto compute_type = cuda_dtype<AccType>::value;
+    constexpr auto idtype = cusparse_idtype<IdType>::value;
+    if (!A_data) {
+      if (!ones_) {
+        ones_ = static_cast<DType*>(device->AllocDataSpace(
+            ctx_, nnz_ * sizeof(DType), sizeof(DType), csr.indptr->dtype));
+        _Fill(ones_, nnz_, static_cast<DType>(1.));
+      }
+      A_data = ones_;
+    }
+    DType* values = const_cast<DType*>(A_data);
+    DType* B_values = const_cast<DType*>(B_data);
+    if (!matA_) {
+      CUSPARSE_CALL(cusparseCreateCsr(&matA_,
+          m_, k_, nnz_,
+          csr.indptr->data, csr.indices->data, values,
+          idtype, idtype,
+          CUSPARSE_INDEX_BASE_ZERO, dtype));
+      CUSPARSE_CALL(cusparseCreateDnMat(&matB_,
+          k_, n_, n_,
+          B_values, dtype, CUSPARSE_ORDER_ROW));
+      CUSPARSE_CALL(cusparseCreateDnMat(&matC_,
+          m_, n_, n_,
+          C_data, dtype, CUSPARSE_ORDER_ROW));
+    } else {
+      CUSPARSE_CALL(cusparseCsrSetPointers(matA_,
+          csr.indptr->data, csr.indices->data, values));
+      CUSPARSE_CALL(cusparseDnMatSetValues(matB_, B_values));
+      CUSPARSE_CALL(cusparseDnMatSetValues(matC_, C_data));
+    }
+
+    const AccType alpha = 1.0;
+    auto transA = CUSPARSE_OPERATION_NON_TRANSPOSE;
+    auto transB = CUSPARSE_OPERATION_NON_TRANSPOSE;
+    if (!workspace_ready_) {
+      size_t workspace_size = 0;
+      CUSPARSE_CALL(cusparseSpMM_bufferSize(
+          handle, transA, transB,
+          &alpha, matA_, matB_, &beta, matC_,
+          compute_type, CUSPARSE_SPMM_CSR_ALG2,
+          &workspace_size));
+      if (workspace_size > 0)
+        workspace_ = device->AllocDataSpace(ctx_, workspace_size, 256, csr.indptr->dtype);
+      workspace_ready_ = true;
+    }
+    CUSPARSE_CALL(cusparseSpMM(
+        handle, transA, transB,
+        &alpha, matA_, matB_, &beta, matC_,
+        compute_type, CUSPARSE_SPMM_CSR_ALG2,
+        workspace_));
+  }
+
+ private:
+  DLContext ctx_;
+  int64_t m_, k_, nnz_, n_;
+  cusparseSpMatDescr_t matA_ = nullptr;
+  cusparseDnMatDescr_t matB_ = nullptr, matC_ = nullptr;
+  void* workspace_ = nullptr;
+  bool workspace_ready_ = false;
+  /*! \brief The all-one edge values, used when there is no edge feature. */
+  DType* ones_ = nullptr;
+  std::mutex mutex_;
+};
+
+/*!
+ * \brief Run cusparseSpMM with the plan cached for the matrix and feature
+ *        width in plan_cache, or with a temporary plan if plan_cache is null.
+ */
+template <typename DType, typename IdType>
+void CusparseSpMM(
+    const DLContext& ctx,
+    const CSRMatrix& csr,
+    const DType* B_data, const DType* A_data,
+    DType* C_data,
+    int64_t x_length,
+    typename CusparseSpMMPlan<DType, IdType>::AccType beta,
+    cudaStream_t stream,
+    KernelPlanCache* plan_cache) {
+  typedef CusparseSpMMPlan<DType, IdType> Plan;
+  auto* thr_entry = runtime::CUDAThreadEntry::ThreadLocal();
+  // allocate cusparse handle if needed
+  if (!thr_entry->cusparse_handle) {
+    CUSPARSE_CALL(cusparseCreate(&(thr_entry->cusparse_handle)));
+  }
+  CUSPARSE_CALL(cusparseSetStream(thr_entry->cusparse_handle, stream));
+  auto make = [&]() { return std::make_shared<Plan>(ctx, csr, x_length); };
+  std::shared_ptr<Plan> plan = plan_cache ?
+    plan_cache->GetOrCreate<Plan>(
+        std::string(typeid(Plan).name()) + "_" + std::to_string(x_length), make) :
+    make();
+  plan->Run(thr_entry->cusparse_handle, csr, B_data, A_data, C_data, beta);
+}
+#endif  // CUDART_VERSION >= 11000
+
 /*! Cusparse implementation of SpMM on Csr format. */
 template <typename DType, typename IdType>
 void CusparseCsrmm2(
@@ -191,7 +445,13 @@ void CusparseCsrmm2(
     const CSRMatrix& csr,
     const DType* B_data, const DType* A_data,
     DType* C_data,
-    int x_length) {
+    int x_length,
+    KernelPlanCache* plan_cache = nullptr) {
+#if CUDART_VERSION >= 11000
+  auto* thr_entry = runtime::CUDAThreadEntry::ThreadLocal();
+  CusparseSpMM<DType, IdType>(ctx, csr, B_data, A_data, C_data, x_length,
+                              0., thr_entry->stream, plan_cache);
+#else
   // We use csrmm2 to perform following operation:
   // C = A x B, where A is a sparse matrix in csr format, B is the dense matrix for node
   // feature tensor. However, since cusparse only supports column-major, while our tensor
@@ -219,45 +479,6 @@ void CusparseCsrmm2(
     valptr = static_cast<DType*>(device->AllocWorkspace(ctx, nnz * sizeof(DType)));
     _Fill(valptr, nnz, static_cast<DType>(1.));
   }
-#if CUDART_VERSION >= 11000
-  cusparseSpMatDescr_t matA;
-  cusparseDnMatDescr_t matB, matC;
-  constexpr auto dtype = cuda_dtype<DType>::value;
-  constexpr auto idtype = cusparse_idtype<IdType>::value;
-  CUSPARSE_CALL(cusparseCreateCsr(&matA,
-      m, k, nnz,
-      static_cast<IdType*>(csr.indptr->data),
-      static_cast<IdType*>(csr.indices->data),
-      const_cast<DType*>(valptr? valptr : A_data),
-      idtype, idtype,
-      CUSPARSE_INDEX_BASE_ZERO, dtype));
-  CUSPARSE_CALL(cusparseCreateDnMat(&matB,
-      k, n, n,
-      const_cast<DType*>(B_data), dtype, CUSPARSE_ORDER_ROW));
-  CUSPARSE_CALL(cusparseCreateDnMat(&matC,
-      m, n, n,
-      C_data, dtype, CUSPARSE_ORDER_ROW));
-
-  auto transA = CUSPARSE_OPERATION_NON_TRANSPOSE;
-  auto transB = CUSPARSE_OPERATION_NON_TRANSPOSE;
-  size_t workspace_size;
-  CUSPARSE_CALL(cusparseSpMM_bufferSize(
-      thr_entry->cusparse_handle, transA, transB,
-      &alpha, matA, matB, &beta, matC,
-      dtype, CUSPARSE_SPMM_CSR_ALG2,
-      &workspace_size));
-  void* workspace = device->AllocWorkspace(ctx, workspace_size);
-  CUSPARSE_CALL(cusparseSpMM(
-      thr_entry->cusparse_handle, transA, transB,
-      &alpha, matA, matB, &beta, matC,
-      dtype, CUSPARSE_SPMM_CSR_ALG2,
-      workspace));
-  device->FreeWorkspace(ctx, workspace);
-
-  CUSPARSE_CALL(cusparseDestroySpMat(matA));
-  CUSPARSE_CALL(cusparseDestroyDnMat(matB));
-  CUSPARSE_CALL(cusparseDestroyDnMat(matC));
-#else
   // allocate matrix for temporary transposed output
   DType* trans_out = static_cast<DType*>(device->AllocWorkspace(ctx, m * n * sizeof(DType)));
 
@@ -278,9 +499,9 @@ void CusparseCsrmm2(
   // transpose the output matrix
   _Transpose(trans_out, C_data, n, m);
   device->FreeWorkspace(ctx, trans_out);
-#endif
   if (valptr)
     device->FreeWorkspace(ctx, valptr);
+#endif
 }
 
 /*! Cusparse implementation of SpMM on Csr format. */
@@ -291,7 +512,16 @@ void CusparseCsrmm2Hetero(
     const DType* B_data, const DType* A_data,
     DType* C_data,
     int64_t x_length,
-    cudaStream_t strm_id) {
+    cudaStream_t strm_id,
+    KernelPlanCache* plan_cache = nullptr) {
+  int int_maxlimit = std::numeric_limits<int>::max();
+  CHECK_GE(int_maxlimit, (csr.num_rows));
+  CHECK_GE(int_maxlimit, csr.num_cols);
+  CHECK_GE(int_maxlimit, csr.indices->shape[0]);
+#if CUDART_VERSION >= 11000
+  CusparseSpMM<DType, IdType>(ctx, csr, B_data, A_data, C_data, x_length,
+                              1., strm_id, plan_cache);
+#else
   // We use csrmm2 to perform following operation:
   // C = A x B, where A is a sparse matrix in csr format, B is the dense matrix for node
   // feature tensor. However, since cusparse only supports column-major, while our tensor
@@ -299,10 +529,6 @@ void CusparseCsrmm2Hetero(
   // C = trans(A x trans(B)).
   // Currently, we use cublasXgeam to implement transposition and allocate intermediate
   // workspace memory for this.
-  int int_maxlimit = std::numeric_limits<int>::max();
-  CHECK_GE(int_maxlimit, (csr.num_rows));
-  CHECK_GE(int_maxlimit, csr.num_cols);
-  CHECK_GE(int_maxlimit, csr.indices->shape[0]);
   const int m = csr.num_rows;
   const int n = x_length;
   const int k = csr.num_cols;
@@ -323,45 +549,6 @@ void CusparseCsrmm2Hetero(
     valptr = static_cast<DType*>(device->AllocWorkspace(ctx, nnz * sizeof(DType)));
     _Fill(valptr, nnz, static_cast<DType>(1.));
   }
-#if CUDART_VERSION >= 11000
-  cusparseSpMatDescr_t matA;
-  cusparseDnMatDescr_t matB, matC;
-  constexpr auto dtype = cuda_dtype<DType>::value;
-  constexpr auto idtype = cusparse_idtype<IdType>::value;
-  CUSPARSE_CALL(cusparseCreateCsr(&matA,
-      m, k, nnz,
-      static_cast<IdType*>(csr.indptr->data),
-      static_cast<IdType*>(csr.indices->data),
-      const_cast<DType*>(valptr? valptr : A_data),
-      idtype, idtype,
-      CUSPARSE_INDEX_BASE_ZERO, dtype));
-  CUSPARSE_CALL(cusparseCreateDnMat(&matB,
-      k, n, n,
-      const_cast<DType*>(B_data), dtype, CUSPARSE_ORDER_ROW));
-  CUSPARSE_CALL(cusparseCreateDnMat(&matC,
-      m, n, n,
-      C_data, dtype, CUSPARSE_ORDER_ROW));
-
-  auto transA = CUSPARSE_OPERATION_NON_TRANSPOSE;
-  auto transB = CUSPARSE_OPERATION_NON_TRANSPOSE;
-  size_t workspace_size;
-  CUSPARSE_CALL(cusparseSpMM_bufferSize(
-      thr_entry->cusparse_handle, transA, transB,
-      &alpha, matA, matB, &beta, matC,
-      dtype, CUSPARSE_SPMM_CSR_ALG2,
-      &workspace_size));
-  void* workspace = device->AllocWorkspace(ctx, workspace_size);
-  CUSPARSE_CALL(cusparseSpMM(
-      thr_entry->cusparse_handle, transA, transB,
-      &alpha, matA, matB, &beta, matC,
-      dtype, CUSPARSE_SPMM_CSR_ALG2,
-      workspace));
-  device->FreeWorkspace(ctx, workspace);
-
-  CUSPARSE_CALL(cusparseDestroySpMat(matA));
-  CUSPARSE_CALL(cusparseDestroyDnMat(matB));
-  CUSPARSE_CALL(cusparseDestroyDnMat(matC));
-#else
   cusparseMatDescr_t descr;
   CUSPARSE_CALL(cusparseCreateMatDescr(&descr));
   CUSPARSE_CALL(cusparseSetMatType(descr, CUSPARSE_MATRIX_TYPE_GENERAL));
@@ -377,9 +564,9 @@ void CusparseCsrmm2Hetero(
       static_cast<int32_t*>(csr.indices->data),
       B_data, n, &beta, C_data, m));
   CUSPARSE_CALL(cusparseDestroyMatDescr(descr));
-#endif
   if (valptr)
     device->FreeWorkspace(ctx, valptr);
+#endif
 }
 
 }  // namespace cusparse
@@ -420,17 +607,48 @@ inline bool cusparse_available(bool more_nnz_than_matrix_size) {
       return true;
   return false;
 #else
-  if (bits == 16)
-    return false;  // cusparse's SpMM on fp16 is slow, temporally disabled.
+  // fp16 is accumulated in fp32, see CusparseSpMMPlan.
   // If the CSR matrix has more NNZ than matrix size, we should not use cuSPARSE 11.1.
   return !more_nnz_than_matrix_size;
 #endif
 }
 
+#ifdef USE_FP16
+/*!
+ * \brief Run the sum SpMM of fp16 features on tensor cores if the matrix is
+ *        dense enough for its blocked-ELL format, kept in plan_cache.
+ * \return Whether it ran.
+ */
+template <int bits, typename IdType>
+bool _TrySpMMBlockedEll(const std::string& op, const BcastOff& bcast,
+                        const CSRMatrix& csr, NDArray ufeat, NDArray efeat,
+                        NDArray out, KernelPlanCache* plan_cache) {
+  // the tiles of the weighted matrix are summed with atomics
+  if (bits != 16 || !plan_cache || dgl::cuda::DeterministicEnabled())
+    return false;
+  const bool is_scalar_efeat = efeat.NumElements() == csr.indices->shape[0];
+  if (!(op == "copy_lhs" && !bcast.use_bcast) &&
+      !(op == "mul" && is_scalar_efeat && bcast.lhs_len == bcast.out_len))
+    return false;
+  auto plan = plan_cache->GetOrCreate<cuda::SpMMBlockedEllPlan>(
+      typeid(cuda::SpMMBlockedEllPlan).name(),
+      [&csr]() { return cuda::BuildBlockedEllPlan<IdType>(csr); });
+  if (!plan->use)
+    return false;
+  cuda::SpMMBlockedEll<IdType>(*plan, csr, ufeat,
+      op == "mul" ? efeat : NullArray(), out, bcast.out_len);
+  return true;
+}
+#endif  // USE_FP16
+
 /*!
  * \brief CUDA implementation of g-SpMM on Csr format.
  * \note use cusparse if the reduce operator is `sum` and there is
- *       no broadcast, use dgl's kernel in other cases.
+ *       no broadcast, use dgl's kernel in other cases. Dgl's kernel splits
+ *       the non-zeros instead of the rows across threads when the largest
+ *       degree is far above the average one; the degree statistics are kept
+ *       in plan_cache. The sum of fp16 features over a dense enough matrix
+ *       runs on tensor cores on its blocked-ELL format, also kept in plan_cache.
  */
 template <int XPU, typename IdType, int bits>
 void SpMMCsr(const std::string& op, const std::string& reduce,
@@ -439,13 +657,18 @@ void SpMMCsr(const std::string& op, const std::string& reduce,
              NDArray ufeat,
              NDArray efeat,
              NDArray out,
-             std::vector<NDArray> out_aux) {
+             std::vector<NDArray> out_aux,
+             KernelPlanCache* plan_cache) {
   int64_t feat_len = bcast.out_len;
   bool is_scalar_efeat = efeat.NumElements() == csr.indices->shape[0];
   bool use_efeat = op != "copy_lhs";
 
   if (reduce == "sum") {
     bool more_nnz = (csr.indices->shape[0] > csr.num_rows * csr.num_cols);
+#ifdef USE_FP16
+    if (_TrySpMMBlockedEll<bits, IdType>(op, bcast, csr, ufeat, efeat, out, plan_cache))
+      return;
+#endif  // USE_FP16
     if (op == "copy_lhs" && cusparse_available<bits, IdType>(more_nnz)) {
       // cusparse
       int64_t x_length = 1;
@@ -457,46 +680,48 @@ void SpMMCsr(const std::string& op, const std::string& reduce,
             static_cast<DType*>(ufeat->data),
             nullptr,
             static_cast<DType*>(out->data),
-            x_length);
+            x_length, plan_cache);
       });
     } else if (op == "mul" && is_scalar_efeat && cusparse_available<bits, IdType>(more_nnz)) {
       // cusparse
       int64_t x_length = 1;
       for (int i = 1; i < ufeat->ndim; ++i)
         x_length *= ufeat->shape[i];
-      if (!IsNullArray(csr.data)) {
-        SWITCH_BITS(bits, DType, {
-          efeat = _IndexSelect<DType, IdType>(efeat, csr.data);
-        });
-      }
       SWITCH_BITS(bits, DType, {
+        DType* efeat_data = IsNullArray(csr.data) ? static_cast<DType*>(efeat->data) :
+          _IndexSelect<DType, IdType>(efeat, csr.data);
         cusparse::CusparseCsrmm2<DType, IdType>(
             ufeat->ctx, csr,
             static_cast<DType*>(ufeat->data),
-            static_cast<DType*>(efeat->data),
+            efeat_data,
             static_cast<DType*>(out->data),
-            x_length);
+            x_length, plan_cache);
+        if (!IsNullArray(csr.data))
+          runtime::DeviceAPI::Get(efeat->ctx)->FreeWorkspace(efeat->ctx, efeat_data);
       });
     } else {  // general kernel
+      const int64_t chunk_size = _BalancedChunkSize<IdType>(csr, plan_cache);
       SWITCH_BITS(bits, DType, {
         SWITCH_OP(op, Op, {
-          cuda::SpMMCsr<IdType, DType, Op, cuda::reduce::Sum<IdType, DType> >(
-              bcast, csr, ufeat, efeat, out, NullArray(), NullArray());
+          _SpMMCsr<IdType, DType, Op, cuda::reduce::Sum>(
+              bcast, csr, ufeat, efeat, out, NullArray(), NullArray(), chunk_size);
         });
       });
     }
   } else if (reduce == "max") {
+    const int64_t chunk_size = _BalancedChunkSize<IdType>(csr, plan_cache);
     SWITCH_BITS(bits, DType, {
       SWITCH_OP(op, Op, {
-        cuda::SpMMCsr<IdType, DType, Op, cuda::reduce::Max<IdType, DType> >(
-            bcast, csr, ufeat, efeat, out, out_aux[0], out_aux[1]);
+        _SpMMCsr<IdType, DType, Op, cuda::reduce::Max>(
+            bcast, csr, ufeat, efeat, out, out_aux[0], out_aux[1], chunk_size);
       });
     });
   } else if (reduce == "min") {
+    const int64_t chunk_size = _BalancedChunkSize<IdType>(csr, plan_cache);
     SWITCH_BITS(bits, DType, {
       SWITCH_OP(op, Op, {
-        cuda::SpMMCsr<IdType, DType, Op, cuda::reduce::Min<IdType, DType> >(
-            bcast, csr, ufeat, efeat, out, out_aux[0], out_aux[1]);
+        _SpMMCsr<IdType, DType, Op, cuda::reduce::Min>(
+            bcast, csr, ufeat, efeat, out, out_aux[0], out_aux[1], chunk_size);
       });
     });
   } else {
@@ -518,10 +743,13 @@ void SpMMCsrHetero(const std::string& op, const std::string& reduce,
              std::vector<NDArray>* vec_out,
              std::vector<std::vector<NDArray>>* out_aux,
              const std::vector<dgl_type_t>& ufeat_ntids,  // ufeat node type id
-             const std::vector<dgl_type_t>& out_ntids) {  // output node type id
+             const std::vector<dgl_type_t>& out_ntids,  // output node type id
+             std::vector<KernelPlanCache*> plan_caches) {
+  plan_caches.resize(vec_csr.size(), nullptr);
   bool is_scalar_efeat = vec_efeat[0].NumElements() == vec_csr[0].indices->shape[0];
   bool use_efeat = op != "copy_lhs";
   auto device = runtime::DeviceAPI::Get(vec_csr[0].indptr->ctx);
+  auto* thr_entry = runtime::CUDAThreadEntry::ThreadLocal();
   SWITCH_BITS(bits, DType, {
     std::vector<DType*> trans_out((*vec_out).size(), NULL);
 
@@ -538,7 +766,7 @@ void SpMMCsrHetero(const std::string& op, const std::string& reduce,
         if (m == 0) continue;
         DType *out = static_cast<DType*>(device->AllocWorkspace(vec_csr[0].indptr->ctx,
           m * n * sizeof(DType)));
-        CUDA_CALL(cudaMemset(out, 0, m * n * sizeof(DType)));
+        CUDA_CALL(cudaMemsetAsync(out, 0, m * n * sizeof(DType), thr_entry->stream));
         trans_out[ntype] = out;
       }
     }
@@ -589,7 +817,8 @@ void SpMMCsrHetero(const std::string& op, const std::string& reduce,
       }
     }
 
-    auto* thr_entry = runtime::CUDAThreadEntry::ThreadLocal();
+    // relations left to the batched kernel, computed in a single launch
+    std::vector<dgl_type_t> batched_etypes;
     for (dgl_type_t etype = 0; etype < ufeat_ntids.size(); ++etype) {
       const dgl_type_t src_id = ufeat_ntids[etype];
       const dgl_type_t dst_id = out_ntids[etype];
@@ -606,56 +835,49 @@ void SpMMCsrHetero(const std::string& op, const std::string& reduce,
               static_cast<DType*>(vec_ufeat[src_id]->data),
               nullptr,
               out,
-              x_length, thr_entry->stream);
+              x_length, thr_entry->stream, plan_caches[etype]);
         } else if (op == "mul" && is_scalar_efeat &&
             cusparse_available<bits, IdType>(more_nnz)) {  // cusparse
           NDArray efeat = vec_efeat[etype];
-          if (!IsNullArray(csr.data))
-            efeat = _IndexSelect<DType, IdType>(efeat, csr.data);
+          DType* efeat_data = IsNullArray(csr.data) ? static_cast<DType*>(efeat->data) :
+            _IndexSelect<DType, IdType>(efeat, csr.data);
           cusparse::CusparseCsrmm2Hetero<DType, IdType>(
               csr.indptr->ctx, csr,
               static_cast<DType*>(vec_ufeat[src_id]->data),
-              static_cast<DType*>(efeat->data),
+              efeat_data,
               // TODO(Israt): Change (*vec_out) to trans_out to support CUDA version < 11
               static_cast<DType*>((*vec_out)[dst_id]->data),
-              x_length, thr_entry->stream);
+              x_length, thr_entry->stream, plan_caches[etype]);
+          if (!IsNullArray(csr.data))
+            runtime::DeviceAPI::Get(efeat->ctx)->FreeWorkspace(efeat->ctx, efeat_data);
         } else {  // general kernel
-          NDArray ufeat = (vec_ufeat.size() == 0) ?
-            NullArray() : vec_ufeat[src_id];
-          NDArray efeat = (vec_efeat.size() == 0) ?
-            NullArray() : vec_efeat[etype];
-          SWITCH_OP(op, Op, {
-            cuda::SpMMCsr<IdType, DType, Op, cuda::reduce::Sum<IdType, DType> >(
-                bcast, csr, ufeat, efeat, (*vec_out)[dst_id], NullArray(), NullArray());
-          });
+          batched_etypes.push_back(etype);
         }
-      } else if (reduce == "max") {
-          SWITCH_OP(op, Op, {
-            NDArray ufeat = (vec_ufeat.size() == 0) ?
-                NullArray() : vec_ufeat[src_id];
-            NDArray efeat = (vec_efeat.size() == 0) ?
-                NullArray() : vec_efeat[etype];
-            cuda::SpMMCmpCsrHetero<IdType, DType, Op, cuda::reduce::Max<IdType, DType> >(
-                bcast, csr, ufeat, efeat, (*vec_out)[dst_id], (*out_aux)[0][dst_id],
-                (*out_aux)[1][dst_id], (*out_aux)[2][dst_id], (*out_aux)[3][dst_id],
-                src_id, etype);
-          });
-      } else if (reduce == "min") {
-          SWITCH_OP(op, Op, {
-            NDArray ufeat = (vec_ufeat.size() == 0) ?
-                NullArray() : vec_ufeat[src_id];
-            NDArray efeat = (vec_efeat.size() == 0) ?
-                NullArray() : vec_efeat[etype];
-            cuda::SpMMCmpCsrHetero<IdType, DType, Op, cuda::reduce::Min<IdType, DType> >(
-                bcast, csr, ufeat, efeat, (*vec_out)[dst_id], (*out_aux)[0][dst_id],
-                (*out_aux)[1][dst_id], (*out_aux)[2][dst_id], (*out_aux)[3][dst_id],
-                src_id, etype);
-        });
+      } else if (reduce == "max" || reduce == "min") {
+        batched_etypes.push_back(etype);
       } else {
         LOG(FATAL) << "Not implemented";
       }
     }
 
+    if (!batched_etypes.empty()) {
+      SWITCH_OP(op, Op, {
+        if (reduce == "sum") {
+          cuda::SpMMCsrHeteroBatched<IdType, DType, Op, cuda::reduce::Sum<IdType, DType> >(
+              bcast, vec_csr, vec_ufeat, vec_efeat, vec_out, nullptr,
+              batched_etypes, ufeat_ntids, out_ntids);
+        } else if (reduce == "max") {
+          cuda::SpMMCsrHeteroBatched<IdType, DType, Op, cuda::reduce::Max<IdType, DType> >(
+              bcast, vec_csr, vec_ufeat, vec_efeat, vec_out, out_aux,
+              batched_etypes, ufeat_ntids, out_ntids);
+        } else {
+          cuda::SpMMCsrHeteroBatched<IdType, DType, Op, cuda::reduce::Min<IdType, DType> >(
+              bcast, vec_csr, vec_ufeat, vec_efeat, vec_out, out_aux,
+              batched_etypes, ufeat_ntids, out_ntids);
+        }
+      });
+    }
+
     if (use_legacy_cusparsemm) {
       // transpose output
       for (dgl_type_t ntype = 0; ntype < (*vec_out).size(); ++ntype) {
@@ -670,8 +892,47 @@ void SpMMCsrHetero(const std::string& op, const std::string& reduce,
   });
 }
 
+namespace {
+
+/*!
+ * \brief The edges of a Coo matrix sorted by destination, for the deterministic
+ *        SpMM on Coo format. The rows of csc are the columns of the Coo matrix,
+ *        its indices the source nodes and its data the edge ids.
+ */
+struct SpMMCooSortedPlan {
+  CSRMatrix csc;
+};
+
+/*!
+ * \brief Deterministic g-SpMM on Coo format.
+ * \note the edges are sorted by destination once and kept in plan_cache, then
+ *       every entry of the output is reduced by a single thread, in the same
+ *       order on every run and without atomics.
+ */
+template <typename IdType, typename DType, typename Op,
+          template <typename, typename, bool> class Reduce>
+void _SpMMCooSorted(const BcastOff& bcast, const COOMatrix& coo,
+                    NDArray ufeat, NDArray efeat,
+                    NDArray out, NDArray argu, NDArray arge,
+                    KernelPlanCache* plan_cache) {
+  auto make = [&coo]() {
+    auto plan = std::make_shared<SpMMCooSortedPlan>();
+    plan->csc = COOToCSR(COOTranspose(coo));
+    return plan;
+  };
+  const std::string key = typeid(SpMMCooSortedPlan).name();
+  auto plan = plan_cache ?
+    plan_cache->GetOrCreate<SpMMCooSortedPlan>(key, make) : make();
+  cuda::SpMMCsr<IdType, DType, Op, Reduce<IdType, DType, false> >(
+      bcast, plan->csc, ufeat, efeat, out, argu, arge);
+}
+
+}  // namespace
+
 /*!
  * \brief CUDA implementation of g-SpMM on Coo format.
+ * \note in the deterministic mode, see cuda::DeterministicEnabled, the edges
+ *       are reduced sorted by destination instead of with atomics.
  */
 template <int XPU, typename IdType, int bits>
 void SpMMCoo(const std::string& op, const std::string& reduce,
@@ -680,7 +941,27 @@ void SpMMCoo(const std::string& op, const std::string& reduce,
              NDArray ufeat,
              NDArray efeat,
              NDArray out,
-             std::vector<NDArray> out_aux) {
+             std::vector<NDArray> out_aux,
+             KernelPlanCache* plan_cache) {
+  if (dgl::cuda::DeterministicEnabled()) {
+    SWITCH_BITS(bits, DType, {
+      SWITCH_OP(op, Op, {
+        if (reduce == "sum") {
+          _SpMMCooSorted<IdType, DType, Op, cuda::reduce::Sum>(
+              bcast, coo, ufeat, efeat, out, NullArray(), NullArray(), plan_cache);
+        } else if (reduce == "max") {
+          _SpMMCooSorted<IdType, DType, Op, cuda::reduce::Max>(
+              bcast, coo, ufeat, efeat, out, out_aux[0], out_aux[1], plan_cache);
+        } else if (reduce == "min") {
+          _SpMMCooSorted<IdType, DType, Op, cuda::reduce::Min>(
+              bcast, coo, ufeat, efeat, out, out_aux[0], out_aux[1], plan_cache);
+        } else {
+          LOG(FATAL) << "Not implemented";
+        }
+      });
+    });
+    return;
+  }
   if (reduce == "sum") {
     SWITCH_BITS(bits, DType, {
       SWITCH_OP(op, Op, {
@@ -710,89 +991,107 @@ void SpMMCoo(const std::string& op, const std::string& reduce,
 template void SpMMCsr<kDLGPU, int32_t, 16>(
     const std::string& op, const std::string& reduce,
     const BcastOff& bcast, const CSRMatrix& csr,
-    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux);
+    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux,
+    KernelPlanCache* plan_cache);
 template void SpMMCsr<kDLGPU, int64_t, 16>(
     const std::string& op, const std::string& reduce,
     const BcastOff& bcast, const CSRMatrix& csr,
-    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux);
+    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux,
+    KernelPlanCache* plan_cache);
 template void SpMMCsr<kDLGPU, int32_t, 32>(
     const std::string& op, const std::string& reduce,
     const BcastOff& bcast, const CSRMatrix& csr,
-    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux);
+    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux,
+    KernelPlanCache* plan_cache);
 template void SpMMCsr<kDLGPU, int64_t, 32>(
     const std::string& op, const std::string& reduce,
     const BcastOff& bcast, const CSRMatrix& csr,
-    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux);
+    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux,
+    KernelPlanCache* plan_cache);
 template void SpMMCsr<kDLGPU, int32_t, 64>(
     const std::string& op, const std::string& reduce,
     const BcastOff& bcast, const CSRMatrix& csr,
-    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux);
+    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux,
+    KernelPlanCache* plan_cache);
 template void SpMMCsr<kDLGPU, int64_t, 64>(
     const std::string& op, const std::string& reduce,
     const BcastOff& bcast, const CSRMatrix& csr,
-    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux);
+    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux,
+    KernelPlanCache* plan_cache);
 
 template void SpMMCsrHetero<kDLGPU, int32_t, 16>(
     const std::string& op, const std::string& reduce,
     const BcastOff& bcast, const std::vector<CSRMatrix>& csr,
     const std::vector<NDArray>& ufeat, const std::vector<NDArray>& efeat,
     std::vector<NDArray>* out, std::vector<std::vector<NDArray>>* out_aux,
-    const std::vector<dgl_type_t>& ufeat_ntids, const std::vector<dgl_type_t>& out_ntids);
+    const std::vector<dgl_type_t>& ufeat_ntids, const std::vector<dgl_type_t>& out_ntids,
+    std::vector<KernelPlanCache*> plan_caches);
 template void SpMMCsrHetero<kDLGPU, int64_t, 16>(
     const std::string& op, const std::string& reduce,
     const BcastOff& bcast, const std::vector<CSRMatrix>& csr,
     const std::vector<NDArray>& ufeat, const std::vector<NDArray>& efeat,
     std::vector<NDArray>* out, std::vector<std::vector<NDArray>>* out_aux,
-    const std::vector<dgl_type_t>& ufeat_ntids, const std::vector<dgl_type_t>& out_ntids);
+    const std::vector<dgl_type_t>& ufeat_ntids, const std::vector<dgl_type_t>& out_ntids,
+    std::vector<KernelPlanCache*> plan_caches);
 template void SpMMCsrHetero<kDLGPU, int32_t, 32>(
     const std::string& op, const std::string& reduce,
     const BcastOff& bcast, const std::vector<CSRMatrix>& csr,
     const std::vector<NDArray>& ufeat, const std::vector<NDArray>& efeat,
     std::vector<NDArray>* out, std::vector<std::vector<NDArray>>* out_aux,
-    const std::vector<dgl_type_t>& ufeat_ntids, const std::vector<dgl_type_t>& out_ntids);
+    const std::vector<dgl_type_t>& ufeat_ntids, const std::vector<dgl_type_t>& out_ntids,
+    std::vector<KernelPlanCache*> plan_caches);
 template void SpMMCsrHetero<kDLGPU, int64_t, 32>(
     const std::string& op, const std::string& reduce,
     const BcastOff& bcast, const std::vector<CSRMatrix>& csr,
     const std::vector<NDArray>& ufeat, const std::vector<NDArray>& efeat,
     std::vector<NDArray>* out, std::vector<std::vector<NDArray>>* out_aux,
-    const std::vector<dgl_type_t>& ufeat_ntids, const std::vector<dgl_type_t>& out_ntids);
+    const std::vector<dgl_type_t>& ufeat_ntids, const std::vector<dgl_type_t>& out_ntids,
+    std::vector<KernelPlanCache*> plan_caches);
 template void SpMMCsrHetero<kDLGPU, int32_t, 64>(
     const std::string& op, const std::string& reduce,
     const BcastOff& bcast, const std::vector<CSRMatrix>& csr,
     const std::vector<NDArray>& ufeat, const std::vector<NDArray>& efeat,
     std::vector<NDArray>* out, std::vector<std::vector<NDArray>>* out_aux,
-    const std::vector<dgl_type_t>& ufeat_ntids, const std::vector<dgl_type_t>& out_ntids);
+    const std::vector<dgl_type_t>& ufeat_ntids, const std::vector<dgl_type_t>& out_ntids,
+    std::vector<KernelPlanCache*> plan_caches);
 template void SpMMCsrHetero<kDLGPU, int64_t, 64>(
     const std::string& op, const std::string& reduce,
     const BcastOff& bcast, const std::vector<CSRMatrix>& csr,
     const std::vector<NDArray>& ufeat, const std::vector<NDArray>& efeat,
     std::vector<NDArray>* out, std::vector<std::vector<NDArray>>* out_aux,
-    const std::vector<dgl_type_t>& ufeat_ntids, const std::vector<dgl_type_t>& out_ntids);
+    const std::vector<dgl_type_t>& ufeat_ntids, const std::vector<dgl_type_t>& out_ntids,
+    std::vector<KernelPlanCache*> plan_caches);
 
 template void SpMMCoo<kDLGPU, int32_t, 16>(
     const std::string& op, const std::string& reduce,
     const BcastOff& bcast, const COOMatrix& coo,
-    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux);
+    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux,
+    KernelPlanCache* plan_cache);
 template void SpMMCoo<kDLGPU, int64_t, 16>(
     const std::string& op, const std::string& reduce,
     const BcastOff& bcast, const COOMatrix& coo,
-    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux);
+    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux,
+    KernelPlanCache* plan_cache);
 template void SpMMCoo<kDLGPU, int32_t, 32>(
     const std::string& op, const std::string& reduce,
     const BcastOff& bcast, const COOMatrix& coo,
-    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux);
+    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux,
+    KernelPlanCache* plan_cache);
 template void SpMMCoo<kDLGPU, int64_t, 32>(
     const std::string& op, const std::string& reduce,
     const BcastOff& bcast, const COOMatrix& coo,
-    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux);
+    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux,
+    KernelPlanCache* plan_cache);
 template void SpMMCoo<kDLGPU, int32_t, 64>(
     const std::string& op, const std::string& reduce,
     const BcastOff& bcast, const COOMatrix& coo,
-    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux);
+    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux,
+    KernelPlanCache* plan_cache);
 template void SpMMCoo<kDLGPU, int64_t, 64>(
     const std::string& op, const std::string& reduce,
     const BcastOff& bcast, const COOMatrix& coo,
-    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux);
+    NDArray ufeat, NDArray efeat, NDArray out, std::vector<NDArray> out_aux,
+    KernelPlanCache* plan_cache);
 
 
 }  // namespace aten
@@ -7,10 +7,13 @@
 #define DGL_ARRAY_CUDA_SPMM_CUH_
 
 #include <dgl/bcast.h>
+#include <vector>
 #include "macro.cuh"
 #include "fp16.cuh"
+#include "vectorized.cuh"
 #include "atomic.cuh"
 #include "../../runtime/cuda/cuda_common.h"
+#include "../../runtime/cuda/cuda_graph.h"
 #include "./utils.h"
 
 namespace dgl {
@@ -70,6 +73,54 @@ __global__ void SpMMCooKernel(
   }
 }
 
+/*!
+ * \brief CUDA kernel of g-SpMM on Coo format with vectorized feature access.
+ * \note it uses the same strategy as SpMMCooKernel, but every thread loads
+ *       VecType<DType>::kWidth consecutive positions in feature dimension of
+ *       the operands at once. It requires no broadcasting and feature rows
+ *       aligned to the vector size.
+ */
+template <typename Idx, typename DType,
+          typename BinaryOp, typename ReduceOp,
+          bool UseIdx = false>
+__global__ void SpMMCooVecKernel(
+  const DType* __restrict__ ufeat,
+  const DType* __restrict__ efeat,
+  DType* __restrict__ out,
+  const Idx* __restrict__ row,
+  const Idx* __restrict__ col,
+  const Idx* __restrict__ edge_map,
+  int64_t N, int64_t M, int64_t E,
+  int64_t ufeat_len, int64_t efeat_len, int64_t out_len) {
+  constexpr int kWidth = VecType<DType>::kWidth;
+  Idx ty = blockIdx.y * blockDim.y + threadIdx.y;
+  const Idx stride_y = blockDim.y * gridDim.y;
+  while (ty < E) {
+    const Idx src = _ldg(row + ty);
+    const Idx dst = _ldg(col + ty);
+    const Idx eid = UseIdx ? _ldg(edge_map + ty) : ty;
+    int64_t tx = (blockIdx.x * blockDim.x + threadIdx.x) * kWidth;
+    const int64_t stride_x = blockDim.x * gridDim.x * kWidth;
+    const DType* uoff = BinaryOp::use_lhs ? (ufeat + src * ufeat_len): nullptr;
+    const DType* eoff = BinaryOp::use_rhs ? (efeat + eid * efeat_len): nullptr;
+    DType* outoff = out + dst * out_len;
+    while (tx < out_len) {
+      VecPack<DType> lhs_vec, rhs_vec;
+      if (BinaryOp::use_lhs)
+        lhs_vec = VecLoad(uoff + tx);
+      if (BinaryOp::use_rhs)
+        rhs_vec = VecLoad(eoff + tx);
+#pragma unroll
+      for (int k = 0; k < kWidth; ++k) {
+        DType val = BinaryOp::Call(lhs_vec.val + k, rhs_vec.val + k);
+        ReduceOp::Call(outoff + tx + k, nullptr, nullptr, val, src, eid);
+      }
+      tx += stride_x;
+    }
+    ty += stride_y;
+  }
+}
+
 /*!
  * \brief CUDA kernel to compute argu and arge in g-SpMM on Coo format.
  * \note it uses edge parallel strategy, different threadblocks (on y-axis)
@@ -176,6 +227,123 @@ __global__ void SpMMCsrKernel(
   }
 }
 
+/*!
+ * \brief Find the row of a Csr matrix holding the given edge position.
+ * \return The last row whose start is not greater than pos, i.e. the
+ *         non-empty row containing pos.
+ */
+template <typename Idx>
+__device__ __forceinline__ Idx _CsrRowOfPos(
+    const Idx* __restrict__ indptr, int64_t num_rows, Idx pos) {
+  Idx lo = 0, hi = num_rows;
+  // invariant: indptr[lo] <= pos < indptr[hi]
+  while (hi - lo > 1) {
+    const Idx mid = lo + (hi - lo) / 2;
+    if (_ldg(indptr + mid) <= pos)
+      lo = mid;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+/*!
+ * \brief Load-balanced CUDA kernel of g-SpMM on Csr format.
+ * \note it uses an nnz-split strategy: the non-zeros are cut into chunks of
+ *       chunk_size consecutive edges, and different threadblocks (on y-axis)
+ *       are responsible for different chunks, so a row with a huge degree
+ *       is spread over many threads. Threadblocks on the x-axis are
+ *       responsible for the computation on different positions in feature
+ *       dimension.
+ *
+ *       A row lying entirely within a chunk is written directly, along with
+ *       its arg-min/max. A row cut by a chunk boundary is combined with
+ *       AtomicReduceOp, the atomic version of ReduceOp; its arg-min/max are
+ *       written by a second launch with ArgPass set, which recomputes the
+ *       partial results of these rows and records the edge matching the
+ *       final output.
+ *
+ *       The output must be filled with ReduceOp::zero() for min/max.
+ */
+template <typename Idx, typename DType,
+          typename BinaryOp, typename ReduceOp, typename AtomicReduceOp,
+          bool ArgPass = false, bool UseBcast = false, bool UseIdx = false>
+__global__ void SpMMCsrBalancedKernel(
+  const DType* __restrict__ ufeat,
+  const DType* __restrict__ efeat,
+  DType* __restrict__ out,
+  Idx* __restrict__ arg_u,
+  Idx* __restrict__ arg_e,
+  const Idx* __restrict__ indptr,
+  const Idx* __restrict__ indices,
+  const Idx* __restrict__ edge_map,
+  int64_t num_rows, int64_t nnz, int64_t chunk_size,
+  const int64_t* __restrict__ ubcast_off,
+  const int64_t* __restrict__ ebcast_off,
+  int64_t ufeat_len, int64_t efeat_len, int64_t out_len) {
+  const int64_t num_chunks = (nnz + chunk_size - 1) / chunk_size;
+  int64_t ty = blockIdx.y * blockDim.y + threadIdx.y;
+  const int64_t stride_y = blockDim.y * gridDim.y;
+  const int64_t stride_x = blockDim.x * gridDim.x;
+  while (ty < num_chunks) {
+    const Idx chunk_begin = ty * chunk_size;
+    const Idx chunk_end = min(static_cast<int64_t>(chunk_begin) + chunk_size, nnz);
+    const Idx first_row = _CsrRowOfPos(indptr, num_rows, chunk_begin);
+    int64_t tx = blockIdx.x * blockDim.x + threadIdx.x;
+    while (tx < out_len) {
+      const int64_t lhs_add = UseBcast ? ubcast_off[tx] : tx;
+      const int64_t rhs_add = UseBcast ? ebcast_off[tx] : tx;
+      Idx row = first_row;
+      Idx row_begin = _ldg(indptr + row), row_end = _ldg(indptr + row + 1);
+      Idx i = chunk_begin;
+      while (i < chunk_end) {
+        DType local_accum = ReduceOp::zero();
+        Idx local_argu = 0, local_arge = 0;
+        const Idx end = min(row_end, chunk_end);
+        for (; i < end; ++i) {
+          const Idx eid = UseIdx ? _ldg(edge_map + i) : i;
+          const Idx cid = _ldg(indices + i);
+          const DType* uoff = BinaryOp::use_lhs ? (ufeat + cid * ufeat_len): nullptr;
+          const DType* eoff = BinaryOp::use_rhs ? (efeat + eid * efeat_len): nullptr;
+          DType val = BinaryOp::Call(uoff + lhs_add, eoff + rhs_add);
+          ReduceOp::Call(&local_accum, &local_argu, &local_arge, val, cid, eid);
+        }
+        const int64_t pos = row * out_len + tx;
+        const bool whole_row = row_begin >= chunk_begin && row_end <= chunk_end;
+        if (!ArgPass) {
+          if (whole_row) {
+            if (ReduceOp::require_arg) {
+              out[pos] = local_accum;
+              if (BinaryOp::use_lhs)
+                arg_u[pos] = local_argu;
+              if (BinaryOp::use_rhs)
+                arg_e[pos] = local_arge;
+            } else {
+              // accumulate as SpMMCsrKernel does
+              out[pos] += local_accum;
+            }
+          } else {
+            AtomicReduceOp::Call(out + pos, nullptr, nullptr, local_accum, 0, 0);
+          }
+        } else if (!whole_row && local_accum == out[pos]) {
+          if (BinaryOp::use_lhs)
+            arg_u[pos] = local_argu;
+          if (BinaryOp::use_rhs)
+            arg_e[pos] = local_arge;
+        }
+        // move to the next non-empty row
+        while (i < chunk_end && i >= row_end) {
+          ++row;
+          row_begin = row_end;
+          row_end = _ldg(indptr + row + 1);
+        }
+      }
+      tx += stride_x;
+    }
+    ty += stride_y;
+  }
+}
+
 /*!
  * \brief CUDA kernel of SpMM-Min/Max on Csr format.
  * \note it uses node parallel strategy, different threadblocks (on y-axis)
@@ -237,6 +405,126 @@ __global__ void SpMMCmpCsrHeteroKernel(
   }
 }
 
+/*! \brief A relation of the batched g-SpMM on heterogeneous graph. */
+template <typename Idx, typename DType>
+struct SpMMCsrHeteroRelation {
+  const Idx* indptr;
+  const Idx* indices;
+  /*! \brief The edge ids, null if they are the positions in indices. */
+  const Idx* edge_map;
+  const DType* ufeat;
+  const DType* efeat;
+  Idx src_type;
+  Idx etype;
+};
+
+/*!
+ * \brief The relations of the batched g-SpMM sharing a destination node type.
+ *
+ * The rows of all the targets are concatenated, and every row of a target is
+ * reduced over all its relations by the same thread.
+ */
+template <typename Idx, typename DType>
+struct SpMMCsrHeteroTarget {
+  DType* out;
+  Idx* arg_u;
+  Idx* arg_e;
+  Idx* arg_u_ntype;
+  Idx* arg_e_etype;
+  /*! \brief The position of the first row of the target among all rows. */
+  int64_t row_begin;
+  int64_t num_rows;
+  /*! \brief The range of the relations of the target in the relation table. */
+  int64_t rel_begin, rel_end;
+};
+
+/*!
+ * \brief CUDA kernel of g-SpMM on Csr format on heterogeneous graph, computing
+ *        all the relations in a single launch.
+ * \note it uses node parallel strategy over the rows of all the destination
+ *       node types, different threadblocks (on y-axis) are responsible for
+ *       different (node type, node) pairs and loop over the relations of the
+ *       node type, so that no atomics are needed. Threadblocks on the x-axis
+ *       are responsible for the computation on different positions in feature
+ *       dimension.
+ *
+ *       For sum the result is added to out. For min/max, out must be filled
+ *       with ReduceOp::zero(); like SpMMCmpCsrHeteroKernel, the arg and type
+ *       outputs are only written where the result changes, and the first
+ *       relation reaching the extremum wins.
+ */
+template <typename Idx, typename DType,
+          typename BinaryOp, typename ReduceOp,
+          bool UseBcast = false>
+__global__ void SpMMCsrHeteroBatchedKernel(
+  const SpMMCsrHeteroRelation<Idx, DType>* __restrict__ relations,
+  const SpMMCsrHeteroTarget<Idx, DType>* __restrict__ targets,
+  int64_t num_targets, int64_t total_rows,
+  const int64_t* __restrict__ ubcast_off,
+  const int64_t* __restrict__ ebcast_off,
+  int64_t ufeat_len, int64_t efeat_len, int64_t out_len) {
+  int64_t ty = blockIdx.y * blockDim.y + threadIdx.y;
+  const int64_t stride_y = blockDim.y * gridDim.y;
+  const int64_t stride_x = blockDim.x * gridDim.x;
+  while (ty < total_rows) {
+    // the last target starting at or before ty
+    int64_t lo = 0, hi = num_targets;
+    while (hi - lo > 1) {
+      const int64_t mid = lo + (hi - lo) / 2;
+      if (targets[mid].row_begin <= ty)
+        lo = mid;
+      else
+        hi = mid;
+    }
+    const SpMMCsrHeteroTarget<Idx, DType> target = targets[lo];
+    const Idx row = ty - target.row_begin;
+    int64_t tx = blockIdx.x * blockDim.x + threadIdx.x;
+    while (tx < out_len) {
+      const int64_t lhs_add = UseBcast ? ubcast_off[tx] : tx;
+      const int64_t rhs_add = UseBcast ? ebcast_off[tx] : tx;
+      const int64_t pos = row * out_len + tx;
+      DType accum = ReduceOp::require_arg ? target.out[pos] : ReduceOp::zero();
+      Idx argu = 0, arge = 0, argu_ntype = -1, arge_etype = -1;
+      bool updated = false;
+      for (int64_t r = target.rel_begin; r < target.rel_end; ++r) {
+        const SpMMCsrHeteroRelation<Idx, DType>& rel = relations[r];
+        const DType prev = accum;
+        Idx local_argu = 0, local_arge = 0;
+        for (Idx i = _ldg(rel.indptr + row); i < _ldg(rel.indptr + row + 1); ++i) {
+          const Idx eid = rel.edge_map ? _ldg(rel.edge_map + i) : i;
+          const Idx cid = _ldg(rel.indices + i);
+          const DType* uoff = BinaryOp::use_lhs ? (rel.ufeat + cid * ufeat_len): nullptr;
+          const DType* eoff = BinaryOp::use_rhs ? (rel.efeat + eid * efeat_len): nullptr;
+          DType val = BinaryOp::Call(uoff + lhs_add, eoff + rhs_add);
+          ReduceOp::Call(&accum, &local_argu, &local_arge, val, cid, eid);
+        }
+        if (ReduceOp::require_arg && accum != prev) {
+          argu = local_argu;
+          arge = local_arge;
+          argu_ntype = rel.src_type;
+          arge_etype = rel.etype;
+          updated = true;
+        }
+      }
+      if (!ReduceOp::require_arg) {
+        target.out[pos] += accum;
+      } else if (updated) {
+        target.out[pos] = accum;
+        if (BinaryOp::use_lhs) {
+          target.arg_u[pos] = argu;
+          target.arg_u_ntype[pos] = argu_ntype;
+        }
+        if (BinaryOp::use_rhs) {
+          target.arg_e[pos] = arge;
+          target.arg_e_etype[pos] = arge_etype;
+        }
+      }
+      tx += stride_x;
+    }
+    ty += stride_y;
+  }
+}
+
 /*!
  * \brief CUDA implementation of g-SpMM on Coo format.
  * \param bcast Broadcast information.
@@ -294,15 +582,36 @@ void SpMMCoo(
   const dim3 nblks(nbx, nby);
   const dim3 nthrs(ntx, nty);
   const bool use_idx = !IsNullArray(coo.data);
+  // The reduction pass loads kWidth features at once when the rows allow it,
+  // the arg pass is left scalar.
+  const bool use_vec = !bcast.use_bcast &&
+    VecAligned(BinaryOp::use_lhs ? ufeat_data : nullptr, lhs_len) &&
+    VecAligned(BinaryOp::use_rhs ? efeat_data : nullptr, rhs_len) &&
+    VecAligned(out_data, len);
 
   BCAST_IDX_CTX_SWITCH(bcast, use_idx, ufeat->ctx, ubcast_off, ebcast_off, {
-    CUDA_KERNEL_CALL((SpMMCooKernel<Idx, DType, BinaryOp, ReduceOp, UseBcast, UseIdx>),
-        nblks, nthrs, 0, thr_entry->stream,
-        ufeat_data, efeat_data, out_data, argu_data, arge_data,
-        row, col, edge_map,
-        N, M, E,
-        ubcast_off, ebcast_off,
-        lhs_len, rhs_len, len);
+    if (use_vec) {
+      const int64_t num_vec = len / VecType<DType>::kWidth;
+      const int vec_ntx = FindNumThreads(num_vec);
+      const int vec_nty = CUDA_MAX_NUM_THREADS / vec_ntx;
+      const dim3 vec_nblks((num_vec + vec_ntx - 1) / vec_ntx,
+                           FindNumBlocks<'y'>((E + vec_nty - 1) / vec_nty));
+      const dim3 vec_nthrs(vec_ntx, vec_nty);
+      CUDA_KERNEL_CALL((SpMMCooVecKernel<Idx, DType, BinaryOp, ReduceOp, UseIdx>),
+          vec_nblks, vec_nthrs, 0, thr_entry->stream,
+          ufeat_data, efeat_data, out_data,
+          row, col, edge_map,
+          N, M, E,
+          lhs_len, rhs_len, len);
+    } else {
+      CUDA_KERNEL_CALL((SpMMCooKernel<Idx, DType, BinaryOp, ReduceOp, UseBcast, UseIdx>),
+          nblks, nthrs, 0, thr_entry->stream,
+          ufeat_data, efeat_data, out_data, argu_data, arge_data,
+          row, col, edge_map,
+          N, M, E,
+          ubcast_off, ebcast_off,
+          lhs_len, rhs_len, len);
+    }
     if (ReduceOp::require_arg) {
       CUDA_KERNEL_CALL((ArgSpMMCooKernel<Idx, DType, BinaryOp, ReduceOp, UseBcast, UseIdx>),
           nblks, nthrs, 0, thr_entry->stream,
@@ -371,6 +680,85 @@ void SpMMCsr(
   });
 }
 
+/*!
+ * \brief Load-balanced CUDA implementation of g-SpMM on Csr format.
+ *
+ * It splits the non-zeros evenly across the threads instead of the rows, see
+ * SpMMCsrBalancedKernel, which pays off on graphs with a few rows of very
+ * large degree. The arguments are the same as SpMMCsr.
+ *
+ * \tparam AtomicReduceOp The atomic version of ReduceOp.
+ * \param chunk_size The number of non-zeros computed by one thread.
+ */
+template <typename Idx, typename DType,
+          typename BinaryOp, typename ReduceOp, typename AtomicReduceOp>
+void SpMMCsrBalanced(
+    const BcastOff& bcast,
+    const CSRMatrix& csr,
+    NDArray ufeat, NDArray efeat,
+    NDArray out, NDArray argu, NDArray arge,
+    int64_t chunk_size) {
+#if defined(CUDART_VERSION) && CUDART_VERSION <= 10000
+  if (std::is_same<DType, half>::value)
+    LOG(FATAL) << "SpMMCsrBalanced requires atomicCAS, which is not supported "
+               << "for float16 in CUDA 10.0. Please upgrade your CUDA "
+               << "to later versions.";
+#endif
+  const Idx *indptr = csr.indptr.Ptr<Idx>();
+  const Idx *indices = csr.indices.Ptr<Idx>();
+  const Idx *edge_map = csr.data.Ptr<Idx>();
+  const DType *ufeat_data = ufeat.Ptr<DType>();
+  const DType *efeat_data = efeat.Ptr<DType>();
+  DType *out_data = out.Ptr<DType>();
+  Idx* argu_data = argu.Ptr<Idx>();
+  Idx* arge_data = arge.Ptr<Idx>();
+  const int64_t nnz = csr.indices->shape[0];
+  const int64_t num_chunks = (nnz + chunk_size - 1) / chunk_size;
+
+  auto* thr_entry = runtime::CUDAThreadEntry::ThreadLocal();
+
+  if (ReduceOp::require_arg) {
+    const int64_t out_size = out.NumElements();
+    const int nt = FindNumThreads(out_size);
+    const int nb = (out_size + nt - 1) / nt;
+    CUDA_KERNEL_CALL(_FillKernel, nb, nt, 0, thr_entry->stream,
+        out_data, out_size, ReduceOp::zero());
+  }
+
+  int64_t *ubcast_off = nullptr, *ebcast_off = nullptr;
+  int64_t len = bcast.out_len,
+          lhs_len = bcast.lhs_len,
+          rhs_len = bcast.rhs_len;
+  const int ntx = FindNumThreads(len);
+  const int nty = CUDA_MAX_NUM_THREADS / ntx;
+  const int nbx = (len + ntx - 1) / ntx;
+  const int nby = FindNumBlocks<'y'>((num_chunks + nty - 1) / nty);
+  const dim3 nblks(nbx, nby);
+  const dim3 nthrs(ntx, nty);
+  const bool use_idx = !IsNullArray(csr.data);
+
+  BCAST_IDX_CTX_SWITCH(bcast, use_idx, ufeat->ctx, ubcast_off, ebcast_off, {
+    CUDA_KERNEL_CALL((SpMMCsrBalancedKernel<Idx, DType, BinaryOp, ReduceOp, AtomicReduceOp,
+                                            false, UseBcast, UseIdx>),
+        nblks, nthrs, 0, thr_entry->stream,
+        ufeat_data, efeat_data, out_data, argu_data, arge_data,
+        indptr, indices, edge_map,
+        csr.num_rows, nnz, chunk_size,
+        ubcast_off, ebcast_off,
+        lhs_len, rhs_len, len);
+    if (ReduceOp::require_arg) {
+      CUDA_KERNEL_CALL((SpMMCsrBalancedKernel<Idx, DType, BinaryOp, ReduceOp, AtomicReduceOp,
+                                              true, UseBcast, UseIdx>),
+          nblks, nthrs, 0, thr_entry->stream,
+          ufeat_data, efeat_data, out_data, argu_data, arge_data,
+          indptr, indices, edge_map,
+          csr.num_rows, nnz, chunk_size,
+          ubcast_off, ebcast_off,
+          lhs_len, rhs_len, len);
+    }
+  });
+}
+
 /*!
  * \brief CUDA kernel of SpMM-Min/Max on Csr format on heterogeneous graph.
  * \param bcast Broadcast information.
@@ -438,6 +826,115 @@ void SpMMCmpCsrHetero(
   });
 }
 
+/*!
+ * \brief CUDA implementation of g-SpMM on Csr format on heterogeneous graph,
+ *        computing the given relations in a single launch.
+ * \param bcast Broadcast information, shared by all the relations.
+ * \param vec_csr The Csr matrix of every relation.
+ * \param vec_ufeat The feature on source nodes of every node type.
+ * \param vec_efeat The feature on edges of every relation.
+ * \param vec_out The result feature of every node type.
+ * \param out_aux The arg-Min/Max on source nodes and edges, and their node
+ *        and edge types, of every node type; null for sum. See
+ *        SpMMCmpCsrHetero.
+ * \param etypes The relations to compute.
+ * \param ufeat_ntids The source node type of every relation.
+ * \param out_ntids The destination node type of every relation.
+ */
+template <typename Idx, typename DType,
+          typename BinaryOp, typename ReduceOp>
+void SpMMCsrHeteroBatched(
+    const BcastOff& bcast,
+    const std::vector<CSRMatrix>& vec_csr,
+    const std::vector<NDArray>& vec_ufeat,
+    const std::vector<NDArray>& vec_efeat,
+    std::vector<NDArray>* vec_out,
+    std::vector<std::vector<NDArray>>* out_aux,
+    const std::vector<dgl_type_t>& etypes,
+    const std::vector<dgl_type_t>& ufeat_ntids,
+    const std::vector<dgl_type_t>& out_ntids) {
+  typedef SpMMCsrHeteroRelation<Idx, DType> Relation;
+  typedef SpMMCsrHeteroTarget<Idx, DType> Target;
+  // group the relations by destination node type
+  std::vector<Relation> relations;
+  std::vector<Target> targets;
+  std::vector<bool> visited(etypes.size(), false);
+  int64_t total_rows = 0;
+  for (size_t i = 0; i < etypes.size(); ++i) {
+    if (visited[i])
+      continue;
+    const dgl_type_t dst_id = out_ntids[etypes[i]];
+    Target target;
+    target.out = (*vec_out)[dst_id].Ptr<DType>();
+    target.arg_u = out_aux ? (*out_aux)[0][dst_id].Ptr<Idx>() : nullptr;
+    target.arg_e = out_aux ? (*out_aux)[1][dst_id].Ptr<Idx>() : nullptr;
+    target.arg_u_ntype = out_aux ? (*out_aux)[2][dst_id].Ptr<Idx>() : nullptr;
+    target.arg_e_etype = out_aux ? (*out_aux)[3][dst_id].Ptr<Idx>() : nullptr;
+    target.row_begin = total_rows;
+    target.num_rows = vec_csr[etypes[i]].num_rows;
+    target.rel_begin = relations.size();
+    for (size_t j = i; j < etypes.size(); ++j) {
+      const dgl_type_t etype = etypes[j];
+      if (visited[j] || out_ntids[etype] != dst_id)
+        continue;
+      visited[j] = true;
+      const CSRMatrix& csr = vec_csr[etype];
+      CHECK_EQ(csr.num_rows, target.num_rows);
+      Relation rel;
+      rel.indptr = csr.indptr.Ptr<Idx>();
+      rel.indices = csr.indices.Ptr<Idx>();
+      rel.edge_map = IsNullArray(csr.data) ? nullptr : csr.data.Ptr<Idx>();
+      rel.ufeat = vec_ufeat.empty() ? nullptr : vec_ufeat[ufeat_ntids[etype]].Ptr<DType>();
+      rel.efeat = vec_efeat.empty() ? nullptr : vec_efeat[etype].Ptr<DType>();
+      rel.src_type = ufeat_ntids[etype];
+      rel.etype = etype;
+      relations.push_back(rel);
+    }
+    target.rel_end = relations.size();
+    if (target.num_rows > 0) {
+      targets.push_back(target);
+      total_rows += target.num_rows;
+    }
+  }
+  if (total_rows == 0)
+    return;
+
+  const DLContext ctx = vec_csr[etypes[0]].indptr->ctx;
+  const auto device = runtime::DeviceAPI::Get(ctx);
+  auto* thr_entry = runtime::CUDAThreadEntry::ThreadLocal();
+  Relation* relations_dev = static_cast<Relation*>(
+      device->AllocWorkspace(ctx, relations.size() * sizeof(Relation)));
+  Target* targets_dev = static_cast<Target*>(
+      device->AllocWorkspace(ctx, targets.size() * sizeof(Target)));
+  runtime::CopyHostToDeviceAsync(relations.data(), relations_dev,
+      relations.size() * sizeof(Relation), thr_entry->stream);
+  runtime::CopyHostToDeviceAsync(targets.data(), targets_dev,
+      targets.size() * sizeof(Target), thr_entry->stream);
+
+  int64_t *ubcast_off = nullptr, *ebcast_off = nullptr;
+  int64_t len = bcast.out_len,
+          lhs_len = bcast.lhs_len,
+          rhs_len = bcast.rhs_len;
+  const int ntx = FindNumThreads(len);
+  const int nty = CUDA_MAX_NUM_THREADS / ntx;
+  const int nbx = (len + ntx - 1) / ntx;
+  const int nby = FindNumBlocks<'y'>((total_rows + nty - 1) / nty);
+  const dim3 nblks(nbx, nby);
+  const dim3 nthrs(ntx, nty);
+
+  // the edge maps are checked per relation in the kernel
+  BCAST_IDX_CTX_SWITCH(bcast, false, ctx, ubcast_off, ebcast_off, {
+    CUDA_KERNEL_CALL((SpMMCsrHeteroBatchedKernel<Idx, DType, BinaryOp, ReduceOp, UseBcast>),
+        nblks, nthrs, 0, thr_entry->stream,
+        relations_dev, targets_dev,
+        static_cast<int64_t>(targets.size()), total_rows,
+        ubcast_off, ebcast_off,
+        lhs_len, rhs_len, len);
+  });
+  device->FreeWorkspace(ctx, targets_dev);
+  device->FreeWorkspace(ctx, relations_dev);
+}
+
 
 }  // namespace cuda
 }  // namespace aten
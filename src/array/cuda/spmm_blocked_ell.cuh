@@ -0,0 +1,343 @@
+/*!
+ * Copyright (c) 2021 by Contributors
+ * \file array/cuda/spmm_blocked_ell.cuh
+ * \brief Blocked-ELL SpMM CUDA kernel function header, on tensor cores.
+ */
+#ifndef DGL_ARRAY_CUDA_SPMM_BLOCKED_ELL_CUH_
+#define DGL_ARRAY_CUDA_SPMM_BLOCKED_ELL_CUH_
+
+#ifdef USE_FP16
+
+#include <dgl/array.h>
+#include <cuda_fp16.h>
+#include <mma.h>
+#include <memory>
+#include "atomic.cuh"
+#include "./dgl_cub.cuh"
+#include "./utils.h"
+#include "../../runtime/cuda/cuda_common.h"
+#include "../../runtime/cuda/cuda_graph.h"
+
+namespace dgl {
+
+using namespace cuda;
+
+namespace aten {
+namespace cuda {
+
+/*! \brief The size of the square tiles of the blocked-ELL format. */
+constexpr int kEllBlock = 16;
+/*! \brief Number of warps, i.e. feature tiles, of a blocked-ELL SpMM thread block. */
+constexpr int kEllWarps = 4;
+/*! \brief Number of threads of the kernels building the blocked-ELL format. */
+constexpr int kEllBuildThreads = 256;
+/*!
+ * \brief Maximum number of column tiles, bounding the shared memory of the
+ *        kernels building the blocked-ELL format.
+ */
+constexpr int64_t kEllMaxColBlocks = 16384;
+/*! \brief Minimum density of the matrix for which the blocked-ELL format is tried. */
+constexpr double kEllMinDensity = 0.02;
+/*!
+ * \brief Minimum ratio of the non-zeros to the size of the stored tiles for
+ *        which the blocked-ELL SpMM is used: below it the tensor cores spend
+ *        more time on the zeros than the scalar kernels on the non-zeros.
+ */
+constexpr double kEllMinFill = 0.125;
+
+/*!
+ * \brief The blocked-ELL format of a Csr matrix, cached to run SpMM on tensor
+ *        cores.
+ *
+ * The rows are grouped by tiles of kEllBlock rows. Every row tile stores the
+ * same number ell_width of dense kEllBlock x kEllBlock tiles, of the column
+ * tiles holding its non-zeros followed by padding ones.
+ */
+struct SpMMBlockedEllPlan {
+  /*! \brief Whether the format is worth using. */
+  bool use = false;
+  int64_t num_block_rows = 0, ell_width = 0;
+  /*! \brief The column tile of every stored tile, or -1 for the padding ones. */
+  IdArray ell_cols;
+  /*! \brief The offset of every non-zero of the Csr matrix in the tiles. */
+  IdArray edge_pos;
+  /*! \brief The tiles of the unweighted matrix, i.e. of the edge counts. */
+  NDArray ones;
+};
+
+/*!
+ * \brief Mark the column tiles of the non-zeros of a row tile in a bitmap in
+ *        shared memory.
+ */
+template <typename IdType>
+__device__ __forceinline__ void _MarkColBlocks(
+    const IdType* __restrict__ indptr, const IdType* __restrict__ indices,
+    int64_t num_rows, int64_t num_words, uint32_t* bitmap) {
+  for (int64_t w = threadIdx.x; w < num_words; w += blockDim.x)
+    bitmap[w] = 0;
+  __syncthreads();
+  const int64_t row_start = static_cast<int64_t>(blockIdx.x) * kEllBlock;
+  const int64_t row_end = min(row_start + kEllBlock, num_rows);
+  for (IdType j = indptr[row_start] + threadIdx.x; j < indptr[row_end]; j += blockDim.x) {
+    const int64_t cb = indices[j] / kEllBlock;
+    atomicOr(bitmap + cb / 32, 1u << (cb % 32));
+  }
+  __syncthreads();
+}
+
+/*! \brief Count the column tiles of every row tile. */
+template <typename IdType>
+__global__ void _EllCountKernel(
+    const IdType* __restrict__ indptr, const IdType* __restrict__ indices,
+    int64_t num_rows, int64_t num_words, int64_t* __restrict__ counts) {
+  extern __shared__ uint32_t bitmap[];
+  __shared__ int count;
+  if (threadIdx.x == 0)
+    count = 0;
+  _MarkColBlocks(indptr, indices, num_rows, num_words, bitmap);
+  int local = 0;
+  for (int64_t w = threadIdx.x; w < num_words; w += blockDim.x)
+    local += __popc(bitmap[w]);
+  atomicAdd(&count, local);
+  __syncthreads();
+  if (threadIdx.x == 0)
+    counts[blockIdx.x] = count;
+}
+
+/*!
+ * \brief Fill the column tiles of every row tile and the offsets of the
+ *        non-zeros in the tiles.
+ */
+template <typename IdType>
+__global__ void _EllBuildKernel(
+    const IdType* __restrict__ indptr, const IdType* __restrict__ indices,
+    int64_t num_rows, int64_t num_words, int64_t ell_width,
+    int32_t* __restrict__ ell_cols, int64_t* __restrict__ edge_pos) {
+  extern __shared__ uint32_t bitmap[];
+  // the rank of the first column tile of every word of the bitmap
+  uint32_t* prefix = bitmap + num_words;
+  _MarkColBlocks(indptr, indices, num_rows, num_words, bitmap);
+  if (threadIdx.x == 0) {
+    uint32_t rank = 0;
+    for (int64_t w = 0; w < num_words; ++w) {
+      prefix[w] = rank;
+      rank += __popc(bitmap[w]);
+    }
+  }
+  __syncthreads();
+  const int64_t block_row = blockIdx.x;
+  int32_t* cols = ell_cols + block_row * ell_width;
+  for (int64_t s = threadIdx.x; s < ell_width; s += blockDim.x)
+    cols[s] = -1;
+  __syncthreads();
+  for (int64_t w = threadIdx.x; w < num_words; w += blockDim.x) {
+    uint32_t bits = bitmap[w];
+    uint32_t rank = prefix[w];
+    while (bits) {
+      const int bit = __ffs(bits) - 1;
+      cols[rank++] = w * 32 + bit;
+      bits &= bits - 1;
+    }
+  }
+  // every warp takes rows of the tile, the lanes the non-zeros of the row
+  const int lane = threadIdx.x % 32, warp = threadIdx.x / 32;
+  const int64_t row_start = block_row * kEllBlock;
+  for (int64_t r = row_start + warp; r < min(row_start + kEllBlock, num_rows);
+       r += blockDim.x / 32) {
+    for (IdType j = indptr[r] + lane; j < indptr[r + 1]; j += 32) {
+      const int64_t c = indices[j], cb = c / kEllBlock;
+      const uint32_t word = bitmap[cb / 32];
+      const int64_t slot = prefix[cb / 32] + __popc(word & ((1u << (cb % 32)) - 1));
+      edge_pos[j] = ((block_row * ell_width + slot) * kEllBlock + (r - row_start)) * kEllBlock +
+        c % kEllBlock;
+    }
+  }
+}
+
+/*!
+ * \brief Scatter the edge values, or ones if efeat is null, to the tiles.
+ * \note the tiles must be zeroed beforehand; multi-edges add up.
+ */
+template <typename IdType, bool UseIdx>
+__global__ void _EllScatterKernel(
+    const int64_t* __restrict__ edge_pos, const half* __restrict__ efeat,
+    const IdType* __restrict__ edge_map, int64_t nnz, half* __restrict__ tiles) {
+  int64_t tx = blockIdx.x * blockDim.x + threadIdx.x;
+  const int64_t stride_x = gridDim.x * blockDim.x;
+  while (tx < nnz) {
+    const half val = efeat ? efeat[UseIdx ? edge_map[tx] : tx] : __float2half(1.f);
+    AtomicAdd(tiles + edge_pos[tx], val);
+    tx += stride_x;
+  }
+}
+
+/*!
+ * \brief CUDA kernel of SpMM on blocked-ELL format with tensor cores.
+ * \note every warp computes a kEllBlock x kEllBlock tile of the output, the
+ *       grid dimension x being over row tiles and y over feature tiles. For
+ *       every stored tile of the row tile, the matching kEllBlock rows of the
+ *       features are staged in shared memory, zero-padded past the matrix and
+ *       feature bounds, and multiplied with WMMA, accumulating in float.
+ *       It overwrites out.
+ */
+__global__ void SpMMBlockedEllKernel(
+    const half* __restrict__ tiles,
+    const int32_t* __restrict__ ell_cols,
+    const half* __restrict__ ufeat,
+    half* __restrict__ out,
+    int64_t num_rows, int64_t num_cols, int64_t ell_width, int64_t feat_len) {
+#if __CUDA_ARCH__ >= 700
+  using namespace nvcuda;
+  constexpr int kTileSize = kEllBlock * kEllBlock;
+  __shared__ __align__(32) half sh_feat[kEllWarps][kTileSize];
+  __shared__ __align__(32) float sh_out[kEllWarps][kTileSize];
+  const int lane = threadIdx.x, warp = threadIdx.y;
+  const int64_t block_row = blockIdx.x;
+  const int64_t fid = (static_cast<int64_t>(blockIdx.y) * kEllWarps + warp) * kEllBlock;
+  // the whole warp leaves, so the warp-level synchronizations below are safe
+  if (fid >= feat_len)
+    return;
+  wmma::fragment<wmma::matrix_a, kEllBlock, kEllBlock, kEllBlock, half, wmma::row_major> a;
+  wmma::fragment<wmma::matrix_b, kEllBlock, kEllBlock, kEllBlock, half, wmma::row_major> b;
+  wmma::fragment<wmma::accumulator, kEllBlock, kEllBlock, kEllBlock, float> acc;
+  wmma::fill_fragment(acc, 0.f);
+  for (int64_t s = 0; s < ell_width; ++s) {
+    const int64_t cb = _ldg(ell_cols + block_row * ell_width + s);
+    // the padding tiles are the last ones
+    if (cb < 0)
+      break;
+    for (int i = lane; i < kTileSize; i += 32) {
+      const int64_t c = cb * kEllBlock + i / kEllBlock, f = fid + i % kEllBlock;
+      sh_feat[warp][i] = (c < num_cols && f < feat_len) ?
+        ufeat[c * feat_len + f] : __float2half(0.f);
+    }
+    __syncwarp();
+    wmma::load_matrix_sync(a, tiles + (block_row * ell_width + s) * kTileSize, kEllBlock);
+    wmma::load_matrix_sync(b, sh_feat[warp], kEllBlock);
+    wmma::mma_sync(acc, a, b, acc);
+    __syncwarp();
+  }
+  wmma::store_matrix_sync(sh_out[warp], acc, kEllBlock, wmma::mem_row_major);
+  __syncwarp();
+  for (int i = lane; i < kTileSize; i += 32) {
+    const int64_t r = block_row * kEllBlock + i / kEllBlock, f = fid + i % kEllBlock;
+    if (r < num_rows && f < feat_len)
+      out[r * feat_len + f] = __float2half(sh_out[warp][i]);
+  }
+#endif  // __CUDA_ARCH__ >= 700
+}
+
+/*!
+ * \brief Build the blocked-ELL format of a Csr matrix, or a plan not to use it
+ *        if the matrix is too sparse or the device has no tensor cores.
+ */
+template <typename IdType>
+std::shared_ptr<SpMMBlockedEllPlan> BuildBlockedEllPlan(const CSRMatrix& csr) {
+  auto plan = std::make_shared<SpMMBlockedEllPlan>();
+  const auto& ctx = csr.indptr->ctx;
+  int major = 0;
+  CUDA_CALL(cudaDeviceGetAttribute(&major, cudaDevAttrComputeCapabilityMajor, ctx.device_id));
+  const int64_t nnz = csr.indices->shape[0];
+  const int64_t num_col_blocks = (csr.num_cols + kEllBlock - 1) / kEllBlock;
+  if (major < 7 || nnz == 0 || num_col_blocks > kEllMaxColBlocks ||
+      nnz < kEllMinDensity * csr.num_rows * csr.num_cols)
+    return plan;
+
+  auto device = runtime::DeviceAPI::Get(ctx);
+  auto* thr_entry = runtime::CUDAThreadEntry::ThreadLocal();
+  const int64_t num_block_rows = (csr.num_rows + kEllBlock - 1) / kEllBlock;
+  const int64_t num_words = (num_col_blocks + 31) / 32;
+  const IdType* indptr = csr.indptr.Ptr<IdType>();
+  const IdType* indices = csr.indices.Ptr<IdType>();
+  int64_t* counts = static_cast<int64_t*>(
+      device->AllocWorkspace(ctx, num_block_rows * sizeof(int64_t)));
+  int64_t* max_count = static_cast<int64_t*>(device->AllocWorkspace(ctx, sizeof(int64_t)));
+  CUDA_KERNEL_CALL(_EllCountKernel<IdType>, num_block_rows, kEllBuildThreads,
+      num_words * sizeof(uint32_t), thr_entry->stream,
+      indptr, indices, csr.num_rows, num_words, counts);
+  size_t workspace_size = 0;
+  CUDA_CALL(cub::DeviceReduce::Max(nullptr, workspace_size,
+      counts, max_count, num_block_rows, thr_entry->stream));
+  void* workspace = device->AllocWorkspace(ctx, workspace_size);
+  CUDA_CALL(cub::DeviceReduce::Max(workspace, workspace_size,
+      counts, max_count, num_block_rows, thr_entry->stream));
+  int64_t ell_width = 0;
+  runtime::CheckNotCapturing(thr_entry->stream, "Building the blocked-ELL format of SpMM");
+  device->CopyDataFromTo(max_count, 0, &ell_width, 0, sizeof(ell_width),
+      ctx, DGLContext{kDLCPU, 0}, DLDataType{kDLInt, 64, 1}, thr_entry->stream);
+  device->StreamSync(ctx, thr_entry->stream);
+  device->FreeWorkspace(ctx, workspace);
+  device->FreeWorkspace(ctx, max_count);
+  device->FreeWorkspace(ctx, counts);
+  const int64_t num_tiles = num_block_rows * ell_width;
+  if (nnz < kEllMinFill * num_tiles * kEllBlock * kEllBlock)
+    return plan;
+
+  plan->num_block_rows = num_block_rows;
+  plan->ell_width = ell_width;
+  plan->ell_cols = NewIdArray(num_tiles, ctx, 32);
+  plan->edge_pos = NewIdArray(nnz, ctx, 64);
+  CUDA_KERNEL_CALL(_EllBuildKernel<IdType>, num_block_rows, kEllBuildThreads,
+      2 * num_words * sizeof(uint32_t), thr_entry->stream,
+      indptr, indices, csr.num_rows, num_words, ell_width,
+      plan->ell_cols.Ptr<int32_t>(), plan->edge_pos.Ptr<int64_t>());
+  plan->ones = NDArray::Empty(
+      {num_tiles * kEllBlock * kEllBlock}, DLDataType{kDLFloat, 16, 1}, ctx);
+  CUDA_CALL(cudaMemsetAsync(plan->ones->data, 0,
+      plan->ones.NumElements() * sizeof(half), thr_entry->stream));
+  const int nt = FindNumThreads(nnz);
+  const int nb = (nnz + nt - 1) / nt;
+  CUDA_KERNEL_CALL((_EllScatterKernel<IdType, false>), nb, nt, 0, thr_entry->stream,
+      plan->edge_pos.Ptr<int64_t>(), nullptr, nullptr, nnz, plan->ones.Ptr<half>());
+  plan->use = true;
+  return plan;
+}
+
+/*!
+ * \brief SpMM with sum reduce on blocked-ELL format.
+ * \param plan The blocked-ELL format of csr.
+ * \param efeat The scalar edge weights, or an empty array for copy_lhs.
+ */
+template <typename IdType>
+void SpMMBlockedEll(
+    const SpMMBlockedEllPlan& plan, const CSRMatrix& csr,
+    NDArray ufeat, NDArray efeat, NDArray out, int64_t feat_len) {
+  const auto& ctx = ufeat->ctx;
+  auto device = runtime::DeviceAPI::Get(ctx);
+  auto* thr_entry = runtime::CUDAThreadEntry::ThreadLocal();
+  const int64_t tiles_size = plan.ones.NumElements() * sizeof(half);
+  const half* tiles = plan.ones.Ptr<half>();
+  half* weighted = nullptr;
+  if (!IsNullArray(efeat)) {
+    weighted = static_cast<half*>(device->AllocWorkspace(ctx, tiles_size));
+    CUDA_CALL(cudaMemsetAsync(weighted, 0, tiles_size, thr_entry->stream));
+    const int64_t nnz = csr.indices->shape[0];
+    const int nt = FindNumThreads(nnz);
+    const int nb = (nnz + nt - 1) / nt;
+    if (CSRHasData(csr)) {
+      CUDA_KERNEL_CALL((_EllScatterKernel<IdType, true>), nb, nt, 0, thr_entry->stream,
+          plan.edge_pos.Ptr<int64_t>(), efeat.Ptr<half>(), csr.data.Ptr<IdType>(),
+          nnz, weighted);
+    } else {
+      CUDA_KERNEL_CALL((_EllScatterKernel<IdType, false>), nb, nt, 0, thr_entry->stream,
+          plan.edge_pos.Ptr<int64_t>(), efeat.Ptr<half>(), nullptr, nnz, weighted);
+    }
+    tiles = weighted;
+  }
+  const int64_t num_feat_blocks = (feat_len + kEllBlock - 1) / kEllBlock;
+  const dim3 nblks(plan.num_block_rows, (num_feat_blocks + kEllWarps - 1) / kEllWarps);
+  const dim3 nthrs(32, kEllWarps);
+  CUDA_KERNEL_CALL(SpMMBlockedEllKernel, nblks, nthrs, 0, thr_entry->stream,
+      tiles, plan.ell_cols.Ptr<int32_t>(), ufeat.Ptr<half>(), out.Ptr<half>(),
+      csr.num_rows, csr.num_cols, plan.ell_width, feat_len);
+  if (weighted)
+    device->FreeWorkspace(ctx, weighted);
+}
+
+}  // namespace cuda
+}  // namespace aten
+}  // namespace dgl
+
+#endif  // USE_FP16
+
+#endif  // DGL_ARRAY_CUDA_SPMM_BLOCKED_ELL_CUH_
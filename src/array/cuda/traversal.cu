@@ -0,0 +1,436 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file array/cuda/traversal.cu
+ * \brief Graph traversal implementation on GPU
+ */
+
+#include <dgl/array.h>
+#include <dgl/graph_traversal.h>
+#include <dgl/runtime/device_api.h>
+#include <limits>
+#include <vector>
+
+#include "../../runtime/cuda/cuda_common.h"
+#include "../../runtime/workspace.h"
+#include "./atomic.cuh"
+#include "./dgl_cub.cuh"
+#include "./utils.h"
+
+namespace dgl {
+
+using runtime::NDArray;
+using runtime::Workspace;
+
+namespace aten {
+namespace impl {
+
+namespace {
+
+template <typename IdType>
+__global__ void _BFSVisitKernel(
+    const IdType* nodes, int64_t num_nodes, int8_t* visited) {
+  int64_t tx = blockIdx.x * blockDim.x + threadIdx.x;
+  const int64_t stride_x = gridDim.x * blockDim.x;
+  while (tx < num_nodes) {
+    visited[nodes[tx]] = 1;
+    tx += stride_x;
+  }
+}
+
+template <typename IdType>
+__global__ void _BFSDegreeKernel(
+    const IdType* frontier, int64_t size, const IdType* indptr, int64_t* degree) {
+  int64_t tx = blockIdx.x * blockDim.x + threadIdx.x;
+  const int64_t stride_x = gridDim.x * blockDim.x;
+  while (tx < size) {
+    degree[tx] = indptr[frontier[tx] + 1] - indptr[frontier[tx]];
+    tx += stride_x;
+  }
+}
+
+/*!
+ * \brief Take for every unvisited node the lowest rank of the edges from the
+ *        frontier to it, the rank of an edge being its position when expanding
+ *        the frontier in order.
+ */
+template <typename IdType>
+__global__ void _BFSRankKernel(
+    const IdType* frontier, int64_t size, const IdType* indptr, const IdType* indices,
+    const int64_t* prefix, const int8_t* visited, int64_t* rank) {
+  int64_t tx = blockIdx.x * blockDim.x + threadIdx.x;
+  const int64_t stride_x = gridDim.x * blockDim.x;
+  while (tx < size) {
+    const IdType u = frontier[tx];
+    for (IdType idx = indptr[u]; idx < indptr[u + 1]; ++idx) {
+      const IdType v = indices[idx];
+      if (!visited[v])
+        cuda::AtomicMin(rank + v, prefix[tx] + idx - indptr[u]);
+    }
+    tx += stride_x;
+  }
+}
+
+/*! \brief Flag the edges of the frontier which discover their destination. */
+template <typename IdType>
+__global__ void _BFSWinnerKernel(
+    const IdType* frontier, int64_t size, const IdType* indptr, const IdType* indices,
+    const IdType* eids, const int64_t* prefix, const int8_t* visited, const int64_t* rank,
+    IdType* cand_nodes, IdType* cand_edges, int8_t* is_winner) {
+  int64_t tx = blockIdx.x * blockDim.x + threadIdx.x;
+  const int64_t stride_x = gridDim.x * blockDim.x;
+  while (tx < size) {
+    const IdType u = frontier[tx];
+    for (IdType idx = indptr[u]; idx < indptr[u + 1]; ++idx) {
+      const IdType v = indices[idx];
+      const int64_t r = prefix[tx] + idx - indptr[u];
+      is_winner[r] = !visited[v] && rank[v] == r;
+      cand_nodes[r] = v;
+      if (cand_edges)
+        cand_edges[r] = eids ? eids[idx] : idx;
+    }
+    tx += stride_x;
+  }
+}
+
+template <typename IdType>
+__global__ void _TopoInDegreeKernel(
+    const IdType* indices, int64_t num_edges, int64_t* degree) {
+  int64_t tx = blockIdx.x * blockDim.x + threadIdx.x;
+  const int64_t stride_x = gridDim.x * blockDim.x;
+  while (tx < num_edges) {
+    cuda::AtomicAdd(degree + indices[tx], static_cast<int64_t>(1));
+    tx += stride_x;
+  }
+}
+
+__global__ void _TopoSourceKernel(
+    const int64_t* degree, int64_t num_nodes, int8_t* is_source) {
+  int64_t tx = blockIdx.x * blockDim.x + threadIdx.x;
+  const int64_t stride_x = gridDim.x * blockDim.x;
+  while (tx < num_nodes) {
+    is_source[tx] = degree[tx] == 0;
+    tx += stride_x;
+  }
+}
+
+template <typename IdType>
+__global__ void _TopoDecrementKernel(
+    const IdType* frontier, int64_t size, const IdType* indptr, const IdType* indices,
+    int64_t* degree) {
+  int64_t tx = blockIdx.x * blockDim.x + threadIdx.x;
+  const int64_t stride_x = gridDim.x * blockDim.x;
+  while (tx < size) {
+    const IdType u = frontier[tx];
+    for (IdType idx = indptr[u]; idx < indptr[u + 1]; ++idx)
+      cuda::AtomicAdd(degree + indices[idx], static_cast<int64_t>(-1));
+    tx += stride_x;
+  }
+}
+
+/*!
+ * \brief Take for every node reaching a zero in-degree one plus the highest rank
+ *        of the edges from the frontier to it.
+ */
+template <typename IdType>
+__global__ void _TopoRankKernel(
+    const IdType* frontier, int64_t size, const IdType* indptr, const IdType* indices,
+    const int64_t* prefix, const int64_t* degree, int64_t* rank) {
+  int64_t tx = blockIdx.x * blockDim.x + threadIdx.x;
+  const int64_t stride_x = gridDim.x * blockDim.x;
+  while (tx < size) {
+    const IdType u = frontier[tx];
+    for (IdType idx = indptr[u]; idx < indptr[u + 1]; ++idx) {
+      const IdType v = indices[idx];
+      if (degree[v] == 0)
+        cuda::AtomicMax(rank + v, prefix[tx] + idx - indptr[u] + 1);
+    }
+    tx += stride_x;
+  }
+}
+
+/*! \brief Flag the edges of the frontier which complete their destination. */
+template <typename IdType>
+__global__ void _TopoWinnerKernel(
+    const IdType* frontier, int64_t size, const IdType* indptr, const IdType* indices,
+    const int64_t* prefix, const int64_t* degree, const int64_t* rank,
+    IdType* cand_nodes, int8_t* is_winner) {
+  int64_t tx = blockIdx.x * blockDim.x + threadIdx.x;
+  const int64_t stride_x = gridDim.x * blockDim.x;
+  while (tx < size) {
+    const IdType u = frontier[tx];
+    for (IdType idx = indptr[u]; idx < indptr[u + 1]; ++idx) {
+      const IdType v = indices[idx];
+      const int64_t r = prefix[tx] + idx - indptr[u];
+      is_winner[r] = degree[v] == 0 && rank[v] == r + 1;
+      cand_nodes[r] = v;
+    }
+    tx += stride_x;
+  }
+}
+
+// Level-synchronous top-down BFS returning the frontiers of BFSTraverseNodes,
+// or the edges of BFSTraverseEdges, in the same order: the nodes of the next
+// frontier are compacted in the order of the edge discovering them first in
+// the serial expansion. The size of every frontier is read on the host.
+template <typename IdType>
+Frontiers BFSFrontiersGPU(const CSRMatrix& csr, IdArray source, bool return_edges) {
+  const auto& ctx = source->ctx;
+  auto device = runtime::DeviceAPI::Get(ctx);
+  cudaStream_t stream = runtime::CUDAThreadEntry::ThreadLocal()->stream;
+  const int64_t num_nodes = csr.num_rows;
+  const int64_t len = source->shape[0];
+  const uint8_t nbits = sizeof(IdType) * 8;
+  const IdType* indptr = csr.indptr.Ptr<IdType>();
+  const IdType* indices = csr.indices.Ptr<IdType>();
+  const IdType* eids = CSRHasData(csr) ? csr.data.Ptr<IdType>() : nullptr;
+
+  // every node is in a single frontier, apart from the sources given several times
+  IdArray nodes = NewIdArray(len + num_nodes, ctx, nbits);
+  IdArray edges = NewIdArray(return_edges ? num_nodes : 0, ctx, nbits);
+  IdArray rank = Full<int64_t>(std::numeric_limits<int64_t>::max(), num_nodes, ctx);
+  Workspace<int8_t> visited(device, ctx, num_nodes);
+  CUDA_CALL(cudaMemsetAsync(visited.get(), 0, num_nodes, stream));
+  Workspace<int64_t> d_num_selected(device, ctx, 1);
+  if (len > 0) {
+    device->CopyDataFromTo(source->data, 0, nodes->data, 0, len * sizeof(IdType),
+                           ctx, ctx, source->dtype, stream);
+    const int nt = cuda::FindNumThreads(len);
+    const int nb = (len + nt - 1) / nt;
+    CUDA_KERNEL_CALL(_BFSVisitKernel, nb, nt, 0, stream,
+        nodes.Ptr<IdType>(), len, visited.get());
+  }
+
+  std::vector<int64_t> sections;
+  if (!return_edges && len > 0)
+    sections.push_back(len);
+  int64_t begin = 0, size = len, num_visited = len, num_tree_edges = 0;
+  while (size > 0) {
+    const IdType* frontier = nodes.Ptr<IdType>() + begin;
+    const int nt = cuda::FindNumThreads(size);
+    const int nb = (size + nt - 1) / nt;
+
+    Workspace<int64_t> prefix(device, ctx, size + 1);
+    CUDA_CALL(cudaMemsetAsync(prefix.get() + size, 0, sizeof(int64_t), stream));
+    CUDA_KERNEL_CALL(_BFSDegreeKernel, nb, nt, 0, stream,
+        frontier, size, indptr, prefix.get());
+    size_t prefix_workspace_size = 0;
+    CUDA_CALL(cub::DeviceScan::ExclusiveSum(nullptr, prefix_workspace_size,
+        prefix.get(), prefix.get(), size + 1, stream));
+    Workspace<void> prefix_workspace(device, ctx, prefix_workspace_size);
+    CUDA_CALL(cub::DeviceScan::ExclusiveSum(prefix_workspace.get(), prefix_workspace_size,
+        prefix.get(), prefix.get(), size + 1, stream));
+    int64_t frontier_edges;
+    device->CopyDataFromTo(prefix.get(), size * sizeof(int64_t), &frontier_edges, 0,
+                           sizeof(int64_t), ctx, DGLContext{kDLCPU, 0},
+                           DLDataType{kDLInt, 64, 1}, stream);
+    device->StreamSync(ctx, stream);
+    if (frontier_edges == 0)
+      break;
+
+    CUDA_KERNEL_CALL(_BFSRankKernel, nb, nt, 0, stream,
+        frontier, size, indptr, indices, prefix.get(), visited.get(), rank.Ptr<int64_t>());
+    Workspace<IdType> cand_nodes(device, ctx, frontier_edges);
+    Workspace<IdType> cand_edges(device, ctx, return_edges ? frontier_edges : 1);
+    Workspace<int8_t> is_winner(device, ctx, frontier_edges);
+    CUDA_KERNEL_CALL(_BFSWinnerKernel, nb, nt, 0, stream,
+        frontier, size, indptr, indices, eids, prefix.get(), visited.get(),
+        rank.Ptr<int64_t>(), cand_nodes.get(), return_edges ? cand_edges.get() : nullptr,
+        is_winner.get());
+
+    // the winners in the order of their edges, appended to the frontiers
+    size_t select_workspace_size = 0;
+    CUDA_CALL(cub::DeviceSelect::Flagged(nullptr, select_workspace_size,
+        cand_nodes.get(), is_winner.get(), nodes.Ptr<IdType>() + num_visited,
+        d_num_selected.get(), frontier_edges, stream));
+    Workspace<void> select_workspace(device, ctx, select_workspace_size);
+    CUDA_CALL(cub::DeviceSelect::Flagged(select_workspace.get(), select_workspace_size,
+        cand_nodes.get(), is_winner.get(), nodes.Ptr<IdType>() + num_visited,
+        d_num_selected.get(), frontier_edges, stream));
+    if (return_edges) {
+      CUDA_CALL(cub::DeviceSelect::Flagged(select_workspace.get(), select_workspace_size,
+          cand_edges.get(), is_winner.get(), edges.Ptr<IdType>() + num_tree_edges,
+          d_num_selected.get(), frontier_edges, stream));
+    }
+    int64_t next_size;
+    device->CopyDataFromTo(d_num_selected.get(), 0, &next_size, 0, sizeof(int64_t),
+                           ctx, DGLContext{kDLCPU, 0}, DLDataType{kDLInt, 64, 1}, stream);
+    device->StreamSync(ctx, stream);
+
+    if (next_size > 0) {
+      const int vnt = cuda::FindNumThreads(next_size);
+      const int vnb = (next_size + vnt - 1) / vnt;
+      CUDA_KERNEL_CALL(_BFSVisitKernel, vnb, vnt, 0, stream,
+          nodes.Ptr<IdType>() + num_visited, next_size, visited.get());
+      sections.push_back(next_size);
+    }
+    begin = num_visited;
+    num_visited += next_size;
+    num_tree_edges += return_edges ? next_size : 0;
+    size = next_size;
+  }
+
+  Frontiers front;
+  front.ids = return_edges ?
+    edges.CreateView({num_tree_edges}, edges->dtype, 0) :
+    nodes.CreateView({num_visited}, nodes->dtype, 0);
+  front.sections = VecToIdArray(sections, sizeof(int64_t) * 8);
+  return front;
+}
+
+// Level-synchronous Kahn's algorithm returning the frontiers of
+// TopologicalNodes in the same order: the nodes of the next frontier are the
+// ones reaching a zero in-degree, compacted in the order of their last edge from
+// the frontier in the serial expansion. The size of every frontier is read on
+// the host.
+template <typename IdType>
+Frontiers TopologicalFrontiersGPU(const CSRMatrix& csr) {
+  const auto& ctx = csr.indptr->ctx;
+  auto device = runtime::DeviceAPI::Get(ctx);
+  cudaStream_t stream = runtime::CUDAThreadEntry::ThreadLocal()->stream;
+  const int64_t num_nodes = csr.num_rows;
+  const int64_t num_edges = csr.indices->shape[0];
+  const uint8_t nbits = sizeof(IdType) * 8;
+  const IdType* indptr = csr.indptr.Ptr<IdType>();
+  const IdType* indices = csr.indices.Ptr<IdType>();
+
+  IdArray nodes = NewIdArray(num_nodes, ctx, nbits);
+  std::vector<int64_t> sections;
+  if (num_nodes == 0) {
+    Frontiers front;
+    front.ids = nodes;
+    front.sections = VecToIdArray(sections, sizeof(int64_t) * 8);
+    return front;
+  }
+  IdArray degree = Full<int64_t>(0, num_nodes, ctx);
+  // one plus the highest rank, only taken on the step of a node
+  IdArray rank = Full<int64_t>(0, num_nodes, ctx);
+  Workspace<int64_t> d_num_selected(device, ctx, 1);
+  if (num_edges > 0) {
+    const int nt = cuda::FindNumThreads(num_edges);
+    const int nb = (num_edges + nt - 1) / nt;
+    CUDA_KERNEL_CALL(_TopoInDegreeKernel, nb, nt, 0, stream,
+        indices, num_edges, degree.Ptr<int64_t>());
+  }
+
+  // the nodes without in-edges in increasing order
+  {
+    Workspace<int8_t> is_source(device, ctx, num_nodes);
+    const int nt = cuda::FindNumThreads(num_nodes);
+    const int nb = (num_nodes + nt - 1) / nt;
+    CUDA_KERNEL_CALL(_TopoSourceKernel, nb, nt, 0, stream,
+        degree.Ptr<int64_t>(), num_nodes, is_source.get());
+    cub::CountingInputIterator<IdType> node_ids(0);
+    size_t select_workspace_size = 0;
+    CUDA_CALL(cub::DeviceSelect::Flagged(nullptr, select_workspace_size,
+        node_ids, is_source.get(), nodes.Ptr<IdType>(), d_num_selected.get(), num_nodes,
+        stream));
+    Workspace<void> select_workspace(device, ctx, select_workspace_size);
+    CUDA_CALL(cub::DeviceSelect::Flagged(select_workspace.get(), select_workspace_size,
+        node_ids, is_source.get(), nodes.Ptr<IdType>(), d_num_selected.get(), num_nodes,
+        stream));
+  }
+  int64_t size;
+  device->CopyDataFromTo(d_num_selected.get(), 0, &size, 0, sizeof(int64_t),
+                         ctx, DGLContext{kDLCPU, 0}, DLDataType{kDLInt, 64, 1}, stream);
+  device->StreamSync(ctx, stream);
+  if (size > 0)
+    sections.push_back(size);
+
+  int64_t begin = 0, num_visited = size;
+  while (size > 0) {
+    const IdType* frontier = nodes.Ptr<IdType>() + begin;
+    const int nt = cuda::FindNumThreads(size);
+    const int nb = (size + nt - 1) / nt;
+
+    Workspace<int64_t> prefix(device, ctx, size + 1);
+    CUDA_CALL(cudaMemsetAsync(prefix.get() + size, 0, sizeof(int64_t), stream));
+    CUDA_KERNEL_CALL(_BFSDegreeKernel, nb, nt, 0, stream,
+        frontier, size, indptr, prefix.get());
+    size_t prefix_workspace_size = 0;
+    CUDA_CALL(cub::DeviceScan::ExclusiveSum(nullptr, prefix_workspace_size,
+        prefix.get(), prefix.get(), size + 1, stream));
+    Workspace<void> prefix_workspace(device, ctx, prefix_workspace_size);
+    CUDA_CALL(cub::DeviceScan::ExclusiveSum(prefix_workspace.get(), prefix_workspace_size,
+        prefix.get(), prefix.get(), size + 1, stream));
+    int64_t frontier_edges;
+    device->CopyDataFromTo(prefix.get(), size * sizeof(int64_t), &frontier_edges, 0,
+                           sizeof(int64_t), ctx, DGLContext{kDLCPU, 0},
+                           DLDataType{kDLInt, 64, 1}, stream);
+    device->StreamSync(ctx, stream);
+    if (frontier_edges == 0)
+      break;
+
+    CUDA_KERNEL_CALL(_TopoDecrementKernel, nb, nt, 0, stream,
+        frontier, size, indptr, indices, degree.Ptr<int64_t>());
+    CUDA_KERNEL_CALL(_TopoRankKernel, nb, nt, 0, stream,
+        frontier, size, indptr, indices, prefix.get(), degree.Ptr<int64_t>(),
+        rank.Ptr<int64_t>());
+    Workspace<IdType> cand_nodes(device, ctx, frontier_edges);
+    Workspace<int8_t> is_winner(device, ctx, frontier_edges);
+    CUDA_KERNEL_CALL(_TopoWinnerKernel, nb, nt, 0, stream,
+        frontier, size, indptr, indices, prefix.get(), degree.Ptr<int64_t>(),
+        rank.Ptr<int64_t>(), cand_nodes.get(), is_winner.get());
+
+    // the winners in the order of their edges, appended to the frontiers
+    size_t select_workspace_size = 0;
+    CUDA_CALL(cub::DeviceSelect::Flagged(nullptr, select_workspace_size,
+        cand_nodes.get(), is_winner.get(), nodes.Ptr<IdType>() + num_visited,
+        d_num_selected.get(), frontier_edges, stream));
+    Workspace<void> select_workspace(device, ctx, select_workspace_size);
+    CUDA_CALL(cub::DeviceSelect::Flagged(select_workspace.get(), select_workspace_size,
+        cand_nodes.get(), is_winner.get(), nodes.Ptr<IdType>() + num_visited,
+        d_num_selected.get(), frontier_edges, stream));
+    int64_t next_size;
+    device->CopyDataFromTo(d_num_selected.get(), 0, &next_size, 0, sizeof(int64_t),
+                           ctx, DGLContext{kDLCPU, 0}, DLDataType{kDLInt, 64, 1}, stream);
+    device->StreamSync(ctx, stream);
+
+    if (next_size > 0)
+      sections.push_back(next_size);
+    begin = num_visited;
+    num_visited += next_size;
+    size = next_size;
+  }
+
+  if (num_visited != num_nodes) {
+    LOG(FATAL) << "Error in topological traversal: loop detected in the given graph.";
+  }
+  Frontiers front;
+  front.ids = nodes;
+  front.sections = VecToIdArray(sections, sizeof(int64_t) * 8);
+  return front;
+}
+
+}  // namespace
+
+template <DLDeviceType XPU, typename IdType>
+Frontiers BFSNodesFrontiers(const CSRMatrix& csr, const CSRMatrix& transpose, IdArray source) {
+  return BFSFrontiersGPU<IdType>(csr, source, false);
+}
+
+template Frontiers BFSNodesFrontiers<kDLGPU, int32_t>(const CSRMatrix&, const CSRMatrix&,
+                                                      IdArray);
+template Frontiers BFSNodesFrontiers<kDLGPU, int64_t>(const CSRMatrix&, const CSRMatrix&,
+                                                      IdArray);
+
+template <DLDeviceType XPU, typename IdType>
+Frontiers BFSEdgesFrontiers(const CSRMatrix& csr, const CSRMatrix& transpose, IdArray source) {
+  return BFSFrontiersGPU<IdType>(csr, source, true);
+}
+
+template Frontiers BFSEdgesFrontiers<kDLGPU, int32_t>(const CSRMatrix&, const CSRMatrix&,
+                                                      IdArray);
+template Frontiers BFSEdgesFrontiers<kDLGPU, int64_t>(const CSRMatrix&, const CSRMatrix&,
+                                                      IdArray);
+
+template <DLDeviceType XPU, typename IdType>
+Frontiers TopologicalNodesFrontiers(const CSRMatrix& csr) {
+  return TopologicalFrontiersGPU<IdType>(csr);
+}
+
+template Frontiers TopologicalNodesFrontiers<kDLGPU, int32_t>(const CSRMatrix&);
+template Frontiers TopologicalNodesFrontiers<kDLGPU, int64_t>(const CSRMatrix&);
+
+}  // namespace impl
+}  // namespace aten
+}  // namespace dgl
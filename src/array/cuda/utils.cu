@@ -5,22 +5,58 @@
  */
 
 #include "./utils.h"
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
 #include "./dgl_cub.cuh"
 #include "../../runtime/cuda/cuda_common.h"
+#include "../../runtime/cuda/cuda_graph.h"
 
 namespace dgl {
 namespace cuda {
 
+bool DeterministicEnabled() {
+  static const bool enabled = [] {
+    const char* var = std::getenv("DGL_CUDA_DETERMINISTIC");
+    return var && std::string(var) == "1";
+  }();
+  return enabled;
+}
+
+int64_t* BcastOffsetOnDevice(const DLContext& ctx, const std::vector<int64_t>& offset) {
+  static std::mutex mutex;
+  static std::map<std::pair<int, std::vector<int64_t>>, int64_t*> cache;
+  std::lock_guard<std::mutex> lock(mutex);
+  auto it = cache.find({ctx.device_id, offset});
+  if (it != cache.end())
+    return it->second;
+  runtime::CheckNotCapturing(runtime::CUDAThreadEntry::ThreadLocal()->stream,
+                             "Copying new broadcasting offsets");
+  const size_t size = sizeof(int64_t) * offset.size();
+  int64_t* ptr = static_cast<int64_t*>(runtime::DeviceAPI::Get(ctx)->AllocDataSpace(
+      ctx, size, sizeof(int64_t), DLDataType{kDLInt, 64, 1}));
+  cudaStream_t stream = runtime::CUDAThreadEntry::ThreadLocal()->stream;
+  CUDA_CALL(cudaMemcpyAsync(ptr, offset.data(), size, cudaMemcpyHostToDevice, stream));
+  CUDA_CALL(cudaStreamSynchronize(stream));
+  cache.emplace(std::make_pair(ctx.device_id, offset), ptr);
+  return ptr;
+}
+
 bool AllTrue(int8_t* flags, int64_t length, const DLContext& ctx) {
   auto device = runtime::DeviceAPI::Get(ctx);
+  cudaStream_t stream = runtime::CUDAThreadEntry::ThreadLocal()->stream;
   int8_t* rst = static_cast<int8_t*>(device->AllocWorkspace(ctx, 1));
   // Call CUB's reduction
   size_t workspace_size = 0;
-  CUDA_CALL(cub::DeviceReduce::Min(nullptr, workspace_size, flags, rst, length));
+  CUDA_CALL(cub::DeviceReduce::Min(nullptr, workspace_size, flags, rst, length, stream));
   void* workspace = device->AllocWorkspace(ctx, workspace_size);
-  CUDA_CALL(cub::DeviceReduce::Min(workspace, workspace_size, flags, rst, length));
+  CUDA_CALL(cub::DeviceReduce::Min(workspace, workspace_size, flags, rst, length, stream));
   int8_t cpu_rst = 0;
-  CUDA_CALL(cudaMemcpy(&cpu_rst, rst, 1, cudaMemcpyDeviceToHost));
+  CUDA_CALL(cudaMemcpyAsync(&cpu_rst, rst, 1, cudaMemcpyDeviceToHost, stream));
+  CUDA_CALL(cudaStreamSynchronize(stream));
   device->FreeWorkspace(ctx, workspace);
   device->FreeWorkspace(ctx, rst);
   return cpu_rst == 1;
@@ -8,6 +8,7 @@
 
 #include <dmlc/logging.h>
 #include <dlpack/dlpack.h>
+#include <vector>
 #include "../../runtime/cuda/cuda_common.h"
 
 namespace dgl {
@@ -65,6 +66,28 @@ inline int FindNumThreads(int dim, int max_nthrs = CUDA_MAX_NUM_THREADS) {
   return ret;
 }
 
+/*!
+ * \brief Calculate the number of bits needed to store the integers in [0, range),
+ *        so that the radix sorts only go over these bits.
+ */
+template <typename T>
+inline int NumberOfBits(const T& range) {
+  if (range <= 1) {
+    // ranges of 0 or 1 require no bits to store
+    return 0;
+  }
+
+  int bits = 1;
+  while (bits < static_cast<int>(sizeof(T)*8) && (static_cast<T>(1) << bits) < range) {
+    ++bits;
+  }
+
+  CHECK_EQ((range-1) >> bits, 0);
+  CHECK_NE((range-1) >> (bits-1), 0);
+
+  return bits;
+}
+
 /*
  * !\brief Find number of blocks is smaller than nblks and max_nblks
  * on the given axis ('x', 'y' or 'z').
@@ -103,6 +126,46 @@ __device__ __forceinline__ T _ldg(T* addr) {
 #endif
 }
 
+/*!
+ * \brief Find the first position in [start, end) of a sorted array whose value
+ *        is not less than the given one.
+ */
+template <typename IdType>
+__device__ __forceinline__ IdType _LowerBound(
+    const IdType* array, IdType start, IdType end, IdType value) {
+  while (start < end) {
+    const IdType mid = start + (end - start) / 2;
+    if (_ldg(array + mid) < value)
+      start = mid + 1;
+    else
+      end = mid;
+  }
+  return start;
+}
+
+/*!
+ * \brief Whether the CUDA kernels must be deterministic, i.e. avoid the atomic
+ *        reductions whose order changes from run to run.
+ *
+ * The deterministic mode is opt-in, by setting the environment variable
+ * DGL_CUDA_DETERMINISTIC=1. In this mode SpMM on Coo format reduces the edges
+ * sorted by destination, and scatter add reduces the rows sorted by index.
+ */
+bool DeterministicEnabled();
+
+/*!
+ * \brief Return a device copy of the broadcasting offsets.
+ *
+ * The copies are cached per device and never freed, their number is bounded by
+ * the number of different broadcasting shapes. The kernels can thus read them
+ * without a synchronous copy and a CUDA graph capturing the kernels can replay
+ * them, provided the shapes were seen once before the capture.
+ *
+ * \param ctx The device context.
+ * \param offset The broadcasting offsets on the host.
+ */
+int64_t* BcastOffsetOnDevice(const DLContext& ctx, const std::vector<int64_t>& offset);
+
 /*!
  * \brief Return true if the given bool flag array is all true.
  * The input bool array is in int8_t type so it is aligned with byte address.
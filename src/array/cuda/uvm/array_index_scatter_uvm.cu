@@ -0,0 +1,179 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file array/cuda/uvm/array_index_scatter_uvm.cu
+ * \brief Array index scatter from the GPU to a pinned host array
+ */
+#include <dgl/array.h>
+#include "../../../runtime/cuda/cuda_common.h"
+#include "../../../runtime/cuda/cuda_hashtable.cuh"
+#include "../atomic.cuh"
+#include "./array_index_select_uvm.cuh"
+#include "../utils.h"
+
+namespace dgl {
+using runtime::NDArray;
+namespace aten {
+namespace impl {
+
+namespace {
+
+/*! \brief The blocks of the row kernels, a row per threadIdx.y. */
+inline dim3 RowBlock(const int64_t num_feat) {
+  dim3 block(256, 1);
+  while (static_cast<int64_t>(block.x) >= 2 * num_feat) {
+    block.x /= 2;
+    block.y *= 2;
+  }
+  return block;
+}
+
+/*!
+ * \brief The scatter counterpart of IndexSelectMultiKernelAligned: the writes
+ *        over PCIe start at a cache line of the destination row.
+ */
+template <typename DType, typename IdType>
+__global__ void _IndexScatterMultiKernelAligned(
+    const DType* const source, const int64_t num_feat, const IdType* const index,
+    const int64_t length, const int64_t arr_len, const bool aligned, DType* const out) {
+  int64_t in_row = blockIdx.x * blockDim.y + threadIdx.y;
+  const int64_t stride = blockDim.y * gridDim.x;
+  while (in_row < length) {
+    const int64_t out_row = index[in_row];
+    assert(out_row >= 0 && out_row < arr_len);
+    int64_t col = threadIdx.x;
+    if (aligned)
+      col -= ((uint64_t)(&out[out_row * num_feat]) % CACHE_LINE_SIZE) / sizeof(DType);
+    for (; col < num_feat; col += blockDim.x) {
+      if (col >= 0)
+        out[out_row * num_feat + col] = source[in_row * num_feat + col];
+    }
+    in_row += stride;
+  }
+}
+
+/*! \brief Sum the rows of the source by their position in the unique index. */
+template <typename DType, typename IdType>
+__global__ void _SumDuplicatesKernel(
+    const runtime::cuda::DeviceOrderedHashTable<IdType> table,
+    const DType* const source, const int64_t num_feat, const IdType* const index,
+    const int64_t length, DType* const sums) {
+  int64_t in_row = blockIdx.x * blockDim.y + threadIdx.y;
+  const int64_t stride = blockDim.y * gridDim.x;
+  while (in_row < length) {
+    const int64_t out_row = table.Search(index[in_row])->local;
+    for (int64_t col = threadIdx.x; col < num_feat; col += blockDim.x)
+      cuda::AtomicAdd(sums + out_row * num_feat + col, source[in_row * num_feat + col]);
+    in_row += stride;
+  }
+}
+
+/*!
+ * \brief Add the summed rows to the distinct rows of the destination. Since
+ *        the rows are distinct, every element is read and written once, and
+ *        no atomic operation crosses PCIe.
+ */
+template <typename DType, typename IdType>
+__global__ void _AddUniqueKernelAligned(
+    const DType* const sums, const int64_t num_feat, const IdType* const unique,
+    const int64_t* const num_unique, const int64_t arr_len, const bool aligned,
+    DType* const out) {
+  int64_t in_row = blockIdx.x * blockDim.y + threadIdx.y;
+  const int64_t stride = blockDim.y * gridDim.x;
+  // the grid covers any number of distinct rows, so it needs no synchronization
+  const int64_t length = *num_unique;
+  while (in_row < length) {
+    const int64_t out_row = unique[in_row];
+    assert(out_row >= 0 && out_row < arr_len);
+    int64_t col = threadIdx.x;
+    if (aligned)
+      col -= ((uint64_t)(&out[out_row * num_feat]) % CACHE_LINE_SIZE) / sizeof(DType);
+    for (; col < num_feat; col += blockDim.x) {
+      if (col >= 0)
+        out[out_row * num_feat + col] += sums[in_row * num_feat + col];
+    }
+    in_row += stride;
+  }
+}
+
+/*! \return The number of elements of a row of the array, checking the source. */
+int64_t NumFeat(NDArray array, IdArray index, NDArray source) {
+  CHECK_EQ(array->ctx.device_type, kDLCPU);
+  CHECK_EQ(index->ctx.device_type, kDLGPU);
+  CHECK(source->ctx == index->ctx) << "The source must be on the GPU of the index.";
+  CHECK_EQ(source->ndim, array->ndim) << "The source must have the rank of the array.";
+  CHECK_EQ(source->shape[0], index->shape[0])
+    << "The source must have a row per index.";
+  CHECK_EQ(source->dtype, array->dtype) << "The source must have the dtype of the array.";
+  int64_t num_feat = 1;
+  for (int d = 1; d < array->ndim; ++d) {
+    CHECK_EQ(source->shape[d], array->shape[d])
+      << "The rows of the source must have the shape of the rows of the array.";
+    num_feat *= array->shape[d];
+  }
+  return num_feat;
+}
+
+}  // namespace
+
+template <typename DType, typename IdType>
+void IndexScatterGPUToCPU(NDArray array, IdArray index, NDArray source) {
+  const int64_t num_feat = NumFeat(array, index, source);
+  const int64_t len = index->shape[0];
+  if (len == 0)
+    return;
+  auto* thr_entry = runtime::CUDAThreadEntry::ThreadLocal();
+  const dim3 block = RowBlock(num_feat);
+  const dim3 grid((len + block.y - 1) / block.y);
+  const bool aligned = num_feat * sizeof(DType) >= 2 * CACHE_LINE_SIZE;
+  CUDA_KERNEL_CALL((_IndexScatterMultiKernelAligned<DType, IdType>), grid, block, 0,
+      thr_entry->stream, source.Ptr<DType>(), num_feat, index.Ptr<IdType>(), len,
+      array->shape[0], aligned, array.Ptr<DType>());
+}
+
+template <typename DType, typename IdType>
+void IndexAddGPUToCPU(NDArray array, IdArray index, NDArray source) {
+  const int64_t num_feat = NumFeat(array, index, source);
+  const int64_t len = index->shape[0];
+  if (len == 0)
+    return;
+  const DLContext ctx = index->ctx;
+  auto device = runtime::DeviceAPI::Get(ctx);
+  cudaStream_t stream = runtime::CUDAThreadEntry::ThreadLocal()->stream;
+
+  // sum the rows of the duplicate indices on the GPU first
+  runtime::cuda::OrderedHashTable<IdType> table(len, ctx, stream);
+  IdArray unique = NewIdArray(len, ctx, sizeof(IdType) * 8);
+  int64_t* num_unique = static_cast<int64_t*>(device->AllocWorkspace(ctx, sizeof(int64_t)));
+  table.FillWithDuplicates(index.Ptr<IdType>(), len, unique.Ptr<IdType>(), num_unique,
+                           stream);
+  std::vector<int64_t> shape(source->shape, source->shape + source->ndim);
+  NDArray sums = Full<DType>(0, len * num_feat, ctx).CreateView(shape, source->dtype);
+
+  const dim3 block = RowBlock(num_feat);
+  const dim3 grid((len + block.y - 1) / block.y);
+  CUDA_KERNEL_CALL((_SumDuplicatesKernel<DType, IdType>), grid, block, 0, stream,
+      table.DeviceHandle(), source.Ptr<DType>(), num_feat, index.Ptr<IdType>(), len,
+      sums.Ptr<DType>());
+  const bool aligned = num_feat * sizeof(DType) >= 2 * CACHE_LINE_SIZE;
+  CUDA_KERNEL_CALL((_AddUniqueKernelAligned<DType, IdType>), grid, block, 0, stream,
+      sums.Ptr<DType>(), num_feat, unique.Ptr<IdType>(), num_unique, array->shape[0],
+      aligned, array.Ptr<DType>());
+  device->FreeWorkspace(ctx, num_unique);
+}
+
+template void IndexScatterGPUToCPU<int8_t, int32_t>(NDArray, IdArray, NDArray);
+template void IndexScatterGPUToCPU<int8_t, int64_t>(NDArray, IdArray, NDArray);
+template void IndexScatterGPUToCPU<int16_t, int32_t>(NDArray, IdArray, NDArray);
+template void IndexScatterGPUToCPU<int16_t, int64_t>(NDArray, IdArray, NDArray);
+template void IndexScatterGPUToCPU<int32_t, int32_t>(NDArray, IdArray, NDArray);
+template void IndexScatterGPUToCPU<int32_t, int64_t>(NDArray, IdArray, NDArray);
+template void IndexScatterGPUToCPU<int64_t, int32_t>(NDArray, IdArray, NDArray);
+template void IndexScatterGPUToCPU<int64_t, int64_t>(NDArray, IdArray, NDArray);
+template void IndexAddGPUToCPU<float, int32_t>(NDArray, IdArray, NDArray);
+template void IndexAddGPUToCPU<float, int64_t>(NDArray, IdArray, NDArray);
+template void IndexAddGPUToCPU<double, int32_t>(NDArray, IdArray, NDArray);
+template void IndexAddGPUToCPU<double, int64_t>(NDArray, IdArray, NDArray);
+
+}  // namespace impl
+}  // namespace aten
+}  // namespace dgl
@@ -62,6 +62,46 @@ NDArray IndexSelectCPUFromGPU(NDArray array, IdArray index) {
   return ret;
 }
 
+template<typename DType, typename IdType>
+NDArray IndexSelectCPUFromGPUSorted(NDArray array, IdArray index) {
+  auto* thr_entry = runtime::CUDAThreadEntry::ThreadLocal();
+  const int64_t arr_len = array->shape[0];
+  const int64_t len = index->shape[0];
+  int64_t num_feat = 1;
+  std::vector<int64_t> shape{len};
+
+  CHECK_EQ(array->ctx.device_type, kDLCPU);
+  CHECK_EQ(index->ctx.device_type, kDLGPU);
+
+  for (int d = 1; d < array->ndim; ++d) {
+    num_feat *= array->shape[d];
+    shape.emplace_back(array->shape[d]);
+  }
+
+  NDArray ret = NDArray::Empty(shape, array->dtype, index->ctx);
+  if (len == 0)
+    return ret;
+
+  // sort only the bits of the row ids, keeping the positions in the index
+  int num_bits = 1;
+  while (num_bits < 63 && (int64_t{1} << num_bits) < arr_len)
+    ++num_bits;
+  const auto sorted = aten::Sort(index, num_bits);
+
+  const int64_t row_bytes = num_feat * sizeof(DType);
+  const bool vectorized = row_bytes % sizeof(uint4) == 0 &&
+    reinterpret_cast<uintptr_t>(array->data) % sizeof(uint4) == 0 &&
+    reinterpret_cast<uintptr_t>(ret->data) % sizeof(uint4) == 0;
+  // a warp per row, and enough rows per block
+  const dim3 block(32, 8);
+  const dim3 grid((len+block.y-1)/block.y);
+  CUDA_KERNEL_CALL(IndexSelectSortedWarpKernel, grid, block, 0,
+      thr_entry->stream, static_cast<const DType*>(array->data), num_feat,
+      sorted.first.Ptr<IdType>(), sorted.second.Ptr<int64_t>(), len, arr_len,
+      vectorized, ret.Ptr<DType>());
+  return ret;
+}
+
 template NDArray IndexSelectCPUFromGPU<int8_t, int32_t>(NDArray, IdArray);
 template NDArray IndexSelectCPUFromGPU<int8_t, int64_t>(NDArray, IdArray);
 template NDArray IndexSelectCPUFromGPU<int16_t, int32_t>(NDArray, IdArray);
@@ -72,6 +112,14 @@ template NDArray IndexSelectCPUFromGPU<int64_t, int32_t>(NDArray, IdArray);
 template NDArray IndexSelectCPUFromGPU<int64_t, int64_t>(NDArray, IdArray);
 template NDArray IndexSelectCPUFromGPU<float, int32_t>(NDArray, IdArray);
 template NDArray IndexSelectCPUFromGPU<float, int64_t>(NDArray, IdArray);
+template NDArray IndexSelectCPUFromGPUSorted<int8_t, int32_t>(NDArray, IdArray);
+template NDArray IndexSelectCPUFromGPUSorted<int8_t, int64_t>(NDArray, IdArray);
+template NDArray IndexSelectCPUFromGPUSorted<int16_t, int32_t>(NDArray, IdArray);
+template NDArray IndexSelectCPUFromGPUSorted<int16_t, int64_t>(NDArray, IdArray);
+template NDArray IndexSelectCPUFromGPUSorted<int32_t, int32_t>(NDArray, IdArray);
+template NDArray IndexSelectCPUFromGPUSorted<int32_t, int64_t>(NDArray, IdArray);
+template NDArray IndexSelectCPUFromGPUSorted<int64_t, int32_t>(NDArray, IdArray);
+template NDArray IndexSelectCPUFromGPUSorted<int64_t, int64_t>(NDArray, IdArray);
 
 }  // namespace impl
 }  // namespace aten
@@ -45,6 +45,43 @@ __global__ void IndexSelectMultiKernelAligned(
   }
 }
 
+/*  This is a version of IndexSelectMultiKernelAligned for a sorted index,
+*   where a warp reads a row, with 128-bit loads if vectorized, so that the
+*   adjacent rows are read by consecutive requests over PCIe. The rows are
+*   written at their positions in the original index, perm.
+*/
+template <typename DType, typename IdType>
+__global__ void IndexSelectSortedWarpKernel(
+        const DType* const array,
+        const int64_t num_feat,
+        const IdType* const sorted_index,
+        const int64_t* const perm,
+        const int64_t length,
+        const int64_t arr_len,
+        const bool vectorized,
+        DType* const out) {
+  int64_t row = blockIdx.x*blockDim.y+threadIdx.y;
+
+  const int64_t stride = blockDim.y*gridDim.x;
+
+  while (row < length) {
+    const int64_t in_row = sorted_index[row];
+    assert(in_row >= 0 && in_row < arr_len);
+    const int64_t out_row = perm[row];
+    if (vectorized) {
+      const uint4* const src = reinterpret_cast<const uint4*>(array + in_row*num_feat);
+      uint4* const dst = reinterpret_cast<uint4*>(out + out_row*num_feat);
+      const int64_t num_vec = num_feat*sizeof(DType)/sizeof(uint4);
+      for (int64_t v = threadIdx.x; v < num_vec; v += blockDim.x)
+        dst[v] = src[v];
+    } else {
+      for (int64_t col = threadIdx.x; col < num_feat; col += blockDim.x)
+        out[out_row*num_feat+col] = array[in_row*num_feat+col];
+    }
+    row += stride;
+  }
+}
+
 }  // namespace impl
 }  // namespace aten
 }  // namespace dgl
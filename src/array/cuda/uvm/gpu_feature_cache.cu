@@ -0,0 +1,264 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file array/cuda/uvm/gpu_feature_cache.cu
+ * \brief A GPU cache of the rows of a pinned host array read by UVM.
+ */
+#include "./gpu_feature_cache.cuh"
+
+#include <dgl/runtime/container.h>
+#include <dgl/runtime/device_api.h>
+#include <dgl/runtime/registry.h>
+#include <dgl/packed_func_ext.h>
+#include <algorithm>
+
+#include "../../../runtime/cuda/cuda_common.h"
+#include "../../../runtime/cuda/cuda_hashtable.cuh"
+#include "../../uvm_array_op.h"
+#include "./array_index_select_uvm.cuh"
+
+using namespace dgl::runtime;
+
+namespace dgl {
+namespace aten {
+
+namespace {
+
+constexpr int BLOCK_SIZE = 256;
+
+inline int64_t NumBlocks(const int64_t n) {
+  return (n + BLOCK_SIZE - 1) / BLOCK_SIZE;
+}
+
+/*! \brief The blocks of IndexSelectMultiKernel, a row per threadIdx.y. */
+inline dim3 RowBlock(const int64_t num_feat) {
+  dim3 block(256, 1);
+  while (static_cast<int64_t>(block.x) >= 2 * num_feat) {
+    block.x /= 2;
+    block.y *= 2;
+  }
+  return block;
+}
+
+/*!
+ * \brief Gather the rows of the cached slots from the buffer, and the others
+ *        from the host array, counting the hits and the misses.
+ */
+template <typename DType, typename IdType>
+__global__ void _CachedIndexSelectKernel(
+    const DType* const array, const DType* const buffer, const int64_t num_feat,
+    const IdType* const index, const int64_t* const slots, const int64_t length,
+    const int64_t arr_len, const bool aligned, DType* const out, int64_t* const counts) {
+  int64_t out_row = blockIdx.x * blockDim.y + threadIdx.y;
+  const int64_t stride = blockDim.y * gridDim.x;
+  unsigned long long num_hits = 0, num_misses = 0;  // NOLINT
+  while (out_row < length) {
+    const int64_t slot = slots[out_row];
+    if (slot >= 0) {
+      for (int64_t col = threadIdx.x; col < num_feat; col += blockDim.x)
+        out[out_row * num_feat + col] = buffer[slot * num_feat + col];
+      ++num_hits;
+    } else {
+      const int64_t in_row = index[out_row];
+      assert(in_row >= 0 && in_row < arr_len);
+      // the reads over PCIe start at a cache line, as in IndexSelectMultiKernelAligned
+      int64_t col = threadIdx.x;
+      if (aligned)
+        col -= ((uint64_t)(&array[in_row * num_feat]) % CACHE_LINE_SIZE) / sizeof(DType);
+      for (; col < num_feat; col += blockDim.x) {
+        if (col >= 0)
+          out[out_row * num_feat + col] = array[in_row * num_feat + col];
+      }
+      ++num_misses;
+    }
+    out_row += stride;
+  }
+  if (threadIdx.x == 0) {
+    if (num_hits > 0)
+      atomicAdd(reinterpret_cast<unsigned long long*>(counts), num_hits);  // NOLINT
+    if (num_misses > 0)
+      atomicAdd(reinterpret_cast<unsigned long long*>(counts + 1), num_misses);  // NOLINT
+  }
+}
+
+/*!
+ * \brief Give the next dynamic slots to the first missed rows, in the order of
+ *        the ring, and find the rows of the output they are copied from.
+ */
+__global__ void _AdmitKernel(
+    const runtime::cuda::DeviceOrderedHashTable<int64_t> misses,
+    const int64_t* const unique, const int64_t num_admitted, const int64_t* const miss_pos,
+    const int64_t slot_begin, const int64_t num_dynamic, const int64_t next_slot,
+    int64_t* const slot_ids, int64_t* const new_slots, int64_t* const evicted,
+    int64_t* const src_rows) {
+  const int64_t tx = blockIdx.x * blockDim.x + threadIdx.x;
+  if (tx < num_admitted) {
+    const int64_t slot = slot_begin + (next_slot + tx) % num_dynamic;
+    evicted[tx] = slot_ids[slot];
+    slot_ids[slot] = unique[tx];
+    new_slots[tx] = slot;
+    src_rows[tx] = miss_pos[misses.Search(unique[tx])->index];
+  }
+}
+
+template <typename DType>
+__global__ void _CopyRowsKernel(
+    const DType* const src, const int64_t* const src_rows, DType* const dst,
+    const int64_t* const dst_rows, const int64_t length, const int64_t num_feat) {
+  int64_t row = blockIdx.x * blockDim.y + threadIdx.y;
+  const int64_t stride = blockDim.y * gridDim.x;
+  while (row < length) {
+    for (int64_t col = threadIdx.x; col < num_feat; col += blockDim.x)
+      dst[dst_rows[row] * num_feat + col] = src[src_rows[row] * num_feat + col];
+    row += stride;
+  }
+}
+
+}  // namespace
+
+GPUFeatureCache::GPUFeatureCache(NDArray array, DGLContext ctx, int64_t capacity, bool dynamic)
+  : array_(array), ctx_(ctx), capacity_(capacity), dynamic_(dynamic) {
+  CHECK_EQ(array->ctx.device_type, kDLCPU) << "The cached array must be on the CPU.";
+  CHECK(array.IsPinned()) << "The cached array must be pinned.";
+  CHECK_EQ(ctx.device_type, kDLGPU) << "The cache must be on a GPU.";
+  CHECK_GE(array->ndim, 1) << "Only support array with at least 1 dimension";
+  CHECK_GT(capacity, 0) << "The cache must hold at least one row.";
+  capacity_ = std::min(capacity, array->shape[0]);
+  num_feat_ = 1;
+  std::vector<int64_t> shape{capacity_};
+  for (int d = 1; d < array->ndim; ++d) {
+    num_feat_ *= array->shape[d];
+    shape.push_back(array->shape[d]);
+  }
+  buffer_ = NDArray::Empty(shape, array->dtype, ctx);
+  slot_ids_ = Full<int64_t>(-1, capacity_, ctx);
+  table_ = std::make_shared<runtime::cuda::CUDAIdHashTable>(ctx, capacity_);
+}
+
+void GPUFeatureCache::Preload(IdArray ids) {
+  CHECK_EQ(ids->ndim, 1) << "The ids must be a 1D array.";
+  CHECK(ids->ctx == ctx_) << "The ids must be on the GPU of the cache.";
+  const int64_t num = std::min(ids->shape[0], capacity_);
+  ids = AsNumBits(ids.CreateView({num}, ids->dtype), 64);
+  const IdArray slots = Range(0, num, 64, ctx_);
+  table_ = std::make_shared<runtime::cuda::CUDAIdHashTable>(ctx_, capacity_);
+  table_->Insert(ids, slots);
+  slot_ids_ = Full<int64_t>(-1, capacity_, ctx_);
+  num_static_ = num;
+  next_slot_ = 0;
+  if (num == 0)
+    return;
+  auto device = DeviceAPI::Get(ctx_);
+  cudaStream_t stream = CUDAThreadEntry::ThreadLocal()->stream;
+  device->CopyDataFromTo(ids->data, 0, slot_ids_->data, 0, num * sizeof(int64_t),
+                         ctx_, ctx_, ids->dtype, stream);
+  ATEN_DTYPE_BITS_ONLY_SWITCH(array_->dtype, DType, "values", {
+    const NDArray rows = impl::IndexSelectCPUFromGPU<DType, int64_t>(array_, ids);
+    device->CopyDataFromTo(rows->data, 0, buffer_->data, 0, rows.GetSize(),
+                           ctx_, ctx_, rows->dtype, stream);
+  });
+}
+
+std::pair<NDArray, IdArray> GPUFeatureCache::IndexSelect(IdArray index) {
+  CHECK_EQ(index->ndim, 1) << "Index array must be an 1D array.";
+  CHECK(index->ctx == ctx_) << "The index must be on the GPU of the cache.";
+  cudaStream_t stream = CUDAThreadEntry::ThreadLocal()->stream;
+  const int64_t len = index->shape[0];
+  std::vector<int64_t> shape{len};
+  for (int d = 1; d < array_->ndim; ++d)
+    shape.push_back(array_->shape[d]);
+  NDArray ret = NDArray::Empty(shape, array_->dtype, ctx_);
+  IdArray counts = Full<int64_t>(0, 2, ctx_);
+  if (len == 0)
+    return {ret, counts};
+
+  const IdArray slots = table_->Lookup(index);
+  ATEN_DTYPE_BITS_ONLY_SWITCH(array_->dtype, DType, "values", {
+    ATEN_ID_TYPE_SWITCH(index->dtype, IdType, {
+      const dim3 block = RowBlock(num_feat_);
+      const dim3 grid((len + block.y - 1) / block.y);
+      const bool aligned = num_feat_ * sizeof(DType) >= 2 * CACHE_LINE_SIZE;
+      CUDA_KERNEL_CALL((_CachedIndexSelectKernel<DType, IdType>), grid, block, 0, stream,
+          array_.Ptr<DType>(), buffer_.Ptr<DType>(), num_feat_, index.Ptr<IdType>(),
+          slots.Ptr<int64_t>(), len, array_->shape[0], aligned, ret.Ptr<DType>(),
+          counts.Ptr<int64_t>());
+    });
+  });
+  if (dynamic_ && num_static_ < capacity_)
+    Admit(index, slots, ret);
+  return {ret, counts};
+}
+
+void GPUFeatureCache::Admit(IdArray index, IdArray slots, NDArray rows) {
+  auto device = DeviceAPI::Get(ctx_);
+  cudaStream_t stream = CUDAThreadEntry::ThreadLocal()->stream;
+  const IdArray miss_pos = NonZero(LT(slots, 0));
+  const int64_t num_misses = miss_pos->shape[0];
+  if (num_misses == 0)
+    return;
+  const IdArray miss_ids = AsNumBits(aten::IndexSelect(index, miss_pos), 64);
+
+  // the first occurrences of the missed rows
+  runtime::cuda::OrderedHashTable<int64_t> misses(num_misses, ctx_, stream);
+  IdArray unique = NewIdArray(num_misses, ctx_, 64);
+  int64_t* num_unique_device = static_cast<int64_t*>(
+      device->AllocWorkspace(ctx_, sizeof(int64_t)));
+  misses.FillWithDuplicates(miss_ids.Ptr<int64_t>(), num_misses, unique.Ptr<int64_t>(),
+                            num_unique_device, stream);
+  int64_t num_unique;
+  device->CopyDataFromTo(num_unique_device, 0, &num_unique, 0, sizeof(num_unique),
+                         ctx_, DGLContext{kDLCPU, 0},
+                         DGLType{kDLInt, 64, 1}, stream);
+  device->StreamSync(ctx_, stream);
+  device->FreeWorkspace(ctx_, num_unique_device);
+
+  const int64_t num_dynamic = capacity_ - num_static_;
+  const int64_t num_admitted = std::min(num_unique, num_dynamic);
+  IdArray new_slots = NewIdArray(num_admitted, ctx_, 64);
+  IdArray evicted = NewIdArray(num_admitted, ctx_, 64);
+  IdArray src_rows = NewIdArray(num_admitted, ctx_, 64);
+  CUDA_KERNEL_CALL(_AdmitKernel, NumBlocks(num_admitted), BLOCK_SIZE, 0, stream,
+      misses.DeviceHandle(), unique.Ptr<int64_t>(), num_admitted, miss_pos.Ptr<int64_t>(),
+      num_static_, num_dynamic, next_slot_, slot_ids_.Ptr<int64_t>(),
+      new_slots.Ptr<int64_t>(), evicted.Ptr<int64_t>(), src_rows.Ptr<int64_t>());
+  // the empty slots evict -1, which is ignored
+  table_->Remove(evicted);
+  table_->Insert(unique.CreateView({num_admitted}, unique->dtype), new_slots);
+  ATEN_DTYPE_BITS_ONLY_SWITCH(rows->dtype, DType, "values", {
+    const dim3 block = RowBlock(num_feat_);
+    const dim3 grid((num_admitted + block.y - 1) / block.y);
+    CUDA_KERNEL_CALL(_CopyRowsKernel<DType>, grid, block, 0, stream,
+        rows.Ptr<DType>(), src_rows.Ptr<int64_t>(), buffer_.Ptr<DType>(),
+        new_slots.Ptr<int64_t>(), num_admitted, num_feat_);
+  });
+  next_slot_ = (next_slot_ + num_admitted) % num_dynamic;
+}
+
+DGL_REGISTER_GLOBAL("ndarray.uvm._CAPI_DGLGPUFeatureCacheCreate")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    NDArray array = args[0];
+    DGLContext ctx;
+    ctx.device_type = kDLGPU;
+    ctx.device_id = args[1];
+    const int64_t capacity = args[2];
+    const bool dynamic = args[3];
+    *rv = GPUFeatureCacheRef(std::make_shared<GPUFeatureCache>(array, ctx, capacity, dynamic));
+  });
+
+DGL_REGISTER_GLOBAL("ndarray.uvm._CAPI_DGLGPUFeatureCachePreload")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    GPUFeatureCacheRef cache = args[0];
+    cache->Preload(args[1]);
+  });
+
+DGL_REGISTER_GLOBAL("ndarray.uvm._CAPI_DGLGPUFeatureCacheIndexSelect")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    GPUFeatureCacheRef cache = args[0];
+    const auto ret = cache->IndexSelect(args[1]);
+    List<Value> rets;
+    rets.push_back(Value(MakeValue(ret.first)));
+    rets.push_back(Value(MakeValue(ret.second)));
+    *rv = rets;
+  });
+
+}  // namespace aten
+}  // namespace dgl
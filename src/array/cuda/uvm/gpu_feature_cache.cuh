@@ -0,0 +1,93 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file array/cuda/uvm/gpu_feature_cache.cuh
+ * \brief A GPU cache of the rows of a pinned host array read by UVM.
+ */
+#ifndef DGL_ARRAY_CUDA_UVM_GPU_FEATURE_CACHE_CUH_
+#define DGL_ARRAY_CUDA_UVM_GPU_FEATURE_CACHE_CUH_
+
+#include <dgl/array.h>
+#include <dgl/runtime/object.h>
+#include <memory>
+#include <utility>
+#include "../../../runtime/cuda/cuda_id_hash_table.cuh"
+
+namespace dgl {
+namespace aten {
+
+/*!
+ * \brief A cache on the GPU of the rows of a pinned host array, e.g. the node
+ *        features, in front of IndexSelectCPUFromGPU.
+ *
+ * The cache holds up to capacity rows in two tiers:
+ *
+ * - the static rows, preloaded once, e.g. of the nodes of the highest degrees;
+ * - if dynamic, the remaining slots, where the rows missed by IndexSelect are
+ *   admitted in first-in first-out order.
+ *
+ * IndexSelect gathers the cached rows from the GPU and only the others over
+ * PCIe, in the same kernel. The admission of the missed rows copies them from
+ * the output, so their bytes cross PCIe once; it synchronizes the stream once
+ * per call, for the number of missed rows.
+ *
+ * The cache is not thread-safe.
+ */
+class GPUFeatureCache : public runtime::Object {
+ public:
+  /*!
+   * \brief Constructor.
+   * \param array The pinned host array, of at least one dimension.
+   * \param ctx The GPU of the cache.
+   * \param capacity The number of rows of the cache.
+   * \param dynamic Whether to admit the missed rows.
+   */
+  GPUFeatureCache(NDArray array, DGLContext ctx, int64_t capacity, bool dynamic);
+
+  /*!
+   * \brief Fill the static tier with the rows of ids, replacing the content of
+   *        the cache. The ids beyond the capacity are ignored.
+   * \param ids The distinct row ids, on the GPU of the cache.
+   */
+  void Preload(IdArray ids);
+
+  /*!
+   * \brief Gather the rows of the array like IndexSelectCPUFromGPU.
+   * \param index The row ids, on the GPU of the cache.
+   * \return The rows on the GPU, and the numbers of rows found in the cache and
+   *         read from the host, as an int64 array on the GPU.
+   */
+  std::pair<NDArray, IdArray> IndexSelect(IdArray index);
+
+  /*! \return The number of rows of the static tier. */
+  int64_t NumStatic() const { return num_static_; }
+
+  static constexpr const char* _type_key = "aten.GPUFeatureCache";
+  DGL_DECLARE_OBJECT_TYPE_INFO(GPUFeatureCache, runtime::Object);
+
+ private:
+  /*! \brief Admit the rows missed by IndexSelect, copied from its output. */
+  void Admit(IdArray index, IdArray slots, NDArray rows);
+
+  NDArray array_;
+  DGLContext ctx_;
+  int64_t capacity_;
+  bool dynamic_;
+  /*! \brief The number of elements of a row. */
+  int64_t num_feat_;
+  /*! \brief The slots of the cached rows, by row id. */
+  std::shared_ptr<runtime::cuda::CUDAIdHashTable> table_;
+  /*! \brief The cached rows, by slot. */
+  NDArray buffer_;
+  /*! \brief The row id of every slot, -1 if empty. */
+  IdArray slot_ids_;
+  int64_t num_static_{0};
+  /*! \brief The dynamic slot the next admitted row goes to, among them. */
+  int64_t next_slot_{0};
+};
+
+DGL_DEFINE_OBJECT_REF(GPUFeatureCacheRef, GPUFeatureCache);
+
+}  // namespace aten
+}  // namespace dgl
+
+#endif  // DGL_ARRAY_CUDA_UVM_GPU_FEATURE_CACHE_CUH_
@@ -0,0 +1,90 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file array/cuda/vectorized.cuh
+ * \brief Vectorized access to feature rows in CUDA kernels.
+ */
+#ifndef DGL_ARRAY_CUDA_VECTORIZED_CUH_
+#define DGL_ARRAY_CUDA_VECTORIZED_CUH_
+
+#include <cstdint>
+#include "fp16.cuh"
+
+namespace dgl {
+namespace aten {
+namespace cuda {
+
+/*!
+ * \brief The vector type used to load kWidth consecutive values of DType in
+ *        a single memory transaction. kWidth is 1 for types without one.
+ */
+template <typename DType>
+struct VecType {
+  typedef DType Type;
+  static constexpr int kWidth = 1;
+};
+
+template <>
+struct VecType<float> {
+  typedef float4 Type;
+  static constexpr int kWidth = 4;
+};
+
+#ifdef USE_FP16
+template <>
+struct VecType<half> {
+  typedef half2 Type;
+  static constexpr int kWidth = 2;
+};
+#endif  // USE_FP16
+
+/*!
+ * \brief Whether the rows of a feature matrix can be accessed with
+ *        VecType<DType>, i.e. the row length is a multiple of the vector width
+ *        and the data is aligned to the vector size.
+ * \param data The feature data, nullptr if the feature is not used.
+ * \param row_len The number of elements between 2 consecutive rows.
+ */
+template <typename DType>
+inline bool VecAligned(const DType* data, int64_t row_len) {
+  typedef typename VecType<DType>::Type Vec;
+  if (VecType<DType>::kWidth == 1)
+    return false;
+  if (data == nullptr)
+    return true;
+  return row_len % VecType<DType>::kWidth == 0 &&
+    reinterpret_cast<uintptr_t>(data) % sizeof(Vec) == 0;
+}
+
+/*! \brief kWidth values of DType, aligned to be accessed as VecType<DType>. */
+template <typename DType>
+struct alignas(sizeof(typename VecType<DType>::Type)) VecPack {
+  DType val[VecType<DType>::kWidth];
+};
+
+/*!
+ * \brief Load the kWidth values of DType starting at ptr.
+ * \note ptr must be aligned to the vector size.
+ */
+template <typename DType>
+__device__ __forceinline__ VecPack<DType> VecLoad(const DType* __restrict__ ptr) {
+  typedef typename VecType<DType>::Type Vec;
+  VecPack<DType> ret;
+  *reinterpret_cast<Vec*>(ret.val) = __ldg(reinterpret_cast<const Vec*>(ptr));
+  return ret;
+}
+
+/*!
+ * \brief Store kWidth values of DType starting at ptr.
+ * \note ptr must be aligned to the vector size.
+ */
+template <typename DType>
+__device__ __forceinline__ void VecStore(DType* __restrict__ ptr, const VecPack<DType>& pack) {
+  typedef typename VecType<DType>::Type Vec;
+  *reinterpret_cast<Vec*>(ptr) = *reinterpret_cast<const Vec*>(pack.val);
+}
+
+}  // namespace cuda
+}  // namespace aten
+}  // namespace dgl
+
+#endif  // DGL_ARRAY_CUDA_VECTORIZED_CUH_
@@ -0,0 +1,103 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file array/degree_stats.cc
+ * \brief Degree statistics of sparse matrices.
+ */
+#include <dgl/array.h>
+#include <dgl/aten/degree_stats.h>
+#include <dgl/runtime/parallel_for.h>
+
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace dgl {
+namespace aten {
+
+namespace {
+
+/*! \brief Fill the statistics of the degrees in stats->degrees. */
+template <typename IdType>
+void FillDegreeStats(DegreeStats* stats) {
+  const NDArray degrees = stats->degrees.CopyTo(DLContext{kDLCPU, 0});
+  const IdType* degrees_data = degrees.Ptr<IdType>();
+  const int num_bins = 8 * sizeof(IdType) + 1;
+  std::vector<int64_t> histogram(num_bins, 0);
+  int64_t max_degree = 0, nnz = 0;
+  std::mutex mutex;
+  runtime::parallel_for(0, stats->num_rows, [&](size_t b, size_t e) {
+    std::vector<int64_t> local_histogram(num_bins, 0);
+    int64_t local_max = 0, local_nnz = 0;
+    for (size_t i = b; i < e; ++i) {
+      const int64_t degree = degrees_data[i];
+      local_max = std::max(local_max, degree);
+      local_nnz += degree;
+      ++local_histogram[DegreeStats::Bin(degree)];
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    max_degree = std::max(max_degree, local_max);
+    nnz += local_nnz;
+    for (int bin = 0; bin < num_bins; ++bin)
+      histogram[bin] += local_histogram[bin];
+  });
+  histogram.resize(DegreeStats::Bin(max_degree) + 1);
+  stats->max_degree = max_degree;
+  stats->nnz = nnz;
+  stats->histogram = std::move(histogram);
+}
+
+template <typename IdType>
+std::shared_ptr<DegreeStats> ComputeCSRDegreeStats(const CSRMatrix& csr) {
+  auto stats = std::make_shared<DegreeStats>();
+  NDArray indptr = csr.indptr;
+  stats->num_rows = csr.num_rows;
+  stats->degrees = Sub(
+      indptr.CreateView({csr.num_rows}, indptr->dtype, sizeof(IdType)),
+      indptr.CreateView({csr.num_rows}, indptr->dtype, 0));
+  FillDegreeStats<IdType>(stats.get());
+  return stats;
+}
+
+template <typename IdType>
+std::shared_ptr<DegreeStats> ComputeCOODegreeStats(const COOMatrix& coo, bool transpose) {
+  if (coo.row->ctx.device_type != kDLCPU)
+    return ComputeCSRDegreeStats<IdType>(COOToCSR(transpose ? COOTranspose(coo) : coo));
+  auto stats = std::make_shared<DegreeStats>();
+  const int64_t num_rows = transpose ? coo.num_cols : coo.num_rows;
+  const IdType* rows = (transpose ? coo.col : coo.row).Ptr<IdType>();
+  const int64_t nnz = coo.row->shape[0];
+  stats->num_rows = num_rows;
+  stats->degrees = Full<IdType>(0, num_rows, coo.row->ctx);
+  IdType* degrees_data = stats->degrees.Ptr<IdType>();
+  for (int64_t i = 0; i < nnz; ++i)
+    ++degrees_data[rows[i]];
+  FillDegreeStats<IdType>(stats.get());
+  return stats;
+}
+
+}  // namespace
+
+std::shared_ptr<const DegreeStats> CSRGetDegreeStats(
+    const CSRMatrix& csr, KernelPlanCache* cache) {
+  std::shared_ptr<const DegreeStats> ret;
+  ATEN_ID_TYPE_SWITCH(csr.indptr->dtype, IdType, {
+    auto make = [&csr]() { return ComputeCSRDegreeStats<IdType>(csr); };
+    ret = cache ? cache->GetOrCreate<DegreeStats>("degree_stats", make) : make();
+  });
+  return ret;
+}
+
+std::shared_ptr<const DegreeStats> COOGetDegreeStats(
+    const COOMatrix& coo, bool transpose, KernelPlanCache* cache) {
+  std::shared_ptr<const DegreeStats> ret;
+  ATEN_ID_TYPE_SWITCH(coo.row->dtype, IdType, {
+    auto make = [&coo, transpose]() { return ComputeCOODegreeStats<IdType>(coo, transpose); };
+    const std::string key = transpose ? "degree_stats_col" : "degree_stats_row";
+    ret = cache ? cache->GetOrCreate<DegreeStats>(key, make) : make();
+  });
+  return ret;
+}
+
+}  // namespace aten
+}  // namespace dgl
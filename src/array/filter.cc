@@ -15,14 +15,10 @@ namespace array {
 
 using namespace dgl::runtime;
 
-template<DLDeviceType XPU, typename IdType>
-FilterRef CreateSetFilter(IdArray set);
-
 DGL_REGISTER_GLOBAL("utils.filter._CAPI_DGLFilterCreateFromSet")
 .set_body([] (DGLArgs args, DGLRetValue* rv) {
   IdArray array = args[0];
   auto ctx = array->ctx;
-  // TODO(nv-dlasalle): Implement CPU version.
   if (ctx.device_type == kDLGPU) {
     #ifdef DGL_USE_CUDA
     ATEN_ID_TYPE_SWITCH(array->dtype, IdType, {
@@ -32,7 +28,9 @@ DGL_REGISTER_GLOBAL("utils.filter._CAPI_DGLFilterCreateFromSet")
     LOG(FATAL) << "GPU support not compiled.";
     #endif
   } else {
-    LOG(FATAL) << "CPU support not yet implemented.";
+    ATEN_ID_TYPE_SWITCH(array->dtype, IdType, {
+      *rv = CreateSetFilter<kDLCPU, IdType>(array);
+    });
   }
 });
 
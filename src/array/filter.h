@@ -46,6 +46,16 @@ class Filter : public runtime::Object {
 
 DGL_DEFINE_OBJECT_REF(FilterRef, Filter);
 
+/*!
+ * \brief Create a filter selecting the items of the given set.
+ *
+ * \param set The items of the set, on device XPU.
+ *
+ * \return The filter.
+ */
+template<DLDeviceType XPU, typename IdType>
+FilterRef CreateSetFilter(IdArray set);
+
 }  // namespace array
 }  // namespace dgl
 
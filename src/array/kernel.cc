@@ -5,6 +5,15 @@
  */
 #include <dgl/packed_func_ext.h>
 #include <dgl/base_heterograph.h>
+#include <dgl/kernel.h>
+#include <dgl/runtime/profile_range.h>
+#include <dgl/zerocopy_serializer.h>
+#include <algorithm>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <typeinfo>
 
 #ifdef USE_TVM
 #include <featgraph.h>
@@ -20,6 +29,56 @@ namespace dgl {
 namespace aten {
 namespace {
 
+/*! \brief Check that bfloat16 features are only given to the CPU kernels. */
+void CheckBFloat16Context(const DLContext& ctx, const NDArray& feat, const char* name) {
+  CHECK(feat->dtype.code != kDLBfloat || ctx.device_type == kDLCPU)
+    << name << " only supports bfloat16 features on CPU.";
+}
+
+#ifdef USE_TVM
+/*! \brief The NDArray as a mutable DLTensor for the featgraph kernels. */
+inline DLTensor* AsDLTensor(const NDArray& array) {
+  return const_cast<DLTensor*>(array.operator->());
+}
+
+/*!
+ * \brief Run the tuned featgraph kernel of a sum of the source features over a
+ *        CSC matrix without edge ids, if there is one.
+ * \return Whether a tuned kernel was run.
+ */
+bool SpMMTuned(const std::string& op, const std::string& reduce, const BcastOff& bcast,
+               const CSRMatrix& csc, NDArray ufeat, NDArray out) {
+  if (op != "copy_lhs" || reduce != "sum" || bcast.use_bcast || CSRHasData(csc) ||
+      !ufeat.IsContiguous() || !out.IsContiguous())
+    return false;
+  const int64_t feat_len = bcast.out_len;
+  NDArray u = ufeat.CreateView({ufeat->shape[0], feat_len}, ufeat->dtype);
+  NDArray v = out.CreateView({out->shape[0], feat_len}, out->dtype);
+  return featgraph::SpMMCsrTuned(op + "_" + reduce, AsDLTensor(csc.indptr),
+                                 AsDLTensor(csc.indices), AsDLTensor(u), AsDLTensor(v),
+                                 feat_len);
+}
+
+/*!
+ * \brief Run the tuned featgraph kernel of the dot products of the source and the
+ *        destination features over a COO matrix without edge ids, if there is one.
+ * \return Whether a tuned kernel was run.
+ */
+bool SDDMMTuned(const std::string& op, const BcastOff& bcast, const COOMatrix& coo,
+                NDArray lhs, NDArray rhs, NDArray out, int lhs_target, int rhs_target) {
+  if (op != "dot" || lhs_target != 0 || rhs_target != 2 || bcast.use_bcast ||
+      COOHasData(coo) || !lhs.IsContiguous() || !rhs.IsContiguous() || !out.IsContiguous())
+    return false;
+  // the heads are the dimensions of the output
+  const int64_t num_heads = bcast.out_len, feat_len = bcast.reduce_size;
+  NDArray u = lhs.CreateView({lhs->shape[0], num_heads, feat_len}, lhs->dtype);
+  NDArray v = rhs.CreateView({rhs->shape[0], num_heads, feat_len}, rhs->dtype);
+  NDArray e = out.CreateView({out->shape[0], num_heads, 1}, out->dtype);
+  return featgraph::SDDMMCooTuned(AsDLTensor(coo.row), AsDLTensor(coo.col),
+                                  AsDLTensor(u), AsDLTensor(v), AsDLTensor(e), feat_len);
+}
+#endif  // USE_TVM
+
 }  // namespace
 
 /*! \brief Generalized Sparse Matrix-Matrix Multiplication. */
@@ -31,19 +90,30 @@ void SpMM(const std::string& op, const std::string& reduce,
           std::vector<NDArray> out_aux) {
   // TODO(zihao): format tuning
   SparseFormat format = graph->SelectFormat(0, CSC_CODE);
+  DGL_PROFILE_RANGE("SpMM", op, reduce, ToStringSparseFormat(format), ufeat, efeat, out);
   const auto& bcast = CalcBcastOff(op, ufeat, efeat);
+  CheckBFloat16Context(graph->Context(), out, "SpMM");
+
+#ifdef USE_TVM
+  // the tuned kernels are preferred to the hand-written ones
+  if (format == SparseFormat::kCSC &&
+      SpMMTuned(op, reduce, bcast, graph->GetCSCMatrix(0), ufeat, out))
+    return;
+#endif  // USE_TVM
 
   ATEN_XPU_SWITCH_CUDA(graph->Context().device_type, XPU, "SpMM", {
     ATEN_ID_TYPE_SWITCH(graph->DataType(), IdType, {
-      ATEN_FLOAT_BITS_SWITCH(out->dtype, bits, "Feature data", {
+      ATEN_FLOAT_BITS_SWITCH_BF16(out->dtype, bits, "Feature data", {
         if (format == SparseFormat::kCSC) {
           SpMMCsr<XPU, IdType, bits>(
               op, reduce, bcast, graph->GetCSCMatrix(0),
-              ufeat, efeat, out, out_aux);
+              ufeat, efeat, out, out_aux,
+              graph->GetKernelPlanCache(0, format).get());
         } else if (format == SparseFormat::kCOO) {
           SpMMCoo<XPU, IdType, bits>(
               op, reduce, bcast, graph->GetCOOMatrix(0),
-              ufeat, efeat, out, out_aux);
+              ufeat, efeat, out, out_aux,
+              graph->GetKernelPlanCache(0, format).get());
         } else {
           LOG(FATAL) << "SpMM only supports CSC and COO formats";
         }
@@ -60,8 +130,11 @@ void SpMMHetero(const std::string& op, const std::string& reduce,
           std::vector<NDArray>* out,
           std::vector<std::vector<NDArray>>* out_aux) {
   SparseFormat format = graph->SelectFormat(0, CSC_CODE);
+  DGL_PROFILE_RANGE("SpMMHetero", op, reduce, ToStringSparseFormat(format),
+                    graph->NumEdgeTypes());
 
   std::vector<CSRMatrix> vec_graph;
+  std::vector<KernelPlanCache*> plan_caches;
   std::vector<dgl_type_t> ufeat_eid;
   std::vector<dgl_type_t> efeat_eid;
   std::vector<dgl_type_t> out_eid;
@@ -70,6 +143,7 @@ void SpMMHetero(const std::string& op, const std::string& reduce,
   NDArray efeat_etype0 = (efeat_vec.size() == 0) ? NullArray() : efeat_vec[0];
   for (dgl_type_t etype = 0; etype < graph->NumEdgeTypes(); ++etype) {
     vec_graph.push_back(graph->GetCSCMatrix(etype));
+    plan_caches.push_back(graph->GetKernelPlanCache(etype, format).get());
     auto pair = graph->meta_graph()->FindEdge(etype);
     ufeat_eid.push_back(pair.first);
     efeat_eid.push_back(etype);
@@ -88,7 +162,7 @@ void SpMMHetero(const std::string& op, const std::string& reduce,
           SpMMCsrHetero<XPU, IdType, bits>(
               op, reduce, bcast, vec_graph,
               ufeat_vec, efeat_vec, out, out_aux,
-              ufeat_eid, out_eid);
+              ufeat_eid, out_eid, plan_caches);
         } else {
           // TODO(Israt): Add support for COO format
           LOG(FATAL) << "SpMM only supports CSC format for graphs with number "
@@ -99,6 +173,77 @@ void SpMMHetero(const std::string& op, const std::string& reduce,
   });
 }
 
+/*! \brief Generalized Sparse Matrix-Matrix Multiplication on a Csr matrix. */
+void SpMM(const std::string& op, const std::string& reduce,
+          const CSRMatrix& csr,
+          NDArray ufeat,
+          NDArray efeat,
+          NDArray out,
+          std::vector<NDArray> out_aux) {
+  const auto& bcast = CalcBcastOff(op, ufeat, efeat);
+  if (CSRHasWideIndptr(csr)) {
+    ATEN_XPU_SWITCH(csr.indptr->ctx.device_type, XPU, "SpMM", {
+      ATEN_FLOAT_BITS_SWITCH(out->dtype, bits, "Feature data", {
+        SpMMCsrWideIndptr<XPU, int32_t, bits>(op, reduce, bcast, csr, ufeat, efeat, out);
+      });
+    });
+    return;
+  }
+  CheckBFloat16Context(csr.indptr->ctx, out, "SpMM");
+  ATEN_CSR_SWITCH_CUDA(csr, XPU, IdType, "SpMM", {
+    ATEN_FLOAT_BITS_SWITCH_BF16(out->dtype, bits, "Feature data", {
+      SpMMCsr<XPU, IdType, bits>(op, reduce, bcast, csr, ufeat, efeat, out, out_aux);
+    });
+  });
+}
+
+/*! \brief Generalized Sparse Matrix-Matrix Multiplication on a compressed Csr matrix. */
+void SpMM(const std::string& op, const std::string& reduce,
+          const CompressedCSRMatrix& csr,
+          NDArray ufeat,
+          NDArray efeat,
+          NDArray out) {
+  const auto& bcast = CalcBcastOff(op, ufeat, efeat);
+  ATEN_COMPRESSED_CSR_SWITCH(csr, XPU, IdType, "SpMM", {
+    ATEN_FLOAT_BITS_SWITCH(out->dtype, bits, "Feature data", {
+      SpMMCompressedCsr<XPU, IdType, bits>(op, reduce, bcast, csr, ufeat, efeat, out);
+    });
+  });
+}
+
+/*! \brief Generalized SpMM reading the source node features from a table. */
+void SpMMWithIndex(const std::string& op, const std::string& reduce,
+                   HeteroGraphPtr graph,
+                   NDArray ufeat,
+                   IdArray ufeat_index,
+                   NDArray efeat,
+                   NDArray out,
+                   std::vector<NDArray> out_aux) {
+  const auto& ctx = graph->Context();
+  CHECK_EQ(graph->NumEdgeTypes(), 1);
+  CHECK(op != "copy_rhs") << "SpMMWithIndex requires the source node features.";
+  CHECK_EQ(ufeat_index->ctx.device_type, ctx.device_type)
+    << "The index must be on the device of the graph.";
+  CHECK_EQ(ufeat_index->ndim, 1) << "The index must be a 1D array.";
+  CHECK_EQ(ufeat_index->shape[0], graph->NumVertices(graph->meta_graph()->FindEdge(0).first))
+    << "The index must have a row of the table for every source node.";
+  if (ufeat->ctx.device_type != ctx.device_type) {
+    CHECK(ctx.device_type == kDLGPU && ufeat.IsPinned())
+      << "The feature table of a graph on GPU must be on GPU or in pinned host memory.";
+    // a view of the pinned table on the GPU, which the kernels read without
+    // copying it
+    std::vector<int64_t> shape(ufeat->shape, ufeat->shape + ufeat->ndim);
+    ufeat = CreateNDArrayFromRawData(shape, ufeat->dtype, ctx, ufeat->data,
+                                     std::make_shared<NDArray>(ufeat));
+  }
+  const CSRMatrix& csc = graph->GetCSCMatrix(0);
+  const IdArray index = AsNumBits(ufeat_index, csc.indices->dtype.bits);
+  // the columns are no longer sorted once mapped
+  const CSRMatrix mapped(csc.num_rows, ufeat->shape[0], csc.indptr,
+                         IndexSelect(index, csc.indices), csc.data, false);
+  DGL_PROFILE_RANGE("SpMMWithIndex", op, reduce, ufeat, efeat, out);
+  SpMM(op, reduce, mapped, ufeat, efeat, out, out_aux);
+}
 
 /*! \brief Generalized Sampled Dense-Dense Matrix Multiplication. */
 void SDDMM(const std::string& op,
@@ -110,11 +255,20 @@ void SDDMM(const std::string& op,
            int rhs_target) {
   // TODO(zihao): format tuning
   SparseFormat format = graph->SelectFormat(0, COO_CODE);
+  DGL_PROFILE_RANGE("SDDMM", op, ToStringSparseFormat(format), lhs, rhs, out);
   const auto &bcast = CalcBcastOff(op, lhs, rhs);
+  CheckBFloat16Context(graph->Context(), out, "SDDMM");
+
+#ifdef USE_TVM
+  // the tuned kernels are preferred to the hand-written ones
+  if (format == SparseFormat::kCOO &&
+      SDDMMTuned(op, bcast, graph->GetCOOMatrix(0), lhs, rhs, out, lhs_target, rhs_target))
+    return;
+#endif  // USE_TVM
 
   ATEN_XPU_SWITCH_CUDA(graph->Context().device_type, XPU, "SDDMM", {
     ATEN_ID_TYPE_SWITCH(graph->DataType(), IdType, {
-      ATEN_FLOAT_BITS_SWITCH(out->dtype, bits, "Feature data", {
+      ATEN_FLOAT_BITS_SWITCH_BF16(out->dtype, bits, "Feature data", {
         if (format == SparseFormat::kCSR) {
           SDDMMCsr<XPU, IdType, bits>(
               op, bcast, graph->GetCSRMatrix(0),
@@ -158,6 +312,8 @@ void SDDMMHetero(const std::string& op,
            int lhs_target,
            int rhs_target) {
   SparseFormat format = graph->SelectFormat(0, COO_CODE);
+  DGL_PROFILE_RANGE("SDDMMHetero", op, ToStringSparseFormat(format),
+                    graph->NumEdgeTypes());
 
   std::vector<dgl_type_t> lhs_eid;
   std::vector<dgl_type_t> rhs_eid;
@@ -166,10 +322,11 @@ void SDDMMHetero(const std::string& op,
     rhs_eid.push_back(get_typeid_by_target(graph, rhs_target, etype));
   }
   const auto &bcast = CalcBcastOff(op, lhs[lhs_eid[0]], rhs[rhs_eid[0]]);
+  CheckBFloat16Context(graph->Context(), out[rhs_eid[0]], "SDDMM");
 
   ATEN_XPU_SWITCH_CUDA(graph->Context().device_type, XPU, "SDDMM", {
     ATEN_ID_TYPE_SWITCH(graph->DataType(), IdType, {
-      ATEN_FLOAT_BITS_SWITCH(out[rhs_eid[0]]->dtype, bits, "Feature data", {
+      ATEN_FLOAT_BITS_SWITCH_BF16(out[rhs_eid[0]]->dtype, bits, "Feature data", {
         if (format == SparseFormat::kCSR) {
           std::vector<CSRMatrix> vec_csr;
           for (dgl_type_t etype = 0; etype < graph->NumEdgeTypes(); ++etype) {
@@ -205,12 +362,64 @@ NDArray GetEdgeMapping(HeteroGraphRef graph) {
   }
 }
 
+/*!
+ * \brief Fused attention: computes the edge scores of op on lhs and rhs, the
+ *        softmax of the scores over the in-edges of every destination node, and
+ *        aggregates feat with the softmax weights, without materializing any edge
+ *        tensor.
+ */
+void FusedAttention(const std::string& op,
+                    HeteroGraphPtr graph,
+                    NDArray lhs,
+                    NDArray rhs,
+                    NDArray feat,
+                    double negative_slope,
+                    NDArray out,
+                    NDArray out_lse) {
+  ATEN_XPU_SWITCH(graph->Context().device_type, XPU, "FusedAttention", {
+    ATEN_ID_TYPE_SWITCH(graph->DataType(), IdType, {
+      ATEN_FLOAT_BITS_SWITCH(out->dtype, bits, "Feature data", {
+        FusedAttentionCsr<XPU, IdType, bits>(
+            op, graph->GetCSCMatrix(0), lhs, rhs, feat, negative_slope, out, out_lse);
+      });
+    });
+  });
+}
+
+/*!
+ * \brief Edge softmax forward: normalizes the scores of the in-edges of every
+ *        destination node.
+ */
+void EdgeSoftmaxForward(HeteroGraphPtr graph, NDArray score, NDArray out) {
+  ATEN_XPU_SWITCH_CUDA(graph->Context().device_type, XPU, "EdgeSoftmaxForward", {
+    ATEN_ID_TYPE_SWITCH(graph->DataType(), IdType, {
+      ATEN_FLOAT_BITS_SWITCH(out->dtype, bits, "Feature data", {
+        EdgeSoftmaxForwardCsr<XPU, IdType, bits>(graph->GetCSCMatrix(0), score, out);
+      });
+    });
+  });
+}
+
+/*! \brief Edge softmax backward: the gradient of the scores of EdgeSoftmaxForward. */
+void EdgeSoftmaxBackward(HeteroGraphPtr graph, NDArray out, NDArray grad_out,
+                         NDArray grad_score) {
+  ATEN_XPU_SWITCH_CUDA(graph->Context().device_type, XPU, "EdgeSoftmaxBackward", {
+    ATEN_ID_TYPE_SWITCH(graph->DataType(), IdType, {
+      ATEN_FLOAT_BITS_SWITCH(out->dtype, bits, "Feature data", {
+        EdgeSoftmaxBackwardCsr<XPU, IdType, bits>(
+            graph->GetCSCMatrix(0), out, grad_out, grad_score);
+      });
+    });
+  });
+}
+
 /*! \brief Segment reduce dispatch function. */
 void SegmentReduceDispatch(const std::string& op,
                            NDArray feat,
                            NDArray offsets,
                            NDArray out,
                            NDArray arg) {
+  DGL_PROFILE_RANGE("SegmentReduce", op, feat, offsets);
   ATEN_XPU_SWITCH_CUDA(feat->ctx.device_type, XPU, "SegmentReduce", {
     ATEN_ID_TYPE_SWITCH(offsets->dtype, IdType, {
       ATEN_FLOAT_BITS_SWITCH(feat->dtype, bits, "Feature data", {
@@ -260,6 +469,91 @@ void BackwardSegmentCmpDispatch(NDArray feat, NDArray arg, NDArray out) {
   });
 }
 
+/*!
+ * \brief Sum the gradients of the duplicate rows with ScatterAdd.
+ * \return The unique rows, their gradients and the number of gradients summed
+ *         in every row, which is a null array if there is no duplicate row.
+ */
+std::tuple<IdArray, NDArray, IdArray> CoalesceRowGrad(IdArray idx, NDArray grad) {
+  IdArray rows, inverse, counts;
+  std::tie(rows, inverse, counts) = aten::Unique(idx);
+  if (rows->shape[0] == idx->shape[0])
+    return std::make_tuple(idx, grad, NullArray(idx->dtype, idx->ctx));
+  std::vector<int64_t> shape(grad->shape, grad->shape + grad->ndim);
+  shape[0] = rows->shape[0];
+  const int64_t dim = grad.NumElements() / grad->shape[0];
+  NDArray sum;
+  ATEN_FLOAT_TYPE_SWITCH(grad->dtype, DType, "Gradient", {
+    sum = aten::Full<DType>(0, shape[0] * dim, grad->ctx).CreateView(shape, grad->dtype);
+  });
+  ScatterAddDispatch(grad, inverse, sum);
+  return std::make_tuple(rows, sum, counts);
+}
+
+/*!
+ * \brief Check that the states of a sparse optimizer are on the device of the
+ *        gradients, or in pinned host memory for gradients on GPU, and are of the
+ *        shape of the embedding, or of its rows if row_state.
+ */
+void CheckOptimizerStates(
+    NDArray weight, NDArray grad, const std::vector<NDArray>& states,
+    const std::vector<std::string>& names, const std::vector<bool>& row_state) {
+  const int64_t dim = weight.NumElements() / std::max<int64_t>(weight->shape[0], 1);
+  CHECK_EQ(grad.NumElements(), grad->shape[0] * dim)
+    << "The gradients must be of the row size of the embedding.";
+  for (size_t i = 0; i < states.size(); ++i) {
+    if (states[i]->ctx != grad->ctx) {
+      CHECK(grad->ctx.device_type == kDLGPU && states[i]->ctx.device_type == kDLCPU &&
+            states[i].IsPinned())
+        << "Expected device context " << grad->ctx << " or pinned memory. But got "
+        << states[i]->ctx << " for " << names[i] << ".";
+    }
+    CHECK(states[i].IsContiguous()) << "Expect " << names[i] << " to be a contiguous tensor";
+    CHECK_EQ(states[i]->dtype, grad->dtype)
+      << "Expect " << names[i] << " to be of the type of the gradients.";
+    CHECK_EQ(states[i]->shape[0], weight->shape[0])
+      << "Expect " << names[i] << " to have a row for every row of the embedding.";
+    CHECK_EQ(states[i].NumElements(), row_state[i] ? weight->shape[0] : weight.NumElements())
+      << "Expect " << names[i] << " to be of the shape of the embedding.";
+  }
+}
+
+/*! \brief Sparse Adagrad update dispatch function. */
+void SparseAdagradUpdateDispatch(
+    NDArray weight, NDArray state, IdArray idx, NDArray grad, double lr, double eps) {
+  CheckOptimizerStates(weight, grad, {weight, state}, {"weight", "state"}, {false, false});
+  IdArray rows, counts;
+  NDArray row_grad;
+  std::tie(rows, row_grad, counts) = CoalesceRowGrad(idx, grad);
+  ATEN_XPU_SWITCH_CUDA(grad->ctx.device_type, XPU, "SparseAdagradUpdate", {
+    ATEN_ID_TYPE_SWITCH(idx->dtype, IdType, {
+      ATEN_FLOAT_TYPE_SWITCH(grad->dtype, DType, "Gradient", {
+        SparseAdagradUpdate<XPU, IdType, DType>(
+            weight, state, rows, row_grad, counts, lr, eps);
+      });
+    });
+  });
+}
+
+/*! \brief Sparse Adam update dispatch function. */
+void SparseAdamUpdateDispatch(
+    NDArray weight, NDArray step, NDArray mem, NDArray power, IdArray idx, NDArray grad,
+    double lr, double beta1, double beta2, double eps) {
+  CheckOptimizerStates(weight, grad, {weight, step, mem, power},
+                       {"weight", "step", "mem", "power"}, {false, true, false, false});
+  IdArray rows, counts;
+  NDArray row_grad;
+  std::tie(rows, row_grad, counts) = CoalesceRowGrad(idx, grad);
+  ATEN_XPU_SWITCH_CUDA(grad->ctx.device_type, XPU, "SparseAdamUpdate", {
+    ATEN_ID_TYPE_SWITCH(idx->dtype, IdType, {
+      ATEN_FLOAT_TYPE_SWITCH(grad->dtype, DType, "Gradient", {
+        SparseAdamUpdate<XPU, IdType, DType>(
+            weight, step, mem, power, rows, row_grad, counts, lr, beta1, beta2, eps);
+      });
+    });
+  });
+}
+
 std::pair<CSRMatrix, NDArray> CSRMM(
     CSRMatrix A,
     NDArray A_weights,
@@ -276,6 +570,7 @@ std::pair<CSRMatrix, NDArray> CSRMM(
   CHECK_EQ(A.indptr->dtype, B.indptr->dtype) << "ID types of two graphs must match.";
   CHECK_EQ(A_weights->dtype, B_weights->dtype) << "Data types of two edge weights must match.";
 
+  DGL_PROFILE_RANGE("CSRMM", A.num_rows, A.num_cols, B.num_cols, A.indices, B.indices);
   std::pair<CSRMatrix, NDArray> ret;
   ATEN_XPU_SWITCH_CUDA(A.indptr->ctx.device_type, XPU, "CSRMM", {
     ATEN_ID_TYPE_SWITCH(A.indptr->dtype, IdType, {
@@ -287,6 +582,34 @@ std::pair<CSRMatrix, NDArray> CSRMM(
   return ret;
 }
 
+std::pair<CSRMatrix, NDArray> CSRMMTopK(
+    CSRMatrix A,
+    NDArray A_weights,
+    CSRMatrix B,
+    NDArray B_weights,
+    int64_t k) {
+  CHECK_EQ(A.num_cols, B.num_rows) <<
+    "The number of nodes of destination node type of the first graph must be the "
+    "same as the number of nodes of source node type of the second graph.";
+  CheckCtx(
+      A.indptr->ctx,
+      {A_weights, B_weights},
+      {"A's edge weights", "B's edge weights"});
+  CHECK_EQ(A.indptr->ctx, B.indptr->ctx) << "Device of two graphs must match.";
+  CHECK_EQ(A.indptr->dtype, B.indptr->dtype) << "ID types of two graphs must match.";
+  CHECK_EQ(A_weights->dtype, B_weights->dtype) << "Data types of two edge weights must match.";
+
+  std::pair<CSRMatrix, NDArray> ret;
+  ATEN_XPU_SWITCH(A.indptr->ctx.device_type, XPU, "CSRMMTopK", {
+    ATEN_ID_TYPE_SWITCH(A.indptr->dtype, IdType, {
+      ATEN_FLOAT_TYPE_SWITCH(A_weights->dtype, DType, "Edge weights", {
+        ret = CSRMMTopK<XPU, IdType, DType>(A, A_weights, B, B_weights, k);
+      });
+    });
+  });
+  return ret;
+}
+
 std::pair<CSRMatrix, NDArray> CSRSum(
     const std::vector<CSRMatrix>& A,
     const std::vector<NDArray>& A_weights) {
@@ -322,6 +645,259 @@ std::pair<CSRMatrix, NDArray> CSRSum(
   return ret;
 }
 
+NDArray CSRMaskedMM(
+    CSRMatrix A,
+    NDArray A_weights,
+    CSRMatrix B_t,
+    NDArray B_weights,
+    COOMatrix mask) {
+  CHECK_EQ(A.num_cols, B_t.num_cols) <<
+    "The number of nodes of destination node type of the first graph must be the "
+    "same as the number of nodes of source node type of the second graph.";
+  CHECK_EQ(mask.num_rows, A.num_rows) <<
+    "The mask must have the number of source nodes of the first graph.";
+  CHECK_EQ(mask.num_cols, B_t.num_rows) <<
+    "The mask must have the number of destination nodes of the second graph.";
+  CheckCtx(
+      A.indptr->ctx,
+      {A_weights, B_weights, B_t.indptr, mask.row},
+      {"A's edge weights", "B's edge weights", "B", "mask"});
+  CHECK_EQ(A.indptr->dtype, B_t.indptr->dtype) << "ID types of two graphs must match.";
+  CHECK_EQ(A.indptr->dtype, mask.row->dtype) << "ID types of the graph and mask must match.";
+  CHECK_EQ(A_weights->dtype, B_weights->dtype) << "Data types of two edge weights must match.";
+
+  A = CSRSort(A);
+  B_t = CSRSort(B_t);
+  DGL_PROFILE_RANGE("CSRMaskedMM", A.num_rows, A.num_cols, B_t.num_rows, mask.row);
+  NDArray ret;
+  ATEN_XPU_SWITCH_CUDA(A.indptr->ctx.device_type, XPU, "CSRMaskedMM", {
+    ATEN_ID_TYPE_SWITCH(A.indptr->dtype, IdType, {
+      ATEN_FLOAT_TYPE_SWITCH(A_weights->dtype, DType, "Edge weights", {
+        ret = CSRMaskedMM<XPU, IdType, DType>(A, A_weights, B_t, B_weights, mask);
+      });
+    });
+  });
+  return ret;
+}
+
+NDArray CSRMMNumeric(
+    const CSRMatrix& A,
+    NDArray A_weights,
+    const CSRMatrix& B,
+    NDArray B_weights,
+    const CSRMatrix& C) {
+  NDArray ret;
+  ATEN_XPU_SWITCH_CUDA(A.indptr->ctx.device_type, XPU, "CSRMM", {
+    ATEN_ID_TYPE_SWITCH(A.indptr->dtype, IdType, {
+      ATEN_FLOAT_TYPE_SWITCH(A_weights->dtype, DType, "Edge weights", {
+        ret = CSRMMNumeric<XPU, IdType, DType>(A, A_weights, B, B_weights, C);
+      });
+    });
+  });
+  return ret;
+}
+
+NDArray CSRSumNumeric(
+    const std::vector<CSRMatrix>& A,
+    const std::vector<NDArray>& A_weights,
+    const CSRMatrix& C) {
+  NDArray ret;
+  ATEN_XPU_SWITCH_CUDA(C.indptr->ctx.device_type, XPU, "CSRSum", {
+    ATEN_ID_TYPE_SWITCH(C.indptr->dtype, IdType, {
+      ATEN_FLOAT_TYPE_SWITCH(A_weights[0]->dtype, DType, "Edge weights", {
+        ret = CSRSumNumeric<XPU, IdType, DType>(A, A_weights, C);
+      });
+    });
+  });
+  return ret;
+}
+
+namespace {
+
+/*!
+ * \brief The symbolic result of a product or a sum of sparse matrices, cached
+ *        on the first operand.
+ */
+struct SparseResultPlan {
+  /*! \brief The indptr and indices arrays of the other operands. */
+  std::vector<NDArray> operands;
+  /*! \brief The number of vertex types of the result graph. */
+  int num_vtypes;
+  /*! \brief The result graph and its adjacency matrix. */
+  HeteroGraphPtr graph;
+  CSRMatrix csr;
+};
+
+/*!
+ * \brief The last few symbolic results of the products or the sums of a sparse
+ *        matrix, the most recently used first.
+ */
+class SparseResultPlans {
+ public:
+  /*! \return The plan for the given operands, or nullptr. */
+  std::shared_ptr<SparseResultPlan> Find(
+      const std::vector<NDArray>& operands, int num_vtypes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = plans_.begin(); it != plans_.end(); ++it) {
+      if ((*it)->num_vtypes == num_vtypes && SameArrays((*it)->operands, operands)) {
+        plans_.splice(plans_.begin(), plans_, it);
+        return plans_.front();
+      }
+    }
+    return nullptr;
+  }
+
+  /*! \brief Add a plan, dropping the least recently used one if full. */
+  void Add(std::shared_ptr<SparseResultPlan> plan) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    plans_.push_front(plan);
+    if (plans_.size() > kMaxPlans)
+      plans_.pop_back();
+  }
+
+ private:
+  /*!
+   * \brief The number of plans kept per matrix, e.g. the other operands of a
+   *        metapath and their transposes in the backward pass.
+   */
+  static constexpr size_t kMaxPlans = 4;
+
+  /*!
+   * \brief Whether the arrays are the same. The plans hold the arrays, so
+   *        that their addresses cannot be reused by other arrays.
+   */
+  static bool SameArrays(const std::vector<NDArray>& a, const std::vector<NDArray>& b) {
+    if (a.size() != b.size())
+      return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+      if (a[i]->data != b[i]->data || a[i]->shape[0] != b[i]->shape[0])
+        return false;
+    }
+    return true;
+  }
+
+  std::mutex mutex_;
+  std::list<std::shared_ptr<SparseResultPlan>> plans_;
+};
+
+/*!
+ * \brief Build the plan of a result, sorting its column indices.
+ * \param weights The weights of the result, reordered if the columns are sorted.
+ */
+std::shared_ptr<SparseResultPlan> MakeSparseResultPlan(
+    std::vector<NDArray> operands, int num_vtypes, CSRMatrix result, NDArray* weights) {
+  if (!result.sorted) {
+    result = CSRSort(result);
+    *weights = IndexSelect(*weights, result.data);
+    result.data = NullArray(result.indptr->dtype, result.indptr->ctx);
+  }
+  auto plan = std::make_shared<SparseResultPlan>();
+  plan->operands = std::move(operands);
+  plan->num_vtypes = num_vtypes;
+  plan->graph = CreateFromCSR(num_vtypes, result, ALL_CODE);
+  plan->csr = result;
+  return plan;
+}
+
+/*! \return The plans of the results with the given first operand, or nullptr. */
+SparseResultPlans* GetSparseResultPlans(HeteroGraphPtr graph, const std::string& op) {
+  auto cache = graph->GetKernelPlanCache(0, SparseFormat::kCSR);
+  if (!cache)
+    return nullptr;
+  return cache->GetOrCreate<SparseResultPlans>(
+      std::string(typeid(SparseResultPlans).name()) + op,
+      [] { return std::make_shared<SparseResultPlans>(); }).get();
+}
+
+}  // namespace
+
+std::pair<HeteroGraphPtr, NDArray> CSRMM(
+    HeteroGraphPtr A,
+    NDArray A_weights,
+    HeteroGraphPtr B,
+    NDArray B_weights,
+    int num_vtypes,
+    int64_t topk) {
+  CHECK_EQ(A->NumEdgeTypes(), 1) << "The first graph must have only one edge type.";
+  CHECK_EQ(B->NumEdgeTypes(), 1) << "The second graph must have only one edge type.";
+  const auto A_csr = A->GetCSRMatrix(0);
+  const auto B_csr = B->GetCSRMatrix(0);
+  if (topk >= 0) {
+    auto result = CSRMMTopK(A_csr, A_weights, B_csr, B_weights, topk);
+    return {CreateFromCSR(num_vtypes, result.first, ALL_CODE), result.second};
+  }
+  const std::vector<NDArray> operands = {B_csr.indptr, B_csr.indices};
+  SparseResultPlans* plans = GetSparseResultPlans(A, "CSRMM");
+  auto plan = plans ? plans->Find(operands, num_vtypes) : nullptr;
+  if (plan) {
+    // the inputs are checked by CSRMM when building the plan
+    CHECK_EQ(A_weights->dtype, B_weights->dtype) <<
+      "Data types of two edge weights must match.";
+    CheckCtx(A_csr.indptr->ctx, {A_weights, B_weights},
+             {"A's edge weights", "B's edge weights"});
+    return {plan->graph, CSRMMNumeric(A_csr, A_weights, B_csr, B_weights, plan->csr)};
+  }
+  auto result = CSRMM(A_csr, A_weights, B_csr, B_weights);
+  if (!plans)
+    return {CreateFromCSR(num_vtypes, result.first, ALL_CODE), result.second};
+  NDArray C_weights = result.second;
+  plan = MakeSparseResultPlan(operands, num_vtypes, result.first, &C_weights);
+  plans->Add(plan);
+  return {plan->graph, C_weights};
+}
+
+std::pair<HeteroGraphPtr, NDArray> CSRSum(
+    const std::vector<HeteroGraphPtr>& A,
+    const std::vector<NDArray>& A_weights) {
+  CHECK(A.size() > 0) << "The list of graphs must not be empty.";
+  std::vector<CSRMatrix> mats;
+  std::vector<NDArray> operands;
+  mats.reserve(A.size());
+  for (size_t i = 0; i < A.size(); ++i) {
+    CHECK_EQ(A[i]->NumEdgeTypes(), 1) << "Graphs must have only one edge type.";
+    mats.push_back(A[i]->GetCSRMatrix(0));
+    if (i > 0) {
+      operands.push_back(mats[i].indptr);
+      operands.push_back(mats[i].indices);
+    }
+  }
+  const int num_vtypes = A[0]->NumVertexTypes();
+  SparseResultPlans* plans = GetSparseResultPlans(A[0], "CSRSum");
+  auto plan = plans ? plans->Find(operands, num_vtypes) : nullptr;
+  if (plan) {
+    CHECK_EQ(A.size(), A_weights.size()) <<
+      "The list of edge weights must have the same length as the list of graphs.";
+    for (size_t i = 0; i < A.size(); ++i) {
+      CHECK_EQ(A_weights[i]->ctx, mats[0].indptr->ctx) <<
+        "The devices of edge weights must be the same as that of the graphs.";
+      CHECK_EQ(A_weights[i]->dtype, A_weights[0]->dtype) <<
+        "The data types of all edge weights must be equal.";
+    }
+    return {plan->graph, CSRSumNumeric(mats, A_weights, plan->csr)};
+  }
+  auto result = CSRSum(mats, A_weights);
+  if (!plans)
+    return {CreateFromCSR(num_vtypes, result.first, ALL_CODE), result.second};
+  NDArray C_weights = result.second;
+  plan = MakeSparseResultPlan(operands, num_vtypes, result.first, &C_weights);
+  plans->Add(plan);
+  return {plan->graph, C_weights};
+}
+
+NDArray CSRMaskedMM(
+    HeteroGraphPtr A,
+    NDArray A_weights,
+    HeteroGraphPtr B,
+    NDArray B_weights,
+    HeteroGraphPtr mask) {
+  CHECK_EQ(A->NumEdgeTypes(), 1) << "The first graph must have only one edge type.";
+  CHECK_EQ(B->NumEdgeTypes(), 1) << "The second graph must have only one edge type.";
+  CHECK_EQ(mask->NumEdgeTypes(), 1) << "The mask must have only one edge type.";
+  // the rows of the CSC matrix of B are its columns
+  return CSRMaskedMM(A->GetCSRMatrix(0), A_weights, B->GetCSCMatrix(0), B_weights,
+                     mask->GetCOOMatrix(0));
+}
+
 DGL_REGISTER_GLOBAL("sparse._CAPI_DGLKernelSpMM")
 .set_body([] (DGLArgs args, DGLRetValue* rv) {
     HeteroGraphRef graph = args[0];
@@ -348,6 +924,33 @@ DGL_REGISTER_GLOBAL("sparse._CAPI_DGLKernelSpMM")
     SpMM(op, reduce_op, graph.sptr(), U, E, V, {ArgU, ArgE});
   });
 
+DGL_REGISTER_GLOBAL("sparse._CAPI_DGLKernelSpMMWithIndex")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    HeteroGraphRef graph = args[0];
+    const std::string op = args[1];
+    const std::string reduce_op = args[2];
+    NDArray U = args[3];
+    IdArray U_index = args[4];
+    NDArray E = args[5];
+    NDArray V = args[6];
+    NDArray ArgU = args[7];
+    NDArray ArgE = args[8];
+    // the table may be in pinned host memory
+    CheckCtx(graph->Context(), {U_index, E, V, ArgU, ArgE},
+        {"U_index", "E_data", "out", "Arg_U", "Arg_E"});
+    CheckContiguous({U, E, V, ArgU, ArgE},
+        {"U_data", "E_data", "out", "Arg_U", "Arg_E"});
+    CHECK_EQ(graph->NumEdgeTypes(), 1);
+    auto pair = graph->meta_graph()->FindEdge(0);  // only one etype in the graph.
+    const dgl_type_t dst_vtype = pair.second;
+    CheckShape(
+        {graph->NumEdges(0), graph->NumVertices(dst_vtype)},
+        {0, 1, 1, 1},
+        {E, V, ArgU, ArgE},
+        {"E_data", "out", "Arg_U", "Arg_E"});
+    SpMMWithIndex(op, reduce_op, graph.sptr(), U, U_index, E, V, {ArgU, ArgE});
+  });
+
 DGL_REGISTER_GLOBAL("sparse._CAPI_DGLKernelSpMMHetero")
 .set_body([] (DGLArgs args, DGLRetValue* rv) {
     HeteroGraphRef graph = args[0];
@@ -439,6 +1042,84 @@ DGL_REGISTER_GLOBAL("sparse._CAPI_DGLKernelSDDMMHetero")
     SDDMMHetero(op, graph.sptr(), vec_lhs, vec_rhs, vec_out, lhs_target, rhs_target);
   });
 
+DGL_REGISTER_GLOBAL("sparse._CAPI_DGLKernelFusedAttention")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    HeteroGraphRef graph = args[0];
+    const std::string op = args[1];
+    NDArray lhs = args[2];
+    NDArray rhs = args[3];
+    NDArray feat = args[4];
+    const double negative_slope = args[5];
+    NDArray out = args[6];
+    NDArray out_lse = args[7];
+    CHECK_EQ(graph->NumEdgeTypes(), 1);
+    CheckCtx(graph->Context(), {lhs, rhs, feat, out, out_lse},
+        {"lhs", "rhs", "feat", "out", "out_lse"});
+    CheckContiguous({lhs, rhs, feat, out, out_lse},
+        {"lhs", "rhs", "feat", "out", "out_lse"});
+    auto pair = graph->meta_graph()->FindEdge(0);
+    const dgl_type_t src_vtype = pair.first;
+    const dgl_type_t dst_vtype = pair.second;
+    CHECK_EQ(lhs->ndim, 3) << "lhs must be of shape (N_src, H, D).";
+    CHECK_EQ(rhs->ndim, 3) << "rhs must be of shape (N_dst, H, D).";
+    CHECK_EQ(feat->ndim, 3) << "feat must be of shape (N_src, H, F).";
+    CHECK_EQ(out->ndim, 3) << "out must be of shape (N_dst, H, F).";
+    CheckShape(
+        {graph->NumVertices(src_vtype), graph->NumVertices(dst_vtype)},
+        {0, 1, 0, 1},
+        {lhs, rhs, feat, out},
+        {"lhs", "rhs", "feat", "out"});
+    for (int i = 1; i < 3; ++i) {
+      CHECK_EQ(lhs->shape[i], rhs->shape[i]) << "lhs and rhs must have the same shape.";
+      CHECK_EQ(feat->shape[i], out->shape[i]) << "feat and out must have the same shape.";
+    }
+    CHECK_EQ(lhs->shape[1], feat->shape[1])
+      << "The number of heads of the scores and the features must match.";
+    if (op == "add")
+      CHECK_EQ(lhs->shape[2], 1) << "The add operator expects one score per head.";
+    if (!aten::IsNullArray(out_lse)) {
+      CHECK_EQ(out_lse->ndim, 2) << "out_lse must be of shape (N_dst, H).";
+      CHECK_EQ(out_lse->shape[0], out->shape[0]);
+      CHECK_EQ(out_lse->shape[1], out->shape[1]);
+    }
+    FusedAttention(op, graph.sptr(), lhs, rhs, feat, negative_slope, out, out_lse);
+  });
+
+DGL_REGISTER_GLOBAL("sparse._CAPI_DGLKernelEdgeSoftmaxForward")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    HeteroGraphRef graph = args[0];
+    NDArray score = args[1];
+    NDArray out = args[2];
+    CHECK_EQ(graph->NumEdgeTypes(), 1);
+    CheckCtx(graph->Context(), {score, out}, {"score", "out"});
+    CheckContiguous({score, out}, {"score", "out"});
+    CHECK_EQ(score->shape[0], graph->NumEdges(0))
+      << "score must have one row per edge.";
+    CHECK_EQ(score.NumElements(), out.NumElements())
+      << "score and out must have the same shape.";
+    EdgeSoftmaxForward(graph.sptr(), score, out);
+  });
+
+DGL_REGISTER_GLOBAL("sparse._CAPI_DGLKernelEdgeSoftmaxBackward")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    HeteroGraphRef graph = args[0];
+    NDArray out = args[1];
+    NDArray grad_out = args[2];
+    NDArray grad_score = args[3];
+    CHECK_EQ(graph->NumEdgeTypes(), 1);
+    CheckCtx(graph->Context(), {out, grad_out, grad_score},
+        {"out", "grad_out", "grad_score"});
+    CheckContiguous({out, grad_out, grad_score},
+        {"out", "grad_out", "grad_score"});
+    CHECK_EQ(out->shape[0], graph->NumEdges(0))
+      << "out must have one row per edge.";
+    CHECK_EQ(out.NumElements(), grad_out.NumElements())
+      << "out and grad_out must have the same shape.";
+    CHECK_EQ(out.NumElements(), grad_score.NumElements())
+      << "out and grad_score must have the same shape.";
+    EdgeSoftmaxBackward(graph.sptr(), out, grad_out, grad_score);
+  });
+
 DGL_REGISTER_GLOBAL("sparse._CAPI_DGLKernelSegmentReduce")
 .set_body([] (DGLArgs args, DGLRetValue* rv) {
     const std::string op = args[0];
@@ -461,6 +1142,36 @@ DGL_REGISTER_GLOBAL("sparse._CAPI_DGLKernelScatterAdd")
     ScatterAddDispatch(feat, idx, out);
   });
 
+DGL_REGISTER_GLOBAL("sparse._CAPI_DGLKernelSparseAdagradUpdate")
+.set_body([](DGLArgs args, DGLRetValue *rv) {
+    NDArray weight = args[0];
+    NDArray state = args[1];
+    IdArray idx = args[2];
+    NDArray grad = args[3];
+    const double lr = args[4];
+    const double eps = args[5];
+    CheckCtx(grad->ctx, {idx, grad}, {"idx", "grad"});
+    CheckContiguous({idx, grad}, {"idx", "grad"});
+    SparseAdagradUpdateDispatch(weight, state, idx, grad, lr, eps);
+  });
+
+DGL_REGISTER_GLOBAL("sparse._CAPI_DGLKernelSparseAdamUpdate")
+.set_body([](DGLArgs args, DGLRetValue *rv) {
+    NDArray weight = args[0];
+    NDArray step = args[1];
+    NDArray mem = args[2];
+    NDArray power = args[3];
+    IdArray idx = args[4];
+    NDArray grad = args[5];
+    const double lr = args[6];
+    const double beta1 = args[7];
+    const double beta2 = args[8];
+    const double eps = args[9];
+    CheckCtx(grad->ctx, {idx, grad}, {"idx", "grad"});
+    CheckContiguous({idx, grad}, {"idx", "grad"});
+    SparseAdamUpdateDispatch(weight, step, mem, power, idx, grad, lr, beta1, beta2, eps);
+  });
+
 DGL_REGISTER_GLOBAL("sparse._CAPI_DGLKernelUpdateGradMinMaxHetero")
 .set_body([](DGLArgs args, DGLRetValue *rv) {
     HeteroGraphRef graph = args[0];
@@ -502,6 +1213,7 @@ DGL_REGISTER_GLOBAL("sparse._CAPI_DGLKernelGetEdgeMapping")
  * \param B_ref The right operand.
  * \param B_weights The edge weights of graph B.
  * \param num_vtypes The number of vertex types of the graph to be returned.
+ * \param topk The number of largest entries to keep in every row, or -1.
  * \return A pair consisting of the new graph as well as its edge weights.
  */
 DGL_REGISTER_GLOBAL("sparse._CAPI_DGLCSRMM")
@@ -511,17 +1223,12 @@ DGL_REGISTER_GLOBAL("sparse._CAPI_DGLCSRMM")
     const HeteroGraphRef B_ref = args[2];
     NDArray B_weights = args[3];
     int num_vtypes = args[4];
+    int64_t topk = args[5];
 
-    const HeteroGraphPtr A = A_ref.sptr();
-    const HeteroGraphPtr B = B_ref.sptr();
-    CHECK_EQ(A->NumEdgeTypes(), 1) << "The first graph must have only one edge type.";
-    CHECK_EQ(B->NumEdgeTypes(), 1) << "The second graph must have only one edge type.";
-    const auto A_csr = A->GetCSRMatrix(0);
-    const auto B_csr = B->GetCSRMatrix(0);
-    auto result = CSRMM(A_csr, A_weights, B_csr, B_weights);
+    auto result = CSRMM(A_ref.sptr(), A_weights, B_ref.sptr(), B_weights, num_vtypes, topk);
 
     List<ObjectRef> ret;
-    ret.push_back(HeteroGraphRef(CreateFromCSR(num_vtypes, result.first, ALL_CODE)));
+    ret.push_back(HeteroGraphRef(result.first));
     ret.push_back(Value(MakeValue(result.second)));
     *rv = ret;
   });
@@ -532,24 +1239,29 @@ DGL_REGISTER_GLOBAL("sparse._CAPI_DGLCSRSum")
     List<Value> A_weights = args[1];
 
     std::vector<NDArray> weights = ListValueToVector<NDArray>(A_weights);
-    std::vector<CSRMatrix> mats;
-    mats.reserve(A_refs.size());
-    int num_vtypes = 0;
-    for (auto A_ref : A_refs) {
-      const HeteroGraphPtr A = A_ref.sptr();
-      CHECK_EQ(A->NumEdgeTypes(), 1) << "Graphs must have only one edge type.";
-      mats.push_back(A->GetCSRMatrix(0));
-      if (num_vtypes == 0)
-        num_vtypes = A->NumVertexTypes();
-    }
-    auto result = CSRSum(mats, weights);
+    std::vector<HeteroGraphPtr> graphs;
+    graphs.reserve(A_refs.size());
+    for (auto A_ref : A_refs)
+      graphs.push_back(A_ref.sptr());
+    auto result = CSRSum(graphs, weights);
 
     List<ObjectRef> ret;
-    ret.push_back(HeteroGraphRef(CreateFromCSR(num_vtypes, result.first, ALL_CODE)));
+    ret.push_back(HeteroGraphRef(result.first));
     ret.push_back(Value(MakeValue(result.second)));
     *rv = ret;
   });
 
+DGL_REGISTER_GLOBAL("sparse._CAPI_DGLCSRMaskedMM")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    const HeteroGraphRef A_ref = args[0];
+    NDArray A_weights = args[1];
+    const HeteroGraphRef B_ref = args[2];
+    NDArray B_weights = args[3];
+    const HeteroGraphRef mask_ref = args[4];
+
+    *rv = CSRMaskedMM(A_ref.sptr(), A_weights, B_ref.sptr(), B_weights, mask_ref.sptr());
+  });
+
 DGL_REGISTER_GLOBAL("sparse._CAPI_DGLCSRMask")
 .set_body([] (DGLArgs args, DGLRetValue* rv) {
     const HeteroGraphRef A_ref = args[0];
@@ -581,6 +1293,12 @@ DGL_REGISTER_GLOBAL("sparse._CAPI_FG_LoadModule")
     dgl::featgraph::LoadFeatGraphModule(path);
   });
 
+DGL_REGISTER_GLOBAL("sparse._CAPI_FG_LoadTunedKernelDir")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    const std::string dir = args[0];
+    dgl::featgraph::LoadTunedKernelDir(dir);
+  });
+
 DGL_REGISTER_GLOBAL("sparse._CAPI_FG_SDDMMTreeReduction")
 .set_body([] (DGLArgs args, DGLRetValue* rv) {
     HeteroGraphRef graph = args[0];
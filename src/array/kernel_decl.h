@@ -19,6 +19,9 @@ namespace aten {
 
 /*!
  * \brief Generalized Sparse Matrix Dense Matrix Multiplication on Csr format.
+ * \note plan_cache is the kernel plan cache of csr (see
+ *       BaseHeteroGraph::GetKernelPlanCache). It may be null, in which case
+ *       no per-graph plan is kept.
  */
 template <int XPU, typename IdType, int bits>
 void SpMMCsr(const std::string& op, const std::string& reduce,
@@ -27,11 +30,39 @@ void SpMMCsr(const std::string& op, const std::string& reduce,
              NDArray ufeat,
              NDArray efeat,
              NDArray out,
-             std::vector<NDArray> out_aux);
+             std::vector<NDArray> out_aux,
+             KernelPlanCache* plan_cache = nullptr);
+
+/*!
+ * \brief Generalized Sparse Matrix Dense Matrix Multiplication on Csr format
+ *        with int64 row pointers and data, IdType being the type of the column
+ *        indices. Only the sum reducer is supported.
+ */
+template <int XPU, typename IdType, int bits>
+void SpMMCsrWideIndptr(const std::string& op, const std::string& reduce,
+                       const BcastOff& bcast,
+                       const aten::CSRMatrix& csr,
+                       NDArray ufeat,
+                       NDArray efeat,
+                       NDArray out);
+
+/*!
+ * \brief Generalized Sparse Matrix Dense Matrix Multiplication on compressed Csr
+ *        format. Only the sum reducer is supported.
+ */
+template <int XPU, typename IdType, int bits>
+void SpMMCompressedCsr(const std::string& op, const std::string& reduce,
+                       const BcastOff& bcast,
+                       const aten::CompressedCSRMatrix& csr,
+                       NDArray ufeat,
+                       NDArray efeat,
+                       NDArray out);
 
 /*!
  * \brief Generalized Sparse Matrix Dense Matrix Multiplication on Csr format
  with heterograph support.
+ * \note plan_caches holds the kernel plan cache of the csr of every relation,
+ *       see SpMMCsr. Missing or null entries keep no plan.
  */
 template <int XPU, typename IdType, int bits>
 void SpMMCsrHetero(const std::string& op, const std::string& reduce,
@@ -42,9 +73,11 @@ void SpMMCsrHetero(const std::string& op, const std::string& reduce,
              std::vector<NDArray>* out,
              std::vector<std::vector<NDArray>>* out_aux,
              const std::vector<dgl_type_t>& ufeat_eid,
-             const std::vector<dgl_type_t>& out_eid);
+             const std::vector<dgl_type_t>& out_eid,
+             std::vector<KernelPlanCache*> plan_caches = {});
 /*!
  * \brief Generalized Sparse Matrix Dense Matrix Multiplication on Coo format.
+ * \note plan_cache is the kernel plan cache of coo, see SpMMCsr.
  */
 template <int XPU, typename IdType, int bits>
 void SpMMCoo(const std::string& op, const std::string& reduce,
@@ -53,7 +86,8 @@ void SpMMCoo(const std::string& op, const std::string& reduce,
              NDArray ufeat,
              NDArray efeat,
              NDArray out,
-             std::vector<NDArray> out_aux);
+             std::vector<NDArray> out_aux,
+             KernelPlanCache* plan_cache = nullptr);
 
 /*!
  * \brief Generalized Sampled Dense-Dense Matrix Multiplication on Csr format.
@@ -112,6 +146,36 @@ void SDDMMCooHetero(const std::string& op,
               const std::vector<dgl_type_t>& lhs_eid,
               const std::vector<dgl_type_t>& rhs_eid);
 
+/*!
+ * \brief Fused SDDMM, edge softmax and SpMM on Csr format, for attention layers.
+ */
+template <int XPU, typename IdType, int bits>
+void FusedAttentionCsr(const std::string& op,
+                       const aten::CSRMatrix& csc,
+                       NDArray lhs,
+                       NDArray rhs,
+                       NDArray feat,
+                       double negative_slope,
+                       NDArray out,
+                       NDArray out_lse);
+
+/*!
+ * \brief Softmax of the edge scores over the rows of a Csr matrix.
+ */
+template <int XPU, typename IdType, int bits>
+void EdgeSoftmaxForwardCsr(const aten::CSRMatrix& csc,
+                           NDArray score,
+                           NDArray out);
+
+/*!
+ * \brief Gradient of the edge scores of EdgeSoftmaxForwardCsr.
+ */
+template <int XPU, typename IdType, int bits>
+void EdgeSoftmaxBackwardCsr(const aten::CSRMatrix& csc,
+                            NDArray out,
+                            NDArray grad_out,
+                            NDArray grad_score);
+
 /*!
  * \brief Segment reduce.
  */
@@ -149,6 +213,42 @@ void BackwardSegmentCmp(NDArray feat,
                         NDArray arg,
                         NDArray out);
 
+/*!
+ * \brief Sparse Adagrad update of the rows of an embedding, in place.
+ *
+ * \param weight The embedding.
+ * \param state The sums of the squared gradients, of the shape of weight.
+ * \param idx The unique rows to update.
+ * \param grad The gradients of the rows.
+ * \param counts The number of gradients summed in every row of grad, which are
+ *        averaged, or a null array if every row is a single gradient.
+ *
+ * \note On GPU, the embedding and the states can be in pinned host memory.
+ */
+template <int XPU, typename IdType, typename DType>
+void SparseAdagradUpdate(
+    NDArray weight, NDArray state, IdArray idx, NDArray grad, IdArray counts,
+    double lr, double eps);
+
+/*!
+ * \brief Sparse Adam update of the rows of an embedding, in place.
+ *
+ * \param weight The embedding.
+ * \param step The number of updates of every row.
+ * \param mem The first moments, of the shape of weight.
+ * \param power The second moments, of the shape of weight.
+ * \param idx The unique rows to update.
+ * \param grad The gradients of the rows.
+ * \param counts The number of gradients summed in every row of grad, which are
+ *        averaged, or a null array if every row is a single gradient.
+ *
+ * \note On GPU, the embedding and the states can be in pinned host memory.
+ */
+template <int XPU, typename IdType, typename DType>
+void SparseAdamUpdate(
+    NDArray weight, NDArray step, NDArray mem, NDArray power, IdArray idx,
+    NDArray grad, IdArray counts, double lr, double beta1, double beta2, double eps);
+
 /*!
  * \brief Sparse-sparse matrix multiplication
  *
@@ -168,6 +268,48 @@ std::pair<CSRMatrix, NDArray> CSRMM(
     const CSRMatrix& B,
     NDArray B_weights);
 
+/*!
+ * \brief Sparse-sparse matrix multiplication keeping the k largest entries of
+ *        every row of the product, the smallest columns first among equal
+ *        entries, to bound its density.
+ *
+ * \param A The left operand.
+ * \param A_weights The weights of matrix as a 1D tensor.
+ * \param B The right operand.
+ * \param B_weights The weights of matrix as a 1D tensor.
+ * \param k The number of entries to keep in every row.
+ *
+ * \note The CSR matrix should not have duplicate entries.
+ */
+template <int XPU, typename IdType, typename DType>
+std::pair<CSRMatrix, NDArray> CSRMMTopK(
+    const CSRMatrix& A,
+    NDArray A_weights,
+    const CSRMatrix& B,
+    NDArray B_weights,
+    int64_t k);
+
+/*!
+ * \brief Sparse-sparse matrix multiplication computed only at the entries of a
+ *        mask, as the dot products of the rows of A and the columns of B.
+ *
+ * \param A The left operand, with sorted column indices.
+ * \param A_weights The weights of matrix A as a 1D tensor.
+ * \param B_t The transpose of the right operand, with sorted column indices.
+ * \param B_weights The weights of matrix B as a 1D tensor.
+ * \param mask The entries of the product to compute.
+ * \return The entries of the product, in the order of the mask.
+ *
+ * \note The CSR matrices should not have duplicate entries.
+ */
+template <int XPU, typename IdType, typename DType>
+NDArray CSRMaskedMM(
+    const CSRMatrix& A,
+    NDArray A_weights,
+    const CSRMatrix& B_t,
+    NDArray B_weights,
+    const COOMatrix& mask);
+
 /*!
  * \brief Sparse-sparse matrix summation.
  *
@@ -183,6 +325,46 @@ std::pair<CSRMatrix, NDArray> CSRSum(
     const std::vector<CSRMatrix>& A,
     const std::vector<NDArray>& A_weights);
 
+/*!
+ * \brief Numeric phase of the sparse-sparse matrix multiplication.
+ *
+ * Compute the weights of C = A x B, given the sparsity of C computed beforehand
+ * by CSRMM (the symbolic phase). The weights of the same sparse product can
+ * thus be recomputed without the analysis and workspaces of CSRMM.
+ *
+ * \param A The left operand.
+ * \param A_weights The weights of matrix A as a 1D tensor.
+ * \param B The right operand.
+ * \param B_weights The weights of matrix B as a 1D tensor.
+ * \param C The sparsity of the product, with sorted column indices and no data.
+ * \return The weights of C.
+ *
+ * \note The CSR matrices should not have duplicate entries.
+ */
+template <int XPU, typename IdType, typename DType>
+NDArray CSRMMNumeric(
+    const CSRMatrix& A,
+    NDArray A_weights,
+    const CSRMatrix& B,
+    NDArray B_weights,
+    const CSRMatrix& C);
+
+/*!
+ * \brief Numeric phase of the sparse-sparse matrix summation.
+ *
+ * \param A The sparse matrices with the same size.
+ * \param A_weights The weights of each sparse matrix as a 1D tensor.
+ * \param C The sparsity of the sum, with sorted column indices and no data.
+ * \return The weights of C.
+ *
+ * \note The CSR matrices should not have duplicate entries.
+ */
+template <int XPU, typename IdType, typename DType>
+NDArray CSRSumNumeric(
+    const std::vector<CSRMatrix>& A,
+    const std::vector<NDArray>& A_weights,
+    const CSRMatrix& C);
+
 }  // namespace aten
 }  // namespace dgl
 
@@ -16,6 +16,11 @@ Copyright (c) 2021 Intel Corporation
 #include <dmlc/omp.h>
 #include <dgl/packed_func_ext.h>
 #include <dgl/base_heterograph.h>
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <string>
 #include <vector>
 
 #ifdef USE_TVM
@@ -42,31 +47,123 @@ int32_t Ver2partition(IdType in_val, int64_t* node_map, int32_t num_parts) {
   LOG(FATAL) << "Error: Unexpected output in Ver2partition!";
 }
 
-/*! \brief Identifies the lead loaded partition/community for a given edge assignment.*/
-int32_t LeastLoad(int64_t* community_edges, int32_t nc) {
-  std::vector<int> loc;
-  int32_t min = 1e9;
-  for (int32_t i=0; i < nc; i++) {
-    if (community_edges[i] < min) {
-      min = community_edges[i];
+/*! \brief Number of edges a stream of LibraVertexCut assigns between two
+ *  synchronizations of the partition loads. */
+constexpr int64_t kLibraSyncInterval = 4096;
+
+namespace {
+
+/*! \brief Number of set bits of a word. */
+inline int32_t CountBits(uint64_t bits) {
+  int32_t n = 0;
+  for (; bits; bits &= bits - 1)
+    ++n;
+  return n;
+}
+
+/*!
+ * \brief The partitions of every node, as nc bits per node, updated atomically
+ *        so that the edges can be assigned by several threads.
+ */
+class PartitionSets {
+ public:
+  PartitionSets(int64_t num_nodes, int32_t nc)
+    : words_((nc + 63) / 64), bits_(new std::atomic<uint64_t>[num_nodes * words_]) {
+    runtime::parallel_for(0, num_nodes * words_, [&](size_t b, size_t e) {
+      for (size_t i = b; i < e; ++i)
+        bits_[i].store(0, std::memory_order_relaxed);
+    });
+  }
+
+  int64_t Words() const { return words_; }
+
+  /*! \brief Copy the bits of node v to mask, returning whether any is set. */
+  bool Load(int64_t v, uint64_t* mask) const {
+    uint64_t any = 0;
+    for (int64_t w = 0; w < words_; ++w) {
+      mask[w] = bits_[v * words_ + w].load(std::memory_order_relaxed);
+      any |= mask[w];
     }
+    return any != 0;
+  }
+
+  void Add(int64_t v, int32_t c) {
+    bits_[v * words_ + c / 64].fetch_or(uint64_t{1} << (c % 64), std::memory_order_relaxed);
+  }
+
+  /*! \brief Number of partitions of node v. */
+  int32_t Count(int64_t v) const {
+    int32_t n = 0;
+    for (int64_t w = 0; w < words_; ++w)
+      n += CountBits(bits_[v * words_ + w].load(std::memory_order_relaxed));
+    return n;
   }
-  for (int32_t i=0; i < nc; i++) {
-    if (community_edges[i] == min) {
-      loc.push_back(i);
+
+  /*! \brief Number of partitions of node v before the partition c. */
+  int32_t Rank(int64_t v, int32_t c) const {
+    int32_t n = 0;
+    for (int64_t w = 0; w < c / 64; ++w)
+      n += CountBits(bits_[v * words_ + w].load(std::memory_order_relaxed));
+    const uint64_t below = (uint64_t{1} << (c % 64)) - 1;
+    return n + CountBits(bits_[v * words_ + c / 64].load(std::memory_order_relaxed) & below);
+  }
+
+ private:
+  int64_t words_;
+  std::unique_ptr<std::atomic<uint64_t>[]> bits_;
+};
+
+/*! \brief Calls f with every partition set in mask, in increasing order. */
+template <typename F>
+void ForEachPart(const uint64_t* mask, int64_t words, F f) {
+  for (int64_t w = 0; w < words; ++w) {
+    int32_t c = w * 64;
+    for (uint64_t bits = mask[w]; bits; bits >>= 1, ++c) {
+      if (bits & 1)
+        f(c);
     }
   }
+}
+
+/*!
+ * \brief Identifies the least loaded partition/community out of the ones set in
+ *        mask, breaking the ties uniformly at random, in a single pass.
+ */
+int32_t LeastLoad(const uint64_t* mask, int64_t words, const int64_t* loads) {
+  int32_t best = -1;
+  int64_t min = std::numeric_limits<int64_t>::max();
+  int64_t ties = 0;
+  ForEachPart(mask, words, [&](int32_t c) {
+    if (loads[c] < min) {
+      min = loads[c];
+      best = c;
+      ties = 1;
+    } else if (loads[c] == min && RandomEngine::ThreadLocal()->RandInt(++ties) == 0) {
+      best = c;
+    }
+  });
+  CHECK_GE(best, 0) << "[bug] no partition to choose from!";
+  return best;
+}
 
-  int32_t r = RandomEngine::ThreadLocal()->RandInt(loc.size());
-  CHECK(loc[r] < nc);
-  return loc[r];
+/*! \brief Splits [0, num_items) into one contiguous range per thread. */
+int64_t NumStreams(int64_t num_items, int64_t min_items) {
+  return std::max<int64_t>(1, std::min<int64_t>(omp_get_max_threads(), num_items / min_items));
 }
 
+}  // namespace
+
 /*! \brief Libra - vertexcut based graph partitioning.
   It takes list of edges from input DGL graph and distributed them among nc partitions
   During edge distribution, Libra assign a given edge to a partition based on the end vertices,
   in doing so, it tries to minimized the splitting of the graph vertices. In case of conflict
   Libra assigns an edge to the least loaded partition/community.
+
+  The edges are split into one contiguous stream per thread. The streams assign
+  their edges concurrently, sharing the partitions of the nodes, and every
+  kLibraSyncInterval edges publish the loads of their assignments and read the
+  loads of the other streams; in between, a stream sees its own assignments only.
+  The partitions of a node are a bitset of nc bits.
   \param[in] nc Number of partitions/communities
   \param[in] node_degree per node degree
   \param[in] edgenum_unassigned node degree
@@ -100,190 +197,128 @@ void LibraVertexCut(
   int64_t *w_ptr                  = w.Ptr<int64_t>();
   int64_t *community_weights_ptr  = community_weights.Ptr<int64_t>();
 
-  std::vector<std::vector<int32_t> > node_assignments(N_n);
-  std::vector<IdType2> replication_list;
-  // local allocations
-  int64_t *community_edges = new int64_t[nc]();
-  int64_t *cache = new int64_t[nc]();
-
-  int64_t meter = static_cast<int>(N_e/100);
-  for (int64_t i=0; i < N_e; i++) {
-    IdType u = u_ptr[i];    // edge end vertex 1
-    IdType v = v_ptr[i];    // edge end vertex 2
-    int64_t  w = w_ptr[i];    // edge weight
-
-    CHECK(u < N_n);
-    CHECK(v < N_n);
-
-    if (i % meter == 0) {
-      fprintf(stderr, "."); fflush(0);
-    }
-
-    if (node_assignments[u].size() == 0 && node_assignments[v].size() == 0) {
-      int32_t c = LeastLoad(community_edges, nc);
-      out_ptr[i] = c;
-      CHECK_LT(c, nc);
-
-      community_edges[c]++;
-      community_weights_ptr[c] = community_weights_ptr[c] + w;
-      node_assignments[u].push_back(c);
-      if (u != v)
-        node_assignments[v].push_back(c);
-
-      CHECK(node_assignments[u].size() <= nc) <<
-        "[bug] 1. generated splits (u) are greater than nc!";
-      CHECK(node_assignments[v].size() <= nc) <<
-        "[bug] 1. generated splits (v) are greater than nc!";
-      edgenum_unassigned_ptr[u]--;
-      edgenum_unassigned_ptr[v]--;
-    } else if (node_assignments[u].size() != 0 && node_assignments[v].size() == 0) {
-      for (uint32_t j=0; j < node_assignments[u].size(); j++) {
-        int32_t cind = node_assignments[u][j];
-        cache[j] = community_edges[cind];
-      }
-      int32_t cindex = LeastLoad(cache, node_assignments[u].size());
-      int32_t c = node_assignments[u][cindex];
-      out_ptr[i] = c;
-      community_edges[c]++;
-      community_weights_ptr[c] = community_weights_ptr[c] + w;
-
-      node_assignments[v].push_back(c);
-      CHECK(node_assignments[v].size() <= nc) <<
-        "[bug] 2. generated splits (v) are greater than nc!";
-      edgenum_unassigned_ptr[u]--;
-      edgenum_unassigned_ptr[v]--;
-    } else if (node_assignments[v].size() != 0 && node_assignments[u].size() == 0) {
-      for (uint32_t j=0; j < node_assignments[v].size(); j++) {
-        int32_t cind = node_assignments[v][j];
-        cache[j] = community_edges[cind];
-      }
-      int32_t cindex = LeastLoad(cache, node_assignments[v].size());
-      int32_t c = node_assignments[v][cindex];
-      CHECK(c < nc) << "[bug] 2. partition greater than nc !!";
-      out_ptr[i] = c;
-
-      community_edges[c]++;
-      community_weights_ptr[c] = community_weights_ptr[c] + w;
-
-      node_assignments[u].push_back(c);
-      CHECK(node_assignments[u].size() <= nc) <<
-        "[bug] 3. generated splits (u) are greater than nc!";
-      edgenum_unassigned_ptr[u]--;
-      edgenum_unassigned_ptr[v]--;
-    } else {
-      std::vector<int> setv(nc), intersetv;
-      for (int32_t j=0; j < nc; j++) setv[j] = 0;
-      int32_t interset = 0;
-
-      CHECK(node_assignments[u].size() <= nc) <<
-        "[bug] 4. generated splits (u) are greater than nc!";
-      CHECK(node_assignments[v].size() <= nc) <<
-        "[bug] 4. generated splits (v) are greater than nc!";
-      for (int32_t j=0; j < node_assignments[v].size(); j++) {
-        CHECK(node_assignments[v][j] < nc) << "[bug] 4. Part assigned (v) greater than nc!";
-        setv[node_assignments[v][j]]++;
-      }
-
-      for (int32_t j=0; j < node_assignments[u].size(); j++) {
-        CHECK(node_assignments[u][j] < nc) << "[bug] 4. Part assigned (u) greater than nc!";
-        setv[node_assignments[u][j]]++;
-      }
-
-      for (int32_t j=0; j < nc; j++) {
-        CHECK(setv[j] <= 2) << "[bug] 4. unexpected computed value !!!";
-        if (setv[j] == 2) {
-          interset++;
-          intersetv.push_back(j);
+  PartitionSets node_assignments(N_n, nc);
+  const int64_t words = node_assignments.Words();
+  std::vector<uint64_t> all_parts(words, 0);
+  for (int32_t c = 0; c < nc; c++)
+    all_parts[c / 64] |= uint64_t{1} << (c % 64);
+
+  // the loads published by the streams
+  std::unique_ptr<std::atomic<int64_t>[]> community_edges(new std::atomic<int64_t>[nc]);
+  for (int32_t c = 0; c < nc; c++)
+    community_edges[c].store(0);
+
+  const int64_t num_streams = NumStreams(N_e, kLibraSyncInterval);
+  const int64_t stream_size = (N_e + num_streams - 1) / num_streams;
+  std::vector<std::vector<int64_t>> stream_weights(num_streams, std::vector<int64_t>(nc, 0));
+  std::vector<std::vector<IdType2>> replication_lists(num_streams);
+  const int64_t meter = std::max<int64_t>(stream_size / 100, 1);
+
+  runtime::parallel_for(0, num_streams, 1, [&](size_t sb, size_t se) {
+    for (size_t s = sb; s < se; s++) {
+      const int64_t begin = s * stream_size;
+      const int64_t end = std::min(N_e, begin + stream_size);
+      std::vector<int64_t>& weights = stream_weights[s];
+      std::vector<IdType2>& replication_list = replication_lists[s];
+      // the loads seen by this stream, and its assignments not published yet
+      std::vector<int64_t> loads(nc, 0), pending(nc, 0);
+      std::vector<uint64_t> su(words), sv(words), interset(words);
+
+      for (int64_t i = begin; i < end; i++) {
+        IdType u = u_ptr[i];    // edge end vertex 1
+        IdType v = v_ptr[i];    // edge end vertex 2
+        CHECK(u >= 0 && u < N_n);
+        CHECK(v >= 0 && v < N_n);
+
+        if (s == 0 && (i - begin) % meter == 0) {
+          fprintf(stderr, "."); fflush(0);
         }
-      }
-      if (interset) {
-        for (int32_t j=0; j < intersetv.size(); j++) {
-          int32_t cind = intersetv[j];
-          cache[j] = community_edges[cind];
-        }
-        int32_t cindex = LeastLoad(cache, intersetv.size());
-        int32_t c = intersetv[cindex];
-        CHECK(c < nc) << "[bug] 4. partition greater than nc !!";
-        out_ptr[i] = c;
-        community_edges[c]++;
-        community_weights_ptr[c] = community_weights_ptr[c] + w;
-        edgenum_unassigned_ptr[u]--;
-        edgenum_unassigned_ptr[v]--;
-      } else {
-        if (node_degree_ptr[u] < node_degree_ptr[v]) {
-          for (uint32_t j=0; j < node_assignments[u].size(); j++) {
-            int32_t cind = node_assignments[u][j];
-            cache[j] = community_edges[cind];
-          }
-          int32_t cindex = LeastLoad(cache, node_assignments[u].size());
-          int32_t c = node_assignments[u][cindex];
-          CHECK(c < nc) << "[bug] 5. partition greater than nc !!";
-          out_ptr[i] = c;
-          community_edges[c]++;
-          community_weights_ptr[c] = community_weights_ptr[c] + w;
-
-          for (uint32_t j=0; j < node_assignments[v].size(); j++) {
-            CHECK(node_assignments[v][j] != c) <<
-              "[bug] 5. duplicate partition (v) assignment !!";
-          }
 
-          node_assignments[v].push_back(c);
-          CHECK(node_assignments[v].size() <= nc) <<
-            "[bug] 5. generated splits (v) greater than nc!!";
-          replication_list.push_back(v);
-          edgenum_unassigned_ptr[u]--;
-          edgenum_unassigned_ptr[v]--;
+        const bool has_u = node_assignments.Load(u, su.data());
+        const bool has_v = node_assignments.Load(v, sv.data());
+        int32_t c;
+        if (!has_u && !has_v) {
+          c = LeastLoad(all_parts.data(), words, loads.data());
+          node_assignments.Add(u, c);
+          node_assignments.Add(v, c);
+        } else if (!has_v) {
+          c = LeastLoad(su.data(), words, loads.data());
+          node_assignments.Add(v, c);
+        } else if (!has_u) {
+          c = LeastLoad(sv.data(), words, loads.data());
+          node_assignments.Add(u, c);
         } else {
-          for (uint32_t j=0; j < node_assignments[v].size(); j++) {
-            int32_t cind = node_assignments[v][j];
-            cache[j] = community_edges[cind];
+          uint64_t any = 0;
+          for (int64_t j = 0; j < words; j++) {
+            interset[j] = su[j] & sv[j];
+            any |= interset[j];
           }
-          int32_t cindex = LeastLoad(cache, node_assignments[v].size());
-          int32_t c = node_assignments[v][cindex];
-          CHECK(c < nc)  << "[bug] 6. partition greater than nc !!";
-          out_ptr[i] = c;
-          community_edges[c]++;
-          community_weights_ptr[c] = community_weights_ptr[c] + w;
-          for (uint32_t j=0; j < node_assignments[u].size(); j++) {
-            CHECK(node_assignments[u][j] != c) <<
-              "[bug] 6. duplicate partition (u) assignment !!";
+          if (any) {
+            c = LeastLoad(interset.data(), words, loads.data());
+          } else if (node_degree_ptr[u] < node_degree_ptr[v]) {
+            c = LeastLoad(su.data(), words, loads.data());
+            node_assignments.Add(v, c);
+            replication_list.push_back(v);
+          } else {
+            c = LeastLoad(sv.data(), words, loads.data());
+            node_assignments.Add(u, c);
+            replication_list.push_back(u);
+          }
+        }
+        CHECK_LT(c, nc) << "[bug] partition greater than nc !!";
+        out_ptr[i] = c;
+        loads[c]++;
+        pending[c]++;
+        weights[c] += w_ptr[i];
+
+        if ((i - begin + 1) % kLibraSyncInterval == 0 || i + 1 == end) {
+          for (int32_t p = 0; p < nc; p++) {
+            if (pending[p])
+              community_edges[p].fetch_add(pending[p]);
+            pending[p] = 0;
+            loads[p] = community_edges[p].load();
           }
-          if (u != v)
-            node_assignments[u].push_back(c);
-
-          CHECK(node_assignments[u].size() <= nc) <<
-            "[bug] 6. generated splits (u) greater than nc!!";
-          replication_list.push_back(u);
-          edgenum_unassigned_ptr[u]--;
-          edgenum_unassigned_ptr[v]--;
         }
       }
     }
+  });
+
+  for (int64_t i = 0; i < N_e; i++) {
+    edgenum_unassigned_ptr[u_ptr[i]]--;
+    edgenum_unassigned_ptr[v_ptr[i]]--;
+  }
+  for (int64_t s = 0; s < num_streams; s++) {
+    for (int32_t c = 0; c < nc; c++)
+      community_weights_ptr[c] += stream_weights[s][c];
   }
-  delete cache;
 
+  // a single pass over the edges, into buffered files
+  std::vector<FILE*> fps(nc);
   for (int64_t c=0; c < nc; c++) {
     std::string path = prefix + "/community" + std::to_string(c) +".txt";
-
-    FILE *fp = fopen(path.c_str(), "w");
-    CHECK_NE(fp, static_cast<FILE*>(NULL)) << "Error: can not open file: " << path.c_str();
-
-    for (int64_t i=0; i < N_e; i++) {
-      if (out_ptr[i] == c)
-        fprintf(fp, "%ld,%ld,%f\n", u_ptr[i], v_ptr[i], w_ptr[i]);
-    }
-    fclose(fp);
+    fps[c] = fopen(path.c_str(), "w");
+    CHECK_NE(fps[c], static_cast<FILE*>(NULL)) << "Error: can not open file: " << path.c_str();
+    setvbuf(fps[c], NULL, _IOFBF, 1 << 20);
+  }
+  for (int64_t i=0; i < N_e; i++) {
+    fprintf(fps[out_ptr[i]], "%ld,%ld,%ld\n", static_cast<int64_t>(u_ptr[i]),
+            static_cast<int64_t>(v_ptr[i]), w_ptr[i]);
   }
+  for (int64_t c=0; c < nc; c++)
+    fclose(fps[c]);
 
   std::string path = prefix + "/replicationlist.csv";
   FILE *fp = fopen(path.c_str(), "w");
   CHECK_NE(fp, static_cast<FILE*>(NULL)) << "Error: can not open file: " << path.c_str();
 
   fprintf(fp, "## The Indices of Nodes that are replicated :: Header");
-  printf("\nTotal replication: %ld\n", replication_list.size());
-
-  for (uint64_t i=0; i < replication_list.size(); i++)
-    fprintf(fp, "%ld\n", replication_list[i]);
+  int64_t num_replications = 0;
+  for (const auto& replication_list : replication_lists) {
+    num_replications += replication_list.size();
+    for (IdType2 node : replication_list)
+      fprintf(fp, "%ld\n", static_cast<int64_t>(node));
+  }
+  printf("\nTotal replication: %ld\n", num_replications);
 
   printf("Community weights:\n");
   for (int64_t c=0; c < nc; c++)
@@ -292,10 +327,9 @@ void LibraVertexCut(
 
   printf("Community edges:\n");
   for (int64_t c=0; c < nc; c++)
-    printf("%ld ", community_edges[c]);
+    printf("%ld ", community_edges[c].load());
   printf("\n");
 
-  delete community_edges;
   fclose(fp);
 }
 
@@ -455,6 +489,170 @@ DGL_REGISTER_GLOBAL("sparse._CAPI_DGLLibra2dglBuildDict")
 });
 
 
+/*! \brief Builds the partitions of Libra in memory, from its assignment of the
+  edges: the same dictionaries as Libra2dglBuildDict for all the partitions, and
+  the local edges of every partition, without reading back the community files.
+  The local node IDs of a partition follow the global node IDs, so that the
+  nodes and the edges are processed in parallel.
+  \param[in] u src nodes
+  \param[in] v dst nodes
+  \param[in] out partition assignment of the edges
+  \param[in] nc number of partitions/communities
+  \param[out] gdt_key global dict for storing number of local nodes (or split nodes) for a
+  given global node ID
+  \param[out] gdt_value global dict, stores local node IDs (due to split) across partitions
+  for a given global node ID, in the order of the partitions
+  \param[out] node_map keeps track of range of local node IDs (consecutive) given to the nodes in
+  the partitions
+  \param[in] N_n number of nodes in the input graph
+  \return For every partition, the global node IDs of its local nodes, then the
+  local src and dst node IDs of its edges, in the order of the input edges.
+ */
+template<typename IdType>
+List<Value> Libra2dglBuildPartitions(
+  NDArray u,
+  NDArray v,
+  NDArray out,
+  int32_t nc,
+  NDArray gdt_key,
+  NDArray gdt_value,
+  NDArray node_map,
+  int64_t N_n) {
+  const IdType  *u_ptr         = u.Ptr<IdType>();
+  const IdType  *v_ptr         = v.Ptr<IdType>();
+  const int32_t *out_ptr       = out.Ptr<int32_t>();
+  int64_t       *gdt_key_ptr   = gdt_key.Ptr<int64_t>();
+  int64_t       *gdt_value_ptr = gdt_value.Ptr<int64_t>();   // 2D tensor
+  int64_t       *node_map_ptr  = node_map.Ptr<int64_t>();
+  const int64_t N_e = u->shape[0];
+  const int32_t width = nc;
+  CHECK_EQ(gdt_value->shape[0] * gdt_value->shape[1], N_n * width);
+
+  PartitionSets node_parts(N_n, nc);
+  runtime::parallel_for(0, N_e, [&](size_t b, size_t e) {
+    for (size_t i = b; i < e; i++) {
+      CHECK(out_ptr[i] >= 0 && out_ptr[i] < nc);
+      CHECK(u_ptr[i] >= 0 && u_ptr[i] < N_n);
+      CHECK(v_ptr[i] >= 0 && v_ptr[i] < N_n);
+      node_parts.Add(u_ptr[i], out_ptr[i]);
+      node_parts.Add(v_ptr[i], out_ptr[i]);
+    }
+  });
+
+  // the local node IDs, by blocks of nodes counted then numbered in parallel
+  const int64_t num_blocks = NumStreams(N_n, 1024);
+  const int64_t block_size = (N_n + num_blocks - 1) / num_blocks;
+  std::vector<int64_t> node_pos(num_blocks * nc, 0);
+  const int64_t words = node_parts.Words();
+  runtime::parallel_for(0, num_blocks, 1, [&](size_t bb, size_t be) {
+    for (size_t block = bb; block < be; block++) {
+      const int64_t end = std::min(N_n, static_cast<int64_t>(block + 1) * block_size);
+      std::vector<uint64_t> mask(words);
+      for (int64_t i = block * block_size; i < end; i++) {
+        node_parts.Load(i, mask.data());
+        ForEachPart(mask.data(), words, [&](int32_t c) { node_pos[block * nc + c]++; });
+      }
+    }
+  });
+  std::vector<int64_t> num_local_nodes(nc, 0);
+  for (int32_t c = 0; c < nc; c++) {
+    for (int64_t block = 0; block < num_blocks; block++) {
+      const int64_t n = node_pos[block * nc + c];
+      node_pos[block * nc + c] = num_local_nodes[c];
+      num_local_nodes[c] += n;
+    }
+  }
+  std::vector<int64_t> node_offset(nc, 0);
+  std::vector<IdArray> ldt_key(nc);
+  for (int32_t c = 0; c < nc; c++) {
+    node_offset[c] = c ? node_map_ptr[c - 1] : 0;
+    node_map_ptr[c] = node_offset[c] + num_local_nodes[c];
+    ldt_key[c] = NewIdArray(num_local_nodes[c]);
+  }
+  runtime::parallel_for(0, num_blocks, 1, [&](size_t bb, size_t be) {
+    for (size_t block = bb; block < be; block++) {
+      const int64_t end = std::min(N_n, static_cast<int64_t>(block + 1) * block_size);
+      std::vector<uint64_t> mask(words);
+      for (int64_t i = block * block_size; i < end; i++) {
+        int64_t *ptr = gdt_value_ptr + i * width;
+        int64_t ind = 0;
+        node_parts.Load(i, mask.data());
+        ForEachPart(mask.data(), words, [&](int32_t c) {
+          const int64_t local = node_pos[block * nc + c]++;
+          ldt_key[c].Ptr<int64_t>()[local] = i;
+          ptr[ind++] = node_offset[c] + local;
+        });
+        gdt_key_ptr[i] = ind;
+      }
+    }
+  });
+
+  // the local edges, grouped by partition in the order of the input edges
+  const int64_t num_streams = NumStreams(N_e, kLibraSyncInterval);
+  const int64_t stream_size = (N_e + num_streams - 1) / num_streams;
+  std::vector<int64_t> edge_pos(num_streams * nc, 0);
+  runtime::parallel_for(0, num_streams, 1, [&](size_t sb, size_t se) {
+    for (size_t s = sb; s < se; s++) {
+      const int64_t end = std::min(N_e, static_cast<int64_t>(s + 1) * stream_size);
+      for (int64_t i = s * stream_size; i < end; i++)
+        edge_pos[s * nc + out_ptr[i]]++;
+    }
+  });
+  std::vector<IdArray> src(nc), dst(nc);
+  for (int32_t c = 0; c < nc; c++) {
+    int64_t num_local_edges = 0;
+    for (int64_t s = 0; s < num_streams; s++) {
+      const int64_t n = edge_pos[s * nc + c];
+      edge_pos[s * nc + c] = num_local_edges;
+      num_local_edges += n;
+    }
+    src[c] = NewIdArray(num_local_edges);
+    dst[c] = NewIdArray(num_local_edges);
+  }
+  auto local_id = [&](int64_t node, int32_t c) {
+    return gdt_value_ptr[node * width + node_parts.Rank(node, c)] - node_offset[c];
+  };
+  runtime::parallel_for(0, num_streams, 1, [&](size_t sb, size_t se) {
+    for (size_t s = sb; s < se; s++) {
+      const int64_t end = std::min(N_e, static_cast<int64_t>(s + 1) * stream_size);
+      for (int64_t i = s * stream_size; i < end; i++) {
+        const int32_t c = out_ptr[i];
+        const int64_t pos = edge_pos[s * nc + c]++;
+        src[c].Ptr<int64_t>()[pos] = local_id(u_ptr[i], c);
+        dst[c].Ptr<int64_t>()[pos] = local_id(v_ptr[i], c);
+      }
+    }
+  });
+
+  List<Value> ret;
+  for (int32_t c = 0; c < nc; c++) {
+    ret.push_back(Value(MakeValue(ldt_key[c])));
+    ret.push_back(Value(MakeValue(src[c])));
+    ret.push_back(Value(MakeValue(dst[c])));
+  }
+  return ret;
+}
+
+
+DGL_REGISTER_GLOBAL("sparse._CAPI_DGLLibra2dglBuildPartitions")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+  NDArray u         = args[0];
+  NDArray v         = args[1];
+  NDArray out       = args[2];
+  int32_t nc        = args[3];
+  NDArray gdt_key   = args[4];
+  NDArray gdt_value = args[5];
+  NDArray node_map  = args[6];
+  int64_t Nn        = args[7];
+
+  CHECK_SAME_DTYPE(u, v);
+  ATEN_ID_TYPE_SWITCH(u->dtype, IdType, {
+      *rv = Libra2dglBuildPartitions<IdType>(u, v, out, nc, gdt_key, gdt_value,
+                                             node_map, Nn);
+    });
+});
+
+
 /*! \brief sets up the 1-level tree among the clones of the split-nodes.
   \param[in] gdt_key global dict for assigning consecutive node IDs to nodes across all the
   partitions
@@ -0,0 +1,112 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file array/quantized.cc
+ * \brief Quantized feature tables
+ */
+#include <dgl/array.h>
+#include <dgl/packed_func_ext.h>
+#include <dgl/runtime/registry.h>
+#include "../c_api_common.h"
+#include "./array_op.h"
+
+using namespace dgl::runtime;
+
+namespace dgl {
+namespace aten {
+
+namespace {
+
+void CheckQuantized(const QuantizedArray& array) {
+  CHECK_GE(array.data->ndim, 1) << "The table must have at least one dimension.";
+  const DLDataType dtype = array.data->dtype;
+  if (dtype == DLDataType({kDLFloat, 16, 1}))
+    return;
+  CHECK(dtype == DLDataType({kDLInt, 8, 1})) << "The table must be int8 or float16.";
+  const int64_t num_groups =
+    array.per_row ? array.data->shape[0] : QuantizedRowLength(array);
+  CHECK(!IsNullArray(array.scale) && array.scale->shape[0] == num_groups)
+    << "The table must have a scale for every " << (array.per_row ? "row." : "column.");
+  CHECK(!IsNullArray(array.zero_point) && array.zero_point->shape[0] == num_groups)
+    << "The table must have a zero point for every " << (array.per_row ? "row." : "column.");
+  CHECK(array.scale->ctx == array.data->ctx && array.zero_point->ctx == array.data->ctx)
+    << "The scales and the zero points must be on the device of the table.";
+}
+
+/*! \brief A quantized table from the arguments of a CAPI, starting at args[i]. */
+QuantizedArray QuantizedArrayFromArgs(DGLArgs args, int i) {
+  QuantizedArray ret;
+  ret.data = args[i];
+  ret.scale = args[i + 1];
+  ret.zero_point = args[i + 2];
+  ret.per_row = args[i + 3];
+  if (ret.data->dtype.bits == 16) {
+    ret.scale = NullArray();
+    ret.zero_point = NullArray();
+  }
+  return ret;
+}
+
+}  // namespace
+
+NDArray Dequantize(const QuantizedArray& array) {
+  CHECK_EQ(array.data->ctx.device_type, kDLCPU) << "The table must be on CPU.";
+  return IndexSelectDequantize(array, Range(0, array.data->shape[0], 64, array.data->ctx));
+}
+
+NDArray IndexSelectDequantize(const QuantizedArray& array, IdArray index) {
+  CheckQuantized(array);
+  CHECK_EQ(index->ndim, 1) << "Index array must be an 1D array.";
+  if (array.data->ctx != index->ctx) {
+    CHECK(index->ctx.device_type == kDLGPU && array.data->ctx.device_type == kDLCPU &&
+          array.data.IsPinned() &&
+          (IsNullArray(array.scale) || (array.scale.IsPinned() && array.zero_point.IsPinned())))
+      << "With a GPU index, the table must be on the GPU or in pinned memory.";
+  }
+  NDArray ret;
+  ATEN_XPU_SWITCH_CUDA(index->ctx.device_type, XPU, "IndexSelectDequantize", {
+    ATEN_ID_TYPE_SWITCH(index->dtype, IdType, {
+      if (array.data->dtype.bits == 8)
+        ret = impl::IndexSelectDequantize<XPU, 8, IdType>(array, index);
+      else
+        ret = impl::IndexSelectDequantize<XPU, 16, IdType>(array, index);
+    });
+  });
+  return ret;
+}
+
+DGL_REGISTER_GLOBAL("ndarray.quantized._CAPI_DGLQuantize")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    NDArray array = args[0];
+    DLDataType dtype = args[1];
+    const bool per_row = args[2];
+    const QuantizedArray ret = Quantize(array, dtype, per_row);
+    // the float16 tables have empty scales and zero points
+    const NDArray empty = NDArray::Empty({0}, DLDataType{kDLFloat, 32, 1}, array->ctx);
+    *rv = ConvertNDArrayVectorToPackedFunc({
+        ret.data, IsNullArray(ret.scale) ? empty : ret.scale,
+        IsNullArray(ret.zero_point) ? empty : ret.zero_point});
+  });
+
+DGL_REGISTER_GLOBAL("ndarray.quantized._CAPI_DGLDequantize")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    *rv = Dequantize(QuantizedArrayFromArgs(args, 0));
+  });
+
+DGL_REGISTER_GLOBAL("ndarray.quantized._CAPI_DGLIndexSelectDequantize")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    IdArray index = args[4];
+    *rv = IndexSelectDequantize(QuantizedArrayFromArgs(args, 0), index);
+  });
+
+DGL_REGISTER_GLOBAL("ndarray.quantized._CAPI_DGLSpMMCopyUSumQuantized")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    HeteroGraphRef graph = args[0];
+    NDArray out = args[5];
+    CHECK_EQ(graph->NumEdgeTypes(), 1) << "The graph must have a single edge type.";
+    const QuantizedArray ufeat = QuantizedArrayFromArgs(args, 1);
+    CheckQuantized(ufeat);
+    SpMMCopyUSumQuantized(graph->GetCSCMatrix(0), ufeat, out);
+  });
+
+}  // namespace aten
+}  // namespace dgl
@@ -5,6 +5,7 @@
  */
 #include <dgl/array.h>
 #include <vector>
+#include "./array_op.h"
 
 namespace dgl {
 namespace aten {
@@ -23,6 +24,13 @@ COOMatrix DisjointUnionCoo(const std::vector<COOMatrix>& coos) {
     has_data |= COOHasData(coos[i]);
   }
 
+  // on CPU the matrices are copied in parallel into the result
+  if (coos[0].row->ctx.device_type == kDLCPU) {
+    ATEN_ID_TYPE_SWITCH(coos[0].row->dtype, IdType, {
+      return impl::DisjointUnionCoo<kDLCPU, IdType>(coos);
+    });
+  }
+
   std::vector<IdArray> res_src;
   std::vector<IdArray> res_dst;
   std::vector<IdArray> res_data;
@@ -78,6 +86,12 @@ std::vector<COOMatrix> DisjointPartitionCooBySizes(
   CHECK_EQ(edge_cumsum.size(), batch_size + 1);
   CHECK_EQ(src_vertex_cumsum.size(), batch_size + 1);
   CHECK_EQ(dst_vertex_cumsum.size(), batch_size + 1);
+  if (coo.row->ctx.device_type == kDLCPU) {
+    ATEN_ID_TYPE_SWITCH(coo.row->dtype, IdType, {
+      return impl::DisjointPartitionCooBySizes<kDLCPU, IdType>(
+          coo, batch_size, edge_cumsum, src_vertex_cumsum, dst_vertex_cumsum);
+    });
+  }
   std::vector<COOMatrix> ret;
   ret.resize(batch_size);
 
@@ -153,12 +167,21 @@ CSRMatrix DisjointUnionCsr(const std::vector<CSRMatrix>& csrs) {
   int64_t indices_offset = 0;
   bool has_data = false;
   bool sorted = true;
+  bool wide_indptr = false;
 
   // check if data index array
   for (size_t i = 0; i < csrs.size(); ++i) {
     CHECK_SAME_DTYPE(csrs[0].indptr, csrs[i].indptr);
     CHECK_SAME_CONTEXT(csrs[0].indices, csrs[i].indices);
     has_data |= CSRHasData(csrs[i]);
+    wide_indptr |= CSRHasWideIndptr(csrs[i]);
+  }
+
+  // on CPU the matrices are copied in parallel into the result
+  if (csrs[0].indptr->ctx.device_type == kDLCPU && !wide_indptr) {
+    ATEN_ID_TYPE_SWITCH(csrs[0].indptr->dtype, IdType, {
+      return impl::DisjointUnionCsr<kDLCPU, IdType>(csrs);
+    });
   }
 
   std::vector<IdArray> res_indptr;
@@ -193,8 +216,8 @@ CSRMatrix DisjointUnionCsr(const std::vector<CSRMatrix>& csrs) {
         edges_data = csr.data + indices_offset;
       }
       res_data.push_back(edges_data);
-      indices_offset += csr.indices->shape[0];
     }
+    indices_offset += csr.indices->shape[0];
   }
 
   IdArray result_indptr = Concat(res_indptr);
@@ -218,6 +241,12 @@ std::vector<CSRMatrix> DisjointPartitionCsrBySizes(
   CHECK_EQ(edge_cumsum.size(), batch_size + 1);
   CHECK_EQ(src_vertex_cumsum.size(), batch_size + 1);
   CHECK_EQ(dst_vertex_cumsum.size(), batch_size + 1);
+  if (csr.indptr->ctx.device_type == kDLCPU && !CSRHasWideIndptr(csr)) {
+    ATEN_ID_TYPE_SWITCH(csr.indptr->dtype, IdType, {
+      return impl::DisjointPartitionCsrBySizes<kDLCPU, IdType>(
+          csr, batch_size, edge_cumsum, src_vertex_cumsum, dst_vertex_cumsum);
+    });
+  }
   std::vector<CSRMatrix> ret;
   ret.resize(batch_size);
 
@@ -4,8 +4,11 @@
  * \brief DGL array utilities implementation
  */
 #include <dgl/array.h>
+#include <dgl/runtime/stage_tracker.h>
+#include <algorithm>
 #include <sstream>
 #include "../c_api_common.h"
+#include "./array_op.h"
 #include "./uvm_array_op.h"
 
 using namespace dgl::runtime;
@@ -13,7 +16,7 @@ using namespace dgl::runtime;
 namespace dgl {
 namespace aten {
 
-NDArray IndexSelectCPUFromGPU(NDArray array, IdArray index) {
+NDArray IndexSelectCPUFromGPU(NDArray array, IdArray index, bool sort_index) {
 #ifdef DGL_USE_CUDA
   CHECK_EQ(array->ctx.device_type, kDLCPU) << "Only the CPU device type input "
                                            << "array supported";
@@ -22,8 +25,14 @@ NDArray IndexSelectCPUFromGPU(NDArray array, IdArray index) {
 
   CHECK_GE(array->ndim, 1) << "Only support array with at least 1 dimension";
   CHECK_EQ(index->ndim, 1) << "Index array must be an 1D array.";
+  StageScope stage_scope(SamplingStage::kGather);
+  stage_scope.AddSeeds(index->shape[0]);
+  const int64_t row_bytes = array.GetSize() / std::max<int64_t>(array->shape[0], 1);
+  stage_scope.AddBytes(row_bytes * index->shape[0]);
   ATEN_DTYPE_BITS_ONLY_SWITCH(array->dtype, DType, "values", {
     ATEN_ID_TYPE_SWITCH(index->dtype, IdType, {
+      if (sort_index)
+        return impl::IndexSelectCPUFromGPUSorted<DType, IdType>(array, index);
       return impl::IndexSelectCPUFromGPU<DType, IdType>(array, index);
     });
   });
@@ -33,11 +42,121 @@ NDArray IndexSelectCPUFromGPU(NDArray array, IdArray index) {
   return NDArray{};
 }
 
+void IndexScatterGPUToCPU(NDArray array, IdArray index, NDArray source) {
+#ifdef DGL_USE_CUDA
+  CHECK_EQ(array->ctx.device_type, kDLCPU) << "Only the CPU device type input "
+                                           << "array supported";
+  CHECK_EQ(index->ctx.device_type, kDLGPU) << "Only the GPU device type input "
+                                           << "index supported";
+
+  CHECK_GE(array->ndim, 1) << "Only support array with at least 1 dimension";
+  CHECK_EQ(index->ndim, 1) << "Index array must be an 1D array.";
+  ATEN_DTYPE_BITS_ONLY_SWITCH(array->dtype, DType, "values", {
+    ATEN_ID_TYPE_SWITCH(index->dtype, IdType, {
+      impl::IndexScatterGPUToCPU<DType, IdType>(array, index, source);
+    });
+  });
+  return;
+#endif
+  LOG(FATAL) << "IndexScatterGPUToCPU requires CUDA";
+}
+
+void IndexAddGPUToCPU(NDArray array, IdArray index, NDArray source) {
+#ifdef DGL_USE_CUDA
+  CHECK_EQ(array->ctx.device_type, kDLCPU) << "Only the CPU device type input "
+                                           << "array supported";
+  CHECK_EQ(index->ctx.device_type, kDLGPU) << "Only the GPU device type input "
+                                           << "index supported";
+
+  CHECK_GE(array->ndim, 1) << "Only support array with at least 1 dimension";
+  CHECK_EQ(index->ndim, 1) << "Index array must be an 1D array.";
+  ATEN_FLOAT_TYPE_SWITCH(array->dtype, DType, "values", {
+    ATEN_ID_TYPE_SWITCH(index->dtype, IdType, {
+      impl::IndexAddGPUToCPU<DType, IdType>(array, index, source);
+    });
+  });
+  return;
+#endif
+  LOG(FATAL) << "IndexAddGPUToCPU requires CUDA";
+}
+
+namespace {
+
+// The key of the row pointers cached by CSRCacheIndptr in the plan cache of a matrix.
+constexpr char kCachedIndptrKey[] = "cached_indptr";
+
+struct CachedIndptr {
+  IdArray indptr;
+};
+
+}  // namespace
+
+COOMatrix CSRRowWiseSamplingUniformPinned(
+    CSRMatrix mat, IdArray rows, int64_t num_samples, bool replace) {
+#ifdef DGL_USE_CUDA
+  CHECK_EQ(rows->ctx.device_type, kDLGPU) << "Only the GPU device type rows supported";
+  CHECK(mat.indices.IsPinned() || mat.indices->shape[0] == 0)
+    << "The CSR matrix must be pinned, e.g. by pin_memory_() after creating its formats.";
+  CHECK(!CSRHasWideIndptr(mat))
+    << "The pinned CSR matrices with int64 row pointers and int32 columns are not supported.";
+  CHECK(mat.indptr.IsPinned() || mat.indptr->ctx == rows->ctx)
+    << "The row pointers must be pinned or on the device of the rows.";
+  CHECK(!CSRHasData(mat) || mat.data.IsPinned() || mat.data->shape[0] == 0)
+    << "The edge IDs of the CSR matrix must be pinned.";
+  CHECK_SAME_DTYPE(mat.indices, rows);
+  CHECK_GE(num_samples, 0) << "Sampling all the edges of a pinned CSR matrix is not supported.";
+  COOMatrix ret;
+  ATEN_ID_TYPE_SWITCH(mat.indices->dtype, IdType, {
+    ret = impl::CSRRowWiseSamplingUniform<kDLGPU, IdType>(mat, rows, num_samples, replace);
+  });
+  return ret;
+#endif
+  LOG(FATAL) << "CSRRowWiseSamplingUniformPinned requires CUDA";
+  // Should be unreachable
+  return COOMatrix{};
+}
+
+void CSRCacheIndptr(const CSRMatrix& csr, DLContext ctx, KernelPlanCache* cache) {
+  CHECK_EQ(ctx.device_type, kDLGPU) << "The row pointers can only be cached on a GPU.";
+  CSRUncacheIndptr(cache);
+  cache->GetOrCreate<CachedIndptr>(kCachedIndptrKey, [&csr, &ctx]() {
+    return std::make_shared<CachedIndptr>(CachedIndptr{csr.indptr.CopyTo(ctx)});
+  });
+}
+
+void CSRUncacheIndptr(KernelPlanCache* cache) {
+  cache->Erase(kCachedIndptrKey);
+}
+
+CSRMatrix CSRWithCachedIndptr(CSRMatrix csr, DLContext ctx, const KernelPlanCache* cache) {
+  const auto cached = cache ? cache->Find<CachedIndptr>(kCachedIndptrKey) : nullptr;
+  if (cached && cached->indptr->ctx == ctx)
+    csr.indptr = cached->indptr;
+  return csr;
+}
+
 DGL_REGISTER_GLOBAL("ndarray.uvm._CAPI_DGLIndexSelectCPUFromGPU")
 .set_body([] (DGLArgs args, DGLRetValue* rv) {
     NDArray array = args[0];
     IdArray index = args[1];
-    *rv = IndexSelectCPUFromGPU(array, index);
+    const bool sort_index = args[2];
+    *rv = IndexSelectCPUFromGPU(array, index, sort_index);
+  });
+
+DGL_REGISTER_GLOBAL("ndarray.uvm._CAPI_DGLIndexScatterGPUToCPU")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    NDArray array = args[0];
+    IdArray index = args[1];
+    NDArray source = args[2];
+    IndexScatterGPUToCPU(array, index, source);
+  });
+
+DGL_REGISTER_GLOBAL("ndarray.uvm._CAPI_DGLIndexAddGPUToCPU")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    NDArray array = args[0];
+    IdArray index = args[1];
+    NDArray source = args[2];
+    IndexAddGPUToCPU(array, index, source);
   });
 
 }  // namespace aten
@@ -7,16 +7,49 @@
 #define DGL_ARRAY_UVM_ARRAY_OP_H_
 
 #include <dgl/array.h>
+#include <dgl/aten/kernel_plan.h>
 #include <utility>
 
 namespace dgl {
 namespace aten {
+
+// Take CPU array and GPU index, and then index with GPU, for any types.
+NDArray IndexSelectCPUFromGPU(NDArray array, IdArray index, bool sort_index = false);
+
+// Take a CSR matrix pinned in host memory and GPU rows, and then sample the rows uniformly
+// with GPU, reading the columns over PCIe. The row pointers may be on the GPU instead.
+COOMatrix CSRRowWiseSamplingUniformPinned(
+    CSRMatrix mat, IdArray rows, int64_t num_samples, bool replace);
+
+// Copy the row pointers of a CSR matrix pinned in host memory to the GPU ctx, and keep the
+// copy in the kernel plan cache of the matrix, for CSRWithCachedIndptr.
+void CSRCacheIndptr(const CSRMatrix& csr, DLContext ctx, KernelPlanCache* cache);
+
+// Drop the row pointers cached by CSRCacheIndptr, if any.
+void CSRUncacheIndptr(KernelPlanCache* cache);
+
+// Return the CSR matrix with the row pointers cached on ctx by CSRCacheIndptr, or the matrix
+// itself if they are not cached there.
+CSRMatrix CSRWithCachedIndptr(CSRMatrix csr, DLContext ctx, const KernelPlanCache* cache);
+
 namespace impl {
 
 // Take CPU array and GPU index, and then index with GPU.
 template <typename DType, typename IdType>
 NDArray IndexSelectCPUFromGPU(NDArray array, IdArray index);
 
+// The same, reading the rows in the order of their ids, with a warp per row.
+template <typename DType, typename IdType>
+NDArray IndexSelectCPUFromGPUSorted(NDArray array, IdArray index);
+
+// Take CPU array, GPU index and GPU source, and then write array[index] = source with GPU.
+template <typename DType, typename IdType>
+void IndexScatterGPUToCPU(NDArray array, IdArray index, NDArray source);
+
+// Take CPU array, GPU index and GPU source, and then add source to array[index] with GPU.
+template <typename DType, typename IdType>
+void IndexAddGPUToCPU(NDArray array, IdArray index, NDArray source);
+
 }  // namespace impl
 }  // namespace aten
 }  // namespace dgl
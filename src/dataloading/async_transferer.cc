@@ -10,6 +10,7 @@
 #include <dgl/packed_func_ext.h>
 #include <dgl/runtime/registry.h>
 #include <dgl/runtime/device_api.h>
+#include <dgl/runtime/stage_tracker.h>
 #include <vector>
 #include <utility>
 
@@ -58,6 +59,8 @@ AsyncTransferer::~AsyncTransferer() {
 TransferId AsyncTransferer::StartTransfer(
     NDArray src,
     DGLContext dst_ctx) {
+  StageScope stage_scope(SamplingStage::kCopyTo);
+  stage_scope.AddBytes(src.GetSize());
   const TransferId id = GenerateId();
 
   Transfer t;
@@ -65,10 +68,21 @@ TransferId AsyncTransferer::StartTransfer(
 
   DLDataType dtype = src->dtype;
   std::vector<int64_t> shape(src->shape, src->shape+src->ndim);
-  t.dst = NDArray::Empty(shape, dtype, dst_ctx);
 
   if (stream_) {
     #ifdef DGL_USE_CUDA
+    // the copies from and to pageable memory are staged by CUDA, synchronously
+    // and at a fraction of the bandwidth, so they go through page-locked memory
+    if (dst_ctx.device_type == kDLCPU)
+      t.dst = NDArray::PinnedEmpty(shape, dtype, ctx_);
+    else
+      t.dst = NDArray::Empty(shape, dtype, dst_ctx);
+    if (src->ctx.device_type == kDLCPU && !src.IsPinned()) {
+      // kept until the copy is done
+      t.src = NDArray::PinnedEmpty(shape, dtype, ctx_);
+      t.src.CopyFrom(src);
+    }
+
     // get tensor information
     t.event.reset(new Event);
     CUDA_CALL(cudaEventCreate(&t.event->id));
@@ -80,6 +94,7 @@ TransferId AsyncTransferer::StartTransfer(
     #endif
   } else {
     // copy synchronously since we don't have the notion of streams on the CPU
+    t.dst = NDArray::Empty(shape, dtype, dst_ctx);
     t.event.reset(nullptr);
     t.dst.CopyFrom(t.src);
   }
@@ -0,0 +1,229 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file dataloading/cluster_gcn.cc
+ * \brief The ClusterGCNSampler implementation.
+ */
+
+#include "cluster_gcn.h"
+
+#include <dgl/array.h>
+#include <dgl/packed_func_ext.h>
+#include <dgl/runtime/container.h>
+#include <dgl/runtime/parallel_for.h>
+#include <dgl/runtime/registry.h>
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+#include "../c_api_common.h"
+#include "../graph/unit_graph.h"
+
+namespace dgl {
+
+using namespace runtime;
+
+namespace dataloading {
+
+ClusterGCNSampler::ClusterGCNSampler(
+    HeteroGraphPtr graph, IdArray part_indptr, IdArray part_nodes)
+  : graph_(graph), part_nodes_(part_nodes) {
+  CHECK_EQ(graph_->NumVertexTypes(), 1) << "The graph must be homogeneous.";
+  CHECK_EQ(graph_->NumEdgeTypes(), 1) << "The graph must be homogeneous.";
+  CHECK_EQ(graph_->Context().device_type, kDLCPU) << "The graph must be on CPU.";
+  CHECK_INT64(part_indptr, "part_indptr");
+  CHECK_EQ(part_nodes->dtype.bits, graph_->NumBits())
+    << "The partition nodes must have the ID type of the graph.";
+  part_indptr_ = part_indptr.ToVector<int64_t>();
+  CHECK(!part_indptr_.empty() && part_indptr_.front() == 0)
+    << "The partition offsets must start with 0.";
+  CHECK_EQ(part_indptr_.back(), graph_->NumVertices(0))
+    << "The partitions must hold all the nodes.";
+  CHECK_EQ(part_nodes->shape[0], graph_->NumVertices(0))
+    << "The partitions must hold all the nodes.";
+  ATEN_ID_TYPE_SWITCH(graph_->DataType(), IdType, {
+    Init<IdType>();
+  });
+}
+
+template <typename IdType>
+void ClusterGCNSampler::Init() {
+  const int64_t num_nodes = graph_->NumVertices(0);
+  const int64_t num_parts = NumPartitions();
+  const IdType* nodes = part_nodes_.Ptr<IdType>();
+
+  // the row of every node
+  std::vector<IdType> node_row(num_nodes, -1);
+  parallel_for(0, num_nodes, [&](size_t b, size_t e) {
+    for (auto i = b; i < e; ++i) {
+      CHECK(nodes[i] >= 0 && nodes[i] < num_nodes) << "Invalid node ID " << nodes[i] << ".";
+      node_row[nodes[i]] = i;
+    }
+  });
+  // a node given twice leaves another one without a row
+  parallel_for(0, num_nodes, [&](size_t b, size_t e) {
+    for (auto v = b; v < e; ++v)
+      CHECK_GE(node_row[v], 0) << "The partitions must be a permutation of the nodes.";
+  });
+  row_part_.resize(num_nodes);
+  parallel_for(0, num_parts, [&](size_t b, size_t e) {
+    for (auto p = b; p < e; ++p) {
+      CHECK_LE(part_indptr_[p], part_indptr_[p + 1]) << "The partition offsets must be sorted.";
+      std::fill(row_part_.begin() + part_indptr_[p], row_part_.begin() + part_indptr_[p + 1], p);
+    }
+  });
+
+  const aten::CSRMatrix csr = graph_->GetCSRMatrix(0);
+  const IdType* indptr = csr.indptr.Ptr<IdType>();
+  const IdType* indices = csr.indices.Ptr<IdType>();
+  const IdType* eids = aten::CSRHasData(csr) ? csr.data.Ptr<IdType>() : nullptr;
+  const int64_t num_edges = csr.indices->shape[0];
+  IdArray new_indptr = aten::NewIdArray(num_nodes + 1, csr.indptr->ctx, graph_->NumBits());
+  IdArray new_indices = aten::NewIdArray(num_edges, csr.indptr->ctx, graph_->NumBits());
+  IdArray new_eids = aten::NewIdArray(num_edges, csr.indptr->ctx, graph_->NumBits());
+  IdType* new_indptr_data = new_indptr.Ptr<IdType>();
+  IdType* new_indices_data = new_indices.Ptr<IdType>();
+  IdType* new_eids_data = new_eids.Ptr<IdType>();
+  new_indptr_data[0] = 0;
+  parallel_for(0, num_nodes, [&](size_t b, size_t e) {
+    for (auto i = b; i < e; ++i)
+      new_indptr_data[i + 1] = indptr[nodes[i] + 1] - indptr[nodes[i]];
+  });
+  std::partial_sum(new_indptr_data, new_indptr_data + num_nodes + 1, new_indptr_data);
+
+  parallel_for_weighted(0, num_nodes, new_indptr_data, [&](size_t b, size_t e) {
+    std::vector<std::pair<IdType, IdType>> row;
+    for (auto i = b; i < e; ++i) {
+      const IdType v = nodes[i];
+      row.clear();
+      for (IdType j = indptr[v]; j < indptr[v + 1]; ++j)
+        row.emplace_back(node_row[indices[j]], eids ? eids[j] : j);
+      std::sort(row.begin(), row.end());
+      IdType pos = new_indptr_data[i];
+      for (const auto& entry : row) {
+        new_indices_data[pos] = entry.first;
+        new_eids_data[pos++] = entry.second;
+      }
+    }
+  });
+  csr_ = aten::CSRMatrix(num_nodes, num_nodes, new_indptr, new_indices, new_eids, true);
+}
+
+HeteroSubgraph ClusterGCNSampler::Sample(IdArray parts) const {
+  CHECK_INT64(parts, "parts");
+  std::vector<int64_t> parts_vec = parts.ToVector<int64_t>();
+  std::sort(parts_vec.begin(), parts_vec.end());
+  parts_vec.erase(std::unique(parts_vec.begin(), parts_vec.end()), parts_vec.end());
+  for (const int64_t p : parts_vec)
+    CHECK(p >= 0 && p < NumPartitions()) << "Invalid partition ID " << p << ".";
+  HeteroSubgraph ret;
+  ATEN_ID_TYPE_SWITCH(graph_->DataType(), IdType, {
+    ret = SampleImpl<IdType>(parts_vec);
+  });
+  return ret;
+}
+
+template <typename IdType>
+HeteroSubgraph ClusterGCNSampler::SampleImpl(const std::vector<int64_t>& parts) const {
+  const int64_t num_parts = NumPartitions();
+  const IdType* indptr = csr_.indptr.Ptr<IdType>();
+  const IdType* indices = csr_.indices.Ptr<IdType>();
+  const IdType* eids = csr_.data.Ptr<IdType>();
+  const DLContext ctx = csr_.indptr->ctx;
+  const uint8_t nbits = graph_->NumBits();
+
+  // the first node of every partition in the subgraph, -1 if not in it
+  std::vector<int64_t> part_offset(num_parts, -1);
+  std::vector<int64_t> offsets = {0};
+  for (const int64_t p : parts) {
+    part_offset[p] = offsets.back();
+    offsets.push_back(offsets.back() + part_indptr_[p + 1] - part_indptr_[p]);
+  }
+  const int64_t num_nodes = offsets.back();
+  // the rows of the subgraph, and the node IDs as induced nodes
+  std::vector<IdType> rows(num_nodes);
+  IdArray induced_nodes = aten::NewIdArray(num_nodes, ctx, nbits);
+  IdType* induced_nodes_data = induced_nodes.Ptr<IdType>();
+  const IdType* part_nodes = part_nodes_.Ptr<IdType>();
+  parallel_for(0, parts.size(), [&](size_t b, size_t e) {
+    for (auto k = b; k < e; ++k) {
+      const int64_t start = part_indptr_[parts[k]];
+      std::iota(rows.begin() + offsets[k], rows.begin() + offsets[k + 1], start);
+      std::copy(part_nodes + start, part_nodes + start + offsets[k + 1] - offsets[k],
+                induced_nodes_data + offsets[k]);
+    }
+  });
+
+  // the rows are balanced by their degrees in the graph
+  std::vector<int64_t> cost(num_nodes + 1, 0);
+  for (int64_t i = 0; i < num_nodes; ++i)
+    cost[i + 1] = cost[i] + indptr[rows[i] + 1] - indptr[rows[i]];
+  auto local_id = [&](IdType row) -> int64_t {
+    const int64_t p = row_part_[row];
+    return part_offset[p] < 0 ? -1 : part_offset[p] + row - part_indptr_[p];
+  };
+
+  IdArray sub_indptr = aten::NewIdArray(num_nodes + 1, ctx, nbits);
+  IdType* sub_indptr_data = sub_indptr.Ptr<IdType>();
+  sub_indptr_data[0] = 0;
+  parallel_for_weighted(0, num_nodes, cost.data(), [&](size_t b, size_t e) {
+    for (auto i = b; i < e; ++i) {
+      IdType deg = 0;
+      for (IdType j = indptr[rows[i]]; j < indptr[rows[i] + 1]; ++j)
+        deg += local_id(indices[j]) >= 0;
+      sub_indptr_data[i + 1] = deg;
+    }
+  });
+  std::partial_sum(sub_indptr_data, sub_indptr_data + num_nodes + 1, sub_indptr_data);
+
+  // the columns of a row stay sorted, the partitions being in increasing order
+  const int64_t num_edges = sub_indptr_data[num_nodes];
+  IdArray sub_indices = aten::NewIdArray(num_edges, ctx, nbits);
+  IdArray induced_edges = aten::NewIdArray(num_edges, ctx, nbits);
+  IdType* sub_indices_data = sub_indices.Ptr<IdType>();
+  IdType* induced_edges_data = induced_edges.Ptr<IdType>();
+  parallel_for_weighted(0, num_nodes, cost.data(), [&](size_t b, size_t e) {
+    for (auto i = b; i < e; ++i) {
+      IdType pos = sub_indptr_data[i];
+      for (IdType j = indptr[rows[i]]; j < indptr[rows[i] + 1]; ++j) {
+        const int64_t col = local_id(indices[j]);
+        if (col < 0)
+          continue;
+        sub_indices_data[pos] = col;
+        induced_edges_data[pos++] = eids[j];
+      }
+    }
+  });
+
+  // the edges are numbered in the order of the CSR matrix
+  HeteroSubgraph ret;
+  ret.graph = CreateHeteroGraph(
+      graph_->meta_graph(),
+      {UnitGraph::CreateFromCSR(
+          1, aten::CSRMatrix(num_nodes, num_nodes, sub_indptr, sub_indices,
+                             aten::NullArray(), true))},
+      {num_nodes});
+  ret.induced_vertices = {induced_nodes};
+  ret.induced_edges = {induced_edges};
+  return ret;
+}
+
+DGL_REGISTER_GLOBAL("dataloading.cluster_gcn._CAPI_DGLClusterGCNSamplerCreate")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    HeteroGraphRef hg = args[0];
+    IdArray part_indptr = args[1];
+    IdArray part_nodes = args[2];
+    *rv = ClusterGCNSamplerRef(std::make_shared<ClusterGCNSampler>(
+        hg.sptr(), part_indptr, part_nodes));
+  });
+
+DGL_REGISTER_GLOBAL("dataloading.cluster_gcn._CAPI_DGLClusterGCNSamplerSample")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    ClusterGCNSamplerRef ref = args[0];
+    IdArray parts = args[1];
+    std::shared_ptr<HeteroSubgraph> subg(new HeteroSubgraph);
+    *subg = ref->Sample(parts);
+    *rv = HeteroSubgraphRef(subg);
+  });
+
+}  // namespace dataloading
+}  // namespace dgl
@@ -0,0 +1,86 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file dataloading/cluster_gcn.h
+ * \brief The ClusterGCNSampler class extracting the subgraphs induced by unions of
+ * partitions.
+ */
+
+#ifndef DGL_DATALOADING_CLUSTER_GCN_H_
+#define DGL_DATALOADING_CLUSTER_GCN_H_
+
+#include <dgl/aten/csr.h>
+#include <dgl/base_heterograph.h>
+#include <dgl/runtime/ndarray.h>
+#include <dgl/runtime/object.h>
+#include <cstdint>
+#include <vector>
+
+namespace dgl {
+namespace dataloading {
+
+/*!
+ * \brief A sampler of the subgraphs induced by unions of the partitions of a
+ *        homogeneous graph on CPU, as in Cluster-GCN.
+ *
+ * The out-edges of the graph are renumbered once by partition, so that the nodes
+ * of a partition are a range of rows of a CSR matrix whose columns are sorted.
+ * The subgraph of a union of partitions is then extracted by slicing the ranges
+ * of its rows and keeping the columns in the union, in parallel, without any hash
+ * map of the nodes.
+ */
+class ClusterGCNSampler : public runtime::Object {
+ public:
+  /*!
+   * \brief Constructor.
+   * \param graph The graph, homogeneous and on CPU.
+   * \param part_indptr The offsets of the nodes of every partition in part_nodes,
+   *        an int64 array of the number of partitions plus one.
+   * \param part_nodes The nodes by partition, a permutation of the nodes.
+   */
+  ClusterGCNSampler(HeteroGraphPtr graph, IdArray part_indptr, IdArray part_nodes);
+
+  /*!
+   * \brief The subgraph induced by the nodes of the given partitions.
+   *
+   * The nodes of the subgraph are the ones of the partitions by increasing
+   * partition ID, in the order of part_nodes within a partition.
+   *
+   * \param parts The int64 IDs of the partitions, in any order and possibly repeated.
+   * \return The subgraph with its node and edge IDs.
+   */
+  HeteroSubgraph Sample(IdArray parts) const;
+
+  /*! \brief The number of partitions. */
+  int64_t NumPartitions() const {
+    return part_indptr_.size() - 1;
+  }
+
+  static constexpr const char* _type_key = "dataloading.ClusterGCNSampler";
+  DGL_DECLARE_OBJECT_TYPE_INFO(ClusterGCNSampler, Object);
+
+ private:
+  template <typename IdType>
+  void Init();
+
+  template <typename IdType>
+  HeteroSubgraph SampleImpl(const std::vector<int64_t>& parts) const;
+
+  HeteroGraphPtr graph_;
+  std::vector<int64_t> part_indptr_;
+  /*! \brief The node ID of every row, i.e. part_nodes. */
+  IdArray part_nodes_;
+  /*! \brief The partition of every row. */
+  std::vector<int64_t> row_part_;
+  /*!
+   * \brief The out-edges of the graph between the rows, with sorted columns and the
+   *        edge IDs as data.
+   */
+  aten::CSRMatrix csr_;
+};
+
+DGL_DEFINE_OBJECT_REF(ClusterGCNSamplerRef, ClusterGCNSampler);
+
+}  // namespace dataloading
+}  // namespace dgl
+
+#endif  // DGL_DATALOADING_CLUSTER_GCN_H_
@@ -0,0 +1,302 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file dataloading/graph_saint.cc
+ * \brief The SAINTSampler implementation.
+ */
+
+#include "graph_saint.h"
+
+#include <dgl/array.h>
+#include <dgl/packed_func_ext.h>
+#include <dgl/random.h>
+#include <dgl/runtime/container.h>
+#include <dgl/runtime/parallel_for.h>
+#include <dgl/runtime/registry.h>
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+#include "../c_api_common.h"
+#include "../graph/unit_graph.h"
+
+namespace dgl {
+
+using namespace runtime;
+
+namespace dataloading {
+
+SAINTSampler::SAINTSampler(
+    HeteroGraphPtr graph, const std::string& mode, int64_t budget, int64_t walk_length)
+  : graph_(graph), mode_(mode), budget_(budget), walk_length_(walk_length),
+    node_counts_(graph->NumVertices(0)), edge_counts_(graph->NumEdges(0)) {
+  CHECK(mode_ == "node" || mode_ == "edge" || mode_ == "walk")
+    << "mode can only be \"node\", \"edge\" or \"walk\"";
+  CHECK_EQ(graph_->NumVertexTypes(), 1) << "The graph must be homogeneous.";
+  CHECK_EQ(graph_->NumEdgeTypes(), 1) << "The graph must be homogeneous.";
+  CHECK_EQ(graph_->Context().device_type, kDLCPU) << "The graph must be on CPU.";
+  CHECK_GT(budget_, 0) << "The budget must be positive.";
+  CHECK(mode_ != "walk" || walk_length_ >= 0) << "The walk length cannot be negative.";
+  const int64_t num_nodes = graph_->NumVertices(0);
+  const int64_t num_edges = graph_->NumEdges(0);
+  CHECK_GT(num_nodes, 0) << "The graph has no node.";
+  CHECK(mode_ != "edge" || num_edges > 0) << "The graph has no edge.";
+  csr_ = graph_->GetCSRMatrix(0);
+  for (int64_t v = 0; v < num_nodes; ++v)
+    node_counts_[v] = 0;
+  for (int64_t e = 0; e < num_edges; ++e)
+    edge_counts_[e] = 0;
+  if (mode_ == "walk")
+    return;
+
+  // the in-degrees, at least 1, weigh the nodes and the edges
+  std::vector<int64_t> in_deg;
+  ATEN_ID_TYPE_SWITCH(graph_->DataType(), IdType, {
+    const IdType* indptr = csr_.indptr.Ptr<IdType>();
+    const IdType* indices = csr_.indices.Ptr<IdType>();
+    in_deg.assign(num_nodes, 0);
+    for (int64_t j = 0; j < num_edges; ++j)
+      ++in_deg[indices[j]];
+    if (mode_ == "edge") {
+      edge_src_.resize(num_edges);
+      edge_dst_.resize(num_edges);
+      parallel_for(0, num_nodes, [&](size_t b, size_t e) {
+        for (auto u = b; u < e; ++u) {
+          for (IdType j = indptr[u]; j < indptr[u + 1]; ++j) {
+            edge_src_[j] = u;
+            edge_dst_[j] = indices[j];
+          }
+        }
+      });
+    }
+  });
+  if (mode_ == "node") {
+    cdf_.resize(num_nodes);
+    for (int64_t v = 0; v < num_nodes; ++v)
+      cdf_[v] = (v > 0 ? cdf_[v - 1] : 0.) + std::max<int64_t>(in_deg[v], 1);
+  } else {
+    cdf_.resize(num_edges);
+    for (int64_t j = 0; j < num_edges; ++j) {
+      const double weight = 1. / std::max<int64_t>(in_deg[edge_src_[j]], 1) +
+        1. / std::max<int64_t>(in_deg[edge_dst_[j]], 1);
+      cdf_[j] = (j > 0 ? cdf_[j - 1] : 0.) + weight;
+    }
+  }
+}
+
+int64_t SAINTSampler::Draw(const std::vector<double>& cdf) const {
+  const double x = RandomEngine::ThreadLocal()->Uniform<double>() * cdf.back();
+  const int64_t i = std::upper_bound(cdf.begin(), cdf.end(), x) - cdf.begin();
+  return std::min<int64_t>(i, cdf.size() - 1);
+}
+
+template <typename IdType>
+void SAINTSampler::SampleNodes(std::vector<IdType>* nodes) const {
+  RandomEngine* engine = RandomEngine::ThreadLocal();
+  nodes->clear();
+  if (mode_ == "node") {
+    for (int64_t i = 0; i < budget_; ++i)
+      nodes->push_back(Draw(cdf_));
+  } else if (mode_ == "edge") {
+    for (int64_t i = 0; i < budget_; ++i) {
+      const int64_t j = Draw(cdf_);
+      nodes->push_back(edge_src_[j]);
+      nodes->push_back(edge_dst_[j]);
+    }
+  } else {
+    const IdType* indptr = csr_.indptr.Ptr<IdType>();
+    const IdType* indices = csr_.indices.Ptr<IdType>();
+    const int64_t num_nodes = csr_.num_rows;
+    for (int64_t i = 0; i < budget_; ++i) {
+      IdType v = engine->RandInt<int64_t>(num_nodes);
+      nodes->push_back(v);
+      // a walk stops at a node without out-edges
+      for (int64_t k = 0; k < walk_length_ && indptr[v] < indptr[v + 1]; ++k) {
+        v = indices[indptr[v] + engine->RandInt<int64_t>(indptr[v + 1] - indptr[v])];
+        nodes->push_back(v);
+      }
+    }
+  }
+  std::sort(nodes->begin(), nodes->end());
+  nodes->erase(std::unique(nodes->begin(), nodes->end()), nodes->end());
+}
+
+SAINTSampler::Batch SAINTSampler::Sample(
+    int64_t num_subgraphs, int64_t random_seed, bool count) {
+  CHECK_GE(num_subgraphs, 0) << "The number of subgraphs cannot be negative.";
+  Batch ret;
+  ATEN_ID_TYPE_SWITCH(graph_->DataType(), IdType, {
+    ret = SampleImpl<IdType>(num_subgraphs, random_seed, count);
+  });
+  return ret;
+}
+
+template <typename IdType>
+SAINTSampler::Batch SAINTSampler::SampleImpl(
+    int64_t num_subgraphs, int64_t random_seed, bool count) {
+  const IdType* indptr = csr_.indptr.Ptr<IdType>();
+  const IdType* indices = csr_.indices.Ptr<IdType>();
+  const IdType* eids = aten::CSRHasData(csr_) ? csr_.data.Ptr<IdType>() : nullptr;
+  const RowStreamKey key = random_seed >= 0 ?
+    RowStreamKey::FromSeed(random_seed) : RowStreamKey();
+
+  // every subgraph is induced by its sorted nodes, the columns of a row being
+  // found by binary search
+  std::vector<std::vector<IdType>> sub_nodes(num_subgraphs), sub_indptr(num_subgraphs);
+  std::vector<std::vector<IdType>> sub_indices(num_subgraphs), sub_eids(num_subgraphs);
+  parallel_for(0, num_subgraphs, 1, [&](size_t b, size_t e) {
+    RandomEngine* engine = RandomEngine::ThreadLocal();
+    const RandomEngine saved_engine = *engine;
+    for (auto i = b; i < e; ++i) {
+      if (key.enabled)
+        key.Seed(engine, i);
+      std::vector<IdType>& nodes = sub_nodes[i];
+      SampleNodes<IdType>(&nodes);
+      sub_indptr[i].assign(1, 0);
+      for (const IdType u : nodes) {
+        for (IdType j = indptr[u]; j < indptr[u + 1]; ++j) {
+          const auto it = std::lower_bound(nodes.begin(), nodes.end(), indices[j]);
+          if (it == nodes.end() || *it != indices[j])
+            continue;
+          sub_indices[i].push_back(it - nodes.begin());
+          sub_eids[i].push_back(eids ? eids[j] : j);
+        }
+        sub_indptr[i].push_back(sub_indices[i].size());
+      }
+    }
+    if (key.enabled)
+      *engine = saved_engine;
+  });
+
+  std::vector<int64_t> node_offsets(num_subgraphs + 1, 0), edge_offsets(num_subgraphs + 1, 0);
+  for (int64_t i = 0; i < num_subgraphs; ++i) {
+    node_offsets[i + 1] = node_offsets[i] + sub_nodes[i].size();
+    edge_offsets[i + 1] = edge_offsets[i] + sub_indices[i].size();
+  }
+  const int64_t num_nodes = node_offsets.back();
+  const int64_t num_edges = edge_offsets.back();
+  const DLContext ctx = csr_.indptr->ctx;
+  const uint8_t nbits = graph_->NumBits();
+  IdArray batch_indptr = aten::NewIdArray(num_nodes + 1, ctx, nbits);
+  IdArray batch_indices = aten::NewIdArray(num_edges, ctx, nbits);
+  IdArray induced_nodes = aten::NewIdArray(num_nodes, ctx, nbits);
+  IdArray induced_edges = aten::NewIdArray(num_edges, ctx, nbits);
+  IdType* batch_indptr_data = batch_indptr.Ptr<IdType>();
+  IdType* batch_indices_data = batch_indices.Ptr<IdType>();
+  IdType* induced_nodes_data = induced_nodes.Ptr<IdType>();
+  IdType* induced_edges_data = induced_edges.Ptr<IdType>();
+  batch_indptr_data[num_nodes] = num_edges;
+  // the subgraphs are laid out one after the other, so the CSR matrix of the
+  // batch is block diagonal
+  parallel_for(0, num_subgraphs, 1, [&](size_t b, size_t e) {
+    for (auto i = b; i < e; ++i) {
+      const int64_t n = sub_nodes[i].size();
+      const int64_t m = sub_indices[i].size();
+      for (int64_t k = 0; k < n; ++k)
+        batch_indptr_data[node_offsets[i] + k] = edge_offsets[i] + sub_indptr[i][k];
+      for (int64_t k = 0; k < m; ++k)
+        batch_indices_data[edge_offsets[i] + k] = node_offsets[i] + sub_indices[i][k];
+      std::copy(sub_nodes[i].begin(), sub_nodes[i].end(), induced_nodes_data + node_offsets[i]);
+      std::copy(sub_eids[i].begin(), sub_eids[i].end(), induced_edges_data + edge_offsets[i]);
+      if (count) {
+        for (const IdType v : sub_nodes[i])
+          node_counts_[v].fetch_add(1, std::memory_order_relaxed);
+        for (const IdType eid : sub_eids[i])
+          edge_counts_[eid].fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+  });
+  if (count)
+    num_counted_ += num_subgraphs;
+
+  Batch ret;
+  ret.subgraphs.graph = CreateHeteroGraph(
+      graph_->meta_graph(),
+      {UnitGraph::CreateFromCSR(
+          1, aten::CSRMatrix(num_nodes, num_nodes, batch_indptr, batch_indices,
+                             aten::NullArray(), csr_.sorted))},
+      {num_nodes});
+  ret.subgraphs.induced_vertices = {induced_nodes};
+  ret.subgraphs.induced_edges = {induced_edges};
+  std::vector<int64_t> batch_num_nodes(num_subgraphs), batch_num_edges(num_subgraphs);
+  std::adjacent_difference(node_offsets.begin() + 1, node_offsets.end(), batch_num_nodes.begin());
+  std::adjacent_difference(edge_offsets.begin() + 1, edge_offsets.end(), batch_num_edges.begin());
+  ret.batch_num_nodes = aten::VecToIdArray(batch_num_nodes, 64);
+  ret.batch_num_edges = aten::VecToIdArray(batch_num_edges, 64);
+  return ret;
+}
+
+std::vector<NDArray> SAINTSampler::Normalization() const {
+  const int64_t num_nodes = node_counts_.size();
+  const int64_t num_edges = edge_counts_.size();
+  const DLDataType dtype{kDLFloat, 32, 1};
+  const DLContext ctx{kDLCPU, 0};
+  NDArray loss_norm = NDArray::Empty({num_nodes}, dtype, ctx);
+  NDArray aggr_norm = NDArray::Empty({num_edges}, dtype, ctx);
+  float* loss_norm_data = loss_norm.Ptr<float>();
+  float* aggr_norm_data = aggr_norm.Ptr<float>();
+  const double num_counted = num_counted_;
+  auto node_count = [this] (int64_t v) {
+    return static_cast<double>(std::max<int64_t>(node_counts_[v], 1));
+  };
+  parallel_for(0, num_nodes, [&](size_t b, size_t e) {
+    for (auto v = b; v < e; ++v)
+      loss_norm_data[v] = num_counted / node_count(v) / num_nodes;
+  });
+  ATEN_ID_TYPE_SWITCH(graph_->DataType(), IdType, {
+    const IdType* indptr = csr_.indptr.Ptr<IdType>();
+    const IdType* indices = csr_.indices.Ptr<IdType>();
+    const IdType* eids = aten::CSRHasData(csr_) ? csr_.data.Ptr<IdType>() : nullptr;
+    parallel_for(0, csr_.num_rows, [&](size_t b, size_t e) {
+      for (auto u = b; u < e; ++u) {
+        for (IdType j = indptr[u]; j < indptr[u + 1]; ++j) {
+          const IdType eid = eids ? eids[j] : j;
+          aggr_norm_data[eid] = node_count(indices[j]) /
+            std::max<int64_t>(edge_counts_[eid], 1);
+        }
+      }
+    });
+  });
+  return {loss_norm, aggr_norm};
+}
+
+DGL_REGISTER_GLOBAL("dataloading.graph_saint._CAPI_DGLSAINTSamplerCreate")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    HeteroGraphRef hg = args[0];
+    const std::string mode = args[1];
+    const int64_t budget = args[2];
+    const int64_t walk_length = args[3];
+    *rv = SAINTSamplerRef(std::make_shared<SAINTSampler>(
+        hg.sptr(), mode, budget, walk_length));
+  });
+
+DGL_REGISTER_GLOBAL("dataloading.graph_saint._CAPI_DGLSAINTSamplerSample")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    SAINTSamplerRef ref = args[0];
+    const int64_t num_subgraphs = args[1];
+    const int64_t random_seed = args[2];
+    const bool count = args[3];
+    SAINTSampler::Batch batch = ref->Sample(num_subgraphs, random_seed, count);
+    std::shared_ptr<HeteroSubgraph> subg(new HeteroSubgraph);
+    *subg = std::move(batch.subgraphs);
+
+    List<ObjectRef> ret;
+    ret.push_back(HeteroSubgraphRef(subg));
+    ret.push_back(Value(MakeValue(batch.batch_num_nodes)));
+    ret.push_back(Value(MakeValue(batch.batch_num_edges)));
+    *rv = ret;
+  });
+
+DGL_REGISTER_GLOBAL("dataloading.graph_saint._CAPI_DGLSAINTSamplerNormalization")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    SAINTSamplerRef ref = args[0];
+    *rv = ConvertNDArrayVectorToPackedFunc(ref->Normalization());
+  });
+
+DGL_REGISTER_GLOBAL("dataloading.graph_saint._CAPI_DGLSAINTSamplerNumCounted")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    SAINTSamplerRef ref = args[0];
+    *rv = ref->NumCounted();
+  });
+
+}  // namespace dataloading
+}  // namespace dgl
@@ -0,0 +1,117 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file dataloading/graph_saint.h
+ * \brief The SAINTSampler class sampling the subgraphs of GraphSAINT.
+ */
+
+#ifndef DGL_DATALOADING_GRAPH_SAINT_H_
+#define DGL_DATALOADING_GRAPH_SAINT_H_
+
+#include <dgl/aten/csr.h>
+#include <dgl/base_heterograph.h>
+#include <dgl/runtime/ndarray.h>
+#include <dgl/runtime/object.h>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace dgl {
+namespace dataloading {
+
+/*!
+ * \brief A sampler of the subgraphs of GraphSAINT on a homogeneous graph on CPU.
+ *
+ * A subgraph is induced by the nodes
+ * - of budget draws of nodes with probabilities proportional to their in-degrees
+ *   for the "node" mode,
+ * - of the endpoints of budget draws of edges (u, v) with probabilities proportional
+ *   to 1 / in-degree(u) + 1 / in-degree(v) for the "edge" mode,
+ * - of budget random walks of walk_length steps on the out-edges, from uniformly
+ *   drawn roots, for the "walk" mode.
+ *
+ * The subgraphs of a batch are sampled in parallel, each in a task of its own, and
+ * returned as a single graph whose CSR matrix is block diagonal. The number of
+ * subgraphs every node and edge appeared in may be counted on the fly, for the
+ * normalization coefficients of the loss and of the aggregation.
+ */
+class SAINTSampler : public runtime::Object {
+ public:
+  /*! \brief The subgraphs of a batch. */
+  struct Batch {
+    /*! \brief The subgraphs, with the node and edge IDs of them all. */
+    HeteroSubgraph subgraphs;
+    /*! \brief The int64 numbers of nodes and of edges of every subgraph. */
+    IdArray batch_num_nodes, batch_num_edges;
+  };
+
+  /*!
+   * \brief Constructor.
+   * \param graph The graph, homogeneous and on CPU.
+   * \param mode "node", "edge" or "walk".
+   * \param budget The number of nodes, of edges or of roots drawn for a subgraph.
+   * \param walk_length The number of steps of a walk, for the "walk" mode.
+   */
+  SAINTSampler(HeteroGraphPtr graph, const std::string& mode, int64_t budget,
+               int64_t walk_length);
+
+  /*!
+   * \brief Sample a batch of subgraphs.
+   * \param num_subgraphs The number of subgraphs.
+   * \param random_seed If not negative, the i-th subgraph is sampled from the row stream
+   *        i of random_seed, see RowStreamKey, so that the batch does not depend on
+   *        the number of threads.
+   * \param count If true, the nodes and the edges of the subgraphs are counted.
+   */
+  Batch Sample(int64_t num_subgraphs, int64_t random_seed, bool count);
+
+  /*!
+   * \brief The normalization coefficients of GraphSAINT from the subgraphs counted.
+   *
+   * The loss of the node v is scaled by N / (C_v * |V|) and the edge (u, v) is
+   * aggregated with the weight C_v / C_(u, v), where N is the number of subgraphs
+   * counted and C the number of them a node or an edge appeared in, at least 1.
+   *
+   * \return The float32 coefficients of the nodes and of the edges.
+   */
+  std::vector<runtime::NDArray> Normalization() const;
+
+  /*! \brief The number of subgraphs counted. */
+  int64_t NumCounted() const {
+    return num_counted_;
+  }
+
+  static constexpr const char* _type_key = "dataloading.SAINTSampler";
+  DGL_DECLARE_OBJECT_TYPE_INFO(SAINTSampler, Object);
+
+ private:
+  template <typename IdType>
+  Batch SampleImpl(int64_t num_subgraphs, int64_t random_seed, bool count);
+
+  /*! \brief Draw the nodes of a subgraph, sorted and unique. */
+  template <typename IdType>
+  void SampleNodes(std::vector<IdType>* nodes) const;
+
+  /*! \brief Draw from the cumulative weights, e.g. of the nodes or of the edges. */
+  int64_t Draw(const std::vector<double>& cdf) const;
+
+  HeteroGraphPtr graph_;
+  std::string mode_;
+  int64_t budget_;
+  int64_t walk_length_;
+  aten::CSRMatrix csr_;
+  /*! \brief The endpoints of the edges in CSR order, for the "edge" mode. */
+  std::vector<int64_t> edge_src_, edge_dst_;
+  /*! \brief The cumulative weights of the nodes or of the edges. */
+  std::vector<double> cdf_;
+
+  std::vector<std::atomic<int64_t>> node_counts_, edge_counts_;
+  std::atomic<int64_t> num_counted_{0};
+};
+
+DGL_DEFINE_OBJECT_REF(SAINTSamplerRef, SAINTSampler);
+
+}  // namespace dataloading
+}  // namespace dgl
+
+#endif  // DGL_DATALOADING_GRAPH_SAINT_H_
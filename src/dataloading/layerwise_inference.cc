@@ -0,0 +1,316 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file dataloading/layerwise_inference.cc
+ * \brief The LayerwiseInference implementation.
+ */
+
+#include "layerwise_inference.h"
+
+#include <dgl/array.h>
+#include <dgl/bcast.h>
+#include <dgl/kernel.h>
+#include <dgl/packed_func_ext.h>
+#include <dgl/runtime/container.h>
+#include <dgl/runtime/device_api.h>
+#include <dgl/runtime/parallel_for.h>
+#include <dgl/runtime/registry.h>
+#include <algorithm>
+#include <utility>
+
+#include "../array/cpu/array_row_copy.h"
+#include "../array/uvm_array_op.h"
+#include "../c_api_common.h"
+
+#ifdef DGL_USE_CUDA
+#include <cuda_runtime.h>
+#include "../runtime/cuda/cuda_common.h"
+#endif
+
+namespace dgl {
+
+using namespace runtime;
+
+namespace dataloading {
+
+namespace {
+
+/*! \brief The number of bytes of a row of an array. */
+int64_t RowBytes(const NDArray& array) {
+  int64_t nbytes = (array->dtype.bits * array->dtype.lanes + 7) / 8;
+  for (int i = 1; i < array->ndim; ++i)
+    nbytes *= array->shape[i];
+  return nbytes;
+}
+
+/*! \brief The shape of num_rows rows of an array. */
+std::vector<int64_t> RowsShape(const NDArray& array, int64_t num_rows) {
+  std::vector<int64_t> shape(array->shape, array->shape + array->ndim);
+  shape[0] = num_rows;
+  return shape;
+}
+
+/*!
+ * \brief The sorted unique columns of a CSR matrix, its columns being replaced by
+ *        their positions among them.
+ */
+template <typename IdType>
+IdArray CompactColumns(aten::CSRMatrix* csr) {
+  const int64_t nnz = csr->indices->shape[0];
+  const IdType* indices = csr->indices.Ptr<IdType>();
+  std::vector<IdType> cols(indices, indices + nnz);
+  std::sort(cols.begin(), cols.end());
+  cols.erase(std::unique(cols.begin(), cols.end()), cols.end());
+  IdArray local = aten::NewIdArray(nnz, csr->indices->ctx, sizeof(IdType) * 8);
+  IdType* local_data = local.Ptr<IdType>();
+  parallel_for(0, nnz, [&](size_t b, size_t e) {
+    for (auto j = b; j < e; ++j)
+      local_data[j] = std::lower_bound(cols.begin(), cols.end(), indices[j]) - cols.begin();
+  });
+  csr->indices = local;
+  csr->num_cols = cols.size();
+  return aten::VecToIdArray(cols, sizeof(IdType) * 8);
+}
+
+}  // namespace
+
+LayerwiseInference::LayerwiseInference(
+    HeteroGraphPtr graph, NDArray ufeat, NDArray efeat, const std::string& op,
+    const std::string& reduce, int64_t chunk_size, DLContext ctx, NDArray out,
+    int num_buffers)
+  : ufeat_(ufeat), efeat_(efeat), op_(op), mean_(reduce == "mean"),
+    chunk_size_(chunk_size), ctx_(ctx), out_(out), num_buffers_(num_buffers) {
+  CHECK_EQ(graph->NumVertexTypes(), 1) << "The graph must be homogeneous.";
+  CHECK_EQ(graph->NumEdgeTypes(), 1) << "The graph must be homogeneous.";
+  CHECK_EQ(graph->Context().device_type, kDLCPU) << "The graph must be on CPU.";
+  CHECK(op_ == "copy_lhs" || op_ == "mul") << "op can only be \"copy_lhs\" or \"mul\"";
+  CHECK(reduce == "sum" || (reduce == "mean" && op_ == "copy_lhs"))
+    << "reduce can only be \"sum\", or \"mean\" with \"copy_lhs\"";
+  CHECK_GT(chunk_size_, 0) << "The chunks must have at least one node.";
+  CHECK_GT(num_buffers_, 0) << "At least one chunk must be buffered.";
+  const int64_t num_nodes = graph->NumVertices(0);
+  CHECK_GE(ufeat_->ndim, 1) << "The node features must have a row for every node.";
+  CHECK_EQ(ufeat_->shape[0], num_nodes) << "The node features must have a row for every node.";
+  CHECK(ufeat_->ctx == ctx_ || ufeat_->ctx.device_type == kDLCPU)
+    << "The node features must be on CPU or on the device.";
+  if (op_ == "mul") {
+    CHECK(!aten::IsNullArray(efeat_)) << "The mul operator needs the edge features.";
+    CHECK_EQ(efeat_->shape[0], graph->NumEdges(0))
+      << "The edge features must have a row for every edge.";
+    CHECK(efeat_->ctx == ctx_ || efeat_->ctx.device_type == kDLCPU)
+      << "The edge features must be on CPU or on the device.";
+    const int64_t row_len = RowBytes(ufeat_) * 8 / ufeat_->dtype.bits;
+    CHECK_EQ(CalcBcastOff(op_, ufeat_, efeat_).out_len, row_len)
+      << "The edge features must broadcast to the node features.";
+  }
+  if (!aten::IsNullArray(out_)) {
+    CHECK_EQ(out_->ctx.device_type, kDLCPU) << "The output table must be on CPU.";
+    CHECK_EQ(out_->shape[0], num_nodes) << "The output table must have a row for every node.";
+  }
+  csc_ = graph->GetCSCMatrix(0);
+  if (ctx_.device_type == kDLGPU)
+    stream_ = DeviceAPI::Get(ctx_)->CreateStream(ctx_);
+  worker_ = std::thread(&LayerwiseInference::WorkerLoop, this);
+}
+
+LayerwiseInference::~LayerwiseInference() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cond_.notify_all();
+  worker_.join();
+  if (stream_)
+    DeviceAPI::Get(ctx_)->FreeStream(ctx_, stream_);
+}
+
+void LayerwiseInference::WorkerLoop() {
+  if (stream_) {
+    #ifdef DGL_USE_CUDA
+    DeviceAPI::Get(ctx_)->SetDevice(ctx_);
+    // the kernels of the gathering and of the aggregation run on the stream
+    CUDAThreadEntry::ThreadLocal()->stream = static_cast<cudaStream_t>(stream_);
+    #endif
+  }
+  for (int64_t i = 0; i < NumChunks(); ++i) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cond_.wait(lock, [this] {
+        return stop_ || ready_.size() < static_cast<size_t>(num_buffers_);
+      });
+      if (stop_)
+        return;
+    }
+    Slot slot;
+    try {
+      slot.chunk = Process(i * chunk_size_, std::min((i + 1) * chunk_size_, csc_.num_rows));
+    } catch (...) {
+      slot.error = std::current_exception();
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ready_.push_back(std::move(slot));
+    }
+    cond_.notify_all();
+  }
+}
+
+LayerwiseInference::Chunk LayerwiseInference::Next() {
+  Slot slot;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    CHECK_LT(num_fetched_, NumChunks()) << "All the chunks were fetched.";
+    cond_.wait(lock, [this] { return !ready_.empty(); });
+    slot = std::move(ready_.front());
+    ready_.pop_front();
+    ++num_fetched_;
+  }
+  cond_.notify_all();
+  if (slot.error)
+    std::rethrow_exception(slot.error);
+  return std::move(slot.chunk);
+}
+
+NDArray LayerwiseInference::GatherRows(NDArray table, IdArray index) const {
+  const int64_t len = index->shape[0];
+  const std::vector<int64_t> shape = RowsShape(table, len);
+  NDArray ret = ctx_.device_type == kDLGPU ?
+    NDArray::PinnedEmpty(shape, table->dtype, table->ctx) :
+    NDArray::Empty(shape, table->dtype, table->ctx);
+  ATEN_ID_TYPE_SWITCH(index->dtype, IdType, {
+    aten::impl::CopyRows<IdType>(
+        static_cast<const char*>(table->data), index.Ptr<IdType>(), table->shape[0],
+        static_cast<char*>(ret->data), nullptr, len, len, RowBytes(table));
+  });
+  return ret;
+}
+
+LayerwiseInference::Chunk LayerwiseInference::Process(int64_t start, int64_t end) const {
+  const int64_t len = end - start;
+  const uint8_t nbits = csc_.indptr->dtype.bits;
+  aten::CSRMatrix chunk = aten::CSRSliceRows(csc_, start, end);
+  const int64_t nnz = chunk.indices->shape[0];
+  IdArray eids = chunk.data;
+  if (!aten::CSRHasData(chunk)) {
+    int64_t first;
+    ATEN_ID_TYPE_SWITCH(csc_.indptr->dtype, IdType, {
+      first = csc_.indptr.Ptr<IdType>()[start];
+    });
+    eids = aten::Range(first, first + nnz, nbits, chunk.indptr->ctx);
+  }
+  // the edge IDs are replaced by the positions of the edges in the chunk
+  chunk.data = aten::NullArray();
+
+  NDArray efeat;
+  if (mean_) {
+    // sum the features of the source nodes weighted by 1 / in-degree
+    NDArray weight = NDArray::Empty({nnz, 1}, ufeat_->dtype, chunk.indptr->ctx);
+    ATEN_ID_TYPE_SWITCH(chunk.indptr->dtype, IdType, {
+      ATEN_FLOAT_TYPE_SWITCH(ufeat_->dtype, DType, "Feature data", {
+        const IdType* indptr = chunk.indptr.Ptr<IdType>();
+        DType* weight_data = weight.Ptr<DType>();
+        parallel_for(0, len, [&](size_t b, size_t e) {
+          for (auto i = b; i < e; ++i)
+            std::fill(weight_data + indptr[i], weight_data + indptr[i + 1],
+                      DType(1) / std::max<IdType>(indptr[i + 1] - indptr[i], 1));
+        });
+      });
+    });
+    efeat = weight.CopyTo(ctx_, stream_);
+  } else if (!aten::IsNullArray(efeat_)) {
+    efeat = efeat_->ctx == ctx_ ? aten::IndexSelect(efeat_, eids.CopyTo(ctx_, stream_)) :
+      GatherRows(efeat_, eids).CopyTo(ctx_, stream_);
+  }
+
+  NDArray ufeat;
+  if (ctx_.device_type == kDLCPU) {
+    // the table is read in place, e.g. from the pages of a mapped file
+    ufeat = ufeat_;
+  } else {
+    IdArray src_nodes;
+    ATEN_ID_TYPE_SWITCH(chunk.indptr->dtype, IdType, {
+      src_nodes = CompactColumns<IdType>(&chunk);
+    });
+    if (ufeat_->ctx == ctx_)
+      ufeat = aten::IndexSelect(ufeat_, src_nodes.CopyTo(ctx_, stream_));
+    else if (ufeat_.IsPinned())
+      ufeat = aten::IndexSelectCPUFromGPU(ufeat_, src_nodes.CopyTo(ctx_, stream_));
+    else
+      ufeat = GatherRows(ufeat_, src_nodes).CopyTo(ctx_, stream_);
+    chunk = chunk.CopyTo(ctx_, stream_);
+  }
+
+  Chunk ret;
+  ret.start = start;
+  ret.end = end;
+  const int64_t out_len = RowBytes(ufeat_) * 8 / ufeat_->dtype.bits;
+  ATEN_FLOAT_TYPE_SWITCH(ufeat_->dtype, DType, "Feature data", {
+    ret.aggregated = aten::Full<DType>(0, len * out_len, ctx_).CreateView(
+        RowsShape(ufeat_, len), ufeat_->dtype);
+  });
+  aten::SpMM(mean_ ? "mul" : op_, "sum", chunk, ufeat, efeat, ret.aggregated);
+  NDArray table = ufeat_;
+  NDArray dst_features = table.CreateView(
+      RowsShape(ufeat_, len), ufeat_->dtype, start * RowBytes(ufeat_));
+  ret.dst_features = dst_features->ctx == ctx_ ? dst_features :
+    dst_features.CopyTo(ctx_, stream_);
+  // the pinned sources of the copies are freed once the copies are done
+  if (stream_)
+    DeviceAPI::Get(ctx_)->StreamSync(ctx_, stream_);
+  return ret;
+}
+
+void LayerwiseInference::Store(int64_t start, NDArray value) {
+  CHECK(!aten::IsNullArray(out_)) << "No output table was given.";
+  CHECK(value->dtype == out_->dtype) << "The outputs must have the type of the table.";
+  CHECK_GE(value->ndim, 1) << "The outputs must have a row for every node.";
+  CHECK_EQ(RowBytes(value), RowBytes(out_)) << "The outputs must have the rows of the table.";
+  CHECK(start >= 0 && start + value->shape[0] <= out_->shape[0])
+    << "The nodes are out of the bounds of the output table.";
+  NDArray rows = out_.CreateView(
+      RowsShape(out_, value->shape[0]), out_->dtype, start * RowBytes(out_));
+  rows.CopyFrom(value);
+}
+
+DGL_REGISTER_GLOBAL("dataloading.layerwise_inference._CAPI_DGLLayerwiseInferenceCreate")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    HeteroGraphRef hg = args[0];
+    NDArray ufeat = args[1];
+    NDArray efeat = args[2];
+    const std::string op = args[3];
+    const std::string reduce = args[4];
+    const int64_t chunk_size = args[5];
+    DGLContext ctx = args[6];
+    NDArray out = args[7];
+    const int num_buffers = args[8];
+    *rv = LayerwiseInferenceRef(std::make_shared<LayerwiseInference>(
+        hg.sptr(), ufeat, efeat, op, reduce, chunk_size, ctx, out, num_buffers));
+  });
+
+DGL_REGISTER_GLOBAL("dataloading.layerwise_inference._CAPI_DGLLayerwiseInferenceNumChunks")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    LayerwiseInferenceRef ref = args[0];
+    *rv = ref->NumChunks();
+  });
+
+DGL_REGISTER_GLOBAL("dataloading.layerwise_inference._CAPI_DGLLayerwiseInferenceNext")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    LayerwiseInferenceRef ref = args[0];
+    const LayerwiseInference::Chunk chunk = ref->Next();
+    List<Value> ret;
+    ret.push_back(Value(MakeValue(chunk.start)));
+    ret.push_back(Value(MakeValue(chunk.end)));
+    ret.push_back(Value(MakeValue(chunk.aggregated)));
+    ret.push_back(Value(MakeValue(chunk.dst_features)));
+    *rv = ret;
+  });
+
+DGL_REGISTER_GLOBAL("dataloading.layerwise_inference._CAPI_DGLLayerwiseInferenceStore")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    LayerwiseInferenceRef ref = args[0];
+    const int64_t start = args[1];
+    NDArray value = args[2];
+    ref->Store(start, value);
+  });
+
+}  // namespace dataloading
+}  // namespace dgl
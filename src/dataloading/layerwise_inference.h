@@ -0,0 +1,131 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file dataloading/layerwise_inference.h
+ * \brief The LayerwiseInference class aggregating the features of all the nodes
+ * of a graph chunk by chunk, for the layer-wise inference over the full graph.
+ */
+
+#ifndef DGL_DATALOADING_LAYERWISE_INFERENCE_H_
+#define DGL_DATALOADING_LAYERWISE_INFERENCE_H_
+
+#include <dgl/aten/csr.h>
+#include <dgl/base_heterograph.h>
+#include <dgl/runtime/c_runtime_api.h>
+#include <dgl/runtime/ndarray.h>
+#include <dgl/runtime/object.h>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dgl {
+namespace dataloading {
+
+/*!
+ * \brief A driver of one layer of the inference over all the nodes of a graph,
+ *        by chunks of consecutive destination nodes.
+ *
+ * For every chunk, a thread of its own slices the rows of the chunk from the CSC
+ * matrix of the graph, gathers the features of their source nodes from the feature
+ * table, moves them to the device and aggregates them there with an SpMM. The
+ * next chunks are thus prepared while the current one is computed on, at most
+ * num_buffers of them being ready at once. The outputs of the layer computed from
+ * the chunks are written into a preallocated table, e.g. mapped from a file.
+ *
+ * The feature table may be in host memory, possibly mapped from a file, in pinned
+ * memory, read by UVM from a GPU, or on the device.
+ */
+class LayerwiseInference : public runtime::Object {
+ public:
+  /*! \brief The aggregated features of the destination nodes of a chunk. */
+  struct Chunk {
+    /*! \brief The destination nodes, from start to end excluded. */
+    int64_t start, end;
+    /*! \brief The aggregation of the features of their source nodes, on the device. */
+    runtime::NDArray aggregated;
+    /*! \brief The features of the destination nodes, on the device. */
+    runtime::NDArray dst_features;
+  };
+
+  /*!
+   * \brief Constructor.
+   * \param graph The graph, homogeneous and on CPU.
+   * \param ufeat The feature table of the nodes.
+   * \param efeat The feature of every edge for the `mul` operator, or null.
+   * \param op The binary operator, `copy_lhs` or `mul`.
+   * \param reduce The reduce operator, `sum`, or `mean` with `copy_lhs`.
+   * \param chunk_size The number of destination nodes of a chunk.
+   * \param ctx The device the chunks are computed on.
+   * \param out The table the outputs of the layer are stored into, or null.
+   * \param num_buffers The maximum number of chunks prepared and not fetched.
+   */
+  LayerwiseInference(HeteroGraphPtr graph, runtime::NDArray ufeat, runtime::NDArray efeat,
+                     const std::string& op, const std::string& reduce, int64_t chunk_size,
+                     DLContext ctx, runtime::NDArray out, int num_buffers);
+  ~LayerwiseInference();
+
+  // disable copying
+  LayerwiseInference(const LayerwiseInference&) = delete;
+  LayerwiseInference& operator=(const LayerwiseInference&) = delete;
+
+  /*! \brief The number of chunks. */
+  int64_t NumChunks() const {
+    return (csc_.num_rows + chunk_size_ - 1) / chunk_size_;
+  }
+
+  /*! \brief Wait for the next chunk, the chunks being fetched in order. */
+  Chunk Next();
+
+  /*!
+   * \brief Store the outputs of the layer of consecutive nodes into the output table.
+   * \param start The first node.
+   * \param value The outputs of the nodes, on any device.
+   */
+  void Store(int64_t start, runtime::NDArray value);
+
+  static constexpr const char* _type_key = "dataloading.LayerwiseInference";
+  DGL_DECLARE_OBJECT_TYPE_INFO(LayerwiseInference, Object);
+
+ private:
+  struct Slot {
+    Chunk chunk;
+    std::exception_ptr error;
+  };
+
+  void WorkerLoop();
+
+  /*! \brief Aggregate the features of a chunk, waiting for the work on the device. */
+  Chunk Process(int64_t start, int64_t end) const;
+
+  /*! \brief Gather the rows of a CPU table into pinned memory if the device is a GPU. */
+  runtime::NDArray GatherRows(runtime::NDArray table, IdArray index) const;
+
+  aten::CSRMatrix csc_;
+  runtime::NDArray ufeat_, efeat_;
+  std::string op_;
+  bool mean_;
+  int64_t chunk_size_;
+  DLContext ctx_;
+  runtime::NDArray out_;
+  int num_buffers_;
+  /*! \brief The stream of the worker if the device is a GPU. */
+  DGLStreamHandle stream_{nullptr};
+
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  /*! \brief The chunks prepared and not fetched, in order. */
+  std::deque<Slot> ready_;
+  int64_t num_fetched_{0};
+  bool stop_{false};
+  std::thread worker_;
+};
+
+DGL_DEFINE_OBJECT_REF(LayerwiseInferenceRef, LayerwiseInference);
+
+}  // namespace dataloading
+}  // namespace dgl
+
+#endif  // DGL_DATALOADING_LAYERWISE_INFERENCE_H_
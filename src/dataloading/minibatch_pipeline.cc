@@ -0,0 +1,320 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file dataloading/minibatch_pipeline.cc
+ * \brief The MinibatchPipeline implementation.
+ */
+
+#include "minibatch_pipeline.h"
+
+#include <dgl/array.h>
+#include <dgl/packed_func_ext.h>
+#include <dgl/random.h>
+#include <dgl/runtime/container.h>
+#include <dgl/runtime/device_api.h>
+#include <dgl/runtime/parallel_for.h>
+#include <dgl/runtime/registry.h>
+#include <dgl/runtime/stage_tracker.h>
+#include <algorithm>
+#include <cstring>
+#include <tuple>
+#include <utility>
+
+#include "../array/uvm_array_op.h"
+#include "../c_api_common.h"
+#include "../graph/transform/to_bipartite.h"
+
+#ifdef DGL_USE_CUDA
+#include <cuda_runtime.h>
+#include "../runtime/cuda/cuda_common.h"
+#endif
+
+namespace dgl {
+
+using namespace runtime;
+
+namespace dataloading {
+
+namespace {
+
+/*! \brief Gather the rows of a CPU array of any rank. */
+NDArray GatherRowsCPU(NDArray array, IdArray index) {
+  const int64_t len = index->shape[0];
+  std::vector<int64_t> shape(array->shape, array->shape + array->ndim);
+  shape[0] = len;
+  NDArray ret = NDArray::Empty(shape, array->dtype, array->ctx);
+  const int64_t row_bytes = array.GetSize() / std::max<int64_t>(array->shape[0], 1);
+  const char* src = static_cast<const char*>(array->data);
+  char* dst = static_cast<char*>(ret->data);
+  ATEN_ID_TYPE_SWITCH(index->dtype, IdType, {
+    const IdType* idx = index.Ptr<IdType>();
+    parallel_for(0, len, [&](size_t b, size_t e) {
+      for (size_t i = b; i < e; ++i) {
+        CHECK(idx[i] >= 0 && idx[i] < array->shape[0]) << "Index out of range.";
+        std::memcpy(dst + i * row_bytes, src + idx[i] * row_bytes, row_bytes);
+      }
+    });
+  });
+  return ret;
+}
+
+}  // namespace
+
+struct MinibatchPipeline::Event {
+  #ifdef DGL_USE_CUDA
+  cudaEvent_t id;
+
+  Event() {
+    CUDA_CALL(cudaEventCreateWithFlags(&id, cudaEventDisableTiming));
+  }
+
+  ~Event() {
+    CUDA_CALL(cudaEventDestroy(id));
+  }
+  #endif
+};
+
+MinibatchPipeline::MinibatchPipeline(
+    HeteroGraphPtr graph, std::vector<std::vector<int64_t>> fanouts, bool replace,
+    std::vector<NDArray> features, int num_buffers, int num_workers, int64_t random_seed)
+  : graph_(graph), fanouts_(std::move(fanouts)), replace_(replace),
+    features_(std::move(features)), num_buffers_(num_buffers), random_seed_(random_seed) {
+  CHECK_GT(num_buffers, 0) << "The pipeline must have at least one buffer.";
+  CHECK_GT(num_workers, 0) << "The pipeline must have at least one worker.";
+  CHECK_EQ(features_.size(), graph_->NumVertexTypes())
+    << "Number of feature tensors must match the number of node types.";
+  for (const auto& fanout : fanouts_) {
+    CHECK_EQ(fanout.size(), graph_->NumEdgeTypes())
+      << "Number of fanout values must match the number of edge types.";
+  }
+  const DLContext ctx = graph_->Context();
+  for (const NDArray& feat : features_) {
+    if (aten::IsNullArray(feat) || feat->ctx == ctx)
+      continue;
+    CHECK(feat->ctx.device_type == kDLCPU && feat.IsPinned())
+      << "The features must be on the device of the graph, or in pinned memory.";
+  }
+  // a worker has nothing to do while the batches it could start are buffered
+  num_workers = std::min(num_workers, num_buffers);
+  if (ctx.device_type == kDLGPU) {
+    for (int i = 0; i < num_workers; ++i)
+      streams_.push_back(DeviceAPI::Get(ctx)->CreateStream(ctx));
+  }
+  for (int i = 0; i < num_workers; ++i)
+    workers_.emplace_back(&MinibatchPipeline::WorkerLoop, this, i);
+}
+
+MinibatchPipeline::~MinibatchPipeline() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cond_.notify_all();
+  for (std::thread& worker : workers_)
+    worker.join();
+  const DLContext ctx = graph_->Context();
+  for (DGLStreamHandle stream : streams_) {
+    DeviceAPI::Get(ctx)->StreamSync(ctx, stream);
+    DeviceAPI::Get(ctx)->FreeStream(ctx, stream);
+  }
+}
+
+void MinibatchPipeline::Submit(std::vector<IdArray> seeds) {
+  CHECK_EQ(seeds.size(), graph_->NumVertexTypes())
+    << "Number of node ID tensors must match the number of node types.";
+  std::unique_ptr<Batch> batch(new Batch);
+  batch->seeds = std::move(seeds);
+  if (!streams_.empty())
+    batch->done.reset(new Event);
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this] {
+      return batches_.size() < static_cast<size_t>(num_buffers_);
+    });
+    batch->index = num_submitted_++;
+    batches_.push_back(std::move(batch));
+  }
+  cond_.notify_all();
+}
+
+MinibatchPipeline::Minibatch MinibatchPipeline::Fetch() {
+  std::unique_ptr<Batch> batch;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    CHECK(!batches_.empty()) << "No batch submitted to the pipeline.";
+    cond_.wait(lock, [this] { return batches_.front()->finished; });
+    batch = std::move(batches_.front());
+    batches_.pop_front();
+    --num_started_;
+  }
+  cond_.notify_all();
+  if (batch->error)
+    std::rethrow_exception(batch->error);
+  if (batch->done) {
+    #ifdef DGL_USE_CUDA
+    CUDA_CALL(cudaStreamWaitEvent(CUDAThreadEntry::ThreadLocal()->stream, batch->done->id, 0));
+    #endif
+  }
+  return std::move(batch->result);
+}
+
+void MinibatchPipeline::WorkerLoop(int worker) {
+  const DGLStreamHandle stream = streams_.empty() ? nullptr : streams_[worker];
+  if (stream) {
+    #ifdef DGL_USE_CUDA
+    const DLContext ctx = graph_->Context();
+    DeviceAPI::Get(ctx)->SetDevice(ctx);
+    // the kernels of the sampling and of the gathering run on the stream
+    CUDAThreadEntry::ThreadLocal()->stream = static_cast<cudaStream_t>(stream);
+    #endif
+  }
+  for (;;) {
+    Batch* batch;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cond_.wait(lock, [this] { return stop_ || num_started_ < batches_.size(); });
+      if (stop_)
+        return;
+      // not fetched before it is finished
+      batch = batches_[num_started_++].get();
+    }
+    try {
+      batch->result = Process(batch->seeds, batch->index);
+    } catch (...) {
+      batch->error = std::current_exception();
+    }
+    if (batch->done) {
+      #ifdef DGL_USE_CUDA
+      CUDA_CALL(cudaEventRecord(batch->done->id, static_cast<cudaStream_t>(stream)));
+      #endif
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      batch->finished = true;
+    }
+    cond_.notify_all();
+  }
+}
+
+MinibatchPipeline::Minibatch MinibatchPipeline::Process(
+    const std::vector<IdArray>& output_nodes, int64_t index) const {
+  const int64_t num_layers = fanouts_.size();
+  const DLContext ctx = graph_->Context();
+  const std::vector<FloatArray> prob(graph_->NumEdgeTypes(), aten::NullArray());
+  const RowStreamKey row_streams = random_seed_ >= 0 ?
+    RowStreamKey::FromSeed(random_seed_).Derive(index) : RowStreamKey();
+  // the stages of the batch are traced under its index
+  StageBatchScope batch_scope(index);
+
+  Minibatch ret;
+  sampling::SampledBlocks& sampled = ret.blocks;
+  sampled.blocks.resize(num_layers);
+  sampled.src_nodes.resize(num_layers);
+  sampled.induced_edges.resize(num_layers);
+  std::vector<IdArray> seeds = output_nodes;
+  for (int64_t layer = num_layers - 1; layer >= 0; --layer) {
+    RowStreamScope row_stream_scope(row_streams.Derive(layer));
+    const HeteroSubgraph frontier = sampling::SampleNeighbors(
+        graph_, seeds, fanouts_[layer], EdgeDir::kIn, prob, {}, replace_);
+    HeteroGraphPtr block;
+    std::vector<IdArray> induced_edges;
+    std::vector<IdArray> src_nodes;
+    ATEN_XPU_SWITCH_CUDA(ctx.device_type, XPU, "MinibatchPipeline", {
+      ATEN_ID_TYPE_SWITCH(graph_->DataType(), IdType, {
+        std::tie(block, induced_edges) = transform::ToBlock<XPU, IdType>(
+            frontier.graph, seeds, true, &src_nodes);
+      });
+    });
+    // the edges of the frontier to the ones of the graph
+    for (size_t etype = 0; etype < induced_edges.size(); ++etype) {
+      if (induced_edges[etype]->shape[0] > 0)
+        induced_edges[etype] = aten::IndexSelect(
+            frontier.induced_edges[etype], induced_edges[etype]);
+    }
+    sampled.blocks[layer] = block;
+    sampled.induced_edges[layer] = std::move(induced_edges);
+    sampled.src_nodes[layer] = src_nodes;
+    seeds = std::move(src_nodes);
+  }
+
+  // seeds are the input nodes by now
+  ret.features.resize(features_.size());
+  for (size_t ntype = 0; ntype < features_.size(); ++ntype) {
+    const NDArray& feat = features_[ntype];
+    if (aten::IsNullArray(feat))
+      continue;
+    if (feat->ctx.device_type != ctx.device_type) {
+      // counted as a gather by IndexSelectCPUFromGPU
+      ret.features[ntype] = aten::IndexSelectCPUFromGPU(feat, seeds[ntype]);
+      continue;
+    }
+    StageScope stage_scope(SamplingStage::kGather);
+    stage_scope.AddSeeds(seeds[ntype]->shape[0]);
+    if (ctx.device_type == kDLCPU)
+      ret.features[ntype] = GatherRowsCPU(feat, seeds[ntype]);
+    else
+      ret.features[ntype] = aten::IndexSelect(feat, seeds[ntype]);
+    stage_scope.AddBytes(ret.features[ntype].GetSize());
+  }
+  return ret;
+}
+
+DGL_REGISTER_GLOBAL("dataloading.minibatch_pipeline._CAPI_DGLMinibatchPipelineCreate")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    HeteroGraphRef hg = args[0];
+    const auto& fanout_arrays = ListValueToVector<IdArray>(args[1]);
+    const bool replace = args[2];
+    const auto& features = ListValueToVector<NDArray>(args[3]);
+    const int num_buffers = args[4];
+    const int num_workers = args[5];
+    const int64_t random_seed = args[6];
+
+    std::vector<std::vector<int64_t>> fanouts;
+    for (const IdArray& fanout : fanout_arrays) {
+      CHECK_INT64(fanout, "fanout");
+      fanouts.push_back(fanout.ToVector<int64_t>());
+    }
+    *rv = MinibatchPipelineRef(std::make_shared<MinibatchPipeline>(
+        hg.sptr(), std::move(fanouts), replace, features, num_buffers, num_workers,
+        random_seed));
+  });
+
+DGL_REGISTER_GLOBAL("dataloading.minibatch_pipeline._CAPI_DGLMinibatchPipelineSubmit")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    MinibatchPipelineRef ref = args[0];
+    ref->Submit(ListValueToVector<IdArray>(args[1]));
+  });
+
+DGL_REGISTER_GLOBAL("dataloading.minibatch_pipeline._CAPI_DGLMinibatchPipelineFetch")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    MinibatchPipelineRef ref = args[0];
+    const MinibatchPipeline::Minibatch batch = ref->Fetch();
+    const sampling::SampledBlocks& sampled = batch.blocks;
+
+    List<HeteroGraphRef> blocks_ref;
+    List<ObjectRef> src_nodes_ref, induced_edges_ref;
+    for (size_t layer = 0; layer < sampled.blocks.size(); ++layer) {
+      blocks_ref.push_back(HeteroGraphRef(sampled.blocks[layer]));
+      List<Value> src_nodes;
+      for (const IdArray& array : sampled.src_nodes[layer])
+        src_nodes.push_back(Value(MakeValue(array)));
+      src_nodes_ref.push_back(src_nodes);
+      List<Value> induced_edges;
+      for (const IdArray& array : sampled.induced_edges[layer])
+        induced_edges.push_back(Value(MakeValue(array)));
+      induced_edges_ref.push_back(induced_edges);
+    }
+    // the node types without features get empty arrays
+    List<Value> features_ref;
+    for (const NDArray& feat : batch.features)
+      features_ref.push_back(Value(MakeValue(feat.defined() ? feat : aten::NullArray())));
+
+    List<ObjectRef> ret;
+    ret.push_back(blocks_ref);
+    ret.push_back(src_nodes_ref);
+    ret.push_back(induced_edges_ref);
+    ret.push_back(features_ref);
+    *rv = ret;
+  });
+
+}  // namespace dataloading
+}  // namespace dgl
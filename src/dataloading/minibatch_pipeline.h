@@ -0,0 +1,131 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file dataloading/minibatch_pipeline.h
+ * \brief The MinibatchPipeline class for sampling the blocks and gathering the
+ * input features of the next minibatches in the background.
+ */
+
+#ifndef DGL_DATALOADING_MINIBATCH_PIPELINE_H_
+#define DGL_DATALOADING_MINIBATCH_PIPELINE_H_
+
+#include <dgl/base_heterograph.h>
+#include <dgl/runtime/c_runtime_api.h>
+#include <dgl/runtime/ndarray.h>
+#include <dgl/runtime/object.h>
+#include <dgl/sampling/neighbor.h>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dgl {
+namespace dataloading {
+
+/*!
+ * \brief A stage running, for a batch of seeds, the neighbor sampling of every
+ *        layer, the construction of the blocks and the gathering of the
+ *        features of the input nodes, back to back.
+ *
+ * The work of the batches submitted runs on the persistent worker threads of
+ * the pipeline, each with a stream of its own if the graph is on a GPU, so the
+ * host synchronizations sizing the outputs of the sampling and of the blocks
+ * do not stall the training. The workers take the batches in order and the
+ * batches are fetched in order. At most num_buffers batches are in the
+ * pipeline, e.g. with 2, the batch i + 1 is sampled while the batch i is
+ * trained on.
+ *
+ * The blocks and the features are created in the process of the trainer, so
+ * they are handed over without any copy, serialization or shared memory.
+ *
+ * The features of a node type are gathered by UVM when they are in pinned
+ * host memory and the graph is on a GPU.
+ */
+class MinibatchPipeline : public runtime::Object {
+ public:
+  /*! \brief The blocks of a batch, and the features of the input nodes by node type. */
+  struct Minibatch {
+    sampling::SampledBlocks blocks;
+    std::vector<runtime::NDArray> features;
+  };
+
+  /*!
+   * \brief Constructor.
+   * \param graph The graph, on the CPU or a GPU.
+   * \param fanouts Number of sampled neighbors for each edge type, for every layer
+   *                from the first to the last.
+   * \param replace If true, sample with replacement.
+   * \param features The features of every node type, empty if none.
+   * \param num_buffers The maximum number of batches in the pipeline.
+   * \param num_workers The number of batches worked on at the same time.
+   * \param random_seed If not negative, the i-th batch submitted is sampled from the
+   *        row streams of random_seed and i, see RowStreamKey, so that the result does
+   *        not depend on the number of threads or of workers.
+   */
+  MinibatchPipeline(HeteroGraphPtr graph, std::vector<std::vector<int64_t>> fanouts,
+                    bool replace, std::vector<runtime::NDArray> features, int num_buffers,
+                    int num_workers = 1, int64_t random_seed = -1);
+  ~MinibatchPipeline();
+
+  // disable copying
+  MinibatchPipeline(const MinibatchPipeline&) = delete;
+  MinibatchPipeline& operator=(const MinibatchPipeline&) = delete;
+
+  /*!
+   * \brief Submit a batch of output nodes of every node type, waiting while the
+   *        pipeline is full.
+   */
+  void Submit(std::vector<IdArray> seeds);
+
+  /*!
+   * \brief Wait for the oldest batch submitted. On a GPU, the stream of the
+   *        calling thread then waits for the work of the batch, the host does not.
+   */
+  Minibatch Fetch();
+
+  static constexpr const char* _type_key = "ndarray.MinibatchPipeline";
+  DGL_DECLARE_OBJECT_TYPE_INFO(MinibatchPipeline, Object);
+
+ private:
+  struct Event;
+  struct Batch {
+    int64_t index;
+    std::vector<IdArray> seeds;
+    Minibatch result;
+    std::unique_ptr<Event> done;
+    std::exception_ptr error;
+    bool finished{false};
+  };
+
+  void WorkerLoop(int worker);
+
+  /*! \brief Sample the blocks of the seeds and gather the features of their inputs. */
+  Minibatch Process(const std::vector<IdArray>& seeds, int64_t index) const;
+
+  HeteroGraphPtr graph_;
+  std::vector<std::vector<int64_t>> fanouts_;
+  bool replace_;
+  std::vector<runtime::NDArray> features_;
+  int num_buffers_;
+  int64_t random_seed_;
+  /*! \brief The stream of every worker if the graph is on a GPU. */
+  std::vector<DGLStreamHandle> streams_;
+
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  /*! \brief The batches submitted and not fetched, the first ones taken by a worker. */
+  std::deque<std::unique_ptr<Batch>> batches_;
+  size_t num_started_{0};
+  int64_t num_submitted_{0};
+  bool stop_{false};
+  std::vector<std::thread> workers_;
+};
+
+DGL_DEFINE_OBJECT_REF(MinibatchPipelineRef, MinibatchPipeline);
+
+}  // namespace dataloading
+}  // namespace dgl
+
+#endif  // DGL_DATALOADING_MINIBATCH_PIPELINE_H_
@@ -0,0 +1,184 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file dataloading/prefetch_queue.cc
+ * \brief The PrefetchQueue implementation.
+ */
+
+#include "prefetch_queue.h"
+
+#include <dgl/packed_func_ext.h>
+#include <dgl/runtime/container.h>
+#include <dgl/runtime/registry.h>
+#include <dgl/runtime/device_api.h>
+#include <utility>
+
+#ifdef DGL_USE_CUDA
+#include <cuda_runtime.h>
+#include "../runtime/cuda/cuda_common.h"
+#endif
+
+namespace dgl {
+
+using namespace runtime;
+
+namespace dataloading {
+
+struct PrefetchQueue::Event {
+  #ifdef DGL_USE_CUDA
+  cudaEvent_t id;
+
+  Event() {
+    CUDA_CALL(cudaEventCreateWithFlags(&id, cudaEventDisableTiming));
+  }
+
+  ~Event() {
+    CUDA_CALL(cudaEventDestroy(id));
+  }
+  #endif
+};
+
+PrefetchQueue::PrefetchQueue(DGLContext ctx, int num_slots, int num_streams)
+  : ctx_(ctx), slots_(num_slots) {
+  CHECK_GT(num_slots, 0) << "The prefetch queue must have at least one slot.";
+  CHECK_GT(num_streams, 0) << "The prefetch queue must have at least one stream.";
+  if (ctx_.device_type == kDLGPU) {
+    #ifdef DGL_USE_CUDA
+    for (int i = 0; i < num_streams; ++i)
+      streams_.push_back(DeviceAPI::Get(ctx_)->CreateStream(ctx_));
+    for (Slot& slot : slots_) {
+      slot.done.reset(new Event);
+      slot.released.reset(new Event);
+    }
+    #else
+    LOG(FATAL) << "GPU support not compiled.";
+    #endif
+  }
+}
+
+PrefetchQueue::~PrefetchQueue() {
+  // the buffers are freed once the copies into them are done
+  for (DGLStreamHandle stream : streams_) {
+    DeviceAPI::Get(ctx_)->StreamSync(ctx_, stream);
+    DeviceAPI::Get(ctx_)->FreeStream(ctx_, stream);
+  }
+}
+
+NDArray PrefetchQueue::GetBuffer(std::vector<NDArray>* pool, size_t i,
+                                 const std::vector<int64_t>& shape, DLDataType dtype,
+                                 DGLContext ctx, bool pinned, bool* reused) {
+  int64_t nbytes = (dtype.bits * dtype.lanes + 7) / 8;
+  for (int64_t dim : shape)
+    nbytes *= dim;
+  if (pool->size() <= i)
+    pool->resize(i + 1);
+  NDArray& buffer = (*pool)[i];
+  // referenced only by the pool, i.e. the arrays viewing it are gone
+  *reused = buffer.use_count() == 1 && buffer->shape[0] >= nbytes;
+  if (!*reused) {
+    // with some headroom, for the minibatches of varying sizes
+    const std::vector<int64_t> size = {nbytes + nbytes / 4};
+    const DLDataType bytes = DLDataType{kDLUInt, 8, 1};
+    buffer = pinned ? NDArray::PinnedEmpty(size, bytes, ctx) : NDArray::Empty(size, bytes, ctx);
+  }
+  return buffer.CreateView(shape, dtype);
+}
+
+void PrefetchQueue::Enqueue(const std::vector<NDArray>& arrays) {
+  CHECK_LT(size_, Capacity()) << "The prefetch queue is full.";
+  Slot& slot = slots_[(head_ + size_) % Capacity()];
+  slot.src = arrays;
+  slot.dst.clear();
+  ++size_;
+
+  if (ctx_.device_type != kDLGPU) {
+    // copy synchronously since we don't have the notion of streams on the CPU
+    for (const NDArray& array : arrays)
+      slot.dst.push_back(array->ctx == ctx_ ? array : array.CopyTo(ctx_));
+    return;
+  }
+
+  #ifdef DGL_USE_CUDA
+  DGLStreamHandle stream = streams_[next_stream_];
+  next_stream_ = (next_stream_ + 1) % streams_.size();
+  // the work on the recycled buffers is queued on this stream by now
+  CUDA_CALL(cudaEventRecord(slot.released->id, CUDAThreadEntry::ThreadLocal()->stream));
+  bool waited = false;
+  for (size_t i = 0; i < arrays.size(); ++i) {
+    const NDArray& array = arrays[i];
+    if (array->ctx == ctx_) {
+      slot.dst.push_back(array);
+      continue;
+    }
+    const std::vector<int64_t> shape(array->shape, array->shape + array->ndim);
+    bool reused;
+    NDArray dst = GetBuffer(&slot.buffers, i, shape, array->dtype, ctx_, false, &reused);
+    if (reused && !waited) {
+      CUDA_CALL(cudaStreamWaitEvent(static_cast<cudaStream_t>(stream), slot.released->id, 0));
+      waited = true;
+    }
+    if (array->ctx.device_type == kDLCPU && !array.IsPinned()) {
+      // the copies from pageable memory are staged by CUDA, synchronously, so
+      // they go through page-locked memory, free since the slot was dequeued
+      bool staged;
+      slot.src[i] = GetBuffer(&slot.staging, i, shape, array->dtype, array->ctx, true, &staged);
+      slot.src[i].CopyFrom(array);
+    }
+    dst.CopyFrom(slot.src[i], stream);
+    slot.dst.push_back(dst);
+  }
+  CUDA_CALL(cudaEventRecord(slot.done->id, static_cast<cudaStream_t>(stream)));
+  #endif
+}
+
+std::vector<NDArray> PrefetchQueue::Dequeue() {
+  CHECK_GT(size_, 0) << "The prefetch queue is empty.";
+  Slot& slot = slots_[head_];
+  if (slot.done) {
+    #ifdef DGL_USE_CUDA
+    // wait for it
+    CUDA_CALL(cudaEventSynchronize(slot.done->id));
+    #endif
+  }
+  std::vector<NDArray> ret = std::move(slot.dst);
+  slot.dst.clear();
+  slot.src.clear();
+  head_ = (head_ + 1) % Capacity();
+  --size_;
+  return ret;
+}
+
+DGL_REGISTER_GLOBAL("dataloading.async_transferer._CAPI_DGLPrefetchQueueCreate")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    DGLContext ctx = args[0];
+    const int num_slots = args[1];
+    const int num_streams = args[2];
+    *rv = PrefetchQueueRef(std::make_shared<PrefetchQueue>(ctx, num_slots, num_streams));
+});
+
+DGL_REGISTER_GLOBAL("dataloading.async_transferer._CAPI_DGLPrefetchQueueEnqueue")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+  PrefetchQueueRef ref = args[0];
+  const List<Value> arrays = args[1];
+  std::vector<NDArray> vec;
+  for (const Value& array : arrays)
+    vec.push_back(array->data);
+  ref->Enqueue(vec);
+});
+
+DGL_REGISTER_GLOBAL("dataloading.async_transferer._CAPI_DGLPrefetchQueueDequeue")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+  PrefetchQueueRef ref = args[0];
+  List<Value> ret;
+  for (const NDArray& array : ref->Dequeue())
+    ret.push_back(Value(MakeValue(array)));
+  *rv = ret;
+});
+
+DGL_REGISTER_GLOBAL("dataloading.async_transferer._CAPI_DGLPrefetchQueueSize")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+  PrefetchQueueRef ref = args[0];
+  *rv = ref->Size();
+});
+
+}  // namespace dataloading
+}  // namespace dgl
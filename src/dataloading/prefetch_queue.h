@@ -0,0 +1,100 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file dataloading/prefetch_queue.h
+ * \brief The PrefetchQueue class for copying the next minibatches to the GPU
+ * ahead of time, on several streams and into recycled buffers.
+ */
+
+#ifndef DGL_DATALOADING_PREFETCH_QUEUE_H_
+#define DGL_DATALOADING_PREFETCH_QUEUE_H_
+
+#include <dgl/runtime/c_runtime_api.h>
+#include <dgl/runtime/ndarray.h>
+#include <dgl/runtime/object.h>
+#include <memory>
+#include <vector>
+
+namespace dgl {
+namespace dataloading {
+
+/*!
+ * \brief A first-in first-out queue of transfers to a device, each of a list
+ *        of arrays, e.g. the arrays of the blocks, the features and the labels
+ *        of a minibatch.
+ *
+ * The queue has a fixed number of slots, each with its own event and device
+ * buffers. A buffer is reused by the next transfer of its slot once the array
+ * returned from it is no longer referenced; the copy into it then waits for
+ * the work queued on the stream of the calling thread until then. The
+ * transfers go round-robin over a number of copy streams.
+ */
+class PrefetchQueue : public runtime::Object {
+ public:
+  /*!
+   * \brief Constructor.
+   * \param ctx The device to copy to.
+   * \param num_slots The maximum number of transfers in the queue.
+   * \param num_streams The number of copy streams.
+   */
+  PrefetchQueue(DGLContext ctx, int num_slots, int num_streams);
+  ~PrefetchQueue();
+
+  // disable copying
+  PrefetchQueue(const PrefetchQueue&) = delete;
+  PrefetchQueue& operator=(const PrefetchQueue&) = delete;
+
+  /*!
+   * \brief Start copying the arrays to the device. The arrays already on the
+   *        device are passed through. The queue must not be full.
+   */
+  void Enqueue(const std::vector<runtime::NDArray>& arrays);
+
+  /*! \brief Wait for the oldest transfer, and return its arrays on the device. */
+  std::vector<runtime::NDArray> Dequeue();
+
+  /*! \return The number of transfers in the queue. */
+  int Size() const { return size_; }
+
+  /*! \return The maximum number of transfers in the queue. */
+  int Capacity() const { return static_cast<int>(slots_.size()); }
+
+  static constexpr const char* _type_key = "ndarray.PrefetchQueue";
+  DGL_DECLARE_OBJECT_TYPE_INFO(PrefetchQueue, Object);
+
+ private:
+  struct Event;
+  struct Slot {
+    std::unique_ptr<Event> done;
+    std::unique_ptr<Event> released;
+    /*! \brief The recycled bytes on the device and the pinned staging bytes. */
+    std::vector<runtime::NDArray> buffers;
+    std::vector<runtime::NDArray> staging;
+    /*! \brief The sources, kept until the copies are done. */
+    std::vector<runtime::NDArray> src;
+    std::vector<runtime::NDArray> dst;
+  };
+
+  /*!
+   * \brief Get a buffer of at least nbytes from pool[i], reused if it is no
+   *        longer referenced, then viewed with the shape and dtype.
+   * \param reused Set to true if the buffer is reused.
+   */
+  runtime::NDArray GetBuffer(std::vector<runtime::NDArray>* pool, size_t i,
+                             const std::vector<int64_t>& shape, DLDataType dtype,
+                             DGLContext ctx, bool pinned, bool* reused);
+
+  DGLContext ctx_;
+  std::vector<Slot> slots_;
+  std::vector<DGLStreamHandle> streams_;
+  /*! \brief The slot of the oldest transfer. */
+  int head_{0};
+  int size_{0};
+  int next_stream_{0};
+};
+
+DGL_DEFINE_OBJECT_REF(PrefetchQueueRef, PrefetchQueue);
+
+}  // namespace dataloading
+}  // namespace dgl
+
+#endif  // DGL_DATALOADING_PREFETCH_QUEUE_H_
@@ -4,7 +4,9 @@
  * \brief Geometry operator CPU implementation
  */
 #include <dgl/random.h>
-#include <numeric>
+#include <dgl/runtime/parallel_for.h>
+#include <algorithm>
+#include <cstdint>
 #include <vector>
 #include <utility>
 #include "../geometry_op.h"
@@ -48,24 +50,6 @@ template void GroupIndexShuffle<int32_t>(
 template void GroupIndexShuffle<int64_t>(
     const int64_t *group_idxs, int64_t *idxs, int64_t num_groups_idxs, int64_t num_elems);
 
-template <typename IdType>
-IdArray RandomPerm(int64_t num_nodes) {
-  IdArray perm = aten::NewIdArray(num_nodes, DLContext{kDLCPU, 0}, sizeof(IdType) * 8);
-  IdType* perm_data = static_cast<IdType*>(perm->data);
-  std::iota(perm_data, perm_data + num_nodes, 0);
-  IndexShuffle(perm_data, num_nodes);
-  return perm;
-}
-
-template <typename IdType>
-IdArray GroupRandomPerm(const IdType *group_idxs, int64_t num_group_idxs, int64_t num_nodes) {
-  IdArray perm = aten::NewIdArray(num_nodes, DLContext{kDLCPU, 0}, sizeof(IdType) * 8);
-  IdType* perm_data = static_cast<IdType*>(perm->data);
-  std::iota(perm_data, perm_data + num_nodes, 0);
-  GroupIndexShuffle(group_idxs, perm_data, num_group_idxs, num_nodes);
-  return perm;
-}
-
 /*!
  * \brief Farthest Point Sampler without the need to compute all pairs of distance.
  * 
@@ -76,6 +60,10 @@ IdArray GroupRandomPerm(const IdType *group_idxs, int64_t num_group_idxs, int64_
  * Then for each point, we maintain the minimum to-sample distance.
  * Finally, we pick the point with the maximum such distance.
  * This process will be repeated for ``sample_points`` - 1 times.
+ *
+ * The point clouds are sampled in parallel. Every iteration updates the distances
+ * and takes their maximum in a vectorized loop, then picks the first point with
+ * the maximum distance.
  */
 template <DLDeviceType XPU, typename FloatType, typename IdType>
 void FarthestPointSampler(NDArray array, int64_t batch_size, int64_t sample_points,
@@ -93,47 +81,48 @@ void FarthestPointSampler(NDArray array, int64_t batch_size, int64_t sample_poin
   // return value
   IdType* ret_data = static_cast<IdType*>(result->data);
 
-  int64_t array_start = 0, ret_start = 0;
   // loop for each point cloud sample in this batch
-  for (auto b = 0; b < batch_size; b++) {
-    // random init start sample
-    int64_t sample_idx = (int64_t)start_idx_data[b];
-    ret_data[ret_start] = (IdType)(sample_idx);
-
-    // sample the rest `sample_points - 1` points
-    for (auto i = 0; i < sample_points - 1; i++) {
-      // re-init distance and the argmax
-      int64_t dist_argmax = 0;
-      FloatType dist_max = -1;
-
-      // update the distance
-      for (auto j = 0; j < point_in_batch; j++) {
-        // compute the distance on dimensions
-        FloatType one_dist = 0;
-        for (auto d = 0; d < dim; d++) {
-          FloatType tmp = array_data[(array_start + j) * dim + d] -
-              array_data[(array_start + sample_idx) * dim + d];
-          one_dist += tmp * tmp;
-        }
+  runtime::parallel_for(0, batch_size, 1, [&](size_t b_begin, size_t b_end) {
+    std::vector<FloatType> sample(dim);
+    for (size_t b = b_begin; b < b_end; ++b) {
+      const FloatType* points = array_data + b * point_in_batch * dim;
+      FloatType* batch_dist = dist_data + b * point_in_batch;
+      IdType* batch_ret = ret_data + b * sample_points;
 
-        // for each out-of-set point, keep its nearest to-the-set distance
-        if (i == 0 || dist_data[j] > one_dist) {
-          dist_data[j] = one_dist;
-        }
-        // look for the farthest sample
-        if (dist_data[j] > dist_max) {
-          dist_argmax = j;
-          dist_max = dist_data[j];
+      // random init start sample
+      int64_t sample_idx = (int64_t)start_idx_data[b];
+      batch_ret[0] = (IdType)(sample_idx);
+
+      // sample the rest `sample_points - 1` points
+      for (int64_t i = 0; i < sample_points - 1; i++) {
+        std::copy(points + sample_idx * dim, points + (sample_idx + 1) * dim, sample.begin());
+        const FloatType* sample_data = sample.data();
+        FloatType dist_max = -1;
+
+        // update the distance
+#pragma omp simd reduction(max:dist_max)
+        for (int64_t j = 0; j < point_in_batch; j++) {
+          // compute the distance on dimensions
+          FloatType one_dist = 0;
+          for (int64_t d = 0; d < dim; d++) {
+            const FloatType tmp = points[j * dim + d] - sample_data[d];
+            one_dist += tmp * tmp;
+          }
+          // for each out-of-set point, keep its nearest to-the-set distance
+          const FloatType cur = (i == 0 || batch_dist[j] > one_dist) ? one_dist : batch_dist[j];
+          batch_dist[j] = cur;
+          dist_max = std::max(dist_max, cur);
         }
+
+        // sample the first farthest point
+        int64_t dist_argmax = 0;
+        while (dist_argmax < point_in_batch && batch_dist[dist_argmax] != dist_max)
+          ++dist_argmax;
+        sample_idx = dist_argmax < point_in_batch ? dist_argmax : 0;
+        batch_ret[i + 1] = (IdType)(sample_idx);
       }
-      // sample the `dist_argmax`-th point
-      sample_idx = dist_argmax;
-      ret_data[ret_start + i + 1] = (IdType)(sample_idx);
     }
-
-    array_start += point_in_batch;
-    ret_start += sample_points;
-  }
+  });
 }
 template void FarthestPointSampler<kDLCPU, float, int32_t>(
     NDArray array, int64_t batch_size, int64_t sample_points,
@@ -148,39 +137,110 @@ template void FarthestPointSampler<kDLCPU, double, int64_t>(
     NDArray array, int64_t batch_size, int64_t sample_points,
     NDArray dist, IdArray start_idx, IdArray result);
 
-template <DLDeviceType XPU, typename FloatType, typename IdType>
-void WeightedNeighborMatching(const aten::CSRMatrix &csr, const NDArray weight, IdArray result) {
+namespace {
+
+/*! \brief Mix the bits of a 64-bit key, as in splitmix64. */
+inline uint64_t MixBits(uint64_t x) {
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+/*!
+ * \brief Handshake matching (CPU version), from `A GPU Algorithm for Greedy Graph
+ * Matching <http://www.staff.science.uu.nl/~bisse101/Articles/match12.pdf>`__
+ *
+ * Every round, each unmarked node points to the unmarked neighbor of the edge
+ * with the largest key, and the nodes pointing to each other are matched and
+ * marked with the smaller id between them. The nodes without unmarked neighbors
+ * are marked with their own id, so the matching is maximal once all nodes are
+ * marked. The key of an edge is its weight, ties being broken by a hash of its
+ * end nodes, the seed and the round, which is the same for both directions of
+ * the edge: the edge with the largest key left is then matched every round.
+ * The pointers are taken in parallel from the marks of the previous round, so
+ * the result only depends on the seed. A round matching nothing, e.g. for
+ * weights different in both directions, falls back to a greedy pass.
+ *
+ * \param weight_fn The weight of an edge given its position in csr.
+ */
+template <typename IdType, typename FloatType, typename WeightFn>
+void HandshakeMatching(const aten::CSRMatrix &csr, IdArray result, WeightFn weight_fn) {
   const int64_t num_nodes = result->shape[0];
   const IdType *indptr_data = static_cast<IdType*>(csr.indptr->data);
   const IdType *indices_data = static_cast<IdType*>(csr.indices->data);
   IdType *result_data = static_cast<IdType*>(result->data);
-  FloatType *weight_data = static_cast<FloatType*>(weight->data);
-
-  // build node visiting order
-  IdArray vis_order = RandomPerm<IdType>(num_nodes);
-  IdType *vis_order_data = static_cast<IdType*>(vis_order->data);
+  const uint64_t seed = dgl::RandomEngine::ThreadLocal()->RandInt(UINT64_MAX);
 
-  for (int64_t n = 0; n < num_nodes; ++n) {
-    auto u = vis_order_data[n];
-
-    // if marked
-    if (result_data[u] >= 0) continue;
-
-    auto v_max = u;
-    FloatType weight_max = 0;
+  std::vector<IdType> active, next_active;
+  for (int64_t u = 0; u < num_nodes; ++u) {
+    if (result_data[u] < 0)
+      active.push_back(u);
+  }
+  std::vector<IdType> proposal(num_nodes, -1);
+  for (uint64_t round = 0; !active.empty(); ++round) {
+    const uint64_t round_seed = MixBits(seed + round);
+    auto best_neighbor = [&](IdType u) {
+      IdType v_max = -1;
+      FloatType weight_max = 0;
+      uint64_t tie_max = 0;
+      for (auto e = indptr_data[u]; e < indptr_data[u + 1]; ++e) {
+        const IdType v = indices_data[e];
+        if (v == u || result_data[v] >= 0) continue;
+        const FloatType w = weight_fn(e);
+        const uint64_t tie = MixBits(round_seed ^ MixBits(
+            (static_cast<uint64_t>(std::min(u, v)) << 32) ^ static_cast<uint64_t>(std::max(u, v))));
+        if (v_max < 0 || w > weight_max || (w == weight_max && tie > tie_max)) {
+          v_max = v;
+          weight_max = w;
+          tie_max = tie;
+        }
+      }
+      return v_max;
+    };
+    runtime::parallel_for(0, active.size(), [&](size_t b, size_t e) {
+      for (size_t i = b; i < e; ++i)
+        proposal[active[i]] = best_neighbor(active[i]);
+    });
+    // every node only marks itself
+    runtime::parallel_for(0, active.size(), [&](size_t b, size_t e) {
+      for (size_t i = b; i < e; ++i) {
+        const IdType u = active[i];
+        const IdType v = proposal[u];
+        if (v < 0)
+          result_data[u] = u;
+        else if (proposal[v] == u)
+          result_data[u] = std::min(u, v);
+      }
+    });
 
-    for (auto e = indptr_data[u]; e < indptr_data[u + 1]; ++e) {
-      auto v = indices_data[e];
-      if (result_data[v] >= 0) continue;
-      if (weight_data[e] >= weight_max) {
-        v_max = v;
-        weight_max = weight_data[e];
+    next_active.clear();
+    for (const IdType u : active) {
+      if (result_data[u] < 0)
+        next_active.push_back(u);
+    }
+    if (next_active.size() == active.size()) {
+      for (const IdType u : active) {
+        if (result_data[u] >= 0) continue;
+        const IdType v = best_neighbor(u);
+        result_data[u] = v < 0 ? u : std::min(u, v);
+        if (v >= 0)
+          result_data[v] = result_data[u];
       }
+      next_active.clear();
     }
-    result_data[u] = std::min(u, v_max);
-    result_data[v_max] = result_data[u];
+    active.swap(next_active);
   }
 }
+
+}  // namespace
+
+template <DLDeviceType XPU, typename FloatType, typename IdType>
+void WeightedNeighborMatching(const aten::CSRMatrix &csr, const NDArray weight, IdArray result) {
+  const FloatType *weight_data = static_cast<FloatType*>(weight->data);
+  HandshakeMatching<IdType, FloatType>(csr, result, [weight_data] (int64_t e) {
+      return weight_data[e];
+    });
+}
 template void WeightedNeighborMatching<kDLCPU, float, int32_t>(
     const aten::CSRMatrix &csr, const NDArray weight, IdArray result);
 template void WeightedNeighborMatching<kDLCPU, float, int64_t>(
@@ -190,36 +250,13 @@ template void WeightedNeighborMatching<kDLCPU, double, int32_t>(
 template void WeightedNeighborMatching<kDLCPU, double, int64_t>(
     const aten::CSRMatrix &csr, const NDArray weight, IdArray result);
 
+/*! \brief Unweighted neighbor matching procedure (CPU version), the handshake
+ * matching with all weights equal, i.e. with a random key for every edge on
+ * every round.
+ */
 template <DLDeviceType XPU, typename IdType>
 void NeighborMatching(const aten::CSRMatrix &csr, IdArray result) {
-  const int64_t num_nodes = result->shape[0];
-  const IdType *indptr_data = static_cast<IdType*>(csr.indptr->data);
-  const IdType *indices_data = static_cast<IdType*>(csr.indices->data);
-  IdType *result_data = static_cast<IdType*>(result->data);
-
-  // build vis order
-  IdArray u_vis_order = RandomPerm<IdType>(num_nodes);
-  IdType *u_vis_order_data = static_cast<IdType*>(u_vis_order->data);
-  IdArray v_vis_order = GroupRandomPerm<IdType>(
-    indptr_data, csr.indptr->shape[0], csr.indices->shape[0]);
-  IdType *v_vis_order_data = static_cast<IdType*>(v_vis_order->data);
-
-  for (int64_t n = 0; n < num_nodes; ++n) {
-    auto u = u_vis_order_data[n];
-
-    // if marked
-    if (result_data[u] >= 0) continue;
-
-    result_data[u] = u;
-
-    for (auto e = indptr_data[u]; e < indptr_data[u + 1]; ++e) {
-      auto v = indices_data[v_vis_order_data[e]];
-      if (result_data[v] >= 0) continue;
-      result_data[u] = std::min(u, v);
-      result_data[v] = result_data[u];
-      break;
-    }
-  }
+  HandshakeMatching<IdType, float>(csr, result, [] (int64_t e) { return 0.f; });
 }
 template void NeighborMatching<kDLCPU, int32_t>(const aten::CSRMatrix &csr, IdArray result);
 template void NeighborMatching<kDLCPU, int64_t>(const aten::CSRMatrix &csr, IdArray result);
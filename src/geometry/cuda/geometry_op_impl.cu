@@ -75,16 +75,21 @@ __global__ void fps_kernel(const FloatType *array_data, const int64_t batch_size
 
     __syncthreads();
 
-    if (thread_idx == 0) {
-      FloatType best = dist_max_ht[0];
-      int64_t best_idx = dist_argmax_ht[0];
-      for (auto j = 1; j < THREADS; j++) {
-         if (dist_max_ht[j] > best)  {
-             best = dist_max_ht[j];
-             best_idx = dist_argmax_ht[j];
-         }
+    // tree reduction of the argmax, taking the first point among the farthest ones
+    for (int64_t s = THREADS / 2; s > 0; s >>= 1) {
+      if (thread_idx < s) {
+        const FloatType other = dist_max_ht[thread_idx + s];
+        if (other > dist_max_ht[thread_idx] || (other == dist_max_ht[thread_idx] &&
+            dist_argmax_ht[thread_idx + s] < dist_argmax_ht[thread_idx])) {
+          dist_max_ht[thread_idx] = other;
+          dist_argmax_ht[thread_idx] = dist_argmax_ht[thread_idx + s];
+        }
       }
-      ret_data[ret_start + i + 1] = (IdType)(best_idx);
+      __syncthreads();
+    }
+
+    if (thread_idx == 0) {
+      ret_data[ret_start + i + 1] = (IdType)(dist_argmax_ht[0]);
     }
   }
 }
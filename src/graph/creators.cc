@@ -19,25 +19,25 @@ HeteroGraphPtr CreateHeteroGraph(
 HeteroGraphPtr CreateFromCOO(
     int64_t num_vtypes, int64_t num_src, int64_t num_dst,
     IdArray row, IdArray col,
-    bool row_sorted, bool col_sorted, dgl_format_code_t formats) {
+    bool row_sorted, bool col_sorted, dgl_format_code_t formats, bool trusted) {
   auto unit_g = UnitGraph::CreateFromCOO(
-      num_vtypes, num_src, num_dst, row, col, row_sorted, col_sorted, formats);
+      num_vtypes, num_src, num_dst, row, col, row_sorted, col_sorted, formats, trusted);
   return HeteroGraphPtr(new HeteroGraph(unit_g->meta_graph(), {unit_g}));
 }
 
 HeteroGraphPtr CreateFromCOO(
     int64_t num_vtypes, const aten::COOMatrix& mat,
-    dgl_format_code_t formats) {
-  auto unit_g = UnitGraph::CreateFromCOO(num_vtypes, mat, formats);
+    dgl_format_code_t formats, bool trusted) {
+  auto unit_g = UnitGraph::CreateFromCOO(num_vtypes, mat, formats, trusted);
   return HeteroGraphPtr(new HeteroGraph(unit_g->meta_graph(), {unit_g}));
 }
 
 HeteroGraphPtr CreateFromCSR(
     int64_t num_vtypes, int64_t num_src, int64_t num_dst,
     IdArray indptr, IdArray indices, IdArray edge_ids,
-    dgl_format_code_t formats) {
+    dgl_format_code_t formats, bool sorted) {
   auto unit_g = UnitGraph::CreateFromCSR(
-      num_vtypes, num_src, num_dst, indptr, indices, edge_ids, formats);
+      num_vtypes, num_src, num_dst, indptr, indices, edge_ids, formats, sorted);
   return HeteroGraphPtr(new HeteroGraph(unit_g->meta_graph(), {unit_g}));
 }
 
@@ -55,9 +55,9 @@ HeteroGraphPtr CreateFromCSR(
 HeteroGraphPtr CreateFromCSC(
     int64_t num_vtypes, int64_t num_src, int64_t num_dst,
     IdArray indptr, IdArray indices, IdArray edge_ids,
-    dgl_format_code_t formats) {
+    dgl_format_code_t formats, bool sorted) {
   auto unit_g = UnitGraph::CreateFromCSC(
-      num_vtypes, num_src, num_dst, indptr, indices, edge_ids, formats);
+      num_vtypes, num_src, num_dst, indptr, indices, edge_ids, formats, sorted);
   return HeteroGraphPtr(new HeteroGraph(unit_g->meta_graph(), {unit_g}));
 }
 
@@ -0,0 +1,303 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file graph/cuda_ipc_graph.cc
+ * \brief Graph structures on a GPU shared with the other processes by CUDA IPC
+ */
+#include <dgl/array.h>
+#include <dgl/immutable_graph.h>
+#include <dgl/graph_serializer.h>
+#include <dgl/runtime/device_api.h>
+#include <dgl/runtime/shared_mem.h>
+#include <dmlc/memory_io.h>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "./heterograph.h"
+#include "./unit_graph.h"
+#ifdef DGL_USE_CUDA
+#include "../runtime/cuda/cuda_common.h"
+#endif  // DGL_USE_CUDA
+
+using namespace dgl::runtime;
+
+namespace dgl {
+
+#ifdef DGL_USE_CUDA
+namespace {
+
+/*!
+ * \brief The header of the shared memory segment describing a graph on a GPU.
+ *
+ * The segment is laid out as
+ * {
+ *   CUDAIpcGraphHeader
+ *   char meta[meta_size] (the graph metadata, the IPC handle and the layout)
+ * }
+ *
+ * while the arrays of all the formats lie in a single device buffer, exported by
+ * its IPC handle, each one starting at a multiple of kIpcAlignment bytes.
+ */
+struct CUDAIpcGraphHeader {
+  uint64_t magic;
+  uint64_t meta_size;
+};
+
+constexpr uint64_t kCUDAIpcGraphMagic = 0x4447434944475031ULL;
+constexpr int64_t kIpcAlignment = 256;
+
+/*! \brief The kinds of formats of the records of the layout. */
+enum IpcFormat : int64_t {
+  kIpcCOO = 0,
+  kIpcCSR = 1,
+  kIpcCSC = 2,
+};
+
+/*!
+ * \brief The number of integers of the record of a format in the layout:
+ *        {format, num_rows, num_cols, sorted0, sorted1, then the offset and the
+ *        length of each of the three arrays}.
+ */
+constexpr size_t kIpcRecordSize = 11;
+
+/*! \brief The owner of device memory wrapped into an NDArray. */
+struct DeviceMemoryTensor {
+  DLManagedTensor tensor;
+  int64_t shape;
+  std::function<void()> free;
+};
+
+/*! \brief A byte array over device memory, released by free with the array. */
+NDArray WrapDeviceMemory(void* ptr, int64_t size, const DLContext& ctx,
+                         std::function<void()> free) {
+  DeviceMemoryTensor* owner = new DeviceMemoryTensor();
+  owner->shape = size;
+  owner->free = std::move(free);
+  DLTensor& t = owner->tensor.dl_tensor;
+  t.data = ptr;
+  t.ctx = ctx;
+  t.ndim = 1;
+  t.dtype = DLDataType{kDLUInt, 8, 1};
+  t.shape = &owner->shape;
+  t.strides = nullptr;
+  t.byte_offset = 0;
+  owner->tensor.manager_ctx = owner;
+  owner->tensor.deleter = [] (DLManagedTensor* tensor) {
+    DeviceMemoryTensor* owner = static_cast<DeviceMemoryTensor*>(tensor->manager_ctx);
+    owner->free();
+    delete owner;
+  };
+  return NDArray::FromDLPack(&owner->tensor);
+}
+
+/*! \brief Lay the arrays of a format out in the buffer, appending its record. */
+void LayOut(IpcFormat format, int64_t num_rows, int64_t num_cols, bool sorted0,
+            bool sorted1, const std::array<NDArray, 3>& arrays, std::vector<int64_t>* record,
+            std::vector<NDArray>* buffer_arrays, std::vector<int64_t>* buffer_offsets,
+            int64_t* size) {
+  record->insert(record->end(), {format, num_rows, num_cols, sorted0, sorted1});
+  for (const NDArray& arr : arrays) {
+    CHECK(arr.IsContiguous()) << "The arrays of the graph must be contiguous.";
+    *size = (*size + kIpcAlignment - 1) / kIpcAlignment * kIpcAlignment;
+    record->push_back(*size);
+    record->push_back(arr->shape[0]);
+    buffer_arrays->push_back(arr);
+    buffer_offsets->push_back(*size);
+    *size += arr.GetSize();
+  }
+}
+
+/*! \brief Create the relation graphs whose arrays are views of the buffer. */
+std::vector<HeteroGraphPtr> AttachIpcRelationGraphs(
+    NDArray buffer, uint8_t bits, const std::vector<std::vector<int64_t>>& layout) {
+  const DLDataType dtype{kDLInt, bits, 1};
+  std::vector<HeteroGraphPtr> relgraphs;
+  for (const std::vector<int64_t>& records : layout) {
+    CHECK_EQ(records.size() % kIpcRecordSize, 0) << "Invalid layout of the graph";
+    aten::COOMatrix coo;
+    aten::CSRMatrix csr, csc;
+    bool has_coo = false, has_csr = false, has_csc = false;
+    for (size_t i = 0; i < records.size(); i += kIpcRecordSize) {
+      const int64_t* rec = records.data() + i;
+      std::array<NDArray, 3> arrays;
+      for (int k = 0; k < 3; ++k)
+        arrays[k] = buffer.CreateView({rec[6 + 2 * k]}, dtype, rec[5 + 2 * k]);
+      switch (rec[0]) {
+        case kIpcCOO:
+          coo = aten::COOMatrix(rec[1], rec[2], arrays[0], arrays[1], arrays[2], rec[3], rec[4]);
+          has_coo = true;
+          break;
+        case kIpcCSR:
+          csr = aten::CSRMatrix(rec[1], rec[2], arrays[0], arrays[1], arrays[2], rec[3]);
+          has_csr = true;
+          break;
+        case kIpcCSC:
+          csc = aten::CSRMatrix(rec[1], rec[2], arrays[0], arrays[1], arrays[2], rec[3]);
+          has_csc = true;
+          break;
+        default:
+          LOG(FATAL) << "Invalid layout of the graph";
+      }
+    }
+    relgraphs.push_back(
+        UnitGraph::CreateHomographFrom(csc, csr, coo, has_csc, has_csr, has_coo));
+  }
+  return relgraphs;
+}
+
+}  // namespace
+#endif  // DGL_USE_CUDA
+
+HeteroGraphPtr HeteroGraph::CopyToCUDAIpc(
+      HeteroGraphPtr g, const std::string& name, const std::vector<std::string>& ntypes,
+      const std::vector<std::string>& etypes, const std::set<std::string>& fmts) {
+#ifdef DGL_USE_CUDA
+  auto hg = std::dynamic_pointer_cast<HeteroGraph>(g);
+  CHECK_NOTNULL(hg);
+  const DLContext ctx = hg->Context();
+  CHECK_EQ(ctx.device_type, kDLGPU) << "Only a graph on a GPU can be shared by CUDA IPC.";
+  CHECK(!SharedMemory::Exist(name)) << "The shared memory " << name << " already exists";
+
+  const bool has_coo = fmts.find("coo") != fmts.end();
+  const bool has_csr = fmts.find("csr") != fmts.end();
+  const bool has_csc = fmts.find("csc") != fmts.end();
+  std::vector<std::vector<int64_t>> layout(g->NumEdgeTypes());
+  std::vector<NDArray> arrays;
+  std::vector<int64_t> offsets;
+  int64_t size = 0;
+  for (dgl_type_t etype = 0; etype < g->NumEdgeTypes(); ++etype) {
+    if (has_coo) {
+      const aten::COOMatrix coo = hg->GetCOOMatrix(etype);
+      LayOut(kIpcCOO, coo.num_rows, coo.num_cols, coo.row_sorted, coo.col_sorted,
+             {coo.row, coo.col, coo.data}, &layout[etype], &arrays, &offsets, &size);
+    }
+    if (has_csr) {
+      const aten::CSRMatrix csr = hg->GetCSRMatrix(etype);
+      LayOut(kIpcCSR, csr.num_rows, csr.num_cols, csr.sorted, false,
+             {csr.indptr, csr.indices, csr.data}, &layout[etype], &arrays, &offsets, &size);
+    }
+    if (has_csc) {
+      const aten::CSRMatrix csc = hg->GetCSCMatrix(etype);
+      LayOut(kIpcCSC, csc.num_rows, csc.num_cols, csc.sorted, false,
+             {csc.indptr, csc.indices, csc.data}, &layout[etype], &arrays, &offsets, &size);
+    }
+  }
+
+  // The buffer is allocated by cudaMalloc rather than by the allocator of the
+  // framework, whose blocks may be parts of larger allocations while an IPC
+  // handle always refers to the start of an allocation.
+  DeviceAPI* device = DeviceAPI::Get(ctx);
+  void* ptr = device->AllocDataSpace(ctx, std::max<int64_t>(size, 1), kIpcAlignment,
+                                     DLDataType{kDLUInt, 8, 1});
+  NDArray buffer = WrapDeviceMemory(ptr, size, ctx, [device, ctx, ptr] () {
+      device->FreeDataSpace(ctx, ptr);
+    });
+  auto stream = CUDAThreadEntry::ThreadLocal()->stream;
+  for (size_t i = 0; i < arrays.size(); ++i) {
+    NDArray view = buffer.CreateView({arrays[i]->shape[0]}, arrays[i]->dtype, offsets[i]);
+    view.CopyFrom(arrays[i], stream);
+  }
+  device->StreamSync(ctx, stream);
+  cudaIpcMemHandle_t handle;
+  CUDA_CALL(cudaIpcGetMemHandle(&handle, ptr));
+
+  std::string meta;
+  dmlc::MemoryStringStream strm(&meta);
+  strm.Write(ImmutableGraph::ToImmutable(hg->meta_graph_));
+  strm.Write(hg->num_verts_per_type_);
+  strm.Write(ntypes);
+  strm.Write(etypes);
+  strm.Write(static_cast<int64_t>(g->NumBits()));
+  strm.Write(static_cast<int64_t>(ctx.device_id));
+  strm.Write(std::string(reinterpret_cast<const char*>(&handle), sizeof(handle)));
+  strm.Write(size);
+  strm.Write(layout);
+
+  const DLContext cpu_ctx{kDLCPU, 0};
+  NDArray segment = NDArray::EmptyShared(
+      name, {static_cast<int64_t>(sizeof(CUDAIpcGraphHeader) + meta.size())},
+      DLDataType{kDLUInt, 8, 1}, cpu_ctx, true);
+  CUDAIpcGraphHeader* header = static_cast<CUDAIpcGraphHeader*>(segment->data);
+  header->magic = kCUDAIpcGraphMagic;
+  header->meta_size = meta.size();
+  std::memcpy(header + 1, meta.data(), meta.size());
+
+  auto ret = std::make_shared<HeteroGraph>(
+      hg->meta_graph_, AttachIpcRelationGraphs(buffer, g->NumBits(), layout),
+      hg->num_verts_per_type_);
+  ret->ipc_segment_ = segment;
+  return ret;
+#else
+  LOG(FATAL) << "Only a graph on a GPU can be shared by CUDA IPC, and DGL is not built "
+             << "with CUDA.";
+  return nullptr;
+#endif  // DGL_USE_CUDA
+}
+
+std::tuple<HeteroGraphPtr, std::vector<std::string>, std::vector<std::string>>
+    HeteroGraph::CreateFromCUDAIpc(const std::string &name) {
+#ifdef DGL_USE_CUDA
+  if (!SharedMemory::Exist(name)) {
+    return std::make_tuple(nullptr, std::vector<std::string>(), std::vector<std::string>());
+  }
+  uint64_t meta_size;
+  {
+    SharedMemory header_mem(name);
+    const CUDAIpcGraphHeader* header =
+      static_cast<const CUDAIpcGraphHeader*>(header_mem.Open(sizeof(CUDAIpcGraphHeader)));
+    CHECK_EQ(header->magic, kCUDAIpcGraphMagic)
+      << "The shared memory " << name << " does not hold a graph on a GPU";
+    meta_size = header->meta_size;
+  }
+  const DLContext cpu_ctx{kDLCPU, 0};
+  NDArray segment = NDArray::EmptyShared(
+      name, {static_cast<int64_t>(sizeof(CUDAIpcGraphHeader) + meta_size)},
+      DLDataType{kDLUInt, 8, 1}, cpu_ctx, false);
+  std::string meta(static_cast<const char*>(segment->data) + sizeof(CUDAIpcGraphHeader),
+                   meta_size);
+  dmlc::MemoryStringStream strm(&meta);
+
+  auto meta_imgraph = Serializer::make_shared<ImmutableGraph>();
+  CHECK(strm.Read(&meta_imgraph)) << "Invalid meta graph";
+  GraphPtr metagraph = meta_imgraph;
+  std::vector<int64_t> num_verts_per_type;
+  CHECK(strm.Read(&num_verts_per_type)) << "Invalid number of vertices per type";
+  std::vector<std::string> ntypes;
+  std::vector<std::string> etypes;
+  CHECK(strm.Read(&ntypes)) << "invalid ntypes";
+  CHECK(strm.Read(&etypes)) << "invalid etypes";
+  int64_t bits, device_id, size;
+  std::string handle_bytes;
+  std::vector<std::vector<int64_t>> layout;
+  CHECK(strm.Read(&bits)) << "Invalid number of bits";
+  CHECK(strm.Read(&device_id)) << "Invalid device";
+  CHECK(strm.Read(&handle_bytes) && handle_bytes.size() == sizeof(cudaIpcMemHandle_t))
+    << "Invalid IPC handle";
+  CHECK(strm.Read(&size)) << "Invalid size of the buffer";
+  CHECK(strm.Read(&layout)) << "Invalid layout of the graph";
+  CHECK_EQ(layout.size(), metagraph->NumEdges()) << "Invalid number of edge types";
+
+  cudaIpcMemHandle_t handle;
+  std::memcpy(&handle, handle_bytes.data(), sizeof(handle));
+  const DLContext ctx{kDLGPU, static_cast<int>(device_id)};
+  CUDA_CALL(cudaSetDevice(ctx.device_id));
+  void* ptr;
+  CUDA_CALL(cudaIpcOpenMemHandle(&ptr, handle, cudaIpcMemLazyEnablePeerAccess));
+  NDArray buffer = WrapDeviceMemory(ptr, size, ctx, [ctx, ptr] () {
+      CUDA_CALL(cudaSetDevice(ctx.device_id));
+      CUDA_CALL(cudaIpcCloseMemHandle(ptr));
+    });
+
+  auto ret = std::make_shared<HeteroGraph>(
+      metagraph, AttachIpcRelationGraphs(buffer, bits, layout), num_verts_per_type);
+  return std::make_tuple(ret, ntypes, etypes);
+#else
+  LOG(FATAL) << "DGL is not built with CUDA.";
+  return std::make_tuple(nullptr, std::vector<std::string>(), std::vector<std::string>());
+#endif  // DGL_USE_CUDA
+}
+
+}  // namespace dgl
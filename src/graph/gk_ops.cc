@@ -99,22 +99,4 @@ aten::CSRMatrix Convert2DGLCsr(gk_csr_t *gk_csr, bool is_row) {
 
 #endif  // !defined(_WIN32)
 
-GraphPtr GraphOp::ToBidirectedSimpleImmutableGraph(ImmutableGraphPtr ig) {
-#if !defined(_WIN32)
-  // TODO(zhengda) should we get whatever CSR exists in the graph.
-  CSRPtr csr = ig->GetInCSR();
-  gk_csr_t *gk_csr = Convert2GKCsr(csr->ToCSRMatrix(), true);
-  gk_csr_t *sym_gk_csr = gk_csr_MakeSymmetric(gk_csr, GK_CSR_SYM_SUM);
-  auto mat = Convert2DGLCsr(sym_gk_csr, true);
-  gk_csr_Free(&gk_csr);
-  gk_csr_Free(&sym_gk_csr);
-
-  // This is a symmetric graph now. The in-csr and out-csr are the same.
-  csr = CSRPtr(new CSR(mat.indptr, mat.indices, mat.data));
-  return GraphPtr(new ImmutableGraph(csr, csr));
-#else
-  return GraphPtr();
-#endif  // !defined(_WIN32)
-}
-
 }  // namespace dgl
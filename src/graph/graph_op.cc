@@ -11,6 +11,7 @@
 #include <dgl/runtime/parallel_for.h>
 #include <algorithm>
 #include "../c_api_common.h"
+#include "../partition/partition_op.h"
 
 using namespace dgl::runtime;
 
@@ -403,6 +404,18 @@ GraphPtr GraphOp::ToBidirectedImmutableGraph(GraphPtr g) {
       g->NumVertices(), srcs_array, dsts_array);
 }
 
+GraphPtr GraphOp::ToBidirectedSimpleImmutableGraph(ImmutableGraphPtr ig) {
+  // TODO(zhengda) should we get whatever CSR exists in the graph.
+  CSRPtr csr = ig->GetInCSR();
+  auto mat = aten::CSRMakeSymmetric(csr->ToCSRMatrix());
+  IdArray eids = aten::Range(0, mat.indices->shape[0], mat.indptr->dtype.bits,
+                             mat.indptr->ctx);
+
+  // This is a symmetric graph now. The in-csr and out-csr are the same.
+  csr = CSRPtr(new CSR(mat.indptr, mat.indices, eids));
+  return GraphPtr(new ImmutableGraph(csr, csr));
+}
+
 HaloSubgraph GraphOp::GetSubgraphWithHalo(GraphPtr g, IdArray nodes, int num_hops) {
   const dgl_id_t *nid = static_cast<dgl_id_t *>(nodes->data);
   const auto id_len = nodes->shape[0];
@@ -723,6 +736,25 @@ DGL_REGISTER_GLOBAL("graph_index._CAPI_DGLMapSubgraphNID")
     *rv = GraphOp::MapParentIdToSubgraphId(parent_vids, query);
   });
 
+namespace {
+
+/*!
+ * \brief Find the first of the n sorted ends not below id, by a binary search
+ *        whose only branch is on n, so that it pipelines across IDs.
+ */
+template<class IdType>
+inline int64_t LowerBoundBranchless(const IdType* ends, int64_t n, IdType id) {
+  const IdType* base = ends;
+  while (n > 1) {
+    const int64_t half = n / 2;
+    base += (base[half - 1] < id) * half;
+    n -= half;
+  }
+  return (base - ends) + (*base < id);
+}
+
+}  // namespace
+
 template<class IdType>
 IdArray MapIds(IdArray ids, IdArray range_starts, IdArray range_ends, IdArray typed_map,
                int num_parts, int num_types) {
@@ -739,20 +771,16 @@ IdArray MapIds(IdArray ids, IdArray range_starts, IdArray range_ends, IdArray ty
   runtime::parallel_for(0, ids->shape[0], [&](size_t b, size_t e) {
     for (auto i = b; i < e; ++i) {
       IdType id = ids_data[i];
-      auto it = std::lower_bound(range_end_data, range_end_data + num_ranges, id);
+      const int64_t range_id = LowerBoundBranchless(range_end_data, num_ranges, id);
       // The range must exist.
-      BUG_IF_FAIL(it != range_end_data + num_ranges);
-      size_t range_id = it - range_end_data;
+      BUG_IF_FAIL(range_id < num_ranges);
       int type_id = range_id % num_types;
       types_data[i] = type_id;
       int part_id = range_id / num_types;
       BUG_IF_FAIL(part_id < num_parts);
-      if (part_id == 0) {
-        per_type_ids_data[i] = id - range_start_data[range_id];
-      } else {
-        per_type_ids_data[i] = id - range_start_data[range_id]
-          + typed_map_data[num_parts * type_id + part_id - 1];
-      }
+      // the per-type IDs of the previous parts, none for the first part
+      const IdType offset = part_id == 0 ? 0 : typed_map_data[num_parts * type_id + part_id - 1];
+      per_type_ids_data[i] = id - range_start_data[range_id] + offset;
     }
   });
   return ret;
@@ -774,9 +802,22 @@ DGL_REGISTER_GLOBAL("distributed.id_map._CAPI_DGLHeteroMapIds")
     CHECK_EQ(num_ranges, num_parts * num_types);
     CHECK_EQ(num_ranges, range_ends->shape[0]);
 
+    CHECK_SAME_CONTEXT(ids, range_starts);
+    CHECK_SAME_CONTEXT(ids, range_ends);
+    CHECK_SAME_CONTEXT(ids, typed_map);
+
     IdArray ret;
     ATEN_ID_TYPE_SWITCH(ids->dtype, IdType, {
+#ifdef DGL_USE_CUDA
+      if (ids->ctx.device_type == kDLGPU) {
+        ret = partition::impl::MapIdsToTypes<kDLGPU, IdType>(
+            ids, range_starts, range_ends, typed_map, num_parts, num_types);
+      } else {
+        ret = MapIds<IdType>(ids, range_starts, range_ends, typed_map, num_parts, num_types);
+      }
+#else
       ret = MapIds<IdType>(ids, range_starts, range_ends, typed_map, num_parts, num_types);
+#endif
     });
     *rv = ret;
   });
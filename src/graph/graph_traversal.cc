@@ -12,18 +12,31 @@ using namespace dgl::runtime;
 namespace dgl {
 namespace traverse {
 
+namespace {
+// The matrix to traverse, and its transpose if the graph has it already.
+void GetBFSMatrices(HeteroGraphPtr g, bool reversed,
+                    aten::CSRMatrix* csr, aten::CSRMatrix* transpose) {
+  const dgl_format_code_t created = g->GetCreatedFormats();
+  if (reversed) {
+    *csr = g->GetCSCMatrix(0);
+    if (FORMAT_HAS_CSR(created))
+      *transpose = g->GetCSRMatrix(0);
+  } else {
+    *csr = g->GetCSRMatrix(0);
+    if (FORMAT_HAS_CSC(created))
+      *transpose = g->GetCSCMatrix(0);
+  }
+}
+}  // namespace
+
 DGL_REGISTER_GLOBAL("traversal._CAPI_DGLBFSNodes_v2")
 .set_body([] (DGLArgs args, DGLRetValue* rv) {
     HeteroGraphRef g = args[0];
     const IdArray src = args[1];
     bool reversed = args[2];
-    aten::CSRMatrix csr;
-    if (reversed) {
-      csr = g.sptr()->GetCSCMatrix(0);
-    } else {
-      csr = g.sptr()->GetCSRMatrix(0);
-    }
-    const auto& front = aten::BFSNodesFrontiers(csr, src);
+    aten::CSRMatrix csr, transpose;
+    GetBFSMatrices(g.sptr(), reversed, &csr, &transpose);
+    const auto& front = aten::BFSNodesFrontiers(csr, transpose, src);
     *rv = ConvertNDArrayVectorToPackedFunc({front.ids, front.sections});
   });
 
@@ -32,14 +45,9 @@ DGL_REGISTER_GLOBAL("traversal._CAPI_DGLBFSEdges_v2")
     HeteroGraphRef g = args[0];
     const IdArray src = args[1];
     bool reversed = args[2];
-    aten::CSRMatrix csr;
-    if (reversed) {
-      csr = g.sptr()->GetCSCMatrix(0);
-    } else {
-      csr = g.sptr()->GetCSRMatrix(0);
-    }
-
-    const auto& front = aten::BFSEdgesFrontiers(csr, src);
+    aten::CSRMatrix csr, transpose;
+    GetBFSMatrices(g.sptr(), reversed, &csr, &transpose);
+    const auto& front = aten::BFSEdgesFrontiers(csr, transpose, src);
     *rv = ConvertNDArrayVectorToPackedFunc({front.ids, front.sections});
   });
 
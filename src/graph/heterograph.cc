@@ -7,8 +7,11 @@
 #include <dgl/array.h>
 #include <dgl/immutable_graph.h>
 #include <dgl/graph_serializer.h>
+#include <dgl/runtime/parallel_for.h>
+#include <dgl/runtime/stage_tracker.h>
 #include <dmlc/memory_io.h>
 #include <memory>
+#include <numeric>
 #include <vector>
 #include <tuple>
 #include <utility>
@@ -259,16 +262,48 @@ HeteroGraphPtr HeteroGraph::CopyTo(HeteroGraphPtr g, const DLContext &ctx,
   }
   auto hgindex = std::dynamic_pointer_cast<HeteroGraph>(g);
   CHECK_NOTNULL(hgindex);
-  std::vector<HeteroGraphPtr> rel_graphs;
-  for (auto g : hgindex->relation_graphs_) {
-    rel_graphs.push_back(UnitGraph::CopyTo(g, ctx, stream));
+  runtime::StageScope stage_scope(runtime::SamplingStage::kCopyTo);
+  if (stage_scope.active()) {
+    for (dgl_type_t etype = 0; etype < g->NumEdgeTypes(); ++etype)
+      stage_scope.AddEdges(g->NumEdges(etype));
   }
+  // all the relation graphs are copied at once rather than array by array
+  std::vector<HeteroGraphPtr> rel_graphs(hgindex->relation_graphs_.begin(),
+                                         hgindex->relation_graphs_.end());
+  rel_graphs = UnitGraph::CopyTo(rel_graphs, ctx, stream);
   return HeteroGraphPtr(new HeteroGraph(hgindex->meta_graph_, rel_graphs,
                                         hgindex->num_verts_per_type_));
 }
 
 std::string HeteroGraph::SharedMemName() const {
-  return shared_mem_ ? shared_mem_->GetName() : "";
+  return shared_mem_ ? shared_mem_->name() : "";
+}
+
+HeteroGraphPtr HeteroGraph::AttachRelationGraph(
+    const SharedMemManager& shm, dgl_type_t etype, const UnitGraphPtr& local) {
+  aten::COOMatrix coo;
+  aten::CSRMatrix csr, csc;
+  bool has_coo = shm.Get(etype, &coo);
+  bool has_csr = shm.Get(etype, false, &csr);
+  bool has_csc = shm.Get(etype, true, &csc);
+  if (!local)
+    return UnitGraph::CreateHomographFrom(csc, csr, coo, has_csc, has_csr, has_coo);
+
+  const dgl_format_code_t created = local->GetCreatedFormats();
+  if (!has_coo && (created & COO_CODE)) {
+    coo = local->GetCOOMatrix(0);
+    has_coo = true;
+  }
+  if (!has_csr && (created & CSR_CODE)) {
+    csr = local->GetCSRMatrix(0);
+    has_csr = true;
+  }
+  if (!has_csc && (created & CSC_CODE)) {
+    csc = local->GetCSCMatrix(0);
+    has_csc = true;
+  }
+  return UnitGraph::CreateHomographFrom(csc, csr, coo, has_csc, has_csr, has_coo,
+                                        local->GetAllowedFormats());
 }
 
 HeteroGraphPtr HeteroGraph::CopyToSharedMem(
@@ -280,46 +315,39 @@ HeteroGraphPtr HeteroGraph::CopyToSharedMem(
   if (hg->SharedMemName() == name)
     return g;
 
-  // Copy buffer to share memory
-  auto mem = std::make_shared<SharedMemory>(name);
-  auto mem_buf = mem->CreateNew(SHARED_MEM_METAINFO_SIZE_MAX);
-  dmlc::MemoryFixedSizeStream strm(mem_buf, SHARED_MEM_METAINFO_SIZE_MAX);
-  SharedMemManager shm(name, &strm);
+  std::string meta;
+  dmlc::MemoryStringStream strm(&meta);
+  strm.Write(ImmutableGraph::ToImmutable(hg->meta_graph_));
+  strm.Write(hg->num_verts_per_type_);
+  strm.Write(ntypes);
+  strm.Write(etypes);
+
+  std::vector<SharedMemManager::RelationSize> sizes(g->NumEdgeTypes());
+  for (dgl_type_t etype = 0 ; etype < g->NumEdgeTypes() ; ++etype) {
+    const auto pair = hg->meta_graph_->FindEdge(etype);
+    sizes[etype] = {static_cast<int64_t>(hg->NumVertices(pair.first)),
+                    static_cast<int64_t>(hg->NumVertices(pair.second)),
+                    static_cast<int64_t>(hg->NumEdges(etype))};
+  }
+  auto shm = std::make_shared<SharedMemManager>(name, g->NumBits(), meta, sizes);
 
   bool has_coo = fmts.find("coo") != fmts.end();
   bool has_csr = fmts.find("csr") != fmts.end();
   bool has_csc = fmts.find("csc") != fmts.end();
-  shm.Write(g->NumBits());
-  shm.Write(has_coo);
-  shm.Write(has_csr);
-  shm.Write(has_csc);
-  shm.Write(ImmutableGraph::ToImmutable(hg->meta_graph_));
-  shm.Write(hg->num_verts_per_type_);
-
   std::vector<HeteroGraphPtr> relgraphs(g->NumEdgeTypes());
-
   for (dgl_type_t etype = 0 ; etype < g->NumEdgeTypes() ; ++etype) {
-    aten::COOMatrix coo;
-    aten::CSRMatrix csr, csc;
-    std::string prefix = name + "_" + std::to_string(etype);
-    if (has_coo) {
-      coo = shm.CopyToSharedMem(hg->GetCOOMatrix(etype), prefix + "_coo");
-    }
-    if (has_csr) {
-      csr = shm.CopyToSharedMem(hg->GetCSRMatrix(etype), prefix + "_csr");
-    }
-    if (has_csc) {
-      csc = shm.CopyToSharedMem(hg->GetCSCMatrix(etype), prefix + "_csc");
-    }
-    relgraphs[etype] = UnitGraph::CreateHomographFrom(csc, csr, coo, has_csc, has_csr, has_coo);
+    if (has_coo)
+      shm->Publish(etype, hg->GetCOOMatrix(etype));
+    if (has_csr)
+      shm->Publish(etype, hg->GetCSRMatrix(etype), false);
+    if (has_csc)
+      shm->Publish(etype, hg->GetCSCMatrix(etype), true);
+    relgraphs[etype] = AttachRelationGraph(*shm, etype, nullptr);
   }
 
   auto ret = std::shared_ptr<HeteroGraph>(
       new HeteroGraph(hg->meta_graph_, relgraphs, hg->num_verts_per_type_));
-  ret->shared_mem_ = mem;
-
-  shm.Write(ntypes);
-  shm.Write(etypes);
+  ret->shared_mem_ = shm;
   return ret;
 }
 
@@ -329,54 +357,55 @@ std::tuple<HeteroGraphPtr, std::vector<std::string>, std::vector<std::string>>
   if (!exist) {
     return std::make_tuple(nullptr, std::vector<std::string>(), std::vector<std::string>());
   }
-  auto mem = std::make_shared<SharedMemory>(name);
-  auto mem_buf = mem->Open(SHARED_MEM_METAINFO_SIZE_MAX);
-  dmlc::MemoryFixedSizeStream strm(mem_buf, SHARED_MEM_METAINFO_SIZE_MAX);
-  SharedMemManager shm(name, &strm);
-
-  uint8_t nbits;
-  CHECK(shm.Read(&nbits)) << "invalid nbits (unit8_t)";
-
-  bool has_coo, has_csr, has_csc;
-  CHECK(shm.Read(&has_coo)) << "invalid nbits (unit8_t)";
-  CHECK(shm.Read(&has_csr)) << "invalid csr (unit8_t)";
-  CHECK(shm.Read(&has_csc)) << "invalid csc (unit8_t)";
+  auto shm = std::make_shared<SharedMemManager>(name);
+  std::string meta = shm->meta();
+  dmlc::MemoryStringStream strm(&meta);
 
   auto meta_imgraph = Serializer::make_shared<ImmutableGraph>();
-  CHECK(shm.Read(&meta_imgraph)) << "Invalid meta graph";
+  CHECK(strm.Read(&meta_imgraph)) << "Invalid meta graph";
   GraphPtr metagraph = meta_imgraph;
 
   std::vector<int64_t> num_verts_per_type;
-  CHECK(shm.Read(&num_verts_per_type)) << "Invalid number of vertices per type";
+  CHECK(strm.Read(&num_verts_per_type)) << "Invalid number of vertices per type";
 
-  std::vector<HeteroGraphPtr> relgraphs(metagraph->NumEdges());
-  for (dgl_type_t etype = 0 ; etype < metagraph->NumEdges() ; ++etype) {
-    aten::COOMatrix coo;
-    aten::CSRMatrix csr, csc;
-    std::string prefix = name + "_" + std::to_string(etype);
-    if (has_coo) {
-      shm.CreateFromSharedMem(&coo, prefix + "_coo");
-    }
-    if (has_csr) {
-      shm.CreateFromSharedMem(&csr, prefix + "_csr");
-    }
-    if (has_csc) {
-      shm.CreateFromSharedMem(&csc, prefix + "_csc");
-    }
+  std::vector<std::string> ntypes;
+  std::vector<std::string> etypes;
+  CHECK(strm.Read(&ntypes)) << "invalid ntypes";
+  CHECK(strm.Read(&etypes)) << "invalid etypes";
 
-    relgraphs[etype] = UnitGraph::CreateHomographFrom(csc, csr, coo, has_csc, has_csr, has_coo);
-  }
+  CHECK_EQ(shm->NumEdgeTypes(), metagraph->NumEdges()) << "Invalid number of edge types";
+  std::vector<HeteroGraphPtr> relgraphs(metagraph->NumEdges());
+  for (dgl_type_t etype = 0 ; etype < metagraph->NumEdges() ; ++etype)
+    relgraphs[etype] = AttachRelationGraph(*shm, etype, nullptr);
 
   auto ret = std::make_shared<HeteroGraph>(metagraph, relgraphs, num_verts_per_type);
-  ret->shared_mem_ = mem;
-
-  std::vector<std::string> ntypes;
-  std::vector<std::string> etypes;
-  CHECK(shm.Read(&ntypes)) << "invalid ntypes";
-  CHECK(shm.Read(&etypes)) << "invalid etypes";
+  ret->shared_mem_ = shm;
   return std::make_tuple(ret, ntypes, etypes);
 }
 
+HeteroGraphPtr HeteroGraph::SyncSharedMemFormats(HeteroGraphPtr g) {
+  auto hg = std::dynamic_pointer_cast<HeteroGraph>(g);
+  CHECK_NOTNULL(hg);
+  CHECK(hg->shared_mem_) << "The graph is not in shared memory";
+  SharedMemManager* shm = hg->shared_mem_.get();
+  std::vector<HeteroGraphPtr> relgraphs(g->NumEdgeTypes());
+  for (dgl_type_t etype = 0 ; etype < g->NumEdgeTypes() ; ++etype) {
+    const UnitGraphPtr& relgraph = hg->relation_graphs_[etype];
+    const dgl_format_code_t created = relgraph->GetCreatedFormats();
+    // A format already published, or being published by another process, is skipped
+    if (created & COO_CODE)
+      shm->Publish(etype, relgraph->GetCOOMatrix(0));
+    if (created & CSR_CODE)
+      shm->Publish(etype, relgraph->GetCSRMatrix(0), false);
+    if (created & CSC_CODE)
+      shm->Publish(etype, relgraph->GetCSCMatrix(0), true);
+    relgraphs[etype] = AttachRelationGraph(*shm, etype, relgraph);
+  }
+  auto ret = std::make_shared<HeteroGraph>(hg->meta_graph_, relgraphs, hg->num_verts_per_type_);
+  ret->shared_mem_ = hg->shared_mem_;
+  return ret;
+}
+
 HeteroGraphPtr HeteroGraph::GetGraphInFormat(dgl_format_code_t formats) const {
   std::vector<HeteroGraphPtr> format_rels(NumEdgeTypes());
   for (dgl_type_t etype = 0; etype < NumEdgeTypes(); ++etype) {
@@ -387,14 +416,91 @@ HeteroGraphPtr HeteroGraph::GetGraphInFormat(dgl_format_code_t formats) const {
     meta_graph_, format_rels, NumVerticesPerType()));
 }
 
+HeteroGraphPtr HeteroGraph::Snapshot() const {
+  std::vector<HeteroGraphPtr> rels(NumEdgeTypes());
+  for (dgl_type_t etype = 0; etype < NumEdgeTypes(); ++etype) {
+    auto relgraph = std::dynamic_pointer_cast<UnitGraph>(GetRelationGraph(etype));
+    rels[etype] = relgraph->Snapshot();
+  }
+  return HeteroGraphPtr(new HeteroGraph(meta_graph_, rels, NumVerticesPerType()));
+}
+
 FlattenedHeteroGraphPtr HeteroGraph::Flatten(
     const std::vector<dgl_type_t>& etypes) const {
+  {
+    std::lock_guard<std::mutex> lock(flattened_mutex_);
+    auto it = flattened_.find(etypes);
+    if (it != flattened_.end())
+      return it->second;
+  }
   const int64_t bits = NumBits();
+  FlattenedHeteroGraphPtr ret;
   if (bits == 32) {
-    return FlattenImpl<int32_t>(etypes);
+    ret = FlattenImpl<int32_t>(etypes);
   } else {
-    return FlattenImpl<int64_t>(etypes);
+    ret = FlattenImpl<int64_t>(etypes);
   }
+  // the first of the threads flattening the same edge types at once wins
+  std::lock_guard<std::mutex> lock(flattened_mutex_);
+  return flattened_.emplace(etypes, ret).first->second;
+}
+
+template <class IdType>
+HeteroGraphPtr HeteroGraph::FlattenCSC(
+    const std::vector<dgl_type_t>& etypes, int64_t num_vtypes,
+    int64_t src_nodes, int64_t dst_nodes,
+    const std::unordered_map<dgl_type_t, size_t>& srctype_offsets,
+    const std::unordered_map<dgl_type_t, size_t>& dsttype_offsets) const {
+  std::vector<aten::CSRMatrix> cscs;
+  std::vector<int64_t> edge_offsets = {0};
+  for (dgl_type_t etype : etypes) {
+    cscs.push_back(GetCSCMatrix(etype));
+    edge_offsets.push_back(edge_offsets.back() + NumEdges(etype));
+  }
+  const int64_t num_edges = edge_offsets.back();
+  IdArray indptr = aten::NewIdArray(dst_nodes + 1, Context(), NumBits());
+  IdArray indices = aten::NewIdArray(num_edges, Context(), NumBits());
+  IdArray eids = aten::NewIdArray(num_edges, Context(), NumBits());
+  IdType* indptr_data = indptr.Ptr<IdType>();
+  IdType* indices_data = indices.Ptr<IdType>();
+  IdType* eids_data = eids.Ptr<IdType>();
+
+  // the in-degree of every destination node, then its first edge
+  std::fill(indptr_data, indptr_data + dst_nodes + 1, 0);
+  for (size_t i = 0; i < etypes.size(); ++i) {
+    const IdType* csc_indptr = cscs[i].indptr.Ptr<IdType>();
+    IdType* deg = indptr_data + 1 + dsttype_offsets.at(meta_graph_->FindEdge(etypes[i]).second);
+    runtime::parallel_for(0, cscs[i].num_rows, [&](size_t b, size_t e) {
+      for (auto r = b; r < e; ++r)
+        deg[r] += csc_indptr[r + 1] - csc_indptr[r];
+    });
+  }
+  std::partial_sum(indptr_data, indptr_data + dst_nodes + 1, indptr_data);
+
+  // the edges of every destination node, by edge type
+  std::vector<IdType> pos(indptr_data, indptr_data + dst_nodes);
+  for (size_t i = 0; i < etypes.size(); ++i) {
+    const auto src_dsttype = meta_graph_->FindEdge(etypes[i]);
+    const IdType src_offset = srctype_offsets.at(src_dsttype.first);
+    const IdType edge_offset = edge_offsets[i];
+    IdType* dst_pos = pos.data() + dsttype_offsets.at(src_dsttype.second);
+    const IdType* csc_indptr = cscs[i].indptr.Ptr<IdType>();
+    const IdType* csc_indices = cscs[i].indices.Ptr<IdType>();
+    const IdType* csc_eids = aten::CSRHasData(cscs[i]) ? cscs[i].data.Ptr<IdType>() : nullptr;
+    runtime::parallel_for(0, cscs[i].num_rows, [&](size_t b, size_t e) {
+      for (auto r = b; r < e; ++r) {
+        IdType p = dst_pos[r];
+        for (IdType j = csc_indptr[r]; j < csc_indptr[r + 1]; ++j, ++p) {
+          indices_data[p] = csc_indices[j] + src_offset;
+          eids_data[p] = (csc_eids ? csc_eids[j] : j) + edge_offset;
+        }
+        dst_pos[r] = p;
+      }
+    });
+  }
+
+  return UnitGraph::CreateFromCSC(
+      num_vtypes, aten::CSRMatrix(dst_nodes, src_nodes, indptr, indices, eids));
 }
 
 template <class IdType>
@@ -467,20 +573,31 @@ FlattenedHeteroGraphPtr HeteroGraph::FlattenImpl(const std::vector<dgl_type_t>&
     size_t srctype_offset = srctype_offsets[srctype];
     size_t dsttype_offset = dsttype_offsets[dsttype];
 
-    EdgeArray edges = Edges(etype);
     size_t num_edges = NumEdges(etype);
-    src_arrs.push_back(edges.src + srctype_offset);
-    dst_arrs.push_back(edges.dst + dsttype_offset);
-    eid_arrs.push_back(edges.id);
+    if (Context().device_type == kDLCPU) {
+      // the edges of a type are in the order of their IDs in the flattened CSC
+      eid_arrs.push_back(aten::Range(0, num_edges, NumBits(), Context()));
+    } else {
+      EdgeArray edges = Edges(etype);
+      src_arrs.push_back(edges.src + srctype_offset);
+      dst_arrs.push_back(edges.dst + dsttype_offset);
+      eid_arrs.push_back(edges.id);
+    }
     induced_etypes.push_back(aten::Full(etype, num_edges, NumBits(), Context()));
   }
 
-  HeteroGraphPtr gptr = UnitGraph::CreateFromCOO(
-      homograph ? 1 : 2,
-      src_nodes,
-      dst_nodes,
-      aten::Concat(src_arrs),
-      aten::Concat(dst_arrs));
+  HeteroGraphPtr gptr;
+  if (Context().device_type == kDLCPU) {
+    gptr = FlattenCSC<IdType>(
+        etypes, homograph ? 1 : 2, src_nodes, dst_nodes, srctype_offsets, dsttype_offsets);
+  } else {
+    gptr = UnitGraph::CreateFromCOO(
+        homograph ? 1 : 2,
+        src_nodes,
+        dst_nodes,
+        aten::Concat(src_arrs),
+        aten::Concat(dst_arrs));
+  }
 
   // Sanity check
   CHECK_EQ(gptr->Context(), Context());
@@ -511,6 +628,8 @@ bool HeteroGraph::Load(dmlc::Stream* fs) {
   meta_graph_ = meta_imgraph;
   CHECK(fs->Read(&relation_graphs_)) << "Invalid relation_graphs_";
   CHECK(fs->Read(&num_verts_per_type_)) << "Invalid num_verts_per_type_";
+  std::lock_guard<std::mutex> lock(flattened_mutex_);
+  flattened_.clear();
   return true;
 }
 
@@ -13,8 +13,11 @@
 #include <utility>
 #include <string>
 #include <vector>
+#include <map>
+#include <mutex>
 #include <set>
 #include <tuple>
+#include <unordered_map>
 #include <memory>
 #include "./unit_graph.h"
 #include "shared_mem_manager.h"
@@ -58,6 +61,26 @@ class HeteroGraph : public BaseHeteroGraph {
     return relation_graphs_[0]->Context();
   }
 
+  bool IsPinned() const override {
+    for (const auto& relg : relation_graphs_) {
+      if (!relg->IsPinned())
+        return false;
+    }
+    return true;
+  }
+
+  /*! \brief Pin the structure of the relation graphs, see UnitGraph::PinMemory_. */
+  void PinMemory_(const DLContext& ctx, bool cache_indptr = false) {
+    for (const auto& relg : relation_graphs_)
+      relg->PinMemory_(ctx, cache_indptr);
+  }
+
+  /*! \brief Unpin the structure of the relation graphs, see UnitGraph::UnpinMemory_. */
+  void UnpinMemory_() {
+    for (const auto& relg : relation_graphs_)
+      relg->UnpinMemory_();
+  }
+
   uint8_t NumBits() const override {
     return relation_graphs_[0]->NumBits();
   }
@@ -192,6 +215,11 @@ class HeteroGraph : public BaseHeteroGraph {
     return GetRelationGraph(etype)->GetCSRMatrix(0);
   }
 
+  aten::KernelPlanCachePtr GetKernelPlanCache(
+      dgl_type_t etype, SparseFormat fmt) const override {
+    return GetRelationGraph(etype)->GetKernelPlanCache(0, fmt);
+  }
+
   SparseFormat SelectFormat(dgl_type_t etype, dgl_format_code_t preferred_formats) const override {
     return GetRelationGraph(etype)->SelectFormat(0, preferred_formats);
   }
@@ -211,6 +239,15 @@ class HeteroGraph : public BaseHeteroGraph {
 
   HeteroGraphPtr GetGraphInFormat(dgl_format_code_t formats) const override;
 
+  /*!
+   * \brief Return a copy of the graph with the formats created so far, unaffected
+   *        by the formats created later on this graph.
+   *
+   * The arrays are shared, so the copy can be read by another thread, e.g. to
+   * save it, while this graph keeps being used.
+   */
+  HeteroGraphPtr Snapshot() const;
+
   FlattenedHeteroGraphPtr Flatten(const std::vector<dgl_type_t>& etypes) const override;
 
   GraphPtr AsImmutableGraph() const override;
@@ -242,6 +279,30 @@ class HeteroGraph : public BaseHeteroGraph {
   static std::tuple<HeteroGraphPtr, std::vector<std::string>, std::vector<std::string>>
       CreateFromSharedMem(const std::string &name);
 
+  /*! \brief Copy the data to a buffer on its GPU, exported to the other processes by
+  *   CUDA IPC.
+  *
+  * The IPC handle of the buffer is published with the names of node types and edge
+  * types in the shared memory of the given name, so that the processes using the
+  * same GPU can open the graph by CreateFromCUDAIpc instead of copying it. The
+  * returned graph must outlive the graphs opened by the other processes.
+  */
+  static HeteroGraphPtr CopyToCUDAIpc(
+      HeteroGraphPtr g, const std::string& name, const std::vector<std::string>& ntypes,
+      const std::vector<std::string>& etypes, const std::set<std::string>& fmts);
+
+  /*! \brief Open a heterograph on a GPU exported by CopyToCUDAIpc in another process.
+  *   \return the HeteroGraphPtr, names of node types, names of edge types
+  */
+  static std::tuple<HeteroGraphPtr, std::vector<std::string>, std::vector<std::string>>
+      CreateFromCUDAIpc(const std::string &name);
+
+  /*! \brief Publish the formats created in a graph in shared memory that the
+  *   shared memory lacks, so that all the graphs attached to it can use them.
+  *   \return the graph using every format published in the shared memory
+  */
+  static HeteroGraphPtr SyncSharedMemFormats(HeteroGraphPtr g);
+
   /*! \brief Creat a LineGraph of self */
   HeteroGraphPtr LineGraph(bool backtracking) const;
 
@@ -262,12 +323,29 @@ class HeteroGraph : public BaseHeteroGraph {
   /*! \brief A map from vert type to the number of verts in the type */
   std::vector<int64_t> num_verts_per_type_;
 
-  /*! \brief The shared memory object for meta info*/
-  std::shared_ptr<runtime::SharedMemory> shared_mem_;
+  /*! \brief The shared memory segment holding the graph */
+  std::shared_ptr<SharedMemManager> shared_mem_;
+
+  /*! \brief The shared memory segment publishing the CUDA IPC handle of the graph */
+  NDArray ipc_segment_;
+
+  /*!
+   * \brief The flattened graphs of the lists of edge types asked for, built once
+   *        since the relation graphs are immutable, so that the formats created in
+   *        a flattened graph are reused too. Cleared when the graph is loaded.
+   */
+  mutable std::map<std::vector<dgl_type_t>, FlattenedHeteroGraphPtr> flattened_;
+  mutable std::mutex flattened_mutex_;
 
   /*! \brief The name of the shared memory. Return empty string if it is not in shared memory. */
   std::string SharedMemName() const;
 
+  /*! \brief Create the relation graph of an edge type from the formats published in
+  *   shared memory, completed by the ones created in the local relation graph if any.
+  */
+  static HeteroGraphPtr AttachRelationGraph(
+      const SharedMemManager& shm, dgl_type_t etype, const UnitGraphPtr& local);
+
   /*! \brief template class for Flatten operation
   * 
   * \tparam IdType Graph's index data type, can be int32_t or int64_t
@@ -276,6 +354,21 @@ class HeteroGraph : public BaseHeteroGraph {
   */
   template <class IdType>
   FlattenedHeteroGraphPtr FlattenImpl(const std::vector<dgl_type_t>& etypes) const;
+
+  /*!
+   * \brief Create the flattened unit graph of the edge types on CPU from the CSC
+   *        matrices of the relation graphs, whose rows are concatenated per
+   *        destination node, so that no COO is concatenated and sorted again.
+   *
+   * \param srctype_offsets The offset of the source nodes of every node type.
+   * \param dsttype_offsets The offset of the destination nodes of every node type.
+   */
+  template <class IdType>
+  HeteroGraphPtr FlattenCSC(
+      const std::vector<dgl_type_t>& etypes, int64_t num_vtypes,
+      int64_t src_nodes, int64_t dst_nodes,
+      const std::unordered_map<dgl_type_t, size_t>& srctype_offsets,
+      const std::unordered_map<dgl_type_t, size_t>& dsttype_offsets) const;
 };
 
 }  // namespace dgl
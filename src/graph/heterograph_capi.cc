@@ -34,6 +34,7 @@ DGL_REGISTER_GLOBAL("heterograph_index._CAPI_DGLHeteroCreateUnitGraphFromCOO")
     List<Value> formats = args[5];
     bool row_sorted = args[6];
     bool col_sorted = args[7];
+    bool trusted = args[8];
     std::vector<SparseFormat> formats_vec;
     for (Value val : formats) {
       std::string fmt = val->data;
@@ -41,7 +42,7 @@ DGL_REGISTER_GLOBAL("heterograph_index._CAPI_DGLHeteroCreateUnitGraphFromCOO")
     }
     const auto code = SparseFormatsToCode(formats_vec);
     auto hgptr = CreateFromCOO(nvtypes, num_src, num_dst, row, col,
-        row_sorted, col_sorted, code);
+        row_sorted, col_sorted, code, trusted);
     *rv = HeteroGraphRef(hgptr);
   });
 
@@ -55,6 +56,7 @@ DGL_REGISTER_GLOBAL("heterograph_index._CAPI_DGLHeteroCreateUnitGraphFromCSR")
     IdArray edge_ids = args[5];
     List<Value> formats = args[6];
     bool transpose = args[7];
+    bool sorted = args[8];
     std::vector<SparseFormat> formats_vec;
     for (Value val : formats) {
       std::string fmt = val->data;
@@ -62,10 +64,12 @@ DGL_REGISTER_GLOBAL("heterograph_index._CAPI_DGLHeteroCreateUnitGraphFromCSR")
     }
     const auto code = SparseFormatsToCode(formats_vec);
     if (!transpose) {
-      auto hgptr = CreateFromCSR(nvtypes, num_src, num_dst, indptr, indices, edge_ids, code);
+      auto hgptr = CreateFromCSR(
+          nvtypes, num_src, num_dst, indptr, indices, edge_ids, code, sorted);
       *rv = HeteroGraphRef(hgptr);
     } else {
-      auto hgptr = CreateFromCSC(nvtypes, num_src, num_dst, indptr, indices, edge_ids, code);
+      auto hgptr = CreateFromCSC(
+          nvtypes, num_src, num_dst, indptr, indices, edge_ids, code, sorted);
       *rv = HeteroGraphRef(hgptr);
     }
   });
@@ -473,6 +477,30 @@ DGL_REGISTER_GLOBAL("heterograph_index._CAPI_DGLHeteroCopyTo")
     *rv = HeteroGraphRef(hg_new);
   });
 
+DGL_REGISTER_GLOBAL("heterograph_index._CAPI_DGLHeteroPinMemory_")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    HeteroGraphRef hg = args[0];
+    int device_id = args[1];
+    const bool cache_indptr = args[2];
+    auto hg_ptr = std::dynamic_pointer_cast<HeteroGraph>(hg.sptr());
+    CHECK(hg_ptr) << "Only the heterographs can be pinned.";
+    hg_ptr->PinMemory_(DLContext{kDLGPU, device_id}, cache_indptr);
+  });
+
+DGL_REGISTER_GLOBAL("heterograph_index._CAPI_DGLHeteroUnpinMemory_")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    HeteroGraphRef hg = args[0];
+    auto hg_ptr = std::dynamic_pointer_cast<HeteroGraph>(hg.sptr());
+    CHECK(hg_ptr) << "Only the heterographs can be pinned.";
+    hg_ptr->UnpinMemory_();
+  });
+
+DGL_REGISTER_GLOBAL("heterograph_index._CAPI_DGLHeteroIsPinned")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    HeteroGraphRef hg = args[0];
+    *rv = hg->IsPinned();
+  });
+
 DGL_REGISTER_GLOBAL("heterograph_index._CAPI_DGLHeteroCopyToSharedMem")
 .set_body([] (DGLArgs args, DGLRetValue* rv) {
     HeteroGraphRef hg = args[0];
@@ -512,6 +540,51 @@ DGL_REGISTER_GLOBAL("heterograph_index._CAPI_DGLHeteroCreateFromSharedMem")
     *rv = ret;
   });
 
+DGL_REGISTER_GLOBAL("heterograph_index._CAPI_DGLHeteroCopyToCUDAIpc")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    HeteroGraphRef hg = args[0];
+    std::string name = args[1];
+    List<Value> ntypes = args[2];
+    List<Value> etypes = args[3];
+    List<Value> fmts = args[4];
+    auto ntypes_vec = ListValueToVector<std::string>(ntypes);
+    auto etypes_vec = ListValueToVector<std::string>(etypes);
+    std::set<std::string> fmts_set;
+    for (const auto &fmt : fmts) {
+      std::string fmt_data = fmt->data;
+      fmts_set.insert(fmt_data);
+    }
+    auto hg_share = HeteroGraph::CopyToCUDAIpc(
+        hg.sptr(), name, ntypes_vec, etypes_vec, fmts_set);
+    *rv = HeteroGraphRef(hg_share);
+  });
+
+DGL_REGISTER_GLOBAL("heterograph_index._CAPI_DGLHeteroCreateFromCUDAIpc")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    std::string name = args[0];
+    HeteroGraphPtr hg;
+    std::vector<std::string> ntypes;
+    std::vector<std::string> etypes;
+    std::tie(hg, ntypes, etypes) = HeteroGraph::CreateFromCUDAIpc(name);
+    List<Value> ntypes_list;
+    List<Value> etypes_list;
+    for (const auto &ntype : ntypes)
+      ntypes_list.push_back(Value(MakeValue(ntype)));
+    for (const auto &etype : etypes)
+      etypes_list.push_back(Value(MakeValue(etype)));
+    List<ObjectRef> ret;
+    ret.push_back(HeteroGraphRef(hg));
+    ret.push_back(ntypes_list);
+    ret.push_back(etypes_list);
+    *rv = ret;
+  });
+
+DGL_REGISTER_GLOBAL("heterograph_index._CAPI_DGLHeteroSyncSharedMemFormats")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    HeteroGraphRef hg = args[0];
+    *rv = HeteroGraphRef(HeteroGraph::SyncSharedMemFormats(hg.sptr()));
+  });
+
 DGL_REGISTER_GLOBAL("heterograph_index._CAPI_DGLHeteroJointUnion")
 .set_body([] (DGLArgs args, DGLRetValue* rv) {
     GraphRef meta_graph = args[0];
@@ -648,6 +721,27 @@ DGL_REGISTER_GLOBAL("heterograph_index._CAPI_DGLHeteroCreateFormat")
 #endif
 });
 
+DGL_REGISTER_GLOBAL("heterograph_index._CAPI_DGLHeteroSetFormatMemoryBudget")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    HeteroGraphRef hg = args[0];
+    const int64_t budget = args[1];
+    for (dgl_type_t etype = 0; etype < hg->NumEdgeTypes(); ++etype) {
+      auto bg = std::dynamic_pointer_cast<UnitGraph>(hg->GetRelationGraph(etype));
+      bg->SetFormatMemoryBudget(budget);
+    }
+});
+
+DGL_REGISTER_GLOBAL("heterograph_index._CAPI_DGLHeteroGetFormatMemoryUsage")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    HeteroGraphRef hg = args[0];
+    int64_t usage = 0;
+    for (dgl_type_t etype = 0; etype < hg->NumEdgeTypes(); ++etype) {
+      auto bg = std::dynamic_pointer_cast<UnitGraph>(hg->GetRelationGraph(etype));
+      usage += bg->GetFormatMemoryUsage();
+    }
+    *rv = usage;
+});
+
 DGL_REGISTER_GLOBAL("heterograph_index._CAPI_DGLHeteroGetFormatGraph")
 .set_body([] (DGLArgs args, DGLRetValue* rv) {
     HeteroGraphRef hg = args[0];
@@ -682,6 +776,43 @@ DGL_REGISTER_GLOBAL("subgraph._CAPI_DGLOutSubgraph")
     *rv = HeteroGraphRef(ret);
   });
 
+DGL_REGISTER_GLOBAL("subgraph._CAPI_DGLBatchedNodeSubgraph")
+.set_body([] (DGLArgs args, DGLRetValue *rv) {
+    HeteroGraphRef hg = args[0];
+    const auto& nodes = ListValueToVector<IdArray>(args[1]);
+    const auto& offsets = ListValueToVector<IdArray>(args[2]);
+    std::vector<IdArray> edge_offsets;
+    std::shared_ptr<HeteroSubgraph> subg(new HeteroSubgraph);
+    *subg = BatchedNodeSubgraph(hg.sptr(), nodes, offsets, &edge_offsets);
+    List<Value> edge_offsets_ref;
+    for (const IdArray& array : edge_offsets)
+      edge_offsets_ref.push_back(Value(MakeValue(array)));
+    List<ObjectRef> ret;
+    ret.push_back(HeteroSubgraphRef(subg));
+    ret.push_back(edge_offsets_ref);
+    *rv = ret;
+  });
+
+DGL_REGISTER_GLOBAL("subgraph._CAPI_DGLBatchedKHopSubgraph")
+.set_body([] (DGLArgs args, DGLRetValue *rv) {
+    HeteroGraphRef hg = args[0];
+    IdArray seeds = args[1];
+    IdArray seed_offsets = args[2];
+    int64_t num_hops = args[3];
+    const std::string direction = args[4];
+    IdArray node_offsets, edge_offsets;
+    NDArray dists;
+    std::shared_ptr<HeteroSubgraph> subg(new HeteroSubgraph);
+    *subg = BatchedKHopSubgraph(hg.sptr(), seeds, seed_offsets, num_hops, direction,
+                                &node_offsets, &edge_offsets, &dists);
+    List<ObjectRef> ret;
+    ret.push_back(HeteroSubgraphRef(subg));
+    ret.push_back(Value(MakeValue(node_offsets)));
+    ret.push_back(Value(MakeValue(edge_offsets)));
+    ret.push_back(Value(MakeValue(dists)));
+    *rv = ret;
+  });
+
 DGL_REGISTER_GLOBAL("transform._CAPI_DGLAsImmutableGraph")
 .set_body([] (DGLArgs args, DGLRetValue* rv) {
     HeteroGraphRef hg = args[0];
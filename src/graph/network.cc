@@ -20,6 +20,7 @@
 #include "../rpc/network/socket_communicator.h"
 #include "../rpc/network/msg_queue.h"
 #include "../rpc/network/common.h"
+#include "../array/cpu/array_row_copy.h"
 
 using dgl::network::StringPrintf;
 using namespace dgl::runtime;
@@ -206,7 +207,22 @@ DGL_REGISTER_GLOBAL("network._CAPI_DGLSenderCreate")
     int64_t msg_queue_size = args[1];
     network::Sender* sender = nullptr;
     if (type == "socket") {
-      sender = new network::SocketSender(msg_queue_size, 0);
+      auto* socket_sender = new network::SocketSender(msg_queue_size, 0);
+      // Batch the small messages of a send thread for up to a delay
+      const char* delay_str = getenv("DGL_SOCKET_SEND_DELAY_US");
+      const char* bytes_str = getenv("DGL_SOCKET_SEND_BATCH_BYTES");
+      if (delay_str) {
+        socket_sender->SetBatching(atoll(delay_str),
+                                   bytes_str ? atoll(bytes_str) : 1 << 20);
+      }
+      // Stripe the large messages on parallel connections to each receiver
+      const char* stripes_str = getenv("DGL_SOCKET_NUM_STRIPES");
+      const char* stripe_bytes_str = getenv("DGL_SOCKET_STRIPE_MIN_BYTES");
+      if (stripes_str) {
+        socket_sender->SetStriping(atoi(stripes_str),
+                                   stripe_bytes_str ? atoll(stripe_bytes_str) : 4 << 20);
+      }
+      sender = socket_sender;
     } else {
       LOG(FATAL) << "Unknown communicator type: " << type;
     }
@@ -220,7 +236,12 @@ DGL_REGISTER_GLOBAL("network._CAPI_DGLReceiverCreate")
     int64_t msg_queue_size = args[1];
     network::Receiver* receiver = nullptr;
     if (type == "socket") {
-      receiver = new network::SocketReceiver(msg_queue_size, 0);
+      auto* socket_receiver = new network::SocketReceiver(msg_queue_size, 0);
+      const char* stripes_str = getenv("DGL_SOCKET_NUM_STRIPES");
+      if (stripes_str) {
+        socket_receiver->SetStriping(atoi(stripes_str));
+      }
+      receiver = socket_receiver;
     } else {
       LOG(FATAL) << "Unknown communicator type: " << type;
     }
@@ -830,16 +851,10 @@ DGL_REGISTER_GLOBAL("network._CAPI_FastPull")
     char *return_data = new char[ID_size*row_size];
     const int64_t local_ids_size = local_ids.size();
     // Copy local data
-    runtime::parallel_for(0, local_ids_size, [&](size_t b, size_t e) {
-      for (auto i = b; i < e; ++i) {
-        CHECK_GE(ID_size*row_size, local_ids_orginal[i] * row_size + row_size);
-        CHECK_GE(data_size, local_ids[i] * row_size + row_size);
-        CHECK_GE(local_ids[i], 0);
-        memcpy(return_data + local_ids_orginal[i] * row_size,
-               local_data_char + local_ids[i] * row_size,
-               row_size);
-      }
-    });
+    aten::impl::CopyRows<int64_t>(
+        local_data_char, local_ids.data(), local_data_shape[0],
+        return_data, local_ids_orginal.data(), ID_size,
+        local_ids_size, row_size);
     // Recv remote message
     for (int i = 0; i < msg_count; ++i) {
       KVStoreMsg *kv_msg = recv_kv_message(receiver);
@@ -0,0 +1,240 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file graph/sampling/layer/layer.cc
+ * \brief Definition of layer-wise importance sampler APIs.
+ */
+
+#include <dgl/runtime/container.h>
+#include <dgl/runtime/parallel_for.h>
+#include <dgl/packed_func_ext.h>
+#include <dgl/array.h>
+#include <dgl/aten/macro.h>
+#include <dgl/immutable_graph.h>
+#include <dgl/random.h>
+#include <dgl/sampling/layer.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "../../../array/cpu/array_utils.h"
+#include "../../../c_api_common.h"
+#include "../../../runtime/arena.h"
+
+using namespace dgl::runtime;
+using namespace dgl::aten;
+
+namespace dgl {
+namespace sampling {
+
+namespace {
+
+template <typename IdType, typename FloatType>
+LayerSampledBlocks SampleLayerBlocksCPU(
+    const HeteroGraphPtr hg,
+    IdArray seeds,
+    const std::vector<int64_t>& num_samples,
+    FloatArray weight,
+    LayerImportance importance,
+    bool replace) {
+  const int64_t num_layers = num_samples.size();
+  const CSRMatrix csc = hg->GetCSCMatrix(0);
+  const CSRMatrix csr = importance == LayerImportance::kFastGCN ?
+    hg->GetCSRMatrix(0) : CSRMatrix();
+  const FloatType* weight_data = IsNullArray(weight) ? nullptr : weight.Ptr<FloatType>();
+  LayerSampledBlocks ret;
+  ret.blocks.resize(num_layers);
+  ret.src_nodes.resize(num_layers);
+  ret.induced_edges.resize(num_layers);
+  ret.edge_weights.resize(num_layers);
+
+  // The input nodes of a layer start with its output nodes and are the output
+  // nodes of the previous layer, so that a single map relabels all the layers.
+  ArenaScope arena_scope;
+  IdHashMap<IdType, ArenaAllocator<IdType>> node_map;
+  node_map.Update(seeds);
+  IdArray dst_nodes = node_map.Values();
+
+  const auto meta_graph = ImmutableGraph::CreateFromCOO(
+      2, VecToIdArray(std::vector<int64_t>({0})), VecToIdArray(std::vector<int64_t>({1})));
+
+  for (int64_t layer = num_layers - 1; layer >= 0; --layer) {
+    ArenaScope layer_scope;
+    const int64_t num_dst = node_map.Size();
+    // The in-edges of the output nodes, and their source nodes as the candidates.
+    const CSRMatrix sub = CSRSliceRows(csc, dst_nodes);
+    const IdType* sub_indptr = sub.indptr.Ptr<IdType>();
+    const IdType* sub_eids = sub.data.Ptr<IdType>();
+    IdHashMap<IdType, ArenaAllocator<IdType>> cand_map(sub.indices);
+    const IdArray cands = cand_map.Values();
+    const IdArray cand_cols = cand_map.Map(sub.indices, -1);
+    const IdType* cands_data = cands.Ptr<IdType>();
+    const IdType* cand_cols_data = cand_cols.Ptr<IdType>();
+    const int64_t num_cands = cands->shape[0];
+    const int64_t nnz = sub.indices->shape[0];
+
+    // The importance of the candidates, i.e. the squared column norms of the
+    // adjacency matrix restricted to the output nodes for LADIES, of the whole
+    // adjacency matrix for FastGCN.
+    FloatArray cand_prob = NDArray::Empty({num_cands}, weight->dtype, weight->ctx);
+    FloatType* prob_data = cand_prob.Ptr<FloatType>();
+    if (importance == LayerImportance::kLADIES) {
+      std::fill(prob_data, prob_data + num_cands, 0);
+      for (int64_t j = 0; j < nnz; ++j) {
+        const FloatType w = weight_data ? weight_data[sub_eids[j]] : 1;
+        prob_data[cand_cols_data[j]] += w * w;
+      }
+    } else {
+      const IdType* csr_indptr = csr.indptr.Ptr<IdType>();
+      const IdType* csr_eids = CSRHasData(csr) ? csr.data.Ptr<IdType>() : nullptr;
+      parallel_for(0, num_cands, [&](size_t b, size_t e) {
+        for (size_t c = b; c < e; ++c) {
+          const IdType u = cands_data[c];
+          if (!weight_data) {
+            prob_data[c] = csr_indptr[u + 1] - csr_indptr[u];
+            continue;
+          }
+          FloatType norm = 0;
+          for (IdType k = csr_indptr[u]; k < csr_indptr[u + 1]; ++k) {
+            const FloatType w = weight_data[csr_eids ? csr_eids[k] : k];
+            norm += w * w;
+          }
+          prob_data[c] = norm;
+        }
+      });
+    }
+
+    // Draw the input nodes among the candidates.
+    uint8_t* selected = layer_scope.arena()->Alloc<uint8_t>(num_cands);
+    std::fill(selected, selected + num_cands, 0);
+    const int64_t num_picks = replace ? num_samples[layer] :
+      std::min<int64_t>(num_samples[layer], num_cands);
+    if (num_cands > 0 && num_picks > 0) {
+      if (!replace && num_picks == num_cands) {
+        std::fill(selected, selected + num_cands, 1);
+      } else {
+        IdType* picked = layer_scope.arena()->Alloc<IdType>(num_picks);
+        RandomEngine::ThreadLocal()->Choice<IdType, FloatType>(
+            num_picks, cand_prob, picked, replace);
+        for (int64_t i = 0; i < num_picks; ++i)
+          selected[picked[i]] = 1;
+      }
+    }
+    const int64_t num_drawn = std::count(selected, selected + num_cands, 1);
+    IdArray drawn = NewIdArray(num_drawn, cands->ctx, sizeof(IdType) * 8);
+    IdType* drawn_data = drawn.Ptr<IdType>();
+    for (int64_t c = 0, k = 0; c < num_cands; ++c) {
+      if (selected[c])
+        drawn_data[k++] = cands_data[c];
+    }
+    node_map.Update(drawn);
+
+    // Keep the edges coming from the drawn nodes, debiased by the importance
+    // of their source and normalized over the in-edges of every output node.
+    std::vector<IdType> new_src, new_dst, eids;
+    std::vector<FloatType> weights;
+    for (int64_t i = 0; i < num_dst; ++i) {
+      const size_t row_start = weights.size();
+      FloatType row_sum = 0;
+      for (IdType j = sub_indptr[i]; j < sub_indptr[i + 1]; ++j) {
+        const IdType c = cand_cols_data[j];
+        if (!selected[c] || prob_data[c] <= 0)
+          continue;
+        const FloatType w = (weight_data ? weight_data[sub_eids[j]] : 1) / prob_data[c];
+        new_src.push_back(node_map.Map(cands_data[c], -1));
+        new_dst.push_back(i);
+        eids.push_back(sub_eids[j]);
+        weights.push_back(w);
+        row_sum += w;
+      }
+      if (row_sum > 0) {
+        for (size_t k = row_start; k < weights.size(); ++k)
+          weights[k] /= row_sum;
+      }
+    }
+
+    const int64_t num_src = node_map.Size();
+    const HeteroGraphPtr rel_graph = CreateFromCOO(
+        2, num_src, num_dst,
+        VecToIdArray(new_src, sizeof(IdType) * 8),
+        VecToIdArray(new_dst, sizeof(IdType) * 8));
+    ret.blocks[layer] = CreateHeteroGraph(meta_graph, {rel_graph}, {num_src, num_dst});
+    ret.induced_edges[layer] = VecToIdArray(eids, sizeof(IdType) * 8);
+    ret.edge_weights[layer] = NDArray::FromVector(weights);
+    dst_nodes = node_map.Values();
+    ret.src_nodes[layer] = dst_nodes;
+  }
+  return ret;
+}
+
+}  // namespace
+
+LayerSampledBlocks SampleLayerBlocks(
+    const HeteroGraphPtr hg,
+    IdArray seeds,
+    const std::vector<int64_t>& num_samples,
+    FloatArray weight,
+    LayerImportance importance,
+    bool replace) {
+  CHECK_EQ(hg->NumVertexTypes(), 1)
+    << "Layer-wise sampling only supports graphs with a single node type.";
+  CHECK_EQ(hg->NumEdgeTypes(), 1)
+    << "Layer-wise sampling only supports graphs with a single edge type.";
+  CHECK_EQ(hg->Context().device_type, kDLCPU)
+    << "Layer-wise sampling only supports CPU graphs.";
+  CHECK_EQ(seeds->dtype.bits, hg->DataType().bits)
+    << "The seed nodes must have the same ID type as the graph.";
+  if (IsNullArray(weight)) {
+    weight = NDArray::Empty({0}, DLDataType{kDLFloat, 32, 1}, hg->Context());
+  } else {
+    CHECK_EQ(weight->shape[0], hg->NumEdges(0))
+      << "The edge weights must have one value per edge.";
+  }
+  LayerSampledBlocks ret;
+  ATEN_ID_TYPE_SWITCH(hg->DataType(), IdType, {
+    ATEN_FLOAT_TYPE_SWITCH(weight->dtype, FloatType, "weight", {
+      ret = SampleLayerBlocksCPU<IdType, FloatType>(
+          hg, seeds, num_samples, weight, importance, replace);
+    });
+  });
+  return ret;
+}
+
+DGL_REGISTER_GLOBAL("sampling.layer._CAPI_DGLSampleLayerBlocks")
+.set_body([] (DGLArgs args, DGLRetValue *rv) {
+    HeteroGraphRef hg = args[0];
+    IdArray seeds = args[1];
+    IdArray num_samples_array = args[2];
+    FloatArray weight = args[3];
+    const std::string importance_str = args[4];
+    const bool replace = args[5];
+
+    CHECK_INT64(num_samples_array, "num_samples");
+    LayerImportance importance;
+    if (importance_str == "ladies")
+      importance = LayerImportance::kLADIES;
+    else if (importance_str == "fastgcn")
+      importance = LayerImportance::kFastGCN;
+    else
+      LOG(FATAL) << "Unknown layer importance " << importance_str;
+
+    const LayerSampledBlocks sampled = SampleLayerBlocks(
+        hg.sptr(), seeds, num_samples_array.ToVector<int64_t>(), weight, importance, replace);
+
+    List<HeteroGraphRef> blocks_ref;
+    List<Value> src_nodes_ref, induced_edges_ref, edge_weights_ref;
+    for (size_t layer = 0; layer < sampled.blocks.size(); ++layer) {
+      blocks_ref.push_back(HeteroGraphRef(sampled.blocks[layer]));
+      src_nodes_ref.push_back(Value(MakeValue(sampled.src_nodes[layer])));
+      induced_edges_ref.push_back(Value(MakeValue(sampled.induced_edges[layer])));
+      edge_weights_ref.push_back(Value(MakeValue(sampled.edge_weights[layer])));
+    }
+
+    List<ObjectRef> ret;
+    ret.push_back(blocks_ref);
+    ret.push_back(src_nodes_ref);
+    ret.push_back(induced_edges_ref);
+    ret.push_back(edge_weights_ref);
+    *rv = ret;
+  });
+
+}  // namespace sampling
+}  // namespace dgl
@@ -0,0 +1,97 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file graph/sampling/negative/negative.cc
+ * \brief Definition of negative sampling APIs.
+ */
+
+#include <dgl/runtime/container.h>
+#include <dgl/packed_func_ext.h>
+#include <dgl/array.h>
+#include <dgl/sampling/negative.h>
+#include <utility>
+#include <vector>
+#include "../../../c_api_common.h"
+#include "negative_impl.h"
+
+using namespace dgl::runtime;
+using namespace dgl::aten;
+
+namespace dgl {
+namespace sampling {
+
+std::vector<COOMatrix> CorruptEdges(
+    const HeteroGraphPtr hg,
+    const std::vector<IdArray>& eids,
+    int64_t k,
+    bool corrupt_src,
+    const std::vector<FloatArray>& prob,
+    int64_t num_trials) {
+  CHECK_EQ(eids.size(), hg->NumEdgeTypes())
+    << "Number of edge ID tensors must match the number of edge types.";
+  CHECK_EQ(prob.size(), hg->NumEdgeTypes())
+    << "Number of probability tensors must match the number of edge types.";
+  CHECK_GE(k, 0) << "The number of negative edges must be non-negative.";
+  CHECK_GE(num_trials, 0) << "The number of trials must be non-negative.";
+
+  std::vector<COOMatrix> ret(hg->NumEdgeTypes());
+  for (dgl_type_t etype = 0; etype < hg->NumEdgeTypes(); ++etype) {
+    const auto pair = hg->meta_graph()->FindEdge(etype);
+    const int64_t num_src = hg->NumVertices(pair.first);
+    const int64_t num_dst = hg->NumVertices(pair.second);
+    IdArray fixed;
+    if (IsNullArray(eids[etype])) {
+      fixed = NewIdArray(0, hg->Context(), hg->NumBits());
+    } else {
+      const EdgeArray edges = hg->FindEdges(etype, eids[etype]);
+      fixed = corrupt_src ? edges.dst : edges.src;
+    }
+    if (!IsNullArray(prob[etype])) {
+      CHECK_FLOAT(prob[etype], "probability");
+      CHECK_EQ(prob[etype]->ctx.device_type, hg->Context().device_type)
+        << "The weights of the nodes must be on the device of the graph.";
+    }
+    // the rows of the matrix are the fixed ends
+    CSRMatrix adj;
+    if (num_trials > 0 && fixed->shape[0] > 0)
+      adj = corrupt_src ? hg->GetCSCMatrix(etype) : hg->GetCSRMatrix(etype);
+
+    std::pair<IdArray, IdArray> result;
+    ATEN_XPU_SWITCH_CUDA(hg->Context().device_type, XPU, "CorruptEdges", {
+      ATEN_ID_TYPE_SWITCH(hg->DataType(), IdxType, {
+        const DLDataType float_type = IsNullArray(prob[etype]) ?
+          DLDataType{kDLFloat, 32, 1} : prob[etype]->dtype;
+        ATEN_FLOAT_TYPE_SWITCH(float_type, FloatType, "probability", {
+          result = impl::CorruptEdges<XPU, IdxType, FloatType>(
+              fixed, corrupt_src ? num_src : num_dst, k, prob[etype], adj,
+              adj.indptr.defined() ? num_trials : 0);
+        });
+      });
+    });
+    ret[etype] = corrupt_src ?
+      COOMatrix(num_src, num_dst, result.second, result.first) :
+      COOMatrix(num_src, num_dst, result.first, result.second);
+  }
+  return ret;
+}
+
+DGL_REGISTER_GLOBAL("sampling.negative._CAPI_DGLCorruptEdges")
+.set_body([] (DGLArgs args, DGLRetValue *rv) {
+    HeteroGraphRef hg = args[0];
+    const auto& eids = ListValueToVector<IdArray>(args[1]);
+    const int64_t k = args[2];
+    const bool corrupt_src = args[3];
+    const auto& prob = ListValueToVector<FloatArray>(args[4]);
+    const int64_t num_trials = args[5];
+
+    const std::vector<COOMatrix> negs = CorruptEdges(
+        hg.sptr(), eids, k, corrupt_src, prob, num_trials);
+    List<Value> ret;
+    for (const COOMatrix& neg : negs) {
+      ret.push_back(Value(MakeValue(neg.row)));
+      ret.push_back(Value(MakeValue(neg.col)));
+    }
+    *rv = ret;
+  });
+
+}  // namespace sampling
+}  // namespace dgl
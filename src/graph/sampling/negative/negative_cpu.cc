@@ -0,0 +1,118 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file graph/sampling/negative/negative_cpu.cc
+ * \brief DGL sampler - CPU implementation of negative sampling
+ */
+
+#include <dgl/array.h>
+#include <dgl/random.h>
+#include <dgl/runtime/parallel_for.h>
+#include <algorithm>
+#include <numeric>
+#include <utility>
+#include <vector>
+#include "negative_impl.h"
+
+namespace dgl {
+
+using namespace dgl::runtime;
+using namespace dgl::aten;
+
+namespace sampling {
+
+namespace impl {
+
+template<DLDeviceType XPU, typename IdxType, typename FloatType>
+std::pair<IdArray, IdArray> CorruptEdges(
+    IdArray fixed,
+    int64_t num_nodes,
+    int64_t k,
+    FloatArray prob,
+    const CSRMatrix& adj,
+    int64_t num_trials) {
+  const auto& ctx = fixed->ctx;
+  const uint8_t nbits = fixed->dtype.bits;
+  const int64_t num_samples = fixed->shape[0] * k;
+  const IdxType* fixed_data = fixed.Ptr<IdxType>();
+  IdArray ret_fixed = NewIdArray(num_samples, ctx, nbits);
+  IdArray ret_corrupted = NewIdArray(num_samples, ctx, nbits);
+  if (num_samples == 0)
+    return std::make_pair(ret_fixed, ret_corrupted);
+  CHECK_GT(num_nodes, 0) << "There are no nodes to corrupt the edges with.";
+
+  // the cumulative weights of the nodes, to draw them by binary search
+  std::vector<FloatType> cdf;
+  if (!IsNullArray(prob)) {
+    CHECK_EQ(prob->shape[0], num_nodes)
+      << "There must be one weight for each node of the corrupted type.";
+    const FloatType* prob_data = prob.Ptr<FloatType>();
+    cdf.resize(num_nodes);
+    std::partial_sum(prob_data, prob_data + num_nodes, cdf.begin());
+    CHECK_GT(cdf.back(), 0) << "The weights of the nodes must not be all zero.";
+  }
+  auto draw = [&cdf, num_nodes](RandomEngine* re) -> IdxType {
+    if (cdf.empty())
+      return re->RandInt<IdxType>(num_nodes);
+    const FloatType r = re->Uniform<FloatType>(0, cdf.back());
+    const int64_t node = std::upper_bound(cdf.begin(), cdf.end(), r) - cdf.begin();
+    return std::min(node, num_nodes - 1);
+  };
+  const IdxType* indptr = num_trials > 0 ? adj.indptr.Ptr<IdxType>() : nullptr;
+  const IdxType* indices = num_trials > 0 ? adj.indices.Ptr<IdxType>() : nullptr;
+  auto exists = [indptr, indices, &adj](IdxType u, IdxType v) {
+    const IdxType* begin = indices + indptr[u];
+    const IdxType* end = indices + indptr[u + 1];
+    return adj.sorted ? std::binary_search(begin, end, v) : (std::find(begin, end, v) != end);
+  };
+
+  IdxType* ret_fixed_data = ret_fixed.Ptr<IdxType>();
+  IdxType* ret_corrupted_data = ret_corrupted.Ptr<IdxType>();
+  // whether each negative edge is kept
+  std::vector<int8_t> kept(num_samples, 1);
+  parallel_for(0, num_samples, [&](size_t b, size_t e) {
+    RandomEngine* re = RandomEngine::ThreadLocal();
+    for (size_t i = b; i < e; ++i) {
+      const IdxType u = fixed_data[i / k];
+      ret_fixed_data[i] = u;
+      ret_corrupted_data[i] = draw(re);
+      if (num_trials == 0)
+        continue;
+      for (int64_t trial = 1; exists(u, ret_corrupted_data[i]); ++trial) {
+        if (trial == num_trials) {
+          kept[i] = 0;
+          break;
+        }
+        ret_corrupted_data[i] = draw(re);
+      }
+    }
+  });
+  if (num_trials == 0)
+    return std::make_pair(ret_fixed, ret_corrupted);
+
+  // drop the negative edges that exist
+  int64_t num_kept = 0;
+  for (int64_t i = 0; i < num_samples; ++i) {
+    if (kept[i]) {
+      ret_fixed_data[num_kept] = ret_fixed_data[i];
+      ret_corrupted_data[num_kept] = ret_corrupted_data[i];
+      ++num_kept;
+    }
+  }
+  return std::make_pair(ret_fixed.CreateView({num_kept}, ret_fixed->dtype),
+                        ret_corrupted.CreateView({num_kept}, ret_corrupted->dtype));
+}
+
+template std::pair<IdArray, IdArray> CorruptEdges<kDLCPU, int32_t, float>(
+    IdArray, int64_t, int64_t, FloatArray, const CSRMatrix&, int64_t);
+template std::pair<IdArray, IdArray> CorruptEdges<kDLCPU, int32_t, double>(
+    IdArray, int64_t, int64_t, FloatArray, const CSRMatrix&, int64_t);
+template std::pair<IdArray, IdArray> CorruptEdges<kDLCPU, int64_t, float>(
+    IdArray, int64_t, int64_t, FloatArray, const CSRMatrix&, int64_t);
+template std::pair<IdArray, IdArray> CorruptEdges<kDLCPU, int64_t, double>(
+    IdArray, int64_t, int64_t, FloatArray, const CSRMatrix&, int64_t);
+
+}  // namespace impl
+
+}  // namespace sampling
+
+}  // namespace dgl
@@ -0,0 +1,194 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file graph/sampling/negative/negative_gpu.cu
+ * \brief DGL sampler - GPU implementation of negative sampling
+ */
+
+#include <dgl/array.h>
+#include <dgl/random.h>
+#include <dgl/runtime/device_api.h>
+#include <curand_kernel.h>
+#include <utility>
+#include "../../../array/cuda/dgl_cub.cuh"
+#include "../../../array/cuda/utils.h"
+#include "../../../runtime/cuda/cuda_common.h"
+#include "../../../runtime/workspace.h"
+#include "negative_impl.h"
+
+namespace dgl {
+
+using namespace dgl::runtime;
+using namespace dgl::aten;
+
+namespace sampling {
+
+namespace impl {
+
+namespace {
+
+/*!
+ * \brief Whether v is in the row u of the matrix, by binary search if the rows
+ *        are sorted.
+ */
+template <typename IdType>
+__device__ __forceinline__ bool _HasEdge(
+    const IdType* indptr, const IdType* indices, bool sorted, IdType u, IdType v) {
+  IdType begin = indptr[u], end = indptr[u + 1];
+  if (!sorted) {
+    for (; begin < end; ++begin) {
+      if (indices[begin] == v)
+        return true;
+    }
+    return false;
+  }
+  while (begin < end) {
+    const IdType mid = begin + ((end - begin) >> 1);
+    if (indices[mid] < v)
+      begin = mid + 1;
+    else
+      end = mid;
+  }
+  return begin < indptr[u + 1] && indices[begin] == v;
+}
+
+/*!
+ * \brief Draw a node uniformly, or by binary search over the cumulative weights
+ *        if given.
+ */
+template <typename IdType, typename FloatType>
+__device__ __forceinline__ IdType _DrawNode(
+    curandState* rng, int64_t num_nodes, const FloatType* cdf) {
+  if (!cdf)
+    return curand(rng) % num_nodes;
+  // curand_uniform is in (0, 1]
+  const FloatType r = (1 - curand_uniform(rng)) * cdf[num_nodes - 1];
+  int64_t begin = 0, end = num_nodes - 1;
+  while (begin < end) {
+    const int64_t mid = begin + ((end - begin) >> 1);
+    if (cdf[mid] <= r)
+      begin = mid + 1;
+    else
+      end = mid;
+  }
+  return begin;
+}
+
+/*!
+ * \brief Corrupt the edges, drawing a negative edge again while it exists up to
+ *        num_trials draws if num_trials > 0, flagging the ones kept.
+ */
+template <typename IdType, typename FloatType>
+__global__ void _CorruptEdgesKernel(
+    const uint64_t rand_seed, const IdType* fixed, int64_t num_samples, int64_t k,
+    int64_t num_nodes, const FloatType* cdf,
+    const IdType* indptr, const IdType* indices, bool sorted, int64_t num_trials,
+    IdType* out_fixed, IdType* out_corrupted, int8_t* kept) {
+  int64_t tx = blockIdx.x * blockDim.x + threadIdx.x;
+  const int64_t stride_x = gridDim.x * blockDim.x;
+  curandState rng;
+  curand_init(rand_seed, tx, 0, &rng);
+  while (tx < num_samples) {
+    const IdType u = fixed[tx / k];
+    IdType v = _DrawNode<IdType>(&rng, num_nodes, cdf);
+    bool keep = true;
+    if (num_trials > 0) {
+      for (int64_t trial = 1; _HasEdge(indptr, indices, sorted, u, v); ++trial) {
+        if (trial == num_trials) {
+          keep = false;
+          break;
+        }
+        v = _DrawNode<IdType>(&rng, num_nodes, cdf);
+      }
+      kept[tx] = keep;
+    }
+    out_fixed[tx] = u;
+    out_corrupted[tx] = v;
+    tx += stride_x;
+  }
+}
+
+}  // namespace
+
+template<DLDeviceType XPU, typename IdxType, typename FloatType>
+std::pair<IdArray, IdArray> CorruptEdges(
+    IdArray fixed,
+    int64_t num_nodes,
+    int64_t k,
+    FloatArray prob,
+    const CSRMatrix& adj,
+    int64_t num_trials) {
+  const auto& ctx = fixed->ctx;
+  auto device = runtime::DeviceAPI::Get(ctx);
+  cudaStream_t stream = runtime::CUDAThreadEntry::ThreadLocal()->stream;
+  const uint8_t nbits = fixed->dtype.bits;
+  const int64_t num_samples = fixed->shape[0] * k;
+  IdArray ret_fixed = NewIdArray(num_samples, ctx, nbits);
+  IdArray ret_corrupted = NewIdArray(num_samples, ctx, nbits);
+  if (num_samples == 0)
+    return std::make_pair(ret_fixed, ret_corrupted);
+  CHECK_GT(num_nodes, 0) << "There are no nodes to corrupt the edges with.";
+
+  // the cumulative weights of the nodes, to draw them by binary search
+  Workspace<FloatType> cdf(device, ctx, IsNullArray(prob) ? 1 : num_nodes);
+  if (!IsNullArray(prob)) {
+    CHECK_EQ(prob->shape[0], num_nodes)
+      << "There must be one weight for each node of the corrupted type.";
+    size_t scan_workspace_size = 0;
+    CUDA_CALL(cub::DeviceScan::InclusiveSum(nullptr, scan_workspace_size,
+        prob.Ptr<FloatType>(), cdf.get(), num_nodes, stream));
+    Workspace<void> scan_workspace(device, ctx, scan_workspace_size);
+    CUDA_CALL(cub::DeviceScan::InclusiveSum(scan_workspace.get(), scan_workspace_size,
+        prob.Ptr<FloatType>(), cdf.get(), num_nodes, stream));
+  }
+
+  Workspace<int8_t> kept(device, ctx, num_trials > 0 ? num_samples : 1);
+  const uint64_t random_seed = RandomEngine::ThreadLocal()->RandInt(1000000000);
+  const int nt = cuda::FindNumThreads(num_samples);
+  const int nb = (num_samples + nt - 1) / nt;
+  CUDA_KERNEL_CALL((_CorruptEdgesKernel<IdxType, FloatType>), nb, nt, 0, stream,
+      random_seed, fixed.Ptr<IdxType>(), num_samples, k, num_nodes,
+      IsNullArray(prob) ? nullptr : cdf.get(),
+      num_trials > 0 ? adj.indptr.Ptr<IdxType>() : nullptr,
+      num_trials > 0 ? adj.indices.Ptr<IdxType>() : nullptr,
+      adj.sorted, num_trials,
+      ret_fixed.Ptr<IdxType>(), ret_corrupted.Ptr<IdxType>(), kept.get());
+  if (num_trials == 0)
+    return std::make_pair(ret_fixed, ret_corrupted);
+
+  // drop the negative edges that exist
+  IdArray kept_fixed = NewIdArray(num_samples, ctx, nbits);
+  IdArray kept_corrupted = NewIdArray(num_samples, ctx, nbits);
+  Workspace<int64_t> d_num_kept(device, ctx, 1);
+  size_t select_workspace_size = 0;
+  CUDA_CALL(cub::DeviceSelect::Flagged(nullptr, select_workspace_size,
+      ret_fixed.Ptr<IdxType>(), kept.get(), kept_fixed.Ptr<IdxType>(),
+      d_num_kept.get(), num_samples, stream));
+  Workspace<void> select_workspace(device, ctx, select_workspace_size);
+  CUDA_CALL(cub::DeviceSelect::Flagged(select_workspace.get(), select_workspace_size,
+      ret_fixed.Ptr<IdxType>(), kept.get(), kept_fixed.Ptr<IdxType>(),
+      d_num_kept.get(), num_samples, stream));
+  CUDA_CALL(cub::DeviceSelect::Flagged(select_workspace.get(), select_workspace_size,
+      ret_corrupted.Ptr<IdxType>(), kept.get(), kept_corrupted.Ptr<IdxType>(),
+      d_num_kept.get(), num_samples, stream));
+  int64_t num_kept;
+  device->CopyDataFromTo(d_num_kept.get(), 0, &num_kept, 0, sizeof(int64_t),
+                         ctx, DGLContext{kDLCPU, 0}, DLDataType{kDLInt, 64, 1}, stream);
+  device->StreamSync(ctx, stream);
+  return std::make_pair(kept_fixed.CreateView({num_kept}, kept_fixed->dtype),
+                        kept_corrupted.CreateView({num_kept}, kept_corrupted->dtype));
+}
+
+template std::pair<IdArray, IdArray> CorruptEdges<kDLGPU, int32_t, float>(
+    IdArray, int64_t, int64_t, FloatArray, const CSRMatrix&, int64_t);
+template std::pair<IdArray, IdArray> CorruptEdges<kDLGPU, int32_t, double>(
+    IdArray, int64_t, int64_t, FloatArray, const CSRMatrix&, int64_t);
+template std::pair<IdArray, IdArray> CorruptEdges<kDLGPU, int64_t, float>(
+    IdArray, int64_t, int64_t, FloatArray, const CSRMatrix&, int64_t);
+template std::pair<IdArray, IdArray> CorruptEdges<kDLGPU, int64_t, double>(
+    IdArray, int64_t, int64_t, FloatArray, const CSRMatrix&, int64_t);
+
+}  // namespace impl
+
+}  // namespace sampling
+
+}  // namespace dgl
@@ -0,0 +1,49 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file graph/sampling/negative/negative_impl.h
+ * \brief DGL sampler - templated implementation definition of negative sampling
+ */
+
+#ifndef DGL_GRAPH_SAMPLING_NEGATIVE_NEGATIVE_IMPL_H_
+#define DGL_GRAPH_SAMPLING_NEGATIVE_NEGATIVE_IMPL_H_
+
+#include <dgl/array.h>
+#include <utility>
+
+namespace dgl {
+
+using namespace dgl::runtime;
+using namespace dgl::aten;
+
+namespace sampling {
+
+namespace impl {
+
+/*!
+ * \brief Corrupt one end of every edge k times.
+ * \param fixed The end of every edge kept, repeated k times in the result.
+ * \param num_nodes The number of nodes of the type of the corrupted end.
+ * \param k The number of negative edges of every edge.
+ * \param prob The weights of the nodes to draw, or a null array to draw them uniformly.
+ * \param adj The matrix to look the negative edges up in, whose rows are the fixed
+ *        ends and whose columns are the corrupted ends. Unused if num_trials is 0.
+ * \param num_trials The number of draws of a negative edge before it is dropped for
+ *        existing in adj, or 0 to keep the existing ones.
+ * \return The fixed ends and the corrupted ends of the negative edges.
+ */
+template<DLDeviceType XPU, typename IdxType, typename FloatType>
+std::pair<IdArray, IdArray> CorruptEdges(
+    IdArray fixed,
+    int64_t num_nodes,
+    int64_t k,
+    FloatArray prob,
+    const CSRMatrix& adj,
+    int64_t num_trials);
+
+}  // namespace impl
+
+}  // namespace sampling
+
+}  // namespace dgl
+
+#endif  // DGL_GRAPH_SAMPLING_NEGATIVE_NEGATIVE_IMPL_H_
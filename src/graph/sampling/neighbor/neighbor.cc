@@ -7,9 +7,20 @@
 #include <dgl/runtime/container.h>
 #include <dgl/packed_func_ext.h>
 #include <dgl/array.h>
+#include <dgl/aten/degree_stats.h>
 #include <dgl/aten/macro.h>
+#include <dgl/immutable_graph.h>
+#include <dgl/random.h>
+#include <dgl/runtime/memory_tracker.h>
+#include <dgl/runtime/parallel_for.h>
+#include <dgl/runtime/profile_range.h>
+#include <dgl/runtime/stage_tracker.h>
 #include <dgl/sampling/neighbor.h>
+#include "../../../array/cpu/array_utils.h"
+#include "../../../array/filter.h"
+#include "../../../array/uvm_array_op.h"
 #include "../../../c_api_common.h"
+#include "../../../runtime/arena.h"
 #include "../../unit_graph.h"
 
 using namespace dgl::runtime;
@@ -18,47 +29,242 @@ using namespace dgl::aten;
 namespace dgl {
 namespace sampling {
 
+namespace {
+
+// Whether sampling the edges of one edge type incident to the nodes takes all of
+// them, i.e. the sampling is uniform without replacement and no node has more
+// edges than the fanout. The largest degree is cached with the graph.
+bool SamplesAllEdges(
+    const HeteroGraphPtr hg, dgl_type_t etype, int64_t fanout, EdgeDir dir,
+    const FloatArray& prob, bool replace) {
+  if (fanout < 0 || replace || !IsNullArray(prob))
+    return false;
+  const auto fmt = hg->SelectFormat(etype, (dir == EdgeDir::kOut) ? CSR_CODE : CSC_CODE);
+  const auto cache = hg->GetKernelPlanCache(etype, fmt);
+  std::shared_ptr<const DegreeStats> stats;
+  if (fmt == SparseFormat::kCOO)
+    stats = COOGetDegreeStats(hg->GetCOOMatrix(etype), dir == EdgeDir::kIn, cache.get());
+  else
+    stats = CSRGetDegreeStats(
+        fmt == SparseFormat::kCSR ? hg->GetCSRMatrix(etype) : hg->GetCSCMatrix(etype),
+        cache.get());
+  return stats->max_degree <= fanout;
+}
+
+// Sample the edges of one edge type incident to the given nodes. Return them as a
+// COO matrix in the orientation of the graph, with the edge IDs as data. The nodes
+// draw from the streams of the edge type under row_streams, if enabled. Only the
+// edges of nonzero mask are sampled if mask is not null. A pinned graph on the CPU
+// is sampled by the GPU of the nodes, reading the row pointers cached there if any.
+COOMatrix SampleEdgesOfType(
+    const HeteroGraphPtr hg,
+    dgl_type_t etype,
+    const IdArray& nodes,
+    int64_t fanout,
+    EdgeDir dir,
+    const FloatArray& prob,
+    bool replace,
+    const FloatArray& alias_accept,
+    const IdArray& alias,
+    const RowStreamKey& row_streams,
+    const NDArray& mask = NullArray()) {
+  // with a mask, the samplers also take all the edges left for a fanout of -1
+  const bool has_mask = !IsNullArray(mask);
+  const bool pinned = nodes->ctx.device_type != hg->Context().device_type;
+  if (!has_mask && !pinned &&
+      (fanout == -1 || SamplesAllEdges(hg, etype, fanout, dir, prob, replace))) {
+    const auto pair = hg->meta_graph()->FindEdge(etype);
+    const auto &earr = (dir == EdgeDir::kOut) ?
+      hg->OutEdges(etype, nodes) :
+      hg->InEdges(etype, nodes);
+    return COOMatrix(
+      hg->NumVertices(pair.first), hg->NumVertices(pair.second), earr.src, earr.dst, earr.id);
+  }
+  // sample from one relation graph, on the thread of the task of the edge type
+  RowStreamScope row_stream_scope(row_streams.Derive(etype));
+  auto req_fmt = (dir == EdgeDir::kOut)? CSR_CODE : CSC_CODE;
+  auto avail_fmt = hg->SelectFormat(etype, req_fmt);
+  // the alias tables are built on the CSR or CSC matrix, and the masks and the
+  // pinned matrices are only read by the CSR samplers
+  const bool use_alias = !has_mask && !pinned && !IsNullArray(alias_accept) &&
+    !IsNullArray(prob);
+  if ((has_mask || pinned) && avail_fmt == SparseFormat::kCOO)
+    avail_fmt = (dir == EdgeDir::kOut) ? SparseFormat::kCSR : SparseFormat::kCSC;
+  auto get_csr = [&](SparseFormat fmt) {
+    const CSRMatrix mat = (fmt == SparseFormat::kCSR) ?
+      hg->GetCSRMatrix(etype) : hg->GetCSCMatrix(etype);
+    return pinned ?
+      aten::CSRWithCachedIndptr(mat, nodes->ctx, hg->GetKernelPlanCache(etype, fmt).get()) :
+      mat;
+  };
+  COOMatrix sampled_coo;
+  switch (avail_fmt) {
+    case SparseFormat::kCOO:
+      if (dir == EdgeDir::kIn) {
+        sampled_coo = aten::COOTranspose(aten::COORowWiseSampling(
+          aten::COOTranspose(hg->GetCOOMatrix(etype)),
+          nodes, fanout, prob, replace));
+      } else {
+        sampled_coo = aten::COORowWiseSampling(
+          hg->GetCOOMatrix(etype), nodes, fanout, prob, replace);
+      }
+      break;
+    case SparseFormat::kCSR:
+      CHECK(dir == EdgeDir::kOut) << "Cannot sample out edges on CSC matrix.";
+      if (use_alias) {
+        sampled_coo = aten::CSRRowWiseSamplingAlias(
+          hg->GetCSRMatrix(etype), nodes, fanout, prob, alias_accept, alias, replace);
+      } else {
+        sampled_coo = aten::CSRRowWiseSampling(
+          get_csr(SparseFormat::kCSR), nodes, fanout, prob, replace, mask);
+      }
+      break;
+    case SparseFormat::kCSC:
+      CHECK(dir == EdgeDir::kIn) << "Cannot sample in edges on CSR matrix.";
+      if (use_alias) {
+        sampled_coo = aten::CSRRowWiseSamplingAlias(
+          hg->GetCSCMatrix(etype), nodes, fanout, prob, alias_accept, alias, replace);
+      } else {
+        sampled_coo = aten::CSRRowWiseSampling(
+          get_csr(SparseFormat::kCSC), nodes, fanout, prob, replace, mask);
+      }
+      sampled_coo = aten::COOTranspose(sampled_coo);
+      break;
+    default:
+      LOG(FATAL) << "Unsupported sparse format.";
+  }
+  return sampled_coo;
+}
+
+template <typename IdType>
+SampledBlocks SampleNeighborBlocksCPU(
+    const HeteroGraphPtr hg,
+    const std::vector<IdArray>& seeds,
+    const std::vector<std::vector<int64_t>>& fanouts,
+    const std::vector<FloatArray>& prob,
+    bool replace,
+    const std::vector<FloatArray>& alias_accept,
+    const std::vector<IdArray>& alias) {
+  const int64_t num_ntypes = hg->NumVertexTypes();
+  const int64_t num_etypes = hg->NumEdgeTypes();
+  const int64_t num_layers = fanouts.size();
+  SampledBlocks ret;
+  ret.blocks.resize(num_layers);
+  ret.src_nodes.resize(num_layers);
+  ret.induced_edges.resize(num_layers);
+
+  // The source nodes of a block start with its destination nodes and are the
+  // destination nodes of the previous block, so that a single map per node type
+  // relabels the nodes of all the layers.
+  runtime::ArenaScope arena_scope;
+  std::vector<IdHashMap<IdType, runtime::ArenaAllocator<IdType>>> node_maps(num_ntypes);
+  std::vector<IdArray> dst_nodes(num_ntypes);
+  for (int64_t ntype = 0; ntype < num_ntypes; ++ntype) {
+    node_maps[ntype].Update(seeds[ntype]);
+    dst_nodes[ntype] = node_maps[ntype].Values();
+  }
+
+  const EdgeArray meta_edges = hg->meta_graph()->Edges("eid");
+  const auto new_meta_graph = ImmutableGraph::CreateFromCOO(
+      num_ntypes * 2, meta_edges.src, Add(meta_edges.dst, num_ntypes));
+  const RowStreamKey row_streams = RowStreamScope::Current();
+
+  for (int64_t layer = num_layers - 1; layer >= 0; --layer) {
+    CHECK_EQ(fanouts[layer].size(), num_etypes)
+      << "Number of fanout values must match the number of edge types.";
+    std::vector<int64_t> num_dst(num_ntypes);
+    for (int64_t ntype = 0; ntype < num_ntypes; ++ntype)
+      num_dst[ntype] = node_maps[ntype].Size();
+
+    // the relations are sampled in parallel, and the new nodes numbered in the
+    // order of the relations
+    std::vector<COOMatrix> sampled(num_etypes);
+    std::vector<char> has_sampled(num_etypes, false);
+    runtime::parallel_for_tasks(0, num_etypes, [&](size_t etype) {
+      const auto src_dst_types = hg->GetEndpointTypes(etype);
+      const int64_t fanout = fanouts[layer][etype];
+      if (num_dst[src_dst_types.second] == 0 || fanout == 0)
+        return;
+      sampled[etype] = SampleEdgesOfType(
+          hg, etype, dst_nodes[src_dst_types.second], fanout, EdgeDir::kIn, prob[etype],
+          replace,
+          etype < alias_accept.size() ? alias_accept[etype] : aten::NullArray(),
+          etype < alias.size() ? alias[etype] : aten::NullArray(),
+          row_streams.Derive(layer));
+      has_sampled[etype] = true;
+    });
+    for (int64_t etype = 0; etype < num_etypes; ++etype) {
+      if (has_sampled[etype])
+        node_maps[hg->GetEndpointTypes(etype).first].Update(sampled[etype].row);
+    }
+
+    std::vector<int64_t> num_nodes_per_type(num_ntypes * 2);
+    for (int64_t ntype = 0; ntype < num_ntypes; ++ntype) {
+      num_nodes_per_type[ntype] = node_maps[ntype].Size();
+      num_nodes_per_type[num_ntypes + ntype] = num_dst[ntype];
+    }
+    std::vector<HeteroGraphPtr> rel_graphs(num_etypes);
+    std::vector<IdArray> induced_edges(num_etypes);
+    runtime::parallel_for_tasks(0, num_etypes, [&](size_t etype) {
+      const auto src_dst_types = hg->GetEndpointTypes(etype);
+      const int64_t num_src = num_nodes_per_type[src_dst_types.first];
+      const int64_t num_dst_etype = num_dst[src_dst_types.second];
+      if (!has_sampled[etype]) {
+        rel_graphs[etype] = CreateFromCOO(
+            2, num_src, num_dst_etype, aten::NullArray(), aten::NullArray());
+        induced_edges[etype] = aten::NullArray(hg->DataType(), hg->Context());
+      } else {
+        const COOMatrix& coo = sampled[etype];
+        rel_graphs[etype] = CreateFromCOO(
+            2, num_src, num_dst_etype,
+            node_maps[src_dst_types.first].Map(coo.row, -1),
+            node_maps[src_dst_types.second].Map(coo.col, -1));
+        induced_edges[etype] = coo.data;
+      }
+    });
+
+    ret.blocks[layer] = CreateHeteroGraph(new_meta_graph, rel_graphs, num_nodes_per_type);
+    ret.src_nodes[layer].resize(num_ntypes);
+    for (int64_t ntype = 0; ntype < num_ntypes; ++ntype) {
+      dst_nodes[ntype] = node_maps[ntype].Values();
+      ret.src_nodes[layer][ntype] = dst_nodes[ntype];
+    }
+    ret.induced_edges[layer] = std::move(induced_edges);
+  }
+  return ret;
+}
+
+}  // namespace
+
 HeteroSubgraph ExcludeCertainEdges(
     const HeteroSubgraph& sg,
     const std::vector<IdArray>& exclude_edges) {
-
+    runtime::StageScope stage_scope(runtime::SamplingStage::kExcludeEdges);
     HeteroGraphPtr hg_view = HeteroGraphRef(sg.graph).sptr();
     std::vector<IdArray> remain_induced_edges(hg_view->NumEdgeTypes());
     std::vector<IdArray> remain_edges(hg_view->NumEdgeTypes());
 
     for (dgl_type_t etype = 0; etype < hg_view->NumEdgeTypes(); ++etype) {
-      IdArray edge_ids = Range(0,
-                               sg.induced_edges[etype]->shape[0],
-                               sg.induced_edges[etype]->dtype.bits,
-                               sg.induced_edges[etype]->ctx);
       if (exclude_edges[etype].GetSize() == 0) {
-        remain_edges[etype] = edge_ids;
+        remain_edges[etype] = Range(0,
+                                    sg.induced_edges[etype]->shape[0],
+                                    sg.induced_edges[etype]->dtype.bits,
+                                    sg.induced_edges[etype]->ctx);
         remain_induced_edges[etype] = sg.induced_edges[etype];
         continue;
       }
       ATEN_ID_TYPE_SWITCH(hg_view->DataType(), IdType, {
-        IdType* idx_data = edge_ids.Ptr<IdType>();
-        IdType* induced_edges_data = sg.induced_edges[etype].Ptr<IdType>();
-        const IdType exclude_edges_len = exclude_edges[etype]->shape[0];
-        std::sort(exclude_edges[etype].Ptr<IdType>(),
-                  exclude_edges[etype].Ptr<IdType>() + exclude_edges_len);
-        const IdType* exclude_edges_data = exclude_edges[etype].Ptr<IdType>();
-        IdType outId = 0;
-        for (IdType i = 0; i != sg.induced_edges[etype]->shape[0]; ++i) {
-          if (!std::binary_search(exclude_edges_data,
-                                  exclude_edges_data + exclude_edges_len,
-                                  induced_edges_data[i])) {
-            induced_edges_data[outId] = induced_edges_data[i];
-            idx_data[outId] = idx_data[i];
-            ++outId;
-          }
-        }
-        remain_edges[etype] = aten::IndexSelect(edge_ids, 0, outId);
-        remain_induced_edges[etype] = aten::IndexSelect(sg.induced_edges[etype], 0, outId);
+        // A set filter looks the sampled edges up in a bitmap over the excluded
+        // IDs when they are dense enough, in a hash set otherwise.
+        array::FilterRef filter = array::CreateSetFilter<kDLCPU, IdType>(exclude_edges[etype]);
+        remain_edges[etype] = filter->find_excluded_indices(sg.induced_edges[etype]);
+        remain_induced_edges[etype] = aten::IndexSelect(sg.induced_edges[etype],
+                                                        remain_edges[etype]);
       });
     }
     HeteroSubgraph subg = hg_view->EdgeSubgraph(remain_edges, true);
     subg.induced_edges = std::move(remain_induced_edges);
+    stage_scope.AddEdges(subg.induced_edges);
     return subg;
 }
 
@@ -69,7 +275,15 @@ HeteroSubgraph SampleNeighbors(
     EdgeDir dir,
     const std::vector<FloatArray>& prob,
     const std::vector<IdArray>& exclude_edges,
-    bool replace) {
+    bool replace,
+    const std::vector<FloatArray>& alias_accept,
+    const std::vector<IdArray>& alias,
+    const std::vector<NDArray>& mask) {
+  DGL_PROFILE_RANGE("SampleNeighbors", hg->NumEdgeTypes(), nodes.empty() ? NDArray() : nodes[0],
+                    fanouts.empty() ? 0 : fanouts[0], replace);
+  runtime::MemoryTagScope tag_scope(runtime::MemoryTag::kSampler);
+  runtime::StageScope stage_scope(runtime::SamplingStage::kSampleNeighbors);
+  stage_scope.AddSeeds(nodes);
 
   // sanity check
   CHECK_EQ(nodes.size(), hg->NumVertexTypes())
@@ -79,9 +293,23 @@ HeteroSubgraph SampleNeighbors(
   CHECK_EQ(prob.size(), hg->NumEdgeTypes())
     << "Number of probability tensors must match the number of edge types.";
 
+  // a pinned graph on the CPU is sampled by the GPU of the nodes
+  DLContext ctx = hg->Context();
+  for (const IdArray& nodes_ntype : nodes) {
+    if (nodes_ntype->shape[0] > 0 && nodes_ntype->ctx.device_type != ctx.device_type) {
+      CHECK(hg->IsPinned()) << "The nodes must be on the device of the graph, "
+        << "unless the graph is pinned.";
+      CHECK(exclude_edges.empty()) << "Excluding edges is not supported when sampling "
+        << "a pinned graph on a GPU.";
+      ctx = nodes_ntype->ctx;
+      break;
+    }
+  }
+
   std::vector<HeteroGraphPtr> subrels(hg->NumEdgeTypes());
   std::vector<IdArray> induced_edges(hg->NumEdgeTypes());
-  for (dgl_type_t etype = 0; etype < hg->NumEdgeTypes(); ++etype) {
+  const RowStreamKey row_streams = RowStreamScope::Current();
+  auto sample_etype = [&](dgl_type_t etype) {
     auto pair = hg->meta_graph()->FindEdge(etype);
     const dgl_type_t src_vtype = pair.first;
     const dgl_type_t dst_vtype = pair.second;
@@ -93,66 +321,94 @@ HeteroSubgraph SampleNeighbors(
         hg->GetRelationGraph(etype)->NumVertexTypes(),
         hg->NumVertices(src_vtype),
         hg->NumVertices(dst_vtype),
-        hg->DataType(), hg->Context());
-      induced_edges[etype] = aten::NullArray(hg->DataType(), hg->Context());
-    } else if (fanouts[etype] == -1) {
-      const auto &earr = (dir == EdgeDir::kOut) ?
-        hg->OutEdges(etype, nodes_ntype) :
-        hg->InEdges(etype, nodes_ntype);
-      subrels[etype] = UnitGraph::CreateFromCOO(
-        hg->GetRelationGraph(etype)->NumVertexTypes(),
-        hg->NumVertices(src_vtype),
-        hg->NumVertices(dst_vtype),
-        earr.src,
-        earr.dst);
-      induced_edges[etype] = earr.id;
+        hg->DataType(), ctx);
+      induced_edges[etype] = aten::NullArray(hg->DataType(), ctx);
     } else {
-      // sample from one relation graph
-      auto req_fmt = (dir == EdgeDir::kOut)? CSR_CODE : CSC_CODE;
-      auto avail_fmt = hg->SelectFormat(etype, req_fmt);
-      COOMatrix sampled_coo;
-      switch (avail_fmt) {
-        case SparseFormat::kCOO:
-          if (dir == EdgeDir::kIn) {
-            sampled_coo = aten::COOTranspose(aten::COORowWiseSampling(
-              aten::COOTranspose(hg->GetCOOMatrix(etype)),
-              nodes_ntype, fanouts[etype], prob[etype], replace));
-          } else {
-            sampled_coo = aten::COORowWiseSampling(
-              hg->GetCOOMatrix(etype), nodes_ntype, fanouts[etype], prob[etype], replace);
-          }
-          break;
-        case SparseFormat::kCSR:
-          CHECK(dir == EdgeDir::kOut) << "Cannot sample out edges on CSC matrix.";
-          sampled_coo = aten::CSRRowWiseSampling(
-            hg->GetCSRMatrix(etype), nodes_ntype, fanouts[etype], prob[etype], replace);
-          break;
-        case SparseFormat::kCSC:
-          CHECK(dir == EdgeDir::kIn) << "Cannot sample in edges on CSR matrix.";
-          sampled_coo = aten::CSRRowWiseSampling(
-            hg->GetCSCMatrix(etype), nodes_ntype, fanouts[etype], prob[etype], replace);
-          sampled_coo = aten::COOTranspose(sampled_coo);
-          break;
-        default:
-          LOG(FATAL) << "Unsupported sparse format.";
-      }
+      CHECK(nodes_ntype->ctx == ctx) << "The nodes of all the types must be on the same device.";
+      const COOMatrix sampled_coo = SampleEdgesOfType(
+        hg, etype, nodes_ntype, fanouts[etype], dir, prob[etype], replace,
+        etype < alias_accept.size() ? alias_accept[etype] : aten::NullArray(),
+        etype < alias.size() ? alias[etype] : aten::NullArray(), row_streams,
+        etype < mask.size() ? mask[etype] : aten::NullArray());
+      // the sortedness of the picks is carried to the subgraph
       subrels[etype] = UnitGraph::CreateFromCOO(
         hg->GetRelationGraph(etype)->NumVertexTypes(), sampled_coo.num_rows, sampled_coo.num_cols,
-        sampled_coo.row, sampled_coo.col);
+        sampled_coo.row, sampled_coo.col, sampled_coo.row_sorted, sampled_coo.col_sorted);
       induced_edges[etype] = sampled_coo.data;
     }
+  };
+  if (ctx.device_type == kDLCPU) {
+    // the relations of very different sizes share the threads
+    runtime::parallel_for_tasks(0, hg->NumEdgeTypes(), [&](size_t etype) {
+      sample_etype(etype);
+    });
+  } else {
+    // the CUDA kernels run on the stream of the calling thread
+    for (dgl_type_t etype = 0; etype < hg->NumEdgeTypes(); ++etype)
+      sample_etype(etype);
   }
 
   HeteroSubgraph ret;
   ret.graph = CreateHeteroGraph(hg->meta_graph(), subrels, hg->NumVerticesPerType());
   ret.induced_vertices.resize(hg->NumVertexTypes());
   ret.induced_edges = std::move(induced_edges);
-  if (!exclude_edges.empty()) {
-    return ExcludeCertainEdges(ret, exclude_edges);
-  }
+  if (!exclude_edges.empty())
+    ret = ExcludeCertainEdges(ret, exclude_edges);
+  stage_scope.AddEdges(ret.induced_edges);
   return ret;
 }
 
+SampledBlocks SampleNeighborBlocks(
+    const HeteroGraphPtr hg,
+    const std::vector<IdArray>& seeds,
+    const std::vector<std::vector<int64_t>>& fanouts,
+    const std::vector<FloatArray>& prob,
+    bool replace,
+    const std::vector<FloatArray>& alias_accept,
+    const std::vector<IdArray>& alias) {
+  CHECK_EQ(seeds.size(), hg->NumVertexTypes())
+    << "Number of node ID tensors must match the number of node types.";
+  CHECK_EQ(prob.size(), hg->NumEdgeTypes())
+    << "Number of probability tensors must match the number of edge types.";
+  CHECK_EQ(hg->Context().device_type, kDLCPU)
+    << "SampleNeighborBlocks only supports CPU graphs.";
+  runtime::StageScope stage_scope(runtime::SamplingStage::kSampleNeighbors);
+  stage_scope.AddSeeds(seeds);
+  SampledBlocks ret;
+  ATEN_ID_TYPE_SWITCH(hg->DataType(), IdType, {
+    ret = SampleNeighborBlocksCPU<IdType>(
+        hg, seeds, fanouts, prob, replace, alias_accept, alias);
+  });
+  for (const auto& induced_edges : ret.induced_edges)
+    stage_scope.AddEdges(induced_edges);
+  return ret;
+}
+
+std::pair<FloatArray, IdArray> BuildAliasTable(
+    const HeteroGraphPtr hg,
+    dgl_type_t etype,
+    EdgeDir dir,
+    const FloatArray& probability) {
+  CHECK_EQ(probability->shape[0], hg->NumEdges(etype))
+    << "The probability array must have one element for each edge.";
+  const auto& mat = (dir == EdgeDir::kOut) ?
+    hg->GetCSRMatrix(etype) : hg->GetCSCMatrix(etype);
+  return aten::CSRRowWiseAliasTable(mat, probability);
+}
+
+IdArray BuildTopkOrder(
+    const HeteroGraphPtr hg,
+    dgl_type_t etype,
+    EdgeDir dir,
+    const FloatArray& weight,
+    bool ascending) {
+  CHECK_EQ(weight->shape[0], hg->NumEdges(etype))
+    << "The weight array must have one element for each edge.";
+  const auto& mat = (dir == EdgeDir::kOut) ?
+    hg->GetCSRMatrix(etype) : hg->GetCSCMatrix(etype);
+  return aten::CSRRowWiseTopkOrder(mat, weight, ascending);
+}
+
 HeteroSubgraph SampleNeighborsEType(
     const HeteroGraphPtr hg,
     const IdArray nodes,
@@ -233,9 +489,10 @@ HeteroSubgraph SampleNeighborsEType(
         LOG(FATAL) << "Unsupported sparse format.";
     }
 
+    // the sortedness of the picks is carried to the subgraph
     subrels[etype] = UnitGraph::CreateFromCOO(
       1, sampled_coo.num_rows, sampled_coo.num_cols,
-      sampled_coo.row, sampled_coo.col);
+      sampled_coo.row, sampled_coo.col, sampled_coo.row_sorted, sampled_coo.col_sorted);
     induced_edges[etype] = sampled_coo.data;
   }
 
@@ -252,7 +509,8 @@ HeteroSubgraph SampleNeighborsTopk(
     const std::vector<int64_t>& k,
     EdgeDir dir,
     const std::vector<FloatArray>& weight,
-    bool ascending) {
+    bool ascending,
+    const std::vector<IdArray>& order) {
   // sanity check
   CHECK_EQ(nodes.size(), hg->NumVertexTypes())
     << "Number of node ID tensors must match the number of node types.";
@@ -292,6 +550,7 @@ HeteroSubgraph SampleNeighborsTopk(
       // sample from one relation graph
       auto req_fmt = (dir == EdgeDir::kOut)? CSR_CODE : CSC_CODE;
       auto avail_fmt = hg->SelectFormat(etype, req_fmt);
+      const bool has_order = etype < order.size() && !aten::IsNullArray(order[etype]);
       COOMatrix sampled_coo;
       switch (avail_fmt) {
         case SparseFormat::kCOO:
@@ -306,13 +565,19 @@ HeteroSubgraph SampleNeighborsTopk(
           break;
         case SparseFormat::kCSR:
           CHECK(dir == EdgeDir::kOut) << "Cannot sample out edges on CSC matrix.";
-          sampled_coo = aten::CSRRowWiseTopk(
-            hg->GetCSRMatrix(etype), nodes_ntype, k[etype], weight[etype], ascending);
+          sampled_coo = has_order ?
+            aten::CSRRowWiseTopkOrdered(
+              hg->GetCSRMatrix(etype), nodes_ntype, k[etype], order[etype]) :
+            aten::CSRRowWiseTopk(
+              hg->GetCSRMatrix(etype), nodes_ntype, k[etype], weight[etype], ascending);
           break;
         case SparseFormat::kCSC:
           CHECK(dir == EdgeDir::kIn) << "Cannot sample in edges on CSR matrix.";
-          sampled_coo = aten::CSRRowWiseTopk(
-            hg->GetCSCMatrix(etype), nodes_ntype, k[etype], weight[etype], ascending);
+          sampled_coo = has_order ?
+            aten::CSRRowWiseTopkOrdered(
+              hg->GetCSCMatrix(etype), nodes_ntype, k[etype], order[etype]) :
+            aten::CSRRowWiseTopk(
+              hg->GetCSCMatrix(etype), nodes_ntype, k[etype], weight[etype], ascending);
           sampled_coo = aten::COOTranspose(sampled_coo);
           break;
         default:
@@ -332,6 +597,70 @@ HeteroSubgraph SampleNeighborsTopk(
   return ret;
 }
 
+HeteroSubgraph SampleNeighborsTemporal(
+    const HeteroGraphPtr hg,
+    const std::vector<IdArray>& nodes,
+    const std::vector<int64_t>& fanouts,
+    EdgeDir dir,
+    const std::vector<NDArray>& timestamp,
+    const std::vector<IdArray>& order,
+    const std::vector<NDArray>& bound,
+    bool replace) {
+  // sanity check
+  CHECK_EQ(nodes.size(), hg->NumVertexTypes())
+    << "Number of node ID tensors must match the number of node types.";
+  CHECK_EQ(bound.size(), hg->NumVertexTypes())
+    << "Number of time bound tensors must match the number of node types.";
+  CHECK_EQ(fanouts.size(), hg->NumEdgeTypes())
+    << "Number of fanout values must match the number of edge types.";
+  CHECK_EQ(timestamp.size(), hg->NumEdgeTypes())
+    << "Number of timestamp tensors must match the number of edge types.";
+  CHECK_EQ(order.size(), hg->NumEdgeTypes())
+    << "Number of order tensors must match the number of edge types.";
+
+  std::vector<HeteroGraphPtr> subrels(hg->NumEdgeTypes());
+  std::vector<IdArray> induced_edges(hg->NumEdgeTypes());
+  for (dgl_type_t etype = 0; etype < hg->NumEdgeTypes(); ++etype) {
+    auto pair = hg->meta_graph()->FindEdge(etype);
+    const dgl_type_t src_vtype = pair.first;
+    const dgl_type_t dst_vtype = pair.second;
+    const dgl_type_t nodes_vtype = (dir == EdgeDir::kOut)? src_vtype : dst_vtype;
+    const IdArray nodes_ntype = nodes[nodes_vtype];
+    const int64_t num_nodes = nodes_ntype->shape[0];
+    if (num_nodes == 0 || fanouts[etype] == 0) {
+      // Nothing to sample for this etype, create a placeholder relation graph
+      subrels[etype] = UnitGraph::Empty(
+        hg->GetRelationGraph(etype)->NumVertexTypes(),
+        hg->NumVertices(src_vtype),
+        hg->NumVertices(dst_vtype),
+        hg->DataType(), hg->Context());
+      induced_edges[etype] = aten::NullArray();
+    } else {
+      // the order is built on the matrix of the edge direction, see BuildTopkOrder
+      COOMatrix sampled_coo;
+      if (dir == EdgeDir::kOut) {
+        sampled_coo = aten::CSRRowWiseSamplingTemporal(
+            hg->GetCSRMatrix(etype), nodes_ntype, fanouts[etype], timestamp[etype],
+            order[etype], bound[nodes_vtype], replace);
+      } else {
+        sampled_coo = aten::COOTranspose(aten::CSRRowWiseSamplingTemporal(
+            hg->GetCSCMatrix(etype), nodes_ntype, fanouts[etype], timestamp[etype],
+            order[etype], bound[nodes_vtype], replace));
+      }
+      subrels[etype] = UnitGraph::CreateFromCOO(
+        hg->GetRelationGraph(etype)->NumVertexTypes(), sampled_coo.num_rows, sampled_coo.num_cols,
+        sampled_coo.row, sampled_coo.col);
+      induced_edges[etype] = sampled_coo.data;
+    }
+  }
+
+  HeteroSubgraph ret;
+  ret.graph = CreateHeteroGraph(hg->meta_graph(), subrels, hg->NumVerticesPerType());
+  ret.induced_vertices.resize(hg->NumVertexTypes());
+  ret.induced_edges = std::move(induced_edges);
+  return ret;
+}
+
 HeteroSubgraph SampleNeighborsBiased(
     const HeteroGraphPtr hg,
     const IdArray& nodes,
@@ -445,18 +774,98 @@ DGL_REGISTER_GLOBAL("sampling.neighbor._CAPI_DGLSampleNeighbors")
     const auto& prob = ListValueToVector<FloatArray>(args[4]);
     const auto& exclude_edges = ListValueToVector<IdArray>(args[5]);
     const bool replace = args[6];
+    const auto& alias_accept = ListValueToVector<FloatArray>(args[7]);
+    const auto& alias = ListValueToVector<IdArray>(args[8]);
+    const int64_t random_seed = args[9];
+    const auto& mask = ListValueToVector<NDArray>(args[10]);
 
     CHECK(dir_str == "in" || dir_str == "out")
       << "Invalid edge direction. Must be \"in\" or \"out\".";
     EdgeDir dir = (dir_str == "in")? EdgeDir::kIn : EdgeDir::kOut;
 
+    RowStreamScope row_stream_scope(
+        random_seed >= 0 ? RowStreamKey::FromSeed(random_seed) : RowStreamKey());
     std::shared_ptr<HeteroSubgraph> subg(new HeteroSubgraph);
     *subg = sampling::SampleNeighbors(
-        hg.sptr(), nodes, fanouts, dir, prob, exclude_edges, replace);
+        hg.sptr(), nodes, fanouts, dir, prob, exclude_edges, replace, alias_accept, alias,
+        mask);
 
     *rv = HeteroSubgraphRef(subg);
   });
 
+DGL_REGISTER_GLOBAL("sampling.neighbor._CAPI_DGLSampleNeighborBlocks")
+.set_body([] (DGLArgs args, DGLRetValue *rv) {
+    HeteroGraphRef hg = args[0];
+    const auto& seeds = ListValueToVector<IdArray>(args[1]);
+    const auto& fanout_arrays = ListValueToVector<IdArray>(args[2]);
+    const auto& prob = ListValueToVector<FloatArray>(args[3]);
+    const bool replace = args[4];
+    const auto& alias_accept = ListValueToVector<FloatArray>(args[5]);
+    const auto& alias = ListValueToVector<IdArray>(args[6]);
+    const int64_t random_seed = args[7];
+
+    std::vector<std::vector<int64_t>> fanouts;
+    for (const IdArray& fanout : fanout_arrays) {
+      CHECK_INT64(fanout, "fanout");
+      fanouts.push_back(fanout.ToVector<int64_t>());
+    }
+
+    RowStreamScope row_stream_scope(
+        random_seed >= 0 ? RowStreamKey::FromSeed(random_seed) : RowStreamKey());
+    const SampledBlocks sampled = sampling::SampleNeighborBlocks(
+        hg.sptr(), seeds, fanouts, prob, replace, alias_accept, alias);
+
+    List<HeteroGraphRef> blocks_ref;
+    List<ObjectRef> src_nodes_ref, induced_edges_ref;
+    for (size_t layer = 0; layer < sampled.blocks.size(); ++layer) {
+      blocks_ref.push_back(HeteroGraphRef(sampled.blocks[layer]));
+      List<Value> src_nodes;
+      for (const IdArray& array : sampled.src_nodes[layer])
+        src_nodes.push_back(Value(MakeValue(array)));
+      src_nodes_ref.push_back(src_nodes);
+      List<Value> induced_edges;
+      for (const IdArray& array : sampled.induced_edges[layer])
+        induced_edges.push_back(Value(MakeValue(array)));
+      induced_edges_ref.push_back(induced_edges);
+    }
+
+    List<ObjectRef> ret;
+    ret.push_back(blocks_ref);
+    ret.push_back(src_nodes_ref);
+    ret.push_back(induced_edges_ref);
+    *rv = ret;
+  });
+
+DGL_REGISTER_GLOBAL("sampling.neighbor._CAPI_DGLBuildAliasTable")
+.set_body([] (DGLArgs args, DGLRetValue *rv) {
+    HeteroGraphRef hg = args[0];
+    dgl_type_t etype = args[1];
+    const std::string dir_str = args[2];
+    FloatArray prob = args[3];
+
+    CHECK(dir_str == "in" || dir_str == "out")
+      << "Invalid edge direction. Must be \"in\" or \"out\".";
+    EdgeDir dir = (dir_str == "in")? EdgeDir::kIn : EdgeDir::kOut;
+
+    const auto& table = sampling::BuildAliasTable(hg.sptr(), etype, dir, prob);
+    *rv = ConvertNDArrayVectorToPackedFunc({table.first, table.second});
+  });
+
+DGL_REGISTER_GLOBAL("sampling.neighbor._CAPI_DGLBuildTopkOrder")
+.set_body([] (DGLArgs args, DGLRetValue *rv) {
+    HeteroGraphRef hg = args[0];
+    dgl_type_t etype = args[1];
+    const std::string dir_str = args[2];
+    FloatArray weight = args[3];
+    const bool ascending = args[4];
+
+    CHECK(dir_str == "in" || dir_str == "out")
+      << "Invalid edge direction. Must be \"in\" or \"out\".";
+    EdgeDir dir = (dir_str == "in")? EdgeDir::kIn : EdgeDir::kOut;
+
+    *rv = sampling::BuildTopkOrder(hg.sptr(), etype, dir, weight, ascending);
+  });
+
 DGL_REGISTER_GLOBAL("sampling.neighbor._CAPI_DGLSampleNeighborsTopk")
 .set_body([] (DGLArgs args, DGLRetValue *rv) {
     HeteroGraphRef hg = args[0];
@@ -466,6 +875,7 @@ DGL_REGISTER_GLOBAL("sampling.neighbor._CAPI_DGLSampleNeighborsTopk")
     const std::string dir_str = args[3];
     const auto& weight = ListValueToVector<FloatArray>(args[4]);
     const bool ascending = args[5];
+    const auto& order = ListValueToVector<IdArray>(args[6]);
 
     CHECK(dir_str == "in" || dir_str == "out")
       << "Invalid edge direction. Must be \"in\" or \"out\".";
@@ -473,7 +883,30 @@ DGL_REGISTER_GLOBAL("sampling.neighbor._CAPI_DGLSampleNeighborsTopk")
 
     std::shared_ptr<HeteroSubgraph> subg(new HeteroSubgraph);
     *subg = sampling::SampleNeighborsTopk(
-        hg.sptr(), nodes, k, dir, weight, ascending);
+        hg.sptr(), nodes, k, dir, weight, ascending, order);
+
+    *rv = HeteroGraphRef(subg);
+  });
+
+DGL_REGISTER_GLOBAL("sampling.neighbor._CAPI_DGLSampleNeighborsTemporal")
+.set_body([] (DGLArgs args, DGLRetValue *rv) {
+    HeteroGraphRef hg = args[0];
+    const auto& nodes = ListValueToVector<IdArray>(args[1]);
+    IdArray fanouts_array = args[2];
+    const auto& fanouts = fanouts_array.ToVector<int64_t>();
+    const std::string dir_str = args[3];
+    const auto& timestamp = ListValueToVector<NDArray>(args[4]);
+    const auto& order = ListValueToVector<IdArray>(args[5]);
+    const auto& bound = ListValueToVector<NDArray>(args[6]);
+    const bool replace = args[7];
+
+    CHECK(dir_str == "in" || dir_str == "out")
+      << "Invalid edge direction. Must be \"in\" or \"out\".";
+    EdgeDir dir = (dir_str == "in")? EdgeDir::kIn : EdgeDir::kOut;
+
+    std::shared_ptr<HeteroSubgraph> subg(new HeteroSubgraph);
+    *subg = sampling::SampleNeighborsTemporal(
+        hg.sptr(), nodes, fanouts, dir, timestamp, order, bound, replace);
 
     *rv = HeteroGraphRef(subg);
   });
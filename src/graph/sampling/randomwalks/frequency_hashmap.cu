@@ -6,6 +6,7 @@
 
 #include <cub/cub.cuh>
 #include <algorithm>
+#include <limits>
 #include <tuple>
 #include <utility>
 #include "../../../runtime/cuda/cuda_common.h"
@@ -27,10 +28,22 @@ int64_t _table_size(const int64_t num, const int64_t scale) {
    * is a power of two.
    * https://en.wikipedia.org/wiki/Quadratic_probing#Limitations
    */
-  const int64_t next_pow2 = 1 << static_cast<int64_t>(1 + std::log2(num >> 1));
+  int64_t next_pow2 = 1;
+  while (next_pow2 < num)
+    next_pow2 <<= 1;
   return next_pow2 << scale;
 }
 
+/**
+ * The number of bits needed to store the values in [0, num].
+ */
+int _num_bits(const int64_t num) {
+  int bits = 0;
+  while (bits < 63 && (static_cast<int64_t>(1) << bits) <= num)
+    ++bits;
+  return bits;
+}
+
 
 template<typename IdxType, int BLOCK_SIZE, int TILE_SIZE>
 __global__ void _init_edge_table(void *edge_hashmap, int64_t edges_len) {
@@ -101,9 +114,15 @@ struct BlockPrefixCallbackOp {
   }
 };
 
+/**
+ * The unique edges are sorted by a key made of the inverted index of their
+ * destination node in the high bits and of their count in the `cnt_bits` low
+ * bits, so that a single radix sort of the keys in descending order sorts the
+ * edges by destination node and then by decreasing count.
+ */
 template<typename IdxType, typename Idx64Type, int BLOCK_SIZE, int TILE_SIZE>
 __global__ void _compact_frequency(const IdxType *src_data, const IdxType *dst_data,
-    const int64_t num_edges, const int64_t num_edges_per_node,
+    const int64_t num_edges, const int64_t num_edges_per_node, const int cnt_bits,
     const IdxType *edge_blocks_prefix, const bool *is_first_position,
     IdxType *num_unique_each_node,
     IdxType *unique_src_edges, Idx64Type *unique_frequency,
@@ -132,14 +151,9 @@ __global__ void _compact_frequency(const IdxType *src_data, const IdxType *dst_d
       if (is_first_position[idx] == true) {
         const IdxType pos = (block_offset + flag);
         unique_src_edges[pos] = src;
-        if (sizeof(IdxType) != sizeof(Idx64Type)
-            && sizeof(IdxType) == 4) {  // if IdxType is a 32-bit data
-          unique_frequency[pos] = (
-              (static_cast<Idx64Type>(num_edges / num_edges_per_node - dst_idx) << 32)
-              | device_edge_hashmap.GetEdgeCount(src, dst_idx));
-        } else {
-          unique_frequency[pos] = device_edge_hashmap.GetEdgeCount(src, dst_idx);
-        }
+        unique_frequency[pos] = (
+            (static_cast<Idx64Type>(num_edges / num_edges_per_node - dst_idx) << cnt_bits)
+            | static_cast<Idx64Type>(device_edge_hashmap.GetEdgeCount(src, dst_idx)));
       }
     }
   }
@@ -163,11 +177,12 @@ template<typename IdxType, typename Idx64Type, int BLOCK_SIZE, int TILE_SIZE>
 __global__ void _pick_data(const Idx64Type *unique_frequency, const IdxType *unique_src_edges,
     const IdxType *unique_input_offsets, const IdxType *dst_data,
     const int64_t num_edges_per_node, const int64_t num_dst_nodes,
-    const int64_t num_edges,
+    const int64_t num_edges, const int cnt_bits,
     const IdxType *unique_output_offsets,
     IdxType *output_src, IdxType *output_dst, IdxType *output_frequency) {
   int64_t start_idx = (blockIdx.x * TILE_SIZE) + threadIdx.x;
   int64_t last_idx = start_idx + TILE_SIZE;
+  const Idx64Type cnt_mask = (static_cast<Idx64Type>(1) << cnt_bits) - 1;
 
   for (int64_t idx = start_idx; idx < last_idx; idx += BLOCK_SIZE) {
     if (idx < num_dst_nodes) {
@@ -181,7 +196,8 @@ __global__ void _pick_data(const Idx64Type *unique_frequency, const IdxType *uni
           output_idx < last_output_offset; ++output_idx, ++input_idx) {
         output_src[output_idx] = unique_src_edges[input_idx];
         output_dst[output_idx] = dst;
-        output_frequency[output_idx] = static_cast<IdxType>(unique_frequency[input_idx]);
+        output_frequency[output_idx] = static_cast<IdxType>(
+            unique_frequency[input_idx] & cnt_mask);
       }
     }
   }
@@ -189,7 +205,8 @@ __global__ void _pick_data(const Idx64Type *unique_frequency, const IdxType *uni
 
 }  // namespace
 
-// return the old cnt of this edge
+// return the old cnt of this edge, or -1 if the table of the destination
+// node is full
 template<typename IdxType>
 inline __device__ IdxType DeviceEdgeHashmap<IdxType>::InsertEdge(
     const IdxType &src, const IdxType &dst_idx) {
@@ -197,7 +214,9 @@ inline __device__ IdxType DeviceEdgeHashmap<IdxType>::InsertEdge(
   IdxType pos = EdgeHash(src);
   IdxType delta = 1;
   IdxType old_cnt = static_cast<IdxType>(-1);
-  while (true) {
+  // the quadratic probing visits all the buckets of a power-of-two table
+  // in as many probes
+  while (delta <= _num_items_each_dst) {
     IdxType old_src = dgl::aten::cuda::AtomicCAS(
         &_edge_hashmap[start_off + pos].src, static_cast<IdxType>(-1), src);
     if (old_src == static_cast<IdxType>(-1) || old_src == src) {
@@ -241,6 +260,8 @@ FrequencyHashmap<IdxType>::FrequencyHashmap(
   _ctx = ctx;
   _stream = stream;
   num_items_each_dst = _table_size(num_items_each_dst, edge_table_scale);
+  CHECK_LE(num_dst * num_items_each_dst, std::numeric_limits<IdxType>::max())
+    << "The hash tables of the PinSAGE neighbors exceed the ID type.";
   auto device = dgl::runtime::DeviceAPI::Get(_ctx);
   auto dst_unique_edges = static_cast<IdxType*>(
       device->AllocWorkspace(_ctx, (num_dst) * sizeof(IdxType)));
@@ -250,7 +271,7 @@ FrequencyHashmap<IdxType>::FrequencyHashmap(
   constexpr int TILE_SIZE  = BLOCK_SIZE * 8;
   dim3 block(BLOCK_SIZE);
   dim3 grid((num_dst * num_items_each_dst + TILE_SIZE - 1) / TILE_SIZE);
-  cudaMemset(dst_unique_edges, 0, (num_dst) * sizeof(IdxType));
+  CUDA_CALL(cudaMemsetAsync(dst_unique_edges, 0, (num_dst) * sizeof(IdxType), _stream));
   _init_edge_table<IdxType, BLOCK_SIZE, TILE_SIZE><<<grid, block, 0, _stream>>>(
       edge_hashmap, (num_dst * num_items_each_dst));
   _device_edge_hashmap = new DeviceEdgeHashmap<IdxType>(
@@ -277,7 +298,7 @@ std::tuple<IdArray, IdArray, IdArray> FrequencyHashmap<IdxType>::Topk(
     const int64_t num_edges, const int64_t num_edges_per_node,
     const int64_t num_pick) {
 
-  using Idx64Type = int64_t;
+  using Idx64Type = uint64_t;
   const int64_t num_dst_nodes = (num_edges / num_edges_per_node);
   constexpr int BLOCK_SIZE = 256;
   // XXX: a experienced value, best performance in GV100
@@ -286,12 +307,15 @@ std::tuple<IdArray, IdArray, IdArray> FrequencyHashmap<IdxType>::Topk(
   const dim3 edges_grid((num_edges + TILE_SIZE - 1) / TILE_SIZE);
   auto device = dgl::runtime::DeviceAPI::Get(_ctx);
   const IdxType num_edge_blocks = static_cast<IdxType>(edges_grid.x);
-  IdxType num_unique_edges = 0;
+  // the bits of the sort keys of the unique edges, see _compact_frequency
+  const int cnt_bits = _num_bits(num_edges_per_node);
+  const int key_bits = cnt_bits + _num_bits(num_dst_nodes);
+  CHECK_LE(key_bits, 64) << "Too many PinSAGE neighbors to sort.";
 
   // to mark if this position of edges is the first inserting position for _edge_hashmap
   bool *is_first_position = static_cast<bool*>(
       device->AllocWorkspace(_ctx, sizeof(bool) * (num_edges)));
-  CUDA_CALL(cudaMemset(is_first_position, 0, sizeof(bool) * (num_edges)));
+  CUDA_CALL(cudaMemsetAsync(is_first_position, 0, sizeof(bool) * (num_edges), _stream));
   // double space to use ExclusiveSum
   auto edge_blocks_prefix_data = static_cast<IdxType*>(
       device->AllocWorkspace(_ctx, 2 * sizeof(IdxType) * (num_edge_blocks + 1)));
@@ -314,70 +338,58 @@ std::tuple<IdArray, IdArray, IdArray> FrequencyHashmap<IdxType>::Topk(
   void *d_temp_storage = nullptr;
   size_t temp_storage_bytes = 0;
   CUDA_CALL(cub::DeviceScan::ExclusiveSum(d_temp_storage, temp_storage_bytes,
-            edge_blocks_prefix, edge_blocks_prefix_alternate, num_edge_blocks + 1));
+            edge_blocks_prefix, edge_blocks_prefix_alternate, num_edge_blocks + 1, _stream));
   d_temp_storage = device->AllocWorkspace(_ctx, temp_storage_bytes);
   CUDA_CALL(cub::DeviceScan::ExclusiveSum(d_temp_storage, temp_storage_bytes,
-            edge_blocks_prefix, edge_blocks_prefix_alternate, num_edge_blocks + 1));
+            edge_blocks_prefix, edge_blocks_prefix_alternate, num_edge_blocks + 1, _stream));
   device->FreeWorkspace(_ctx, d_temp_storage);
   std::swap(edge_blocks_prefix, edge_blocks_prefix_alternate);
-  device->CopyDataFromTo(&edge_blocks_prefix[num_edge_blocks], 0, &num_unique_edges, 0,
-      sizeof(num_unique_edges),
-      _ctx, DGLContext{kDLCPU, 0},
-      dtype, _stream);
-  device->StreamSync(_ctx, _stream);
   // 2.2 Allocate the data of unique edges and frequency
-  // double space to use SegmentedRadixSort
+  // The number of unique edges stays on the device: the arrays are sized for
+  // all the edges, and the keys past the unique edges are zero so that they
+  // are sorted after all of them.
+  // double space to use RadixSort
   auto unique_src_edges_data = static_cast<IdxType*>(
-      device->AllocWorkspace(_ctx, 2 * sizeof(IdxType) * (num_unique_edges)));
+      device->AllocWorkspace(_ctx, 2 * sizeof(IdxType) * (num_edges)));
   IdxType *unique_src_edges = unique_src_edges_data;
-  IdxType *unique_src_edges_alternate = unique_src_edges_data + num_unique_edges;
-  // double space to use SegmentedRadixSort
+  IdxType *unique_src_edges_alternate = unique_src_edges_data + num_edges;
+  // double space to use RadixSort
   auto unique_frequency_data = static_cast<Idx64Type*>(
-      device->AllocWorkspace(_ctx, 2 * sizeof(Idx64Type) * (num_unique_edges)));
+      device->AllocWorkspace(_ctx, 2 * sizeof(Idx64Type) * (num_edges)));
   Idx64Type *unique_frequency = unique_frequency_data;
-  Idx64Type *unique_frequency_alternate = unique_frequency_data + num_unique_edges;
+  Idx64Type *unique_frequency_alternate = unique_frequency_data + num_edges;
+  CUDA_CALL(cudaMemsetAsync(unique_frequency, 0, sizeof(Idx64Type) * (num_edges), _stream));
   // 2.3 Compact the unique edges and their frequency
   _compact_frequency<IdxType, Idx64Type, BLOCK_SIZE, TILE_SIZE><<<edges_grid, block, 0, _stream>>>(
-      src_data, dst_data, num_edges, num_edges_per_node,
+      src_data, dst_data, num_edges, num_edges_per_node, cnt_bits,
       edge_blocks_prefix, is_first_position, num_unique_each_node,
       unique_src_edges, unique_frequency, *_device_edge_hashmap);
 
-  // 3. SegmentedRadixSort the unique edges and unique_frequency
+  // 3. RadixSort the unique edges and unique_frequency
   // 3.1 ExclusiveSum the num_unique_each_node
   d_temp_storage = nullptr;
   temp_storage_bytes = 0;
   CUDA_CALL(cub::DeviceScan::ExclusiveSum(d_temp_storage, temp_storage_bytes,
-            num_unique_each_node, num_unique_each_node_alternate, num_dst_nodes + 1));
+            num_unique_each_node, num_unique_each_node_alternate, num_dst_nodes + 1, _stream));
   d_temp_storage = device->AllocWorkspace(_ctx, temp_storage_bytes);
   CUDA_CALL(cub::DeviceScan::ExclusiveSum(d_temp_storage, temp_storage_bytes,
-            num_unique_each_node, num_unique_each_node_alternate, num_dst_nodes + 1));
+            num_unique_each_node, num_unique_each_node_alternate, num_dst_nodes + 1, _stream));
   device->FreeWorkspace(_ctx, d_temp_storage);
-  // 3.2 SegmentedRadixSort the unique_src_edges and unique_frequency
+  // 3.2 RadixSort the unique_src_edges and unique_frequency
+  // The keys order the edges of all the dst nodes at once, which is faster than
+  // DeviceSegmentedRadixSort, especially when num_dst_nodes is large (about ~10000),
+  // and only the bits in use are sorted.
   // Create a set of DoubleBuffers to wrap pairs of device pointers
   cub::DoubleBuffer<Idx64Type> d_unique_frequency(unique_frequency, unique_frequency_alternate);
   cub::DoubleBuffer<IdxType> d_unique_src_edges(unique_src_edges, unique_src_edges_alternate);
   // Determine temporary device storage requirements
   d_temp_storage = nullptr;
   temp_storage_bytes = 0;
-  // the DeviceRadixSort is faster than DeviceSegmentedRadixSort,
-  // especially when num_dst_nodes is large (about ~10000)
-  if (dtype.bits == 32) {
-    CUDA_CALL(cub::DeviceRadixSort::SortPairsDescending(d_temp_storage, temp_storage_bytes,
-              d_unique_frequency, d_unique_src_edges, num_unique_edges));
-  } else {
-    CUDA_CALL(cub::DeviceSegmentedRadixSort::SortPairsDescending(d_temp_storage, temp_storage_bytes,
-              d_unique_frequency, d_unique_src_edges, num_unique_edges, num_dst_nodes,
-              num_unique_each_node_alternate, num_unique_each_node_alternate + 1));
-  }
+  CUDA_CALL(cub::DeviceRadixSort::SortPairsDescending(d_temp_storage, temp_storage_bytes,
+            d_unique_frequency, d_unique_src_edges, num_edges, 0, key_bits, _stream));
   d_temp_storage = device->AllocWorkspace(_ctx, temp_storage_bytes);
-  if (dtype.bits == 32) {
-    CUDA_CALL(cub::DeviceRadixSort::SortPairsDescending(d_temp_storage, temp_storage_bytes,
-              d_unique_frequency, d_unique_src_edges, num_unique_edges));
-  } else {
-  CUDA_CALL(cub::DeviceSegmentedRadixSort::SortPairsDescending(d_temp_storage, temp_storage_bytes,
-            d_unique_frequency, d_unique_src_edges, num_unique_edges, num_dst_nodes,
-            num_unique_each_node_alternate, num_unique_each_node_alternate + 1));
-  }
+  CUDA_CALL(cub::DeviceRadixSort::SortPairsDescending(d_temp_storage, temp_storage_bytes,
+            d_unique_frequency, d_unique_src_edges, num_edges, 0, key_bits, _stream));
   device->FreeWorkspace(_ctx, d_temp_storage);
 
   // 4. Get the final pick number for each dst node
@@ -391,13 +403,14 @@ std::tuple<IdArray, IdArray, IdArray> FrequencyHashmap<IdxType>::Topk(
   d_temp_storage = nullptr;
   temp_storage_bytes = 0;
   CUDA_CALL(cub::DeviceScan::ExclusiveSum(d_temp_storage, temp_storage_bytes,
-            num_unique_each_node, unique_output_offsets, num_dst_nodes + 1));
+            num_unique_each_node, unique_output_offsets, num_dst_nodes + 1, _stream));
   d_temp_storage = device->AllocWorkspace(_ctx, temp_storage_bytes);
   CUDA_CALL(cub::DeviceScan::ExclusiveSum(d_temp_storage, temp_storage_bytes,
-            num_unique_each_node, unique_output_offsets, num_dst_nodes + 1));
+            num_unique_each_node, unique_output_offsets, num_dst_nodes + 1, _stream));
   device->FreeWorkspace(_ctx, d_temp_storage);
 
   // 5. Pick the data to result
+  // the only copy to the host, which sizes the output
   IdxType num_output = 0;
   device->CopyDataFromTo(&unique_output_offsets[num_dst_nodes], 0, &num_output, 0,
       sizeof(num_output),
@@ -413,7 +426,7 @@ std::tuple<IdArray, IdArray, IdArray> FrequencyHashmap<IdxType>::Topk(
       dtype, _ctx);
   _pick_data<IdxType, Idx64Type, BLOCK_SIZE, NODE_TILE_SIZE><<<nodes_grid, block, 0, _stream>>>(
       d_unique_frequency.Current(), d_unique_src_edges.Current(), num_unique_each_node_alternate,
-      dst_data, num_edges_per_node, num_dst_nodes, num_edges,
+      dst_data, num_edges_per_node, num_dst_nodes, num_edges, cnt_bits,
       unique_output_offsets,
       res_src.Ptr<IdxType>(), res_dst.Ptr<IdxType>(), res_cnt.Ptr<IdxType>());
 
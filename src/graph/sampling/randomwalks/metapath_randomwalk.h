@@ -27,10 +27,13 @@ namespace impl {
 
 namespace {
 
+// The predicates for terminating a random walk path are callables of signature
 // bool WhetherToTerminate(
 //     IdxType *node_ids_generated_so_far,
 //     dgl_id_t last_node_id_generated,
 //     int64_t number_of_nodes_generated_so_far)
+// The walkers are templated on their type, so that every variant of the random
+// walk compiles to its own loop without indirect calls.
 template<typename IdxType>
 using TerminatePredicate = std::function<bool(IdxType *, dgl_id_t, int64_t)>;
 
@@ -46,12 +49,15 @@ using TerminatePredicate = std::function<bool(IdxType *, dgl_id_t, int64_t)>;
  * \param edges_by_type Vector of results from \c GetAdj() by edge type.
  * \param metapath_data Edge types of given metapath.
  * \param prob Transition probability per edge type.
+ * \param alias_accept The acceptance probabilities of the alias table of \c prob per
+ *        edge type, or a null array.
+ * \param alias The aliases of the alias table of \c prob per edge type, or a null array.
  * \param terminate Predicate for terminating the current random walk path.
  *
  * \return A tuple of ID of next successor (-1 if not exist), the last traversed edge
  *         ID, as well as whether to terminate.
  */
-template<DLDeviceType XPU, typename IdxType>
+template<DLDeviceType XPU, typename IdxType, typename Terminate>
 std::tuple<dgl_id_t, dgl_id_t, bool> MetapathRandomWalkStep(
     IdxType *data,
     dgl_id_t curr,
@@ -60,7 +66,9 @@ std::tuple<dgl_id_t, dgl_id_t, bool> MetapathRandomWalkStep(
     const std::vector<bool> &csr_has_data,
     const IdxType *metapath_data,
     const std::vector<FloatArray> &prob,
-    TerminatePredicate<IdxType> terminate) {
+    const std::vector<FloatArray> &alias_accept,
+    const std::vector<IdArray> &alias,
+    const Terminate &terminate) {
   dgl_type_t etype = metapath_data[len];
 
   // Note that since the selection of successors is very lightweight (especially in the
@@ -87,6 +95,18 @@ std::tuple<dgl_id_t, dgl_id_t, bool> MetapathRandomWalkStep(
   if (IsNullArray(prob_etype)) {
     // empty probability array; assume uniform
     idx = RandomEngine::ThreadLocal()->RandInt(size);
+  } else if (!IsNullArray(alias[etype])) {
+    // alias table; as cheap as the uniform choice
+    ATEN_FLOAT_TYPE_SWITCH(prob_etype->dtype, DType, "probability", {
+      const DType *accept_data = alias_accept[etype].Ptr<DType>();
+      const IdxType *alias_data = alias[etype].Ptr<IdxType>();
+      const IdxType k = RandomEngine::ThreadLocal()->RandInt(size);
+      const IdxType e = eids ? eids[k] : (k + offsets[curr]);
+      idx = RandomEngine::ThreadLocal()->Uniform<DType>() < accept_data[e] ? k : alias_data[e];
+      // the table of a row without weight is uniform, but the walk stops there
+      if (prob_etype.Ptr<DType>()[eids ? eids[idx] : (idx + offsets[curr])] == 0)
+        return std::make_tuple(-1, -1, true);
+    });
   } else {
     ATEN_FLOAT_TYPE_SWITCH(prob_etype->dtype, DType, "probability", {
       FloatArray prob_selected = FloatArray::Empty({size}, prob_etype->dtype, prob_etype->ctx);
@@ -119,7 +139,7 @@ std::tuple<dgl_id_t, dgl_id_t, bool> MetapathRandomWalkStep(
  * \return A pair of ID of next successor (-1 if not exist), as well as whether to terminate.
  * \note This function is called only if all the probability arrays are null.
  */
-template<DLDeviceType XPU, typename IdxType>
+template<DLDeviceType XPU, typename IdxType, typename Terminate>
 std::tuple<dgl_id_t, dgl_id_t, bool> MetapathRandomWalkStepUniform(
     IdxType *data,
     dgl_id_t curr,
@@ -128,7 +148,7 @@ std::tuple<dgl_id_t, dgl_id_t, bool> MetapathRandomWalkStepUniform(
     const std::vector<bool> &csr_has_data,
     const IdxType *metapath_data,
     const std::vector<FloatArray> &prob,
-    TerminatePredicate<IdxType> terminate) {
+    const Terminate &terminate) {
   dgl_type_t etype = metapath_data[len];
 
   // Note that since the selection of successors is very lightweight (especially in the
@@ -163,17 +183,26 @@ std::tuple<dgl_id_t, dgl_id_t, bool> MetapathRandomWalkStepUniform(
  * \param metapath A 1D array of edge types representing the metapath.
  * \param prob A vector of 1D float arrays, indicating the transition probability of
  *        each edge by edge type.  An empty float array assumes uniform transition.
+ * \param alias_accept A vector of the acceptance probabilities of the alias tables
+ *        of \c prob by edge type, or null arrays.
+ * \param alias A vector of the aliases of the alias tables of \c prob by edge type,
+ *        or null arrays.
  * \param terminate Predicate for terminating a random walk path.
+ * \param random_seed The seed of the walks, or a negative number to draw them from
+ *        the thread-local random engine.  See GenericRandomWalk.
  * \return A 2D array of shape (len(seeds), len(metapath) + 1) with node IDs, and
  *         A 2D array of shape (len(seeds), len(metapath)) with edge IDs.
  */
-template<DLDeviceType XPU, typename IdxType>
+template<DLDeviceType XPU, typename IdxType, typename Terminate>
 std::pair<IdArray, IdArray> MetapathBasedRandomWalk(
     const HeteroGraphPtr hg,
     const IdArray seeds,
     const TypeArray metapath,
     const std::vector<FloatArray> &prob,
-    TerminatePredicate<IdxType> terminate) {
+    const std::vector<FloatArray> &alias_accept,
+    const std::vector<IdArray> &alias,
+    const Terminate &terminate,
+    int64_t random_seed) {
   int64_t max_num_steps = metapath->shape[0];
   const IdxType *metapath_data = static_cast<IdxType *>(metapath->data);
   const int64_t begin_ntype = hg->meta_graph()->FindEdge(metapath_data[0]).first;
@@ -190,6 +219,12 @@ std::pair<IdArray, IdArray> MetapathBasedRandomWalk(
     const CSRMatrix &csr = hg->GetCSRMatrix(etype);
     edges_by_type[etype] = csr;
     csr_has_data[etype] = CSRHasData(csr);
+    if (!IsNullArray(alias[etype])) {
+      CHECK_EQ(alias[etype]->dtype.bits, sizeof(IdxType) * 8)
+        << "The alias table of edge type " << etype << " does not match the graph.";
+      CHECK_EQ(alias[etype]->shape[0], hg->NumEdges(etype))
+        << "The alias table of edge type " << etype << " does not match the graph.";
+    }
   }
 
   // Hoist the check for Uniform vs Non uniform edge distribution
@@ -202,21 +237,23 @@ std::pair<IdArray, IdArray> MetapathBasedRandomWalk(
     }
   }
   if (!isUniform) {
-    StepFunc<IdxType> step =
-      [&edges_by_type, &csr_has_data, metapath_data, &prob, terminate]
+    auto step =
+      [&edges_by_type, &csr_has_data, metapath_data, &prob, &alias_accept, &alias,
+       &terminate]
       (IdxType *data, dgl_id_t curr, int64_t len) {
         return MetapathRandomWalkStep<XPU, IdxType>(
-            data, curr, len, edges_by_type, csr_has_data, metapath_data, prob, terminate);
+            data, curr, len, edges_by_type, csr_has_data, metapath_data, prob,
+            alias_accept, alias, terminate);
       };
-    return GenericRandomWalk<XPU, IdxType>(seeds, max_num_steps, step, max_nodes);
+    return GenericRandomWalk<XPU, IdxType>(seeds, max_num_steps, step, max_nodes, random_seed);
   } else {
-    StepFunc<IdxType> step =
-      [&edges_by_type, &csr_has_data, metapath_data, &prob, terminate]
+    auto step =
+      [&edges_by_type, &csr_has_data, metapath_data, &prob, &terminate]
       (IdxType *data, dgl_id_t curr, int64_t len) {
         return MetapathRandomWalkStepUniform<XPU, IdxType>(
             data, curr, len, edges_by_type, csr_has_data, metapath_data, prob, terminate);
       };
-    return GenericRandomWalk<XPU, IdxType>(seeds, max_num_steps, step, max_nodes);
+    return GenericRandomWalk<XPU, IdxType>(seeds, max_num_steps, step, max_nodes, random_seed);
   }
 }
 
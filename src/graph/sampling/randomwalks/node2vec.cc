@@ -32,13 +32,26 @@ void CheckNode2vecInputs(const HeteroGraphPtr hg, const IdArray seeds,
 std::pair<IdArray, IdArray> Node2vec(
     const HeteroGraphPtr hg, const IdArray seeds, const double p,
     const double q, const int64_t walk_length,
-    const FloatArray &prob) {
+    const FloatArray &prob, const IdArray &neighbor_filter,
+    const int64_t random_seed) {
   CheckNode2vecInputs(hg, seeds, p, q, walk_length, prob);
 
   std::pair<IdArray, IdArray> result;
-  ATEN_XPU_SWITCH(hg->Context().device_type, XPU, "Node2vec", {
+  ATEN_XPU_SWITCH_CUDA(hg->Context().device_type, XPU, "Node2vec", {
     ATEN_ID_TYPE_SWITCH(seeds->dtype, IdxType, {
-      result = impl::Node2vec<XPU, IdxType>(hg, seeds, p, q, walk_length, prob);
+      result = impl::Node2vec<XPU, IdxType>(
+          hg, seeds, p, q, walk_length, prob, neighbor_filter, random_seed);
+    });
+  });
+
+  return result;
+}
+
+IdArray Node2vecNeighborFilter(const HeteroGraphPtr hg) {
+  IdArray result;
+  ATEN_XPU_SWITCH(hg->Context().device_type, XPU, "Node2vecNeighborFilter", {
+    ATEN_ID_TYPE_SWITCH(hg->DataType(), IdxType, {
+      result = impl::Node2vecNeighborFilter<XPU, IdxType>(hg);
     });
   });
 
@@ -53,9 +66,11 @@ DGL_REGISTER_GLOBAL("sampling.randomwalks._CAPI_DGLSamplingNode2vec")
       double q = args[3];
       int64_t walk_length = args[4];
       FloatArray prob = args[5];
+      IdArray neighbor_filter = args[6];
+      int64_t random_seed = args[7];
 
-      auto result =
-          sampling::Node2vec(hg.sptr(), seeds, p, q, walk_length, prob);
+      auto result = sampling::Node2vec(
+          hg.sptr(), seeds, p, q, walk_length, prob, neighbor_filter, random_seed);
 
       List<Value> ret;
       ret.push_back(Value(MakeValue(result.first)));
@@ -63,6 +78,12 @@ DGL_REGISTER_GLOBAL("sampling.randomwalks._CAPI_DGLSamplingNode2vec")
       *rv = ret;
     });
 
+DGL_REGISTER_GLOBAL("sampling.randomwalks._CAPI_DGLSamplingNode2vecNeighborFilter")
+    .set_body([](DGLArgs args, DGLRetValue *rv) {
+      HeteroGraphRef hg = args[0];
+      *rv = sampling::Node2vecNeighborFilter(hg.sptr());
+    });
+
 }  // namespace
 
 }  // namespace sampling
@@ -23,12 +23,17 @@ template <DLDeviceType XPU, typename IdxType>
 std::pair<IdArray, IdArray> Node2vec(
     const HeteroGraphPtr hg, const IdArray seeds, const double p,
     const double q, const int64_t walk_length,
-    const FloatArray &prob) {
-  TerminatePredicate<IdxType> terminate = [](IdxType *data, dgl_id_t curr,
-                                             int64_t len) { return false; };
+    const FloatArray &prob, const IdArray &neighbor_filter,
+    const int64_t random_seed) {
+  auto terminate = [](IdxType *data, dgl_id_t curr, int64_t len) { return false; };
 
   return Node2vecRandomWalk<XPU, IdxType>(hg, seeds, p, q, walk_length, prob,
-                                          terminate);
+                                          neighbor_filter, terminate, random_seed);
+}
+
+template <DLDeviceType XPU, typename IdxType>
+IdArray Node2vecNeighborFilter(const HeteroGraphPtr hg) {
+  return BuildNeighborFilter<IdxType>(hg->GetCSRMatrix(0));
 }
 
 template std::pair<IdArray, IdArray> Node2vec<kDLCPU, int32_t>(
@@ -36,13 +41,20 @@ template std::pair<IdArray, IdArray> Node2vec<kDLCPU, int32_t>(
     const IdArray seeds, const double p,
     const double q,
     const int64_t walk_length,
-    const FloatArray &prob);
+    const FloatArray &prob,
+    const IdArray &neighbor_filter,
+    const int64_t random_seed);
 template std::pair<IdArray, IdArray> Node2vec<kDLCPU, int64_t>(
     const HeteroGraphPtr hg,
     const IdArray seeds, const double p,
     const double q,
     const int64_t walk_length,
-    const FloatArray &prob);
+    const FloatArray &prob,
+    const IdArray &neighbor_filter,
+    const int64_t random_seed);
+
+template IdArray Node2vecNeighborFilter<kDLCPU, int32_t>(const HeteroGraphPtr hg);
+template IdArray Node2vecNeighborFilter<kDLCPU, int64_t>(const HeteroGraphPtr hg);
 
 };  // namespace impl
 
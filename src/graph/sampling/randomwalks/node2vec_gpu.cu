@@ -0,0 +1,205 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file graph/sampling/node2vec_gpu.cu
+ * \brief DGL sampler - GPU implementation of node2vec random walk
+ */
+
+#include <dgl/array.h>
+#include <dgl/base_heterograph.h>
+#include <dgl/runtime/device_api.h>
+#include <dgl/random.h>
+#include <curand_kernel.h>
+#include <algorithm>
+#include <utility>
+
+#include "node2vec_impl.h"
+#include "randomwalk_gpu.cuh"
+
+namespace dgl {
+
+using namespace dgl::runtime;
+using namespace dgl::aten;
+
+namespace sampling {
+
+namespace impl {
+
+namespace {
+
+/*!
+ * \brief Whether there is an edge from u to v, by binary search in the row of u
+ *        of a sorted CSR.
+ */
+template<typename IdType>
+__device__ bool _HasEdgeBetween(const GraphKernelData<IdType> &graph, IdType u, IdType v) {
+  int64_t lo = graph.in_ptr[u];
+  const int64_t end = graph.in_ptr[u + 1];
+  int64_t hi = end;
+  while (lo < hi) {
+    const int64_t mid = (lo + hi) / 2;
+    if (graph.in_cols[mid] < v)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo < end && graph.in_cols[lo] == v;
+}
+
+/*!
+ * \brief Generate the node2vec random walks, one thread per seed.
+ *
+ * Every step after the first one draws a candidate from the neighbors turn by
+ * turn, and accepts it with the probability prob0 if it goes back to the
+ * previous node, prob1 if it is a neighbor of the previous node and prob2
+ * otherwise.
+ */
+template<typename IdType, int BLOCK_SIZE, int TILE_SIZE>
+__global__ void _Node2vecKernel(
+    const uint64_t rand_seed, const IdType *seed_data, const int64_t num_seeds,
+    const int64_t max_num_steps,
+    const GraphKernelData<IdType> graph,
+    const double prob0, const double prob1, const double prob2,
+    IdType *out_traces_data,
+    IdType *out_eids_data) {
+  assert(BLOCK_SIZE == blockDim.x);
+  int64_t idx = blockIdx.x * TILE_SIZE + threadIdx.x;
+  int64_t last_idx = min(static_cast<int64_t>(blockIdx.x + 1) * TILE_SIZE, num_seeds);
+  int64_t trace_length = (max_num_steps + 1);
+  curandState rng;
+  curand_init(rand_seed + idx, 0, 0, &rng);
+
+  while (idx < last_idx) {
+    IdType curr = seed_data[idx];
+    IdType pre = curr;
+    IdType *traces_data_ptr = &out_traces_data[idx * trace_length];
+    IdType *eids_data_ptr = &out_eids_data[idx * max_num_steps];
+    *(traces_data_ptr++) = curr;
+    int64_t step_idx;
+    for (step_idx = 0; step_idx < max_num_steps; ++step_idx) {
+      const int64_t in_row_start = graph.in_ptr[curr];
+      const int64_t deg = graph.in_ptr[curr + 1] - graph.in_ptr[curr];
+      if (deg == 0) {  // isolated node
+        break;
+      }
+      int64_t num;
+      IdType pick;
+      while (true) {
+        num = PickNeighbor(graph, in_row_start, deg, &rng);
+        if (num < 0)
+          break;
+        pick = graph.in_cols[num];
+        if (step_idx == 0)
+          break;
+        const double r = 1. - curand_uniform_double(&rng);
+        if (pick == pre) {
+          if (r < prob0) break;
+        } else if (_HasEdgeBetween(graph, pick, pre)) {
+          if (r < prob1) break;
+        } else if (r < prob2) {
+          break;
+        }
+      }
+      if (num < 0) {  // none of the neighbors can be picked
+        break;
+      }
+      *(traces_data_ptr++) = pick;
+      *(eids_data_ptr++) = (graph.data ? graph.data[num] : num);
+      pre = curr;
+      curr = pick;
+    }
+    for (; step_idx < max_num_steps; ++step_idx) {
+      *(traces_data_ptr++) = -1;
+      *(eids_data_ptr++) = -1;
+    }
+    idx += BLOCK_SIZE;
+  }
+}
+
+}  // namespace
+
+template <DLDeviceType XPU, typename IdxType>
+std::pair<IdArray, IdArray> Node2vec(
+    const HeteroGraphPtr hg, const IdArray seeds, const double p,
+    const double q, const int64_t walk_length,
+    const FloatArray &prob, const IdArray &neighbor_filter,
+    const int64_t random_seed) {
+  CHECK(seeds->ctx.device_type == kDLGPU) << "seeds should be in GPU.";
+  const IdxType *seed_data = static_cast<const IdxType*>(seeds->data);
+  const int64_t num_seeds = seeds->shape[0];
+  const int64_t trace_length = walk_length + 1;
+  IdArray traces = IdArray::Empty({num_seeds, trace_length}, seeds->dtype, seeds->ctx);
+  IdArray eids = IdArray::Empty({num_seeds, walk_length}, seeds->dtype, seeds->ctx);
+
+  // the check for the edges between the candidates and the previous node
+  // searches the sorted neighbors
+  CSRMatrix csr = hg->GetCSRMatrix(0);  // homogeneous graph.
+  CHECK(csr.indptr->ctx.device_type == kDLGPU) << "graph should be in GPU.";
+  if (!csr.sorted)
+    csr = CSRSort(csr);
+  const auto &ctx = csr.indptr->ctx;
+  auto device = DeviceAPI::Get(ctx);
+  // use default stream
+  cudaStream_t stream = 0;
+
+  double *cdf = IsNullArray(prob) ? nullptr : BuildTransitionCDF<IdxType>(csr, prob, stream);
+  GraphKernelData<IdxType> graph;
+  graph.in_ptr = csr.indptr.Ptr<IdxType>();
+  graph.in_cols = csr.indices.Ptr<IdxType>();
+  graph.data = CSRHasData(csr) ? csr.data.Ptr<IdxType>() : nullptr;
+  graph.cdf = cdf;
+  graph.alias_prob = nullptr;
+  graph.alias_accept = nullptr;
+  graph.alias = nullptr;
+
+  // Normalize the weights to compute rejection probabilities
+  const double max_prob = std::max({1 / p, 1.0, 1 / q});
+  const double prob0 = 1 / p / max_prob;
+  const double prob1 = 1 / max_prob;
+  const double prob2 = 1 / q / max_prob;
+
+  if (num_seeds > 0) {
+    constexpr int BLOCK_SIZE = 256;
+    constexpr int TILE_SIZE = BLOCK_SIZE * 4;
+    dim3 block(BLOCK_SIZE);
+    dim3 grid((num_seeds + TILE_SIZE - 1) / TILE_SIZE);
+    const uint64_t kernel_seed = random_seed >= 0 ?
+      random_seed : RandomEngine::ThreadLocal()->RandInt(1000000000);
+    CUDA_KERNEL_CALL((_Node2vecKernel<IdxType, BLOCK_SIZE, TILE_SIZE>),
+        grid, block, 0, stream,
+        kernel_seed,
+        seed_data,
+        num_seeds,
+        walk_length,
+        graph,
+        prob0, prob1, prob2,
+        traces.Ptr<IdxType>(),
+        eids.Ptr<IdxType>());
+  }
+
+  if (cdf)
+    device->FreeWorkspace(ctx, cdf);
+  return std::make_pair(traces, eids);
+}
+
+template std::pair<IdArray, IdArray> Node2vec<kDLGPU, int32_t>(
+    const HeteroGraphPtr hg,
+    const IdArray seeds, const double p,
+    const double q,
+    const int64_t walk_length,
+    const FloatArray &prob,
+    const IdArray &neighbor_filter,
+    const int64_t random_seed);
+template std::pair<IdArray, IdArray> Node2vec<kDLGPU, int64_t>(
+    const HeteroGraphPtr hg,
+    const IdArray seeds, const double p,
+    const double q,
+    const int64_t walk_length,
+    const FloatArray &prob,
+    const IdArray &neighbor_filter,
+    const int64_t random_seed);
+
+};  // namespace impl
+
+};  // namespace sampling
+
+};  // namespace dgl
@@ -37,6 +37,11 @@ namespace impl {
  * \param prob A vector of 1D float arrays, indicating the transition
  *        probability of each edge by edge type.  An empty float array assumes uniform
  *        transition.
+ * \param neighbor_filter The neighbor filter of the graph from Node2vecNeighborFilter,
+ *        or an empty array.  Only used on CPU.
+ * \param random_seed The seed of the walks, or a negative number to draw them from
+ *        the thread-local random engine.  With a seed, the walk from the i-th seed
+ *        node only depends on \c random_seed and i, whatever the number of threads.
  * \return A 2D array of shape (len(seeds), len(walk_length) + 1)
  *         with node IDs.  The paths that terminated early are padded with -1.
  */
@@ -44,7 +49,18 @@ template <DLDeviceType XPU, typename IdxType>
 std::pair<IdArray, IdArray> Node2vec(
     const HeteroGraphPtr hg, const IdArray seeds, const double p,
     const double q, const int64_t walk_length,
-    const FloatArray &prob);
+    const FloatArray &prob, const IdArray &neighbor_filter,
+    const int64_t random_seed);
+
+/*!
+ * \brief Build the neighbor filter of a graph for the node2vec random walks, which
+ *        speeds up the check of the edges between the candidates and the previous
+ *        node of a walk.
+ * \param hg The homogeneous graph.
+ * \return The filter, with one int64 element per edge.
+ */
+template <DLDeviceType XPU, typename IdxType>
+IdArray Node2vecNeighborFilter(const HeteroGraphPtr hg);
 
 };  // namespace impl
 
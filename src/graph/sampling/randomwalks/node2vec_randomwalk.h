@@ -10,6 +10,7 @@
 #include <dgl/array.h>
 #include <dgl/base_heterograph.h>
 #include <dgl/random.h>
+#include <dgl/runtime/parallel_for.h>
 
 #include <algorithm>
 #include <cmath>
@@ -33,14 +34,78 @@ namespace impl {
 
 namespace {
 
+/*!
+ * \brief The two bits set by a node in the neighbor filter of a row with the given
+ *        number of neighbors.
+ */
+inline std::pair<uint64_t, uint64_t> NeighborFilterBits(dgl_id_t v, int64_t size) {
+  // splitmix64 finalizer, whose two halves are the two hashes of the node
+  uint64_t h = static_cast<uint64_t>(v) + 0x9E3779B97F4A7C15ULL;
+  h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+  h ^= h >> 31;
+  const uint64_t num_bits = static_cast<uint64_t>(size) * 64;
+  return std::make_pair((h >> 32) % num_bits, (h & 0xFFFFFFFFULL) % num_bits);
+}
+
+/*!
+ * \brief Build the neighbor filter of a CSR matrix, i.e. a Bloom filter of the
+ *        successors of every node with two hash functions and 64 bits per
+ *        successor.
+ *
+ * The filter of a node is made of the words at the positions of its row in the
+ * CSR, so the array has one 64-bit word per edge and does not depend on the order
+ * of the successors.
+ *
+ * \param csr The CSR matrix.
+ * \return The filter as an int64 array with one element per edge.
+ */
+template <typename IdxType>
+IdArray BuildNeighborFilter(const CSRMatrix &csr) {
+  const IdxType *offsets = csr.indptr.Ptr<IdxType>();
+  const IdxType *all_succ = csr.indices.Ptr<IdxType>();
+  const int64_t nnz = csr.indices->shape[0];
+  IdArray filter = Full<int64_t>(0, nnz, csr.indptr->ctx);
+  uint64_t *words = static_cast<uint64_t *>(filter->data);
+
+  // every row only writes its own words
+  runtime::parallel_for(0, csr.num_rows, [&](size_t b, size_t e) {
+    for (size_t u = b; u < e; ++u) {
+      const int64_t size = offsets[u + 1] - offsets[u];
+      uint64_t *u_words = words + offsets[u];
+      for (IdxType j = offsets[u]; j < offsets[u + 1]; ++j) {
+        const auto bits = NeighborFilterBits(all_succ[j], size);
+        u_words[bits.first / 64] |= 1ULL << (bits.first % 64);
+        u_words[bits.second / 64] |= 1ULL << (bits.second % 64);
+      }
+    }
+  });
+  return filter;
+}
+
+/*!
+ * \brief Whether there is an edge from u to v.
+ *
+ * The neighbor filter, if given, rules out most of the nodes that are not
+ * successors of u without reading the successors.
+ */
 template <typename IdxType>
 bool has_edge_between(const CSRMatrix &csr, dgl_id_t u,
-                      dgl_id_t v) {
+                      dgl_id_t v, const uint64_t *filter) {
   const IdxType *offsets = csr.indptr.Ptr<IdxType>();
   const IdxType *all_succ = csr.indices.Ptr<IdxType>();
   const IdxType *u_succ = all_succ + offsets[u];
   const int64_t size = offsets[u + 1] - offsets[u];
 
+  if (size == 0)
+    return false;
+  if (filter) {
+    const uint64_t *u_words = filter + offsets[u];
+    const auto bits = NeighborFilterBits(v, size);
+    if (!((u_words[bits.first / 64] >> (bits.first % 64)) & 1) ||
+        !((u_words[bits.second / 64] >> (bits.second % 64)) & 1))
+      return false;
+  }
   if (csr.sorted)
     return std::binary_search(u_succ, u_succ + size, v);
   else
@@ -59,17 +124,18 @@ bool has_edge_between(const CSRMatrix &csr, dgl_id_t u,
  * \param len The number of nodes generated so far.  Note that the seed node is
  *        always included as \c data[0], and the successors start from \c data[1].
  * \param csr The CSR matrix
+ * \param filter The neighbor filter of the CSR matrix, or null.
  * \param prob Transition probability
  * \param terminate Predicate for terminating the current random walk path.
  * \return A tuple of ID of next successor (-1 if not exist), the edge ID traversed,
  *         as well as whether to terminate.
  */
 
-template <DLDeviceType XPU, typename IdxType>
+template <DLDeviceType XPU, typename IdxType, typename Terminate>
 std::tuple<dgl_id_t, dgl_id_t, bool> Node2vecRandomWalkStep(
     IdxType *data, dgl_id_t curr, dgl_id_t pre, const double p, const double q,
-    int64_t len, const CSRMatrix &csr, bool csr_has_data, const FloatArray &probs,
-    TerminatePredicate<IdxType> terminate) {
+    int64_t len, const CSRMatrix &csr, bool csr_has_data, const uint64_t *filter,
+    const FloatArray &probs, const Terminate &terminate) {
   const IdxType *offsets = csr.indptr.Ptr<IdxType>();
   const IdxType *all_succ = csr.indices.Ptr<IdxType>();
   const IdxType *all_eids = csr_has_data ? csr.data.Ptr<IdxType>() : nullptr;
@@ -106,7 +172,7 @@ std::tuple<dgl_id_t, dgl_id_t, bool> Node2vecRandomWalkStep(
         next_node = succ[idx];
         if (next_node == pre) {
           if (r < prob0) break;
-        } else if (has_edge_between<IdxType>(csr, next_node, pre)) {
+        } else if (has_edge_between<IdxType>(csr, next_node, pre, filter)) {
           if (r < prob1) break;
         } else if (r < prob2) {
           break;
@@ -133,7 +199,7 @@ std::tuple<dgl_id_t, dgl_id_t, bool> Node2vecRandomWalkStep(
         next_node = succ[idx];
         if (next_node == pre) {
           if (r < prob0) break;
-        } else if (has_edge_between<IdxType>(csr, next_node, pre)) {
+        } else if (has_edge_between<IdxType>(csr, next_node, pre, filter)) {
           if (r < prob1) break;
         } else if (r < prob2) {
           break;
@@ -146,24 +212,37 @@ std::tuple<dgl_id_t, dgl_id_t, bool> Node2vecRandomWalkStep(
   return std::make_tuple(next_node, eid, terminate(data, next_node, len));
 }
 
-template <DLDeviceType XPU, typename IdxType>
+template <DLDeviceType XPU, typename IdxType, typename Terminate>
 std::pair<IdArray, IdArray> Node2vecRandomWalk(
     const HeteroGraphPtr g, const IdArray seeds,
     const double p, const double q,
     const int64_t max_num_steps, const FloatArray &prob,
-    TerminatePredicate<IdxType> terminate) {
-  const CSRMatrix &edges = g->GetCSRMatrix(0);  // homogeneous graph.
+    const IdArray &neighbor_filter,
+    const Terminate &terminate,
+    const int64_t random_seed) {
+  // Sort the successors so that the edge checks of the rejection sampling are
+  // binary searches.
+  const CSRMatrix edges = CSRSort(g->GetCSRMatrix(0));  // homogeneous graph.
   bool csr_has_data = CSRHasData(edges);
+  const uint64_t *filter = nullptr;
+  if (!IsNullArray(neighbor_filter)) {
+    CHECK_EQ(neighbor_filter->dtype.bits, 64) << "The neighbor filter must be int64.";
+    CHECK_EQ(neighbor_filter->shape[0], edges.indices->shape[0])
+      << "The neighbor filter must have one element per edge.";
+    filter = static_cast<const uint64_t *>(neighbor_filter->data);
+  }
 
-  StepFunc<IdxType> step =
-    [&edges, csr_has_data, &prob, p, q, terminate]
+  auto step =
+    [&edges, csr_has_data, filter, &prob, p, q, &terminate]
     (IdxType *data, dgl_id_t curr, int64_t len) {
       dgl_id_t pre = (len != 0) ? data[len - 1] : curr;
       return Node2vecRandomWalkStep<XPU, IdxType>(data, curr, pre, p, q, len,
-                                                  edges, csr_has_data, prob, terminate);
+                                                  edges, csr_has_data, filter, prob,
+                                                  terminate);
     };
 
-  return GenericRandomWalk<XPU, IdxType>(seeds, max_num_steps, step, g->NumVertices(0));
+  return GenericRandomWalk<XPU, IdxType>(
+      seeds, max_num_steps, step, g->NumVertices(0), random_seed);
 }
 
 };  // namespace
@@ -28,13 +28,17 @@ std::pair<IdArray, IdArray> RandomWalk(
     const HeteroGraphPtr hg,
     const IdArray seeds,
     const TypeArray metapath,
-    const std::vector<FloatArray> &prob) {
-  TerminatePredicate<IdxType> terminate =
+    const std::vector<FloatArray> &prob,
+    const std::vector<FloatArray> &alias_accept,
+    const std::vector<IdArray> &alias,
+    int64_t random_seed) {
+  auto terminate =
     [] (IdxType *data, dgl_id_t curr, int64_t len) {
       return false;
     };
 
-  return MetapathBasedRandomWalk<XPU, IdxType>(hg, seeds, metapath, prob, terminate);
+  return MetapathBasedRandomWalk<XPU, IdxType>(
+      hg, seeds, metapath, prob, alias_accept, alias, terminate, random_seed);
 }
 
 template<DLDeviceType XPU, typename IdxType>
@@ -42,7 +46,8 @@ std::tuple<IdArray, IdArray, IdArray> SelectPinSageNeighbors(
     const IdArray src,
     const IdArray dst,
     const int64_t num_samples_per_node,
-    const int64_t k) {
+    const int64_t k,
+    const int64_t hashmap_size) {
   CHECK(src->ctx.device_type == kDLCPU) << "IdArray needs be on CPU!";
   int64_t len = src->shape[0] / num_samples_per_node;
   IdxType* src_data = src.Ptr<IdxType>();
@@ -111,26 +116,34 @@ std::pair<IdArray, IdArray> RandomWalk<kDLCPU, int32_t>(
     const HeteroGraphPtr hg,
     const IdArray seeds,
     const TypeArray metapath,
-    const std::vector<FloatArray> &prob);
+    const std::vector<FloatArray> &prob,
+    const std::vector<FloatArray> &alias_accept,
+    const std::vector<IdArray> &alias,
+    int64_t random_seed);
 template
 std::pair<IdArray, IdArray> RandomWalk<kDLCPU, int64_t>(
     const HeteroGraphPtr hg,
     const IdArray seeds,
     const TypeArray metapath,
-    const std::vector<FloatArray> &prob);
+    const std::vector<FloatArray> &prob,
+    const std::vector<FloatArray> &alias_accept,
+    const std::vector<IdArray> &alias,
+    int64_t random_seed);
 
 template
 std::tuple<IdArray, IdArray, IdArray> SelectPinSageNeighbors<kDLCPU, int32_t>(
     const IdArray src,
     const IdArray dst,
     const int64_t num_samples_per_node,
-    const int64_t k);
+    const int64_t k,
+    const int64_t hashmap_size);
 template
 std::tuple<IdArray, IdArray, IdArray> SelectPinSageNeighbors<kDLCPU, int64_t>(
     const IdArray src,
     const IdArray dst,
     const int64_t num_samples_per_node,
-    const int64_t k);
+    const int64_t k,
+    const int64_t hashmap_size);
 
 };  // namespace impl
 
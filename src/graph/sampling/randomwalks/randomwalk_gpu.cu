@@ -9,11 +9,13 @@
 #include <dgl/runtime/device_api.h>
 #include <dgl/random.h>
 #include <curand_kernel.h>
+#include <algorithm>
 #include <vector>
 #include <utility>
 #include <tuple>
 
 #include "frequency_hashmap.cuh"
+#include "randomwalk_gpu.cuh"
 
 namespace dgl {
 
@@ -26,13 +28,6 @@ namespace impl {
 
 namespace {
 
-template<typename IdType>
-struct GraphKernelData {
-  const IdType *in_ptr;
-  const IdType *in_cols;
-  const IdType *data;
-};
-
 template<typename IdType, typename FloatType, int BLOCK_SIZE, int TILE_SIZE>
 __global__ void _RandomWalkKernel(
     const uint64_t rand_seed, const IdType *seed_data, const int64_t num_seeds,
@@ -65,9 +60,12 @@ __global__ void _RandomWalkKernel(
       if (deg == 0) {  // the degree is zero
         break;
       }
-      const int64_t num = curand(&rng) % deg;
-      IdType pick = graph.in_cols[in_row_start + num];
-      IdType eid = (graph.data? graph.data[in_row_start + num] : in_row_start + num);
+      const int64_t num = PickNeighbor(graph, in_row_start, deg, &rng);
+      if (num < 0) {  // none of the neighbors can be picked
+        break;
+      }
+      IdType pick = graph.in_cols[num];
+      IdType eid = (graph.data? graph.data[num] : num);
       *traces_data_ptr = pick;
       *eids_data_ptr = eid;
       if ((restart_prob_size > 1) && (curand_uniform(&rng) < restart_prob_data[step_idx])) {
@@ -88,13 +86,18 @@ __global__ void _RandomWalkKernel(
 
 }  // namespace
 
-// random walk for uniform choice
+// random walk for uniform choice, or weighted choice for the edge types with a
+// non-null probability array
 template<DLDeviceType XPU, typename IdType>
-std::pair<IdArray, IdArray> RandomWalkUniform(
+std::pair<IdArray, IdArray> RandomWalkGPU(
     const HeteroGraphPtr hg,
     const IdArray seeds,
     const TypeArray metapath,
-    FloatArray restart_prob) {
+    const std::vector<FloatArray> &prob,
+    const std::vector<FloatArray> &alias_accept,
+    const std::vector<IdArray> &alias,
+    FloatArray restart_prob,
+    int64_t random_seed) {
   const int64_t max_num_steps = metapath->shape[0];
   const IdType *metapath_data = static_cast<IdType *>(metapath->data);
   int64_t num_etypes = hg->NumEdgeTypes();
@@ -110,7 +113,9 @@ std::pair<IdArray, IdArray> RandomWalkUniform(
   IdType *traces_data = traces.Ptr<IdType>();
   IdType *eids_data = eids.Ptr<IdType>();
 
+  cudaStream_t stream = runtime::CUDAThreadEntry::ThreadLocal()->stream;
   GraphKernelData<IdType> h_graphs[num_etypes];
+  std::vector<double*> cdfs;
   DGLContext ctx;
   for (int64_t etype = 0; etype < num_etypes; ++etype) {
     const CSRMatrix &csr = hg->GetCSRMatrix(etype);
@@ -119,9 +124,23 @@ std::pair<IdArray, IdArray> RandomWalkUniform(
     h_graphs[etype].in_ptr  = static_cast<const IdType*>(csr.indptr->data);
     h_graphs[etype].in_cols = static_cast<const IdType*>(csr.indices->data);
     h_graphs[etype].data = (CSRHasData(csr) ? static_cast<const IdType*>(csr.data->data) : nullptr);
+    h_graphs[etype].cdf = nullptr;
+    h_graphs[etype].alias_prob = nullptr;
+    h_graphs[etype].alias_accept = nullptr;
+    h_graphs[etype].alias = nullptr;
+    // the alias tables are drawn from in single precision, the others go
+    // through the prefix sum of the probabilities
+    if (etype < static_cast<int64_t>(alias.size()) && !IsNullArray(alias[etype]) &&
+        prob[etype]->dtype.code == kDLFloat && prob[etype]->dtype.bits == 32 &&
+        alias[etype]->dtype.bits == sizeof(IdType) * 8) {
+      h_graphs[etype].alias_prob = prob[etype].Ptr<float>();
+      h_graphs[etype].alias_accept = alias_accept[etype].Ptr<float>();
+      h_graphs[etype].alias = alias[etype].Ptr<IdType>();
+    } else if (etype < static_cast<int64_t>(prob.size()) && !IsNullArray(prob[etype])) {
+      cdfs.push_back(BuildTransitionCDF<IdType>(csr, prob[etype], stream));
+      h_graphs[etype].cdf = cdfs.back();
+    }
   }
-  // use default stream
-  cudaStream_t stream = 0;
   auto device = DeviceAPI::Get(ctx);
   auto d_graphs = static_cast<GraphKernelData<IdType>*>(
       device->AllocWorkspace(ctx, (num_etypes) * sizeof(GraphKernelData<IdType>)));
@@ -138,14 +157,17 @@ std::pair<IdArray, IdArray> RandomWalkUniform(
   constexpr int TILE_SIZE = BLOCK_SIZE * 4;
   dim3 block(256);
   dim3 grid((num_seeds + TILE_SIZE - 1) / TILE_SIZE);
-  const uint64_t random_seed = RandomEngine::ThreadLocal()->RandInt(1000000000);
+  // the random state of a thread is keyed on the seed and its first seed node,
+  // so the walks only depend on the seed for a given launch configuration
+  const uint64_t kernel_seed = random_seed >= 0 ?
+    random_seed : RandomEngine::ThreadLocal()->RandInt(1000000000);
   ATEN_FLOAT_TYPE_SWITCH(restart_prob->dtype, FloatType, "random walk GPU kernel", {
     CHECK(restart_prob->ctx.device_type == kDLGPU) << "restart prob should be in GPU.";
     CHECK(restart_prob->ndim == 1) << "restart prob dimension should be 1.";
     const FloatType *restart_prob_data = restart_prob.Ptr<FloatType>();
     const int64_t restart_prob_size = restart_prob->shape[0];
     _RandomWalkKernel<IdType, FloatType, BLOCK_SIZE, TILE_SIZE> <<<grid, block, 0, stream>>>(
-        random_seed,
+        kernel_seed,
         seed_data,
         num_seeds,
         d_metapath_data,
@@ -157,6 +179,8 @@ std::pair<IdArray, IdArray> RandomWalkUniform(
         eids_data);
   });
 
+  for (double *cdf : cdfs)
+    device->FreeWorkspace(ctx, cdf);
   device->FreeWorkspace(ctx, d_graphs);
   return std::make_pair(traces, eids);
 }
@@ -166,18 +190,14 @@ std::pair<IdArray, IdArray> RandomWalk(
     const HeteroGraphPtr hg,
     const IdArray seeds,
     const TypeArray metapath,
-    const std::vector<FloatArray> &prob) {
-
-  // not support no-uniform choice now
-  for (const auto &etype_prob : prob) {
-    if (!IsNullArray(etype_prob)) {
-      LOG(FATAL) << "Non-uniform choice is not supported in GPU.";
-    }
-  }
-
+    const std::vector<FloatArray> &prob,
+    const std::vector<FloatArray> &alias_accept,
+    const std::vector<IdArray> &alias,
+    int64_t random_seed) {
   auto restart_prob = NDArray::Empty(
       {0}, DLDataType{kDLFloat, 32, 1}, DGLContext{XPU, 0});
-  return RandomWalkUniform<XPU, IdType>(hg, seeds, metapath, restart_prob);
+  return RandomWalkGPU<XPU, IdType>(
+      hg, seeds, metapath, prob, alias_accept, alias, restart_prob, random_seed);
 }
 
 template<DLDeviceType XPU, typename IdType>
@@ -186,21 +206,16 @@ std::pair<IdArray, IdArray> RandomWalkWithRestart(
     const IdArray seeds,
     const TypeArray metapath,
     const std::vector<FloatArray> &prob,
-    double restart_prob) {
-
-  // not support no-uniform choice now
-  for (const auto &etype_prob : prob) {
-    if (!IsNullArray(etype_prob)) {
-      LOG(FATAL) << "Non-uniform choice is not supported in GPU.";
-    }
-  }
+    const std::vector<FloatArray> &alias_accept,
+    const std::vector<IdArray> &alias,
+    double restart_prob,
+    int64_t random_seed) {
   auto restart_prob_array = NDArray::Empty(
       {1}, DLDataType{kDLFloat, 64, 1}, seeds->ctx);
   auto device_ctx = restart_prob_array->ctx;
   auto device = dgl::runtime::DeviceAPI::Get(device_ctx);
 
-  // use default stream
-  cudaStream_t stream = 0;
+  cudaStream_t stream = runtime::CUDAThreadEntry::ThreadLocal()->stream;
   device->CopyDataFromTo(
       &restart_prob, 0, restart_prob_array.Ptr<double>(), 0,
       sizeof(double),
@@ -208,7 +223,8 @@ std::pair<IdArray, IdArray> RandomWalkWithRestart(
       restart_prob_array->dtype, stream);
   device->StreamSync(device_ctx, stream);
 
-  return RandomWalkUniform<XPU, IdType>(hg, seeds, metapath, restart_prob_array);
+  return RandomWalkGPU<XPU, IdType>(
+      hg, seeds, metapath, prob, alias_accept, alias, restart_prob_array, random_seed);
 }
 
 template<DLDeviceType XPU, typename IdType>
@@ -217,16 +233,12 @@ std::pair<IdArray, IdArray> RandomWalkWithStepwiseRestart(
     const IdArray seeds,
     const TypeArray metapath,
     const std::vector<FloatArray> &prob,
-    FloatArray restart_prob) {
-
-  // not support no-uniform choice now
-  for (const auto &etype_prob : prob) {
-    if (!IsNullArray(etype_prob)) {
-      LOG(FATAL) << "Non-uniform choice is not supported in GPU.";
-    }
-  }
-
-  return RandomWalkUniform<XPU, IdType>(hg, seeds, metapath, restart_prob);
+    const std::vector<FloatArray> &alias_accept,
+    const std::vector<IdArray> &alias,
+    FloatArray restart_prob,
+    int64_t random_seed) {
+  return RandomWalkGPU<XPU, IdType>(
+      hg, seeds, metapath, prob, alias_accept, alias, restart_prob, random_seed);
 }
 
 template<DLDeviceType XPU, typename IdxType>
@@ -234,17 +246,19 @@ std::tuple<IdArray, IdArray, IdArray> SelectPinSageNeighbors(
     const IdArray src,
     const IdArray dst,
     const int64_t num_samples_per_node,
-    const int64_t k) {
+    const int64_t k,
+    const int64_t hashmap_size) {
   CHECK(src->ctx.device_type == kDLGPU) <<
     "IdArray needs be on GPU!";
   const IdxType* src_data = src.Ptr<IdxType>();
   const IdxType* dst_data = dst.Ptr<IdxType>();
   const int64_t num_dst_nodes = (dst->shape[0] / num_samples_per_node);
   auto ctx = src->ctx;
-  // use default stream
-  cudaStream_t stream = 0;
+  cudaStream_t stream = runtime::CUDAThreadEntry::ThreadLocal()->stream;
+  const int64_t num_items_each_dst = hashmap_size > 0 ?
+    std::min(hashmap_size, num_samples_per_node) : num_samples_per_node;
   auto frequency_hashmap = FrequencyHashmap<IdxType>(num_dst_nodes,
-      num_samples_per_node, ctx, stream);
+      num_items_each_dst, ctx, stream);
   auto ret = frequency_hashmap.Topk(src_data, dst_data, src->dtype,
       src->shape[0], num_samples_per_node, k);
   return ret;
@@ -255,13 +269,19 @@ std::pair<IdArray, IdArray> RandomWalk<kDLGPU, int32_t>(
     const HeteroGraphPtr hg,
     const IdArray seeds,
     const TypeArray metapath,
-    const std::vector<FloatArray> &prob);
+    const std::vector<FloatArray> &prob,
+    const std::vector<FloatArray> &alias_accept,
+    const std::vector<IdArray> &alias,
+    int64_t random_seed);
 template
 std::pair<IdArray, IdArray> RandomWalk<kDLGPU, int64_t>(
     const HeteroGraphPtr hg,
     const IdArray seeds,
     const TypeArray metapath,
-    const std::vector<FloatArray> &prob);
+    const std::vector<FloatArray> &prob,
+    const std::vector<FloatArray> &alias_accept,
+    const std::vector<IdArray> &alias,
+    int64_t random_seed);
 
 template
 std::pair<IdArray, IdArray> RandomWalkWithRestart<kDLGPU, int32_t>(
@@ -269,14 +289,20 @@ std::pair<IdArray, IdArray> RandomWalkWithRestart<kDLGPU, int32_t>(
     const IdArray seeds,
     const TypeArray metapath,
     const std::vector<FloatArray> &prob,
-    double restart_prob);
+    const std::vector<FloatArray> &alias_accept,
+    const std::vector<IdArray> &alias,
+    double restart_prob,
+    int64_t random_seed);
 template
 std::pair<IdArray, IdArray> RandomWalkWithRestart<kDLGPU, int64_t>(
     const HeteroGraphPtr hg,
     const IdArray seeds,
     const TypeArray metapath,
     const std::vector<FloatArray> &prob,
-    double restart_prob);
+    const std::vector<FloatArray> &alias_accept,
+    const std::vector<IdArray> &alias,
+    double restart_prob,
+    int64_t random_seed);
 
 template
 std::pair<IdArray, IdArray> RandomWalkWithStepwiseRestart<kDLGPU, int32_t>(
@@ -284,27 +310,35 @@ std::pair<IdArray, IdArray> RandomWalkWithStepwiseRestart<kDLGPU, int32_t>(
     const IdArray seeds,
     const TypeArray metapath,
     const std::vector<FloatArray> &prob,
-    FloatArray restart_prob);
+    const std::vector<FloatArray> &alias_accept,
+    const std::vector<IdArray> &alias,
+    FloatArray restart_prob,
+    int64_t random_seed);
 template
 std::pair<IdArray, IdArray> RandomWalkWithStepwiseRestart<kDLGPU, int64_t>(
     const HeteroGraphPtr hg,
     const IdArray seeds,
     const TypeArray metapath,
     const std::vector<FloatArray> &prob,
-    FloatArray restart_prob);
+    const std::vector<FloatArray> &alias_accept,
+    const std::vector<IdArray> &alias,
+    FloatArray restart_prob,
+    int64_t random_seed);
 
 template
 std::tuple<IdArray, IdArray, IdArray> SelectPinSageNeighbors<kDLGPU, int32_t>(
     const IdArray src,
     const IdArray dst,
     const int64_t num_samples_per_node,
-    const int64_t k);
+    const int64_t k,
+    const int64_t hashmap_size);
 template
 std::tuple<IdArray, IdArray, IdArray> SelectPinSageNeighbors<kDLGPU, int64_t>(
     const IdArray src,
     const IdArray dst,
     const int64_t num_samples_per_node,
-    const int64_t k);
+    const int64_t k,
+    const int64_t hashmap_size);
 
 
 };  // namespace impl
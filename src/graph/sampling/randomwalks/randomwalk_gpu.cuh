@@ -0,0 +1,144 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file graph/sampling/randomwalk_gpu.cuh
+ * \brief Device helpers shared by the GPU random walks
+ */
+
+#ifndef DGL_GRAPH_SAMPLING_RANDOMWALKS_RANDOMWALK_GPU_CUH_
+#define DGL_GRAPH_SAMPLING_RANDOMWALKS_RANDOMWALK_GPU_CUH_
+
+#include <dgl/array.h>
+#include <dgl/runtime/device_api.h>
+#include <curand_kernel.h>
+#include <algorithm>
+
+#include "../../../array/cuda/dgl_cub.cuh"
+#include "../../../runtime/cuda/cuda_common.h"
+
+namespace dgl {
+
+namespace sampling {
+
+namespace impl {
+
+template<typename IdType>
+struct GraphKernelData {
+  const IdType *in_ptr;
+  const IdType *in_cols;
+  const IdType *data;
+  /*!
+   * \brief The inclusive prefix sum of the transition probabilities of the edges
+   *        in the order of the CSR, or null if the neighbors are picked uniformly.
+   */
+  const double *cdf;
+  /*!
+   * \brief The transition probabilities and their alias table built by
+   *        CSRRowWiseAliasTable, indexed by edge ID, or null if there is no table.
+   */
+  const float *alias_prob;
+  const float *alias_accept;
+  const IdType *alias;
+};
+
+template<typename IdType, typename FloatType>
+struct TransitionProb {
+  const FloatType *prob;
+  const IdType *data;
+
+  __device__ double operator()(const int64_t k) const {
+    return prob[data ? data[k] : k];
+  }
+};
+
+/*!
+ * \brief Compute the prefix sum of the transition probabilities of the edges in
+ *        the order of the CSR, used by PickNeighbor to draw a neighbor by binary
+ *        search in the row.
+ *
+ * The sum runs over the whole matrix in double precision, so that the rows are
+ * differences of it and a single scan serves all of them.
+ *
+ * \param csr The CSR matrix on GPU.
+ * \param prob The transition probabilities on GPU, indexed by edge ID.
+ * \param stream The stream to run on.
+ * \return The prefix sum, in a workspace of the device to be freed by the caller.
+ */
+template<typename IdType>
+double * BuildTransitionCDF(
+    const aten::CSRMatrix &csr, const FloatArray &prob, cudaStream_t stream) {
+  const auto& ctx = csr.indptr->ctx;
+  auto device = runtime::DeviceAPI::Get(ctx);
+  CHECK(prob->ctx.device_type == kDLGPU) << "prob should be in GPU.";
+  const int64_t nnz = csr.indices->shape[0];
+  double *cdf = static_cast<double*>(
+      device->AllocWorkspace(ctx, std::max<int64_t>(nnz, 1) * sizeof(double)));
+  if (nnz == 0)
+    return cdf;
+
+  ATEN_FLOAT_TYPE_SWITCH(prob->dtype, FloatType, "probability", {
+    cub::CountingInputIterator<int64_t> edges(0);
+    cub::TransformInputIterator<double, TransitionProb<IdType, FloatType>,
+      cub::CountingInputIterator<int64_t>> probs(edges, TransitionProb<IdType, FloatType>{
+        prob.Ptr<FloatType>(), aten::CSRHasData(csr) ? csr.data.Ptr<IdType>() : nullptr});
+    size_t workspace_size = 0;
+    CUDA_CALL(cub::DeviceScan::InclusiveSum(
+        nullptr, workspace_size, probs, cdf, nnz, stream));
+    void *workspace = device->AllocWorkspace(ctx, workspace_size);
+    CUDA_CALL(cub::DeviceScan::InclusiveSum(
+        workspace, workspace_size, probs, cdf, nnz, stream));
+    device->FreeWorkspace(ctx, workspace);
+  });
+  return cdf;
+}
+
+/*!
+ * \brief Pick a neighbor of a node, uniformly or with the transition probabilities
+ *        of the graph, by their alias table if any.
+ *
+ * \param graph The graph.
+ * \param in_row_start The offset of the row of the node in the CSR.
+ * \param deg The degree of the node, which must be positive.
+ * \param rng The random state of the thread.
+ * \return The offset of the picked edge in the CSR, or -1 if all the transition
+ *         probabilities of the row are zero.
+ */
+template<typename IdType>
+__device__ int64_t PickNeighbor(
+    const GraphKernelData<IdType> &graph, const int64_t in_row_start, const int64_t deg,
+    curandState *rng) {
+  if (graph.alias) {
+    const int64_t k = in_row_start + curand(rng) % deg;
+    const int64_t e = graph.data ? graph.data[k] : k;
+    const int64_t pick =
+      1.f - curand_uniform(rng) < graph.alias_accept[e] ? k : in_row_start + graph.alias[e];
+    // the table of a row without weight is uniform, but the walk stops there
+    return graph.alias_prob[graph.data ? graph.data[pick] : pick] > 0 ? pick : -1;
+  }
+  if (!graph.cdf)
+    return in_row_start + curand(rng) % deg;
+
+  // draw in [base, base + total) and find the first edge whose cumulative
+  // probability is above it, which skips the edges without weight
+  const double base = in_row_start > 0 ? graph.cdf[in_row_start - 1] : 0.;
+  const double total = graph.cdf[in_row_start + deg - 1] - base;
+  if (!(total > 0))
+    return -1;
+  const double r = base + (1. - curand_uniform_double(rng)) * total;
+  int64_t lo = in_row_start, hi = in_row_start + deg - 1;
+  while (lo < hi) {
+    const int64_t mid = (lo + hi) / 2;
+    if (graph.cdf[mid] > r)
+      hi = mid;
+    else
+      lo = mid + 1;
+  }
+  return lo;
+}
+
+};  // namespace impl
+
+};  // namespace sampling
+
+};  // namespace dgl
+
+#endif  // DGL_GRAPH_SAMPLING_RANDOMWALKS_RANDOMWALK_GPU_CUH_
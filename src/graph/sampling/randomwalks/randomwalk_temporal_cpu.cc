@@ -0,0 +1,134 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file graph/sampling/randomwalk_temporal_cpu.cc
+ * \brief DGL sampler - CPU implementation of the temporal random walk with OpenMP
+ */
+
+#include <dgl/array.h>
+#include <dgl/base_heterograph.h>
+#include <dgl/random.h>
+#include <dgl/runtime/parallel_for.h>
+#include <vector>
+#include <utility>
+#include "randomwalks_impl.h"
+
+namespace dgl {
+
+using namespace dgl::runtime;
+using namespace dgl::aten;
+
+namespace sampling {
+
+namespace impl {
+
+template<DLDeviceType XPU, typename IdxType>
+std::pair<IdArray, IdArray> RandomWalkTemporal(
+    const HeteroGraphPtr hg,
+    const IdArray seeds,
+    const TypeArray metapath,
+    const std::vector<NDArray> &timestamp,
+    const std::vector<IdArray> &order,
+    const NDArray seed_time,
+    int64_t random_seed) {
+  const int64_t max_num_steps = metapath->shape[0];
+  const IdxType *metapath_data = metapath.Ptr<IdxType>();
+  const int64_t begin_ntype = hg->meta_graph()->FindEdge(metapath_data[0]).first;
+  const int64_t max_nodes = hg->NumVertices(begin_ntype);
+  const int64_t num_seeds = seeds->shape[0];
+  const int64_t trace_length = max_num_steps + 1;
+  IdArray traces = IdArray::Empty({num_seeds, trace_length}, seeds->dtype, seeds->ctx);
+  IdArray eids = IdArray::Empty({num_seeds, max_num_steps}, seeds->dtype, seeds->ctx);
+  const IdxType *seed_data = seeds.Ptr<IdxType>();
+  IdxType *traces_data = traces.Ptr<IdxType>();
+  IdxType *eids_data = eids.Ptr<IdxType>();
+
+  // Prefetch all edges, before the parallel loop, as in MetapathBasedRandomWalk.
+  const int64_t num_etypes = hg->NumEdgeTypes();
+  std::vector<CSRMatrix> edges_by_type(num_etypes);
+  for (int64_t etype = 0; etype < num_etypes; ++etype)
+    edges_by_type[etype] = hg->GetCSRMatrix(etype);
+
+  ATEN_DTYPE_SWITCH(seed_time->dtype, DType, "timestamp", {
+    const DType *seed_time_data = seed_time.Ptr<DType>();
+    runtime::parallel_for(0, num_seeds, [&](size_t seed_begin, size_t seed_end) {
+      RandomEngine *engine = RandomEngine::ThreadLocal();
+      const RandomEngine saved_engine = *engine;
+      for (auto seed_id = seed_begin; seed_id < seed_end; seed_id++) {
+        IdxType *trace = traces_data + seed_id * trace_length;
+        IdxType *trace_eids = eids_data + seed_id * max_num_steps;
+        IdxType curr = seed_data[seed_id];
+        DType curr_time = seed_time_data[seed_id];
+        if (random_seed >= 0)
+          engine->SetStream(random_seed, seed_id);
+        trace[0] = curr;
+        CHECK_LT(curr, max_nodes) << "Seed node ID exceeds the maximum number of nodes.";
+
+        int64_t i;
+        for (i = 0; i < max_num_steps; ++i) {
+          const dgl_type_t etype = metapath_data[i];
+          const CSRMatrix &csr = edges_by_type[etype];
+          const IdxType *data = CSRHasData(csr) ? csr.data.Ptr<IdxType>() : nullptr;
+          const IdxType *order_data = order[etype].Ptr<IdxType>();
+          const DType *ts_data = timestamp[etype].Ptr<DType>();
+          const IdxType off = csr.indptr.Ptr<IdxType>()[curr];
+          auto eid = [data](IdxType pos) { return data ? data[pos] : pos; };
+          auto by_rank = [eid, order_data, off](IdxType j) {
+            return off + order_data[eid(off + j)];
+          };
+
+          // the earlier edges are a prefix of the edges by increasing timestamp,
+          // see aten::CSRRowWiseSamplingTemporal
+          IdxType lo = 0, hi = csr.indptr.Ptr<IdxType>()[curr + 1] - off;
+          while (lo < hi) {
+            const IdxType mid = lo + (hi - lo) / 2;
+            if (ts_data[eid(by_rank(mid))] < curr_time)
+              lo = mid + 1;
+            else
+              hi = mid;
+          }
+          if (lo == 0)
+            break;
+          const IdxType picked = by_rank(engine->RandInt<IdxType>(lo));
+          curr = csr.indices.Ptr<IdxType>()[picked];
+          curr_time = ts_data[eid(picked)];
+          trace[i + 1] = curr;
+          trace_eids[i] = eid(picked);
+        }
+
+        for (; i < max_num_steps; ++i) {
+          trace[i + 1] = -1;
+          trace_eids[i] = -1;
+        }
+      }
+      if (random_seed >= 0)
+        *engine = saved_engine;
+    });
+  });
+
+  return std::make_pair(traces, eids);
+}
+
+template
+std::pair<IdArray, IdArray> RandomWalkTemporal<kDLCPU, int32_t>(
+    const HeteroGraphPtr hg,
+    const IdArray seeds,
+    const TypeArray metapath,
+    const std::vector<NDArray> &timestamp,
+    const std::vector<IdArray> &order,
+    const NDArray seed_time,
+    int64_t random_seed);
+template
+std::pair<IdArray, IdArray> RandomWalkTemporal<kDLCPU, int64_t>(
+    const HeteroGraphPtr hg,
+    const IdArray seeds,
+    const TypeArray metapath,
+    const std::vector<NDArray> &timestamp,
+    const std::vector<IdArray> &order,
+    const NDArray seed_time,
+    int64_t random_seed);
+
+};  // namespace impl
+
+};  // namespace sampling
+
+};  // namespace dgl
@@ -28,12 +28,16 @@ std::pair<IdArray, IdArray> RandomWalkWithRestart(
     const IdArray seeds,
     const TypeArray metapath,
     const std::vector<FloatArray> &prob,
-    double restart_prob) {
-  TerminatePredicate<IdxType> terminate =
+    const std::vector<FloatArray> &alias_accept,
+    const std::vector<IdArray> &alias,
+    double restart_prob,
+    int64_t random_seed) {
+  auto terminate =
     [restart_prob] (IdxType *data, dgl_id_t curr, int64_t len) {
       return RandomEngine::ThreadLocal()->Uniform<double>() < restart_prob;
     };
-  return MetapathBasedRandomWalk<XPU, IdxType>(hg, seeds, metapath, prob, terminate);
+  return MetapathBasedRandomWalk<XPU, IdxType>(
+      hg, seeds, metapath, prob, alias_accept, alias, terminate, random_seed);
 }
 
 template
@@ -42,14 +46,20 @@ std::pair<IdArray, IdArray> RandomWalkWithRestart<kDLCPU, int32_t>(
     const IdArray seeds,
     const TypeArray metapath,
     const std::vector<FloatArray> &prob,
-    double restart_prob);
+    const std::vector<FloatArray> &alias_accept,
+    const std::vector<IdArray> &alias,
+    double restart_prob,
+    int64_t random_seed);
 template
 std::pair<IdArray, IdArray> RandomWalkWithRestart<kDLCPU, int64_t>(
     const HeteroGraphPtr hg,
     const IdArray seeds,
     const TypeArray metapath,
     const std::vector<FloatArray> &prob,
-    double restart_prob);
+    const std::vector<FloatArray> &alias_accept,
+    const std::vector<IdArray> &alias,
+    double restart_prob,
+    int64_t random_seed);
 
 template<DLDeviceType XPU, typename IdxType>
 std::pair<IdArray, IdArray> RandomWalkWithStepwiseRestart(
@@ -57,16 +67,20 @@ std::pair<IdArray, IdArray> RandomWalkWithStepwiseRestart(
     const IdArray seeds,
     const TypeArray metapath,
     const std::vector<FloatArray> &prob,
-    FloatArray restart_prob) {
+    const std::vector<FloatArray> &alias_accept,
+    const std::vector<IdArray> &alias,
+    FloatArray restart_prob,
+    int64_t random_seed) {
   std::pair<IdArray, IdArray> result;
 
   ATEN_FLOAT_TYPE_SWITCH(restart_prob->dtype, DType, "restart probability", {
     DType *restart_prob_data = static_cast<DType *>(restart_prob->data);
-    TerminatePredicate<IdxType> terminate =
+    auto terminate =
       [restart_prob_data] (IdxType *data, dgl_id_t curr, int64_t len) {
         return RandomEngine::ThreadLocal()->Uniform<DType>() < restart_prob_data[len];
       };
-    result = MetapathBasedRandomWalk<XPU, IdxType>(hg, seeds, metapath, prob, terminate);
+    result = MetapathBasedRandomWalk<XPU, IdxType>(
+        hg, seeds, metapath, prob, alias_accept, alias, terminate, random_seed);
   });
 
   return result;
@@ -78,14 +92,20 @@ std::pair<IdArray, IdArray> RandomWalkWithStepwiseRestart<kDLCPU, int32_t>(
     const IdArray seeds,
     const TypeArray metapath,
     const std::vector<FloatArray> &prob,
-    FloatArray restart_prob);
+    const std::vector<FloatArray> &alias_accept,
+    const std::vector<IdArray> &alias,
+    FloatArray restart_prob,
+    int64_t random_seed);
 template
 std::pair<IdArray, IdArray> RandomWalkWithStepwiseRestart<kDLCPU, int64_t>(
     const HeteroGraphPtr hg,
     const IdArray seeds,
     const TypeArray metapath,
     const std::vector<FloatArray> &prob,
-    FloatArray restart_prob);
+    const std::vector<FloatArray> &alias_accept,
+    const std::vector<IdArray> &alias,
+    FloatArray restart_prob,
+    int64_t random_seed);
 
 };  // namespace impl
 
@@ -7,7 +7,10 @@
 #include <dgl/runtime/container.h>
 #include <dgl/packed_func_ext.h>
 #include <dgl/array.h>
+#include <dgl/runtime/memory_tracker.h>
+#include <dgl/runtime/parallel_for.h>
 #include <dgl/sampling/randomwalks.h>
+#include <algorithm>
 #include <utility>
 #include <tuple>
 #include <vector>
@@ -27,7 +30,9 @@ void CheckRandomWalkInputs(
     const HeteroGraphPtr hg,
     const IdArray seeds,
     const TypeArray metapath,
-    const std::vector<FloatArray> &prob) {
+    const std::vector<FloatArray> &prob,
+    const std::vector<FloatArray> &alias_accept,
+    const std::vector<IdArray> &alias) {
   CHECK_INT(seeds, "seeds");
   CHECK_INT(metapath, "metapath");
   CHECK_NDIM(seeds, 1, "seeds");
@@ -38,6 +43,70 @@ void CheckRandomWalkInputs(
     if (p.GetSize() != 0)
       CHECK_NDIM(p, 1, "probability");
   }
+  CHECK_EQ(alias_accept.size(), prob.size())
+    << "Number of alias tables must match the number of edge types.";
+  CHECK_EQ(alias.size(), prob.size())
+    << "Number of alias tables must match the number of edge types.";
+  for (uint64_t i = 0; i < alias.size(); ++i) {
+    if (IsNullArray(alias_accept[i]) || IsNullArray(prob[i]))
+      continue;
+    CHECK_SAME_DTYPE(prob[i], alias_accept[i]);
+    CHECK_INT(alias[i], "alias");
+    CHECK_EQ(alias_accept[i]->shape[0], prob[i]->shape[0])
+      << "The alias tables must be built from the same probabilities.";
+    CHECK_EQ(alias[i]->shape[0], prob[i]->shape[0])
+      << "The alias tables must be built from the same probabilities.";
+  }
+}
+
+template <typename IdxType, typename TypeIdx>
+std::tuple<IdArray, IdArray, TypeArray, IdArray, IdArray> PackWalksCPU(
+    const IdArray traces,
+    const IdArray eids,
+    const TypeArray vtypes) {
+  const auto &ctx = traces->ctx;
+  const int64_t num_traces = traces->shape[0];
+  const int64_t trace_length = traces->shape[1];
+  const int64_t max_num_steps = trace_length - 1;
+  const IdxType *traces_data = traces.Ptr<IdxType>();
+  const IdxType *eids_data = eids.Ptr<IdxType>();
+  const TypeIdx *vtypes_data = vtypes.Ptr<TypeIdx>();
+
+  IdArray lengths = NewIdArray(num_traces, ctx);
+  IdArray offsets = NewIdArray(num_traces, ctx);
+  int64_t *lengths_data = lengths.Ptr<int64_t>();
+  int64_t *offsets_data = offsets.Ptr<int64_t>();
+  runtime::parallel_for(0, num_traces, [&](size_t b, size_t e) {
+    for (size_t i = b; i < e; ++i) {
+      const IdxType *trace = traces_data + i * trace_length;
+      lengths_data[i] = std::find(trace, trace + trace_length, static_cast<IdxType>(-1)) - trace;
+    }
+  });
+  int64_t total_length = 0;
+  for (int64_t i = 0; i < num_traces; ++i) {
+    offsets_data[i] = total_length;
+    total_length += lengths_data[i];
+  }
+
+  // Every trace starts with its seed node, so it has one edge less than nodes
+  // and its edges start at its offset minus its index.
+  IdArray concat_vids = NewIdArray(total_length, ctx, sizeof(IdxType) * 8);
+  IdArray concat_eids = NewIdArray(total_length - num_traces, ctx, sizeof(IdxType) * 8);
+  TypeArray concat_vtypes = TypeArray::Empty({total_length}, vtypes->dtype, ctx);
+  IdxType *concat_vids_data = concat_vids.Ptr<IdxType>();
+  IdxType *concat_eids_data = concat_eids.Ptr<IdxType>();
+  TypeIdx *concat_vtypes_data = concat_vtypes.Ptr<TypeIdx>();
+  runtime::parallel_for(0, num_traces, [&](size_t b, size_t e) {
+    for (size_t i = b; i < e; ++i) {
+      const int64_t length = lengths_data[i];
+      const int64_t offset = offsets_data[i];
+      std::copy_n(traces_data + i * trace_length, length, concat_vids_data + offset);
+      std::copy_n(vtypes_data, length, concat_vtypes_data + offset);
+      std::copy_n(eids_data + i * max_num_steps, length - 1, concat_eids_data + offset - i);
+    }
+  });
+
+  return std::make_tuple(concat_vids, concat_eids, concat_vtypes, lengths, offsets);
 }
 
 };  // namespace
@@ -46,15 +115,20 @@ std::tuple<IdArray, IdArray, TypeArray> RandomWalk(
     const HeteroGraphPtr hg,
     const IdArray seeds,
     const TypeArray metapath,
-    const std::vector<FloatArray> &prob) {
-  CheckRandomWalkInputs(hg, seeds, metapath, prob);
+    const std::vector<FloatArray> &prob,
+    const std::vector<FloatArray> &alias_accept,
+    const std::vector<IdArray> &alias,
+    int64_t random_seed) {
+  CheckRandomWalkInputs(hg, seeds, metapath, prob, alias_accept, alias);
+  runtime::MemoryTagScope tag_scope(runtime::MemoryTag::kSampler);
 
   TypeArray vtypes;
   std::pair<IdArray, IdArray> result;
   ATEN_XPU_SWITCH_CUDA(hg->Context().device_type, XPU, "RandomWalk", {
     ATEN_ID_TYPE_SWITCH(seeds->dtype, IdxType, {
       vtypes = impl::GetNodeTypesFromMetapath<XPU, IdxType>(hg, metapath);
-      result = impl::RandomWalk<XPU, IdxType>(hg, seeds, metapath, prob);
+      result = impl::RandomWalk<XPU, IdxType>(
+          hg, seeds, metapath, prob, alias_accept, alias, random_seed);
     });
   });
 
@@ -66,8 +140,11 @@ std::tuple<IdArray, IdArray, TypeArray> RandomWalkWithRestart(
     const IdArray seeds,
     const TypeArray metapath,
     const std::vector<FloatArray> &prob,
-    double restart_prob) {
-  CheckRandomWalkInputs(hg, seeds, metapath, prob);
+    const std::vector<FloatArray> &alias_accept,
+    const std::vector<IdArray> &alias,
+    double restart_prob,
+    int64_t random_seed) {
+  CheckRandomWalkInputs(hg, seeds, metapath, prob, alias_accept, alias);
   CHECK(restart_prob >= 0 && restart_prob < 1) << "restart probability must belong to [0, 1)";
 
   TypeArray vtypes;
@@ -75,7 +152,8 @@ std::tuple<IdArray, IdArray, TypeArray> RandomWalkWithRestart(
   ATEN_XPU_SWITCH_CUDA(hg->Context().device_type, XPU, "RandomWalkWithRestart", {
     ATEN_ID_TYPE_SWITCH(seeds->dtype, IdxType, {
       vtypes = impl::GetNodeTypesFromMetapath<XPU, IdxType>(hg, metapath);
-      result = impl::RandomWalkWithRestart<XPU, IdxType>(hg, seeds, metapath, prob, restart_prob);
+      result = impl::RandomWalkWithRestart<XPU, IdxType>(
+          hg, seeds, metapath, prob, alias_accept, alias, restart_prob, random_seed);
     });
   });
 
@@ -87,8 +165,11 @@ std::tuple<IdArray, IdArray, TypeArray> RandomWalkWithStepwiseRestart(
     const IdArray seeds,
     const TypeArray metapath,
     const std::vector<FloatArray> &prob,
-    FloatArray restart_prob) {
-  CheckRandomWalkInputs(hg, seeds, metapath, prob);
+    const std::vector<FloatArray> &alias_accept,
+    const std::vector<IdArray> &alias,
+    FloatArray restart_prob,
+    int64_t random_seed) {
+  CheckRandomWalkInputs(hg, seeds, metapath, prob, alias_accept, alias);
   // TODO(BarclayII): check the elements of restart probability
 
   TypeArray vtypes;
@@ -97,18 +178,87 @@ std::tuple<IdArray, IdArray, TypeArray> RandomWalkWithStepwiseRestart(
     ATEN_ID_TYPE_SWITCH(seeds->dtype, IdxType, {
       vtypes = impl::GetNodeTypesFromMetapath<XPU, IdxType>(hg, metapath);
       result = impl::RandomWalkWithStepwiseRestart<XPU, IdxType>(
-          hg, seeds, metapath, prob, restart_prob);
+          hg, seeds, metapath, prob, alias_accept, alias, restart_prob, random_seed);
+    });
+  });
+
+  return std::make_tuple(result.first, result.second, vtypes);
+}
+
+std::tuple<IdArray, IdArray, TypeArray> RandomWalkTemporal(
+    const HeteroGraphPtr hg,
+    const IdArray seeds,
+    const TypeArray metapath,
+    const std::vector<NDArray> &timestamp,
+    const std::vector<IdArray> &order,
+    const NDArray seed_time,
+    int64_t random_seed) {
+  CHECK_INT(seeds, "seeds");
+  CHECK_INT(metapath, "metapath");
+  CHECK_NDIM(seeds, 1, "seeds");
+  CHECK_NDIM(metapath, 1, "metapath");
+  CHECK_NDIM(seed_time, 1, "seed_time");
+  CHECK_EQ(seed_time->shape[0], seeds->shape[0]) << "Every seed node must have a time.";
+  CHECK_EQ(timestamp.size(), hg->NumEdgeTypes())
+    << "Number of timestamp tensors must match the number of edge types.";
+  CHECK_EQ(order.size(), hg->NumEdgeTypes())
+    << "Number of order tensors must match the number of edge types.";
+  for (uint64_t i = 0; i < timestamp.size(); ++i) {
+    CHECK_SAME_DTYPE(timestamp[i], seed_time);
+    CHECK_SAME_DTYPE(order[i], seeds);
+    CHECK_EQ(timestamp[i]->shape[0], hg->NumEdges(i))
+      << "The timestamp array must have one element for each edge.";
+    CHECK_EQ(order[i]->shape[0], hg->NumEdges(i))
+      << "The order must be built from the same timestamps.";
+  }
+
+  TypeArray vtypes;
+  std::pair<IdArray, IdArray> result;
+  ATEN_XPU_SWITCH(hg->Context().device_type, XPU, "RandomWalkTemporal", {
+    ATEN_ID_TYPE_SWITCH(seeds->dtype, IdxType, {
+      vtypes = impl::GetNodeTypesFromMetapath<XPU, IdxType>(hg, metapath);
+      result = impl::RandomWalkTemporal<XPU, IdxType>(
+          hg, seeds, metapath, timestamp, order, seed_time, random_seed);
     });
   });
 
   return std::make_tuple(result.first, result.second, vtypes);
 }
 
+std::tuple<IdArray, IdArray, TypeArray, IdArray, IdArray> PackWalks(
+    const IdArray traces,
+    const IdArray eids,
+    const TypeArray vtypes) {
+  CHECK_INT(traces, "traces");
+  CHECK_INT(eids, "eids");
+  CHECK_INT(vtypes, "vtypes");
+  CHECK_NDIM(traces, 2, "traces");
+  CHECK_NDIM(eids, 2, "eids");
+  CHECK_NDIM(vtypes, 1, "vtypes");
+  CHECK_EQ(traces->ctx.device_type, kDLCPU) << "Packing the traces only supports CPU.";
+  CHECK_EQ(traces->shape[1], vtypes->shape[0])
+    << "The traces and the node types must have the same length.";
+  CHECK_EQ(eids->shape[0], traces->shape[0]) << "The traces and their edges must match.";
+  CHECK_EQ(eids->shape[1], traces->shape[1] - 1) << "The traces and their edges must match.";
+  CHECK_EQ(eids->dtype.bits, traces->dtype.bits)
+    << "The traces and their edges must have the same ID type.";
+
+  std::tuple<IdArray, IdArray, TypeArray, IdArray, IdArray> result;
+  ATEN_ID_TYPE_SWITCH(traces->dtype, IdxType, {
+    ATEN_ID_TYPE_SWITCH(vtypes->dtype, TypeIdx, {
+      result = PackWalksCPU<IdxType, TypeIdx>(traces, eids, vtypes);
+    });
+  });
+
+  return result;
+}
+
 std::tuple<IdArray, IdArray, IdArray> SelectPinSageNeighbors(
     const IdArray src,
     const IdArray dst,
     const int64_t num_samples_per_node,
-    const int64_t k) {
+    const int64_t k,
+    const int64_t hashmap_size) {
   assert((src->ndim == 1) && (dst->ndim == 1)
           && (src->shape[0] % num_samples_per_node == 0)
           && (src->shape[0] == dst->shape[0]));
@@ -116,7 +266,8 @@ std::tuple<IdArray, IdArray, IdArray> SelectPinSageNeighbors(
 
   ATEN_XPU_SWITCH_CUDA((src->ctx).device_type, XPU, "SelectPinSageNeighbors", {
     ATEN_ID_TYPE_SWITCH(src->dtype, IdxType, {
-      result = impl::SelectPinSageNeighbors<XPU, IdxType>(src, dst, num_samples_per_node, k);
+      result = impl::SelectPinSageNeighbors<XPU, IdxType>(
+          src, dst, num_samples_per_node, k, hashmap_size);
     });
   });
 
@@ -131,10 +282,14 @@ DGL_REGISTER_GLOBAL("sampling.randomwalks._CAPI_DGLSamplingRandomWalk")
     IdArray seeds = args[1];
     TypeArray metapath = args[2];
     List<Value> prob = args[3];
+    const auto& alias_accept_vec = ListValueToVector<FloatArray>(args[4]);
+    const auto& alias_vec = ListValueToVector<IdArray>(args[5]);
+    int64_t random_seed = args[6];
 
     const auto& prob_vec = ListValueToVector<FloatArray>(prob);
 
-    auto result = sampling::RandomWalk(hg.sptr(), seeds, metapath, prob_vec);
+    auto result = sampling::RandomWalk(
+        hg.sptr(), seeds, metapath, prob_vec, alias_accept_vec, alias_vec, random_seed);
     List<Value> ret;
     ret.push_back(Value(MakeValue(std::get<0>(result))));
     ret.push_back(Value(MakeValue(std::get<1>(result))));
@@ -148,8 +303,9 @@ DGL_REGISTER_GLOBAL("sampling.pinsage._CAPI_DGLSamplingSelectPinSageNeighbors")
     IdArray dst = args[1];
     int64_t num_travelsals = static_cast<int64_t>(args[2]);
     int64_t k = static_cast<int64_t>(args[3]);
+    int64_t hashmap_size = static_cast<int64_t>(args[4]);
 
-    auto result = sampling::SelectPinSageNeighbors(src, dst, num_travelsals, k);
+    auto result = sampling::SelectPinSageNeighbors(src, dst, num_travelsals, k, hashmap_size);
 
     List<Value> ret;
     ret.push_back(Value(MakeValue(std::get<0>(result))));
@@ -164,12 +320,16 @@ DGL_REGISTER_GLOBAL("sampling.randomwalks._CAPI_DGLSamplingRandomWalkWithRestart
     IdArray seeds = args[1];
     TypeArray metapath = args[2];
     List<Value> prob = args[3];
-    double restart_prob = args[4];
+    const auto& alias_accept_vec = ListValueToVector<FloatArray>(args[4]);
+    const auto& alias_vec = ListValueToVector<IdArray>(args[5]);
+    double restart_prob = args[6];
+    int64_t random_seed = args[7];
 
     const auto& prob_vec = ListValueToVector<FloatArray>(prob);
 
     auto result = sampling::RandomWalkWithRestart(
-        hg.sptr(), seeds, metapath, prob_vec, restart_prob);
+        hg.sptr(), seeds, metapath, prob_vec, alias_accept_vec, alias_vec, restart_prob,
+        random_seed);
     List<Value> ret;
     ret.push_back(Value(MakeValue(std::get<0>(result))));
     ret.push_back(Value(MakeValue(std::get<1>(result))));
@@ -183,12 +343,35 @@ DGL_REGISTER_GLOBAL("sampling.randomwalks._CAPI_DGLSamplingRandomWalkWithStepwis
     IdArray seeds = args[1];
     TypeArray metapath = args[2];
     List<Value> prob = args[3];
-    FloatArray restart_prob = args[4];
+    const auto& alias_accept_vec = ListValueToVector<FloatArray>(args[4]);
+    const auto& alias_vec = ListValueToVector<IdArray>(args[5]);
+    FloatArray restart_prob = args[6];
+    int64_t random_seed = args[7];
 
     const auto& prob_vec = ListValueToVector<FloatArray>(prob);
 
     auto result = sampling::RandomWalkWithStepwiseRestart(
-        hg.sptr(), seeds, metapath, prob_vec, restart_prob);
+        hg.sptr(), seeds, metapath, prob_vec, alias_accept_vec, alias_vec, restart_prob,
+        random_seed);
+    List<Value> ret;
+    ret.push_back(Value(MakeValue(std::get<0>(result))));
+    ret.push_back(Value(MakeValue(std::get<1>(result))));
+    ret.push_back(Value(MakeValue(std::get<2>(result))));
+    *rv = ret;
+  });
+
+DGL_REGISTER_GLOBAL("sampling.randomwalks._CAPI_DGLSamplingRandomWalkTemporal")
+.set_body([] (DGLArgs args, DGLRetValue *rv) {
+    HeteroGraphRef hg = args[0];
+    IdArray seeds = args[1];
+    TypeArray metapath = args[2];
+    const auto& timestamp_vec = ListValueToVector<NDArray>(args[3]);
+    const auto& order_vec = ListValueToVector<IdArray>(args[4]);
+    NDArray seed_time = args[5];
+    int64_t random_seed = args[6];
+
+    auto result = sampling::RandomWalkTemporal(
+        hg.sptr(), seeds, metapath, timestamp_vec, order_vec, seed_time, random_seed);
     List<Value> ret;
     ret.push_back(Value(MakeValue(std::get<0>(result))));
     ret.push_back(Value(MakeValue(std::get<1>(result))));
@@ -213,4 +396,21 @@ DGL_REGISTER_GLOBAL("sampling.randomwalks._CAPI_DGLSamplingPackTraces")
     *rv = ret;
   });
 
+DGL_REGISTER_GLOBAL("sampling.randomwalks._CAPI_DGLSamplingPackWalks")
+.set_body([] (DGLArgs args, DGLRetValue *rv) {
+    IdArray traces = args[0];
+    IdArray eids = args[1];
+    TypeArray vtypes = args[2];
+
+    auto result = sampling::PackWalks(traces, eids, vtypes);
+
+    List<Value> ret;
+    ret.push_back(Value(MakeValue(std::get<0>(result))));
+    ret.push_back(Value(MakeValue(std::get<1>(result))));
+    ret.push_back(Value(MakeValue(std::get<2>(result))));
+    ret.push_back(Value(MakeValue(std::get<3>(result))));
+    ret.push_back(Value(MakeValue(std::get<4>(result))));
+    *rv = ret;
+  });
+
 };  // namespace dgl
@@ -9,6 +9,7 @@
 
 #include <dgl/base_heterograph.h>
 #include <dgl/array.h>
+#include <dgl/random.h>
 #include <dgl/runtime/parallel_for.h>
 #include <tuple>
 #include <utility>
@@ -30,17 +31,23 @@ namespace {
  * \param seeds A 1D array of seed nodes, with the type the source type of the first
  *        edge type in the metapath.
  * \param max_num_steps The maximum number of steps of a random walk path.
- * \param step The random walk step function with type \c StepFunc.
+ * \param step The random walk step function, a callable with the signature of
+ *        \c StepFunc.  The walk is templated on its type so that the step is
+ *        not an indirect call.
  * \param max_nodes Throws an error if one of the values in \c seeds exceeds this argument.
+ * \param random_seed The seed of the walks, or a negative number to draw them from
+ *        the thread-local random engine.  With a seed, the walk from the i-th seed
+ *        node only depends on \c random_seed and i, whatever the number of threads.
  * \return A 2D array of shape (len(seeds), max_num_steps + 1) with node IDs.
  * \note The graph itself should be bounded in the closure of \c step.
  */
-template<DLDeviceType XPU, typename IdxType>
+template<DLDeviceType XPU, typename IdxType, typename Step>
 std::pair<IdArray, IdArray> GenericRandomWalk(
     const IdArray seeds,
     int64_t max_num_steps,
-    StepFunc<IdxType> step,
-    int64_t max_nodes) {
+    const Step &step,
+    int64_t max_nodes,
+    int64_t random_seed) {
   int64_t num_seeds = seeds->shape[0];
   int64_t trace_length = max_num_steps + 1;
   IdArray traces = IdArray::Empty({num_seeds, trace_length}, seeds->dtype, seeds->ctx);
@@ -51,9 +58,15 @@ std::pair<IdArray, IdArray> GenericRandomWalk(
   IdxType *eids_data = eids.Ptr<IdxType>();
 
   runtime::parallel_for(0, num_seeds, [&](size_t seed_begin, size_t seed_end) {
+    // The steps draw from the thread-local engine, which is switched to the stream
+    // of every walk with a seed, and restored afterwards.
+    RandomEngine *engine = RandomEngine::ThreadLocal();
+    const RandomEngine saved_engine = *engine;
     for (auto seed_id = seed_begin; seed_id < seed_end; seed_id++) {
       int64_t i;
       dgl_id_t curr = seed_data[seed_id];
+      if (random_seed >= 0)
+        engine->SetStream(random_seed, seed_id);
       traces_data[seed_id * trace_length] = curr;
 
       CHECK_LT(curr, max_nodes) << "Seed node ID exceeds the maximum number of nodes.";
@@ -71,6 +84,8 @@ std::pair<IdArray, IdArray> GenericRandomWalk(
         eids_data[seed_id * max_num_steps + i] = -1;
       }
     }
+    if (random_seed >= 0)
+      *engine = saved_engine;
   });
 
   return std::make_pair(traces, eids);
@@ -51,6 +51,13 @@ TypeArray GetNodeTypesFromMetapath(
  * \param metapath A 1D array of edge types representing the metapath.
  * \param prob A vector of 1D float arrays, indicating the transition probability of
  *        each edge by edge type.  An empty float array assumes uniform transition.
+ * \param alias_accept A vector of the acceptance probabilities of the alias tables
+ *        of \c prob by edge type, from aten::CSRRowWiseAliasTable on the CSR matrices,
+ *        or null arrays.  They make a weighted step O(1) instead of O(degree).
+ * \param alias A vector of the aliases of the alias tables by edge type.
+ * \param random_seed The seed of the walks, or a negative number to draw them from
+ *        the thread-local random engine.  With a seed, the walk from the i-th seed
+ *        node only depends on \c random_seed and i, whatever the number of threads.
  * \return A 2D array of shape (len(seeds), len(metapath) + 1) with node IDs.  The
  *         paths that terminated early are padded with -1.
  *         A 2D array of shape (len(seeds), len(metapath)) with edge IDs.  The
@@ -63,7 +70,10 @@ std::pair<IdArray, IdArray> RandomWalk(
     const HeteroGraphPtr hg,
     const IdArray seeds,
     const TypeArray metapath,
-    const std::vector<FloatArray> &prob);
+    const std::vector<FloatArray> &prob,
+    const std::vector<FloatArray> &alias_accept,
+    const std::vector<IdArray> &alias,
+    int64_t random_seed);
 
 /*!
  * \brief Metapath-based random walk with restart probability.
@@ -73,7 +83,14 @@ std::pair<IdArray, IdArray> RandomWalk(
  * \param metapath A 1D array of edge types representing the metapath.
  * \param prob A vector of 1D float arrays, indicating the transition probability of
  *        each edge by edge type.  An empty float array assumes uniform transition.
+ * \param alias_accept A vector of the acceptance probabilities of the alias tables
+ *        of \c prob by edge type, from aten::CSRRowWiseAliasTable on the CSR matrices,
+ *        or null arrays.  They make a weighted step O(1) instead of O(degree).
+ * \param alias A vector of the aliases of the alias tables by edge type.
  * \param restart_prob Restart probability
+ * \param random_seed The seed of the walks, or a negative number to draw them from
+ *        the thread-local random engine.  With a seed, the walk from the i-th seed
+ *        node only depends on \c random_seed and i, whatever the number of threads.
  * \return A 2D array of shape (len(seeds), len(metapath) + 1) with node IDs.  The
  *         paths that terminated early are padded with -1.
  *         A 2D array of shape (len(seeds), len(metapath)) with edge IDs.  The
@@ -87,7 +104,10 @@ std::pair<IdArray, IdArray> RandomWalkWithRestart(
     const IdArray seeds,
     const TypeArray metapath,
     const std::vector<FloatArray> &prob,
-    double restart_prob);
+    const std::vector<FloatArray> &alias_accept,
+    const std::vector<IdArray> &alias,
+    double restart_prob,
+    int64_t random_seed);
 
 /*!
  * \brief Metapath-based random walk with stepwise restart probability.  Useful
@@ -98,8 +118,15 @@ std::pair<IdArray, IdArray> RandomWalkWithRestart(
  * \param metapath A 1D array of edge types representing the metapath.
  * \param prob A vector of 1D float arrays, indicating the transition probability of
  *        each edge by edge type.  An empty float array assumes uniform transition.
+ * \param alias_accept A vector of the acceptance probabilities of the alias tables
+ *        of \c prob by edge type, from aten::CSRRowWiseAliasTable on the CSR matrices,
+ *        or null arrays.  They make a weighted step O(1) instead of O(degree).
+ * \param alias A vector of the aliases of the alias tables by edge type.
  * \param restart_prob Restart probability array which has the same number of elements
  *        as \c metapath, indicating the probability to terminate after transition.
+ * \param random_seed The seed of the walks, or a negative number to draw them from
+ *        the thread-local random engine.  With a seed, the walk from the i-th seed
+ *        node only depends on \c random_seed and i, whatever the number of threads.
  * \return A 2D array of shape (len(seeds), len(metapath) + 1) with node IDs.  The
  *         paths that terminated early are padded with -1.
  *         A 2D array of shape (len(seeds), len(metapath)) with edge IDs.  The
@@ -113,14 +140,62 @@ std::pair<IdArray, IdArray> RandomWalkWithStepwiseRestart(
     const IdArray seeds,
     const TypeArray metapath,
     const std::vector<FloatArray> &prob,
-    FloatArray restart_prob);
+    const std::vector<FloatArray> &alias_accept,
+    const std::vector<IdArray> &alias,
+    FloatArray restart_prob,
+    int64_t random_seed);
+
+/*!
+ * \brief Metapath-based random walk going back in time, every step picking uniformly
+ *        an edge strictly earlier than the previous one.
+ * \param hg The heterograph.
+ * \param seeds A 1D array of seed nodes, with the type the source type of the first
+ *        edge type in the metapath.
+ * \param metapath A 1D array of edge types representing the metapath.
+ * \param timestamp A vector of 1D arrays, the timestamps of the edges by edge type.
+ * \param order A vector of the orders of the outbound edges of the nodes by ascending
+ *        timestamp, from aten::CSRRowWiseTopkOrder on the CSR matrices, by edge type.
+ * \param seed_time A 1D array of the time of every seed node, of the type of the
+ *        timestamps.  The first step picks an edge strictly earlier than it.
+ * \param random_seed The seed of the walks, or a negative number to draw them from
+ *        the thread-local random engine.  With a seed, the walk from the i-th seed
+ *        node only depends on \c random_seed and i, whatever the number of threads.
+ * \return A 2D array of shape (len(seeds), len(metapath) + 1) with node IDs.  The
+ *         paths that terminated early are padded with -1.
+ *         A 2D array of shape (len(seeds), len(metapath)) with edge IDs.  The
+ *         paths that terminated early are padded with -1.
+ * \note This function should be called together with GetNodeTypesFromMetapath to
+ *       determine the node type of each node in the random walk traces.
+ */
+template<DLDeviceType XPU, typename IdxType>
+std::pair<IdArray, IdArray> RandomWalkTemporal(
+    const HeteroGraphPtr hg,
+    const IdArray seeds,
+    const TypeArray metapath,
+    const std::vector<NDArray> &timestamp,
+    const std::vector<IdArray> &order,
+    const NDArray seed_time,
+    int64_t random_seed);
 
+/*!
+ * \brief Select the PinSAGE neighbors of the destination nodes, i.e. the k source
+ *        nodes visited the most often from every destination node.
+ * \param src The visited nodes, padded with -1.
+ * \param dst The destination nodes, repeated \c num_samples_per_node times.
+ * \param num_samples_per_node The number of visits of every destination node.
+ * \param k The number of neighbors to select for every destination node.
+ * \param hashmap_size The number of distinct nodes the hash table of a destination
+ *        node can count on GPU, or 0 for \c num_samples_per_node.  The distinct
+ *        nodes visited past this number are ignored.
+ * \return The neighbors, the destination nodes, and the number of visits.
+ */
 template<DLDeviceType XPU, typename IdxType>
 std::tuple<IdArray, IdArray, IdArray> SelectPinSageNeighbors(
     const IdArray src,
     const IdArray dst,
     const int64_t num_samples_per_node,
-    const int64_t k);
+    const int64_t k,
+    const int64_t hashmap_size);
 
 };  // namespace impl
 
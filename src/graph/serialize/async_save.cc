@@ -0,0 +1,172 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file graph/serialize/async_save.cc
+ * \brief Saving tensors and graphs in the background.
+ */
+#include "async_save.h"
+
+#include <dgl/packed_func_ext.h>
+#include <dgl/runtime/device_api.h>
+#include <dgl/runtime/parallel_for.h>
+#include <dmlc/logging.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <thread>
+
+#include "../../c_api_common.h"
+
+using namespace dgl::runtime;
+
+namespace dgl {
+namespace serialize {
+
+namespace {
+
+/*! \brief The number of bytes copied by one task when staging a tensor. */
+constexpr uint64_t kStageChunkSize = 4 << 20;
+
+/*! \brief The background threads writing the queued saves. */
+class AsyncSavePool {
+ public:
+  static AsyncSavePool *Global() {
+    // never destroyed, the pending saves are waited for by the Python atexit hook
+    static AsyncSavePool *pool = new AsyncSavePool();
+    return pool;
+  }
+
+  void Submit(const AsyncSave &save, std::function<void()> write) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.emplace_back(save, std::move(write));
+    ++num_pending_;
+    cond_.notify_one();
+  }
+
+  /*! \brief Wait for all the queued saves to finish. */
+  void WaitAll() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_cond_.wait(lock, [this] { return num_pending_ == 0; });
+  }
+
+ private:
+  AsyncSavePool() {
+    const char *var = std::getenv("DGL_ASYNC_SAVE_THREADS");
+    const int num_threads = std::max(var ? std::atoi(var) : 1, 1);
+    for (int i = 0; i < num_threads; ++i)
+      std::thread(&AsyncSavePool::Run, this).detach();
+  }
+
+  void Run() {
+    while (true) {
+      std::pair<AsyncSave, std::function<void()>> task;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait(lock, [this] { return !queue_.empty(); });
+        task = std::move(queue_.front());
+        queue_.pop_front();
+      }
+      std::string error;
+      try {
+        task.second();
+      } catch (const std::exception &e) {
+        error = e.what();
+        if (error.empty())
+          error = "Fail to write the file";
+      }
+      // release the staged arrays before reporting the save as done
+      task.second = nullptr;
+      task.first->Finish(error);
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--num_pending_ == 0)
+        idle_cond_.notify_all();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::condition_variable idle_cond_;
+  std::deque<std::pair<AsyncSave, std::function<void()>>> queue_;
+  int64_t num_pending_ = 0;
+};
+
+}  // namespace
+
+bool AsyncSaveObject::Done() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return done_;
+}
+
+void AsyncSaveObject::Wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cond_.wait(lock, [this] { return done_; });
+  if (!error_.empty())
+    LOG(FATAL) << "Asynchronous save failed: " << error_;
+}
+
+void AsyncSaveObject::Finish(const std::string &error) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  error_ = error;
+  done_ = true;
+  cond_.notify_all();
+}
+
+NDArray StageTensor(NDArray array) {
+  CHECK(array.IsContiguous()) << "Only contiguous tensors can be saved";
+  const DLContext cpu_ctx{kDLCPU, 0};
+  if (array->ctx.device_type != kDLCPU) {
+    NDArray ret = array.CopyTo(cpu_ctx);
+    DeviceAPI::Get(array->ctx)->StreamSync(array->ctx, nullptr);
+    return ret;
+  }
+  NDArray ret = NDArray::Empty(
+      std::vector<int64_t>(array->shape, array->shape + array->ndim), array->dtype, cpu_ctx);
+  const uint64_t size = array.GetSize();
+  const char *src = static_cast<const char *>(array->data) + array->byte_offset;
+  char *dst = static_cast<char *>(ret->data);
+  const uint64_t num_chunks = (size + kStageChunkSize - 1) / kStageChunkSize;
+  parallel_for(0, num_chunks, 1, [&](size_t b, size_t e) {
+    for (size_t i = b; i < e; ++i) {
+      const uint64_t begin = i * kStageChunkSize;
+      std::memcpy(dst + begin, src + begin, std::min(kStageChunkSize, size - begin));
+    }
+  });
+  return ret;
+}
+
+std::vector<std::pair<std::string, NDArray>> StageTensors(
+    const std::vector<std::pair<std::string, NDArray>> &tensors) {
+  std::vector<std::pair<std::string, NDArray>> ret;
+  ret.reserve(tensors.size());
+  for (const auto &kv : tensors)
+    ret.emplace_back(kv.first, StageTensor(kv.second));
+  return ret;
+}
+
+AsyncSave SubmitAsyncSave(std::function<void()> write) {
+  AsyncSave save(std::make_shared<AsyncSaveObject>());
+  AsyncSavePool::Global()->Submit(save, std::move(write));
+  return save;
+}
+
+DGL_REGISTER_GLOBAL("data.async_save._CAPI_AsyncSaveDone")
+  .set_body([](DGLArgs args, DGLRetValue *rv) {
+    AsyncSave save = args[0];
+    *rv = save->Done();
+  });
+
+DGL_REGISTER_GLOBAL("data.async_save._CAPI_AsyncSaveWait")
+  .set_body([](DGLArgs args, DGLRetValue *rv) {
+    AsyncSave save = args[0];
+    save->Wait();
+  });
+
+DGL_REGISTER_GLOBAL("data.async_save._CAPI_WaitAllAsyncSaves")
+  .set_body([](DGLArgs args, DGLRetValue *rv) {
+    AsyncSavePool::Global()->WaitAll();
+  });
+
+}  // namespace serialize
+}  // namespace dgl
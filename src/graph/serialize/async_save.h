@@ -0,0 +1,85 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file graph/serialize/async_save.h
+ * \brief Saving tensors and graphs in the background.
+ *
+ * An asynchronous save first stages the tensors the caller may still change,
+ * i.e. the features and labels, by copying them into new CPU arrays, and then
+ * queues the write to a pool of background threads. The graph structures are
+ * immutable and not copied. The caller gets an AsyncSave handle as soon as
+ * the tensors are staged, and may change them right away.
+ *
+ * The number of background threads is given by DGL_ASYNC_SAVE_THREADS, 1 by
+ * default, so that the saves are written in the order they are queued.
+ */
+#ifndef DGL_GRAPH_SERIALIZE_ASYNC_SAVE_H_
+#define DGL_GRAPH_SERIALIZE_ASYNC_SAVE_H_
+
+#include <dgl/runtime/ndarray.h>
+#include <dgl/runtime/object.h>
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dgl {
+namespace serialize {
+
+/*! \brief The state of a save written in the background. */
+class AsyncSaveObject : public runtime::Object {
+ public:
+  static constexpr const char *_type_key = "serialize.AsyncSave";
+
+  /*! \return Whether the write has finished, successfully or not. */
+  bool Done();
+
+  /*!
+   * \brief Wait for the write to finish.
+   *
+   * Fails with the error of the write, if any.
+   */
+  void Wait();
+
+  /*! \brief Record the end of the write, with its error if not empty. */
+  void Finish(const std::string &error);
+
+  DGL_DECLARE_OBJECT_TYPE_INFO(AsyncSaveObject, runtime::Object);
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  bool done_ = false;
+  std::string error_;
+};
+
+class AsyncSave : public runtime::ObjectRef {
+ public:
+  DGL_DEFINE_OBJECT_REF_METHODS(AsyncSave, runtime::ObjectRef, AsyncSaveObject);
+};
+
+/*!
+ * \brief Copy a tensor into a new contiguous CPU array, in parallel.
+ *
+ * The copy is finished on return, even from a GPU.
+ */
+runtime::NDArray StageTensor(runtime::NDArray array);
+
+/*! \brief Stage the tensors of a list of (name, tensor) pairs. */
+std::vector<std::pair<std::string, runtime::NDArray>> StageTensors(
+    const std::vector<std::pair<std::string, runtime::NDArray>> &tensors);
+
+/*!
+ * \brief Queue a write to the background threads.
+ * \param write The write, whose arrays must all be staged.
+ * \return The handle of the save.
+ */
+AsyncSave SubmitAsyncSave(std::function<void()> write);
+
+}  // namespace serialize
+}  // namespace dgl
+
+#endif  // DGL_GRAPH_SERIALIZE_ASYNC_SAVE_H_
@@ -94,6 +94,29 @@ bool SaveDGLGraphs(std::string filename, List<GraphData> graph_data,
 std::vector<HeteroGraphData> LoadHeteroGraphs(const std::string &filename,
                                               std::vector<dgl_id_t> idx_list);
 
+bool SaveHeteroGraphsMmap(std::string filename, List<HeteroGraphData> hdata,
+                          const std::vector<NamedTensor> &nd_list);
+
+std::vector<HeteroGraphData> LoadHeteroGraphsMmap(const std::string &filename,
+                                                  std::vector<dgl_id_t> idx_list);
+
+std::vector<NamedTensor> LoadLabelsMmap(const std::string &filename);
+
+bool SaveHeteroGraphsColumnar(std::string filename, List<HeteroGraphData> hdata,
+                              const std::vector<NamedTensor> &nd_list);
+
+std::vector<HeteroGraphData> LoadHeteroGraphsColumnar(const std::string &filename,
+                                                      std::vector<dgl_id_t> idx_list);
+
+std::vector<NamedTensor> LoadLabelsColumnar(const std::string &filename);
+
+bool SaveHeteroGraphDelta(const std::string &filename, HeteroGraphDelta delta);
+
+HeteroGraphDelta LoadHeteroGraphDelta(const std::string &filename);
+
+HeteroGraphData ApplyHeteroGraphDeltas(HeteroGraphData base,
+                                       const std::vector<HeteroGraphDelta> &deltas);
+
 ImmutableGraphPtr ToImmutableGraph(GraphPtr g);
 
 }  // namespace serialize
@@ -0,0 +1,442 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file graph/serialize/heterograph_columnar_serialize.cc
+ * \brief DGLHeteroGraph serialization with the features stored by columns
+ *
+ * The storage structure is
+ * {
+ *   // MetaData Section
+ *   uint64_t kDGLSerializeMagic
+ *   uint64_t kVersion = 5
+ *   uint64_t GraphType = kDGLHeteroGraph
+ *   dgl_id_t num_graphs
+ *   ** Reserved Area till 4kB **
+ *
+ *   // Graph Section
+ *   vector<HeteroGraphData> graph_datas (without their features)
+ *
+ *   // Column Section, each column starting at a multiple of 4kB
+ *   vector<char> column_payloads
+ *
+ *   // Index Section
+ *   vector<uint64_t> graph_pos (the file offset of each graph, and the end of
+ * the graph section)
+ *   uint64_t num_columns
+ *   ColumnInfo columns[num_columns]
+ *   uint64_t index_pos (the file offset of the index section)
+ * }
+ *
+ * A column stores one feature of all the graphs, i.e. the feature of a node
+ * type or of a canonical edge type, as the concatenation of the rows of every
+ * graph. Loading one feature of all the graphs is thus a single sequential
+ * read, without parsing the graphs. A label is a column with a single row,
+ * the label tensor.
+ */
+#include <dgl/runtime/container.h>
+#include <dgl/runtime/object.h>
+#include <dgl/runtime/serializer.h>
+#include <dmlc/io.h>
+#include <dmlc/memory_io.h>
+
+#include <algorithm>
+#include <array>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "./graph_serialize.h"
+#include "./streamwithcount.h"
+
+namespace dgl {
+namespace serialize {
+
+using namespace dgl::runtime;
+using dmlc::SeekStream;
+using dmlc::Stream;
+using dmlc::io::FileSystem;
+using dmlc::io::URI;
+
+namespace {
+
+constexpr uint64_t kVersion = 5;
+constexpr uint64_t kPageSize = 4096;
+
+enum ColumnKind : uint64_t {
+  kNodeColumn = 0,
+  kEdgeColumn = 1,
+  kLabelColumn = 2,
+};
+
+/*! \brief The description of a column. */
+struct ColumnInfo {
+  uint64_t kind;
+  // the node type, the canonical edge type or nothing for a label
+  std::vector<std::string> type;
+  std::string name;
+  DLDataType dtype;
+  // the shape of a row, i.e. of the label for a label
+  std::vector<int64_t> row_shape;
+  // the file offset of the payload
+  uint64_t pos;
+  // the rows of graph i are [row_offsets[i], row_offsets[i + 1]), present
+  // only if the graph has the feature
+  std::vector<int64_t> row_offsets;
+  std::vector<uint8_t> present;
+
+  void Save(Stream *fs) const {
+    fs->Write(kind);
+    fs->Write(type);
+    fs->Write(name);
+    fs->Write(dtype);
+    fs->Write(row_shape);
+    fs->Write(pos);
+    fs->Write(row_offsets);
+    fs->Write(present);
+  }
+
+  bool Load(Stream *fs) {
+    return fs->Read(&kind) && fs->Read(&type) && fs->Read(&name) && fs->Read(&dtype) &&
+      fs->Read(&row_shape) && fs->Read(&pos) && fs->Read(&row_offsets) && fs->Read(&present);
+  }
+
+  uint64_t RowBytes() const {
+    uint64_t size = (dtype.bits * dtype.lanes + 7) / 8;
+    for (const int64_t dim : row_shape)
+      size *= dim;
+    return size;
+  }
+};
+
+/*! \return The canonical edge type of an edge type of the graph. */
+std::vector<std::string> CanonicalEtype(const HeteroGraphDataObject &gdata, dgl_type_t etype) {
+  const auto pair = gdata.gptr->meta_graph()->FindEdge(etype);
+  return {gdata.ntype_names[pair.first], gdata.etype_names[etype],
+          gdata.ntype_names[pair.second]};
+}
+
+/*! \brief The tensors of the columns of the saved graphs. */
+class ColumnBuilder {
+ public:
+  explicit ColumnBuilder(uint64_t num_graph) : num_graph_(num_graph) {}
+
+  void Add(uint64_t kind, const std::vector<std::string> &type, const std::string &name,
+           uint64_t gid, NDArray tensor) {
+    CHECK(tensor.IsContiguous()) << "Only contiguous tensors can be saved";
+    if (kind != kLabelColumn)
+      CHECK_GE(tensor->ndim, 1) << "The feature " << name << " has no row";
+    const auto key = std::make_tuple(kind, type, name);
+    auto it = ids_.find(key);
+    if (it == ids_.end()) {
+      it = ids_.emplace(key, columns_.size()).first;
+      ColumnInfo col;
+      col.kind = kind;
+      col.type = type;
+      col.name = name;
+      col.dtype = tensor->dtype;
+      col.row_shape.assign(tensor->shape + (kind == kLabelColumn ? 0 : 1),
+                           tensor->shape + tensor->ndim);
+      col.present.resize(kind == kLabelColumn ? 1 : num_graph_, 0);
+      columns_.push_back(col);
+      tensors_.emplace_back(col.present.size());
+    }
+    ColumnInfo *col = &columns_[it->second];
+    CHECK(col->dtype == tensor->dtype && std::equal(
+        col->row_shape.begin(), col->row_shape.end(),
+        tensor->shape + (kind == kLabelColumn ? 0 : 1)) &&
+        col->row_shape.size() + (kind == kLabelColumn ? 0 : 1) == tensor->ndim)
+      << "The feature " << name << " has different data types or row shapes in the graphs, "
+      << "which cannot be stored by columns";
+    col->present[gid] = 1;
+    tensors_[it->second][gid] = tensor;
+  }
+
+  /*! \brief Write the payloads of the columns, and return their descriptions. */
+  std::vector<ColumnInfo> Write(StreamWithCount *fs) {
+    std::array<char, kPageSize> zeros;
+    zeros.fill(0);
+    const DLContext cpu_ctx{kDLCPU, 0};
+    for (size_t c = 0; c < columns_.size(); ++c) {
+      ColumnInfo *col = &columns_[c];
+      fs->Write(zeros.data(), (kPageSize - fs->Count() % kPageSize) % kPageSize);
+      col->pos = fs->Count();
+      col->row_offsets.assign(1, 0);
+      for (const NDArray &tensor : tensors_[c]) {
+        int64_t num_rows = 0;
+        if (tensor.defined()) {
+          num_rows = col->kind == kLabelColumn ? 1 : tensor->shape[0];
+          const NDArray cpu_tensor =
+            tensor->ctx.device_type == kDLCPU ? tensor : tensor.CopyTo(cpu_ctx);
+          fs->Write(static_cast<const char *>(cpu_tensor->data) + cpu_tensor->byte_offset,
+                    num_rows * col->RowBytes());
+        }
+        col->row_offsets.push_back(col->row_offsets.back() + num_rows);
+      }
+    }
+    return columns_;
+  }
+
+ private:
+  uint64_t num_graph_;
+  std::map<std::tuple<uint64_t, std::vector<std::string>, std::string>, size_t> ids_;
+  std::vector<ColumnInfo> columns_;
+  std::vector<std::vector<NDArray>> tensors_;
+};
+
+/*! \brief The index of a file of graphs stored by columns. */
+struct ColumnarIndex {
+  std::unique_ptr<SeekStream> fs;
+  uint64_t num_graph;
+  std::vector<uint64_t> graph_pos;
+  std::vector<ColumnInfo> columns;
+
+  explicit ColumnarIndex(const std::string &filename)
+    : fs(SeekStream::CreateForRead(filename.c_str(), false)) {
+    CHECK(fs) << "File name " << filename << " is not a valid name";
+    uint64_t magicNum, graphType, version;
+    fs->Read(&magicNum);
+    fs->Read(&version);
+    fs->Read(&graphType);
+    CHECK(fs->Read(&num_graph)) << "Invalid num of graph";
+    CHECK_EQ(magicNum, kDGLSerializeMagic) << "Invalid DGL files";
+    CHECK_EQ(version, kVersion) << "Invalid DGL Version Number";
+    CHECK_EQ(graphType, GraphType::kHeteroGraph) << "Invalid GraphType";
+
+    // the index position is the last 8 bytes of the file
+    URI uri(filename.c_str());
+    fs->Seek(FileSystem::GetInstance(uri)->GetPathInfo(uri).size - sizeof(uint64_t));
+    uint64_t index_pos;
+    CHECK(fs->Read(&index_pos)) << "Invalid DGL files";
+    fs->Seek(index_pos);
+    uint64_t num_columns;
+    CHECK(fs->Read(&graph_pos) && fs->Read(&num_columns)) << "Invalid DGL files";
+    CHECK_EQ(graph_pos.size(), num_graph + 1) << "Invalid DGL files";
+    columns.resize(num_columns);
+    for (auto &col : columns)
+      CHECK(col.Load(fs.get())) << "Invalid DGL files";
+  }
+
+  HeteroGraphData ReadGraph(dgl_id_t gid) {
+    CHECK((gid < num_graph) && (gid >= 0))
+      << "ID " << gid << " in idx_list is out of bound. Please check your idx_list.";
+    fs->Seek(graph_pos[gid]);
+    HeteroGraphData gdata = HeteroGraphData::Create();
+    auto hetero_data = gdata.sptr();
+    CHECK(fs->Read(&hetero_data)) << "Invalid DGL files";
+    return gdata;
+  }
+
+  /*! \brief Read the rows [begin, end) of a column with a single read. */
+  NDArray ReadRows(const ColumnInfo &col, int64_t begin, int64_t end) {
+    std::vector<int64_t> shape;
+    if (col.kind != kLabelColumn)
+      shape.push_back(end - begin);
+    shape.insert(shape.end(), col.row_shape.begin(), col.row_shape.end());
+    NDArray ret = NDArray::Empty(shape, col.dtype, DLContext{kDLCPU, 0});
+    const uint64_t row_bytes = col.RowBytes();
+    fs->Seek(col.pos + begin * row_bytes);
+    char *data = static_cast<char *>(ret->data);
+    for (uint64_t size = (end - begin) * row_bytes; size > 0;) {
+      const size_t nread = fs->Read(data, size);
+      CHECK_GT(nread, 0) << "Invalid DGL files";
+      data += nread;
+      size -= nread;
+    }
+    return ret;
+  }
+
+  /*! \brief Return the column of a feature, or the only one of the name if type is empty. */
+  const ColumnInfo &FindColumn(uint64_t kind, const std::vector<std::string> &type,
+                               const std::string &name) const {
+    const ColumnInfo *found = nullptr;
+    for (const auto &col : columns) {
+      if (col.kind != kind || col.name != name)
+        continue;
+      // an edge type may be given by its name only
+      const bool match = type.empty() || col.type == type ||
+        (kind == kEdgeColumn && type.size() == 1 && col.type[1] == type[0]);
+      if (!match)
+        continue;
+      CHECK(found == nullptr) << "The feature " << name << " exists for multiple types, "
+                              << "please specify the type";
+      found = &col;
+    }
+    CHECK(found != nullptr) << "The feature " << name << " is not found";
+    return *found;
+  }
+};
+
+}  // namespace
+
+bool SaveHeteroGraphsColumnar(std::string filename, List<HeteroGraphData> hdata,
+                              const std::vector<NamedTensor> &nd_list) {
+  auto fs = std::unique_ptr<StreamWithCount>(
+    StreamWithCount::Create(filename.c_str(), "w", false));
+  CHECK(fs->IsValid()) << "File name " << filename << " is not a valid name";
+
+  std::array<char, kPageSize> meta_buffer;
+  meta_buffer.fill(0);
+  dmlc::MemoryFixedSizeStream meta_fs_(meta_buffer.data(), kPageSize);
+  auto meta_fs = static_cast<Stream *>(&meta_fs_);
+  meta_fs->Write(kDGLSerializeMagic);
+  meta_fs->Write(kVersion);
+  meta_fs->Write(GraphType::kHeteroGraph);
+  uint64_t num_graph = hdata.size();
+  meta_fs->Write(num_graph);
+  fs->Write(meta_buffer.data(), kPageSize);
+
+  // the graphs are written without their features, which go to the columns
+  ColumnBuilder builder(num_graph);
+  std::vector<uint64_t> graph_pos;
+  for (uint64_t i = 0; i < num_graph; ++i) {
+    graph_pos.push_back(fs->Count());
+    auto gdata = hdata[i].sptr();
+    HeteroGraphData record = HeteroGraphData::Create();
+    record->gptr = gdata->gptr;
+    record->node_tensors.resize(gdata->node_tensors.size());
+    record->edge_tensors.resize(gdata->edge_tensors.size());
+    record->ntype_names = gdata->ntype_names;
+    record->etype_names = gdata->etype_names;
+    fs->Write(record.sptr());
+    for (size_t ntype = 0; ntype < gdata->node_tensors.size(); ++ntype) {
+      for (const auto &kv : gdata->node_tensors[ntype])
+        builder.Add(kNodeColumn, {gdata->ntype_names[ntype]}, kv.first, i, kv.second);
+    }
+    for (size_t etype = 0; etype < gdata->edge_tensors.size(); ++etype) {
+      for (const auto &kv : gdata->edge_tensors[etype])
+        builder.Add(kEdgeColumn, CanonicalEtype(*gdata, etype), kv.first, i, kv.second);
+    }
+  }
+  graph_pos.push_back(fs->Count());
+  for (const auto &kv : nd_list)
+    builder.Add(kLabelColumn, {}, kv.first, 0, kv.second);
+  const std::vector<ColumnInfo> columns = builder.Write(fs.get());
+
+  std::string index_blob;
+  dmlc::MemoryStringStream index_fs_(&index_blob);
+  auto index_fs = static_cast<Stream *>(&index_fs_);
+  index_fs->Write(graph_pos);
+  index_fs->Write(static_cast<uint64_t>(columns.size()));
+  for (const auto &col : columns)
+    col.Save(index_fs);
+  const uint64_t index_pos = fs->Count();
+  fs->Write(index_blob.data(), index_blob.size());
+  fs->Write(index_pos);
+  return true;
+}
+
+std::vector<HeteroGraphData> LoadHeteroGraphsColumnar(const std::string &filename,
+                                                      std::vector<dgl_id_t> idx_list) {
+  ColumnarIndex index(filename);
+  const bool load_all = idx_list.empty();
+  if (load_all) {
+    idx_list.resize(index.num_graph);
+    std::iota(idx_list.begin(), idx_list.end(), 0);
+  }
+  // The returned graphs are in the order of idx_list
+  std::vector<HeteroGraphData> gdata_refs;
+  for (const dgl_id_t gid : idx_list)
+    gdata_refs.push_back(index.ReadGraph(gid));
+
+  for (const auto &col : index.columns) {
+    if (col.kind == kLabelColumn)
+      continue;
+    // the whole column is read at once when all the graphs are loaded
+    NDArray all_rows;
+    if (load_all)
+      all_rows = index.ReadRows(col, 0, col.row_offsets.back());
+    for (size_t k = 0; k < idx_list.size(); ++k) {
+      const dgl_id_t gid = idx_list[k];
+      if (!col.present[gid])
+        continue;
+      const int64_t begin = col.row_offsets[gid], end = col.row_offsets[gid + 1];
+      NDArray rows;
+      if (load_all) {
+        std::vector<int64_t> shape = {end - begin};
+        shape.insert(shape.end(), col.row_shape.begin(), col.row_shape.end());
+        rows = all_rows.CreateView(shape, col.dtype, begin * col.RowBytes());
+      } else {
+        rows = index.ReadRows(col, begin, end);
+      }
+      auto gdata = gdata_refs[k].sptr();
+      if (col.kind == kNodeColumn) {
+        const auto it =
+          std::find(gdata->ntype_names.begin(), gdata->ntype_names.end(), col.type[0]);
+        CHECK(it != gdata->ntype_names.end()) << "Invalid DGL files";
+        gdata->node_tensors[it - gdata->ntype_names.begin()].emplace_back(col.name, rows);
+      } else {
+        dgl_type_t etype = 0;
+        while (etype < gdata->etype_names.size() && CanonicalEtype(*gdata, etype) != col.type)
+          ++etype;
+        CHECK_LT(etype, gdata->etype_names.size()) << "Invalid DGL files";
+        gdata->edge_tensors[etype].emplace_back(col.name, rows);
+      }
+    }
+  }
+  return gdata_refs;
+}
+
+std::vector<NamedTensor> LoadLabelsColumnar(const std::string &filename) {
+  ColumnarIndex index(filename);
+  std::vector<NamedTensor> labels_list;
+  for (const auto &col : index.columns) {
+    if (col.kind == kLabelColumn)
+      labels_list.emplace_back(col.name, index.ReadRows(col, 0, 1));
+  }
+  return labels_list;
+}
+
+DGL_REGISTER_GLOBAL("data.heterograph_serialize._CAPI_SaveHeteroGraphData_V5")
+  .set_body([](DGLArgs args, DGLRetValue *rv) {
+    std::string filename = args[0];
+    List<HeteroGraphData> hgdata = args[1];
+    Map<std::string, Value> nd_map = args[2];
+    std::vector<NamedTensor> nd_list;
+    for (auto kv : nd_map) {
+      NDArray ndarray = static_cast<NDArray>(kv.second->data);
+      nd_list.emplace_back(kv.first, ndarray);
+    }
+    *rv = SaveHeteroGraphsColumnar(filename, hgdata, nd_list);
+  });
+
+DGL_REGISTER_GLOBAL("data.graph_serialize._CAPI_LoadGraphFiles_V5")
+  .set_body([](DGLArgs args, DGLRetValue *rv) {
+    std::string filename = args[0];
+    List<Value> idxs = args[1];
+    auto idx_list = ListValueToVector<dgl_id_t>(idxs);
+    *rv = List<HeteroGraphData>(LoadHeteroGraphsColumnar(filename, idx_list));
+  });
+
+DGL_REGISTER_GLOBAL("data.graph_serialize._CAPI_LoadLabels_V5")
+  .set_body([](DGLArgs args, DGLRetValue *rv) {
+    std::string filename = args[0];
+    auto labels_list = LoadLabelsColumnar(filename);
+    Map<std::string, Value> rvmap;
+    for (auto kv : labels_list) {
+      rvmap.Set(kv.first, Value(MakeValue(kv.second)));
+    }
+    *rv = rvmap;
+  });
+
+DGL_REGISTER_GLOBAL("data.graph_serialize._CAPI_LoadFeatureColumn_V5")
+  .set_body([](DGLArgs args, DGLRetValue *rv) {
+    std::string filename = args[0];
+    const bool is_edge = args[1];
+    auto type = ListValueToVector<std::string>(args[2]);
+    std::string name = args[3];
+    ColumnarIndex index(filename);
+    const ColumnInfo &col = index.FindColumn(is_edge ? kEdgeColumn : kNodeColumn, type, name);
+    // the rows of all the graphs, their offsets, and whether each graph has the feature
+    List<Value> ret;
+    ret.push_back(Value(MakeValue(index.ReadRows(col, 0, col.row_offsets.back()))));
+    ret.push_back(Value(MakeValue(NDArray::FromVector(col.row_offsets))));
+    std::vector<int64_t> present(col.present.begin(), col.present.end());
+    ret.push_back(Value(MakeValue(NDArray::FromVector(present))));
+    *rv = ret;
+  });
+
+}  // namespace serialize
+}  // namespace dgl
@@ -113,11 +113,81 @@ class HeteroGraphData : public runtime::ObjectRef {
     return HeteroGraphData(std::make_shared<HeteroGraphDataObject>());
   }
 };
+
+/*!
+ * \brief The changes of a heterograph since a snapshot.
+ *
+ * The graph only grows: new nodes and edges get the IDs after the ones of the
+ * snapshot, and the rows of their features are appended. The rows of existing
+ * nodes and edges can be replaced by patches.
+ */
+class HeteroGraphDeltaObject : public runtime::Object {
+ public:
+  std::vector<std::string> ntype_names;
+  std::vector<std::string> etype_names;
+  /*! \brief The numbers of nodes and edges of every type in the snapshot */
+  std::vector<int64_t> base_num_nodes;
+  std::vector<int64_t> base_num_edges;
+  std::vector<int64_t> num_new_nodes;
+  /*! \brief The endpoints of the new edges of every edge type */
+  std::vector<IdArray> new_src;
+  std::vector<IdArray> new_dst;
+  /*! \brief The feature rows of the new nodes and edges */
+  std::vector<std::vector<NamedTensor>> node_tensors;
+  std::vector<std::vector<NamedTensor>> edge_tensors;
+  /*! \brief The existing nodes and edges patched, and their new feature rows */
+  std::vector<IdArray> dirty_nodes;
+  std::vector<IdArray> dirty_edges;
+  std::vector<std::vector<NamedTensor>> node_patches;
+  std::vector<std::vector<NamedTensor>> edge_patches;
+
+  static constexpr const char *_type_key =
+    "heterograph_serialize.HeteroGraphDelta";
+
+  void Save(dmlc::Stream *fs) const {
+    fs->Write(ntype_names);
+    fs->Write(etype_names);
+    fs->Write(base_num_nodes);
+    fs->Write(base_num_edges);
+    fs->Write(num_new_nodes);
+    fs->Write(new_src);
+    fs->Write(new_dst);
+    fs->Write(node_tensors);
+    fs->Write(edge_tensors);
+    fs->Write(dirty_nodes);
+    fs->Write(dirty_edges);
+    fs->Write(node_patches);
+    fs->Write(edge_patches);
+  }
+
+  bool Load(dmlc::Stream *fs) {
+    return fs->Read(&ntype_names) && fs->Read(&etype_names) &&
+      fs->Read(&base_num_nodes) && fs->Read(&base_num_edges) &&
+      fs->Read(&num_new_nodes) && fs->Read(&new_src) && fs->Read(&new_dst) &&
+      fs->Read(&node_tensors) && fs->Read(&edge_tensors) &&
+      fs->Read(&dirty_nodes) && fs->Read(&dirty_edges) &&
+      fs->Read(&node_patches) && fs->Read(&edge_patches);
+  }
+
+  DGL_DECLARE_OBJECT_TYPE_INFO(HeteroGraphDeltaObject, runtime::Object);
+};
+
+class HeteroGraphDelta : public runtime::ObjectRef {
+ public:
+  DGL_DEFINE_OBJECT_REF_METHODS(HeteroGraphDelta, runtime::ObjectRef,
+                                HeteroGraphDeltaObject);
+
+  /*! \brief create an empty GraphDelta reference */
+  static HeteroGraphDelta Create() {
+    return HeteroGraphDelta(std::make_shared<HeteroGraphDeltaObject>());
+  }
+};
 }  // namespace serialize
 }  // namespace dgl
 
 namespace dmlc {
 DMLC_DECLARE_TRAITS(has_saveload, dgl::serialize::HeteroGraphDataObject, true);
+DMLC_DECLARE_TRAITS(has_saveload, dgl::serialize::HeteroGraphDeltaObject, true);
 }
 
 #endif  // DGL_GRAPH_SERIALIZE_HETEROGRAPH_DATA_H_
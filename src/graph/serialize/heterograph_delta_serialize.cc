@@ -0,0 +1,249 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file graph/serialize/heterograph_delta_serialize.cc
+ * \brief Incremental snapshots of a growing DGLHeteroGraph
+ *
+ * A delta file stores the changes of a graph since a snapshot
+ * {
+ *   uint64_t kDGLSerializeMagic
+ *   uint64_t kVersion = 4
+ *   uint64_t GraphType = kHeteroGraph
+ *   HeteroGraphDeltaObject delta
+ * }
+ *
+ * The snapshot is a file saved by save_graphs, and the deltas are applied in
+ * the order they have been saved. Every delta records the numbers of nodes
+ * and edges of the graph it starts from, so a delta applied out of order is
+ * detected.
+ *
+ * The relation graphs without new edges and the feature tensors without new
+ * rows are the ones of the snapshot, patched in place. With a memory mapped
+ * snapshot, a patch thus only copies the pages it writes.
+ */
+#include <dgl/runtime/container.h>
+#include <dgl/runtime/object.h>
+#include <dgl/runtime/parallel_for.h>
+#include <dgl/transform.h>
+#include <dmlc/io.h>
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../heterograph.h"
+#include "./graph_serialize.h"
+
+using namespace dgl::runtime;
+
+namespace dgl {
+namespace serialize {
+
+namespace {
+
+constexpr uint64_t kVersion = 4;
+
+std::vector<std::vector<NamedTensor>> ToNamedTensors(List<Map<std::string, Value>> dicts) {
+  std::vector<std::vector<NamedTensor>> ret;
+  for (auto dict : dicts) {
+    ret.emplace_back();
+    for (auto kv : dict)
+      ret.back().emplace_back(kv.first, static_cast<NDArray>(kv.second->data));
+  }
+  return ret;
+}
+
+NDArray* FindTensor(std::vector<NamedTensor>* tensors, const std::string& name) {
+  for (auto& kv : *tensors) {
+    if (kv.first == name)
+      return &kv.second;
+  }
+  return nullptr;
+}
+
+/*! \brief Return the rows of a followed by the rows of b. */
+NDArray ConcatRows(NDArray a, NDArray b) {
+  CHECK_EQ(a->ndim, b->ndim) << "The new rows do not have the shape of the feature";
+  std::vector<int64_t> shape(a->shape, a->shape + a->ndim);
+  for (int i = 1; i < a->ndim; ++i)
+    CHECK_EQ(a->shape[i], b->shape[i]) << "The new rows do not have the shape of the feature";
+  CHECK(a->dtype == b->dtype) << "The new rows do not have the data type of the feature";
+  shape[0] += b->shape[0];
+  NDArray ret = NDArray::Empty(shape, a->dtype, a->ctx);
+  const std::vector<int64_t> a_shape(a->shape, a->shape + a->ndim);
+  const std::vector<int64_t> b_shape(b->shape, b->shape + b->ndim);
+  if (a->shape[0] > 0)
+    ret.CreateView(a_shape, a->dtype, 0).CopyFrom(a);
+  if (b->shape[0] > 0)
+    ret.CreateView(b_shape, b->dtype, a.GetSize()).CopyFrom(b);
+  return ret;
+}
+
+/*! \brief Replace the rows ids of the CPU tensor out by the rows of values. */
+template <typename IdType>
+void ScatterRows(NDArray out, IdArray ids, NDArray values) {
+  CHECK_EQ(out->ctx.device_type, kDLCPU) << "Only CPU features can be patched";
+  CHECK(out.IsContiguous()) << "Only contiguous features can be patched";
+  const int64_t num_rows = out->shape[0];
+  const int64_t num_ids = ids->shape[0];
+  CHECK_EQ(values->shape[0], num_ids) << "The patch does not have a row per ID";
+  CHECK(values->dtype == out->dtype) << "The patch does not have the data type of the feature";
+  const size_t row_bytes = num_rows > 0 ? out.GetSize() / num_rows : 0;
+  CHECK_EQ(values.GetSize(), num_ids * row_bytes) << "The patch does not have the shape of "
+                                                     "the feature";
+  const IdType* id_data = ids.Ptr<IdType>();
+  for (int64_t i = 0; i < num_ids; ++i)
+    CHECK(id_data[i] >= 0 && id_data[i] < num_rows) << "Invalid patched ID " << id_data[i];
+  char* out_data = static_cast<char*>(out->data);
+  const NDArray cpu_values = values.CopyTo(out->ctx);
+  const char* value_data = static_cast<const char*>(cpu_values->data);
+  parallel_for(0, num_ids, [&](size_t b, size_t e) {
+    for (size_t i = b; i < e; ++i)
+      std::memcpy(out_data + id_data[i] * row_bytes, value_data + i * row_bytes, row_bytes);
+  });
+}
+
+/*! \brief Append the rows of the new nodes or edges to every feature. */
+void AppendRows(std::vector<NamedTensor>* tensors, std::vector<NamedTensor> rows,
+                int64_t num_new) {
+  for (const auto& kv : rows)
+    CHECK(FindTensor(tensors, kv.first)) << "The feature " << kv.first << " of the delta "
+                                         << "is not in the snapshot";
+  if (num_new == 0)
+    return;
+  for (auto& kv : *tensors) {
+    NDArray* new_rows = FindTensor(&rows, kv.first);
+    CHECK(new_rows) << "The delta lacks the rows of the new nodes or edges of the feature "
+                    << kv.first;
+    CHECK_EQ((*new_rows)->shape[0], num_new)
+      << "The delta does not have a row per new node or edge of the feature " << kv.first;
+    kv.second = ConcatRows(kv.second, *new_rows);
+  }
+}
+
+void PatchRows(std::vector<NamedTensor>* tensors, IdArray ids,
+               const std::vector<NamedTensor>& patches) {
+  if (ids->shape[0] == 0)
+    return;
+  for (const auto& kv : patches) {
+    NDArray* out = FindTensor(tensors, kv.first);
+    CHECK(out) << "The feature " << kv.first << " of the delta is not in the snapshot";
+    ATEN_ID_TYPE_SWITCH(ids->dtype, IdType, {
+      ScatterRows<IdType>(*out, ids.CopyTo(DLContext{kDLCPU, 0}), kv.second);
+    });
+  }
+}
+
+void ApplyDelta(HeteroGraphDataObject* data, const HeteroGraphDeltaObject& delta) {
+  CHECK(delta.ntype_names == data->ntype_names && delta.etype_names == data->etype_names)
+    << "The delta does not have the node and edge types of the snapshot";
+  const HeteroGraphPtr g = data->gptr;
+  const uint64_t num_ntypes = g->NumVertexTypes();
+  const uint64_t num_etypes = g->NumEdgeTypes();
+  CHECK(delta.base_num_nodes.size() == num_ntypes && delta.num_new_nodes.size() == num_ntypes &&
+        delta.node_tensors.size() == num_ntypes && delta.dirty_nodes.size() == num_ntypes &&
+        delta.node_patches.size() == num_ntypes) << "Invalid DGL graph delta";
+  CHECK(delta.base_num_edges.size() == num_etypes && delta.new_src.size() == num_etypes &&
+        delta.new_dst.size() == num_etypes && delta.edge_tensors.size() == num_etypes &&
+        delta.dirty_edges.size() == num_etypes && delta.edge_patches.size() == num_etypes)
+    << "Invalid DGL graph delta";
+
+  std::vector<int64_t> num_nodes(num_ntypes);
+  for (uint64_t ntype = 0; ntype < num_ntypes; ++ntype) {
+    CHECK_EQ(static_cast<int64_t>(g->NumVertices(ntype)), delta.base_num_nodes[ntype])
+      << "The delta does not start from the graph it is applied to: node type "
+      << data->ntype_names[ntype] << " has " << g->NumVertices(ntype)
+      << " nodes instead of " << delta.base_num_nodes[ntype];
+    num_nodes[ntype] = delta.base_num_nodes[ntype] + delta.num_new_nodes[ntype];
+  }
+  for (uint64_t etype = 0; etype < num_etypes; ++etype) {
+    CHECK_EQ(static_cast<int64_t>(g->NumEdges(etype)), delta.base_num_edges[etype])
+      << "The delta does not start from the graph it is applied to: edge type "
+      << data->etype_names[etype] << " has " << g->NumEdges(etype)
+      << " edges instead of " << delta.base_num_edges[etype];
+  }
+
+  data->gptr = std::dynamic_pointer_cast<HeteroGraph>(
+      transform::AddEdges(g, delta.new_src, delta.new_dst, num_nodes));
+  CHECK_NOTNULL(data->gptr);
+  for (uint64_t ntype = 0; ntype < num_ntypes; ++ntype) {
+    AppendRows(&data->node_tensors[ntype], delta.node_tensors[ntype],
+               delta.num_new_nodes[ntype]);
+    PatchRows(&data->node_tensors[ntype], delta.dirty_nodes[ntype],
+              delta.node_patches[ntype]);
+  }
+  for (uint64_t etype = 0; etype < num_etypes; ++etype) {
+    AppendRows(&data->edge_tensors[etype], delta.edge_tensors[etype],
+               delta.new_src[etype]->shape[0]);
+    PatchRows(&data->edge_tensors[etype], delta.dirty_edges[etype],
+              delta.edge_patches[etype]);
+  }
+}
+
+}  // namespace
+
+bool SaveHeteroGraphDelta(const std::string &filename, HeteroGraphDelta delta) {
+  auto fs = std::unique_ptr<dmlc::Stream>(
+    dmlc::Stream::Create(filename.c_str(), "w", false));
+  CHECK(fs) << "File name " << filename << " is not a valid name";
+  fs->Write(kDGLSerializeMagic);
+  fs->Write(kVersion);
+  fs->Write(GraphType::kHeteroGraph);
+  delta->Save(fs.get());
+  return true;
+}
+
+HeteroGraphDelta LoadHeteroGraphDelta(const std::string &filename) {
+  auto fs = std::unique_ptr<dmlc::Stream>(
+    dmlc::Stream::Create(filename.c_str(), "r", true));
+  CHECK(fs) << "File " << filename << " not found";
+  uint64_t magicNum, version, graphType;
+  CHECK(fs->Read(&magicNum)) << "Invalid DGL files";
+  CHECK(fs->Read(&version)) << "Invalid DGL files";
+  CHECK(fs->Read(&graphType)) << "Invalid DGL files";
+  CHECK_EQ(magicNum, kDGLSerializeMagic) << "Invalid DGL files";
+  CHECK_EQ(version, kVersion) << "File " << filename << " is not a DGL graph delta";
+  CHECK_EQ(graphType, GraphType::kHeteroGraph) << "Invalid GraphType";
+  HeteroGraphDelta delta = HeteroGraphDelta::Create();
+  CHECK(delta->Load(fs.get())) << "Invalid DGL graph delta";
+  return delta;
+}
+
+HeteroGraphData ApplyHeteroGraphDeltas(HeteroGraphData base,
+                                       const std::vector<HeteroGraphDelta> &deltas) {
+  for (const auto& delta : deltas)
+    ApplyDelta(base.sptr().get(), *delta.sptr());
+  return base;
+}
+
+DGL_REGISTER_GLOBAL("data.graph_serialize._CAPI_SaveHeteroGraphDelta")
+  .set_body([](DGLArgs args, DGLRetValue *rv) {
+    std::string filename = args[0];
+    HeteroGraphDelta delta = HeteroGraphDelta::Create();
+    delta->ntype_names = ListValueToVector<std::string>(args[1]);
+    delta->etype_names = ListValueToVector<std::string>(args[2]);
+    delta->base_num_nodes = ListValueToVector<int64_t>(args[3]);
+    delta->base_num_edges = ListValueToVector<int64_t>(args[4]);
+    delta->num_new_nodes = ListValueToVector<int64_t>(args[5]);
+    delta->new_src = ListValueToVector<IdArray>(args[6]);
+    delta->new_dst = ListValueToVector<IdArray>(args[7]);
+    delta->node_tensors = ToNamedTensors(args[8]);
+    delta->edge_tensors = ToNamedTensors(args[9]);
+    delta->dirty_nodes = ListValueToVector<IdArray>(args[10]);
+    delta->dirty_edges = ListValueToVector<IdArray>(args[11]);
+    delta->node_patches = ToNamedTensors(args[12]);
+    delta->edge_patches = ToNamedTensors(args[13]);
+    *rv = SaveHeteroGraphDelta(filename, delta);
+  });
+
+DGL_REGISTER_GLOBAL("data.graph_serialize._CAPI_ApplyHeteroGraphDeltas")
+  .set_body([](DGLArgs args, DGLRetValue *rv) {
+    HeteroGraphData base = args[0];
+    std::vector<HeteroGraphDelta> deltas;
+    for (const auto& filename : ListValueToVector<std::string>(args[1]))
+      deltas.push_back(LoadHeteroGraphDelta(filename));
+    *rv = ApplyHeteroGraphDeltas(base, deltas);
+  });
+
+}  // namespace serialize
+}  // namespace dgl
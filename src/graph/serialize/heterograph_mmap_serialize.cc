@@ -0,0 +1,315 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file graph/serialize/heterograph_mmap_serialize.cc
+ * \brief DGLHeteroGraph serialization for memory mapped loading
+ *
+ * The storage structure is
+ * {
+ *   // MetaData Section
+ *   uint64_t kDGLSerializeMagic
+ *   uint64_t kVersion = 3
+ *   uint64_t GraphType = kDGLHeteroGraph
+ *   dgl_id_t num_graphs
+ *   ** Reserved Area till 4kB **
+ *
+ *   // Array Section, each array starting at a multiple of 4kB
+ *   vector<char> array_payloads
+ *
+ *   // Index Section
+ *   vector<uint64_t> array_pos (the file offset of each array payload)
+ *   vector<string> blobs (blob 0 stores the label dict, blob i + 1 stores
+ * the HeteroGraphData of graph i, with their NDArrays replaced by references
+ * to the array payloads)
+ *   vector<uint64_t> blob_arrays (the index of the first array of each blob,
+ * followed by the number of arrays)
+ *   uint64_t index_pos (the file offset of the index section)
+ * }
+ *
+ * Loading maps the file into memory, and the NDArrays point directly into
+ * the mapping instead of being read, so that the page cache is shared by the
+ * processes loading the same file.
+ */
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // !_WIN32
+
+#include <dgl/runtime/container.h>
+#include <dgl/runtime/object.h>
+#include <dgl/zerocopy_serializer.h>
+#include <dmlc/io.h>
+#include <dmlc/memory_io.h>
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "./graph_serialize.h"
+#include "./streamwithcount.h"
+
+namespace dgl {
+namespace serialize {
+
+using namespace dgl::runtime;
+using dmlc::Stream;
+
+namespace {
+
+constexpr uint64_t kVersion = 3;
+constexpr uint64_t kPageSize = 4096;
+
+/*!
+ * \brief Serialize the object into the blob, and write the payloads of its
+ *        NDArrays into the file, each one at the start of a page.
+ */
+template <typename T>
+void WriteBlob(StreamWithCount* fs, const T& obj, std::string* blob,
+               std::vector<uint64_t>* array_pos) {
+  StreamWithBuffer strm(blob, true);
+  static_cast<Stream*>(&strm)->Write(obj);
+  std::array<char, kPageSize> zeros;
+  zeros.fill(0);
+  DLContext cpu_ctx;
+  cpu_ctx.device_type = kDLCPU;
+  cpu_ctx.device_id = 0;
+  for (const auto& buf : strm.buffer_list()) {
+    const uint64_t padding = (kPageSize - fs->Count() % kPageSize) % kPageSize;
+    fs->Write(zeros.data(), padding);
+    array_pos->push_back(fs->Count());
+    if (buf.tensor->ctx.device_type == kDLCPU) {
+      fs->Write(buf.data, buf.size);
+    } else {
+      const NDArray cpu_tensor = buf.tensor.CopyTo(cpu_ctx);
+      fs->Write(cpu_tensor->data, buf.size);
+    }
+  }
+}
+
+#ifndef _WIN32
+/*!
+ * \brief A file mapped copy-on-write into memory, unmapped on destruction.
+ *
+ * The pages are shared with the page cache until they are written to.
+ */
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string& filename) {
+    const int fd = open(filename.c_str(), O_RDONLY);
+    CHECK_NE(fd, -1) << "File " << filename << " not found";
+    struct stat st;
+    CHECK_NE(fstat(fd, &st), -1) << "Fail to stat file " << filename;
+    size_ = st.st_size;
+    CHECK_GT(size_, 0) << "Fail to map empty file " << filename;
+    void* data = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    CHECK_NE(data, MAP_FAILED) << "Fail to map file " << filename;
+    data_ = static_cast<char*>(data);
+  }
+
+  ~MappedFile() {
+    munmap(data_, size_);
+  }
+
+  char* data() const { return data_; }
+  uint64_t size() const { return size_; }
+
+ private:
+  char* data_ = nullptr;
+  uint64_t size_ = 0;
+};
+
+/*! \brief The index of a file mapped into memory. */
+struct MappedIndex {
+  std::shared_ptr<MappedFile> file;
+  uint64_t num_graph;
+  std::vector<uint64_t> array_pos;
+  std::vector<std::string> blobs;
+  std::vector<uint64_t> blob_arrays;
+
+  explicit MappedIndex(const std::string& filename)
+    : file(std::make_shared<MappedFile>(filename)) {
+    CHECK_GE(file->size(), kPageSize + sizeof(uint64_t)) << "Invalid DGL files";
+    uint64_t magicNum, graphType, version;
+    dmlc::MemoryFixedSizeStream meta_fs(file->data(), kPageSize);
+    meta_fs.Read(&magicNum);
+    meta_fs.Read(&version);
+    meta_fs.Read(&graphType);
+    CHECK(meta_fs.Read(&num_graph)) << "Invalid num of graph";
+    CHECK_EQ(magicNum, kDGLSerializeMagic) << "Invalid DGL files";
+    CHECK_EQ(version, kVersion) << "Invalid DGL Version Number";
+    CHECK_EQ(graphType, GraphType::kHeteroGraph) << "Invalid GraphType";
+
+    uint64_t index_pos;
+    const uint64_t index_end = file->size() - sizeof(uint64_t);
+    std::copy(file->data() + index_end, file->data() + file->size(),
+              reinterpret_cast<char*>(&index_pos));
+    CHECK(index_pos >= kPageSize && index_pos <= index_end) << "Invalid DGL files";
+    dmlc::MemoryFixedSizeStream index_fs(file->data() + index_pos, index_end - index_pos);
+    CHECK(index_fs.Read(&array_pos)) << "Invalid DGL files";
+    CHECK(index_fs.Read(&blobs)) << "Invalid DGL files";
+    CHECK(index_fs.Read(&blob_arrays)) << "Invalid DGL files";
+    CHECK_EQ(blobs.size(), num_graph + 1) << "Invalid DGL files";
+    CHECK_EQ(blob_arrays.size(), num_graph + 2) << "Invalid DGL files";
+    CHECK_EQ(blob_arrays.back(), array_pos.size()) << "Invalid DGL files";
+  }
+
+  /*! \brief Deserialize the object of the blob, pointing into the mapping. */
+  template <typename T>
+  void ReadBlob(uint64_t i, T* obj) {
+    std::vector<void*> data_ptr_list;
+    for (uint64_t j = blob_arrays[i]; j < blob_arrays[i + 1]; ++j)
+      data_ptr_list.push_back(file->data() + array_pos[j]);
+    StreamWithBuffer strm(&blobs[i], data_ptr_list, file);
+    CHECK(static_cast<Stream*>(&strm)->Read(obj)) << "Invalid DGL files";
+  }
+};
+#endif  // !_WIN32
+
+}  // namespace
+
+bool SaveHeteroGraphsMmap(std::string filename, List<HeteroGraphData> hdata,
+                          const std::vector<NamedTensor> &nd_list) {
+  auto fs = std::unique_ptr<StreamWithCount>(
+    StreamWithCount::Create(filename.c_str(), "w", false));
+  CHECK(fs->IsValid()) << "File name " << filename << " is not a valid name";
+
+  // Write metadata into char buffer with size 4096
+  std::array<char, kPageSize> meta_buffer;
+  meta_buffer.fill(0);
+  dmlc::MemoryFixedSizeStream meta_fs_(meta_buffer.data(), kPageSize);
+  auto meta_fs = static_cast<Stream *>(&meta_fs_);
+  meta_fs->Write(kDGLSerializeMagic);
+  meta_fs->Write(kVersion);
+  meta_fs->Write(GraphType::kHeteroGraph);
+  uint64_t num_graph = hdata.size();
+  meta_fs->Write(num_graph);
+  fs->Write(meta_buffer.data(), kPageSize);
+
+  std::vector<uint64_t> array_pos;
+  std::vector<std::string> blobs(num_graph + 1);
+  std::vector<uint64_t> blob_arrays;
+  blob_arrays.reserve(num_graph + 2);
+
+  blob_arrays.push_back(array_pos.size());
+  WriteBlob(fs.get(), nd_list, &blobs[0], &array_pos);
+  for (uint64_t i = 0; i < num_graph; ++i) {
+    blob_arrays.push_back(array_pos.size());
+    auto gdata = hdata[i].sptr();
+    WriteBlob(fs.get(), gdata, &blobs[i + 1], &array_pos);
+  }
+  blob_arrays.push_back(array_pos.size());
+
+  const uint64_t index_pos = fs->Count();
+  fs->Write(array_pos);
+  fs->Write(blobs);
+  fs->Write(blob_arrays);
+  fs->Write(index_pos);
+
+  return true;
+}
+
+std::vector<HeteroGraphData> LoadHeteroGraphsMmap(const std::string &filename,
+                                                  std::vector<dgl_id_t> idx_list) {
+#ifndef _WIN32
+  MappedIndex index(filename);
+  if (idx_list.empty()) {
+    idx_list.resize(index.num_graph);
+    std::iota(idx_list.begin(), idx_list.end(), 0);
+  }
+  // The returned graphs are in the order of idx_list
+  std::vector<HeteroGraphData> gdata_refs;
+  gdata_refs.reserve(idx_list.size());
+  for (const dgl_id_t gid : idx_list) {
+    CHECK((gid < index.num_graph) && (gid >= 0))
+      << "ID " << gid
+      << " in idx_list is out of bound. Please check your idx_list.";
+    HeteroGraphData gdata = HeteroGraphData::Create();
+    auto hetero_data = gdata.sptr();
+    index.ReadBlob(gid + 1, &hetero_data);
+    gdata_refs.push_back(gdata);
+  }
+  return gdata_refs;
+#else
+  LOG(FATAL) << "Memory mapped graph files are not supported on windows";
+  return {};
+#endif  // !_WIN32
+}
+
+std::vector<NamedTensor> LoadLabelsMmap(const std::string &filename) {
+  std::vector<NamedTensor> labels_list;
+#ifndef _WIN32
+  MappedIndex index(filename);
+  index.ReadBlob(0, &labels_list);
+#else
+  LOG(FATAL) << "Memory mapped graph files are not supported on windows";
+#endif  // !_WIN32
+  return labels_list;
+}
+
+DGL_REGISTER_GLOBAL("data.heterograph_serialize._CAPI_SaveHeteroGraphData_V3")
+  .set_body([](DGLArgs args, DGLRetValue *rv) {
+    std::string filename = args[0];
+    List<HeteroGraphData> hgdata = args[1];
+    Map<std::string, Value> nd_map = args[2];
+    std::vector<NamedTensor> nd_list;
+    for (auto kv : nd_map) {
+      NDArray ndarray = static_cast<NDArray>(kv.second->data);
+      nd_list.emplace_back(kv.first, ndarray);
+    }
+    *rv = SaveHeteroGraphsMmap(filename, hgdata, nd_list);
+  });
+
+DGL_REGISTER_GLOBAL("data.graph_serialize._CAPI_LoadGraphFiles_V3")
+  .set_body([](DGLArgs args, DGLRetValue *rv) {
+    std::string filename = args[0];
+    List<Value> idxs = args[1];
+    auto idx_list = ListValueToVector<dgl_id_t>(idxs);
+    *rv = List<HeteroGraphData>(LoadHeteroGraphsMmap(filename, idx_list));
+  });
+
+DGL_REGISTER_GLOBAL("data.graph_serialize._CAPI_LoadLabels_V3")
+  .set_body([](DGLArgs args, DGLRetValue *rv) {
+    std::string filename = args[0];
+    auto labels_list = LoadLabelsMmap(filename);
+    Map<std::string, Value> rvmap;
+    for (auto kv : labels_list) {
+      rvmap.Set(kv.first, Value(MakeValue(kv.second)));
+    }
+    *rv = rvmap;
+  });
+
+DGL_REGISTER_GLOBAL("data.graph_serialize._CAPI_MapArrayFromFile")
+  .set_body([](DGLArgs args, DGLRetValue *rv) {
+    std::string filename = args[0];
+    const int64_t offset = args[1];
+    DLDataType dtype = args[2];
+    std::vector<int64_t> shape;
+    int64_t size = dtype.bits / 8 * dtype.lanes;
+    for (int i = 3; i < args.size(); ++i) {
+      shape.push_back(args[i]);
+      size *= shape.back();
+    }
+#ifndef _WIN32
+    // the array keeps the mapping of the whole file alive
+    auto file = std::make_shared<MappedFile>(filename);
+    CHECK(offset >= 0 && offset + size <= static_cast<int64_t>(file->size()))
+      << "The array is out of the bounds of file " << filename;
+    CHECK_EQ(offset % (dtype.bits / 8), 0)
+      << "The array in file " << filename << " is not aligned to its data type";
+    DLContext cpu_ctx;
+    cpu_ctx.device_type = kDLCPU;
+    cpu_ctx.device_id = 0;
+    *rv = CreateNDArrayFromRawData(shape, dtype, cpu_ctx, file->data() + offset, file);
+#else
+    LOG(FATAL) << "Memory mapped arrays are not supported on windows";
+#endif  // !_WIN32
+  });
+
+}  // namespace serialize
+}  // namespace dgl
@@ -37,17 +37,20 @@
 #include <dgl/immutable_graph.h>
 #include <dgl/runtime/container.h>
 #include <dgl/runtime/object.h>
+#include <dgl/runtime/parallel_for.h>
 #include <dmlc/io.h>
 #include <dmlc/type_traits.h>
 
 #include <algorithm>
 #include <array>
 #include <iostream>
+#include <numeric>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "../heterograph.h"
+#include "./async_save.h"
 #include "./graph_serialize.h"
 #include "./streamwithcount.h"
 #include "dmlc/memory_io.h"
@@ -61,6 +64,71 @@ using dmlc::Stream;
 using dmlc::io::FileSystem;
 using dmlc::io::URI;
 
+namespace {
+
+/*! \brief The number of bytes below which the gap between two ranges is read through. */
+constexpr uint64_t kCoalesceGap = 1 << 16;
+
+/*!
+ * \brief Read the byte ranges [first, second) of the file, sorted by start.
+ *
+ * The ranges closer than kCoalesceGap are merged into a single read, and
+ * the merged reads are split among threads, each with its own stream.
+ *
+ * \return The contents of each range.
+ */
+std::vector<std::string> ReadRanges(
+    const std::string &filename, const std::vector<std::pair<uint64_t, uint64_t>> &ranges) {
+  std::vector<std::pair<uint64_t, uint64_t>> spans;
+  std::vector<size_t> span_first;
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    if (spans.empty() || ranges[i].first > spans.back().second + kCoalesceGap) {
+      spans.push_back(ranges[i]);
+      span_first.push_back(i);
+    } else {
+      spans.back().second = std::max(spans.back().second, ranges[i].second);
+    }
+  }
+  span_first.push_back(ranges.size());
+
+  std::vector<std::string> ret(ranges.size());
+  runtime::parallel_for(0, spans.size(), 1, [&](size_t b, size_t e) {
+    auto fs = std::unique_ptr<SeekStream>(
+      SeekStream::CreateForRead(filename.c_str(), false));
+    CHECK(fs) << "File name " << filename << " is not a valid name";
+    std::string buffer;
+    for (size_t s = b; s < e; ++s) {
+      buffer.resize(spans[s].second - spans[s].first);
+      fs->Seek(spans[s].first);
+      for (size_t pos = 0; pos < buffer.size();) {
+        const size_t nread = fs->Read(&buffer[pos], buffer.size() - pos);
+        CHECK_GT(nread, 0) << "Invalid DGL files";
+        pos += nread;
+      }
+      for (size_t i = span_first[s]; i < span_first[s + 1]; ++i) {
+        ret[i] = buffer.substr(ranges[i].first - spans[s].first,
+                               ranges[i].second - ranges[i].first);
+      }
+    }
+  });
+  return ret;
+}
+
+/*! \brief Copy the graph data for an asynchronous save, with the features staged. */
+HeteroGraphData StageHeteroGraphData(const HeteroGraphData &gdata) {
+  HeteroGraphData ret = HeteroGraphData::Create();
+  ret->gptr = std::dynamic_pointer_cast<HeteroGraph>(gdata->gptr->Snapshot());
+  for (const auto &tensors : gdata->node_tensors)
+    ret->node_tensors.push_back(StageTensors(tensors));
+  for (const auto &tensors : gdata->edge_tensors)
+    ret->edge_tensors.push_back(StageTensors(tensors));
+  ret->ntype_names = gdata->ntype_names;
+  ret->etype_names = gdata->etype_names;
+  return ret;
+}
+
+}  // namespace
+
 bool SaveHeteroGraphs(std::string filename, List<HeteroGraphData> hdata,
                       const std::vector<NamedTensor> &nd_list) {
   auto fs = std::unique_ptr<StreamWithCount>(
@@ -152,33 +220,56 @@ std::vector<HeteroGraphData> LoadHeteroGraphs(const std::string &filename,
       gdata_refs.push_back(gdata);
     }
   } else {
-    uint64_t gdata_start_pos = fs->Tell();
-    // Read Selected Graphss
-    gdata_refs.reserve(idx_list.size());
+    // Read Selected Graphs
     URI uri(filename.c_str());
     uint64_t filesize = FileSystem::GetInstance(uri)->GetPathInfo(uri).size;
     fs->Seek(filesize - sizeof(uint64_t));
     uint64_t indptr_buffer_size;
     fs->Read(&indptr_buffer_size);
 
-    std::vector<uint64_t> graph_indices(num_graph);
-    fs->Seek(filesize - sizeof(uint64_t) - indptr_buffer_size);
-    fs->Read(&graph_indices);
-
-    fs->Seek(gdata_start_pos);
-    // Would be better if idx_list is sorted. However the returned the graphs
-    // should be the same order as the idx_list
-    for (uint64_t i = 0; i < idx_list.size(); ++i) {
-      auto gid = idx_list[i];
-      CHECK((gid < graph_indices.size()) && (gid >= 0))
+    // graph_indices is stored as its length followed by the start position of
+    // each graph, so only the entries of the selected graphs are read.
+    // The last graph ends where graph_indices starts.
+    const uint64_t indices_pos = filesize - sizeof(uint64_t) - indptr_buffer_size;
+    const uint64_t entries_pos = indices_pos + sizeof(uint64_t);
+    const uint64_t entries_end = filesize - sizeof(uint64_t);
+
+    // The graphs are read in the order of the file, but returned in the
+    // order of idx_list
+    std::vector<size_t> order(idx_list.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&idx_list](size_t i, size_t j) {
+      return idx_list[i] < idx_list[j];
+    });
+    std::vector<std::pair<uint64_t, uint64_t>> ranges(order.size());
+    for (size_t k = 0; k < order.size(); ++k) {
+      const dgl_id_t gid = idx_list[order[k]];
+      CHECK((gid < num_graph) && (gid >= 0))
         << "ID " << gid
         << " in idx_list is out of bound. Please check your idx_list.";
-      fs->Seek(graph_indices[gid]);
-      HeteroGraphData gdata = HeteroGraphData::Create();
-      auto hetero_data = gdata.sptr();
-      fs->Read(&hetero_data);
-      gdata_refs.push_back(gdata);
+      const uint64_t entry = entries_pos + gid * sizeof(uint64_t);
+      ranges[k] = {entry, std::min(entry + 2 * sizeof(uint64_t), entries_end)};
+    }
+    const std::vector<std::string> entries = ReadRanges(filename, ranges);
+    for (size_t k = 0; k < order.size(); ++k) {
+      uint64_t pos[2] = {0, indices_pos};
+      std::copy(entries[k].begin(), entries[k].end(), reinterpret_cast<char *>(pos));
+      ranges[k] = {pos[0], pos[1]};
     }
+    const std::vector<std::string> blobs = ReadRanges(filename, ranges);
+
+    gdata_refs.resize(idx_list.size());
+    runtime::parallel_for(0, order.size(), 1, [&](size_t b, size_t e) {
+      for (size_t k = b; k < e; ++k) {
+        dmlc::MemoryFixedSizeStream gdata_fs_(
+          const_cast<char *>(blobs[k].data()), blobs[k].size());
+        auto gdata_fs = static_cast<Stream *>(&gdata_fs_);
+        HeteroGraphData gdata = HeteroGraphData::Create();
+        auto hetero_data = gdata.sptr();
+        CHECK(gdata_fs->Read(&hetero_data)) << "Invalid DGL files";
+        gdata_refs[order[k]] = gdata;
+      }
+    });
   }
 
   return gdata_refs;
@@ -229,6 +320,29 @@ DGL_REGISTER_GLOBAL("data.heterograph_serialize._CAPI_SaveHeteroGraphData")
     *rv = dgl::serialize::SaveHeteroGraphs(filename, hgdata, nd_list);
   });
 
+DGL_REGISTER_GLOBAL("data.heterograph_serialize._CAPI_SaveHeteroGraphDataAsync")
+  .set_body([](DGLArgs args, DGLRetValue *rv) {
+    std::string filename = args[0];
+    List<HeteroGraphData> hgdata = args[1];
+    Map<std::string, Value> nd_map = args[2];
+    bool mmap_layout = args[3];
+    std::vector<NamedTensor> nd_list;
+    for (auto kv : nd_map) {
+      NDArray ndarray = static_cast<NDArray>(kv.second->data);
+      nd_list.emplace_back(kv.first, ndarray);
+    }
+    List<HeteroGraphData> staged;
+    for (const auto &gdata : hgdata)
+      staged.push_back(StageHeteroGraphData(gdata));
+    nd_list = StageTensors(nd_list);
+    *rv = SubmitAsyncSave([filename, staged, nd_list, mmap_layout]() {
+      if (mmap_layout)
+        SaveHeteroGraphsMmap(filename, staged, nd_list);
+      else
+        SaveHeteroGraphs(filename, staged, nd_list);
+    });
+  });
+
 DGL_REGISTER_GLOBAL(
   "data.heterograph_serialize._CAPI_GetGindexFromHeteroGraphData")
   .set_body([](DGLArgs args, DGLRetValue *rv) {
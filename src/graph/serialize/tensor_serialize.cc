@@ -2,14 +2,44 @@
  *  Copyright (c) 2019 by Contributors
  * \file graph/serialize/tensor_serialize.cc
  * \brief Graph serialization implementation
+ *
+ * The tensors are saved in chunks, whose storage structure is
+ * {
+ *   uint64_t kDGLSerialize_ChunkedTensors
+ *   uint64_t header_size
+ *   ChunkedTensorHeader header
+ *   ** Padding till a multiple of 4kB **
+ *
+ *   // The payload of each tensor, at header.offsets from here, which are
+ *   // multiples of 4kB
+ *   vector<char> payloads
+ * }
+ *
+ * The payloads are written and read by chunks of kTensorChunkSize bytes in
+ * parallel. Files saved in the former format, a vector<NamedTensor> after
+ * kDGLSerialize_Tensors and the number of tensors, are still loaded.
  */
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif  // !_WIN32
+
 #include <dgl/packed_func_ext.h>
 #include <dgl/runtime/container.h>
 #include <dgl/runtime/ndarray.h>
 #include <dgl/runtime/object.h>
+#include <dgl/runtime/parallel_for.h>
 #include <dmlc/io.h>
+#include <dmlc/memory_io.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "../../c_api_common.h"
+#include "./async_save.h"
 
 using namespace dgl::runtime;
 using dmlc::SeekStream;
@@ -20,29 +50,221 @@ namespace serialize {
 typedef std::pair<std::string, NDArray> NamedTensor;
 
 constexpr uint64_t kDGLSerialize_Tensors = 0xDD5A9FBE3FA2443F;
+constexpr uint64_t kDGLSerialize_ChunkedTensors = 0xDD5A9FBE3FA2444F;
+
+/*! \brief The alignment of the payloads in the file, suitable for direct I/O. */
+constexpr uint64_t kTensorAlignment = 4096;
+/*! \brief The number of bytes of the payloads read or written by one task. */
+constexpr uint64_t kTensorChunkSize = 64ull << 20;
+
+namespace {
+
+inline uint64_t AlignUp(uint64_t pos) {
+  return (pos + kTensorAlignment - 1) / kTensorAlignment * kTensorAlignment;
+}
+
+/*! \brief The description of the tensors of a chunked tensor file. */
+struct ChunkedTensorHeader {
+  std::vector<std::string> names;
+  std::vector<DLDataType> dtypes;
+  std::vector<std::vector<int64_t>> shapes;
+  // the offsets of the payloads from the end of the header padding
+  std::vector<uint64_t> offsets;
+  std::vector<uint64_t> sizes;
+
+  void Save(dmlc::Stream *fs) const {
+    fs->Write(names);
+    fs->Write(dtypes);
+    fs->Write(shapes);
+    fs->Write(offsets);
+    fs->Write(sizes);
+  }
+
+  bool Load(dmlc::Stream *fs) {
+    return fs->Read(&names) && fs->Read(&dtypes) && fs->Read(&shapes) &&
+      fs->Read(&offsets) && fs->Read(&sizes);
+  }
+
+  /*! \brief Return the (tensor, chunk) pairs of all the payloads. */
+  std::vector<std::pair<size_t, uint64_t>> Chunks() const {
+    std::vector<std::pair<size_t, uint64_t>> chunks;
+    for (size_t i = 0; i < sizes.size(); ++i) {
+      for (uint64_t c = 0; c * kTensorChunkSize < sizes[i]; ++c)
+        chunks.emplace_back(i, c);
+    }
+    return chunks;
+  }
+
+  /*! \brief Return the byte range of the chunk within its tensor. */
+  std::pair<uint64_t, uint64_t> ChunkRange(const std::pair<size_t, uint64_t> &chunk) const {
+    const uint64_t begin = chunk.second * kTensorChunkSize;
+    return {begin, std::min(begin + kTensorChunkSize, sizes[chunk.first])};
+  }
+};
+
+inline bool IsLocalFile(const std::string &filename) {
+  return filename.find("://") == std::string::npos;
+}
+
+#ifndef _WIN32
+void PWriteAll(int fd, const char *data, uint64_t size, uint64_t pos) {
+  while (size > 0) {
+    const ssize_t written = pwrite(fd, data, size, pos);
+    CHECK_GT(written, 0) << "Fail to write the tensor file";
+    data += written;
+    size -= written;
+    pos += written;
+  }
+}
+#endif  // !_WIN32
+
+void SaveChunkedTensors(const std::string &filename, const std::vector<NamedTensor> &tensors) {
+  std::vector<NDArray> arrays;
+  ChunkedTensorHeader header;
+  uint64_t offset = 0;
+  for (const auto &kv : tensors) {
+    NDArray array = kv.second;
+    CHECK(array.IsContiguous()) << "Only contiguous tensors can be saved";
+    if (array->ctx.device_type != kDLCPU)
+      array = array.CopyTo(DLContext{kDLCPU, 0});
+    int64_t num_elems = 1;
+    for (int i = 0; i < array->ndim; ++i)
+      num_elems *= array->shape[i];
+    const uint64_t size = num_elems * ((array->dtype.bits * array->dtype.lanes + 7) / 8);
+    header.names.push_back(kv.first);
+    header.dtypes.push_back(array->dtype);
+    header.shapes.emplace_back(array->shape, array->shape + array->ndim);
+    header.offsets.push_back(offset);
+    header.sizes.push_back(size);
+    offset = AlignUp(offset + size);
+    arrays.push_back(array);
+  }
+
+  std::string prefix;
+  {
+    std::string header_blob;
+    dmlc::MemoryStringStream header_fs(&header_blob);
+    header.Save(&header_fs);
+    dmlc::MemoryStringStream prefix_fs(&prefix);
+    static_cast<dmlc::Stream *>(&prefix_fs)->Write(kDGLSerialize_ChunkedTensors);
+    static_cast<dmlc::Stream *>(&prefix_fs)->Write(static_cast<uint64_t>(header_blob.size()));
+    prefix += header_blob;
+    prefix.resize(AlignUp(prefix.size()), '\0');
+  }
+  const uint64_t data_pos = prefix.size();
+  const auto chunks = header.Chunks();
+  auto chunk_data = [&](const std::pair<size_t, uint64_t> &chunk) {
+    const NDArray &array = arrays[chunk.first];
+    return static_cast<const char *>(array->data) + array->byte_offset +
+      header.ChunkRange(chunk).first;
+  };
+
+#ifndef _WIN32
+  if (IsLocalFile(filename)) {
+    // every chunk is written at its final position by one of the threads
+    const int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    CHECK_NE(fd, -1) << "Filename is invalid";
+    PWriteAll(fd, prefix.data(), prefix.size(), 0);
+    runtime::parallel_for(0, chunks.size(), 1, [&](size_t b, size_t e) {
+      for (size_t i = b; i < e; ++i) {
+        const auto range = header.ChunkRange(chunks[i]);
+        PWriteAll(fd, chunk_data(chunks[i]), range.second - range.first,
+                  data_pos + header.offsets[chunks[i].first] + range.first);
+      }
+    });
+    CHECK_EQ(close(fd), 0) << "Fail to write the tensor file";
+    return;
+  }
+#endif  // !_WIN32
+
+  auto fs = std::unique_ptr<dmlc::Stream>(
+    dmlc::Stream::Create(filename.c_str(), "w"));
+  CHECK(fs) << "Filename is invalid";
+  fs->Write(prefix.data(), prefix.size());
+  const std::string padding(kTensorAlignment, '\0');
+  uint64_t pos = 0;
+  for (size_t i = 0; i < arrays.size(); ++i) {
+    fs->Write(padding.data(), header.offsets[i] - pos);
+    const char *data = static_cast<const char *>(arrays[i]->data) + arrays[i]->byte_offset;
+    fs->Write(data, header.sizes[i]);
+    pos = header.offsets[i] + header.sizes[i];
+  }
+}
+
+/*! \brief Load the tensors of a chunked tensor file, after its magic number. */
+std::vector<NamedTensor> LoadChunkedTensors(const std::string &filename, dmlc::Stream *fs) {
+  uint64_t header_size;
+  CHECK(fs->Read(&header_size)) << "Invalid DGL tensor file";
+  std::string header_blob(header_size, '\0');
+  CHECK_EQ(fs->Read(&header_blob[0], header_size), header_size) << "Invalid DGL tensor file";
+  dmlc::MemoryStringStream header_fs(&header_blob);
+  ChunkedTensorHeader header;
+  CHECK(header.Load(&header_fs)) << "Invalid DGL tensor file";
+  const uint64_t data_pos = AlignUp(2 * sizeof(uint64_t) + header_size);
+
+  std::vector<NamedTensor> tensors;
+  for (size_t i = 0; i < header.names.size(); ++i) {
+    tensors.emplace_back(header.names[i], NDArray::Empty(
+      header.shapes[i], header.dtypes[i], DLContext{kDLCPU, 0}));
+  }
+
+  // every thread reads its chunks through its own stream
+  const auto chunks = header.Chunks();
+  runtime::parallel_for(0, chunks.size(), 1, [&](size_t b, size_t e) {
+    auto chunk_fs = std::unique_ptr<SeekStream>(
+      SeekStream::CreateForRead(filename.c_str()));
+    CHECK(chunk_fs) << "Filename is invalid or file doesn't exists";
+    for (size_t i = b; i < e; ++i) {
+      const auto range = header.ChunkRange(chunks[i]);
+      char *data = static_cast<char *>(tensors[chunks[i].first].second->data) + range.first;
+      chunk_fs->Seek(data_pos + header.offsets[chunks[i].first] + range.first);
+      for (uint64_t size = range.second - range.first; size > 0;) {
+        const size_t nread = chunk_fs->Read(data, size);
+        CHECK_GT(nread, 0) << "Invalid DGL tensor file";
+        data += nread;
+        size -= nread;
+      }
+    }
+  });
+  return tensors;
+}
+
+}  // namespace
 
 DGL_REGISTER_GLOBAL("data.tensor_serialize._CAPI_SaveNDArrayDict")
   .set_body([](DGLArgs args, DGLRetValue *rv) {
     std::string filename = args[0];
-    auto fs = std::unique_ptr<dmlc::Stream>(
-      dmlc::Stream::Create(filename.c_str(), "w"));
-    CHECK(fs) << "Filename is invalid";
-    fs->Write(kDGLSerialize_Tensors);
     bool empty_dict = args[2];
     Map<std::string, Value> nd_dict;
     if (!empty_dict) {
       nd_dict = args[1];
     }
     std::vector<NamedTensor> namedTensors;
-    fs->Write(static_cast<uint64_t>(nd_dict.size()));
     for (auto kv : nd_dict) {
       NDArray ndarray = static_cast<NDArray>(kv.second->data);
       namedTensors.emplace_back(kv.first, ndarray);
     }
-    fs->Write(namedTensors);
+    SaveChunkedTensors(filename, namedTensors);
     *rv = true;
   });
 
+DGL_REGISTER_GLOBAL("data.tensor_serialize._CAPI_SaveNDArrayDictAsync")
+  .set_body([](DGLArgs args, DGLRetValue *rv) {
+    std::string filename = args[0];
+    bool empty_dict = args[2];
+    Map<std::string, Value> nd_dict;
+    if (!empty_dict) {
+      nd_dict = args[1];
+    }
+    std::vector<NamedTensor> namedTensors;
+    for (auto kv : nd_dict) {
+      NDArray ndarray = static_cast<NDArray>(kv.second->data);
+      namedTensors.emplace_back(kv.first, ndarray);
+    }
+    const std::vector<NamedTensor> staged = StageTensors(namedTensors);
+    *rv = SubmitAsyncSave([filename, staged]() { SaveChunkedTensors(filename, staged); });
+  });
+
 DGL_REGISTER_GLOBAL("data.tensor_serialize._CAPI_LoadNDArrayDict")
   .set_body([](DGLArgs args, DGLRetValue *rv) {
     std::string filename = args[0];
@@ -51,11 +273,15 @@ DGL_REGISTER_GLOBAL("data.tensor_serialize._CAPI_LoadNDArrayDict")
     CHECK(fs) << "Filename is invalid or file doesn't exists";
     uint64_t magincNum, num_elements;
     CHECK(fs->Read(&magincNum)) << "Invalid file";
-    CHECK_EQ(magincNum, kDGLSerialize_Tensors) << "Invalid DGL tensor file";
-    CHECK(fs->Read(&num_elements)) << "Invalid num of elements";
-    Map<std::string, Value> nd_dict;
     std::vector<NamedTensor> namedTensors;
-    fs->Read(&namedTensors);
+    if (magincNum == kDGLSerialize_ChunkedTensors) {
+      namedTensors = LoadChunkedTensors(filename, fs.get());
+    } else {
+      CHECK_EQ(magincNum, kDGLSerialize_Tensors) << "Invalid DGL tensor file";
+      CHECK(fs->Read(&num_elements)) << "Invalid num of elements";
+      fs->Read(&namedTensors);
+    }
+    Map<std::string, Value> nd_dict;
     for (auto kv : namedTensors) {
       Value ndarray = Value(MakeValue(kv.second));
       nd_dict.Set(kv.first, ndarray);
@@ -17,19 +17,24 @@ struct RawDataTensorCtx {
   std::vector<int64_t> shape;
   std::vector<int64_t> stride;
   DLManagedTensor tensor;
+  // the owner of the data, which is freed with the tensor if null
+  std::shared_ptr<void> owner;
 };
 
 void RawDataTensoDLPackDeleter(DLManagedTensor* tensor) {
   auto ctx = static_cast<RawDataTensorCtx*>(tensor->manager_ctx);
-  delete[] ctx->tensor.dl_tensor.data;
+  if (!ctx->owner)
+    delete[] ctx->tensor.dl_tensor.data;
   delete ctx;
 }
 
 NDArray CreateNDArrayFromRawData(std::vector<int64_t> shape, DLDataType dtype,
-                                 DLContext ctx, void* raw) {
+                                 DLContext ctx, void* raw,
+                                 std::shared_ptr<void> owner) {
   auto dlm_tensor_ctx = new RawDataTensorCtx();
   DLManagedTensor* dlm_tensor = &dlm_tensor_ctx->tensor;
   dlm_tensor_ctx->shape = shape;
+  dlm_tensor_ctx->owner = std::move(owner);
   dlm_tensor->manager_ctx = dlm_tensor_ctx;
   dlm_tensor->dl_tensor.shape = dmlc::BeginPtr(dlm_tensor_ctx->shape);
   dlm_tensor->dl_tensor.ctx = ctx;
@@ -115,12 +120,19 @@ NDArray StreamWithBuffer::PopNDArray() {
     CHECK(send_to_remote_) << "Invalid attempt to deserialize from raw data "
                               "pointer with send_to_remote=false";
     NDArray ret;
-    if (ndim == 0 || shape[0] == 0) {
-      // Mean this is a null ndarray
+    int64_t num_elems = 1;
+    for (int i = 0; i < ndim; ++i) {
+      num_elems *= shape[i];
+    }
+    if (num_elems == 0) {
+      // Mean this is a null ndarray, whose data was not pushed
       ret = CreateNDArrayFromRawData(shape, dtype, cpu_ctx, nullptr);
+    } else if (buffer_list_.front().tensor.defined()) {
+      ret = buffer_list_.front().tensor.CreateView(shape, dtype, 0);
+      buffer_list_.pop_front();
     } else {
       ret = CreateNDArrayFromRawData(shape, dtype, cpu_ctx,
-                                     buffer_list_.front().data);
+                                     buffer_list_.front().data, data_owner_);
       buffer_list_.pop_front();
     }
     return ret;
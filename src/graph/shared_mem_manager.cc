@@ -1,131 +1,226 @@
 /*!
  *  Copyright (c) 2018 by Contributors
  * \file graph/shared_mem_manager.cc
- * \brief DGL sampler implementation
+ * \brief DGL shared mem manager implementation
  */
 #include "shared_mem_manager.h"
 
 #include <dgl/array.h>
-#include <dgl/base_heterograph.h>
-#include <dgl/immutable_graph.h>
-#include <dgl/packed_func_ext.h>
-#include <dgl/random.h>
-#include <dgl/runtime/container.h>
-#include <dgl/sampler.h>
-#include <dmlc/io.h>
-#include <dmlc/memory_io.h>
 
 #include <algorithm>
-#include <array>
-#include <cmath>
-#include <cstdlib>
-#include <numeric>
+#include <atomic>
+#include <new>
 #include <vector>
 
-#include "../c_api_common.h"
-#include "heterograph.h"
-
 using namespace dgl::runtime;
 using namespace dgl::aten;
 
 namespace dgl {
 
-template <>
-NDArray SharedMemManager::CopyToSharedMem<NDArray>(const NDArray &data,
-                                                   std::string name) {
-  DLContext ctx = {kDLCPU, 0};
-  std::vector<int64_t> shape(data->shape, data->shape + data->ndim);
-  strm_->Write(data->ndim);
-  strm_->Write(data->dtype);
-  int ndim = data->ndim;
-  strm_->WriteArray(data->shape, ndim);
-
-  bool is_null = IsNullArray(data);
-  strm_->Write(is_null);
-  if (is_null) {
-    return data;
-  } else {
-    auto nd =
-      NDArray::EmptyShared(graph_name_ + name, shape, data->dtype, ctx, true);
-    nd.CopyFrom(data);
-    return nd;
-  }
+namespace {
+
+constexpr uint64_t kSharedGraphMagic = 0xD6A3F1C25E704B19;
+constexpr uint64_t kArrayAlignment = 64;
+
+/*! \brief The states of a slot, changed atomically. */
+constexpr uint64_t kSlotEmpty = 0;
+constexpr uint64_t kSlotWriting = 1;
+constexpr uint64_t kSlotReady = 2;
+
+struct SharedGraphHeader {
+  uint64_t magic;
+  uint64_t size;
+  uint64_t bits;
+  uint64_t num_etypes;
+  uint64_t meta_offset;
+  uint64_t meta_size;
+};
+
+/*!
+ * \brief A sparse matrix of an edge type, whose three arrays (row, col and
+ *        data, or indptr, indices and data) have a fixed place in the segment.
+ *
+ * The state is shared by the processes, and only the one moving it from empty
+ * to writing copies the matrix in.
+ */
+struct SharedFormatSlot {
+  std::atomic<uint64_t> state;
+  uint64_t offset[3];
+  int64_t capacity[3];
+  int64_t length[3];
+  int64_t num_rows;
+  int64_t num_cols;
+  uint8_t sorted[2];
+};
+
+uint64_t Align(uint64_t pos) {
+  return (pos + kArrayAlignment - 1) / kArrayAlignment * kArrayAlignment;
+}
+
+SharedGraphHeader* GetHeader(const NDArray& segment) {
+  return static_cast<SharedGraphHeader*>(segment->data);
 }
 
-template <>
-CSRMatrix SharedMemManager::CopyToSharedMem<CSRMatrix>(const CSRMatrix &csr,
-                                                       std::string name) {
-  auto indptr_shared_mem = CopyToSharedMem(csr.indptr, name + "_indptr");
-  auto indices_shared_mem = CopyToSharedMem(csr.indices, name + "_indices");
-  auto data_shared_mem = CopyToSharedMem(csr.data, name + "_data");
-  strm_->Write(csr.num_rows);
-  strm_->Write(csr.num_cols);
-  strm_->Write(csr.sorted);
-  return CSRMatrix(csr.num_rows, csr.num_cols, indptr_shared_mem,
-                   indices_shared_mem, data_shared_mem, csr.sorted);
+SharedFormatSlot* GetSlots(const NDArray& segment) {
+  return reinterpret_cast<SharedFormatSlot*>(
+      static_cast<char*>(segment->data) + sizeof(SharedGraphHeader));
 }
 
-template <>
-COOMatrix SharedMemManager::CopyToSharedMem<COOMatrix>(const COOMatrix &coo,
-                                                       std::string name) {
-  auto row_shared_mem = CopyToSharedMem(coo.row, name + "_row");
-  auto col_shared_mem = CopyToSharedMem(coo.col, name + "_col");
-  auto data_shared_mem = CopyToSharedMem(coo.data, name + "_data");
-  strm_->Write(coo.num_rows);
-  strm_->Write(coo.num_cols);
-  strm_->Write(coo.row_sorted);
-  strm_->Write(coo.col_sorted);
-  return COOMatrix(coo.num_rows, coo.num_cols, row_shared_mem, col_shared_mem,
-                   data_shared_mem, coo.row_sorted, coo.col_sorted);
+uint64_t SlotIndex(dgl_type_t etype, SparseFormat fmt) {
+  return etype * 3 + static_cast<int>(fmt) - 1;
 }
 
-template <>
-bool SharedMemManager::CreateFromSharedMem<NDArray>(NDArray *nd,
-                                                    std::string name) {
-  int ndim;
-  DLContext ctx = {kDLCPU, 0};
-  DLDataType dtype;
+}  // namespace
 
-  CHECK(this->Read(&ndim)) << "Invalid DLTensor file format";
-  CHECK(this->Read(&dtype)) << "Invalid DLTensor file format";
+SharedMemManager::SharedMemManager(const std::string& name, uint8_t bits,
+                                   const std::string& meta,
+                                   const std::vector<RelationSize>& sizes)
+  : name_(name) {
+  const uint64_t num_slots = sizes.size() * 3;
+  const uint64_t meta_offset =
+    sizeof(SharedGraphHeader) + num_slots * sizeof(SharedFormatSlot);
+  uint64_t pos = Align(meta_offset + meta.size());
+  std::vector<std::array<int64_t, 3>> capacities(num_slots);
+  std::vector<std::array<uint64_t, 3>> offsets(num_slots);
+  for (uint64_t etype = 0; etype < sizes.size(); ++etype) {
+    const int64_t num_edges = sizes[etype][2];
+    capacities[SlotIndex(etype, SparseFormat::kCOO)] = {num_edges, num_edges, num_edges};
+    capacities[SlotIndex(etype, SparseFormat::kCSR)] = {sizes[etype][0] + 1, num_edges, num_edges};
+    capacities[SlotIndex(etype, SparseFormat::kCSC)] = {sizes[etype][1] + 1, num_edges, num_edges};
+  }
+  for (uint64_t slot = 0; slot < num_slots; ++slot) {
+    for (int i = 0; i < 3; ++i) {
+      offsets[slot][i] = pos;
+      pos = Align(pos + capacities[slot][i] * bits / 8);
+    }
+  }
 
-  std::vector<int64_t> shape(ndim);
-  if (ndim != 0) {
-    CHECK(this->ReadArray(&shape[0], ndim)) << "Invalid DLTensor file format";
+  const DLContext cpu_ctx{kDLCPU, 0};
+  segment_ = NDArray::EmptyShared(name, {static_cast<int64_t>(pos)},
+                                  DLDataType{kDLUInt, 8, 1}, cpu_ctx, true);
+  SharedGraphHeader* header = GetHeader(segment_);
+  header->magic = kSharedGraphMagic;
+  header->size = pos;
+  header->bits = bits;
+  header->num_etypes = sizes.size();
+  header->meta_offset = meta_offset;
+  header->meta_size = meta.size();
+  SharedFormatSlot* slots = GetSlots(segment_);
+  for (uint64_t slot = 0; slot < num_slots; ++slot) {
+    SharedFormatSlot* s = new (&slots[slot]) SharedFormatSlot();
+    s->state.store(kSlotEmpty);
+    std::copy(offsets[slot].begin(), offsets[slot].end(), s->offset);
+    std::copy(capacities[slot].begin(), capacities[slot].end(), s->capacity);
   }
-  bool is_null;
-  this->Read(&is_null);
-  if (is_null) {
-    *nd = NDArray::Empty(shape, dtype, ctx);
-  } else {
-    *nd =
-      NDArray::EmptyShared(graph_name_ + name, shape, dtype, ctx, false);
+  std::copy(meta.begin(), meta.end(), static_cast<char*>(segment_->data) + meta_offset);
+}
+
+SharedMemManager::SharedMemManager(const std::string& name) : name_(name) {
+  uint64_t size;
+  {
+    SharedMemory header_mem(name);
+    const SharedGraphHeader* header =
+      static_cast<const SharedGraphHeader*>(header_mem.Open(sizeof(SharedGraphHeader)));
+    CHECK_EQ(header->magic, kSharedGraphMagic)
+      << "The shared memory " << name << " does not hold a graph";
+    size = header->size;
   }
+  const DLContext cpu_ctx{kDLCPU, 0};
+  segment_ = NDArray::EmptyShared(name, {static_cast<int64_t>(size)},
+                                  DLDataType{kDLUInt, 8, 1}, cpu_ctx, false);
+}
+
+std::string SharedMemManager::meta() const {
+  const SharedGraphHeader* header = GetHeader(segment_);
+  return std::string(static_cast<char*>(segment_->data) + header->meta_offset,
+                     header->meta_size);
+}
+
+uint8_t SharedMemManager::NumBits() const {
+  return GetHeader(segment_)->bits;
+}
+
+uint64_t SharedMemManager::NumEdgeTypes() const {
+  return GetHeader(segment_)->num_etypes;
+}
+
+bool SharedMemManager::PublishSlot(uint64_t slot, const std::array<NDArray, 3>& arrays,
+                                   int64_t num_rows, int64_t num_cols,
+                                   bool sorted0, bool sorted1) {
+  CHECK_LT(slot, NumEdgeTypes() * 3) << "Invalid edge type";
+  SharedFormatSlot* s = &GetSlots(segment_)[slot];
+  uint64_t expected = kSlotEmpty;
+  if (!s->state.compare_exchange_strong(expected, kSlotWriting))
+    return false;
+  const uint8_t bits = NumBits();
+  const DLDataType dtype{kDLInt, bits, 1};
+  for (int i = 0; i < 3; ++i) {
+    const NDArray& arr = arrays[i];
+    const int64_t len = IsNullArray(arr) ? 0 : arr->shape[0];
+    CHECK_LE(len, s->capacity[i]) << "The matrix does not fit the shared memory";
+    if (len > 0) {
+      CHECK_EQ(arr->dtype.bits, bits) << "The matrix has a different ID type";
+      segment_.CreateView({len}, dtype, s->offset[i]).CopyFrom(arr);
+    }
+    s->length[i] = len;
+  }
+  s->num_rows = num_rows;
+  s->num_cols = num_cols;
+  s->sorted[0] = sorted0;
+  s->sorted[1] = sorted1;
+  s->state.store(kSlotReady, std::memory_order_release);
   return true;
 }
 
-template <>
-bool SharedMemManager::CreateFromSharedMem<COOMatrix>(COOMatrix *coo,
-                                                      std::string name) {
-  CreateFromSharedMem(&coo->row, name + "_row");
-  CreateFromSharedMem(&coo->col, name + "_col");
-  CreateFromSharedMem(&coo->data, name + "_data");
-  strm_->Read(&coo->num_rows);
-  strm_->Read(&coo->num_cols);
-  strm_->Read(&coo->row_sorted);
-  strm_->Read(&coo->col_sorted);
+bool SharedMemManager::GetSlot(uint64_t slot, std::array<NDArray, 3>* arrays,
+                               int64_t* num_rows, int64_t* num_cols,
+                               bool* sorted0, bool* sorted1) const {
+  CHECK_LT(slot, NumEdgeTypes() * 3) << "Invalid edge type";
+  const SharedFormatSlot* s = &GetSlots(segment_)[slot];
+  if (s->state.load(std::memory_order_acquire) != kSlotReady)
+    return false;
+  const DLDataType dtype{kDLInt, NumBits(), 1};
+  NDArray segment = segment_;
+  for (int i = 0; i < 3; ++i)
+    (*arrays)[i] = segment.CreateView({s->length[i]}, dtype, s->offset[i]);
+  *num_rows = s->num_rows;
+  *num_cols = s->num_cols;
+  *sorted0 = s->sorted[0];
+  *sorted1 = s->sorted[1];
+  return true;
+}
+
+bool SharedMemManager::Publish(dgl_type_t etype, const COOMatrix& coo) {
+  return PublishSlot(SlotIndex(etype, SparseFormat::kCOO), {coo.row, coo.col, coo.data},
+                     coo.num_rows, coo.num_cols, coo.row_sorted, coo.col_sorted);
+}
+
+bool SharedMemManager::Publish(dgl_type_t etype, const CSRMatrix& csr, bool transposed) {
+  return PublishSlot(
+      SlotIndex(etype, transposed ? SparseFormat::kCSC : SparseFormat::kCSR),
+      {csr.indptr, csr.indices, csr.data}, csr.num_rows, csr.num_cols, csr.sorted, false);
+}
+
+bool SharedMemManager::Get(dgl_type_t etype, COOMatrix* coo) const {
+  std::array<NDArray, 3> arrays;
+  if (!GetSlot(SlotIndex(etype, SparseFormat::kCOO), &arrays, &coo->num_rows,
+               &coo->num_cols, &coo->row_sorted, &coo->col_sorted))
+    return false;
+  coo->row = arrays[0];
+  coo->col = arrays[1];
+  coo->data = arrays[2];
   return true;
 }
 
-template <>
-bool SharedMemManager::CreateFromSharedMem<CSRMatrix>(CSRMatrix *csr,
-                                                      std::string name) {
-  CreateFromSharedMem(&csr->indptr, name + "_indptr");
-  CreateFromSharedMem(&csr->indices, name + "_indices");
-  CreateFromSharedMem(&csr->data, name + "_data");
-  strm_->Read(&csr->num_rows);
-  strm_->Read(&csr->num_cols);
-  strm_->Read(&csr->sorted);
+bool SharedMemManager::Get(dgl_type_t etype, bool transposed, CSRMatrix* csr) const {
+  std::array<NDArray, 3> arrays;
+  bool unused;
+  if (!GetSlot(SlotIndex(etype, transposed ? SparseFormat::kCSC : SparseFormat::kCSR),
+               &arrays, &csr->num_rows, &csr->num_cols, &csr->sorted, &unused))
+    return false;
+  csr->indptr = arrays[0];
+  csr->indices = arrays[1];
+  csr->data = arrays[2];
   return true;
 }
 
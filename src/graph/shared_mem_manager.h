@@ -1,6 +1,6 @@
 /*!
  *  Copyright (c) 2018 by Contributors
- * \file graph/shared_mem_manager.cc
+ * \file graph/shared_mem_manager.h
  * \brief DGL shared mem manager APIs
  */
 
@@ -8,46 +8,104 @@
 #define DGL_GRAPH_SHARED_MEM_MANAGER_H_
 
 #include <dgl/array.h>
-#include <dmlc/io.h>
-#include <dmlc/memory_io.h>
+#include <dgl/runtime/shared_mem.h>
 
-#include <algorithm>
 #include <array>
-#include <cmath>
-#include <cstdlib>
 #include <memory>
-#include <numeric>
 #include <string>
+#include <vector>
 
 namespace dgl {
 
 using dgl::runtime::SharedMemory;
 
-const size_t SHARED_MEM_METAINFO_SIZE_MAX = 1024 * 32;
-
-// Utility class to copy objects to shared memory and record metadatas
-class SharedMemManager : public dmlc::Stream {
+/*!
+ * \brief A graph structure stored in a single shared memory segment.
+ *
+ * The segment is laid out as
+ * {
+ *   SharedGraphHeader
+ *   SharedFormatSlot[num_etypes * 3] (the COO, CSR and CSC of every edge type)
+ *   char meta[meta_size] (the graph metadata, serialized by the caller)
+ *   ** Arrays of every slot, each one starting at a multiple of 64 bytes **
+ * }
+ *
+ * The arrays of all three formats of every edge type are reserved when the
+ * segment is created, whether they are materialized or not. Since untouched
+ * pages of shared memory are not allocated, a format costs memory only once it
+ * is published. Any process attached to the segment can publish a format that
+ * is still missing, which then becomes visible to all the others.
+ */
+class SharedMemManager {
  public:
-  explicit SharedMemManager(std::string graph_name, dmlc::Stream* strm)
-      : graph_name_(graph_name),
-        strm_(strm) {}
+  /*! \brief The numbers of source nodes, destination nodes and edges of an edge type. */
+  typedef std::array<int64_t, 3> RelationSize;
+
+  /*!
+   * \brief Create the segment.
+   * \param name The name of the shared memory.
+   * \param bits The number of bits of the IDs.
+   * \param meta The serialized graph metadata.
+   * \param sizes The sizes of the edge types.
+   */
+  SharedMemManager(const std::string& name, uint8_t bits, const std::string& meta,
+                   const std::vector<RelationSize>& sizes);
+
+  /*! \brief Attach to the segment created by another SharedMemManager. */
+  explicit SharedMemManager(const std::string& name);
+
+  /*! \return The name of the shared memory. */
+  const std::string& name() const { return name_; }
 
-  template <typename T>
-  T CopyToSharedMem(const T& data, std::string name);
+  /*! \return The serialized graph metadata. */
+  std::string meta() const;
 
-  template <typename T>
-  bool CreateFromSharedMem(T* out_data, std::string name);
+  /*! \return The number of bits of the IDs. */
+  uint8_t NumBits() const;
 
-  // delegate methods to strm_
-  virtual size_t Read(void* ptr, size_t size) { return strm_->Read(ptr, size); }
-  virtual void Write(const void* ptr, size_t size) { strm_->Write(ptr, size); }
+  /*! \return The number of edge types. */
+  uint64_t NumEdgeTypes() const;
 
-  using dmlc::Stream::Read;
-  using dmlc::Stream::Write;
+  /*!
+   * \brief Copy the COO matrix into the segment, unless it is already there or
+   *        being copied by another process.
+   * \return Whether the matrix has been copied.
+   */
+  bool Publish(dgl_type_t etype, const aten::COOMatrix& coo);
+
+  /*!
+   * \brief Copy the CSR (or CSC if transposed) matrix into the segment, unless
+   *        it is already there or being copied by another process.
+   * \return Whether the matrix has been copied.
+   */
+  bool Publish(dgl_type_t etype, const aten::CSRMatrix& csr, bool transposed);
+
+  /*!
+   * \brief Get the COO matrix published in the segment, whose arrays point into
+   *        the shared memory.
+   * \return Whether the matrix has been published.
+   */
+  bool Get(dgl_type_t etype, aten::COOMatrix* coo) const;
+
+  /*!
+   * \brief Get the CSR (or CSC if transposed) matrix published in the segment,
+   *        whose arrays point into the shared memory.
+   * \return Whether the matrix has been published.
+   */
+  bool Get(dgl_type_t etype, bool transposed, aten::CSRMatrix* csr) const;
 
  private:
-  std::string graph_name_;
-  dmlc::Stream* strm_;
+  /*! \brief Copy the arrays and flags into the slot if it is empty. */
+  bool PublishSlot(uint64_t slot, const std::array<NDArray, 3>& arrays,
+                   int64_t num_rows, int64_t num_cols, bool sorted0, bool sorted1);
+
+  /*! \brief Get the arrays and flags of the slot if it has been published. */
+  bool GetSlot(uint64_t slot, std::array<NDArray, 3>* arrays, int64_t* num_rows,
+               int64_t* num_cols, bool* sorted0, bool* sorted1) const;
+
+  std::string name_;
+  /*! \brief The whole segment as a byte array, owning the shared memory. */
+  NDArray segment_;
 };
 
 }  // namespace dgl
@@ -0,0 +1,260 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file graph/streaming_csr_builder.cc
+ * \brief Build CSR matrices from edges given by chunks
+ */
+#include "./streaming_csr_builder.h"
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif  // !_WIN32
+
+#include <dgl/packed_func_ext.h>
+#include <dgl/runtime/parallel_for.h>
+#include <dgl/runtime/registry.h>
+#include <dmlc/omp.h>
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "../c_api_common.h"
+#include "./unit_graph.h"
+
+namespace dgl {
+
+using namespace dgl::runtime;
+using namespace dgl::aten;
+
+namespace {
+
+/*! \brief The default number of buckets of source nodes. */
+constexpr int64_t kDefaultNumBuckets = 256;
+/*! \brief The least number of edges buffered, whatever the memory budget. */
+constexpr int64_t kMinCapacity = 1 << 12;
+
+/*!
+ * \brief Open a temporary file in the directory, removed when closed.
+ *
+ * The directory is ignored on Windows.
+ */
+std::FILE* OpenTempFile(const std::string& dir) {
+#ifndef _WIN32
+  if (!dir.empty()) {
+    std::string path = dir + "/dgl_edges_XXXXXX";
+    const int fd = mkstemp(&path[0]);
+    CHECK_NE(fd, -1) << "Cannot create a temporary file in " << dir;
+    unlink(path.c_str());
+    std::FILE* file = fdopen(fd, "w+b");
+    CHECK(file) << "Cannot open a temporary file in " << dir;
+    return file;
+  }
+#endif  // !_WIN32
+  std::FILE* file = std::tmpfile();
+  CHECK(file) << "Cannot create a temporary file";
+  return file;
+}
+
+}  // namespace
+
+StreamingCSRBuilder::StreamingCSRBuilder(
+    int64_t num_rows, int64_t num_cols, uint8_t bits, int64_t memory_budget,
+    const std::string& tmp_dir, int64_t num_buckets)
+  : num_rows_(num_rows), num_cols_(num_cols), bits_(bits), tmp_dir_(tmp_dir) {
+  CHECK_GE(num_rows, 0) << "The number of rows must be non-negative";
+  CHECK_GE(num_cols, 0) << "The number of columns must be non-negative";
+  CHECK(bits == 32 || bits == 64) << "bits must be 32 or 64";
+  CHECK(bits == 64 || std::max(num_rows, num_cols) <= std::numeric_limits<int32_t>::max())
+    << "The number of nodes exceeds the range of 32-bit IDs";
+  if (num_buckets <= 0)
+    num_buckets = kDefaultNumBuckets;
+  num_buckets = std::max<int64_t>(1, std::min(num_buckets, num_rows));
+  rows_per_bucket_ = std::max<int64_t>(1, (num_rows + num_buckets - 1) / num_buckets);
+  buckets_.resize((num_rows + rows_per_bucket_ - 1) / rows_per_bucket_, nullptr);
+  // the buffer and its copy sorted by bucket when spilled share the budget
+  capacity_ = std::max(kMinCapacity, memory_budget / static_cast<int64_t>(6 * sizeof(int64_t)));
+  degrees_.resize(num_rows, 0);
+}
+
+StreamingCSRBuilder::~StreamingCSRBuilder() {
+  for (std::FILE* file : buckets_) {
+    if (file)
+      std::fclose(file);
+  }
+}
+
+void StreamingCSRBuilder::AddEdges(IdArray src, IdArray dst) {
+  CHECK(!finished_) << "Cannot add edges after building the CSR matrix";
+  CHECK_EQ(src->ndim, 1) << "The source nodes must be a 1D array";
+  CHECK_EQ(dst->ndim, 1) << "The destination nodes must be a 1D array";
+  CHECK_EQ(src->shape[0], dst->shape[0])
+    << "The source and destination nodes must have the same length";
+  CHECK_EQ(src->dtype.bits, dst->dtype.bits)
+    << "The source and destination nodes must have the same data type";
+  const DLContext cpu_ctx{kDLCPU, 0};
+  src = src.CopyTo(cpu_ctx);
+  dst = dst.CopyTo(cpu_ctx);
+  const int64_t len = src->shape[0];
+  ATEN_ID_TYPE_SWITCH(src->dtype, IdType, {
+    const IdType* src_data = src.Ptr<IdType>();
+    const IdType* dst_data = dst.Ptr<IdType>();
+    for (int64_t i = 0; i < len; ++i) {
+      const int64_t u = src_data[i], v = dst_data[i];
+      CHECK(u >= 0 && u < num_rows_) << "Invalid source node " << u;
+      CHECK(v >= 0 && v < num_cols_) << "Invalid destination node " << v;
+      ++degrees_[u];
+      buffer_.push_back(u);
+      buffer_.push_back(v);
+      buffer_.push_back(num_edges_++);
+      if (static_cast<int64_t>(buffer_.size()) >= 3 * capacity_)
+        Spill();
+    }
+  });
+}
+
+void StreamingCSRBuilder::Spill() {
+  const int64_t num_buffered = buffer_.size() / 3;
+  const int64_t num_buckets = buckets_.size();
+  std::vector<int64_t> offsets(num_buckets + 1, 0);
+  for (int64_t i = 0; i < num_buffered; ++i)
+    ++offsets[buffer_[3 * i] / rows_per_bucket_ + 1];
+  for (int64_t b = 0; b < num_buckets; ++b)
+    offsets[b + 1] += offsets[b];
+
+  // a stable counting sort by bucket, keeping the order of the edges of a row
+  std::vector<int64_t> sorted(buffer_.size());
+  std::vector<int64_t> pos(offsets.begin(), offsets.end() - 1);
+  for (int64_t i = 0; i < num_buffered; ++i) {
+    const int64_t b = buffer_[3 * i] / rows_per_bucket_;
+    std::copy(&buffer_[3 * i], &buffer_[3 * i] + 3, &sorted[3 * pos[b]++]);
+  }
+  for (int64_t b = 0; b < num_buckets; ++b) {
+    const size_t count = offsets[b + 1] - offsets[b];
+    if (count == 0)
+      continue;
+    if (!buckets_[b])
+      buckets_[b] = OpenTempFile(tmp_dir_);
+    CHECK_EQ(std::fwrite(&sorted[3 * offsets[b]], 3 * sizeof(int64_t), count, buckets_[b]),
+             count) << "Cannot write the temporary file of the edges";
+  }
+  buffer_.clear();
+}
+
+template <typename IdType>
+CSRMatrix StreamingCSRBuilder::FinishImpl(bool sort_columns) {
+  const DLContext cpu_ctx{kDLCPU, 0};
+  IdArray indptr = NewIdArray(num_rows_ + 1, cpu_ctx, bits_);
+  IdArray indices = NewIdArray(num_edges_, cpu_ctx, bits_);
+  IdArray data = NewIdArray(num_edges_, cpu_ctx, bits_);
+  IdType* indptr_data = indptr.Ptr<IdType>();
+  IdType* indices_data = indices.Ptr<IdType>();
+  IdType* data_data = data.Ptr<IdType>();
+
+  // the degrees become the position of the next edge of every row
+  indptr_data[0] = 0;
+  for (int64_t r = 0; r < num_rows_; ++r) {
+    indptr_data[r + 1] = indptr_data[r] + degrees_[r];
+    degrees_[r] = indptr_data[r];
+  }
+  auto scatter = [&](const int64_t* edges, int64_t num) {
+    for (int64_t i = 0; i < num; ++i) {
+      const int64_t pos = degrees_[edges[3 * i]]++;
+      indices_data[pos] = edges[3 * i + 1];
+      data_data[pos] = edges[3 * i + 2];
+    }
+  };
+
+  const bool spilled = std::any_of(buckets_.begin(), buckets_.end(),
+                                   [](std::FILE* file) { return file != nullptr; });
+  if (!spilled) {
+    scatter(buffer_.data(), buffer_.size() / 3);
+  } else {
+    Spill();
+    std::vector<int64_t>().swap(buffer_);
+    // the buckets hold disjoint rows, so the threads scatter them independently,
+    // each one reading its bucket files by chunks of its share of the budget
+    const int64_t chunk_edges = std::max<int64_t>(1, capacity_ / omp_get_max_threads());
+    parallel_for(0, buckets_.size(), 1, [&](size_t b, size_t e) {
+      std::vector<int64_t> chunk(3 * chunk_edges);
+      for (size_t i = b; i < e; ++i) {
+        std::FILE* file = buckets_[i];
+        if (!file)
+          continue;
+        CHECK_EQ(std::fseek(file, 0, SEEK_SET), 0)
+          << "Cannot read the temporary file of the edges";
+        size_t num;
+        while ((num = std::fread(chunk.data(), 3 * sizeof(int64_t), chunk_edges, file)) > 0)
+          scatter(chunk.data(), num);
+        CHECK(!std::ferror(file)) << "Cannot read the temporary file of the edges";
+      }
+    });
+  }
+  for (std::FILE*& file : buckets_) {
+    if (file)
+      std::fclose(file);
+    file = nullptr;
+  }
+  std::vector<int64_t>().swap(buffer_);
+  std::vector<int64_t>().swap(degrees_);
+
+  if (sort_columns) {
+    // the edge IDs of a row are increasing, and stay so among equal columns
+    parallel_for_weighted(0, num_rows_, indptr_data, [&](size_t b, size_t e) {
+      std::vector<std::pair<IdType, IdType>> row;
+      for (size_t r = b; r < e; ++r) {
+        row.clear();
+        for (IdType pos = indptr_data[r]; pos < indptr_data[r + 1]; ++pos)
+          row.emplace_back(indices_data[pos], data_data[pos]);
+        std::sort(row.begin(), row.end());
+        for (size_t j = 0; j < row.size(); ++j) {
+          indices_data[indptr_data[r] + j] = row[j].first;
+          data_data[indptr_data[r] + j] = row[j].second;
+        }
+      }
+    });
+  }
+
+  return CSRMatrix(num_rows_, num_cols_, indptr, indices, data, sort_columns);
+}
+
+CSRMatrix StreamingCSRBuilder::Finish(bool sort_columns) {
+  CHECK(!finished_) << "The CSR matrix has already been built";
+  CHECK(bits_ == 64 || num_edges_ <= std::numeric_limits<int32_t>::max())
+    << "The number of edges exceeds the range of 32-bit IDs";
+  finished_ = true;
+  CSRMatrix ret;
+  ATEN_ID_BITS_SWITCH(bits_, IdType, {
+    ret = FinishImpl<IdType>(sort_columns);
+  });
+  return ret;
+}
+
+DGL_REGISTER_GLOBAL("heterograph_index._CAPI_DGLStreamingCSRBuilderCreate")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    const int64_t num_rows = args[0];
+    const int64_t num_cols = args[1];
+    const int bits = args[2];
+    const int64_t memory_budget = args[3];
+    const std::string tmp_dir = args[4];
+    const int64_t num_buckets = args[5];
+    *rv = StreamingCSRBuilderRef(std::make_shared<StreamingCSRBuilder>(
+        num_rows, num_cols, bits, memory_budget, tmp_dir, num_buckets));
+  });
+
+DGL_REGISTER_GLOBAL("heterograph_index._CAPI_DGLStreamingCSRBuilderAddEdges")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    StreamingCSRBuilderRef builder = args[0];
+    const IdArray src = args[1];
+    const IdArray dst = args[2];
+    builder->AddEdges(src, dst);
+  });
+
+DGL_REGISTER_GLOBAL("heterograph_index._CAPI_DGLStreamingCSRBuilderFinish")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    StreamingCSRBuilderRef builder = args[0];
+    const int64_t num_vtypes = args[1];
+    const bool sort_columns = args[2];
+    *rv = HeteroGraphRef(UnitGraph::CreateFromCSR(num_vtypes, builder->Finish(sort_columns)));
+  });
+
+}  // namespace dgl
@@ -0,0 +1,92 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file graph/streaming_csr_builder.h
+ * \brief Build CSR matrices from edges given by chunks
+ */
+#ifndef DGL_GRAPH_STREAMING_CSR_BUILDER_H_
+#define DGL_GRAPH_STREAMING_CSR_BUILDER_H_
+
+#include <dgl/array.h>
+#include <dgl/runtime/object.h>
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace dgl {
+
+/*!
+ * \brief Build a CSR matrix from edges given by chunks, without holding all of
+ *        them in memory as a COO matrix.
+ *
+ * The edges are buffered up to the memory budget, then spilled to temporary
+ * files, one per bucket of consecutive source nodes, while the out degrees are
+ * counted. Finish() computes the row pointers from the degrees, and scatters
+ * the edges of the buckets into the indices and edge IDs of the CSR, every
+ * thread taking whole buckets. The result is the only array holding all the
+ * edges.
+ *
+ * The edge IDs are given in the order the edges are added.
+ */
+class StreamingCSRBuilder : public runtime::Object {
+ public:
+  /*!
+   * \brief Create a builder.
+   * \param num_rows The number of rows, i.e. source nodes.
+   * \param num_cols The number of columns, i.e. destination nodes.
+   * \param bits The number of bits of the IDs of the result.
+   * \param memory_budget The number of bytes used to buffer the edges.
+   * \param tmp_dir The directory of the temporary files, or empty for the
+   *        default one.
+   * \param num_buckets The number of buckets of source nodes.
+   */
+  StreamingCSRBuilder(int64_t num_rows, int64_t num_cols, uint8_t bits,
+                      int64_t memory_budget, const std::string& tmp_dir,
+                      int64_t num_buckets);
+
+  ~StreamingCSRBuilder();
+
+  /*! \brief Add the edges from src to dst, numbered after the ones already added. */
+  void AddEdges(IdArray src, IdArray dst);
+
+  /*!
+   * \brief Return the CSR matrix of all the edges added, and release the
+   *        temporary files.
+   * \param sort_columns Whether to sort the columns of every row.
+   */
+  aten::CSRMatrix Finish(bool sort_columns);
+
+  /*! \brief Return the number of edges added. */
+  int64_t NumEdges() const { return num_edges_; }
+
+  static constexpr const char* _type_key = "graph.StreamingCSRBuilder";
+  DGL_DECLARE_OBJECT_TYPE_INFO(StreamingCSRBuilder, runtime::Object);
+
+ private:
+  /*! \brief Write the buffered edges to the files of their buckets. */
+  void Spill();
+
+  template <typename IdType>
+  aten::CSRMatrix FinishImpl(bool sort_columns);
+
+  int64_t num_rows_;
+  int64_t num_cols_;
+  uint8_t bits_;
+  std::string tmp_dir_;
+  int64_t rows_per_bucket_;
+  // the number of edges buffered before spilling
+  int64_t capacity_;
+  int64_t num_edges_ = 0;
+  bool finished_ = false;
+  std::vector<int64_t> degrees_;
+  // the (src, dst, edge ID) triplets of the buffered edges
+  std::vector<int64_t> buffer_;
+  std::vector<std::FILE*> buckets_;
+};
+
+DGL_DEFINE_OBJECT_REF(StreamingCSRBuilderRef, StreamingCSRBuilder);
+
+}  // namespace dgl
+
+#endif  // DGL_GRAPH_STREAMING_CSR_BUILDER_H_
@@ -3,11 +3,180 @@
  * \file graph/subgraph.cc
  * \brief Functions for extracting subgraphs.
  */
+#include <dgl/runtime/parallel_for.h>
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 #include "./heterograph.h"
 using namespace dgl::runtime;
 
 namespace dgl {
 
+namespace {
+
+/*!
+ * \brief Slice the given rows of a CSR matrix into a matrix of the same shape,
+ *        with the other rows empty.
+ *
+ * The entries are numbered in the order of the rows given, as by InEdges and
+ * OutEdges, so the returned array maps them to the entries of the matrix.
+ */
+template <typename IdType>
+std::pair<aten::CSRMatrix, IdArray> SliceRowsInPlaceCPU(
+    const aten::CSRMatrix& mat, IdArray rows) {
+  const aten::CSRMatrix sliced = aten::CSRSliceRows(mat, rows);
+  const int64_t len = rows->shape[0];
+  const int64_t num_rows = mat.num_rows;
+  const int64_t nnz = sliced.indices->shape[0];
+  const IdType* rows_data = rows.Ptr<IdType>();
+  const IdType* slice_indptr = sliced.indptr.Ptr<IdType>();
+  const IdType* slice_indices = sliced.indices.Ptr<IdType>();
+
+  IdArray indptr = NDArray::Empty({num_rows + 1}, mat.indptr->dtype, mat.indptr->ctx);
+  IdArray indices = NDArray::Empty({nnz}, mat.indices->dtype, mat.indices->ctx);
+  IdArray data = NDArray::Empty({nnz}, mat.indptr->dtype, mat.indptr->ctx);
+  IdType* indptr_data = indptr.Ptr<IdType>();
+  IdType* indices_data = indices.Ptr<IdType>();
+  IdType* data_data = data.Ptr<IdType>();
+
+  // the degree of every row, shifted by one
+  parallel_for(0, num_rows + 1, 4096, [&](int64_t b, int64_t e) {
+    std::fill(indptr_data + b, indptr_data + e, 0);
+  });
+  bool duplicate = false;
+  for (int64_t i = 0; i < len; ++i) {
+    const IdType rid = rows_data[i];
+    CHECK(rid >= 0 && rid < num_rows) << "Invalid node ID " << rid << ".";
+    const IdType deg = slice_indptr[i + 1] - slice_indptr[i];
+    duplicate |= (deg > 0 && indptr_data[rid + 1] > 0);
+    indptr_data[rid + 1] += deg;
+  }
+
+  // prefix sum of the chunks of every thread, then of the chunks
+  const int64_t num_chunks = std::max<int64_t>(
+      1, std::min<int64_t>(omp_get_max_threads(), num_rows / 4096));
+  const int64_t chunk_size = (num_rows + num_chunks - 1) / num_chunks;
+  std::vector<IdType> chunk_sums(num_chunks + 1, 0);
+  parallel_for(0, num_chunks, 1, [&](int64_t b, int64_t e) {
+    for (int64_t c = b; c < e; ++c) {
+      const int64_t begin = 1 + c * chunk_size;
+      const int64_t end = std::min(num_rows, (c + 1) * chunk_size) + 1;
+      IdType sum = 0;
+      for (int64_t v = begin; v < end; ++v) {
+        sum += indptr_data[v];
+        indptr_data[v] = sum;
+      }
+      chunk_sums[c + 1] = sum;
+    }
+  });
+  for (int64_t c = 0; c < num_chunks; ++c)
+    chunk_sums[c + 1] += chunk_sums[c];
+  parallel_for(0, num_chunks, 1, [&](int64_t b, int64_t e) {
+    for (int64_t c = b; c < e; ++c) {
+      const int64_t begin = 1 + c * chunk_size;
+      const int64_t end = std::min(num_rows, (c + 1) * chunk_size) + 1;
+      for (int64_t v = begin; v < end; ++v)
+        indptr_data[v] += chunk_sums[c];
+    }
+  });
+
+  // the start of the entries of every row given, after the ones of its earlier
+  // occurrences if it is given several times
+  std::vector<IdType> starts(len);
+  if (!duplicate) {
+    parallel_for(0, len, [&](int64_t b, int64_t e) {
+      for (int64_t i = b; i < e; ++i)
+        starts[i] = indptr_data[rows_data[i]];
+    });
+  } else {
+    std::unordered_map<IdType, IdType> cursor;
+    for (int64_t i = 0; i < len; ++i) {
+      const IdType rid = rows_data[i];
+      auto it = cursor.emplace(rid, indptr_data[rid]).first;
+      starts[i] = it->second;
+      it->second += slice_indptr[i + 1] - slice_indptr[i];
+    }
+  }
+
+  parallel_for(0, len, [&](int64_t b, int64_t e) {
+    for (int64_t i = b; i < e; ++i) {
+      const IdType begin = slice_indptr[i];
+      const IdType deg = slice_indptr[i + 1] - begin;
+      std::copy(slice_indices + begin, slice_indices + begin + deg, indices_data + starts[i]);
+      for (IdType k = 0; k < deg; ++k)
+        data_data[starts[i] + k] = begin + k;
+    }
+  });
+
+  aten::CSRMatrix ret(num_rows, mat.num_cols, indptr, indices, data,
+                      mat.sorted && !duplicate);
+  return std::make_pair(ret, sliced.data);
+}
+
+/*!
+ * \brief Extract the subgraph of the in or out edges of the given nodes of a
+ *        graph on CPU, without relabeling the nodes.
+ *
+ * The CSC (or CSR) matrix of every relation is sliced directly into the one of
+ * the subgraph, instead of going through COO, with the relations in parallel.
+ */
+HeteroSubgraph SliceEdgeGraphNoRelabelNodesCPU(
+    const HeteroGraphPtr graph, const std::vector<IdArray>& vids, bool in_edges) {
+  const dgl_type_t num_etypes = graph->NumEdgeTypes();
+  std::vector<HeteroGraphPtr> subrels(num_etypes);
+  std::vector<IdArray> induced_edges(num_etypes);
+  // the formats are created before, as they may be converted in place
+  std::vector<aten::CSRMatrix> mats(num_etypes);
+  for (dgl_type_t etype = 0; etype < num_etypes; ++etype) {
+    auto pair = graph->meta_graph()->FindEdge(etype);
+    const dgl_type_t vtype = in_edges ? pair.second : pair.first;
+    if (!aten::IsNullArray(vids[vtype])) {
+      CHECK_EQ(vids[vtype]->dtype.bits, graph->NumBits())
+        << "The node IDs must have the same data type as the graph.";
+      CHECK_EQ(vids[vtype]->ctx.device_type, kDLCPU)
+        << "The node IDs must be on the device of the graph.";
+      mats[etype] = in_edges ? graph->GetCSCMatrix(etype) : graph->GetCSRMatrix(etype);
+    }
+  }
+  parallel_for(0, num_etypes, 1, [&](size_t b, size_t e) {
+    for (size_t etype = b; etype < e; ++etype) {
+      auto pair = graph->meta_graph()->FindEdge(etype);
+      const dgl_type_t src_vtype = pair.first;
+      const dgl_type_t dst_vtype = pair.second;
+      const IdArray& nodes = vids[in_edges ? dst_vtype : src_vtype];
+      const int64_t num_vtypes = graph->GetRelationGraph(etype)->NumVertexTypes();
+      if (aten::IsNullArray(nodes)) {
+        // create a placeholder graph
+        subrels[etype] = UnitGraph::Empty(
+          num_vtypes,
+          graph->NumVertices(src_vtype),
+          graph->NumVertices(dst_vtype),
+          graph->DataType(), graph->Context());
+        induced_edges[etype] = IdArray::Empty({0}, graph->DataType(), graph->Context());
+        continue;
+      }
+      std::pair<aten::CSRMatrix, IdArray> sliced;
+      ATEN_ID_TYPE_SWITCH(graph->DataType(), IdType, {
+        sliced = SliceRowsInPlaceCPU<IdType>(mats[etype], nodes);
+      });
+      subrels[etype] = in_edges ?
+        UnitGraph::CreateFromCSC(num_vtypes, sliced.first) :
+        UnitGraph::CreateFromCSR(num_vtypes, sliced.first);
+      induced_edges[etype] = sliced.second;
+    }
+  });
+  HeteroSubgraph ret;
+  ret.graph = CreateHeteroGraph(graph->meta_graph(), subrels, graph->NumVerticesPerType());
+  ret.induced_edges = std::move(induced_edges);
+  return ret;
+}
+
+}  // namespace
+
 HeteroSubgraph InEdgeGraphRelabelNodes(
     const HeteroGraphPtr graph, const std::vector<IdArray>& vids) {
   CHECK_EQ(vids.size(), graph->NumVertexTypes())
@@ -31,6 +200,8 @@ HeteroSubgraph InEdgeGraphNoRelabelNodes(
   // TODO(mufei): This should also use EdgeSubgraph once it is supported for CSR graphs
   CHECK_EQ(vids.size(), graph->NumVertexTypes())
     << "Invalid input: the input list size must be the same as the number of vertex types.";
+  if (graph->Context().device_type == kDLCPU && (graph->GetAllowedFormats() & CSC_CODE))
+    return SliceEdgeGraphNoRelabelNodesCPU(graph, vids, true);
   std::vector<HeteroGraphPtr> subrels(graph->NumEdgeTypes());
   std::vector<IdArray> induced_edges(graph->NumEdgeTypes());
   for (dgl_type_t etype = 0; etype < graph->NumEdgeTypes(); ++etype) {
@@ -95,6 +266,8 @@ HeteroSubgraph OutEdgeGraphNoRelabelNodes(
   // TODO(mufei): This should also use EdgeSubgraph once it is supported for CSR graphs
   CHECK_EQ(vids.size(), graph->NumVertexTypes())
     << "Invalid input: the input list size must be the same as the number of vertex types.";
+  if (graph->Context().device_type == kDLCPU && (graph->GetAllowedFormats() & CSR_CODE))
+    return SliceEdgeGraphNoRelabelNodesCPU(graph, vids, false);
   std::vector<HeteroGraphPtr> subrels(graph->NumEdgeTypes());
   std::vector<IdArray> induced_edges(graph->NumEdgeTypes());
   for (dgl_type_t etype = 0; etype < graph->NumEdgeTypes(); ++etype) {
@@ -136,4 +309,62 @@ HeteroSubgraph OutEdgeGraph(
   }
 }
 
+HeteroSubgraph BatchedNodeSubgraph(
+    const HeteroGraphPtr graph, const std::vector<IdArray>& nodes,
+    const std::vector<IdArray>& offsets, std::vector<IdArray>* edge_offsets) {
+  CHECK_EQ(nodes.size(), graph->NumVertexTypes())
+    << "Invalid input: the input list size must be the same as the number of vertex types.";
+  CHECK_EQ(offsets.size(), graph->NumVertexTypes())
+    << "Invalid input: the input list size must be the same as the number of vertex types.";
+  const dgl_type_t num_etypes = graph->NumEdgeTypes();
+  std::vector<HeteroGraphPtr> subrels(num_etypes);
+  std::vector<IdArray> induced_edges(num_etypes);
+  edge_offsets->resize(num_etypes);
+  std::vector<int64_t> num_nodes_per_type(nodes.size());
+  for (size_t vtype = 0; vtype < nodes.size(); ++vtype)
+    num_nodes_per_type[vtype] = nodes[vtype]->shape[0];
+  for (dgl_type_t etype = 0; etype < num_etypes; ++etype) {
+    auto pair = graph->meta_graph()->FindEdge(etype);
+    const dgl_type_t src_vtype = pair.first;
+    const dgl_type_t dst_vtype = pair.second;
+    const aten::CSRMatrix mat = aten::CSRSliceMatrixBatched(
+        graph->GetCSRMatrix(etype), nodes[src_vtype], offsets[src_vtype],
+        nodes[dst_vtype], offsets[dst_vtype]);
+    // the edges are numbered in the order of the batched CSR
+    subrels[etype] = UnitGraph::CreateFromCSR(
+        graph->GetRelationGraph(etype)->NumVertexTypes(),
+        aten::CSRMatrix(mat.num_rows, mat.num_cols, mat.indptr, mat.indices));
+    induced_edges[etype] = mat.data;
+    (*edge_offsets)[etype] = aten::IndexSelect(mat.indptr, offsets[src_vtype]);
+  }
+  HeteroSubgraph ret;
+  ret.graph = CreateHeteroGraph(graph->meta_graph(), subrels, num_nodes_per_type);
+  ret.induced_vertices = nodes;
+  ret.induced_edges = std::move(induced_edges);
+  return ret;
+}
+
+HeteroSubgraph BatchedKHopSubgraph(
+    const HeteroGraphPtr graph, IdArray seeds, IdArray seed_offsets, int64_t num_hops,
+    const std::string& direction, IdArray* node_offsets, IdArray* edge_offsets,
+    NDArray* dists) {
+  CHECK(graph->NumVertexTypes() == 1 && graph->NumEdgeTypes() == 1)
+    << "The k-hop subgraphs are only supported on homogeneous graphs.";
+  std::vector<aten::CSRMatrix> adjs;
+  if (direction == "in" || direction == "both")
+    adjs.push_back(graph->GetCSCMatrix(0));
+  if (direction == "out" || direction == "both")
+    adjs.push_back(graph->GetCSRMatrix(0));
+  CHECK(!adjs.empty()) << "Invalid direction: " << direction;
+  const std::vector<NDArray> expanded = aten::CSRKHopExpand(
+      adjs, seeds, seed_offsets, num_hops);
+  std::vector<IdArray> edge_offsets_per_type;
+  HeteroSubgraph ret = BatchedNodeSubgraph(
+      graph, {expanded[0]}, {expanded[1]}, &edge_offsets_per_type);
+  *node_offsets = expanded[1];
+  *edge_offsets = edge_offsets_per_type[0];
+  *dists = expanded[2];
+  return ret;
+}
+
 }  // namespace dgl
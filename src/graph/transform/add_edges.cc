@@ -0,0 +1,61 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file graph/transform/add_edges.cc
+ * \brief Add edges.
+ */
+
+#include <dgl/base_heterograph.h>
+#include <dgl/transform.h>
+#include <dgl/array.h>
+#include <dgl/packed_func_ext.h>
+#include <dgl/runtime/registry.h>
+#include <dgl/runtime/container.h>
+#include <vector>
+#include "../heterograph.h"
+#include "../unit_graph.h"
+
+namespace dgl {
+
+using namespace dgl::runtime;
+using namespace dgl::aten;
+
+namespace transform {
+
+HeteroGraphPtr AddEdges(
+    const HeteroGraphPtr graph, const std::vector<IdArray> &src,
+    const std::vector<IdArray> &dst, const std::vector<int64_t> &num_nodes_per_type) {
+  const int64_t num_etypes = graph->NumEdgeTypes();
+  const auto &ugs = std::dynamic_pointer_cast<HeteroGraph>(graph)->relation_graphs();
+  std::vector<HeteroGraphPtr> rel_graphs(num_etypes);
+
+  for (int64_t etype = 0; etype < num_etypes; ++etype) {
+    const auto src_dst_types = graph->GetEndpointTypes(etype);
+    const int64_t num_src = num_nodes_per_type[src_dst_types.first];
+    const int64_t num_dst = num_nodes_per_type[src_dst_types.second];
+    if (src[etype]->shape[0] == 0 &&
+        num_src == graph->NumVertices(src_dst_types.first) &&
+        num_dst == graph->NumVertices(src_dst_types.second)) {
+      // the relation graph is shared with its formats
+      rel_graphs[etype] = ugs[etype];
+    } else {
+      rel_graphs[etype] = ugs[etype]->AppendEdges(num_src, num_dst, src[etype], dst[etype]);
+    }
+  }
+
+  return CreateHeteroGraph(graph->meta_graph(), rel_graphs, num_nodes_per_type);
+}
+
+DGL_REGISTER_GLOBAL("heterograph._CAPI_DGLAddEdges")
+.set_body([] (DGLArgs args, DGLRetValue *rv) {
+    const HeteroGraphRef graph_ref = args[0];
+    const std::vector<IdArray> &src = ListValueToVector<IdArray>(args[1]);
+    const std::vector<IdArray> &dst = ListValueToVector<IdArray>(args[2]);
+    const IdArray num_nodes_per_type = args[3];
+
+    *rv = HeteroGraphRef(AddEdges(
+        graph_ref.sptr(), src, dst, num_nodes_per_type.ToVector<int64_t>()));
+  });
+
+};  // namespace transform
+
+};  // namespace dgl
@@ -25,13 +25,15 @@
 #include <dgl/packed_func_ext.h>
 #include <dgl/runtime/registry.h>
 #include <dgl/runtime/container.h>
+#include <dgl/runtime/memory_tracker.h>
+#include <dgl/runtime/profile_range.h>
 #include <vector>
 #include <utility>
 #include "../../c_api_common.h"
 #include "../unit_graph.h"
 // TODO(BarclayII): currently CompactGraphs depend on IdHashMap implementation which
 // only works on CPU.  Should fix later to make it device agnostic.
-#include "../../array/cpu/array_utils.h"
+#include "../../array/cpu/concurrent_id_hash_map.h"
 
 namespace dgl {
 
@@ -47,10 +49,12 @@ std::pair<std::vector<HeteroGraphPtr>, std::vector<IdArray>>
 CompactGraphsCPU(
     const std::vector<HeteroGraphPtr> &graphs,
     const std::vector<IdArray> &always_preserve) {
+  DGL_PROFILE_RANGE("CompactGraphs", graphs.size(), graphs[0]->NumEdgeTypes());
+  runtime::MemoryTagScope tag_scope(runtime::MemoryTag::kSampler);
   // TODO(BarclayII): check whether the node space and metagraph of each graph is the same.
   // Step 1: Collect the nodes that has connections for each type.
   const int64_t num_ntypes = graphs[0]->NumVertexTypes();
-  std::vector<aten::IdHashMap<IdType>> hashmaps(num_ntypes);
+  std::vector<aten::ConcurrentIdHashMap<IdType>> hashmaps(num_ntypes);
   std::vector<std::vector<EdgeArray>> all_edges(graphs.size());   // all_edges[i][etype]
 
   std::vector<int64_t> max_vertex_cnt(num_ntypes, 0);
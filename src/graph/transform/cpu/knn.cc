@@ -7,6 +7,7 @@
 #include <dgl/runtime/device_api.h>
 #include <dgl/random.h>
 #include <dgl/runtime/parallel_for.h>
+#include <dgl/runtime/profile_range.h>
 #include <dmlc/omp.h>
 #include <vector>
 #include <tuple>
@@ -24,6 +25,10 @@ namespace impl {
 // This value is directly from pynndescent
 static constexpr int NN_DESCENT_BLOCK_SIZE = 16384;
 
+// The numbers of query and data points in a tile of the brute-force KNN
+static constexpr int64_t KNN_QUERY_BLOCK_SIZE = 32;
+static constexpr int64_t KNN_DATA_BLOCK_SIZE = 256;
+
 /*!
  * \brief Compute Euclidean distance between two vectors, return positive
  *  infinite value if the intermediate distance is greater than the worst
@@ -255,6 +260,69 @@ void KdTreeKNN(const NDArray& data_points, const IdArray& data_offsets,
   }
 }
 
+/*!
+ * \brief Compute the squared Euclidean distances between a block of query points
+ *  and a block of data points as |q|^2 + |d|^2 - 2 q.d, like a GEMM tile. The dot
+ *  products are accumulated for four data points at a time, so that the loop over
+ *  the features is vectorized.
+ */
+template <typename FloatType>
+void BlockEuclideanDist(const FloatType* queries, const FloatType* query_norms,
+                        int64_t num_queries, const FloatType* data, const FloatType* data_norms,
+                        int64_t num_data, int64_t dim, FloatType* dists) {
+  for (int64_t q = 0; q < num_queries; ++q) {
+    const FloatType* q_vec = queries + q * dim;
+    FloatType* q_dists = dists + q * num_data;
+    int64_t d = 0;
+    for (; d + 4 <= num_data; d += 4) {
+      const FloatType* d_vec = data + d * dim;
+      FloatType dot0 = 0, dot1 = 0, dot2 = 0, dot3 = 0;
+#pragma omp simd reduction(+:dot0, dot1, dot2, dot3)
+      for (int64_t idx = 0; idx < dim; ++idx) {
+        dot0 += q_vec[idx] * d_vec[idx];
+        dot1 += q_vec[idx] * d_vec[dim + idx];
+        dot2 += q_vec[idx] * d_vec[2 * dim + idx];
+        dot3 += q_vec[idx] * d_vec[3 * dim + idx];
+      }
+      q_dists[d] = query_norms[q] + data_norms[d] - 2 * dot0;
+      q_dists[d + 1] = query_norms[q] + data_norms[d + 1] - 2 * dot1;
+      q_dists[d + 2] = query_norms[q] + data_norms[d + 2] - 2 * dot2;
+      q_dists[d + 3] = query_norms[q] + data_norms[d + 3] - 2 * dot3;
+    }
+    for (; d < num_data; ++d) {
+      const FloatType* d_vec = data + d * dim;
+      FloatType dot = 0;
+#pragma omp simd reduction(+:dot)
+      for (int64_t idx = 0; idx < dim; ++idx)
+        dot += q_vec[idx] * d_vec[idx];
+      q_dists[d] = query_norms[q] + data_norms[d] - 2 * dot;
+    }
+    // the rounding errors must not give negative distances
+    for (d = 0; d < num_data; ++d)
+      q_dists[d] = std::max(q_dists[d], static_cast<FloatType>(0));
+  }
+}
+
+/*! \brief Compute the squared norm of every point */
+template <typename FloatType>
+void SquaredNorms(const FloatType* points, int64_t num_points, int64_t dim,
+                  FloatType* norms) {
+  parallel_for(0, num_points, [&](int64_t b, int64_t e) {
+    for (int64_t i = b; i < e; ++i) {
+      FloatType norm = 0;
+#pragma omp simd reduction(+:norm)
+      for (int64_t idx = 0; idx < dim; ++idx)
+        norm += points[i * dim + idx] * points[i * dim + idx];
+      norms[i] = norm;
+    }
+  });
+}
+
+/*!
+ * \brief The brute-force implementation of K-Nearest Neighbors. The distances are
+ *  computed by tiles of query and data points which stay in cache, and each query
+ *  point only inserts into its heap the distances below its current worst one.
+ */
 template <typename FloatType, typename IdType>
 void BruteForceKNN(const NDArray& data_points, const IdArray& data_offsets,
                    const NDArray& query_points, const IdArray& query_offsets,
@@ -268,35 +336,47 @@ void BruteForceKNN(const NDArray& data_points, const IdArray& data_offsets,
   IdType* query_out = result.Ptr<IdType>();
   IdType* data_out = query_out + k * query_points->shape[0];
 
-  for (int64_t b = 0; b < batch_size; ++b) {
-    IdType d_start = data_offsets_data[b], d_end = data_offsets_data[b + 1];
-    IdType q_start = query_offsets_data[b], q_end = query_offsets_data[b + 1];
-
-    std::vector<FloatType> dist_buffer(k);
+  std::vector<FloatType> data_norms(data_points->shape[0]);
+  std::vector<FloatType> query_norms(query_points->shape[0]);
+  SquaredNorms(data_points_data, data_points->shape[0], feature_size, data_norms.data());
+  SquaredNorms(query_points_data, query_points->shape[0], feature_size, query_norms.data());
 
-    parallel_for(q_start, q_end, [&](IdType b, IdType e) {
-      for (auto q_idx = b; q_idx < e; ++q_idx) {
-        std::vector<FloatType> dist_buffer(k);
-        for (IdType k_idx = 0; k_idx < k; ++k_idx) {
-          query_out[q_idx * k + k_idx] = q_idx;
-          dist_buffer[k_idx] = std::numeric_limits<FloatType>::max();
+  for (int64_t b = 0; b < batch_size; ++b) {
+    const IdType d_start = data_offsets_data[b], d_end = data_offsets_data[b + 1];
+    const IdType q_start = query_offsets_data[b], q_end = query_offsets_data[b + 1];
+    const int64_t num_query_blocks =
+      (q_end - q_start + KNN_QUERY_BLOCK_SIZE - 1) / KNN_QUERY_BLOCK_SIZE;
+
+    parallel_for(0, num_query_blocks, 1, [&](int64_t begin, int64_t end) {
+      std::vector<FloatType> dist_buffer(KNN_QUERY_BLOCK_SIZE * k);
+      std::vector<FloatType> block_dists(KNN_QUERY_BLOCK_SIZE * KNN_DATA_BLOCK_SIZE);
+      for (int64_t qb = begin; qb < end; ++qb) {
+        const IdType qb_start = q_start + qb * KNN_QUERY_BLOCK_SIZE;
+        const IdType qb_end = std::min<IdType>(qb_start + KNN_QUERY_BLOCK_SIZE, q_end);
+        for (IdType q_idx = qb_start; q_idx < qb_end; ++q_idx) {
+          for (IdType k_idx = 0; k_idx < k; ++k_idx)
+            query_out[q_idx * k + k_idx] = q_idx;
         }
-        FloatType worst_dist = std::numeric_limits<FloatType>::max();
-
-        for (IdType d_idx = d_start; d_idx < d_end; ++d_idx) {
-          FloatType tmp_dist = EuclideanDistWithCheck<FloatType, IdType>(
-            query_points_data + q_idx * feature_size,
-            data_points_data + d_idx * feature_size,
-            feature_size, worst_dist);
-
-          if (tmp_dist == std::numeric_limits<FloatType>::max()) {
-            continue;
+        std::fill(dist_buffer.begin(), dist_buffer.end(), std::numeric_limits<FloatType>::max());
+
+        for (IdType db_start = d_start; db_start < d_end; db_start += KNN_DATA_BLOCK_SIZE) {
+          const IdType db_end = std::min<IdType>(db_start + KNN_DATA_BLOCK_SIZE, d_end);
+          const int64_t db_size = db_end - db_start;
+          BlockEuclideanDist<FloatType>(
+            query_points_data + qb_start * feature_size, query_norms.data() + qb_start,
+            qb_end - qb_start, data_points_data + db_start * feature_size,
+            data_norms.data() + db_start, db_size, feature_size, block_dists.data());
+
+          for (IdType q_idx = qb_start; q_idx < qb_end; ++q_idx) {
+            FloatType* q_dist_buffer = dist_buffer.data() + (q_idx - qb_start) * k;
+            const FloatType* q_block_dists = block_dists.data() + (q_idx - qb_start) * db_size;
+            for (int64_t i = 0; i < db_size; ++i) {
+              if (q_block_dists[i] < q_dist_buffer[0]) {
+                HeapInsert<FloatType, IdType>(
+                  data_out + q_idx * k, q_dist_buffer, db_start + i, q_block_dists[i], k);
+              }
+            }
           }
-
-          IdType out_offset = q_idx * k;
-          HeapInsert<FloatType, IdType>(
-            data_out + out_offset, dist_buffer.data(), d_idx, tmp_dist, k);
-          worst_dist = dist_buffer[0];
         }
       }
     });
@@ -308,6 +388,7 @@ template <DLDeviceType XPU, typename FloatType, typename IdType>
 void KNN(const NDArray& data_points, const IdArray& data_offsets,
          const NDArray& query_points, const IdArray& query_offsets,
          const int k, IdArray result, const std::string& algorithm) {
+  DGL_PROFILE_RANGE("KNN", algorithm, k, data_points, query_points);
   if (algorithm == std::string("kd-tree")) {
     impl::KdTreeKNN<FloatType, IdType>(
       data_points, data_offsets, query_points, query_offsets, k, result);
@@ -323,6 +404,7 @@ template <DLDeviceType XPU, typename FloatType, typename IdType>
 void NNDescent(const NDArray& points, const IdArray& offsets,
                IdArray result, const int k, const int num_iters,
                const int num_candidates, const double delta) {
+  DGL_PROFILE_RANGE("NNDescent", k, num_iters, points);
   using nnd_updates_t = std::vector<std::vector<std::tuple<IdType, IdType, FloatType>>>;
   const auto& ctx = points->ctx;
   auto device = runtime::DeviceAPI::Get(ctx);
@@ -204,17 +204,18 @@ CompactGraphsGPU(
     &induced_nodes,
     stream);
 
-  device->CopyDataFromTo(
-    count_unique_device, 0,
-    num_induced_nodes.data(), 0,
-    sizeof(*num_induced_nodes.data())*num_ntypes,
-    ctx,
-    DGLContext{kDLCPU, 0},
-    DGLType{kDLInt, 64, 1},
-    stream);
-  device->StreamSync(ctx, stream);
+  // only wait for the node counts once the edges are being mapped
+  AsyncCountCopy count_unique_copy(count_unique_device, num_ntypes, stream);
 
-  // wait for the node counts to finish transferring
+  // Step 3: Remap the edges of each graph using MapEdges
+  std::vector<std::vector<IdArray>> new_src(graphs.size());
+  std::vector<std::vector<IdArray>> new_dst(graphs.size());
+  for (size_t i = 0; i < graphs.size(); ++i) {
+    std::tie(new_src[i], new_dst[i]) = MapEdges(
+      graphs[i], all_edges[i], node_maps, stream);
+  }
+
+  num_induced_nodes = count_unique_copy.Wait();
   device->FreeWorkspace(ctx, count_unique_device);
 
   // resize induced nodes
@@ -222,7 +223,6 @@ CompactGraphsGPU(
     induced_nodes[ntype]->shape[0] = num_induced_nodes[ntype];
   }
 
-  // Step 3: Remap the edges of each graph using MapEdges
   std::vector<HeteroGraphPtr> new_graphs;
   for (size_t i = 0; i < graphs.size(); ++i) {
     const HeteroGraphPtr curr_graph = graphs[i];
@@ -232,11 +232,6 @@ CompactGraphsGPU(
     std::vector<HeteroGraphPtr> rel_graphs;
     rel_graphs.reserve(num_etypes);
 
-    std::vector<IdArray> new_src;
-    std::vector<IdArray> new_dst;
-    std::tie(new_src, new_dst) = MapEdges(
-      curr_graph, all_edges[i], node_maps, stream);
-
     for (IdType etype = 0; etype < num_etypes; ++etype) {
       IdType srctype, dsttype;
       std::tie(srctype, dsttype) = curr_graph->GetEndpointTypes(etype);
@@ -245,8 +240,8 @@ CompactGraphsGPU(
           srctype == dsttype ? 1 : 2,
           induced_nodes[srctype]->shape[0],
           induced_nodes[dsttype]->shape[0],
-          new_src[etype],
-          new_dst[etype]));
+          new_src[i][etype],
+          new_dst[i][etype]));
     }
 
     new_graphs.push_back(CreateHeteroGraph(meta_graph, rel_graphs, num_induced_nodes));
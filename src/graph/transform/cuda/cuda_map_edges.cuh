@@ -22,6 +22,8 @@
 
 #include <dgl/runtime/c_runtime_api.h>
 #include <cuda_runtime.h>
+#include <algorithm>
+#include <vector>
 
 #include "../../../runtime/cuda/cuda_common.h"
 #include "../../../runtime/cuda/cuda_hashtable.cuh"
@@ -206,6 +208,71 @@ inline IdType RoundUp(
   return RoundUpDiv(num, unit)*unit;
 }
 
+/**
+* \brief Copy of the node counts of the hash tables to the host which does not
+* wait for the work enqueued on the stream after it.
+*
+* The counts go through a pinned buffer of the calling thread, so that the copy
+* is asynchronous. The kernels enqueued between the construction and Wait(),
+* e.g. the mapping of the edges, keep the device busy while the host waits for
+* the counts to size the graphs, instead of being launched after a
+* synchronization of the whole stream.
+*/
+class AsyncCountCopy {
+ public:
+  AsyncCountCopy(
+      const int64_t * const counts_device,
+      const int64_t num_counts,
+      cudaStream_t stream) :
+      num_counts_(num_counts) {
+    counts_host_ = PinnedBuffer(num_counts);
+    CUDA_CALL(cudaMemcpyAsync(
+        counts_host_, counts_device, num_counts*sizeof(int64_t),
+        cudaMemcpyDeviceToHost, stream));
+    CUDA_CALL(cudaEventCreateWithFlags(&event_, cudaEventDisableTiming));
+    CUDA_CALL(cudaEventRecord(event_, stream));
+  }
+
+  ~AsyncCountCopy() {
+    cudaEventDestroy(event_);
+  }
+
+  /**
+  * \brief Wait for the copy to finish.
+  *
+  * \return The counts.
+  */
+  std::vector<int64_t> Wait() {
+    CUDA_CALL(cudaEventSynchronize(event_));
+    return std::vector<int64_t>(counts_host_, counts_host_ + num_counts_);
+  }
+
+ private:
+  // The pinned buffer of the thread, grown to hold the given number of counts.
+  static int64_t * PinnedBuffer(const int64_t num_counts) {
+    struct Buffer {
+      int64_t * ptr = nullptr;
+      int64_t size = 0;
+      ~Buffer() {
+        if (ptr)
+          cudaFreeHost(ptr);
+      }
+    };
+    thread_local Buffer buffer;
+    if (buffer.size < num_counts) {
+      if (buffer.ptr)
+        CUDA_CALL(cudaFreeHost(buffer.ptr));
+      buffer.size = std::max<int64_t>(num_counts, 64);
+      CUDA_CALL(cudaMallocHost(&buffer.ptr, buffer.size*sizeof(int64_t)));
+    }
+    return buffer.ptr;
+  }
+
+  int64_t * counts_host_;
+  int64_t num_counts_;
+  cudaEvent_t event_;
+};
+
 template<typename IdType>
 std::tuple<std::vector<IdArray>, std::vector<IdArray>>
 MapEdges(
@@ -20,6 +20,7 @@
 
 
 #include <dgl/runtime/device_api.h>
+#include <dgl/runtime/stage_tracker.h>
 #include <dgl/immutable_graph.h>
 #include <cuda_runtime.h>
 #include <utility>
@@ -162,6 +163,9 @@ ToBlockGPU(
     const std::vector<IdArray> &rhs_nodes,
     const bool include_rhs_in_lhs,
     std::vector<IdArray>* const lhs_nodes_ptr) {
+  // timed on the host, the kernels being asynchronous
+  runtime::StageScope stage_scope(runtime::SamplingStage::kToBlock);
+  stage_scope.AddSeeds(rhs_nodes);
   std::vector<IdArray>& lhs_nodes = *lhs_nodes_ptr;
   const bool generate_lhs_nodes = lhs_nodes.empty();
 
@@ -280,8 +284,10 @@ ToBlockGPU(
   }
 
   // populate the mappings
+  int64_t * count_lhs_device = nullptr;
+  std::unique_ptr<AsyncCountCopy> count_lhs_copy;
   if (generate_lhs_nodes) {
-    int64_t * count_lhs_device = static_cast<int64_t*>(
+    count_lhs_device = static_cast<int64_t*>(
         device->AllocWorkspace(ctx, sizeof(int64_t)*num_ntypes*2));
 
     maker.Make(
@@ -292,18 +298,8 @@ ToBlockGPU(
         &lhs_nodes,
         stream);
 
-    device->CopyDataFromTo(
-        count_lhs_device, 0,
-        num_nodes_per_type.data(), 0,
-        sizeof(*num_nodes_per_type.data())*num_ntypes,
-        ctx,
-        DGLContext{kDLCPU, 0},
-        DGLType{kDLInt, 64, 1},
-        stream);
-    device->StreamSync(ctx, stream);
-
-    // wait for the node counts to finish transferring
-    device->FreeWorkspace(ctx, count_lhs_device);
+    // only wait for the node counts once the edges are being mapped
+    count_lhs_copy.reset(new AsyncCountCopy(count_lhs_device, num_ntypes, stream));
   } else {
     maker.Make(
         lhs_nodes,
@@ -345,6 +341,9 @@ ToBlockGPU(
 
   // resize lhs nodes
   if (generate_lhs_nodes) {
+    const std::vector<int64_t> count_lhs = count_lhs_copy->Wait();
+    std::copy(count_lhs.begin(), count_lhs.end(), num_nodes_per_type.begin());
+    device->FreeWorkspace(ctx, count_lhs_device);
     for (int64_t ntype = 0; ntype < num_ntypes; ++ntype) {
       lhs_nodes[ntype]->shape[0] = num_nodes_per_type[ntype];
     }
@@ -375,6 +374,7 @@ ToBlockGPU(
   HeteroGraphPtr new_graph = CreateHeteroGraph(
       new_meta_graph, rel_graphs, num_nodes_per_type);
 
+  stage_scope.AddEdges(induced_edges);
   // return the new graph, the new src nodes, and new edges
   return std::make_tuple(new_graph, induced_edges);
 }
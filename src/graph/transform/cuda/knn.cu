@@ -518,7 +518,7 @@ void BruteForceKNNSharedCuda(const NDArray& data_points, const IdArray& data_off
   size_t prefix_temp_size = 0;
   CUDA_CALL(cub::DeviceScan::ExclusiveSum(
     nullptr, prefix_temp_size, num_block_per_segment,
-    num_block_prefixsum, batch_size));
+    num_block_prefixsum, batch_size, thr_entry->stream));
   void* prefix_temp = device->AllocWorkspace(ctx, prefix_temp_size);
   CUDA_CALL(cub::DeviceScan::ExclusiveSum(
     prefix_temp, prefix_temp_size, num_block_per_segment,
@@ -835,13 +835,21 @@ void NNDescent(const NDArray& points, const IdArray& offsets,
                IdArray result, const int k, const int num_iters,
                const int num_candidates, const double delta) {
   auto* thr_entry = runtime::CUDAThreadEntry::ThreadLocal();
-  const auto& ctx = points->ctx;
+  const auto& ctx = result->ctx;
   auto device = runtime::DeviceAPI::Get(ctx);
   const int64_t num_nodes = points->shape[0];
   const int64_t feature_size = points->shape[1];
   const int64_t batch_size = offsets->shape[0] - 1;
   const IdType* offsets_data = offsets.Ptr<IdType>();
   const FloatType* points_data = points.Ptr<FloatType>();
+  if (points->ctx.device_type == kDLCPU) {
+    // The points are read by the kernels from pinned host memory, so that they
+    // need not fit in the memory of the GPU.
+    void* device_points = nullptr;
+    CHECK_EQ(cudaHostGetDevicePointer(&device_points, points->data, 0), cudaSuccess)
+      << "The points on CPU must be in pinned memory.";
+    points_data = static_cast<const FloatType*>(device_points);
+  }
 
   IdType* central_nodes = result.Ptr<IdType>();
   IdType* neighbors = central_nodes + k * num_nodes;
@@ -862,9 +870,9 @@ void NNDescent(const NDArray& points, const IdArray& offsets,
   IdType* num_updates = static_cast<IdType*>(
     device->AllocWorkspace(ctx, num_nodes * sizeof(IdType)));
   FloatType* distances = static_cast<FloatType*>(
-    device->AllocWorkspace(ctx, num_nodes * k * sizeof(IdType)));
+    device->AllocWorkspace(ctx, num_nodes * k * sizeof(FloatType)));
   bool* flags = static_cast<bool*>(
-    device->AllocWorkspace(ctx, num_nodes * k * sizeof(IdType)));
+    device->AllocWorkspace(ctx, num_nodes * k * sizeof(bool)));
 
   size_t sum_temp_size = 0;
   IdType total_num_updates = 0;
@@ -872,7 +880,7 @@ void NNDescent(const NDArray& points, const IdArray& offsets,
     device->AllocWorkspace(ctx, sizeof(IdType)));
 
   CUDA_CALL(cub::DeviceReduce::Sum(
-    nullptr, sum_temp_size, num_updates, total_num_updates_d, num_nodes));
+    nullptr, sum_temp_size, num_updates, total_num_updates_d, num_nodes, thr_entry->stream));
   IdType* sum_temp_storage = static_cast<IdType*>(
     device->AllocWorkspace(ctx, sum_temp_size));
 
@@ -901,11 +909,13 @@ void NNDescent(const NDArray& points, const IdArray& offsets,
 
     total_num_updates = 0;
     CUDA_CALL(cub::DeviceReduce::Sum(
-      sum_temp_storage, sum_temp_size, num_updates, total_num_updates_d, num_nodes));
+      sum_temp_storage, sum_temp_size, num_updates, total_num_updates_d, num_nodes,
+      thr_entry->stream));
     device->CopyDataFromTo(
       total_num_updates_d, 0, &total_num_updates, 0,
       sizeof(IdType), ctx, DLContext{kDLCPU, 0},
       offsets->dtype, thr_entry->stream);
+    device->StreamSync(ctx, thr_entry->stream);
 
     if (total_num_updates <= static_cast<IdType>(delta * k * num_nodes)) {
       break;
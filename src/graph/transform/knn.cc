@@ -53,10 +53,13 @@ DGL_REGISTER_GLOBAL("transform._CAPI_DGLNNDescent")
 
     aten::CheckContiguous(
       {points, offsets, result}, {"points", "offsets", "result"});
-    aten::CheckCtx(
-      points->ctx, {points, offsets, result}, {"points", "offsets", "result"});
+    aten::CheckCtx(result->ctx, {offsets, result}, {"offsets", "result"});
+    // the points of a GPU NN-descent can stay in pinned host memory
+    CHECK(points->ctx == result->ctx || points->ctx.device_type == kDLCPU)
+      << "Expected the points on " << result->ctx << " or on CPU, but got "
+      << points->ctx << ".";
 
-    ATEN_XPU_SWITCH_CUDA(points->ctx.device_type, XPU, "NNDescent", {
+    ATEN_XPU_SWITCH_CUDA(result->ctx.device_type, XPU, "NNDescent", {
       ATEN_FLOAT_TYPE_SWITCH(points->dtype, FloatType, "points", {
         ATEN_ID_TYPE_SWITCH(result->dtype, IdType, {
           NNDescent<XPU, FloatType, IdType>(
@@ -0,0 +1,272 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file graph/transform/node_order.cc
+ * \brief Locality-improving orders of the nodes of a graph
+ */
+
+#include <dgl/base_heterograph.h>
+#include <dgl/transform.h>
+#include <dgl/array.h>
+#include <dgl/packed_func_ext.h>
+#include <dgl/runtime/registry.h>
+#include <dgl/runtime/parallel_for.h>
+#include <algorithm>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../../c_api_common.h"
+
+namespace dgl {
+
+using namespace dgl::runtime;
+using namespace dgl::aten;
+
+namespace transform {
+
+namespace {
+
+/*! \brief The undirected adjacency of a graph, without the self loops. */
+struct SymmetricAdjacency {
+  std::vector<int64_t> indptr;
+  std::vector<int64_t> indices;
+
+  int64_t Degree(int64_t v) const { return indptr[v + 1] - indptr[v]; }
+};
+
+template <typename IdType>
+SymmetricAdjacency MakeSymmetric(const CSRMatrix& out_csr, const CSRMatrix& in_csr) {
+  const int64_t num_nodes = out_csr.num_rows;
+  const IdType* out_indptr = out_csr.indptr.Ptr<IdType>();
+  const IdType* out_indices = out_csr.indices.Ptr<IdType>();
+  const IdType* in_indptr = in_csr.indptr.Ptr<IdType>();
+  const IdType* in_indices = in_csr.indices.Ptr<IdType>();
+
+  SymmetricAdjacency adj;
+  adj.indptr.resize(num_nodes + 1, 0);
+  parallel_for(0, num_nodes, [&](size_t b, size_t e) {
+    for (auto v = b; v < e; ++v) {
+      int64_t deg = 0;
+      for (IdType i = out_indptr[v]; i < out_indptr[v + 1]; ++i)
+        deg += out_indices[i] != static_cast<IdType>(v);
+      for (IdType i = in_indptr[v]; i < in_indptr[v + 1]; ++i)
+        deg += in_indices[i] != static_cast<IdType>(v);
+      adj.indptr[v + 1] = deg;
+    }
+  });
+  std::partial_sum(adj.indptr.begin(), adj.indptr.end(), adj.indptr.begin());
+  adj.indices.resize(adj.indptr[num_nodes]);
+  parallel_for(0, num_nodes, [&](size_t b, size_t e) {
+    for (auto v = b; v < e; ++v) {
+      int64_t pos = adj.indptr[v];
+      for (IdType i = out_indptr[v]; i < out_indptr[v + 1]; ++i) {
+        if (out_indices[i] != static_cast<IdType>(v))
+          adj.indices[pos++] = out_indices[i];
+      }
+      for (IdType i = in_indptr[v]; i < in_indptr[v + 1]; ++i) {
+        if (in_indices[i] != static_cast<IdType>(v))
+          adj.indices[pos++] = in_indices[i];
+      }
+    }
+  });
+  return adj;
+}
+
+/*! \brief The nodes by decreasing degree, and by ID among equal degrees. */
+std::vector<int64_t> DegreeOrder(const SymmetricAdjacency& adj) {
+  const int64_t num_nodes = adj.indptr.size() - 1;
+  std::vector<int64_t> order(num_nodes);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&adj] (int64_t a, int64_t b) {
+      return adj.Degree(a) > adj.Degree(b);
+    });
+  return order;
+}
+
+/*! \brief The nodes by increasing degree, and by ID among equal degrees. */
+std::vector<int64_t> IncreasingDegreeOrder(const SymmetricAdjacency& adj) {
+  const int64_t num_nodes = adj.indptr.size() - 1;
+  std::vector<int64_t> order(num_nodes);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&adj] (int64_t a, int64_t b) {
+      return adj.Degree(a) < adj.Degree(b);
+    });
+  return order;
+}
+
+/*! \brief The reverse Cuthill-McKee order. */
+std::vector<int64_t> RCMOrder(SymmetricAdjacency adj) {
+  const int64_t num_nodes = adj.indptr.size() - 1;
+  std::vector<int64_t> degree(num_nodes);
+  for (int64_t v = 0; v < num_nodes; ++v)
+    degree[v] = adj.Degree(v);
+  // the neighbors of every node in the order they are visited in
+  parallel_for(0, num_nodes, [&](size_t b, size_t e) {
+    for (auto v = b; v < e; ++v) {
+      std::sort(adj.indices.begin() + adj.indptr[v], adj.indices.begin() + adj.indptr[v + 1],
+                [&degree] (int64_t x, int64_t y) {
+                  return degree[x] < degree[y] || (degree[x] == degree[y] && x < y);
+                });
+    }
+  });
+  std::vector<int64_t> order;
+  order.reserve(num_nodes);
+  std::vector<bool> visited(num_nodes, false);
+  // the start of every component is its first node by increasing degree
+  for (const int64_t start : IncreasingDegreeOrder(adj)) {
+    if (visited[start])
+      continue;
+    visited[start] = true;
+    // the order is the queue of the breadth-first search
+    size_t head = order.size();
+    order.push_back(start);
+    for (; head < order.size(); ++head) {
+      const int64_t v = order[head];
+      for (int64_t i = adj.indptr[v]; i < adj.indptr[v + 1]; ++i) {
+        const int64_t u = adj.indices[i];
+        if (!visited[u]) {
+          visited[u] = true;
+          order.push_back(u);
+        }
+      }
+    }
+  }
+  std::reverse(order.begin(), order.end());
+  return order;
+}
+
+/*! \brief The Rabbit order. */
+std::vector<int64_t> RabbitOrder(const SymmetricAdjacency& adj) {
+  const int64_t num_nodes = adj.indptr.size() - 1;
+  // twice the number of undirected edges
+  const double two_m = adj.indices.size();
+  // the edges to the other communities and the degree of every community,
+  // kept by its root, the last node it was merged into
+  std::vector<std::vector<std::pair<int64_t, int64_t>>> edges(num_nodes);
+  std::vector<int64_t> degree(num_nodes);
+  std::vector<int64_t> parent(num_nodes);
+  std::vector<int64_t> size(num_nodes, 1);
+  std::vector<std::vector<int64_t>> children(num_nodes);
+  parallel_for(0, num_nodes, [&](size_t b, size_t e) {
+    for (auto v = b; v < e; ++v) {
+      for (int64_t i = adj.indptr[v]; i < adj.indptr[v + 1]; ++i)
+        edges[v].emplace_back(adj.indices[i], 1);
+      degree[v] = adj.Degree(v);
+      parent[v] = v;
+    }
+  });
+  auto find_root = [&parent] (int64_t v) {
+    int64_t root = v;
+    while (parent[root] != root)
+      root = parent[root];
+    while (parent[v] != root) {
+      const int64_t next = parent[v];
+      parent[v] = root;
+      v = next;
+    }
+    return root;
+  };
+
+  // the weight of the edges from the community being merged to every other one
+  std::vector<int64_t> weight(num_nodes, 0);
+  std::vector<int64_t> neighbors;
+  for (const int64_t u : IncreasingDegreeOrder(adj)) {
+    neighbors.clear();
+    for (const auto& edge : edges[u]) {
+      const int64_t r = find_root(edge.first);
+      if (r == u)
+        continue;
+      if (weight[r] == 0)
+        neighbors.push_back(r);
+      weight[r] += edge.second;
+    }
+    std::sort(neighbors.begin(), neighbors.end());
+    // the modularity gain of merging u into v is proportional to
+    // w(u, v) - d(u) * d(v) / 2m
+    int64_t best = -1;
+    double best_gain = 0;
+    edges[u].clear();
+    for (const int64_t v : neighbors) {
+      const double gain = weight[v] - static_cast<double>(degree[u]) * degree[v] / two_m;
+      if (gain > best_gain) {
+        best = v;
+        best_gain = gain;
+      }
+      edges[u].emplace_back(v, weight[v]);
+      weight[v] = 0;
+    }
+    if (best < 0) {
+      edges[u].shrink_to_fit();
+      continue;
+    }
+    parent[u] = best;
+    degree[best] += degree[u];
+    size[best] += size[u];
+    children[best].push_back(u);
+    edges[best].insert(edges[best].end(), edges[u].begin(), edges[u].end());
+    std::vector<std::pair<int64_t, int64_t>>().swap(edges[u]);
+  }
+
+  // every community is laid out by a depth-first order of its merges, from its
+  // root, the communities being ordered by their roots
+  std::vector<int64_t> roots;
+  std::vector<int64_t> offsets = {0};
+  for (int64_t v = 0; v < num_nodes; ++v) {
+    if (parent[v] == v) {
+      roots.push_back(v);
+      offsets.push_back(offsets.back() + size[v]);
+    }
+  }
+  std::vector<int64_t> order(num_nodes);
+  parallel_for(0, roots.size(), [&](size_t b, size_t e) {
+    std::vector<int64_t> stack;
+    for (auto i = b; i < e; ++i) {
+      int64_t pos = offsets[i];
+      stack.push_back(roots[i]);
+      while (!stack.empty()) {
+        const int64_t v = stack.back();
+        stack.pop_back();
+        order[pos++] = v;
+        // the children merged first are visited first
+        stack.insert(stack.end(), children[v].rbegin(), children[v].rend());
+      }
+    }
+  });
+  return order;
+}
+
+}  // namespace
+
+IdArray NodeOrder(const HeteroGraphPtr graph, const std::string &algorithm) {
+  CHECK(algorithm == "rcmk" || algorithm == "degree" || algorithm == "rabbit")
+    << "algorithm can only be \"rcmk\", \"degree\" or \"rabbit\"";
+  CHECK_EQ(graph->NumEdgeTypes(), 1) << "Only homogeneous graphs can be ordered.";
+  CHECK_EQ(graph->NumVertexTypes(), 1) << "Only homogeneous graphs can be ordered.";
+  CHECK_EQ(graph->Context().device_type, kDLCPU) << "The graph must be on CPU.";
+  const CSRMatrix out_csr = graph->GetCSRMatrix(0);
+  const CSRMatrix in_csr = graph->GetCSCMatrix(0);
+  SymmetricAdjacency adj;
+  ATEN_ID_TYPE_SWITCH(out_csr.indptr->dtype, IdType, {
+    adj = MakeSymmetric<IdType>(out_csr, in_csr);
+  });
+
+  std::vector<int64_t> order;
+  if (algorithm == "rcmk")
+    order = RCMOrder(std::move(adj));
+  else if (algorithm == "degree")
+    order = DegreeOrder(adj);
+  else
+    order = RabbitOrder(adj);
+  return AsNumBits(VecToIdArray(order, 64), graph->NumBits());
+}
+
+DGL_REGISTER_GLOBAL("transform._CAPI_DGLNodeOrder")
+.set_body([] (DGLArgs args, DGLRetValue *rv) {
+    const HeteroGraphRef graph_ref = args[0];
+    const std::string algorithm = args[1];
+    *rv = NodeOrder(graph_ref.sptr(), algorithm);
+  });
+
+};  // namespace transform
+
+};  // namespace dgl
@@ -7,23 +7,18 @@
 #include <dgl/base_heterograph.h>
 #include <dgl/packed_func_ext.h>
 #include <dgl/runtime/parallel_for.h>
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "../heterograph.h"
 #include "../unit_graph.h"
 
-#if !defined(_WIN32)
-#include <GKlib.h>
-#endif  // !defined(_WIN32)
-
 using namespace dgl::runtime;
 
 namespace dgl {
 
-#if !defined(_WIN32)
-gk_csr_t *Convert2GKCsr(const aten::CSRMatrix mat, bool is_row);
-aten::CSRMatrix Convert2DGLCsr(gk_csr_t *gk_csr, bool is_row);
-#endif  // !defined(_WIN32)
-
 namespace transform {
 
 class HaloHeteroSubgraph : public HeteroSubgraph {
@@ -49,147 +44,131 @@ HeteroGraphPtr ReorderUnitGraph(UnitGraphPtr ug, IdArray new_order) {
   }
 }
 
-HaloHeteroSubgraph GetSubgraphWithHalo(std::shared_ptr<HeteroGraph> hg,
-                                       IdArray nodes, int num_hops) {
-  CHECK_EQ(hg->NumBits(), 64) << "halo subgraph only supports 64bits graph";
-  CHECK_EQ(hg->relation_graphs().size(), 1)
-    << "halo subgraph only supports homogeneous graph";
-  CHECK_EQ(nodes->dtype.bits, 64)
-    << "halo subgraph only supports 64bits nodes tensor";
-  const dgl_id_t *nid = static_cast<dgl_id_t *>(nodes->data);
-  const auto id_len = nodes->shape[0];
-  // A map contains all nodes in the subgraph.
-  // The key is the old node Ids, the value indicates whether a node is a inner
-  // node.
-  std::unordered_map<dgl_id_t, bool> all_nodes;
-  // The old Ids of all nodes. We want to preserve the order of the nodes in the
-  // vector. The first few nodes are the inner nodes in the subgraph.
-  std::vector<dgl_id_t> old_node_ids(nid, nid + id_len);
-  std::vector<std::vector<dgl_id_t>> outer_nodes(num_hops);
-  for (int64_t i = 0; i < id_len; i++) all_nodes[nid[i]] = true;
-  auto orig_nodes = all_nodes;
+/*!
+ * \brief Get the subgraph of a partition with its halo nodes up to num_hops hops
+ *        away along the in-edges, and the out-edges of its nodes.
+ *
+ * The inner nodes come first, in the order given. The partition of every node and
+ * the position of every node in its partition are shared by all the partitions,
+ * so only the halo nodes of a partition are hashed, and the edges are read from
+ * the in-CSR and the out-CSR of the graph directly. The nodes and the edges are
+ * in the same order as when expanding with InEdges and OutEdges.
+ *
+ * \param hg The graph.
+ * \param in_csr The in-CSR of the graph, with the edge IDs as data.
+ * \param out_csr The out-CSR of the graph, with the edge IDs as data.
+ * \param nodes The nodes of the partition.
+ * \param part_id The partition.
+ * \param part_data The partition of every node.
+ * \param local_ids The position of every node in its partition.
+ * \param num_hops The number of hops of the halo.
+ */
+HaloHeteroSubgraph GetPartitionWithHalo(std::shared_ptr<HeteroGraph> hg,
+                                        const aten::CSRMatrix &in_csr,
+                                        const aten::CSRMatrix &out_csr,
+                                        const std::vector<int64_t> &nodes, int64_t part_id,
+                                        const int64_t *part_data,
+                                        const std::vector<int64_t> &local_ids, int num_hops) {
+  const int64_t *in_indptr = in_csr.indptr.Ptr<int64_t>();
+  const int64_t *in_indices = in_csr.indices.Ptr<int64_t>();
+  const int64_t *in_eids = aten::CSRHasData(in_csr) ? in_csr.data.Ptr<int64_t>() : nullptr;
+  const int64_t *out_indptr = out_csr.indptr.Ptr<int64_t>();
+  const int64_t *out_indices = out_csr.indices.Ptr<int64_t>();
+  const int64_t *out_eids = aten::CSRHasData(out_csr) ? out_csr.data.Ptr<int64_t>() : nullptr;
+  const int64_t num_inner = nodes.size();
 
-  std::vector<dgl_id_t> edge_src, edge_dst, edge_eid;
+  // The new Ids of the halo nodes, behind the inner nodes.
+  std::unordered_map<int64_t, int64_t> halo_ids;
+  std::vector<int64_t> halo_nodes;
+  auto is_inner = [&] (int64_t v) { return part_data[v] == part_id; };
+  auto add_halo = [&] (int64_t v) {
+    if (is_inner(v) || !halo_ids.emplace(v, num_inner + halo_nodes.size()).second)
+      return false;
+    halo_nodes.push_back(v);
+    return true;
+  };
+  auto new_id = [&] (int64_t v) {
+    return is_inner(v) ? local_ids[v] : halo_ids.find(v)->second;
+  };
 
-  // When we deal with in-edges, we need to do two things:
-  // * find the edges inside the partition and the edges between partitions.
-  // * find the nodes outside the partition that connect the partition.
-  EdgeArray in_edges = hg->InEdges(0, nodes);
-  auto src = in_edges.src;
-  auto dst = in_edges.dst;
-  auto eid = in_edges.id;
-  auto num_edges = eid->shape[0];
-  const dgl_id_t *src_data = static_cast<dgl_id_t *>(src->data);
-  const dgl_id_t *dst_data = static_cast<dgl_id_t *>(dst->data);
-  const dgl_id_t *eid_data = static_cast<dgl_id_t *>(eid->data);
-  for (int64_t i = 0; i < num_edges; i++) {
-    // We check if the source node is in the original node.
-    auto it1 = orig_nodes.find(src_data[i]);
-    if (it1 != orig_nodes.end() || num_hops > 0) {
-      edge_src.push_back(src_data[i]);
-      edge_dst.push_back(dst_data[i]);
-      edge_eid.push_back(eid_data[i]);
-    }
-    // We need to expand only if the node hasn't been seen before.
-    auto it = all_nodes.find(src_data[i]);
-    if (it == all_nodes.end() && num_hops > 0) {
-      all_nodes[src_data[i]] = false;
-      old_node_ids.push_back(src_data[i]);
-      outer_nodes[0].push_back(src_data[i]);
+  std::vector<int64_t> edge_src, edge_dst, edge_eid;
+  // The in-edges of the inner nodes, inside the partition or from the nodes one
+  // hop away.
+  for (const int64_t v : nodes) {
+    for (int64_t j = in_indptr[v]; j < in_indptr[v + 1]; ++j) {
+      const int64_t u = in_indices[j];
+      if (num_hops == 0 && !is_inner(u))
+        continue;
+      if (num_hops > 0)
+        add_halo(u);
+      edge_src.push_back(u);
+      edge_dst.push_back(v);
+      edge_eid.push_back(in_eids ? in_eids[j] : j);
     }
   }
-
-  // Now we need to traverse the graph with the in-edges to access nodes
-  // and edges more hops away.
+  // The in-edges of the halo nodes of every hop from the outside of the partition;
+  // the ones from the inner nodes are out-edges of the partition.
+  size_t hop_begin = 0;
   for (int k = 1; k < num_hops; k++) {
-    const std::vector<dgl_id_t> &nodes = outer_nodes[k - 1];
-    EdgeArray in_edges = hg->InEdges(0, aten::VecToIdArray(nodes));
-    auto src = in_edges.src;
-    auto dst = in_edges.dst;
-    auto eid = in_edges.id;
-    auto num_edges = eid->shape[0];
-    const dgl_id_t *src_data = static_cast<dgl_id_t *>(src->data);
-    const dgl_id_t *dst_data = static_cast<dgl_id_t *>(dst->data);
-    const dgl_id_t *eid_data = static_cast<dgl_id_t *>(eid->data);
-    for (int64_t i = 0; i < num_edges; i++) {
-      auto it1 = orig_nodes.find(src_data[i]);
-      // If the source node is in the partition, we have got this edge when we iterate over
-      // the out-edges above.
-      if (it1 == orig_nodes.end()) {
-        edge_src.push_back(src_data[i]);
-        edge_dst.push_back(dst_data[i]);
-        edge_eid.push_back(eid_data[i]);
-      }
-      // If we haven't seen this node.
-      auto it = all_nodes.find(src_data[i]);
-      if (it == all_nodes.end()) {
-        all_nodes[src_data[i]] = false;
-        old_node_ids.push_back(src_data[i]);
-        outer_nodes[k].push_back(src_data[i]);
+    const size_t hop_end = halo_nodes.size();
+    for (size_t i = hop_begin; i < hop_end; ++i) {
+      const int64_t v = halo_nodes[i];
+      for (int64_t j = in_indptr[v]; j < in_indptr[v + 1]; ++j) {
+        const int64_t u = in_indices[j];
+        if (is_inner(u))
+          continue;
+        add_halo(u);
+        edge_src.push_back(u);
+        edge_dst.push_back(v);
+        edge_eid.push_back(in_eids ? in_eids[j] : j);
       }
     }
+    hop_begin = hop_end;
   }
-
+  // The out-edges of the inner nodes to the outside of the partition. We don't
+  // expand along the out-edges.
   if (num_hops > 0) {
-    EdgeArray out_edges = hg->OutEdges(0, nodes);
-    auto src = out_edges.src;
-    auto dst = out_edges.dst;
-    auto eid = out_edges.id;
-    auto num_edges = eid->shape[0];
-    const dgl_id_t *src_data = static_cast<dgl_id_t *>(src->data);
-    const dgl_id_t *dst_data = static_cast<dgl_id_t *>(dst->data);
-    const dgl_id_t *eid_data = static_cast<dgl_id_t *>(eid->data);
-    for (int64_t i = 0; i < num_edges; i++) {
-      // If the outer edge isn't in the partition.
-      auto it1 = orig_nodes.find(dst_data[i]);
-      if (it1 == orig_nodes.end()) {
-        edge_src.push_back(src_data[i]);
-        edge_dst.push_back(dst_data[i]);
-        edge_eid.push_back(eid_data[i]);
-      }
-      // We don't expand along the out-edges.
-      auto it = all_nodes.find(dst_data[i]);
-      if (it == all_nodes.end()) {
-        all_nodes[dst_data[i]] = false;
-        old_node_ids.push_back(dst_data[i]);
+    for (const int64_t u : nodes) {
+      for (int64_t j = out_indptr[u]; j < out_indptr[u + 1]; ++j) {
+        const int64_t v = out_indices[j];
+        if (is_inner(v))
+          continue;
+        add_halo(v);
+        edge_src.push_back(u);
+        edge_dst.push_back(v);
+        edge_eid.push_back(out_eids ? out_eids[j] : j);
       }
     }
   }
 
-  // We assign new Ids to the nodes in the subgraph. We ensure that the HALO
-  // nodes are behind the input nodes.
-  std::unordered_map<dgl_id_t, dgl_id_t> old2new;
-  for (size_t i = 0; i < old_node_ids.size(); i++) {
-    old2new[old_node_ids[i]] = i;
-  }
-
-  num_edges = edge_src.size();
-  IdArray new_src = IdArray::Empty({num_edges}, DLDataType{kDLInt, 64, 1},
-                                   DLContext{kDLCPU, 0});
-  IdArray new_dst = IdArray::Empty({num_edges}, DLDataType{kDLInt, 64, 1},
-                                   DLContext{kDLCPU, 0});
-  dgl_id_t *new_src_data = static_cast<dgl_id_t *>(new_src->data);
-  dgl_id_t *new_dst_data = static_cast<dgl_id_t *>(new_dst->data);
-  for (size_t i = 0; i < edge_src.size(); i++) {
-    new_src_data[i] = old2new[edge_src[i]];
-    new_dst_data[i] = old2new[edge_dst[i]];
+  const int64_t num_subg_nodes = num_inner + halo_nodes.size();
+  const int64_t num_edges = edge_src.size();
+  IdArray induced_nodes = aten::NewIdArray(num_subg_nodes);
+  IdArray new_src = aten::NewIdArray(num_edges);
+  IdArray new_dst = aten::NewIdArray(num_edges);
+  // TODO(zhengda) we need to switch to 8 bytes afterwards.
+  IdArray inner_nodes = aten::NewIdArray(num_subg_nodes, DLContext{kDLCPU, 0}, 32);
+  int64_t *induced_data = induced_nodes.Ptr<int64_t>();
+  int *inner_data = inner_nodes.Ptr<int>();
+  std::copy(nodes.begin(), nodes.end(), induced_data);
+  std::copy(halo_nodes.begin(), halo_nodes.end(), induced_data + num_inner);
+  std::fill(inner_data, inner_data + num_inner, 1);
+  std::fill(inner_data + num_inner, inner_data + num_subg_nodes, 0);
+  int64_t *new_src_data = new_src.Ptr<int64_t>();
+  int64_t *new_dst_data = new_dst.Ptr<int64_t>();
+  for (int64_t i = 0; i < num_edges; i++) {
+    new_src_data[i] = new_id(edge_src[i]);
+    new_dst_data[i] = new_id(edge_dst[i]);
   }
 
-  std::vector<int> inner_nodes(old_node_ids.size());
-  for (size_t i = 0; i < old_node_ids.size(); i++) {
-    dgl_id_t old_nid = old_node_ids[i];
-    inner_nodes[i] = all_nodes[old_nid];
-  }
-  aten::COOMatrix coo(old_node_ids.size(), old_node_ids.size(), new_src,
-                      new_dst);
+  aten::COOMatrix coo(num_subg_nodes, num_subg_nodes, new_src, new_dst);
   HeteroGraphPtr ugptr = UnitGraph::CreateFromCOO(1, coo);
   HeteroGraphPtr subg = CreateHeteroGraph(hg->meta_graph(), {ugptr});
   HaloHeteroSubgraph halo_subg;
   halo_subg.graph = subg;
-  halo_subg.induced_vertices = {aten::VecToIdArray(old_node_ids)};
+  halo_subg.induced_vertices = {induced_nodes};
   halo_subg.induced_edges = {aten::VecToIdArray(edge_eid)};
-  // TODO(zhengda) we need to switch to 8 bytes afterwards.
-  halo_subg.inner_nodes = {aten::VecToIdArray<int>(inner_nodes, 32)};
+  halo_subg.inner_nodes = {inner_nodes};
   return halo_subg;
 }
 
@@ -223,44 +202,40 @@ DGL_REGISTER_GLOBAL("partition._CAPI_DGLPartitionWithHalo_Hetero")
     CHECK_EQ(node_parts->dtype.bits, 64)
       << "Only supports 64bits tensor for now";
 
+    CHECK_EQ(hgptr->NumBits(), 64) << "halo subgraph only supports 64bits graph";
     const int64_t *part_data = static_cast<int64_t *>(node_parts->data);
     int64_t num_nodes = node_parts->shape[0];
-    std::unordered_map<int, std::vector<int64_t>> part_map;
-    for (int64_t i = 0; i < num_nodes; i++) {
-      dgl_id_t part_id = part_data[i];
-      auto it = part_map.find(part_id);
-      if (it == part_map.end()) {
-        std::vector<int64_t> vec;
-        vec.push_back(i);
-        part_map[part_id] = vec;
-      } else {
-        it->second.push_back(i);
-      }
-    }
+    // The nodes of every partition in increasing order, and the position of every
+    // node in its partition.
+    std::unordered_map<int64_t, int> part_index;
     std::vector<int> part_ids;
     std::vector<std::vector<int64_t>> part_nodes;
+    std::vector<int64_t> local_ids(num_nodes);
     int max_part_id = 0;
-    for (auto it = part_map.begin(); it != part_map.end(); it++) {
-      max_part_id = std::max(it->first, max_part_id);
-      part_ids.push_back(it->first);
-      part_nodes.push_back(it->second);
+    for (int64_t i = 0; i < num_nodes; i++) {
+      auto it = part_index.emplace(part_data[i], part_ids.size()).first;
+      if (it->second == static_cast<int>(part_ids.size())) {
+        part_ids.push_back(part_data[i]);
+        part_nodes.emplace_back();
+        max_part_id = std::max<int>(part_data[i], max_part_id);
+      }
+      local_ids[i] = part_nodes[it->second].size();
+      part_nodes[it->second].push_back(i);
     }
     // When we construct subgraphs, we need to access both in-edges and out-edges.
     // We need to make sure the in-CSR and out-CSR exist. Otherwise, we'll
     // try to construct in-CSR and out-CSR in openmp for loop, which will lead
     // to some unexpected results.
-    ugptr->GetInCSR();
-    ugptr->GetOutCSR();
+    const aten::CSRMatrix in_csr = ugptr->GetCSCMatrix(0);
+    const aten::CSRMatrix out_csr = ugptr->GetCSRMatrix(0);
     std::vector<std::shared_ptr<HaloHeteroSubgraph>> subgs(max_part_id + 1);
     int num_partitions = part_nodes.size();
-    runtime::parallel_for(0, num_partitions, [&](int b, int e) {
+    // one partition at a time per thread, as their sizes differ
+    runtime::parallel_for(0, num_partitions, 1, [&](int b, int e) {
       for (auto i = b; i < e; i++) {
-        auto nodes = aten::VecToIdArray(part_nodes[i]);
-        HaloHeteroSubgraph subg = GetSubgraphWithHalo(hgptr, nodes, num_hops);
-        std::shared_ptr<HaloHeteroSubgraph> subg_ptr(
-          new HaloHeteroSubgraph(subg));
         int part_id = part_ids[i];
-        subgs[part_id] = subg_ptr;
+        subgs[part_id] = std::make_shared<HaloHeteroSubgraph>(GetPartitionWithHalo(
+            hgptr, in_csr, out_csr, part_nodes[i], part_id, part_data, local_ids, num_hops));
       }
     });
     List<HeteroSubgraphRef> ret_list;
@@ -355,22 +330,15 @@ DGL_REGISTER_GLOBAL("partition._CAPI_DGLMakeSymmetric_Hetero")
       << "Metis partition only supports homogeneous graph";
     auto ugptr = hgptr->relation_graphs()[0];
 
-#if !defined(_WIN32)
     // TODO(zhengda) should we get whatever CSR exists in the graph.
-    gk_csr_t *gk_csr = Convert2GKCsr(ugptr->GetCSCMatrix(0), true);
-    gk_csr_t *sym_gk_csr = gk_csr_MakeSymmetric(gk_csr, GK_CSR_SYM_SUM);
-    auto mat = Convert2DGLCsr(sym_gk_csr, true);
-    gk_csr_Free(&gk_csr);
-    gk_csr_Free(&sym_gk_csr);
+    auto mat = aten::CSRMakeSymmetric(ugptr->GetCSCMatrix(0));
+    mat.data = aten::Range(0, mat.indices->shape[0], mat.indptr->dtype.bits, mat.indptr->ctx);
 
     auto new_ugptr = UnitGraph::CreateFromCSC(ugptr->NumVertexTypes(), mat,
                                               ugptr->GetAllowedFormats());
     std::vector<HeteroGraphPtr> rel_graphs = {new_ugptr};
     *rv = HeteroGraphRef(std::make_shared<HeteroGraph>(
       hgptr->meta_graph(), rel_graphs, hgptr->NumVerticesPerType()));
-#else
-    LOG(FATAL) << "The fast version of making symmetric graph is not supported in Windows.";
-#endif  // !defined(_WIN32)
   });
 
 }  // namespace transform
@@ -13,6 +13,8 @@
 #include <vector>
 #include <utility>
 #include <tuple>
+#include "../heterograph.h"
+#include "../unit_graph.h"
 
 namespace dgl {
 
@@ -23,45 +25,20 @@ namespace transform {
 
 std::pair<HeteroGraphPtr, std::vector<IdArray>>
 RemoveEdges(const HeteroGraphPtr graph, const std::vector<IdArray> &eids) {
-  std::vector<IdArray> induced_eids;
-  std::vector<HeteroGraphPtr> rel_graphs;
   const int64_t num_etypes = graph->NumEdgeTypes();
+  const auto &ugs = std::dynamic_pointer_cast<HeteroGraph>(graph)->relation_graphs();
+  std::vector<IdArray> induced_eids(num_etypes);
+  std::vector<HeteroGraphPtr> rel_graphs(num_etypes);
 
   for (int64_t etype = 0; etype < num_etypes; ++etype) {
-    const SparseFormat fmt = graph->SelectFormat(etype, COO_CODE);
-    const auto src_dst_types = graph->GetEndpointTypes(etype);
-    const dgl_type_t srctype = src_dst_types.first;
-    const dgl_type_t dsttype = src_dst_types.second;
-    const int num_ntypes_rel = (srctype == dsttype) ? 1 : 2;
-    HeteroGraphPtr new_rel_graph;
-    IdArray induced_eids_rel;
-
-    if (fmt == SparseFormat::kCOO) {
-      const COOMatrix &coo = graph->GetCOOMatrix(etype);
-      const COOMatrix &result = COORemove(coo, eids[etype]);
-      new_rel_graph = CreateFromCOO(
-          num_ntypes_rel, result.num_rows, result.num_cols, result.row, result.col);
-      induced_eids_rel = result.data;
-    } else if (fmt == SparseFormat::kCSR) {
-      const CSRMatrix &csr = graph->GetCSRMatrix(etype);
-      const CSRMatrix &result = CSRRemove(csr, eids[etype]);
-      new_rel_graph = CreateFromCSR(
-          num_ntypes_rel, result.num_rows, result.num_cols, result.indptr, result.indices,
-          // TODO(BarclayII): make CSR support null eid array
-          Range(0, result.indices->shape[0], result.indices->dtype.bits, result.indices->ctx));
-      induced_eids_rel = result.data;
-    } else if (fmt == SparseFormat::kCSC) {
-      const CSRMatrix &csc = graph->GetCSCMatrix(etype);
-      const CSRMatrix &result = CSRRemove(csc, eids[etype]);
-      new_rel_graph = CreateFromCSC(
-          num_ntypes_rel, result.num_rows, result.num_cols, result.indptr, result.indices,
-          // TODO(BarclayII): make CSR support null eid array
-          Range(0, result.indices->shape[0], result.indices->dtype.bits, result.indices->ctx));
-      induced_eids_rel = result.data;
+    if (eids[etype]->shape[0] == 0) {
+      // the relation graph is shared with its formats
+      rel_graphs[etype] = ugs[etype];
+      induced_eids[etype] = Range(
+          0, ugs[etype]->NumEdges(0), ugs[etype]->NumBits(), ugs[etype]->Context());
+    } else {
+      std::tie(rel_graphs[etype], induced_eids[etype]) = ugs[etype]->RemoveEdges(eids[etype]);
     }
-
-    rel_graphs.push_back(new_rel_graph);
-    induced_eids.push_back(induced_eids_rel);
   }
 
   const HeteroGraphPtr new_graph = CreateHeteroGraph(
@@ -69,7 +46,7 @@ RemoveEdges(const HeteroGraphPtr graph, const std::vector<IdArray> &eids) {
   return std::make_pair(new_graph, induced_eids);
 }
 
-DGL_REGISTER_GLOBAL("transform._CAPI_DGLRemoveEdges")
+DGL_REGISTER_GLOBAL("heterograph._CAPI_DGLRemoveEdges")
 .set_body([] (DGLArgs args, DGLRetValue *rv) {
     const HeteroGraphRef graph_ref = args[0];
     const std::vector<IdArray> &eids = ListValueToVector<IdArray>(args[1]);
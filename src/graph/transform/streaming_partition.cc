@@ -0,0 +1,244 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file graph/transform/streaming_partition.cc
+ * \brief Partition the nodes of a graph from edges given by chunks
+ */
+#include "streaming_partition.h"
+
+#include <dgl/packed_func_ext.h>
+#include <dgl/runtime/parallel_for.h>
+#include <dgl/runtime/registry.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../../c_api_common.h"
+
+using namespace dgl::runtime;
+
+namespace dgl {
+namespace transform {
+
+namespace {
+// the exponent of the load penalty of Fennel
+constexpr double kFennelGamma = 1.5;
+}  // namespace
+
+StreamingPartitioner::StreamingPartitioner(
+    int64_t num_nodes, int num_parts, const std::string& algorithm, NDArray vwgt,
+    double imbalance, int64_t batch_size)
+  : num_nodes_(num_nodes), num_parts_(num_parts), batch_size_(batch_size),
+    parts_(num_nodes, -1) {
+  CHECK(algorithm == "ldg" || algorithm == "fennel")
+    << "algorithm can only be \"ldg\" or \"fennel\"";
+  CHECK_GT(num_parts, 0) << "The number of parts must be positive.";
+  CHECK_GE(imbalance, 1.0) << "The imbalance must be at least 1.";
+  CHECK_GT(batch_size, 0) << "The batch size must be positive.";
+  fennel_ = algorithm == "fennel";
+  capacity_ = imbalance * num_nodes / num_parts;
+
+  const int64_t vwgt_len = aten::IsNullArray(vwgt) ? 0 : vwgt->shape[0];
+  if (vwgt_len > 0) {
+    CHECK_INT64(vwgt, "vwgt");
+    CHECK(num_nodes > 0 && vwgt_len % num_nodes == 0)
+      << "The vertex weight array doesn't have right number of elements";
+    ncon_ = vwgt_len / num_nodes;
+    vwgt = vwgt.CopyTo(DLContext{kDLCPU, 0});
+    vwgt_.assign(vwgt.Ptr<int64_t>(), vwgt.Ptr<int64_t>() + vwgt_len);
+  }
+  // the weights in nodes, so that the weights of all the nodes sum to n for
+  // every constraint
+  scale_.assign(ncon_, 1.0);
+  for (int c = 0; c < ncon_ && !vwgt_.empty(); ++c) {
+    int64_t total = 0;
+    for (int64_t v = 0; v < num_nodes; ++v) {
+      CHECK_GE(vwgt_[v * ncon_ + c], 0) << "The vertex weights must be non-negative.";
+      total += vwgt_[v * ncon_ + c];
+    }
+    scale_[c] = total > 0 ? static_cast<double>(num_nodes) / total : 0.0;
+  }
+  loads_.assign(static_cast<size_t>(num_parts) * ncon_, 0.0);
+  max_loads_.assign(num_parts, 0.0);
+  for (int p = 0; p < num_parts; ++p)
+    by_load_.emplace(0.0, p);
+}
+
+double StreamingPartitioner::LoadWith(int p, int64_t v) const {
+  double load = 0.0;
+  for (int c = 0; c < ncon_; ++c) {
+    const double weight = vwgt_.empty() ? 1.0 : vwgt_[v * ncon_ + c] * scale_[c];
+    load = std::max(load, loads_[p * ncon_ + c] + weight);
+  }
+  return load;
+}
+
+void StreamingPartitioner::Assign(
+    int64_t v, const std::vector<std::pair<int, int64_t>>& counts) {
+  const double alpha = std::sqrt(static_cast<double>(num_parts_)) * num_edges_ /
+    std::pow(static_cast<double>(num_nodes_), 1.5);
+  auto score = [&](int p, int64_t count) {
+    const double load = max_loads_[p];
+    return fennel_ ?
+      count - alpha * kFennelGamma * std::pow(load, kFennelGamma - 1) :
+      count * (1.0 - load / capacity_);
+  };
+  // the best score, then the lowest load, then the lowest part
+  int best = -1;
+  double best_score = -std::numeric_limits<double>::infinity();
+  auto consider = [&](int p, int64_t count) {
+    const double s = score(p, count);
+    if (best < 0 || s > best_score ||
+        (s == best_score && std::make_pair(max_loads_[p], p) <
+                            std::make_pair(max_loads_[best], best))) {
+      best = p;
+      best_score = s;
+    }
+  };
+  for (const auto& pc : counts) {
+    if (LoadWith(pc.first, v) <= capacity_)
+      consider(pc.first, pc.second);
+  }
+  // of the parts without neighbors, the least loaded one has the best score
+  for (const auto& lp : by_load_) {
+    const int p = lp.second;
+    const bool has_neighbors = std::any_of(counts.begin(), counts.end(),
+        [p] (const std::pair<int, int64_t>& pc) { return pc.first == p; });
+    if (!has_neighbors && LoadWith(p, v) <= capacity_) {
+      consider(p, 0);
+      break;
+    }
+  }
+  if (best < 0) {
+    // every part is full, e.g. with heavy nodes
+    best = by_load_.begin()->second;
+  }
+
+  by_load_.erase(std::make_pair(max_loads_[best], best));
+  for (int c = 0; c < ncon_; ++c)
+    loads_[best * ncon_ + c] += vwgt_.empty() ? 1.0 : vwgt_[v * ncon_ + c] * scale_[c];
+  max_loads_[best] = *std::max_element(loads_.begin() + best * ncon_,
+                                       loads_.begin() + (best + 1) * ncon_);
+  by_load_.emplace(max_loads_[best], best);
+  parts_[v] = best;
+}
+
+template <typename IdType>
+void StreamingPartitioner::AddEdgesImpl(IdArray src, IdArray dst) {
+  const int64_t num_edges = src->shape[0];
+  const IdType* src_data = src.Ptr<IdType>();
+  const IdType* dst_data = dst.Ptr<IdType>();
+
+  // both directions of every edge, grouped by their first node
+  std::vector<std::pair<int64_t, int64_t>> adj;
+  adj.reserve(2 * num_edges);
+  for (int64_t e = 0; e < num_edges; ++e) {
+    const int64_t u = src_data[e];
+    const int64_t v = dst_data[e];
+    CHECK(u >= 0 && u < num_nodes_ && v >= 0 && v < num_nodes_)
+      << "Invalid edge (" << u << ", " << v << ") for " << num_nodes_ << " nodes.";
+    if (u == v)
+      continue;
+    adj.emplace_back(u, v);
+    adj.emplace_back(v, u);
+  }
+  std::sort(adj.begin(), adj.end());
+  num_edges_ += num_edges;
+
+  // the nodes to assign, and the ranges of their neighbors in adj
+  std::vector<int64_t> nodes;
+  std::vector<int64_t> offsets;
+  for (size_t i = 0; i < adj.size(); ) {
+    size_t j = i;
+    while (j < adj.size() && adj[j].first == adj[i].first)
+      ++j;
+    if (parts_[adj[i].first] < 0) {
+      nodes.push_back(adj[i].first);
+      offsets.push_back(i);
+      offsets.push_back(j);
+    }
+    i = j;
+  }
+
+  std::vector<std::vector<std::pair<int, int64_t>>> counts(
+      std::min<int64_t>(batch_size_, nodes.size()));
+  for (size_t b0 = 0; b0 < nodes.size(); b0 += batch_size_) {
+    const size_t b1 = std::min(nodes.size(), b0 + batch_size_);
+    // count the neighbors in each part of the nodes of the batch
+    parallel_for(b0, b1, [&](size_t b, size_t e) {
+      std::vector<int64_t> part_count(num_parts_, 0);
+      for (size_t i = b; i < e; ++i) {
+        std::vector<std::pair<int, int64_t>>& node_counts = counts[i - b0];
+        node_counts.clear();
+        for (int64_t j = offsets[2 * i]; j < offsets[2 * i + 1]; ++j) {
+          const int64_t p = parts_[adj[j].second];
+          if (p >= 0 && part_count[p]++ == 0)
+            node_counts.emplace_back(static_cast<int>(p), 0);
+        }
+        for (auto& pc : node_counts) {
+          pc.second = part_count[pc.first];
+          part_count[pc.first] = 0;
+        }
+      }
+    });
+    for (size_t i = b0; i < b1; ++i)
+      Assign(nodes[i], counts[i - b0]);
+  }
+}
+
+void StreamingPartitioner::AddEdges(IdArray src, IdArray dst) {
+  CHECK(!finished_) << "The partitioner is already finished.";
+  CHECK_SAME_DTYPE(src, dst);
+  CHECK_EQ(src->shape[0], dst->shape[0])
+    << "The numbers of source and destination nodes must match.";
+  src = src.CopyTo(DLContext{kDLCPU, 0});
+  dst = dst.CopyTo(DLContext{kDLCPU, 0});
+  ATEN_ID_TYPE_SWITCH(src->dtype, IdType, {
+    AddEdgesImpl<IdType>(src, dst);
+  });
+}
+
+IdArray StreamingPartitioner::Finish() {
+  CHECK(!finished_) << "The partitioner is already finished.";
+  finished_ = true;
+  const std::vector<std::pair<int, int64_t>> no_counts;
+  for (int64_t v = 0; v < num_nodes_; ++v) {
+    if (parts_[v] < 0)
+      Assign(v, no_counts);
+  }
+  IdArray ret = aten::VecToIdArray(parts_, 64);
+  std::vector<int64_t>().swap(parts_);
+  return ret;
+}
+
+DGL_REGISTER_GLOBAL("partition._CAPI_DGLStreamingPartitionerCreate")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    const int64_t num_nodes = args[0];
+    const int num_parts = args[1];
+    const std::string algorithm = args[2];
+    NDArray vwgt = args[3];
+    const double imbalance = args[4];
+    const int64_t batch_size = args[5];
+    *rv = StreamingPartitionerRef(std::make_shared<StreamingPartitioner>(
+        num_nodes, num_parts, algorithm, vwgt, imbalance, batch_size));
+  });
+
+DGL_REGISTER_GLOBAL("partition._CAPI_DGLStreamingPartitionerAddEdges")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    StreamingPartitionerRef partitioner = args[0];
+    const IdArray src = args[1];
+    const IdArray dst = args[2];
+    partitioner->AddEdges(src, dst);
+  });
+
+DGL_REGISTER_GLOBAL("partition._CAPI_DGLStreamingPartitionerFinish")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    StreamingPartitionerRef partitioner = args[0];
+    *rv = partitioner->Finish();
+  });
+
+}  // namespace transform
+}  // namespace dgl
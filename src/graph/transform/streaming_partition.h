@@ -0,0 +1,110 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file graph/transform/streaming_partition.h
+ * \brief Partition the nodes of a graph from edges given by chunks
+ */
+#ifndef DGL_GRAPH_TRANSFORM_STREAMING_PARTITION_H_
+#define DGL_GRAPH_TRANSFORM_STREAMING_PARTITION_H_
+
+#include <dgl/array.h>
+#include <dgl/runtime/object.h>
+
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dgl {
+namespace transform {
+
+/*!
+ * \brief Assign the nodes of a graph to parts from its edges given by chunks,
+ *        with the LDG or the Fennel heuristic, in memory bounded by the number
+ *        of nodes and the size of a chunk.
+ *
+ * The edges are taken as undirected. The nodes of a chunk not assigned yet are
+ * assigned in increasing order, to the part holding most of their neighbors
+ * assigned so far, discounted by the load of the part:
+ *
+ * - LDG: n(v, p) * (1 - load(p) / capacity)
+ * - Fennel: n(v, p) - alpha * gamma * load(p) ^ (gamma - 1), with gamma = 1.5
+ *   and alpha = sqrt(k) * m / n ^ 1.5, m being the number of edges so far.
+ *
+ * The load of a part is the largest of its loads for each constraint, in
+ * units of the average weight of a node, and no part takes more than the
+ * capacity, imbalance * n / k. The neighbors of the nodes in each part are
+ * counted in parallel, by batches seeing the assignments of the previous
+ * batches only, then the nodes are scored and assigned in order, so the
+ * result does not depend on the number of threads. Only the parts of the
+ * neighbors and the least loaded part that fits are scored for a node, the
+ * parts being kept ordered by load. The nodes without edges are assigned to
+ * the least loaded parts when finishing.
+ */
+class StreamingPartitioner : public runtime::Object {
+ public:
+  /*!
+   * \brief Create a partitioner.
+   * \param num_nodes The number of nodes.
+   * \param num_parts The number of parts.
+   * \param algorithm "ldg" or "fennel".
+   * \param vwgt The weights of the nodes to balance, num_nodes * ncon of them laid
+   *        out as for METIS, or empty to balance the number of nodes.
+   * \param imbalance The largest load of a part over the average one.
+   * \param batch_size The number of nodes scored in parallel before their
+   *        assignments are committed.
+   */
+  StreamingPartitioner(int64_t num_nodes, int num_parts, const std::string& algorithm,
+                       NDArray vwgt, double imbalance, int64_t batch_size);
+
+  /*! \brief Assign the nodes of the edges from src to dst not assigned yet. */
+  void AddEdges(IdArray src, IdArray dst);
+
+  /*! \brief Assign the remaining nodes, and return the part of every node. */
+  IdArray Finish();
+
+  /*! \brief Return the number of edges added. */
+  int64_t NumEdges() const { return num_edges_; }
+
+  static constexpr const char* _type_key = "graph.StreamingPartitioner";
+  DGL_DECLARE_OBJECT_TYPE_INFO(StreamingPartitioner, runtime::Object);
+
+ private:
+  template <typename IdType>
+  void AddEdgesImpl(IdArray src, IdArray dst);
+
+  /*! \brief Return the load of the part p with the node v added, in nodes. */
+  double LoadWith(int p, int64_t v) const;
+
+  /*!
+   * \brief Assign v to the part with the best score, given the number of its
+   *        neighbors in each part it has neighbors in.
+   */
+  void Assign(int64_t v, const std::vector<std::pair<int, int64_t>>& counts);
+
+  int64_t num_nodes_;
+  int num_parts_;
+  bool fennel_;
+  double capacity_;
+  int64_t batch_size_;
+  int64_t num_edges_ = 0;
+  bool finished_ = false;
+  int ncon_ = 1;
+  // the weights of the nodes, empty for unit weights
+  std::vector<int64_t> vwgt_;
+  // the number of nodes per unit of weight of each constraint
+  std::vector<double> scale_;
+  // the load of each part for each constraint, in nodes
+  std::vector<double> loads_;
+  // the largest load of each part, and the parts ordered by it
+  std::vector<double> max_loads_;
+  std::set<std::pair<double, int>> by_load_;
+  // the part of each node, -1 if not assigned
+  std::vector<int64_t> parts_;
+};
+
+DGL_DEFINE_OBJECT_REF(StreamingPartitionerRef, StreamingPartitioner);
+
+}  // namespace transform
+}  // namespace dgl
+
+#endif  // DGL_GRAPH_TRANSFORM_STREAMING_PARTITION_H_
@@ -26,10 +26,15 @@
 #include <dgl/immutable_graph.h>
 #include <dgl/runtime/registry.h>
 #include <dgl/runtime/container.h>
+#include <dgl/runtime/memory_tracker.h>
+#include <dgl/runtime/parallel_for.h>
+#include <dgl/runtime/profile_range.h>
+#include <dgl/runtime/stage_tracker.h>
 #include <vector>
 #include <tuple>
 #include <utility>
-#include "../../array/cpu/array_utils.h"
+#include "../../array/cpu/concurrent_id_hash_map.h"
+#include "../../runtime/arena.h"
 
 namespace dgl {
 
@@ -46,6 +51,13 @@ template<typename IdType>
 std::tuple<HeteroGraphPtr, std::vector<IdArray>>
 ToBlockCPU(HeteroGraphPtr graph, const std::vector<IdArray> &rhs_nodes,
     bool include_rhs_in_lhs, std::vector<IdArray>* const lhs_nodes_ptr) {
+  DGL_PROFILE_RANGE("ToBlock", graph->NumEdgeTypes(), graph->NumEdges(0));
+  runtime::MemoryTagScope tag_scope(runtime::MemoryTag::kSampler);
+  runtime::StageScope stage_scope(runtime::SamplingStage::kToBlock);
+  stage_scope.AddSeeds(rhs_nodes);
+  // The node maps are temporaries drawn from the arena of the thread.
+  typedef ConcurrentIdHashMap<IdType, runtime::ArenaAllocator<IdType>> NodeMap;
+  runtime::ArenaScope arena_scope;
   std::vector<IdArray>& lhs_nodes = *lhs_nodes_ptr;
   const bool generate_lhs_nodes = lhs_nodes.empty();
 
@@ -56,18 +68,27 @@ ToBlockCPU(HeteroGraphPtr graph, const std::vector<IdArray> &rhs_nodes,
   CHECK(rhs_nodes.size() == static_cast<size_t>(num_ntypes))
     << "rhs_nodes not given for every node type";
 
-  const std::vector<IdHashMap<IdType>> rhs_node_mappings(rhs_nodes.begin(), rhs_nodes.end());
-  std::vector<IdHashMap<IdType>> lhs_node_mappings;
-
-  if (generate_lhs_nodes) {
-  // build lhs_node_mappings -- if we don't have them already
-    if (include_rhs_in_lhs)
-      lhs_node_mappings = rhs_node_mappings;  // copy
-    else
-      lhs_node_mappings.resize(num_ntypes);
+  // When the lhs nodes are generated starting with the rhs nodes, the rhs nodes
+  // get the same new ids on both sides, so the lhs maps also map the rhs nodes,
+  // which are the ones below the number of rhs nodes.
+  const bool share_rhs_mappings = generate_lhs_nodes && include_rhs_in_lhs;
+  std::vector<NodeMap> lhs_node_mappings;
+  std::vector<NodeMap> rhs_node_mappings;
+  if (share_rhs_mappings) {
+    lhs_node_mappings = std::vector<NodeMap>(rhs_nodes.begin(), rhs_nodes.end());
   } else {
-    lhs_node_mappings = std::vector<IdHashMap<IdType>>(lhs_nodes.begin(), lhs_nodes.end());
+    rhs_node_mappings = std::vector<NodeMap>(rhs_nodes.begin(), rhs_nodes.end());
+    // build lhs_node_mappings -- if we don't have them already
+    if (generate_lhs_nodes)
+      lhs_node_mappings.resize(num_ntypes);
+    else
+      lhs_node_mappings = std::vector<NodeMap>(lhs_nodes.begin(), lhs_nodes.end());
   }
+  const std::vector<NodeMap> &rhs_maps =
+    share_rhs_mappings ? lhs_node_mappings : rhs_node_mappings;
+  std::vector<int64_t> num_rhs_nodes(num_ntypes);
+  for (int64_t ntype = 0; ntype < num_ntypes; ++ntype)
+    num_rhs_nodes[ntype] = rhs_maps[ntype].Size();
 
 
   for (int64_t etype = 0; etype < num_etypes; ++etype) {
@@ -95,37 +116,62 @@ ToBlockCPU(HeteroGraphPtr graph, const std::vector<IdArray> &rhs_nodes,
   for (int64_t ntype = 0; ntype < num_ntypes; ++ntype)
     num_nodes_per_type.push_back(lhs_node_mappings[ntype].Size());
   for (int64_t ntype = 0; ntype < num_ntypes; ++ntype)
-    num_nodes_per_type.push_back(rhs_node_mappings[ntype].Size());
+    num_nodes_per_type.push_back(num_rhs_nodes[ntype]);
 
-  std::vector<HeteroGraphPtr> rel_graphs;
-  std::vector<IdArray> induced_edges;
-  for (int64_t etype = 0; etype < num_etypes; ++etype) {
+  // the relations of very different sizes share the threads
+  std::vector<HeteroGraphPtr> rel_graphs(num_etypes);
+  std::vector<IdArray> induced_edges(num_etypes);
+  runtime::parallel_for_tasks(0, num_etypes, [&](size_t etype) {
     const auto src_dst_types = graph->GetEndpointTypes(etype);
     const dgl_type_t srctype = src_dst_types.first;
     const dgl_type_t dsttype = src_dst_types.second;
-    const IdHashMap<IdType> &lhs_map = lhs_node_mappings[srctype];
-    const IdHashMap<IdType> &rhs_map = rhs_node_mappings[dsttype];
-    if (rhs_map.Size() == 0) {
+    const NodeMap &lhs_map = lhs_node_mappings[srctype];
+    const NodeMap &rhs_map = rhs_maps[dsttype];
+    if (num_rhs_nodes[dsttype] == 0) {
       // No rhs nodes are given for this edge type. Create an empty graph.
-      rel_graphs.push_back(CreateFromCOO(
-          2, lhs_map.Size(), rhs_map.Size(),
-          aten::NullArray(), aten::NullArray()));
-      induced_edges.push_back(aten::NullArray());
+      rel_graphs[etype] = CreateFromCOO(
+          2, lhs_map.Size(), num_rhs_nodes[dsttype],
+          aten::NullArray(), aten::NullArray());
+      induced_edges[etype] = aten::NullArray();
     } else {
       IdArray new_src = lhs_map.Map(edge_arrays[etype].src, -1);
       IdArray new_dst = rhs_map.Map(edge_arrays[etype].dst, -1);
-      // Check whether there are unmapped IDs and raise error.
-      for (int64_t i = 0; i < new_dst->shape[0]; ++i)
-        CHECK_NE(new_dst.Ptr<IdType>()[i], -1)
+      // Check whether there are unmapped IDs and raise error. The order of the
+      // edges is found in the same pass, so that the block is not scanned for it.
+      const IdType *new_src_data = new_src.Ptr<IdType>();
+      const IdType *new_dst_data = new_dst.Ptr<IdType>();
+      bool dst_sorted = true, src_sorted = true, src_dst_sorted = true;
+      for (int64_t i = 0; i < new_dst->shape[0]; ++i) {
+        const IdType v = new_dst_data[i];
+        CHECK(v != -1 && v < num_rhs_nodes[dsttype])
           << "Node " << edge_arrays[etype].dst.Ptr<IdType>()[i] << " does not exist"
           << " in `rhs_nodes`. Argument `rhs_nodes` must contain all the edge"
           << " destination nodes.";
-      rel_graphs.push_back(CreateFromCOO(
-          2, lhs_map.Size(), rhs_map.Size(),
-          new_src, new_dst));
-      induced_edges.push_back(edge_arrays[etype].id);
+        if (i > 0) {
+          const IdType u = new_src_data[i], prev_u = new_src_data[i - 1];
+          dst_sorted = dst_sorted && new_dst_data[i - 1] <= v;
+          src_sorted = src_sorted && prev_u <= u;
+          src_dst_sorted = src_dst_sorted &&
+            (prev_u < u || (prev_u == u && new_dst_data[i - 1] <= v));
+        }
+      }
+      if (dst_sorted) {
+        // The edges of the samplers come grouped by destination node in the order
+        // of the seeds, so the block is directly built in CSC, the format of the
+        // message passing, keeping the order of the edges.
+        const COOMatrix transposed(
+            num_rhs_nodes[dsttype], lhs_map.Size(), new_dst, new_src,
+            aten::NullArray(), true, false);
+        rel_graphs[etype] = CreateFromCSC(2, COOToCSR(transposed));
+      } else {
+        const COOMatrix coo(
+            lhs_map.Size(), num_rhs_nodes[dsttype], new_src, new_dst,
+            aten::NullArray(), src_sorted, src_sorted && src_dst_sorted);
+        rel_graphs[etype] = CreateFromCOO(2, coo, ALL_CODE, true);
+      }
+      induced_edges[etype] = edge_arrays[etype].id;
     }
-  }
+  });
 
   const HeteroGraphPtr new_graph = CreateHeteroGraph(
       new_meta_graph, rel_graphs, num_nodes_per_type);
@@ -133,9 +179,10 @@ ToBlockCPU(HeteroGraphPtr graph, const std::vector<IdArray> &rhs_nodes,
   if (generate_lhs_nodes) {
     CHECK_EQ(lhs_nodes.size(), 0) << "InteralError: lhs_nodes should be empty "
         "when generating it.";
-    for (const IdHashMap<IdType> &lhs_map : lhs_node_mappings)
+    for (const NodeMap &lhs_map : lhs_node_mappings)
       lhs_nodes.push_back(lhs_map.Values());
   }
+  stage_scope.AddEdges(induced_edges);
   return std::make_tuple(new_graph, induced_edges);
 }
 
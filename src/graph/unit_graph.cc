@@ -4,10 +4,16 @@
  * \brief UnitGraph graph implementation
  */
 #include <dgl/array.h>
+#include <dgl/aten/degree_stats.h>
 #include <dgl/base_heterograph.h>
 #include <dgl/immutable_graph.h>
 #include <dgl/lazy.h>
+#include <dgl/runtime/device_api.h>
+#include <dgl/runtime/memory_tracker.h>
+#include <dgl/runtime/parallel_for.h>
+#include <cstring>
 
+#include "../array/uvm_array_op.h"
 #include "../c_api_common.h"
 #include "./unit_graph.h"
 
@@ -51,6 +57,85 @@ inline GraphPtr CreateUnitGraphMetaGraph(int num_vtypes) {
   return {};
 }
 
+// count a conversion of the sparse formats of a graph
+inline void CountConversion(SparseFormat from, SparseFormat to) {
+  runtime::MemoryTracker::Global()->OnConversion(
+      static_cast<int>(from), static_cast<int>(to));
+}
+
+/*!
+ * \brief Keep the entries of a COO matrix whose edges are kept, in their order.
+ * \param coo The matrix, whose data are the edge ids or empty.
+ * \param mask One for the kept edges and zero for the removed ones, by edge id.
+ * \param new_eids The new id of every kept edge, by edge id.
+ */
+aten::COOMatrix RemoveCOOEntries(
+    const aten::COOMatrix &coo, IdArray mask, IdArray new_eids) {
+  if (!aten::COOHasData(coo)) {
+    // the edges keep the order of their ids, so that the new ids are consecutive
+    const IdArray kept = aten::NonZero(mask);
+    return aten::COOMatrix(
+        coo.num_rows, coo.num_cols, aten::IndexSelect(coo.row, kept),
+        aten::IndexSelect(coo.col, kept), aten::NullArray(), coo.row_sorted, coo.col_sorted);
+  }
+  const IdArray kept = aten::NonZero(aten::IndexSelect(mask, coo.data));
+  const IdArray kept_eids = aten::IndexSelect(coo.data, kept);
+  return aten::COOMatrix(
+      coo.num_rows, coo.num_cols, aten::IndexSelect(coo.row, kept),
+      aten::IndexSelect(coo.col, kept), aten::IndexSelect(new_eids, kept_eids),
+      coo.row_sorted, coo.col_sorted);
+}
+
+/*! \brief Return the data array of a COO matrix, which is 0 to NNZ - 1 when missing. */
+IdArray COOEntryIds(const aten::COOMatrix &coo) {
+  return aten::COOHasData(coo) ? coo.data : aten::Range(
+      0, coo.row->shape[0], coo.row->dtype.bits, coo.row->ctx);
+}
+
+/*!
+ * \brief Append entries to a CSR matrix whose shape grows to num_rows x num_cols.
+ *
+ * On CPU the new entries are merged row by row into the matrix, which stays
+ * sorted if it was. On the other devices the matrix is converted back from the
+ * COO of all the entries.
+ */
+aten::CSRMatrix AppendCSREntries(
+    const aten::CSRMatrix &csr, int64_t num_rows, int64_t num_cols,
+    IdArray rows, IdArray cols, IdArray eids) {
+  if (csr.indptr->ctx.device_type != kDLCPU) {
+    const aten::COOMatrix coo = aten::CSRToCOO(csr, false);
+    return aten::COOToCSR(aten::COOMatrix(
+        num_rows, num_cols, aten::Concat({coo.row, rows}), aten::Concat({coo.col, cols}),
+        aten::Concat({COOEntryIds(coo), eids})));
+  }
+  aten::CSRMatrix base = csr;
+  base.num_rows = num_rows;
+  base.num_cols = num_cols;
+  if (num_rows > csr.num_rows) {
+    // the new rows are empty
+    base.indptr = aten::Concat({csr.indptr, aten::Full(
+        csr.indices->shape[0], num_rows - csr.num_rows, csr.indptr->dtype.bits,
+        csr.indptr->ctx)});
+  }
+  if (rows->shape[0] == 0)
+    return base;
+  aten::CSRMatrix delta = aten::COOToCSR(
+      aten::COOMatrix(num_rows, num_cols, rows, cols, eids));
+  if (base.sorted)
+    aten::CSRSort_(&delta);
+  return aten::CSRMergeRows(base, delta);
+}
+
+/*! \brief Return the size in bytes of an array. */
+int64_t ArrayBytes(const NDArray& arr) {
+  return arr.defined() ? arr.NumElements() * arr->dtype.bits * arr->dtype.lanes / 8 : 0;
+}
+
+/*! \brief Return the index of a format in the last uses of the formats. */
+inline int FormatIndex(SparseFormat format) {
+  return static_cast<int>(format) - 1;
+}
+
 };  // namespace
 
 //////////////////////////////////////////////////////////
@@ -62,8 +147,9 @@ inline GraphPtr CreateUnitGraphMetaGraph(int num_vtypes) {
 class UnitGraph::COO : public BaseHeteroGraph {
  public:
   COO(GraphPtr metagraph, int64_t num_src, int64_t num_dst, IdArray src,
-      IdArray dst, bool row_sorted = false, bool col_sorted = false)
-    : BaseHeteroGraph(metagraph) {
+      IdArray dst, bool row_sorted = false, bool col_sorted = false,
+      bool trusted = false)
+    : BaseHeteroGraph(metagraph), trusted_(trusted) {
     CHECK(aten::IsValidIdArray(src));
     CHECK(aten::IsValidIdArray(dst));
     CHECK_EQ(src->shape[0], dst->shape[0]) << "Input arrays should have the same length.";
@@ -72,8 +158,8 @@ class UnitGraph::COO : public BaseHeteroGraph {
         row_sorted, col_sorted};
   }
 
-  COO(GraphPtr metagraph, const aten::COOMatrix& coo)
-    : BaseHeteroGraph(metagraph), adj_(coo) {
+  COO(GraphPtr metagraph, const aten::COOMatrix& coo, bool trusted = false)
+    : BaseHeteroGraph(metagraph), adj_(coo), trusted_(trusted) {
     // Data index should not be inherited. Edges in COO format are always
     // assigned ids from 0 to num_edges - 1.
     CHECK(!COOHasData(coo)) << "[BUG] COO should not contain data.";
@@ -287,7 +373,9 @@ class UnitGraph::COO : public BaseHeteroGraph {
 
   DegreeArray InDegrees(dgl_type_t etype, IdArray vids) const override {
     CHECK(aten::IsValidIdArray(vids)) << "Invalid vertex id array.";
-    return aten::COOGetRowNNZ(aten::COOTranspose(adj_), vids);
+    // counting the degrees takes a scan of the edges, so they are cached
+    const auto stats = aten::COOGetDegreeStats(adj_, true, plan_cache_.get());
+    return aten::IndexSelect(stats->degrees, vids);
   }
 
   uint64_t OutDegree(dgl_type_t etype, dgl_id_t vid) const override {
@@ -297,7 +385,8 @@ class UnitGraph::COO : public BaseHeteroGraph {
 
   DegreeArray OutDegrees(dgl_type_t etype, IdArray vids) const override {
     CHECK(aten::IsValidIdArray(vids)) << "Invalid vertex id array.";
-    return aten::COOGetRowNNZ(adj_, vids);
+    const auto stats = aten::COOGetDegreeStats(adj_, false, plan_cache_.get());
+    return aten::IndexSelect(stats->degrees, vids);
   }
 
   DGLIdIters SuccVec(dgl_type_t etype, dgl_id_t vid) const override {
@@ -411,6 +500,16 @@ class UnitGraph::COO : public BaseHeteroGraph {
     return adj_;
   }
 
+  /*! \return whether the sortedness flags of the matrix are exact */
+  bool trusted() const {
+    return trusted_;
+  }
+
+  /*! \return the cache of kernel plans built on this adjacency matrix */
+  const aten::KernelPlanCachePtr& plan_cache() const {
+    return plan_cache_;
+  }
+
   /*!
    * \brief Determines whether the graph is "hypersparse", i.e. having significantly more
    * nodes than edges.
@@ -425,6 +524,7 @@ class UnitGraph::COO : public BaseHeteroGraph {
     CHECK(fs->Read(&meta_imgraph)) << "Invalid meta graph";
     meta_graph_ = meta_imgraph;
     CHECK(fs->Read(&adj_)) << "Invalid adj matrix";
+    plan_cache_->Clear();
     return true;
   }
   void Save(dmlc::Stream* fs) const {
@@ -438,6 +538,12 @@ class UnitGraph::COO : public BaseHeteroGraph {
 
   /*! \brief internal adjacency matrix. Data array is empty */
   aten::COOMatrix adj_;
+
+  /*! \brief whether the sortedness flags of adj_ are exact */
+  bool trusted_ = false;
+
+  /*! \brief kernel plans (e.g. SpMM edge partitions) built on adj_ */
+  aten::KernelPlanCachePtr plan_cache_ = std::make_shared<aten::KernelPlanCache>();
 };
 
 //////////////////////////////////////////////////////////
@@ -450,7 +556,7 @@ class UnitGraph::COO : public BaseHeteroGraph {
 class UnitGraph::CSR : public BaseHeteroGraph {
  public:
   CSR(GraphPtr metagraph, int64_t num_src, int64_t num_dst,
-      IdArray indptr, IdArray indices, IdArray edge_ids)
+      IdArray indptr, IdArray indices, IdArray edge_ids, bool sorted = false)
     : BaseHeteroGraph(metagraph) {
     CHECK(aten::IsValidIdArray(indptr));
     CHECK(aten::IsValidIdArray(indices));
@@ -460,7 +566,7 @@ class UnitGraph::CSR : public BaseHeteroGraph {
     CHECK_EQ(num_src, indptr->shape[0] - 1)
       << "number of nodes do not match the length of indptr minus 1.";
 
-    adj_ = aten::CSRMatrix{num_src, num_dst, indptr, indices, edge_ids};
+    adj_ = aten::CSRMatrix{num_src, num_dst, indptr, indices, edge_ids, sorted};
   }
 
   CSR(GraphPtr metagraph, const aten::CSRMatrix& csr)
@@ -588,7 +694,7 @@ class UnitGraph::CSR : public BaseHeteroGraph {
   BoolArray HasEdgesBetween(dgl_type_t etype, IdArray src_ids, IdArray dst_ids) const override {
     CHECK(aten::IsValidIdArray(src_ids)) << "Invalid vertex id array.";
     CHECK(aten::IsValidIdArray(dst_ids)) << "Invalid vertex id array.";
-    return aten::CSRIsNonZero(adj_, src_ids, dst_ids);
+    return aten::CSRIsNonZero(adj_, src_ids, dst_ids, plan_cache_.get());
   }
 
   IdArray Predecessors(dgl_type_t etype, dgl_id_t dst) const override {
@@ -615,7 +721,7 @@ class UnitGraph::CSR : public BaseHeteroGraph {
   }
 
   IdArray EdgeIdsOne(dgl_type_t etype, IdArray src, IdArray dst) const override {
-    return aten::CSRGetData(adj_, src, dst);
+    return aten::CSRGetData(adj_, src, dst, plan_cache_.get());
   }
 
   std::pair<dgl_id_t, dgl_id_t> FindEdge(dgl_type_t etype, dgl_id_t eid) const override {
@@ -795,11 +901,17 @@ class UnitGraph::CSR : public BaseHeteroGraph {
     return adj_;
   }
 
+  /*! \return the cache of kernel plans built on this adjacency matrix */
+  const aten::KernelPlanCachePtr& plan_cache() const {
+    return plan_cache_;
+  }
+
   bool Load(dmlc::Stream* fs) {
     auto meta_imgraph = Serializer::make_shared<ImmutableGraph>();
     CHECK(fs->Read(&meta_imgraph)) << "Invalid meta graph";
     meta_graph_ = meta_imgraph;
     CHECK(fs->Read(&adj_)) << "Invalid adj matrix";
+    plan_cache_->Clear();
     return true;
   }
   void Save(dmlc::Stream* fs) const {
@@ -813,6 +925,9 @@ class UnitGraph::CSR : public BaseHeteroGraph {
 
   /*! \brief internal adjacency matrix. Data array stores edge ids */
   aten::CSRMatrix adj_;
+
+  /*! \brief kernel plans (e.g. SpMM blockings) built on adj_ */
+  aten::KernelPlanCachePtr plan_cache_ = std::make_shared<aten::KernelPlanCache>();
 };
 
 //////////////////////////////////////////////////////////
@@ -1156,13 +1271,13 @@ HeteroGraphPtr UnitGraph::CreateFromCOO(
     int64_t num_vtypes, int64_t num_src, int64_t num_dst,
     IdArray row, IdArray col,
     bool row_sorted, bool col_sorted,
-    dgl_format_code_t formats) {
+    dgl_format_code_t formats, bool trusted) {
   CHECK(num_vtypes == 1 || num_vtypes == 2);
   if (num_vtypes == 1)
     CHECK_EQ(num_src, num_dst);
   auto mg = CreateUnitGraphMetaGraph(num_vtypes);
   COOPtr coo(new COO(mg, num_src, num_dst, row, col,
-      row_sorted, col_sorted));
+      row_sorted, col_sorted, trusted));
 
   return HeteroGraphPtr(
       new UnitGraph(mg, nullptr, nullptr, coo, formats));
@@ -1170,12 +1285,12 @@ HeteroGraphPtr UnitGraph::CreateFromCOO(
 
 HeteroGraphPtr UnitGraph::CreateFromCOO(
     int64_t num_vtypes, const aten::COOMatrix& mat,
-    dgl_format_code_t formats) {
+    dgl_format_code_t formats, bool trusted) {
   CHECK(num_vtypes == 1 || num_vtypes == 2);
   if (num_vtypes == 1)
     CHECK_EQ(mat.num_rows, mat.num_cols);
   auto mg = CreateUnitGraphMetaGraph(num_vtypes);
-  COOPtr coo(new COO(mg, mat));
+  COOPtr coo(new COO(mg, mat, trusted));
 
   return HeteroGraphPtr(
       new UnitGraph(mg, nullptr, nullptr, coo, formats));
@@ -1183,12 +1298,13 @@ HeteroGraphPtr UnitGraph::CreateFromCOO(
 
 HeteroGraphPtr UnitGraph::CreateFromCSR(
     int64_t num_vtypes, int64_t num_src, int64_t num_dst,
-    IdArray indptr, IdArray indices, IdArray edge_ids, dgl_format_code_t formats) {
+    IdArray indptr, IdArray indices, IdArray edge_ids, dgl_format_code_t formats,
+    bool sorted) {
   CHECK(num_vtypes == 1 || num_vtypes == 2);
   if (num_vtypes == 1)
     CHECK_EQ(num_src, num_dst);
   auto mg = CreateUnitGraphMetaGraph(num_vtypes);
-  CSRPtr csr(new CSR(mg, num_src, num_dst, indptr, indices, edge_ids));
+  CSRPtr csr(new CSR(mg, num_src, num_dst, indptr, indices, edge_ids, sorted));
   return HeteroGraphPtr(new UnitGraph(mg, nullptr, csr, nullptr, formats));
 }
 
@@ -1205,12 +1321,13 @@ HeteroGraphPtr UnitGraph::CreateFromCSR(
 
 HeteroGraphPtr UnitGraph::CreateFromCSC(
     int64_t num_vtypes, int64_t num_src, int64_t num_dst,
-    IdArray indptr, IdArray indices, IdArray edge_ids, dgl_format_code_t formats) {
+    IdArray indptr, IdArray indices, IdArray edge_ids, dgl_format_code_t formats,
+    bool sorted) {
   CHECK(num_vtypes == 1 || num_vtypes == 2);
   if (num_vtypes == 1)
     CHECK_EQ(num_src, num_dst);
   auto mg = CreateUnitGraphMetaGraph(num_vtypes);
-  CSRPtr csc(new CSR(mg, num_src, num_dst, indptr, indices, edge_ids));
+  CSRPtr csc(new CSR(mg, num_src, num_dst, indptr, indices, edge_ids, sorted));
   return HeteroGraphPtr(new UnitGraph(mg, csc, nullptr, nullptr, formats));
 }
 
@@ -1263,16 +1380,233 @@ HeteroGraphPtr UnitGraph::CopyTo(HeteroGraphPtr g, const DLContext &ctx,
   }
 }
 
+namespace {
+
+/*!
+ * \brief The pinned staging buffer of the calling thread, grown to a power of two
+ *        of at least the given number of bytes, reused so that the page-locked
+ *        memory is not allocated again for every copy.
+ */
+NDArray PinnedStagingBuffer(const DLContext &ctx, int64_t nbytes) {
+  static thread_local NDArray buffer;
+  if (!buffer.defined() || buffer->shape[0] < nbytes) {
+    int64_t capacity = 1;
+    while (capacity < nbytes)
+      capacity <<= 1;
+    buffer = NDArray();
+    buffer = NDArray::PinnedEmpty({capacity}, DLDataType{kDLUInt, 8, 1}, ctx);
+  }
+  return buffer;
+}
+
+}  // namespace
+
+std::vector<HeteroGraphPtr> UnitGraph::CopyTo(
+    const std::vector<HeteroGraphPtr> &graphs, const DLContext &ctx,
+    const DGLStreamHandle &stream) {
+  const size_t num_graphs = graphs.size();
+  std::vector<HeteroGraphPtr> ret(num_graphs);
+  std::vector<aten::CSRMatrix> in_csrs(num_graphs), out_csrs(num_graphs);
+  std::vector<aten::COOMatrix> coos(num_graphs);
+  // the arrays to copy, and whether they can be packed into one buffer
+  std::vector<NDArray*> arrays;
+  bool coalesce = ctx.device_type == kDLGPU;
+  auto add = [&arrays, &coalesce](NDArray *array, bool optional) {
+    if (optional && aten::IsNullArray(*array))
+      return;
+    coalesce = coalesce && (*array)->ctx.device_type == kDLCPU && array->IsContiguous();
+    arrays.push_back(array);
+  };
+  for (size_t i = 0; i < num_graphs; ++i) {
+    if (graphs[i]->Context() == ctx) {
+      ret[i] = graphs[i];
+      continue;
+    }
+    auto bg = std::dynamic_pointer_cast<UnitGraph>(graphs[i]);
+    CHECK_NOTNULL(bg);
+    if (bg->in_csr_->defined()) {
+      in_csrs[i] = bg->in_csr_->adj();
+      add(&in_csrs[i].indptr, false);
+      add(&in_csrs[i].indices, false);
+      add(&in_csrs[i].data, true);
+    }
+    if (bg->out_csr_->defined()) {
+      out_csrs[i] = bg->out_csr_->adj();
+      add(&out_csrs[i].indptr, false);
+      add(&out_csrs[i].indices, false);
+      add(&out_csrs[i].data, true);
+    }
+    if (bg->coo_->defined()) {
+      coos[i] = bg->coo_->adj();
+      add(&coos[i].row, false);
+      add(&coos[i].col, false);
+      add(&coos[i].data, true);
+    }
+  }
+  if (!coalesce) {
+    for (size_t i = 0; i < num_graphs; ++i) {
+      if (!ret[i])
+        ret[i] = CopyTo(graphs[i], ctx, stream);
+    }
+    return ret;
+  }
+
+  // pack the arrays at aligned offsets, copy them at once and view them on GPU
+  std::vector<int64_t> offsets(arrays.size() + 1, 0);
+  for (size_t j = 0; j < arrays.size(); ++j) {
+    const int64_t nbytes = arrays[j]->GetSize();
+    offsets[j + 1] = offsets[j] +
+      (nbytes + runtime::kAllocAlignment - 1) / runtime::kAllocAlignment *
+      runtime::kAllocAlignment;
+  }
+  const int64_t total = offsets.back();
+  const DLDataType bytes{kDLUInt, 8, 1};
+  NDArray buffer = NDArray::Empty({total}, bytes, ctx);
+  if (total > 0) {
+    NDArray staging = PinnedStagingBuffer(ctx, total);
+    char *staging_data = static_cast<char*>(staging->data);
+    runtime::parallel_for(0, arrays.size(), [&](size_t b, size_t e) {
+      for (auto j = b; j < e; ++j) {
+        const NDArray &array = *arrays[j];
+        std::memcpy(staging_data + offsets[j],
+                    static_cast<const char*>(array->data) + array->byte_offset,
+                    array.GetSize());
+      }
+    });
+    staging.CreateView({total}, bytes).CopyTo(buffer, stream);
+    // the staging buffer is reused by the next copy
+    runtime::DeviceAPI::Get(ctx)->StreamSync(ctx, stream);
+  }
+  for (size_t j = 0; j < arrays.size(); ++j) {
+    NDArray *array = arrays[j];
+    std::vector<int64_t> shape((*array)->shape, (*array)->shape + (*array)->ndim);
+    *array = buffer.CreateView(shape, (*array)->dtype, offsets[j]);
+  }
+
+  for (size_t i = 0; i < num_graphs; ++i) {
+    if (ret[i])
+      continue;
+    auto bg = std::dynamic_pointer_cast<UnitGraph>(graphs[i]);
+    const auto &mg = graphs[i]->meta_graph();
+    CSRPtr new_incsr = bg->in_csr_->defined() ? CSRPtr(new CSR(mg, in_csrs[i])) : nullptr;
+    CSRPtr new_outcsr = bg->out_csr_->defined() ? CSRPtr(new CSR(mg, out_csrs[i])) : nullptr;
+    COOPtr new_coo = bg->coo_->defined() ? COOPtr(new COO(mg, coos[i])) : nullptr;
+    ret[i] = HeteroGraphPtr(new UnitGraph(mg, new_incsr, new_outcsr, new_coo, bg->formats_));
+  }
+  return ret;
+}
+
+namespace {
+
+/*!
+ * \brief Load the format if it is known to be created, checking the flag again
+ *        after loading it so that a format dropped meanwhile is not returned.
+ */
+template <typename FormatPtr>
+bool LoadReadyFormat(const std::atomic<dgl_format_code_t> &ready, dgl_format_code_t code,
+                     const FormatPtr &format, FormatPtr *ret) {
+  if (!(ready & code))
+    return false;
+  *ret = std::atomic_load(&format);
+  return ready & code;
+}
+
+}  // namespace
+
 void UnitGraph::InvalidateCSR() {
-  this->out_csr_ = CSRPtr(new CSR());
+  std::lock_guard<std::mutex> lock(format_mutex_);
+  // The old CSR may still be shared with other graphs, so drop its plans explicitly
+  // in case the arrays they were built on have been modified in place.
+  this->out_csr_->plan_cache()->Clear();
+  ready_formats_ &= ~CSR_CODE;
+  std::atomic_store(&this->out_csr_, CSRPtr(new CSR()));
 }
 
 void UnitGraph::InvalidateCSC() {
-  this->in_csr_ = CSRPtr(new CSR());
+  std::lock_guard<std::mutex> lock(format_mutex_);
+  this->in_csr_->plan_cache()->Clear();
+  ready_formats_ &= ~CSC_CODE;
+  std::atomic_store(&this->in_csr_, CSRPtr(new CSR()));
 }
 
 void UnitGraph::InvalidateCOO() {
-  this->coo_ = COOPtr(new COO());
+  std::lock_guard<std::mutex> lock(format_mutex_);
+  this->coo_->plan_cache()->Clear();
+  ready_formats_ &= ~COO_CODE;
+  std::atomic_store(&this->coo_, COOPtr(new COO()));
+}
+
+void UnitGraph::SetFormatMemoryBudget(int64_t budget) {
+  std::lock_guard<std::mutex> lock(format_mutex_);
+  format_memory_budget_ = budget;
+  // keep the most recently used format
+  SparseFormat keep = SparseFormat::kCOO;
+  uint64_t latest = 0;
+  for (SparseFormat format : CodeToSparseFormats(GetCreatedFormats())) {
+    const uint64_t last_use = format_last_use_[FormatIndex(format)];
+    if (last_use >= latest) {
+      keep = format;
+      latest = last_use;
+    }
+  }
+  EvictFormats(keep);
+}
+
+int64_t UnitGraph::GetFormatMemoryUsage() const {
+  int64_t ret = 0;
+  if (in_csr_->defined()) {
+    const aten::CSRMatrix& adj = in_csr_->adj();
+    ret += ArrayBytes(adj.indptr) + ArrayBytes(adj.indices) + ArrayBytes(adj.data);
+  }
+  if (out_csr_->defined()) {
+    const aten::CSRMatrix& adj = out_csr_->adj();
+    ret += ArrayBytes(adj.indptr) + ArrayBytes(adj.indices) + ArrayBytes(adj.data);
+  }
+  if (coo_->defined()) {
+    const aten::COOMatrix& adj = coo_->adj();
+    ret += ArrayBytes(adj.row) + ArrayBytes(adj.col) + ArrayBytes(adj.data);
+  }
+  return ret;
+}
+
+void UnitGraph::TouchFormat(SparseFormat format) const {
+  format_last_use_[FormatIndex(format)] = ++format_clock_;
+}
+
+void UnitGraph::EvictFormats(SparseFormat keep) {
+  // called with format_mutex_ held
+  if (format_memory_budget_ < 0)
+    return;
+  while (GetFormatMemoryUsage() > format_memory_budget_) {
+    // Only the pointer to the evicted format is dropped, so that the callers still
+    // holding it can keep using it and its plans.
+    bool found = false;
+    SparseFormat oldest = keep;
+    for (SparseFormat format : CodeToSparseFormats(GetCreatedFormats())) {
+      if (format != keep && (!found ||
+          format_last_use_[FormatIndex(format)] < format_last_use_[FormatIndex(oldest)])) {
+        oldest = format;
+        found = true;
+      }
+    }
+    if (!found)
+      break;
+    // the flag is cleared first for the threads loading the format without locking
+    switch (oldest) {
+      case SparseFormat::kCSC:
+        ready_formats_ &= ~CSC_CODE;
+        std::atomic_store(&in_csr_, CSRPtr(new CSR()));
+        break;
+      case SparseFormat::kCSR:
+        ready_formats_ &= ~CSR_CODE;
+        std::atomic_store(&out_csr_, CSRPtr(new CSR()));
+        break;
+      default:
+        ready_formats_ &= ~COO_CODE;
+        std::atomic_store(&coo_, COOPtr(new COO()));
+        break;
+    }
+  }
 }
 
 UnitGraph::UnitGraph(GraphPtr metagraph, CSRPtr in_csr, CSRPtr out_csr, COOPtr coo,
@@ -1330,11 +1664,18 @@ UnitGraph::CSRPtr UnitGraph::GetInCSR(bool inplace) const {
     if (!(formats_ & CSC_CODE))
       LOG(FATAL) << "The graph have restricted sparse format " <<
         CodeToStr(formats_) << ", cannot create CSC matrix.";
-  CSRPtr ret = in_csr_;
+  TouchFormat(SparseFormat::kCSC);
+  CSRPtr ret;
+  if (LoadReadyFormat(ready_formats_, CSC_CODE, in_csr_, &ret))
+    return ret;
+  std::lock_guard<std::mutex> lock(format_mutex_);
+  ret = in_csr_;
   // Prefers converting from COO since it is parallelized.
   // TODO(BarclayII): need benchmarking.
   if (!in_csr_->defined()) {
+    runtime::MemoryTagScope tag_scope(runtime::MemoryTag::kGraph);
     if (coo_->defined()) {
+      CountConversion(SparseFormat::kCOO, SparseFormat::kCSC);
       const auto& newadj = aten::COOToCSR(
             aten::COOTranspose(coo_->adj()));
 
@@ -1344,6 +1685,7 @@ UnitGraph::CSRPtr UnitGraph::GetInCSR(bool inplace) const {
         ret = std::make_shared<CSR>(meta_graph(), newadj);
     } else {
       CHECK(out_csr_->defined()) << "None of CSR, COO exist";
+      CountConversion(SparseFormat::kCSR, SparseFormat::kCSC);
       const auto& newadj = aten::CSRTranspose(out_csr_->adj());
 
       if (inplace)
@@ -1351,7 +1693,11 @@ UnitGraph::CSRPtr UnitGraph::GetInCSR(bool inplace) const {
       else
         ret = std::make_shared<CSR>(meta_graph(), newadj);
     }
+    if (inplace)
+      const_cast<UnitGraph*>(this)->EvictFormats(SparseFormat::kCSC);
   }
+  if (ret == in_csr_)
+    ready_formats_ |= CSC_CODE;
   return ret;
 }
 
@@ -1361,12 +1707,25 @@ UnitGraph::CSRPtr UnitGraph::GetOutCSR(bool inplace) const {
     if (!(formats_ & CSR_CODE))
       LOG(FATAL) << "The graph have restricted sparse format " <<
         CodeToStr(formats_) << ", cannot create CSR matrix.";
-  CSRPtr ret = out_csr_;
+  TouchFormat(SparseFormat::kCSR);
+  CSRPtr ret;
+  if (LoadReadyFormat(ready_formats_, CSR_CODE, out_csr_, &ret))
+    return ret;
+  std::lock_guard<std::mutex> lock(format_mutex_);
+  ret = out_csr_;
   // Prefers converting from COO since it is parallelized.
   // TODO(BarclayII): need benchmarking.
   if (!out_csr_->defined()) {
+    runtime::MemoryTagScope tag_scope(runtime::MemoryTag::kGraph);
     if (coo_->defined()) {
-      const auto& newadj = aten::COOToCSR(coo_->adj());
+      CountConversion(SparseFormat::kCOO, SparseFormat::kCSR);
+      // The CSR of a COO sorted by row shares its column array, so that the COO
+      // loaded from sorted edges is checked for it even when it is not flagged,
+      // unless its flags are trusted.
+      aten::COOMatrix adj = coo_->adj();
+      if (!adj.row_sorted && !coo_->trusted())
+        std::tie(adj.row_sorted, adj.col_sorted) = aten::COOIsSorted(adj);
+      const auto& newadj = aten::COOToCSR(adj);
 
       if (inplace)
         *(const_cast<UnitGraph*>(this)->out_csr_) = CSR(meta_graph(), newadj);
@@ -1374,6 +1733,7 @@ UnitGraph::CSRPtr UnitGraph::GetOutCSR(bool inplace) const {
         ret = std::make_shared<CSR>(meta_graph(), newadj);
     } else {
       CHECK(in_csr_->defined()) << "None of CSR, COO exist";
+      CountConversion(SparseFormat::kCSC, SparseFormat::kCSR);
       const auto& newadj = aten::CSRTranspose(in_csr_->adj());
 
       if (inplace)
@@ -1381,7 +1741,11 @@ UnitGraph::CSRPtr UnitGraph::GetOutCSR(bool inplace) const {
       else
         ret = std::make_shared<CSR>(meta_graph(), newadj);
     }
+    if (inplace)
+      const_cast<UnitGraph*>(this)->EvictFormats(SparseFormat::kCSR);
   }
+  if (ret == out_csr_)
+    ready_formats_ |= CSR_CODE;
   return ret;
 }
 
@@ -1391,9 +1755,16 @@ UnitGraph::COOPtr UnitGraph::GetCOO(bool inplace) const {
     if (!(formats_ & COO_CODE))
       LOG(FATAL) << "The graph have restricted sparse format " <<
         CodeToStr(formats_) << ", cannot create COO matrix.";
-  COOPtr ret = coo_;
+  TouchFormat(SparseFormat::kCOO);
+  COOPtr ret;
+  if (LoadReadyFormat(ready_formats_, COO_CODE, coo_, &ret))
+    return ret;
+  std::lock_guard<std::mutex> lock(format_mutex_);
+  ret = coo_;
   if (!coo_->defined()) {
+    runtime::MemoryTagScope tag_scope(runtime::MemoryTag::kGraph);
     if (in_csr_->defined()) {
+      CountConversion(SparseFormat::kCSC, SparseFormat::kCOO);
       const auto& newadj = aten::COOTranspose(aten::CSRToCOO(in_csr_->adj(), true));
 
       if (inplace)
@@ -1402,6 +1773,7 @@ UnitGraph::COOPtr UnitGraph::GetCOO(bool inplace) const {
         ret = std::make_shared<COO>(meta_graph(), newadj);
     } else {
       CHECK(out_csr_->defined()) << "Both CSR are missing.";
+      CountConversion(SparseFormat::kCSR, SparseFormat::kCOO);
       const auto& newadj = aten::CSRToCOO(out_csr_->adj(), true);
 
       if (inplace)
@@ -1409,7 +1781,11 @@ UnitGraph::COOPtr UnitGraph::GetCOO(bool inplace) const {
       else
         ret = std::make_shared<COO>(meta_graph(), newadj);
     }
+    if (inplace)
+      const_cast<UnitGraph*>(this)->EvictFormats(SparseFormat::kCOO);
   }
+  if (ret == coo_)
+    ready_formats_ |= COO_CODE;
   return ret;
 }
 
@@ -1421,6 +1797,20 @@ aten::CSRMatrix UnitGraph::GetCSRMatrix(dgl_type_t etype) const {
   return GetOutCSR()->adj();
 }
 
+aten::KernelPlanCachePtr UnitGraph::GetKernelPlanCache(
+    dgl_type_t etype, SparseFormat fmt) const {
+  switch (fmt) {
+    case SparseFormat::kCSC:
+      return GetInCSR()->plan_cache();
+    case SparseFormat::kCSR:
+      return GetOutCSR()->plan_cache();
+    case SparseFormat::kCOO:
+      return GetCOO()->plan_cache();
+    default:
+      return nullptr;
+  }
+}
+
 aten::COOMatrix UnitGraph::GetCOOMatrix(dgl_type_t etype) const {
   return GetCOO()->adj();
 }
@@ -1484,6 +1874,92 @@ HeteroGraphPtr UnitGraph::GetGraphInFormat(dgl_format_code_t formats) const {
   return CreateFromCSC(num_vtypes, GetInCSR(false)->adj(), formats);
 }
 
+HeteroGraphPtr UnitGraph::Snapshot() const {
+  return HeteroGraphPtr(
+      new UnitGraph(meta_graph_,
+                    in_csr_->defined() ? CSRPtr(new CSR(*in_csr_)) : nullptr,
+                    out_csr_->defined() ? CSRPtr(new CSR(*out_csr_)) : nullptr,
+                    coo_->defined() ? COOPtr(new COO(*coo_)) : nullptr,
+                    formats_));
+}
+
+namespace {
+
+// Whether an array is pinned, the empty arrays having no memory to pin.
+bool IsPinnedOrEmpty(const NDArray& arr) {
+  return arr.GetSize() == 0 || arr.IsPinned();
+}
+
+}  // namespace
+
+bool UnitGraph::IsPinned() const {
+  if (Context().device_type != kDLCPU)
+    return false;
+  if (in_csr_->defined()) {
+    const aten::CSRMatrix& adj = in_csr_->adj();
+    if (!IsPinnedOrEmpty(adj.indptr) || !IsPinnedOrEmpty(adj.indices) ||
+        !IsPinnedOrEmpty(adj.data))
+      return false;
+  }
+  if (out_csr_->defined()) {
+    const aten::CSRMatrix& adj = out_csr_->adj();
+    if (!IsPinnedOrEmpty(adj.indptr) || !IsPinnedOrEmpty(adj.indices) ||
+        !IsPinnedOrEmpty(adj.data))
+      return false;
+  }
+  if (coo_->defined()) {
+    const aten::COOMatrix& adj = coo_->adj();
+    if (!IsPinnedOrEmpty(adj.row) || !IsPinnedOrEmpty(adj.col) || !IsPinnedOrEmpty(adj.data))
+      return false;
+  }
+  return true;
+}
+
+void UnitGraph::PinMemory_(const DLContext& ctx, bool cache_indptr) {
+  CHECK_EQ(Context().device_type, kDLCPU) << "Only the graphs on the CPU can be pinned.";
+  // the formats are neither created nor dropped meanwhile
+  std::lock_guard<std::mutex> lock(format_mutex_);
+  for (const CSRPtr& csr : {in_csr_, out_csr_}) {
+    if (!csr->defined())
+      continue;
+    aten::CSRMatrix adj = csr->adj();
+    adj.indptr.PinMemory_(ctx);
+    adj.indices.PinMemory_(ctx);
+    if (aten::CSRHasData(adj))
+      adj.data.PinMemory_(ctx);
+    if (cache_indptr)
+      aten::CSRCacheIndptr(adj, ctx, csr->plan_cache().get());
+  }
+  if (coo_->defined()) {
+    aten::COOMatrix adj = coo_->adj();
+    adj.row.PinMemory_(ctx);
+    adj.col.PinMemory_(ctx);
+    if (aten::COOHasData(adj))
+      adj.data.PinMemory_(ctx);
+  }
+}
+
+void UnitGraph::UnpinMemory_() {
+  std::lock_guard<std::mutex> lock(format_mutex_);
+  for (const CSRPtr& csr : {in_csr_, out_csr_}) {
+    if (!csr->defined())
+      continue;
+    aten::CSRMatrix adj = csr->adj();
+    aten::CSRUncacheIndptr(csr->plan_cache().get());
+    adj.indptr.UnpinMemory_();
+    adj.indices.UnpinMemory_();
+    if (aten::CSRHasData(adj))
+      adj.data.UnpinMemory_();
+  }
+  if (coo_->defined()) {
+    aten::COOMatrix adj = coo_->adj();
+    adj.row.UnpinMemory_();
+    adj.col.UnpinMemory_();
+    if (aten::COOHasData(adj))
+      adj.data.UnpinMemory_();
+  }
+}
+
 SparseFormat UnitGraph::SelectFormat(dgl_format_code_t preferred_formats) const {
   dgl_format_code_t common = preferred_formats & formats_;
   dgl_format_code_t created = GetCreatedFormats();
@@ -1607,6 +2083,7 @@ bool UnitGraph::Load(dmlc::Stream* fs) {
   if (!coo_) {
     coo_ = COOPtr(new COO());
   }
+  ready_formats_ = 0;
 
   meta_graph_ = GetAny()->meta_graph();
 
@@ -1687,4 +2164,69 @@ UnitGraph::ToSimple() const {
                          edge_map);
 }
 
+std::pair<UnitGraphPtr, IdArray>
+UnitGraph::RemoveEdges(IdArray eids) const {
+  const int64_t num_edges = NumEdges(0);
+  const uint8_t nbits = NumBits();
+  const DLContext ctx = Context();
+  IdArray mask = aten::Full(1, num_edges, nbits, ctx);
+  aten::Scatter_(eids, aten::Full(0, eids->shape[0], nbits, ctx), mask);
+  const IdArray induced_eids = aten::AsNumBits(aten::NonZero(mask), nbits);
+  const IdArray new_eids = aten::Sub(aten::CumSum(mask), 1);
+
+  // The entries of the CSRs stay sorted by row, so that they are converted back
+  // without sorting.
+  CSRPtr new_incsr = nullptr, new_outcsr = nullptr;
+  COOPtr new_coo = nullptr;
+  if (in_csr_->defined()) {
+    const aten::COOMatrix coo = RemoveCOOEntries(
+        aten::CSRToCOO(in_csr_->adj(), false), mask, new_eids);
+    new_incsr = CSRPtr(new CSR(meta_graph(), aten::COOToCSR(coo)));
+  }
+  if (out_csr_->defined()) {
+    const aten::COOMatrix coo = RemoveCOOEntries(
+        aten::CSRToCOO(out_csr_->adj(), false), mask, new_eids);
+    new_outcsr = CSRPtr(new CSR(meta_graph(), aten::COOToCSR(coo)));
+  }
+  if (coo_->defined())
+    new_coo = COOPtr(new COO(meta_graph(), RemoveCOOEntries(coo_->adj(), mask, new_eids)));
+
+  return std::make_pair(
+      UnitGraphPtr(new UnitGraph(meta_graph(), new_incsr, new_outcsr, new_coo, formats_)),
+      induced_eids);
+}
+
+UnitGraphPtr UnitGraph::AppendEdges(
+    int64_t num_src, int64_t num_dst, IdArray src, IdArray dst) const {
+  CHECK_GE(num_src, NumVertices(SrcType())) << "The number of source nodes cannot decrease.";
+  CHECK_GE(num_dst, NumVertices(DstType()))
+    << "The number of destination nodes cannot decrease.";
+  CHECK_EQ(src->shape[0], dst->shape[0])
+    << "The numbers of source and destination nodes of the new edges differ.";
+  CHECK_SAME_DTYPE(src, dst);
+  const int64_t num_edges = NumEdges(0);
+  const IdArray new_eids = aten::Range(
+      num_edges, num_edges + src->shape[0], NumBits(), Context());
+
+  CSRPtr new_incsr = nullptr, new_outcsr = nullptr;
+  COOPtr new_coo = nullptr;
+  if (in_csr_->defined()) {
+    new_incsr = CSRPtr(new CSR(meta_graph(), AppendCSREntries(
+        in_csr_->adj(), num_dst, num_src, dst, src, new_eids)));
+  }
+  if (out_csr_->defined()) {
+    new_outcsr = CSRPtr(new CSR(meta_graph(), AppendCSREntries(
+        out_csr_->adj(), num_src, num_dst, src, dst, new_eids)));
+  }
+  if (coo_->defined()) {
+    const aten::COOMatrix &coo = coo_->adj();
+    const IdArray data = aten::COOHasData(coo) ?
+      aten::Concat({coo.data, new_eids}) : aten::NullArray();
+    new_coo = COOPtr(new COO(meta_graph(), aten::COOMatrix(
+        num_src, num_dst, aten::Concat({coo.row, src}), aten::Concat({coo.col, dst}), data)));
+  }
+
+  return UnitGraphPtr(new UnitGraph(meta_graph(), new_incsr, new_outcsr, new_coo, formats_));
+}
+
 }  // namespace dgl
@@ -12,6 +12,8 @@
 #include <dgl/array.h>
 #include <dmlc/io.h>
 #include <dmlc/type_traits.h>
+#include <atomic>
+#include <mutex>
 #include <utility>
 #include <string>
 #include <vector>
@@ -83,6 +85,9 @@ class UnitGraph : public BaseHeteroGraph {
 
   DLContext Context() const override;
 
+  /*! \return Whether the arrays of all the created formats are pinned. */
+  bool IsPinned() const override;
+
   uint8_t NumBits() const override;
 
   bool IsMultigraph() const override;
@@ -171,21 +176,30 @@ class UnitGraph : public BaseHeteroGraph {
     return CreateFromCOO(num_vtypes, num_src, num_dst, row, col);
   }
 
-  /*! \brief Create a graph from COO arrays */
+  /*!
+   * \brief Create a graph from COO arrays
+   *
+   * The sortedness flags of a trusted COO are exact, i.e. an unsorted COO is not
+   * scanned for sorted rows when it is converted.
+   */
   static HeteroGraphPtr CreateFromCOO(
       int64_t num_vtypes, int64_t num_src, int64_t num_dst,
       IdArray row, IdArray col, bool row_sorted = false,
-      bool col_sorted = false, dgl_format_code_t formats = ALL_CODE);
+      bool col_sorted = false, dgl_format_code_t formats = ALL_CODE,
+      bool trusted = false);
 
   static HeteroGraphPtr CreateFromCOO(
       int64_t num_vtypes, const aten::COOMatrix& mat,
-      dgl_format_code_t formats = ALL_CODE);
+      dgl_format_code_t formats = ALL_CODE, bool trusted = false);
 
-  /*! \brief Create a graph from (out) CSR arrays */
+  /*!
+   * \brief Create a graph from (out) CSR arrays, whose columns are sorted in
+   *        every row if sorted.
+   */
   static HeteroGraphPtr CreateFromCSR(
       int64_t num_vtypes, int64_t num_src, int64_t num_dst,
       IdArray indptr, IdArray indices, IdArray edge_ids,
-      dgl_format_code_t formats = ALL_CODE);
+      dgl_format_code_t formats = ALL_CODE, bool sorted = false);
 
   static HeteroGraphPtr CreateFromCSR(
       int64_t num_vtypes, const aten::CSRMatrix& mat,
@@ -195,7 +209,7 @@ class UnitGraph : public BaseHeteroGraph {
   static HeteroGraphPtr CreateFromCSC(
       int64_t num_vtypes, int64_t num_src, int64_t num_dst,
       IdArray indptr, IdArray indices, IdArray edge_ids,
-      dgl_format_code_t formats = ALL_CODE);
+      dgl_format_code_t formats = ALL_CODE, bool sorted = false);
 
   static HeteroGraphPtr CreateFromCSC(
       int64_t num_vtypes, const aten::CSRMatrix& mat,
@@ -208,6 +222,17 @@ class UnitGraph : public BaseHeteroGraph {
   static HeteroGraphPtr CopyTo(HeteroGraphPtr g, const DLContext &ctx,
                                const DGLStreamHandle &stream = nullptr);
 
+  /*!
+   * \brief Copy the data of the graphs to another context.
+   *
+   * From CPU to GPU, the arrays of all the graphs are packed into a pinned buffer
+   * and copied at once, the arrays of the returned graphs being views of a single
+   * allocation on GPU.
+   */
+  static std::vector<HeteroGraphPtr> CopyTo(const std::vector<HeteroGraphPtr> &graphs,
+                                            const DLContext &ctx,
+                                            const DGLStreamHandle &stream = nullptr);
+
   /*! 
    * \brief Create in-edge CSR format of the unit graph.
    * \param inplace if true and the in-edge CSR format does not exist, the created
@@ -241,6 +266,10 @@ class UnitGraph : public BaseHeteroGraph {
   /*! \return Return the out-edge CSR in the matrix form */
   aten::CSRMatrix GetCSRMatrix(dgl_type_t etype) const override;
 
+  /*! \return Return the kernel plan cache of the in-edge CSC, the out-edge CSR or the COO */
+  aten::KernelPlanCachePtr GetKernelPlanCache(
+      dgl_type_t etype, SparseFormat fmt) const override;
+
   SparseFormat SelectFormat(dgl_type_t etype, dgl_format_code_t preferred_formats) const override {
     return SelectFormat(preferred_formats);
   }
@@ -259,6 +288,21 @@ class UnitGraph : public BaseHeteroGraph {
 
   HeteroGraphPtr GetGraphInFormat(dgl_format_code_t formats) const override;
 
+  /*!
+   * \brief Pin the arrays of the created formats in place for the GPU ctx, so that
+   *        the GPU samplers read them over PCIe. The formats created afterwards are
+   *        not pinned.
+   * \param cache_indptr Whether to also copy the row pointers of the CSR and the CSC
+   *        to ctx, where the samplers read them instead.
+   */
+  void PinMemory_(const DLContext& ctx, bool cache_indptr = false);
+
+  /*! \brief Unpin the arrays pinned by PinMemory_ and drop the cached row pointers. */
+  void UnpinMemory_();
+
+  /*! \return A copy of the graph with the formats created so far, see HeteroGraph::Snapshot */
+  HeteroGraphPtr Snapshot() const;
+
   /*! \return Load UnitGraph from stream, using CSRMatrix*/
   bool Load(dmlc::Stream* fs);
 
@@ -278,12 +322,53 @@ class UnitGraph : public BaseHeteroGraph {
    */
   std::tuple<UnitGraphPtr, IdArray, IdArray>ToSimple() const;
 
+  /*!
+   * \brief Remove the given edges, keeping all the created formats.
+   * \param eids The ids of the edges to remove.
+   * \return The new graph, whose edges are numbered in the order of their old ids,
+   *         and the old ids of its edges.
+   */
+  std::pair<UnitGraphPtr, IdArray> RemoveEdges(IdArray eids) const;
+
+  /*!
+   * \brief Add edges, keeping all the created formats.
+   *
+   * The new edges are merged into the created formats instead of building them
+   * again from all the edges. The sorted CSRs stay sorted.
+   *
+   * \param num_src The number of source nodes, no less than the current one.
+   * \param num_dst The number of destination nodes, no less than the current one.
+   * \param src The source nodes of the new edges.
+   * \param dst The destination nodes of the new edges.
+   * \return The new graph, whose new edges are numbered after the old ones.
+   */
+  UnitGraphPtr AppendEdges(int64_t num_src, int64_t num_dst, IdArray src, IdArray dst) const;
+
   void InvalidateCSR();
 
   void InvalidateCSC();
 
   void InvalidateCOO();
 
+  /*!
+   * \brief Set the memory budget of the formats, in bytes.
+   *
+   * Whenever creating a format makes the arrays of the created formats larger than
+   * the budget, the least recently used other formats are dropped until they fit or
+   * the new format is the only one left. A dropped format is created again from the
+   * remaining ones when needed. A negative budget, the default, means no limit.
+   * The budget is not kept by the copies and conversions of the graph.
+   */
+  void SetFormatMemoryBudget(int64_t budget);
+
+  /*! \return the memory budget of the formats in bytes, negative if unlimited */
+  int64_t GetFormatMemoryBudget() const {
+    return format_memory_budget_;
+  }
+
+  /*! \return the total size in bytes of the arrays of the created formats */
+  int64_t GetFormatMemoryUsage() const;
+
  private:
   friend class Serializer;
   friend class HeteroGraph;
@@ -338,6 +423,12 @@ class UnitGraph : public BaseHeteroGraph {
   /*! \return Whether the graph is hypersparse */
   bool IsHypersparse() const;
 
+  /*! \brief Record a use of the format, for the order of the eviction. */
+  void TouchFormat(SparseFormat format) const;
+
+  /*! \brief Drop the least recently used formats but keep until within the budget. */
+  void EvictFormats(SparseFormat keep);
+
   GraphPtr AsImmutableGraph() const override;
 
   // Graph stored in different format. We use an on-demand strategy: the format is
@@ -352,6 +443,23 @@ class UnitGraph : public BaseHeteroGraph {
    * \brief Storage format restriction.
    */
   dgl_format_code_t formats_;
+  /*! \brief Memory budget of the formats in bytes, negative if unlimited. */
+  int64_t format_memory_budget_ = -1;
+  /*! \brief Counter giving the order of the uses of the formats. */
+  mutable std::atomic<uint64_t> format_clock_{0};
+  /*! \brief Counter value of the last use of the COO, the CSR and the CSC. */
+  mutable std::atomic<uint64_t> format_last_use_[3] = {};
+  /*!
+   * \brief Mutex guarding the creation and the dropping of the formats, so that
+   *        a format requested by several threads is created by only one of them.
+   */
+  mutable std::mutex format_mutex_;
+  /*!
+   * \brief The formats known to be created, set under format_mutex_ once a format
+   *        is created and cleared before it is dropped, so that the created formats
+   *        are returned without locking.
+   */
+  mutable std::atomic<dgl_format_code_t> ready_formats_{0};
 };
 
 };  // namespace dgl
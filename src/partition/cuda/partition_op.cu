@@ -247,6 +247,107 @@ __global__ void _MapGlobalIndexByRangeKernel(
     global[idx] = local[idx] + range[part_id];
   }
 }
+
+/**
+* @brief Kernel to map element IDs to partition IDs, using a lookup table.
+*
+* @tparam IdType The type of element ID.
+* @tparam PartType The type of the lookup table.
+* @param part_map The partition ID of each element.
+* @param global The global element IDs.
+* @param num_elements The number of element IDs.
+* @param part_id The partition ID assigned to each element (output).
+*/
+template<typename IdType, typename PartType>
+__global__ void _MapProcByLookupKernel(
+    const PartType * const part_map,
+    const IdType * const global,
+    const int64_t num_elements,
+    IdType * const part_id) {
+  assert(num_elements <= gridDim.x*blockDim.x);
+  const int64_t idx = blockDim.x*static_cast<int64_t>(blockIdx.x)+threadIdx.x;
+
+  if (idx < num_elements) {
+    part_id[idx] = static_cast<IdType>(part_map[global[idx]]);
+  }
+}
+
+/**
+* @brief Kernel to map global element IDs to their ID within their respective
+* partition, or local element IDs within a partition to their global IDs,
+* using a lookup table.
+*
+* @tparam IdType The type of element ID.
+* @tparam PartType The type of the lookup table.
+* @param map The mapped ID of each element ID.
+* @param in The element IDs.
+* @param num_elements The number of elements.
+* @param out The mapped element IDs (output).
+*/
+template<typename IdType, typename PartType>
+__global__ void _MapIndexByLookupKernel(
+    const PartType * const map,
+    const IdType * const in,
+    const int64_t num_elements,
+    IdType * const out) {
+  assert(num_elements <= gridDim.x*blockDim.x);
+  const int64_t idx = threadIdx.x+blockDim.x*static_cast<int64_t>(blockIdx.x);
+
+  if (idx < num_elements) {
+    out[idx] = static_cast<IdType>(map[in[idx]]);
+  }
+}
+
+/**
+* @brief Kernel to map homogeneous IDs to their type and per-type ID, finding
+* the range of each ID by a binary search without branches on the data, so
+* that the threads of a warp do not diverge.
+*
+* @tparam IdType The type of ID.
+* @param range_starts The first ID of every range.
+* @param range_ends The last ID of every range, sorted.
+* @param typed_map The per-type ID of the first ID of every part after the
+* first and every type.
+* @param ids The homogeneous IDs.
+* @param num_ids The number of IDs.
+* @param num_parts The number of partitions.
+* @param num_types The number of types.
+* @param types The type of every ID (output).
+* @param per_type_ids The per-type ID of every ID (output).
+*/
+template<typename IdType>
+__global__ void _MapIdsToTypesKernel(
+    const IdType * const range_starts,
+    const IdType * const range_ends,
+    const IdType * const typed_map,
+    const IdType * const ids,
+    const int64_t num_ids,
+    const int num_parts,
+    const int num_types,
+    IdType * const types,
+    IdType * const per_type_ids) {
+  const int64_t num_ranges = static_cast<int64_t>(num_parts) * num_types;
+  const int64_t stride = static_cast<int64_t>(gridDim.x) * blockDim.x;
+  for (int64_t idx = blockDim.x*static_cast<int64_t>(blockIdx.x)+threadIdx.x;
+       idx < num_ids; idx += stride) {
+    const IdType id = ids[idx];
+    // rely on caching to load the ranges into L1 cache
+    const IdType * base = range_ends;
+    int64_t n = num_ranges;
+    while (n > 1) {
+      const int64_t half = n / 2;
+      base += (base[half - 1] < id) * half;
+      n -= half;
+    }
+    const int64_t range_id = (base - range_ends) + (*base < id);
+    assert(range_id < num_ranges);
+    const int type_id = range_id % num_types;
+    const int part_id = range_id / num_types;
+    const IdType offset = part_id == 0 ? 0 : typed_map[num_parts * type_id + part_id - 1];
+    types[idx] = type_id;
+    per_type_ids[idx] = id - range_starts[range_id] + offset;
+  }
+}
 }  // namespace
 
 // Remainder Based Partition Operations
@@ -745,6 +846,324 @@ MapToGlobalFromRange<kDLGPU, int64_t, int64_t>(
         int part_id);
 
 
+// Lookup Based Partition Operations
+
+template <DLDeviceType XPU, typename IdType, typename PartType>
+std::pair<IdArray, NDArray>
+GeneratePermutationFromLookup(
+        int64_t array_size,
+        int num_parts,
+        IdArray part_map,
+        IdArray in_idx) {
+  std::pair<IdArray, NDArray> result;
+
+  const auto& ctx = in_idx->ctx;
+  auto device = DeviceAPI::Get(ctx);
+  cudaStream_t stream = CUDAThreadEntry::ThreadLocal()->stream;
+
+  const int64_t num_in = in_idx->shape[0];
+
+  CHECK_GE(num_parts, 1) << "The number of partitions (" << num_parts <<
+      ") must be at least 1.";
+  if (num_parts == 1) {
+    // no permutation
+    result.first = aten::Range(0, num_in, sizeof(IdType)*8, ctx);
+    result.second = aten::Full(num_in, num_parts, sizeof(int64_t)*8, ctx);
+
+    return result;
+  }
+
+  result.first = aten::NewIdArray(num_in, ctx, sizeof(IdType)*8);
+  result.second = aten::Full(0, num_parts, sizeof(int64_t)*8, ctx);
+  int64_t * out_counts = static_cast<int64_t*>(result.second->data);
+  if (num_in == 0) {
+    // now that we've zero'd out_counts, nothing left to do for an empty
+    // mapping
+    return result;
+  }
+
+  const int64_t part_bits =
+      static_cast<int64_t>(std::ceil(std::log2(num_parts)));
+
+  // First, generate a mapping of indexes to processors
+  Workspace<IdType> proc_id_in(device, ctx, num_in);
+  {
+    const dim3 block(256);
+    const dim3 grid((num_in+block.x-1)/block.x);
+
+    CUDA_KERNEL_CALL(_MapProcByLookupKernel, grid, block, 0, stream,
+        static_cast<const PartType*>(part_map->data),
+        static_cast<const IdType*>(in_idx->data),
+        num_in,
+        proc_id_in.get());
+  }
+
+  // then create a permutation array that groups processors together by
+  // performing a radix sort
+  Workspace<IdType> proc_id_out(device, ctx, num_in);
+  IdType * perm_out = static_cast<IdType*>(result.first->data);
+  {
+    IdArray perm_in = aten::Range(0, num_in, sizeof(IdType)*8, ctx);
+
+    size_t sort_workspace_size;
+    CUDA_CALL(cub::DeviceRadixSort::SortPairs(nullptr, sort_workspace_size,
+        proc_id_in.get(), proc_id_out.get(), static_cast<IdType*>(perm_in->data), perm_out,
+        num_in, 0, part_bits, stream));
+
+    Workspace<void> sort_workspace(device, ctx, sort_workspace_size);
+    CUDA_CALL(cub::DeviceRadixSort::SortPairs(sort_workspace.get(), sort_workspace_size,
+        proc_id_in.get(), proc_id_out.get(), static_cast<IdType*>(perm_in->data), perm_out,
+        num_in, 0, part_bits, stream));
+  }
+  // explicitly free so workspace can be re-used
+  proc_id_in.free();
+
+  // perform a histogram and then prefixsum on the sorted proc_id vector
+
+  // Count the number of values to be sent to each processor
+  {
+    using AtomicCount = unsigned long long; // NOLINT
+    static_assert(sizeof(AtomicCount) == sizeof(*out_counts),
+        "AtomicCount must be the same width as int64_t for atomicAdd "
+        "in cub::DeviceHistogram::HistogramEven() to work");
+
+    // TODO(dlasalle): Once https://github.com/NVIDIA/cub/pull/287 is merged,
+    // add a compile time check against the cub version to allow
+    // num_in > (2 << 31).
+    CHECK(num_in < static_cast<int64_t>(std::numeric_limits<int>::max())) <<
+        "number of values to insert into histogram must be less than max "
+        "value of int.";
+
+    size_t hist_workspace_size;
+    CUDA_CALL(cub::DeviceHistogram::HistogramEven(
+        nullptr,
+        hist_workspace_size,
+        proc_id_out.get(),
+        reinterpret_cast<AtomicCount*>(out_counts),
+        num_parts+1,
+        static_cast<IdType>(0),
+        static_cast<IdType>(num_parts+1),
+        static_cast<int>(num_in),
+        stream));
+
+    Workspace<void> hist_workspace(device, ctx, hist_workspace_size);
+    CUDA_CALL(cub::DeviceHistogram::HistogramEven(
+        hist_workspace.get(),
+        hist_workspace_size,
+        proc_id_out.get(),
+        reinterpret_cast<AtomicCount*>(out_counts),
+        num_parts+1,
+        static_cast<IdType>(0),
+        static_cast<IdType>(num_parts+1),
+        static_cast<int>(num_in),
+        stream));
+  }
+
+  return result;
+}
+
+
+template std::pair<IdArray, IdArray>
+GeneratePermutationFromLookup<kDLGPU, int32_t, int32_t>(
+        int64_t array_size,
+        int num_parts,
+        IdArray part_map,
+        IdArray in_idx);
+template std::pair<IdArray, IdArray>
+GeneratePermutationFromLookup<kDLGPU, int64_t, int32_t>(
+        int64_t array_size,
+        int num_parts,
+        IdArray part_map,
+        IdArray in_idx);
+template std::pair<IdArray, IdArray>
+GeneratePermutationFromLookup<kDLGPU, int32_t, int64_t>(
+        int64_t array_size,
+        int num_parts,
+        IdArray part_map,
+        IdArray in_idx);
+template std::pair<IdArray, IdArray>
+GeneratePermutationFromLookup<kDLGPU, int64_t, int64_t>(
+        int64_t array_size,
+        int num_parts,
+        IdArray part_map,
+        IdArray in_idx);
+
+template <DLDeviceType XPU, typename IdType, typename PartType>
+IdArray MapToLocalFromLookup(
+    const int num_parts,
+    IdArray local_map,
+    IdArray global_idx) {
+  const auto& ctx = global_idx->ctx;
+  cudaStream_t stream = CUDAThreadEntry::ThreadLocal()->stream;
+
+  if (num_parts > 1 && global_idx->shape[0] > 0) {
+    IdArray local_idx = aten::NewIdArray(global_idx->shape[0], ctx,
+        sizeof(IdType)*8);
+
+    const dim3 block(128);
+    const dim3 grid((global_idx->shape[0] +block.x-1)/block.x);
+
+    CUDA_KERNEL_CALL(
+        _MapIndexByLookupKernel,
+        grid,
+        block,
+        0,
+        stream,
+        static_cast<const PartType*>(local_map->data),
+        static_cast<const IdType*>(global_idx->data),
+        global_idx->shape[0],
+        static_cast<IdType*>(local_idx->data));
+
+    return local_idx;
+  } else {
+    // no mapping to be done
+    return global_idx;
+  }
+}
+
+template IdArray
+MapToLocalFromLookup<kDLGPU, int32_t, int32_t>(
+        int num_parts,
+        IdArray local_map,
+        IdArray in_idx);
+template IdArray
+MapToLocalFromLookup<kDLGPU, int64_t, int32_t>(
+        int num_parts,
+        IdArray local_map,
+        IdArray in_idx);
+template IdArray
+MapToLocalFromLookup<kDLGPU, int32_t, int64_t>(
+        int num_parts,
+        IdArray local_map,
+        IdArray in_idx);
+template IdArray
+MapToLocalFromLookup<kDLGPU, int64_t, int64_t>(
+        int num_parts,
+        IdArray local_map,
+        IdArray in_idx);
+
+template <DLDeviceType XPU, typename IdType, typename PartType>
+IdArray MapToGlobalFromLookup(
+    const int num_parts,
+    IdArray global_map,
+    const int64_t part_offset,
+    IdArray local_idx,
+    const int part_id) {
+  CHECK_LT(part_id, num_parts) << "Invalid partition id " << part_id <<
+      "/" << num_parts;
+  CHECK_GE(part_id, 0) << "Invalid partition id " << part_id <<
+      "/" << num_parts;
+
+  const auto& ctx = local_idx->ctx;
+  cudaStream_t stream = CUDAThreadEntry::ThreadLocal()->stream;
+
+  if (num_parts > 1 && local_idx->shape[0] > 0) {
+    IdArray global_idx = aten::NewIdArray(local_idx->shape[0], ctx,
+        sizeof(IdType)*8);
+
+    const dim3 block(128);
+    const dim3 grid((local_idx->shape[0] +block.x-1)/block.x);
+
+    CUDA_KERNEL_CALL(
+        _MapIndexByLookupKernel,
+        grid,
+        block,
+        0,
+        stream,
+        static_cast<const PartType*>(global_map->data) + part_offset,
+        static_cast<const IdType*>(local_idx->data),
+        global_idx->shape[0],
+        static_cast<IdType*>(global_idx->data));
+
+    return global_idx;
+  } else {
+    // no mapping to be done
+    return local_idx;
+  }
+}
+
+template IdArray
+MapToGlobalFromLookup<kDLGPU, int32_t, int32_t>(
+        int num_parts,
+        IdArray global_map,
+        int64_t part_offset,
+        IdArray in_idx,
+        int part_id);
+template IdArray
+MapToGlobalFromLookup<kDLGPU, int64_t, int32_t>(
+        int num_parts,
+        IdArray global_map,
+        int64_t part_offset,
+        IdArray in_idx,
+        int part_id);
+template IdArray
+MapToGlobalFromLookup<kDLGPU, int32_t, int64_t>(
+        int num_parts,
+        IdArray global_map,
+        int64_t part_offset,
+        IdArray in_idx,
+        int part_id);
+template IdArray
+MapToGlobalFromLookup<kDLGPU, int64_t, int64_t>(
+        int num_parts,
+        IdArray global_map,
+        int64_t part_offset,
+        IdArray in_idx,
+        int part_id);
+
+
+template <DLDeviceType XPU, typename IdType>
+IdArray MapIdsToTypes(
+    IdArray ids,
+    IdArray range_starts,
+    IdArray range_ends,
+    IdArray typed_map,
+    int num_parts,
+    int num_types) {
+  const auto& ctx = ids->ctx;
+  cudaStream_t stream = CUDAThreadEntry::ThreadLocal()->stream;
+  const int64_t num_ids = ids->shape[0];
+  IdArray ret = aten::NewIdArray(num_ids * 2, ctx, sizeof(IdType)*8);
+
+  const dim3 block(128);
+  const dim3 grid((num_ids+block.x-1)/block.x);
+  CUDA_KERNEL_CALL(
+      _MapIdsToTypesKernel,
+      grid,
+      block,
+      0,
+      stream,
+      static_cast<const IdType*>(range_starts->data),
+      static_cast<const IdType*>(range_ends->data),
+      static_cast<const IdType*>(typed_map->data),
+      static_cast<const IdType*>(ids->data),
+      num_ids,
+      num_parts,
+      num_types,
+      static_cast<IdType*>(ret->data),
+      static_cast<IdType*>(ret->data) + num_ids);
+
+  return ret;
+}
+
+template IdArray
+MapIdsToTypes<kDLGPU, int32_t>(
+        IdArray ids,
+        IdArray range_starts,
+        IdArray range_ends,
+        IdArray typed_map,
+        int num_parts,
+        int num_types);
+template IdArray
+MapIdsToTypes<kDLGPU, int64_t>(
+        IdArray ids,
+        IdArray range_starts,
+        IdArray range_ends,
+        IdArray typed_map,
+        int num_parts,
+        int num_types);
+
+
 }  // namespace impl
 }  // namespace partition
 }  // namespace dgl
@@ -10,6 +10,7 @@
 #include <dgl/runtime/packed_func.h>
 #include <utility>
 #include <memory>
+#include <vector>
 
 #include "partition_op.h"
 
@@ -208,6 +209,145 @@ class RangePartition : public NDArrayPartition {
   IdArray range_cpu_;
 };
 
+class LookupPartition : public NDArrayPartition {
+ public:
+  LookupPartition(
+      const int64_t array_size,
+      const int num_parts,
+      IdArray part_map) :
+    NDArrayPartition(array_size, num_parts),
+    part_map_(part_map),
+    part_offset_(num_parts+1, 0) {
+    auto ctx = part_map->ctx;
+    if (ctx.device_type != kDLGPU) {
+        LOG(FATAL) << "The part map for an NDArrayPartition is only supported "
+            " on GPUs. Transfer the part map to the target device before "
+            "creating the partition.";
+    }
+    CHECK_EQ(part_map->ndim, 1) << "The part map must be one dimensional.";
+    CHECK_EQ(part_map->shape[0], array_size) << "The part map (" <<
+        part_map->shape[0] << ") must have an entry for each row of the "
+        "array (" << array_size << ").";
+
+    // Number the rows of each part once, on the CPU, into the tables mapping
+    // the global indices to the local ones and back.
+    IdArray part_map_cpu = part_map.CopyTo(DGLContext{kDLCPU, 0});
+    IdArray local_map_cpu = IdArray::Empty({array_size}, part_map->dtype,
+        DGLContext{kDLCPU, 0});
+    IdArray global_map_cpu = IdArray::Empty({array_size}, part_map->dtype,
+        DGLContext{kDLCPU, 0});
+    ATEN_ID_TYPE_SWITCH(part_map->dtype, PartType, {
+      const PartType * const parts = part_map_cpu.Ptr<PartType>();
+      for (int64_t i = 0; i < array_size; ++i) {
+        CHECK(parts[i] >= 0 && parts[i] < num_parts) << "Invalid part ID (" <<
+            parts[i] << ") of row " << i << " for partition of size " <<
+            num_parts << ".";
+        ++part_offset_[parts[i]+1];
+      }
+      for (int p = 0; p < num_parts; ++p) {
+        part_offset_[p+1] += part_offset_[p];
+      }
+
+      std::vector<int64_t> part_size(num_parts, 0);
+      PartType * const local = local_map_cpu.Ptr<PartType>();
+      PartType * const global = global_map_cpu.Ptr<PartType>();
+      for (int64_t i = 0; i < array_size; ++i) {
+        const PartType p = parts[i];
+        local[i] = static_cast<PartType>(part_size[p]);
+        global[part_offset_[p]+part_size[p]] = static_cast<PartType>(i);
+        ++part_size[p];
+      }
+    });
+    local_map_ = local_map_cpu.CopyTo(ctx);
+    global_map_ = global_map_cpu.CopyTo(ctx);
+  }
+
+  std::pair<IdArray, NDArray>
+  GeneratePermutation(
+      IdArray in_idx) const override {
+    auto ctx = in_idx->ctx;
+
+#ifdef DGL_USE_CUDA
+    if (ctx.device_type == kDLGPU) {
+      if (ctx.device_type != part_map_->ctx.device_type ||
+          ctx.device_id != part_map_->ctx.device_id) {
+        LOG(FATAL) << "The part map for the NDArrayPartition and the input "
+            "array must be on the same device: " << ctx << " vs. " << part_map_->ctx;
+      }
+      ATEN_ID_TYPE_SWITCH(in_idx->dtype, IdType, {
+        ATEN_ID_TYPE_SWITCH(part_map_->dtype, PartType, {
+          return impl::GeneratePermutationFromLookup<kDLGPU, IdType, PartType>(
+              ArraySize(), NumParts(), part_map_, in_idx);
+        });
+      });
+    }
+#endif
+
+    LOG(FATAL) << "Lookup based partitioning for the CPU is not yet "
+        "implemented.";
+    // should be unreachable
+    return std::pair<IdArray, NDArray>{};
+  }
+
+  IdArray MapToLocal(
+      IdArray in_idx) const override {
+    auto ctx = in_idx->ctx;
+#ifdef DGL_USE_CUDA
+    if (ctx.device_type == kDLGPU) {
+      ATEN_ID_TYPE_SWITCH(in_idx->dtype, IdType, {
+        ATEN_ID_TYPE_SWITCH(local_map_->dtype, PartType, {
+          return impl::MapToLocalFromLookup<kDLGPU, IdType, PartType>(
+              NumParts(), local_map_, in_idx);
+        });
+      });
+    }
+#endif
+
+    LOG(FATAL) << "Lookup based partitioning for the CPU is not yet "
+        "implemented.";
+    // should be unreachable
+    return IdArray{};
+  }
+
+  IdArray MapToGlobal(
+      IdArray in_idx,
+      const int part_id) const override {
+    CHECK_LT(part_id, NumParts()) << "Invalid part ID (" << part_id << ") for "
+        "partition of size " << NumParts() << ".";
+    auto ctx = in_idx->ctx;
+#ifdef DGL_USE_CUDA
+    if (ctx.device_type == kDLGPU) {
+      ATEN_ID_TYPE_SWITCH(in_idx->dtype, IdType, {
+        ATEN_ID_TYPE_SWITCH(global_map_->dtype, PartType, {
+          return impl::MapToGlobalFromLookup<kDLGPU, IdType, PartType>(
+              NumParts(), global_map_, part_offset_[part_id], in_idx, part_id);
+        });
+      });
+    }
+#endif
+
+    LOG(FATAL) << "Lookup based partitioning for the CPU is not yet "
+        "implemented.";
+    // should be unreachable
+    return IdArray{};
+  }
+
+  int64_t PartSize(const int part_id) const override {
+    CHECK_LT(part_id, NumParts()) << "Invalid part ID (" << part_id << ") for "
+        "partition of size " << NumParts() << ".";
+    return part_offset_[part_id+1]-part_offset_[part_id];
+  }
+
+ private:
+  IdArray part_map_;
+  // the local index of each row within its part
+  IdArray local_map_;
+  // the rows of each part, in the order of their local indices
+  IdArray global_map_;
+  // the exclusive prefix-sum of the part sizes, on the CPU
+  std::vector<int64_t> part_offset_;
+};
+
 NDArrayPartitionRef CreatePartitionRemainderBased(
     const int64_t array_size,
     const int num_parts) {
@@ -225,6 +365,16 @@ NDArrayPartitionRef CreatePartitionRangeBased(
       range));
 }
 
+NDArrayPartitionRef CreatePartitionLookupBased(
+    const int64_t array_size,
+    const int num_parts,
+    IdArray part_map) {
+  return NDArrayPartitionRef(std::make_shared<LookupPartition>(
+      array_size,
+      num_parts,
+      part_map));
+}
+
 DGL_REGISTER_GLOBAL("partition._CAPI_DGLNDArrayPartitionCreateRemainderBased")
 .set_body([] (DGLArgs args, DGLRetValue* rv) {
   int64_t array_size = args[0];
@@ -242,6 +392,15 @@ DGL_REGISTER_GLOBAL("partition._CAPI_DGLNDArrayPartitionCreateRangeBased")
   *rv = CreatePartitionRangeBased(array_size, num_parts, range);
 });
 
+DGL_REGISTER_GLOBAL("partition._CAPI_DGLNDArrayPartitionCreateLookupBased")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+  const int64_t array_size = args[0];
+  const int num_parts = args[1];
+  IdArray part_map = args[2];
+
+  *rv = CreatePartitionLookupBased(array_size, num_parts, part_map);
+});
+
 
 
 DGL_REGISTER_GLOBAL("partition._CAPI_DGLNDArrayPartitionGetPartSize")
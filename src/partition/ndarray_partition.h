@@ -140,6 +140,23 @@ NDArrayPartitionRef CreatePartitionRangeBased(
     int num_parts,
     IdArray range);
 
+/**
+ * @brief Create a new partition object, using a lookup table of the part of
+ * each row, e.g., from METIS, to assign rows to parts. The local index of a
+ * row is its rank among the rows of its part, in increasing order.
+ *
+ * @param array_size The size of the partitioned array.
+ * @param num_parts The number of parts the array is partitioned into.
+ * @param part_map The part id of each row, of length `array_size`. Must be on
+ * the GPU of the partitioned array.
+ *
+ * @return The partition object.
+ */
+NDArrayPartitionRef CreatePartitionLookupBased(
+    int64_t array_size,
+    int num_parts,
+    IdArray part_map);
+
 }  // namespace partition
 }  // namespace dgl
 
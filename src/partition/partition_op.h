@@ -147,7 +147,109 @@ IdArray MapToGlobalFromRange(
     IdArray local_idx,
     int part_id);
 
+/**
+ * @brief Create a permutation that groups indices by the part id when used for
+ * slicing, via a lookup table of the part id of every row. That is, for the
+ * input indices A, find I such that A[I] is grouped by part ID.
+ *
+ * For example, if we have the part ids [1, 0, 0, 1, 0, 1] for the rows, and
+ * the set of indices [3, 1, 4, 0], the permutation vector would be
+ * [1, 2, 0, 3].
+ *
+ * @tparam XPU The type of device to run on.
+ * @tparam IdType The type of the index.
+ * @tparam PartType The type of the lookup table.
+ * @param array_size The total size of the partitioned array.
+ * @param num_parts The number parts the array id divided into.
+ * @param part_map The part id of each row of the array. Must be on the same
+ * context as `in_idx`.
+ * @param in_idx The array of indices to group by part id.
+ *
+ * @return The permutation to group the indices by part id, and the number of
+ * indices in each part.
+ */
+template <DLDeviceType XPU, typename IdType, typename PartType>
+std::pair<IdArray, IdArray>
+GeneratePermutationFromLookup(
+        int64_t array_size,
+        int num_parts,
+        IdArray part_map,
+        IdArray in_idx);
 
+/**
+ * @brief Generate the set of local indices from the global indices, using a
+ * lookup table. That is, for each index `i` in `global_idx`, the local index
+ * is computed as `local_map[global_idx[i]]`.
+ *
+ * @tparam XPU The type of device to run on.
+ * @tparam IdType The type of the index.
+ * @tparam PartType The type of the lookup table.
+ * @param num_parts The number parts the array id divided into.
+ * @param local_map The local index of each row of the array within its part.
+ * Must be on the same context as `global_idx`.
+ * @param global_idx The array of global indices to map.
+ *
+ * @return The array of local indices.
+ */
+template <DLDeviceType XPU, typename IdType, typename PartType>
+IdArray MapToLocalFromLookup(
+    int num_parts,
+    IdArray local_map,
+    IdArray global_idx);
+
+/**
+ * @brief Generate the set of global indices from the local indices, using a
+ * lookup table. That is, for each index `i` in `local_idx`, the global index
+ * is computed as `global_map[part_offset + local_idx[i]]`.
+ *
+ * @tparam XPU The type of device to run on.
+ * @tparam IdType The type of the index.
+ * @tparam PartType The type of the lookup table.
+ * @param num_parts The number parts the array id divided into.
+ * @param global_map The rows of the array, grouped by part, in the order of
+ * their local indices. Must be on the same context as `local_idx`.
+ * @param part_offset The offset of the rows of the current part in
+ * `global_map`.
+ * @param local_idx The array of local indices to map.
+ * @param part_id The id of the current part.
+ *
+ * @return The array of global indices.
+ */
+template <DLDeviceType XPU, typename IdType, typename PartType>
+IdArray MapToGlobalFromLookup(
+    int num_parts,
+    IdArray global_map,
+    int64_t part_offset,
+    IdArray local_idx,
+    int part_id);
+
+/**
+ * @brief Map the homogeneous IDs of a partitioned heterograph to their type
+ * and per-type IDs. The IDs of part p and type t are the range
+ * [range_starts[p * num_types + t], range_ends[p * num_types + t]], and the
+ * per-type IDs of a type continue from one part to the next.
+ *
+ * @tparam XPU The type of device to run on.
+ * @tparam IdType The type of the index.
+ * @param ids The homogeneous IDs to map.
+ * @param range_starts The first ID of every range, sorted.
+ * @param range_ends The last ID of every range, sorted.
+ * @param typed_map The number of IDs of each type in the first parts, that is
+ * the per-type ID of the first ID of part p + 1 and type t at
+ * `num_parts * t + p`.
+ * @param num_parts The number of parts.
+ * @param num_types The number of types.
+ *
+ * @return The types of the IDs, followed by their per-type IDs.
+ */
+template <DLDeviceType XPU, typename IdType>
+IdArray MapIdsToTypes(
+    IdArray ids,
+    IdArray range_starts,
+    IdArray range_ends,
+    IdArray typed_map,
+    int num_parts,
+    int num_types);
 
 }  // namespace impl
 }  // namespace partition
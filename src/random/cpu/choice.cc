@@ -63,7 +63,7 @@ void RandomEngine::UniformChoice(IdxType num, IdxType population, IdxType* out,
     CHECK_LE(num, population)
       << "Cannot take more sample than population when 'replace=false'";
   if (replace) {
-    for (IdxType i = 0; i < num; ++i) out[i] = RandInt(population);
+    RandInt<IdxType>(0, population, num, out);
   } else {
     if (num <
         population / 10) {  // TODO(minjie): may need a better threshold here
@@ -0,0 +1,148 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file rpc/feature_cache.cc
+ * \brief Cache of the remote rows of a KVStore tensor, used by fast pull.
+ */
+#include "./feature_cache.h"
+
+#include <dmlc/logging.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace dgl {
+namespace rpc {
+
+namespace {
+
+/*! \brief The smallest number of sketch counters. */
+constexpr int64_t kMinSketchSize = 1024;
+
+/*! \brief The sketch counters are halved after this many counts per counter. */
+constexpr int64_t kSketchAgingPeriod = 8;
+
+/*! \brief Mix the bits of an ID, as splitmix64 does. */
+inline uint64_t HashID(int64_t id) {
+  uint64_t x = static_cast<uint64_t>(id) + 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+}  // namespace
+
+FeatureCache::FeatureCache(int64_t row_size, int64_t budget, int admit_threshold)
+  : row_size_(row_size),
+    capacity_(row_size > 0 ? budget / row_size : 0),
+    admit_threshold_(admit_threshold) {
+  CHECK_GT(row_size, 0) << "Invalid row size of feature cache.";
+  CHECK_GE(admit_threshold, 0) << "Invalid admission threshold of feature cache.";
+  rows_.resize(capacity_ * row_size_);
+  ids_.assign(capacity_, -1);
+  referenced_.assign(capacity_, 0);
+  pinned_.assign(capacity_, 0);
+  index_.reserve(capacity_);
+  int64_t sketch_size = kMinSketchSize;
+  while (sketch_size < 4 * capacity_)
+    sketch_size *= 2;
+  sketch_.assign(sketch_size, 0);
+}
+
+const char* FeatureCache::Lookup(int64_t id) {
+  auto it = index_.find(id);
+  if (it == index_.end()) {
+    ++num_misses_;
+    if (admit_threshold_ > 0) {
+      uint8_t* counter = Counter(id);
+      if (*counter < std::numeric_limits<uint8_t>::max())
+        ++*counter;
+      if (++num_counted_ == kSketchAgingPeriod * static_cast<int64_t>(sketch_.size())) {
+        for (uint8_t& c : sketch_)
+          c >>= 1;
+        num_counted_ = 0;
+      }
+    }
+    return nullptr;
+  }
+  ++num_hits_;
+  referenced_[it->second] = 1;
+  return rows_.data() + it->second * row_size_;
+}
+
+void FeatureCache::Offer(int64_t id, const char* row) {
+  if (admit_threshold_ == 0 || *Counter(id) < admit_threshold_ || index_.count(id))
+    return;
+  Insert(id, row, false);
+}
+
+bool FeatureCache::Pin(int64_t id, const char* row) {
+  return Insert(id, row, true);
+}
+
+void FeatureCache::Invalidate(const int64_t* ids, int64_t num_ids) {
+  for (int64_t i = 0; i < num_ids; ++i) {
+    auto it = index_.find(ids[i]);
+    if (it == index_.end())
+      continue;
+    const int64_t slot = it->second;
+    if (pinned_[slot])
+      --num_pinned_;
+    ids_[slot] = -1;
+    referenced_[slot] = 0;
+    pinned_[slot] = 0;
+    index_.erase(it);
+  }
+}
+
+bool FeatureCache::Insert(int64_t id, const char* row, bool pinned) {
+  int64_t slot;
+  auto it = index_.find(id);
+  if (it != index_.end()) {
+    slot = it->second;
+  } else {
+    slot = FindSlot();
+    if (slot < 0)
+      return false;
+    if (ids_[slot] >= 0)
+      index_.erase(ids_[slot]);
+    ids_[slot] = id;
+    index_[id] = slot;
+  }
+  std::memcpy(rows_.data() + slot * row_size_, row, row_size_);
+  referenced_[slot] = 0;
+  if (pinned && !pinned_[slot])
+    ++num_pinned_;
+  pinned_[slot] |= pinned;
+  return true;
+}
+
+int64_t FeatureCache::FindSlot() {
+  if (num_pinned_ == capacity_)
+    return -1;
+  if (num_rows() < capacity_) {
+    // take an empty slot, so that nothing is evicted before the cache is full
+    while (ids_[hand_] >= 0)
+      hand_ = (hand_ + 1) % capacity_;
+    return hand_;
+  }
+  // CLOCK: the referenced rows get a second chance
+  while (true) {
+    const int64_t slot = hand_;
+    hand_ = (hand_ + 1) % capacity_;
+    if (pinned_[slot])
+      continue;
+    if (referenced_[slot]) {
+      referenced_[slot] = 0;
+      continue;
+    }
+    return slot;
+  }
+}
+
+uint8_t* FeatureCache::Counter(int64_t id) {
+  return &sketch_[HashID(id) & (sketch_.size() - 1)];
+}
+
+}  // namespace rpc
+}  // namespace dgl
@@ -0,0 +1,96 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file rpc/feature_cache.h
+ * \brief Cache of the remote rows of a KVStore tensor, used by fast pull.
+ *
+ * The cache of a tensor holds a fixed number of rows, given by its byte
+ * budget, keyed by global ID. Rows get in either by being pinned, e.g. the
+ * rows of the nodes of highest degree, or by frequency: each miss is counted
+ * in a small counting sketch, and a pulled row is admitted once its ID has
+ * missed admit_threshold times. When the cache is full, an admitted row
+ * replaces an unpinned row chosen by the CLOCK policy. The sketch counters
+ * are halved periodically, so that the admission follows the recent pulls.
+ *
+ * The cache is not synchronized with the servers: the rows pushed by this
+ * client are invalidated, but those pushed by other clients are not.
+ */
+#ifndef DGL_RPC_FEATURE_CACHE_H_
+#define DGL_RPC_FEATURE_CACHE_H_
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace dgl {
+namespace rpc {
+
+class FeatureCache {
+ public:
+  /*!
+   * \param row_size The size of a row in bytes.
+   * \param budget The size of all the cached rows in bytes.
+   * \param admit_threshold The number of misses of an ID before its row is
+   *        admitted, or 0 to admit the pinned rows only.
+   */
+  FeatureCache(int64_t row_size, int64_t budget, int admit_threshold);
+
+  /*!
+   * \brief Look up the row of an ID, counting the hit or miss.
+   * \return The row, or nullptr on miss.
+   */
+  const char* Lookup(int64_t id);
+
+  /*!
+   * \brief Offer a pulled row, which is cached if its ID has missed often
+   *        enough.
+   */
+  void Offer(int64_t id, const char* row);
+
+  /*!
+   * \brief Cache a row that is never evicted.
+   * \return Whether the row has been cached, i.e. the cache was not full of
+   *         pinned rows.
+   */
+  bool Pin(int64_t id, const char* row);
+
+  /*! \brief Drop the rows of some IDs, e.g. after pushing them. */
+  void Invalidate(const int64_t* ids, int64_t num_ids);
+
+  int64_t row_size() const { return row_size_; }
+  int64_t capacity() const { return capacity_; }
+  int64_t num_rows() const { return static_cast<int64_t>(index_.size()); }
+  int64_t num_hits() const { return num_hits_; }
+  int64_t num_misses() const { return num_misses_; }
+
+ private:
+  /*! \brief Insert a row, evicting another one if full. */
+  bool Insert(int64_t id, const char* row, bool pinned);
+
+  /*! \return The slot to insert into, or -1 if all slots are pinned. */
+  int64_t FindSlot();
+
+  /*! \return The sketch counter of an ID. */
+  uint8_t* Counter(int64_t id);
+
+  const int64_t row_size_;
+  const int64_t capacity_;
+  const int admit_threshold_;
+  std::vector<char> rows_;
+  // the ID of each slot, -1 if empty
+  std::vector<int64_t> ids_;
+  // the CLOCK reference bit of each slot
+  std::vector<uint8_t> referenced_;
+  std::vector<uint8_t> pinned_;
+  std::unordered_map<int64_t, int64_t> index_;
+  int64_t num_pinned_ = 0;
+  int64_t hand_ = 0;
+  std::vector<uint8_t> sketch_;
+  int64_t num_counted_ = 0;
+  int64_t num_hits_ = 0;
+  int64_t num_misses_ = 0;
+};
+
+}  // namespace rpc
+}  // namespace dgl
+
+#endif  // DGL_RPC_FEATURE_CACHE_H_
@@ -0,0 +1,226 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file lockfree_msg_queue.cc
+ * \brief Lock-free message queue for DGL distributed training.
+ */
+#include <dmlc/logging.h>
+
+#include <algorithm>
+#include <thread>
+
+#include "lockfree_msg_queue.h"
+
+namespace dgl {
+namespace network {
+
+namespace {
+
+/*! \brief Bounds of the number of spins before parking */
+constexpr int kMinSpinCount = 16;
+constexpr int kMaxSpinCount = 4096;
+
+}  // namespace
+
+constexpr int64_t LockFreeMessageQueue::kDefaultNumSlots;
+
+LockFreeMessageQueue::LockFreeMessageQueue(int64_t queue_size, int num_producers,
+                                           int64_t num_slots)
+  : MessageQueue(queue_size, num_producers),
+    free_bytes_(queue_size),
+    spin_count_(kMinSpinCount) {
+  CHECK_GT(num_slots, 0);
+  size_t capacity = 1;
+  while (capacity < static_cast<size_t>(num_slots)) {
+    capacity <<= 1;
+  }
+  slots_.reset(new Slot[capacity]);
+  for (size_t i = 0; i < capacity; ++i) {
+    slots_[i].seq.store(i, std::memory_order_relaxed);
+  }
+  mask_ = capacity - 1;
+}
+
+bool LockFreeMessageQueue::TryReserve(int64_t size) {
+  int64_t free = free_bytes_.load();
+  while (free >= size) {
+    if (free_bytes_.compare_exchange_weak(free, free - size)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool LockFreeMessageQueue::TryPush(const Message& msg) {
+  size_t pos = add_pos_.load(std::memory_order_relaxed);
+  for (;;) {
+    Slot& slot = slots_[pos & mask_];
+    const size_t seq = slot.seq.load(std::memory_order_acquire);
+    const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+    if (diff == 0) {
+      if (add_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        slot.msg = msg;
+        slot.seq.store(pos + 1, std::memory_order_release);
+        return true;
+      }
+    } else if (diff < 0) {
+      return false;  // the slot has not been removed yet
+    } else {
+      pos = add_pos_.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+bool LockFreeMessageQueue::TryPop(Message* msg) {
+  size_t pos = remove_pos_.load(std::memory_order_relaxed);
+  for (;;) {
+    Slot& slot = slots_[pos & mask_];
+    const size_t seq = slot.seq.load(std::memory_order_acquire);
+    const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+    if (diff == 0) {
+      if (remove_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        *msg = std::move(slot.msg);
+        slot.msg.deallocator = nullptr;
+        slot.seq.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+      }
+    } else if (diff < 0) {
+      return false;  // the slot has not been added yet
+    } else {
+      pos = remove_pos_.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+template <typename Pred>
+void LockFreeMessageQueue::Wait(std::atomic<int>* num_parked,
+                                std::condition_variable* cond, Pred ready) {
+  const int spin_count = spin_count_.load(std::memory_order_relaxed);
+  for (int i = 0; i < spin_count; ++i) {
+    if (ready()) {
+      // spinning pays off, spin longer next time
+      spin_count_.store(std::min(spin_count * 2, kMaxSpinCount), std::memory_order_relaxed);
+      return;
+    }
+    if (i >= spin_count / 2) {
+      std::this_thread::yield();
+    }
+  }
+  spin_count_.store(std::max(spin_count / 2, kMinSpinCount), std::memory_order_relaxed);
+  // the other side checks num_parked after changing the queue, and locks to
+  // wake, so the queue is checked again here before sleeping
+  ++*num_parked;
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond->wait(lock, ready);
+  }
+  --*num_parked;
+}
+
+void LockFreeMessageQueue::Wake(std::atomic<int>* num_parked,
+                                std::condition_variable* cond) {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (num_parked->load() > 0) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cond->notify_all();
+  }
+}
+
+STATUS LockFreeMessageQueue::Add(Message msg, bool is_blocking) {
+  // check if message is too long to fit into the queue
+  if (msg.size > queue_size_) {
+    LOG(WARNING) << "Message is larger than the queue.";
+    return MSG_GT_SIZE;
+  }
+  if (msg.size <= 0) {
+    LOG(WARNING) << "Message size (" << msg.size << ") is negative or zero.";
+    return MSG_LE_ZERO;
+  }
+  if (exit_flag_.load()) {
+    return QUEUE_CLOSE;
+  }
+  if (!TryReserve(msg.size)) {
+    if (!is_blocking) {
+      return QUEUE_FULL;
+    }
+    Wait(&num_parked_producers_, &cond_not_full_,
+         [&]() { return TryReserve(msg.size); });
+  }
+  if (!TryPush(msg)) {
+    if (!is_blocking) {
+      free_bytes_ += msg.size;
+      return QUEUE_FULL;
+    }
+    Wait(&num_parked_producers_, &cond_not_full_,
+         [&]() { return TryPush(msg); });
+  }
+  Wake(&num_parked_consumers_, &cond_not_empty_);
+  return ADD_SUCCESS;
+}
+
+STATUS LockFreeMessageQueue::Remove(Message* msg, bool is_blocking) {
+  if (!TryPop(msg)) {
+    if (!is_blocking) {
+      return QUEUE_EMPTY;
+    }
+    bool removed = false;
+    Wait(&num_parked_consumers_, &cond_not_empty_, [&]() {
+      removed = TryPop(msg);
+      return removed || exit_flag_.load();
+    });
+    // all producers may have finished while the last messages were added
+    if (!removed && !TryPop(msg)) {
+      return QUEUE_CLOSE;
+    }
+  }
+  free_bytes_ += msg->size;
+  Wake(&num_parked_producers_, &cond_not_full_);
+  return REMOVE_SUCCESS;
+}
+
+STATUS LockFreeMessageQueue::RemoveBatch(std::vector<Message>* msgs, int max_count) {
+  msgs->clear();
+  Message msg;
+  if (!TryPop(&msg)) {
+    bool removed = false;
+    Wait(&num_parked_consumers_, &cond_not_empty_, [&]() {
+      removed = TryPop(&msg);
+      return removed || exit_flag_.load();
+    });
+    if (!removed && !TryPop(&msg)) {
+      return QUEUE_CLOSE;
+    }
+  }
+  // the space of the whole batch is freed at once, with a single wake
+  int64_t size = msg.size;
+  msgs->push_back(std::move(msg));
+  while (static_cast<int>(msgs->size()) < max_count && TryPop(&msg)) {
+    size += msg.size;
+    msgs->push_back(std::move(msg));
+  }
+  free_bytes_ += size;
+  Wake(&num_parked_producers_, &cond_not_full_);
+  return REMOVE_SUCCESS;
+}
+
+void LockFreeMessageQueue::SignalFinished(int producer_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  finished_producers_.insert(producer_id);
+  // if all producers have finished, consumers should be
+  // waken up to get this signal
+  if (finished_producers_.size() >= num_producers_) {
+    exit_flag_.store(true);
+    cond_not_empty_.notify_all();
+  }
+}
+
+bool LockFreeMessageQueue::Empty() const {
+  return remove_pos_.load() == add_pos_.load();
+}
+
+bool LockFreeMessageQueue::EmptyAndNoMoreAdd() const {
+  return exit_flag_.load() && Empty();
+}
+
+}  // namespace network
+}  // namespace dgl
@@ -0,0 +1,116 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file lockfree_msg_queue.h
+ * \brief Lock-free message queue for DGL distributed training.
+ */
+#ifndef DGL_RPC_NETWORK_LOCKFREE_MSG_QUEUE_H_
+#define DGL_RPC_NETWORK_LOCKFREE_MSG_QUEUE_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "msg_queue.h"
+
+namespace dgl {
+namespace network {
+
+/*!
+ * \brief Lock-free Message Queue for network communication.
+ *
+ * LockFreeMessageQueue has the semantics of MessageQueue, but stores the
+ * messages in a bounded ring buffer of slots, each with a sequence number
+ * telling whether it is free or filled (Vyukov's bounded queue). Producers
+ * and consumers only contend on an atomic position, so that many threads can
+ * post small messages without taking a lock.
+ *
+ * A thread that cannot add or remove spins for a while, then parks on a
+ * condition variable. The spin count adapts to how often spinning succeeds,
+ * and the threads on the other side only lock to wake parked threads.
+ *
+ * LockFreeMessageQueue is thread-safe.
+ */
+class LockFreeMessageQueue : public MessageQueue {
+ public:
+  /*!
+   * \brief LockFreeMessageQueue constructor
+   * \param queue_size size (bytes) of message queue
+   * \param num_producers number of producers, use 1 by default
+   * \param num_slots maximal number of messages in the queue, rounded up to a
+   *        power of two
+   */
+  LockFreeMessageQueue(int64_t queue_size /* in bytes */,
+                       int num_producers = 1,
+                       int64_t num_slots = kDefaultNumSlots);
+
+  STATUS Add(Message msg, bool is_blocking = true) override;
+
+  STATUS Remove(Message* msg, bool is_blocking = true) override;
+
+  STATUS RemoveBatch(std::vector<Message>* msgs, int max_count) override;
+
+  void SignalFinished(int producer_id) override;
+
+  bool Empty() const override;
+
+  bool EmptyAndNoMoreAdd() const override;
+
+  /*!
+   * \brief Default maximal number of messages in the queue
+   */
+  static constexpr int64_t kDefaultNumSlots = 4096;
+
+ private:
+  struct Slot {
+    std::atomic<size_t> seq;
+    Message msg;
+  };
+
+  /*! \brief Take free_bytes_ for a message, false if not enough */
+  bool TryReserve(int64_t size);
+  /*! \brief Fill a slot, false if the ring is full */
+  bool TryPush(const Message& msg);
+  /*! \brief Empty a slot, false if the ring is empty */
+  bool TryPop(Message* msg);
+
+  /*! \brief Spin, then park until ready() returns true */
+  template <typename Pred>
+  void Wait(std::atomic<int>* num_parked, std::condition_variable* cond, Pred ready);
+  /*! \brief Wake the threads parked on a condition */
+  void Wake(std::atomic<int>* num_parked, std::condition_variable* cond);
+
+  /*!
+   * \brief The ring of slots
+   */
+  std::unique_ptr<Slot[]> slots_;
+  size_t mask_;
+
+  /*!
+   * \brief Positions of the next add and remove, on their own cache lines
+   */
+  alignas(64) std::atomic<size_t> add_pos_{0};
+  alignas(64) std::atomic<size_t> remove_pos_{0};
+
+  /*!
+   * \brief Free size of the queue
+   */
+  alignas(64) std::atomic<int64_t> free_bytes_;
+
+  /*!
+   * \brief Number of threads parked on cond_not_full_ and cond_not_empty_
+   */
+  std::atomic<int> num_parked_producers_{0};
+  std::atomic<int> num_parked_consumers_{0};
+
+  /*!
+   * \brief Number of spins before parking
+   */
+  std::atomic<int> spin_count_;
+};
+
+}  // namespace network
+}  // namespace dgl
+
+#endif  // DGL_RPC_NETWORK_LOCKFREE_MSG_QUEUE_H_
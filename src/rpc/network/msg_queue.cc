@@ -7,6 +7,7 @@
 #include <cstring>
 
 #include "msg_queue.h"
+#include "lockfree_msg_queue.h"
 
 namespace dgl {
 namespace network {
@@ -80,6 +81,21 @@ STATUS MessageQueue::Remove(Message* msg, bool is_blocking) {
   return REMOVE_SUCCESS;
 }
 
+STATUS MessageQueue::RemoveBatch(std::vector<Message>* msgs, int max_count) {
+  msgs->clear();
+  Message msg;
+  STATUS code = Remove(&msg);
+  if (code != REMOVE_SUCCESS) {
+    return code;
+  }
+  msgs->push_back(msg);
+  while (static_cast<int>(msgs->size()) < max_count &&
+         Remove(&msg, false) == REMOVE_SUCCESS) {
+    msgs->push_back(msg);
+  }
+  return REMOVE_SUCCESS;
+}
+
 void MessageQueue::SignalFinished(int producer_id) {
   std::lock_guard<std::mutex> lock(mutex_);
   finished_producers_.insert(producer_id);
@@ -102,5 +118,14 @@ bool MessageQueue::EmptyAndNoMoreAdd() const {
          finished_producers_.size() >= num_producers_;
 }
 
+std::shared_ptr<MessageQueue> CreateMessageQueue(MessageQueueType type,
+                                                 int64_t queue_size,
+                                                 int num_producers) {
+  if (type == MessageQueueType::kLockFree) {
+    return std::make_shared<LockFreeMessageQueue>(queue_size, num_producers);
+  }
+  return std::make_shared<MessageQueue>(queue_size, num_producers);
+}
+
 }  // namespace network
 }  // namespace dgl
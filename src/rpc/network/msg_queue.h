@@ -8,10 +8,12 @@
 
 #include <dgl/runtime/ndarray.h>
 
+#include <memory>
 #include <queue>
 #include <set>
 #include <string>
 #include <utility>  // for pair
+#include <vector>
 #include <mutex>
 #include <condition_variable>
 #include <atomic>
@@ -99,7 +101,7 @@ class MessageQueue {
   /*!
    * \brief MessageQueue deconstructor
    */
-  ~MessageQueue() {}
+  virtual ~MessageQueue() {}
 
   /*!
    * \brief Add message to the queue
@@ -107,7 +109,7 @@ class MessageQueue {
    * \param is_blocking Blocking if cannot add, else return
    * \return Status code
    */
-  STATUS Add(Message msg, bool is_blocking = true);
+  virtual STATUS Add(Message msg, bool is_blocking = true);
 
   /*!
    * \brief Remove message from the queue
@@ -115,23 +117,32 @@ class MessageQueue {
    * \param is_blocking Blocking if cannot remove, else return
    * \return Status code
    */
-  STATUS Remove(Message* msg, bool is_blocking = true);
+  virtual STATUS Remove(Message* msg, bool is_blocking = true);
+
+  /*!
+   * \brief Remove the first message from the queue, blocking if empty, and
+   *        the following ones already queued
+   * \param msgs the removed messages, in order
+   * \param max_count maximal number of messages to remove
+   * \return Status code of removing the first message
+   */
+  virtual STATUS RemoveBatch(std::vector<Message>* msgs, int max_count);
 
   /*!
    * \brief Signal that producer producer_id will no longer produce anything
    * \param producer_id An integer uniquely to identify a producer thread
    */
-  void SignalFinished(int producer_id);
+  virtual void SignalFinished(int producer_id);
 
   /*!
    * \return true if queue is empty.
    */
-  bool Empty() const;
+  virtual bool Empty() const;
 
   /*!
    * \return true if queue is empty and all num_producers have signaled.
    */
-  bool EmptyAndNoMoreAdd() const;
+  virtual bool EmptyAndNoMoreAdd() const;
 
  protected:
   /*! 
@@ -180,6 +191,26 @@ class MessageQueue {
   mutable std::mutex mutex_;
 };
 
+/*!
+ * \brief Implementations of message queue
+ */
+enum class MessageQueueType {
+  /*! \brief MessageQueue, guarded by a mutex */
+  kLocked,
+  /*! \brief LockFreeMessageQueue, a ring buffer for many small messages */
+  kLockFree,
+};
+
+/*!
+ * \brief Create a message queue
+ * \param type implementation of the queue
+ * \param queue_size size (bytes) of message queue
+ * \param num_producers number of producers
+ */
+std::shared_ptr<MessageQueue> CreateMessageQueue(MessageQueueType type,
+                                                 int64_t queue_size,
+                                                 int num_producers = 1);
+
 }  // namespace network
 }  // namespace dgl
 
@@ -8,7 +8,13 @@
 #include <string.h>
 #include <stdlib.h>
 #include <time.h>
+#include <algorithm>
+#include <chrono>
+#include <future>
 #include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
 
 #include "socket_communicator.h"
 #include "../../c_api_common.h"
@@ -24,6 +30,46 @@ namespace dgl {
 namespace network {
 
 
+/*!
+ * \brief Start of the stripe k of a message, the last stripe ending at size
+ */
+inline int64_t StripeOffset(int64_t size, int k, int num_stripes) {
+  return size / num_stripes * k + std::min<int64_t>(size % num_stripes, k);
+}
+
+/*!
+ * \brief Send all the data on a blocking socket
+ */
+void SendAll(TCPSocket* socket, const char* data, int64_t size) {
+  while (size > 0) {
+    int64_t tmp = socket->Send(data, size);
+    CHECK_NE(tmp, -1);
+    data += tmp;
+    size -= tmp;
+  }
+}
+
+/*!
+ * \brief Receive all the data on a blocking socket
+ */
+void RecvAll(TCPSocket* socket, char* buffer, int64_t size) {
+  while (size > 0) {
+    int64_t tmp = socket->Receive(buffer, size);
+    CHECK_GT(tmp, 0) << "Connection closed while receiving a message.";
+    buffer += tmp;
+    size -= tmp;
+  }
+}
+
+/*!
+ * \brief First data sent on each connection when striping, telling the
+ *        receiver the sender and the stripe of the connection
+ */
+struct StripeHello {
+  uint64_t key;
+  int64_t stripe;
+};
+
 /////////////////////////////////////// SocketSender ///////////////////////////////////////////
 
 
@@ -54,6 +100,47 @@ void SocketSender::AddReceiver(const char* addr, int recv_id) {
   receiver_addrs_[recv_id] = address;
 }
 
+void SocketSender::SetBatching(int64_t max_delay_us, int64_t max_batch_bytes) {
+  CHECK_GE(max_delay_us, 0);
+  CHECK_GT(max_batch_bytes, 0);
+  max_delay_us_ = max_delay_us;
+  max_batch_bytes_ = max_batch_bytes;
+}
+
+void SocketSender::SetStriping(int num_stripes, int64_t min_stripe_bytes) {
+  CHECK_GT(num_stripes, 0);
+  CHECK_GT(min_stripe_bytes, 0);
+  num_stripes_ = num_stripes;
+  min_stripe_bytes_ = min_stripe_bytes;
+}
+
+/*!
+ * \brief Connect a socket to an address, retrying until the receiver listens
+ */
+bool ConnectSocket(TCPSocket* client_socket, const IPAddr& addr) {
+  bool bo = false;
+  int try_count = 0;
+  const char* ip = addr.ip.c_str();
+  int port = addr.port;
+  while (bo == false && try_count < kMaxTryCount) {
+    if (client_socket->Connect(ip, port)) {
+      bo = true;
+    } else {
+      if (try_count % 200 == 0 && try_count != 0) {
+        // every 1000 seconds show this message
+        LOG(INFO) << "Try to connect to: " << ip << ":" << port;
+      }
+      try_count++;
+#ifdef _WIN32
+      Sleep(5);
+#else   // !_WIN32
+      sleep(5);
+#endif  // _WIN32
+    }
+  }
+  return bo;
+}
+
 bool SocketSender::Connect() {
   // Create N sockets for Receiver
   int receiver_count = static_cast<int>(receiver_addrs_.size());
@@ -61,43 +148,45 @@ bool SocketSender::Connect() {
     max_thread_count_ = receiver_count;
   }
   sockets_.resize(max_thread_count_);
+  stripe_sockets_.resize(max_thread_count_);
+  std::random_device device;
   for (const auto& r : receiver_addrs_) {
     int receiver_id = r.first;
     int thread_id = receiver_id % max_thread_count_;
     sockets_[thread_id][receiver_id] = std::make_shared<TCPSocket>();
     TCPSocket* client_socket = sockets_[thread_id][receiver_id].get();
-    bool bo = false;
-    int try_count = 0;
-    const char* ip = r.second.ip.c_str();
-    int port = r.second.port;
-    while (bo == false && try_count < kMaxTryCount) {
-      if (client_socket->Connect(ip, port)) {
-        bo = true;
-      } else {
-        if (try_count % 200 == 0 && try_count != 0) {
-          // every 1000 seconds show this message
-          LOG(INFO) << "Try to connect to: " << ip << ":" << port;
+    if (!ConnectSocket(client_socket, r.second)) {
+      return false;
+    }
+    if (num_stripes_ > 1) {
+      // The receiver groups the connections of a sender by their key
+      StripeHello hello;
+      hello.key = (static_cast<uint64_t>(device()) << 32) | device();
+      hello.stripe = 0;
+      SendAll(client_socket, reinterpret_cast<char*>(&hello), sizeof(hello));
+      auto& stripes = stripe_sockets_[thread_id][receiver_id];
+      for (int k = 1; k < num_stripes_; ++k) {
+        stripes.push_back(std::make_shared<TCPSocket>());
+        if (!ConnectSocket(stripes.back().get(), r.second)) {
+          return false;
         }
-        try_count++;
-#ifdef _WIN32
-        Sleep(5);
-#else   // !_WIN32
-        sleep(5);
-#endif  // _WIN32
+        hello.stripe = k;
+        SendAll(stripes.back().get(), reinterpret_cast<char*>(&hello), sizeof(hello));
       }
     }
-    if (bo == false) {
-      return bo;
-    }
   }
 
   for (int thread_id = 0; thread_id < max_thread_count_; ++thread_id) {
-    msg_queue_.push_back(std::make_shared<MessageQueue>(queue_size_));
+    msg_queue_.push_back(CreateMessageQueue(queue_type_, queue_size_));
     // Create a new thread for this socket connection
     threads_.push_back(std::make_shared<std::thread>(
       SendLoop,
       sockets_[thread_id],
-      msg_queue_[thread_id]));
+      msg_queue_[thread_id],
+      max_delay_us_,
+      max_batch_bytes_,
+      stripe_sockets_[thread_id],
+      min_stripe_bytes_));
   }
 
   return true;
@@ -139,53 +228,178 @@ void SocketSender::Finalize() {
       socket.second->Close();
     }
   }
+  for (auto& group_stripes : stripe_sockets_) {
+    for (auto& stripes : group_stripes) {
+      for (auto& socket : stripes.second) {
+        socket->Close();
+      }
+    }
+  }
 }
 
-void SendCore(Message msg, TCPSocket* socket) {
-  // First send the size
-  // If exit == true, we will send zero size to reciever
-  int64_t sent_bytes = 0;
-  while (static_cast<size_t>(sent_bytes) < sizeof(int64_t)) {
-    int64_t max_len = sizeof(int64_t) - sent_bytes;
-    int64_t tmp = socket->Send(
-      reinterpret_cast<char*>(&msg.size) + sent_bytes,
-      max_len);
+/*!
+ * \brief The maximal number of queued messages sent at once by a SendLoop.
+ */
+const int kMaxSendMessages = 64;
+
+/*!
+ * \brief The size of the bytes read ahead by a RecvLoop for each socket.
+ */
+const int64_t kRecvStagingSize = 64 << 10;
+
+/*!
+ * \brief Send buffers with scatter-gather calls until all are sent
+ */
+void SendBuffers(TCPSocket* socket, std::vector<const char*> data,
+                 std::vector<int64_t> len_data) {
+  size_t first = 0;
+  while (first < data.size()) {
+    const int num_buffers = static_cast<int>(std::min<size_t>(
+      data.size() - first, TCPSocket::kMaxSendBuffers));
+    int64_t tmp = socket->SendV(&data[first], &len_data[first], num_buffers);
     CHECK_NE(tmp, -1);
-    sent_bytes += tmp;
+    // skip the buffers fully sent, and the sent part of the next one
+    for (; first < data.size() && tmp >= len_data[first]; ++first) {
+      tmp -= len_data[first];
+    }
+    if (tmp > 0) {
+      data[first] += tmp;
+      len_data[first] -= tmp;
+    }
   }
-  // Then send the data
-  sent_bytes = 0;
-  while (sent_bytes < msg.size) {
-    int64_t max_len = msg.size - sent_bytes;
-    int64_t tmp = socket->Send(msg.data+sent_bytes, max_len);
-    CHECK_NE(tmp, -1);
-    sent_bytes += tmp;
+}
+
+void SendCore(std::vector<Message>* msgs, TCPSocket* socket) {
+  // Every message is its size followed by its data, which are all sent
+  // directly from their memory with scatter-gather calls.
+  // If exit == true, we will send zero size to reciever
+  std::vector<const char*> data;
+  std::vector<int64_t> len_data;
+  for (auto& msg : *msgs) {
+    data.push_back(reinterpret_cast<char*>(&msg.size));
+    len_data.push_back(sizeof(int64_t));
+    if (msg.size > 0) {
+      data.push_back(msg.data);
+      len_data.push_back(msg.size);
+    }
   }
+  SendBuffers(socket, std::move(data), std::move(len_data));
   // delete msg
-  if (msg.deallocator != nullptr) {
-    msg.deallocator(&msg);
+  for (auto& msg : *msgs) {
+    if (msg.deallocator != nullptr) {
+      msg.deallocator(&msg);
+    }
+  }
+}
+
+/*!
+ * \brief Send a message in stripes, the first one on the main connection
+ *        after a negative size telling the receiver that it is striped
+ */
+void SendStriped(Message* msg, TCPSocket* socket,
+                 const std::vector<std::shared_ptr<TCPSocket>>& stripes) {
+  const int num_stripes = static_cast<int>(stripes.size()) + 1;
+  const int64_t size = msg->size;
+  std::vector<std::future<void>> sends;
+  for (int k = 1; k < num_stripes; ++k) {
+    TCPSocket* stripe = stripes[k - 1].get();
+    const char* data = msg->data + StripeOffset(size, k, num_stripes);
+    const int64_t len = StripeOffset(size, k + 1, num_stripes) - StripeOffset(size, k, num_stripes);
+    sends.push_back(std::async(std::launch::async, [stripe, data, len]() {
+      SendAll(stripe, data, len);
+    }));
+  }
+  int64_t header = -size;
+  SendBuffers(socket, {reinterpret_cast<char*>(&header), msg->data},
+              {sizeof(int64_t), StripeOffset(size, 1, num_stripes)});
+  for (auto& send : sends) {
+    send.get();
+  }
+  if (msg->deallocator != nullptr) {
+    msg->deallocator(msg);
   }
 }
 
 void SocketSender::SendLoop(
   std::unordered_map<int, std::shared_ptr<TCPSocket>> sockets,
-  std::shared_ptr<MessageQueue> queue) {
+  std::shared_ptr<MessageQueue> queue,
+  int64_t max_delay_us,
+  int64_t max_batch_bytes,
+  StripeSocketMap stripes,
+  int64_t min_stripe_bytes) {
+  std::vector<Message> msgs;
   for (;;) {
-    Message msg;
-    STATUS code = queue->Remove(&msg);
+    // The messages already queued are sent along, together with the other
+    // ones of their receiver, keeping their order
+    STATUS code = queue->RemoveBatch(&msgs, kMaxSendMessages);
     if (code == QUEUE_CLOSE) {
+      Message msg;
       msg.size = 0;  // send an end-signal to receiver
       for (auto& socket : sockets) {
-        SendCore(msg, socket.second.get());
+        std::vector<Message> end_msgs(1, msg);
+        SendCore(&end_msgs, socket.second.get());
       }
       break;
     }
-    SendCore(msg, sockets[msg.receiver_id].get());
+    if (max_delay_us > 0) {
+      // Wait a little for more messages, unless the batch is already large
+      int64_t batch_bytes = 0;
+      for (auto& msg : msgs) {
+        batch_bytes += msg.size;
+      }
+      const auto deadline = std::chrono::steady_clock::now() +
+        std::chrono::microseconds(max_delay_us);
+      Message msg;
+      while (static_cast<int>(msgs.size()) < kMaxSendMessages &&
+             batch_bytes < max_batch_bytes) {
+        if (queue->Remove(&msg, false) == REMOVE_SUCCESS) {
+          batch_bytes += msg.size;
+          msgs.push_back(msg);
+        } else if (std::chrono::steady_clock::now() < deadline) {
+          std::this_thread::yield();
+        } else {
+          break;
+        }
+      }
+    }
+    std::unordered_map<int, std::vector<Message>> batches;
+    for (auto& msg : msgs) {
+      batches[msg.receiver_id].push_back(msg);
+    }
+    for (auto& kv : batches) {
+      TCPSocket* socket = sockets[kv.first].get();
+      auto it = stripes.find(kv.first);
+      if (it == stripes.end()) {
+        SendCore(&kv.second, socket);
+        continue;
+      }
+      // The large messages are striped, between batches of the small ones
+      std::vector<Message> small_msgs;
+      for (auto& msg : kv.second) {
+        if (msg.size < min_stripe_bytes) {
+          small_msgs.push_back(msg);
+          continue;
+        }
+        if (!small_msgs.empty()) {
+          SendCore(&small_msgs, socket);
+          small_msgs.clear();
+        }
+        SendStriped(&msg, socket, it->second);
+      }
+      if (!small_msgs.empty()) {
+        SendCore(&small_msgs, socket);
+      }
+    }
   }
 }
 
 /////////////////////////////////////// SocketReceiver ///////////////////////////////////////////
 
+void SocketReceiver::SetStriping(int num_stripes) {
+  CHECK_GT(num_stripes, 0);
+  num_stripes_ = num_stripes;
+}
+
 bool SocketReceiver::Wait(const char* addr, int num_sender) {
   CHECK_NOTNULL(addr);
   CHECK_GT(num_sender, 0);
@@ -231,14 +445,53 @@ bool SocketReceiver::Wait(const char* addr, int num_sender) {
   std::string accept_ip;
   int accept_port;
   sockets_.resize(max_thread_count_);
-  for (int i = 0; i < num_sender_; ++i) {
-    int thread_id = i % max_thread_count_;
-    auto socket = std::make_shared<TCPSocket>();
-    sockets_[thread_id][i] = socket;
-    msg_queue_[i] = std::make_shared<MessageQueue>(queue_size_);
-    if (server_socket_->Accept(socket.get(), &accept_ip, &accept_port) == false) {
-      LOG(WARNING) << "Error on accept socket.";
-      return false;
+  stripe_sockets_.resize(max_thread_count_);
+  if (num_stripes_ == 1) {
+    for (int i = 0; i < num_sender_; ++i) {
+      int thread_id = i % max_thread_count_;
+      auto socket = std::make_shared<TCPSocket>();
+      sockets_[thread_id][i] = socket;
+      msg_queue_[i] = CreateMessageQueue(queue_type_, queue_size_);
+      if (server_socket_->Accept(socket.get(), &accept_ip, &accept_port) == false) {
+        LOG(WARNING) << "Error on accept socket.";
+        return false;
+      }
+    }
+  } else {
+    // Each sender opens num_stripes_ connections, in any order with those of
+    // the other senders, and tells their key and stripe on each of them. The
+    // senders are numbered in the order their keys are first seen.
+    std::unordered_map<uint64_t, int> sender_of_key;
+    std::vector<std::vector<std::shared_ptr<TCPSocket>>> connections(
+      num_sender_, std::vector<std::shared_ptr<TCPSocket>>(num_stripes_));
+    for (int i = 0; i < num_sender_ * num_stripes_; ++i) {
+      auto socket = std::make_shared<TCPSocket>();
+      if (server_socket_->Accept(socket.get(), &accept_ip, &accept_port) == false) {
+        LOG(WARNING) << "Error on accept socket.";
+        return false;
+      }
+      StripeHello hello;
+      RecvAll(socket.get(), reinterpret_cast<char*>(&hello), sizeof(hello));
+      CHECK(hello.stripe >= 0 && hello.stripe < num_stripes_)
+        << "Invalid stripe " << hello.stripe << " from " << accept_ip << ":" << accept_port
+        << ", the sender and the receiver must use the same number of stripes.";
+      auto it = sender_of_key.find(hello.key);
+      int sender_id;
+      if (it == sender_of_key.end()) {
+        sender_id = static_cast<int>(sender_of_key.size());
+        CHECK_LT(sender_id, num_sender_) << "Too many senders.";
+        sender_of_key[hello.key] = sender_id;
+      } else {
+        sender_id = it->second;
+      }
+      CHECK(!connections[sender_id][hello.stripe]) << "Duplicate stripe connection.";
+      connections[sender_id][hello.stripe] = socket;
+    }
+    for (int i = 0; i < num_sender_; ++i) {
+      int thread_id = i % max_thread_count_;
+      sockets_[thread_id][i] = connections[i][0];
+      stripe_sockets_[thread_id][i].assign(connections[i].begin() + 1, connections[i].end());
+      msg_queue_[i] = CreateMessageQueue(queue_type_, queue_size_);
     }
   }
   mq_iter_ = msg_queue_.begin();
@@ -249,7 +502,8 @@ bool SocketReceiver::Wait(const char* addr, int num_sender) {
       RecvLoop,
       sockets_[thread_id],
       msg_queue_,
-      &queue_sem_));
+      &queue_sem_,
+      stripe_sockets_[thread_id]));
   }
 
   return true;
@@ -306,28 +560,15 @@ void SocketReceiver::Finalize() {
       socket.second->Close();
     }
   }
-  server_socket_->Close();
-  delete server_socket_;
-}
-
-int64_t RecvDataSize(TCPSocket* socket) {
-  int64_t received_bytes = 0;
-  int64_t data_size = 0;
-  while (static_cast<size_t>(received_bytes) < sizeof(int64_t)) {
-    int64_t max_len = sizeof(int64_t) - received_bytes;
-    int64_t tmp = socket->Receive(
-      reinterpret_cast<char*>(&data_size) + received_bytes,
-      max_len);
-    if (tmp == -1) {
-      if (received_bytes > 0) {
-        // We want to finish reading full data_size
-        continue;
+  for (auto& group_stripes : stripe_sockets_) {
+    for (auto& stripes : group_stripes) {
+      for (auto& socket : stripes.second) {
+        socket->Close();
       }
-      return -1;
     }
-    received_bytes += tmp;
   }
-  return data_size;
+  server_socket_->Close();
+  delete server_socket_;
 }
 
 void RecvData(TCPSocket* socket, char* buffer, const int64_t &data_size,
@@ -343,20 +584,57 @@ void RecvData(TCPSocket* socket, char* buffer, const int64_t &data_size,
   }
 }
 
+/*!
+ * \brief Start receiving the stripes but the first one of a message
+ * \return The size of the first stripe
+ */
+int64_t StartStripeReads(char* buffer, int64_t size,
+                         const std::vector<std::shared_ptr<TCPSocket>>& stripes,
+                         std::vector<std::future<void>>* reads) {
+  const int num_stripes = static_cast<int>(stripes.size()) + 1;
+  for (int k = 1; k < num_stripes; ++k) {
+    TCPSocket* stripe = stripes[k - 1].get();
+    char* data = buffer + StripeOffset(size, k, num_stripes);
+    const int64_t len = StripeOffset(size, k + 1, num_stripes) - StripeOffset(size, k, num_stripes);
+    reads->push_back(std::async(std::launch::async, [stripe, data, len]() {
+      RecvAll(stripe, data, len);
+    }));
+  }
+  return StripeOffset(size, 1, num_stripes);
+}
+
 void SocketReceiver::RecvLoop(
   std::unordered_map<int /* Sender (virtual) ID */,
     std::shared_ptr<TCPSocket>> sockets,
   std::unordered_map<int /* Sender (virtual) ID */,
     std::shared_ptr<MessageQueue>> queues,
-  runtime::Semaphore *queue_sem) {
+  runtime::Semaphore *queue_sem,
+  StripeSocketMap stripes) {
   std::unordered_map<int, std::unique_ptr<RecvContext>> recv_contexts;
   SocketPool socket_pool;
   for (auto& socket : sockets) {
     auto &sender_id = socket.first;
     socket_pool.AddSocket(socket.second, sender_id);
     recv_contexts[sender_id] = std::unique_ptr<RecvContext>(new RecvContext());
+    recv_contexts[sender_id]->staging.resize(kRecvStagingSize);
   }
 
+  // Put a fully received message to the queue of its sender
+  auto add_message = [&](int sender_id, char* buffer, int64_t data_size) {
+    // The other stripes are received directly into the buffer
+    for (auto& read : recv_contexts[sender_id]->stripe_reads) {
+      read.get();
+    }
+    recv_contexts[sender_id]->stripe_reads.clear();
+    Message msg;
+    msg.data = buffer;
+    msg.size = data_size;
+    msg.deallocator = DefaultMessageDeleter;
+    queues[sender_id]->Add(msg);
+    // Signal queue semaphore
+    queue_sem->Post();
+  };
+
   // Main loop to receive messages
   for (;;) {
     int sender_id;
@@ -378,38 +656,80 @@ void SocketReceiver::RecvLoop(
     char*& buffer = ctx->buffer;
 
     if (data_size == -1) {
-      // This is a new message, so receive the data size first
-      data_size = RecvDataSize(socket.get());
-      if (data_size > 0) {
+      // Read ahead all the available bytes, and parse the messages in them
+      // without more system calls. The rest of a message larger than them is
+      // received directly into its buffer.
+      std::vector<char>& staging = ctx->staging;
+      int64_t& staged_bytes = ctx->staged_bytes;
+      int64_t tmp = socket->Receive(staging.data() + staged_bytes,
+                                    staging.size() - staged_bytes);
+      if (tmp <= 0) {
+        // Socket not ready, no more data to read
+        continue;
+      }
+      staged_bytes += tmp;
+      int64_t pos = 0;
+      bool stopped = false;
+      while (staged_bytes - pos >= static_cast<int64_t>(sizeof(int64_t))) {
+        int64_t size;
+        memcpy(&size, staging.data() + pos, sizeof(int64_t));
+        if (size == 0) {
+          // Received stop signal
+          stopped = true;
+          break;
+        }
+        // A negative size tells that the message is striped
+        const bool striped = size < 0;
+        if (striped) {
+          size = -size;
+        }
+        char* msg_buffer = nullptr;
         try {
-          buffer = new char[data_size];
+          msg_buffer = new char[size];
         } catch(const std::bad_alloc&) {
           LOG(FATAL) << "Cannot allocate enough memory for message, "
-                     << "(message size: " << data_size << ")";
+                     << "(message size: " << size << ")";
+        }
+        int64_t main_size = size;
+        if (striped) {
+          auto it = stripes.find(sender_id);
+          CHECK(it != stripes.end()) << "Striped message from a sender without stripes.";
+          main_size = StartStripeReads(msg_buffer, size, it->second, &ctx->stripe_reads);
         }
-        received_bytes = 0;
-      } else if (data_size == 0) {
-        // Received stop signal
+        pos += sizeof(int64_t);
+        const int64_t num_staged = std::min(main_size, staged_bytes - pos);
+        memcpy(msg_buffer, staging.data() + pos, num_staged);
+        pos += num_staged;
+        if (num_staged < main_size) {
+          buffer = msg_buffer;
+          data_size = main_size;
+          ctx->message_size = size;
+          received_bytes = num_staged;
+          break;
+        }
+        add_message(sender_id, msg_buffer, size);
+      }
+      // Keep the partial size of the next message
+      memmove(staging.data(), staging.data() + pos, staged_bytes - pos);
+      staged_bytes -= pos;
+      if (stopped) {
         if (socket_pool.RemoveSocket(socket) == 0) {
           return;
         }
+        continue;
+      }
+      if (data_size == -1) {
+        continue;
       }
     }
 
     RecvData(socket.get(), buffer, data_size, &received_bytes);
     if (received_bytes >= data_size) {
       // Full data received, create Message and push to queue
-      Message msg;
-      msg.data = buffer;
-      msg.size = data_size;
-      msg.deallocator = DefaultMessageDeleter;
-      queues[sender_id]->Add(msg);
+      add_message(sender_id, buffer, ctx->message_size);
 
       // Reset recv context
       data_size = -1;
-
-      // Signal queue semaphore
-      queue_sem->Post();
     }
   }
 }
@@ -6,6 +6,7 @@
 #ifndef DGL_RPC_NETWORK_SOCKET_COMMUNICATOR_H_
 #define DGL_RPC_NETWORK_SOCKET_COMMUNICATOR_H_
 
+#include <future>
 #include <thread>
 #include <vector>
 #include <string>
@@ -25,6 +26,12 @@ static constexpr int kMaxTryCount = 1024;    // maximal connection: 1024
 static constexpr int kTimeOut = 10 * 60;     // 10 minutes (in seconds) for socket timeout
 static constexpr int kMaxConnection = 1024;  // maximal connection: 1024
 
+/*!
+ * \brief The extra connections of each peer, used to send striped messages
+ */
+typedef std::unordered_map<int /* peer ID */,
+  std::vector<std::shared_ptr<TCPSocket>>> StripeSocketMap;
+
 /*!
  * \breif Networking address
  */
@@ -44,9 +51,11 @@ class SocketSender : public Sender {
    * \brief Sender constructor
    * \param queue_size size of message queue 
    * \param max_thread_count size of thread pool. 0 for no limit
+   * \param queue_type implementation of message queue
    */
-  SocketSender(int64_t queue_size, int max_thread_count)
-    : Sender(queue_size, max_thread_count) {}
+  SocketSender(int64_t queue_size, int max_thread_count,
+               MessageQueueType queue_type = MessageQueueType::kLocked)
+    : Sender(queue_size, max_thread_count), queue_type_(queue_type) {}
 
   /*!
    * \brief Add receiver's address and ID to the sender's namebook
@@ -57,6 +66,27 @@ class SocketSender : public Sender {
    */
   void AddReceiver(const char* addr, int recv_id);
 
+  /*!
+   * \brief Let the send threads wait for more messages to batch, like Nagle
+   * \param max_delay_us maximal time (microseconds) to wait for a batch, 0 by
+   *        default, i.e., only the messages already queued are batched
+   * \param max_batch_bytes size of data after which a batch is sent right away
+   *
+   * SetBatching() must be called before Connect().
+   */
+  void SetBatching(int64_t max_delay_us, int64_t max_batch_bytes);
+
+  /*!
+   * \brief Split the large messages into chunks sent in parallel, each on its
+   *        own connection to the receiver
+   * \param num_stripes number of connections to each receiver, which must be
+   *        the same as in SocketReceiver::SetStriping()
+   * \param min_stripe_bytes size from which a message is split
+   *
+   * SetStriping() must be called before Connect().
+   */
+  void SetStriping(int num_stripes, int64_t min_stripe_bytes);
+
   /*!
    * \brief Connect with all the Receivers
    * \return True for success and False for fail
@@ -109,6 +139,28 @@ class SocketSender : public Sender {
    */ 
   std::vector<std::shared_ptr<MessageQueue>> msg_queue_;
 
+  /*!
+   * \brief implementation of message queue
+   */
+  MessageQueueType queue_type_;
+
+  /*!
+   * \brief batching of the send threads
+   */
+  int64_t max_delay_us_ = 0;
+  int64_t max_batch_bytes_ = 1 << 20;
+
+  /*!
+   * \brief striping of the large messages
+   */
+  int num_stripes_ = 1;
+  int64_t min_stripe_bytes_ = 4 << 20;
+
+  /*!
+   * \brief extra connections of each thread, used for striping
+   */
+  std::vector<StripeSocketMap> stripe_sockets_;
+
   /*!
    * \brief Independent thread
    */ 
@@ -118,6 +170,10 @@ class SocketSender : public Sender {
    * \brief Send-loop for each thread
    * \param sockets TCPSockets for current thread
    * \param queue message_queue for current thread
+   * \param max_delay_us maximal time to wait for a batch
+   * \param max_batch_bytes size of data after which a batch is sent
+   * \param stripes extra connections for striping of current thread
+   * \param min_stripe_bytes size from which a message is striped
    * 
    * Note that, the SendLoop will finish its loop-job and exit thread
    * when the main thread invokes Signal() API on the message queue.
@@ -125,7 +181,11 @@ class SocketSender : public Sender {
   static void SendLoop(
     std::unordered_map<int /* Receiver (virtual) ID */,
       std::shared_ptr<TCPSocket>> sockets,
-    std::shared_ptr<MessageQueue> queue);
+    std::shared_ptr<MessageQueue> queue,
+    int64_t max_delay_us,
+    int64_t max_batch_bytes,
+    StripeSocketMap stripes,
+    int64_t min_stripe_bytes);
 };
 
 /*!
@@ -139,9 +199,11 @@ class SocketReceiver : public Receiver {
    * \brief Receiver constructor
    * \param queue_size size of message queue.
    * \param max_thread_count size of thread pool. 0 for no limit
+   * \param queue_type implementation of message queue
    */
-  SocketReceiver(int64_t queue_size, int max_thread_count)
-    : Receiver(queue_size, max_thread_count) {}
+  SocketReceiver(int64_t queue_size, int max_thread_count,
+                 MessageQueueType queue_type = MessageQueueType::kLocked)
+    : Receiver(queue_size, max_thread_count), queue_type_(queue_type) {}
 
   /*!
    * \brief Wait for all the Senders to connect
@@ -153,6 +215,15 @@ class SocketReceiver : public Receiver {
    */
   bool Wait(const char* addr, int num_sender);
 
+  /*!
+   * \brief Receive the striped messages on parallel connections
+   * \param num_stripes number of connections from each sender, which must be
+   *        the same as in SocketSender::SetStriping()
+   *
+   * SetStriping() must be called before Wait().
+   */
+  void SetStriping(int num_stripes);
+
   /*!
    * \brief Recv data from Sender. Actually removing data from msg_queue.
    * \param msg pointer of data message
@@ -193,9 +264,17 @@ class SocketReceiver : public Receiver {
 
  private:
   struct RecvContext {
+    // the message received directly into its buffer, if data_size > 0, where
+    // data_size is that of the part sent on the main connection
     int64_t data_size = -1;
     int64_t received_bytes = 0;
     char *buffer = nullptr;
+    int64_t message_size = 0;
+    // the reads of the other stripes of the message
+    std::vector<std::future<void>> stripe_reads;
+    // the bytes read ahead from the socket, holding the small messages
+    std::vector<char> staging;
+    int64_t staged_bytes = 0;
   };
   /*!
    * \brief number of sender
@@ -220,6 +299,21 @@ class SocketReceiver : public Receiver {
     std::shared_ptr<MessageQueue>> msg_queue_;
   std::unordered_map<int, std::shared_ptr<MessageQueue>>::iterator mq_iter_;
 
+  /*!
+   * \brief implementation of message queue
+   */
+  MessageQueueType queue_type_;
+
+  /*!
+   * \brief number of connections from each sender
+   */
+  int num_stripes_ = 1;
+
+  /*!
+   * \brief extra connections of each thread, used for striping
+   */
+  std::vector<StripeSocketMap> stripe_sockets_;
+
   /*!
    * \brief Independent thead
    */ 
@@ -235,6 +329,7 @@ class SocketReceiver : public Receiver {
    * \brief Recv-loop for each thread
    * \param sockets client sockets of current thread
    * \param queue message queues of current thread
+   * \param stripes extra connections for striping of current thread
    *
    * Note that, the RecvLoop will finish its loop-job and exit thread
    * when the main thread invokes Signal() API on the message queue.
@@ -244,7 +339,8 @@ class SocketReceiver : public Receiver {
       std::shared_ptr<TCPSocket>> sockets,
     std::unordered_map<int /* Sender (virtual) ID */,
       std::shared_ptr<MessageQueue>> queues,
-    runtime::Semaphore *queue_sem);
+    runtime::Semaphore *queue_sem,
+    StripeSocketMap stripes);
 };
 
 }  // namespace network
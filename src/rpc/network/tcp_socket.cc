@@ -13,6 +13,7 @@
 #include <netdb.h>
 #include <netinet/in.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #endif  // !_WIN32
 #include <string.h>
@@ -24,6 +25,8 @@ namespace network {
 typedef struct sockaddr_in SAI;
 typedef struct sockaddr SA;
 
+constexpr int TCPSocket::kMaxSendBuffers;
+
 TCPSocket::TCPSocket() {
   // init socket
   socket_ = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
@@ -199,6 +202,41 @@ int64_t TCPSocket::Send(const char * data, int64_t len_data) {
   return number_send;
 }
 
+int64_t TCPSocket::SendV(const char * const * data, const int64_t * len_data,
+                         int num_buffers) {
+  CHECK_LE(num_buffers, kMaxSendBuffers);
+#ifdef _WIN32
+  int64_t total_send = 0;
+  for (int i = 0; i < num_buffers; ++i) {
+    int64_t number_send = Send(data[i], len_data[i]);
+    if (number_send == -1) {
+      return total_send > 0 ? total_send : -1;
+    }
+    total_send += number_send;
+    if (number_send < len_data[i]) {
+      break;
+    }
+  }
+  return total_send;
+#else   // !_WIN32
+  struct iovec iov[kMaxSendBuffers];
+  for (int i = 0; i < num_buffers; ++i) {
+    iov[i].iov_base = const_cast<char *>(data[i]);
+    iov[i].iov_len = len_data[i];
+  }
+  int64_t number_send;
+
+  do {  // retry if EINTR failure appears
+    number_send = writev(socket_, iov, num_buffers);
+  } while (number_send == -1 && errno == EINTR);
+  if (number_send == -1) {
+    LOG(ERROR) << "writev error: " << strerror(errno);
+  }
+
+  return number_send;
+#endif  // _WIN32
+}
+
 int64_t TCPSocket::Receive(char * buffer, int64_t size_buffer) {
   int64_t number_recv;
 
@@ -106,6 +106,20 @@ class TCPSocket {
    */  
   int64_t Send(const char * data, int64_t len_data);
 
+  /*!
+   * \brief Send several buffers with one scatter-gather call.
+   * \param data data of each buffer
+   * \param len_data length of each buffer
+   * \param num_buffers number of buffers, at most kMaxSendBuffers
+   * \return return number of bytes sent if OK, -1 on error
+   */
+  int64_t SendV(const char * const * data, const int64_t * len_data, int num_buffers);
+
+  /*!
+   * \brief The maximal number of buffers given to SendV.
+   */
+  static constexpr int kMaxSendBuffers = 128;
+
   /*!
    * \brief Receive data.
    * \param buffer buffer for receving
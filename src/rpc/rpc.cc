@@ -13,10 +13,17 @@
 #include <dgl/runtime/parallel_for.h>
 #include <dgl/zerocopy_serializer.h>
 #include <tensorpipe/tensorpipe.h>
+#ifdef DGL_USE_CUDA
+#include <tensorpipe/tensorpipe_cuda.h>
+#endif  // DGL_USE_CUDA
 #include <unistd.h>
 
 #include <csignal>
+#include <cstring>
 #include <future>
+#include <map>
+#include <thread>
+#include <unordered_map>
 
 #include "../c_api_common.h"
 #include "../runtime/resource_manager.h"
@@ -63,25 +70,208 @@ const std::string& guessAddress() {
   return uvAddress;
 }
 
+/*! \brief The size of the payloads of a message. */
+int64_t MessageBytes(const RPCMessage& msg) {
+  int64_t bytes = msg.data.size();
+  for (const auto& tensor : msg.tensors)
+    bytes += tensor.GetSize();
+  return bytes;
+}
+
 RPCStatus SendRPCMessage(const RPCMessage& msg, const int32_t target_id) {
-  RPCContext::getInstance()->sender->Send(msg, target_id);
+  RPCContext* ctx = RPCContext::getInstance();
+  ctx->sender->Send(msg, target_id);
+  ctx->stats.OnSend(msg.service_id, msg.msg_seq, target_id, MessageBytes(msg),
+                    RPCStats::NowMicros());
   return kRPCSuccess;
 }
 
 RPCStatus RecvRPCMessage(RPCMessage* msg, int32_t timeout) {
   // ignore timeout now
   CHECK_EQ(timeout, 0) << "rpc cannot support timeout now.";
-  RPCContext::getInstance()->receiver->Recv(msg);
+  RPCContext* ctx = RPCContext::getInstance();
+  const int64_t start_us = RPCStats::NowMicros();
+  ctx->receiver->Recv(msg);
+  const int64_t now_us = RPCStats::NowMicros();
+  ctx->stats.OnRecv(msg->service_id, msg->msg_seq, msg->client_id, msg->server_id,
+                    MessageBytes(*msg), now_us - start_us, ctx->receiver->NumQueued(), now_us);
   return kRPCSuccess;
 }
 
+/*!
+ * \brief Handle a request by the handler of its service, if any, and send
+ *        the response.
+ * \return Whether the request has been handled.
+ */
+void SendServiceResponse(const RPCMessage& req, RPCMessage* res) {
+  RPCContext* ctx = RPCContext::getInstance();
+  // as the Python server does, the response carries the sequence of the request
+  ctx->msg_seq = req.msg_seq;
+  res->service_id = req.service_id;
+  res->msg_seq = req.msg_seq;
+  res->client_id = req.client_id;
+  res->server_id = ctx->rank;
+  SendRPCMessage(*res, req.client_id);
+}
+
+bool HandleServiceRequest(const RPCMessage& req) {
+  RPCContext* ctx = RPCContext::getInstance();
+  auto it = ctx->service_handlers.find(req.service_id);
+  if (it == ctx->service_handlers.end())
+    return false;
+  RPCMessage res;
+  if (!it->second(req, &res))
+    return false;
+  SendServiceResponse(req, &res);
+  return true;
+}
+
+/*! \brief The maximum number of requests handled in one batch. */
+constexpr size_t kMaxBatchRequests = 1024;
+
+/*!
+ * \brief Handle a request of a service served in batches, together with the
+ *        requests of such services received within the window of its service.
+ *
+ * The requests are grouped by service and payload, and the handler of each
+ * group runs once. The other messages received meanwhile are handled as usual
+ * or kept for Python, as are the requests of the groups whose handler declines
+ * them.
+ * \return Whether the request is of a service served in batches.
+ */
+bool HandleBatchServiceRequests(const RPCMessage& req) {
+  RPCContext* ctx = RPCContext::getInstance();
+  auto it = ctx->batch_services.find(req.service_id);
+  if (it == ctx->batch_services.end())
+    return false;
+  std::map<std::pair<int32_t, std::string>, std::vector<RPCMessage>> batches;
+  batches[{req.service_id, req.data}].push_back(req);
+  size_t num_reqs = 1;
+  const int64_t deadline = RPCStats::NowMicros() + it->second.window_us;
+  while (num_reqs < kMaxBatchRequests) {
+    if (ctx->receiver->NumQueued() == 0) {
+      if (RPCStats::NowMicros() >= deadline)
+        break;
+      std::this_thread::yield();
+      continue;
+    }
+    RPCMessage msg;
+    RecvRPCMessage(&msg, 0);
+    if (ctx->batch_services.count(msg.service_id)) {
+      batches[{msg.service_id, msg.data}].push_back(msg);
+      ++num_reqs;
+    } else if (!HandleServiceRequest(msg) && !DeliverFastPullResponse(msg)) {
+      ctx->deferred_msgs.push_back(msg);
+    }
+  }
+  for (auto& batch : batches) {
+    const std::vector<RPCMessage>& reqs = batch.second;
+    std::vector<RPCMessage> res;
+    if (!ctx->batch_services[batch.first.first].handler(reqs, &res)) {
+      ctx->deferred_msgs.insert(ctx->deferred_msgs.end(), reqs.begin(), reqs.end());
+      continue;
+    }
+    CHECK_EQ(res.size(), reqs.size()) << "A batch handler must respond to every request.";
+    for (size_t i = 0; i < reqs.size(); ++i)
+      SendServiceResponse(reqs[i], &res[i]);
+  }
+  return true;
+}
+
+/*!
+ * \brief Scatter a response into the result of its fast pull, if any.
+ * \return Whether the message is the response of a pending fast pull.
+ */
+bool DeliverFastPullResponse(const RPCMessage& msg) {
+  RPCContext* ctx = RPCContext::getInstance();
+  auto& pending = ctx->pending_pulls;
+  auto it = pending.find(msg.msg_seq);
+  if (it == pending.end() || it->second->service_id != msg.service_id)
+    return false;
+  FastPullObject* pull = it->second.get();
+  const size_t part_id = msg.server_id / pull->group_count;
+  CHECK_LT(part_id, pull->remote_pos.size()) << "Invalid server ID of pull response.";
+  const std::vector<int64_t>& ids = pull->remote_ids[part_id];
+  const std::vector<int64_t>& pos = pull->remote_pos[part_id];
+  const std::vector<int64_t>& rows = pull->remote_rows[part_id];
+  CHECK_EQ(msg.tensors.size(), 1) << "A pull response must have one tensor.";
+  CHECK_EQ(msg.tensors[0].GetSize(), ids.size() * static_cast<size_t>(pull->row_size))
+    << "The pull response of partition " << part_id << " has a wrong size.";
+  if (static_cast<size_t>(msg.server_id) < ctx->server_inflight.size() &&
+      ctx->server_inflight[msg.server_id] > 0)
+    --ctx->server_inflight[msg.server_id];
+  const int64_t row_size = pull->row_size;
+  const char* data_char = static_cast<const char*>(msg.tensors[0]->data);
+  char* return_data = static_cast<char*>(pull->result->data);
+  parallel_for(0, pos.size(), [&](size_t b, size_t e) {
+    for (auto n = b; n < e; ++n) {
+      memcpy(return_data + pos[n] * row_size, data_char + rows[n] * row_size, row_size);
+    }
+  });
+  if (pull->cache) {
+    for (size_t n = 0; n < ids.size(); ++n)
+      pull->cache->Offer(ids[n], data_char + n * row_size);
+  }
+  if (--pull->num_pending == 0)
+    pending.erase(it);
+  return true;
+}
+
+/*!
+ * \brief Receive the remaining responses of a fast pull and wait for its
+ *        local rows.
+ *
+ * The responses of the other pending fast pulls received meanwhile are
+ * scattered too, and the other messages are kept for Python.
+ */
+NDArray WaitFastPull(FastPullObject* pull) {
+  RPCContext* ctx = RPCContext::getInstance();
+  while (pull->num_pending > 0) {
+    RPCMessage msg;
+    RecvRPCMessage(&msg, 0);
+    if (!DeliverFastPullResponse(msg) && !HandleServiceRequest(msg))
+      ctx->deferred_msgs.push_back(msg);
+  }
+  if (pull->local_gather.valid())
+    pull->local_gather.get();
+  return pull->result;
+}
+
 void InitGlobalTpContext() {
   if (!RPCContext::getInstance()->ctx) {
     RPCContext::getInstance()->ctx = std::make_shared<tensorpipe::Context>();
     auto context = RPCContext::getInstance()->ctx;
     auto transportContext = tensorpipe::transport::uv::create();
-    auto shmtransport = tensorpipe::transport::shm::create();
     context->registerTransport(0 /* priority */, "tcp", transportContext);
+    // Within a host, e.g. between a trainer and the servers of its machine,
+    // the pipes go through shared-memory rings instead of TCP loopback, and
+    // the tensors are copied once between the processes with CMA (CUDA IPC
+    // for the GPU tensors). Across
+    // hosts the domains of these differ, so the pipes keep using TCP.
+    char* useShm_str = std::getenv("DGL_RPC_USE_SHM");
+    const bool useShm = !useShm_str || std::string(useShm_str) != "0";
+#if TENSORPIPE_HAS_SHM_TRANSPORT
+    if (useShm) {
+      auto shmContext = tensorpipe::transport::shm::create();
+      if (shmContext->isViable()) {
+        context->registerTransport(20 /* highest priority */, "shm", shmContext);
+      }
+    }
+#endif  // TENSORPIPE_HAS_SHM_TRANSPORT
+#if TENSORPIPE_HAS_IBV_TRANSPORT
+    // RDMA over InfiniBand or RoCE, which the pipes prefer to TCP when both
+    // ends have a usable device. The connections are still set up by TCP.
+    char* useIbv_str = std::getenv("DGL_RPC_USE_IBV");
+    if (useIbv_str && std::string(useIbv_str) != "0") {
+      auto ibvContext = tensorpipe::transport::ibv::create();
+      if (ibvContext->isViable()) {
+        context->registerTransport(10 /* high priority */, "ibv", ibvContext);
+      } else {
+        LOG(WARNING) << "DGL_RPC_USE_IBV is set but no RDMA device is usable, "
+                     << "falling back to TCP.";
+      }
+    }
+#endif  // TENSORPIPE_HAS_IBV_TRANSPORT
     // Register basic uv channel
     auto basicChannel = tensorpipe::channel::basic::create();
     context->registerChannel(0 /* low priority */, "basic", basicChannel);
@@ -103,6 +293,29 @@ void InitGlobalTpContext() {
                                                          std::move(listeners));
       context->registerChannel(20 /* high priority */, "mpt", mptChannel);
     }
+#if TENSORPIPE_HAS_CMA_CHANNEL
+    if (useShm) {
+      auto cmaChannel = tensorpipe::channel::cma::create();
+      if (cmaChannel->isViable()) {
+        context->registerChannel(30 /* highest priority */, "cma", cmaChannel);
+      }
+    }
+#endif  // TENSORPIPE_HAS_CMA_CHANNEL
+#ifdef DGL_USE_CUDA
+    // The GPU tensors go through the CPU channels across hosts, and are
+    // copied between the devices of a host with CUDA IPC.
+    auto cudaBasicChannel = tensorpipe::channel::cuda_basic::create(
+      tensorpipe::channel::basic::create());
+    context->registerChannel(0 /* low priority */, "cuda_basic", cudaBasicChannel);
+#if TENSORPIPE_HAS_CUDA_IPC_CHANNEL
+    if (useShm) {
+      auto cudaIpcChannel = tensorpipe::channel::cuda_ipc::create();
+      if (cudaIpcChannel->isViable()) {
+        context->registerChannel(30 /* highest priority */, "cuda_ipc", cudaIpcChannel);
+      }
+    }
+#endif  // TENSORPIPE_HAS_CUDA_IPC_CHANNEL
+#endif  // DGL_USE_CUDA
   }
 }
 
@@ -125,7 +338,17 @@ DGL_REGISTER_GLOBAL("distributed.rpc._CAPI_DGLRPCCreateReceiver")
   std::string type = args[1];
   InitGlobalTpContext();
   RPCContext::getInstance()->receiver =
-    std::make_shared<TPReceiver>(RPCContext::getInstance()->ctx);
+    std::make_shared<TPReceiver>(RPCContext::getInstance()->ctx, msg_queue_size);
+});
+
+DGL_REGISTER_GLOBAL("distributed.rpc._CAPI_DGLRPCSetServicePriority")
+.set_body([](DGLArgs args, DGLRetValue* rv) {
+  const int32_t service_id = args[0];
+  const int32_t priority = args[1];
+  // a receiver created later is given the priorities by Python
+  auto receiver = RPCContext::getInstance()->receiver;
+  if (receiver)
+    receiver->SetServicePriority(service_id, priority);
 });
 
 DGL_REGISTER_GLOBAL("distributed.rpc._CAPI_DGLRPCFinalizeSender")
@@ -200,6 +423,12 @@ DGL_REGISTER_GLOBAL("distributed.rpc._CAPI_DGLRPCGetNumClient")
   *rv = RPCContext::getInstance()->num_clients;
 });
 
+DGL_REGISTER_GLOBAL("distributed.rpc._CAPI_DGLRPCGetNumQueued")
+.set_body([](DGLArgs args, DGLRetValue* rv) {
+  RPCContext* ctx = RPCContext::getInstance();
+  *rv = static_cast<int64_t>(ctx->receiver->NumQueued() + ctx->deferred_msgs.size());
+});
+
 DGL_REGISTER_GLOBAL("distributed.rpc._CAPI_DGLRPCSetNumServerPerMachine")
 .set_body([](DGLArgs args, DGLRetValue* rv) {
   const int32_t num_servers = args[0];
@@ -271,7 +500,25 @@ DGL_REGISTER_GLOBAL("distributed.rpc._CAPI_DGLRPCRecvRPCMessage")
 .set_body([](DGLArgs args, DGLRetValue* rv) {
   int32_t timeout = args[0];
   RPCMessageRef msg = args[1];
-  *rv = RecvRPCMessage(msg.sptr().get(), timeout);
+  RPCContext* ctx = RPCContext::getInstance();
+  // the requests served in C++ and the responses of fast pulls are handled
+  // here, and Python only gets the others, including the ones kept meanwhile
+  while (true) {
+    if (!ctx->deferred_msgs.empty()) {
+      *msg.sptr() = ctx->deferred_msgs.front();
+      ctx->deferred_msgs.pop_front();
+      *rv = kRPCSuccess;
+      return;
+    }
+    const RPCStatus status = RecvRPCMessage(msg.sptr().get(), timeout);
+    const RPCMessage& m = *msg.sptr();
+    if (status != kRPCSuccess ||
+        !(HandleServiceRequest(m) || HandleBatchServiceRequests(m) ||
+          DeliverFastPullResponse(m))) {
+      *rv = status;
+      return;
+    }
+  }
 });
 
 //////////////////////////// RPCMessage ////////////////////////////
@@ -400,8 +647,33 @@ DGL_REGISTER_GLOBAL("distributed.rpc._CAPI_DGLRPCGetGlobalIDFromLocalPartition")
   *rv = res_tensor;
 });
 
-DGL_REGISTER_GLOBAL("distributed.rpc._CAPI_DGLRPCFastPull")
-.set_body([](DGLArgs args, DGLRetValue* rv) {
+/*!
+ * \brief Pick the server of a machine with the fewest fast-pull requests in
+ *        flight, so that a slow server, e.g. a busy or paused one, gets less.
+ *
+ * The servers are scanned from a random one, which breaks the ties.
+ */
+int32_t PickPullServer(int machine_id, int group_count) {
+  std::vector<int32_t>& inflight = RPCContext::getInstance()->server_inflight;
+  const int32_t lower = machine_id * group_count;
+  if (inflight.size() < static_cast<size_t>(lower + group_count))
+    inflight.resize(lower + group_count, 0);
+  const int start = dgl::RandomEngine::ThreadLocal()->RandInt(0, group_count);
+  int32_t best = lower + start;
+  for (int k = 1; k < group_count; ++k) {
+    const int32_t server_id = lower + (start + k) % group_count;
+    if (inflight[server_id] < inflight[best])
+      best = server_id;
+  }
+  return best;
+}
+
+/*!
+ * \brief Send the requests of a fast pull and start copying its local rows.
+ *
+ * The arguments are those of _CAPI_DGLRPCFastPull.
+ */
+std::shared_ptr<FastPullObject> StartFastPull(DGLArgs args) {
   // Input
   std::string name = args[0];
   int local_machine_id = args[1];
@@ -420,14 +692,24 @@ DGL_REGISTER_GLOBAL("distributed.rpc._CAPI_DGLRPCFastPull")
   dgl_id_t* ID_data = static_cast<dgl_id_t*>(ID->data);
   dgl_id_t* part_id_data = static_cast<dgl_id_t*>(part_id->data);
   dgl_id_t* local_id_data = static_cast<dgl_id_t*>(local_id->data);
-  char* local_data_char = static_cast<char*>(local_data->data);
+  auto pull = std::make_shared<FastPullObject>();
+  RPCContext* ctx = RPCContext::getInstance();
+  auto cache_it = ctx->feature_caches.find(name);
+  if (cache_it != ctx->feature_caches.end())
+    pull->cache = cache_it->second;
+  // the positions in the result of the cached rows, and the rows
+  std::vector<std::pair<dgl_id_t, const char*>> cached_rows;
   std::vector<dgl_id_t> local_ids;
   std::vector<dgl_id_t> local_ids_orginal;
   std::vector<int64_t> local_data_shape;
-  std::vector<std::vector<dgl_id_t>> remote_ids(machine_count);
-  std::vector<std::vector<dgl_id_t>> remote_ids_original(machine_count);
+  // the row of each remote ID in its response, as each ID is pulled once
+  std::unordered_map<dgl_id_t, int64_t> remote_rows;
+  remote_rows.reserve(ID_size);
+  pull->remote_ids.resize(machine_count);
+  pull->remote_pos.resize(machine_count);
+  pull->remote_rows.resize(machine_count);
   // Get row size (in bytes)
-  int row_size = 1;
+  int64_t row_size = 1;
   for (int i = 0; i < local_data->ndim; ++i) {
     local_data_shape.push_back(local_data->shape[i]);
     if (i != 0) {
@@ -438,6 +720,10 @@ DGL_REGISTER_GLOBAL("distributed.rpc._CAPI_DGLRPCFastPull")
   size_t data_size = local_data.GetSize();
   CHECK_GT(local_data_shape.size(), 0);
   CHECK_EQ(row_size * local_data_shape[0], data_size);
+  if (pull->cache) {
+    CHECK_EQ(pull->cache->row_size(), row_size)
+      << "The feature cache of " << name << " has a wrong row size.";
+  }
   // Get local id (used in local machine) and
   // remote id (send to remote machine)
   dgl_id_t idx = 0;
@@ -452,57 +738,418 @@ DGL_REGISTER_GLOBAL("distributed.rpc._CAPI_DGLRPCFastPull")
     } else {
       CHECK_LT(p_id, machine_count) << "Invalid partition ID.";
       dgl_id_t id = ID_data[i];
-      remote_ids[p_id].push_back(id);
-      remote_ids_original[p_id].push_back(i);
+      if (pull->cache) {
+        const char* row = pull->cache->Lookup(id);
+        if (row) {
+          cached_rows.emplace_back(i, row);
+          continue;
+        }
+      }
+      auto inserted = remote_rows.emplace(id, pull->remote_ids[p_id].size());
+      if (inserted.second)
+        pull->remote_ids[p_id].push_back(id);
+      pull->remote_pos[p_id].push_back(i);
+      pull->remote_rows[p_id].push_back(inserted.first->second);
     }
   }
+  local_data_shape[0] = ID_size;
+  pull->result = NDArray::Empty(local_data_shape, local_data->dtype, DLContext{kDLCPU, 0});
+  pull->row_size = row_size;
+  pull->group_count = group_count;
+  pull->service_id = service_id;
   // Send remote id
-  int msg_count = 0;
-  for (int i = 0; i < remote_ids.size(); ++i) {
-    if (remote_ids[i].size() != 0) {
+  for (int i = 0; i < machine_count; ++i) {
+    if (pull->remote_ids[i].size() != 0) {
       RPCMessage msg;
       msg.service_id = service_id;
       msg.msg_seq = msg_seq;
       msg.client_id = client_id;
-      int lower = i * group_count;
-      int upper = (i + 1) * group_count;
-      msg.server_id = dgl::RandomEngine::ThreadLocal()->RandInt(lower, upper);
+      msg.server_id = PickPullServer(i, group_count);
       msg.data = pickle_data;
-      NDArray tensor = dgl::aten::VecToIdArray<dgl_id_t>(remote_ids[i]);
+      NDArray tensor = dgl::aten::VecToIdArray<int64_t>(pull->remote_ids[i]);
       msg.tensors.push_back(tensor);
       SendRPCMessage(msg, msg.server_id);
-      msg_count++;
+      ctx->server_inflight[msg.server_id]++;
+      pull->num_pending++;
     }
   }
-  local_data_shape[0] = ID_size;
-  NDArray res_tensor = NDArray::Empty(local_data_shape,
-                                      local_data->dtype,
-                                      DLContext{kDLCPU, 0});
-  char* return_data = static_cast<char*>(res_tensor->data);
-  // Copy local data
-  parallel_for(0, local_ids.size(), [&](size_t b, size_t e) {
+  // Copy cached data, before any response can change the cache
+  char* return_data = static_cast<char*>(pull->result->data);
+  parallel_for(0, cached_rows.size(), [&](size_t b, size_t e) {
     for (auto i = b; i < e; ++i) {
-      CHECK_GE(ID_size * row_size,
-                local_ids_orginal[i] * row_size + row_size);
-      CHECK_GE(data_size, local_ids[i] * row_size + row_size);
-      CHECK_GE(local_ids[i], 0);
-      memcpy(return_data + local_ids_orginal[i] * row_size,
-             local_data_char + local_ids[i] * row_size, row_size);
+      memcpy(return_data + cached_rows[i].first * row_size, cached_rows[i].second, row_size);
     }
   });
-  // Recv remote message
-  for (int i = 0; i < msg_count; ++i) {
-    RPCMessage msg;
-    RecvRPCMessage(&msg, 0);
-    int part_id = msg.server_id / group_count;
-    char* data_char = static_cast<char*>(msg.tensors[0]->data);
-    dgl_id_t id_size = remote_ids[part_id].size();
-    for (size_t n = 0; n < id_size; ++n) {
-      memcpy(return_data + remote_ids_original[part_id][n] * row_size,
-             data_char + n * row_size, row_size);
+  if (pull->num_pending > 0) {
+    auto& pending = ctx->pending_pulls;
+    CHECK_EQ(pending.count(msg_seq), 0) << "Duplicate message sequence of fast pull.";
+    pending[msg_seq] = pull;
+  }
+  // Copy local data while waiting for the remote responses. The local
+  // rows never overlap the remote ones scattered meanwhile.
+  if (!local_ids.empty()) {
+    pull->local_gather = std::async(std::launch::async,
+        [local_data, return_data, row_size, local_ids, local_ids_orginal] () {
+      const char* local_data_char = static_cast<const char*>(local_data->data);
+      parallel_for(0, local_ids.size(), [&](size_t b, size_t e) {
+        for (auto i = b; i < e; ++i) {
+          memcpy(return_data + local_ids_orginal[i] * row_size,
+                 local_data_char + local_ids[i] * row_size, row_size);
+        }
+      });
+    });
+  }
+  return pull;
+}
+
+DGL_REGISTER_GLOBAL("distributed.rpc._CAPI_DGLRPCFastPull")
+.set_body([](DGLArgs args, DGLRetValue* rv) {
+  std::shared_ptr<FastPullObject> pull = StartFastPull(args);
+  *rv = WaitFastPull(pull.get());
+});
+
+DGL_REGISTER_GLOBAL("distributed.rpc._CAPI_DGLRPCFastPullAsync")
+.set_body([](DGLArgs args, DGLRetValue* rv) {
+  *rv = StartFastPull(args);
+});
+
+DGL_REGISTER_GLOBAL("distributed.rpc._CAPI_DGLRPCFastPullWait")
+.set_body([](DGLArgs args, DGLRetValue* rv) {
+  FastPullRef pull = args[0];
+  *rv = WaitFastPull(pull.sptr().get());
+});
+
+DGL_REGISTER_GLOBAL("distributed.rpc._CAPI_DGLRPCFastPullDone")
+.set_body([](DGLArgs args, DGLRetValue* rv) {
+  FastPullRef pull = args[0];
+  *rv = pull->num_pending == 0;
+});
+
+/*! \brief Get the feature cache of a tensor, which must be enabled. */
+std::shared_ptr<FeatureCache> GetFeatureCache(const std::string& name) {
+  auto& caches = RPCContext::getInstance()->feature_caches;
+  auto it = caches.find(name);
+  CHECK(it != caches.end()) << "The feature cache of " << name << " is not enabled.";
+  return it->second;
+}
+
+DGL_REGISTER_GLOBAL("distributed.rpc._CAPI_DGLRPCEnableFeatureCache")
+.set_body([](DGLArgs args, DGLRetValue* rv) {
+  const std::string name = args[0];
+  NDArray local_data = args[1];
+  const int64_t budget = args[2];
+  const int admit_threshold = args[3];
+  CHECK_GT(local_data->ndim, 0);
+  int64_t row_size = local_data->dtype.bits / 8;
+  for (int i = 1; i < local_data->ndim; ++i)
+    row_size *= local_data->shape[i];
+  RPCContext::getInstance()->feature_caches[name] =
+    std::make_shared<FeatureCache>(row_size, budget, admit_threshold);
+});
+
+DGL_REGISTER_GLOBAL("distributed.rpc._CAPI_DGLRPCDisableFeatureCache")
+.set_body([](DGLArgs args, DGLRetValue* rv) {
+  const std::string name = args[0];
+  RPCContext::getInstance()->feature_caches.erase(name);
+});
+
+DGL_REGISTER_GLOBAL("distributed.rpc._CAPI_DGLRPCFeatureCachePin")
+.set_body([](DGLArgs args, DGLRetValue* rv) {
+  const std::string name = args[0];
+  IdArray ids = args[1];
+  NDArray rows = args[2];
+  std::shared_ptr<FeatureCache> cache = GetFeatureCache(name);
+  CHECK_EQ(ids->dtype.bits, 64) << "The IDs must be int64.";
+  CHECK_EQ(rows->ctx.device_type, kDLCPU) << "The rows must be on CPU.";
+  CHECK(rows.IsContiguous()) << "The rows must be contiguous.";
+  const int64_t num_ids = ids->shape[0];
+  CHECK_EQ(rows.GetSize(), static_cast<size_t>(num_ids * cache->row_size()))
+    << "The rows have a wrong size.";
+  const int64_t* ids_data = static_cast<int64_t*>(ids->data);
+  const char* rows_data = static_cast<const char*>(rows->data) + rows->byte_offset;
+  int64_t num_pinned = 0;
+  for (int64_t i = 0; i < num_ids; ++i)
+    num_pinned += cache->Pin(ids_data[i], rows_data + i * cache->row_size());
+  *rv = num_pinned;
+});
+
+DGL_REGISTER_GLOBAL("distributed.rpc._CAPI_DGLRPCFeatureCacheInvalidate")
+.set_body([](DGLArgs args, DGLRetValue* rv) {
+  const std::string name = args[0];
+  IdArray ids = args[1];
+  CHECK_EQ(ids->dtype.bits, 64) << "The IDs must be int64.";
+  GetFeatureCache(name)->Invalidate(static_cast<int64_t*>(ids->data), ids->shape[0]);
+});
+
+DGL_REGISTER_GLOBAL("distributed.rpc._CAPI_DGLRPCFeatureCacheStats")
+.set_body([](DGLArgs args, DGLRetValue* rv) {
+  const std::string name = args[0];
+  std::shared_ptr<FeatureCache> cache = GetFeatureCache(name);
+  *rv = NDArray::FromVector(std::vector<int64_t>{
+    cache->num_hits(), cache->num_misses(), cache->num_rows(), cache->capacity()});
+});
+
+DGL_REGISTER_GLOBAL("distributed.rpc._CAPI_DGLRPCGetStats")
+.set_body([](DGLArgs args, DGLRetValue* rv) {
+  RPCContext* ctx = RPCContext::getInstance();
+  *rv = ctx->stats.Snapshot(ctx->rank);
+});
+
+DGL_REGISTER_GLOBAL("distributed.rpc._CAPI_DGLRPCResetStats")
+.set_body([](DGLArgs args, DGLRetValue* rv) {
+  RPCContext::getInstance()->stats.Clear();
+});
+
+DGL_REGISTER_GLOBAL("distributed.rpc._CAPI_DGLRPCStartStatsDump")
+.set_body([](DGLArgs args, DGLRetValue* rv) {
+  const std::string path = args[0];
+  const double interval = args[1];
+  RPCContext* ctx = RPCContext::getInstance();
+  ctx->stats.StartDump(path, interval, ctx->rank);
+});
+
+DGL_REGISTER_GLOBAL("distributed.rpc._CAPI_DGLRPCStopStatsDump")
+.set_body([](DGLArgs args, DGLRetValue* rv) {
+  RPCContext::getInstance()->stats.StopDump();
+});
+
+/*!
+ * \brief The tensors whose pulls are served in C++, keyed by the payload of
+ *        the pull requests naming them.
+ */
+struct NativePullTable {
+  struct Entry {
+    // the rows of the local partition
+    NDArray data;
+    // the global ID of the first row
+    int64_t offset;
+    // the payload of the responses
+    std::string response_data;
+  };
+  std::unordered_map<std::string, Entry> entries;
+
+  static NativePullTable* Global() {
+    static NativePullTable table;
+    return &table;
+  }
+};
+
+/*!
+ * \brief Reply to a pull request with the rows of its global IDs.
+ *
+ * The requests of the tensors not in the table, or with an unexpected
+ * payload, are declined.
+ */
+bool HandleNativePull(const RPCMessage& req, RPCMessage* res) {
+  NativePullTable* table = NativePullTable::Global();
+  auto it = table->entries.find(req.data);
+  if (it == table->entries.end() || req.tensors.size() != 1)
+    return false;
+  const NDArray& ids = req.tensors[0];
+  if (ids->ndim != 1 || ids->dtype.code != kDLInt || ids->dtype.bits != 64 ||
+      ids->ctx.device_type != kDLCPU)
+    return false;
+  const NativePullTable::Entry& entry = it->second;
+  const NDArray& data = entry.data;
+  const int64_t num_rows = data->shape[0];
+  const int64_t row_size = num_rows > 0 ? data.GetSize() / num_rows : 0;
+  const int64_t num_ids = ids->shape[0];
+  std::vector<int64_t> shape(data->shape, data->shape + data->ndim);
+  shape[0] = num_ids;
+  NDArray rows = NDArray::Empty(shape, data->dtype, DLContext{kDLCPU, 0});
+  const int64_t* id_data = static_cast<const int64_t*>(ids->data);
+  const char* data_char = static_cast<const char*>(data->data);
+  char* rows_char = static_cast<char*>(rows->data);
+  parallel_for(0, num_ids, [&](size_t b, size_t e) {
+    for (auto i = b; i < e; ++i) {
+      const int64_t local_id = id_data[i] - entry.offset;
+      CHECK(local_id >= 0 && local_id < num_rows)
+        << "Pulled ID " << id_data[i] << " is not in the local partition.";
+      memcpy(rows_char + i * row_size, data_char + local_id * row_size, row_size);
+    }
+  });
+  res->data = entry.response_data;
+  res->tensors.push_back(rows);
+  return true;
+}
+
+DGL_REGISTER_GLOBAL("distributed.rpc._CAPI_DGLRPCRegisterNativePull")
+.set_body([](DGLArgs args, DGLRetValue* rv) {
+  const int32_t service_id = args[0];
+  const std::string request_data = args[1];
+  const std::string response_data = args[2];
+  NDArray data = args[3];
+  const int64_t offset = args[4];
+  CHECK_EQ(data->ctx.device_type, kDLCPU) << "Only CPU tensors can be pulled natively.";
+  CHECK(data.IsContiguous()) << "Only contiguous tensors can be pulled natively.";
+  CHECK_GT(data->ndim, 0) << "Only tensors with rows can be pulled natively.";
+  NativePullTable::Global()->entries[request_data] = {data, offset, response_data};
+  RPCContext::getInstance()->service_handlers[service_id] = HandleNativePull;
+});
+
+DGL_REGISTER_GLOBAL("distributed.rpc._CAPI_DGLRPCUnregisterNativePull")
+.set_body([](DGLArgs args, DGLRetValue* rv) {
+  const std::string request_data = args[0];
+  NativePullTable::Global()->entries.erase(request_data);
+});
+
+/*!
+ * \brief The neighbor samplings served in C++, keyed by the payload of the
+ *        sampling requests, i.e. by everything but their seed nodes.
+ */
+struct NativeSamplingTable {
+  struct Entry {
+    // the graph of the local partition, with a single edge type
+    HeteroGraphPtr graph;
+    // the global IDs of the local nodes and edges
+    IdArray nid, eid;
+    // the global ID of the first node of the partition
+    int64_t node_offset;
+    int64_t fanout;
+    bool in_edges;
+    bool replace;
+    // the payload of the responses
+    std::string response_data;
+  };
+  std::unordered_map<std::string, Entry> entries;
+
+  static NativeSamplingTable* Global() {
+    static NativeSamplingTable table;
+    return &table;
+  }
+};
+
+template <typename IdType>
+void SampleNeighborsBatch(const NativeSamplingTable::Entry& entry, const aten::CSRMatrix& mat,
+                          const std::vector<RPCMessage>& reqs, std::vector<RPCMessage>* res) {
+  const int64_t num_nodes = entry.graph->NumVertices(0);
+  std::vector<int64_t> req_offsets(reqs.size() + 1, 0);
+  for (size_t i = 0; i < reqs.size(); ++i)
+    req_offsets[i + 1] = req_offsets[i] + reqs[i].tensors[0]->shape[0];
+  IdArray rows = aten::NewIdArray(req_offsets.back(), DLContext{kDLCPU, 0}, sizeof(IdType) * 8);
+  IdType* rows_data = rows.Ptr<IdType>();
+  for (size_t i = 0; i < reqs.size(); ++i) {
+    const int64_t* seeds = static_cast<const int64_t*>(reqs[i].tensors[0]->data);
+    for (int64_t j = req_offsets[i]; j < req_offsets[i + 1]; ++j) {
+      const int64_t local_id = seeds[j - req_offsets[i]] - entry.node_offset;
+      CHECK(local_id >= 0 && local_id < num_nodes)
+        << "Sampled node " << local_id + entry.node_offset << " is not in the local partition.";
+      rows_data[j] = local_id;
     }
   }
-  *rv = res_tensor;
+
+  // one sampling over the seeds of all the requests
+  const aten::COOMatrix picked =
+    aten::CSRRowWiseSampling(mat, rows, entry.fanout, aten::NullArray(), entry.replace);
+
+  // the edges picked for every row are consecutive, in the order of the rows,
+  // and as many as its degree caps without replacement
+  const IdType* indptr = mat.indptr.Ptr<IdType>();
+  std::vector<int64_t> edge_offsets(reqs.size() + 1, 0);
+  for (size_t i = 0; i < reqs.size(); ++i) {
+    int64_t num_picked = 0;
+    for (int64_t j = req_offsets[i]; j < req_offsets[i + 1]; ++j) {
+      const int64_t deg = indptr[rows_data[j] + 1] - indptr[rows_data[j]];
+      num_picked += entry.replace ? (deg == 0 ? 0 : entry.fanout) : std::min(entry.fanout, deg);
+    }
+    edge_offsets[i + 1] = edge_offsets[i] + num_picked;
+  }
+  CHECK_EQ(edge_offsets.back(), picked.row->shape[0]) << "Unexpected number of sampled edges.";
+
+  const IdType* picked_row = picked.row.Ptr<IdType>();
+  const IdType* picked_col = picked.col.Ptr<IdType>();
+  const IdType* picked_eid = picked.data.Ptr<IdType>();
+  const int64_t* nid = entry.nid.Ptr<int64_t>();
+  const int64_t* eid = entry.eid.Ptr<int64_t>();
+  res->resize(reqs.size());
+  parallel_for(0, reqs.size(), 1, [&](size_t b, size_t e) {
+    for (auto i = b; i < e; ++i) {
+      const int64_t len = edge_offsets[i + 1] - edge_offsets[i];
+      IdArray src = aten::NewIdArray(len);
+      IdArray dst = aten::NewIdArray(len);
+      IdArray eids = aten::NewIdArray(len);
+      int64_t* src_data = src.Ptr<int64_t>();
+      int64_t* dst_data = dst.Ptr<int64_t>();
+      int64_t* eids_data = eids.Ptr<int64_t>();
+      for (int64_t k = 0; k < len; ++k) {
+        const int64_t j = edge_offsets[i] + k;
+        const int64_t row = nid[picked_row[j]], col = nid[picked_col[j]];
+        src_data[k] = entry.in_edges ? col : row;
+        dst_data[k] = entry.in_edges ? row : col;
+        eids_data[k] = eid[picked_eid[j]];
+      }
+      (*res)[i].data = entry.response_data;
+      (*res)[i].tensors = {src, dst, eids};
+    }
+  });
+}
+
+/*!
+ * \brief Reply to the neighbor sampling requests of the same payload with one
+ *        sampling over all their seed nodes, split back into a response per
+ *        request.
+ *
+ * The requests of the samplings not in the table, or with unexpected seed
+ * nodes, are declined.
+ */
+bool HandleNativeSampling(const std::vector<RPCMessage>& reqs, std::vector<RPCMessage>* res) {
+  NativeSamplingTable* table = NativeSamplingTable::Global();
+  auto it = table->entries.find(reqs[0].data);
+  if (it == table->entries.end())
+    return false;
+  for (const RPCMessage& req : reqs) {
+    if (req.tensors.size() != 1)
+      return false;
+    const NDArray& seeds = req.tensors[0];
+    if (seeds->ndim != 1 || seeds->dtype.code != kDLInt || seeds->dtype.bits != 64 ||
+        seeds->ctx.device_type != kDLCPU)
+      return false;
+  }
+  const NativeSamplingTable::Entry& entry = it->second;
+  const aten::CSRMatrix mat = entry.in_edges ?
+    entry.graph->GetCSCMatrix(0) : entry.graph->GetCSRMatrix(0);
+  if (aten::CSRHasWideIndptr(mat))
+    return false;
+  ATEN_ID_TYPE_SWITCH(mat.indptr->dtype, IdType, {
+    SampleNeighborsBatch<IdType>(entry, mat, reqs, res);
+  });
+  return true;
+}
+
+DGL_REGISTER_GLOBAL("distributed.rpc._CAPI_DGLRPCRegisterNativeSampling")
+.set_body([](DGLArgs args, DGLRetValue* rv) {
+  const int32_t service_id = args[0];
+  const std::string request_data = args[1];
+  NativeSamplingTable::Entry entry;
+  const std::string response_data = args[2];
+  entry.response_data = response_data;
+  HeteroGraphRef graph = args[3];
+  entry.graph = graph.sptr();
+  entry.nid = args[4];
+  entry.eid = args[5];
+  entry.node_offset = args[6];
+  entry.fanout = args[7];
+  entry.in_edges = args[8];
+  entry.replace = args[9];
+  const int64_t window_us = args[10];
+  CHECK_EQ(entry.graph->NumEdgeTypes(), 1) << "Only homogeneous graphs are sampled natively.";
+  CHECK_EQ(entry.graph->Context().device_type, kDLCPU)
+    << "Only graphs on CPU are sampled natively.";
+  CHECK_GE(entry.fanout, 0) << "The fanout must be non-negative.";
+  for (const IdArray& ids : {entry.nid, entry.eid}) {
+    CHECK(ids->dtype == DLDataType({kDLInt, 64, 1}) && ids->ctx.device_type == kDLCPU &&
+          ids.IsContiguous()) << "The global IDs must be contiguous int64 arrays on CPU.";
+  }
+  NativeSamplingTable::Global()->entries[request_data] = entry;
+  BatchService& service = RPCContext::getInstance()->batch_services[service_id];
+  service.handler = HandleNativeSampling;
+  service.window_us = window_us;
+});
+
+DGL_REGISTER_GLOBAL("distributed.rpc._CAPI_DGLRPCUnregisterNativeSampling")
+.set_body([](DGLArgs args, DGLRetValue* rv) {
+  const std::string request_data = args[0];
+  NativeSamplingTable::Global()->entries.erase(request_data);
 });
 
 }  // namespace rpc
@@ -11,13 +11,18 @@
 #include <dgl/zerocopy_serializer.h>
 #include <dmlc/thread_local.h>
 #include <cstdint>
+#include <functional>
+#include <future>
 #include <memory>
 #include <deque>
 #include <vector>
 #include <string>
 #include <mutex>
+#include <unordered_map>
 
+#include "./feature_cache.h"
 #include "./rpc_msg.h"
+#include "./rpc_stats.h"
 #include "./tensorpipe/tp_communicator.h"
 #include "./network/common.h"
 #include "./server_state.h"
@@ -30,6 +35,74 @@ struct RPCContext;
 // Communicator handler type
 typedef void* CommunicatorHandle;
 
+/*!
+ * \brief A handler of the requests of a service, run by the server in C++.
+ *
+ * \param req The request.
+ * \param res The response to send back to the client of the request.
+ * \return Whether the request has been handled, otherwise it is passed to
+ *         Python.
+ */
+typedef std::function<bool(const RPCMessage& req, RPCMessage* res)> ServiceHandler;
+
+/*!
+ * \brief A handler of the requests of a service, run by the server in C++ on
+ *        the requests received within a short window at once.
+ *
+ * \param reqs The requests, all of the same service and payload.
+ * \param res The responses to send back to the clients of the requests, in the
+ *        order of the requests.
+ * \return Whether the requests have been handled, otherwise they are passed
+ *         to Python.
+ */
+typedef std::function<bool(const std::vector<RPCMessage>& reqs,
+                           std::vector<RPCMessage>* res)> BatchServiceHandler;
+
+/*! \brief A service served in C++ in batches. */
+struct BatchService {
+  BatchServiceHandler handler;
+  /*!
+   * \brief The time in microseconds the server waits for more requests after
+   *        the first one of a batch.
+   */
+  int64_t window_us = 0;
+};
+
+/*!
+ * \brief A fast pull in flight.
+ *
+ * The rows of the local partition are copied in the background, while the
+ * rows of each remote partition are scattered into the result as soon as
+ * its response arrives, by whichever receive gets it first.
+ */
+struct FastPullObject : public runtime::Object {
+  /*! \brief The pulled rows, in the order of the requested IDs. */
+  runtime::NDArray result;
+  /*! \brief The size of a row in bytes. */
+  int64_t row_size = 0;
+  /*! \brief Total number of server per machine. */
+  int group_count = 1;
+  /*! \brief The service ID of the pull requests. */
+  int32_t service_id = 0;
+  /*! \brief The distinct IDs pulled from each partition. */
+  std::vector<std::vector<int64_t>> remote_ids;
+  /*! \brief The positions in the result of the rows of each partition. */
+  std::vector<std::vector<int64_t>> remote_pos;
+  /*! \brief The row in the response of each position of remote_pos. */
+  std::vector<std::vector<int64_t>> remote_rows;
+  /*! \brief The cache of the pulled tensor, if any, offered the remote rows. */
+  std::shared_ptr<FeatureCache> cache;
+  /*! \brief The number of responses not received yet. */
+  int num_pending = 0;
+  /*! \brief The copy of the local rows. */
+  std::future<void> local_gather;
+
+  static constexpr const char* _type_key = "rpc.FastPull";
+  DGL_DECLARE_OBJECT_TYPE_INFO(FastPullObject, runtime::Object);
+};
+
+DGL_DEFINE_OBJECT_REF(FastPullRef, FastPullObject);
+
 /*! \brief Context information for RPC communication */
 struct RPCContext {
   /*!
@@ -101,6 +174,48 @@ struct RPCContext {
    */
   std::shared_ptr<ServerState> server_state;
 
+  /*!
+   * \brief The handlers of the services served in C++, by service ID.
+   *
+   * The requests of these services are handled while receiving, and never
+   * reach Python unless the handler declines them.
+   */
+  std::unordered_map<int32_t, ServiceHandler> service_handlers;
+
+  /*!
+   * \brief The services served in C++ in batches, by service ID.
+   *
+   * The requests received together are grouped by service and payload, so that
+   * the handler runs once per group.
+   */
+  std::unordered_map<int32_t, BatchService> batch_services;
+
+  /*!
+   * \brief The fast pulls waiting for responses, by message sequence.
+   */
+  std::unordered_map<int64_t, std::shared_ptr<FastPullObject>> pending_pulls;
+
+  /*!
+   * \brief The messages received while waiting for a fast pull, which are
+   *        returned by the next receives from Python.
+   */
+  std::deque<RPCMessage> deferred_msgs;
+
+  /*!
+   * \brief The client-side caches of the remote rows, by tensor name.
+   */
+  std::unordered_map<std::string, std::shared_ptr<FeatureCache>> feature_caches;
+
+  /*!
+   * \brief The number of fast-pull requests in flight to each server.
+   */
+  std::vector<int32_t> server_inflight;
+
+  /*!
+   * \brief The counters and latencies of the messages sent and received.
+   */
+  RPCStats stats;
+
   /*! \brief Get the RPC context singleton */
   static RPCContext* getInstance() {
     static RPCContext ctx;
@@ -119,6 +234,14 @@ struct RPCContext {
     t->sender.reset();
     t->receiver.reset();
     t->ctx.reset();
+    t->service_handlers.clear();
+    t->batch_services.clear();
+    t->pending_pulls.clear();
+    t->deferred_msgs.clear();
+    t->feature_caches.clear();
+    t->server_inflight.clear();
+    t->stats.StopDump();
+    t->stats.Clear();
   }
 };
 
@@ -128,6 +251,12 @@ enum RPCStatus {
   kRPCTimeOut,
 };
 
+/*!
+ * \brief Create the tensorpipe context of the process in RPCContext, with its
+ *        transports and channels, if it is not created yet.
+ */
+void InitGlobalTpContext();
+
 /*!
  * \brief Send out one RPC message.
  *
@@ -0,0 +1,225 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file rpc/rpc_stats.cc
+ * \brief Counters and latency histograms of the RPC messages of a process.
+ */
+#include "./rpc_stats.h"
+
+#include <dmlc/logging.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+namespace dgl {
+namespace rpc {
+
+namespace {
+
+void WriteTraffic(const RPCStats::Traffic& traffic, std::ostream* os) {
+  *os << "\"num_sent\": " << traffic.num_sent
+      << ", \"bytes_sent\": " << traffic.bytes_sent
+      << ", \"num_recv\": " << traffic.num_recv
+      << ", \"bytes_recv\": " << traffic.bytes_recv;
+}
+
+}  // namespace
+
+constexpr int LatencyHistogram::kNumBuckets;
+constexpr size_t RPCStats::kMaxOutstanding;
+
+void LatencyHistogram::Add(int64_t us) {
+  us = std::max<int64_t>(us, 0);
+  int b = 0;
+  while (b < kNumBuckets - 1 && (int64_t(1) << b) <= us)
+    ++b;
+  ++buckets_[b];
+  ++count_;
+  sum_ += us;
+  max_ = std::max(max_, us);
+}
+
+int64_t LatencyHistogram::Quantile(double q) const {
+  if (count_ == 0)
+    return 0;
+  const int64_t rank = std::max<int64_t>(1, static_cast<int64_t>(std::ceil(q * count_)));
+  int64_t seen = 0;
+  for (int b = 0; b < kNumBuckets; ++b) {
+    seen += buckets_[b];
+    if (seen >= rank)
+      return std::min(int64_t(1) << b, max_);
+  }
+  return max_;
+}
+
+void LatencyHistogram::WriteJSON(std::ostream* os) const {
+  *os << "{\"count\": " << count_ << ", \"sum\": " << sum_ << ", \"max\": " << max_
+      << ", \"p50\": " << Quantile(0.5) << ", \"p90\": " << Quantile(0.9)
+      << ", \"p99\": " << Quantile(0.99) << ", \"buckets\": [";
+  // the empty buckets of the largest latencies are left out
+  int num_buckets = kNumBuckets;
+  while (num_buckets > 0 && buckets_[num_buckets - 1] == 0)
+    --num_buckets;
+  for (int b = 0; b < num_buckets; ++b)
+    *os << (b ? ", " : "") << buckets_[b];
+  *os << "]}";
+}
+
+int64_t RPCStats::TakeOutstanding(OutstandingTable* table, int32_t peer,
+                                  int32_t service_id, int64_t msg_seq) {
+  auto peer_it = table->msgs.find(peer);
+  if (peer_it == table->msgs.end())
+    return -1;
+  auto it = peer_it->second.find(msg_seq);
+  if (it == peer_it->second.end() || it->second.service_id != service_id)
+    return -1;
+  const int64_t start_us = it->second.start_us;
+  peer_it->second.erase(it);
+  --table->size;
+  return start_us;
+}
+
+void RPCStats::PutOutstanding(OutstandingTable* table, int32_t peer, int32_t service_id,
+                              int64_t msg_seq, int64_t now_us) {
+  if (table->size >= kMaxOutstanding) {
+    // e.g. the messages that are never answered
+    num_dropped_ += table->size;
+    table->msgs.clear();
+    table->size = 0;
+  }
+  Outstanding& msg = table->msgs[peer][msg_seq];
+  msg.service_id = service_id;
+  msg.start_us = now_us;
+  ++table->size;
+}
+
+void RPCStats::OnSend(int32_t service_id, int64_t msg_seq, int32_t target_id,
+                      int64_t bytes, int64_t now_us) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Service& service = services_[service_id];
+  ++service.traffic.num_sent;
+  service.traffic.bytes_sent += bytes;
+  Traffic& peer = peers_[target_id];
+  ++peer.num_sent;
+  peer.bytes_sent += bytes;
+  const int64_t start_us = TakeOutstanding(&recv_requests_, target_id, service_id, msg_seq);
+  if (start_us >= 0)
+    service.serve_latency.Add(now_us - start_us);
+  else
+    PutOutstanding(&sent_requests_, target_id, service_id, msg_seq, now_us);
+}
+
+void RPCStats::OnRecv(int32_t service_id, int64_t msg_seq, int32_t client_id,
+                      int32_t server_id, int64_t bytes, int64_t blocked_us,
+                      int64_t queue_depth, int64_t now_us) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Service& service = services_[service_id];
+  ++service.traffic.num_recv;
+  service.traffic.bytes_recv += bytes;
+  // a response comes from the server of its request, and a request from its
+  // client
+  int32_t peer_id = server_id;
+  const int64_t start_us = TakeOutstanding(&sent_requests_, server_id, service_id, msg_seq);
+  if (start_us >= 0) {
+    service.request_latency.Add(now_us - start_us);
+  } else {
+    peer_id = client_id;
+    PutOutstanding(&recv_requests_, client_id, service_id, msg_seq, now_us);
+  }
+  Traffic& peer = peers_[peer_id];
+  ++peer.num_recv;
+  peer.bytes_recv += bytes;
+  recv_blocked_.Add(blocked_us);
+  last_queue_depth_ = queue_depth;
+  max_queue_depth_ = std::max(max_queue_depth_, queue_depth);
+}
+
+std::string RPCStats::Snapshot(int32_t rank) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::ostringstream os;
+  const double time = std::chrono::duration<double>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+  os.precision(16);
+  os << "{\"rank\": " << rank << ", \"time\": " << time << ", \"services\": {";
+  bool first = true;
+  for (const auto& kv : services_) {
+    os << (first ? "" : ", ") << "\"" << kv.first << "\": {";
+    WriteTraffic(kv.second.traffic, &os);
+    os << ", \"request_latency_us\": ";
+    kv.second.request_latency.WriteJSON(&os);
+    os << ", \"serve_latency_us\": ";
+    kv.second.serve_latency.WriteJSON(&os);
+    os << "}";
+    first = false;
+  }
+  os << "}, \"peers\": {";
+  first = true;
+  for (const auto& kv : peers_) {
+    os << (first ? "" : ", ") << "\"" << kv.first << "\": {";
+    WriteTraffic(kv.second, &os);
+    os << "}";
+    first = false;
+  }
+  os << "}, \"recv_blocked_us\": ";
+  recv_blocked_.WriteJSON(&os);
+  os << ", \"recv_queue_depth\": {\"last\": " << last_queue_depth_
+     << ", \"max\": " << max_queue_depth_ << "}"
+     << ", \"num_outstanding\": " << sent_requests_.size + recv_requests_.size
+     << ", \"num_dropped\": " << num_dropped_ << "}";
+  return os.str();
+}
+
+void RPCStats::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  services_.clear();
+  peers_.clear();
+  recv_blocked_ = LatencyHistogram();
+  last_queue_depth_ = 0;
+  max_queue_depth_ = 0;
+  sent_requests_ = OutstandingTable();
+  recv_requests_ = OutstandingTable();
+  num_dropped_ = 0;
+}
+
+void RPCStats::StartDump(const std::string& path, double interval_s, int32_t rank) {
+  CHECK_GT(interval_s, 0) << "The interval of the RPC stats dump must be positive.";
+  StopDump();
+  dump_stop_ = false;
+  dump_thread_ = std::thread(&RPCStats::DumpLoop, this, path, interval_s, rank);
+}
+
+void RPCStats::StopDump() {
+  if (!dump_thread_.joinable())
+    return;
+  {
+    std::lock_guard<std::mutex> lock(dump_mutex_);
+    dump_stop_ = true;
+  }
+  dump_cond_.notify_all();
+  dump_thread_.join();
+}
+
+void RPCStats::DumpLoop(std::string path, double interval_s, int32_t rank) {
+  const std::chrono::duration<double> interval(interval_s);
+  std::unique_lock<std::mutex> lock(dump_mutex_);
+  for (;;) {
+    const bool stop = dump_cond_.wait_for(lock, interval, [this] { return dump_stop_; });
+    std::ofstream out(path, std::ios::app);
+    if (out)
+      out << Snapshot(rank) << std::endl;
+    else
+      LOG(WARNING) << "Cannot open " << path << " to dump the RPC stats.";
+    if (stop)
+      return;
+  }
+}
+
+int64_t RPCStats::NowMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}  // namespace rpc
+}  // namespace dgl
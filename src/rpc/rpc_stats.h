@@ -0,0 +1,166 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file rpc/rpc_stats.h
+ * \brief Counters and latency histograms of the RPC messages of a process.
+ *
+ * Every sent and received message is counted, with its bytes, by service ID
+ * and by peer. A received message whose service, sequence and peer match a
+ * request sent before is its response, and the time since the request is the
+ * request latency of the service. Conversely, a sent message that matches a
+ * request received before is its response, and the time since the request is
+ * the serve latency. The time spent blocked in receiving and the depth of the
+ * receive queue are recorded too.
+ *
+ * Latencies are kept in histograms of power-of-two buckets of microseconds,
+ * so that recording is a few increments under a lock.
+ */
+#ifndef DGL_RPC_RPC_STATS_H_
+#define DGL_RPC_RPC_STATS_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace dgl {
+namespace rpc {
+
+/*! \brief Histogram of latencies in microseconds. */
+class LatencyHistogram {
+ public:
+  /*! \brief Bucket b > 0 counts the latencies in [2^(b-1), 2^b) us. */
+  static constexpr int kNumBuckets = 40;
+
+  LatencyHistogram() : buckets_(kNumBuckets, 0) {}
+
+  void Add(int64_t us);
+
+  /*! \return The upper bound of the bucket of the q-quantile, 0 if empty. */
+  int64_t Quantile(double q) const;
+
+  int64_t count() const { return count_; }
+  int64_t sum() const { return sum_; }
+  int64_t max() const { return max_; }
+  const std::vector<int64_t>& buckets() const { return buckets_; }
+
+  /*! \brief Write the histogram as a JSON object. */
+  void WriteJSON(std::ostream* os) const;
+
+ private:
+  std::vector<int64_t> buckets_;
+  int64_t count_ = 0;
+  int64_t sum_ = 0;
+  int64_t max_ = 0;
+};
+
+class RPCStats {
+ public:
+  /*! \brief The message counts of a service or a peer. */
+  struct Traffic {
+    int64_t num_sent = 0;
+    int64_t bytes_sent = 0;
+    int64_t num_recv = 0;
+    int64_t bytes_recv = 0;
+  };
+
+  /*! \brief The counts and latencies of a service. */
+  struct Service {
+    Traffic traffic;
+    LatencyHistogram request_latency;
+    LatencyHistogram serve_latency;
+  };
+
+  /*! \brief The number of unanswered messages kept for matching. */
+  static constexpr size_t kMaxOutstanding = 1 << 16;
+
+  ~RPCStats() { StopDump(); }
+
+  /*!
+   * \brief Count a sent message.
+   * \param target_id The receiver of the message.
+   * \param now_us The current time in microseconds.
+   */
+  void OnSend(int32_t service_id, int64_t msg_seq, int32_t target_id,
+              int64_t bytes, int64_t now_us);
+
+  /*!
+   * \brief Count a received message.
+   * \param blocked_us The time spent waiting for it.
+   * \param queue_depth The number of messages still in the receive queue.
+   * \param now_us The current time in microseconds.
+   */
+  void OnRecv(int32_t service_id, int64_t msg_seq, int32_t client_id,
+              int32_t server_id, int64_t bytes, int64_t blocked_us,
+              int64_t queue_depth, int64_t now_us);
+
+  /*! \return The stats as a JSON object, with the rank of the process. */
+  std::string Snapshot(int32_t rank) const;
+
+  /*! \brief Drop all stats. */
+  void Clear();
+
+  /*!
+   * \brief Append a snapshot to a file every interval, in a background
+   *        thread, one JSON object per line.
+   */
+  void StartDump(const std::string& path, double interval_s, int32_t rank);
+
+  /*! \brief Stop the periodic dump, after a last snapshot. */
+  void StopDump();
+
+  /*! \return The current time in microseconds, for OnSend and OnRecv. */
+  static int64_t NowMicros();
+
+ private:
+  /*! \brief A message waiting for its response. */
+  struct Outstanding {
+    int32_t service_id;
+    int64_t start_us;
+  };
+
+  /*! \brief The outstanding messages, by peer and sequence. */
+  struct OutstandingTable {
+    std::unordered_map<int32_t, std::unordered_map<int64_t, Outstanding>> msgs;
+    size_t size = 0;
+  };
+
+  /*!
+   * \brief Take the outstanding message of a service, sequence and peer.
+   * \return Its start time, or -1 if not found.
+   */
+  static int64_t TakeOutstanding(OutstandingTable* table, int32_t peer,
+                                 int32_t service_id, int64_t msg_seq);
+
+  /*! \brief Keep a message until its response, dropping all if too many. */
+  void PutOutstanding(OutstandingTable* table, int32_t peer, int32_t service_id,
+                      int64_t msg_seq, int64_t now_us);
+
+  void DumpLoop(std::string path, double interval_s, int32_t rank);
+
+  mutable std::mutex mutex_;
+  // ordered, so that the snapshots list them in order
+  std::map<int32_t, Service> services_;
+  std::map<int32_t, Traffic> peers_;
+  LatencyHistogram recv_blocked_;
+  int64_t last_queue_depth_ = 0;
+  int64_t max_queue_depth_ = 0;
+  OutstandingTable sent_requests_;
+  OutstandingTable recv_requests_;
+  // the outstanding messages dropped without a response
+  int64_t num_dropped_ = 0;
+
+  std::mutex dump_mutex_;
+  std::condition_variable dump_cond_;
+  bool dump_stop_ = false;
+  std::thread dump_thread_;
+};
+
+}  // namespace rpc
+}  // namespace dgl
+
+#endif  // DGL_RPC_RPC_STATS_H_
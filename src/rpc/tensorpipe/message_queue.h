@@ -0,0 +1,167 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file message_queue.h
+ * \brief The queue of the received RPC messages, by priority of service and
+ *        with flow control per sender.
+ */
+#ifndef DGL_RPC_TENSORPIPE_MESSAGE_QUEUE_H_
+#define DGL_RPC_TENSORPIPE_MESSAGE_QUEUE_H_
+
+#include <dgl/runtime/ndarray.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include "../rpc_msg.h"
+
+namespace dgl {
+namespace rpc {
+
+/*!
+ * \brief The queue of the messages received and not taken yet.
+ *
+ * The messages are taken by priority of their service, highest first, and in
+ * arrival order within a priority, so that e.g. the sampling requests are not
+ * served behind large pulls. A message bypassed by kMaxBypass messages of
+ * higher priorities in a row is taken next, so that no service starves.
+ *
+ * Every sender has a credit of the bytes of its messages in the queue, an
+ * equal share of the capacity of the queue. A sender out of credit is not
+ * read from until its messages are taken, which makes the sender wait, so
+ * that a single sender cannot fill the memory of the receiver.
+ */
+class RPCMessageQueue {
+ public:
+  /*! \brief The number of messages that may bypass an older one in a row. */
+  static constexpr int kMaxBypass = 16;
+
+  /*!
+   * \brief Constructor.
+   * \param capacity The number of bytes of the messages in the queue the
+   *        credits of all the senders add up to.
+   */
+  explicit RPCMessageQueue(int64_t capacity) : capacity_(std::max<int64_t>(capacity, 1)) {}
+
+  /*! \brief Set the number of senders sharing the capacity. */
+  void SetNumSenders(int num_senders) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    credit_ = std::max<int64_t>(capacity_ / std::max(num_senders, 1), 1);
+  }
+
+  /*! \brief Set the priority of the messages of a service, 0 by default. */
+  void SetPriority(int32_t service_id, int32_t priority) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    priorities_[service_id] = priority;
+  }
+
+  /*!
+   * \brief Push a message of a sender.
+   * \param sender The ID of the sender.
+   * \param msg The message.
+   * \param resume The function reading the next message of the sender, called
+   *        once the sender has credit again if it has none left.
+   * \return Whether the sender has credit left, i.e. its next message is to be
+   *         read right away.
+   */
+  bool Push(int sender, RPCMessage msg, std::function<void()> resume) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int64_t bytes = msg.data.size();
+    for (const auto& tensor : msg.tensors)
+      bytes += tensor.GetSize();
+    auto it = priorities_.find(msg.service_id);
+    const int32_t priority = it == priorities_.end() ? 0 : it->second;
+    queues_[priority].push_back({std::move(msg), sender, next_seq_++, bytes});
+    ++size_;
+    SenderState& state = senders_[sender];
+    state.queued_bytes += bytes;
+    cv_.notify_one();
+    if (state.queued_bytes < credit_)
+      return true;
+    state.resume = std::move(resume);
+    return false;
+  }
+
+  /*! \brief Take the next message, waiting for one if the queue is empty. */
+  RPCMessage Pop() {
+    std::function<void()> resume;
+    RPCMessage msg;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this] { return size_ > 0; });
+      // the highest priority first, unless the oldest message waited too long
+      auto top = queues_.begin();
+      while (top->second.empty())
+        ++top;
+      auto next = top;
+      auto oldest = top;
+      bool bypasses = false;
+      for (auto q = std::next(top); q != queues_.end(); ++q) {
+        if (q->second.empty())
+          continue;
+        bypasses = true;
+        if (q->second.front().seq < oldest->second.front().seq)
+          oldest = q;
+      }
+      if (bypasses && ++bypassed_ > kMaxBypass) {
+        next = oldest;
+        bypassed_ = 0;
+      } else if (!bypasses) {
+        bypassed_ = 0;
+      }
+      Entry entry = std::move(next->second.front());
+      next->second.pop_front();
+      --size_;
+      SenderState& state = senders_[entry.sender];
+      state.queued_bytes -= entry.bytes;
+      if (state.resume && state.queued_bytes < credit_)
+        std::swap(resume, state.resume);
+      msg = std::move(entry.msg);
+    }
+    if (resume)
+      resume();
+    return msg;
+  }
+
+  /*! \brief The number of messages in the queue. */
+  size_t size() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return size_;
+  }
+
+ private:
+  struct Entry {
+    RPCMessage msg;
+    int sender;
+    uint64_t seq;
+    int64_t bytes;
+  };
+
+  struct SenderState {
+    int64_t queued_bytes = 0;
+    // set while the sender is out of credit
+    std::function<void()> resume;
+  };
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  const int64_t capacity_;
+  int64_t credit_ = capacity_;
+  /*! \brief The messages by priority, highest first. */
+  std::map<int32_t, std::deque<Entry>, std::greater<int32_t>> queues_;
+  std::unordered_map<int32_t, int32_t> priorities_;
+  std::unordered_map<int, SenderState> senders_;
+  uint64_t next_seq_ = 0;
+  size_t size_ = 0;
+  int bypassed_ = 0;
+};
+
+}  // namespace rpc
+}  // namespace dgl
+
+#endif  // DGL_RPC_TENSORPIPE_MESSAGE_QUEUE_H_
@@ -41,6 +41,11 @@ class Queue {
     return t;
   }
 
+  size_t size() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return items_.size();
+  }
+
  private:
   std::mutex mutex_;
   std::condition_variable cv_;
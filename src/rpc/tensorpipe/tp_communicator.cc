@@ -8,18 +8,62 @@
 
 #include <time.h>
 #include <unistd.h>
+#ifdef DGL_USE_CUDA
+#include <tensorpipe/tensorpipe_cuda.h>
+#endif  // DGL_USE_CUDA
 
 #include <future>
 #include <memory>
 #include <utility>
 
 #include "../rpc.h"
+#ifdef DGL_USE_CUDA
+#include "../../runtime/cuda/cuda_common.h"
+#endif  // DGL_USE_CUDA
 
 namespace dgl {
 namespace rpc {
 
 using namespace tensorpipe;
 
+namespace {
+
+/*!
+ * \brief The TensorPipe buffer of the data of an array, so that the pipe picks
+ *        the channel of its device, e.g. CUDA IPC for a GPU array.
+ */
+Buffer MakeTensorBuffer(const NDArray& array, void* data) {
+#ifdef DGL_USE_CUDA
+  if (array->ctx.device_type == kDLGPU) {
+    CudaBuffer cuda_buffer;
+    cuda_buffer.ptr = data;
+    cuda_buffer.stream = runtime::CUDAThreadEntry::ThreadLocal()->stream;
+    return cuda_buffer;
+  }
+#endif  // DGL_USE_CUDA
+  CHECK_EQ(array->ctx.device_type, kDLCPU)
+    << "Cannot send an NDArray on device " << array->ctx.device_type << ".";
+  CpuBuffer cpu_buffer;
+  cpu_buffer.ptr = data;
+  return cpu_buffer;
+}
+
+/*!
+ * \brief Allocate the array a tensor of a message is received into, on the GPU
+ *        of the sender for a GPU tensor and on CPU otherwise.
+ */
+NDArray AllocTensorTarget(const Descriptor::Tensor& tensor) {
+  const int64_t length = tensor.length;
+  const DLDataType dtype{kDLUInt, 8, 1};
+#ifdef DGL_USE_CUDA
+  if (tensor.sourceDevice.type == kCudaDeviceType)
+    return NDArray::Empty({length}, dtype, DLContext{kDLGPU, tensor.sourceDevice.index});
+#endif  // DGL_USE_CUDA
+  return NDArray::Empty({length}, dtype, DLContext{kDLCPU, 0});
+}
+
+}  // namespace
+
 void TPSender::AddReceiver(const std::string& addr, int recv_id) {
   receiver_addrs_[recv_id] = addr;
 }
@@ -69,9 +113,7 @@ void TPSender::Send(const RPCMessage& msg, int recv_id) {
   for (int i = 0; i < buffer_list.size(); i++) {
     auto& ptr = buffer_list[i];
     (*ndarray_holder.get())[i] = ptr.tensor;
-    tensorpipe::CpuBuffer cpu_buffer;
-    cpu_buffer.ptr = ptr.data;
-    tp_msg.tensors[i].buffer = cpu_buffer;
+    tp_msg.tensors[i].buffer = MakeTensorBuffer(ptr.tensor, ptr.data);
     tp_msg.tensors[i].length = ptr.size;
     if (ptr.size == 0) {
       LOG(FATAL) << "Cannot send a empty NDArray.";
@@ -91,6 +133,7 @@ void TPReceiver::Finalize() {}
 
 bool TPReceiver::Wait(const std::string& addr, int num_sender) {
   listener = context->listen({addr});
+  queue_->SetNumSenders(num_sender);
   for (int i = 0; i < num_sender; i++) {
     std::promise<std::shared_ptr<Pipe>> pipeProm;
     listener->accept([&](const Error& error, std::shared_ptr<Pipe> pipe) {
@@ -109,15 +152,15 @@ bool TPReceiver::Wait(const std::string& addr, int num_sender) {
       });
     CHECK(checkConnect.get_future().get()) << "Invalid connect message.";
     pipes_[i] = pipe;
-    ReceiveFromPipe(pipe, queue_);
+    ReceiveFromPipe(pipe, queue_, i);
   }
   return true;
 }
 
 void TPReceiver::ReceiveFromPipe(std::shared_ptr<Pipe> pipe,
-                                 std::shared_ptr<RPCMessageQueue> queue) {
-  pipe->readDescriptor([pipe, queue = std::move(queue)](const Error& error,
-                                                        Descriptor descriptor) {
+                                 std::shared_ptr<RPCMessageQueue> queue, int sender) {
+  pipe->readDescriptor([pipe, queue = std::move(queue), sender](const Error& error,
+                                                                Descriptor descriptor) {
     if (error) {
       // Error may happen when the pipe is closed
       return;
@@ -125,18 +168,18 @@ void TPReceiver::ReceiveFromPipe(std::shared_ptr<Pipe> pipe,
     Allocation allocation;
     CHECK_EQ(descriptor.payloads.size(), 0) << "Invalid DGL RPC Message";
 
-    int tensorsize = descriptor.tensors.size();
-    if (tensorsize > 0) {
-      allocation.tensors.resize(tensorsize);
-      for (int i = 0; i < descriptor.tensors.size(); i++) {
-        tensorpipe::CpuBuffer cpu_buffer;
-        cpu_buffer.ptr = new char[descriptor.tensors[i].length];
-        allocation.tensors[i].buffer = cpu_buffer;
-      }
+    // the tensors are received directly into the arrays of the message
+    const int tensorsize = descriptor.tensors.size();
+    std::vector<NDArray> targets(tensorsize);
+    allocation.tensors.resize(tensorsize);
+    for (int i = 0; i < tensorsize; i++) {
+      targets[i] = AllocTensorTarget(descriptor.tensors[i]);
+      allocation.tensors[i].buffer = MakeTensorBuffer(targets[i], targets[i]->data);
     }
     pipe->read(
       allocation, [allocation, descriptor = std::move(descriptor),
-                   queue = std::move(queue), pipe](const Error& error) {
+                   targets = std::move(targets),
+                   queue = std::move(queue), pipe, sender](const Error& error) {
         if (error) {
           // Because we always have a read event posted to the epoll,
           // Therefore when pipe is closed, error will be raised.
@@ -146,23 +189,33 @@ void TPReceiver::ReceiveFromPipe(std::shared_ptr<Pipe> pipe,
           return;
         }
 
-        char* meta_msg_begin = const_cast<char*>(&descriptor.metadata[0]);
-        std::vector<void*> buffer_list(descriptor.tensors.size());
-        for (int i = 0; i < descriptor.tensors.size(); i++) {
-          buffer_list[i] = allocation.tensors[i].buffer.unwrap<CpuBuffer>().ptr;
+#ifdef DGL_USE_CUDA
+        // the GPU tensors are complete once their streams are
+        for (const auto& tensor : allocation.tensors) {
+          const Device device = tensor.buffer.device();
+          if (device.type == kCudaDeviceType) {
+            CUDA_CALL(cudaSetDevice(device.index));
+            CUDA_CALL(cudaStreamSynchronize(tensor.buffer.unwrap<CudaBuffer>().stream));
+          }
         }
+#endif  // DGL_USE_CUDA
+        char* meta_msg_begin = const_cast<char*>(&descriptor.metadata[0]);
         StreamWithBuffer zc_read_strm(
           meta_msg_begin, descriptor.metadata.size() - sizeof(int32_t),
-          buffer_list);
+          targets);
         RPCMessage msg;
         zc_read_strm.Read(&msg);
-        queue->push(msg);
-        TPReceiver::ReceiveFromPipe(pipe, queue);
+        // a sender out of credit is read again once its messages are taken
+        auto resume = [pipe, queue, sender]() {
+          TPReceiver::ReceiveFromPipe(pipe, queue, sender);
+        };
+        if (queue->Push(sender, std::move(msg), resume))
+          resume();
       });
   });
 }
 
-void TPReceiver::Recv(RPCMessage* msg) { *msg = std::move(queue_->pop()); }
+void TPReceiver::Recv(RPCMessage* msg) { *msg = queue_->Pop(); }
 
 }  // namespace rpc
 }  // namespace dgl
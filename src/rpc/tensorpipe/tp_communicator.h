@@ -16,15 +16,11 @@
 #include <unordered_map>
 #include <vector>
 
-#include "./queue.h"
+#include "./message_queue.h"
 
 namespace dgl {
 namespace rpc {
 
-class RPCMessage;
-
-typedef Queue<RPCMessage> RPCMessageQueue;
-
 /*!
  * \brief TPSender for DGL distributed training.
  *
@@ -101,12 +97,12 @@ class TPReceiver {
  public:
   /*!
    * \brief Receiver constructor
-   * \param queue_size size of message queue.
+   * \param queue_size size of message queue in bytes, shared by the senders.
    */
-  explicit TPReceiver(std::shared_ptr<tensorpipe::Context> ctx) {
+  TPReceiver(std::shared_ptr<tensorpipe::Context> ctx, int64_t queue_size) {
     CHECK(ctx) << "Context is not initialized";
     this->context = ctx;
-    queue_ = std::make_shared<RPCMessageQueue>();
+    queue_ = std::make_shared<RPCMessageQueue>(queue_size);
   }
 
   /*!
@@ -133,6 +129,19 @@ class TPReceiver {
    */
   void Recv(RPCMessage* msg);
 
+  /*!
+   * \brief The number of received messages not taken by Recv() yet
+   */
+  size_t NumQueued() { return queue_->size(); }
+
+  /*!
+   * \brief Set the priority of the messages of a service, the messages of the
+   *        highest priority being received first. 0 by default.
+   */
+  void SetServicePriority(int32_t service_id, int32_t priority) {
+    queue_->SetPriority(service_id, priority);
+  }
+
   /*!
    * \brief Finalize SocketReceiver
    *
@@ -147,9 +156,11 @@ class TPReceiver {
 
   /*!
    * \brief Issue a receive request on pipe, and push the result into queue
+   *
+   * The next request is issued once the sender has credit in the queue.
    */
   static void ReceiveFromPipe(std::shared_ptr<tensorpipe::Pipe> pipe,
-                              std::shared_ptr<RPCMessageQueue> queue);
+                              std::shared_ptr<RPCMessageQueue> queue, int sender);
 
  private:
   /*!
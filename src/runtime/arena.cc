@@ -0,0 +1,69 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file runtime/arena.cc
+ * \brief A resettable per-thread arena for the temporaries of the CPU samplers.
+ */
+#include "arena.h"
+
+#include <dgl/runtime/device_api.h>
+#include <dgl/runtime/memory_tracker.h>
+#include <dmlc/logging.h>
+#include <dmlc/thread_local.h>
+#include <algorithm>
+
+namespace dgl {
+namespace runtime {
+
+constexpr size_t Arena::kAlignment;
+constexpr size_t Arena::kMinBlockSize;
+
+namespace {
+constexpr DGLContext kArenaContext = {kDLCPU, 0};
+}  // namespace
+
+Arena::~Arena() {
+  for (const Block& block : blocks_) {
+    DeviceAPI::Get(kArenaContext)->FreeDataSpace(kArenaContext, block.data);
+    if (block.tracked)
+      MemoryTracker::Global()->OnFree(kArenaContext, block.size, MemoryTag::kSampler);
+  }
+}
+
+Arena* Arena::ThreadLocal() {
+  return dmlc::ThreadLocalStore<Arena>::Get();
+}
+
+void* Arena::Alloc(size_t size, size_t alignment) {
+  CHECK(alignment > 0 && alignment <= kAlignment && (alignment & (alignment - 1)) == 0)
+    << "Invalid arena alignment " << alignment;
+  // The blocks are aligned to kAlignment, so aligning the offsets is enough.
+  for (; cur_block_ < blocks_.size(); ++cur_block_, offset_ = 0) {
+    const size_t start = (offset_ + alignment - 1) & ~(alignment - 1);
+    if (start + size <= blocks_[cur_block_].size) {
+      offset_ = start + size;
+      return blocks_[cur_block_].data + start;
+    }
+  }
+  // Grow geometrically so that the number of blocks stays small.
+  size_t block_size = std::max(kMinBlockSize, size);
+  if (!blocks_.empty())
+    block_size = std::max(block_size, blocks_.back().size * 2);
+  char* data = static_cast<char*>(DeviceAPI::Get(kArenaContext)->AllocDataSpace(
+      kArenaContext, block_size, kAlignment, DGLType{kDLInt, 8, 1}));
+  const bool tracked = MemoryTracker::Global()->OnAlloc(
+      kArenaContext, block_size, MemoryTag::kSampler);
+  blocks_.push_back({data, block_size, tracked});
+  cur_block_ = blocks_.size() - 1;
+  offset_ = size;
+  return data;
+}
+
+size_t Arena::Capacity() const {
+  size_t capacity = 0;
+  for (const Block& block : blocks_)
+    capacity += block.size;
+  return capacity;
+}
+
+}  // namespace runtime
+}  // namespace dgl
@@ -0,0 +1,163 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file runtime/arena.h
+ * \brief A resettable per-thread arena for the temporaries of the CPU samplers.
+ */
+#ifndef DGL_RUNTIME_ARENA_H_
+#define DGL_RUNTIME_ARENA_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace dgl {
+namespace runtime {
+
+/*!
+ * \brief A bump allocator releasing its memory in bulk.
+ *
+ * The temporaries are carved out of a few large blocks, which the arena keeps
+ * once released so that the next calls of the thread reuse them without going
+ * through the allocator. The memory is released by rewinding the arena to a
+ * mark taken before, usually with an ArenaScope around a sampling call; the
+ * allocations must therefore not outlive the scope they are made in.
+ *
+ * An arena is not thread-safe, each thread uses its own, see ThreadLocal.
+ */
+class Arena {
+ public:
+  /*! \brief A position in the arena. */
+  struct Mark {
+    size_t block;
+    size_t offset;
+  };
+
+  Arena() = default;
+  ~Arena();
+
+  // disable copying
+  Arena(const Arena& other) = delete;
+  Arena& operator=(const Arena& other) = delete;
+
+  /*! \return The arena of the calling thread. */
+  static Arena* ThreadLocal();
+
+  /*!
+   * \brief Allocate memory released by the next Rewind before this allocation.
+   * \param size The size in bytes.
+   * \param alignment The alignment, a power of two not greater than kAlignment.
+   */
+  void* Alloc(size_t size, size_t alignment = kAlignment);
+
+  /*! \brief Allocate an uninitialized array of num elements of type T. */
+  template <typename T>
+  T* Alloc(size_t num) {
+    return static_cast<T*>(Alloc(sizeof(T) * num, alignof(T)));
+  }
+
+  /*! \return The current position, to be given to Rewind. */
+  Mark GetMark() const {
+    return {cur_block_, offset_};
+  }
+
+  /*! \brief Release the memory allocated since the given mark. */
+  void Rewind(const Mark& mark) {
+    cur_block_ = mark.block;
+    offset_ = mark.offset;
+  }
+
+  /*! \brief Release all the memory allocated, keeping the blocks. */
+  void Reset() {
+    Rewind({0, 0});
+  }
+
+  /*! \return The total size of the blocks. */
+  size_t Capacity() const;
+
+  /*! \brief The alignment of the blocks. */
+  static constexpr size_t kAlignment = 64;
+  /*! \brief The minimum size of a block. */
+  static constexpr size_t kMinBlockSize = 1 << 20;
+
+ private:
+  struct Block {
+    char* data;
+    size_t size;
+    /*! \brief Whether the block is counted by the memory tracker. */
+    bool tracked;
+  };
+  std::vector<Block> blocks_;
+  /*! \brief The block being allocated from and the offset of its free part. */
+  size_t cur_block_{0}, offset_{0};
+};
+
+/*!
+ * \brief Release the memory allocated from an arena during the lifetime of the
+ *        scope when it ends. Scopes can be nested.
+ */
+class ArenaScope {
+ public:
+  explicit ArenaScope(Arena* arena = Arena::ThreadLocal())
+    : arena_(arena), mark_(arena->GetMark()) {}
+  ~ArenaScope() {
+    arena_->Rewind(mark_);
+  }
+
+  // disable copying
+  ArenaScope(const ArenaScope& other) = delete;
+  ArenaScope& operator=(const ArenaScope& other) = delete;
+
+  Arena* arena() const {
+    return arena_;
+  }
+
+ private:
+  Arena* arena_;
+  Arena::Mark mark_;
+};
+
+/*!
+ * \brief A standard allocator drawing from an arena, for the temporary containers.
+ *        Deallocating does nothing, the memory is released by the arena.
+ *        Defaults to the arena of the calling thread.
+ */
+template <typename T>
+class ArenaAllocator {
+ public:
+  typedef T value_type;
+
+  ArenaAllocator() : arena_(Arena::ThreadLocal()) {}
+  explicit ArenaAllocator(Arena* arena) : arena_(arena) {}
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena()) {}  // NOLINT
+
+  T* allocate(size_t num) {
+    return arena_->Alloc<T>(num);
+  }
+  void deallocate(T*, size_t) {}
+
+  Arena* arena() const {
+    return arena_;
+  }
+
+ private:
+  Arena* arena_;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) {
+  return lhs.arena() == rhs.arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) {
+  return lhs.arena() != rhs.arena();
+}
+
+/*! \brief A std::vector allocated from the arena of the calling thread. */
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+}  // namespace runtime
+}  // namespace dgl
+
+#endif  // DGL_RUNTIME_ARENA_H_
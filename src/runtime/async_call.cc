@@ -0,0 +1,262 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file runtime/async_call.cc
+ * \brief Calling packed functions asynchronously on a pool of worker threads.
+ */
+#include <dgl/runtime/async_call.h>
+#include <dgl/packed_func_ext.h>
+#include <dgl/runtime/registry.h>
+#include <dgl/runtime/stage_tracker.h>
+#include <dmlc/logging.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace dgl {
+namespace runtime {
+
+namespace {
+
+/*! \brief A queued call, with the arguments it retains. */
+struct Call {
+  PackedFunc f;
+  std::vector<DGLRetValue> args;
+  /*! \brief The indices of the arguments that are futures. */
+  std::vector<size_t> future_args;
+  Future future;
+  /*! \brief The minibatch of the caller, see StageBatchScope. */
+  int64_t batch;
+  /*! \brief The futures not done yet, plus one until the call is submitted. */
+  std::atomic<int> num_deps{1};
+};
+
+/*! \brief The worker threads running the queued calls. */
+class AsyncCallPool {
+ public:
+  static AsyncCallPool* Global() {
+    // never destroyed, the pending calls are waited for by the Python atexit hook
+    static AsyncCallPool* pool = new AsyncCallPool();
+    return pool;
+  }
+
+  /*! \brief Queue a call whose futures are all done. */
+  void Submit(std::shared_ptr<Call> call) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back(std::move(call));
+    cond_.notify_one();
+  }
+
+  /*! \brief Count a call, until it is done, for WaitAll. */
+  void AddPending() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++num_pending_;
+  }
+
+  int64_t NumPending() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return num_pending_;
+  }
+
+  /*! \brief Wait for all the calls counted by AddPending to finish. */
+  void WaitAll() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_cond_.wait(lock, [this] { return num_pending_ == 0; });
+  }
+
+ private:
+  AsyncCallPool() {
+    const char* var = std::getenv("DGL_ASYNC_CALL_THREADS");
+    const int num_threads = std::max(var ? std::atoi(var) : 1, 1);
+    for (int i = 0; i < num_threads; ++i)
+      std::thread(&AsyncCallPool::Run, this).detach();
+  }
+
+  void Run() {
+    while (true) {
+      std::shared_ptr<Call> call;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait(lock, [this] { return !queue_.empty(); });
+        call = std::move(queue_.front());
+        queue_.pop_front();
+      }
+      Future future = call->future;
+      DGLRetValue result;
+      std::string error = Invoke(call.get(), &result);
+      // release the arguments before reporting the call as done
+      call.reset();
+      future->Finish(std::move(result), error);
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (--num_pending_ == 0)
+        idle_cond_.notify_all();
+    }
+  }
+
+  /*! \return The error of the call, empty if none. */
+  static std::string Invoke(Call* call, DGLRetValue* rv) {
+    for (size_t i : call->future_args) {
+      Future dep(*call->args[i].ptr<std::shared_ptr<Object>>());
+      const std::string error = dep->Error();
+      if (!error.empty())
+        return "A future passed as argument " + std::to_string(i) + " failed: " + error;
+      call->args[i] = dep->Wait();
+    }
+    const size_t num_args = call->args.size();
+    std::vector<DGLValue> values(std::max<size_t>(num_args, 1));
+    std::vector<int> type_codes(std::max<size_t>(num_args, 1));
+    std::vector<DGLByteArray> bytes(num_args);
+    DGLArgsSetter setter(values.data(), type_codes.data());
+    for (size_t i = 0; i < num_args; ++i) {
+      const DGLRetValue& arg = call->args[i];
+      if (arg.type_code() == kBytes) {
+        const std::string* str = arg.ptr<std::string>();
+        bytes[i] = DGLByteArray{str->data(), str->size()};
+        setter(i, bytes[i]);
+      } else {
+        setter(i, arg);
+      }
+    }
+    try {
+      StageBatchScope batch_scope(call->batch);
+      call->f.CallPacked(
+          DGLArgs(values.data(), type_codes.data(), static_cast<int>(num_args)), rv);
+    } catch (const std::exception& e) {
+      const std::string error = e.what();
+      return error.empty() ? "Asynchronous call failed" : error;
+    }
+    return "";
+  }
+
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::condition_variable idle_cond_;
+  std::deque<std::shared_ptr<Call>> queue_;
+  int64_t num_pending_ = 0;
+};
+
+/*! \brief Count a future of a call done, submitting the call once they all are. */
+void ReleaseDep(const std::shared_ptr<Call>& call) {
+  if (--call->num_deps == 0)
+    AsyncCallPool::Global()->Submit(call);
+}
+
+}  // namespace
+
+bool FutureObject::Done() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return done_;
+}
+
+DGLRetValue FutureObject::Wait() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cond_.wait(lock, [this] { return done_; });
+  if (!error_.empty())
+    LOG(FATAL) << "Asynchronous call failed: " << error_;
+  return result_;
+}
+
+std::string FutureObject::Error() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return error_;
+}
+
+void FutureObject::Finish(DGLRetValue result, const std::string& error) {
+  std::vector<std::function<void()>> callbacks;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    CHECK(!done_) << "The call of the future has already finished.";
+    result_ = std::move(result);
+    error_ = error;
+    done_ = true;
+    callbacks.swap(callbacks_);
+    cond_.notify_all();
+  }
+  for (const auto& f : callbacks)
+    f();
+}
+
+void FutureObject::OnDone(std::function<void()> f) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!done_) {
+      callbacks_.push_back(std::move(f));
+      return;
+    }
+  }
+  f();
+}
+
+Future AsyncCall(PackedFunc f, DGLArgs args) {
+  CHECK(f != nullptr) << "Cannot call a null function asynchronously.";
+  auto call = std::make_shared<Call>();
+  call->f = f;
+  call->args.resize(args.num_args);
+  for (int i = 0; i < args.num_args; ++i) {
+    CHECK_NE(args.type_codes[i], kArrayHandle)
+      << "Argument " << i << " is an array view, which cannot be retained by the call.";
+    call->args[i] = args[i];
+    if (args.type_codes[i] == kObjectHandle) {
+      const auto& obj = *call->args[i].ptr<std::shared_ptr<Object>>();
+      if (obj && obj->is_type<FutureObject>())
+        call->future_args.push_back(i);
+    }
+  }
+  call->future = Future(std::make_shared<FutureObject>());
+  call->batch = StageBatchScope::Current();
+  AsyncCallPool::Global()->AddPending();
+  // the call is submitted by the last of its futures to finish
+  call->num_deps += static_cast<int>(call->future_args.size());
+  Future ret = call->future;
+  for (size_t i : call->future_args) {
+    Future dep(*call->args[i].ptr<std::shared_ptr<Object>>());
+    dep->OnDone([call]() { ReleaseDep(call); });
+  }
+  ReleaseDep(call);
+  return ret;
+}
+
+void WaitAllAsyncCalls() {
+  AsyncCallPool::Global()->WaitAll();
+}
+
+int64_t NumPendingAsyncCalls() {
+  return AsyncCallPool::Global()->NumPending();
+}
+
+DGL_REGISTER_GLOBAL("utils.async_call._CAPI_DGLAsyncCall")
+.set_body([](DGLArgs args, DGLRetValue* rv) {
+    PackedFunc f = args[0];
+    *rv = AsyncCall(f, DGLArgs(args.values + 1, args.type_codes + 1, args.num_args - 1));
+  });
+
+DGL_REGISTER_GLOBAL("utils.async_call._CAPI_DGLFutureDone")
+.set_body([](DGLArgs args, DGLRetValue* rv) {
+    Future future = args[0];
+    *rv = future->Done();
+  });
+
+DGL_REGISTER_GLOBAL("utils.async_call._CAPI_DGLFutureWait")
+.set_body([](DGLArgs args, DGLRetValue* rv) {
+    Future future = args[0];
+    *rv = future->Wait();
+  });
+
+DGL_REGISTER_GLOBAL("utils.async_call._CAPI_DGLNumPendingAsyncCalls")
+.set_body([](DGLArgs args, DGLRetValue* rv) {
+    *rv = NumPendingAsyncCalls();
+  });
+
+DGL_REGISTER_GLOBAL("utils.async_call._CAPI_DGLWaitAllAsyncCalls")
+.set_body([](DGLArgs args, DGLRetValue* rv) {
+    WaitAllAsyncCalls();
+  });
+
+}  // namespace runtime
+}  // namespace dgl
@@ -131,6 +131,19 @@ void DeviceAPI::PinData(DGLContext ctx, void* ptr, size_t nbytes) {
 void DeviceAPI::UnpinData(DGLContext ctx, void* ptr) {
   LOG(FATAL) << "Device does not support cudaHostUnregister api.";
 }
+
+void* DeviceAPI::AllocPinnedDataSpace(DGLContext ctx, size_t nbytes) {
+  LOG(FATAL) << "Device does not support cudaHostAlloc api.";
+  return nullptr;
+}
+
+void DeviceAPI::FreePinnedDataSpace(DGLContext ctx, void* ptr) {
+  LOG(FATAL) << "Device does not support cudaFreeHost api.";
+}
+
+bool DeviceAPI::IsPinned(DGLContext ctx, const void* ptr) {
+  return false;
+}
 }  // namespace runtime
 }  // namespace dgl
 
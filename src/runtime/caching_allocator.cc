@@ -0,0 +1,245 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file runtime/caching_allocator.cc
+ * \brief A size-class caching allocator for the CPU arrays.
+ */
+#include "./caching_allocator.h"
+
+#include <dmlc/logging.h>
+
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+
+namespace dgl {
+namespace runtime {
+
+namespace {
+
+/*! \brief The header right before each block. */
+struct BlockHeader {
+  // the pointer returned by the underlying allocator
+  void* raw;
+  // the size class, -1 if not cached
+  int32_t cls;
+  uint32_t magic;
+};
+
+constexpr uint32_t kBlockMagic = 0xdc1a110c;
+
+BlockHeader* GetHeader(void* ptr) {
+  return reinterpret_cast<BlockHeader*>(ptr) - 1;
+}
+
+/*! \return The offset of a block from its raw pointer, holding the header. */
+size_t HeaderOffset(size_t alignment) {
+  return std::max(alignment, CachingAllocator::kAlignment);
+}
+
+}  // namespace
+
+constexpr size_t CachingAllocator::kAlignment;
+constexpr size_t CachingAllocator::kMinClassBytes;
+constexpr int CachingAllocator::kNumClasses;
+constexpr size_t CachingAllocator::kMaxThreadCachedBytes;
+constexpr size_t CachingAllocator::kThreadCacheBytes;
+
+struct CachingAllocator::ThreadCache {
+  CachingAllocator* owner;
+  std::vector<std::vector<void*>> lists;
+  size_t bytes = 0;
+
+  explicit ThreadCache(CachingAllocator* owner)
+    : owner(owner), lists(SizeClass(kMaxThreadCachedBytes) + 1) {}
+
+  /*! \brief Give the blocks to the central lists of the owner. */
+  void Flush() {
+    std::lock_guard<std::mutex> lock(owner->mutex_);
+    for (size_t cls = 0; cls < lists.size(); ++cls) {
+      auto& central = owner->central_[cls];
+      central.insert(central.end(), lists[cls].begin(), lists[cls].end());
+      lists[cls].clear();
+    }
+    bytes = 0;
+  }
+};
+
+namespace {
+
+/*! \brief Whether the thread caches of the calling thread are destroyed. */
+thread_local bool thread_caches_destroyed = false;
+
+}  // namespace
+
+struct CachingAllocator::ThreadCaches {
+  std::unordered_map<CachingAllocator*, std::unique_ptr<ThreadCache>> caches;
+  ~ThreadCaches() {
+    for (auto& kv : caches)
+      kv.second->Flush();
+    // e.g. the arrays freed by static destructors go to the central lists
+    thread_caches_destroyed = true;
+  }
+};
+
+CachingAllocator::ThreadCaches* CachingAllocator::GetThreadCaches() {
+  if (thread_caches_destroyed)
+    return nullptr;
+  static thread_local ThreadCaches thread_caches;
+  return &thread_caches;
+}
+
+CachingAllocator::ThreadCache* CachingAllocator::GetThreadCache() {
+  ThreadCaches* thread_caches = GetThreadCaches();
+  if (!thread_caches)
+    return nullptr;
+  std::unique_ptr<ThreadCache>& cache = thread_caches->caches[this];
+  if (!cache)
+    cache.reset(new ThreadCache(this));
+  return cache.get();
+}
+
+CachingAllocator::CachingAllocator(RawAllocFn raw_alloc, RawFreeFn raw_free,
+                                   size_t cap_bytes)
+  : raw_alloc_(raw_alloc), raw_free_(raw_free), cap_bytes_(cap_bytes),
+    central_(kNumClasses) {}
+
+CachingAllocator::~CachingAllocator() {
+  EmptyCache();
+  ThreadCaches* thread_caches = GetThreadCaches();
+  if (thread_caches)
+    thread_caches->caches.erase(this);
+}
+
+int CachingAllocator::SizeClass(size_t nbytes) {
+  if (nbytes <= kMinClassBytes)
+    return 0;
+  if (nbytes > ClassBytes(kNumClasses - 1))
+    return -1;
+  int k = 0;
+  while ((size_t(2) << k) <= nbytes)
+    ++k;
+  // nbytes is in [2^k, 2^(k+1)), split in four classes
+  const size_t base = size_t(1) << k;
+  const size_t step = base >> 2;
+  return 4 * (k - 6) + static_cast<int>((nbytes - base + step - 1) / step);
+}
+
+size_t CachingAllocator::ClassBytes(int cls) {
+  const int k = 6 + cls / 4;
+  return (size_t(1) << k) + (cls % 4) * (size_t(1) << (k - 2));
+}
+
+void* CachingAllocator::Alloc(size_t nbytes, size_t alignment) {
+  ++num_allocs_;
+  const int cls = alignment <= kAlignment ? SizeClass(nbytes) : -1;
+  const size_t block_bytes = cls >= 0 ? ClassBytes(cls) : nbytes;
+  if (cls >= 0) {
+    const int64_t in_use = bytes_in_use_ += block_bytes;
+    int64_t peak = peak_bytes_in_use_.load(std::memory_order_relaxed);
+    while (in_use > peak && !peak_bytes_in_use_.compare_exchange_weak(peak, in_use)) {}
+
+    void* ptr = nullptr;
+    ThreadCache* cache = block_bytes <= kMaxThreadCachedBytes ? GetThreadCache() : nullptr;
+    if (cache && !cache->lists[cls].empty()) {
+      ptr = cache->lists[cls].back();
+      cache->lists[cls].pop_back();
+      cache->bytes -= block_bytes;
+    } else {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!central_[cls].empty()) {
+        ptr = central_[cls].back();
+        central_[cls].pop_back();
+      }
+    }
+    if (ptr) {
+      ++num_hits_;
+      bytes_cached_ -= block_bytes;
+      return ptr;
+    }
+  }
+
+  const size_t offset = HeaderOffset(alignment);
+  char* raw = static_cast<char*>(raw_alloc_(block_bytes + offset, offset));
+  void* ptr = raw + offset;
+  BlockHeader* header = GetHeader(ptr);
+  header->raw = raw;
+  header->cls = cls;
+  header->magic = kBlockMagic;
+  return ptr;
+}
+
+void CachingAllocator::Free(void* ptr) {
+  BlockHeader* header = GetHeader(ptr);
+  CHECK_EQ(header->magic, kBlockMagic) << "Freeing a block not allocated by the cache.";
+  const int cls = header->cls;
+  if (cls < 0) {
+    raw_free_(header->raw);
+    return;
+  }
+  const size_t block_bytes = ClassBytes(cls);
+  bytes_in_use_ -= block_bytes;
+  if (static_cast<size_t>(bytes_cached_ += block_bytes) > cap_bytes_.load()) {
+    bytes_cached_ -= block_bytes;
+    Release(ptr);
+    return;
+  }
+  ThreadCache* cache = block_bytes <= kMaxThreadCachedBytes ? GetThreadCache() : nullptr;
+  if (cache && cache->bytes + block_bytes <= kThreadCacheBytes) {
+    cache->lists[cls].push_back(ptr);
+    cache->bytes += block_bytes;
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  central_[cls].push_back(ptr);
+}
+
+void CachingAllocator::SetCap(size_t cap_bytes) {
+  cap_bytes_ = cap_bytes;
+  Trim();
+}
+
+void CachingAllocator::EmptyCache() {
+  ThreadCache* cache = GetThreadCache();
+  if (cache)
+    cache->Flush();
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (int cls = 0; cls < kNumClasses; ++cls) {
+    for (void* ptr : central_[cls]) {
+      bytes_cached_ -= ClassBytes(cls);
+      Release(ptr);
+    }
+    central_[cls].clear();
+  }
+}
+
+void CachingAllocator::Trim() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // the largest blocks first
+  for (int cls = kNumClasses - 1; cls >= 0; --cls) {
+    while (!central_[cls].empty() &&
+           static_cast<size_t>(bytes_cached_.load()) > cap_bytes_.load()) {
+      bytes_cached_ -= ClassBytes(cls);
+      Release(central_[cls].back());
+      central_[cls].pop_back();
+    }
+  }
+}
+
+void CachingAllocator::Release(void* ptr) {
+  ++num_releases_;
+  raw_free_(GetHeader(ptr)->raw);
+}
+
+CachingAllocator::Stats CachingAllocator::GetStats() const {
+  Stats stats;
+  stats.num_allocs = num_allocs_.load();
+  stats.num_hits = num_hits_.load();
+  stats.bytes_in_use = bytes_in_use_.load();
+  stats.peak_bytes_in_use = peak_bytes_in_use_.load();
+  stats.bytes_cached = bytes_cached_.load();
+  stats.num_releases = num_releases_.load();
+  return stats;
+}
+
+}  // namespace runtime
+}  // namespace dgl
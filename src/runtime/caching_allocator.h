@@ -0,0 +1,135 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file runtime/caching_allocator.h
+ * \brief A size-class caching allocator for the CPU arrays.
+ */
+#ifndef DGL_RUNTIME_CACHING_ALLOCATOR_H_
+#define DGL_RUNTIME_CACHING_ALLOCATOR_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace dgl {
+namespace runtime {
+
+/*!
+ * \brief An allocator keeping the freed blocks for the next allocations of
+ *        the same size class.
+ *
+ * The sizes are rounded up to classes of four per power of two, wasting at
+ * most a quarter of a block. The freed blocks of up to kMaxThreadCachedBytes
+ * are kept in free lists of the freeing thread, taken without locking, the
+ * larger ones in central free lists under a mutex. The blocks of the calling
+ * thread go to the central lists once it keeps kThreadCacheBytes, and the
+ * blocks of a thread exiting too. The blocks are released to the underlying
+ * allocator once all the cached blocks would exceed the cap.
+ *
+ * Every block starts with a header holding its size class, right before the
+ * returned pointer, so Free needs no lookup.
+ *
+ * CachingAllocator is thread-safe. It must outlive the threads using it,
+ * unless they do not free anything after it is destroyed.
+ */
+class CachingAllocator {
+ public:
+  /*! \brief The underlying allocator. */
+  typedef void* (*RawAllocFn)(size_t nbytes, size_t alignment);
+  typedef void (*RawFreeFn)(void* ptr);
+
+  struct Stats {
+    /*! \brief The number of allocations, and of those served from the cache. */
+    int64_t num_allocs;
+    int64_t num_hits;
+    /*! \brief The size of the cached classes allocated and not freed. */
+    int64_t bytes_in_use;
+    int64_t peak_bytes_in_use;
+    /*! \brief The size of the freed blocks kept. */
+    int64_t bytes_cached;
+    /*! \brief The number of blocks released to the underlying allocator. */
+    int64_t num_releases;
+  };
+
+  /*! \brief The largest alignment of the cached blocks. */
+  static constexpr size_t kAlignment = 64;
+  /*! \brief The size of the smallest size class. */
+  static constexpr size_t kMinClassBytes = 64;
+  /*! \brief The number of size classes, up to 2^40 bytes. */
+  static constexpr int kNumClasses = 4 * (40 - 6) + 1;
+  /*! \brief The largest blocks kept by the threads. */
+  static constexpr size_t kMaxThreadCachedBytes = 256 << 10;
+  /*! \brief The size of the blocks kept by each thread. */
+  static constexpr size_t kThreadCacheBytes = 4 << 20;
+
+  /*!
+   * \param raw_alloc The underlying allocation.
+   * \param raw_free The underlying deallocation.
+   * \param cap_bytes The size of the freed blocks kept at most.
+   */
+  CachingAllocator(RawAllocFn raw_alloc, RawFreeFn raw_free, size_t cap_bytes);
+  ~CachingAllocator();
+
+  // disable copying
+  CachingAllocator(const CachingAllocator& other) = delete;
+  CachingAllocator& operator=(const CachingAllocator& other) = delete;
+
+  /*!
+   * \brief Allocate a block, reusing a freed one if any. The blocks with an
+   *        alignment larger than kAlignment are not cached.
+   */
+  void* Alloc(size_t nbytes, size_t alignment);
+
+  /*! \brief Free a block allocated by Alloc. */
+  void Free(void* ptr);
+
+  /*! \brief Change the cap, releasing the central blocks beyond it. */
+  void SetCap(size_t cap_bytes);
+
+  /*! \brief Release the blocks of the central lists and the calling thread. */
+  void EmptyCache();
+
+  Stats GetStats() const;
+
+  /*! \return The size class of a size, -1 if not cached. */
+  static int SizeClass(size_t nbytes);
+
+  /*! \return The size of the blocks of a size class. */
+  static size_t ClassBytes(int cls);
+
+ private:
+  struct ThreadCache;
+  struct ThreadCaches;
+
+  /*! \return The thread caches of the calling thread, nullptr once it exits. */
+  static ThreadCaches* GetThreadCaches();
+
+  /*! \return The free lists of the calling thread, nullptr once it exits. */
+  ThreadCache* GetThreadCache();
+
+  /*! \brief Release the central blocks until the cache is within the cap. */
+  void Trim();
+
+  /*! \brief Release a cached block to the underlying allocator. */
+  void Release(void* ptr);
+
+  const RawAllocFn raw_alloc_;
+  const RawFreeFn raw_free_;
+  std::atomic<size_t> cap_bytes_;
+
+  std::mutex mutex_;
+  std::vector<std::vector<void*>> central_;
+
+  std::atomic<int64_t> num_allocs_{0};
+  std::atomic<int64_t> num_hits_{0};
+  std::atomic<int64_t> bytes_in_use_{0};
+  std::atomic<int64_t> peak_bytes_in_use_{0};
+  std::atomic<int64_t> bytes_cached_{0};
+  std::atomic<int64_t> num_releases_{0};
+};
+
+}  // namespace runtime
+}  // namespace dgl
+
+#endif  // DGL_RUNTIME_CACHING_ALLOCATOR_H_
@@ -6,12 +6,75 @@
 #include <dmlc/thread_local.h>
 #include <dgl/runtime/registry.h>
 #include <dgl/runtime/device_api.h>
+#include <dgl/runtime/huge_page.h>
+#include <dgl/runtime/memory_tracker.h>
+#include <dgl/runtime/ndarray.h>
+#include <dgl/runtime/numa.h>
 #include <cstdlib>
 #include <cstring>
+#include <vector>
+#include "caching_allocator.h"
 #include "workspace_pool.h"
 
 namespace dgl {
 namespace runtime {
+/*! \brief Buffers of at least this size are first-touched in the NUMA mode. */
+constexpr size_t kNumaFirstTouchBytes = 1 << 20;
+
+namespace {
+
+void* RawAllocDataSpace(size_t nbytes, size_t alignment) {
+  void* ptr;
+#if _MSC_VER || defined(__MINGW32__)
+  ptr = _aligned_malloc(nbytes, alignment);
+  if (ptr == nullptr) throw std::bad_alloc();
+#elif defined(_LIBCPP_SGX_CONFIG)
+  ptr = memalign(alignment, nbytes);
+  if (ptr == nullptr) throw std::bad_alloc();
+#else
+  // Huge pages are aligned beyond any alignment requested.
+  ptr = huge_page::Alloc(nbytes);
+  if (ptr == nullptr) {
+    int ret = posix_memalign(&ptr, alignment, nbytes);
+    if (ret != 0) throw std::bad_alloc();
+    huge_page::Advise(ptr, nbytes);
+  }
+  // Large buffers are fresh pages; spread them over the NUMA nodes like the
+  // kernels writing them do.
+  if (nbytes >= kNumaFirstTouchBytes)
+    numa::FirstTouch(ptr, nbytes);
+#endif
+  return ptr;
+}
+
+void RawFreeDataSpace(void* ptr) {
+#if _MSC_VER || defined(__MINGW32__)
+  _aligned_free(ptr);
+#else
+  if (!huge_page::Free(ptr))
+    free(ptr);
+#endif
+}
+
+/*!
+ * \brief The cache of the freed arrays, opt-in by setting the environment
+ *        variable DGL_CPU_ALLOC_CACHE_BYTES to the size kept at most.
+ * \return The cache, or nullptr if disabled.
+ */
+CachingAllocator* GetCachingAllocator() {
+  // never destroyed, since arrays may be freed by static destructors
+  static CachingAllocator* allocator = []() -> CachingAllocator* {
+    const char* var = std::getenv("DGL_CPU_ALLOC_CACHE_BYTES");
+    const int64_t cap_bytes = var ? std::atoll(var) : 0;
+    if (cap_bytes <= 0)
+      return nullptr;
+    return new CachingAllocator(RawAllocDataSpace, RawFreeDataSpace, cap_bytes);
+  }();
+  return allocator;
+}
+
+}  // namespace
+
 class CPUDeviceAPI final : public DeviceAPI {
  public:
   void SetDevice(DGLContext ctx) final {}
@@ -24,26 +87,18 @@ class CPUDeviceAPI final : public DeviceAPI {
                        size_t nbytes,
                        size_t alignment,
                        DGLType type_hint) final {
-    void* ptr;
-#if _MSC_VER || defined(__MINGW32__)
-    ptr = _aligned_malloc(nbytes, alignment);
-    if (ptr == nullptr) throw std::bad_alloc();
-#elif defined(_LIBCPP_SGX_CONFIG)
-    ptr = memalign(alignment, nbytes);
-    if (ptr == nullptr) throw std::bad_alloc();
-#else
-    int ret = posix_memalign(&ptr, alignment, nbytes);
-    if (ret != 0) throw std::bad_alloc();
-#endif
-    return ptr;
+    CachingAllocator* allocator = GetCachingAllocator();
+    if (allocator)
+      return allocator->Alloc(nbytes, alignment);
+    return RawAllocDataSpace(nbytes, alignment);
   }
 
   void FreeDataSpace(DGLContext ctx, void* ptr) final {
-#if _MSC_VER || defined(__MINGW32__)
-    _aligned_free(ptr);
-#else
-    free(ptr);
-#endif
+    CachingAllocator* allocator = GetCachingAllocator();
+    if (allocator)
+      allocator->Free(ptr);
+    else
+      RawFreeDataSpace(ptr);
   }
 
   void CopyDataFromTo(const void* from,
@@ -55,6 +110,7 @@ class CPUDeviceAPI final : public DeviceAPI {
                       DGLContext ctx_to,
                       DGLType type_hint,
                       DGLStreamHandle stream) final {
+    MemoryTracker::Global()->OnCopy(ctx_from, ctx_to, size);
     memcpy(static_cast<char*>(to) + to_offset,
            static_cast<const char*>(from) + from_offset,
            size);
@@ -96,5 +152,32 @@ DGL_REGISTER_GLOBAL("device_api.cpu")
     DeviceAPI* ptr = CPUDeviceAPI::Global().get();
     *rv = static_cast<void*>(ptr);
   });
+
+DGL_REGISTER_GLOBAL("utils.internal._CAPI_DGLCPUAllocatorStats")
+.set_body([](DGLArgs args, DGLRetValue* rv) {
+    CachingAllocator* allocator = GetCachingAllocator();
+    CachingAllocator::Stats stats = {};
+    if (allocator)
+      stats = allocator->GetStats();
+    *rv = NDArray::FromVector(std::vector<int64_t>{
+      allocator != nullptr, stats.num_allocs, stats.num_hits, stats.bytes_in_use,
+      stats.peak_bytes_in_use, stats.bytes_cached, stats.num_releases});
+  });
+
+DGL_REGISTER_GLOBAL("utils.internal._CAPI_DGLCPUAllocatorSetCap")
+.set_body([](DGLArgs args, DGLRetValue* rv) {
+    const int64_t cap_bytes = args[0];
+    CHECK_GE(cap_bytes, 0);
+    CachingAllocator* allocator = GetCachingAllocator();
+    if (allocator)
+      allocator->SetCap(cap_bytes);
+  });
+
+DGL_REGISTER_GLOBAL("utils.internal._CAPI_DGLCPUAllocatorEmptyCache")
+.set_body([](DGLArgs args, DGLRetValue* rv) {
+    CachingAllocator* allocator = GetCachingAllocator();
+    if (allocator)
+      allocator->EmptyCache();
+  });
 }  // namespace runtime
 }  // namespace dgl
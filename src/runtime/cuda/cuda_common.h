@@ -155,6 +155,8 @@ struct cusparse_idtype<int64_t> {
 };
 #endif
 
+class CUDAGraph;
+
 /*! \brief Thread local workspace */
 class CUDAThreadEntry {
  public:
@@ -168,6 +170,8 @@ class CUDAThreadEntry {
   curandGenerator_t curand_gen{nullptr};
   /*! \brief thread local pool*/
   WorkspacePool pool;
+  /*! \brief The CUDA graph being captured on the stream, if any */
+  CUDAGraph* capture{nullptr};
   /*! \brief constructor */
   CUDAThreadEntry();
   // get the threadlocal workspace
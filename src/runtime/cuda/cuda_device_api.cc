@@ -4,15 +4,54 @@
  * \brief GPU specific API
  */
 #include <dgl/runtime/device_api.h>
+#include <dgl/runtime/memory_tracker.h>
 
 #include <dmlc/thread_local.h>
 #include <dgl/runtime/registry.h>
+#include <dgl/runtime/tensordispatch.h>
 #include <cuda_runtime.h>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "../caching_allocator.h"
 #include "cuda_common.h"
+#include "cuda_graph.h"
 
 namespace dgl {
 namespace runtime {
 
+namespace {
+
+void* RawAllocPinnedDataSpace(size_t nbytes, size_t alignment) {
+  // page-locked memory is page aligned
+  void* ptr;
+  CUDA_CALL(cudaHostAlloc(&ptr, nbytes, cudaHostAllocDefault));
+  return ptr;
+}
+
+void RawFreePinnedDataSpace(void* ptr) {
+  CUDA_CALL(cudaFreeHost(ptr));
+}
+
+/*!
+ * \brief The pool of the page-locked host memory, keeping the freed blocks up to
+ *        DGL_CUDA_PINNED_CACHE_BYTES, 1 GB by default, since allocating them
+ *        costs far more than the copies they are for.
+ */
+CachingAllocator* GetPinnedAllocator() {
+  // never destroyed, since arrays may be freed by static destructors
+  static CachingAllocator* allocator = []() {
+    const char* var = std::getenv("DGL_CUDA_PINNED_CACHE_BYTES");
+    const int64_t cap_bytes = var ? std::atoll(var) : (int64_t(1) << 30);
+    return new CachingAllocator(RawAllocPinnedDataSpace, RawFreePinnedDataSpace,
+                                cap_bytes > 0 ? cap_bytes : 0);
+  }();
+  return allocator;
+}
+
+}  // namespace
+
 class CUDADeviceAPI final : public DeviceAPI {
  public:
   void SetDevice(DGLContext ctx) final {
@@ -112,6 +151,7 @@ class CUDADeviceAPI final : public DeviceAPI {
                       DGLContext ctx_to,
                       DGLType type_hint,
                       DGLStreamHandle stream) final {
+    MemoryTracker::Global()->OnCopy(ctx_from, ctx_to, size);
     cudaStream_t cu_stream = static_cast<cudaStream_t>(stream);
     from = static_cast<const char*>(from) + from_offset;
     to = static_cast<char*>(to) + to_offset;
@@ -184,12 +224,67 @@ class CUDADeviceAPI final : public DeviceAPI {
     CUDA_CALL(cudaHostUnregister(ptr));
   }
 
+  void* AllocPinnedDataSpace(DGLContext ctx, size_t nbytes) final {
+    CUDA_CALL(cudaSetDevice(ctx.device_id));
+    return GetPinnedAllocator()->Alloc(nbytes, CachingAllocator::kAlignment);
+  }
+
+  void FreePinnedDataSpace(DGLContext ctx, void* ptr) final {
+    GetPinnedAllocator()->Free(ptr);
+  }
+
+  bool IsPinned(DGLContext ctx, const void* ptr) final {
+    cudaPointerAttributes attr;
+    if (cudaPointerGetAttributes(&attr, ptr) != cudaSuccess) {
+      // the pageable memory is an error before CUDA 11
+      cudaGetLastError();
+      return false;
+    }
+#if CUDART_VERSION >= 10000
+    return attr.type == cudaMemoryTypeHost;
+#else
+    return attr.memoryType == cudaMemoryTypeHost;
+#endif
+  }
+
   void* AllocWorkspace(DGLContext ctx, size_t size, DGLType type_hint) final {
-    return CUDAThreadEntry::ThreadLocal()->pool.AllocWorkspace(ctx, size);
+    CUDAThreadEntry* entry = CUDAThreadEntry::ThreadLocal();
+    // the workspaces of the captured kernels must outlive the capture
+    if (entry->capture)
+      return entry->capture->AllocWorkspace(size);
+    // share the caching allocator of the framework, so that the memory freed by
+    // DGL can be reused by the framework and vice versa
+    TensorDispatcher* td = TensorDispatcher::Global();
+    if (td->IsWorkspaceAvailable())
+      return td->AllocWorkspace(size, ctx.device_id, entry->stream);
+#if CUDART_VERSION >= 11020
+    if (UseStreamOrderedWorkspace(ctx.device_id)) {
+      CUDA_CALL(cudaSetDevice(ctx.device_id));
+      void* ret;
+      CUDA_CALL(cudaMallocAsync(&ret, size, entry->stream));
+      return ret;
+    }
+#endif
+    return entry->pool.AllocWorkspace(ctx, size);
   }
 
   void FreeWorkspace(DGLContext ctx, void* data) final {
-    CUDAThreadEntry::ThreadLocal()->pool.FreeWorkspace(ctx, data);
+    CUDAThreadEntry* entry = CUDAThreadEntry::ThreadLocal();
+    if (entry->capture && entry->capture->OwnsWorkspace(data))
+      return;
+    TensorDispatcher* td = TensorDispatcher::Global();
+    if (td->IsWorkspaceAvailable()) {
+      td->FreeWorkspace(data);
+      return;
+    }
+#if CUDART_VERSION >= 11020
+    if (UseStreamOrderedWorkspace(ctx.device_id)) {
+      CUDA_CALL(cudaSetDevice(ctx.device_id));
+      CUDA_CALL(cudaFreeAsync(data, entry->stream));
+      return;
+    }
+#endif
+    entry->pool.FreeWorkspace(ctx, data);
   }
 
   static const std::shared_ptr<CUDADeviceAPI>& Global() {
@@ -199,6 +294,45 @@ class CUDADeviceAPI final : public DeviceAPI {
   }
 
  private:
+#if CUDART_VERSION >= 11020
+  /*!
+   * \brief Whether the workspaces of a device are allocated from its memory
+   *        pool in the order of the stream of the calling thread, so that
+   *        allocating and freeing them does not synchronize the device.
+   *
+   * It is decided once for all the devices, so that every workspace is freed
+   * the way it was allocated: for the devices supporting memory pools, unless
+   * DGL_CUDA_ASYNC_WORKSPACE is 0. The pools keep the freed memory instead of
+   * releasing it at each synchronization.
+   */
+  static bool UseStreamOrderedWorkspace(int device_id) {
+    static const std::vector<bool> enabled = []() -> std::vector<bool> {
+      int num_devices = 0;
+      if (cudaGetDeviceCount(&num_devices) != cudaSuccess)
+        num_devices = 0;
+      std::vector<bool> enabled(num_devices, false);
+      const char* var = std::getenv("DGL_CUDA_ASYNC_WORKSPACE");
+      if (var && std::strcmp(var, "0") == 0)
+        return enabled;
+      for (int device = 0; device < num_devices; ++device) {
+        int supported = 0;
+        CUDA_CALL(cudaDeviceGetAttribute(
+            &supported, cudaDevAttrMemoryPoolsSupported, device));
+        if (!supported)
+          continue;
+        cudaMemPool_t pool;
+        CUDA_CALL(cudaDeviceGetDefaultMemPool(&pool, device));
+        uint64_t threshold = UINT64_MAX;
+        CUDA_CALL(cudaMemPoolSetAttribute(
+            pool, cudaMemPoolAttrReleaseThreshold, &threshold));
+        enabled[device] = true;
+      }
+      return enabled;
+    }();
+    return device_id < static_cast<int>(enabled.size()) && enabled[device_id];
+  }
+#endif  // CUDART_VERSION >= 11020
+
   static void GPUCopy(const void* from,
                       void* to,
                       size_t size,
@@ -0,0 +1,176 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file cuda_graph.cc
+ * \brief Capture and replay of the DGL CUDA kernels with CUDA graphs.
+ */
+#include "./cuda_graph.h"
+
+#include <dgl/runtime/device_api.h>
+#include <dgl/runtime/registry.h>
+#include <dgl/packed_func_ext.h>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+#include "./cuda_common.h"
+
+namespace dgl {
+namespace runtime {
+
+namespace {
+/*! \brief The alignment of the workspaces carved out of the fixed buffer. */
+constexpr size_t kWorkspaceAlign = 256;
+}  // namespace
+
+CUDAGraph::CUDAGraph(DGLContext ctx, size_t workspace_size)
+  : ctx_(ctx), workspace_size_(workspace_size) {
+  CHECK_EQ(ctx.device_type, kDLGPU) << "CUDA graphs require a GPU context";
+  if (workspace_size_ > 0)
+    workspace_ = DeviceAPI::Get(ctx_)->AllocDataSpace(
+        ctx_, workspace_size_, kWorkspaceAlign, DLDataType{kDLInt, 8, 1});
+}
+
+CUDAGraph::~CUDAGraph() {
+  // the graph may be destroyed while the replays are still running
+  cudaSetDevice(ctx_.device_id);
+  if (exec_ || stream_)
+    cudaDeviceSynchronize();
+  if (exec_)
+    cudaGraphExecDestroy(exec_);
+  if (graph_)
+    cudaGraphDestroy(graph_);
+  if (workspace_)
+    cudaFree(workspace_);
+  for (void* ptr : extra_workspaces_)
+    cudaFree(ptr);
+  for (void* ptr : host_data_)
+    cudaFreeHost(ptr);
+  if (own_stream_)
+    cudaStreamDestroy(stream_);
+}
+
+void CUDAGraph::BeginCapture() {
+  auto* thr_entry = CUDAThreadEntry::ThreadLocal();
+  CHECK(thr_entry->capture == nullptr) << "A CUDA graph is already being captured";
+  CHECK(exec_ == nullptr) << "The CUDA graph was already captured";
+  CUDA_CALL(cudaSetDevice(ctx_.device_id));
+  prev_stream_ = thr_entry->stream;
+  if (prev_stream_ == nullptr) {
+    // the legacy default stream cannot be captured
+    CUDA_CALL(cudaStreamCreateWithFlags(&stream_, cudaStreamNonBlocking));
+    own_stream_ = true;
+    // order the capture after the work already submitted
+    CUDA_CALL(cudaStreamSynchronize(prev_stream_));
+  } else {
+    stream_ = prev_stream_;
+  }
+  thr_entry->stream = stream_;
+  thr_entry->capture = this;
+  // the relaxed mode lets other threads and the framework allocate device
+  // memory while the stream is being captured
+  CUDA_CALL(cudaStreamBeginCapture(stream_, cudaStreamCaptureModeRelaxed));
+}
+
+void CUDAGraph::EndCapture() {
+  auto* thr_entry = CUDAThreadEntry::ThreadLocal();
+  CHECK(thr_entry->capture == this) << "The CUDA graph is not being captured";
+  thr_entry->capture = nullptr;
+  thr_entry->stream = prev_stream_;
+  CUDA_CALL(cudaStreamEndCapture(stream_, &graph_));
+#if CUDART_VERSION >= 12000
+  CUDA_CALL(cudaGraphInstantiate(&exec_, graph_, 0));
+#else
+  CUDA_CALL(cudaGraphInstantiate(&exec_, graph_, nullptr, nullptr, 0));
+#endif
+}
+
+void CUDAGraph::Replay() {
+  CHECK(exec_ != nullptr) << "The CUDA graph has not been captured";
+  CUDA_CALL(cudaSetDevice(ctx_.device_id));
+  CUDA_CALL(cudaGraphLaunch(exec_, CUDAThreadEntry::ThreadLocal()->stream));
+}
+
+void* CUDAGraph::AllocWorkspace(size_t size) {
+  const size_t offset = (workspace_used_ + kWorkspaceAlign - 1) / kWorkspaceAlign
+    * kWorkspaceAlign;
+  if (offset + size <= workspace_size_) {
+    // the workspaces are never reused: the kernels captured before and after a
+    // free may run concurrently on replay
+    workspace_used_ = offset + size;
+    return static_cast<char*>(workspace_) + offset;
+  }
+  void* ptr = DeviceAPI::Get(ctx_)->AllocDataSpace(
+      ctx_, std::max<size_t>(size, 1), kWorkspaceAlign, DLDataType{kDLInt, 8, 1});
+  extra_workspaces_.push_back(ptr);
+  return ptr;
+}
+
+bool CUDAGraph::OwnsWorkspace(const void* ptr) const {
+  const char* p = static_cast<const char*>(ptr);
+  const char* begin = static_cast<const char*>(workspace_);
+  if (workspace_ && p >= begin && p < begin + workspace_size_)
+    return true;
+  return std::find(extra_workspaces_.begin(), extra_workspaces_.end(), ptr)
+    != extra_workspaces_.end();
+}
+
+void* CUDAGraph::RetainHostData(const void* data, size_t size) {
+  void* ptr = nullptr;
+  CUDA_CALL(cudaMallocHost(&ptr, std::max<size_t>(size, 1)));
+  std::memcpy(ptr, data, size);
+  host_data_.push_back(ptr);
+  return ptr;
+}
+
+bool IsCapturing(cudaStream_t stream) {
+  cudaStreamCaptureStatus status = cudaStreamCaptureStatusNone;
+  CUDA_CALL(cudaStreamIsCapturing(stream, &status));
+  return status != cudaStreamCaptureStatusNone;
+}
+
+void CheckNotCapturing(cudaStream_t stream, const std::string& op) {
+  if (IsCapturing(stream)) {
+    LOG(FATAL) << op << " synchronizes with the host and cannot be captured in"
+               << " a CUDA graph. Run the computation once before capturing it,"
+               << " so that its host-side state is cached.";
+  }
+}
+
+void CopyHostToDeviceAsync(const void* host, void* device, size_t size, cudaStream_t stream) {
+  if (size == 0)
+    return;
+  CUDAGraph* capture = CUDAThreadEntry::ThreadLocal()->capture;
+  if (capture && IsCapturing(stream))
+    host = capture->RetainHostData(host, size);
+  CUDA_CALL(cudaMemcpyAsync(device, host, size, cudaMemcpyHostToDevice, stream));
+}
+
+DGL_REGISTER_GLOBAL("cuda.cuda_graph._CAPI_DGLCUDAGraphCreate")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+  DGLContext ctx;
+  ctx.device_type = kDLGPU;
+  ctx.device_id = args[0];
+  const int64_t workspace_size = args[1];
+  *rv = CUDAGraphRef(std::make_shared<CUDAGraph>(ctx, workspace_size));
+});
+
+DGL_REGISTER_GLOBAL("cuda.cuda_graph._CAPI_DGLCUDAGraphBeginCapture")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+  CUDAGraphRef graph = args[0];
+  graph->BeginCapture();
+});
+
+DGL_REGISTER_GLOBAL("cuda.cuda_graph._CAPI_DGLCUDAGraphEndCapture")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+  CUDAGraphRef graph = args[0];
+  graph->EndCapture();
+});
+
+DGL_REGISTER_GLOBAL("cuda.cuda_graph._CAPI_DGLCUDAGraphReplay")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+  CUDAGraphRef graph = args[0];
+  graph->Replay();
+});
+
+}  // namespace runtime
+}  // namespace dgl
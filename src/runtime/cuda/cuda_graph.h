@@ -0,0 +1,119 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file cuda_graph.h
+ * \brief Capture and replay of the DGL CUDA kernels with CUDA graphs.
+ */
+#ifndef DGL_RUNTIME_CUDA_CUDA_GRAPH_H_
+#define DGL_RUNTIME_CUDA_CUDA_GRAPH_H_
+
+#include <cuda_runtime.h>
+#include <dgl/runtime/object.h>
+#include <string>
+#include <vector>
+
+namespace dgl {
+namespace runtime {
+
+/*!
+ * \brief A CUDA graph recording the kernels DGL launches on the stream of the
+ *        calling thread, to replay them without the host-side dispatch.
+ *
+ * While capturing
+ *
+ * - the workspaces are carved out of a fixed device buffer allocated before
+ *   the capture starts and owned by the graph, since every replay reuses the
+ *   same addresses. A workspace not fitting in it gets its own device buffer,
+ *   also owned by the graph;
+ * - the host data copied to the device is first copied to pinned memory owned
+ *   by the graph, see CopyHostToDeviceAsync;
+ * - the operators synchronizing with the host fail with an explicit error, see
+ *   CheckNotCapturing. They only do so the first time they see a graph, when
+ *   building the plans of the kernel plan cache, so running the computation
+ *   once before capturing it is enough.
+ *
+ * The captured kernels read and write the arrays at the addresses they had
+ * during the capture: a replay is only valid for the same graphs and feature
+ * arrays, whose content can be updated in place.
+ */
+class CUDAGraph : public Object {
+ public:
+  /*!
+   * \brief Constructor.
+   * \param ctx The device the kernels run on.
+   * \param workspace_size The size in bytes of the fixed workspace buffer.
+   */
+  CUDAGraph(DGLContext ctx, size_t workspace_size);
+  ~CUDAGraph();
+
+  // disable copying
+  CUDAGraph(const CUDAGraph& other) = delete;
+  CUDAGraph& operator=(const CUDAGraph& other) = delete;
+
+  /*!
+   * \brief Start capturing the kernels launched on the stream of the calling
+   *        thread. A dedicated stream is used if it is the default stream,
+   *        which cannot be captured.
+   */
+  void BeginCapture();
+
+  /*! \brief Stop capturing and instantiate the CUDA graph. */
+  void EndCapture();
+
+  /*! \brief Launch the captured kernels on the stream of the calling thread. */
+  void Replay();
+
+  /*! \brief Allocate a workspace living as long as the graph. */
+  void* AllocWorkspace(size_t size);
+
+  /*! \return Whether the workspace was allocated by AllocWorkspace. */
+  bool OwnsWorkspace(const void* ptr) const;
+
+  /*! \brief Copy host data to pinned memory living as long as the graph. */
+  void* RetainHostData(const void* data, size_t size);
+
+  static constexpr const char* _type_key = "cuda.CUDAGraph";
+  DGL_DECLARE_OBJECT_TYPE_INFO(CUDAGraph, Object);
+
+ private:
+  DGLContext ctx_;
+  /*! \brief The stream of the thread before the capture. */
+  cudaStream_t prev_stream_{nullptr};
+  /*! \brief The stream the capture runs on. */
+  cudaStream_t stream_{nullptr};
+  /*! \brief Whether stream_ was created for the capture. */
+  bool own_stream_{false};
+  cudaGraph_t graph_{nullptr};
+  cudaGraphExec_t exec_{nullptr};
+  /*! \brief The fixed workspace buffer and the size of its used part. */
+  void* workspace_{nullptr};
+  size_t workspace_size_{0}, workspace_used_{0};
+  /*! \brief The workspaces not fitting in the fixed buffer. */
+  std::vector<void*> extra_workspaces_;
+  /*! \brief The pinned copies of the host data. */
+  std::vector<void*> host_data_;
+};
+
+DGL_DEFINE_OBJECT_REF(CUDAGraphRef, CUDAGraph);
+
+/*! \return Whether the given stream is being captured. */
+bool IsCapturing(cudaStream_t stream);
+
+/*!
+ * \brief Fail with an explicit message if the given stream is being captured.
+ * \param stream The stream the operator runs on.
+ * \param op The name of the operator synchronizing with the host.
+ */
+void CheckNotCapturing(cudaStream_t stream, const std::string& op);
+
+/*!
+ * \brief Asynchronously copy host data to the device in a way that can be
+ *        captured: during a capture of the calling thread, the data is first
+ *        copied to pinned memory owned by the CUDA graph, so that every replay
+ *        reads the same values even after the host buffer is gone.
+ */
+void CopyHostToDeviceAsync(const void* host, void* device, size_t size, cudaStream_t stream);
+
+}  // namespace runtime
+}  // namespace dgl
+
+#endif  // DGL_RUNTIME_CUDA_CUDA_GRAPH_H_
@@ -0,0 +1,258 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file runtime/cuda/cuda_id_hash_table.cu
+ * \brief A persistent GPU hashtable from ids to values, updated by batches.
+ */
+#include "./cuda_id_hash_table.cuh"
+
+#include <dgl/array.h>
+#include <dgl/runtime/device_api.h>
+#include <dgl/runtime/registry.h>
+#include <dgl/packed_func_ext.h>
+#include <algorithm>
+
+#include "./cuda_common.h"
+#include "../../array/cuda/atomic.cuh"
+
+using namespace dgl::aten::cuda;
+
+namespace dgl {
+namespace runtime {
+namespace cuda {
+
+namespace {
+
+constexpr int BLOCK_SIZE = 256;
+constexpr int64_t kMinSlots = 64;
+
+inline int64_t NumBlocks(const int64_t n) {
+  return (n + BLOCK_SIZE - 1) / BLOCK_SIZE;
+}
+
+/*!
+ * \brief Insert a key if it is not in the table yet, counting the new slots.
+ * \return The slot of the key.
+ */
+inline __device__ int64_t _InsertKey(
+    const DeviceIdHashTable &table, const int64_t key, int64_t * const counters) {
+  for (int64_t pos = table.Hash(key); ; pos = (pos + 1) & table.mask) {
+    int64_t k = table.keys[pos];
+    if (k == DeviceIdHashTable::kEmptyKey) {
+      k = AtomicCAS(&table.keys[pos], DeviceIdHashTable::kEmptyKey, key);
+      if (k == DeviceIdHashTable::kEmptyKey) {
+        atomicAdd(reinterpret_cast<unsigned long long*>(counters), 1ull);  // NOLINT
+        atomicAdd(reinterpret_cast<unsigned long long*>(counters + 1), 1ull);  // NOLINT
+        return pos;
+      }
+    }
+    if (k == key)
+      return pos;
+  }
+}
+
+template <typename IdType, typename ValType>
+__global__ void _InsertKernel(
+    const DeviceIdHashTable table, const IdType * const keys,
+    const ValType * const values, const int64_t num_keys, int64_t * const counters) {
+  const int64_t tx = blockIdx.x * blockDim.x + threadIdx.x;
+  if (tx < num_keys) {
+    assert(keys[tx] >= 0);
+    const int64_t pos = _InsertKey(table, keys[tx], counters);
+    table.values[pos] = values[tx];
+  }
+}
+
+__global__ void _RebuildKernel(
+    const DeviceIdHashTable table, const int64_t * const old_keys,
+    const int64_t * const old_values, const int64_t num_old_slots,
+    int64_t * const counters) {
+  const int64_t tx = blockIdx.x * blockDim.x + threadIdx.x;
+  if (tx < num_old_slots && old_keys[tx] >= 0) {
+    const int64_t pos = _InsertKey(table, old_keys[tx], counters);
+    table.values[pos] = old_values[tx];
+  }
+}
+
+template <typename IdType>
+__global__ void _LookupKernel(
+    const DeviceIdHashTable table, const IdType * const keys, const int64_t num_keys,
+    int64_t * const values) {
+  const int64_t tx = blockIdx.x * blockDim.x + threadIdx.x;
+  if (tx < num_keys)
+    values[tx] = table.Find(keys[tx]);
+}
+
+template <typename IdType>
+__global__ void _RemoveKernel(
+    const DeviceIdHashTable table, const IdType * const keys, const int64_t num_keys,
+    int64_t * const counters) {
+  const int64_t tx = blockIdx.x * blockDim.x + threadIdx.x;
+  if (tx < num_keys && keys[tx] >= 0) {
+    const int64_t key = keys[tx];
+    const int64_t pos = table.FindSlot(key);
+    // the same key removed twice in the batch only counts once
+    if (pos >= 0 &&
+        AtomicCAS(&table.keys[pos], key, DeviceIdHashTable::kRemovedKey) == key) {
+      table.values[pos] = -1;
+      atomicAdd(reinterpret_cast<unsigned long long*>(counters + 1),  // NOLINT
+                static_cast<unsigned long long>(-1));  // NOLINT
+    }
+  }
+}
+
+}  // namespace
+
+CUDAIdHashTable::CUDAIdHashTable(DGLContext ctx, int64_t capacity) : ctx_(ctx) {
+  CHECK_EQ(ctx.device_type, kDLGPU) << "The hashtable must be on GPU.";
+  Allocate(capacity);
+}
+
+CUDAIdHashTable::~CUDAIdHashTable() {
+  auto device = DeviceAPI::Get(ctx_);
+  device->FreeDataSpace(ctx_, keys_);
+  device->FreeDataSpace(ctx_, values_);
+  device->FreeDataSpace(ctx_, counters_);
+}
+
+void CUDAIdHashTable::Allocate(int64_t capacity) {
+  auto device = DeviceAPI::Get(ctx_);
+  cudaStream_t stream = CUDAThreadEntry::ThreadLocal()->stream;
+  num_slots_ = kMinSlots;
+  while (num_slots_ < 2 * capacity)
+    num_slots_ *= 2;
+  const DGLType dtype{kDLInt, 64, 1};
+  keys_ = static_cast<int64_t*>(device->AllocDataSpace(
+      ctx_, num_slots_ * sizeof(int64_t), sizeof(int64_t), dtype));
+  values_ = static_cast<int64_t*>(device->AllocDataSpace(
+      ctx_, num_slots_ * sizeof(int64_t), sizeof(int64_t), dtype));
+  if (!counters_)
+    counters_ = static_cast<int64_t*>(device->AllocDataSpace(
+        ctx_, 2 * sizeof(int64_t), sizeof(int64_t), dtype));
+  // all the bytes of kEmptyKey and of the missing value -1 are set
+  CUDA_CALL(cudaMemsetAsync(keys_, 0xFF, num_slots_ * sizeof(int64_t), stream));
+  CUDA_CALL(cudaMemsetAsync(values_, 0xFF, num_slots_ * sizeof(int64_t), stream));
+  CUDA_CALL(cudaMemsetAsync(counters_, 0, 2 * sizeof(int64_t), stream));
+  used_bound_ = 0;
+}
+
+void CUDAIdHashTable::ReadCounters(int64_t * num_used, int64_t * num_keys) const {
+  auto device = DeviceAPI::Get(ctx_);
+  cudaStream_t stream = CUDAThreadEntry::ThreadLocal()->stream;
+  int64_t counters[2];
+  device->CopyDataFromTo(
+      counters_, 0, counters, 0, sizeof(counters), ctx_, DGLContext{kDLCPU, 0},
+      DGLType{kDLInt, 64, 1}, stream);
+  device->StreamSync(ctx_, stream);
+  *num_used = counters[0];
+  *num_keys = counters[1];
+}
+
+DeviceIdHashTable CUDAIdHashTable::DeviceHandle() const {
+  return DeviceIdHashTable{keys_, values_, num_slots_ - 1};
+}
+
+void CUDAIdHashTable::Insert(IdArray keys, IdArray values) {
+  CHECK_EQ(keys->ndim, 1) << "The keys must be a 1D array.";
+  CHECK_EQ(keys->shape[0], values->shape[0]) << "There must be one value for each key.";
+  CHECK(keys->ctx == ctx_ && values->ctx == ctx_)
+    << "The keys and the values must be on the device of the hashtable.";
+  const int64_t num_keys = keys->shape[0];
+  if (num_keys == 0)
+    return;
+  auto device = DeviceAPI::Get(ctx_);
+  cudaStream_t stream = CUDAThreadEntry::ThreadLocal()->stream;
+
+  if (2 * (used_bound_ + num_keys) > num_slots_) {
+    int64_t num_used, num_old_keys;
+    ReadCounters(&num_used, &num_old_keys);
+    used_bound_ = num_used;
+    if (2 * (num_used + num_keys) > num_slots_) {
+      // rebuild the table without the tombstones
+      int64_t * old_keys = keys_;
+      int64_t * old_values = values_;
+      const int64_t num_old_slots = num_slots_;
+      Allocate(num_old_keys + num_keys);
+      CUDA_KERNEL_CALL(_RebuildKernel, NumBlocks(num_old_slots), BLOCK_SIZE, 0, stream,
+          DeviceHandle(), old_keys, old_values, num_old_slots, counters_);
+      device->FreeDataSpace(ctx_, old_keys);
+      device->FreeDataSpace(ctx_, old_values);
+      used_bound_ = num_old_keys;
+    }
+  }
+
+  ATEN_ID_TYPE_SWITCH(keys->dtype, IdType, {
+    ATEN_ID_TYPE_SWITCH(values->dtype, ValType, {
+      CUDA_KERNEL_CALL((_InsertKernel<IdType, ValType>), NumBlocks(num_keys), BLOCK_SIZE,
+          0, stream, DeviceHandle(), keys.Ptr<IdType>(), values.Ptr<ValType>(), num_keys,
+          counters_);
+    });
+  });
+  used_bound_ += num_keys;
+}
+
+IdArray CUDAIdHashTable::Lookup(IdArray keys) const {
+  CHECK_EQ(keys->ndim, 1) << "The keys must be a 1D array.";
+  CHECK(keys->ctx == ctx_) << "The keys must be on the device of the hashtable.";
+  cudaStream_t stream = CUDAThreadEntry::ThreadLocal()->stream;
+  const int64_t num_keys = keys->shape[0];
+  IdArray values = aten::NewIdArray(num_keys, ctx_, 64);
+  ATEN_ID_TYPE_SWITCH(keys->dtype, IdType, {
+    CUDA_KERNEL_CALL(_LookupKernel<IdType>, NumBlocks(num_keys), BLOCK_SIZE, 0, stream,
+        DeviceHandle(), keys.Ptr<IdType>(), num_keys, values.Ptr<int64_t>());
+  });
+  return values;
+}
+
+void CUDAIdHashTable::Remove(IdArray keys) {
+  CHECK_EQ(keys->ndim, 1) << "The keys must be a 1D array.";
+  CHECK(keys->ctx == ctx_) << "The keys must be on the device of the hashtable.";
+  cudaStream_t stream = CUDAThreadEntry::ThreadLocal()->stream;
+  const int64_t num_keys = keys->shape[0];
+  ATEN_ID_TYPE_SWITCH(keys->dtype, IdType, {
+    CUDA_KERNEL_CALL(_RemoveKernel<IdType>, NumBlocks(num_keys), BLOCK_SIZE, 0, stream,
+        DeviceHandle(), keys.Ptr<IdType>(), num_keys, counters_);
+  });
+}
+
+int64_t CUDAIdHashTable::Size() const {
+  int64_t num_used, num_keys;
+  ReadCounters(&num_used, &num_keys);
+  return num_keys;
+}
+
+DGL_REGISTER_GLOBAL("cuda.id_hash_table._CAPI_DGLCUDAIdHashTableCreate")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+  DGLContext ctx;
+  ctx.device_type = kDLGPU;
+  ctx.device_id = args[0];
+  const int64_t capacity = args[1];
+  *rv = CUDAIdHashTableRef(std::make_shared<CUDAIdHashTable>(ctx, capacity));
+});
+
+DGL_REGISTER_GLOBAL("cuda.id_hash_table._CAPI_DGLCUDAIdHashTableInsert")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+  CUDAIdHashTableRef table = args[0];
+  table->Insert(args[1], args[2]);
+});
+
+DGL_REGISTER_GLOBAL("cuda.id_hash_table._CAPI_DGLCUDAIdHashTableLookup")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+  CUDAIdHashTableRef table = args[0];
+  *rv = table->Lookup(args[1]);
+});
+
+DGL_REGISTER_GLOBAL("cuda.id_hash_table._CAPI_DGLCUDAIdHashTableRemove")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+  CUDAIdHashTableRef table = args[0];
+  table->Remove(args[1]);
+});
+
+DGL_REGISTER_GLOBAL("cuda.id_hash_table._CAPI_DGLCUDAIdHashTableSize")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+  CUDAIdHashTableRef table = args[0];
+  *rv = table->Size();
+});
+
+}  // namespace cuda
+}  // namespace runtime
+}  // namespace dgl
@@ -0,0 +1,147 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file runtime/cuda/cuda_id_hash_table.cuh
+ * \brief A persistent GPU hashtable from ids to values, updated by batches.
+ */
+#ifndef DGL_RUNTIME_CUDA_CUDA_ID_HASH_TABLE_CUH_
+#define DGL_RUNTIME_CUDA_CUDA_ID_HASH_TABLE_CUH_
+
+#include <cuda_runtime.h>
+#include <dgl/runtime/ndarray.h>
+#include <dgl/runtime/object.h>
+
+namespace dgl {
+namespace runtime {
+namespace cuda {
+
+/*!
+ * \brief A device-side handle of a CUDAIdHashTable, to look up the keys from
+ *        CUDA code, e.g. to find the cache slots of the input nodes of a
+ *        minibatch in the kernel gathering their features.
+ *
+ * The table uses linear probing. A removed key leaves a tombstone, so that the
+ * keys after it in the probing sequence can still be found.
+ */
+struct DeviceIdHashTable {
+  static constexpr int64_t kEmptyKey = -1;
+  static constexpr int64_t kRemovedKey = -2;
+
+  int64_t * keys;
+  int64_t * values;
+  /*! \brief The number of slots minus one, the number of slots being a power of two. */
+  int64_t mask;
+
+  inline __device__ int64_t Hash(const int64_t key) const {
+    // the finalizer of MurmurHash3, so that consecutive ids are spread
+    uint64_t x = static_cast<uint64_t>(key);
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    return static_cast<int64_t>(x) & mask;
+  }
+
+  /*!
+   * \brief Find the slot of a key.
+   * \return The slot, or -1 if the key is not in the table.
+   */
+  inline __device__ int64_t FindSlot(const int64_t key) const {
+    for (int64_t pos = Hash(key); ; pos = (pos + 1) & mask) {
+      const int64_t k = keys[pos];
+      if (k == key)
+        return pos;
+      if (k == kEmptyKey)
+        return -1;
+    }
+  }
+
+  /*!
+   * \brief Find the value of a key.
+   * \return The value, or -1 if the key is not in the table.
+   */
+  inline __device__ int64_t Find(const int64_t key) const {
+    const int64_t pos = key < 0 ? -1 : FindSlot(key);
+    return pos < 0 ? -1 : values[pos];
+  }
+};
+
+/*!
+ * \brief A GPU hashtable from non-negative ids to 64-bit values living across
+ *        calls, e.g. a cache mapping global node ids to the slots of a feature
+ *        buffer on the GPU.
+ *
+ * The keys are inserted, looked up and removed by batches, with one kernel per
+ * batch on the stream of the calling thread. The table is kept at most half
+ * full, tombstones included: an insertion which could exceed it first counts
+ * the used slots on the host, and rebuilds the table without the tombstones,
+ * larger if needed. The host otherwise tracks an upper bound of the used slots,
+ * so that most insertions do not synchronize.
+ */
+class CUDAIdHashTable : public Object {
+ public:
+  /*!
+   * \brief Constructor.
+   * \param ctx The device of the table.
+   * \param capacity The number of keys the table holds before growing.
+   */
+  CUDAIdHashTable(DGLContext ctx, int64_t capacity);
+  ~CUDAIdHashTable();
+
+  // disable copying
+  CUDAIdHashTable(const CUDAIdHashTable& other) = delete;
+  CUDAIdHashTable& operator=(const CUDAIdHashTable& other) = delete;
+
+  /*!
+   * \brief Insert the keys with their values, replacing the values of the keys
+   *        already in the table. The value of a key given several times is
+   *        one of its values.
+   * \param keys The keys, of int32 or int64, on the device of the table.
+   * \param values The values, of int32 or int64, one for each key.
+   */
+  void Insert(IdArray keys, IdArray values);
+
+  /*!
+   * \brief Look up the keys.
+   * \param keys The keys, of int32 or int64, on the device of the table.
+   * \return The int64 values of the keys, -1 for the keys not in the table.
+   */
+  IdArray Lookup(IdArray keys) const;
+
+  /*!
+   * \brief Remove the keys, ignoring the ones not in the table.
+   * \param keys The keys, of int32 or int64, on the device of the table.
+   */
+  void Remove(IdArray keys);
+
+  /*! \return The number of keys in the table. Synchronizes with the host. */
+  int64_t Size() const;
+
+  /*! \return A device-side handle of the table, valid until the next insertion. */
+  DeviceIdHashTable DeviceHandle() const;
+
+  static constexpr const char* _type_key = "cuda.CUDAIdHashTable";
+  DGL_DECLARE_OBJECT_TYPE_INFO(CUDAIdHashTable, Object);
+
+ private:
+  /*! \brief Allocate empty slots for at least the given number of keys. */
+  void Allocate(int64_t capacity);
+
+  /*! \brief Read the numbers of used slots and of keys on the device. */
+  void ReadCounters(int64_t * num_used, int64_t * num_keys) const;
+
+  DGLContext ctx_;
+  int64_t num_slots_{0};
+  int64_t * keys_{nullptr};
+  int64_t * values_{nullptr};
+  /*! \brief The numbers of used slots, tombstones included, and of keys. */
+  int64_t * counters_{nullptr};
+  /*! \brief An upper bound of the number of used slots. */
+  int64_t used_bound_{0};
+};
+
+DGL_DEFINE_OBJECT_REF(CUDAIdHashTableRef, CUDAIdHashTable);
+
+}  // namespace cuda
+}  // namespace runtime
+}  // namespace dgl
+
+#endif  // DGL_RUNTIME_CUDA_CUDA_ID_HASH_TABLE_CUH_
@@ -31,6 +31,7 @@
 #include <cuda_runtime.h>
 #include <cuda_fp16.h>
 
+#include <algorithm>
 #include <cmath>
 #include <sstream>
 #include <iomanip>
@@ -144,6 +145,166 @@ __global__ void _InversePermKernel(
   }
 }
 
+template<typename DType>
+__global__ void _SegmentCopyKernel(
+    const DType * const in,
+    const int64_t * const segments,
+    DType * const out) {
+  // each segment is a triplet of source offset, destination offset and length
+  const int64_t in_offset = segments[3*blockIdx.x];
+  const int64_t out_offset = segments[3*blockIdx.x+1];
+  const int64_t length = segments[3*blockIdx.x+2];
+
+  int64_t idx = blockIdx.y*static_cast<int64_t>(blockDim.x)+threadIdx.x;
+  const int64_t stride = blockDim.x*static_cast<int64_t>(gridDim.y);
+  while (idx < length) {
+    out[out_offset+idx] = in[in_offset+idx];
+    idx += stride;
+  }
+}
+
+/**
+ * @brief Copy the segments of an array into another.
+ *
+ * @param in The array to copy from on the device.
+ * @param segments The source offset, destination offset and length of each
+ * segment, on the host.
+ * @param out The array to copy to on the device.
+ * @param ctx The device.
+ * @param stream The stream to operate on.
+ */
+template<typename DType>
+void CopySegments(
+    const DType * const in,
+    const std::vector<int64_t>& segments,
+    DType * const out,
+    DGLContext ctx,
+    cudaStream_t stream) {
+  const int64_t num_segments = segments.size()/3;
+  int64_t max_length = 0;
+  for (int64_t s = 0; s < num_segments; ++s) {
+    max_length = std::max(max_length, segments[3*s+2]);
+  }
+  if (max_length == 0) {
+    return;
+  }
+
+  auto device = DeviceAPI::Get(ctx);
+  Workspace<int64_t> segments_dev(device, ctx, segments.size());
+  device->CopyDataFromTo(
+      segments.data(),
+      0,
+      segments_dev.get(),
+      0,
+      segments.size()*sizeof(int64_t),
+      DGLContext{kDLCPU, 0},
+      ctx,
+      DGLType{kDLInt, 64, 1},
+      stream);
+
+  const dim3 block(256);
+  const dim3 grid(num_segments,
+      std::min<int64_t>((max_length+block.x-1)/block.x, 64));
+  _SegmentCopyKernel<<<grid, block, 0, stream>>>(
+      in, segments_dev.get(), out);
+  CUDA_CALL(cudaGetLastError());
+}
+
+/**
+ * @brief The number of rows exchanged with each rank, on the host.
+ */
+struct ExchangeSizes {
+  // the exclusive prefix sum of the rows sent to each rank
+  std::vector<int64_t> send_prefix;
+  // the exclusive prefix sum of the rows recieved from each rank
+  std::vector<int64_t> recv_prefix;
+  // in the hierarchical mode, the rows sent by each rank to each rank, as
+  // expected by NCCLCommunicator::HierarchicalAllToAllV()
+  std::vector<int64_t> counts;
+};
+
+/**
+ * @brief Communicate the number of rows each rank sends to each rank, and
+ * copy them to the host.
+ *
+ * @param comm The communicator.
+ * @param send_sum The number of rows to send to each rank on the device.
+ * @param ctx The device.
+ * @param stream The stream to operate on.
+ *
+ * @return The sizes of the exchange.
+ */
+ExchangeSizes ExchangeCounts(
+    NCCLCommunicatorRef comm,
+    const int64_t * const send_sum,
+    DGLContext ctx,
+    cudaStream_t stream) {
+  auto device = DeviceAPI::Get(ctx);
+  const int comm_size = comm->size();
+  const int rank = comm->rank();
+
+  ExchangeSizes sizes;
+  std::vector<int64_t> send_sum_host(comm_size);
+  std::vector<int64_t> recv_sum_host(comm_size);
+  if (comm->IsHierarchical()) {
+    // the hops through the other ranks of the node need all of the counts
+    Workspace<int64_t> counts(device, ctx, comm_size*comm_size);
+    comm->AllGather(send_sum, counts.get(), comm_size, stream);
+
+    sizes.counts.resize(comm_size*comm_size);
+    device->CopyDataFromTo(
+        counts.get(),
+        0,
+        sizes.counts.data(),
+        0,
+        sizes.counts.size()*sizeof(int64_t),
+        ctx,
+        DGLContext{kDLCPU, 0},
+        DGLType{kDLInt, 64, 1},
+        stream);
+    device->StreamSync(ctx, stream);
+
+    for (int r = 0; r < comm_size; ++r) {
+      send_sum_host[r] = sizes.counts[rank*comm_size+r];
+      recv_sum_host[r] = sizes.counts[r*comm_size+rank];
+    }
+  } else {
+    Workspace<int64_t> recv_sum(device, ctx, comm_size);
+    comm->AllToAll(send_sum, recv_sum.get(), 1, stream);
+
+    device->CopyDataFromTo(
+        send_sum,
+        0,
+        send_sum_host.data(),
+        0,
+        send_sum_host.size()*sizeof(int64_t),
+        ctx,
+        DGLContext{kDLCPU, 0},
+        DGLType{kDLInt, 64, 1},
+        stream);
+    device->CopyDataFromTo(
+        recv_sum.get(),
+        0,
+        recv_sum_host.data(),
+        0,
+        recv_sum_host.size()*sizeof(int64_t),
+        ctx,
+        DGLContext{kDLCPU, 0},
+        DGLType{kDLInt, 64, 1},
+        stream);
+    device->StreamSync(ctx, stream);
+  }
+
+  sizes.send_prefix.resize(comm_size+1, 0);
+  sizes.recv_prefix.resize(comm_size+1, 0);
+  for (int r = 0; r < comm_size; ++r) {
+    sizes.send_prefix[r+1] = sizes.send_prefix[r] + send_sum_host[r];
+    sizes.recv_prefix[r+1] = sizes.recv_prefix[r] + recv_sum_host[r];
+  }
+
+  return sizes;
+}
+
 
 template<typename IdType, typename DType>
 std::pair<IdArray, NDArray> SparsePush(
@@ -156,8 +317,7 @@ std::pair<IdArray, NDArray> SparsePush(
       "device";
   auto device = DeviceAPI::Get(ctx);
 
-  // TODO(dlasalle): Get the stream from the device context.
-  cudaStream_t stream = 0;
+  cudaStream_t stream = CUDAThreadEntry::ThreadLocal()->stream;
 
   CHECK_LE(in_idx->ndim, 1) << "The tensor of sending indices must be of "
       "dimension one (or empty).";
@@ -204,77 +364,16 @@ std::pair<IdArray, NDArray> SparsePush(
     CUDA_CALL(cudaGetLastError());
   }
 
-  // compute the prefix sum of the send values
-  Workspace<int64_t> send_prefix(device, ctx, comm_size+1);
-  {
-    size_t prefix_workspace_size;
-    CUDA_CALL(cub::DeviceScan::ExclusiveSum(nullptr, prefix_workspace_size,
-        send_sum, send_prefix.get(), comm_size+1, stream));
-
-    Workspace<void> prefix_workspace(device, ctx, prefix_workspace_size);
-    CUDA_CALL(cub::DeviceScan::ExclusiveSum(prefix_workspace.get(),
-        prefix_workspace_size, send_sum, send_prefix.get(),
-        comm_size+1, stream));
-  }
-
-  std::vector<int64_t> send_prefix_host(comm_size+1);
-  device->CopyDataFromTo(
-      send_prefix.get(),
-      0,
-      send_prefix_host.data(),
-      0,
-      send_prefix_host.size()*sizeof(*send_prefix.get()),
-      ctx,
-      DGLContext{kDLCPU, 0},
-      DGLType{kDLInt, sizeof(*send_prefix.get())*8, 1},
-      stream);
-  send_prefix.free();
+  // communicate the amount to send
+  const ExchangeSizes sizes = ExchangeCounts(comm, send_sum, ctx, stream);
+  const std::vector<int64_t>& send_prefix_host = sizes.send_prefix;
+  const std::vector<int64_t>& recv_prefix_host = sizes.recv_prefix;
 
   CHECK_EQ(send_prefix_host.back(), num_in) << "Internal Error: "
       "send_prefix_host.back() = " << send_prefix_host.back() <<
       ", and num_in = " << num_in;
 
-  // communicate the amount to send
-  Workspace<int64_t> recv_sum(device, ctx, comm_size+1);
-  comm->AllToAll(send_sum, recv_sum.get(), 1, stream);
-
-  cudaEvent_t d2h;
-  cudaEventCreate(&d2h);
-
-  // compute the prefix sum of the recv values
-  Workspace<int64_t> recv_prefix(device, ctx, comm_size+1);
-  {
-    size_t prefix_workspace_size;
-    CUDA_CALL(cub::DeviceScan::ExclusiveSum(nullptr, prefix_workspace_size,
-        recv_sum.get(), recv_prefix.get(), comm_size+1));
-
-    Workspace<void> prefix_workspace(device, ctx, prefix_workspace_size);
-    CUDA_CALL(cub::DeviceScan::ExclusiveSum(prefix_workspace.get(),
-        prefix_workspace_size, recv_sum.get(), recv_prefix.get(), comm_size+1));
-  }
-  recv_sum.free();
-
-  // finally copy the prefixsum sum down to the host
-  std::vector<int64_t> recv_prefix_host(comm_size+1);
-  device->CopyDataFromTo(
-      recv_prefix.get(),
-      0,
-      recv_prefix_host.data(),
-      0,
-      recv_prefix_host.size()*sizeof(*recv_prefix.get()),
-      ctx,
-      DGLContext{kDLCPU, 0},
-      DGLType{kDLInt, sizeof(*recv_prefix.get())*8, 1},
-      stream);
-  recv_prefix.free();
-
-  // use an event to track when copying is done
-  cudaEventRecord(d2h, stream);
-
   // allocate output space
-  cudaEventSynchronize(d2h);
-  cudaEventDestroy(d2h);
-
   IdArray recv_idx = aten::NewIdArray(
       recv_prefix_host.back(), ctx, sizeof(IdType)*8);
 
@@ -286,15 +385,32 @@ std::pair<IdArray, NDArray> SparsePush(
   NDArray recv_value = NDArray::Empty(value_shape, in_value->dtype, ctx);
 
   // send data
-  comm->SparseAllToAll(
-      send_idx.get(),
-      send_value.get(),
-      num_feat,
-      send_prefix_host.data(),
-      static_cast<IdType*>(recv_idx->data),
-      static_cast<DType*>(recv_value->data),
-      recv_prefix_host.data(),
-      stream);
+  if (comm->IsHierarchical()) {
+    comm->HierarchicalAllToAllV(
+        send_idx.get(),
+        sizes.counts.data(),
+        false,
+        1,
+        static_cast<IdType*>(recv_idx->data),
+        stream);
+    comm->HierarchicalAllToAllV(
+        send_value.get(),
+        sizes.counts.data(),
+        false,
+        num_feat,
+        static_cast<DType*>(recv_value->data),
+        stream);
+  } else {
+    comm->SparseAllToAll(
+        send_idx.get(),
+        send_value.get(),
+        num_feat,
+        send_prefix_host.data(),
+        static_cast<IdType*>(recv_idx->data),
+        static_cast<DType*>(recv_value->data),
+        recv_prefix_host.data(),
+        stream);
+  }
 
   return std::pair<IdArray, NDArray>(recv_idx, recv_value);
 }
@@ -355,86 +471,33 @@ NDArray SparsePull(
     CUDA_CALL(cudaGetLastError());
   }
 
-  // compute the prefix sum of the indexes this process is requesting
-  Workspace<int64_t> request_prefix(device, ctx, comm_size+1);
-  {
-    size_t prefix_workspace_size;
-    CUDA_CALL(cub::DeviceScan::ExclusiveSum(nullptr, prefix_workspace_size,
-        send_sum, request_prefix.get(), comm_size+1, stream));
-
-    Workspace<void> prefix_workspace(device, ctx, prefix_workspace_size);
-    CUDA_CALL(cub::DeviceScan::ExclusiveSum(prefix_workspace.get(),
-        prefix_workspace_size, send_sum, request_prefix.get(),
-        comm_size+1, stream));
-  }
-
-  cudaEvent_t d2h;
-  cudaEventCreate(&d2h);
-
-  std::vector<int64_t> request_prefix_host(comm_size+1);
-  device->CopyDataFromTo(
-      request_prefix.get(),
-      0,
-      request_prefix_host.data(),
-      0,
-      request_prefix_host.size()*sizeof(*request_prefix.get()),
-      ctx,
-      DGLContext{kDLCPU, 0},
-      DGLType{kDLInt, sizeof(*request_prefix.get())*8, 1},
-      stream);
-  request_prefix.free();
+  // communicate the amount requested
+  const ExchangeSizes sizes = ExchangeCounts(comm, send_sum, ctx, stream);
+  std::vector<int64_t> request_prefix_host = sizes.send_prefix;
+  std::vector<int64_t> response_prefix_host = sizes.recv_prefix;
   CHECK_EQ(request_prefix_host.back(), num_in) << "Internal Error: "
       "request_prefix_host.back() = " << request_prefix_host.back() <<
       ", num_in = " << num_in;
 
-  // communicate the amount requested
-  Workspace<int64_t> recv_sum(device, ctx, comm_size+1);
-  comm->AllToAll(send_sum, recv_sum.get(), 1, stream);
-
-  // compute the prefix sum of the requested indexes
-  Workspace<int64_t> response_prefix(device, ctx, comm_size+1);
-  {
-    size_t prefix_workspace_size;
-    CUDA_CALL(cub::DeviceScan::ExclusiveSum(nullptr, prefix_workspace_size,
-        recv_sum.get(), response_prefix.get(), comm_size+1, stream));
-
-    Workspace<void> prefix_workspace(device, ctx, prefix_workspace_size);
-    CUDA_CALL(cub::DeviceScan::ExclusiveSum(prefix_workspace.get(),
-        prefix_workspace_size, recv_sum.get(), response_prefix.get(),
-        comm_size+1, stream));
-  }
-  recv_sum.free();
-
-  // finally copy the prefixsum sum down to the host
-  std::vector<int64_t> response_prefix_host(comm_size+1);
-  device->CopyDataFromTo(
-      response_prefix.get(),
-      0,
-      response_prefix_host.data(),
-      0,
-      response_prefix_host.size()*sizeof(*response_prefix.get()),
-      ctx,
-      DGLContext{kDLCPU, 0},
-      DGLType{kDLInt, sizeof(*response_prefix.get())*8, 1},
-      stream);
-  response_prefix.free();
-
-  // use an event to track when copying is done
-  cudaEventRecord(d2h, stream);
-
-  // allocate output space
-  cudaEventSynchronize(d2h);
-  cudaEventDestroy(d2h);
-
   // gather requested indexes
   IdArray recv_idx = aten::NewIdArray(
       response_prefix_host.back(), ctx, sizeof(IdType)*8);
-  comm->AllToAllV(
-      send_idx.get(),
-      request_prefix_host.data(),
-      static_cast<IdType*>(recv_idx->data),
-      response_prefix_host.data(),
-      stream);
+  if (comm->IsHierarchical()) {
+    comm->HierarchicalAllToAllV(
+        send_idx.get(),
+        sizes.counts.data(),
+        false,
+        1,
+        static_cast<IdType*>(recv_idx->data),
+        stream);
+  } else {
+    comm->AllToAllV(
+        send_idx.get(),
+        request_prefix_host.data(),
+        static_cast<IdType*>(recv_idx->data),
+        response_prefix_host.data(),
+        stream);
+  }
   send_idx.free();
 
   // convert requested indices to local indices depending on partition
@@ -472,21 +535,32 @@ NDArray SparsePull(
   Workspace<DType> filled_request_value(device, ctx,
       request_prefix_host.back()*num_feat);
 
-  // multiply the prefixes by the number of features being sent
-  for (auto& v : request_prefix_host) {
-    v *= num_feat;
-  }
-  for (auto& v : response_prefix_host) {
-    v *= num_feat;
-  }
-
   // send the values
-  comm->AllToAllV(
-      filled_response_value.get(),
-      response_prefix_host.data(),
-      filled_request_value.get(),
-      request_prefix_host.data(),
-      stream);
+  if (comm->IsHierarchical()) {
+    // the responses go the opposite way of the requests
+    comm->HierarchicalAllToAllV(
+        filled_response_value.get(),
+        sizes.counts.data(),
+        true,
+        num_feat,
+        filled_request_value.get(),
+        stream);
+  } else {
+    // multiply the prefixes by the number of features being sent
+    for (auto& v : request_prefix_host) {
+      v *= num_feat;
+    }
+    for (auto& v : response_prefix_host) {
+      v *= num_feat;
+    }
+
+    comm->AllToAllV(
+        filled_response_value.get(),
+        response_prefix_host.data(),
+        filled_request_value.get(),
+        request_prefix_host.data(),
+        stream);
+  }
   filled_response_value.free();
 
   // finally, we need to permute the values back into the requested order
@@ -511,6 +585,273 @@ NDArray SparsePull(
   return result;
 }
 
+/**
+ * @brief The conversion of values to and from their type on the wire.
+ */
+template<typename DType, typename WireType>
+struct WireConvert {
+  static __device__ __forceinline__ WireType To(const DType val) {
+    return val;
+  }
+  static __device__ __forceinline__ DType From(const WireType val) {
+    return val;
+  }
+};
+
+template<typename DType>
+struct WireConvert<DType, __half> {
+  static __device__ __forceinline__ __half To(const DType val) {
+    return __float2half(static_cast<float>(val));
+  }
+  static __device__ __forceinline__ DType From(const __half val) {
+    return static_cast<DType>(__half2float(val));
+  }
+};
+
+template<typename IdType>
+__global__ void _PackRequestKernel(
+    const IdType * const in_idx,
+    const IdType * const perm,
+    const int64_t * const send_sum,
+    const int64_t * const send_prefix,
+    const int64_t capacity,
+    const int64_t num_slots,
+    IdType * const out_idx,
+    int64_t * const slot) {
+  const int64_t tidx = blockDim.x*static_cast<int64_t>(blockIdx.x)+threadIdx.x;
+  if (tidx < num_slots) {
+    const int64_t r = tidx / capacity;
+    const int64_t j = tidx % capacity;
+    if (j < send_sum[r]) {
+      const int64_t i = send_prefix[r] + j;
+      out_idx[tidx] = in_idx[perm[i]];
+      slot[i] = tidx;
+    }
+  }
+}
+
+template<typename IdType>
+__global__ void _PadRequestKernel(
+    const int64_t * const recv_sum,
+    const int64_t capacity,
+    const int64_t num_slots,
+    const IdType * const pad_idx,
+    IdType * const idx) {
+  const int64_t tidx = blockDim.x*static_cast<int64_t>(blockIdx.x)+threadIdx.x;
+  if (tidx < num_slots && tidx % capacity >= recv_sum[tidx / capacity]) {
+    idx[tidx] = *pad_idx;
+  }
+}
+
+template<typename IdType, typename DType, typename WireType>
+__global__ void _GatherResponseKernel(
+    const DType * const array,
+    const int64_t num_feat,
+    const IdType * const local_idx,
+    const int64_t * const recv_sum,
+    const int64_t capacity,
+    const int64_t num_slots,
+    WireType * const out) {
+  int64_t out_row = blockIdx.x*blockDim.y+threadIdx.y;
+  const int64_t stride = blockDim.y*gridDim.x;
+  while (out_row < num_slots) {
+    // the padding is not sent back to anyone
+    if (out_row % capacity < recv_sum[out_row / capacity]) {
+      const int64_t in_row = local_idx[out_row];
+      for (int64_t col = threadIdx.x; col < num_feat; col += blockDim.x) {
+        out[out_row*num_feat+col] =
+            WireConvert<DType, WireType>::To(array[in_row*num_feat+col]);
+      }
+    }
+    out_row += stride;
+  }
+}
+
+template<typename IdType, typename DType, typename WireType>
+__global__ void _UnpackResponseKernel(
+    const WireType * const in,
+    const int64_t num_feat,
+    const int64_t * const slot,
+    const IdType * const perm,
+    const int64_t length,
+    DType * const out) {
+  int64_t in_row = blockIdx.x*blockDim.y+threadIdx.y;
+  const int64_t stride = blockDim.y*gridDim.x;
+  while (in_row < length) {
+    const int64_t wire_row = slot[in_row];
+    const int64_t out_row = perm[in_row];
+    for (int64_t col = threadIdx.x; col < num_feat; col += blockDim.x) {
+      out[out_row*num_feat+col] =
+          WireConvert<DType, WireType>::From(in[wire_row*num_feat+col]);
+    }
+    in_row += stride;
+  }
+}
+
+/**
+ * @brief Pull the values of the requested indexes without synchronizing with
+ * the host, by exchanging requests and responses of a fixed capacity per pair
+ * of ranks, padded where fewer.
+ *
+ * @tparam IdType The type of index.
+ * @tparam DType The type of value.
+ * @tparam WireType The type of value for communicating, e.g., __half to send
+ * compressed values.
+ * @param comm The communicator.
+ * @param req_idx The indexes to request.
+ * @param local_tensor The values of the indexes this rank owns.
+ * @param part The partition of the indexes.
+ * @param capacity The maximum number of indexes any rank requests, the same
+ * on all ranks.
+ *
+ * @return The values requested.
+ */
+template<typename IdType, typename DType, typename WireType>
+NDArray SparsePullFixed(
+    NCCLCommunicatorRef comm,
+    IdArray req_idx,
+    NDArray local_tensor,
+    NDArrayPartitionRef part,
+    const int64_t capacity) {
+  const auto& ctx = req_idx->ctx;
+  CHECK_EQ(ctx, local_tensor->ctx) << "The request indices and set of local "
+      "values must be on the same device";
+  auto device = DeviceAPI::Get(ctx);
+
+  cudaStream_t stream = CUDAThreadEntry::ThreadLocal()->stream;
+
+  CHECK_LE(req_idx->ndim, 1) << "The tensor of requested indices must be of "
+      "dimension one (or empty).";
+  const int64_t num_in = req_idx->ndim > 0 ? req_idx->shape[0] : 0;
+  CHECK_GT(capacity, 0) << "The capacity (" << capacity << ") must be "
+      "positive.";
+  CHECK_LE(num_in, capacity) << "The number of requested indices (" <<
+      num_in << ") must not exceed the capacity (" << capacity << ").";
+  int64_t num_feat = 1;
+  for (int d = 1; d < local_tensor->ndim; ++d) {
+    num_feat *= local_tensor->shape[d];
+  }
+
+  const int64_t comm_size = comm->size();
+  const int64_t num_slots = comm_size*capacity;
+
+  std::vector<int64_t> value_shape(local_tensor->ndim, 0);
+  value_shape[0] = num_in;
+  for (int d = 1; d < local_tensor->ndim; ++d) {
+    value_shape[d] = local_tensor->shape[d];
+  }
+  NDArray result = NDArray::Empty(value_shape, local_tensor->dtype, ctx);
+
+  std::pair<IdArray, NDArray> part_perm = part->GeneratePermutation(req_idx);
+  const IdType * const perm = static_cast<const IdType*>(part_perm.first->data);
+  const int64_t * const send_sum =
+      static_cast<const int64_t*>(part_perm.second->data);
+
+  Workspace<int64_t> send_prefix(device, ctx, comm_size);
+  {
+    size_t prefix_workspace_size;
+    CUDA_CALL(cub::DeviceScan::ExclusiveSum(nullptr, prefix_workspace_size,
+        send_sum, send_prefix.get(), comm_size, stream));
+
+    Workspace<void> prefix_workspace(device, ctx, prefix_workspace_size);
+    CUDA_CALL(cub::DeviceScan::ExclusiveSum(prefix_workspace.get(),
+        prefix_workspace_size, send_sum, send_prefix.get(),
+        comm_size, stream));
+  }
+
+  // lay out the requests as a block of capacity indexes for each rank, and
+  // keep the slot of each request for its response
+  Workspace<IdType> send_idx(device, ctx, num_slots);
+  Workspace<int64_t> slot(device, ctx, std::max<int64_t>(num_in, 1));
+  {
+    const dim3 block(256);
+    const dim3 grid((num_slots+block.x-1)/block.x);
+
+    CUDA_KERNEL_CALL(_PackRequestKernel, grid, block, 0, stream,
+        static_cast<const IdType*>(req_idx->data),
+        perm,
+        send_sum,
+        send_prefix.get(),
+        capacity,
+        num_slots,
+        send_idx.get(),
+        slot.get());
+  }
+  send_prefix.free();
+
+  // communicate the amounts requested and the requests
+  Workspace<int64_t> recv_sum(device, ctx, comm_size);
+  comm->AllToAll(send_sum, recv_sum.get(), 1, stream);
+  IdArray recv_idx = aten::NewIdArray(num_slots, ctx, sizeof(IdType)*8);
+  comm->AllToAll(send_idx.get(), static_cast<IdType*>(recv_idx->data),
+      capacity, stream);
+  send_idx.free();
+
+  Workspace<WireType> filled_response_value(device, ctx, num_slots*num_feat);
+  if (part->PartSize(comm->rank()) > 0) {
+    // replace the padding by an index of this rank, for it to be mapped
+    IdArray pad_idx = part->MapToGlobal(
+        aten::Full(static_cast<IdType>(0), 1, ctx), comm->rank());
+    {
+      const dim3 block(256);
+      const dim3 grid((num_slots+block.x-1)/block.x);
+
+      CUDA_KERNEL_CALL(_PadRequestKernel, grid, block, 0, stream,
+          recv_sum.get(),
+          capacity,
+          num_slots,
+          static_cast<const IdType*>(pad_idx->data),
+          static_cast<IdType*>(recv_idx->data));
+    }
+    recv_idx = part->MapToLocal(recv_idx);
+
+    dim3 block(256, 1);
+    while (block.x >= 2*num_feat) {
+        block.x /= 2;
+        block.y *= 2;
+    }
+    const dim3 grid((num_slots+block.y-1)/block.y);
+
+    CUDA_KERNEL_CALL((_GatherResponseKernel<IdType, DType, WireType>),
+        grid, block, 0, stream,
+        static_cast<const DType*>(local_tensor->data),
+        num_feat,
+        static_cast<const IdType*>(recv_idx->data),
+        recv_sum.get(),
+        capacity,
+        num_slots,
+        filled_response_value.get());
+  }
+  recv_sum.free();
+
+  // send the values
+  Workspace<WireType> filled_request_value(device, ctx, num_slots*num_feat);
+  comm->AllToAll(filled_response_value.get(), filled_request_value.get(),
+      capacity*num_feat, stream);
+  filled_response_value.free();
+
+  // finally, permute the values back into the requested order
+  if (num_in > 0) {
+    dim3 block(256, 1);
+    while (block.x >= 2*num_feat) {
+        block.x /= 2;
+        block.y *= 2;
+    }
+    const dim3 grid((num_in+block.y-1)/block.y);
+
+    CUDA_KERNEL_CALL((_UnpackResponseKernel<IdType, DType, WireType>),
+        grid, block, 0, stream,
+        filled_request_value.get(),
+        num_feat,
+        slot.get(),
+        perm,
+        num_in,
+        static_cast<DType*>(result->data));
+  }
+
+  return result;
+}
+
 }  // namespace
 
 /* NCCLUniqueId **************************************************************/
@@ -563,7 +904,8 @@ NCCLCommunicator::NCCLCommunicator(
     ncclUniqueId id) :
   comm_(),
   size_(size),
-  rank_(rank) {
+  rank_(rank),
+  local_size_(1) {
   CHECK_LT(rank, size) << "The rank (" << rank << ") must be smaller than "
       "the size of the communicator (" << size << ").";
   CHECK_GE(rank, 0) << "The rank (" << rank << ") must be greater than or "
@@ -718,6 +1060,161 @@ void NCCLCommunicator::SparseAllToAll<int64_t, __half>(
       const int64_t * const recv_prefix,
       cudaStream_t stream);
 
+
+template<typename DType>
+void NCCLCommunicator::AllGather(
+    const DType * const send,
+    DType * const recv,
+    const int64_t count,
+    cudaStream_t stream) {
+  NCCL_CALL(ncclAllGather(send, recv, count, NCCLType<DType>(), comm_, stream));
+}
+
+template
+void NCCLCommunicator::AllGather<int64_t>(
+    const int64_t * const send,
+    int64_t * const recv,
+    const int64_t count,
+    cudaStream_t stream);
+
+
+template<typename DType>
+void NCCLCommunicator::HierarchicalAllToAllV(
+    const DType * const send,
+    const int64_t * const counts,
+    const bool transpose,
+    const int64_t num_feat,
+    DType * const recv,
+    cudaStream_t stream) {
+  CHECK(IsHierarchical()) << "The communicator is not hierarchical.";
+  const ncclDataType_t type = NCCLType<DType>();
+
+  const int num_local = local_size_;
+  const int num_nodes = size_ / local_size_;
+  const int node = rank_ / local_size_;
+  const int local_rank = rank_ % local_size_;
+
+  // the number of values the rank src sends to the rank dst
+  auto count = [=](const int src, const int dst) {
+    return (transpose ? counts[dst*size_+src] : counts[src*size_+dst])*num_feat;
+  };
+
+  int device_id;
+  CUDA_CALL(cudaGetDevice(&device_id));
+  const DGLContext ctx{kDLGPU, device_id};
+  auto device = DeviceAPI::Get(ctx);
+
+  // The values to send are ordered by destination node, then by local rank.
+  // Reorder them by local rank, into a block for each rank of this node, of
+  // the values for the ranks of its local rank, ordered by node.
+  std::vector<int64_t> send_offset(size_+1, 0);
+  for (int r = 0; r < size_; ++r) {
+    send_offset[r+1] = send_offset[r] + count(rank_, r);
+  }
+  std::vector<int64_t> segments;
+  std::vector<int64_t> send_block_prefix(num_local+1, 0);
+  for (int l = 0; l < num_local; ++l) {
+    int64_t offset = send_block_prefix[l];
+    for (int n = 0; n < num_nodes; ++n) {
+      const int dst = n*num_local+l;
+      segments.insert(segments.end(),
+          {send_offset[dst], offset, count(rank_, dst)});
+      offset += count(rank_, dst);
+    }
+    send_block_prefix[l+1] = offset;
+  }
+  Workspace<DType> send_blocks(device, ctx,
+      std::max<int64_t>(send_block_prefix.back(), 1));
+  CopySegments(send, segments, send_blocks.get(), ctx, stream);
+
+  // the block from each rank of this node, ordered by node
+  std::vector<int64_t> recv_block_prefix(num_local+1, 0);
+  for (int l = 0; l < num_local; ++l) {
+    recv_block_prefix[l+1] = recv_block_prefix[l];
+    for (int n = 0; n < num_nodes; ++n) {
+      recv_block_prefix[l+1] += count(node*num_local+l, n*num_local+local_rank);
+    }
+  }
+  Workspace<DType> recv_blocks(device, ctx,
+      std::max<int64_t>(recv_block_prefix.back(), 1));
+
+  // first hop, within the node
+  NCCL_CALL(ncclGroupStart());
+  for (int l = 0; l < num_local; ++l) {
+    const int peer = node*num_local+l;
+    const int64_t send_size = send_block_prefix[l+1]-send_block_prefix[l];
+    if (send_size > 0) {
+      NCCL_CALL(ncclSend(send_blocks.get()+send_block_prefix[l], send_size,
+                         type, peer, comm_, stream));
+    }
+    const int64_t recv_size = recv_block_prefix[l+1]-recv_block_prefix[l];
+    if (recv_size > 0) {
+      NCCL_CALL(ncclRecv(recv_blocks.get()+recv_block_prefix[l], recv_size,
+                         type, peer, comm_, stream));
+    }
+  }
+  NCCL_CALL(ncclGroupEnd());
+  send_blocks.free();
+
+  // Reorder the recieved values by destination node, into a message for each
+  // node, of the values from the ranks of this node ordered by local rank.
+  segments.clear();
+  std::vector<int64_t> block_offset(recv_block_prefix.begin(),
+                                    recv_block_prefix.end()-1);
+  std::vector<int64_t> message_prefix(num_nodes+1, 0);
+  for (int n = 0; n < num_nodes; ++n) {
+    int64_t offset = message_prefix[n];
+    for (int l = 0; l < num_local; ++l) {
+      const int64_t length = count(node*num_local+l, n*num_local+local_rank);
+      segments.insert(segments.end(), {block_offset[l], offset, length});
+      block_offset[l] += length;
+      offset += length;
+    }
+    message_prefix[n+1] = offset;
+  }
+  Workspace<DType> messages(device, ctx,
+      std::max<int64_t>(message_prefix.back(), 1));
+  CopySegments(recv_blocks.get(), segments, messages.get(), ctx, stream);
+  recv_blocks.free();
+
+  // The message from each node holds the values from its ranks, in order, so
+  // it lands directly where they go.
+  std::vector<int64_t> recv_offset(size_+1, 0);
+  for (int r = 0; r < size_; ++r) {
+    recv_offset[r+1] = recv_offset[r] + count(r, rank_);
+  }
+
+  // second hop, to the rank of the same local rank on each node
+  NCCL_CALL(ncclGroupStart());
+  for (int n = 0; n < num_nodes; ++n) {
+    const int peer = n*num_local+local_rank;
+    const int64_t send_size = message_prefix[n+1]-message_prefix[n];
+    if (send_size > 0) {
+      NCCL_CALL(ncclSend(messages.get()+message_prefix[n], send_size,
+                         type, peer, comm_, stream));
+    }
+    const int64_t recv_size =
+        recv_offset[(n+1)*num_local]-recv_offset[n*num_local];
+    if (recv_size > 0) {
+      NCCL_CALL(ncclRecv(recv+recv_offset[n*num_local], recv_size,
+                         type, peer, comm_, stream));
+    }
+  }
+  NCCL_CALL(ncclGroupEnd());
+}
+
+void NCCLCommunicator::SetLocalSize(
+    const int local_size) {
+  CHECK_GE(local_size, 0) << "The local size (" << local_size << ") must be "
+      "non-negative.";
+  if (local_size > 1) {
+    CHECK_EQ(size_ % local_size, 0) << "The size of the communicator (" <<
+        size_ << ") must be a multiple of the local size (" << local_size <<
+        ").";
+  }
+  local_size_ = std::max(local_size, 1);
+}
+
 int NCCLCommunicator::size() const {
   return size_;
 }
@@ -726,6 +1223,15 @@ int NCCLCommunicator::rank() const {
   return rank_;
 }
 
+int NCCLCommunicator::local_size() const {
+  return local_size_;
+}
+
+bool NCCLCommunicator::IsHierarchical() const {
+  // all on one node, or one rank per node, is just as well flat
+  return local_size_ > 1 && local_size_ < size_;
+}
+
 
 /* CAPI **********************************************************************/
 
@@ -759,6 +1265,14 @@ DGL_REGISTER_GLOBAL("cuda.nccl._CAPI_DGLNCCLCreateComm")
         idObj->Get()));
 });
 
+DGL_REGISTER_GLOBAL("cuda.nccl._CAPI_DGLNCCLSetLocalSize")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+  NCCLCommunicatorRef comm = args[0];
+  const int local_size = args[1];
+
+  comm->SetLocalSize(local_size);
+});
+
 DGL_REGISTER_GLOBAL("cuda.nccl._CAPI_DGLNCCLSparseAllToAllPush")
 .set_body([] (DGLArgs args, DGLRetValue* rv) {
   NCCLCommunicatorRef comm = args[0];
@@ -795,6 +1309,32 @@ DGL_REGISTER_GLOBAL("cuda.nccl._CAPI_DGLNCCLSparseAllToAllPull")
   });
 });
 
+DGL_REGISTER_GLOBAL("cuda.nccl._CAPI_DGLNCCLSparseAllToAllPullFixed")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+  NCCLCommunicatorRef comm = args[0];
+  IdArray req_idx = args[1];
+  NDArray tensor = args[2];
+  NDArrayPartitionRef part = args[3];
+  // the maximum number of indexes requested by any process
+  const int64_t capacity = args[4];
+  // whether to send the values as float16
+  const bool compress = args[5];
+
+  ATEN_ID_TYPE_SWITCH(req_idx->dtype, IdType, {
+    if (compress) {
+      ATEN_FLOAT_TYPE_SWITCH(tensor->dtype, DType, "values", {
+        *rv = SparsePullFixed<IdType, DType, __half>(comm, req_idx, tensor,
+            part, capacity);
+      });
+    } else {
+      ATEN_DTYPE_SWITCH(tensor->dtype, DType, "values", {
+        *rv = SparsePullFixed<IdType, DType, DType>(comm, req_idx, tensor,
+            part, capacity);
+      });
+    }
+  });
+});
+
 
 }  // namespace cuda
 }  // namespace runtime
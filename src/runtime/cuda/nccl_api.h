@@ -114,10 +114,73 @@ class NCCLCommunicator : public runtime::Object {
           const int64_t * recv_prefix,
           cudaStream_t stream);
 
+  /**
+   * @brief Perform an all-gather communication.
+   *
+   * @param send The continous array of data to send.
+   * @param recv The continous array of data to recieve, of count elements
+   * from each rank, in the order of the ranks.
+   * @param count The size of data each rank sends.
+   * @param stream The stream to operate on.
+   */
+  template<typename DType>
+  void AllGather(
+      const DType * send,
+      DType * recv,
+      int64_t count,
+      cudaStream_t stream);
+
+  /**
+   * @brief Perform an all-to-all variable sized communication in two hops,
+   * for the hierarchical mode. The rows for the ranks of the same local rank
+   * on the other nodes are first gathered by that local rank on this node,
+   * over the intra-node links, which then sends the rows of the whole node to
+   * each of them in one message. The data sent and recieved is laid out as
+   * with `AllToAllV()`.
+   *
+   * @tparam DType The type of value to send.
+   * @param send The array of rows to send, ordered by destination rank.
+   * @param counts The number of rows each rank sends to each rank, as a
+   * row-major matrix of size*size elements on the host, with the rows of
+   * counts[src*size+dst] sent from src to dst.
+   * @param transpose Whether to send by the transposed matrix instead, i.e.,
+   * the rows of counts[dst*size+src] from src to dst, to respond to a request.
+   * @param num_feat The number of values per row.
+   * @param recv The array of rows to recieve, ordered by source rank.
+   * @param stream The stream to operate on.
+   */
+  template<typename DType>
+  void HierarchicalAllToAllV(
+      const DType * send,
+      const int64_t * counts,
+      bool transpose,
+      int64_t num_feat,
+      DType * recv,
+      cudaStream_t stream);
+
+  /**
+   * @brief Set the number of ranks on each node, enabling the hierarchical
+   * mode of `SparsePush()` and `SparsePull()` if greater than one. The ranks
+   * must be numbered node by node, i.e., the rank `node*local_size+i` is the
+   * local rank `i` of its node.
+   *
+   * @param local_size The number of ranks per node.
+   */
+  void SetLocalSize(int local_size);
+
   int size() const;
 
   int rank() const;
 
+  int local_size() const;
+
+  /**
+   * @brief Check whether the exchanges go through the intra-node links first.
+   *
+   * @return True if the communicator spans several nodes of several ranks.
+   */
+  bool IsHierarchical() const;
+
   static constexpr const char* _type_key = "cuda.NCCLCommunicator";
   DGL_DECLARE_OBJECT_TYPE_INFO(NCCLCommunicator, Object);
 
@@ -125,6 +188,7 @@ class NCCLCommunicator : public runtime::Object {
   ncclComm_t comm_;
   int size_;
   int rank_;
+  int local_size_;
 };
 
 DGL_DEFINE_OBJECT_REF(NCCLCommunicatorRef, NCCLCommunicator);
@@ -0,0 +1,144 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file runtime/huge_page.cc
+ * \brief Huge page backed CPU memory.
+ */
+#include <dgl/runtime/huge_page.h>
+#include <dmlc/logging.h>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace dgl {
+namespace runtime {
+namespace huge_page {
+
+namespace {
+
+#if defined(__linux__)
+/*! \brief The page size flags of mmap(2), see linux/mman.h. */
+constexpr int kMapHugeShift = 26;
+constexpr int kMapHuge2MB = 21 << kMapHugeShift;
+constexpr int kMapHuge1GB = 30 << kMapHugeShift;
+#endif
+
+/*! \brief The sizes of the buffers allocated by Alloc, needed by munmap. */
+struct HugeAllocations {
+  std::mutex mutex;
+  std::unordered_map<void*, size_t> sizes;
+};
+
+HugeAllocations* GetHugeAllocations() {
+  // never destroyed, since arrays may be freed by static destructors
+  static HugeAllocations* allocations = new HugeAllocations();
+  return allocations;
+}
+
+size_t HugePageBytes(Mode mode) {
+  return mode == Mode::k1GB ? (size_t(1) << 30) : (size_t(2) << 20);
+}
+
+}  // namespace
+
+Mode ParseMode(const std::string& value) {
+  if (value == "thp")
+    return Mode::kTransparent;
+  if (value == "2MB")
+    return Mode::k2MB;
+  if (value == "1GB")
+    return Mode::k1GB;
+  return Mode::kNone;
+}
+
+Mode GetMode() {
+  static const Mode mode = []() -> Mode {
+    const char* var = std::getenv("DGL_CPU_HUGE_PAGES");
+    if (!var || !*var || std::string(var) == "0")
+      return Mode::kNone;
+    const Mode ret = ParseMode(var);
+    if (ret == Mode::kNone)
+      LOG(WARNING) << "Invalid DGL_CPU_HUGE_PAGES " << var
+                   << ", expected thp, 2MB or 1GB; huge pages are disabled";
+    return ret;
+  }();
+  return mode;
+}
+
+std::string HugetlbfsDir() {
+  const char* var = std::getenv("DGL_HUGETLBFS_DIR");
+  return var && *var ? var : "/dev/hugepages";
+}
+
+void* Alloc(size_t size) {
+  const Mode mode = GetMode();
+  if ((mode != Mode::k2MB && mode != Mode::k1GB) || size < kMinBytes)
+    return nullptr;
+#if defined(__linux__) && defined(MAP_HUGETLB)
+  const size_t page_bytes = HugePageBytes(mode);
+  const size_t mapped = (size + page_bytes - 1) / page_bytes * page_bytes;
+  const int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB |
+    (mode == Mode::k1GB ? kMapHuge1GB : kMapHuge2MB);
+  void* ptr = mmap(nullptr, mapped, PROT_READ | PROT_WRITE, flags, -1, 0);
+  if (ptr == MAP_FAILED) {
+    static std::once_flag warned;
+    std::call_once(warned, [] {
+      LOG(WARNING) << "Failed to allocate huge pages, falling back to regular pages: "
+                   << std::strerror(errno);
+    });
+    return nullptr;
+  }
+  HugeAllocations* allocations = GetHugeAllocations();
+  std::lock_guard<std::mutex> lock(allocations->mutex);
+  allocations->sizes[ptr] = mapped;
+  return ptr;
+#else
+  return nullptr;
+#endif
+}
+
+bool Free(void* ptr) {
+  const Mode mode = GetMode();
+  if (mode != Mode::k2MB && mode != Mode::k1GB)
+    return false;
+#if defined(__linux__)
+  size_t mapped;
+  {
+    HugeAllocations* allocations = GetHugeAllocations();
+    std::lock_guard<std::mutex> lock(allocations->mutex);
+    auto it = allocations->sizes.find(ptr);
+    if (it == allocations->sizes.end())
+      return false;
+    mapped = it->second;
+    allocations->sizes.erase(it);
+  }
+  CHECK_EQ(munmap(ptr, mapped), 0) << std::strerror(errno);
+  return true;
+#else
+  return false;
+#endif
+}
+
+void Advise(void* ptr, size_t size) {
+  if (GetMode() != Mode::kTransparent || size < kMinBytes)
+    return;
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  // only the huge pages entirely inside the range can be advised
+  const uintptr_t page_bytes = HugePageBytes(Mode::k2MB);
+  const uintptr_t start =
+    (reinterpret_cast<uintptr_t>(ptr) + page_bytes - 1) & ~(page_bytes - 1);
+  const uintptr_t end = (reinterpret_cast<uintptr_t>(ptr) + size) & ~(page_bytes - 1);
+  if (start < end)
+    madvise(reinterpret_cast<void*>(start), end - start, MADV_HUGEPAGE);
+#endif
+}
+
+}  // namespace huge_page
+}  // namespace runtime
+}  // namespace dgl
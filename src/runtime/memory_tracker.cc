@@ -0,0 +1,183 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file runtime/memory_tracker.cc
+ * \brief Accounting of the memory held and copied by DGL.
+ */
+#include <dgl/runtime/memory_tracker.h>
+#include <dgl/runtime/ndarray.h>
+#include <dgl/runtime/registry.h>
+#include <dmlc/logging.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace dgl {
+namespace runtime {
+
+namespace {
+
+thread_local MemoryTag current_tag = MemoryTag::kOther;
+
+/*! \return The index of the device among the counters, -1 if not counted. */
+int DeviceIndex(DLContext ctx) {
+  if (ctx.device_type != kDLGPU)
+    return 0;
+  return ctx.device_id >= 0 && ctx.device_id < MemoryTracker::kMaxGPUs ?
+    ctx.device_id + 1 : -1;
+}
+
+int CopyKind(DLContext ctx) {
+  return ctx.device_type == kDLGPU ? 1 : 0;
+}
+
+}  // namespace
+
+constexpr int MemoryTracker::kNumTags;
+constexpr int MemoryTracker::kMaxGPUs;
+constexpr int MemoryTracker::kNumDevices;
+constexpr int MemoryTracker::kNumCopyKinds;
+constexpr int MemoryTracker::kNumFormats;
+
+MemoryTagScope::MemoryTagScope(MemoryTag tag) : prev_(current_tag) {
+  current_tag = tag;
+}
+
+MemoryTagScope::~MemoryTagScope() {
+  current_tag = prev_;
+}
+
+MemoryTag MemoryTagScope::Current() {
+  return current_tag;
+}
+
+void MemoryTracker::Counter::Add(int64_t nbytes) {
+  const int64_t in_use = bytes += nbytes;
+  int64_t peak = peak_bytes.load(std::memory_order_relaxed);
+  while (in_use > peak && !peak_bytes.compare_exchange_weak(peak, in_use)) {}
+  ++num_allocs;
+}
+
+void MemoryTracker::Counter::Reset() {
+  peak_bytes = bytes.load();
+  num_allocs = 0;
+}
+
+MemoryTracker::Usage MemoryTracker::Counter::Get() const {
+  return Usage{bytes.load(), peak_bytes.load(), num_allocs.load()};
+}
+
+MemoryTracker::MemoryTracker() {
+  Reset();
+  const char* var = std::getenv("DGL_MEMORY_TRACKING");
+  enabled_ = var && std::strcmp(var, "1") == 0;
+}
+
+MemoryTracker* MemoryTracker::Global() {
+  // never destroyed, since arrays may be freed in static destructors
+  static MemoryTracker* tracker = new MemoryTracker();
+  return tracker;
+}
+
+bool MemoryTracker::OnAlloc(DLContext ctx, int64_t nbytes, MemoryTag tag) {
+  if (!Enabled())
+    return false;
+  const int device = DeviceIndex(ctx);
+  if (device < 0)
+    return false;
+  devices_[device].Add(nbytes);
+  tags_[static_cast<int>(tag)].Add(nbytes);
+  return true;
+}
+
+void MemoryTracker::OnFree(DLContext ctx, int64_t nbytes, MemoryTag tag) {
+  devices_[DeviceIndex(ctx)].bytes -= nbytes;
+  tags_[static_cast<int>(tag)].bytes -= nbytes;
+}
+
+void MemoryTracker::OnCopy(DLContext from, DLContext to, int64_t nbytes) {
+  if (!Enabled())
+    return;
+  copy_bytes_[CopyKind(from)][CopyKind(to)] += nbytes;
+  ++num_copies_[CopyKind(from)][CopyKind(to)];
+}
+
+void MemoryTracker::OnConversion(int from, int to) {
+  CHECK(from >= 0 && from < kNumFormats && to >= 0 && to < kNumFormats)
+    << "Invalid sparse formats " << from << " and " << to << ".";
+  if (Enabled())
+    ++num_conversions_[from][to];
+}
+
+MemoryTracker::Snapshot MemoryTracker::GetSnapshot() const {
+  Snapshot snapshot;
+  snapshot.enabled = Enabled();
+  for (int i = 0; i < kNumDevices; ++i)
+    snapshot.devices[i] = devices_[i].Get();
+  for (int i = 0; i < kNumTags; ++i)
+    snapshot.tags[i] = tags_[i].Get();
+  for (int i = 0; i < kNumCopyKinds; ++i) {
+    for (int j = 0; j < kNumCopyKinds; ++j) {
+      snapshot.copy_bytes[i][j] = copy_bytes_[i][j].load();
+      snapshot.num_copies[i][j] = num_copies_[i][j].load();
+    }
+  }
+  for (int i = 0; i < kNumFormats; ++i) {
+    for (int j = 0; j < kNumFormats; ++j)
+      snapshot.num_conversions[i][j] = num_conversions_[i][j].load();
+  }
+  return snapshot;
+}
+
+void MemoryTracker::Reset() {
+  for (Counter& counter : devices_)
+    counter.Reset();
+  for (Counter& counter : tags_)
+    counter.Reset();
+  for (int i = 0; i < kNumCopyKinds; ++i) {
+    for (int j = 0; j < kNumCopyKinds; ++j) {
+      copy_bytes_[i][j] = 0;
+      num_copies_[i][j] = 0;
+    }
+  }
+  for (int i = 0; i < kNumFormats; ++i) {
+    for (int j = 0; j < kNumFormats; ++j)
+      num_conversions_[i][j] = 0;
+  }
+}
+
+DGL_REGISTER_GLOBAL("utils.internal._CAPI_DGLMemoryTrackerSetEnabled")
+.set_body([](DGLArgs args, DGLRetValue* rv) {
+    const bool enabled = args[0];
+    MemoryTracker::Global()->SetEnabled(enabled);
+  });
+
+DGL_REGISTER_GLOBAL("utils.internal._CAPI_DGLMemoryTrackerReset")
+.set_body([](DGLArgs args, DGLRetValue* rv) {
+    MemoryTracker::Global()->Reset();
+  });
+
+/*!
+ * \brief The counters of the tracker, flattened: whether it is enabled, the
+ *        usages of the devices then of the tags, the bytes then the numbers of
+ *        copies, and the numbers of conversions, in the order of Snapshot.
+ */
+DGL_REGISTER_GLOBAL("utils.internal._CAPI_DGLMemoryTrackerStats")
+.set_body([](DGLArgs args, DGLRetValue* rv) {
+    const MemoryTracker::Snapshot snapshot = MemoryTracker::Global()->GetSnapshot();
+    std::vector<int64_t> ret = {snapshot.enabled};
+    for (const auto& usage : snapshot.devices)
+      ret.insert(ret.end(), {usage.bytes, usage.peak_bytes, usage.num_allocs});
+    for (const auto& usage : snapshot.tags)
+      ret.insert(ret.end(), {usage.bytes, usage.peak_bytes, usage.num_allocs});
+    for (const auto& row : snapshot.copy_bytes)
+      ret.insert(ret.end(), std::begin(row), std::end(row));
+    for (const auto& row : snapshot.num_copies)
+      ret.insert(ret.end(), std::begin(row), std::end(row));
+    for (const auto& row : snapshot.num_conversions)
+      ret.insert(ret.end(), std::begin(row), std::end(row));
+    *rv = NDArray::FromVector(ret);
+  });
+
+}  // namespace runtime
+}  // namespace dgl
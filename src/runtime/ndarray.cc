@@ -8,6 +8,7 @@
 #include <dgl/runtime/ndarray.h>
 #include <dgl/runtime/c_runtime_api.h>
 #include <dgl/runtime/device_api.h>
+#include <dgl/runtime/memory_tracker.h>
 #include <dgl/runtime/shared_mem.h>
 #include <dgl/zerocopy_serializer.h>
 #include <dgl/runtime/tensordispatch.h>
@@ -56,6 +57,8 @@ struct NDArray::Internal {
   // Default deleter for the container
   static void DefaultDeleter(NDArray::Container* ptr) {
     using dgl::runtime::NDArray;
+    UnpinInPlace(ptr);
+    Untrack(ptr);
     if (ptr->manager_ctx != nullptr) {
       static_cast<NDArray::Container*>(ptr->manager_ctx)->DecRef();
 #ifndef _WIN32
@@ -74,12 +77,46 @@ struct NDArray::Internal {
   // This enables us to create NDArray from memory allocated by other
   // frameworks that are DLPack compatible
   static void DLPackDeleter(NDArray::Container* ptr) {
+    UnpinInPlace(ptr);
+    Untrack(ptr);
     DLManagedTensor* tensor = static_cast<DLManagedTensor*>(ptr->manager_ctx);
     if (tensor->deleter != nullptr) {
       (*tensor->deleter)(tensor);
     }
     delete ptr;
   }
+  // Deleter for NDArray in the page-locked memory allocated by PinnedEmpty
+  static void PinnedDeleter(NDArray::Container* ptr) {
+    Untrack(ptr);
+    if (ptr->dl_tensor.data != nullptr) {
+      DeviceAPI::Get(ptr->pinned_ctx_)->FreePinnedDataSpace(
+          ptr->pinned_ctx_, ptr->dl_tensor.data);
+    }
+    delete ptr;
+  }
+  // Unpin the memory pinned by PinMemory_, which may outlive the container
+  // (e.g. of a DLPack tensor)
+  static void UnpinInPlace(NDArray::Container* ptr) {
+    if (ptr->pinned_by_dgl_) {
+      DeviceAPI::Get(ptr->pinned_ctx_)->UnpinData(
+          ptr->pinned_ctx_, ptr->dl_tensor.data);
+      ptr->pinned_by_dgl_ = false;
+    }
+  }
+  // Count the data allocated for the container, with the tag of the thread
+  static void Track(NDArray::Container* ptr) {
+    const size_t size = GetDataSize(ptr->dl_tensor);
+    const MemoryTag tag = MemoryTagScope::Current();
+    if (size > 0 && MemoryTracker::Global()->OnAlloc(ptr->dl_tensor.ctx, size, tag))
+      ptr->tracked_tag_ = static_cast<int8_t>(tag);
+  }
+  static void Untrack(NDArray::Container* ptr) {
+    if (ptr->tracked_tag_ >= 0) {
+      MemoryTracker::Global()->OnFree(ptr->dl_tensor.ctx, GetDataSize(ptr->dl_tensor),
+                                      static_cast<MemoryTag>(ptr->tracked_tag_));
+      ptr->tracked_tag_ = -1;
+    }
+  }
   // Local create function which allocates tensor metadata
   // but does not allocate space for the data.
   static NDArray Create(std::vector<int64_t> shape,
@@ -210,20 +247,67 @@ NDArray NDArray::Empty(std::vector<int64_t> shape,
                        DLDataType dtype,
                        DLContext ctx) {
   TensorDispatcher* td = TensorDispatcher::Global();
-  if (td->IsAvailable())
-    return td->Empty(shape, dtype, ctx);
+  if (td->IsAvailable()) {
+    NDArray ret = td->Empty(shape, dtype, ctx);
+    Internal::Track(ret.data_);
+    return ret;
+  }
 
   NDArray ret = Internal::Create(shape, dtype, ctx);
   // setup memory content
   size_t size = GetDataSize(ret.data_->dl_tensor);
   size_t alignment = GetDataAlignment(ret.data_->dl_tensor);
-  if (size > 0)
+  if (size > 0) {
     ret.data_->dl_tensor.data =
         DeviceAPI::Get(ret->ctx)->AllocDataSpace(
             ret->ctx, size, alignment, ret->dtype);
+    Internal::Track(ret.data_);
+  }
   return ret;
 }
 
+NDArray NDArray::PinnedEmpty(std::vector<int64_t> shape,
+                             DLDataType dtype,
+                             DLContext ctx) {
+  CHECK_EQ(ctx.device_type, kDLGPU) << "Memory can only be pinned for a GPU.";
+  NDArray ret = Internal::Create(shape, dtype, DLContext{kDLCPU, 0});
+  ret.data_->deleter = Internal::PinnedDeleter;
+  ret.data_->pinned_ctx_ = ctx;
+  size_t size = GetDataSize(ret.data_->dl_tensor);
+  if (size > 0) {
+    ret.data_->dl_tensor.data = DeviceAPI::Get(ctx)->AllocPinnedDataSpace(ctx, size);
+    Internal::Track(ret.data_);
+  }
+  return ret;
+}
+
+void NDArray::PinMemory_(DLContext ctx) {
+  CHECK_EQ(data_->dl_tensor.ctx.device_type, kDLCPU)
+    << "Only the arrays on the CPU can be pinned.";
+  CHECK_EQ(ctx.device_type, kDLGPU) << "Memory can only be pinned for a GPU.";
+  if (IsPinned() || GetSize() == 0)
+    return;
+  DeviceAPI::Get(ctx)->PinData(ctx, data_->dl_tensor.data, GetSize());
+  data_->pinned_by_dgl_ = true;
+  data_->pinned_ctx_ = ctx;
+}
+
+void NDArray::UnpinMemory_() {
+  Internal::UnpinInPlace(data_);
+}
+
+bool NDArray::IsPinned() const {
+  if (data_->dl_tensor.ctx.device_type != kDLCPU)
+    return false;
+  if (data_->pinned_by_dgl_ || data_->deleter == Internal::PinnedDeleter)
+    return true;
+  // e.g. pinned by the framework
+  const DLContext gpu_ctx{kDLGPU, 0};
+  DeviceAPI* device = DeviceAPI::Get(gpu_ctx, true);
+  return device && data_->dl_tensor.data &&
+    device->IsPinned(gpu_ctx, data_->dl_tensor.data);
+}
+
 NDArray NDArray::FromDLPack(DLManagedTensor* tensor) {
   NDArray::Container* data = new NDArray::Container();
   data->deleter = Internal::DLPackDeleter;
@@ -249,10 +333,18 @@ void NDArray::CopyFromTo(DLTensor* from,
   // api manager.
   DGLContext ctx = from->ctx.device_type != kDLCPU ? from->ctx : to->ctx;
 
-  DeviceAPI::Get(ctx)->CopyDataFromTo(
+  DeviceAPI* device = DeviceAPI::Get(ctx);
+  // Without an explicit stream the copy follows the stream of the calling
+  // thread, and the copies to the host remain synchronous.
+  const bool sync = !stream && to->ctx.device_type == kDLCPU;
+  if (!stream)
+    stream = device->GetStream();
+  device->CopyDataFromTo(
     from->data, static_cast<size_t>(from->byte_offset),
     to->data, static_cast<size_t>(to->byte_offset),
     from_size, from->ctx, to->ctx, from->dtype, stream);
+  if (sync && stream)
+    device->StreamSync(ctx, stream);
 }
 
 template<typename T>
@@ -260,7 +352,8 @@ NDArray NDArray::FromVector(const std::vector<T>& vec, DLContext ctx) {
   const DLDataType dtype = DLDataTypeTraits<T>::dtype;
   int64_t size = static_cast<int64_t>(vec.size());
   NDArray ret = NDArray::Empty({size}, dtype, ctx);
-  DeviceAPI::Get(ctx)->CopyDataFromTo(
+  DeviceAPI* device = DeviceAPI::Get(ctx);
+  device->CopyDataFromTo(
       vec.data(),
       0,
       static_cast<T*>(ret->data),
@@ -269,7 +362,7 @@ NDArray NDArray::FromVector(const std::vector<T>& vec, DLContext ctx) {
       DLContext{kDLCPU, 0},
       ctx,
       dtype,
-      nullptr);
+      device->GetStream());
   return ret;
 }
 
@@ -290,7 +383,9 @@ std::vector<T> NDArray::ToVector() const {
   int64_t size = data_->dl_tensor.shape[0];
   std::vector<T> vec(size);
   const DLContext &ctx = data_->dl_tensor.ctx;
-  DeviceAPI::Get(ctx)->CopyDataFromTo(
+  DeviceAPI* device = DeviceAPI::Get(ctx);
+  DGLStreamHandle stream = device->GetStream();
+  device->CopyDataFromTo(
       static_cast<T*>(data_->dl_tensor.data),
       0,
       vec.data(),
@@ -299,7 +394,9 @@ std::vector<T> NDArray::ToVector() const {
       ctx,
       DLContext{kDLCPU, 0},
       dtype,
-      nullptr);
+      stream);
+  if (stream)
+    device->StreamSync(ctx, stream);
   return vec;
 }
 
@@ -487,10 +584,11 @@ int DGLArrayCopyFromBytes(DGLArrayHandle handle,
   size_t arr_size = GetDataSize(*handle);
   CHECK_EQ(arr_size, nbytes)
       << "DGLArrayCopyFromBytes: size mismatch";
-  DeviceAPI::Get(handle->ctx)->CopyDataFromTo(
+  DeviceAPI* device = DeviceAPI::Get(handle->ctx);
+  device->CopyDataFromTo(
       data, 0,
       handle->data, static_cast<size_t>(handle->byte_offset),
-      nbytes, cpu_ctx, handle->ctx, handle->dtype, nullptr);
+      nbytes, cpu_ctx, handle->ctx, handle->dtype, device->GetStream());
   API_END();
 }
 
@@ -504,19 +602,21 @@ int DGLArrayCopyToBytes(DGLArrayHandle handle,
   size_t arr_size = GetDataSize(*handle);
   CHECK_EQ(arr_size, nbytes)
       << "DGLArrayCopyToBytes: size mismatch";
-  DeviceAPI::Get(handle->ctx)->CopyDataFromTo(
+  DeviceAPI* device = DeviceAPI::Get(handle->ctx);
+  DGLStreamHandle stream = device->GetStream();
+  device->CopyDataFromTo(
       handle->data, static_cast<size_t>(handle->byte_offset),
       data, 0,
-      nbytes, handle->ctx, cpu_ctx, handle->dtype, nullptr);
+      nbytes, handle->ctx, cpu_ctx, handle->dtype, stream);
+  if (stream)
+    device->StreamSync(handle->ctx, stream);
   API_END();
 }
 
 int DGLArrayPinData(DGLArrayHandle handle,
                     DLContext ctx) {
   API_BEGIN();
-  CHECK_EQ(ctx.device_type, kDLGPU);
-  DeviceAPI::Get(ctx)->PinData(ctx, handle->data,
-                                        GetDataSize(*handle));
+  NDArray(reinterpret_cast<NDArray::Container*>(handle)).PinMemory_(ctx);
   API_END();
 }
 
@@ -524,6 +624,6 @@ int DGLArrayUnpinData(DGLArrayHandle handle,
                       DLContext ctx) {
   API_BEGIN();
   CHECK_EQ(ctx.device_type, kDLGPU);
-  DeviceAPI::Get(ctx)->UnpinData(ctx, handle->data);
+  NDArray(reinterpret_cast<NDArray::Container*>(handle)).UnpinMemory_();
   API_END();
 }
@@ -0,0 +1,156 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file runtime/numa.cc
+ * \brief NUMA-aware placement of CPU threads and memory.
+ */
+#include <dgl/runtime/numa.h>
+#include <dgl/runtime/parallel_for.h>
+#include <dmlc/logging.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+#if defined(__linux__)
+#include <fstream>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace dgl {
+namespace runtime {
+namespace numa {
+
+namespace {
+
+#if defined(__linux__)
+/*! \brief Memory policy constants of mbind(2), see linux/mempolicy.h. */
+constexpr int kMpolInterleave = 3;
+constexpr unsigned kMpolMfMove = 1 << 1;
+#endif
+
+struct Topology {
+  bool enabled = false;
+  /*! \brief The online NUMA nodes with at least one cpu. */
+  std::vector<int> nodes;
+  /*! \brief The cpus of every node in nodes. */
+  std::vector<std::vector<int>> node_cpus;
+
+  Topology() {
+#if defined(__linux__)
+    std::ifstream online("/sys/devices/system/node/online");
+    std::string line;
+    if (online && std::getline(online, line)) {
+      for (int node : ParseCpuList(line)) {
+        std::ifstream fs("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        std::string cpulist;
+        if (fs && std::getline(fs, cpulist)) {
+          std::vector<int> cpus = ParseCpuList(cpulist);
+          // memory-only nodes cannot host threads
+          if (!cpus.empty()) {
+            nodes.push_back(node);
+            node_cpus.push_back(cpus);
+          }
+        }
+      }
+    }
+#endif
+    const char* var = std::getenv("DGL_CPU_NUMA_ENABLED");
+    enabled = var && std::string(var) == "1" && nodes.size() > 1;
+  }
+};
+
+const Topology& GetTopology() {
+  static Topology topology;
+  return topology;
+}
+
+}  // namespace
+
+bool Enabled() {
+  return GetTopology().enabled;
+}
+
+int NumNodes() {
+  return std::max<int>(1, GetTopology().nodes.size());
+}
+
+void BindThread(int tid, int num_threads) {
+  const Topology& topology = GetTopology();
+  if (!topology.enabled || num_threads <= 0)
+    return;
+  static thread_local int bound_node = -1;
+  const int num_nodes = topology.nodes.size();
+  const int node = std::min<int>(
+      num_nodes - 1, static_cast<int64_t>(tid) * num_nodes / num_threads);
+  if (node == bound_node)
+    return;
+#if defined(__linux__)
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  for (int cpu : topology.node_cpus[node])
+    CPU_SET(cpu, &cpuset);
+  pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+#endif
+  bound_node = node;
+}
+
+void FirstTouch(void* ptr, size_t size) {
+  if (!Enabled() || size == 0)
+    return;
+#if defined(__linux__)
+  const size_t page_size = sysconf(_SC_PAGESIZE);
+  char* data = static_cast<char*>(ptr);
+  parallel_for(0, size, page_size, [&](size_t b, size_t e) {
+    for (size_t i = b; i < e; i = (i / page_size + 1) * page_size)
+      data[i] = 0;
+  });
+#endif
+}
+
+void Interleave(void* ptr, size_t size) {
+  const Topology& topology = GetTopology();
+  if (topology.nodes.size() <= 1 || size == 0)
+    return;
+#if defined(__linux__)
+  const uintptr_t page_size = sysconf(_SC_PAGESIZE);
+  const uintptr_t start = reinterpret_cast<uintptr_t>(ptr) & ~(page_size - 1);
+  const uintptr_t len = reinterpret_cast<uintptr_t>(ptr) + size - start;
+  const int max_node = *std::max_element(topology.nodes.begin(), topology.nodes.end());
+  const int bits_per_word = sizeof(uint64_t) * 8;
+  std::vector<uint64_t> mask(max_node / bits_per_word + 1, 0);
+  for (int node : topology.nodes)
+    mask[node / bits_per_word] |= uint64_t(1) << (node % bits_per_word);
+  // the kernel expects one more than the number of bits in the mask
+  const uint64_t max_bits = mask.size() * bits_per_word + 1;
+  if (syscall(SYS_mbind, start, len, kMpolInterleave, mask.data(), max_bits, kMpolMfMove)) {
+    LOG(WARNING) << "Failed to interleave memory across NUMA nodes: "
+                 << std::strerror(errno);
+  }
+#endif
+}
+
+std::vector<int> ParseCpuList(const std::string& cpulist) {
+  std::vector<int> cpus;
+  std::stringstream ss(cpulist);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    if (range.empty() || range == "\n")
+      continue;
+    const size_t dash = range.find('-');
+    const int first = std::stoi(range.substr(0, dash));
+    const int last = (dash == std::string::npos) ? first : std::stoi(range.substr(dash + 1));
+    for (int cpu = first; cpu <= last; ++cpu)
+      cpus.push_back(cpu);
+  }
+  return cpus;
+}
+
+}  // namespace numa
+}  // namespace runtime
+}  // namespace dgl
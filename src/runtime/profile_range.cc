@@ -0,0 +1,67 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file runtime/profile_range.cc
+ * \brief Named ranges of the time spent in DGL, for Nsight Systems and VTune.
+ */
+#include <dgl/runtime/profile_range.h>
+#include <dgl/runtime/registry.h>
+
+#ifdef DGL_USE_PROFILING_RANGES
+
+#ifdef DGL_USE_NVTX
+#include <nvtx3/nvToolsExt.h>
+#endif  // DGL_USE_NVTX
+#ifdef DGL_USE_ITT
+#include <ittnotify.h>
+#endif  // DGL_USE_ITT
+
+namespace dgl {
+namespace runtime {
+
+#ifdef DGL_USE_ITT
+namespace {
+
+__itt_domain* GetDomain() {
+  static __itt_domain* domain = __itt_domain_create("dgl");
+  return domain;
+}
+
+}  // namespace
+#endif  // DGL_USE_ITT
+
+void ProfileRange::Begin(const char* name) {
+#ifdef DGL_USE_NVTX
+  nvtxRangePushA(name);
+#endif  // DGL_USE_NVTX
+#ifdef DGL_USE_ITT
+  // the handles are interned by name
+  __itt_task_begin(GetDomain(), __itt_null, __itt_null, __itt_string_handle_create(name));
+#endif  // DGL_USE_ITT
+}
+
+void ProfileRange::End() {
+#ifdef DGL_USE_NVTX
+  nvtxRangePop();
+#endif  // DGL_USE_NVTX
+#ifdef DGL_USE_ITT
+  __itt_task_end(GetDomain());
+#endif  // DGL_USE_ITT
+}
+
+// The ranges of the startup of the Python frontend, which only looks them up
+// when they are registered, i.e. in the builds with the ranges.
+DGL_REGISTER_GLOBAL("_ProfileRangePush")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    const std::string name = args[0];
+    ProfileRange::Begin(name.c_str());
+  });
+
+DGL_REGISTER_GLOBAL("_ProfileRangePop")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    ProfileRange::End();
+  });
+
+}  // namespace runtime
+}  // namespace dgl
+
+#endif  // DGL_USE_PROFILING_RANGES
@@ -6,6 +6,7 @@
 #include <dmlc/logging.h>
 #include <dmlc/thread_local.h>
 #include <dgl/runtime/registry.h>
+#include <dgl/runtime/profile_range.h>
 #include <unordered_map>
 #include <mutex>
 #include <memory>
@@ -16,6 +17,8 @@ namespace dgl {
 namespace runtime {
 
 struct Registry::Manager {
+  /*! \brief The number of functions the map is sized for, above what DGL registers. */
+  static constexpr size_t kInitialCapacity = 1024;
   // map storing the functions.
   // We delibrately used raw pointer
   // This is because PackedFunc can contain callbacks into the host languge(python)
@@ -28,6 +31,8 @@ struct Registry::Manager {
   std::mutex mutex;
 
   Manager() {
+    // no rehashing while the static initializers register the functions
+    fmap.reserve(kInitialCapacity);
     for (auto& x : ext_vtable) {
       x.destroy = nullptr;
     }
@@ -40,18 +45,22 @@ struct Registry::Manager {
 };
 
 Registry& Registry::set_body(PackedFunc f) {  // NOLINT(*)
+  // Most of the functions are registered by the static initializers of the
+  // library and never called, so anything beyond storing the body is left to
+  // the first Get.
   func_ = f;
+  materialized_ = false;
   return *this;
 }
 
 Registry& Registry::Register(const std::string& name, bool override) {  // NOLINT(*)
   Manager* m = Manager::Global();
   std::lock_guard<std::mutex> lock(m->mutex);
-  auto it = m->fmap.find(name);
-  if (it == m->fmap.end()) {
+  auto it = m->fmap.emplace(name, nullptr).first;
+  if (it->second == nullptr) {
     Registry* r = new Registry();
     r->name_ = name;
-    m->fmap[name] = r;
+    it->second = r;
     return *r;
   } else {
     CHECK(override)
@@ -74,7 +83,20 @@ const PackedFunc* Registry::Get(const std::string& name) {
   std::lock_guard<std::mutex> lock(m->mutex);
   auto it = m->fmap.find(name);
   if (it == m->fmap.end()) return nullptr;
-  return &(it->second->func_);
+  Registry* r = it->second;
+  if (!r->materialized_) {
+#ifdef DGL_USE_PROFILING_RANGES
+    // every C API call is a range named by the function
+    const PackedFunc f = r->func_;
+    const std::string name = r->name_;
+    r->func_ = PackedFunc([f, name](DGLArgs args, DGLRetValue* rv) {
+        DGL_PROFILE_RANGE(name.c_str());
+        f.CallPacked(args, rv);
+      });
+#endif  // DGL_USE_PROFILING_RANGES
+    r->materialized_ = true;
+  }
+  return &(r->func_);
 }
 
 std::vector<std::string> Registry::ListNames() {
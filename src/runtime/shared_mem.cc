@@ -8,10 +8,15 @@
 #include <fcntl.h>
 #include <unistd.h>
 #endif
+#if defined(__linux__)
+#include <sys/vfs.h>
+#endif
 #include <stdio.h>
 #include <string.h>
 #include <dmlc/logging.h>
+#include <dgl/runtime/huge_page.h>
 #include <dgl/runtime/shared_mem.h>
+#include <mutex>
 
 #include "resource_manager.h"
 
@@ -25,19 +30,47 @@ namespace runtime {
  */
 class SharedMemoryResource: public Resource {
   std::string name;
+  std::string huge_page_file;
 
  public:
-  explicit SharedMemoryResource(const std::string &name) {
+  explicit SharedMemoryResource(const std::string &name,
+                                const std::string &huge_page_file = "") {
     this->name = name;
+    this->huge_page_file = huge_page_file;
   }
 
   void Destroy() {
     // LOG(INFO) << "remove " << name << " for shared memory";
-    shm_unlink(name.c_str());
+    if (huge_page_file.empty())
+      shm_unlink(name.c_str());
+    else
+      unlink(huge_page_file.c_str());
   }
 };
 #endif  // _WIN32
 
+#if defined(__linux__)
+/*
+ * Shared memory backed by explicit huge pages is a file in hugetlbfs, which
+ * the other processes find by name like the ones of shm_open.
+ */
+static std::string HugePageFile(const std::string &name) {
+  return huge_page::HugetlbfsDir() + "/" + (name[0] == '/' ? name.substr(1) : name);
+}
+
+/*
+ * The mappings of a hugetlbfs file are multiples of its page size, which is
+ * the block size of the file system.
+ */
+static size_t RoundToHugePage(int fd, size_t sz) {
+  struct statfs st;
+  if (fstatfs(fd, &st) != 0 || st.f_bsize <= 0)
+    return sz;
+  const size_t page = st.f_bsize;
+  return (sz + page - 1) / page * page;
+}
+#endif  // __linux__
+
 SharedMemory::SharedMemory(const std::string &name) {
 #ifndef _WIN32
   this->name = name;
@@ -56,7 +89,10 @@ SharedMemory::~SharedMemory() {
   close(fd_);
   if (own_) {
     // LOG(INFO) << "remove " << name << " for shared memory";
-    shm_unlink(name.c_str());
+    if (huge_page_file_.empty())
+      shm_unlink(name.c_str());
+    else
+      unlink(huge_page_file_.c_str());
     // The resource has been deleted. We don't need to keep track of it any more.
     DeleteResource(name);
   }
@@ -69,6 +105,38 @@ void *SharedMemory::CreateNew(size_t sz) {
 #ifndef _WIN32
   this->own_ = true;
 
+#if defined(__linux__)
+  const huge_page::Mode mode = huge_page::GetMode();
+  if ((mode == huge_page::Mode::k2MB || mode == huge_page::Mode::k1GB) &&
+      sz >= huge_page::kMinBytes) {
+    const std::string file = HugePageFile(name);
+    fd_ = open(file.c_str(), O_RDWR|O_CREAT, S_IRUSR | S_IWUSR);
+    int err = errno;
+    if (fd_ != -1) {
+      const size_t mapped = RoundToHugePage(fd_, sz);
+      void *ptr = MAP_FAILED;
+      // The huge pages are reserved by mmap, which fails if there are not enough.
+      if (ftruncate(fd_, mapped) != -1)
+        ptr = mmap(NULL, mapped, PROT_READ|PROT_WRITE, MAP_SHARED, fd_, 0);
+      if (ptr != MAP_FAILED) {
+        AddResource(name, std::shared_ptr<Resource>(new SharedMemoryResource(name, file)));
+        huge_page_file_ = file;
+        ptr_ = ptr;
+        this->size_ = mapped;
+        return ptr_;
+      }
+      err = errno;
+      close(fd_);
+      unlink(file.c_str());
+    }
+    static std::once_flag warned;
+    std::call_once(warned, [&file, err] {
+      LOG(WARNING) << "Failed to create shared memory with huge pages in " << file
+                   << ", falling back to regular pages: " << strerror(err);
+    });
+  }
+#endif  // __linux__
+
   // We need to create a shared-memory file.
   // TODO(zhengda) we need to report error if the shared-memory file exists.
   int flag = O_RDWR|O_CREAT;
@@ -83,6 +151,7 @@ void *SharedMemory::CreateNew(size_t sz) {
   CHECK_NE(ptr_, MAP_FAILED)
       << "Failed to map shared memory. mmap failed with error " << strerror(errno);
   this->size_ = sz;
+  huge_page::Advise(ptr_, sz);
   return ptr_;
 #else
   LOG(FATAL) << "Shared memory is not supported on Windows.";
@@ -92,6 +161,20 @@ void *SharedMemory::CreateNew(size_t sz) {
 
 void *SharedMemory::Open(size_t sz) {
 #ifndef _WIN32
+#if defined(__linux__)
+  // The shared memory may have been created with huge pages by another process.
+  const std::string file = HugePageFile(name);
+  fd_ = open(file.c_str(), O_RDWR);
+  if (fd_ != -1) {
+    const size_t mapped = RoundToHugePage(fd_, sz);
+    ptr_ = mmap(NULL, mapped, PROT_READ|PROT_WRITE, MAP_SHARED, fd_, 0);
+    CHECK_NE(ptr_, MAP_FAILED)
+        << "Failed to map shared memory. mmap failed with error " << strerror(errno);
+    huge_page_file_ = file;
+    this->size_ = mapped;
+    return ptr_;
+  }
+#endif  // __linux__
   int flag = O_RDWR;
   fd_ = shm_open(name.c_str(), flag, S_IRUSR | S_IWUSR);
   CHECK_NE(fd_, -1) << "fail to open " << name << ": " << strerror(errno);
@@ -99,6 +182,7 @@ void *SharedMemory::Open(size_t sz) {
   CHECK_NE(ptr_, MAP_FAILED)
       << "Failed to map shared memory. mmap failed with error " << strerror(errno);
   this->size_ = sz;
+  huge_page::Advise(ptr_, sz);
   return ptr_;
 #else
   LOG(FATAL) << "Shared memory is not supported on Windows.";
@@ -108,6 +192,10 @@ void *SharedMemory::Open(size_t sz) {
 
 bool SharedMemory::Exist(const std::string &name) {
 #ifndef _WIN32
+#if defined(__linux__)
+  if (access(HugePageFile(name).c_str(), F_OK) == 0)
+    return true;
+#endif  // __linux__
   int fd_ = shm_open(name.c_str(), O_RDONLY, S_IRUSR | S_IWUSR);
   if (fd_ >= 0) {
     close(fd_);
@@ -0,0 +1,242 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file runtime/stage_tracker.cc
+ * \brief Timers and counters of the stages of the sampling pipelines.
+ */
+#include <dgl/runtime/registry.h>
+#include <dgl/runtime/stage_tracker.h>
+#include <dmlc/logging.h>
+#include <dmlc/omp.h>
+
+#ifndef _WIN32
+#include <time.h>
+#endif  // _WIN32
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+namespace dgl {
+namespace runtime {
+
+namespace {
+
+const char* const kStageNames[StageTracker::kNumStages] = {
+  "SampleNeighbors", "ExcludeEdges", "ToBlock", "Gather", "CopyTo"};
+
+thread_local int64_t current_batch = -1;
+
+/*! \return A small ID of the calling thread, in the order of their first calls. */
+int ThreadIndex() {
+  static std::atomic<int> num_threads{0};
+  thread_local int index = num_threads++;
+  return index;
+}
+
+bool EnvFlag(const char* name) {
+  const char* var = std::getenv(name);
+  return var && std::strcmp(var, "1") == 0;
+}
+
+}  // namespace
+
+constexpr int StageTracker::kNumStages;
+constexpr size_t StageTracker::kMaxTraceEvents;
+
+StageTracker::StageTracker() {
+  enabled_ = EnvFlag("DGL_STAGE_TRACKING");
+  tracing_ = EnvFlag("DGL_STAGE_TRACE");
+}
+
+StageTracker* StageTracker::Global() {
+  // never destroyed, since the stages may be called in static destructors
+  static StageTracker* tracker = new StageTracker();
+  return tracker;
+}
+
+int64_t StageTracker::NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int64_t StageTracker::CPUTimeNs() {
+#ifndef _WIN32
+  timespec ts;
+  if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) == 0)
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#endif  // _WIN32
+  return 0;
+}
+
+void StageTracker::OnCall(const Record& record) {
+  const int stage = static_cast<int>(record.stage);
+  CHECK(stage >= 0 && stage < kNumStages) << "Invalid sampling stage " << stage << ".";
+  if (Enabled()) {
+    Counter& counter = stages_[stage];
+    ++counter.num_calls;
+    counter.num_seeds += record.num_seeds;
+    counter.num_edges += record.num_edges;
+    counter.num_bytes += record.num_bytes;
+    counter.wall_ns += record.wall_ns;
+    counter.cpu_ns += record.cpu_ns;
+    counter.thread_ns += record.wall_ns * record.num_threads;
+  }
+  if (Tracing()) {
+    const int thread = ThreadIndex();
+    std::lock_guard<std::mutex> lock(trace_mutex_);
+    if (trace_.size() < kMaxTraceEvents)
+      trace_.push_back({record, thread});
+    else
+      ++num_dropped_;
+  }
+}
+
+std::vector<StageTracker::Counters> StageTracker::GetCounters() const {
+  std::vector<Counters> ret(kNumStages);
+  for (int i = 0; i < kNumStages; ++i) {
+    const Counter& counter = stages_[i];
+    ret[i] = Counters{counter.num_calls.load(), counter.num_seeds.load(),
+                      counter.num_edges.load(), counter.num_bytes.load(),
+                      counter.wall_ns.load(), counter.cpu_ns.load(),
+                      counter.thread_ns.load()};
+  }
+  return ret;
+}
+
+std::string StageTracker::GetTrace() const {
+  std::lock_guard<std::mutex> lock(trace_mutex_);
+  // the times of the events are in microseconds from the first one
+  int64_t origin_ns = 0;
+  for (size_t i = 0; i < trace_.size(); ++i) {
+    if (i == 0 || trace_[i].record.start_ns < origin_ns)
+      origin_ns = trace_[i].record.start_ns;
+  }
+  std::ostringstream os;
+  os << "{\"traceEvents\":[";
+  for (size_t i = 0; i < trace_.size(); ++i) {
+    const Record& record = trace_[i].record;
+    os << (i ? ",\n" : "\n")
+       << "{\"name\":\"" << kStageNames[static_cast<int>(record.stage)] << "\""
+       << ",\"cat\":\"sampling\",\"ph\":\"X\",\"pid\":0"
+       << ",\"tid\":" << trace_[i].thread
+       << ",\"ts\":" << (record.start_ns - origin_ns) / 1000.
+       << ",\"dur\":" << record.wall_ns / 1000.
+       << ",\"args\":{\"batch\":" << record.batch
+       << ",\"seeds\":" << record.num_seeds
+       << ",\"edges\":" << record.num_edges
+       << ",\"bytes\":" << record.num_bytes
+       << ",\"threads\":" << record.num_threads << "}}";
+  }
+  os << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped_events\":"
+     << num_dropped_ << "}}";
+  return os.str();
+}
+
+void StageTracker::Reset() {
+  for (Counter& counter : stages_) {
+    counter.num_calls = 0;
+    counter.num_seeds = 0;
+    counter.num_edges = 0;
+    counter.num_bytes = 0;
+    counter.wall_ns = 0;
+    counter.cpu_ns = 0;
+    counter.thread_ns = 0;
+  }
+  std::lock_guard<std::mutex> lock(trace_mutex_);
+  trace_.clear();
+  num_dropped_ = 0;
+}
+
+StageScope::StageScope(SamplingStage stage) : record_() {
+  StageTracker* tracker = StageTracker::Global();
+  active_ = tracker->Enabled() || tracker->Tracing();
+  if (!active_)
+    return;
+  record_.stage = stage;
+  record_.batch = current_batch;
+  record_.num_threads = omp_get_max_threads();
+  record_.cpu_ns = StageTracker::CPUTimeNs();
+  record_.start_ns = StageTracker::NowNs();
+}
+
+StageScope::~StageScope() {
+  if (!active_)
+    return;
+  record_.wall_ns = StageTracker::NowNs() - record_.start_ns;
+  record_.cpu_ns = StageTracker::CPUTimeNs() - record_.cpu_ns;
+  StageTracker::Global()->OnCall(record_);
+}
+
+void StageScope::AddSeeds(const std::vector<NDArray>& seeds) {
+  if (!active_)
+    return;
+  for (const NDArray& array : seeds) {
+    if (array.defined() && array->ndim > 0)
+      record_.num_seeds += array->shape[0];
+  }
+}
+
+void StageScope::AddEdges(const std::vector<NDArray>& edges) {
+  if (!active_)
+    return;
+  for (const NDArray& array : edges) {
+    if (array.defined() && array->ndim > 0)
+      record_.num_edges += array->shape[0];
+  }
+}
+
+StageBatchScope::StageBatchScope(int64_t batch) : prev_(current_batch) {
+  current_batch = batch;
+}
+
+StageBatchScope::~StageBatchScope() {
+  current_batch = prev_;
+}
+
+int64_t StageBatchScope::Current() {
+  return current_batch;
+}
+
+DGL_REGISTER_GLOBAL("utils.internal._CAPI_DGLStageTrackerSetEnabled")
+.set_body([](DGLArgs args, DGLRetValue* rv) {
+    const bool enabled = args[0];
+    const bool tracing = args[1];
+    StageTracker::Global()->SetEnabled(enabled);
+    StageTracker::Global()->SetTracing(tracing);
+  });
+
+DGL_REGISTER_GLOBAL("utils.internal._CAPI_DGLStageTrackerReset")
+.set_body([](DGLArgs args, DGLRetValue* rv) {
+    StageTracker::Global()->Reset();
+  });
+
+/*!
+ * \brief The counters of the stages, flattened: whether the tracker is enabled
+ *        and tracing, then the counters of every stage in the order of
+ *        StageTracker::Counters.
+ */
+DGL_REGISTER_GLOBAL("utils.internal._CAPI_DGLStageTrackerStats")
+.set_body([](DGLArgs args, DGLRetValue* rv) {
+    StageTracker* tracker = StageTracker::Global();
+    std::vector<int64_t> ret = {tracker->Enabled(), tracker->Tracing()};
+    for (const auto& c : tracker->GetCounters()) {
+      ret.insert(ret.end(), {c.num_calls, c.num_seeds, c.num_edges, c.num_bytes,
+                             c.wall_ns, c.cpu_ns, c.thread_ns});
+    }
+    *rv = NDArray::FromVector(ret);
+  });
+
+DGL_REGISTER_GLOBAL("utils.internal._CAPI_DGLStageTrackerTrace")
+.set_body([](DGLArgs args, DGLRetValue* rv) {
+    *rv = StageTracker::Global()->GetTrace();
+  });
+
+DGL_REGISTER_GLOBAL("utils.internal._CAPI_DGLStageTrackerSetBatch")
+.set_body([](DGLArgs args, DGLRetValue* rv) {
+    // the batch of the calling thread, until set again
+    current_batch = args[0];
+  });
+
+}  // namespace runtime
+}  // namespace dgl
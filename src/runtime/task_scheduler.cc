@@ -0,0 +1,249 @@
+/*!
+ *  Copyright (c) 2021 by Contributors
+ * \file runtime/task_scheduler.cc
+ * \brief A work-stealing scheduler of CPU tasks supporting nested parallelism.
+ */
+#include <dgl/runtime/task_scheduler.h>
+#include <dgl/runtime/numa.h>
+#include <dmlc/logging.h>
+#include <dmlc/omp.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace dgl {
+namespace runtime {
+
+namespace {
+
+/*! \brief The scheduler and the deque of the calling worker thread, if any. */
+thread_local const TaskScheduler* worker_owner = nullptr;
+thread_local int worker_id = -1;
+
+/*! \brief The first deque the calling thread tries to steal from. */
+thread_local size_t next_victim = 0;
+
+/*! \brief The rounds of stealing of an idle worker before it sleeps. */
+constexpr int kNumSpins = 64;
+
+/*! \brief The global scheduler, created on first use. */
+std::atomic<TaskScheduler*> global_scheduler{nullptr};
+std::mutex global_mutex;
+
+/*! \brief Restrict the calling thread to a set of cpus. */
+void PinThread(const std::vector<int>& cpus) {
+#if defined(__linux__)
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  for (int cpu : cpus) {
+    CHECK(cpu >= 0 && cpu < CPU_SETSIZE) << "Invalid cpu id " << cpu << ".";
+    CPU_SET(cpu, &cpuset);
+  }
+  const int ret = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset);
+  if (ret != 0)
+    LOG(WARNING) << "Failed to pin a thread to its cpus: " << std::strerror(ret);
+#endif
+}
+
+#if defined(__linux__)
+void LockGlobal() {
+  global_mutex.lock();
+}
+
+void UnlockGlobal() {
+  global_mutex.unlock();
+}
+
+void ResetGlobalInChild() {
+  // the workers are not forked; the scheduler is leaked, as its threads
+  // cannot be joined
+  global_scheduler = nullptr;
+  global_mutex.unlock();
+}
+#endif
+
+}  // namespace
+
+TaskScheduler::TaskScheduler(int num_workers, std::vector<int> cores) {
+  cores_ = std::move(cores);
+  num_workers = std::max(num_workers, 0);
+  for (int i = 0; i <= num_workers; ++i)
+    queues_.emplace_back(new Queue());
+  for (int i = 0; i < num_workers; ++i)
+    workers_.emplace_back(&TaskScheduler::WorkerLoop, this, i);
+}
+
+TaskScheduler::~TaskScheduler() {
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    stop_ = true;
+  }
+  sleep_cond_.notify_all();
+  for (auto& worker : workers_)
+    worker.join();
+}
+
+TaskScheduler* TaskScheduler::Global() {
+  TaskScheduler* scheduler = global_scheduler.load();
+  if (scheduler)
+    return scheduler;
+  std::lock_guard<std::mutex> lock(global_mutex);
+  scheduler = global_scheduler.load();
+  if (scheduler)
+    return scheduler;
+#if defined(__linux__)
+  static const bool fork_handlers = []() {
+    return pthread_atfork(LockGlobal, UnlockGlobal, ResetGlobalInChild) == 0;
+  }();
+  CHECK(fork_handlers) << "Failed to register the fork handlers of the scheduler.";
+#endif
+  const char* cores_var = std::getenv("DGL_CPU_CORES");
+  std::vector<int> cores = cores_var ? numa::ParseCpuList(cores_var) : std::vector<int>();
+  const char* threads_var = std::getenv("DGL_NUM_THREADS");
+  int num_threads = threads_var ? std::atoi(threads_var) :
+    (cores.empty() ? omp_get_max_threads() : static_cast<int>(cores.size()));
+  num_threads = std::max(num_threads, 1);
+  if (!cores.empty())
+    PinThread(cores);
+  // never destroyed, since parallel loops may run in static destructors
+  scheduler = new TaskScheduler(num_threads - 1, std::move(cores));
+  global_scheduler = scheduler;
+  return scheduler;
+}
+
+bool TaskScheduler::Enabled() {
+  static const bool enabled = []() {
+    const char* var = std::getenv("DGL_PARALLEL_FOR_SCHEDULER");
+    return var && std::strcmp(var, "work_stealing") == 0;
+  }();
+  return enabled;
+}
+
+TaskScheduler::Queue* TaskScheduler::LocalQueue() {
+  if (worker_owner == this)
+    return queues_[worker_id].get();
+  return queues_.back().get();
+}
+
+void TaskScheduler::Push(Queue* queue, const Task& task) {
+  {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    queue->tasks.push_back(task);
+  }
+  ++num_queued_;
+  // a worker going to sleep counts itself before checking num_queued_
+  if (num_sleepers_.load() > 0) {
+    { std::lock_guard<std::mutex> lock(sleep_mutex_); }
+    sleep_cond_.notify_one();
+  }
+}
+
+bool TaskScheduler::Pop(Queue* queue, Task* task) {
+  {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    if (!queue->tasks.empty()) {
+      *task = queue->tasks.back();
+      queue->tasks.pop_back();
+      --num_queued_;
+      return true;
+    }
+  }
+  if (num_queued_.load() <= 0)
+    return false;
+  // steal the oldest, i.e. largest, task of another thread
+  const size_t num_queues = queues_.size();
+  // the threads start from different victims
+  const size_t start = next_victim++;
+  for (size_t k = 0; k < num_queues; ++k) {
+    Queue* victim = queues_[(start + k) % num_queues].get();
+    if (victim == queue)
+      continue;
+    std::lock_guard<std::mutex> lock(victim->mutex);
+    if (!victim->tasks.empty()) {
+      *task = victim->tasks.front();
+      victim->tasks.pop_front();
+      --num_queued_;
+      return true;
+    }
+  }
+  return false;
+}
+
+void TaskScheduler::Run(Queue* queue, Task task) {
+  Loop* loop = task.loop;
+  while (task.end - task.begin > loop->grain_size) {
+    const size_t mid = task.begin + (task.end - task.begin) / 2;
+    ++loop->num_pending;
+    Push(queue, Task{loop, mid, task.end});
+    task.end = mid;
+  }
+  try {
+    (*loop->f)(task.begin, task.end);
+  } catch (...) {
+    if (!loop->err_flag.test_and_set())
+      loop->eptr = std::current_exception();
+  }
+  // the loop may be gone right after
+  --loop->num_pending;
+}
+
+void TaskScheduler::ParallelFor(size_t begin, size_t end, size_t grain_size,
+                                const RangeFn& f) {
+  if (begin >= end)
+    return;
+  Loop loop;
+  loop.f = &f;
+  loop.grain_size = std::max<size_t>(grain_size, 1);
+  loop.num_pending = 1;
+  Queue* queue = LocalQueue();
+  Run(queue, Task{&loop, begin, end});
+  // help with any loop until the ranges of this one are done
+  Task task;
+  while (loop.num_pending.load() > 0) {
+    if (Pop(queue, &task))
+      Run(queue, task);
+    else
+      std::this_thread::yield();
+  }
+  if (loop.eptr)
+    std::rethrow_exception(loop.eptr);
+}
+
+void TaskScheduler::WorkerLoop(int id) {
+  worker_owner = this;
+  worker_id = id;
+  // the caller counts as thread 0
+  if (!cores_.empty())
+    PinThread({cores_[(id + 1) % cores_.size()]});
+  else if (numa::Enabled())
+    numa::BindThread(id + 1, NumThreads());
+  Queue* queue = queues_[id].get();
+  Task task;
+  for (;;) {
+    bool found = false;
+    for (int spin = 0; spin < kNumSpins && !found; ++spin) {
+      found = Pop(queue, &task);
+      if (!found)
+        std::this_thread::yield();
+    }
+    if (found) {
+      Run(queue, task);
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    ++num_sleepers_;
+    sleep_cond_.wait(lock, [this] { return stop_ || num_queued_.load() > 0; });
+    --num_sleepers_;
+    if (stop_)
+      return;
+  }
+}
+
+}  // namespace runtime
+}  // namespace dgl
@@ -34,7 +34,8 @@ bool TensorDispatcher::Load(const char *path) {
 
   for (int i = 0; i < num_entries_; ++i) {
     entrypoints_[i] = reinterpret_cast<void*>(GetProcAddress(handle_, names_[i]));
-    CHECK(entrypoints_[i]) << "cannot locate symbol " << names_[i];
+    if (i < num_required_entries_)
+      CHECK(entrypoints_[i]) << "cannot locate symbol " << names_[i];
   }
 #else   // !WIN32
   handle_ = dlopen(path, RTLD_LAZY);
@@ -46,7 +47,8 @@ bool TensorDispatcher::Load(const char *path) {
 
   for (int i = 0; i < num_entries_; ++i) {
     entrypoints_[i] = dlsym(handle_, names_[i]);
-    CHECK(entrypoints_[i]) << "cannot locate symbol " << names_[i];
+    if (i < num_required_entries_)
+      CHECK(entrypoints_[i]) << "cannot locate symbol " << names_[i];
   }
 #endif  // WIN32
 
@@ -9,6 +9,7 @@
 
 #include <dgl/aten/coo.h>
 #include <dgl/packed_func_ext.h>
+#include <dgl/runtime/numa.h>
 #include <utility>
 
 #include "../c_api_common.h"
@@ -26,6 +27,13 @@ DGL_REGISTER_GLOBAL("utils.internal._CAPI_DGLSetOMPThreads")
     omp_set_num_threads(num_threads);
   });
 
+DGL_REGISTER_GLOBAL("utils.internal._CAPI_DGLNumaInterleave")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    NDArray array = args[0];
+    CHECK_EQ(array->ctx.device_type, kDLCPU) << "Only CPU arrays can be interleaved.";
+    numa::Interleave(array->data, array.GetSize());
+  });
+
 
 DGL_REGISTER_GLOBAL("utils.checks._CAPI_DGLCOOIsSorted")
 .set_body([] (DGLArgs args, DGLRetValue* rv) {
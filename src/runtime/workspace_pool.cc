@@ -4,6 +4,7 @@
  * \brief Workspace pool utility.
  */
 #include "workspace_pool.h"
+#include <dgl/runtime/memory_tracker.h>
 #include <memory>
 
 namespace dgl {
@@ -20,6 +21,7 @@ class WorkspacePool::Pool {
     Entry e;
     e.data = nullptr;
     e.size = 0;
+    e.tracked = false;
     free_list_.push_back(e);
     allocated_.push_back(e);
   }
@@ -29,22 +31,16 @@ class WorkspacePool::Pool {
     nbytes = (nbytes + (kWorkspacePageSize - 1)) / kWorkspacePageSize * kWorkspacePageSize;
     if (nbytes == 0) nbytes = kWorkspacePageSize;
     Entry e;
-    DGLType type;
-    type.code = kDLUInt;
-    type.bits = 8;
-    type.lanes = 1;
     if (free_list_.size() == 2) {
       e = free_list_.back();
       free_list_.pop_back();
       if (e.size < nbytes) {
         // resize the page
-        device->FreeDataSpace(ctx, e.data);
-        e.data = device->AllocDataSpace(ctx, nbytes, kTempAllocaAlignment, type);
-        e.size = nbytes;
+        FreePage(ctx, device, e);
+        e = AllocPage(ctx, device, nbytes);
       }
     } else if (free_list_.size() == 1) {
-      e.data = device->AllocDataSpace(ctx, nbytes, kTempAllocaAlignment, type);
-      e.size = nbytes;
+      e = AllocPage(ctx, device, nbytes);
     } else {
       if (free_list_.back().size >= nbytes) {
         // find smallest fit
@@ -56,9 +52,8 @@ class WorkspacePool::Pool {
         // resize the page
         e = free_list_.back();
         free_list_.pop_back();
-        device->FreeDataSpace(ctx, e.data);
-        e.data = device->AllocDataSpace(ctx, nbytes, kTempAllocaAlignment, type);
-        e.size = nbytes;
+        FreePage(ctx, device, e);
+        e = AllocPage(ctx, device, nbytes);
       }
     }
     allocated_.push_back(e);
@@ -96,7 +91,7 @@ class WorkspacePool::Pool {
   void Release(DGLContext ctx, DeviceAPI* device) {
     CHECK_EQ(allocated_.size(), 1);
     for (size_t i = 1; i < free_list_.size(); ++i) {
-      device->FreeDataSpace(ctx, free_list_[i].data);
+      FreePage(ctx, device, free_list_[i]);
     }
     free_list_.clear();
   }
@@ -106,7 +101,27 @@ class WorkspacePool::Pool {
   struct Entry {
     void* data;
     size_t size;
+    // whether the page is counted by the memory tracker
+    bool tracked;
   };
+  // allocate a page from the device
+  Entry AllocPage(DGLContext ctx, DeviceAPI* device, size_t nbytes) {
+    DGLType type;
+    type.code = kDLUInt;
+    type.bits = 8;
+    type.lanes = 1;
+    Entry e;
+    e.data = device->AllocDataSpace(ctx, nbytes, kTempAllocaAlignment, type);
+    e.size = nbytes;
+    e.tracked = MemoryTracker::Global()->OnAlloc(ctx, nbytes, MemoryTag::kWorkspace);
+    return e;
+  }
+  // free a page to the device
+  void FreePage(DGLContext ctx, DeviceAPI* device, const Entry& e) {
+    device->FreeDataSpace(ctx, e.data);
+    if (e.tracked)
+      MemoryTracker::Global()->OnFree(ctx, e.size, MemoryTag::kWorkspace);
+  }
   /*! \brief List of free items, sorted from small to big size */
   std::vector<Entry> free_list_;
   /*! \brief List of allocated items */
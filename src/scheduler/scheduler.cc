@@ -4,6 +4,10 @@
  * \brief DGL Scheduler implementation
  */
 #include <dgl/scheduler.h>
+#include <dgl/array.h>
+#include <dgl/runtime/parallel_for.h>
+#include <algorithm>
+#include <cstring>
 #include <unordered_map>
 #include <vector>
 
@@ -170,6 +174,101 @@ template std::vector<IdArray> GroupEdgeByNodeDegree<int32_t>(
 template std::vector<IdArray> GroupEdgeByNodeDegree<int64_t>(
     const IdArray& uids, const IdArray& vids, const IdArray& eids);
 
+template <class IdType>
+std::vector<IdArray> DegreeBucketingCSC(const aten::CSRMatrix& csc) {
+  const int64_t num_nodes = csc.num_rows;
+  const IdType* indptr = csc.indptr.Ptr<IdType>();
+  const IdType* eid_data = aten::CSRHasData(csc) ? csc.data.Ptr<IdType>() : nullptr;
+  const auto& dtype = csc.indptr->dtype;
+  const auto& ctx = csc.indptr->ctx;
+
+  // number of nodes of every degree
+  IdType max_deg = 0;
+  for (int64_t v = 0; v < num_nodes; ++v)
+    max_deg = std::max(max_deg, indptr[v + 1] - indptr[v]);
+  std::vector<int64_t> count(max_deg + 1, 0);
+  for (int64_t v = 0; v < num_nodes; ++v)
+    ++count[indptr[v + 1] - indptr[v]];
+  int64_t n_deg = 0;
+  for (const int64_t c : count)
+    n_deg += c > 0;
+
+  IdArray degs = IdArray::Empty({n_deg}, dtype, ctx);
+  IdArray nids = IdArray::Empty({num_nodes}, dtype, ctx);
+  IdArray nid_section = IdArray::Empty({n_deg}, dtype, ctx);
+  IdArray eids = IdArray::Empty({csc.indices->shape[0]}, dtype, ctx);
+  IdType* deg_ptr = static_cast<IdType*>(degs->data);
+  IdType* nid_ptr = static_cast<IdType*>(nids->data);
+  IdType* nsec_ptr = static_cast<IdType*>(nid_section->data);
+  IdType* eid_ptr = static_cast<IdType*>(eids->data);
+
+  // the first position of every degree in nids and in eids
+  std::vector<int64_t> node_pos(max_deg + 1), edge_pos(max_deg + 1);
+  int64_t num_before = 0, edges_before = 0;
+  for (IdType deg = 0; deg <= max_deg; ++deg) {
+    node_pos[deg] = num_before;
+    edge_pos[deg] = edges_before;
+    if (count[deg] > 0) {
+      *deg_ptr++ = deg;
+      *nsec_ptr++ = count[deg];
+    }
+    num_before += count[deg];
+    edges_before += count[deg] * deg;
+  }
+  // the position of every node in nids, by a stable counting sort
+  std::vector<int64_t> offset(num_nodes);
+  for (int64_t v = 0; v < num_nodes; ++v) {
+    const IdType deg = indptr[v + 1] - indptr[v];
+    nid_ptr[node_pos[deg]] = v;
+    offset[v] = edge_pos[deg];
+    ++node_pos[deg];
+    edge_pos[deg] += deg;
+  }
+  runtime::parallel_for(0, num_nodes, [&](size_t b, size_t e) {
+    for (size_t v = b; v < e; ++v) {
+      IdType* out = eid_ptr + offset[v];
+      for (IdType i = indptr[v]; i < indptr[v + 1]; ++i)
+        *out++ = eid_data ? eid_data[i] : i;
+      std::sort(eid_ptr + offset[v], out);
+    }
+  });
+
+  std::vector<IdArray> ret;
+  ret.push_back(std::move(degs));
+  ret.push_back(std::move(nids));
+  ret.push_back(std::move(nid_section));
+  ret.push_back(std::move(eids));
+
+  return ret;
+}
+
+template std::vector<IdArray> DegreeBucketingCSC<int32_t>(const aten::CSRMatrix& csc);
+
+template std::vector<IdArray> DegreeBucketingCSC<int64_t>(const aten::CSRMatrix& csc);
+
+NDArray GatherMailbox(NDArray msg, IdArray eids) {
+  CHECK_EQ(msg->ctx.device_type, kDLCPU) << "The messages must be on CPU.";
+  CHECK(msg.IsContiguous()) << "The messages must be contiguous.";
+  const int64_t len = eids->shape[0];
+  std::vector<int64_t> shape(msg->shape, msg->shape + msg->ndim);
+  shape[0] = len;
+  NDArray ret = NDArray::Empty(shape, msg->dtype, msg->ctx);
+  const int64_t num_rows = msg->shape[0];
+  const int64_t row_bytes = msg.GetSize() / std::max<int64_t>(num_rows, 1);
+  const char* src = static_cast<const char*>(msg->data);
+  char* dst = static_cast<char*>(ret->data);
+  ATEN_ID_TYPE_SWITCH(eids->dtype, IdType, {
+    const IdType* idx = eids.Ptr<IdType>();
+    runtime::parallel_for(0, len, [&](size_t b, size_t e) {
+      for (size_t i = b; i < e; ++i) {
+        CHECK(idx[i] >= 0 && idx[i] < num_rows) << "Edge id out of range.";
+        std::memcpy(dst + i * row_bytes, src + idx[i] * row_bytes, row_bytes);
+      }
+    });
+  });
+  return ret;
+}
+
 }  // namespace sched
 
 }  // namespace dgl
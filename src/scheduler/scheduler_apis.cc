@@ -4,7 +4,10 @@
  * \brief DGL scheduler APIs
  */
 #include <dgl/array.h>
+#include <dgl/base_heterograph.h>
 #include <dgl/graph.h>
+#include <dgl/packed_func_ext.h>
+#include <dgl/runtime/container.h>
 #include <dgl/scheduler.h>
 #include "../c_api_common.h"
 #include "../array/cpu/array_utils.h"
@@ -12,6 +15,9 @@
 using dgl::runtime::DGLArgs;
 using dgl::runtime::DGLRetValue;
 using dgl::runtime::NDArray;
+using dgl::runtime::List;
+using dgl::runtime::ListValueToVector;
+using dgl::runtime::Value;
 
 namespace dgl {
 
@@ -41,4 +47,22 @@ DGL_REGISTER_GLOBAL("_deprecate.runtime.degree_bucketing._CAPI_DGLGroupEdgeByNod
     });
   });
 
+DGL_REGISTER_GLOBAL("core._CAPI_DGLDegreeBucketMailbox")
+.set_body([] (DGLArgs args, DGLRetValue* rv) {
+    HeteroGraphRef hg = args[0];
+    const auto& msgs = ListValueToVector<NDArray>(args[1]);
+    CHECK_EQ(hg->NumEdgeTypes(), 1) << "The graph must have a single edge type.";
+    std::vector<IdArray> sched;
+    ATEN_ID_TYPE_SWITCH(hg->DataType(), IdType, {
+      sched = sched::DegreeBucketingCSC<IdType>(hg->GetCSCMatrix(0));
+    });
+    List<Value> ret;
+    for (const IdArray& array : sched)
+      ret.push_back(Value(MakeValue(array)));
+    // the mailboxes of all the buckets, gathered in one buffer per message
+    for (const NDArray& msg : msgs)
+      ret.push_back(Value(MakeValue(sched::GatherMailbox(msg, sched[3]))));
+    *rv = ret;
+  });
+
 }  // namespace dgl
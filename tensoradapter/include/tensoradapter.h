@@ -34,6 +34,23 @@ extern "C" {
 TA_EXPORTS DLManagedTensor* TAempty(
     std::vector<int64_t> shape, DLDataType dtype, DLContext ctx);
 
+/*!
+ * \brief Allocate a piece of GPU memory from the allocator of the framework
+ *
+ * \param nbytes The size in bytes
+ * \param device_id The GPU
+ * \param stream The CUDA stream the memory is used on
+ * \return The pointer to the memory, to be freed with TAfree
+ */
+TA_EXPORTS void* TAalloc(size_t nbytes, int device_id, void* stream);
+
+/*!
+ * \brief Free the GPU memory allocated by TAalloc
+ *
+ * \param ptr The pointer to the memory
+ */
+TA_EXPORTS void TAfree(void* ptr);
+
 }
 
 };  // namespace tensoradapter
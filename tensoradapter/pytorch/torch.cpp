@@ -7,6 +7,11 @@
 #include <tensoradapter.h>
 #include <torch/torch.h>
 #include <ATen/DLConvertor.h>
+#ifdef DGL_USE_CUDA
+#include <c10/cuda/CUDACachingAllocator.h>
+#include <c10/cuda/CUDAGuard.h>
+#include <cuda_runtime.h>
+#endif  // DGL_USE_CUDA
 #include <vector>
 #include <iostream>
 
@@ -41,6 +46,19 @@ DLManagedTensor* TAempty(
   return at::toDLPack(tensor);
 }
 
+#ifdef DGL_USE_CUDA
+// not exported without CUDA, so that DGL keeps its own GPU workspaces
+void* TAalloc(size_t nbytes, int device_id, void* stream) {
+  c10::cuda::CUDAGuard guard(device_id);
+  return c10::cuda::CUDACachingAllocator::raw_alloc_with_stream(
+      nbytes, static_cast<cudaStream_t>(stream));
+}
+
+void TAfree(void* ptr) {
+  c10::cuda::CUDACachingAllocator::raw_delete(ptr);
+}
+#endif  // DGL_USE_CUDA
+
 };
 
 };  // namespace tensoradapter
@@ -241,6 +241,28 @@ def test_binary_op(idtype):
             print(lhs, rhs, binary_op)
             _test(lhs, rhs, binary_op)
 
+@parametrize_dtype
+def test_binary_op_many_relations(idtype):
+    # many relations of few edges each, as in heterogeneous attention
+    num_rels = 40
+    data = {}
+    for i in range(num_rels):
+        num_edges = 1 + i % 7
+        src = np.random.randint(0, 10, num_edges)
+        dst = np.random.randint(0, 8, num_edges)
+        data[('user', 'r%d' % i, 'item')] = (src, dst)
+    g = dgl.heterograph(data, idtype=idtype, device=F.ctx())
+    g.nodes['user'].data['h'] = F.randn((10, 4))
+    g.nodes['item'].data['h'] = F.randn((8, 4))
+
+    g.apply_edges(fn.u_dot_v('h', 'h', 'm'))
+    for etype in g.canonical_etypes:
+        sub = g[etype]
+        u, v = sub.edges()
+        expected = F.sum(F.gather_row(g.nodes['user'].data['h'], u) *
+                         F.gather_row(g.nodes['item'].data['h'], v), 1, keepdims=True)
+        assert F.allclose(g.edges[etype].data['m'], expected)
+
 
 if __name__ == '__main__':
     test_unary_copy_u()
@@ -0,0 +1,47 @@
+import backend as F
+import numpy as np
+import pytest
+
+import dgl
+from dgl.heterograph_index import _CAPI_DGLHeteroNumEdges, _CAPI_DGLHeteroInDegrees
+
+
+def test_async_call_capi():
+    g = dgl.graph((F.tensor([0, 1, 2, 0]), F.tensor([1, 2, 0, 2]))).to(F.ctx())
+    future = dgl.utils.async_call(_CAPI_DGLHeteroNumEdges, g._graph, 0)
+    assert future.wait() == 4
+    assert future.done()
+    # the tensors are passed as DGL NDArrays, and kept alive by the call
+    future = dgl.utils.async_call(
+        _CAPI_DGLHeteroInDegrees, g._graph, 0, F.copy_to(F.tensor([0, 1, 2]), F.ctx()))
+    assert np.array_equal(F.asnumpy(F.from_dgl_nd(future.wait())), [1, 1, 2])
+
+
+def test_async_call_chain():
+    def add(x, y):
+        return x + y
+    first = dgl.utils.async_call(add, 1, 2)
+    second = first.then(add, 10)
+    third = dgl.utils.async_call(add, second, first)
+    assert third.wait() == 16
+    assert first.done() and second.done()
+
+
+def test_async_call_error():
+    def fail(x):
+        raise ValueError('failed on {}'.format(x))
+    failed = dgl.utils.async_call(fail, 1)
+    with pytest.raises(dgl.DGLError):
+        failed.wait()
+    assert failed.done()
+    # so do the calls passed its future
+    with pytest.raises(dgl.DGLError):
+        failed.then(lambda x: x).wait()
+    # and the next calls go on
+    assert dgl.utils.async_call(lambda x: x * 2, 21).wait() == 42
+
+
+if __name__ == '__main__':
+    test_async_call_capi()
+    test_async_call_chain()
+    test_async_call_error()
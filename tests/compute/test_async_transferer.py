@@ -2,7 +2,7 @@ import dgl
 import unittest
 import backend as F
 
-from dgl.dataloading import AsyncTransferer
+from dgl.dataloading import AsyncTransferer, PrefetchQueue
 
 @unittest.skipIf(F._default_context_str == 'cpu',
                  reason="CPU transfer not allowed")
@@ -15,6 +15,26 @@ def test_async_transferer_to_other():
     assert F.context(other_ones) == F.ctx()
     assert F.array_equal(F.copy_to(other_ones, ctx=F.cpu()), cpu_ones)
 
+@unittest.skipIf(F._default_context_str == 'cpu',
+                 reason="Pinned memory needs a GPU")
+def test_pinned_ndarray():
+    nd_ctx = dgl.utils.to_dgl_context(F.ctx())
+    arr = dgl.ndarray.empty_pinned((100, 75), 'int32', nd_ctx)
+    assert arr.ctx == dgl.ndarray.cpu()
+    assert dgl.ndarray.is_pinned(arr)
+
+    cpu_ones = F.ones([100, 75], dtype=F.int32, ctx=F.cpu())
+    cpu_nd = F.zerocopy_to_dgl_ndarray(cpu_ones)
+    assert not dgl.ndarray.is_pinned(cpu_nd)
+    cpu_nd.pin_memory_(nd_ctx)
+    assert dgl.ndarray.is_pinned(cpu_nd)
+    # both the pinned and the pageable sources are copied
+    tran = AsyncTransferer(F.ctx())
+    other_ones = tran.async_copy(cpu_ones, F.ctx()).wait()
+    assert F.array_equal(F.copy_to(other_ones, ctx=F.cpu()), cpu_ones)
+    cpu_nd.unpin_memory_(nd_ctx)
+    assert not dgl.ndarray.is_pinned(cpu_nd)
+
 def test_async_transferer_from_other():
     other_ones = F.ones([100,75,25], dtype=F.int32, ctx=F.ctx())
     tran = AsyncTransferer(F.ctx())
@@ -28,7 +48,38 @@ def test_async_transferer_from_other():
         # should have thrown an error
         assert False
         
+def test_prefetch_queue():
+    batches = [[F.ones([10 + i, 4], dtype=F.float32, ctx=F.cpu()) * i,
+                F.ones([10 + i], dtype=F.int64, ctx=F.cpu()) * i,
+                F.ones([3], dtype=F.int32, ctx=F.ctx())]
+               for i in range(7)]
+    queue = PrefetchQueue(F.ctx(), num_slots=3, num_streams=2)
+    n = 0
+    for feats, labels, other in queue.prefetch(iter(batches)):
+        assert F.context(feats) == F.ctx()
+        assert F.array_equal(F.copy_to(feats, ctx=F.cpu()), batches[n][0])
+        assert F.array_equal(F.copy_to(labels, ctx=F.cpu()), batches[n][1])
+        assert F.array_equal(other, batches[n][2])
+        n += 1
+    assert n == len(batches)
+    assert len(queue) == 0
+
+    for i in range(3):
+        queue.put(batches[i])
+    try:
+        queue.put(batches[3])
+    except Exception:
+        # correctly threw an error
+        pass
+    else:
+        assert False
+    assert len(queue) == 3
+    feats, _, _ = queue.get()
+    assert F.array_equal(F.copy_to(feats, ctx=F.cpu()), batches[0][0])
+
 if __name__ == '__main__':
     test_async_transferer_to_other()
+    test_pinned_ndarray()
     test_async_transferer_from_other()
+    test_prefetch_queue()
 
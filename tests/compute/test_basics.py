@@ -658,6 +658,27 @@ def test_degree_bucket_edge_ordering(idtype):
         return {'n': F.sum(nodes.mailbox['eid'], 1)}
     g.update_all(fn.copy_e('eid', 'eid'), reducer)
 
+@parametrize_dtype
+def test_degree_bucket_mailbox(idtype):
+    import dgl.function as fn
+    g = dgl.rand_graph(100, 600, idtype=idtype, device=F.ctx())
+    src, dst = [F.asnumpy(x) for x in g.edges()]
+    g.edata['x'] = F.copy_to(F.randn((600, 2, 3)), F.ctx())
+    g.edata['mask'] = F.copy_to(F.tensor(np.random.rand(600) > 0.5), F.ctx())
+    x = F.asnumpy(g.edata['x'])
+    mask = F.asnumpy(g.edata['mask'])
+    def reducer(nodes):
+        # the messages of the in-edges of every node, by edge ID
+        assert F.dtype(nodes.mailbox['mask']) == F.dtype(g.edata['mask'])
+        for i, v in enumerate(F.asnumpy(nodes.nodes()).tolist()):
+            eids = np.nonzero(dst == v)[0]
+            assert np.allclose(F.asnumpy(nodes.mailbox['x'])[i], x[eids])
+            assert np.array_equal(F.asnumpy(nodes.mailbox['mask'])[i], mask[eids])
+        return {'y': F.sum(nodes.mailbox['x'], 1)}
+    g.update_all(lambda edges: {'x': edges.data['x'], 'mask': edges.data['mask']}, reducer)
+    g.update_all(fn.copy_e('x', 'x'), fn.sum('x', 'z'))
+    assert F.allclose(g.ndata['y'], g.ndata['z'])
+
 @parametrize_dtype
 def test_issue_2484(idtype):
     import dgl.function as fn
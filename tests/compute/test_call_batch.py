@@ -0,0 +1,28 @@
+import dgl
+import backend as F
+import pytest
+from dgl._ffi.function import BatchResult, call_batch
+
+def test_call_batch():
+    g = dgl.graph(([0, 1, 2], [1, 2, 3]), idtype=F.int64)
+    gidx = g._graph
+    calls = [
+        (dgl.heterograph_index._CAPI_DGLHeteroNumEdges, (gidx, 0)),
+        (dgl.heterograph_index._CAPI_DGLHeteroNumVertices, (gidx, 0)),
+    ]
+    assert call_batch(calls) == 4
+    assert call_batch([]) is None
+
+    # the in-degrees of the successors of node 0, without going back to Python
+    calls = [
+        (dgl.heterograph_index._CAPI_DGLHeteroSuccessors, (gidx, 0, 0)),
+        (dgl.heterograph_index._CAPI_DGLHeteroInDegrees, (gidx, 0, BatchResult(0))),
+    ]
+    assert call_batch(calls).asnumpy().tolist() == [1]
+
+    with pytest.raises(ValueError):
+        call_batch([(dgl.heterograph_index._CAPI_DGLHeteroNumEdges,
+                     (BatchResult(0), 0))])
+
+if __name__ == '__main__':
+    test_call_batch()
@@ -1,6 +1,7 @@
 import numpy as np
 import scipy.sparse as ssp
 import pytest
+import unittest
 import dgl
 from utils import parametrize_dtype
 import backend as F
@@ -39,6 +40,29 @@ def test_csrmm(idtype, dtype):
     c = F.tensor((a * b).todense(), dtype=dtype)
     assert F.allclose(C_adj, c)
 
+@unittest.skipIf(F._default_context_str == 'gpu', reason="GPU top-k product not implemented")
+@parametrize_dtype
+@pytest.mark.parametrize('dtype', [F.float32, F.float64])
+@pytest.mark.parametrize('k', [0, 1, 5])
+def test_csrmm_topk(idtype, dtype, k):
+    a, A = _random_simple_graph(idtype, dtype, F.ctx(), 50, 60, 900, 'A', 'B', 'AB')
+    b, B = _random_simple_graph(idtype, dtype, F.ctx(), 60, 70, 900, 'B', 'C', 'BC')
+    C = dgl.adj_product_graph(A, B, 'w', topk=k)
+    C_row, C_col = C.edges(order='eid')
+    C_row = F.asnumpy(C_row)
+    C_col = F.asnumpy(C_col)
+    C_weights = F.asnumpy(C.edata['w'])
+    c = (a * b).tocsr()
+    for i in range(50):
+        row = c.getrow(i)
+        # stable sort on the negated weights to break the ties by column
+        order = np.argsort(-row.data[np.argsort(row.indices)], kind='stable')[:k]
+        expected = np.sort(np.sort(row.indices)[order])
+        mask = C_row == i
+        assert np.array_equal(C_col[mask], expected)
+        assert np.allclose(C_weights[mask], row[0, expected].toarray().ravel(),
+                           rtol=1e-4, atol=1e-4)
+
 @parametrize_dtype
 @pytest.mark.parametrize('dtype', [F.float32, F.float64])
 @pytest.mark.parametrize('num_vtypes', [1, 2])
@@ -77,6 +101,39 @@ def test_csrmm_backward(idtype, dtype, num_vtypes):
         assert np.allclose(a_dense_grad, A_spspmm_grad, rtol=1e-4, atol=1e-4)
         assert np.allclose(b_dense_grad, B_spspmm_grad, rtol=1e-4, atol=1e-4)
 
+@parametrize_dtype
+@pytest.mark.parametrize('dtype', [F.float32, F.float64])
+@pytest.mark.parametrize('M_nnz', [9000, 0])
+def test_csrmaskedmm(idtype, dtype, M_nnz):
+    a, A = _random_simple_graph(idtype, dtype, F.ctx(), 500, 600, 9000, 'A', 'B', 'AB')
+    b, B = _random_simple_graph(idtype, dtype, F.ctx(), 600, 700, 9000, 'B', 'C', 'BC')
+    m, M = _random_simple_graph(idtype, dtype, F.ctx(), 500, 700, M_nnz, 'A', 'C', 'AC')
+    C = dgl.masked_adj_product(A, B, M, 'w')
+    M_row, M_col = M.edges(order='eid')
+    c = F.tensor((a * b).todense()[F.asnumpy(M_row), F.asnumpy(M_col)].A1, dtype)
+    assert F.allclose(C, c)
+
+@parametrize_dtype
+@pytest.mark.parametrize('dtype', [F.float32, F.float64])
+def test_csrmaskedmm_backward(idtype, dtype):
+    a, A = _random_simple_graph(idtype, dtype, F.ctx(), 3, 4, 6, 'A', 'B', 'AB')
+    b, B = _random_simple_graph(idtype, dtype, F.ctx(), 4, 3, 6, 'B', 'C', 'BC')
+    m, M = _random_simple_graph(idtype, dtype, F.ctx(), 3, 3, 6, 'A', 'C', 'AC')
+    A_row, A_col = A.edges(order='eid')
+    B_row, B_col = B.edges(order='eid')
+    m_dense = (m != 0).astype(np.float64).todense()
+    A.edata['w'] = F.attach_grad(A.edata['w'])
+    B.edata['w'] = F.attach_grad(B.edata['w'])
+
+    with F.record_grad():
+        C = dgl.masked_adj_product(A, B, M, 'w')
+        F.backward(F.reduce_sum(C))
+    # the gradient of the sum of the masked entries of the product
+    a_grad = np.asarray(m_dense @ b.todense().T)[F.asnumpy(A_row), F.asnumpy(A_col)]
+    b_grad = np.asarray(a.todense().T @ m_dense)[F.asnumpy(B_row), F.asnumpy(B_col)]
+    assert np.allclose(F.asnumpy(F.grad(A.edata['w'])), a_grad, rtol=1e-4, atol=1e-4)
+    assert np.allclose(F.asnumpy(F.grad(B.edata['w'])), b_grad, rtol=1e-4, atol=1e-4)
+
 @parametrize_dtype
 @pytest.mark.parametrize('dtype', [F.float32, F.float64])
 def test_csrsum(idtype, dtype):
@@ -192,6 +249,9 @@ def test_csrmask_backward(idtype, dtype):
 if __name__ == '__main__':
     test_csrmm(F.int32, F.float32)
     test_csrmm(F.int64, F.float32)
+    test_csrmm_topk(F.int32, F.float32, 5)
+    test_csrmaskedmm(F.int32, F.float32, 9000)
+    test_csrmaskedmm(F.int64, F.float32, 0)
     test_csrsum(F.int32, F.float32)
     test_csrsum(F.int64, F.float32)
     test_csrmask(F.int32, F.float32, 9000, 9000)
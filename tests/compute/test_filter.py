@@ -39,8 +39,6 @@ def test_graph_filter():
     e_idx = g.filter_edges(predicate, [0, 1])
     assert set(F.zerocopy_to_numpy(e_idx)) == {1}
 
-@unittest.skipIf(F._default_context_str == 'cpu',
-                 reason="CPU not yet supported")
 @parametrize_dtype
 def test_array_filter(idtype):
     f = Filter(F.copy_to(F.tensor([0,1,9,4,6,5,7], dtype=idtype), F.ctx()))
@@ -61,6 +59,16 @@ def test_array_filter(idtype):
     ye_exp = F.copy_to(F.tensor([1,3,4,6], dtype=idtype), F.ctx())
     assert F.array_equal(ye_act, ye_exp)
 
+    # sparse set
+    f = Filter(F.copy_to(F.tensor([1000000,3,5], dtype=idtype), F.ctx()))
+    z = F.copy_to(F.tensor([5,0,3,999999,1000000,7], dtype=idtype), F.ctx())
+    zi_act = f.find_included_indices(z)
+    zi_exp = F.copy_to(F.tensor([0,2,4], dtype=idtype), F.ctx())
+    assert F.array_equal(zi_act, zi_exp)
+    ze_act = f.find_excluded_indices(z)
+    ze_exp = F.copy_to(F.tensor([1,3,5], dtype=idtype), F.ctx())
+    assert F.array_equal(ze_act, ze_exp)
+
 if __name__ == '__main__':
     test_graph_filter()
     test_array_filter()
@@ -7,6 +7,7 @@ import dgl
 import backend as F
 from dgl import DGLError
 import pytest
+from test_utils import parametrize_dtype
 
 # graph generation: a random graph with 10 nodes
 #  and 20 edges.
@@ -409,7 +410,38 @@ def test_formats():
         fail = False
     finally:
         assert not fail
-    
+
+@parametrize_dtype
+def test_streaming_graph_builder(idtype):
+    num_nodes, num_edges = 1000, 20000
+    src = np.random.randint(0, num_nodes, num_edges)
+    dst = np.random.randint(0, num_nodes, num_edges)
+    # a small budget spills the edges to the temporary files
+    builder = dgl.StreamingGraphBuilder(num_nodes, idtype=idtype, memory_budget=1,
+                                        num_buckets=7)
+    for i in range(0, num_edges, 3000):
+        builder.add_edges(F.tensor(src[i:i + 3000]), F.tensor(dst[i:i + 3000]))
+    g = builder.build()
+    assert g.idtype == idtype
+    assert g.num_nodes() == num_nodes
+    assert g.num_edges() == num_edges
+    u, v = g.edges(order='eid')
+    assert np.array_equal(F.asnumpy(u), src)
+    assert np.array_equal(F.asnumpy(v), dst)
+    indptr, indices, eids = g.adj_sparse('csr')
+    for r in range(0, num_nodes, 97):
+        row = F.asnumpy(indices)[F.asnumpy(indptr)[r]:F.asnumpy(indptr)[r + 1]]
+        assert np.all(row[:-1] <= row[1:])
+
+    builder = dgl.StreamingGraphBuilder((3, 4), idtype=idtype)
+    builder.add_edges([0, 2], [3, 1])
+    g = builder.build()
+    assert g.num_nodes('_U') == 3
+    assert g.num_nodes('_V') == 4
+    u, v = g.edges(order='eid')
+    assert F.asnumpy(u).tolist() == [0, 2]
+    assert F.asnumpy(v).tolist() == [3, 1]
+
 if __name__ == '__main__':
     test_query()
     test_mutation()
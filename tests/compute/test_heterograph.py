@@ -206,6 +206,30 @@ def test_create(idtype):
         assert g.device == F.cpu()
         assert F.array_equal(g.edata['w'], F.copy_to(F.tensor(adj.data), F.cpu()))
 
+@parametrize_dtype
+def test_create_trusted(idtype):
+    src = F.tensor([0, 0, 1, 3], dtype=idtype)
+    dst = F.tensor([1, 2, 3, 0], dtype=idtype)
+    with pytest.raises(DGLError):
+        dgl.graph((src, dst), trusted=True)
+    # the node IDs are not checked, so the given number of nodes is kept
+    g = dgl.graph((src, dst), num_nodes=6, row_sorted=True, col_sorted=True, trusted=True)
+    ref = dgl.graph((src, dst), num_nodes=6)
+    assert g.num_nodes() == 6 and g.num_edges() == 4
+    for fmt in ['csr', 'csc']:
+        assert all(F.array_equal(a, b) for a, b in zip(g.adj_sparse(fmt), ref.adj_sparse(fmt)))
+    # unsorted edges flagged as such are converted like any others
+    src = F.tensor([3, 0, 1, 0], dtype=idtype)
+    dst = F.tensor([0, 2, 3, 1], dtype=idtype)
+    g = dgl.graph((src, dst), num_nodes=4, trusted=True)
+    ref = dgl.graph((src, dst), num_nodes=4)
+    assert F.array_equal(g.in_degrees(), ref.in_degrees())
+    assert F.array_equal(g.out_degrees(), ref.out_degrees())
+    # the indices of a sorted CSR
+    indptr, indices, _ = ref.adj_sparse('csr')
+    g = dgl.graph(('csr', (indptr, indices, [])), num_nodes=4, col_sorted=True, trusted=True)
+    assert F.array_equal(g.out_degrees(), ref.out_degrees())
+
 @parametrize_dtype
 def test_query(idtype):
     g = create_test_heterograph(idtype)
@@ -843,6 +867,14 @@ def test_flatten(idtype):
 
     check_mapping(g, fg)
 
+    # flattening the same edge types again gives the same graph
+    fg2 = g['user', :, 'game']
+    u1, v1 = fg.edges(order='eid')
+    u2, v2 = fg2.edges(order='eid')
+    assert F.array_equal(u1, u2)
+    assert F.array_equal(v1, v2)
+    assert F.array_equal(fg.edata[dgl.EID], fg2.edata[dgl.EID])
+
     fg = g['user', :, 'user']
     assert fg.idtype == g.idtype
     assert fg.device == g.device
@@ -1874,6 +1906,60 @@ def test_format(idtype):
         assert g.in_degrees(vid) == ind_arr[vid]
     assert F.array_equal(in_degrees, g.in_degrees())
 
+@parametrize_dtype
+def test_format_memory_budget(idtype):
+    g = dgl.graph(([0, 1, 0, 2], [0, 1, 1, 0]), idtype=idtype, device=F.ctx())
+    nbytes = 4 if idtype == F.int32 else 8
+    assert g.format_memory_usage() == 2 * 4 * nbytes
+    in_degrees = g.in_degrees()
+    out_degrees = g.out_degrees()
+    g.create_formats_()
+    assert len(g.formats()['created']) == 3
+
+    # only the most recently used format is kept
+    g.set_format_memory_budget_(0)
+    assert g.formats()['created'] == ['csc']
+    g.create_formats_()
+    assert g.formats()['created'] == ['csc']
+    assert F.array_equal(g.out_degrees(), out_degrees)
+    assert g.formats()['created'] == ['csr']
+    assert F.array_equal(g.in_degrees(), in_degrees)
+    assert g.formats()['created'] == ['csc']
+
+    # the least recently used format is dropped first
+    g.set_format_memory_budget_(2 * g.format_memory_usage())
+    g.out_degrees()
+    assert g.formats()['created'] == ['csr', 'csc']
+    g.in_degrees()
+    g.edges()
+    assert g.formats()['created'] == ['coo', 'csc']
+
+    g.set_format_memory_budget_(-1)
+    g.create_formats_()
+    assert len(g.formats()['created']) == 3
+
+@parametrize_dtype
+def test_add_edges_keep_formats(idtype):
+    g = dgl.graph(([0, 1, 0, 2], [0, 1, 1, 0]), idtype=idtype, device=F.ctx())
+    g.create_formats_()
+    g.add_edges([3, 1], [1, 4])
+    assert len(g.formats()['created']) == 3
+    assert g.num_nodes() == 5
+    u, v = g.edges(order='eid')
+    assert F.asnumpy(u).tolist() == [0, 1, 0, 2, 3, 1]
+    assert F.asnumpy(v).tolist() == [0, 1, 1, 0, 1, 4]
+    assert F.asnumpy(g.out_degrees()).tolist() == [2, 2, 1, 1, 0]
+    assert F.asnumpy(g.in_degrees()).tolist() == [2, 3, 0, 0, 1]
+    assert F.asnumpy(g.successors(1)).tolist() == [1, 4]
+    assert F.asnumpy(g.edge_ids([1, 3], [4, 1])).tolist() == [5, 4]
+
+    # the restricted formats are kept
+    g = dgl.graph(([0, 1], [1, 2]), idtype=idtype, device=F.ctx()).formats('csc')
+    g.add_edges([2], [0])
+    assert g.formats()['created'] == ['csc']
+    assert len(g.formats()['not created']) == 0
+    assert F.asnumpy(g.in_degrees()).tolist() == [1, 1, 1]
+
 @parametrize_dtype
 def test_edges_order(idtype):
     # (0, 2), (1, 2), (0, 1), (0, 1), (2, 1)
@@ -2374,6 +2460,26 @@ def test_remove_edges(idtype):
     assert F.array_equal(g.nodes['game'].data['h'], F.tensor([2, 2], dtype=idtype))
     assert F.array_equal(g.nodes['developer'].data['h'], F.tensor([3, 3], dtype=idtype))
 
+    # the created formats are kept, with the edges in the order of their ids
+    g = dgl.graph(([0, 2, 1, 2, 0], [1, 0, 2, 1, 2]), idtype=idtype, device=F.ctx())
+    g.create_formats_()
+    g.edata['h'] = F.copy_to(F.tensor([0, 1, 2, 3, 4], dtype=idtype), ctx=F.ctx())
+    g.remove_edges([1, 3])
+    assert sorted(g.formats()['created']) == ['coo', 'csc', 'csr']
+    u, v = g.edges(form='uv', order='eid')
+    assert F.array_equal(u, F.tensor([0, 1, 0], dtype=idtype))
+    assert F.array_equal(v, F.tensor([1, 2, 2], dtype=idtype))
+    assert F.array_equal(g.edata['h'], F.tensor([0, 2, 4], dtype=idtype))
+    u, v, e = g.in_edges(2, form='all')
+    assert F.array_equal(F.sort_1d(e)[0], F.tensor([1, 2], dtype=idtype))
+    u, v, e = g.out_edges(0, form='all')
+    assert F.array_equal(F.sort_1d(e)[0], F.tensor([0, 2], dtype=idtype))
+    g = dgl.graph(([0, 2, 1, 2, 0], [1, 0, 2, 1, 2]), idtype=idtype, device=F.ctx())
+    g = g.formats('csc')
+    g.remove_edges(0)
+    assert g.formats()['created'] == ['csc']
+    assert g.formats()['not created'] == []
+
 @parametrize_dtype
 def test_remove_nodes(idtype):
     # homogeneous Graphs
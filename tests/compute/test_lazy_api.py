@@ -0,0 +1,46 @@
+import sys
+import types
+import dgl
+import backend as F
+from dgl._ffi import function
+from dgl._ffi.base import startup_phases
+
+def _make_module(name):
+    module = types.ModuleType(name)
+    sys.modules[name] = module
+    return module
+
+def test_lazy_api():
+    module = _make_module("dgl._test_lazy_api")
+    function._init_api_prefix("dgl._test_lazy_api", "heterograph_index")
+    f = module._CAPI_DGLHeteroNumEdges
+    if function._LAZY_API:
+        assert isinstance(f, function.LazyFunction)
+    assert f.__name__ == "_CAPI_DGLHeteroNumEdges"
+
+    g = dgl.graph(([0, 1, 2], [1, 2, 3]), idtype=F.int64)
+    assert f(g._graph, 0) == 3
+    # looked up on the first call, and replaced in the module
+    assert isinstance(module._CAPI_DGLHeteroNumEdges, function.Function)
+    assert f(g._graph, 0) == 3
+    del sys.modules["dgl._test_lazy_api"]
+
+def test_lazy_api_register():
+    @dgl.register_func("test_lazy_api.add_one")
+    def add_one(x):
+        return x + 1
+
+    module = _make_module("dgl._test_lazy_api_register")
+    function._init_api_prefix("dgl._test_lazy_api_register", "test_lazy_api")
+    assert module.add_one(1) == 2
+    del sys.modules["dgl._test_lazy_api_register"]
+
+def test_startup_phases():
+    phases = startup_phases()
+    assert phases["load_library"] >= 0
+    assert phases["init_api"] >= 0
+
+if __name__ == '__main__':
+    test_lazy_api()
+    test_lazy_api_register()
+    test_startup_phases()
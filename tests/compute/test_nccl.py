@@ -82,6 +82,41 @@ def test_nccl_sparse_pull_single_range():
     exp_rv = F.gather_row(value, req_index)
     assert F.array_equal(rv, exp_rv)
 
+@unittest.skipIf(F._default_context_str == 'cpu', reason="NCCL only runs on GPU.")
+def test_nccl_sparse_single_local_size():
+    nccl_id = nccl.UniqueId()
+    # a single machine is not hierarchical
+    comm = nccl.Communicator(1, 0, nccl_id, local_size=1)
+    assert comm.local_size() == 1
+
+    req_index = F.randint([10000], F.int64, F.ctx(), 0, 100000)
+    value = F.uniform([100000, 100], F.float32, F.ctx(), -1.0, 1.0)
+
+    part = NDArrayPartition(100000, 1, 'remainder')
+
+    rv = comm.sparse_all_to_all_pull(req_index, value, part)
+    exp_rv = F.gather_row(value, req_index)
+    assert F.array_equal(rv, exp_rv)
+
+@unittest.skipIf(F._default_context_str == 'cpu', reason="NCCL only runs on GPU.")
+def test_nccl_sparse_pull_single_fixed():
+    nccl_id = nccl.UniqueId()
+    comm = nccl.Communicator(1, 0, nccl_id)
+
+    req_index = F.randint([10000], F.int64, F.ctx(), 0, 100000)
+    value = F.uniform([100000, 100], F.float32, F.ctx(), -1.0, 1.0)
+
+    part = NDArrayPartition(100000, 1, 'remainder')
+
+    rv = comm.sparse_all_to_all_pull(req_index, value, part,
+                                     max_num_requests=12000)
+    exp_rv = F.gather_row(value, req_index)
+    assert F.array_equal(rv, exp_rv)
+
+    rv = comm.sparse_all_to_all_pull(req_index, value, part,
+                                     max_num_requests=10000, compress=True)
+    assert F.allclose(rv, exp_rv, rtol=1e-3, atol=1e-3)
+
 
 if __name__ == '__main__':
     test_nccl_id()
@@ -47,3 +47,29 @@ def test_get_node_partition_from_book(idtype):
     exp_ids = F.copy_to(F.tensor([6, 7, 10], dtype=idtype), F.ctx())
     assert F.array_equal(act_ids, exp_ids)
  
+
+@unittest.skipIf(F._default_context_str == 'cpu', reason="NDArrayPartition only works on GPU.")
+@parametrize_dtype
+def test_lookup_partition(idtype):
+    part_map = F.copy_to(F.tensor([2, 0, 1, 0, 2, 2, 1], dtype=idtype), F.ctx())
+    partition = NDArrayPartition(7, 3, mode='lookup', part_map=part_map)
+    assert partition.num_parts() == 3
+    assert partition.array_size() == 7
+    assert partition.local_size(0) == 2
+    assert partition.local_size(1) == 2
+    assert partition.local_size(2) == 3
+
+    test_ids = F.copy_to(F.tensor([0, 1, 3, 5, 6], dtype=idtype), F.ctx())
+    act_ids = partition.map_to_local(test_ids)
+    exp_ids = F.copy_to(F.tensor([0, 0, 1, 2, 1], dtype=idtype), F.ctx())
+    assert F.array_equal(act_ids, exp_ids)
+
+    test_ids = F.copy_to(F.tensor([0, 1, 2], dtype=idtype), F.ctx())
+    act_ids = partition.map_to_global(test_ids, 2)
+    exp_ids = F.copy_to(F.tensor([0, 4, 5], dtype=idtype), F.ctx())
+    assert F.array_equal(act_ids, exp_ids)
+
+    test_ids = F.copy_to(F.tensor([1, 0], dtype=idtype), F.ctx())
+    act_ids = partition.map_to_global(test_ids, 1)
+    exp_ids = F.copy_to(F.tensor([6, 2], dtype=idtype), F.ctx())
+    assert F.array_equal(act_ids, exp_ids)
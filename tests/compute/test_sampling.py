@@ -113,6 +113,130 @@ def test_random_walk():
     check_random_walk(g4, metapath, traces[:, :7], ntypes[:7], 'p', trace_eids=eids)
     assert (F.asnumpy(traces[:, 7]) == -1).all()
 
+@unittest.skipIf(F._default_context_str == 'gpu', reason="GPU pack traces not implemented")
+def test_random_walk_batches():
+    g4 = dgl.heterograph({
+        ('user', 'follow', 'user'): ([0, 1, 1, 2, 3], [1, 2, 3, 0, 0]),
+        ('user', 'view', 'item'): ([0, 0, 1, 2, 3, 3], [0, 1, 1, 2, 2, 1]),
+        ('item', 'viewed-by', 'user'): ([0, 1, 1, 2, 2, 1], [0, 0, 1, 2, 3, 3])})
+    g4.edges['follow'].data['p'] = F.tensor([3, 0, 3, 3, 3], dtype=F.float32)
+    metapath = ['follow', 'view', 'viewed-by'] * 2
+    nodes = F.tensor([0, 1, 2, 3, 0, 1, 2], dtype=g4.idtype)
+
+    num_traces = 0
+    for traces, eids, ntypes in dgl.sampling.random_walk_batches(
+            g4, nodes, 3, metapath=metapath, prob='p'):
+        assert F.shape(traces)[0] <= 3
+        check_random_walk(g4, metapath, traces, ntypes, 'p', trace_eids=eids)
+        num_traces += F.shape(traces)[0]
+    assert num_traces == 7
+
+    num_traces = 0
+    for vids, eids, ntypes, lengths, offsets in dgl.sampling.random_walk_batches(
+            g4, nodes, 3, metapath=metapath, restart_prob=0.5, pack=True):
+        vids, eids, ntypes = F.asnumpy(vids), F.asnumpy(eids), F.asnumpy(ntypes)
+        lengths, offsets = F.asnumpy(lengths), F.asnumpy(offsets)
+        assert len(vids) == len(ntypes) == lengths.sum()
+        assert len(eids) == len(vids) - len(lengths)
+        for i, (length, offset) in enumerate(zip(lengths, offsets)):
+            assert F.asnumpy(nodes)[num_traces + i] == vids[offset]
+            for j in range(length - 1):
+                etype = metapath[j]
+                u, v = g4.find_edges(int(eids[offset - i + j]), etype=etype)
+                assert F.asnumpy(u)[0] == vids[offset + j]
+                assert F.asnumpy(v)[0] == vids[offset + j + 1]
+                assert ntypes[offset + j + 1] == g4.get_ntype_id(g4.to_canonical_etype(etype)[2])
+        num_traces += len(lengths)
+    assert num_traces == 7
+
+@unittest.skipIf(F._default_context_str == 'gpu', reason="GPU random walk not implemented")
+def test_random_walk_alias_tables():
+    g4 = dgl.heterograph({
+        ('user', 'follow', 'user'): ([0, 1, 1, 2, 3], [1, 2, 3, 0, 0]),
+        ('user', 'view', 'item'): ([0, 0, 1, 2, 3, 3], [0, 1, 1, 2, 2, 1]),
+        ('item', 'viewed-by', 'user'): ([0, 1, 1, 2, 2, 1], [0, 0, 1, 2, 3, 3])})
+    g4.edges['follow'].data['p'] = F.tensor([3, 0, 3, 3, 3], dtype=F.float32)
+    g4.edges['viewed-by'].data['p'] = F.tensor([1, 1, 1, 0, 1, 0], dtype=F.float32)
+    metapath = ['follow', 'view', 'viewed-by'] * 2
+    dgl.sampling.build_alias_tables(g4, 'p', edge_dir='out')
+    assert 'p_alias_out' not in g4.edges['view'].data
+    traces, eids, ntypes = dgl.sampling.random_walk(
+        g4, [0, 1, 2, 3, 0, 1, 2], metapath=metapath, prob='p', return_eids=True)
+    check_random_walk(g4, metapath, traces, ntypes, 'p', trace_eids=eids)
+
+    # the alias tables draw the steps with the transition probabilities
+    g = dgl.graph(([0, 0, 0, 0, 1], [1, 2, 3, 4, 0]))
+    g.edata['p'] = F.tensor([1, 2, 0, 5, 0], dtype=F.float32)
+    dgl.sampling.build_alias_tables(g, 'p', edge_dir='out')
+    traces, _ = dgl.sampling.random_walk(
+        g, F.zeros((8000,), dtype=g.idtype), length=1, prob='p')
+    counts = np.bincount(F.asnumpy(traces)[:, 1], minlength=5)
+    assert counts[3] == 0
+    assert np.allclose(counts[[1, 2, 4]] / 8000, [1 / 8, 2 / 8, 5 / 8], atol=0.03)
+    # a node whose outbound edges have no weight ends the walk
+    traces, _ = dgl.sampling.random_walk(g, [1, 1], length=1, prob='p')
+    assert F.array_equal(traces, F.tensor([[1, -1], [1, -1]], dtype=g.idtype))
+
+@unittest.skipIf(F._default_context_str == 'gpu', reason="GPU random walk not implemented")
+def test_random_walk_seed():
+    g = dgl.rand_graph(100, 1000)
+    g.edata['p'] = F.tensor(np.random.rand(1000), dtype=F.float32)
+    nodes = F.tensor(np.random.randint(0, 100, 500), dtype=g.idtype)
+
+    traces, eids, _ = dgl.sampling.random_walk(
+        g, nodes, length=10, prob='p', restart_prob=0.1, return_eids=True, random_seed=42)
+    # the same walks whatever the number of threads
+    dgl.utils.set_num_threads(1)
+    traces1, eids1, _ = dgl.sampling.random_walk(
+        g, nodes, length=10, prob='p', restart_prob=0.1, return_eids=True, random_seed=42)
+    assert F.array_equal(traces, traces1)
+    assert F.array_equal(eids, eids1)
+    dgl.utils.set_num_threads(4)
+    traces2, _ = dgl.sampling.random_walk(
+        g, nodes, length=10, prob='p', restart_prob=0.1, random_seed=42)
+    assert F.array_equal(traces, traces2)
+    # the walk from a starting node only depends on its index
+    traces3, _ = dgl.sampling.random_walk(
+        g, F.slice_axis(nodes, 0, 0, 100), length=10, prob='p', restart_prob=0.1,
+        random_seed=42)
+    assert F.array_equal(F.slice_axis(traces, 0, 0, 100), traces3)
+    traces4, _ = dgl.sampling.random_walk(
+        g, nodes, length=10, prob='p', restart_prob=0.1, random_seed=43)
+    assert not F.array_equal(traces, traces4)
+
+    traces = dgl.sampling.node2vec_random_walk(g, nodes, 0.5, 2, 10, random_seed=42)
+    dgl.utils.set_num_threads(1)
+    traces1 = dgl.sampling.node2vec_random_walk(g, nodes, 0.5, 2, 10, random_seed=42)
+    assert F.array_equal(traces, traces1)
+
+@unittest.skipIf(F._default_context_str == 'gpu', reason="GPU random walk not implemented")
+def test_temporal_random_walk():
+    g = dgl.graph(([0, 1, 2, 1], [1, 2, 0, 0]))
+    g.edata['t'] = F.tensor([3, 2, 1, 5], dtype=F.int64)
+    traces, eids, _ = dgl.sampling.temporal_random_walk(
+        g, [0, 1], F.tensor([4, 6], dtype=F.int64), 't', length=4, return_eids=True)
+    # every step goes strictly back in time, and stops when it cannot
+    assert F.array_equal(traces[0], F.tensor([0, 1, 2, 0, -1], dtype=g.idtype))
+    assert F.array_equal(eids[0], F.tensor([0, 1, 2, -1], dtype=g.idtype))
+
+    g = dgl.rand_graph(100, 2000)
+    g.edata['t'] = F.tensor(np.random.rand(2000), dtype=F.float32)
+    dgl.sampling.build_topk_order(g, 't', edge_dir='out', ascending=True)
+    nodes = F.tensor(np.random.randint(0, 100, 200), dtype=g.idtype)
+    seed_time = F.ones((200,), dtype=F.float32)
+    traces, eids, _ = dgl.sampling.temporal_random_walk(
+        g, nodes, seed_time, 't', length=10, return_eids=True, random_seed=42)
+    t = F.asnumpy(g.edata['t'])
+    for trace, eid in zip(F.asnumpy(traces), F.asnumpy(eids)):
+        eid = eid[eid >= 0]
+        src, dst = g.find_edges(F.tensor(eid, dtype=g.idtype))
+        assert np.array_equal(F.asnumpy(src), trace[:len(eid)])
+        assert np.array_equal(F.asnumpy(dst), trace[1:len(eid) + 1])
+        assert np.all(np.diff(t[eid]) < 0)
+    traces1, _ = dgl.sampling.temporal_random_walk(
+        g, nodes, seed_time, 't', length=10, random_seed=42)
+    assert F.array_equal(traces, traces1)
+
 @unittest.skipIf(F._default_context_str == 'gpu', reason="GPU random walk not implemented")
 def test_node2vec():
     g1 = dgl.heterograph({
@@ -132,6 +256,17 @@ def test_node2vec():
         g2, [0, 1, 2, 3, 0, 1, 2, 3], 1, 1, 4, prob='p', return_eids=True)
     check_random_walk(g2, ['follow'] * 4, traces, ntypes, 'p', trace_eids=eids)
 
+    neighbor_filter = dgl.sampling.node2vec_neighbor_filter(g2)
+    assert F.shape(neighbor_filter) == (g2.num_edges(),)
+    traces, eids = dgl.sampling.node2vec_random_walk(
+        g2, [0, 1, 2, 3, 0, 1, 2, 3], 0.5, 0.25, 4, return_eids=True,
+        neighbor_filter=neighbor_filter)
+    check_random_walk(g2, ['follow'] * 4, traces, ntypes, trace_eids=eids)
+    traces, eids = dgl.sampling.node2vec_random_walk(
+        g2, [0, 1, 2, 3, 0, 1, 2, 3], 0.5, 0.25, 4, prob='p', return_eids=True,
+        neighbor_filter=neighbor_filter)
+    check_random_walk(g2, ['follow'] * 4, traces, ntypes, 'p', trace_eids=eids)
+
 @unittest.skipIf(F._default_context_str == 'gpu', reason="GPU pack traces not implemented")
 def test_pack_traces():
     traces, types = (np.array(
@@ -436,8 +571,11 @@ def _test_sample_neighbors_outedge(hypersparse):
     _test3('prob', True)   # w/ replacement
     _test3('prob', False)  # w/o replacement
 
-def _test_sample_neighbors_topk(hypersparse):
+def _test_sample_neighbors_topk(hypersparse, order=False):
     g, hg = _gen_neighbor_topk_test_graph(hypersparse, False)
+    if order:
+        dgl.sampling.build_topk_order(g, 'weight')
+        dgl.sampling.build_topk_order(hg, 'weight')
 
     def _test1():
         subg = dgl.sampling.select_topk(g, -1, 'weight', [0, 1])
@@ -504,8 +642,11 @@ def _test_sample_neighbors_topk(hypersparse):
     assert subg['liked-by'].number_of_edges() == 0
     assert subg['flips'].number_of_edges() == 4
 
-def _test_sample_neighbors_topk_outedge(hypersparse):
+def _test_sample_neighbors_topk_outedge(hypersparse, order=False):
     g, hg = _gen_neighbor_topk_test_graph(hypersparse, True)
+    if order:
+        dgl.sampling.build_topk_order(g, 'weight', edge_dir='out')
+        dgl.sampling.build_topk_order(hg, 'weight', edge_dir='out')
 
     def _test1():
         subg = dgl.sampling.select_topk(g, -1, 'weight', [0, 1], edge_dir='out')
@@ -566,11 +707,279 @@ def test_sample_neighbors_noprob():
     _test_sample_neighbors(False, None)
     #_test_sample_neighbors(True)
 
-@unittest.skipIf(F._default_context_str == 'gpu', reason="GPU sample neighbors with probability is not implemented")
 def test_sample_neighbors_prob():
     _test_sample_neighbors(False, 'prob')
     #_test_sample_neighbors(True)
 
+@unittest.skipIf(F._default_context_str == 'gpu', reason="GPU sampling differs from CPU")
+@pytest.mark.parametrize('idtype', [F.int32, F.int64])
+@pytest.mark.parametrize('replace', [False, True])
+def test_sample_neighbors_random_seed(idtype, replace):
+    g = dgl.graph((np.random.randint(0, 100, 2000), np.random.randint(0, 100, 2000)),
+                  num_nodes=100, idtype=idtype)
+    def sampled_edges(nodes, random_seed):
+        subg = dgl.sampling.sample_neighbors(
+            g, F.tensor(nodes, dtype=idtype), 5, replace=replace, random_seed=random_seed)
+        edges = {}
+        for v, eid in zip(F.asnumpy(subg.edges()[1]), F.asnumpy(subg.edata[dgl.EID])):
+            edges.setdefault(v, []).append(eid)
+        return edges
+    all_nodes = np.arange(100)
+    some_nodes = np.arange(99, 0, -7)
+    edges = sampled_edges(all_nodes, 42)
+    assert edges == sampled_edges(all_nodes, 42)
+    # the edges of a node do not depend on the other nodes sampled
+    some_edges = sampled_edges(some_nodes, 42)
+    for v, eids in some_edges.items():
+        assert eids == edges[v]
+    assert edges != sampled_edges(all_nodes, 43)
+
+@unittest.skipIf(F._default_context_str == 'gpu', reason="GPU sample neighbors with probability is not implemented")
+def test_sample_neighbors_alias():
+    g, _ = _gen_neighbor_sampling_test_graph(False, False)
+    dgl.sampling.build_alias_tables(g, 'prob')
+    assert 'prob_alias_accept_in' in g.edata
+    assert 'prob_alias_in' in g.edata
+    for replace in [True, False]:
+        for i in range(10):
+            subg = dgl.sampling.sample_neighbors(g, [0, 1], 2, prob='prob', replace=replace)
+            assert subg.number_of_edges() == 4
+            u, v = subg.edges()
+            assert F.array_equal(g.edge_ids(u, v), subg.edata[dgl.EID])
+            edge_set = set(zip(list(F.asnumpy(u)), list(F.asnumpy(v))))
+            if not replace:
+                # check no duplication
+                assert len(edge_set) == 4
+            assert not (3, 0) in edge_set
+            assert not (3, 1) in edge_set
+
+@unittest.skipIf(F._default_context_str == 'gpu', reason="GPU sample neighbors not implemented")
+@pytest.mark.parametrize('idtype', [F.int32, F.int64])
+def test_sample_neighbor_blocks(idtype):
+    g = dgl.heterograph({
+        ('user', 'follow', 'user'): (np.random.randint(0, 50, 300), np.random.randint(0, 50, 300)),
+        ('user', 'play', 'game'): (np.random.randint(0, 50, 200), np.random.randint(0, 20, 200)),
+        ('game', 'played-by', 'user'): (np.random.randint(0, 20, 200), np.random.randint(0, 50, 200))},
+        idtype=idtype)
+    g.nodes['user'].data['h'] = F.randn((50, 2))
+    fanouts = [{'follow': 3, 'play': 2, 'played-by': 0}, 2, -1]
+    seeds = {'user': F.tensor([3, 1, 4, 1], dtype=idtype), 'game': F.tensor([5], dtype=idtype)}
+    for replace in [False, True]:
+        blocks = dgl.sampling.sample_neighbor_blocks(g, seeds, fanouts, replace=replace)
+        assert len(blocks) == 3
+        assert F.array_equal(blocks[-1].dstnodes['user'].data[dgl.NID],
+                             F.tensor([3, 1, 4], dtype=idtype))
+        for layer, block in enumerate(blocks):
+            assert block.is_block
+            for ntype in g.ntypes:
+                src = block.srcnodes[ntype].data[dgl.NID]
+                dst = block.dstnodes[ntype].data[dgl.NID]
+                assert F.array_equal(src[:block.number_of_dst_nodes(ntype)], dst)
+                if layer + 1 < len(blocks):
+                    assert F.array_equal(dst, blocks[layer + 1].srcnodes[ntype].data[dgl.NID])
+            assert F.array_equal(block.srcnodes['user'].data['h'],
+                                 F.gather_row(g.nodes['user'].data['h'],
+                                              F.astype(block.srcnodes['user'].data[dgl.NID],
+                                                       F.int64)))
+            for etype in g.canonical_etypes:
+                fanout = fanouts[layer]
+                fanout = fanout[etype[1]] if isinstance(fanout, dict) else fanout
+                u, v = block.edges(etype=etype)
+                if fanout == 0:
+                    assert len(u) == 0
+                    continue
+                eid = block.edges[etype].data[dgl.EID]
+                orig_u = F.gather_row(block.srcnodes[etype[0]].data[dgl.NID], F.astype(u, F.int64))
+                orig_v = F.gather_row(block.dstnodes[etype[2]].data[dgl.NID], F.astype(v, F.int64))
+                gu, gv = g.find_edges(eid, etype=etype)
+                assert F.array_equal(orig_u, gu)
+                assert F.array_equal(orig_v, gv)
+                in_degs = F.asnumpy(block.in_degrees(etype=etype))
+                if fanout == -1:
+                    assert np.array_equal(in_degs, F.asnumpy(g.in_degrees(
+                        block.dstnodes[etype[2]].data[dgl.NID], etype=etype)))
+                else:
+                    assert np.all(in_degs <= fanout)
+                    if not replace:
+                        assert len(set(F.asnumpy(eid))) == len(eid)
+
+@pytest.mark.parametrize('idtype', [F.int32, F.int64])
+@pytest.mark.parametrize('num_workers', [1, 3])
+def test_minibatch_pipeline(idtype, num_workers):
+    g = dgl.graph((np.random.randint(0, 100, 1000), np.random.randint(0, 100, 1000)),
+                  num_nodes=100, idtype=idtype).to(F.ctx())
+    feats = F.copy_to(F.randn((100, 8)), F.ctx())
+    seeds = [F.copy_to(F.tensor(np.random.permutation(100)[:10], dtype=idtype), F.ctx())
+             for _ in range(5)]
+    num_buffers = num_workers + 1
+    pipeline = dgl.dataloading.MinibatchPipeline(
+        g, [5, 3], features=feats, num_buffers=num_buffers, num_workers=num_workers)
+    for i in range(num_buffers - 1):
+        pipeline.submit(seeds[i])
+    for i in range(len(seeds)):
+        if i + num_buffers - 1 < len(seeds):
+            pipeline.submit(seeds[i + num_buffers - 1])
+        blocks, input_feats = pipeline.fetch()
+        assert len(blocks) == 2
+        assert F.array_equal(blocks[1].dstdata[dgl.NID], seeds[i])
+        for layer, block in enumerate(blocks):
+            src = block.srcdata[dgl.NID]
+            dst = block.dstdata[dgl.NID]
+            assert F.array_equal(src[:block.num_dst_nodes()], dst)
+            if layer + 1 < len(blocks):
+                assert F.array_equal(dst, blocks[layer + 1].srcdata[dgl.NID])
+            u, v = block.edges()
+            orig_u = F.gather_row(src, F.astype(u, F.int64))
+            orig_v = F.gather_row(dst, F.astype(v, F.int64))
+            gu, gv = g.find_edges(block.edata[dgl.EID])
+            assert F.array_equal(orig_u, gu)
+            assert F.array_equal(orig_v, gv)
+            assert np.all(F.asnumpy(block.in_degrees()) <= [5, 3][layer])
+        assert F.allclose(input_feats,
+                          F.gather_row(feats, F.astype(blocks[0].srcdata[dgl.NID], F.int64)))
+
+@unittest.skipIf(F._default_context_str == 'gpu', reason="GPU sample neighbors not implemented")
+@pytest.mark.parametrize('idtype', [F.int32, F.int64])
+@pytest.mark.parametrize('importance', ['ladies', 'fastgcn'])
+def test_sample_layer_blocks(idtype, importance):
+    g = dgl.graph((np.random.randint(0, 100, 1000), np.random.randint(0, 100, 1000)),
+                  num_nodes=100, idtype=idtype)
+    g.edata['a'] = F.tensor(np.random.rand(1000) + 0.5, dtype=F.float32)
+    seeds = F.tensor([1, 2, 3, 2], dtype=idtype)
+    for weight in [None, 'a']:
+        for replace in [False, True]:
+            blocks = dgl.sampling.sample_layer_blocks(
+                g, seeds, [10, 5], weight=weight, importance=importance, replace=replace)
+            assert len(blocks) == 2
+            assert F.array_equal(blocks[1].dstdata[dgl.NID], F.tensor([1, 2, 3], dtype=idtype))
+            for layer, block in enumerate(blocks):
+                src = block.srcdata[dgl.NID]
+                dst = block.dstdata[dgl.NID]
+                assert F.array_equal(src[:block.num_dst_nodes()], dst)
+                if layer == 0:
+                    assert F.array_equal(dst, blocks[1].srcdata[dgl.NID])
+                # the drawn nodes come after the output nodes
+                assert block.num_src_nodes() - block.num_dst_nodes() <= [10, 5][layer]
+                u, v = block.edges()
+                gu, gv = g.find_edges(block.edata[dgl.EID])
+                assert F.array_equal(F.gather_row(src, F.astype(u, F.int64)), gu)
+                assert F.array_equal(F.gather_row(dst, F.astype(v, F.int64)), gv)
+                # the weights are normalized over the in-edges of every node
+                w = F.asnumpy(block.edata['w'])
+                v = F.asnumpy(v)
+                for i in np.unique(v):
+                    assert np.allclose(w[v == i].sum(), 1)
+
+@unittest.skipIf(F._default_context_str == 'gpu', reason="GPU sample neighbors not implemented")
+@pytest.mark.parametrize('idtype', [F.int32, F.int64])
+def test_sample_neighbors_temporal(idtype):
+    g = dgl.graph((np.random.randint(0, 50, 1000), np.random.randint(0, 50, 1000)),
+                  num_nodes=50, idtype=idtype)
+    g.edata['t'] = F.tensor(np.random.randint(0, 100, 1000), dtype=F.int64)
+    t = F.asnumpy(g.edata['t'])
+    seeds = F.tensor([0, 3, 5, 7], dtype=idtype)
+    seed_time = F.tensor([10, 50, 0, 100], dtype=F.int64)
+    for build_order in [False, True]:
+        if build_order:
+            dgl.sampling.build_topk_order(g, 't', ascending=True)
+        # all the eligible edges
+        sg = dgl.sampling.sample_neighbors_temporal(g, seeds, -1, 't', seed_time)
+        _, v, eid = sg.edges(form='all')
+        for seed, time in zip(F.asnumpy(seeds), F.asnumpy(seed_time)):
+            in_eids = F.asnumpy(g.in_edges(seed, form='eid'))
+            expected = np.sort(in_eids[t[in_eids] < time])
+            got = np.sort(F.asnumpy(sg.edata[dgl.EID])[F.asnumpy(v) == seed])
+            assert np.array_equal(expected, got)
+        for replace in [False, True]:
+            sg = dgl.sampling.sample_neighbors_temporal(
+                g, seeds, 3, 't', seed_time, replace=replace)
+            _, v = sg.edges()
+            v = F.asnumpy(v)
+            eid = F.asnumpy(sg.edata[dgl.EID])
+            for seed, time in zip(F.asnumpy(seeds), F.asnumpy(seed_time)):
+                picked = eid[v == seed]
+                assert np.all(t[picked] < time)
+                in_eids = F.asnumpy(g.in_edges(seed, form='eid'))
+                if replace and np.any(t[in_eids] < time):
+                    assert len(picked) == 3
+                else:
+                    assert len(picked) <= 3
+                if not replace:
+                    assert len(set(picked)) == len(picked)
+    # the nodes without eligible edges get none
+    sg = dgl.sampling.sample_neighbors_temporal(
+        g, seeds, 3, 't', F.zeros((4,), dtype=F.int64), replace=True)
+    assert sg.num_edges() == 0
+
+@pytest.mark.parametrize('idtype', [F.int32, F.int64])
+def test_sample_neighbors_mask(idtype):
+    g = dgl.graph((np.random.randint(0, 50, 1000), np.random.randint(0, 50, 1000)),
+                  num_nodes=50, idtype=idtype)
+    g = g.to(F.ctx())
+    mask = np.random.rand(1000) < 0.3
+    g.edata['mask'] = F.copy_to(F.tensor(mask), F.ctx())
+    g.edata['prob'] = F.copy_to(F.tensor(np.random.rand(1000), dtype=F.float32), F.ctx())
+    seeds = F.copy_to(F.tensor([0, 3, 5, 7], dtype=idtype), F.ctx())
+    # all the edges left by the mask
+    sg = dgl.sampling.sample_neighbors(g, seeds, -1, mask='mask')
+    _, v = sg.edges()
+    v = F.asnumpy(v)
+    for seed in F.asnumpy(seeds):
+        in_eids = F.asnumpy(g.in_edges(int(seed), form='eid'))
+        expected = np.sort(in_eids[mask[in_eids]])
+        got = np.sort(F.asnumpy(sg.edata[dgl.EID])[v == seed])
+        assert np.array_equal(expected, got)
+    for prob in [None, 'prob']:
+        for replace in [False, True]:
+            sg = dgl.sampling.sample_neighbors(
+                g, seeds, 3, prob=prob, replace=replace, mask='mask')
+            _, v = sg.edges()
+            v = F.asnumpy(v)
+            eid = F.asnumpy(sg.edata[dgl.EID])
+            assert np.all(mask[eid])
+            for seed in F.asnumpy(seeds):
+                picked = eid[v == seed]
+                in_eids = F.asnumpy(g.in_edges(int(seed), form='eid'))
+                num_left = mask[in_eids].sum()
+                if replace:
+                    assert len(picked) == (3 if num_left > 0 else 0)
+                else:
+                    assert len(picked) == min(3, num_left)
+                    assert len(set(picked)) == len(picked)
+
+@unittest.skipIf(F._default_context_str != 'gpu', reason="Pinned graphs are sampled on the GPU")
+@pytest.mark.parametrize('idtype', [F.int32, F.int64])
+@pytest.mark.parametrize('cache_indptr', [False, True])
+def test_sample_neighbors_pinned(idtype, cache_indptr):
+    g = dgl.graph((np.random.randint(0, 50, 1000), np.random.randint(0, 50, 1000)),
+                  num_nodes=50, idtype=idtype)
+    g.create_formats_()
+    assert not g.is_pinned()
+    g.pin_memory_(F.ctx(), cache_indptr=cache_indptr)
+    assert g.is_pinned()
+    seeds = F.copy_to(F.tensor([0, 3, 5, 7], dtype=idtype), F.ctx())
+    for edge_dir in ['in', 'out']:
+        for replace in [False, True]:
+            sg = dgl.sampling.sample_neighbors(g, seeds, 3, edge_dir=edge_dir, replace=replace)
+            assert sg.device == F.ctx()
+            u, v = sg.edges()
+            u, v = F.asnumpy(u), F.asnumpy(v)
+            eid = F.asnumpy(sg.edata[dgl.EID])
+            src, dst = g.find_edges(F.tensor(eid, dtype=idtype))
+            assert np.array_equal(F.asnumpy(src), u)
+            assert np.array_equal(F.asnumpy(dst), v)
+            for seed in F.asnumpy(seeds):
+                picked = eid[(v if edge_dir == 'in' else u) == seed]
+                degree = int(g.in_degrees(int(seed)) if edge_dir == 'in'
+                             else g.out_degrees(int(seed)))
+                if replace:
+                    assert len(picked) == (3 if degree > 0 else 0)
+                else:
+                    assert len(picked) == min(3, degree)
+                    assert len(set(picked)) == len(picked)
+    g.unpin_memory_()
+    assert not g.is_pinned()
+
 @unittest.skipIf(F._default_context_str == 'gpu', reason="GPU sample neighbors not implemented")
 def test_sample_neighbors_outedge():
     _test_sample_neighbors_outedge(False)
@@ -579,11 +988,13 @@ def test_sample_neighbors_outedge():
 @unittest.skipIf(F._default_context_str == 'gpu', reason="GPU sample neighbors not implemented")
 def test_sample_neighbors_topk():
     _test_sample_neighbors_topk(False)
+    _test_sample_neighbors_topk(False, order=True)
     #_test_sample_neighbors_topk(True)
 
 @unittest.skipIf(F._default_context_str == 'gpu', reason="GPU sample neighbors not implemented")
 def test_sample_neighbors_topk_outedge():
     _test_sample_neighbors_topk_outedge(False)
+    _test_sample_neighbors_topk_outedge(False, order=True)
     #_test_sample_neighbors_topk_outedge(True)
 
 @unittest.skipIf(F._default_context_str == 'gpu', reason="GPU sample neighbors not implemented")
@@ -890,6 +1301,48 @@ def test_sample_neighbors_exclude_edges_homoG(dtype):
 
     assert not np.any(F.asnumpy(sg.has_edges_between(excluded_nodes_U,excluded_nodes_V)))
 
+@pytest.mark.parametrize('dtype', ['int32', 'int64'])
+@pytest.mark.parametrize('corrupt', ['head', 'tail'])
+def test_corrupt_edges(dtype, corrupt):
+    g = dgl.heterograph({
+        ('user', 'follow', 'user'): ([0, 0, 0, 1, 2, 3], [1, 2, 3, 0, 0, 0]),
+        ('user', 'play', 'game'): ([0, 1, 1, 2], [0, 0, 1, 2])
+    }, idtype=getattr(F, dtype), num_nodes_dict={'user': 5, 'game': 4}).to(F.ctx())
+    eids = {'follow': F.copy_to(F.tensor([0, 3, 5], dtype=getattr(F, dtype)), F.ctx()),
+            'play': F.copy_to(F.tensor([1, 2], dtype=getattr(F, dtype)), F.ctx())}
+    negs = dgl.sampling.corrupt_edges(g, eids, 4, corrupt=corrupt)
+    for etype, (src, dst) in negs.items():
+        assert F.dtype(src) == g.idtype
+        assert F.context(src) == F.ctx()
+        u, v = g.find_edges(eids[etype[1]], etype=etype)
+        fixed, corrupted = (dst, src) if corrupt == 'head' else (src, dst)
+        expected = v if corrupt == 'head' else u
+        assert F.array_equal(fixed, F.repeat(expected, 4, 0))
+        corrupted_type = etype[0] if corrupt == 'head' else etype[2]
+        assert np.all(F.asnumpy(corrupted) >= 0)
+        assert np.all(F.asnumpy(corrupted) < g.num_nodes(corrupted_type))
+
+    # weighted by degree, never existing
+    src, dst = g.edges(etype='follow')
+    degrees = g.out_degrees(etype='follow') if corrupt == 'head' else \
+        g.in_degrees(etype='follow')
+    prob = F.astype(degrees, F.float32) ** 0.75
+    neg_src, neg_dst = dgl.sampling.corrupt_edges(
+        g, {'follow': eids['follow']}, 100, corrupt=corrupt, prob={'follow': prob},
+        exclude_existing=True)[('user', 'follow', 'user')]
+    assert not np.any(F.asnumpy(g.has_edges_between(neg_src, neg_dst, etype='follow')))
+    corrupted = neg_src if corrupt == 'head' else neg_dst
+    assert np.all(F.asnumpy(degrees)[F.asnumpy(corrupted)] > 0)
+
+    # the user 0 follows all the users but 0 and 4
+    neg_sampler = dgl.dataloading.negative_sampler.Corrupt(
+        10, corrupt=corrupt, exclude_existing=True, num_trials=100)
+    neg_src, neg_dst = neg_sampler(g, {'follow': eids['follow'][:1]})[('user', 'follow', 'user')]
+    assert F.shape(neg_src)[0] > 0
+    if corrupt == 'head':
+        assert np.all(F.asnumpy(neg_src) != 0)
+    else:
+        assert np.all(np.isin(F.asnumpy(neg_dst), [0, 4]))
 
 if __name__ == '__main__':
     from itertools import product
@@ -906,3 +1359,4 @@ if __name__ == '__main__':
     test_sample_neighbors_biased_bipartite()
     test_sample_neighbors_exclude_edges_heteroG('int32')
     test_sample_neighbors_exclude_edges_homoG('int32')
+    test_corrupt_edges('int32', 'tail')
@@ -11,6 +11,7 @@ from dgl import DGLGraph
 import dgl
 import dgl.ndarray as nd
 from dgl.data.utils import load_labels, save_tensors, load_tensors
+from dgl.data.utils import save_tensors_async, save_graphs_async
 
 np.random.seed(44)
 
@@ -167,6 +168,70 @@ def test_serialize_tensors():
     os.unlink(path)
 
 
+def test_serialize_tensors_layout():
+    f = tempfile.NamedTemporaryFile(delete=False)
+    path = f.name
+    f.close()
+
+    # payloads of sizes not multiple of the alignment, and an empty one
+    tensor_dict = {
+        "feat": F.randn((1000, 7)),
+        "ids": F.tensor(np.arange(3001), dtype=F.int32),
+        "empty": F.zeros((0, 4)),
+        "mask": F.tensor(np.random.randint(0, 2, (13, 5, 3)), dtype=F.int64)}
+    save_tensors(path, tensor_dict)
+
+    load_tensor_dict = load_tensors(path)
+    assert set(load_tensor_dict.keys()) == set(tensor_dict.keys())
+    for key in tensor_dict:
+        assert F.dtype(load_tensor_dict[key]) == F.dtype(tensor_dict[key])
+        assert F.shape(load_tensor_dict[key]) == F.shape(tensor_dict[key])
+        assert np.array_equal(
+            F.asnumpy(load_tensor_dict[key]), F.asnumpy(tensor_dict[key]))
+
+    os.unlink(path)
+
+
+@pytest.mark.parametrize('mmap_layout', [False, True])
+def test_save_async(mmap_layout):
+    paths = []
+    for _ in range(2):
+        f = tempfile.NamedTemporaryFile(delete=False)
+        paths.append(f.name)
+        f.close()
+    tensor_path, graph_path = paths
+
+    feat = np.random.randn(1000, 7).astype(np.float32)
+    handle = save_tensors_async(tensor_path, {"feat": F.tensor(feat)})
+    handle.wait()
+    assert handle.done()
+    assert np.array_equal(F.asnumpy(load_tensors(tensor_path)["feat"]), feat)
+
+    g = dgl.graph(([0, 1, 2], [1, 2, 3]))
+    g.ndata['h'] = F.tensor(feat[:4])
+    labels = {"label": F.tensor([3])}
+    handle = save_graphs_async(graph_path, [g], labels, mmap_layout=mmap_layout)
+    # the saved features do not change with the graph
+    if dgl.backend.backend_name != 'tensorflow':
+        g.ndata['h'][0] = 0
+    g.create_formats_()
+    handle.wait()
+    g_list, load_labels_dict = dgl.load_graphs(graph_path)
+    assert F.array_equal(g_list[0].edges()[0], g.edges()[0])
+    assert F.array_equal(g_list[0].edges()[1], g.edges()[1])
+    assert np.array_equal(F.asnumpy(g_list[0].ndata['h']), feat[:4])
+    assert F.array_equal(load_labels_dict["label"], labels["label"])
+
+    # the error of the write is raised by wait
+    handle = save_tensors_async(
+        os.path.join(tensor_path, "not_a_dir"), {"feat": F.tensor(feat)})
+    with pytest.raises(dgl.DGLError):
+        handle.wait()
+
+    for path in paths:
+        os.unlink(path)
+
+
 def test_serialize_empty_dict():
     # create a temporary file and immediately release it so DGL can open it.
     f = tempfile.NamedTemporaryFile(delete=False)
@@ -316,6 +381,197 @@ def test_serialize_heterograph():
 
     os.unlink(path)
 
+@unittest.skipIf(F._default_context_str == 'gpu', reason="GPU not implemented")
+def test_load_graph_subset():
+    f = tempfile.NamedTemporaryFile(delete=False)
+    path = f.name
+    f.close()
+    g_list0 = construct_graph(20, True)
+    dgl.save_graphs(path, g_list0)
+
+    # unsorted, with duplicates, the first and the last graph
+    idx_list = [19, 3, 0, 3, 18, 7, 19]
+    g_list, _ = dgl.load_graphs(path, idx_list)
+    assert len(g_list) == len(idx_list)
+    for g, idx in zip(g_list, idx_list):
+        g0 = g_list0[idx]
+        assert g.number_of_nodes() == g0.number_of_nodes()
+        assert F.array_equal(g.edges()[0], g0.edges()[0])
+        assert F.array_equal(g.edges()[1], g0.edges()[1])
+        assert F.allclose(g.edata['e1'], g0.edata['e1'])
+        assert F.allclose(g.ndata['n1'], g0.ndata['n1'])
+
+    os.unlink(path)
+
+@unittest.skipIf(F._default_context_str == 'gpu', reason="GPU not implemented")
+def test_serialize_heterograph_mmap():
+    f = tempfile.NamedTemporaryFile(delete=False)
+    path = f.name
+    f.close()
+    g_list0 = create_heterographs2(F.int64) + create_heterographs2(F.int32)
+    labels_dict = {"graph_label": F.arange(0, len(g_list0))}
+    dgl.save_graphs(path, g_list0, labels_dict, mmap_layout=True)
+
+    g_list, labels = dgl.load_graphs(path)
+    assert len(g_list) == len(g_list0)
+    assert F.allclose(labels["graph_label"], labels_dict["graph_label"])
+    assert F.allclose(load_labels(path)["graph_label"], labels_dict["graph_label"])
+    for g, g0 in zip(g_list, g_list0):
+        assert g.idtype == g0.idtype
+        assert g.canonical_etypes == g0.canonical_etypes
+        for etype in g0.canonical_etypes:
+            assert F.array_equal(g.edges(etype=etype)[0], g0.edges(etype=etype)[0])
+            assert F.array_equal(g.edges(etype=etype)[1], g0.edges(etype=etype)[1])
+    assert np.allclose(
+        F.asnumpy(g_list[2].nodes['user'].data['hh']), np.ones((4, 5)))
+
+    g_list, _ = dgl.load_graphs(path, [6, 2])
+    assert g_list[0].idtype == F.int32
+    assert np.allclose(
+        F.asnumpy(g_list[1].nodes['user'].data['hh']), np.ones((4, 5)))
+
+    if dgl.backend.backend_name != 'tensorflow':
+        # writing to a loaded feature does not change the file
+        g_list[1].nodes['user'].data['hh'][0] = 0
+        g_list, _ = dgl.load_graphs(path, [2])
+        assert np.allclose(
+            F.asnumpy(g_list[0].nodes['user'].data['hh']), np.ones((4, 5)))
+
+    os.unlink(path)
+
+@unittest.skipIf(F._default_context_str == 'gpu', reason="GPU not implemented")
+@unittest.skipIf(os.name == 'nt', reason='Memory mapped files are not supported on windows')
+@pytest.mark.parametrize('idtype', [np.int32, np.int64])
+@pytest.mark.parametrize('transpose', [False, True])
+def test_load_csr_graph_mmap(idtype, transpose):
+    indptr = np.array([0, 2, 3, 3, 5], dtype=idtype)
+    indices = np.array([1, 2, 0, 3, 1], dtype=idtype)
+    eids = np.array([4, 3, 2, 1, 0], dtype=idtype)
+    with tempfile.TemporaryDirectory() as tmpdir:
+        paths = [os.path.join(tmpdir, name) for name in ['indptr.npy', 'indices.npy', 'eids.npy']]
+        for path, array in zip(paths, [indptr, indices, eids]):
+            np.save(path, array)
+        fmt = 'csc' if transpose else 'csr'
+        g0 = dgl.graph((fmt, (F.tensor(indptr), F.tensor(indices), F.tensor(eids))))
+        g = dgl.data.utils.load_csr_graph_mmap(*paths, transpose=transpose)
+        assert g.idtype == g0.idtype
+        assert g.num_nodes() == 4 and g.num_edges() == 5
+        for t, t0 in zip(g.edges(form='all', order='eid'), g0.edges(form='all', order='eid')):
+            assert F.array_equal(t, t0)
+
+        g = dgl.data.utils.load_csr_graph_mmap(paths[0], paths[1], formats=fmt)
+        assert g.formats()['created'] == [fmt]
+        g0 = dgl.graph((fmt, (F.tensor(indptr), F.tensor(indices), F.tensor([], dtype=g.idtype))))
+        assert F.array_equal(g.edges(order='eid')[0], g0.edges(order='eid')[0])
+        assert F.array_equal(g.edges(order='eid')[1], g0.edges(order='eid')[1])
+        del g
+        # the files are mapped copy-on-write
+        assert np.array_equal(np.load(paths[0]), indptr)
+
+@unittest.skipIf(F._default_context_str == 'gpu', reason="GPU not implemented")
+def test_serialize_heterograph_columnar():
+    f = tempfile.NamedTemporaryFile(delete=False)
+    path = f.name
+    f.close()
+    g_list0 = create_heterographs2(F.int64) + create_heterographs2(F.int32)
+    g_list0[1].edges['follows'].data['v'] = F.ones((3, 2), F.float32, F.cpu())
+    labels_dict = {"graph_label": F.arange(0, len(g_list0))}
+    dgl.save_graphs(path, g_list0, labels_dict, columnar=True)
+
+    g_list, labels = dgl.load_graphs(path)
+    assert len(g_list) == len(g_list0)
+    assert F.allclose(labels["graph_label"], labels_dict["graph_label"])
+    assert F.allclose(load_labels(path)["graph_label"], labels_dict["graph_label"])
+    for g, g0 in zip(g_list, g_list0):
+        assert g.idtype == g0.idtype
+        assert g.canonical_etypes == g0.canonical_etypes
+        for etype in g0.canonical_etypes:
+            assert F.array_equal(g.edges(etype=etype)[0], g0.edges(etype=etype)[0])
+            assert F.array_equal(g.edges(etype=etype)[1], g0.edges(etype=etype)[1])
+            assert set(g.edges[etype].data.keys()) == set(g0.edges[etype].data.keys())
+        for ntype in g0.ntypes:
+            for key, value in g0.nodes[ntype].data.items():
+                assert F.allclose(g.nodes[ntype].data[key], value)
+
+    g_list, _ = dgl.load_graphs(path, [6, 1])
+    assert g_list[0].idtype == F.int32
+    assert F.allclose(g_list[1].edges['follows'].data['v'], F.ones((3, 2)))
+
+    # one feature of all the graphs
+    feats = dgl.data.utils.load_graph_feature(path, 'hh', ntype='user')
+    assert len(feats) == len(g_list0)
+    for feat, g0 in zip(feats, g_list0):
+        if 'hh' in g0.nodes['user'].data:
+            assert F.allclose(feat, g0.nodes['user'].data['hh'])
+        else:
+            assert feat is None
+    feats = dgl.data.utils.load_graph_feature(path, 'v', etype='follows')
+    assert feats[0] is None
+    assert F.allclose(feats[1], F.ones((3, 2)))
+    with pytest.raises(dgl.DGLError):
+        dgl.data.utils.load_graph_feature(path, 'not_a_feature')
+
+    os.unlink(path)
+
+@unittest.skipIf(F._default_context_str == 'gpu', reason="GPU not implemented")
+@pytest.mark.parametrize('mmap_layout', [False, True])
+def test_graph_snapshot_delta(mmap_layout):
+    paths = []
+    for _ in range(3):
+        f = tempfile.NamedTemporaryFile(delete=False)
+        paths.append(f.name)
+        f.close()
+    base_path, delta_path1, delta_path2 = paths
+
+    g0 = dgl.heterograph({
+        ('user', 'follows', 'user'): ([0, 1], [1, 2]),
+        ('user', 'plays', 'game'): ([0, 2], [1, 0])})
+    g0.nodes['user'].data['h'] = F.zeros((3, 2), F.float32, F.cpu())
+    g0.edges['plays'].data['w'] = F.tensor([1., 2.])
+    dgl.save_graphs(base_path, [g0], mmap_layout=mmap_layout)
+
+    # a new user following user 0, and user 0 changed
+    g1 = dgl.heterograph({
+        ('user', 'follows', 'user'): ([0, 1, 3], [1, 2, 0]),
+        ('user', 'plays', 'game'): ([0, 2], [1, 0])})
+    h = np.zeros((4, 2), dtype=np.float32)
+    h[0] = 1
+    g1.nodes['user'].data['h'] = F.tensor(h)
+    g1.edges['plays'].data['w'] = F.tensor([1., 2.])
+    dgl.data.utils.save_graph_delta(
+        delta_path1, g1, {'user': 3, 'game': 2}, {'follows': 2, 'plays': 2},
+        dirty_nodes={'user': F.tensor([0])})
+
+    # a new play, and play 0 changed
+    g2 = dgl.heterograph({
+        ('user', 'follows', 'user'): ([0, 1, 3], [1, 2, 0]),
+        ('user', 'plays', 'game'): ([0, 2, 3], [1, 0, 1])})
+    g2.nodes['user'].data['h'] = F.tensor(h)
+    g2.edges['plays'].data['w'] = F.tensor([5., 2., 3.])
+    dgl.data.utils.save_graph_delta(
+        delta_path2, g2, {'user': 4, 'game': 2}, {'follows': 3, 'plays': 2},
+        dirty_edges={'plays': F.tensor([0])})
+
+    g = dgl.data.utils.load_graph_snapshot(base_path, [delta_path1, delta_path2])
+    assert g.canonical_etypes == g2.canonical_etypes
+    assert g.number_of_nodes('user') == 4
+    for etype in g2.canonical_etypes:
+        assert F.array_equal(g.edges(etype=etype)[0], g2.edges(etype=etype)[0])
+        assert F.array_equal(g.edges(etype=etype)[1], g2.edges(etype=etype)[1])
+    assert np.allclose(F.asnumpy(g.nodes['user'].data['h']), h)
+    assert np.allclose(F.asnumpy(g.edges['plays'].data['w']), [5., 2., 3.])
+
+    g = dgl.data.utils.load_graph_snapshot(base_path, [delta_path1])
+    assert g.number_of_edges('plays') == 2
+    assert np.allclose(F.asnumpy(g.edges['plays'].data['w']), [1., 2.])
+
+    # the second delta does not start from the snapshot
+    with pytest.raises(dgl.DGLError):
+        dgl.data.utils.load_graph_snapshot(base_path, [delta_path2])
+
+    for path in paths:
+        os.unlink(path)
+
 @unittest.skipIf(F._default_context_str == 'gpu', reason="GPU not implemented")
 @pytest.mark.skip(reason="lack of permission on CI")
 def test_serialize_heterograph_s3():
@@ -81,6 +81,59 @@ def test_copy_from_gpu():
     p.start()
     p.join()
 
+def sub_proc_publish(hg_origin, name):
+    hg_rebuild = dgl.hetero_from_shared_memory(name)
+    assert hg_rebuild.formats()['created'] == ['coo']
+    hg_rebuild.create_formats_()
+    hg_rebuild.publish_formats_()
+    _assert_is_identical_hetero(hg_origin, hg_rebuild)
+
+@unittest.skipIf(os.name == 'nt', reason='Do not support windows yet')
+@unittest.skipIf(dgl.backend.backend_name == 'tensorflow', reason='Not support tensorflow for now')
+@parametrize_dtype
+def test_publish_formats(idtype):
+    hg = create_test_graph(idtype=idtype)
+    hg_share = hg.shared_memory("hg2", formats='coo')
+    p = mp.Process(target=sub_proc_publish, args=(hg, "hg2"))
+    p.start()
+    p.join()
+    assert p.exitcode == 0
+    # the formats published by the other process are visible to new attachers
+    hg_rebuild = dgl.hetero_from_shared_memory("hg2")
+    assert sorted(hg_rebuild.formats()['created']) == ['coo', 'csc', 'csr']
+    _assert_is_identical_hetero(hg, hg_rebuild)
+    for etype in hg.canonical_etypes:
+        indptr, indices, eids = hg.adj_sparse('csc', etype=etype)
+        indptr2, indices2, eids2 = hg_rebuild.adj_sparse('csc', etype=etype)
+        assert F.array_equal(indptr, indptr2)
+        assert F.array_equal(indices, indices2)
+    # and to the graphs attached before, once they sync
+    assert hg_share.formats()['created'] == ['coo']
+    hg_share.publish_formats_()
+    assert sorted(hg_share.formats()['created']) == ['coo', 'csc', 'csr']
+
+def sub_proc_cuda(hg_origin, name):
+    hg_rebuild = dgl.hetero_from_cuda_shared_memory(name)
+    assert hg_rebuild.device.type == 'cuda'
+    _assert_is_identical_hetero(hg_origin.to(hg_rebuild.device), hg_rebuild)
+    # the formats not shared are created on the GPU of this process
+    hg_rebuild.create_formats_()
+
+@unittest.skipIf(os.name == 'nt', reason='Do not support windows yet')
+@unittest.skipIf(F._default_context_str == 'cpu', reason="Need gpu for this test")
+@unittest.skipIf(dgl.backend.backend_name != 'pytorch', reason='Only support PyTorch for now')
+@parametrize_dtype
+def test_cuda_shared_memory(idtype):
+    hg = create_test_graph(idtype=idtype)
+    name = 'hg_cuda32' if idtype == F.int32 else 'hg_cuda64'
+    hg_share = hg.to(F.cuda()).cuda_shared_memory(name, formats=['coo', 'csc'])
+    _assert_is_identical_hetero(hg.to(F.cuda()), hg_share)
+    ctx = mp.get_context('spawn')
+    p = ctx.Process(target=sub_proc_cuda, args=(hg, name))
+    p.start()
+    p.join()
+    assert p.exitcode == 0
+
 # TODO: Test calling shared_memory with Blocks (a subclass of HeteroGraph)
 if __name__ == "__main__":
     test_single_process(F.int64)
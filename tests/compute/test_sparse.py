@@ -1,4 +1,5 @@
 from dgl.ops import gspmm, gsddmm, edge_softmax, segment_reduce
+from dgl.sparse import _gspmm
 from test_utils.graph_cases import get_cases
 from utils import parametrize_dtype
 import dgl
@@ -154,6 +155,18 @@ def test_spmm(idtype, g, shp, msg, reducer):
     g.edata.pop('w')
     if 'v' in g.dstdata: g.dstdata.pop('v')
 
+@pytest.mark.parametrize('msg', ['add', 'mul', 'copy_lhs'])
+@pytest.mark.parametrize('reducer', ['sum', 'max'])
+@parametrize_dtype
+def test_spmm_with_index(idtype, msg, reducer):
+    g = dgl.rand_graph(30, 100).astype(idtype).to(F.ctx())
+    table = F.tensor(np.random.rand(50, 4) + 1)
+    index = F.tensor(np.random.randint(0, 50, (30,)), dtype=idtype)
+    he = F.tensor(np.random.rand(100, 4) + 1)
+    v, _ = _gspmm(g._graph, msg, reducer, table, he, u_index=index)
+    v1, _ = _gspmm(g._graph, msg, reducer, F.gather_row(table, index), he)
+    assert F.allclose(v, v1)
+
 @pytest.mark.parametrize('g', graphs)
 @pytest.mark.parametrize('shp', sddmm_shapes)
 @pytest.mark.parametrize('lhs_target', ['u', 'v', 'e'])
@@ -257,13 +270,16 @@ def test_edge_softmax(g, norm_by, shp, idtype):
         assert F.allclose(F.grad(e2), grad_edata)
         print('backward passed')
 
+# tiny segments, segments of tens of rows and a few huge segments, which the
+# GPU kernel reduces by thread, by warp and by block respectively
+@pytest.mark.parametrize('seglens', [[2, 3, 0, 4, 1, 0, 0], [40, 0, 25, 100], [5000, 3000]])
 @pytest.mark.parametrize('reducer', ['sum', 'max', 'min', 'mean'])
-def test_segment_reduce(reducer):
+def test_segment_reduce(reducer, seglens):
     ctx = F.ctx()
-    value = F.tensor(np.random.rand(10, 5))
+    value = F.tensor(np.random.rand(sum(seglens), 5))
     v1 = F.attach_grad(F.clone(value))
     v2 = F.attach_grad(F.clone(value))
-    seglen = F.tensor([2, 3, 0, 4, 1, 0, 0])
+    seglen = F.tensor(seglens)
     u = F.copy_to(F.arange(0, F.shape(value)[0], F.int32), ctx)
     v = F.repeat(F.copy_to(F.arange(0, len(seglen), F.int32), ctx),
                  seglen, dim=0)
@@ -1,6 +1,7 @@
 import numpy as np
 import networkx as nx
 import unittest
+import pytest
 import scipy.sparse as ssp
 
 import dgl
@@ -438,6 +439,123 @@ def test_out_subgraph(idtype):
     assert subg.num_nodes('game') == 2
     assert subg.num_nodes('coin') == 1
 
+@parametrize_dtype
+def test_in_out_subgraph_edge_order(idtype):
+    g = dgl.heterograph({
+        ('user', 'follow', 'user'): ([1, 2, 3, 0, 2, 3, 0, 4], [0, 0, 0, 1, 1, 1, 2, 0]),
+        ('user', 'play', 'game'): ([0, 0, 1, 3], [0, 1, 2, 2])
+    }, idtype=idtype, num_nodes_dict={'user': 6, 'game': 4}).to(F.ctx())
+    # the edges are numbered as returned by in_edges and out_edges, and the
+    # nodes given twice have their edges twice
+    nodes = {'user': F.tensor([2, 0, 5, 2], dtype=idtype), 'game': F.tensor([2], dtype=idtype)}
+    for subgraph_fn, edges_fn in [(dgl.in_subgraph, 'in_edges'),
+                                  (dgl.out_subgraph, 'out_edges')]:
+        subg = subgraph_fn(g, nodes)
+        for etype in g.canonical_etypes:
+            vtype = etype[2] if edges_fn == 'in_edges' else etype[0]
+            u, v, eid = getattr(g, edges_fn)(nodes[vtype], form='all', etype=etype)
+            su, sv = subg.edges(order='eid', etype=etype)
+            assert F.array_equal(su, u)
+            assert F.array_equal(sv, v)
+            assert F.array_equal(subg.edges[etype].data[dgl.EID], eid)
+            assert subg.num_nodes(etype[0]) == g.num_nodes(etype[0])
+            assert subg.num_nodes(etype[2]) == g.num_nodes(etype[2])
+
+@parametrize_dtype
+def test_batch_node_subgraphs(idtype):
+    g = dgl.heterograph({
+        ('user', 'follow', 'user'): ([1, 2, 3, 0, 2, 3, 0, 4], [0, 0, 0, 1, 1, 1, 2, 0]),
+        ('user', 'play', 'game'): ([0, 0, 1, 3, 4], [0, 1, 2, 2, 3]),
+        ('game', 'liked-by', 'user'): ([2, 2, 2, 1, 1, 0], [0, 1, 2, 0, 3, 0])
+    }, idtype=idtype, num_nodes_dict={'user': 6, 'game': 4}).to(F.ctx())
+    g.nodes['user'].data['h'] = F.copy_to(F.randn((6, 2)), F.ctx())
+    g.edges['play'].data['w'] = F.copy_to(F.randn((5,)), F.ctx())
+    nodes_list = [
+        {'user': F.tensor([0, 1, 2], dtype=idtype), 'game': F.tensor([2, 0], dtype=idtype)},
+        {'user': F.tensor([3, 0], dtype=idtype)},
+        {'user': F.tensor([], dtype=idtype), 'game': F.tensor([1], dtype=idtype)},
+        {'user': F.tensor([4, 1, 3, 2], dtype=idtype), 'game': F.tensor([2, 3], dtype=idtype)}]
+    bg = dgl.batch_node_subgraphs(g, nodes_list)
+    assert bg.idtype == idtype
+    assert bg.device == g.device
+    assert bg.batch_size == len(nodes_list)
+    for sg, nodes in zip(dgl.unbatch(bg), nodes_list):
+        sg0 = dgl.node_subgraph(g, nodes)
+        for ntype in g.ntypes:
+            assert sg.num_nodes(ntype) == sg0.num_nodes(ntype)
+            assert F.array_equal(sg.nodes[ntype].data[dgl.NID], sg0.nodes[ntype].data[dgl.NID])
+        for etype in g.canonical_etypes:
+            u, v, eid = sg.edges(form='all', etype=etype)
+            u0, v0, eid0 = sg0.edges(form='all', etype=etype)
+            edges = set(zip(F.asnumpy(u), F.asnumpy(v), F.asnumpy(sg.edges[etype].data[dgl.EID])))
+            edges0 = set(zip(F.asnumpy(u0), F.asnumpy(v0),
+                             F.asnumpy(sg0.edges[etype].data[dgl.EID])))
+            assert edges == edges0
+        assert F.allclose(sg.nodes['user'].data['h'], sg0.nodes['user'].data['h'])
+        assert F.allclose(F.sum(sg.edges['play'].data['w'], 0),
+                          F.sum(sg0.edges['play'].data['w'], 0))
+
+    bg = dgl.batch_node_subgraphs(g, [], store_ids=False)
+    assert bg.batch_size == 0
+    assert bg.num_edges() == 0
+    assert dgl.NID not in bg.nodes['user'].data
+
+@parametrize_dtype
+@pytest.mark.parametrize('direction', ['in', 'out', 'both'])
+def test_batch_khop_subgraphs(idtype, direction):
+    g = dgl.graph(([1, 2, 3, 0, 2, 3, 0, 4, 5, 6], [0, 0, 0, 1, 1, 4, 2, 5, 6, 5]),
+                  idtype=idtype, num_nodes=8).to(F.ctx())
+    g.ndata['h'] = F.copy_to(F.randn((8, 2)), F.ctx())
+    seeds_list = [[0, 1], [3], [5, 2], [7], [4, 6]]
+    bg, dists = dgl.batch_khop_subgraphs(
+        g, [F.tensor(seeds, dtype=idtype) for seeds in seeds_list], 2, direction=direction)
+    assert bg.idtype == idtype
+    assert bg.device == g.device
+    assert bg.batch_size == len(seeds_list)
+    assert F.shape(dists) == (bg.num_nodes(), 2)
+
+    u, v = map(F.asnumpy, g.edges())
+    nbrs = {i: set() for i in range(g.num_nodes())}
+    for s, d in zip(u, v):
+        if direction in ('in', 'both'):
+            nbrs[d].add(s)
+        if direction in ('out', 'both'):
+            nbrs[s].add(d)
+    offset = 0
+    for sg, seeds in zip(dgl.unbatch(bg), seeds_list):
+        nodes = list(F.asnumpy(sg.ndata[dgl.NID]))
+        assert nodes[:len(seeds)] == seeds
+        if direction != 'both':
+            khop = dgl.khop_in_subgraph if direction == 'in' else dgl.khop_out_subgraph
+            sg0, _ = khop(g, F.tensor(seeds, dtype=idtype), 2)
+            assert set(nodes) == set(F.asnumpy(sg0.ndata[dgl.NID]))
+        sg0 = dgl.node_subgraph(g, F.tensor(nodes, dtype=idtype))
+        assert sg.num_edges() == sg0.num_edges()
+        assert set(F.asnumpy(sg.edata[dgl.EID])) == set(F.asnumpy(sg0.edata[dgl.EID]))
+        assert F.allclose(sg.ndata['h'], sg0.ndata['h'])
+        # the distances from each seed in the subgraph, without the other seeds
+        sub_dists = F.asnumpy(dists)[offset:offset + len(nodes)]
+        offset += len(nodes)
+        for j, seed in enumerate(seeds):
+            dist = {seed: 0}
+            frontier = [seed]
+            while frontier:
+                next_frontier = []
+                for x in frontier:
+                    for w in nbrs[x]:
+                        if w in nodes and w not in seeds and w not in dist:
+                            dist[w] = dist[x] + 1
+                            next_frontier.append(w)
+                frontier = next_frontier
+            for i, node in enumerate(nodes):
+                assert sub_dists[i, j] == dist.get(node, -1)
+        assert np.all(sub_dists[:, len(seeds):] == -1)
+
+    bg, dists = dgl.batch_khop_subgraphs(g, [], 2, store_ids=False)
+    assert bg.batch_size == 0
+    assert bg.num_nodes() == 0
+    assert dgl.NID not in bg.ndata
+
 def test_subgraph_message_passing():
     # Unit test for PR #2055
     g = dgl.graph(([0, 1, 2], [2, 3, 4])).to(F.cpu())
@@ -90,6 +90,20 @@ def test_line_graph2(idtype):
     assert np.array_equal(col[order],
                           np.array([3, 4, 0, 3, 4, 0, 1, 2]))
 
+@parametrize_dtype
+def test_line_graph_random(idtype):
+    # unsorted edges with multi-edges and self-loops, checked against the definition
+    src = np.random.randint(0, 30, (300,))
+    dst = np.random.randint(0, 30, (300,))
+    g = dgl.graph((F.tensor(src), F.tensor(dst)), num_nodes=30, idtype=idtype, device=F.ctx())
+    for backtracking in [True, False]:
+        lg = dgl.line_graph(g, backtracking=backtracking)
+        assert lg.device == g.device
+        expected = [(i, j) for i in range(300) for j in range(300)
+                    if i != j and dst[i] == src[j] and (backtracking or dst[j] != src[i])]
+        row, col = lg.edges()
+        assert list(zip(F.asnumpy(row).tolist(), F.asnumpy(col).tolist())) == expected
+
 def test_no_backtracking():
     N = 5
     G = dgl.DGLGraph(nx.star_graph(N))
@@ -528,6 +542,25 @@ def test_partition_with_halo():
         assert np.all(F.asnumpy(subg.in_degrees(lnode_ids)) == F.asnumpy(g.in_degrees(orig_nids)))
         assert np.all(F.asnumpy(subg.out_degrees(lnode_ids)) == F.asnumpy(g.out_degrees(orig_nids)))
 
+@unittest.skipIf(F._default_context_str == 'gpu', reason="GPU not implemented")
+def test_partition_with_halo_nodes():
+    g = create_large_graph(1000)
+    src, dst = [F.asnumpy(x) for x in g.edges()]
+    node_part = np.random.choice(64, g.number_of_nodes())
+    subgs, _, _ = dgl.transform.partition_graph_with_halo(g, node_part, 1)
+    for part_id, subg in subgs.items():
+        inner = F.asnumpy(subg.ndata['inner_node']).astype(bool)
+        orig_nids = F.asnumpy(subg.ndata[dgl.NID])
+        # the inner nodes first, in increasing order
+        node_ids = np.nonzero(node_part == part_id)[0]
+        assert np.all(inner[:len(node_ids)]) and not np.any(inner[len(node_ids):])
+        assert np.array_equal(orig_nids[:len(node_ids)], node_ids)
+        # the halo nodes are the neighbors of the partition out of it
+        in_part = node_part == part_id
+        halo = np.union1d(src[in_part[dst]], dst[in_part[src]])
+        halo = halo[~in_part[halo]]
+        assert np.array_equal(np.sort(orig_nids[len(node_ids):]), halo)
+
 @unittest.skipIf(os.name == 'nt', reason='Do not support windows yet')
 @unittest.skipIf(F._default_context_str == 'gpu', reason="METIS doesn't support GPU")
 @parametrize_dtype
@@ -571,6 +604,34 @@ def check_metis_partition_with_constraint(g):
             print('type1:', np.sum(sub_ntypes == 1))
             print('type2:', np.sum(sub_ntypes == 2))
 
+@unittest.skipIf(os.name == 'nt', reason='Do not support windows yet')
+@parametrize_dtype
+def test_streaming_partition(idtype):
+    g = create_large_graph(1000, idtype=idtype)
+    for algorithm in ['ldg', 'fennel']:
+        node_part = F.asnumpy(dgl.transform.streaming_partition_assignment(
+            g, 4, algorithm=algorithm, chunk_size=1000))
+        assert node_part.shape == (g.number_of_nodes(),)
+        assert np.all(node_part >= 0) and np.all(node_part < 4)
+        assert np.max(np.bincount(node_part, minlength=4)) <= 1.05 * g.number_of_nodes() / 4
+
+    # the same assignment when the edges are given by other chunks
+    part1 = F.asnumpy(dgl.transform.streaming_partition_assignment(g, 4, chunk_size=100))
+    partitioner = dgl.partition.StreamingPartitioner(g.number_of_nodes(), 4, batch_size=7)
+    u, v = g.edges()
+    partitioner.add_edges(u, v)
+    part2 = F.asnumpy(partitioner.finish())
+    assert part1.shape == part2.shape
+    assert np.max(np.bincount(part2, minlength=4)) <= 1.05 * g.number_of_nodes() / 4
+
+    ntypes = np.zeros((g.number_of_nodes(),), dtype=np.int32)
+    ntypes[0:int(g.number_of_nodes()/4)] = 1
+    node_part = F.asnumpy(dgl.transform.streaming_partition_assignment(
+        g, 4, balance_ntypes=F.tensor(ntypes)))
+    for ntype in [0, 1]:
+        counts = np.bincount(node_part[ntypes == ntype], minlength=4)
+        assert np.max(counts) <= 1.1 * np.sum(ntypes == ntype) / 4 + 1
+
 def check_metis_partition(g, extra_hops):
     subgs = dgl.transform.metis_partition(g, 4, extra_cached_hops=extra_hops)
     num_inner_nodes = 0
@@ -993,6 +1054,24 @@ def test_to_block(idtype):
     checkall(g, bg, dst_nodes, False)
     check_features(g, bg)
 
+@unittest.skipIf(F._default_context_str == 'gpu', reason="GPU not implemented")
+@parametrize_dtype
+def test_to_block_sampled(idtype):
+    g = dgl.graph((F.tensor([0, 1, 2, 3, 4, 0, 2], dtype=idtype),
+                   F.tensor([1, 1, 1, 2, 2, 3, 3], dtype=idtype)))
+    seeds = F.tensor([3, 1, 2], dtype=idtype)
+    sg = dgl.sampling.sample_neighbors(g, seeds, -1)
+    bg = dgl.to_block(sg, seeds)
+    # the edges of the sampler are grouped by seed, so the block is built in CSC
+    assert bg.formats()['created'] == ['csc']
+    assert F.array_equal(bg.dstdata[dgl.NID], seeds)
+    u, v = bg.edges(order='eid')
+    su, sv = sg.find_edges(bg.edata[dgl.EID])
+    assert F.array_equal(F.gather_row(bg.srcdata[dgl.NID], F.astype(u, F.int64)), su)
+    assert F.array_equal(F.gather_row(bg.dstdata[dgl.NID], F.astype(v, F.int64)), sv)
+    assert F.array_equal(bg.edata[dgl.EID], F.arange(0, sg.num_edges(), dtype=idtype))
+    assert F.array_equal(bg.in_degrees(), F.tensor([2, 3, 2], dtype=F.int64))
+
 
 @unittest.skipIf(F._default_context_str == 'gpu', reason="GPU not implemented")
 @parametrize_dtype
@@ -1708,6 +1787,25 @@ def test_reorder_graph(idtype):
     src = F.asnumpy(rg.edges()[0])
     assert np.array_equal(src, np.sort(src))
 
+    # the order of the default 'rcmk' algorithm
+    rg = dgl.reorder_graph(g)
+    assert np.array_equal(F.asnumpy(rg.ndata[dgl.NID]), [4, 3, 1, 2, 0])
+
+    # call with 'degree' node_permute_algo
+    rg = dgl.reorder_graph(g, node_permute_algo='degree')
+    assert np.array_equal(np.sort(F.asnumpy(rg.ndata[dgl.NID])), np.arange(g.num_nodes()))
+    deg = F.asnumpy(rg.in_degrees() + rg.out_degrees())
+    assert np.all(deg[:-1] >= deg[1:])
+
+    # call with 'rabbit' node_permute_algo, keeping every clique together
+    cg = dgl.graph(([0, 4, 1, 0, 4, 0, 2, 6, 3, 2, 6, 2, 0],
+                    [4, 1, 5, 1, 5, 5, 6, 3, 7, 3, 7, 7, 2]),
+                   idtype=idtype, device=F.ctx())
+    rg = dgl.reorder_graph(cg, node_permute_algo='rabbit')
+    nid = F.asnumpy(rg.ndata[dgl.NID])
+    assert np.array_equal(np.sort(nid), np.arange(cg.num_nodes()))
+    assert set(nid[:4]) in ({0, 1, 4, 5}, {2, 3, 6, 7})
+
     # call with 'dst' edge_permute_algo
     rg = dgl.reorder_graph(g, edge_permute_algo='dst')
     dst = F.asnumpy(rg.edges()[1])
@@ -59,6 +59,42 @@ def test_bfs(idtype, n=100):
     assert len(edges_dgl) == len(edges_nx)
     assert all(toset(x) == y for x, y in zip(edges_dgl, edges_nx))
 
+@parametrize_dtype
+def test_bfs_order(idtype, n=1000):
+    # the frontiers of the serial BFS, in the order of discovery
+    def _bfs_serial(indptr, indices, eids, sources):
+        visited = np.zeros(n, dtype=bool)
+        visited[sources] = True
+        nodes, edges = [list(sources)], []
+        while True:
+            next_nodes, next_edges = [], []
+            for u in nodes[-1]:
+                for idx in range(indptr[u], indptr[u + 1]):
+                    v = indices[idx]
+                    if not visited[v]:
+                        visited[v] = True
+                        next_nodes.append(v)
+                        next_edges.append(eids[idx])
+            if len(next_nodes) == 0:
+                return nodes, edges
+            nodes.append(next_nodes)
+            edges.append(next_edges)
+
+    a = sp.random(n, n, 10 / n, data_rvs=lambda n: np.ones(n))
+    sources = [3, 5, 3]
+    for formats in ['csr', ['csr', 'csc']]:
+        g = dgl.from_scipy(a).astype(idtype).formats(formats)
+        g.create_formats_()
+        g = g.to(F.ctx())
+        indptr, indices, eids = [F.asnumpy(x) for x in g.adj_sparse('csr')]
+        if len(eids) == 0:
+            eids = np.arange(len(indices))
+        nodes, edges = _bfs_serial(indptr, indices, eids, sources)
+        layers_dgl = dgl.bfs_nodes_generator(g, sources)
+        assert [F.asnumpy(x).tolist() for x in layers_dgl] == nodes
+        edges_dgl = dgl.bfs_edges_generator(g, sources)
+        assert [F.asnumpy(x).tolist() for x in edges_dgl] == edges
+
 @parametrize_dtype
 def test_topological_nodes(idtype, n=100):
     a = sp.random(n, n, 3 / n, data_rvs=lambda n: np.ones(n))
@@ -85,6 +121,32 @@ def test_topological_nodes(idtype, n=100):
     assert len(layers_dgl) == len(layers_spmv)
     assert all(toset(x) == toset(y) for x, y in zip(layers_dgl, layers_spmv))
 
+@parametrize_dtype
+def test_topological_nodes_order(idtype, n=1000):
+    # the frontiers of the serial Kahn's algorithm, in the order of completion
+    def _topo_serial(indptr, indices):
+        degree = np.bincount(indices, minlength=n)
+        nodes = [list(np.nonzero(degree == 0)[0])]
+        while True:
+            next_nodes = []
+            for u in nodes[-1]:
+                for v in indices[indptr[u]:indptr[u + 1]]:
+                    degree[v] -= 1
+                    if degree[v] == 0:
+                        next_nodes.append(v)
+            if len(next_nodes) == 0:
+                return nodes
+            nodes.append(next_nodes)
+
+    a = sp.random(n, n, 10 / n, data_rvs=lambda n: np.ones(n))
+    b = sp.tril(a, -1).tocoo()
+    # edges from the low IDs too, so the order of completion is not the one of the IDs
+    perm = np.random.permutation(n)
+    g = dgl.graph((perm[b.row], perm[b.col]), num_nodes=n, idtype=idtype).to(F.ctx())
+    indptr, indices, _ = [F.asnumpy(x) for x in g.adj_sparse('csr')]
+    layers_dgl = dgl.topological_nodes_generator(g)
+    assert [F.asnumpy(x).tolist() for x in layers_dgl] == _topo_serial(indptr, indices)
+
 DFS_LABEL_NAMES = ['forward', 'reverse', 'nontree']
 @parametrize_dtype
 def test_dfs_labeled_edges(idtype, example=False):
@@ -124,4 +186,5 @@ def test_dfs_labeled_edges(idtype, example=False):
 if __name__ == '__main__':
     test_bfs(idtype='int32')
     test_topological_nodes(idtype='int32')
+    test_topological_nodes_order(idtype='int32')
     test_dfs_labeled_edges(idtype='int32')
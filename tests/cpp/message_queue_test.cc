@@ -9,10 +9,12 @@
 #include <vector>
 
 #include "../src/rpc/network/msg_queue.h"
+#include "../src/rpc/network/lockfree_msg_queue.h"
 
 using std::string;
 using dgl::network::Message;
 using dgl::network::MessageQueue;
+using dgl::network::LockFreeMessageQueue;
 
 TEST(MessageQueueTest, AddRemove) {
   MessageQueue queue(5, 1);  // size:5, num_of_producer:1
@@ -102,3 +104,58 @@ TEST(MessageQueueTest, MultiThread) {
   }
   EXPECT_EQ(queue.EmptyAndNoMoreAdd(), true);
 }
+
+TEST(MessageQueueTest, LockFreeAddRemove) {
+  LockFreeMessageQueue queue(5, 1, 2);  // size:5, num_of_producer:1, slots:2
+  std::string str_1("111");
+  Message msg_1 = {const_cast<char*>(str_1.data()), 3};
+  EXPECT_EQ(queue.Add(msg_1), ADD_SUCCESS);
+  std::string str_2("2");
+  Message msg_2 = {const_cast<char*>(str_2.data()), 1};
+  EXPECT_EQ(queue.Add(msg_2), ADD_SUCCESS);
+  // out of slots, then out of bytes
+  EXPECT_EQ(queue.Add(msg_2, false), QUEUE_FULL);
+  Message msg_3;
+  EXPECT_EQ(queue.Remove(&msg_3), REMOVE_SUCCESS);
+  EXPECT_EQ(string(msg_3.data, msg_3.size), string("111"));
+  EXPECT_EQ(queue.Add(msg_1), ADD_SUCCESS);
+  Message msg_4 = {const_cast<char*>(str_1.data()), 3};
+  EXPECT_EQ(queue.Add(msg_4, false), QUEUE_FULL);
+  std::vector<Message> msgs;
+  EXPECT_EQ(queue.RemoveBatch(&msgs, 4), REMOVE_SUCCESS);
+  ASSERT_EQ(msgs.size(), 2);
+  EXPECT_EQ(string(msgs[0].data, msgs[0].size), string("2"));
+  EXPECT_EQ(string(msgs[1].data, msgs[1].size), string("111"));
+  Message msg_5;
+  EXPECT_EQ(queue.Remove(&msg_5, false), QUEUE_EMPTY);
+  std::string str_6("666666");
+  Message msg_6 = {const_cast<char*>(str_6.data()), 6};
+  EXPECT_EQ(queue.Add(msg_6), MSG_GT_SIZE);
+  EXPECT_EQ(queue.Empty(), true);
+  queue.SignalFinished(0);
+  EXPECT_EQ(queue.EmptyAndNoMoreAdd(), true);
+  EXPECT_EQ(queue.Remove(&msg_5), QUEUE_CLOSE);
+}
+
+TEST(MessageQueueTest, LockFreeMultiThread) {
+  // few slots and bytes, so that the producers park
+  LockFreeMessageQueue queue(50, kNumOfProducer, 4);
+  std::vector<std::thread*> thread_pool;
+  for (int i = 0; i < kNumOfProducer; ++i) {
+    thread_pool.push_back(new std::thread(start_add, &queue, i));
+  }
+  std::vector<Message> msgs;
+  int num_msgs = 0;
+  while (queue.RemoveBatch(&msgs, 3) == REMOVE_SUCCESS) {
+    for (auto& msg : msgs) {
+      EXPECT_EQ(string(msg.data, msg.size), string("apple"));
+    }
+    num_msgs += msgs.size();
+  }
+  EXPECT_EQ(num_msgs, kNumOfProducer*kNumOfMessage);
+  for (int i = 0; i < kNumOfProducer; ++i) {
+    thread_pool[i]->join();
+    delete thread_pool[i];
+  }
+  EXPECT_EQ(queue.EmptyAndNoMoreAdd(), true);
+}
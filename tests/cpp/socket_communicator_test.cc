@@ -23,6 +23,7 @@ using dgl::network::SocketSender;
 using dgl::network::SocketReceiver;
 using dgl::network::Message;
 using dgl::network::DefaultMessageDeleter;
+using dgl::network::MessageQueueType;
 
 const int64_t kQueueSize = 500 * 1024;
 const int kThreadNum = 2;
@@ -110,6 +111,117 @@ void start_server(int id) {
   receiver.Finalize();
 }
 
+const char* batch_ip_addr = "socket://127.0.0.1:50094";
+const int kNumBatchMessage = 1000;
+// larger than the bytes read ahead by the receiver
+const int64_t kLargeMessageSize = 200 * 1024;
+
+static std::string batch_message(int i) {
+  return i % 100 == 0 ? std::string(kLargeMessageSize, 'a' + i / 100) : std::to_string(i);
+}
+
+static void start_batch_client() {
+  SocketSender sender(kQueueSize, 1, MessageQueueType::kLockFree);
+  sender.AddReceiver(batch_ip_addr, 0);
+  sender.SetBatching(100, 4096);
+  sender.Connect();
+  for (int i = 0; i < kNumBatchMessage; ++i) {
+    const std::string str = batch_message(i);
+    char* str_data = new char[str.size()];
+    memcpy(str_data, str.data(), str.size());
+    Message msg = {str_data, static_cast<int64_t>(str.size())};
+    msg.deallocator = DefaultMessageDeleter;
+    EXPECT_EQ(sender.Send(msg, 0), ADD_SUCCESS);
+  }
+  sender.Finalize();
+}
+
+static void start_batch_server() {
+  SocketReceiver receiver(kQueueSize, 1, MessageQueueType::kLockFree);
+  receiver.Wait(batch_ip_addr, 1);
+  for (int i = 0; i < kNumBatchMessage; ++i) {
+    Message msg;
+    EXPECT_EQ(receiver.RecvFrom(&msg, 0), REMOVE_SUCCESS);
+    EXPECT_EQ(string(msg.data, msg.size), batch_message(i));
+    msg.deallocator(&msg);
+  }
+  receiver.Finalize();
+}
+
+TEST(SocketCommunicatorTest, BatchedSendAndRecv) {
+  std::thread server_thread(start_batch_server);
+  std::thread client_thread(start_batch_client);
+  client_thread.join();
+  server_thread.join();
+}
+
+const char* stripe_ip_addr = "socket://127.0.0.1:50095";
+const int kNumStripes = 3;
+const int kNumStripeSender = 2;
+const int kNumStripeMessage = 100;
+
+static std::string stripe_message(int sender, int i) {
+  if (i % 10 != 5) {
+    return std::to_string(sender) + ":" + std::to_string(i);
+  }
+  // large enough to be striped, and not divisible by the number of stripes
+  std::string str(kLargeMessageSize + 1, 'a' + sender);
+  for (size_t k = 0; k < str.size(); k += 1000) {
+    str[k] = 'a' + i / 10;
+  }
+  return str;
+}
+
+static void start_stripe_client(int sender_id) {
+  SocketSender sender(kQueueSize, 1);
+  sender.AddReceiver(stripe_ip_addr, 0);
+  sender.SetStriping(kNumStripes, 64 * 1024);
+  sender.Connect();
+  for (int i = 0; i < kNumStripeMessage; ++i) {
+    const std::string str = stripe_message(sender_id, i);
+    char* str_data = new char[str.size()];
+    memcpy(str_data, str.data(), str.size());
+    Message msg = {str_data, static_cast<int64_t>(str.size())};
+    msg.deallocator = DefaultMessageDeleter;
+    EXPECT_EQ(sender.Send(msg, 0), ADD_SUCCESS);
+  }
+  sender.Finalize();
+}
+
+static void start_stripe_server() {
+  SocketReceiver receiver(kQueueSize, 1);
+  receiver.SetStriping(kNumStripes);
+  receiver.Wait(stripe_ip_addr, kNumStripeSender);
+  // the senders are numbered in the order they connect, so each one is told
+  // by its first message
+  std::vector<int> sender_ids(kNumStripeSender, -1);
+  std::vector<int> num_received(kNumStripeSender, 0);
+  for (int n = 0; n < kNumStripeSender * kNumStripeMessage; ++n) {
+    Message msg;
+    int send_id;
+    EXPECT_EQ(receiver.Recv(&msg, &send_id), REMOVE_SUCCESS);
+    if (num_received[send_id] == 0) {
+      sender_ids[send_id] = msg.data[0] - '0';
+    }
+    EXPECT_EQ(string(msg.data, msg.size),
+              stripe_message(sender_ids[send_id], num_received[send_id]++));
+    msg.deallocator(&msg);
+  }
+  receiver.Finalize();
+}
+
+TEST(SocketCommunicatorTest, StripedSendAndRecv) {
+  std::thread server_thread(start_stripe_server);
+  std::vector<std::thread> client_threads;
+  for (int i = 0; i < kNumStripeSender; ++i) {
+    client_threads.emplace_back(start_stripe_client, i);
+  }
+  for (auto& thread : client_threads) {
+    thread.join();
+  }
+  server_thread.join();
+}
+
 #else
 
 #include <windows.h>
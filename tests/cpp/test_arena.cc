@@ -0,0 +1,58 @@
+#include <../src/runtime/arena.h>
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <numeric>
+
+using namespace dgl::runtime;
+
+TEST(ArenaTest, TestAlloc) {
+  Arena arena;
+  int32_t* a = arena.Alloc<int32_t>(3);
+  double* b = arena.Alloc<double>(5);
+  char* c = static_cast<char*>(arena.Alloc(7, 1));
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(a) % Arena::kAlignment, 0);
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(b) % alignof(double), 0);
+  ASSERT_GE(reinterpret_cast<char*>(b), reinterpret_cast<char*>(a + 3));
+  ASSERT_GE(c, reinterpret_cast<char*>(b + 5));
+  ASSERT_EQ(arena.Capacity(), Arena::kMinBlockSize);
+
+  // an allocation larger than a block gets its own block
+  char* big = static_cast<char*>(arena.Alloc(Arena::kMinBlockSize * 3));
+  big[Arena::kMinBlockSize * 3 - 1] = 1;
+  ASSERT_GE(arena.Capacity(), Arena::kMinBlockSize * 4);
+  const size_t capacity = arena.Capacity();
+
+  // the memory is reused once released
+  arena.Reset();
+  ASSERT_EQ(arena.Alloc<int32_t>(3), a);
+  arena.Reset();
+  arena.Alloc(Arena::kMinBlockSize * 3);
+  ASSERT_EQ(arena.Capacity(), capacity);
+}
+
+TEST(ArenaTest, TestScope) {
+  Arena arena;
+  int64_t* a = arena.Alloc<int64_t>(10);
+  int64_t* b;
+  {
+    ArenaScope scope(&arena);
+    b = arena.Alloc<int64_t>(10);
+    {
+      ArenaScope inner(&arena);
+      arena.Alloc<int64_t>(100);
+    }
+    ASSERT_EQ(arena.Alloc<int64_t>(10), b + 10);
+  }
+  ASSERT_EQ(arena.Alloc<int64_t>(10), b);
+  ASSERT_NE(a, b);
+}
+
+TEST(ArenaTest, TestArenaVector) {
+  ArenaScope scope;
+  ArenaVector<int64_t> vec;
+  for (int64_t i = 0; i < 1000; ++i)
+    vec.push_back(i);
+  ArenaVector<int64_t> copy(vec);
+  ASSERT_EQ(std::accumulate(copy.begin(), copy.end(), int64_t(0)), 999 * 1000 / 2);
+  ASSERT_EQ(vec.get_allocator().arena(), Arena::ThreadLocal());
+}
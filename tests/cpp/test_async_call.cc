@@ -0,0 +1,75 @@
+#include <dgl/array.h>
+#include <dgl/packed_func_ext.h>
+#include <dgl/runtime/async_call.h>
+#include <dmlc/logging.h>
+#include <gtest/gtest.h>
+#include <vector>
+#include "./common.h"
+
+using namespace dgl;
+using namespace dgl::runtime;
+
+namespace {
+
+// the sum of the integer arguments, failing on negative ones
+PackedFunc AddFunc() {
+  return PackedFunc([](DGLArgs args, DGLRetValue* rv) {
+    int64_t sum = 0;
+    for (int i = 0; i < args.num_args; ++i) {
+      const int64_t x = args[i];
+      CHECK_GE(x, 0) << "Negative argument";
+      sum += x;
+    }
+    *rv = sum;
+  });
+}
+
+template <typename... Args>
+Future Call(PackedFunc f, Args&&... args) {
+  const int kNumArgs = sizeof...(Args);
+  DGLValue values[kNumArgs];
+  int type_codes[kNumArgs];
+  runtime::detail::for_each(DGLArgsSetter(values, type_codes), std::forward<Args>(args)...);
+  return AsyncCall(f, DGLArgs(values, type_codes, kNumArgs));
+}
+
+}  // namespace
+
+TEST(AsyncCallTest, TestCall) {
+  Future future = Call(AddFunc(), 1, 2, 3);
+  const int64_t sum = future->Wait();
+  ASSERT_EQ(sum, 6);
+  ASSERT_TRUE(future->Done());
+  // the result is kept
+  ASSERT_EQ(static_cast<int64_t>(future->Wait()), 6);
+
+  // the array arguments are retained by the call
+  Future array_future = Call(PackedFunc([](DGLArgs args, DGLRetValue* rv) {
+    NDArray array = args[0];
+    *rv = array->shape[0];
+  }), aten::VecToIdArray(std::vector<int64_t>({1, 2, 3})));
+  ASSERT_EQ(static_cast<int64_t>(array_future->Wait()), 3);
+}
+
+TEST(AsyncCallTest, TestChain) {
+  // the futures passed as arguments are replaced by their results
+  Future first = Call(AddFunc(), 1, 2);
+  Future second = Call(AddFunc(), first, 10);
+  Future third = Call(AddFunc(), second, first, 100);
+  ASSERT_EQ(static_cast<int64_t>(third->Wait()), 116);
+  ASSERT_TRUE(first->Done());
+  ASSERT_TRUE(second->Done());
+  WaitAllAsyncCalls();
+}
+
+TEST(AsyncCallTest, TestError) {
+  Future failed = Call(AddFunc(), 1, -1);
+  ASSERT_THROW(failed->Wait(), dmlc::Error);
+  ASSERT_NE(failed->Error().find("Negative argument"), std::string::npos);
+  // so do the calls depending on it
+  Future chained = Call(AddFunc(), failed, 1);
+  ASSERT_THROW(chained->Wait(), dmlc::Error);
+  ASSERT_NE(chained->Error().find("Negative argument"), std::string::npos);
+  // the other calls go on
+  ASSERT_EQ(static_cast<int64_t>(Call(AddFunc(), 4)->Wait()), 4);
+}
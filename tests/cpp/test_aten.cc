@@ -1,5 +1,10 @@
 #include <gtest/gtest.h>
 #include <dgl/array.h>
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <random>
+#include <vector>
 #include "./common.h"
 
 using namespace dgl;
@@ -241,6 +246,29 @@ TEST(ArrayTest, TestIndexSelect) {
 #endif
 }
 
+template <typename IDX>
+void _TestIndexSelectRows(DLContext ctx) {
+  const DLDataType dtype{kDLInt, sizeof(IDX)*8, 1};
+  IdArray a = aten::Range(0, 30, sizeof(IDX)*8, ctx).CreateView({10, 3}, dtype);
+  IdArray b = aten::VecToIdArray(std::vector<IDX>({9, 0, 4, 4}), sizeof(IDX)*8, ctx);
+  IdArray c = aten::IndexSelect(a, b);
+  ASSERT_EQ(c->ndim, 2);
+  ASSERT_EQ(c->shape[0], 4);
+  ASSERT_EQ(c->shape[1], 3);
+  IdArray tc = aten::VecToIdArray(
+      std::vector<IDX>({27, 28, 29, 0, 1, 2, 12, 13, 14, 12, 13, 14}), sizeof(IDX)*8, ctx);
+  ASSERT_TRUE(ArrayEQ<IDX>(c.CreateView({12}, dtype), tc));
+}
+
+TEST(ArrayTest, TestIndexSelectRows) {
+  _TestIndexSelectRows<int32_t>(CPU);
+  _TestIndexSelectRows<int64_t>(CPU);
+#ifdef DGL_USE_CUDA
+  _TestIndexSelectRows<int32_t>(GPU);
+  _TestIndexSelectRows<int64_t>(GPU);
+#endif
+}
+
 template <typename IDX>
 void _TestRelabel_(DLContext ctx) {
   IdArray a = aten::VecToIdArray(std::vector<IDX>({0, 20, 10}), sizeof(IDX)*8, ctx);
@@ -265,6 +293,32 @@ TEST(ArrayTest, TestRelabel_) {
 #endif
 }
 
+template <typename IDX>
+void _TestUnique(DLContext ctx) {
+  IdArray a = aten::VecToIdArray(std::vector<IDX>({2, 3, 10, 0, 2, 10}), sizeof(IDX)*8, ctx);
+  IdArray values, inverse, counts;
+  std::tie(values, inverse, counts) = aten::Unique(a);
+
+  IdArray ta = aten::VecToIdArray(std::vector<IDX>({2, 3, 10, 0, 2, 10}), sizeof(IDX)*8, ctx);
+  IdArray tv = aten::VecToIdArray(std::vector<IDX>({2, 3, 10, 0}), sizeof(IDX)*8, ctx);
+  IdArray ti = aten::VecToIdArray(std::vector<IDX>({0, 1, 2, 3, 0, 2}), sizeof(IDX)*8, ctx);
+  IdArray tc = aten::VecToIdArray(std::vector<IDX>({2, 1, 2, 1}), sizeof(IDX)*8, ctx);
+
+  ASSERT_TRUE(ArrayEQ<IDX>(a, ta));
+  ASSERT_TRUE(ArrayEQ<IDX>(values, tv));
+  ASSERT_TRUE(ArrayEQ<IDX>(inverse, ti));
+  ASSERT_TRUE(ArrayEQ<IDX>(counts, tc));
+}
+
+TEST(ArrayTest, TestUnique) {
+  _TestUnique<int32_t>(CPU);
+  _TestUnique<int64_t>(CPU);
+#ifdef DGL_USE_CUDA
+  _TestUnique<int32_t>(GPU);
+  _TestUnique<int64_t>(GPU);
+#endif
+}
+
 template <typename IDX>
 void _TestConcat(DLContext ctx) {
   IdArray a = aten::VecToIdArray(std::vector<IDX>({1, 2, 3}), sizeof(IDX)*8, CTX);
@@ -372,6 +426,56 @@ TEST(MatrixTest, TestToSimpleCsr) {
   _TestToSimpleCsr<int64_t>(CPU);
 }
 
+template <typename IdType>
+void _TestToSimpleCsrLargeRows() {
+  // rows long enough to be sorted by std::sort, with shuffled edge ids
+  const int64_t num_rows = 50, num_cols = 40;
+  std::mt19937 gen(7);
+  std::vector<IdType> indptr({0}), indices;
+  for (int64_t row = 0; row < num_rows; ++row) {
+    const int64_t deg = std::uniform_int_distribution<int64_t>(0, 200)(gen);
+    for (int64_t i = 0; i < deg; ++i)
+      indices.push_back(std::uniform_int_distribution<IdType>(0, num_cols - 1)(gen));
+    indptr.push_back(indices.size());
+  }
+  std::vector<IdType> eids(indices.size());
+  std::iota(eids.begin(), eids.end(), 0);
+  std::shuffle(eids.begin(), eids.end(), gen);
+  const aten::CSRMatrix csr(
+    num_rows, num_cols, aten::VecToIdArray(indptr, sizeof(IdType) * 8, CTX),
+    aten::VecToIdArray(indices, sizeof(IdType) * 8, CTX),
+    aten::VecToIdArray(eids, sizeof(IdType) * 8, CTX), false);
+
+  std::vector<IdType> b_indptr({0}), b_indices, cnt, map(indices.size());
+  for (int64_t row = 0; row < num_rows; ++row) {
+    std::map<IdType, IdType> row_cnt;
+    for (IdType i = indptr[row]; i < indptr[row + 1]; ++i)
+      ++row_cnt[indices[i]];
+    for (auto &kv : row_cnt) {
+      b_indices.push_back(kv.first);
+      cnt.push_back(kv.second);
+    }
+    for (IdType i = indptr[row]; i < indptr[row + 1]; ++i) {
+      map[eids[i]] = b_indptr.back() + std::distance(
+          row_cnt.begin(), row_cnt.find(indices[i]));
+    }
+    b_indptr.push_back(b_indices.size());
+  }
+
+  auto ret = CSRToSimple(csr);
+  aten::CSRMatrix csr_b = std::get<0>(ret);
+  ASSERT_TRUE(ArrayEQ<IdType>(csr_b.indptr, aten::VecToIdArray(b_indptr, sizeof(IdType) * 8)));
+  ASSERT_TRUE(ArrayEQ<IdType>(csr_b.indices, aten::VecToIdArray(b_indices, sizeof(IdType) * 8)));
+  ASSERT_TRUE(ArrayEQ<IdType>(std::get<1>(ret), aten::VecToIdArray(cnt, sizeof(IdType) * 8)));
+  ASSERT_TRUE(ArrayEQ<IdType>(std::get<2>(ret), aten::VecToIdArray(map, sizeof(IdType) * 8)));
+  ASSERT_TRUE(csr_b.sorted);
+}
+
+TEST(MatrixTest, TestToSimpleCsrLargeRows) {
+  _TestToSimpleCsrLargeRows<int32_t>();
+  _TestToSimpleCsrLargeRows<int64_t>();
+}
+
 template <typename IdType>
 void _TestToSimpleCoo(DLContext ctx) {
  /* 
@@ -785,6 +889,71 @@ TEST(DisjointUnionTest, TestDisjointUnionPartitionCsr) {
 #endif
 }
 
+template <typename IdType>
+void _TestDisjointUnionPartitionBatch(DLContext ctx) {
+  // a large batch of small matrices without data array, some of them empty
+  const int64_t batch_size = 2000;
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int64_t> size(0, 6);
+  std::vector<aten::CSRMatrix> csrs;
+  std::vector<aten::COOMatrix> coos;
+  std::vector<uint64_t> edge_cumsum(1, 0), src_cumsum(1, 0), dst_cumsum(1, 0);
+  std::vector<IdType> indptr(1, 0), indices;
+  for (int64_t g = 0; g < batch_size; ++g) {
+    const int64_t num_rows = size(gen), num_cols = size(gen) + 1;
+    std::vector<IdType> g_indptr(1, 0), g_indices;
+    for (int64_t i = 0; i < num_rows; ++i) {
+      for (int64_t j = 0; j < num_cols; ++j) {
+        if (gen() % 2) {
+          g_indices.push_back(j);
+          indices.push_back(j + dst_cumsum.back());
+        }
+      }
+      g_indptr.push_back(g_indices.size());
+      indptr.push_back(indices.size());
+    }
+    csrs.push_back(aten::CSRMatrix(
+        num_rows, num_cols, aten::VecToIdArray(g_indptr, sizeof(IdType)*8, ctx),
+        aten::VecToIdArray(g_indices, sizeof(IdType)*8, ctx), aten::NullArray(), true));
+    coos.push_back(aten::CSRToCOO(csrs.back(), false));
+    edge_cumsum.push_back(edge_cumsum.back() + g_indices.size());
+    src_cumsum.push_back(src_cumsum.back() + num_rows);
+    dst_cumsum.push_back(dst_cumsum.back() + num_cols);
+  }
+
+  const aten::CSRMatrix csr = aten::DisjointUnionCsr(csrs);
+  ASSERT_EQ(csr.num_rows, src_cumsum.back());
+  ASSERT_EQ(csr.num_cols, dst_cumsum.back());
+  ASSERT_FALSE(aten::CSRHasData(csr));
+  ASSERT_TRUE(ArrayEQ<IdType>(csr.indptr, aten::VecToIdArray(indptr, sizeof(IdType)*8, ctx)));
+  ASSERT_TRUE(ArrayEQ<IdType>(csr.indices, aten::VecToIdArray(indices, sizeof(IdType)*8, ctx)));
+  const aten::COOMatrix coo = aten::DisjointUnionCoo(coos);
+  const aten::COOMatrix expected_coo = aten::CSRToCOO(csr, false);
+  ASSERT_FALSE(aten::COOHasData(coo));
+  ASSERT_TRUE(ArrayEQ<IdType>(coo.row, expected_coo.row));
+  ASSERT_TRUE(ArrayEQ<IdType>(coo.col, expected_coo.col));
+
+  const auto p_csrs = aten::DisjointPartitionCsrBySizes(
+      csr, batch_size, edge_cumsum, src_cumsum, dst_cumsum);
+  const auto p_coos = aten::DisjointPartitionCooBySizes(
+      coo, batch_size, edge_cumsum, src_cumsum, dst_cumsum);
+  ASSERT_EQ(p_csrs.size(), static_cast<size_t>(batch_size));
+  ASSERT_EQ(p_coos.size(), static_cast<size_t>(batch_size));
+  for (int64_t g = 0; g < batch_size; ++g) {
+    ASSERT_EQ(p_csrs[g].num_rows, csrs[g].num_rows);
+    ASSERT_EQ(p_csrs[g].num_cols, csrs[g].num_cols);
+    ASSERT_TRUE(ArrayEQ<IdType>(p_csrs[g].indptr, csrs[g].indptr));
+    ASSERT_TRUE(ArrayEQ<IdType>(p_csrs[g].indices, csrs[g].indices));
+    ASSERT_TRUE(ArrayEQ<IdType>(p_coos[g].row, coos[g].row));
+    ASSERT_TRUE(ArrayEQ<IdType>(p_coos[g].col, coos[g].col));
+  }
+}
+
+TEST(DisjointUnionTest, TestDisjointUnionPartitionBatch) {
+  _TestDisjointUnionPartitionBatch<int32_t>(CPU);
+  _TestDisjointUnionPartitionBatch<int64_t>(CPU);
+}
+
 template <typename IdType>
 void _TestSliceContiguousChunkCoo(DLContext ctx) {
   /*
@@ -1438,6 +1607,26 @@ void _TestScatter_(DLContext ctx) {
   ASSERT_TRUE(ArrayEQ<IDX>(out, tout));
 }
 
+template <typename IDX, typename D>
+void _TestScatterRows_(DLContext ctx) {
+  const DLDataType dtype{kDLInt, sizeof(IDX)*8, 1};
+  IdArray out = aten::Full(1, 8, 8*sizeof(IDX), ctx).CreateView({4, 2}, dtype);
+  IdArray idx = aten::VecToIdArray(std::vector<D>({3, 0}), sizeof(D)*8, ctx);
+  IdArray val = aten::VecToIdArray(std::vector<IDX>({30, 31, 0, -1}), sizeof(IDX)*8, ctx)
+    .CreateView({2, 2}, dtype);
+  aten::Scatter_(idx, val, out);
+  IdArray tout = aten::VecToIdArray(
+      std::vector<IDX>({0, -1, 1, 1, 1, 1, 30, 31}), sizeof(IDX)*8, ctx);
+  ASSERT_TRUE(ArrayEQ<IDX>(out.CreateView({8}, dtype), tout));
+}
+
+TEST(ArrayTest, ScatterRows_) {
+  _TestScatterRows_<int32_t, int32_t>(CPU);
+  _TestScatterRows_<int64_t, int32_t>(CPU);
+  _TestScatterRows_<int32_t, int64_t>(CPU);
+  _TestScatterRows_<int64_t, int64_t>(CPU);
+}
+
 TEST(ArrayTest, Scatter_) {
   _TestScatter_<int32_t, int32_t>(CPU);
   _TestScatter_<int64_t, int32_t>(CPU);
@@ -1620,6 +1809,24 @@ void _TestSort(DLContext ctx) {
   std::tie(sorted, idx) = aten::Sort(a);
   ASSERT_TRUE(ArrayEQ<IDX>(sorted, sorted_a));
   ASSERT_TRUE(ArrayEQ<IDX>(idx, sorted_idx));
+
+  // case 4: large array with negative and duplicated values, sorted stably
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int64_t> dist(-1000, 100000);
+  std::vector<IDX> vals(200000);
+  for (auto& v : vals)
+    v = dist(gen);
+  std::vector<int64_t> order(vals.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&vals](int64_t i, int64_t j) { return vals[i] < vals[j]; });
+  std::vector<IDX> sorted_vals(vals.size());
+  for (size_t i = 0; i < vals.size(); ++i)
+    sorted_vals[i] = vals[order[i]];
+  a = aten::VecToIdArray(vals, sizeof(IDX)*8, ctx);
+  std::tie(sorted, idx) = aten::Sort(a);
+  ASSERT_TRUE(ArrayEQ<IDX>(sorted, aten::VecToIdArray(sorted_vals, sizeof(IDX)*8, ctx)));
+  ASSERT_TRUE(ArrayEQ<int64_t>(idx, aten::VecToIdArray(order, 64, ctx)));
 }
 
 TEST(ArrayTest, Sort) {
@@ -0,0 +1,103 @@
+#include <../src/runtime/caching_allocator.h>
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+using namespace dgl::runtime;
+
+namespace {
+
+int num_raw_allocs = 0;
+
+void* RawAlloc(size_t nbytes, size_t alignment) {
+  ++num_raw_allocs;
+  void* ptr = nullptr;
+#ifdef _WIN32
+  ptr = _aligned_malloc(nbytes, alignment);
+#else
+  if (posix_memalign(&ptr, alignment, nbytes) != 0)
+    ptr = nullptr;
+#endif
+  return ptr;
+}
+
+void RawFree(void* ptr) {
+#ifdef _WIN32
+  _aligned_free(ptr);
+#else
+  free(ptr);
+#endif
+}
+
+}  // namespace
+
+TEST(CachingAllocatorTest, TestSizeClass) {
+  ASSERT_EQ(CachingAllocator::SizeClass(1), 0);
+  ASSERT_EQ(CachingAllocator::SizeClass(64), 0);
+  ASSERT_EQ(CachingAllocator::ClassBytes(CachingAllocator::SizeClass(65)), 80);
+  ASSERT_EQ(CachingAllocator::ClassBytes(CachingAllocator::SizeClass(128)), 128);
+  ASSERT_EQ(CachingAllocator::ClassBytes(CachingAllocator::SizeClass(1000)), 1024);
+  ASSERT_EQ(CachingAllocator::ClassBytes(CachingAllocator::SizeClass(1025)), 1280);
+  ASSERT_EQ(CachingAllocator::SizeClass(size_t(1) << 41), -1);
+  for (size_t n = 1; n < 100000; n = n * 3 / 2 + 1) {
+    const size_t bytes = CachingAllocator::ClassBytes(CachingAllocator::SizeClass(n));
+    ASSERT_GE(bytes, n);
+    ASSERT_LE(bytes, n * 5 / 4 + 64);
+  }
+}
+
+TEST(CachingAllocatorTest, TestReuse) {
+  num_raw_allocs = 0;
+  CachingAllocator allocator(RawAlloc, RawFree, 4 << 20);
+  void* a = allocator.Alloc(1000, 64);
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(a) % 64, 0);
+  allocator.Free(a);
+  // the same class is reused, by the same and another thread
+  void* b = allocator.Alloc(900, 64);
+  ASSERT_EQ(a, b);
+  allocator.Free(b);
+  void* big = allocator.Alloc(1 << 20, 64);
+  allocator.Free(big);
+  std::thread thread([&]() {
+    void* c = allocator.Alloc(1 << 20, 64);
+    ASSERT_EQ(big, c);
+    allocator.Free(c);
+  });
+  thread.join();
+  ASSERT_EQ(num_raw_allocs, 2);
+
+  // the larger alignments are not cached
+  void* aligned = allocator.Alloc(100, 4096);
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(aligned) % 4096, 0);
+  allocator.Free(aligned);
+
+  CachingAllocator::Stats stats = allocator.GetStats();
+  ASSERT_EQ(stats.num_allocs, 5);
+  ASSERT_EQ(stats.num_hits, 2);
+  ASSERT_EQ(stats.bytes_in_use, 0);
+  ASSERT_EQ(stats.bytes_cached, 1024 + (1 << 20));
+}
+
+TEST(CachingAllocatorTest, TestCap) {
+  CachingAllocator allocator(RawAlloc, RawFree, 3 << 20);
+  std::vector<void*> blocks;
+  for (int i = 0; i < 4; ++i)
+    blocks.push_back(allocator.Alloc(1 << 20, 64));
+  for (void* ptr : blocks)
+    allocator.Free(ptr);
+  CachingAllocator::Stats stats = allocator.GetStats();
+  ASSERT_EQ(stats.bytes_cached, 3 << 20);
+  ASSERT_EQ(stats.num_releases, 1);
+  ASSERT_EQ(stats.peak_bytes_in_use, 4 << 20);
+
+  allocator.SetCap(1 << 20);
+  ASSERT_EQ(allocator.GetStats().bytes_cached, 1 << 20);
+  allocator.EmptyCache();
+  ASSERT_EQ(allocator.GetStats().bytes_cached, 0);
+  ASSERT_EQ(allocator.GetStats().num_releases, 4);
+}
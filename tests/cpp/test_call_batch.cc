@@ -0,0 +1,41 @@
+#include <dgl/runtime/packed_func.h>
+#include <dgl/runtime/registry.h>
+#include <gtest/gtest.h>
+#include <string>
+
+using namespace dgl::runtime;
+
+TEST(CallBatchTest, TestCallBatch) {
+  const PackedFunc* call_batch = Registry::Get("_CallBatch");
+  ASSERT_TRUE(call_batch != nullptr);
+  PackedFunc add([](DGLArgs args, DGLRetValue* rv) {
+    const int64_t a = args[0];
+    const int64_t b = args[1];
+    *rv = a + b;
+  });
+  PackedFunc concat([](DGLArgs args, DGLRetValue* rv) {
+    const std::string a = args[0];
+    const int64_t b = args[1];
+    *rv = a + std::to_string(b);
+  });
+
+  // (1 + 2) + 3, then "x" followed by the result
+  const std::string ret = (*call_batch)(
+      3,
+      add, 2, 1, 2,
+      add, 2, nullptr, 3,
+      concat, 2, "x", nullptr,
+      2,
+      1, 0, 0,
+      2, 1, 1);
+  ASSERT_EQ(ret, "x6");
+
+  // a result of a later call cannot be used
+  bool thrown = false;
+  try {
+    (*call_batch)(2, add, 2, nullptr, 1, add, 2, 1, 1, 1, 0, 0, 1);
+  } catch (const dmlc::Error&) {
+    thrown = true;
+  }
+  ASSERT_TRUE(thrown);
+}
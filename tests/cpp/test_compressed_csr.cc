@@ -0,0 +1,159 @@
+#include <../src/array/cpu/spmm.h>
+#include <dgl/array.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <set>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include "./common.h"
+
+using namespace dgl;
+using namespace dgl::runtime;
+
+namespace {
+
+// A CSR matrix with unsorted rows, empty rows, rows longer than a block and
+// column indices taking several bytes.
+template <typename IdType>
+aten::CSRMatrix RandomCSR(int64_t num_rows, int64_t num_cols, bool with_data,
+                          std::mt19937* gen) {
+  std::uniform_int_distribution<int64_t> col(0, num_cols - 1), deg(0, 10);
+  std::vector<IdType> indptr(1, 0), indices;
+  for (int64_t i = 0; i < num_rows; ++i) {
+    const int64_t d = (i % 7 == 0) ? 300 : (i % 5 == 0) ? 0 : deg(*gen);
+    for (int64_t j = 0; j < d; ++j)
+      indices.push_back(col(*gen));
+    indptr.push_back(indices.size());
+  }
+  std::vector<IdType> data(indices.size());
+  std::iota(data.rbegin(), data.rend(), 0);
+  return aten::CSRMatrix(
+      num_rows, num_cols,
+      aten::VecToIdArray(indptr, sizeof(IdType) * 8, CTX),
+      aten::VecToIdArray(indices, sizeof(IdType) * 8, CTX),
+      with_data ? aten::VecToIdArray(data, sizeof(IdType) * 8, CTX) : aten::NullArray());
+}
+
+template <typename IdType>
+void _TestCompressDecompress(bool with_data) {
+  std::mt19937 gen(42);
+  const auto csr = RandomCSR<IdType>(200, 100000, with_data, &gen);
+  const auto ccsr = aten::CSRCompress(csr);
+  ASSERT_EQ(ccsr.num_rows, 200);
+  ASSERT_EQ(ccsr.num_cols, 100000);
+  ASSERT_EQ(aten::CompressedCSRNNZ(ccsr), csr.indices->shape[0]);
+  ASSERT_EQ(ccsr.indices->dtype.bits, 8);
+  // fewer bytes than the plain indices
+  ASSERT_LT(ccsr.indices->shape[0],
+            csr.indices->shape[0] * static_cast<int64_t>(sizeof(IdType)));
+
+  const auto sorted = aten::CSRSort(csr);
+  const auto dcsr = aten::CompressedCSRDecompress(ccsr);
+  ASSERT_TRUE(dcsr.sorted);
+  ASSERT_TRUE(ArrayEQ<IdType>(dcsr.indptr, sorted.indptr));
+  ASSERT_TRUE(ArrayEQ<IdType>(dcsr.indices, sorted.indices));
+  ASSERT_EQ(aten::CompressedCSRHasData(ccsr), aten::CSRHasData(sorted));
+  if (aten::CSRHasData(sorted))
+    ASSERT_TRUE(ArrayEQ<IdType>(dcsr.data, sorted.data));
+}
+
+template <typename IdType>
+void _TestCompressImplicitData() {
+  std::mt19937 gen(42);
+  auto csr = aten::CSRSort(RandomCSR<IdType>(50, 1000, false, &gen));
+  // the data is the identity once the rows are sorted
+  csr.data = aten::Range(0, csr.indices->shape[0], sizeof(IdType) * 8, CTX);
+  ASSERT_FALSE(aten::CompressedCSRHasData(aten::CSRCompress(csr)));
+}
+
+template <typename IdType>
+void _TestCompressedSampling(bool replace) {
+  std::mt19937 gen(42);
+  const auto csr = RandomCSR<IdType>(200, 100000, true, &gen);
+  const auto ccsr = aten::CSRCompress(csr);
+  const IdType* indptr = Ptr<IdType>(csr.indptr);
+  const IdType* indices = Ptr<IdType>(csr.indices);
+  const IdType* data = Ptr<IdType>(csr.data);
+  std::set<std::tuple<IdType, IdType, IdType>> entries;
+  for (int64_t i = 0; i < csr.num_rows; ++i) {
+    for (IdType j = indptr[i]; j < indptr[i + 1]; ++j)
+      entries.emplace(i, indices[j], data[j]);
+  }
+
+  std::vector<IdType> rows(csr.num_rows);
+  std::iota(rows.begin(), rows.end(), 0);
+  const int64_t num_samples = 5;
+  const auto coo = aten::CompressedCSRRowWiseSamplingUniform(
+      ccsr, aten::VecToIdArray(rows, sizeof(IdType) * 8, CTX), num_samples, replace);
+  int64_t expected_len = 0;
+  for (int64_t i = 0; i < csr.num_rows; ++i) {
+    const int64_t len = indptr[i + 1] - indptr[i];
+    expected_len += replace ? (len == 0 ? 0 : num_samples) : std::min(len, num_samples);
+  }
+  ASSERT_EQ(coo.row->shape[0], expected_len);
+  std::set<IdType> eids;
+  for (int64_t i = 0; i < expected_len; ++i) {
+    const auto entry = std::make_tuple(
+        Ptr<IdType>(coo.row)[i], Ptr<IdType>(coo.col)[i], Ptr<IdType>(coo.data)[i]);
+    ASSERT_EQ(entries.count(entry), 1);
+    eids.insert(std::get<2>(entry));
+  }
+  if (!replace)
+    ASSERT_EQ(static_cast<int64_t>(eids.size()), expected_len);
+}
+
+template <typename IdType, typename DType>
+void _TestSpMMSumCompressedCsr(bool with_data) {
+  std::mt19937 gen(42);
+  const int64_t num_cols = 3000, dim = 4;
+  const auto csr = RandomCSR<IdType>(100, num_cols, with_data, &gen);
+  const int64_t nnz = csr.indices->shape[0];
+  const auto ccsr = aten::CSRCompress(csr);
+  const auto dtype = DLDataType{kDLFloat, sizeof(DType) * 8, 1};
+  NDArray ufeat = NDArray::Empty({num_cols, dim}, dtype, CTX);
+  NDArray efeat = NDArray::Empty({nnz, dim}, dtype, CTX);
+  std::uniform_real_distribution<double> dist(-1., 1.);
+  for (int64_t i = 0; i < ufeat.NumElements(); ++i)
+    Ptr<DType>(ufeat)[i] = dist(gen);
+  for (int64_t i = 0; i < efeat.NumElements(); ++i)
+    Ptr<DType>(efeat)[i] = dist(gen);
+  const BcastOff bcast = CalcBcastOff("mul", ufeat, efeat);
+
+  NDArray out = aten::Full(static_cast<DType>(0), csr.num_rows * dim, CTX);
+  NDArray exp = aten::Full(static_cast<DType>(0), csr.num_rows * dim, CTX);
+  aten::cpu::SpMMSumCompressedCsr<IdType, DType, aten::cpu::op::Mul<DType>>(
+      bcast, ccsr, ufeat, efeat, out);
+  aten::cpu::SpMMSumCsrNaive<IdType, DType, aten::cpu::op::Mul<DType>>(
+      bcast, csr, Ptr<DType>(ufeat), Ptr<DType>(efeat), Ptr<DType>(exp));
+  const DType tol = std::is_same<DType, float>::value ? 1e-4 : 1e-10;
+  for (int64_t i = 0; i < csr.num_rows * dim; ++i)
+    ASSERT_NEAR(Ptr<DType>(out)[i], Ptr<DType>(exp)[i], tol);
+}
+
+}  // namespace
+
+TEST(CompressedCSRTest, TestCompressDecompress) {
+  _TestCompressDecompress<int32_t>(false);
+  _TestCompressDecompress<int64_t>(false);
+  _TestCompressDecompress<int32_t>(true);
+  _TestCompressDecompress<int64_t>(true);
+  _TestCompressImplicitData<int32_t>();
+  _TestCompressImplicitData<int64_t>();
+}
+
+TEST(CompressedCSRTest, TestRowWiseSamplingUniform) {
+  _TestCompressedSampling<int32_t>(true);
+  _TestCompressedSampling<int64_t>(true);
+  _TestCompressedSampling<int32_t>(false);
+  _TestCompressedSampling<int64_t>(false);
+}
+
+TEST(CompressedCSRTest, TestSpMMSum) {
+  _TestSpMMSumCompressedCsr<int32_t, float>(false);
+  _TestSpMMSumCompressedCsr<int64_t, double>(false);
+  _TestSpMMSumCompressedCsr<int32_t, double>(true);
+  _TestSpMMSumCompressedCsr<int64_t, float>(true);
+}
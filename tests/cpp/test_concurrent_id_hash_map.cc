@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include <dgl/array.h>
+#include <random>
+#include <vector>
+#include "../../src/array/cpu/array_utils.h"
+#include "../../src/array/cpu/concurrent_id_hash_map.h"
+#include "./common.h"
+
+using namespace dgl;
+using namespace dgl::runtime;
+using namespace dgl::aten;
+
+template <typename IdType>
+void _TestConcurrentIdHashMap(int64_t len, int64_t range, int num_updates) {
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int64_t> dist(0, range - 1);
+  IdHashMap<IdType> expected;
+  ConcurrentIdHashMap<IdType> hashmap;
+  for (int u = 0; u < num_updates; ++u) {
+    std::vector<IdType> ids(len);
+    for (auto &id : ids)
+      id = dist(gen);
+    IdArray arr = VecToIdArray(ids, sizeof(IdType) * 8, CTX);
+    expected.Update(arr);
+    hashmap.Update(arr);
+  }
+  // the ids are relabeled in the order of their first occurrence
+  ASSERT_EQ(hashmap.Size(), expected.Size());
+  ASSERT_TRUE(ArrayEQ<IdType>(hashmap.Values(), expected.Values()));
+
+  IdArray queries = Range(0, range + 10, sizeof(IdType) * 8, CTX);
+  ASSERT_TRUE(ArrayEQ<IdType>(hashmap.Map(queries, -1), expected.Map(queries, -1)));
+  for (IdType id = 0; id < range + 10; ++id)
+    ASSERT_EQ(hashmap.Contains(id), expected.Contains(id));
+}
+
+TEST(ConcurrentIdHashMapTest, TestUpdate) {
+  _TestConcurrentIdHashMap<int32_t>(10, 5, 3);
+  _TestConcurrentIdHashMap<int64_t>(10, 5, 3);
+  _TestConcurrentIdHashMap<int32_t>(100000, 30000, 3);
+  _TestConcurrentIdHashMap<int64_t>(100000, 30000, 3);
+  _TestConcurrentIdHashMap<int64_t>(100000, 1000000, 2);
+}
+
+TEST(ConcurrentIdHashMapTest, TestEmpty) {
+  ConcurrentIdHashMap<int64_t> hashmap;
+  ASSERT_EQ(hashmap.Size(), 0u);
+  ASSERT_FALSE(hashmap.Contains(0));
+  ASSERT_EQ(hashmap.Map(0, -1), -1);
+  ASSERT_EQ(hashmap.Values()->shape[0], 0);
+  hashmap.Update(NewIdArray(0, CTX, 64));
+  ASSERT_EQ(hashmap.Size(), 0u);
+}
+
+TEST(IdHashMapTest, TestFilterGrowth) {
+  // the filter grows past the ids given at first without losing them
+  IdHashMap<int64_t> hashmap(VecToIdArray(std::vector<int64_t>({3, 1 << 25, 3}), 64, CTX));
+  std::vector<int64_t> ids(10000);
+  for (int64_t i = 0; i < 10000; ++i)
+    ids[i] = i * 997;
+  hashmap.Update(VecToIdArray(ids, 64, CTX));
+  ASSERT_EQ(hashmap.Map(3, -1), 0);
+  ASSERT_EQ(hashmap.Map(1 << 25, -1), 1);
+  ASSERT_EQ(hashmap.Map(0, -1), 2);
+  ASSERT_EQ(hashmap.Map(997 * 9999, -1), 10001);
+  ASSERT_FALSE(hashmap.Contains(1));
+  ASSERT_FALSE(hashmap.Contains((1 << 25) + 1024));
+}
@@ -169,6 +169,51 @@ void _TestCsrmask(DLContext ctx = CTX) {
   ASSERT_TRUE(ArrayEQ<DType>(A_mask_C, A_mask_C2));
 }
 
+template <typename DType>
+NDArray Scale(NDArray weights, DType factor, DLContext ctx) {
+  std::vector<DType> vec = weights.CopyTo(CPU).ToVector<DType>();
+  for (auto& w : vec)
+    w *= factor;
+  return NDArray::FromVector(vec, ctx);
+}
+
+template <typename IdType, typename DType>
+void _TestCsrmmPlan(DLContext ctx = CTX) {
+  auto A = CSR_A<IdType, DType>(ctx);
+  auto B = CSR_B<IdType, DType>(ctx);
+  auto A_mm_B2 = CSR_A_mm_B<IdType, DType>(ctx);
+  auto gA = CreateFromCSR(2, A.first);
+  auto gB = CreateFromCSR(2, B.first);
+  auto C = aten::CSRMM(gA, A.second, gB, B.second, 2);
+  ASSERT_TRUE(C.first->GetCSRMatrix(0).sorted);
+  ASSERT_TRUE((CSRIsClose<IdType, DType>(
+      C.first->GetCSRMatrix(0), A_mm_B2.first, C.second, A_mm_B2.second, 1e-4, 1e-4)));
+  // Same graphs with other weights: only the numeric phase runs and the graph is reused.
+  auto C2 = aten::CSRMM(gA, Scale<DType>(A.second, 2, ctx), gB, B.second, 2);
+  ASSERT_EQ(C2.first, C.first);
+  ASSERT_TRUE((CSRIsClose<IdType, DType>(
+      C2.first->GetCSRMatrix(0), A_mm_B2.first, C2.second,
+      Scale<DType>(A_mm_B2.second, 2, ctx), 1e-4, 1e-4)));
+}
+
+template <typename IdType, typename DType>
+void _TestCsrsumPlan(DLContext ctx = CTX) {
+  auto A = CSR_A<IdType, DType>(ctx);
+  auto C = CSR_C<IdType, DType>(ctx);
+  auto A_plus_C2 = CSR_A_plus_C<IdType, DType>(ctx);
+  auto gA = CreateFromCSR(2, A.first);
+  auto gC = CreateFromCSR(2, C.first);
+  auto S = aten::CSRSum({gA, gC}, {A.second, C.second});
+  ASSERT_TRUE((CSRIsClose<IdType, DType>(
+      S.first->GetCSRMatrix(0), A_plus_C2.first, S.second, A_plus_C2.second, 1e-4, 1e-4)));
+  auto S2 = aten::CSRSum(
+      {gA, gC}, {Scale<DType>(A.second, 3, ctx), Scale<DType>(C.second, 3, ctx)});
+  ASSERT_EQ(S2.first, S.first);
+  ASSERT_TRUE((CSRIsClose<IdType, DType>(
+      S2.first->GetCSRMatrix(0), A_plus_C2.first, S2.second,
+      Scale<DType>(A_plus_C2.second, 3, ctx), 1e-4, 1e-4)));
+}
+
 TEST(CsrmmTest, TestCsrmm) {
   _TestCsrmm<int32_t, float>(CPU);
   _TestCsrmm<int32_t, double>(CPU);
@@ -195,6 +240,32 @@ TEST(CsrmmTest, TestCsrsum) {
 #endif
 }
 
+TEST(CsrmmTest, TestCsrmmPlan) {
+  _TestCsrmmPlan<int32_t, float>(CPU);
+  _TestCsrmmPlan<int32_t, double>(CPU);
+  _TestCsrmmPlan<int64_t, float>(CPU);
+  _TestCsrmmPlan<int64_t, double>(CPU);
+#ifdef DGL_USE_CUDA
+  _TestCsrmmPlan<int32_t, float>(GPU);
+  _TestCsrmmPlan<int32_t, double>(GPU);
+  _TestCsrmmPlan<int64_t, float>(GPU);
+  _TestCsrmmPlan<int64_t, double>(GPU);
+#endif
+}
+
+TEST(CsrmmTest, TestCsrsumPlan) {
+  _TestCsrsumPlan<int32_t, float>(CPU);
+  _TestCsrsumPlan<int32_t, double>(CPU);
+  _TestCsrsumPlan<int64_t, float>(CPU);
+  _TestCsrsumPlan<int64_t, double>(CPU);
+#ifdef DGL_USE_CUDA
+  _TestCsrsumPlan<int32_t, float>(GPU);
+  _TestCsrsumPlan<int32_t, double>(GPU);
+  _TestCsrsumPlan<int64_t, float>(GPU);
+  _TestCsrsumPlan<int64_t, double>(GPU);
+#endif
+}
+
 TEST(CsrmmTest, TestCsrmask) {
   _TestCsrmask<int32_t, float>(CPU);
   _TestCsrmask<int32_t, double>(CPU);
@@ -0,0 +1,85 @@
+#include <../src/array/cpu/edge_softmax.h>
+#include <dgl/array.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <type_traits>
+#include <vector>
+#include "./common.h"
+
+using namespace dgl;
+using namespace dgl::runtime;
+
+namespace {
+
+template <typename DType>
+NDArray RandomNDArray(std::vector<int64_t> shape, std::mt19937* gen) {
+  NDArray ret = NDArray::Empty(shape, DLDataType{kDLFloat, sizeof(DType) * 8, 1}, CTX);
+  std::uniform_real_distribution<double> dist(-5., 5.);
+  DType* data = Ptr<DType>(ret);
+  for (int64_t i = 0; i < ret.NumElements(); ++i)
+    data[i] = static_cast<DType>(dist(*gen));
+  return ret;
+}
+
+template <typename IdType, typename DType>
+void _TestEdgeSoftmax(bool use_idx) {
+  /*
+   * Destination nodes 0..4; node 3 has no in-edge. The edge ids are permuted
+   * if use_idx.
+   */
+  const std::vector<IdType> indptr = {0, 3, 4, 8, 8, 10};
+  std::vector<IdType> eids = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+  if (use_idx)
+    eids = {4, 9, 0, 7, 1, 8, 2, 6, 3, 5};
+  const aten::CSRMatrix csc(
+      5, 4,
+      aten::VecToIdArray(indptr, sizeof(IdType) * 8, CTX),
+      aten::VecToIdArray(std::vector<IdType>({0, 1, 3, 2, 0, 1, 2, 3, 1, 1}),
+                         sizeof(IdType) * 8, CTX),
+      use_idx ? aten::VecToIdArray(eids, sizeof(IdType) * 8, CTX) : aten::NullArray());
+  const int64_t E = 10, H = 3;
+  std::mt19937 gen(42);
+  NDArray score = RandomNDArray<DType>({E, H}, &gen);
+  NDArray grad_out = RandomNDArray<DType>({E, H}, &gen);
+  NDArray out = NDArray::Empty({E, H}, DLDataType{kDLFloat, sizeof(DType) * 8, 1}, CTX);
+  NDArray grad_score = NDArray::Empty({E, H}, DLDataType{kDLFloat, sizeof(DType) * 8, 1}, CTX);
+  aten::cpu::EdgeSoftmaxForwardCsr<IdType, DType>(csc, score, out);
+  aten::cpu::EdgeSoftmaxBackwardCsr<IdType, DType>(csc, out, grad_out, grad_score);
+
+  const DType* S = Ptr<DType>(score);
+  const DType* G = Ptr<DType>(grad_out);
+  const DType tol = std::is_same<DType, float>::value ? 1e-5 : 1e-12;
+  for (int64_t v = 0; v < 5; ++v) {
+    for (int64_t h = 0; h < H; ++h) {
+      DType max_s = -std::numeric_limits<DType>::infinity(), sum = 0, accum = 0;
+      for (IdType j = indptr[v]; j < indptr[v + 1]; ++j)
+        max_s = std::max(max_s, S[eids[j] * H + h]);
+      for (IdType j = indptr[v]; j < indptr[v + 1]; ++j)
+        sum += std::exp(S[eids[j] * H + h] - max_s);
+      for (IdType j = indptr[v]; j < indptr[v + 1]; ++j) {
+        const DType y = std::exp(S[eids[j] * H + h] - max_s) / sum;
+        ASSERT_NEAR(Ptr<DType>(out)[eids[j] * H + h], y, tol);
+        accum += y * G[eids[j] * H + h];
+      }
+      for (IdType j = indptr[v]; j < indptr[v + 1]; ++j) {
+        const DType y = Ptr<DType>(out)[eids[j] * H + h];
+        ASSERT_NEAR(Ptr<DType>(grad_score)[eids[j] * H + h],
+                    y * (G[eids[j] * H + h] - accum), tol);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+TEST(EdgeSoftmaxTest, TestEdgeSoftmax) {
+  for (bool use_idx : {false, true}) {
+    _TestEdgeSoftmax<int32_t, float>(use_idx);
+    _TestEdgeSoftmax<int64_t, float>(use_idx);
+    _TestEdgeSoftmax<int32_t, double>(use_idx);
+    _TestEdgeSoftmax<int64_t, double>(use_idx);
+  }
+}
@@ -0,0 +1,74 @@
+#ifndef _WIN32
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "../src/rpc/feature_cache.h"
+
+using dgl::rpc::FeatureCache;
+
+namespace {
+
+std::vector<char> Row(int64_t id) {
+  const int64_t value = id * 10;
+  const char* p = reinterpret_cast<const char*>(&value);
+  return std::vector<char>(p, p + sizeof(value));
+}
+
+int64_t Value(const char* row) {
+  return *reinterpret_cast<const int64_t*>(row);
+}
+
+}  // namespace
+
+TEST(FeatureCacheTest, TestAdmission) {
+  // room for 2 rows, admitted after 2 misses
+  FeatureCache cache(sizeof(int64_t), 2 * sizeof(int64_t), 2);
+  ASSERT_EQ(cache.capacity(), 2);
+  ASSERT_EQ(cache.Lookup(1), nullptr);
+  cache.Offer(1, Row(1).data());
+  ASSERT_EQ(cache.num_rows(), 0);
+  ASSERT_EQ(cache.Lookup(1), nullptr);
+  cache.Offer(1, Row(1).data());
+  ASSERT_EQ(cache.num_rows(), 1);
+  const char* row = cache.Lookup(1);
+  ASSERT_NE(row, nullptr);
+  ASSERT_EQ(Value(row), 10);
+  ASSERT_EQ(cache.num_hits(), 1);
+  ASSERT_EQ(cache.num_misses(), 2);
+
+  // once full, the unreferenced row is evicted first
+  for (int64_t id : {2, 3}) {
+    cache.Lookup(id);
+    cache.Lookup(id);
+  }
+  cache.Offer(2, Row(2).data());
+  cache.Lookup(1);
+  cache.Offer(3, Row(3).data());
+  ASSERT_EQ(cache.num_rows(), 2);
+  ASSERT_NE(cache.Lookup(1), nullptr);
+  ASSERT_EQ(cache.Lookup(2), nullptr);
+  ASSERT_EQ(Value(cache.Lookup(3)), 30);
+
+  const int64_t ids[] = {1, 4};
+  cache.Invalidate(ids, 2);
+  ASSERT_EQ(cache.num_rows(), 1);
+  ASSERT_EQ(cache.Lookup(1), nullptr);
+}
+
+TEST(FeatureCacheTest, TestPin) {
+  // pinned rows only
+  FeatureCache cache(sizeof(int64_t), 2 * sizeof(int64_t), 0);
+  ASSERT_TRUE(cache.Pin(5, Row(5).data()));
+  ASSERT_TRUE(cache.Pin(6, Row(6).data()));
+  ASSERT_FALSE(cache.Pin(7, Row(7).data()));
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_EQ(cache.Lookup(8), nullptr);
+    cache.Offer(8, Row(8).data());
+  }
+  ASSERT_EQ(cache.num_rows(), 2);
+  ASSERT_EQ(Value(cache.Lookup(5)), 50);
+  ASSERT_EQ(Value(cache.Lookup(6)), 60);
+}
+#endif  // _WIN32
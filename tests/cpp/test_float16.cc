@@ -0,0 +1,90 @@
+#include <../src/array/cpu/spmm.h>
+#include <dgl/array.h>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+#include "./common.h"
+
+using namespace dgl;
+using namespace dgl::runtime;
+using aten::cpu::BFloat16;
+using aten::cpu::Float16;
+
+TEST(Float16Test, TestFloat16Conversion) {
+  ASSERT_EQ(Float16(1.f).bits, 0x3C00);
+  ASSERT_EQ(Float16(-2.f).bits, 0xC000);
+  ASSERT_EQ(Float16(65504.f).bits, 0x7BFF);
+  ASSERT_EQ(Float16(1e6f).bits, 0x7C00);  // overflow to inf
+  ASSERT_EQ(Float16(std::pow(2.f, -24.f)).bits, 0x0001);  // smallest subnormal
+  // 1 + 2^-11 is a tie between 1 and 1 + 2^-10, rounded to even
+  ASSERT_EQ(Float16(1.f + std::pow(2.f, -11.f)).bits, 0x3C00);
+  ASSERT_TRUE(std::isnan(static_cast<float>(
+      Float16(std::numeric_limits<float>::quiet_NaN()))));
+  for (float f : {0.f, 1.f, -0.5f, 3.140625f, 65504.f, std::pow(2.f, -20.f)})
+    ASSERT_EQ(static_cast<float>(Float16(f)), f);
+  ASSERT_TRUE(std::isinf(static_cast<float>(Float16(1e6f))));
+}
+
+TEST(Float16Test, TestBFloat16Conversion) {
+  ASSERT_EQ(BFloat16(1.f).bits, 0x3F80);
+  ASSERT_EQ(BFloat16(-2.f).bits, 0xC000);
+  // 1 + 2^-8 is a tie between 1 and 1 + 2^-7, rounded to even
+  ASSERT_EQ(BFloat16(1.f + std::pow(2.f, -8.f)).bits, 0x3F80);
+  ASSERT_EQ(BFloat16(1.f + 3 * std::pow(2.f, -8.f)).bits, 0x3F82);
+  ASSERT_TRUE(std::isnan(static_cast<float>(
+      BFloat16(std::numeric_limits<float>::quiet_NaN()))));
+  for (float f : {0.f, 1.f, -0.5f, 3.140625f, 1e30f})
+    ASSERT_NEAR(static_cast<float>(BFloat16(f)), f, std::abs(f) / 128);
+}
+
+namespace {
+
+template <typename IdType, typename DType>
+void _TestSpMMSumCsrFloat16() {
+  // 6 destination nodes, 4 source nodes, node 5 has no in-edge
+  const aten::CSRMatrix csr(
+      6, 4,
+      aten::VecToIdArray(std::vector<IdType>({0, 2, 5, 6, 9, 10, 10}), sizeof(IdType) * 8, CTX),
+      aten::VecToIdArray(std::vector<IdType>({0, 3, 1, 2, 3, 0, 0, 1, 2, 3}),
+                         sizeof(IdType) * 8, CTX),
+      aten::NullArray());
+  const int64_t dim = 9;
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  const auto dtype = DLDataType{
+    std::is_same<DType, BFloat16>::value ? kDLBfloat : kDLFloat, 16, 1};
+  NDArray ufeat = NDArray::Empty({4, dim}, dtype, CTX);
+  NDArray efeat = NDArray::Empty({10, dim}, dtype, CTX);
+  NDArray out = NDArray::Empty({6, dim}, dtype, CTX);
+  for (int64_t i = 0; i < ufeat.NumElements(); ++i)
+    Ptr<DType>(ufeat)[i] = DType(dist(gen));
+  for (int64_t i = 0; i < efeat.NumElements(); ++i)
+    Ptr<DType>(efeat)[i] = DType(dist(gen));
+  const BcastOff bcast = CalcBcastOff("mul", ufeat, efeat);
+  aten::cpu::SpMMSumCsrFloat16<IdType, DType, aten::cpu::op::Mul<float>>(
+      bcast, csr, ufeat, efeat, out);
+
+  const IdType* indptr = Ptr<IdType>(csr.indptr);
+  const IdType* indices = Ptr<IdType>(csr.indices);
+  for (int64_t v = 0; v < 6; ++v) {
+    for (int64_t k = 0; k < dim; ++k) {
+      float exp = 0;
+      for (IdType j = indptr[v]; j < indptr[v + 1]; ++j)
+        exp += static_cast<float>(Ptr<DType>(ufeat)[indices[j] * dim + k]) *
+               static_cast<float>(Ptr<DType>(efeat)[j * dim + k]);
+      // only the result is rounded
+      ASSERT_EQ(Ptr<DType>(out)[v * dim + k].bits, DType(exp).bits);
+    }
+  }
+}
+
+}  // namespace
+
+TEST(Float16Test, TestSpMMSumCsrFloat16) {
+  _TestSpMMSumCsrFloat16<int32_t, Float16>();
+  _TestSpMMSumCsrFloat16<int64_t, Float16>();
+  _TestSpMMSumCsrFloat16<int32_t, BFloat16>();
+  _TestSpMMSumCsrFloat16<int64_t, BFloat16>();
+}
@@ -0,0 +1,127 @@
+#include <../src/array/cpu/fused_attention.h>
+#include <dgl/array.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <type_traits>
+#include <vector>
+#include "./common.h"
+
+using namespace dgl;
+using namespace dgl::runtime;
+
+namespace {
+
+template <typename DType>
+NDArray RandomNDArray(std::vector<int64_t> shape, std::mt19937* gen) {
+  NDArray ret = NDArray::Empty(shape, DLDataType{kDLFloat, sizeof(DType) * 8, 1}, CTX);
+  std::uniform_real_distribution<double> dist(-2., 2.);
+  DType* data = Ptr<DType>(ret);
+  for (int64_t i = 0; i < ret.NumElements(); ++i)
+    data[i] = static_cast<DType>(dist(*gen));
+  return ret;
+}
+
+/*
+ * Reference: materialize the edge scores, apply the softmax per destination
+ * node and head, then aggregate.
+ */
+template <typename IdType, typename DType>
+void FusedAttentionRef(bool use_dot, const aten::CSRMatrix& csc,
+                       NDArray lhs, NDArray rhs, NDArray feat, DType negative_slope,
+                       std::vector<DType>* out, std::vector<DType>* lse) {
+  const IdType* indptr = Ptr<IdType>(csc.indptr);
+  const IdType* indices = Ptr<IdType>(csc.indices);
+  const int64_t H = feat->shape[1], F = feat->shape[2], D = lhs->shape[2];
+  out->assign(csc.num_rows * H * F, 0);
+  lse->assign(csc.num_rows * H, -std::numeric_limits<DType>::infinity());
+  for (int64_t v = 0; v < csc.num_rows; ++v) {
+    for (int64_t h = 0; h < H; ++h) {
+      std::vector<DType> scores;
+      for (IdType j = indptr[v]; j < indptr[v + 1]; ++j) {
+        const IdType u = indices[j];
+        const DType* l = Ptr<DType>(lhs) + (u * H + h) * D;
+        const DType* r = Ptr<DType>(rhs) + (v * H + h) * D;
+        DType s = 0;
+        if (use_dot) {
+          for (int64_t d = 0; d < D; ++d) s += l[d] * r[d];
+        } else {
+          s = l[0] + r[0];
+        }
+        scores.push_back(s < 0 ? s * negative_slope : s);
+      }
+      if (scores.empty()) continue;
+      DType max_s = *std::max_element(scores.begin(), scores.end());
+      DType sum = 0;
+      for (DType s : scores) sum += std::exp(s - max_s);
+      (*lse)[v * H + h] = max_s + std::log(sum);
+      for (IdType j = indptr[v]; j < indptr[v + 1]; ++j) {
+        const IdType u = indices[j];
+        const DType w = std::exp(scores[j - indptr[v]] - max_s) / sum;
+        for (int64_t k = 0; k < F; ++k)
+          (*out)[(v * H + h) * F + k] += w * Ptr<DType>(feat)[(u * H + h) * F + k];
+      }
+    }
+  }
+}
+
+template <typename IdType, typename DType>
+void _TestFusedAttention(bool use_dot) {
+  /*
+   * Destination nodes 0..4, source nodes 0..3; node 3 has no in-edge.
+   */
+  const aten::CSRMatrix csc(
+      5, 4,
+      aten::VecToIdArray(std::vector<IdType>({0, 3, 4, 8, 8, 10}), sizeof(IdType) * 8, CTX),
+      aten::VecToIdArray(std::vector<IdType>({0, 1, 3, 2, 0, 1, 2, 3, 1, 1}),
+                         sizeof(IdType) * 8, CTX),
+      aten::NullArray());
+  const int64_t H = 3, D = use_dot ? 5 : 1, F = 7;
+  std::mt19937 gen(42);
+  NDArray lhs = RandomNDArray<DType>({4, H, D}, &gen);
+  NDArray rhs = RandomNDArray<DType>({5, H, D}, &gen);
+  NDArray feat = RandomNDArray<DType>({4, H, F}, &gen);
+  NDArray out = NDArray::Empty({5, H, F}, DLDataType{kDLFloat, sizeof(DType) * 8, 1}, CTX);
+  NDArray lse = NDArray::Empty({5, H}, DLDataType{kDLFloat, sizeof(DType) * 8, 1}, CTX);
+  const DType negative_slope = 0.2;
+
+  if (use_dot) {
+    aten::cpu::FusedAttentionCsr<IdType, DType, aten::cpu::op::AttnDot<DType>>(
+        csc, lhs, rhs, feat, negative_slope, out, lse);
+  } else {
+    aten::cpu::FusedAttentionCsr<IdType, DType, aten::cpu::op::AttnAdd<DType>>(
+        csc, lhs, rhs, feat, negative_slope, out, lse);
+  }
+
+  std::vector<DType> out_ref, lse_ref;
+  FusedAttentionRef<IdType, DType>(use_dot, csc, lhs, rhs, feat, negative_slope,
+                                   &out_ref, &lse_ref);
+  const DType tol = std::is_same<DType, float>::value ? 1e-4 : 1e-10;
+  for (size_t i = 0; i < out_ref.size(); ++i)
+    ASSERT_NEAR(Ptr<DType>(out)[i], out_ref[i], tol);
+  for (size_t i = 0; i < lse_ref.size(); ++i) {
+    if (std::isinf(lse_ref[i])) {
+      ASSERT_TRUE(std::isinf(Ptr<DType>(lse)[i]) && Ptr<DType>(lse)[i] < 0);
+    } else {
+      ASSERT_NEAR(Ptr<DType>(lse)[i], lse_ref[i], tol);
+    }
+  }
+}
+
+}  // namespace
+
+TEST(FusedAttentionTest, TestFusedAttentionAdd) {
+  _TestFusedAttention<int32_t, float>(false);
+  _TestFusedAttention<int64_t, float>(false);
+  _TestFusedAttention<int32_t, double>(false);
+  _TestFusedAttention<int64_t, double>(false);
+}
+
+TEST(FusedAttentionTest, TestFusedAttentionDot) {
+  _TestFusedAttention<int32_t, float>(true);
+  _TestFusedAttention<int64_t, float>(true);
+  _TestFusedAttention<int32_t, double>(true);
+  _TestFusedAttention<int64_t, double>(true);
+}
@@ -0,0 +1,32 @@
+#include <dgl/runtime/huge_page.h>
+#include <dgl/runtime/device_api.h>
+#include <gtest/gtest.h>
+#include <cstdint>
+
+using namespace dgl::runtime;
+
+TEST(HugePageTest, TestParseMode) {
+  ASSERT_EQ(huge_page::ParseMode("thp"), huge_page::Mode::kTransparent);
+  ASSERT_EQ(huge_page::ParseMode("2MB"), huge_page::Mode::k2MB);
+  ASSERT_EQ(huge_page::ParseMode("1GB"), huge_page::Mode::k1GB);
+  ASSERT_EQ(huge_page::ParseMode("4kB"), huge_page::Mode::kNone);
+}
+
+TEST(HugePageTest, TestAlloc) {
+  // whatever the mode, large buffers are usable and freed by the CPU allocator
+  const DLContext ctx{kDLCPU, 0};
+  const size_t size = 4 << 20;
+  void* ptr = DeviceAPI::Get(ctx)->AllocDataSpace(ctx, size, 64, DLDataType{kDLInt, 64, 1});
+  ASSERT_EQ(reinterpret_cast<uintptr_t>(ptr) % 64, 0);
+  int64_t* data = static_cast<int64_t*>(ptr);
+  for (size_t i = 0; i < size / sizeof(int64_t); ++i)
+    data[i] = i;
+  for (size_t i = 0; i < size / sizeof(int64_t); ++i)
+    ASSERT_EQ(data[i], i);
+  DeviceAPI::Get(ctx)->FreeDataSpace(ctx, ptr);
+
+  // small buffers never use huge pages
+  ASSERT_EQ(huge_page::Alloc(huge_page::kMinBytes - 1), nullptr);
+  int x;
+  ASSERT_FALSE(huge_page::Free(&x));
+}
@@ -0,0 +1,66 @@
+#include <dgl/array.h>
+#include <dgl/base_heterograph.h>
+#include <dgl/runtime/memory_tracker.h>
+#include <dgl/runtime/ndarray.h>
+#include <gtest/gtest.h>
+#include <vector>
+#include "./common.h"
+
+using namespace dgl;
+using namespace dgl::runtime;
+
+namespace {
+
+const int kSampler = static_cast<int>(MemoryTag::kSampler);
+const int kGraph = static_cast<int>(MemoryTag::kGraph);
+const int kCOO = static_cast<int>(SparseFormat::kCOO);
+const int kCSR = static_cast<int>(SparseFormat::kCSR);
+
+}  // namespace
+
+TEST(MemoryTrackerTest, TestAlloc) {
+  MemoryTracker* tracker = MemoryTracker::Global();
+  NDArray untracked = NDArray::Empty({100}, DLDataType{kDLInt, 64, 1}, CPU);
+  tracker->SetEnabled(true);
+  tracker->Reset();
+  const MemoryTracker::Snapshot before = tracker->GetSnapshot();
+  {
+    MemoryTagScope tag_scope(MemoryTag::kSampler);
+    NDArray a = NDArray::Empty({1000}, DLDataType{kDLInt, 64, 1}, CPU);
+    NDArray b = NDArray::Empty({10, 10}, DLDataType{kDLFloat, 32, 1}, CPU);
+    ASSERT_EQ(MemoryTagScope::Current(), MemoryTag::kSampler);
+    const MemoryTracker::Snapshot snapshot = tracker->GetSnapshot();
+    ASSERT_EQ(snapshot.tags[kSampler].bytes - before.tags[kSampler].bytes, 8400);
+    ASSERT_EQ(snapshot.tags[kSampler].num_allocs, 2);
+    ASSERT_EQ(snapshot.devices[0].bytes - before.devices[0].bytes, 8400);
+    a.CreateView({100}, a->dtype).CopyFrom(untracked);
+  }
+  ASSERT_EQ(MemoryTagScope::Current(), MemoryTag::kOther);
+  // the arrays allocated before are not uncounted
+  untracked = NDArray();
+  const MemoryTracker::Snapshot after = tracker->GetSnapshot();
+  ASSERT_EQ(after.tags[kSampler].bytes, before.tags[kSampler].bytes);
+  ASSERT_EQ(after.tags[kSampler].peak_bytes - before.tags[kSampler].bytes, 8400);
+  ASSERT_EQ(after.devices[0].bytes, before.devices[0].bytes);
+  ASSERT_EQ(after.num_copies[0][0], 1);
+  ASSERT_EQ(after.copy_bytes[0][0], 800);
+  tracker->SetEnabled(false);
+}
+
+TEST(MemoryTrackerTest, TestConversion) {
+  MemoryTracker* tracker = MemoryTracker::Global();
+  tracker->SetEnabled(true);
+  tracker->Reset();
+  const IdArray src = aten::VecToIdArray(std::vector<int64_t>({0, 1, 2, 2}));
+  const IdArray dst = aten::VecToIdArray(std::vector<int64_t>({1, 2, 0, 1}));
+  HeteroGraphPtr g = CreateFromCOO(1, 3, 3, src, dst);
+  const int64_t graph_bytes = tracker->GetSnapshot().tags[kGraph].bytes;
+  g->GetCSRMatrix(0);
+  g->GetCSRMatrix(0);
+  MemoryTracker::Snapshot snapshot = tracker->GetSnapshot();
+  ASSERT_EQ(snapshot.num_conversions[kCOO][kCSR], 1);
+  ASSERT_GT(snapshot.tags[kGraph].bytes, graph_bytes);
+  g = nullptr;
+  ASSERT_EQ(tracker->GetSnapshot().tags[kGraph].bytes, graph_bytes);
+  tracker->SetEnabled(false);
+}
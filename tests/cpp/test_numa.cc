@@ -0,0 +1,33 @@
+#include <dgl/runtime/numa.h>
+#include <dgl/runtime/parallel_for.h>
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <vector>
+
+using namespace dgl::runtime;
+
+TEST(NumaTest, TestParseCpuList) {
+  ASSERT_EQ(numa::ParseCpuList("0"), std::vector<int>({0}));
+  ASSERT_EQ(numa::ParseCpuList("0-3,8,10-11\n"),
+            std::vector<int>({0, 1, 2, 3, 8, 10, 11}));
+  ASSERT_TRUE(numa::ParseCpuList("").empty());
+}
+
+TEST(NumaTest, TestNumaMemory) {
+  ASSERT_GE(numa::NumNodes(), 1);
+  const size_t size = 8 << 20;
+  void* ptr = nullptr;
+  ASSERT_EQ(posix_memalign(&ptr, 4096, size), 0);
+  // neither of them changes what the buffer holds once written
+  numa::FirstTouch(ptr, size);
+  const size_t num = size / sizeof(int64_t);
+  int64_t* data = static_cast<int64_t*>(ptr);
+  parallel_for(0, num, [&](size_t b, size_t e) {
+    for (size_t i = b; i < e; ++i)
+      data[i] = i;
+  });
+  numa::Interleave(ptr, size);
+  for (size_t i = 0; i < num; ++i)
+    ASSERT_EQ(data[i], i);
+  free(ptr);
+}
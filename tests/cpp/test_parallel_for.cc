@@ -0,0 +1,103 @@
+#include <dgl/runtime/parallel_for.h>
+#include <dgl/runtime/task_scheduler.h>
+#include <gtest/gtest.h>
+#if defined(__linux__)
+#include <sched.h>
+#endif
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace dgl::runtime;
+
+TEST(ParallelForTest, TestParallelForWeighted) {
+  // power-law like costs: a few rows hold most of the cost
+  const size_t num = 100000;
+  std::vector<int64_t> cost_prefix(num + 1, 0);
+  for (size_t i = 0; i < num; ++i)
+    cost_prefix[i + 1] = cost_prefix[i] + (i % 1000 == 0 ? 10000 : i % 3);
+
+  const std::vector<std::pair<size_t, size_t>> ranges = {
+    {0, num}, {123, num - 45}, {7, 8}, {9, 9}};
+  for (const auto& range : ranges) {
+    std::vector<int> seen(num, 0);
+    std::vector<std::pair<size_t, size_t>> chunks;
+    std::mutex mutex;
+    parallel_for_weighted(range.first, range.second, cost_prefix.data(),
+                          [&](size_t b, size_t e) {
+      ASSERT_LT(b, e);
+      for (size_t i = b; i < e; ++i)
+        ++seen[i];
+      std::lock_guard<std::mutex> lock(mutex);
+      chunks.emplace_back(b, e);
+    });
+    // every element of the range is visited exactly once
+    for (size_t i = 0; i < num; ++i)
+      ASSERT_EQ(seen[i], (i >= range.first && i < range.second) ? 1 : 0);
+    if (range.first == range.second)
+      ASSERT_TRUE(chunks.empty());
+  }
+}
+
+TEST(ParallelForTest, TestTaskScheduler) {
+  TaskScheduler scheduler(3);
+  ASSERT_EQ(scheduler.NumThreads(), 4);
+  const size_t num = 10000;
+  std::vector<std::atomic<int>> seen(num);
+  for (auto& s : seen)
+    s = 0;
+  // nested loops of very different sizes
+  scheduler.ParallelFor(0, 4, 1, [&](size_t b, size_t e) {
+    for (size_t r = b; r < e; ++r) {
+      const size_t begin = r * num / 4;
+      const size_t end = begin + (r == 0 ? num / 4 : 10);
+      scheduler.ParallelFor(begin, end, 16, [&](size_t b2, size_t e2) {
+        ASSERT_LE(e2 - b2, 16);
+        for (size_t i = b2; i < e2; ++i)
+          ++seen[i];
+      });
+    }
+  });
+  for (size_t i = 0; i < num; ++i) {
+    const size_t r = i * 4 / num;
+    const size_t offset = i - r * num / 4;
+    ASSERT_EQ(seen[i], (r == 0 || offset < 10) ? 1 : 0);
+  }
+
+  // the first exception is rethrown once all ranges are done
+  std::atomic<int> num_done(0);
+  bool thrown = false;
+  try {
+    scheduler.ParallelFor(0, 100, 1, [&](size_t b, size_t e) {
+      ++num_done;
+      if (b == 50)
+        throw std::runtime_error("error");
+    });
+  } catch (const std::runtime_error&) {
+    thrown = true;
+  }
+  ASSERT_TRUE(thrown);
+  ASSERT_EQ(num_done, 100);
+}
+
+#if defined(__linux__)
+TEST(ParallelForTest, TestTaskSchedulerCores) {
+  // all the workers on the first cpu of the caller
+  cpu_set_t cpuset;
+  ASSERT_EQ(sched_getaffinity(0, sizeof(cpu_set_t), &cpuset), 0);
+  int cpu = 0;
+  while (!CPU_ISSET(cpu, &cpuset))
+    ++cpu;
+  TaskScheduler scheduler(2, {cpu, cpu, cpu});
+  const std::thread::id caller = std::this_thread::get_id();
+  std::atomic<int> num_misplaced(0);
+  scheduler.ParallelFor(0, 1000, 1, [&](size_t b, size_t e) {
+    if (std::this_thread::get_id() != caller && sched_getcpu() != cpu)
+      ++num_misplaced;
+  });
+  ASSERT_EQ(num_misplaced, 0);
+}
+#endif  // defined(__linux__)
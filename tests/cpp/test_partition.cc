@@ -197,3 +197,107 @@ TEST(PartitionTest, TestRangePartition) {
 #endif
   // CPU is not implemented
 }
+
+template<DLDeviceType XPU, typename IdType>
+NDArrayPartitionRef _CreateLookupPartition(
+    const int64_t size,
+    const int num_parts,
+    IdArray * const part_map_cpu) {
+  *part_map_cpu = aten::NewIdArray(size, CPU, sizeof(IdType)*8);
+  for (int64_t i = 0; i < size; ++i) {
+    // an arbitrary assignment, with parts of different sizes
+    Ptr<IdType>(*part_map_cpu)[i] = ((i * 7919) % 13) % num_parts;
+  }
+  return CreatePartitionLookupBased(
+      size, num_parts, part_map_cpu->CopyTo(DGLContext{XPU, 0}));
+}
+
+template<DLDeviceType XPU, typename IdType>
+void _TestLookup_GeneratePermutation() {
+  const int64_t size = 160000;
+  const int num_parts = 7;
+  IdArray part_map;
+  NDArrayPartitionRef part = _CreateLookupPartition<XPU, IdType>(
+      size, num_parts, &part_map);
+
+  IdArray idxs = aten::Range(0, size/10, sizeof(IdType)*8,
+      DGLContext{XPU, 0});
+
+  std::pair<IdArray, IdArray> result = part->GeneratePermutation(idxs);
+
+  // first part of result should be the permutation
+  IdArray perm = result.first.CopyTo(DGLContext{kDLCPU, 0});
+  ASSERT_TRUE(perm.Ptr<IdType>() != nullptr);
+  ASSERT_EQ(perm->shape[0], idxs->shape[0]);
+  const IdType * const perm_cpu = static_cast<const IdType*>(perm->data);
+
+  // second part of result should be the counts
+  IdArray counts = result.second.CopyTo(DGLContext{kDLCPU, 0});
+  ASSERT_TRUE(counts.Ptr<int64_t>() != nullptr);
+  ASSERT_EQ(counts->shape[0], num_parts);
+  const int64_t * const counts_cpu = static_cast<const int64_t*>(counts->data);
+
+  std::vector<int64_t> prefix(num_parts+1, 0);
+  for (int p = 0; p < num_parts; ++p) {
+    prefix[p+1] = prefix[p] + counts_cpu[p];
+  }
+  ASSERT_EQ(prefix.back(), idxs->shape[0]);
+
+  // copy original indexes to cpu
+  idxs = idxs.CopyTo(DGLContext{kDLCPU, 0});
+  const IdType * const idxs_cpu = static_cast<const IdType*>(idxs->data);
+
+  for (int p = 0; p < num_parts; ++p) {
+    for (int64_t i = prefix[p]; i < prefix[p+1]; ++i) {
+      EXPECT_EQ(Ptr<IdType>(part_map)[idxs_cpu[perm_cpu[i]]], p);
+    }
+  }
+}
+
+template<DLDeviceType XPU, typename IdType>
+void _TestLookup_MapToX() {
+  const int64_t size = 160000;
+  const int num_parts = 7;
+  IdArray part_map;
+  NDArrayPartitionRef part = _CreateLookupPartition<XPU, IdType>(
+      size, num_parts, &part_map);
+
+  int64_t total = 0;
+  for (int part_id = 0; part_id < num_parts; ++part_id) {
+    IdArray local = aten::Range(0, part->PartSize(part_id), sizeof(IdType)*8,
+        DGLContext{XPU, 0});
+    total += local->shape[0];
+    IdArray global = part->MapToGlobal(local, part_id);
+    IdArray act_local = part->MapToLocal(global).CopyTo(CPU);
+
+    // every global index should be assigned to the part, in increasing order
+    ASSERT_EQ(global->shape[0], local->shape[0]);
+    global = global.CopyTo(CPU);
+    for (size_t i = 0; i < global->shape[0]; ++i) {
+      EXPECT_EQ(Ptr<IdType>(part_map)[Ptr<IdType>(global)[i]], part_id) <<
+          "i=" << i << ", num_parts=" << num_parts << ", part_id=" << part_id;
+      if (i > 0) {
+        EXPECT_LT(Ptr<IdType>(global)[i-1], Ptr<IdType>(global)[i]);
+      }
+    }
+
+    // the remapped local indices to should match the original
+    local = local.CopyTo(CPU);
+    ASSERT_EQ(local->shape[0], act_local->shape[0]);
+    for (size_t i = 0; i < act_local->shape[0]; ++i) {
+      EXPECT_EQ(Ptr<IdType>(local)[i], Ptr<IdType>(act_local)[i]);
+    }
+  }
+  EXPECT_EQ(total, size);
+}
+
+TEST(PartitionTest, TestLookupPartition) {
+#ifdef DGL_USE_CUDA
+  _TestLookup_GeneratePermutation<kDLGPU, int32_t>();
+  _TestLookup_GeneratePermutation<kDLGPU, int64_t>();
+
+  _TestLookup_MapToX<kDLGPU, int32_t>();
+  _TestLookup_MapToX<kDLGPU, int64_t>();
+#endif
+  // CPU is not implemented
+}
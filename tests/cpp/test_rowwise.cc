@@ -1,7 +1,11 @@
 #include <gtest/gtest.h>
 #include <dgl/array.h>
+#include <dgl/random.h>
+#include <algorithm>
+#include <map>
 #include <tuple>
 #include <set>
+#include <vector>
 #include "./common.h"
 
 using namespace dgl;
@@ -216,6 +220,74 @@ TEST(RowwiseTest, TestCSRSampling) {
   _TestCSRSampling<int64_t, double>(false);
 }
 
+void _TestCSRSamplingUniformWideIndptr(bool has_data) {
+  // int64 row pointers and data with int32 column indices
+  auto mat = CSRNarrowIndices(CSR<int64_t>(has_data));
+  ASSERT_TRUE(CSRHasWideIndptr(mat));
+  IdArray rows = NDArray::FromVector(std::vector<int32_t>({0, 3}));
+  for (int k = 0; k < 10; ++k) {
+    auto rst = CSRRowWiseSampling(mat, rows, 2, FloatArray(), true);
+    ASSERT_EQ(rst.row->dtype.bits, 64);
+    CheckSampledResult<int64_t>(rst, NDArray::FromVector(std::vector<int64_t>({0, 3})),
+                                has_data);
+  }
+  for (int k = 0; k < 10; ++k) {
+    auto rst = CSRRowWiseSampling(mat, rows, 2, FloatArray(), false);
+    CheckSampledResult<int64_t>(rst, NDArray::FromVector(std::vector<int64_t>({0, 3})),
+                                has_data);
+    auto eset = ToEdgeSet<int64_t>(rst);
+    ASSERT_EQ(eset.size(), 4);
+  }
+}
+
+TEST(RowwiseTest, TestCSRSamplingUniformWideIndptr) {
+  _TestCSRSamplingUniformWideIndptr(true);
+  _TestCSRSamplingUniformWideIndptr(false);
+}
+
+template <typename Idx, typename FloatType>
+void _TestCSRSamplingAlias(bool has_data) {
+  auto mat = CSR<Idx>(has_data);
+  FloatArray prob = NDArray::FromVector(
+      std::vector<FloatType>({.5, .5, .5, .5, .5}));
+  IdArray rows = NDArray::FromVector(std::vector<Idx>({0, 3}));
+  auto table = CSRRowWiseAliasTable(mat, prob);
+  for (int k = 0; k < 10; ++k) {
+    auto rst = CSRRowWiseSamplingAlias(mat, rows, 2, prob, table.first, table.second, true);
+    CheckSampledResult<Idx>(rst, rows, has_data);
+  }
+  for (int k = 0; k < 10; ++k) {
+    auto rst = CSRRowWiseSamplingAlias(mat, rows, 2, prob, table.first, table.second, false);
+    CheckSampledResult<Idx>(rst, rows, has_data);
+    ASSERT_EQ(ToEdgeSet<Idx>(rst).size(), 4);
+  }
+  prob = NDArray::FromVector(
+      std::vector<FloatType>({.0, .5, .5, .0, .5}));
+  table = CSRRowWiseAliasTable(mat, prob);
+  for (int k = 0; k < 100; ++k) {
+    auto rst = CSRRowWiseSamplingAlias(mat, rows, 2, prob, table.first, table.second, true);
+    CheckSampledResult<Idx>(rst, rows, has_data);
+    auto eset = ToEdgeSet<Idx>(rst);
+    if (has_data) {
+      ASSERT_FALSE(eset.count(std::make_tuple(0, 1, 3)));
+    } else {
+      ASSERT_FALSE(eset.count(std::make_tuple(0, 0, 0)));
+      ASSERT_FALSE(eset.count(std::make_tuple(3, 2, 3)));
+    }
+  }
+}
+
+TEST(RowwiseTest, TestCSRSamplingAlias) {
+  _TestCSRSamplingAlias<int32_t, float>(true);
+  _TestCSRSamplingAlias<int64_t, float>(true);
+  _TestCSRSamplingAlias<int32_t, double>(true);
+  _TestCSRSamplingAlias<int64_t, double>(true);
+  _TestCSRSamplingAlias<int32_t, float>(false);
+  _TestCSRSamplingAlias<int64_t, float>(false);
+  _TestCSRSamplingAlias<int32_t, double>(false);
+  _TestCSRSamplingAlias<int64_t, double>(false);
+}
+
 template <typename Idx, typename FloatType>
 void _TestCSRSamplingUniform(bool has_data) {
   auto mat = CSR<Idx>(has_data);
@@ -254,6 +326,108 @@ TEST(RowwiseTest, TestCSRSamplingUniform) {
   _TestCSRSamplingUniform<int64_t, double>(false);
 }
 
+template <typename Idx, typename FloatType>
+void _TestCSRSamplingMasked(bool has_data) {
+  auto mat = CSR<Idx>(has_data);
+  IdArray rows = NDArray::FromVector(std::vector<Idx>({0, 3}));
+  // the edge of ID 3 is masked out, leaving three edges in the rows
+  NDArray mask = NDArray::Empty({5}, DLDataType{kDLInt, 8, 1}, CTX);
+  const std::vector<int8_t> mask_vec({1, 1, 1, 0, 1});
+  std::copy(mask_vec.begin(), mask_vec.end(), static_cast<int8_t*>(mask->data));
+  FloatArray prob = NDArray::FromVector(
+      std::vector<FloatType>({.5, .5, .5, .5, .5}));
+  for (FloatArray p : {FloatArray(aten::NullArray()), prob}) {
+    for (int k = 0; k < 10; ++k) {
+      auto rst = CSRRowWiseSampling(mat, rows, 2, p, true, mask);
+      CheckSampledResult<Idx>(rst, rows, has_data);
+      for (const auto& e : ToEdgeSet<Idx>(rst))
+        ASSERT_NE(std::get<2>(e), 3);
+    }
+    for (int k = 0; k < 10; ++k) {
+      auto rst = CSRRowWiseSampling(mat, rows, 2, p, false, mask);
+      CheckSampledResult<Idx>(rst, rows, has_data);
+      auto eset = ToEdgeSet<Idx>(rst);
+      ASSERT_EQ(eset.size(), 3);
+      for (const auto& e : eset)
+        ASSERT_NE(std::get<2>(e), 3);
+    }
+    auto rst = CSRRowWiseSampling(mat, rows, -1, p, true, mask);
+    ASSERT_EQ(rst.row->shape[0], 3);
+    ASSERT_EQ(ToEdgeSet<Idx>(rst).size(), 3);
+  }
+}
+
+TEST(RowwiseTest, TestCSRSamplingMasked) {
+  _TestCSRSamplingMasked<int32_t, float>(true);
+  _TestCSRSamplingMasked<int64_t, float>(true);
+  _TestCSRSamplingMasked<int32_t, double>(true);
+  _TestCSRSamplingMasked<int64_t, double>(true);
+  _TestCSRSamplingMasked<int32_t, float>(false);
+  _TestCSRSamplingMasked<int64_t, float>(false);
+  _TestCSRSamplingMasked<int32_t, double>(false);
+  _TestCSRSamplingMasked<int64_t, double>(false);
+}
+
+template <typename Idx>
+std::map<Idx, std::vector<Idx>> SampledEdgesByRow(COOMatrix mat) {
+  std::map<Idx, std::vector<Idx>> ret;
+  const Idx* row = static_cast<Idx*>(mat.row->data);
+  const Idx* data = static_cast<Idx*>(mat.data->data);
+  for (int64_t i = 0; i < mat.row->shape[0]; ++i)
+    ret[row[i]].push_back(data[i]);
+  return ret;
+}
+
+template <typename Idx>
+void _TestCSRSamplingRowStreams(bool replace) {
+  // 64 rows of 16 entries
+  const int64_t N = 64, deg = 16;
+  std::vector<Idx> indptr, indices;
+  for (int64_t i = 0; i <= N; ++i)
+    indptr.push_back(i * deg);
+  for (int64_t i = 0; i < N * deg; ++i)
+    indices.push_back(i % N);
+  CSRMatrix mat(N, N, NDArray::FromVector(indptr), NDArray::FromVector(indices));
+  std::vector<Idx> all_rows(N), some_rows;
+  for (int64_t i = 0; i < N; ++i) {
+    all_rows[i] = i;
+    if (i % 3 == 0)
+      some_rows.insert(some_rows.begin(), i);
+  }
+  const IdArray rows = NDArray::FromVector(all_rows);
+  const IdArray other_rows = NDArray::FromVector(some_rows);
+
+  // a row gets the same samples whatever the other rows
+  RowStreamScope scope(RowStreamKey::FromSeed(42));
+  const auto all = SampledEdgesByRow<Idx>(CSRRowWiseSampling(mat, rows, 4, FloatArray(), replace));
+  const auto again = SampledEdgesByRow<Idx>(
+      CSRRowWiseSampling(mat, rows, 4, FloatArray(), replace));
+  const auto some = SampledEdgesByRow<Idx>(
+      CSRRowWiseSampling(mat, other_rows, 4, FloatArray(), replace));
+  ASSERT_EQ(all, again);
+  ASSERT_EQ(some.size(), some_rows.size());
+  for (const auto& row_edges : some)
+    ASSERT_EQ(row_edges.second, all.at(row_edges.first));
+  // the same for a COO matrix
+  const auto coo_some = SampledEdgesByRow<Idx>(
+      COORowWiseSampling(CSRToCOO(mat, false), other_rows, 4, FloatArray(), replace));
+  const auto coo_all = SampledEdgesByRow<Idx>(
+      COORowWiseSampling(CSRToCOO(mat, false), rows, 4, FloatArray(), replace));
+  for (const auto& row_edges : coo_some)
+    ASSERT_EQ(row_edges.second, coo_all.at(row_edges.first));
+
+  // another key gives other samples
+  RowStreamScope other_scope(RowStreamKey::FromSeed(43));
+  ASSERT_NE(all, SampledEdgesByRow<Idx>(CSRRowWiseSampling(mat, rows, 4, FloatArray(), replace)));
+}
+
+TEST(RowwiseTest, TestCSRSamplingRowStreams) {
+  _TestCSRSamplingRowStreams<int32_t>(true);
+  _TestCSRSamplingRowStreams<int64_t>(true);
+  _TestCSRSamplingRowStreams<int32_t>(false);
+  _TestCSRSamplingRowStreams<int64_t>(false);
+}
+
 template <typename Idx, typename FloatType>
 void _TestCSRPerEtypeSampling(bool has_data) {
   auto mat = CSREtypes<Idx>(has_data);
@@ -1028,6 +1202,119 @@ TEST(RowwiseTest, TestCSRTopk) {
   _TestCSRTopk<int64_t, double>(false);
 }
 
+template <typename Idx, typename FloatType>
+void _TestCSRTopkOrdered(bool has_data) {
+  auto mat = CSR<Idx>(has_data);
+  FloatArray weight = NDArray::FromVector(
+      std::vector<FloatType>({.1f, .0f, -.1f, .2f, .5f}));
+  IdArray rows = NDArray::FromVector(std::vector<Idx>({0, 1, 3}));
+  for (bool ascending : {true, false}) {
+    IdArray order = CSRRowWiseTopkOrder(mat, weight, ascending);
+    for (int64_t k : {1, 2}) {
+      auto rst = CSRRowWiseTopkOrdered(mat, rows, k, order);
+      auto ans = CSRRowWiseTopk(mat, rows, k, weight, ascending);
+      ASSERT_EQ(ToEdgeSet<Idx>(rst), ToEdgeSet<Idx>(ans));
+    }
+  }
+
+  // a hub row selected with the heap and with the partition
+  const Idx len = 100;
+  std::vector<Idx> indices(len);
+  std::vector<FloatType> weights(len);
+  for (Idx i = 0; i < len; ++i) {
+    indices[i] = i;
+    weights[i] = (i * 37) % len;
+  }
+  auto hub = CSRMatrix(
+      1, len, NDArray::FromVector(std::vector<Idx>({0, len})),
+      NDArray::FromVector(indices));
+  FloatArray hub_weight = NDArray::FromVector(weights);
+  IdArray hub_rows = NDArray::FromVector(std::vector<Idx>({0}));
+  IdArray order = CSRRowWiseTopkOrder(hub, hub_weight, false);
+  for (int64_t k : {5, 40}) {
+    for (auto rst : {CSRRowWiseTopk(hub, hub_rows, k, hub_weight, false),
+                     CSRRowWiseTopkOrdered(hub, hub_rows, k, order)}) {
+      ASSERT_EQ(rst.data->shape[0], k);
+      const Idx* data = static_cast<Idx*>(rst.data->data);
+      for (int64_t j = 0; j < k; ++j)
+        ASSERT_GE(weights[data[j]], len - k);
+    }
+  }
+}
+
+TEST(RowwiseTest, TestCSRTopkOrdered) {
+  _TestCSRTopkOrdered<int32_t, float>(true);
+  _TestCSRTopkOrdered<int64_t, float>(true);
+  _TestCSRTopkOrdered<int32_t, double>(true);
+  _TestCSRTopkOrdered<int64_t, double>(true);
+  _TestCSRTopkOrdered<int32_t, float>(false);
+  _TestCSRTopkOrdered<int64_t, float>(false);
+  _TestCSRTopkOrdered<int32_t, double>(false);
+  _TestCSRTopkOrdered<int64_t, double>(false);
+}
+
+
+template <typename Idx, typename DType>
+void _TestCSRSamplingTemporal(bool has_data) {
+  auto mat = CSR<Idx>(has_data);
+  NDArray timestamp = NDArray::FromVector(std::vector<DType>({1, 0, 5, 2, 3}));
+  IdArray order = CSRRowWiseTopkOrder(mat, timestamp, true);
+  IdArray rows = NDArray::FromVector(std::vector<Idx>({0, 1, 3}));
+
+  // only the entries strictly earlier than the bound of their row
+  NDArray bound = NDArray::FromVector(std::vector<DType>({3, 3, 3}));
+  std::set<ETuple<Idx>> eligible;
+  if (has_data) {
+    eligible.insert(ETuple<Idx>{0, 1, 3});
+    eligible.insert(ETuple<Idx>{1, 1, 0});
+    eligible.insert(ETuple<Idx>{3, 2, 1});
+  } else {
+    eligible.insert(ETuple<Idx>{0, 0, 0});
+    eligible.insert(ETuple<Idx>{0, 1, 1});
+    eligible.insert(ETuple<Idx>{3, 2, 3});
+  }
+  {
+  auto rst = CSRRowWiseSamplingTemporal(mat, rows, -1, timestamp, order, bound, false);
+  ASSERT_EQ(ToEdgeSet<Idx>(rst), eligible);
+  }
+  for (int k = 0; k < 10; ++k) {
+    auto rst = CSRRowWiseSamplingTemporal(mat, rows, 4, timestamp, order, bound, true);
+    ASSERT_EQ(rst.row->shape[0], has_data ? 12 : 8);
+    for (const auto& e : ToEdgeSet<Idx>(rst))
+      ASSERT_TRUE(eligible.count(e));
+  }
+  for (int k = 0; k < 10; ++k) {
+    auto rst = CSRRowWiseSamplingTemporal(mat, rows, 1, timestamp, order, bound, false);
+    ASSERT_EQ(rst.row->shape[0], has_data ? 3 : 2);
+    auto eset = ToEdgeSet<Idx>(rst);
+    ASSERT_EQ(eset.size(), has_data ? 3 : 2);
+    for (const auto& e : eset)
+      ASSERT_TRUE(eligible.count(e));
+  }
+
+  // a bound per row
+  bound = NDArray::FromVector(std::vector<DType>({0, 10, 10}));
+  {
+  auto rst = CSRRowWiseSamplingTemporal(mat, rows, 2, timestamp, order, bound, false);
+  auto eset = ToEdgeSet<Idx>(rst);
+  ASSERT_EQ(eset.size(), 3);
+  for (const auto& e : AllEdgeSet<Idx>(has_data)) {
+    if (std::get<0>(e) != 0)
+      ASSERT_TRUE(eset.count(e));
+  }
+  }
+}
+
+TEST(RowwiseTest, TestCSRSamplingTemporal) {
+  _TestCSRSamplingTemporal<int32_t, int64_t>(true);
+  _TestCSRSamplingTemporal<int64_t, int64_t>(true);
+  _TestCSRSamplingTemporal<int32_t, float>(true);
+  _TestCSRSamplingTemporal<int64_t, double>(true);
+  _TestCSRSamplingTemporal<int32_t, int64_t>(false);
+  _TestCSRSamplingTemporal<int64_t, int64_t>(false);
+  _TestCSRSamplingTemporal<int32_t, float>(false);
+  _TestCSRSamplingTemporal<int64_t, double>(false);
+}
 
 template <typename Idx, typename FloatType>
 void _TestCOOTopk(bool has_data) {
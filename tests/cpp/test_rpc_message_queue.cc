@@ -0,0 +1,74 @@
+#ifndef _WIN32
+#include <gtest/gtest.h>
+#include <dmlc/io.h>
+
+#include <string>
+#include <vector>
+
+#include "../src/rpc/tensorpipe/message_queue.h"
+
+using dgl::rpc::RPCMessage;
+using dgl::rpc::RPCMessageQueue;
+
+namespace {
+
+RPCMessage MakeMessage(int32_t service_id, int64_t msg_seq, int bytes) {
+  RPCMessage msg;
+  msg.service_id = service_id;
+  msg.msg_seq = msg_seq;
+  msg.data = std::string(bytes, 'x');
+  return msg;
+}
+
+}  // namespace
+
+TEST(RPCMessageQueueTest, TestPriority) {
+  RPCMessageQueue queue(1 << 20);
+  queue.SetNumSenders(1);
+  queue.SetPriority(1, 1);
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(queue.Push(0, MakeMessage(0, i, 8), [] {}));
+    ASSERT_TRUE(queue.Push(0, MakeMessage(1, 4 + i, 8), [] {}));
+  }
+  ASSERT_EQ(queue.size(), 8);
+  // the high priority first, in arrival order within a priority
+  for (int64_t seq : {4, 5, 6, 7, 0, 1, 2, 3})
+    ASSERT_EQ(queue.Pop().msg_seq, seq);
+  ASSERT_EQ(queue.size(), 0);
+}
+
+TEST(RPCMessageQueueTest, TestStarvation) {
+  RPCMessageQueue queue(1 << 20);
+  queue.SetNumSenders(1);
+  queue.SetPriority(1, 1);
+  ASSERT_TRUE(queue.Push(0, MakeMessage(0, -1, 8), [] {}));
+  const int num_high = 2 * RPCMessageQueue::kMaxBypass;
+  for (int i = 0; i < num_high; ++i)
+    ASSERT_TRUE(queue.Push(0, MakeMessage(1, i, 8), [] {}));
+  // the low priority message is taken once bypassed kMaxBypass times
+  for (int i = 0; i < RPCMessageQueue::kMaxBypass; ++i)
+    ASSERT_EQ(queue.Pop().msg_seq, i);
+  ASSERT_EQ(queue.Pop().msg_seq, -1);
+  for (int i = RPCMessageQueue::kMaxBypass; i < num_high; ++i)
+    ASSERT_EQ(queue.Pop().msg_seq, i);
+}
+
+TEST(RPCMessageQueueTest, TestCredit) {
+  // two senders share 200 bytes, i.e. 100 bytes each
+  RPCMessageQueue queue(200);
+  queue.SetNumSenders(2);
+  int resumed = 0;
+  auto resume = [&resumed] { ++resumed; };
+  ASSERT_TRUE(queue.Push(0, MakeMessage(0, 0, 60), resume));
+  ASSERT_FALSE(queue.Push(0, MakeMessage(0, 1, 60), resume));
+  // the other sender still has credit
+  ASSERT_TRUE(queue.Push(1, MakeMessage(0, 2, 60), resume));
+  ASSERT_EQ(resumed, 0);
+  // the sender out of credit is resumed once below its credit again
+  ASSERT_EQ(queue.Pop().msg_seq, 0);
+  ASSERT_EQ(resumed, 1);
+  ASSERT_EQ(queue.Pop().msg_seq, 1);
+  ASSERT_EQ(queue.Pop().msg_seq, 2);
+  ASSERT_EQ(resumed, 1);
+}
+#endif  // _WIN32
@@ -0,0 +1,69 @@
+#ifndef _WIN32
+#include <gtest/gtest.h>
+#include <stdio.h>
+
+#include <fstream>
+#include <string>
+
+#include "../src/rpc/rpc_stats.h"
+
+using dgl::rpc::LatencyHistogram;
+using dgl::rpc::RPCStats;
+
+TEST(RPCStatsTest, TestHistogram) {
+  LatencyHistogram hist;
+  ASSERT_EQ(hist.Quantile(0.5), 0);
+  for (int64_t us : {0, 1, 3, 3, 100}) {
+    hist.Add(us);
+  }
+  ASSERT_EQ(hist.count(), 5);
+  ASSERT_EQ(hist.sum(), 107);
+  ASSERT_EQ(hist.max(), 100);
+  ASSERT_EQ(hist.buckets()[0], 1);
+  ASSERT_EQ(hist.buckets()[1], 1);
+  ASSERT_EQ(hist.buckets()[2], 2);
+  ASSERT_EQ(hist.buckets()[7], 1);
+  ASSERT_EQ(hist.Quantile(0.5), 4);
+  ASSERT_EQ(hist.Quantile(1.), 100);
+}
+
+TEST(RPCStatsTest, TestLatency) {
+  RPCStats stats;
+  // a client sends a request of service 5 to server 1
+  stats.OnSend(5, 10, 1, 100, 1000);
+  // the response of another request is not matched
+  stats.OnRecv(5, 11, 0, 1, 20, 50, 0, 1100);
+  stats.OnRecv(5, 10, 0, 1, 40, 200, 2, 1300);
+  std::string snapshot = stats.Snapshot(0);
+  ASSERT_NE(snapshot.find("\"request_latency_us\": {\"count\": 1, \"sum\": 300"),
+            std::string::npos);
+  ASSERT_NE(snapshot.find("\"num_sent\": 1, \"bytes_sent\": 100, \"num_recv\": 2, "
+                          "\"bytes_recv\": 60"), std::string::npos);
+  ASSERT_NE(snapshot.find("\"recv_queue_depth\": {\"last\": 2, \"max\": 2}"),
+            std::string::npos);
+
+  // a server answers a request of client 3
+  stats.Clear();
+  stats.OnRecv(6, 7, 3, 0, 10, 0, 0, 2000);
+  stats.OnSend(6, 7, 3, 10, 2500);
+  snapshot = stats.Snapshot(0);
+  ASSERT_NE(snapshot.find("\"serve_latency_us\": {\"count\": 1, \"sum\": 500"),
+            std::string::npos);
+  ASSERT_NE(snapshot.find("\"peers\": {\"3\": {\"num_sent\": 1"), std::string::npos);
+  ASSERT_NE(snapshot.find("\"num_outstanding\": 0"), std::string::npos);
+}
+
+TEST(RPCStatsTest, TestDump) {
+  const std::string path = "rpc_stats_test.jsonl";
+  remove(path.c_str());
+  RPCStats stats;
+  stats.OnSend(1, 1, 0, 8, 0);
+  stats.StartDump(path, 0.01, 4);
+  stats.StopDump();
+  std::ifstream in(path);
+  std::string line;
+  ASSERT_TRUE(static_cast<bool>(std::getline(in, line)));
+  ASSERT_EQ(line.find("{\"rank\": 4"), 0);
+  remove(path.c_str());
+}
+#endif  // _WIN32
@@ -279,4 +279,44 @@ TEST(RandomTest, TestBiasedChoice) {
   _TestBiasedChoice<int64_t, float>(re);
   _TestBiasedChoice<int32_t, double>(re);
   _TestBiasedChoice<int64_t, double>(re);
-}
\ No newline at end of file
+}
+template <typename Idx>
+void _TestRandIntFill(RandomEngine* re) {
+  const int64_t num = 100000;
+  std::vector<Idx> first(num), second(num);
+  re->SetSeed(42);
+  re->RandInt<Idx>(-3, 7, num, first.data());
+  re->SetSeed(42);
+  re->RandInt<Idx>(-3, 7, num, second.data());
+  // the same seed gives the same sequence
+  ASSERT_EQ(first, second);
+  std::vector<int64_t> counter(10, 0);
+  for (int64_t i = 0; i < num; ++i) {
+    ASSERT_TRUE(first[i] >= -3 && first[i] < 7);
+    counter[first[i] + 3]++;
+  }
+  for (int64_t i = 0; i < 10; ++i)
+    ASSERT_NEAR(static_cast<double>(counter[i]) / num, 0.1, 1e-2);
+}
+
+template <typename FloatType>
+void _TestUniformFill(RandomEngine* re) {
+  const int64_t num = 100000;
+  std::vector<FloatType> out(num);
+  re->SetSeed(42);
+  re->Uniform<FloatType>(2, 4, num, out.data());
+  double sum = 0;
+  for (int64_t i = 0; i < num; ++i) {
+    ASSERT_TRUE(out[i] >= 2 && out[i] < 4);
+    sum += out[i];
+  }
+  ASSERT_NEAR(sum / num, 3., 1e-2);
+}
+
+TEST(RandomTest, TestBulkFill) {
+  RandomEngine* re = RandomEngine::ThreadLocal();
+  _TestRandIntFill<int32_t>(re);
+  _TestRandIntFill<int64_t>(re);
+  _TestUniformFill<float>(re);
+  _TestUniformFill<double>(re);
+}
@@ -0,0 +1,96 @@
+#include <../src/array/cpu/sddmm.h>
+#include <dgl/array.h>
+#include <gtest/gtest.h>
+#include <random>
+#include <type_traits>
+#include <vector>
+#include "./common.h"
+
+using namespace dgl;
+using namespace dgl::runtime;
+
+namespace {
+
+template <typename DType>
+NDArray RandomNDArray(std::vector<int64_t> shape, std::mt19937* gen) {
+  NDArray ret = NDArray::Empty(shape, DLDataType{kDLFloat, sizeof(DType) * 8, 1}, CTX);
+  std::uniform_real_distribution<double> dist(-1., 1.);
+  DType* data = Ptr<DType>(ret);
+  for (int64_t i = 0; i < ret.NumElements(); ++i)
+    data[i] = static_cast<DType>(dist(*gen));
+  return ret;
+}
+
+template <typename IdType>
+aten::CSRMatrix RandomCSR(int64_t num_rows, int64_t num_cols, int64_t max_deg,
+                          std::mt19937* gen) {
+  std::uniform_int_distribution<int64_t> deg(0, max_deg), col(0, num_cols - 1);
+  std::vector<IdType> indptr = {0}, indices;
+  for (int64_t i = 0; i < num_rows; ++i) {
+    const int64_t d = deg(*gen);
+    for (int64_t j = 0; j < d; ++j)
+      indices.push_back(col(*gen));
+    indptr.push_back(indices.size());
+  }
+  return aten::CSRMatrix(
+      num_rows, num_cols,
+      aten::VecToIdArray(indptr, sizeof(IdType) * 8, CTX),
+      aten::VecToIdArray(indices, sizeof(IdType) * 8, CTX),
+      aten::NullArray());
+}
+
+/*
+ * Compare u_dot_v computed by the row traversal, the column-tiled traversal
+ * and the Coo kernel against a plain loop.
+ */
+template <typename IdType, typename DType>
+void _TestSDDMMDot(int64_t dim) {
+  std::mt19937 gen(42);
+  const int64_t num_rows = 57, num_cols = 93, num_heads = 2;
+  const aten::CSRMatrix csr = RandomCSR<IdType>(num_rows, num_cols, 9, &gen);
+  const int64_t nnz = csr.indices->shape[0];
+  NDArray lhs = RandomNDArray<DType>({num_rows, num_heads, dim}, &gen);
+  NDArray rhs = RandomNDArray<DType>({num_cols, num_heads, dim}, &gen);
+  const auto dtype = DLDataType{kDLFloat, sizeof(DType) * 8, 1};
+  NDArray out = NDArray::Empty({nnz, num_heads, 1}, dtype, CTX);
+  NDArray out_tiled = NDArray::Empty({nnz, num_heads, 1}, dtype, CTX);
+  NDArray out_coo = NDArray::Empty({nnz, num_heads, 1}, dtype, CTX);
+  const BcastOff bcast = CalcBcastOff("dot", lhs, rhs);
+  typedef aten::cpu::op::Dot<DType> Op;
+
+  aten::cpu::SDDMMCsr<IdType, DType, Op, 0, 2>(bcast, csr, lhs, rhs, out);
+  const auto dot = aten::cpu::SDDMMDotKernel<DType, Op>(bcast.reduce_size);
+  aten::cpu::SDDMMCsrTiled<IdType, DType, Op, 0, 2>(
+      bcast, csr, Ptr<DType>(lhs), Ptr<DType>(rhs), Ptr<DType>(out_tiled), 8, dot);
+  aten::cpu::SDDMMCoo<IdType, DType, Op, 0, 2>(
+      bcast, aten::CSRToCOO(csr, false), lhs, rhs, out_coo);
+
+  const IdType* indptr = Ptr<IdType>(csr.indptr);
+  const IdType* indices = Ptr<IdType>(csr.indices);
+  const DType tol = std::is_same<DType, float>::value ? 1e-4 : 1e-10;
+  for (int64_t r = 0; r < num_rows; ++r) {
+    for (IdType j = indptr[r]; j < indptr[r + 1]; ++j) {
+      for (int64_t h = 0; h < num_heads; ++h) {
+        const DType* l = Ptr<DType>(lhs) + (r * num_heads + h) * dim;
+        const DType* c = Ptr<DType>(rhs) + (indices[j] * num_heads + h) * dim;
+        DType exp = 0;
+        for (int64_t k = 0; k < dim; ++k)
+          exp += l[k] * c[k];
+        ASSERT_NEAR(Ptr<DType>(out)[j * num_heads + h], exp, tol);
+        ASSERT_NEAR(Ptr<DType>(out_tiled)[j * num_heads + h], exp, tol);
+        ASSERT_NEAR(Ptr<DType>(out_coo)[j * num_heads + h], exp, tol);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+TEST(SddmmTest, TestSDDMMDot) {
+  for (int64_t dim : {1, 7, 16, 17, 33, 100}) {
+    _TestSDDMMDot<int32_t, float>(dim);
+    _TestSDDMMDot<int64_t, float>(dim);
+    _TestSDDMMDot<int32_t, double>(dim);
+    _TestSDDMMDot<int64_t, double>(dim);
+  }
+}
@@ -0,0 +1,106 @@
+#include <../src/array/cpu/segment_reduce.h>
+#include <../src/array/cpu/spmm_binary_ops.h>
+#include <dgl/array.h>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+#include "./common.h"
+
+using namespace dgl;
+using namespace dgl::runtime;
+
+namespace {
+
+template <typename DType>
+NDArray RandomFeat(int64_t num_rows, int64_t dim, std::mt19937* gen) {
+  NDArray ret = NDArray::Empty({num_rows, dim}, DLDataType{kDLFloat, sizeof(DType) * 8, 1}, CTX);
+  std::uniform_real_distribution<double> dist(-1., 1.);
+  for (int64_t i = 0; i < ret.NumElements(); ++i)
+    Ptr<DType>(ret)[i] = dist(*gen);
+  return ret;
+}
+
+template <typename DType>
+NDArray Zeros(int64_t num_rows, int64_t dim) {
+  NDArray ret = NDArray::Empty({num_rows, dim}, DLDataType{kDLFloat, sizeof(DType) * 8, 1}, CTX);
+  std::fill(Ptr<DType>(ret), Ptr<DType>(ret) + ret.NumElements(), 0);
+  return ret;
+}
+
+template <typename IdType, typename DType>
+void _TestSegmentReduce(int64_t dim) {
+  std::mt19937 gen(42);
+  // segments of skewed lengths, including empty ones
+  std::vector<IdType> offsets = {0};
+  for (int64_t i = 0; i < 200; ++i)
+    offsets.push_back(offsets.back() + (i % 50 == 0 ? 100 : i % 4));
+  const int64_t n = offsets.size() - 1, num_feat = offsets.back();
+  NDArray feat = RandomFeat<DType>(num_feat, dim, &gen);
+  NDArray offsets_arr = aten::VecToIdArray(offsets, sizeof(IdType) * 8, CTX);
+
+  NDArray sum = Zeros<DType>(n, dim);
+  aten::cpu::SegmentSum<IdType, DType>(feat, offsets_arr, sum);
+  NDArray max = Zeros<DType>(n, dim);
+  NDArray arg = NDArray::Empty({n, dim}, DLDataType{kDLInt, sizeof(IdType) * 8, 1}, CTX);
+  aten::cpu::SegmentCmp<IdType, DType, aten::cpu::op::Max<DType>>(
+      feat, offsets_arr, max, arg);
+
+  const DType* f = Ptr<DType>(feat);
+  for (int64_t i = 0; i < n; ++i) {
+    for (int64_t k = 0; k < dim; ++k) {
+      DType exp_sum = 0, exp_max = aten::cpu::op::Max<DType>::zero;
+      IdType exp_arg = -1;
+      for (IdType j = offsets[i]; j < offsets[i + 1]; ++j) {
+        exp_sum += f[j * dim + k];
+        if (f[j * dim + k] > exp_max) {
+          exp_max = f[j * dim + k];
+          exp_arg = j;
+        }
+      }
+      ASSERT_NEAR(Ptr<DType>(sum)[i * dim + k], exp_sum, 1e-4);
+      ASSERT_EQ(Ptr<DType>(max)[i * dim + k], exp_max);
+      ASSERT_EQ(Ptr<IdType>(arg)[i * dim + k], exp_arg);
+    }
+  }
+}
+
+template <typename IdType, typename DType>
+void _TestScatterAdd(int64_t dim) {
+  std::mt19937 gen(42);
+  const int64_t n = 1000, m = 37;
+  std::uniform_int_distribution<int64_t> row(0, m - 1);
+  std::vector<IdType> idx;
+  for (int64_t i = 0; i < n; ++i)
+    idx.push_back(i % 5 == 0 ? 3 : row(gen));
+  NDArray feat = RandomFeat<DType>(n, dim, &gen);
+  NDArray out = Zeros<DType>(m, dim);
+  aten::cpu::ScatterAdd<IdType, DType>(
+      feat, aten::VecToIdArray(idx, sizeof(IdType) * 8, CTX), out);
+
+  std::vector<DType> exp(m * dim, 0);
+  for (int64_t i = 0; i < n; ++i)
+    for (int64_t k = 0; k < dim; ++k)
+      exp[idx[i] * dim + k] += Ptr<DType>(feat)[i * dim + k];
+  for (int64_t i = 0; i < m * dim; ++i)
+    ASSERT_NEAR(Ptr<DType>(out)[i], exp[i], 1e-4);
+}
+
+}  // namespace
+
+TEST(SegmentReduceTest, TestSegmentReduce) {
+  for (int64_t dim : {1, 5, 33}) {
+    _TestSegmentReduce<int32_t, float>(dim);
+    _TestSegmentReduce<int64_t, float>(dim);
+    _TestSegmentReduce<int32_t, double>(dim);
+    _TestSegmentReduce<int64_t, double>(dim);
+  }
+}
+
+TEST(SegmentReduceTest, TestScatterAdd) {
+  for (int64_t dim : {1, 5, 33}) {
+    _TestScatterAdd<int32_t, float>(dim);
+    _TestScatterAdd<int64_t, float>(dim);
+    _TestScatterAdd<int32_t, double>(dim);
+    _TestScatterAdd<int64_t, double>(dim);
+  }
+}
@@ -1,6 +1,10 @@
 #include <gtest/gtest.h>
 #include <dmlc/omp.h>
 #include <dgl/array.h>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
 #include "./common.h"
 
 using namespace dgl;
@@ -274,15 +278,92 @@ void _TestCOOToCSR(DLContext ctx) {
   ASSERT_TRUE(ArrayEQ<IDX>(csr.indices, tcsr.indices));
 }
 
+template <typename IDX>
+void _TestCOOToCSRLarge() {
+  // large enough to be converted by blocks of rows, with a skewed row
+  std::mt19937 gen(42);
+  const int64_t num_rows = 100000, num_cols = 1000, nnz = 1 << 22;
+  std::uniform_int_distribution<int64_t> row(0, num_rows - 1), col(0, num_cols - 1);
+  std::vector<IDX> rows(nnz), cols(nnz), data(nnz);
+  for (int64_t i = 0; i < nnz; ++i) {
+    rows[i] = (i % 5 == 0) ? 42 : row(gen);
+    cols[i] = col(gen);
+    data[i] = nnz - 1 - i;
+  }
+  // the expected CSR keeps the order of the non-zeros within the rows
+  std::vector<IDX> indptr(num_rows + 1, 0), indices(nnz), eids(nnz);
+  for (int64_t i = 0; i < nnz; ++i)
+    ++indptr[rows[i] + 1];
+  std::partial_sum(indptr.begin(), indptr.end(), indptr.begin());
+  std::vector<IDX> pos(indptr.begin(), indptr.end() - 1);
+  for (int64_t i = 0; i < nnz; ++i) {
+    indices[pos[rows[i]]] = cols[i];
+    eids[pos[rows[i]]++] = i;
+  }
+
+  for (bool with_data : {false, true}) {
+    const auto coo = aten::COOMatrix(
+        num_rows, num_cols, aten::VecToIdArray(rows, sizeof(IDX)*8, CTX),
+        aten::VecToIdArray(cols, sizeof(IDX)*8, CTX),
+        with_data ? aten::VecToIdArray(data, sizeof(IDX)*8, CTX) : aten::NullArray());
+    const auto csr = aten::COOToCSR(coo);
+    ASSERT_TRUE(ArrayEQ<IDX>(csr.indptr, aten::VecToIdArray(indptr, sizeof(IDX)*8, CTX)));
+    ASSERT_TRUE(ArrayEQ<IDX>(csr.indices, aten::VecToIdArray(indices, sizeof(IDX)*8, CTX)));
+    const auto expected_data = with_data ?
+        aten::IndexSelect(coo.data, aten::VecToIdArray(eids, sizeof(IDX)*8, CTX)) :
+        aten::VecToIdArray(eids, sizeof(IDX)*8, CTX);
+    ASSERT_TRUE(ArrayEQ<IDX>(csr.data, expected_data));
+  }
+}
+
 TEST(SpmatTest, COOToCSR) {
   _TestCOOToCSR<int32_t>(CPU);
   _TestCOOToCSR<int64_t>(CPU);
+  _TestCOOToCSRLarge<int32_t>();
+  _TestCOOToCSRLarge<int64_t>();
 #ifdef DGL_USE_CUDA
   _TestCOOToCSR<int32_t>(GPU);
   _TestCOOToCSR<int64_t>(GPU);
 #endif
 }
 
+#ifdef DGL_USE_CUDA
+template <typename IDX>
+void _TestCOOToCSRChunked() {
+  for (const int64_t chunk_size : {1, 2, 3, 100}) {
+    // the order of the edges within the rows is kept
+    auto rs_coo = aten::COOSort(COO3<IDX>(CPU), false);
+    auto tcsr = aten::COOToCSRChunked(rs_coo, GPU, chunk_size);
+    ASSERT_EQ(tcsr.indptr->ctx.device_type, kDLCPU);
+    ASSERT_TRUE(ArrayEQ<IDX>(tcsr.indptr, SR_CSR3<IDX>(CPU).indptr));
+    ASSERT_TRUE(ArrayEQ<IDX>(tcsr.indices, rs_coo.col));
+    ASSERT_TRUE(ArrayEQ<IDX>(tcsr.data, rs_coo.data));
+
+    auto rs_nd_coo = RowSorted_NullData_COO<IDX>();
+    tcsr = aten::COOToCSRChunked(rs_nd_coo, GPU, chunk_size);
+    auto rs_nd_csr = RowSorted_NullData_CSR<IDX>();
+    ASSERT_TRUE(ArrayEQ<IDX>(tcsr.indptr, rs_nd_csr.indptr));
+    ASSERT_TRUE(ArrayEQ<IDX>(tcsr.indices, rs_nd_csr.indices));
+    ASSERT_TRUE(ArrayEQ<IDX>(tcsr.data, rs_nd_csr.data));
+
+    auto src_coo = aten::COOSort(COO1<IDX>(), true);
+    tcsr = aten::COOToCSRChunked(src_coo, GPU, chunk_size);
+    ASSERT_TRUE(tcsr.sorted);
+    ASSERT_TRUE(ArrayEQ<IDX>(tcsr.indptr, CSR1<IDX>().indptr));
+    ASSERT_TRUE(ArrayEQ<IDX>(tcsr.indices, src_coo.col));
+    ASSERT_TRUE(ArrayEQ<IDX>(tcsr.data, src_coo.data));
+
+    tcsr = aten::COOToCSRChunked(COO3<IDX>(CPU), GPU, chunk_size);
+    ASSERT_TRUE(ArrayEQ<IDX>(tcsr.indptr, SR_CSR3<IDX>(CPU).indptr));
+  }
+}
+
+TEST(SpmatTest, COOToCSRChunked) {
+  _TestCOOToCSRChunked<int32_t>();
+  _TestCOOToCSRChunked<int64_t>();
+}
+#endif
+
 template <typename IDX>
 void _TestCOOHasDuplicate() {
   auto csr = COO1<IDX>();
@@ -360,9 +441,57 @@ void _TestCOOSort(DLContext ctx) {
   ASSERT_TRUE(ArrayEQ<IDX>(src_coo.data, sort_col_data));
 }
 
+template <typename IDX>
+void _TestCOOSortLarge() {
+  // large enough for the radix sorts, with a row longer than their threshold
+  std::mt19937 gen(42);
+  const int64_t num_rows = 1000, num_cols = 300000, nnz = 300000;
+  std::uniform_int_distribution<int64_t> row(0, num_rows - 1), col(0, num_cols - 1);
+  std::vector<IDX> rows(nnz), cols(nnz);
+  for (int64_t i = 0; i < nnz; ++i) {
+    rows[i] = (i % 3 == 0) ? 7 : row(gen);
+    cols[i] = col(gen);
+  }
+  const auto coo = aten::COOMatrix(
+      num_rows, num_cols, aten::VecToIdArray(rows, sizeof(IDX)*8, CPU),
+      aten::VecToIdArray(cols, sizeof(IDX)*8, CPU));
+
+  for (bool sort_column : {false, true}) {
+    std::vector<int64_t> order(nnz);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int64_t i, int64_t j) {
+      return rows[i] < rows[j] || (sort_column && rows[i] == rows[j] && cols[i] < cols[j]);
+    });
+    std::vector<IDX> sorted_rows(nnz), sorted_cols(nnz), sorted_data(nnz);
+    for (int64_t i = 0; i < nnz; ++i) {
+      sorted_rows[i] = rows[order[i]];
+      sorted_cols[i] = cols[order[i]];
+      sorted_data[i] = order[i];
+    }
+    const auto sorted = aten::COOSort(coo, sort_column);
+    ASSERT_TRUE(sorted.row_sorted);
+    ASSERT_EQ(sorted.col_sorted, sort_column);
+    ASSERT_TRUE(ArrayEQ<IDX>(sorted.row, aten::VecToIdArray(sorted_rows, sizeof(IDX)*8, CPU)));
+    ASSERT_TRUE(ArrayEQ<IDX>(sorted.col, aten::VecToIdArray(sorted_cols, sizeof(IDX)*8, CPU)));
+    ASSERT_TRUE(ArrayEQ<IDX>(sorted.data, aten::VecToIdArray(sorted_data, sizeof(IDX)*8, CPU)));
+
+    if (sort_column) {
+      // the CSR of the row-sorted matrix has the same columns once sorted, and
+      // the same data in the long row, which is sorted stably
+      const auto csr = aten::CSRSort(aten::COOToCSR(aten::COOSort(coo, false)));
+      ASSERT_TRUE(ArrayEQ<IDX>(csr.indices, sorted.col));
+      const IDX* indptr = Ptr<IDX>(csr.indptr);
+      for (IDX i = indptr[7]; i < indptr[8]; ++i)
+        ASSERT_EQ(Ptr<IDX>(csr.data)[i], Ptr<IDX>(sorted.data)[i]);
+    }
+  }
+}
+
 TEST(SpmatTest, COOSort) {
   _TestCOOSort<int32_t>(CPU);
   _TestCOOSort<int64_t>(CPU);
+  _TestCOOSortLarge<int32_t>();
+  _TestCOOSortLarge<int64_t>();
 #ifdef DGL_USE_CUDA
   _TestCOOSort<int32_t>(GPU);
   _TestCOOSort<int64_t>(GPU);
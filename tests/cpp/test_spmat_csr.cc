@@ -1,5 +1,12 @@
 #include <gtest/gtest.h>
 #include <dgl/array.h>
+#include <dgl/aten/kernel_plan.h>
+#include <dgl/kernel.h>
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <utility>
+#include <vector>
 #include "./common.h"
 
 using namespace dgl;
@@ -276,12 +283,120 @@ void _TestCSRGetData(DLContext ctx) {
 
 }
 
+template <typename IDX>
+IDX _CSRGetDataRef(const aten::CSRMatrix& csr, IDX row, IDX col) {
+  const IDX* indptr = Ptr<IDX>(csr.indptr);
+  const IDX* indices = Ptr<IDX>(csr.indices);
+  const IDX* data = Ptr<IDX>(csr.data);
+  if (csr.sorted) {
+    const IDX* it = std::lower_bound(indices + indptr[row], indices + indptr[row + 1], col);
+    return (it != indices + indptr[row + 1] && *it == col) ? data[it - indices] : -1;
+  }
+  for (IDX i = indptr[row]; i < indptr[row + 1]; ++i) {
+    if (indices[i] == col)
+      return data[i];
+  }
+  return -1;
+}
+
+template <typename IDX>
+void _TestCSRGetDataBatched() {
+  // enough queries to be sorted, on a multigraph with long rows
+  std::mt19937 gen(42);
+  const int64_t num_rows = 2000, num_cols = 500, nnz = 100000, num_queries = 50000;
+  std::uniform_int_distribution<int64_t> row(0, num_rows - 1), col(0, num_cols - 1);
+  std::vector<IDX> rows(nnz), cols(nnz), data(nnz);
+  for (int64_t i = 0; i < nnz; ++i) {
+    rows[i] = (i % 4 == 0) ? 7 : row(gen);
+    cols[i] = col(gen);
+    data[i] = nnz - 1 - i;
+  }
+  auto coo = aten::COOMatrix(
+      num_rows, num_cols, aten::VecToIdArray(rows, sizeof(IDX)*8, CTX),
+      aten::VecToIdArray(cols, sizeof(IDX)*8, CTX), aten::VecToIdArray(data, sizeof(IDX)*8, CTX));
+  const auto csr = aten::COOToCSR(coo);
+  ASSERT_FALSE(csr.sorted);
+
+  std::vector<IDX> qrows(num_queries), qcols(num_queries);
+  for (int64_t i = 0; i < num_queries; ++i) {
+    qrows[i] = (i % 3 == 0) ? 7 : row(gen);
+    qcols[i] = col(gen);
+  }
+  const auto r = aten::VecToIdArray(qrows, sizeof(IDX)*8, CTX);
+  const auto c = aten::VecToIdArray(qcols, sizeof(IDX)*8, CTX);
+  for (const auto& mat : {csr, aten::CSRSort(csr)}) {
+    std::vector<IDX> expected(num_queries), expected_row(num_queries);
+    for (int64_t i = 0; i < num_queries; ++i) {
+      expected[i] = _CSRGetDataRef<IDX>(mat, qrows[i], qcols[i]);
+      expected_row[i] = _CSRGetDataRef<IDX>(mat, 7, qcols[i]);
+    }
+    ASSERT_TRUE(ArrayEQ<IDX>(
+        aten::CSRGetData(mat, r, c), aten::VecToIdArray(expected, sizeof(IDX)*8, CTX)));
+    // broadcasting the row
+    ASSERT_TRUE(ArrayEQ<IDX>(
+        aten::CSRGetData(mat, aten::VecToIdArray(std::vector<IDX>({7}), sizeof(IDX)*8, CTX), c),
+        aten::VecToIdArray(expected_row, sizeof(IDX)*8, CTX)));
+  }
+
+  // an unsorted COO returns the first match in its order, as its unsorted CSR
+  coo.row_sorted = coo.col_sorted = false;
+  std::vector<IDX> expected(num_queries);
+  for (int64_t i = 0; i < num_queries; ++i)
+    expected[i] = _CSRGetDataRef<IDX>(csr, qrows[i], qcols[i]);
+  ASSERT_TRUE(ArrayEQ<IDX>(
+      aten::COOGetData(coo, r, c), aten::VecToIdArray(expected, sizeof(IDX)*8, CTX)));
+}
+
+#ifdef DGL_USE_CUDA
+template <typename IDX>
+void _TestCSRGetDataIndexed(int64_t num_rows) {
+  // an unsorted GPU multigraph, indexed by a hash table for long rows and by a
+  // sorted copy for short ones
+  std::mt19937 gen(42);
+  const int64_t num_cols = 500, nnz = 100000, num_queries = 50000;
+  std::uniform_int_distribution<int64_t> row(0, num_rows - 1), col(0, num_cols - 1);
+  std::vector<IDX> rows(nnz), cols(nnz), data(nnz);
+  for (int64_t i = 0; i < nnz; ++i) {
+    rows[i] = (i % 4 == 0) ? 7 : row(gen);
+    cols[i] = col(gen);
+    data[i] = nnz - 1 - i;
+  }
+  const auto csr = aten::COOToCSR(aten::COOMatrix(
+      num_rows, num_cols, aten::VecToIdArray(rows, sizeof(IDX)*8, CTX),
+      aten::VecToIdArray(cols, sizeof(IDX)*8, CTX), aten::VecToIdArray(data, sizeof(IDX)*8, CTX)));
+  ASSERT_FALSE(csr.sorted);
+
+  std::vector<IDX> qrows(num_queries), qcols(num_queries), expected(num_queries);
+  for (int64_t i = 0; i < num_queries; ++i) {
+    qrows[i] = (i % 3 == 0) ? 7 : row(gen);
+    qcols[i] = col(gen);
+    expected[i] = _CSRGetDataRef<IDX>(csr, qrows[i], qcols[i]);
+  }
+  const auto gpu_csr = csr.CopyTo(GPU);
+  const auto r = aten::VecToIdArray(qrows, sizeof(IDX)*8, GPU);
+  const auto c = aten::VecToIdArray(qcols, sizeof(IDX)*8, GPU);
+  aten::KernelPlanCache cache;
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_TRUE(ArrayEQ<IDX>(
+        aten::CSRGetData(gpu_csr, r, c, &cache).CopyTo(CPU),
+        aten::VecToIdArray(expected, sizeof(IDX)*8, CPU)));
+    ASSERT_EQ(cache.Size(), 1);
+  }
+}
+#endif
+
 TEST(SpmatTest, CSRGetData) {
   _TestCSRGetData<int32_t>(CPU);
   _TestCSRGetData<int64_t>(CPU);
+  _TestCSRGetDataBatched<int32_t>();
+  _TestCSRGetDataBatched<int64_t>();
 #ifdef DGL_USE_CUDA
   _TestCSRGetData<int32_t>(GPU);
   _TestCSRGetData<int64_t>(GPU);
+  _TestCSRGetDataIndexed<int32_t>(2000);
+  _TestCSRGetDataIndexed<int64_t>(2000);
+  _TestCSRGetDataIndexed<int32_t>(50000);
+  _TestCSRGetDataIndexed<int64_t>(50000);
 #endif
 }
 
@@ -328,15 +443,87 @@ void _TestCSRTranspose(DLContext ctx) {
   ASSERT_TRUE(ArrayEQ<IDX>(csr_t.data, td));
 }
 
+template <typename IDX>
+void _TestCSRTransposeLarge(int64_t num_rows, int64_t num_cols, int64_t nnz) {
+  // large enough for the rows to be split among the threads
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<int64_t> row_dist(0, num_rows - 1);
+  std::uniform_int_distribution<int64_t> col_dist(0, num_cols - 1);
+  std::vector<IDX> indptr(num_rows + 1, 0), indices(nnz), data(nnz);
+  for (int64_t i = 0; i < nnz; ++i)
+    indptr[row_dist(gen) + 1]++;
+  std::partial_sum(indptr.begin(), indptr.end(), indptr.begin());
+  for (int64_t i = 0; i < nnz; ++i) {
+    indices[i] = col_dist(gen);
+    data[i] = nnz - 1 - i;
+  }
+  // sort the entries by column, then by row, as the transpose does
+  std::vector<std::vector<std::pair<IDX, IDX>>> cols(num_cols);
+  for (int64_t r = 0; r < num_rows; ++r) {
+    for (IDX j = indptr[r]; j < indptr[r + 1]; ++j)
+      cols[indices[j]].emplace_back(r, data[j]);
+  }
+  std::vector<IDX> tp(1, 0), ti, td;
+  for (const auto &col : cols) {
+    for (const auto &entry : col) {
+      ti.push_back(entry.first);
+      td.push_back(entry.second);
+    }
+    tp.push_back(ti.size());
+  }
+
+  auto csr = aten::CSRMatrix(
+      num_rows, num_cols,
+      aten::VecToIdArray(indptr, sizeof(IDX)*8, CPU),
+      aten::VecToIdArray(indices, sizeof(IDX)*8, CPU),
+      aten::VecToIdArray(data, sizeof(IDX)*8, CPU));
+  auto csr_t = aten::CSRTranspose(csr);
+  ASSERT_EQ(csr_t.num_rows, num_cols);
+  ASSERT_EQ(csr_t.num_cols, num_rows);
+  ASSERT_TRUE(ArrayEQ<IDX>(csr_t.indptr, aten::VecToIdArray(tp, sizeof(IDX)*8, CPU)));
+  ASSERT_TRUE(ArrayEQ<IDX>(csr_t.indices, aten::VecToIdArray(ti, sizeof(IDX)*8, CPU)));
+  ASSERT_TRUE(ArrayEQ<IDX>(csr_t.data, aten::VecToIdArray(td, sizeof(IDX)*8, CPU)));
+}
+
 TEST(SpmatTest, CSRTranspose) {
   _TestCSRTranspose<int32_t>(CPU);
   _TestCSRTranspose<int64_t>(CPU);
+  _TestCSRTransposeLarge<int32_t>(1000, 500, 200000);
+  _TestCSRTransposeLarge<int64_t>(20000, 30, 100000);
 #ifdef DGL_USE_CUDA
   _TestCSRTranspose<int32_t>(GPU);
   _TestCSRTranspose<int64_t>(GPU);
 #endif
 }
 
+template <typename IDX>
+void _TestCSRMakeSymmetric() {
+  // has duplicate entries, a self loop and unsorted columns
+  // [[0, 1, 2, 0],
+  //  [0, 1, 0, 0],
+  //  [0, 0, 0, 1],
+  //  [0, 0, 0, 0]]
+  auto csr = aten::CSRMatrix(
+      4, 4,
+      aten::VecToIdArray(std::vector<IDX>({0, 3, 4, 5, 5}), sizeof(IDX)*8, CPU),
+      aten::VecToIdArray(std::vector<IDX>({2, 1, 2, 1, 3}), sizeof(IDX)*8, CPU),
+      aten::NullArray(), false);
+  auto sym = aten::CSRMakeSymmetric(csr);
+  ASSERT_EQ(sym.num_rows, 4);
+  ASSERT_EQ(sym.num_cols, 4);
+  ASSERT_TRUE(sym.sorted);
+  ASSERT_FALSE(aten::CSRHasData(sym));
+  auto tp = aten::VecToIdArray(std::vector<IDX>({0, 2, 4, 6, 7}), sizeof(IDX)*8, CPU);
+  auto ti = aten::VecToIdArray(std::vector<IDX>({1, 2, 0, 1, 0, 3, 2}), sizeof(IDX)*8, CPU);
+  ASSERT_TRUE(ArrayEQ<IDX>(sym.indptr, tp));
+  ASSERT_TRUE(ArrayEQ<IDX>(sym.indices, ti));
+}
+
+TEST(SpmatTest, CSRMakeSymmetric) {
+  _TestCSRMakeSymmetric<int32_t>();
+  _TestCSRMakeSymmetric<int64_t>();
+}
+
 template <typename IDX>
 void _TestCSRToCOO(DLContext ctx) {
   auto csr = CSR2<IDX>(ctx);
@@ -370,6 +557,18 @@ void _TestCSRToCOO(DLContext ctx) {
   ASSERT_TRUE(ArrayEQ<IDX>(coo.row, tcoo.row));
   ASSERT_TRUE(ArrayEQ<IDX>(coo.col, tcoo.col));
   }
+  if (ctx.device_type == kDLCPU) {
+  // the entries in the order of their ids share the column indices
+  const int64_t nnz = csr.indices->shape[0];
+  const aten::CSRMatrix id_csr(csr.num_rows, csr.num_cols, csr.indptr, csr.indices,
+                               aten::Range(0, nnz, sizeof(IDX)*8, ctx));
+  auto coo = CSRToCOO(id_csr, true);
+  ASSERT_TRUE(coo.row_sorted);
+  ASSERT_FALSE(aten::COOHasData(coo));
+  ASSERT_EQ(coo.col->data, csr.indices->data);
+  auto tr = aten::VecToIdArray(std::vector<IDX>({0, 0, 0, 1, 2, 2}), sizeof(IDX)*8, ctx);
+  ASSERT_TRUE(ArrayEQ<IDX>(coo.row, tr));
+  }
 }
 
 TEST(SpmatTest, CSRToCOO) {
@@ -667,3 +866,24 @@ TEST(SpmatTest, TestCSRReorder) {
   _TestCSRReorder<int32_t>();
   _TestCSRReorder<int64_t>();
 }
+
+TEST(SpmatTest, TestCSRWideIndptr) {
+  auto csr = aten::CSRNarrowIndices(CSR2<int64_t>());
+  ASSERT_TRUE(aten::CSRHasWideIndptr(csr));
+  ASSERT_EQ(csr.indptr->dtype.bits, 64);
+  ASSERT_EQ(csr.indices->dtype.bits, 32);
+  ASSERT_EQ(csr.data->dtype.bits, 64);
+  ASSERT_TRUE(ArrayEQ<int32_t>(
+      csr.indices, aten::VecToIdArray(std::vector<int32_t>({1, 2, 2, 0, 2, 3}), 32, CTX)));
+  // the operators not supporting the matrix fail instead of misreading it
+  EXPECT_ANY_THROW(aten::CSRSort(csr));
+
+  // out[r] = sum of ufeat[c] * efeat[e] over the non-zeros (r, c, e)
+  NDArray ufeat = NDArray::FromVector(std::vector<float>({1., 2., 3., 4., 5.}));
+  NDArray efeat = NDArray::FromVector(std::vector<float>({1., 10., 100., 1000., 1e4, 1e5}));
+  NDArray out = aten::Full(0.f, 4, CTX);
+  aten::SpMM("mul", "sum", csr, ufeat, efeat, out);
+  const std::vector<float> expected({2. + 3. * 100. + 3. * 1e5, 1000., 3. * 10. + 4. * 1e4, 0.});
+  for (int64_t i = 0; i < 4; ++i)
+    ASSERT_FLOAT_EQ(static_cast<float*>(out->data)[i], expected[i]);
+}
@@ -314,5 +314,68 @@ TEST(SpmmTest, TestSpmmDiv) {
   _TestSpmmDiv<float>();
   _TestSpmmDiv<double>();
 }
+
+template <typename Op, typename Cmp, typename IdType>
+void _TestSpmmCmp() {
+  typedef typename Op::type DType;
+  for (size_t i = 0; i < sizeof(sizes) / sizeof(int); i++) {
+    int dim = sizes[i];
+    DType out[dim], out_intel_kernel[dim], lhs[dim], rhs[dim];
+    IdType argx[dim], argw[dim], argx_intel[dim], argw_intel[dim];
+    for (int k = 0; k < dim; k++) {
+      out[k] = out_intel_kernel[k] = Cmp::zero;
+      argx[k] = argw[k] = argx_intel[k] = argw_intel[k] = 0;
+    }
+
+    auto* cpu_spec =
+      generic_ElemWiseUpd<dgl::ElemWiseCmpUpdate<Op, Cmp, IdType>>();
+    // Feed a few "edges" so that the accumulator gets replaced only
+    // on some of the positions.
+    for (int64_t e = 1; e <= 3; ++e) {
+      GenerateRandomData(lhs, dim);
+      GenerateData(rhs, dim, static_cast<DType>(e));
+
+      // Calculation of output using legacy path - 'out'
+      for (int k = 0; k < dim; k++) {
+        const DType val = Op::Call(lhs + k, rhs + k);
+        if (Cmp::Call(out[k], val)) {
+          out[k] = val;
+          if (Op::use_lhs) argx[k] = 10 * e;
+          if (Op::use_rhs) argw[k] = e;
+        }
+      }
+
+      // Calculation of output using intel path - 'out_intel_kernel'
+      if (cpu_spec) {
+        cpu_spec->run(out_intel_kernel, lhs, rhs, static_cast<int64_t>(dim),
+                      argx_intel, argw_intel, 10 * e, e);
+      }
+    }
+    if (cpu_spec) {
+      for (int k = 0; k < dim; k++) {
+        ASSERT_TRUE(out[k] == out_intel_kernel[k]);
+        ASSERT_EQ(argx[k], argx_intel[k]);
+        ASSERT_EQ(argw[k], argw_intel[k]);
+      }
+    }
+  }
+}
+
+template <typename DType, typename IdType>
+void _TestSpmmCmpAllOps() {
+  _TestSpmmCmp<ns_op::Add<DType>, ns_op::Max<DType>, IdType>();
+  _TestSpmmCmp<ns_op::Sub<DType>, ns_op::Min<DType>, IdType>();
+  _TestSpmmCmp<ns_op::Mul<DType>, ns_op::Max<DType>, IdType>();
+  _TestSpmmCmp<ns_op::Div<DType>, ns_op::Min<DType>, IdType>();
+  _TestSpmmCmp<ns_op::CopyLhs<DType>, ns_op::Max<DType>, IdType>();
+  _TestSpmmCmp<ns_op::CopyRhs<DType>, ns_op::Min<DType>, IdType>();
+}
+
+TEST(SpmmTest, TestSpmmCmp) {
+  _TestSpmmCmpAllOps<float, int32_t>();
+  _TestSpmmCmpAllOps<float, int64_t>();
+  _TestSpmmCmpAllOps<double, int32_t>();
+  _TestSpmmCmpAllOps<double, int64_t>();
+}
 #endif  // USE_AVX
 #endif  // _WIN32
@@ -0,0 +1,113 @@
+#include <../src/array/cpu/spmm.h>
+#include <dgl/array.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <type_traits>
+#include <vector>
+#include "./common.h"
+
+using namespace dgl;
+using namespace dgl::runtime;
+
+namespace {
+
+template <typename IdType>
+aten::COOMatrix RandomCOO(int64_t num_rows, int64_t num_cols, int64_t nnz,
+                          std::mt19937* gen) {
+  std::uniform_int_distribution<int64_t> row(0, num_rows - 1), col(0, num_cols - 1);
+  std::vector<IdType> src, dst;
+  for (int64_t i = 0; i < nnz; ++i) {
+    src.push_back(row(*gen));
+    // skew the in-degrees so that the parts have different column ranges
+    dst.push_back(i % 3 == 0 ? 0 : col(*gen));
+  }
+  return aten::COOMatrix(
+      num_rows, num_cols,
+      aten::VecToIdArray(src, sizeof(IdType) * 8, CTX),
+      aten::VecToIdArray(dst, sizeof(IdType) * 8, CTX));
+}
+
+template <typename IdType>
+void _TestSpMMCooPartition() {
+  std::mt19937 gen(42);
+  const aten::COOMatrix coo = RandomCOO<IdType>(30, 50, 400, &gen);
+  const IdType* col = Ptr<IdType>(coo.col);
+  for (int64_t num_parts : {1, 3, 8, 64}) {
+    auto partition = aten::cpu::SpMMBuildCooPartition<IdType>(coo, num_parts);
+    ASSERT_EQ(partition->offsets.size(), num_parts + 1);
+    ASSERT_EQ(partition->offsets[0], 0);
+    ASSERT_EQ(partition->offsets[num_parts], 400);
+    std::vector<int> seen(400, 0);
+    IdType prev_max = -1;
+    for (int64_t p = 0; p < num_parts; ++p) {
+      IdType part_min = coo.num_cols, part_max = -1;
+      for (int64_t j = partition->offsets[p]; j < partition->offsets[p + 1]; ++j) {
+        const IdType i = partition->perm[j];
+        ++seen[i];
+        // the original edge order is kept within a part
+        if (j > partition->offsets[p]) {
+          ASSERT_LT(partition->perm[j - 1], i);
+        }
+        part_min = std::min(part_min, col[i]);
+        part_max = std::max(part_max, col[i]);
+      }
+      // the parts cover disjoint, increasing destination ranges
+      if (part_max >= 0) {
+        ASSERT_GT(part_min, prev_max);
+        prev_max = part_max;
+      }
+    }
+    for (int s : seen)
+      ASSERT_EQ(s, 1);
+  }
+}
+
+template <typename IdType, typename DType>
+void _TestSpMMSumCoo() {
+  std::mt19937 gen(42);
+  const int64_t num_rows = 30, num_cols = 50, nnz = 400, dim = 5;
+  const aten::COOMatrix coo = RandomCOO<IdType>(num_rows, num_cols, nnz, &gen);
+  const auto dtype = DLDataType{kDLFloat, sizeof(DType) * 8, 1};
+  NDArray ufeat = NDArray::Empty({num_rows, dim}, dtype, CTX);
+  NDArray efeat = NDArray::Empty({nnz, dim}, dtype, CTX);
+  std::uniform_real_distribution<double> dist(-1., 1.);
+  for (int64_t i = 0; i < ufeat.NumElements(); ++i)
+    Ptr<DType>(ufeat)[i] = dist(gen);
+  for (int64_t i = 0; i < efeat.NumElements(); ++i)
+    Ptr<DType>(efeat)[i] = dist(gen);
+  NDArray out = NDArray::Empty({num_cols, dim}, dtype, CTX);
+  const BcastOff bcast = CalcBcastOff("mul", ufeat, efeat);
+
+  std::vector<DType> exp(num_cols * dim, 0);
+  for (int64_t i = 0; i < nnz; ++i) {
+    const IdType rid = Ptr<IdType>(coo.row)[i], cid = Ptr<IdType>(coo.col)[i];
+    for (int64_t k = 0; k < dim; ++k)
+      exp[cid * dim + k] += Ptr<DType>(ufeat)[rid * dim + k] * Ptr<DType>(efeat)[i * dim + k];
+  }
+
+  aten::KernelPlanCache plan_cache;
+  const DType tol = std::is_same<DType, float>::value ? 1e-4 : 1e-10;
+  // without cache, then building and reusing the cached partition
+  for (auto* cache : {static_cast<aten::KernelPlanCache*>(nullptr), &plan_cache, &plan_cache}) {
+    aten::cpu::SpMMSumCoo<IdType, DType, aten::cpu::op::Mul<DType>>(
+        bcast, coo, ufeat, efeat, out, cache);
+    for (int64_t i = 0; i < num_cols * dim; ++i)
+      ASSERT_NEAR(Ptr<DType>(out)[i], exp[i], tol);
+  }
+  ASSERT_LE(plan_cache.Size(), 1);
+}
+
+}  // namespace
+
+TEST(SpmmTest, TestSpMMCooPartition) {
+  _TestSpMMCooPartition<int32_t>();
+  _TestSpMMCooPartition<int64_t>();
+}
+
+TEST(SpmmTest, TestSpMMSumCoo) {
+  _TestSpMMSumCoo<int32_t, float>();
+  _TestSpMMSumCoo<int64_t, float>();
+  _TestSpMMSumCoo<int32_t, double>();
+  _TestSpMMSumCoo<int64_t, double>();
+}
@@ -0,0 +1,69 @@
+#include <dgl/runtime/stage_tracker.h>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "./common.h"
+
+using namespace dgl;
+using namespace dgl::runtime;
+
+namespace {
+
+const int kToBlock = static_cast<int>(SamplingStage::kToBlock);
+const int kGather = static_cast<int>(SamplingStage::kGather);
+
+}  // namespace
+
+TEST(StageTrackerTest, TestCounters) {
+  StageTracker* tracker = StageTracker::Global();
+  tracker->SetEnabled(false);
+  tracker->SetTracing(false);
+  tracker->Reset();
+  {
+    StageScope stage_scope(SamplingStage::kToBlock);
+    ASSERT_FALSE(stage_scope.active());
+  }
+  ASSERT_EQ(tracker->GetCounters()[kToBlock].num_calls, 0);
+
+  tracker->SetEnabled(true);
+  for (int i = 0; i < 2; ++i) {
+    StageScope stage_scope(SamplingStage::kToBlock);
+    ASSERT_TRUE(stage_scope.active());
+    stage_scope.AddSeeds({NDArray::FromVector(std::vector<int64_t>({0, 1, 2})),
+                          NDArray::FromVector(std::vector<int64_t>({3}))});
+    stage_scope.AddEdges(10);
+  }
+  const std::vector<StageTracker::Counters> counters = tracker->GetCounters();
+  ASSERT_EQ(counters[kToBlock].num_calls, 2);
+  ASSERT_EQ(counters[kToBlock].num_seeds, 8);
+  ASSERT_EQ(counters[kToBlock].num_edges, 20);
+  ASSERT_GE(counters[kToBlock].wall_ns, 0);
+  ASSERT_GE(counters[kToBlock].thread_ns, counters[kToBlock].wall_ns);
+  ASSERT_EQ(counters[kGather].num_calls, 0);
+  tracker->Reset();
+  ASSERT_EQ(tracker->GetCounters()[kToBlock].num_calls, 0);
+  tracker->SetEnabled(false);
+}
+
+TEST(StageTrackerTest, TestTrace) {
+  StageTracker* tracker = StageTracker::Global();
+  tracker->SetTracing(true);
+  tracker->Reset();
+  ASSERT_EQ(StageBatchScope::Current(), -1);
+  {
+    StageBatchScope batch_scope(7);
+    StageScope stage_scope(SamplingStage::kGather);
+    stage_scope.AddBytes(256);
+  }
+  ASSERT_EQ(StageBatchScope::Current(), -1);
+  // the counters are only kept when enabled
+  ASSERT_EQ(tracker->GetCounters()[kGather].num_calls, 0);
+  const std::string trace = tracker->GetTrace();
+  ASSERT_NE(trace.find("\"traceEvents\""), std::string::npos);
+  ASSERT_NE(trace.find("\"name\":\"Gather\""), std::string::npos);
+  ASSERT_NE(trace.find("\"batch\":7"), std::string::npos);
+  ASSERT_NE(trace.find("\"bytes\":256"), std::string::npos);
+  tracker->Reset();
+  ASSERT_EQ(tracker->GetTrace().find("Gather"), std::string::npos);
+  tracker->SetTracing(false);
+}
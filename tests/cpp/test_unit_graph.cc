@@ -3,14 +3,17 @@
  * \file test_unit_graph.cc
  * \brief Test UnitGraph
  */
+#include "../../src/array/uvm_array_op.h"
 #include "../../src/graph/unit_graph.h"
 #include "./../src/graph/heterograph.h"
 #include "./common.h"
 #include <dgl/array.h>
+#include <dgl/aten/degree_stats.h>
 #include <dgl/immutable_graph.h>
 #include <dgl/runtime/device_api.h>
 #include <gtest/gtest.h>
 #include <memory>
+#include <thread>
 #include <vector>
 
 using namespace dgl;
@@ -373,6 +376,282 @@ void _TestUnitGraph_CopyTo(const DLContext &src_ctx,
   ASSERT_EQ(cg->GetCreatedFormats(), 1);
 }
 
+template <typename IdType>
+void _TestUnitGraph_CopyToBatch(const DLContext &src_ctx,
+                                const DGLContext &dst_ctx) {
+  const aten::CSRMatrix &csr = CSR1<IdType>(src_ctx);
+  const aten::COOMatrix &coo = COO1<IdType>(src_ctx);
+
+  std::vector<HeteroGraphPtr> graphs = {
+    dgl::UnitGraph::CreateFromCSC(2, csr),
+    dgl::UnitGraph::CreateFromCOO(2, coo),
+    dgl::UnitGraph::CreateFromCSR(2, csr)};
+  auto cgs = dgl::UnitGraph::CopyTo(graphs, dst_ctx);
+  ASSERT_EQ(cgs.size(), 3);
+  ASSERT_EQ(cgs[0]->GetCreatedFormats(), 4);
+  ASSERT_EQ(cgs[1]->GetCreatedFormats(), 1);
+  ASSERT_EQ(cgs[2]->GetCreatedFormats(), 2);
+  for (const auto &cg : cgs)
+    ASSERT_EQ(cg->Context(), dst_ctx);
+
+  const auto csc = cgs[0]->GetCSCMatrix(0).CopyTo(CPU);
+  ASSERT_TRUE(ArrayEQ<IdType>(csc.indptr, csr.indptr.CopyTo(CPU)));
+  ASSERT_TRUE(ArrayEQ<IdType>(csc.indices, csr.indices.CopyTo(CPU)));
+  const auto ccoo = cgs[1]->GetCOOMatrix(0).CopyTo(CPU);
+  ASSERT_TRUE(ArrayEQ<IdType>(ccoo.row, coo.row.CopyTo(CPU)));
+  ASSERT_TRUE(ArrayEQ<IdType>(ccoo.col, coo.col.CopyTo(CPU)));
+  const auto ccsr = cgs[2]->GetCSRMatrix(0).CopyTo(CPU);
+  ASSERT_TRUE(ArrayEQ<IdType>(ccsr.indptr, csr.indptr.CopyTo(CPU)));
+  ASSERT_TRUE(ArrayEQ<IdType>(ccsr.indices, csr.indices.CopyTo(CPU)));
+}
+
+template <typename IdType>
+void _TestUnitGraph_ConcurrentFormats(DLContext ctx) {
+  const aten::COOMatrix &coo = COO1<IdType>(ctx);
+  auto g = dgl::UnitGraph::CreateFromCOO(2, coo);
+  const int num_threads = 8;
+  std::vector<aten::CSRMatrix> cscs(num_threads), csrs(num_threads);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back([&g, &cscs, &csrs, i] {
+      cscs[i] = g->GetCSCMatrix(0);
+      csrs[i] = g->GetCSRMatrix(0);
+    });
+  }
+  for (auto &t : threads)
+    t.join();
+  ASSERT_EQ(g->GetCreatedFormats(), 7);
+  // every thread gets the formats created once
+  for (int i = 1; i < num_threads; ++i) {
+    ASSERT_TRUE(cscs[i].indices->data == cscs[0].indices->data);
+    ASSERT_TRUE(csrs[i].indices->data == csrs[0].indices->data);
+  }
+}
+
+template <typename IdType>
+void _TestUnitGraph_KernelPlanCache(DLContext ctx) {
+  const aten::CSRMatrix &csr = CSR1<IdType>(ctx);
+  auto g = std::dynamic_pointer_cast<UnitGraph>(dgl::UnitGraph::CreateFromCSC(2, csr));
+  ASSERT_TRUE(g != nullptr);
+
+  auto plans = g->GetKernelPlanCache(0, SparseFormat::kCSC);
+  ASSERT_TRUE(plans != nullptr);
+  // the plan cache belongs to the CSC and is reused across calls
+  ASSERT_EQ(plans, g->GetKernelPlanCache(0, SparseFormat::kCSC));
+  ASSERT_NE(plans, g->GetKernelPlanCache(0, SparseFormat::kCSR));
+  ASSERT_TRUE(g->GetKernelPlanCache(0, SparseFormat::kCOO) != nullptr);
+  ASSERT_NE(plans, g->GetKernelPlanCache(0, SparseFormat::kCOO));
+
+  int num_builds = 0;
+  auto make = [&num_builds]() {
+    ++num_builds;
+    return std::make_shared<int>(42);
+  };
+  ASSERT_EQ(*plans->GetOrCreate<int>("plan", make), 42);
+  ASSERT_EQ(*plans->GetOrCreate<int>("plan", make), 42);
+  ASSERT_EQ(num_builds, 1);
+  ASSERT_EQ(plans->Size(), 1);
+  ASSERT_EQ(*plans->Find<int>("plan"), 42);
+  ASSERT_TRUE(plans->Find<int>("other") == nullptr);
+  plans->Erase("plan");
+  ASSERT_TRUE(plans->Find<int>("plan") == nullptr);
+  plans->GetOrCreate<int>("plan", make);
+  ASSERT_EQ(num_builds, 2);
+
+  // invalidating the CSC drops its plans
+  g->InvalidateCSC();
+  ASSERT_EQ(plans->Size(), 0);
+  auto new_plans = g->GetKernelPlanCache(0, SparseFormat::kCSC);
+  ASSERT_NE(plans, new_plans);
+  ASSERT_EQ(new_plans->Size(), 0);
+
+  // so does invalidating the COO
+  auto coo_plans = g->GetKernelPlanCache(0, SparseFormat::kCOO);
+  coo_plans->GetOrCreate<int>("plan", make);
+  ASSERT_EQ(coo_plans->Size(), 1);
+  g->InvalidateCOO();
+  ASSERT_EQ(coo_plans->Size(), 0);
+}
+
+#ifdef DGL_USE_CUDA
+template <typename IdType>
+void _TestUnitGraph_PinMemory() {
+  const aten::CSRMatrix &csr = CSR1<IdType>(CPU);
+  auto g = std::dynamic_pointer_cast<UnitGraph>(
+      dgl::UnitGraph::CreateFromCSC(2, csr, CSC_CODE));
+  ASSERT_FALSE(g->IsPinned());
+  g->PinMemory_(GPU, true);
+  ASSERT_TRUE(g->IsPinned());
+  ASSERT_EQ(g->Context().device_type, kDLCPU);
+
+  // the row pointers are read on the GPU, the columns in host memory
+  const auto plans = g->GetKernelPlanCache(0, SparseFormat::kCSC);
+  const aten::CSRMatrix pinned = aten::CSRWithCachedIndptr(g->GetCSCMatrix(0), GPU, plans.get());
+  ASSERT_EQ(pinned.indptr->ctx.device_type, kDLGPU);
+  ASSERT_EQ(pinned.indices->ctx.device_type, kDLCPU);
+  ASSERT_TRUE(ArrayEQ<IdType>(pinned.indptr.CopyTo(CPU), csr.indptr));
+
+  const IdArray rows = aten::VecToIdArray<IdType>({1, 3}, sizeof(IdType) * 8, GPU);
+  for (const aten::CSRMatrix& mat : {g->GetCSCMatrix(0), pinned}) {
+    const aten::COOMatrix sampled = aten::CSRRowWiseSampling(mat, rows, 2);
+    ASSERT_EQ(sampled.row->ctx.device_type, kDLGPU);
+    // rows 1 and 3 have the columns {0, 2}, all taken
+    ASSERT_EQ(sampled.row->shape[0], 4);
+    const IdArray cols = sampled.col.CopyTo(CPU);
+    for (int64_t i = 0; i < 4; ++i) {
+      const IdType col = cols.Ptr<IdType>()[i];
+      ASSERT_TRUE(col == 0 || col == 2);
+    }
+  }
+
+  g->UnpinMemory_();
+  ASSERT_FALSE(g->IsPinned());
+  ASSERT_EQ(aten::CSRWithCachedIndptr(g->GetCSCMatrix(0), GPU, plans.get()).indptr->ctx
+      .device_type, kDLCPU);
+}
+#endif  // DGL_USE_CUDA
+
+template <typename IdType>
+void _TestUnitGraph_DegreeStats(DLContext ctx) {
+  const aten::CSRMatrix &csr = CSR1<IdType>(ctx);
+  auto stats = aten::CSRGetDegreeStats(csr);
+  ASSERT_TRUE(ArrayEQ<IdType>(
+      stats->degrees, aten::VecToIdArray<IdType>({1, 2, 1, 2}, sizeof(IdType) * 8, ctx)));
+  ASSERT_EQ(stats->num_rows, 4);
+  ASSERT_EQ(stats->nnz, 6);
+  ASSERT_EQ(stats->max_degree, 2);
+  ASSERT_EQ(stats->histogram, std::vector<int64_t>({0, 2, 2}));
+  ASSERT_EQ(stats->NumRowsFromBin(2), 2);
+
+  // the statistics are kept in the plan cache of the CSR until it is invalidated
+  auto g = std::dynamic_pointer_cast<UnitGraph>(dgl::UnitGraph::CreateFromCSR(2, csr));
+  ASSERT_TRUE(g != nullptr);
+  auto plans = g->GetKernelPlanCache(0, SparseFormat::kCSR);
+  auto cached = aten::CSRGetDegreeStats(g->GetCSRMatrix(0), plans.get());
+  ASSERT_EQ(cached, aten::CSRGetDegreeStats(g->GetCSRMatrix(0), plans.get()));
+  ASSERT_EQ(plans->Size(), 1);
+  g->InvalidateCSR();
+  ASSERT_EQ(plans->Size(), 0);
+
+  // the degrees of a COO are counted once for each direction
+  const aten::COOMatrix &coo = COO1<IdType>(ctx);
+  auto col_stats = aten::COOGetDegreeStats(coo, true);
+  ASSERT_TRUE(ArrayEQ<IdType>(
+      col_stats->degrees, aten::VecToIdArray<IdType>({1, 2, 0}, sizeof(IdType) * 8, ctx)));
+  ASSERT_EQ(col_stats->max_degree, 2);
+  ASSERT_EQ(col_stats->histogram, std::vector<int64_t>({1, 1, 1}));
+  auto coo_g = CreateFromCOO(2, coo, COO_CODE);
+  auto nids = aten::Range(0, 2, sizeof(IdType) * 8, ctx);
+  coo_g->InDegrees(0, nids);
+  coo_g->OutDegrees(0, nids);
+  coo_g->InDegrees(0, nids);
+  ASSERT_EQ(coo_g->GetKernelPlanCache(0, SparseFormat::kCOO)->Size(), 2);
+}
+
+template <typename IdType>
+void _TestUnitGraph_FormatMemoryBudget(DLContext ctx) {
+  const aten::CSRMatrix &csr = CSR1<IdType>(ctx);
+  auto g = std::dynamic_pointer_cast<UnitGraph>(dgl::UnitGraph::CreateFromCSC(2, csr));
+  ASSERT_TRUE(g != nullptr);
+  ASSERT_LT(g->GetFormatMemoryBudget(), 0);
+  const int64_t csc_bytes = g->GetFormatMemoryUsage();
+  ASSERT_EQ(csc_bytes, 11 * static_cast<int64_t>(sizeof(IdType)));
+
+  // without budget, the created formats are kept
+  auto out_csr = g->GetFormat(SparseFormat::kCSR);
+  g->GetCOO();
+  ASSERT_EQ(g->GetCreatedFormats(), ALL_CODE);
+
+  // the most recently used format is kept
+  g->SetFormatMemoryBudget(0);
+  ASSERT_EQ(g->GetCreatedFormats(), COO_CODE);
+  ASSERT_EQ(g->GetFormatMemoryUsage(), 12 * static_cast<int64_t>(sizeof(IdType)));
+  // the evicted formats are still valid for their holders
+  ASSERT_EQ(out_csr->NumEdges(0), 6);
+  g->GetInCSR();
+  ASSERT_EQ(g->GetCreatedFormats(), CSC_CODE);
+  // the formats created without caching are not counted
+  g->GetCOO(false);
+  ASSERT_EQ(g->GetCreatedFormats(), CSC_CODE);
+
+  // the least recently used formats are evicted first
+  g->SetFormatMemoryBudget(g->GetFormatMemoryUsage() + 16 * static_cast<int64_t>(sizeof(IdType)));
+  g->GetCOO();
+  ASSERT_EQ(g->GetCreatedFormats(), CSC_CODE | COO_CODE);
+  g->GetInCSR();
+  g->GetOutCSR();
+  ASSERT_EQ(g->GetCreatedFormats(), CSC_CODE | CSR_CODE);
+  ASSERT_LE(g->GetFormatMemoryUsage(), g->GetFormatMemoryBudget());
+  ASSERT_TRUE(ArrayEQ<IdType>(g->GetCSCMatrix(0).indptr, csr.indptr));
+}
+
+template <typename IdType>
+void _TestUnitGraph_SharedIndices(DLContext ctx) {
+  // a COO sorted by row but not flagged shares its columns with the CSR
+  aten::COOMatrix coo = COO1<IdType>(ctx);
+  coo.row_sorted = coo.col_sorted = false;
+  auto g = CreateFromCOO(2, coo);
+  const aten::CSRMatrix out_csr = g->GetCSRMatrix(0);
+  ASSERT_EQ(out_csr.indices->data, coo.col->data);
+  ASSERT_TRUE(out_csr.sorted);
+  ASSERT_TRUE(ArrayEQ<IdType>(
+      out_csr.indptr, aten::VecToIdArray(std::vector<IdType>({0, 2, 3}), sizeof(IdType)*8, ctx)));
+
+  // and so does the COO of a CSR without data
+  const aten::CSRMatrix &csr = CSR1<IdType>(ctx);
+  g = CreateFromCSR(2, csr);
+  const aten::COOMatrix out_coo = g->GetCOOMatrix(0);
+  ASSERT_EQ(out_coo.col->data, csr.indices->data);
+  ASSERT_TRUE(out_coo.row_sorted);
+}
+
+template <typename IdType>
+void _TestUnitGraph_AppendEdges(DLContext ctx) {
+  const aten::CSRMatrix &csr = CSR1<IdType>(ctx);
+  auto g = std::dynamic_pointer_cast<UnitGraph>(dgl::UnitGraph::CreateFromCSR(2, csr));
+  ASSERT_TRUE(g != nullptr);
+  g->GetInCSR();
+  g->GetCOO();
+  auto sorted_g = std::dynamic_pointer_cast<UnitGraph>(
+      dgl::UnitGraph::CreateFromCSR(2, aten::CSRSort(csr)));
+  sorted_g->GetInCSR();
+
+  const IdArray src = aten::VecToIdArray(std::vector<IdType>({3, 4, 0}), sizeof(IdType)*8, ctx);
+  const IdArray dst = aten::VecToIdArray(std::vector<IdType>({1, 3, 2}), sizeof(IdType)*8, ctx);
+  // the old edges by id, followed by the new ones
+  const IdArray rows = aten::VecToIdArray(
+      std::vector<IdType>({0, 1, 1, 2, 3, 3, 3, 4, 0}), sizeof(IdType)*8, ctx);
+  const IdArray cols = aten::VecToIdArray(
+      std::vector<IdType>({2, 0, 2, 1, 0, 2, 1, 3, 2}), sizeof(IdType)*8, ctx);
+
+  auto new_g = g->AppendEdges(5, 4, src, dst);
+  ASSERT_EQ(new_g->GetCreatedFormats(), ALL_CODE);
+  ASSERT_EQ(new_g->NumVertices(0), 5);
+  ASSERT_EQ(new_g->NumVertices(1), 4);
+  ASSERT_EQ(new_g->NumEdges(0), 9);
+  // the old graph is not changed
+  ASSERT_EQ(g->NumEdges(0), 6);
+
+  aten::COOMatrix coo = aten::CSRToCOO(new_g->GetCSRMatrix(0), true);
+  ASSERT_TRUE(ArrayEQ<IdType>(coo.row, rows));
+  ASSERT_TRUE(ArrayEQ<IdType>(coo.col, cols));
+  coo = aten::CSRToCOO(new_g->GetCSCMatrix(0), true);
+  ASSERT_TRUE(ArrayEQ<IdType>(coo.row, cols));
+  ASSERT_TRUE(ArrayEQ<IdType>(coo.col, rows));
+  const EdgeArray edges = new_g->Edges(0, "eid");
+  ASSERT_TRUE(ArrayEQ<IdType>(edges.src, rows));
+  ASSERT_TRUE(ArrayEQ<IdType>(edges.dst, cols));
+
+  // the sorted CSRs stay sorted
+  new_g = sorted_g->AppendEdges(5, 4, src, dst);
+  ASSERT_EQ(new_g->GetCreatedFormats(), CSR_CODE | CSC_CODE);
+  ASSERT_TRUE(new_g->GetCSRMatrix(0).sorted);
+  ASSERT_TRUE(aten::CSRIsSorted(new_g->GetCSRMatrix(0)));
+  coo = aten::CSRToCOO(new_g->GetCSRMatrix(0), true);
+  ASSERT_TRUE(ArrayEQ<IdType>(coo.row, rows));
+  ASSERT_TRUE(ArrayEQ<IdType>(coo.col, cols));
+}
+
 TEST(UniGraphTest, TestUnitGraph_CopyTo) {
   _TestUnitGraph_CopyTo<int32_t>(CPU, CPU);
   _TestUnitGraph_CopyTo<int64_t>(CPU, CPU);
@@ -386,6 +665,21 @@ TEST(UniGraphTest, TestUnitGraph_CopyTo) {
 #endif
 }
 
+TEST(UniGraphTest, TestUnitGraph_CopyToBatch) {
+  _TestUnitGraph_CopyToBatch<int32_t>(CPU, CPU);
+  _TestUnitGraph_CopyToBatch<int64_t>(CPU, CPU);
+#ifdef DGL_USE_CUDA
+  _TestUnitGraph_CopyToBatch<int32_t>(CPU, GPU);
+  _TestUnitGraph_CopyToBatch<int64_t>(CPU, GPU);
+  _TestUnitGraph_CopyToBatch<int64_t>(GPU, CPU);
+#endif
+}
+
+TEST(UniGraphTest, TestUnitGraph_ConcurrentFormats) {
+  _TestUnitGraph_ConcurrentFormats<int32_t>(CPU);
+  _TestUnitGraph_ConcurrentFormats<int64_t>(CPU);
+}
+
 TEST(UniGraphTest, TestUnitGraph_InOutDegrees) {
   _TestUnitGraph_InOutDegrees<int32_t>(CPU);
   _TestUnitGraph_InOutDegrees<int64_t>(CPU);
@@ -439,3 +733,35 @@ TEST(UniGraphTest, TestUnitGraph_Reserve) {
   _TestUnitGraph_Reserve<int64_t>(GPU);
 #endif
 }
+
+TEST(UniGraphTest, TestUnitGraph_KernelPlanCache) {
+  _TestUnitGraph_KernelPlanCache<int32_t>(CPU);
+  _TestUnitGraph_KernelPlanCache<int64_t>(CPU);
+}
+
+#ifdef DGL_USE_CUDA
+TEST(UniGraphTest, TestUnitGraph_PinMemory) {
+  _TestUnitGraph_PinMemory<int32_t>();
+  _TestUnitGraph_PinMemory<int64_t>();
+}
+#endif  // DGL_USE_CUDA
+
+TEST(UniGraphTest, TestUnitGraph_DegreeStats) {
+  _TestUnitGraph_DegreeStats<int32_t>(CPU);
+  _TestUnitGraph_DegreeStats<int64_t>(CPU);
+}
+
+TEST(UniGraphTest, TestUnitGraph_SharedIndices) {
+  _TestUnitGraph_SharedIndices<int32_t>(CPU);
+  _TestUnitGraph_SharedIndices<int64_t>(CPU);
+}
+
+TEST(UniGraphTest, TestUnitGraph_FormatMemoryBudget) {
+  _TestUnitGraph_FormatMemoryBudget<int32_t>(CPU);
+  _TestUnitGraph_FormatMemoryBudget<int64_t>(CPU);
+}
+
+TEST(UniGraphTest, TestUnitGraph_AppendEdges) {
+  _TestUnitGraph_AppendEdges<int32_t>(CPU);
+  _TestUnitGraph_AppendEdges<int64_t>(CPU);
+}
@@ -97,6 +97,32 @@ TEST(ZeroCopySerialize, ZeroShapeNDArray) {
   EXPECT_EQ(ndvec_read[1]->shape[0], 0);
 }
 
+TEST(ZeroCopySerialize, ReceivedNDArray) {
+  auto tensor1 = VecToIdArray<int64_t>({1, 2, 5, 3});
+  auto tensor2 = VecToIdArray<int32_t>({6, 6, 5});
+
+  std::string zerocopy_blob;
+  StreamWithBuffer zc_write_strm(&zerocopy_blob, true);
+  zc_write_strm.Write(tensor1);
+  zc_write_strm.Write(tensor2);
+
+  // Mimic the byte arrays a communicator receives the data into
+  std::vector<NDArray> recv_list;
+  for (auto ptr : zc_write_strm.buffer_list()) {
+    auto recv = NDArray::Empty({ptr.size}, DLDataType{kDLUInt, 8, 1}, DLContext{kDLCPU, 0});
+    memcpy(recv->data, ptr.data, ptr.size);
+    recv_list.push_back(recv);
+  }
+
+  NDArray loadtensor1, loadtensor2;
+  StreamWithBuffer zc_read_strm(&zerocopy_blob[0], zerocopy_blob.size(), recv_list);
+  zc_read_strm.Read(&loadtensor1);
+  zc_read_strm.Read(&loadtensor2);
+  ASSERT_TRUE(ArrayEQ<int64_t>(loadtensor1, tensor1));
+  ASSERT_TRUE(ArrayEQ<int32_t>(loadtensor2, tensor2));
+  ASSERT_EQ(loadtensor1->data, recv_list[0]->data);
+}
+
 TEST(ZeroCopySerialize, SharedMem) {
   auto tensor1 = VecToIdArray<int64_t>({1, 2, 5, 3});
   DLDataType dtype = {kDLInt, 64, 1};
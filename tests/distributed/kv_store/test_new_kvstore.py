@@ -231,6 +231,22 @@ def start_client(num_clients, num_servers):
     assert_array_equal(F.asnumpy(res), F.asnumpy(data_tensor))
     res = kvclient.pull(name='data_2', id_tensor=id_tensor)
     assert_array_equal(F.asnumpy(res), F.asnumpy(data_tensor))
+    # Test pull with duplicate IDs
+    res = kvclient.pull(name='data_0', id_tensor=F.tensor([4,0,4,2], F.int64))
+    assert_array_equal(F.asnumpy(res), F.asnumpy(F.cat([data_tensor, data_tensor[0:1]], 0)))
+    # Test async pull, with two pulls in flight waited out of order
+    pull_0 = kvclient.pull_async(name='data_0', id_tensor=id_tensor)
+    pull_1 = kvclient.pull_async(name='data_1', id_tensor=id_tensor)
+    assert_array_equal(F.asnumpy(pull_1.wait()), F.asnumpy(data_tensor))
+    assert_array_equal(F.asnumpy(pull_0.wait()), F.asnumpy(data_tensor))
+    assert pull_0.done()
+    # Test feature cache, which only holds the rows of remote machines
+    kvclient.enable_cache('data_0', budget=1024, hot_ids=id_tensor)
+    res = kvclient.pull(name='data_0', id_tensor=id_tensor)
+    assert_array_equal(F.asnumpy(res), F.asnumpy(data_tensor))
+    stats = kvclient.cache_stats('data_0')
+    assert stats['capacity'] == 1024 // 8
+    assert stats['hits'] + stats['misses'] <= 2 * F.shape(id_tensor)[0]
     # Register new push handler
     kvclient.register_push_handler('data_0', udf_push)
     kvclient.register_push_handler('data_1', udf_push)
@@ -278,6 +294,19 @@ def start_client(num_clients, num_servers):
     data_tensor = data_tensor * num_clients
     assert_array_equal(F.asnumpy(res), F.asnumpy(data_tensor))
 
+    # Test pushing gradients, summed over the duplicate IDs and the clients
+    grad_id = F.tensor([0, 2, 4, 0], F.int64)
+    grad_tensor = F.tensor([[1.,1.],[1.,1.],[1.,1.],[1.,1.]], F.float32)
+    kvclient.barrier()
+    kvclient.push_gradients(name='data_3',
+                            id_tensor=grad_id,
+                            grad_tensor=grad_tensor,
+                            compression='fp16')
+    kvclient.barrier()
+    res = kvclient.pull(name='data_3', id_tensor=id_tensor)
+    data_tensor = data_tensor + F.tensor([[2.,2.],[1.,1.],[1.,1.]], F.float32) * num_clients
+    assert_array_equal(F.asnumpy(res), F.asnumpy(data_tensor))
+
 def start_client_mul_role(i):
     os.environ['DGL_DIST_MODE'] = 'distributed'
     # Initialize creates kvstore !
@@ -558,6 +558,71 @@ def check_rpc_hetero_etype_sampling_empty_shuffle(tmpdir, num_server):
     assert block.number_of_edges() == 0
     assert len(block.etypes) == len(g.etypes)
 
+def start_repeated_sample_client(rank, tmpdir, disable_shared_mem, nodes, num_repeats):
+    gpb = None
+    if disable_shared_mem:
+        _, _, _, gpb, _, _, _ = load_partition(tmpdir / 'test_sampling.json', rank)
+    dgl.distributed.initialize("rpc_ip_config.txt")
+    dist_graph = DistGraph("test_sampling", gpb=gpb)
+    # the first request is sampled in Python, the next ones in C++ by the servers
+    sampled_graphs = [sample_neighbors(dist_graph, nodes, 3) for _ in range(num_repeats)]
+    dgl.distributed.exit_client()
+    return sampled_graphs
+
+def check_rpc_native_sampling_shuffle(tmpdir, num_server):
+    ip_config = open("rpc_ip_config.txt", "w")
+    for _ in range(num_server):
+        ip_config.write('{}\n'.format(get_local_usable_addr()))
+    ip_config.close()
+
+    g = CitationGraphDataset("cora")[0]
+    g.readonly()
+    partition_graph(g, 'test_sampling', num_server, tmpdir,
+                    num_hops=1, part_method='metis', reshuffle=True)
+
+    pserver_list = []
+    ctx = mp.get_context('spawn')
+    for i in range(num_server):
+        p = ctx.Process(target=start_server, args=(i, tmpdir, num_server > 1, 'test_sampling'))
+        p.start()
+        time.sleep(1)
+        pserver_list.append(p)
+
+    time.sleep(3)
+    nodes = F.arange(0, 200)
+    sampled_graphs = start_repeated_sample_client(0, tmpdir, num_server > 1, nodes, 4)
+    for p in pserver_list:
+        p.join()
+
+    orig_nid = F.zeros((g.number_of_nodes(),), dtype=F.int64, ctx=F.cpu())
+    orig_eid = F.zeros((g.number_of_edges(),), dtype=F.int64, ctx=F.cpu())
+    for i in range(num_server):
+        part, _, _, _, _, _, _ = load_partition(tmpdir / 'test_sampling.json', i)
+        orig_nid[part.ndata[dgl.NID]] = part.ndata['orig_id']
+        orig_eid[part.edata[dgl.EID]] = part.edata['orig_id']
+
+    for sampled_graph in sampled_graphs:
+        src, dst = sampled_graph.edges()
+        assert np.array_equal(np.minimum(F.asnumpy(sampled_graph.in_degrees(nodes)), 3),
+                              np.minimum(F.asnumpy(g.in_degrees(orig_nid[nodes])), 3))
+        src = orig_nid[src]
+        dst = orig_nid[dst]
+        assert np.all(F.asnumpy(g.has_edges_between(src, dst)))
+        eids = g.edge_ids(src, dst)
+        eids1 = orig_eid[sampled_graph.edata[dgl.EID]]
+        assert np.array_equal(F.asnumpy(eids1), F.asnumpy(eids))
+
+# Wait non shared memory graph store
+@unittest.skipIf(os.name == 'nt', reason='Do not support windows yet')
+@unittest.skipIf(dgl.backend.backend_name == 'tensorflow', reason='Not support tensorflow for now')
+@unittest.skipIf(dgl.backend.backend_name == "mxnet", reason="Turn off Mxnet support")
+@pytest.mark.parametrize("num_server", [1, 2])
+def test_rpc_native_sampling_shuffle(num_server):
+    import tempfile
+    os.environ['DGL_DIST_MODE'] = 'distributed'
+    with tempfile.TemporaryDirectory() as tmpdirname:
+        check_rpc_native_sampling_shuffle(Path(tmpdirname), num_server)
+
 # Wait non shared memory graph store
 @unittest.skipIf(os.name == 'nt', reason='Do not support windows yet')
 @unittest.skipIf(dgl.backend.backend_name == 'tensorflow', reason='Not support tensorflow for now')
@@ -153,6 +153,13 @@ def start_client(ip_config):
         assert res.hello_str == STR
         assert res.integer == INTEGER
         assert_array_equal(F.asnumpy(res.tensor), F.asnumpy(TENSOR))
+    # test rpc stats
+    stats = dgl.distributed.get_rpc_stats()
+    hello_stats = stats['services'][str(HELLO_SERVICE_ID)]
+    assert hello_stats['num_sent'] == 22
+    assert hello_stats['num_recv'] == 22
+    assert hello_stats['request_latency_us']['count'] == 22
+    assert stats['peers']['0']['num_sent'] >= 22
 
 def test_serialize():
     os.environ['DGL_DIST_MODE'] = 'distributed'
@@ -3,6 +3,7 @@ import dgl
 import dgl.ops as OPS
 import backend as F
 import unittest
+import numpy as np
 import torch
 from torch.utils.data import DataLoader
 from collections import defaultdict
@@ -223,6 +224,82 @@ def test_cluster_gcn(num_workers):
     for sg in dataloader:
         assert sg.batch_size == 4
 
+    # the subgraph of a union of partitions has the edges between them
+    sg = sgiter.subgraph([7, 3, 7])
+    nodes = np.concatenate([sgiter.part_indices[sgiter.part_indptr[i]:sgiter.part_indptr[i + 1]]
+                            for i in [3, 7]])
+    assert np.array_equal(F.asnumpy(sg.ndata[dgl.NID]), nodes)
+    ref = g.subgraph(F.tensor(nodes))
+    assert sg.num_edges() == ref.num_edges()
+    u, v = sg.edges()
+    gu, gv = g.find_edges(sg.edata[dgl.EID])
+    assert F.array_equal(F.gather_row(sg.ndata[dgl.NID], u), gu)
+    assert F.array_equal(F.gather_row(sg.ndata[dgl.NID], v), gv)
+    assert F.array_equal(sg.ndata['feat'], F.gather_row(g.ndata['feat'], sg.ndata[dgl.NID]))
+
+@pytest.mark.parametrize('mode', ['node', 'edge', 'walk'])
+def test_saint_sampler(mode):
+    g = dgl.data.CoraFullDataset()[0]
+    sampler = dgl.dataloading.SAINTSampler(g, mode, 100, walk_length=3)
+    subgs = sampler.sample(8, count=True, split=True)
+    assert len(subgs) == 8
+    assert sampler.num_counted == 8
+    node_counts = np.zeros(g.num_nodes(), dtype=np.int64)
+    edge_counts = np.zeros(g.num_edges(), dtype=np.int64)
+    for sg in subgs:
+        nids = F.asnumpy(sg.ndata[dgl.NID])
+        assert np.array_equal(nids, np.unique(nids))
+        # every subgraph is induced by its nodes
+        assert sg.num_edges() == g.subgraph(sg.ndata[dgl.NID]).num_edges()
+        u, v = sg.edges()
+        gu, gv = g.find_edges(sg.edata[dgl.EID])
+        assert F.array_equal(F.gather_row(sg.ndata[dgl.NID], u), gu)
+        assert F.array_equal(F.gather_row(sg.ndata[dgl.NID], v), gv)
+        assert F.array_equal(sg.ndata['feat'], F.gather_row(g.ndata['feat'], sg.ndata[dgl.NID]))
+        node_counts[nids] += 1
+        edge_counts[F.asnumpy(sg.edata[dgl.EID])] += 1
+
+    loss_norm, aggr_norm = sampler.normalization()
+    node_counts = np.maximum(node_counts, 1)
+    assert np.allclose(F.asnumpy(loss_norm), 8 / node_counts / g.num_nodes())
+    _, dst = g.edges()
+    assert np.allclose(F.asnumpy(aggr_norm),
+                       node_counts[F.asnumpy(dst)] / np.maximum(edge_counts, 1))
+
+    # the subgraphs only depend on the seed
+    batch1 = sampler.sample(4, random_seed=42)
+    batch2 = sampler.sample(4, random_seed=42)
+    assert batch1.batch_size == 4
+    assert F.array_equal(batch1.ndata[dgl.NID], batch2.ndata[dgl.NID])
+    assert F.array_equal(batch1.edata[dgl.EID], batch2.edata[dgl.EID])
+    assert sampler.num_counted == 8
+
+@pytest.mark.parametrize('reduce', ['sum', 'mean'])
+@pytest.mark.parametrize('chunk_size', [7, 1000])
+def test_layerwise_inference(reduce, chunk_size):
+    g = dgl.rand_graph(500, 4000)
+    feat = torch.randn(500, 5)
+    out = torch.zeros(500, 5)
+    engine = dgl.dataloading.LayerwiseInference(
+        g, feat, chunk_size, device=F.ctx(), reduce=reduce, out=out)
+    assert len(engine) == (500 + chunk_size - 1) // chunk_size
+    end = 0
+    for start, end, h_neigh, h_self in engine:
+        assert h_neigh.shape == (end - start, 5)
+        assert torch.equal(h_self.cpu(), feat[start:end])
+        engine.store(start, h_neigh + h_self)
+    assert end == 500
+    ref = OPS.copy_u_sum(g, feat) if reduce == 'sum' else OPS.copy_u_mean(g, feat)
+    assert torch.allclose(out, ref + feat, atol=1e-5)
+
+    efeat = torch.randn(4000)
+    out = torch.zeros(500, 5)
+    engine = dgl.dataloading.LayerwiseInference(
+        g, feat, chunk_size, device=F.ctx(), op='u_mul_e', efeat=efeat, out=out)
+    for start, end, h_neigh, _ in engine:
+        engine.store(start, h_neigh)
+    assert torch.allclose(out, OPS.u_mul_e_sum(g, feat, efeat.unsqueeze(1)), atol=1e-5)
+
 @pytest.mark.parametrize('num_workers', [0, 4])
 def test_shadow(num_workers):
     g = dgl.data.CoraFullDataset()[0]
@@ -37,6 +37,24 @@ def test_fps_start_idx():
     assert th.any(res[:, 0] == 0)
 
 
+
+def test_fps_order():
+    # the samples of every point cloud match the serial algorithm
+    def fps_serial(points, sample_points):
+        samples = [0]
+        dist = np.full(points.shape[0], np.inf)
+        for _ in range(sample_points - 1):
+            dist = np.minimum(dist, ((points - points[samples[-1]]) ** 2).sum(1))
+            samples.append(int(np.argmax(dist)))
+        return samples
+
+    batch_size = 7
+    sample_points = 20
+    x = np.random.uniform(size=(batch_size, 300, 3))
+    res = farthest_point_sampler(th.tensor(x).to(F.ctx()), sample_points, start_idx=0)
+    for b in range(batch_size):
+        assert F.asnumpy(res[b]).tolist() == fps_serial(x[b], sample_points)
+
 @pytest.mark.parametrize('algorithm', ['bruteforce-blas', 'bruteforce', 'kd-tree'])
 @pytest.mark.parametrize('dist', ['euclidean', 'cosine'])
 def test_knn_cpu(algorithm, dist):
@@ -218,6 +236,28 @@ def test_edge_coarsening(idtype, g, weight, relabel):
             assert g.has_edges_between(u, v)
 
 
+@parametrize_dtype
+@pytest.mark.parametrize('weight', [True, False])
+def test_edge_coarsening_maximal(idtype, weight):
+    g = dgl.to_bidirected(dgl.rand_graph(500, 2000))
+    g = g.astype(idtype).to(F.ctx())
+    edge_weight = None
+    if weight:
+        edge_weight = F.abs(F.randn((g.num_edges(),))).to(F.ctx())
+    dgl.seed(42)
+    node_labels = neighbor_matching(g, edge_weight, relabel_idx=False)
+    if F.ctx() == F.cpu():
+        # the matching only depends on the seed
+        dgl.seed(42)
+        assert th.equal(node_labels, neighbor_matching(g, edge_weight, relabel_idx=False))
+
+    # no edge between two unmatched nodes
+    _, counts = th.unique(node_labels, return_counts=True)
+    src, dst = g.edges()
+    unmatched = (counts[th.unique(node_labels, return_inverse=True)[1]] == 1).cpu()
+    src, dst = src.long().cpu(), dst.long().cpu()
+    assert not th.any(unmatched[src] & unmatched[dst] & (src != dst))
+
 if __name__ == '__main__':
     test_fps()
     test_fps_start_idx()
@@ -8,6 +8,7 @@ import backend as F
 
 from dgl.nn import NodeEmbedding
 from dgl.optim import SparseAdam, SparseAdagrad
+from dgl.sparse import _sparse_adagrad_update
 
 @unittest.skipIf(os.name == 'nt', reason='Do not support windows yet')
 def test_sparse_adam():
@@ -45,6 +46,22 @@ def test_sparse_adam():
     # Pytorch sparseAdam maintains a global step
     # DGL sparseAdam use a per embedding step
 
+def test_sparse_adagrad_update_duplicates():
+    weight = th.rand((10, 4))
+    state = th.zeros((10, 4))
+    idx = th.tensor([3, 1, 3, 7, 3])
+    grad = th.rand((5, 4))
+    ref_grad = th.zeros((10, 4)).index_add_(0, idx, grad)
+    ref_grad[3] /= 3
+    rows = th.tensor([1, 3, 7])
+    ref_state = ref_grad * ref_grad
+    ref_weight = weight.clone()
+    ref_weight[rows] -= 0.1 * ref_grad[rows] / th.sqrt(ref_state[rows] + 1e-10)
+
+    _sparse_adagrad_update(weight, state, idx, grad, 0.1, 1e-10)
+    assert F.allclose(state, ref_state)
+    assert F.allclose(weight, ref_weight)
+
 @unittest.skipIf(os.name == 'nt', reason='Do not support windows yet')
 def test_sparse_adam_zero_step():
     num_embs = 10
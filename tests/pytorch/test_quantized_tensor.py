@@ -0,0 +1,48 @@
+import unittest, os
+import pytest
+
+import torch as th
+import dgl
+import backend as F
+
+@pytest.mark.parametrize('dtype', ['int8', 'float16'])
+@pytest.mark.parametrize('per_row', [True, False])
+def test_quantized_tensor(dtype, per_row):
+    input = th.rand((1000, 4, 8)) * 10 - 5
+    feats = dgl.contrib.QuantizedTensor(input, dtype=dtype, per_row=per_row)
+    assert feats.shape == (1000, 4, 8)
+    assert len(feats) == 1000
+
+    full = feats.dequantize()
+    assert full.dtype == th.float32 and full.shape == input.shape
+    if dtype == 'int8':
+        flat = input.reshape(1000, -1)
+        lo, hi = (flat.min(1)[0], flat.max(1)[0]) if per_row else (flat.min(0)[0], flat.max(0)[0])
+        scale = ((hi - lo) / 255).unsqueeze(1 if per_row else 0)
+        assert th.all((full.reshape(1000, -1) - flat).abs() <= scale / 2 + 1e-5)
+    else:
+        assert th.equal(full, input.half().float())
+
+    idx = th.randint(0, 1000, (300,))
+    assert th.equal(feats[idx], full[idx])
+
+    g = dgl.rand_graph(1000, 5000)
+    assert th.allclose(dgl.contrib.quantized_copy_u_sum(g, feats),
+                       dgl.ops.copy_u_sum(g, full), atol=1e-4)
+
+@unittest.skipIf(os.name == 'nt', reason='Do not support windows yet')
+@unittest.skipIf(F.ctx().type == 'cpu', reason='gpu only test')
+@pytest.mark.parametrize('dtype', ['int8', 'float16'])
+def test_quantized_tensor_gpu(dtype):
+    input = th.rand((1000, 100))
+    feats = dgl.contrib.QuantizedTensor(input, dtype=dtype, device=th.device('cuda'))
+    full = feats.dequantize()
+    idx = th.randint(0, 1000, (300,), device='cuda')
+    output = feats[idx]
+    assert output.device.type == 'cuda'
+    assert th.allclose(output.cpu(), full[idx.cpu()])
+
+if __name__ == '__main__':
+    test_quantized_tensor('int8', True)
+    test_quantized_tensor('float16', False)
+    test_quantized_tensor_gpu('int8')
@@ -36,6 +36,72 @@ def test_unified_tensor():
     rand_idx = rand_idx.to(th.device('cuda'))
     assert th.all(th.eq(input[rand_idx].to(th.device('cuda')), input_unified[rand_idx]))
 
+@unittest.skipIf(os.name == 'nt', reason='Do not support windows yet')
+@unittest.skipIf(F.ctx().type == 'cpu', reason='gpu only test')
+@pytest.mark.parametrize("test_col_size", [1, 3, 64, 256])
+def test_unified_tensor_sorted(test_col_size):
+    test_row_size = 65536
+    device = th.device('cuda')
+
+    input = th.rand((test_row_size, test_col_size))
+    input_unified = dgl.contrib.UnifiedTensor(input, device=device, sort_index=True)
+
+    rand_idx = th.randint(0, test_row_size, (8192,))
+    assert th.all(th.eq(input[rand_idx].to(device), input_unified[rand_idx.to(device)]))
+    rand_idx = rand_idx.int()
+    assert th.all(th.eq(input[rand_idx.long()].to(device), input_unified[rand_idx.to(device)]))
+
+@unittest.skipIf(os.name == 'nt', reason='Do not support windows yet')
+@unittest.skipIf(F.ctx().type == 'cpu', reason='gpu only test')
+def test_unified_tensor_write():
+    test_row_size = 4096
+    test_col_size = 96
+    device = th.device('cuda')
+
+    input = th.rand((test_row_size, test_col_size))
+    expected = input.clone()
+    input_unified = dgl.contrib.UnifiedTensor(input, device=device)
+
+    idx = th.randperm(test_row_size)[:1024]
+    val = th.rand((1024, test_col_size))
+    input_unified[idx.to(device)] = val.to(device)
+    th.cuda.synchronize()
+    expected[idx] = val
+    assert th.all(th.eq(input, expected))
+
+    idx = th.randint(0, test_row_size, (2048,))
+    val = th.rand((2048, test_col_size))
+    input_unified.index_add_(idx.to(device), val.to(device))
+    th.cuda.synchronize()
+    expected.index_add_(0, idx, val)
+    assert th.allclose(input, expected)
+
+@unittest.skipIf(os.name == 'nt', reason='Do not support windows yet')
+@unittest.skipIf(F.ctx().type == 'cpu', reason='gpu only test')
+@pytest.mark.parametrize("dynamic_cache", [False, True])
+def test_unified_tensor_cache(dynamic_cache):
+    test_row_size = 4096
+    test_col_size = 64
+    cache_size = 512
+    device = th.device('cuda')
+
+    input = th.rand((test_row_size, test_col_size))
+    input_unified = dgl.contrib.UnifiedTensor(
+        input, device=device, cache_size=cache_size, dynamic_cache=dynamic_cache)
+    input_unified.preload_cache(th.arange(0, cache_size // 2, device=device))
+
+    idx = th.arange(0, cache_size // 4, device=device)
+    rows, counts = input_unified.gather(idx)
+    assert th.all(th.eq(input[idx.cpu()].to(device), rows))
+    assert counts.tolist() == [cache_size // 4, 0]
+
+    rand_idx = th.randint(0, test_row_size, (1024,), device=device)
+    for _ in range(2):
+        rows, counts = input_unified.gather(rand_idx)
+        assert th.all(th.eq(input[rand_idx.cpu()].to(device), rows))
+        assert counts.sum().item() == 1024
+    assert th.all(th.eq(input[rand_idx.cpu()].to(device), input_unified[rand_idx]))
+
 @unittest.skipIf(os.name == 'nt', reason='Do not support windows yet')
 @unittest.skipIf(F.ctx().type == 'cpu', reason='gpu only test')
 @pytest.mark.parametrize("num_workers", [1, 2])